@@ -0,0 +1,51 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+//
+// Benchmarks for the ghost updates of common::IndexMap
+
+#include "utils.h"
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/la/Vector.h>
+#include <dolfinx/mesh/Topology.h>
+
+using namespace dolfinx;
+
+namespace
+{
+
+void scatter_fwd(benchmark::State& state)
+{
+  auto mesh = bench::create_mesh(state.range(0));
+  auto map = mesh->topology().index_map(0);
+  la::Vector<double> x(map, state.range(1));
+  std::fill(x.mutable_array().begin(), x.mutable_array().end(), 1.0);
+  bench::run(state, mesh->mpi_comm(), [&x]() { x.scatter_fwd(); });
+  state.counters["ghosts"] = map->num_ghosts();
+}
+//-----------------------------------------------------------------------------
+void scatter_rev(benchmark::State& state)
+{
+  auto mesh = bench::create_mesh(state.range(0));
+  auto map = mesh->topology().index_map(0);
+  la::Vector<double> x(map, state.range(1));
+  std::fill(x.mutable_array().begin(), x.mutable_array().end(), 1.0);
+  bench::run(state, mesh->mpi_comm(),
+             [&x]() { x.scatter_rev(common::IndexMap::Mode::add); });
+  state.counters["ghosts"] = map->num_ghosts();
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
+BENCHMARK(scatter_fwd)
+    ->ArgsProduct({{32, 64}, {1, 3}})
+    ->UseManualTime()
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(scatter_rev)
+    ->ArgsProduct({{32, 64}, {1, 3}})
+    ->UseManualTime()
+    ->Unit(benchmark::kMicrosecond);
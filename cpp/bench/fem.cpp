@@ -0,0 +1,84 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+//
+// Benchmarks for the assembly of finite element forms
+
+#include "forms.h"
+#include "utils.h"
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <dolfinx/fem/Form.h>
+#include <dolfinx/fem/Function.h>
+#include <dolfinx/fem/FunctionSpace.h>
+#include <dolfinx/fem/assembler.h>
+#include <dolfinx/fem/utils.h>
+#include <dolfinx/la/MatrixCSR.h>
+#include <dolfinx/la/SparsityPattern.h>
+#include <vector>
+
+using namespace dolfinx;
+
+namespace
+{
+
+void assemble_vector(benchmark::State& state)
+{
+  auto mesh = bench::create_mesh(state.range(0));
+  const int num_threads = state.range(1);
+  auto V = fem::create_functionspace(functionspace_form_forms_a, "u", mesh);
+  auto f = std::make_shared<fem::Function<double>>(V);
+  std::vector<double>& fx = f->x()->mutable_array();
+  std::fill(fx.begin(), fx.end(), 1.0);
+  auto L = fem::create_form<double>(*form_forms_L, {V}, {{"f", f}}, {}, {});
+
+  // Pack the coefficients once, to time the cell loop and the kernels
+  const std::vector<double> constants = fem::pack_constants(L);
+  const array2d<double> coeffs = fem::pack_coefficients(L);
+  std::vector<double> b(f->x()->array().size());
+  bench::run(state, mesh->mpi_comm(),
+             [&]()
+             {
+               std::fill(b.begin(), b.end(), 0.0);
+               fem::assemble_vector(xtl::span<double>(b), L,
+                                    xtl::span<const double>(constants), coeffs,
+                                    num_threads);
+               benchmark::DoNotOptimize(b.data());
+             });
+  state.counters["cells"] = mesh->topology().index_map(3)->size_local();
+}
+//-----------------------------------------------------------------------------
+void assemble_matrix(benchmark::State& state)
+{
+  auto mesh = bench::create_mesh(state.range(0));
+  const int num_threads = state.range(1);
+  auto V = fem::create_functionspace(functionspace_form_forms_a, "u", mesh);
+  auto a = fem::create_form<double>(*form_forms_a, {V, V}, {}, {}, {});
+
+  la::MatrixCSR<double> A(fem::create_sparsity_pattern(a));
+  const std::vector<double> constants = fem::pack_constants(a);
+  const array2d<double> coeffs = fem::pack_coefficients(a);
+  bench::run(state, mesh->mpi_comm(),
+             [&]()
+             {
+               A.set(0.0);
+               fem::assemble_matrix(
+                   la::MatrixCSR<double>::mat_add_values(A), a,
+                   xtl::span<const double>(constants), coeffs, {},
+                   num_threads);
+             });
+  state.counters["cells"] = mesh->topology().index_map(3)->size_local();
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
+BENCHMARK(assemble_vector)
+    ->ArgsProduct({{16, 32, 64}, {1, 4}})
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(assemble_matrix)
+    ->ArgsProduct({{16, 32, 64}, {1, 4}})
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,69 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+//
+// Benchmarks for the construction and queries of
+// geometry::BoundingBoxTree
+
+#include "utils.h"
+#include <benchmark/benchmark.h>
+#include <dolfinx/geometry/BoundingBoxTree.h>
+#include <dolfinx/geometry/utils.h>
+#include <random>
+#include <vector>
+
+using namespace dolfinx;
+
+namespace
+{
+
+void bbtree_build(benchmark::State& state)
+{
+  auto mesh = bench::create_mesh(state.range(0));
+  const auto strategy = static_cast<geometry::BuildStrategy>(state.range(1));
+  const int num_threads = state.range(2);
+  bench::run(state, mesh->mpi_comm(),
+             [&]()
+             {
+               geometry::BoundingBoxTree tree(*mesh, 3, 0.0, strategy,
+                                              num_threads);
+               benchmark::DoNotOptimize(tree);
+             });
+}
+//-----------------------------------------------------------------------------
+void bbtree_collisions(benchmark::State& state)
+{
+  auto mesh = bench::create_mesh(state.range(0));
+  const int num_threads = state.range(1);
+  geometry::BoundingBoxTree tree(*mesh, 3);
+
+  // Points in the unit cube, the same for each run
+  constexpr std::size_t num_points = 100000;
+  std::mt19937 engine(0);
+  std::uniform_real_distribution<double> dist(0.0, 1.0);
+  std::vector<double> points(3 * num_points);
+  for (double& p : points)
+    p = dist(engine);
+
+  bench::run(state, mesh->mpi_comm(),
+             [&]()
+             {
+               auto collisions = geometry::compute_collisions(
+                   tree, xtl::span<const double>(points), num_threads);
+               benchmark::DoNotOptimize(collisions);
+             });
+  state.counters["points"] = num_points;
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
+BENCHMARK(bbtree_build)
+    ->ArgsProduct({{16, 32}, {0, 1}, {1, 4}})
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(bbtree_collisions)
+    ->ArgsProduct({{16, 32}, {1, 4}})
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
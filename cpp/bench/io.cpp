@@ -0,0 +1,84 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+//
+// Benchmarks for the parallel I/O of io::HDF5Interface
+
+#include "utils.h"
+#include <array>
+#include <benchmark/benchmark.h>
+#include <dolfinx/common/MPI.h>
+#include <dolfinx/io/HDF5Interface.h>
+#include <numeric>
+#include <string>
+#include <vector>
+
+using namespace dolfinx;
+
+namespace
+{
+const std::string filename = "bench.h5";
+
+// Write a dataset with num_rows rows of 3 values from each process
+void write(MPI_Comm comm, std::int64_t num_rows)
+{
+  std::vector<double> x(3 * num_rows);
+  std::iota(x.begin(), x.end(), 0.0);
+  const std::int64_t offset = dolfinx::MPI::global_offset(comm, num_rows, true);
+  const std::int64_t num_rows_global
+      = dolfinx::MPI::size(comm) * std::int64_t(num_rows);
+
+  io::HDF5Interface::WriteOptions options;
+  options.use_mpi_io = dolfinx::MPI::size(comm) > 1;
+  hid_t h5 = io::HDF5Interface::open_file(comm, filename, "w",
+                                          options.use_mpi_io);
+  io::HDF5Interface::write_dataset(h5, "/x", x.data(),
+                                   {offset, offset + num_rows},
+                                   {num_rows_global, 3}, options);
+  io::HDF5Interface::close_file(h5);
+}
+//-----------------------------------------------------------------------------
+void hdf5_write(benchmark::State& state)
+{
+  MPI_Comm comm = MPI_COMM_WORLD;
+  const std::int64_t num_rows = state.range(0);
+  bench::run(state, comm, [&]() { write(comm, num_rows); });
+  state.SetBytesProcessed(state.iterations() * dolfinx::MPI::size(comm)
+                          * num_rows * 3 * sizeof(double));
+}
+//-----------------------------------------------------------------------------
+void hdf5_read(benchmark::State& state)
+{
+  MPI_Comm comm = MPI_COMM_WORLD;
+  const std::int64_t num_rows = state.range(0);
+  write(comm, num_rows);
+  const std::int64_t offset = dolfinx::MPI::global_offset(comm, num_rows, true);
+  const bool use_mpi_io = dolfinx::MPI::size(comm) > 1;
+  bench::run(state, comm,
+             [&]()
+             {
+               hid_t h5 = io::HDF5Interface::open_file(comm, filename, "r",
+                                                       use_mpi_io);
+               std::vector<double> x = io::HDF5Interface::read_dataset<double>(
+                   h5, "/x", {offset, offset + num_rows});
+               io::HDF5Interface::close_file(h5);
+               benchmark::DoNotOptimize(x.data());
+             });
+  state.SetBytesProcessed(state.iterations() * dolfinx::MPI::size(comm)
+                          * num_rows * 3 * sizeof(double));
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
+BENCHMARK(hdf5_write)
+    ->RangeMultiplier(16)
+    ->Range(1 << 12, 1 << 20)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(hdf5_read)
+    ->RangeMultiplier(16)
+    ->Range(1 << 12, 1 << 20)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,59 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+//
+// Benchmarks for the construction of la::SparsityPattern
+
+#include "forms.h"
+#include "utils.h"
+#include <array>
+#include <benchmark/benchmark.h>
+#include <dolfinx/fem/DofMap.h>
+#include <dolfinx/fem/FunctionSpace.h>
+#include <dolfinx/fem/utils.h>
+#include <dolfinx/graph/AdjacencyList.h>
+#include <dolfinx/la/SparsityPattern.h>
+#include <dolfinx/mesh/Topology.h>
+
+using namespace dolfinx;
+
+namespace
+{
+
+void sparsity_pattern(benchmark::State& state)
+{
+  auto mesh = bench::create_mesh(state.range(0));
+  const int num_threads = state.range(1);
+  auto V = fem::create_functionspace(functionspace_form_forms_a, "u", mesh);
+  const fem::DofMap& dofmap = *V->dofmap();
+  const graph::AdjacencyList<std::int32_t>& dofs = dofmap.list();
+  const std::array maps{dofmap.index_map, dofmap.index_map};
+  const std::array bs{dofmap.index_map_bs(), dofmap.index_map_bs()};
+
+  // Insert the cell dofs and assemble, counting the entries per row in
+  // a first pass
+  bench::run(state, mesh->mpi_comm(),
+             [&]()
+             {
+               la::SparsityPattern pattern(mesh->mpi_comm(), maps, bs);
+               pattern.count_begin();
+               for (int pass = 0; pass < 2; ++pass)
+               {
+                 for (std::int32_t c = 0; c < dofs.num_nodes(); ++c)
+                   pattern.insert(dofs.links(c), dofs.links(c));
+                 if (pass == 0)
+                   pattern.count_end();
+               }
+               pattern.assemble(num_threads);
+               benchmark::DoNotOptimize(pattern.num_nonzeros());
+             });
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
+BENCHMARK(sparsity_pattern)
+    ->ArgsProduct({{16, 32, 64}, {1, 4}})
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
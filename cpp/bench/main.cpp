@@ -0,0 +1,61 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include <benchmark/benchmark.h>
+#include <dolfinx/common/subsystem.h>
+#include <mpi.h>
+#include <string>
+#include <vector>
+
+namespace
+{
+// Reporter that discards the results, for the processes other than
+// rank 0
+class NullReporter : public benchmark::BenchmarkReporter
+{
+public:
+  bool ReportContext(const Context&) override { return true; }
+  void ReportRuns(const std::vector<Run>&) override {}
+};
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  // The benchmarks of collective operations require MPI initialization
+  // before any benchmarks run and termination only after all
+  // benchmarks complete
+  dolfinx::common::subsystem::init_mpi(argc, argv);
+  dolfinx::common::subsystem::init_logging(argc, argv);
+
+  int rank = 0;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+  // Only rank 0 writes the output file (--benchmark_out)
+  std::vector<char*> args;
+  for (int i = 0; i < argc; ++i)
+  {
+    if (rank == 0 or std::string(argv[i]).rfind("--benchmark_out", 0) != 0)
+      args.push_back(argv[i]);
+  }
+  int num_args = args.size();
+  args.push_back(nullptr);
+
+  benchmark::Initialize(&num_args, args.data());
+  if (benchmark::ReportUnrecognizedArguments(num_args, args.data()))
+    return 1;
+
+  if (rank == 0)
+    benchmark::RunSpecifiedBenchmarks();
+  else
+  {
+    NullReporter reporter;
+    benchmark::RunSpecifiedBenchmarks(&reporter);
+  }
+
+  dolfinx::common::subsystem::finalize_mpi();
+
+  return 0;
+}
@@ -0,0 +1,69 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+//
+// Benchmarks for the computation of mesh entities and dual graphs
+
+#include "utils.h"
+#include <benchmark/benchmark.h>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/graph/AdjacencyList.h>
+#include <dolfinx/mesh/Topology.h>
+#include <dolfinx/mesh/graphbuild.h>
+#include <dolfinx/mesh/topologycomputation.h>
+#include <vector>
+
+using namespace dolfinx;
+
+namespace
+{
+
+void compute_entities(benchmark::State& state)
+{
+  auto mesh = bench::create_mesh(state.range(0));
+  const int dim = state.range(1);
+  const int num_threads = state.range(2);
+  bench::run(state, mesh->mpi_comm(),
+             [&]()
+             {
+               auto entities = mesh::compute_entities(
+                   mesh->mpi_comm(), mesh->topology(), dim, num_threads);
+               benchmark::DoNotOptimize(entities);
+             });
+}
+//-----------------------------------------------------------------------------
+void build_dual_graph(benchmark::State& state)
+{
+  auto mesh = bench::create_mesh(state.range(0));
+  const int num_threads = state.range(1);
+
+  // Cell-vertex connectivity with global vertex indices, as input to
+  // mesh creation
+  const mesh::Topology& topology = mesh->topology();
+  auto c_to_v = topology.connectivity(3, 0);
+  std::vector<std::int64_t> vertices(c_to_v->array().size());
+  topology.index_map(0)->local_to_global(c_to_v->array(), vertices);
+  const graph::AdjacencyList<std::int64_t> cells(std::move(vertices),
+                                                 c_to_v->offsets());
+
+  bench::run(state, mesh->mpi_comm(),
+             [&]()
+             {
+               auto graph = mesh::build_dual_graph(mesh->mpi_comm(), cells, 3,
+                                                   num_threads);
+               benchmark::DoNotOptimize(graph);
+             });
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
+BENCHMARK(compute_entities)
+    ->ArgsProduct({{16, 32}, {1, 2}, {1, 4}})
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(build_dual_graph)
+    ->ArgsProduct({{16, 32}, {1, 4}})
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
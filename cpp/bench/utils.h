@@ -0,0 +1,54 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <dolfinx/common/MPI.h>
+#include <dolfinx/generation/BoxMesh.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <dolfinx/mesh/cell_types.h>
+#include <dolfinx/mesh/utils.h>
+#include <memory>
+
+namespace dolfinx::bench
+{
+
+/// Create a mesh of the unit cube with `6 n^3` tetrahedra
+inline std::shared_ptr<mesh::Mesh>
+create_mesh(std::size_t n, mesh::GhostMode ghost_mode = mesh::GhostMode::none)
+{
+  return std::make_shared<mesh::Mesh>(generation::BoxMesh::create(
+      MPI_COMM_WORLD, {{{0.0, 0.0, 0.0}, {1.0, 1.0, 1.0}}}, {n, n, n},
+      mesh::CellType::tetrahedron, ghost_mode));
+}
+
+/// Run the iterations of a benchmark on all processes of a
+/// communicator. The processes are synchronised before each iteration,
+/// and the time of the iteration is the maximum time over the
+/// processes. All processes therefore run the same number of
+/// iterations, which is required when @p f is collective. Benchmarks
+/// that use this function must be registered with `UseManualTime()`.
+/// @param[in] state The benchmark state
+/// @param[in] comm The communicator
+/// @param[in] f The function to time
+template <typename F>
+void run(benchmark::State& state, MPI_Comm comm, F&& f)
+{
+  for (auto _ : state)
+  {
+    MPI_Barrier(comm);
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    auto t1 = std::chrono::steady_clock::now();
+    double t = std::chrono::duration<double>(t1 - t0).count();
+    MPI_Allreduce(MPI_IN_PLACE, &t, 1, MPI_DOUBLE, MPI_MAX, comm);
+    state.SetIterationTime(t);
+  }
+}
+
+} // namespace dolfinx::bench
@@ -0,0 +1,414 @@
+// Poisson scaling driver (C++)
+// ============================
+//
+// This driver runs the complete pipeline of the Poisson demo for a
+// configuration that is set at run time, to measure the weak and strong
+// scaling of DOLFINx. The phases of the pipeline are
+//
+// * mesh: generation and distribution of a mesh of the unit cube,
+//   excluding the cell partitioning
+// * partition: the cell partitioning
+// * topology: the facets and the exterior facets
+// * function space: the function space and the boundary condition dofs
+// * sparsity: the sparsity pattern and the allocation of the matrix
+// * assembly: the assembly of the matrix and vector
+// * solve: the solution of the linear system
+// * output: writing the solution to a VTK file
+//
+// The minimum, mean and maximum wall time of each phase over the
+// processes are printed and written, with the configuration and the
+// problem size, to a JSON file.
+//
+// The configuration is read from the PETSc options database:
+//
+// * ``-scaling weak|strong``: in weak scaling (default), ``-n`` is the
+//   number of cubes per process along each axis of the process grid
+//   (see ``MPI_Dims_create``), and in strong scaling it is the number of
+//   cubes along each axis of the mesh
+// * ``-n <n>``: the number of cubes along an axis (default 8). Each
+//   cube is divided into 6 tetrahedra or is one hexahedron.
+// * ``-degree <k>``: the degree of the Lagrange element, 1-3 for
+//   tetrahedra and 1-2 for hexahedra (default 1)
+// * ``-cell tetrahedron|hexahedron``: the cell type (default
+//   tetrahedron)
+// * ``-ghost_mode none|shared_facet|shared_vertex``: the ghost mode
+//   (default none)
+// * ``-partitioner default|scotch|parmetis|kahip|hierarchical|block``:
+//   the cell partitioner (default is the default graph partitioner).
+//   ``hierarchical`` is the compute node-aware partitioner, and
+//   ``block`` distributes a block of the grid to each process without
+//   graph partitioning (ghost mode none only).
+// * ``-ksp_type``, ``-pc_type``, ...: the PETSc solver (default
+//   conjugate gradients with algebraic multigrid)
+// * ``-timings <file>``: the JSON file (default scaling.json)
+// * ``-solution <file>``: the VTK file of the solution (default u.pvd)
+//
+// For example, for a weak scaling study with quadratic elements::
+//
+//     mpirun -np 64 ./demo_poisson_scaling -n 32 -degree 2 \
+//         -timings weak_64.json
+
+#include "poisson_scaling.h"
+#include <array>
+#include <dolfinx.h>
+#include <dolfinx/fem/petsc.h>
+#include <dolfinx/graph/kahip.h>
+#include <dolfinx/graph/parmetis.h>
+#include <dolfinx/graph/scotch.h>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace dolfinx;
+
+namespace
+{
+// Forms and function space of a cell type and degree
+struct PoissonForms
+{
+  ufc_form* a;
+  ufc_form* L;
+  ufc_function_space* (*V)(const char*);
+  std::string u;
+};
+
+#define POISSON_FORMS(s)                                                       \
+  PoissonForms{form_poisson_scaling_a_##s, form_poisson_scaling_L_##s,         \
+               functionspace_form_poisson_scaling_a_##s, "u_" #s}
+
+PoissonForms get_forms(const std::string& cell, int degree)
+{
+  if (cell == "tetrahedron" and degree == 1)
+    return POISSON_FORMS(tetrahedron_1);
+  else if (cell == "tetrahedron" and degree == 2)
+    return POISSON_FORMS(tetrahedron_2);
+  else if (cell == "tetrahedron" and degree == 3)
+    return POISSON_FORMS(tetrahedron_3);
+  else if (cell == "hexahedron" and degree == 1)
+    return POISSON_FORMS(hexahedron_1);
+  else if (cell == "hexahedron" and degree == 2)
+    return POISSON_FORMS(hexahedron_2);
+  throw std::runtime_error("No forms for cell type " + cell + " and degree "
+                           + std::to_string(degree));
+}
+
+// Get a string option from the PETSc options database
+std::string get_string(const std::string& name, const std::string& value)
+{
+  char buffer[PETSC_MAX_PATH_LEN];
+  PetscBool set = PETSC_FALSE;
+  PetscOptionsGetString(nullptr, nullptr, name.c_str(), buffer,
+                        sizeof(buffer), &set);
+  return set ? std::string(buffer) : value;
+}
+
+// Get an integer option from the PETSc options database
+PetscInt get_int(const std::string& name, PetscInt value)
+{
+  PetscBool set = PETSC_FALSE;
+  PetscInt v = 0;
+  PetscOptionsGetInt(nullptr, nullptr, name.c_str(), &v, &set);
+  return set ? v : value;
+}
+
+// Set a PETSc option if it is not set
+void set_default(const std::string& name, const std::string& value)
+{
+  PetscBool set = PETSC_FALSE;
+  PetscOptionsHasName(nullptr, nullptr, ("-" + name).c_str(), &set);
+  if (!set)
+    la::PETScOptions::set(name, value);
+}
+
+mesh::GhostMode get_ghost_mode(const std::string& ghost_mode)
+{
+  if (ghost_mode == "none")
+    return mesh::GhostMode::none;
+  else if (ghost_mode == "shared_facet")
+    return mesh::GhostMode::shared_facet;
+  else if (ghost_mode == "shared_vertex")
+    return mesh::GhostMode::shared_vertex;
+  throw std::runtime_error("Unknown ghost mode: " + ghost_mode);
+}
+
+// Get the cell partitioner of a name, except "block"
+mesh::CellPartitionFunction get_partitioner(const std::string& partitioner)
+{
+  if (partitioner == "default")
+  {
+    return static_cast<graph::AdjacencyList<std::int32_t> (*)(
+        MPI_Comm, int, int, const graph::AdjacencyList<std::int64_t>&,
+        mesh::GhostMode)>(&mesh::partition_cells_graph);
+  }
+  else if (partitioner == "scotch")
+    return mesh::create_cell_partitioner(graph::scotch::partitioner());
+#ifdef HAS_PARMETIS
+  else if (partitioner == "parmetis")
+    return mesh::create_cell_partitioner(graph::parmetis::partitioner());
+#endif
+#ifdef HAS_KAHIP
+  else if (partitioner == "kahip")
+    return mesh::create_cell_partitioner(graph::kahip::partitioner());
+#endif
+  else if (partitioner == "hierarchical")
+  {
+    return mesh::create_cell_partitioner(
+        graph::create_hierarchical_partitioner());
+  }
+  throw std::runtime_error("Unknown or unavailable partitioner: "
+                           + partitioner);
+}
+
+// Write the configuration, the problem size and the minimum, mean and
+// maximum time of each phase over the processes to a JSON file
+void write_timings(
+    const std::string& filename,
+    const std::vector<std::pair<std::string, std::string>>& parameters,
+    const std::vector<std::pair<std::string, std::int64_t>>& sizes,
+    const std::vector<std::string>& phases,
+    const std::array<std::vector<double>, 3>& t, int num_processes)
+{
+  std::ofstream file(filename);
+  if (!file)
+    throw std::runtime_error("Could not open file: " + filename);
+  file.precision(9);
+  file << "{\n  \"num_processes\": " << num_processes << ",\n";
+  file << "  \"parameters\": {";
+  for (std::size_t i = 0; i < parameters.size(); ++i)
+  {
+    file << (i == 0 ? "" : ", ") << "\"" << parameters[i].first << "\": \""
+         << parameters[i].second << "\"";
+  }
+  file << "},\n  \"sizes\": {";
+  for (std::size_t i = 0; i < sizes.size(); ++i)
+  {
+    file << (i == 0 ? "" : ", ") << "\"" << sizes[i].first
+         << "\": " << sizes[i].second;
+  }
+  file << "},\n  \"phases\": [\n";
+  for (std::size_t i = 0; i < phases.size(); ++i)
+  {
+    file << "    {\"name\": \"" << phases[i] << "\", \"min\": " << t[0][i]
+         << ", \"mean\": " << t[1][i] << ", \"max\": " << t[2][i] << "}"
+         << (i + 1 < phases.size() ? ",\n" : "\n");
+  }
+  file << "  ]\n}\n";
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  common::subsystem::init_logging(argc, argv);
+  common::subsystem::init_petsc(argc, argv);
+
+  {
+    MPI_Comm comm = MPI_COMM_WORLD;
+    const int size = dolfinx::MPI::size(comm);
+    const int rank = dolfinx::MPI::rank(comm);
+
+    // Read the configuration
+    const std::string scaling = get_string("-scaling", "weak");
+    const std::size_t n = get_int("-n", 8);
+    const int degree = get_int("-degree", 1);
+    const std::string cell = get_string("-cell", "tetrahedron");
+    const std::string ghost_mode = get_string("-ghost_mode", "none");
+    const std::string partitioner = get_string("-partitioner", "default");
+    const std::string timings = get_string("-timings", "scaling.json");
+    const std::string solution = get_string("-solution", "u.pvd");
+    set_default("ksp_type", "cg");
+    set_default("pc_type", "gamg");
+
+    const PoissonForms forms = get_forms(cell, degree);
+    const mesh::CellType cell_type = mesh::to_type(cell);
+    if (partitioner == "block" and ghost_mode != "none")
+    {
+      throw std::runtime_error(
+          "The block partitioner requires ghost mode none");
+    }
+
+    // Number of cubes along each axis
+    std::array<std::size_t, 3> num_cubes = {n, n, n};
+    if (scaling == "weak")
+    {
+      std::array<int, 3> dims = {0, 0, 0};
+      MPI_Dims_create(size, 3, dims.data());
+      for (int i = 0; i < 3; ++i)
+        num_cubes[i] *= dims[i];
+    }
+    else if (scaling != "strong")
+      throw std::runtime_error("Unknown scaling: " + scaling);
+
+    // Wall time of each phase of the pipeline on this process. The
+    // processes are synchronised at the start of each phase.
+    std::vector<std::string> phases;
+    std::vector<double> t;
+    auto time = [&phases, &t, comm](const std::string& phase, auto&& f)
+    {
+      MPI_Barrier(comm);
+      common::Timer timer("Scaling: " + phase);
+      f();
+      phases.push_back(phase);
+      t.push_back(timer.stop());
+    };
+
+    // Create the mesh, timing the cell partitioner separately
+    std::shared_ptr<mesh::Mesh> mesh;
+    double t_partition = 0.0;
+    time("mesh",
+         [&]()
+         {
+           const std::array<std::array<double, 3>, 2> p
+               = {{{0.0, 0.0, 0.0}, {1.0, 1.0, 1.0}}};
+           if (partitioner == "block")
+           {
+             mesh = std::make_shared<mesh::Mesh>(
+                 generation::BoxMesh::create_block(comm, p, num_cubes,
+                                                   cell_type));
+           }
+           else
+           {
+             mesh::CellPartitionFunction partfn = get_partitioner(partitioner);
+             auto timed_partfn
+                 = [&partfn, &t_partition](
+                       MPI_Comm _comm, int nparts, int tdim,
+                       const graph::AdjacencyList<std::int64_t>& cells,
+                       mesh::GhostMode _ghost_mode)
+             {
+               common::Timer timer("Scaling: partition");
+               auto dest = partfn(_comm, nparts, tdim, cells, _ghost_mode);
+               t_partition += timer.stop();
+               return dest;
+             };
+             mesh = std::make_shared<mesh::Mesh>(generation::BoxMesh::create(
+                 comm, p, num_cubes, cell_type, get_ghost_mode(ghost_mode),
+                 timed_partfn));
+           }
+         });
+    t.back() -= t_partition;
+    phases.push_back("partition");
+    t.push_back(t_partition);
+
+    time("topology",
+         [&]() { mesh->topology_mutable().create_boundary_facets(); });
+
+    std::shared_ptr<fem::FunctionSpace> V;
+    std::vector<std::shared_ptr<const fem::DirichletBC<PetscScalar>>> bcs;
+    time("function space",
+         [&]()
+         {
+           V = fem::create_functionspace(forms.V, forms.u, mesh);
+           const std::vector<std::int32_t>& facets
+               = *mesh->topology().boundary_facets();
+           auto u0 = std::make_shared<fem::Function<PetscScalar>>(V);
+           bcs.push_back(std::make_shared<const fem::DirichletBC<PetscScalar>>(
+               u0, fem::locate_dofs_topological(*V, 2, facets)));
+         });
+
+    auto a = std::make_shared<fem::Form<PetscScalar>>(
+        fem::create_form<PetscScalar>(*forms.a, {V, V}, {}, {}, {}));
+    auto L = std::make_shared<fem::Form<PetscScalar>>(
+        fem::create_form<PetscScalar>(*forms.L, {V}, {}, {}, {}));
+
+    std::unique_ptr<la::PETScMatrix> A;
+    time("sparsity",
+         [&]()
+         {
+           la::SparsityPattern pattern = fem::create_sparsity_pattern(*a);
+           pattern.assemble();
+           A = std::make_unique<la::PETScMatrix>(
+               la::create_petsc_matrix(comm, pattern), false);
+         });
+
+    la::PETScVector b(*V->dofmap()->index_map, V->dofmap()->index_map_bs());
+    time("assembly",
+         [&]()
+         {
+           MatZeroEntries(A->mat());
+           fem::assemble_matrix(
+               la::PETScMatrix::set_block_fn(A->mat(), ADD_VALUES), *a, bcs);
+           MatAssemblyBegin(A->mat(), MAT_FLUSH_ASSEMBLY);
+           MatAssemblyEnd(A->mat(), MAT_FLUSH_ASSEMBLY);
+           fem::set_diagonal(la::PETScMatrix::set_fn(A->mat(), INSERT_VALUES),
+                             *V, bcs);
+           MatAssemblyBegin(A->mat(), MAT_FINAL_ASSEMBLY);
+           MatAssemblyEnd(A->mat(), MAT_FINAL_ASSEMBLY);
+
+           VecSet(b.vec(), 0.0);
+           fem::assemble_vector_petsc(b.vec(), *L);
+           fem::apply_lifting_petsc(b.vec(), {a}, {{bcs}}, {}, 1.0);
+           VecGhostUpdateBegin(b.vec(), ADD_VALUES, SCATTER_REVERSE);
+           VecGhostUpdateEnd(b.vec(), ADD_VALUES, SCATTER_REVERSE);
+           fem::set_bc_petsc(b.vec(), bcs, nullptr);
+         });
+
+    fem::Function<PetscScalar> u(V);
+    int num_iterations = 0;
+    time("solve",
+         [&]()
+         {
+           la::PETScKrylovSolver solver(comm);
+           solver.set_from_options();
+           solver.set_operator(A->mat());
+           num_iterations = solver.solve(u.vector(), b.vec());
+         });
+
+    time("output",
+         [&]()
+         {
+           io::VTKFile file(comm, solution, "w");
+           file.write({u}, 0.0);
+         });
+
+    // Minimum, mean and maximum time of each phase over the processes
+    std::array<std::vector<double>, 3> t_reduced;
+    for (auto& tr : t_reduced)
+      tr.resize(t.size());
+    MPI_Reduce(t.data(), t_reduced[0].data(), t.size(), MPI_DOUBLE, MPI_MIN,
+               0, comm);
+    MPI_Reduce(t.data(), t_reduced[1].data(), t.size(), MPI_DOUBLE, MPI_SUM,
+               0, comm);
+    MPI_Reduce(t.data(), t_reduced[2].data(), t.size(), MPI_DOUBLE, MPI_MAX,
+               0, comm);
+    for (double& tr : t_reduced[1])
+      tr /= size;
+
+    const std::int64_t num_cells
+        = mesh->topology().index_map(3)->size_global();
+    const std::int64_t num_dofs = V->dofmap()->index_map->size_global()
+                                  * V->dofmap()->index_map_bs();
+    if (rank == 0)
+    {
+      Table table("Poisson scaling (" + std::to_string(size)
+                  + " processes): wall time [s]");
+      for (std::size_t i = 0; i < phases.size(); ++i)
+      {
+        table.set(phases[i], "min", t_reduced[0][i]);
+        table.set(phases[i], "mean", t_reduced[1][i]);
+        table.set(phases[i], "max", t_reduced[2][i]);
+      }
+      std::cout << table.str() << std::endl;
+      std::cout << "Cells: " << num_cells << ", dofs: " << num_dofs
+                << ", Krylov iterations: " << num_iterations << std::endl;
+
+      write_timings(
+          timings,
+          {{"scaling", scaling},
+           {"n", std::to_string(n)},
+           {"degree", std::to_string(degree)},
+           {"cell", cell},
+           {"ghost_mode", ghost_mode},
+           {"partitioner", partitioner},
+           {"ksp_type", get_string("-ksp_type", "")},
+           {"pc_type", get_string("-pc_type", "")}},
+          {{"num_cells", num_cells},
+           {"num_dofs", num_dofs},
+           {"krylov_iterations", num_iterations}},
+          phases, t_reduced, size);
+    }
+  }
+
+  common::subsystem::finalize_petsc();
+  return 0;
+}
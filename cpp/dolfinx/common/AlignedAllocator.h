@@ -0,0 +1,86 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <new>
+
+namespace dolfinx::common
+{
+
+/// Allocator for memory that is aligned to a given number of bytes.
+///
+/// It can be passed to containers such as la::Vector, array2d and
+/// la::MatrixCSR, so that the start of the data is aligned for (SIMD)
+/// loads and stores, e.g. to a cache line with the default alignment
+/// of 64 bytes.
+/// @tparam T The value type
+/// @tparam Alignment The alignment in bytes. Must be a power of two.
+template <typename T, std::size_t Alignment = 64>
+class AlignedAllocator
+{
+  static_assert(Alignment >= alignof(T), "Alignment is too small.");
+  static_assert((Alignment & (Alignment - 1)) == 0,
+                "Alignment must be a power of two.");
+
+public:
+  /// \cond DO_NOT_DOCUMENT
+  using value_type = T;
+
+  template <typename U>
+  struct rebind
+  {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+  /// \endcond
+
+  /// Create an allocator
+  AlignedAllocator() noexcept = default;
+
+  /// Create an allocator from an allocator of another value type
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept
+  {
+  }
+
+  /// Allocate aligned (uninitialised) memory for n values
+  /// @param[in] n The number of values
+  /// @return Pointer to the memory
+  T* allocate(std::size_t n)
+  {
+    if (n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+      throw std::bad_array_new_length();
+    return static_cast<T*>(
+        ::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+  }
+
+  /// Deallocate memory obtained from AlignedAllocator::allocate
+  /// @param[in] p Pointer to the memory
+  void deallocate(T* p, std::size_t) noexcept
+  {
+    ::operator delete(p, std::align_val_t(Alignment));
+  }
+};
+
+/// @cond
+template <typename T, typename U, std::size_t Alignment>
+bool operator==(const AlignedAllocator<T, Alignment>&,
+                const AlignedAllocator<U, Alignment>&) noexcept
+{
+  return true;
+}
+
+template <typename T, typename U, std::size_t Alignment>
+bool operator!=(const AlignedAllocator<T, Alignment>&,
+                const AlignedAllocator<U, Alignment>&) noexcept
+{
+  return false;
+}
+/// @endcond
+
+} // namespace dolfinx::common
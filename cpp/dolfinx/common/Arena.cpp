@@ -0,0 +1,153 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "Arena.h"
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+
+using namespace dolfinx;
+using namespace dolfinx::common;
+
+namespace
+{
+// Alignment of the start of each block
+constexpr std::size_t block_alignment = 64;
+
+// Offset from the start of a block of the first position after offset
+// that is aligned
+std::size_t align(const std::byte* data, std::size_t offset,
+                  std::size_t alignment)
+{
+  const std::uintptr_t p = reinterpret_cast<std::uintptr_t>(data) + offset;
+  return offset + (alignment - p % alignment) % alignment;
+}
+} // namespace
+
+//-----------------------------------------------------------------------------
+Arena::Arena(std::size_t block_size) : _block_size(block_size) {}
+//-----------------------------------------------------------------------------
+Arena::~Arena()
+{
+  for (Block& b : _blocks)
+    ::operator delete(b.data, std::align_val_t(block_alignment));
+}
+//-----------------------------------------------------------------------------
+std::size_t Arena::size() const { return _size; }
+//-----------------------------------------------------------------------------
+std::size_t Arena::peak() const { return _peak; }
+//-----------------------------------------------------------------------------
+std::size_t Arena::capacity() const
+{
+  std::size_t c = 0;
+  for (const Block& b : _blocks)
+    c += b.size;
+  return c;
+}
+//-----------------------------------------------------------------------------
+void Arena::release()
+{
+  if (_size > 0)
+    throw std::runtime_error("Cannot release an arena that is in use.");
+  for (Block& b : _blocks)
+    ::operator delete(b.data, std::align_val_t(block_alignment));
+  _blocks.clear();
+  _block = 0;
+  _offset = 0;
+}
+//-----------------------------------------------------------------------------
+void* Arena::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+  while (true)
+  {
+    // Allocate from the current block
+    if (_block < _blocks.size())
+    {
+      const Block& b = _blocks[_block];
+      if (const std::size_t start = align(b.data, _offset, alignment);
+          start + bytes <= b.size)
+      {
+        _size += start + bytes - _offset;
+        _peak = std::max(_peak, _size);
+        _offset = start + bytes;
+        return b.data + start;
+      }
+    }
+
+    // Move to the next (unused) block if the allocation fits, or else
+    // free the unused blocks that are too small
+    if (_block + 1 < _blocks.size())
+    {
+      const Block& b = _blocks[_block + 1];
+      if (align(b.data, 0, alignment) + bytes <= b.size)
+      {
+        ++_block;
+        _offset = 0;
+        continue;
+      }
+
+      for (auto it = std::next(_blocks.begin(), _block + 1);
+           it != _blocks.end(); ++it)
+      {
+        ::operator delete(it->data, std::align_val_t(block_alignment));
+      }
+      _blocks.erase(std::next(_blocks.begin(), _block + 1), _blocks.end());
+    }
+
+    // Add a block
+    const std::size_t size = std::max(_block_size, bytes + alignment);
+    _blocks.push_back({static_cast<std::byte*>(::operator new(
+                           size, std::align_val_t(block_alignment))),
+                       size});
+    _block = _blocks.size() - 1;
+    _offset = 0;
+  }
+}
+//-----------------------------------------------------------------------------
+void Arena::do_deallocate(void* p, std::size_t bytes, std::size_t)
+{
+  // Return the memory of the most recent allocation
+  if (_block < _blocks.size())
+  {
+    std::byte* data = _blocks[_block].data;
+    if (static_cast<std::byte*>(p) + bytes == data + _offset)
+    {
+      const std::size_t start = static_cast<std::byte*>(p) - data;
+      _size -= _offset - start;
+      _offset = start;
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+bool Arena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+  return this == &other;
+}
+//-----------------------------------------------------------------------------
+ArenaScope::ArenaScope(Arena& arena)
+    : _arena(arena), _block(arena._block), _offset(arena._offset),
+      _size(arena._size)
+{
+}
+//-----------------------------------------------------------------------------
+ArenaScope::ArenaScope() : ArenaScope(scratch_arena()) {}
+//-----------------------------------------------------------------------------
+ArenaScope::~ArenaScope()
+{
+  _arena._block = _block;
+  _arena._offset = _offset;
+  _arena._size = _size;
+}
+//-----------------------------------------------------------------------------
+std::pmr::memory_resource* ArenaScope::resource() const { return &_arena; }
+//-----------------------------------------------------------------------------
+Arena& common::scratch_arena()
+{
+  thread_local Arena arena;
+  return arena;
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,126 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+namespace dolfinx::common
+{
+
+/// A memory resource for temporary buffers, which allocates from large
+/// blocks by incrementing an offset.
+///
+/// Memory is released in bulk when an ArenaScope ends. The blocks are
+/// kept and re-used by later scopes, so a sequence of setup phases that
+/// each allocate large temporary arrays re-uses the same memory rather
+/// than fragmenting the heap. Deallocation of the most recent
+/// allocation returns its memory to the arena, other deallocations do
+/// nothing until the scope ends.
+///
+/// Temporaries should be sized on creation (e.g. `std::pmr::vector`
+/// with a size), since memory of arrays that grow is only released at
+/// the end of a scope.
+///
+/// @note An arena is not thread safe. Each thread has its own arena,
+/// see common::scratch_arena, and the containers that use it must be
+/// created and destroyed by the same thread.
+class Arena : public std::pmr::memory_resource
+{
+public:
+  /// Create an arena
+  /// @param[in] block_size The minimum size (bytes) of a block
+  explicit Arena(std::size_t block_size = std::size_t(1) << 22);
+
+  /// Copy constructor
+  Arena(const Arena& arena) = delete;
+
+  /// Destructor
+  ~Arena();
+
+  /// Assignment operator
+  Arena& operator=(const Arena& arena) = delete;
+
+  /// Number of bytes that are allocated
+  std::size_t size() const;
+
+  /// Largest number of bytes that have been allocated at once
+  std::size_t peak() const;
+
+  /// Number of bytes in the blocks of the arena
+  std::size_t capacity() const;
+
+  /// Free the blocks of the arena, e.g. after the setup of a mesh
+  /// @note There must be no allocated memory, i.e. no open ArenaScope
+  void release();
+
+private:
+  friend class ArenaScope;
+
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+  void do_deallocate(void* p, std::size_t bytes,
+                     std::size_t alignment) override;
+  bool do_is_equal(const std::pmr::memory_resource& other) const
+      noexcept override;
+
+  // Minimum block size
+  std::size_t _block_size;
+
+  struct Block
+  {
+    std::byte* data;
+    std::size_t size;
+  };
+  std::vector<Block> _blocks;
+
+  // Current block and the offset in the block, number of allocated
+  // bytes and the peak number
+  std::size_t _block = 0, _offset = 0, _size = 0, _peak = 0;
+};
+
+/// A scope of allocations from an arena. The allocations from the arena
+/// that are made during the scope are released when the scope ends.
+///
+/// The scope must be created before the containers that use it, so that
+/// they are destroyed first:
+/// @code
+/// common::ArenaScope scope;
+/// std::pmr::vector<std::int32_t> offsets(n + 1, 0, scope.resource());
+/// @endcode
+class ArenaScope
+{
+public:
+  /// Open a scope
+  /// @param[in] arena The arena
+  explicit ArenaScope(Arena& arena);
+
+  /// Open a scope of the arena of the calling thread
+  ArenaScope();
+
+  /// Copy constructor
+  ArenaScope(const ArenaScope& scope) = delete;
+
+  /// Destructor. Releases the allocations of the scope.
+  ~ArenaScope();
+
+  /// Assignment operator
+  ArenaScope& operator=(const ArenaScope& scope) = delete;
+
+  /// The memory resource to allocate from
+  std::pmr::memory_resource* resource() const;
+
+private:
+  Arena& _arena;
+  std::size_t _block, _offset, _size;
+};
+
+/// Get the arena for temporary buffers of the calling thread
+/// @return The arena
+Arena& scratch_arena();
+
+} // namespace dolfinx::common
@@ -8,7 +8,6 @@
 #include <algorithm>
 #include <functional>
 #include <numeric>
-#include <unordered_map>
 
 using namespace dolfinx;
 using namespace dolfinx::common;
@@ -162,6 +161,31 @@ compute_asymmetric_communicators(MPI_Comm comm,
   return comms;
 }
 //-----------------------------------------------------------------------------
+/// Create a neighborhood communicator with the union of the in- and
+/// out-edges of an owner-to-ghost communicator as both in- and
+/// out-edges
+/// @note Collective
+MPI_Comm compute_symmetric_communicator(MPI_Comm comm_owner_to_ghost)
+{
+  int indegree(-1), outdegree(-2), weighted(-1);
+  MPI_Dist_graph_neighbors_count(comm_owner_to_ghost, &indegree, &outdegree,
+                                 &weighted);
+  std::vector<int> neighbors(indegree + outdegree);
+  MPI_Dist_graph_neighbors(comm_owner_to_ghost, indegree, neighbors.data(),
+                           MPI_UNWEIGHTED, outdegree,
+                           neighbors.data() + indegree, MPI_UNWEIGHTED);
+  std::sort(neighbors.begin(), neighbors.end());
+  neighbors.erase(std::unique(neighbors.begin(), neighbors.end()),
+                  neighbors.end());
+
+  MPI_Comm comm;
+  MPI_Dist_graph_create_adjacent(
+      comm_owner_to_ghost, neighbors.size(), neighbors.data(), MPI_UNWEIGHTED,
+      neighbors.size(), neighbors.data(), MPI_UNWEIGHTED, MPI_INFO_NULL, false,
+      &comm);
+  return comm;
+}
+//-----------------------------------------------------------------------------
 } // namespace
 
 //-----------------------------------------------------------------------------
@@ -186,96 +210,56 @@ common::stack_index_maps(
     local_offset[f] = local_offset[f - 1] + bs * local_size;
   }
 
-  // Pack old and new composite indices for owned entries that are ghost
-  // on other ranks
-  std::vector<std::int64_t> indices;
+  // The composite index of owned index i (in block j) of map f on a
+  // rank is shift[f] + bs * (i + local_range[0]) + j. Each owner sends
+  // its shift for map f to the ranks that ghost its indices. The
+  // exchanges for the maps are started together and are small (one
+  // value per neighbor), and no communicator is created.
+  std::vector<std::int64_t> shift(maps.size());
+  std::vector<std::vector<std::int64_t>> recv_shift(maps.size());
+  std::vector<std::vector<int>> src_ranks(maps.size());
+  std::vector<MPI_Request> requests(maps.size());
   for (std::size_t f = 0; f < maps.size(); ++f)
   {
+    const common::IndexMap& map = maps[f].first.get();
     const int bs = maps[f].second;
-    const std::vector<std::int32_t>& forward_indices
-        = maps[f].first.get().shared_indices().array();
-    const std::int64_t offset = bs * maps[f].first.get().local_range()[0];
-    for (std::int32_t local_index : forward_indices)
-    {
-      for (std::int32_t i = 0; i < bs; ++i)
-      {
-        // Insert field index, global index, composite global index
-        indices.push_back(f);
-        indices.push_back(bs * local_index + i + offset);
-        indices.push_back(bs * local_index + i + local_offset[f]
-                          + process_offset);
-      }
-    }
-  }
+    shift[f] = process_offset + local_offset[f] - bs * map.local_range()[0];
 
-  // Build arrays of incoming and outcoming neighborhood ranks
-  std::set<std::int32_t> in_neighbor_set, out_neighbor_set;
-  for (auto& map : maps)
-  {
-    MPI_Comm neighbor_comm = map.first.get().comm(IndexMap::Direction::forward);
-    auto [source, dest] = dolfinx::MPI::neighbors(neighbor_comm);
-    in_neighbor_set.insert(source.begin(), source.end());
-    out_neighbor_set.insert(dest.begin(), dest.end());
+    MPI_Comm comm = map.comm(IndexMap::Direction::forward);
+    src_ranks[f] = std::get<0>(dolfinx::MPI::neighbors(comm));
+    recv_shift[f].resize(src_ranks[f].size());
+    MPI_Ineighbor_allgather(&shift[f], 1, MPI_INT64_T, recv_shift[f].data(),
+                            1, MPI_INT64_T, comm, &requests[f]);
   }
+  MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
 
-  const std::vector<int> in_neighbors(in_neighbor_set.begin(),
-                                      in_neighbor_set.end());
-  const std::vector<int> out_neighbors(out_neighbor_set.begin(),
-                                       out_neighbor_set.end());
-
-  // Create neighborhood communicator
-  MPI_Comm comm;
-  MPI_Dist_graph_create_adjacent(
-      maps.at(0).first.get().comm(IndexMap::Direction::forward),
-      in_neighbors.size(), in_neighbors.data(), MPI_UNWEIGHTED,
-      out_neighbors.size(), out_neighbors.data(), MPI_UNWEIGHTED, MPI_INFO_NULL,
-      false, &comm);
-
-  int indegree(-1), outdegree(-2), weighted(-1);
-  MPI_Dist_graph_neighbors_count(comm, &indegree, &outdegree, &weighted);
-
-  // Figure out how much data to receive from each neighbor
-  const int num_my_rows = indices.size();
-  std::vector<int> num_rows_recv(indegree);
-  MPI_Neighbor_allgather(&num_my_rows, 1, MPI_INT, num_rows_recv.data(), 1,
-                         MPI_INT, comm);
-
-  // Compute displacements for data to receive
-  std::vector<int> disp(indegree + 1, 0);
-  std::partial_sum(num_rows_recv.begin(), num_rows_recv.end(),
-                   disp.begin() + 1);
-
-  // Send data to neighbors, and receive data
-  std::vector<std::int64_t> data_recv(disp.back());
-  MPI_Neighbor_allgatherv(indices.data(), indices.size(), MPI_INT64_T,
-                          data_recv.data(), num_rows_recv.data(), disp.data(),
-                          MPI_INT64_T, comm);
-
-  // Destroy communicator
-  MPI_Comm_free(&comm);
-
-  // Create map (old global index -> new global index) for each field
-  std::vector<std::map<int64_t, std::int64_t>> ghost_maps(maps.size());
-  for (std::size_t i = 0; i < data_recv.size(); i += 3)
-    ghost_maps[data_recv[i]].insert({data_recv[i + 1], data_recv[i + 2]});
-
-  /// Build arrays from old ghost index to composite ghost index for
-  /// each field
+  // Compute composite ghost index from the shift of the ghost owner for
+  // each field
   std::vector<std::vector<std::int64_t>> ghosts_new(maps.size());
   std::vector<std::vector<int>> ghost_owners_new(maps.size());
   for (std::size_t f = 0; f < maps.size(); ++f)
   {
+    // Map from owner rank to the shift of the owner
+    std::vector<std::pair<int, std::int64_t>> rank_to_shift;
+    for (std::size_t i = 0; i < src_ranks[f].size(); ++i)
+      rank_to_shift.push_back({src_ranks[f][i], recv_shift[f][i]});
+    std::sort(rank_to_shift.begin(), rank_to_shift.end());
+
     const int bs = maps[f].second;
     const std::vector<std::int64_t>& ghosts = maps[f].first.get().ghosts();
-    const std::vector<int>& ghost_owners
+    const std::vector<int> ghost_owners
         = maps[f].first.get().ghost_owner_rank();
+    ghosts_new[f].reserve(bs * ghosts.size());
+    ghost_owners_new[f].reserve(bs * ghosts.size());
     for (std::size_t i = 0; i < ghosts.size(); ++i)
     {
+      auto it = std::lower_bound(
+          rank_to_shift.begin(), rank_to_shift.end(), ghost_owners[i],
+          [](auto& a, int r) { return a.first < r; });
+      assert(it != rank_to_shift.end() and it->first == ghost_owners[i]);
       for (int j = 0; j < bs; ++j)
       {
-        auto it = ghost_maps[f].find(bs * ghosts[i] + j);
-        assert(it != ghost_maps[f].end());
-        ghosts_new[f].push_back(it->second);
+        ghosts_new[f].push_back(it->second + bs * ghosts[i] + j);
         ghost_owners_new[f].push_back(ghost_owners[i]);
       }
     }
@@ -285,9 +269,62 @@ common::stack_index_maps(
           std::move(ghost_owners_new)};
 }
 //-----------------------------------------------------------------------------
+std::vector<int> common::stack_dest_ranks(
+    const std::vector<
+        std::pair<std::reference_wrapper<const common::IndexMap>, int>>& maps)
+{
+  std::vector<int> dest_ranks;
+  for (auto& map : maps)
+  {
+    const std::vector<int> ranks = std::get<1>(dolfinx::MPI::neighbors(
+        map.first.get().comm(IndexMap::Direction::forward)));
+    dest_ranks.insert(dest_ranks.end(), ranks.begin(), ranks.end());
+  }
+  std::sort(dest_ranks.begin(), dest_ranks.end());
+  dest_ranks.erase(std::unique(dest_ranks.begin(), dest_ranks.end()),
+                   dest_ranks.end());
+  return dest_ranks;
+}
+//-----------------------------------------------------------------------------
+std::vector<std::int64_t> common::stack_local_to_global(
+    const std::vector<
+        std::pair<std::reference_wrapper<const common::IndexMap>, int>>& maps,
+    const IndexMap& map)
+{
+  std::size_t size = 0;
+  for (auto& m : maps)
+  {
+    const IndexMap& map_m = m.first.get();
+    size += m.second * (map_m.size_local() + map_m.num_ghosts());
+  }
+  std::vector<std::int64_t> global;
+  global.reserve(size);
+
+  const std::int64_t offset = map.local_range()[0];
+  const std::vector<std::int64_t>& ghosts = map.ghosts();
+  std::int64_t owned = offset;
+  auto ghost = ghosts.begin();
+  for (auto& m : maps)
+  {
+    const int bs = m.second;
+    const std::int32_t size_local = bs * m.first.get().size_local();
+    const std::int32_t num_ghosts = bs * m.first.get().num_ghosts();
+    for (std::int32_t i = 0; i < size_local; ++i)
+      global.push_back(owned++);
+    assert(std::distance(ghost, ghosts.end()) >= num_ghosts);
+    global.insert(global.end(), ghost, std::next(ghost, num_ghosts));
+    std::advance(ghost, num_ghosts);
+  }
+  assert(ghost == ghosts.end());
+  assert(owned == map.local_range()[1]);
+
+  return global;
+}
+//-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 IndexMap::IndexMap(MPI_Comm comm, std::int32_t local_size)
-    : _comm_owner_to_ghost(MPI_COMM_NULL), _comm_ghost_to_owner(MPI_COMM_NULL)
+    : _comm_owner_to_ghost(MPI_COMM_NULL), _comm_ghost_to_owner(MPI_COMM_NULL),
+      _comm_symmetric(MPI_COMM_NULL)
 {
   // Get global offset (index), using partial exclusive reduction
   std::int64_t offset = 0;
@@ -320,6 +357,8 @@ IndexMap::IndexMap(MPI_Comm comm, std::int32_t local_size)
                                  weights.data(), MPI_INFO_NULL, false, &comm1);
   _comm_owner_to_ghost = dolfinx::MPI::Comm(comm0, false);
   _comm_ghost_to_owner = dolfinx::MPI::Comm(comm1, false);
+  _comm_symmetric = dolfinx::MPI::Comm(
+      compute_symmetric_communicator(_comm_owner_to_ghost.comm()), false);
   _shared_indices = std::make_unique<graph::AdjacencyList<std::int32_t>>(0);
 }
 //-----------------------------------------------------------------------------
@@ -328,7 +367,7 @@ IndexMap::IndexMap(MPI_Comm mpi_comm, std::int32_t local_size,
                    const xtl::span<const std::int64_t>& ghosts,
                    const xtl::span<const int>& src_ranks)
     : _comm_owner_to_ghost(MPI_COMM_NULL), _comm_ghost_to_owner(MPI_COMM_NULL),
-      _ghosts(ghosts.begin(), ghosts.end())
+      _comm_symmetric(MPI_COMM_NULL), _ghosts(ghosts.begin(), ghosts.end())
 {
   assert(size_t(ghosts.size()) == src_ranks.size());
   assert(std::equal(src_ranks.begin(), src_ranks.end(),
@@ -383,6 +422,8 @@ IndexMap::IndexMap(MPI_Comm mpi_comm, std::int32_t local_size,
       = compute_asymmetric_communicators(mpi_comm, halo_src_ranks, dest_ranks);
   _comm_owner_to_ghost = dolfinx::MPI::Comm(comm_array[0], false);
   _comm_ghost_to_owner = dolfinx::MPI::Comm(comm_array[1], false);
+  _comm_symmetric = dolfinx::MPI::Comm(
+      compute_symmetric_communicator(_comm_owner_to_ghost.comm()), false);
 
   // Compute owned indices which are ghosted by other ranks, and how
   // many of my indices each neighbor ghosts
@@ -393,6 +434,20 @@ IndexMap::IndexMap(MPI_Comm mpi_comm, std::int32_t local_size,
   MPI_Wait(&request_scan, MPI_STATUS_IGNORE);
   _local_range = {offset, offset + local_size};
 
+  // Sort ghosts for global-to-local lookups
+  std::vector<std::int32_t> perm(_ghosts.size());
+  std::iota(perm.begin(), perm.end(), 0);
+  std::sort(perm.begin(), perm.end(),
+            [&ghosts = std::as_const(_ghosts)](auto a, auto b)
+            { return ghosts[a] < ghosts[b]; });
+  _ghosts_sorted.resize(perm.size());
+  _ghosts_sorted_local.resize(perm.size());
+  for (std::size_t i = 0; i < perm.size(); ++i)
+  {
+    _ghosts_sorted[i] = _ghosts[perm[i]];
+    _ghosts_sorted_local[i] = local_size + perm[i];
+  }
+
   // Convert owned global indices that are ghosts on another rank to
   // local indexing
   std::vector<std::int32_t> local_shared_ind(shared_ind.size());
@@ -478,14 +533,7 @@ void IndexMap::local_to_global(const xtl::span<const std::int32_t>& local,
 void IndexMap::global_to_local(const xtl::span<const std::int64_t>& global,
                                const xtl::span<std::int32_t>& local) const
 {
-  const std::int32_t local_size = _local_range[1] - _local_range[0];
-
-  std::vector<std::pair<std::int64_t, std::int32_t>> global_local_ghosts;
-  for (std::size_t i = 0; i < _ghosts.size(); ++i)
-    global_local_ghosts.emplace_back(_ghosts[i], i + local_size);
-
-  std::map<std::int64_t, std::int32_t> global_to_local(
-      global_local_ghosts.begin(), global_local_ghosts.end());
+  assert(local.size() >= global.size());
   for (std::size_t i = 0; i < global.size(); i++)
   {
     std::int64_t index = global[i];
@@ -493,8 +541,13 @@ void IndexMap::global_to_local(const xtl::span<const std::int64_t>& global,
       local[i] = index - _local_range[0];
     else
     {
-      if (auto it = global_to_local.find(index); it != global_to_local.end())
-        local[i] = it->second;
+      auto it = std::lower_bound(_ghosts_sorted.begin(), _ghosts_sorted.end(),
+                                 index);
+      if (it != _ghosts_sorted.end() and *it == index)
+      {
+        local[i] = _ghosts_sorted_local[std::distance(_ghosts_sorted.begin(),
+                                                      it)];
+      }
       else
         local[i] = -1;
     }
@@ -550,7 +603,12 @@ MPI_Comm IndexMap::comm(Direction dir) const
   }
 }
 //----------------------------------------------------------------------------
-std::map<std::int32_t, std::set<int>> IndexMap::compute_shared_indices() const
+MPI_Comm IndexMap::comm_symmetric() const
+{
+  return _comm_symmetric.comm();
+}
+//----------------------------------------------------------------------------
+graph::AdjacencyList<int> IndexMap::compute_sharing_ranks() const
 {
   // Get number of neighbors and neighbor ranks
   int indegree(-1), outdegree(-2), weighted(-1);
@@ -561,15 +619,22 @@ std::map<std::int32_t, std::set<int>> IndexMap::compute_shared_indices() const
                            neighbors_in.data(), MPI_UNWEIGHTED, outdegree,
                            neighbors_out.data(), MPI_UNWEIGHTED);
 
-  std::map<std::int32_t, std::set<int>> shared_indices;
-
-  // Build map from owned local index to ranks that ghost the index
+  // (local index, rank) pairs for owned indices and the ranks that
+  // ghost them, sorted by index
+  std::vector<std::pair<std::int32_t, int>> index_rank;
   for (std::int32_t p = 0; p < _shared_indices->num_nodes(); ++p)
   {
     const int rank_global = neighbors_out[p];
-    for (const std::int32_t& idx : _shared_indices->links(p))
-      shared_indices[idx].insert(rank_global);
+    for (std::int32_t idx : _shared_indices->links(p))
+      index_rank.push_back({idx, rank_global});
   }
+  std::sort(index_rank.begin(), index_rank.end());
+
+  const std::int32_t size_local = this->size_local();
+  std::vector<std::int32_t> offsets(size_local + 1, 0);
+  for (auto& q : index_rank)
+    ++offsets[q.first + 1];
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
 
   // Ghost indices know the owner rank, but they don't know about other
   // ranks that also ghost the index. If an index is a ghost on more
@@ -580,20 +645,17 @@ std::map<std::int32_t, std::set<int>> IndexMap::compute_shared_indices() const
   std::vector<int> fwd_sharing_offsets{0};
   for (std::int32_t p = 0; p < _shared_indices->num_nodes(); ++p)
   {
-    for (const std::int32_t& idx : _shared_indices->links(p))
+    for (std::int32_t idx : _shared_indices->links(p))
     {
-      assert(shared_indices.find(idx) != shared_indices.end());
-      if (auto it = shared_indices.find(idx); it->second.size() > 1)
+      if (const int num_ranks = offsets[idx + 1] - offsets[idx];
+          num_ranks > 1)
       {
-        // Add global index
+        // Add global index, number of sharing ranks and the sharing
+        // ranks
         fwd_sharing_data.push_back(idx + _local_range[0]);
-
-        // Add number of sharing ranks
-        fwd_sharing_data.push_back(shared_indices[idx].size());
-
-        // Add sharing ranks
-        fwd_sharing_data.insert(fwd_sharing_data.end(), it->second.begin(),
-                                it->second.end());
+        fwd_sharing_data.push_back(num_ranks);
+        for (std::int32_t k = offsets[idx]; k < offsets[idx + 1]; ++k)
+          fwd_sharing_data.push_back(index_rank[k].second);
       }
     }
 
@@ -631,15 +693,8 @@ std::map<std::int32_t, std::set<int>> IndexMap::compute_shared_indices() const
       MPI_INT64_T, _comm_owner_to_ghost.comm(), &request);
 
   // For my ghosts, add owning rank to list of sharing ranks
-  const std::int32_t size_local = this->size_local();
   for (std::size_t i = 0; i < _ghosts.size(); ++i)
-    shared_indices[size_local + i].insert(neighbors_in[_ghost_owners[i]]);
-
-  // Build map from global index to local index for ghosts
-  std::unordered_map<std::int64_t, std::int32_t> ghosts;
-  ghosts.reserve(_ghosts.size());
-  for (std::size_t i = 0; i < _ghosts.size(); ++i)
-    ghosts.emplace(_ghosts[i], i + size_local);
+    index_rank.push_back({size_local + i, neighbors_in[_ghost_owners[i]]});
 
   // Wait for all-to-all to complete
   MPI_Wait(&request, MPI_STATUS_IGNORE);
@@ -649,18 +704,121 @@ std::map<std::int32_t, std::set<int>> IndexMap::compute_shared_indices() const
   MPI_Comm_rank(_comm_owner_to_ghost.comm(), &myrank);
   for (std::size_t i = 0; i < recv_data.size();)
   {
-    auto it = ghosts.find(recv_data[i]);
-    assert(it != ghosts.end());
-    const std::int32_t idx = it->second;
+    std::int32_t idx = -1;
+    global_to_local(xtl::span<const std::int64_t>(&recv_data[i], 1),
+                    xtl::span<std::int32_t>(&idx, 1));
+    assert(idx >= size_local);
     const int set_size = recv_data[i + 1];
     for (int j = 0; j < set_size; j++)
     {
       if (recv_data[i + 2 + j] != myrank)
-        shared_indices[idx].insert(recv_data[i + 2 + +j]);
+        index_rank.push_back({idx, recv_data[i + 2 + j]});
     }
     i += set_size + 2;
   }
 
-  return shared_indices;
+  // Build adjacency list with the sorted ranks of each index
+  std::sort(index_rank.begin(), index_rank.end());
+  index_rank.erase(std::unique(index_rank.begin(), index_rank.end()),
+                   index_rank.end());
+  std::vector<std::int32_t> rank_offsets(size_local + _ghosts.size() + 1, 0);
+  std::vector<int> ranks(index_rank.size());
+  for (std::size_t i = 0; i < index_rank.size(); ++i)
+  {
+    ++rank_offsets[index_rank[i].first + 1];
+    ranks[i] = index_rank[i].second;
+  }
+  std::partial_sum(rank_offsets.begin(), rank_offsets.end(),
+                   rank_offsets.begin());
+
+  return graph::AdjacencyList<int>(std::move(ranks), std::move(rank_offsets));
 }
-//-----------------------------------------------------------------------------
\ No newline at end of file
+//-----------------------------------------------------------------------------
+std::size_t IndexMap::memory_usage() const
+{
+  std::size_t size = 0;
+  for (auto v : {&_sizes_recv_fwd, &_sizes_send_fwd, &_displs_recv_fwd})
+    size += v->capacity() * sizeof(int);
+  for (auto v : {&_ghosts, &_ghosts_sorted})
+    size += v->capacity() * sizeof(std::int64_t);
+  for (auto v : {&_ghosts_sorted_local, &_ghost_owners})
+    size += v->capacity() * sizeof(std::int32_t);
+  if (_shared_indices)
+    size += _shared_indices->memory_usage();
+  return size;
+}
+//-----------------------------------------------------------------------------
+std::pair<IndexMap, std::vector<std::int32_t>>
+common::create_sub_index_map(const IndexMap& map,
+                             const xtl::span<const std::int32_t>& indices)
+{
+  assert(std::is_sorted(indices.begin(), indices.end()));
+  MPI_Comm comm = map.comm(IndexMap::Direction::forward);
+  const std::int32_t size_local = map.size_local();
+
+  // The owned indices are at the start of the (sorted) list
+  const auto it_ghost
+      = std::lower_bound(indices.begin(), indices.end(), size_local);
+  const std::int32_t num_owned = std::distance(indices.begin(), it_ghost);
+
+  // Global offset of the owned indices of the sub-map
+  std::int64_t offset = 0;
+  const std::int64_t num_owned_tmp = num_owned;
+  MPI_Exscan(&num_owned_tmp, &offset, 1, MPI_INT64_T, MPI_SUM, comm);
+
+  // Send the global index in the sub-map of each owned index (-1 if not
+  // in the sub-map) to the ranks that ghost it
+  std::vector<std::int64_t> global_owned(size_local, -1);
+  for (std::int32_t i = 0; i < num_owned; ++i)
+    global_owned[indices[i]] = offset + i;
+  std::vector<std::int64_t> global_ghost(map.num_ghosts());
+  map.scatter_fwd(xtl::span<const std::int64_t>(global_owned),
+                  xtl::span<std::int64_t>(global_ghost), 1);
+
+  // Keep the ghosts that are in the sub-map of their owner
+  const std::vector<int> ghost_owners = map.ghost_owner_rank();
+  std::vector<std::int32_t> sub_to_parent(indices.begin(), it_ghost);
+  std::vector<std::int64_t> ghosts;
+  std::vector<int> ghost_ranks;
+  for (auto it = it_ghost; it != indices.end(); ++it)
+  {
+    const std::int32_t g = *it - size_local;
+    if (global_ghost[g] >= 0)
+    {
+      sub_to_parent.push_back(*it);
+      ghosts.push_back(global_ghost[g]);
+      ghost_ranks.push_back(ghost_owners[g]);
+    }
+  }
+
+  // Flag the owners of the ghosts of the sub-map, and receive the flags
+  // of the ranks that ghost indices of this rank, to compute the ranks
+  // that ghost indices of the sub-map owned by this rank
+  MPI_Comm comm_rev = map.comm(IndexMap::Direction::reverse);
+  const auto [src_ranks, dest_ranks] = dolfinx::MPI::neighbors(comm_rev);
+  std::vector<int> send_flags(dest_ranks.size(), 0);
+  std::vector<int> recv_flags(src_ranks.size(), 0);
+  for (int r : ghost_ranks)
+  {
+    auto it = std::find(dest_ranks.begin(), dest_ranks.end(), r);
+    assert(it != dest_ranks.end());
+    send_flags[std::distance(dest_ranks.begin(), it)] = 1;
+  }
+
+  // A rank in the neighborhood communicator can have no incoming or
+  // outcoming edges. This may cause OpenMPI to crash. Workaround:
+  if (send_flags.empty())
+    send_flags.reserve(1);
+  if (recv_flags.empty())
+    recv_flags.reserve(1);
+  MPI_Neighbor_alltoall(send_flags.data(), 1, MPI_INT, recv_flags.data(), 1,
+                        MPI_INT, comm_rev);
+  std::vector<int> sub_dest_ranks;
+  for (std::size_t i = 0; i < src_ranks.size(); ++i)
+    if (recv_flags[i] > 0)
+      sub_dest_ranks.push_back(src_ranks[i]);
+
+  return {IndexMap(comm, num_owned, sub_dest_ranks, ghosts, ghost_ranks),
+          std::move(sub_to_parent)};
+}
+//-----------------------------------------------------------------------------
@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include "utils.h"
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <dolfinx/common/MPI.h>
@@ -23,8 +25,9 @@ namespace dolfinx::common
 class IndexMap;
 
 /// Compute layout data and ghost indices for a stacked (concatenated)
-/// index map, i.e. 'splice' multiple maps into one. Communication is
-/// required to compute the new ghost indices.
+/// index map, i.e. 'splice' multiple maps into one. Communication with
+/// the neighbors of each map (one value per neighbor) is required to
+/// compute the new ghost indices.
 ///
 /// @param[in] maps List of (index map, block size) pairs
 /// @returns The (0) global offset of a stacked map for this rank, (1)
@@ -38,6 +41,29 @@ stack_index_maps(
     const std::vector<
         std::pair<std::reference_wrapper<const common::IndexMap>, int>>& maps);
 
+/// Compute the ranks that ghost indices of a stacked map, see
+/// common::stack_index_maps, i.e. the destination ranks of the
+/// forward communicators of the maps. No communication is required.
+/// @param[in] maps List of (index map, block size) pairs
+/// @return The sorted destination ranks for the stacked map
+std::vector<int> stack_dest_ranks(
+    const std::vector<
+        std::pair<std::reference_wrapper<const common::IndexMap>, int>>& maps);
+
+/// Compute the global indices in a stacked index map of the (blocked)
+/// local indices of each map, e.g. the local-to-global map of a block
+/// matrix or vector. The indices are ordered by map, with the owned
+/// indices of a map followed by its ghosts. No communication is
+/// required.
+/// @param[in] maps List of (index map, block size) pairs
+/// @param[in] map The stacked index map, with block size 1, created
+/// from the data computed by common::stack_index_maps
+/// @return The stacked global index of each local index
+std::vector<std::int64_t> stack_local_to_global(
+    const std::vector<
+        std::pair<std::reference_wrapper<const common::IndexMap>, int>>& maps,
+    const IndexMap& map);
+
 /// This class represents the distribution index arrays across
 /// processes. An index array is a contiguous collection of N+1 indices
 /// [0, 1, . . ., N] that are distributed across M processes. On a given
@@ -125,6 +151,13 @@ public:
   /// @return A neighborhood communicator for the specified edge direction
   MPI_Comm comm(Direction dir) const;
 
+  /// Return a MPI communicator with a symmetric distributed graph
+  /// topology, i.e. the source and destination ranks are the same, and
+  /// are the ranks that share indices with the caller in either
+  /// direction
+  /// @return A symmetric neighborhood communicator
+  MPI_Comm comm_symmetric() const;
+
   /// Compute global indices for array of local indices
   /// @param[in] local Local indices
   /// @param[out] global The global indices
@@ -135,6 +168,10 @@ public:
   /// @param[in] global Global indices
   /// @param[out] local The local of the corresponding global index in 'global'.
   /// Returns -1 if the local index does not exist on this process.
+  /// @note Ghost indices are found by binary search in a sorted copy of
+  /// the ghosts that is built when the map is created, so the cost per
+  /// index is O(log(num_ghosts())). Pass all indices in one call rather
+  /// than calling this function in a loop.
   void global_to_local(const xtl::span<const std::int64_t>& global,
                        const xtl::span<std::int32_t>& local) const;
 
@@ -154,13 +191,22 @@ public:
   /// Owner rank (on global communicator) of each ghost entry
   std::vector<int> ghost_owner_rank() const;
 
-  /// @todo Aim to remove this function? If it's kept, should it work
-  /// with neighborhood ranks?
+  /// @todo Should this work with neighborhood ranks?
   ///
-  /// Compute map from each local (owned) index to the set of ranks that
-  /// have the index as a ghost
-  /// @return shared indices
-  std::map<std::int32_t, std::set<int>> compute_shared_indices() const;
+  /// Ranks that share each local index. For an owned index these are
+  /// the ranks that have the index as a ghost. For a ghost index these
+  /// are the owner and the other ranks that ghost the index. The ranks
+  /// (on the global communicator) of each index are sorted, and an
+  /// index that is not shared has no ranks.
+  /// @note Collective MPI operation. The result is not cached, so
+  /// callers that need it more than once should keep it.
+  /// @return The sharing ranks, with one node per local index (owned
+  /// and ghost)
+  graph::AdjacencyList<int> compute_sharing_ranks() const;
+
+  /// Return the memory allocated by the index map
+  /// @return The number of bytes
+  std::size_t memory_usage() const;
 
   /// Start a non-blocking send from the local owner of to process ranks
   /// that have the index as a ghost. The non-blocking communication is
@@ -203,11 +249,13 @@ public:
     // Copy data into send buffer
     send_buffer.resize(n * displs_send_fwd.back());
     const std::vector<std::int32_t>& indices = _shared_indices->array();
-    for (std::size_t i = 0; i < indices.size(); ++i)
+    auto pack = [&](auto bs)
     {
-      std::copy_n(std::next(local_data.cbegin(), n * indices[i]), n,
-                  std::next(send_buffer.begin(), n * i));
-    }
+      for (std::size_t i = 0; i < indices.size(); ++i)
+        for (int j = 0; j < bs; ++j)
+          send_buffer[bs * i + j] = local_data[bs * indices[i] + j];
+    };
+    dispatch_block_size(n, pack);
 
     // Start send/receive
     recv_buffer.resize(n * _displs_recv_fwd.back());
@@ -238,7 +286,17 @@ public:
       return;
 
     // Wait for communication to complete
+    const bool log = dolfinx::communication_log();
+    const double t0 = log ? MPI_Wtime() : 0.0;
     MPI_Wait(&request, MPI_STATUS_IGNORE);
+    if (log)
+    {
+      dolfinx::register_communication(
+          "IndexMap::scatter_fwd", _displs_recv_fwd.size() - 1,
+          std::count_if(_sizes_recv_fwd.begin(), _sizes_recv_fwd.end(),
+                        [](int n) { return n > 0; }),
+          recv_buffer.size() * sizeof(T), MPI_Wtime() - t0);
+    }
 
     // Copy into ghost area ("remote_data")
     if (!remote_data.empty())
@@ -247,13 +305,17 @@ public:
       assert(remote_data.size() % _ghosts.size() == 0);
       const int n = remote_data.size() / _ghosts.size();
       std::vector<std::int32_t> displs = _displs_recv_fwd;
-      for (std::size_t i = 0; i < _ghosts.size(); ++i)
+      auto unpack = [&](auto bs)
       {
-        const int p = _ghost_owners[i];
-        std::copy_n(std::next(recv_buffer.cbegin(), n * displs[p]), n,
-                    std::next(remote_data.begin(), n * i));
-        displs[p] += 1;
-      }
+        for (std::size_t i = 0; i < _ghosts.size(); ++i)
+        {
+          const int p = _ghost_owners[i];
+          for (int j = 0; j < bs; ++j)
+            remote_data[bs * i + j] = recv_buffer[bs * displs[p] + j];
+          displs[p] += 1;
+        }
+      };
+      dispatch_block_size(n, unpack);
     }
   }
 
@@ -329,13 +391,17 @@ public:
     // Pack send buffer
     send_buffer.resize(n * _displs_recv_fwd.back());
     std::vector<std::int32_t> displs(_displs_recv_fwd);
-    for (std::size_t i = 0; i < _ghosts.size(); ++i)
+    auto pack = [&](auto bs)
     {
-      const int p = _ghost_owners[i];
-      std::copy_n(std::next(remote_data.cbegin(), n * i), n,
-                  std::next(send_buffer.begin(), n * displs[p]));
-      displs[p] += 1;
-    }
+      for (std::size_t i = 0; i < _ghosts.size(); ++i)
+      {
+        const int p = _ghost_owners[i];
+        for (int j = 0; j < bs; ++j)
+          send_buffer[bs * displs[p] + j] = remote_data[bs * i + j];
+        displs[p] += 1;
+      }
+    };
+    dispatch_block_size(n, pack);
 
     // Send and receive data
     recv_buffer.resize(n * displs_send_fwd.back());
@@ -370,7 +436,17 @@ public:
       return;
 
     // Wait for communication to complete
+    const bool log = dolfinx::communication_log();
+    const double t0 = log ? MPI_Wtime() : 0.0;
     MPI_Wait(&request, MPI_STATUS_IGNORE);
+    if (log)
+    {
+      dolfinx::register_communication(
+          "IndexMap::scatter_rev", displs_send_fwd.size() - 1,
+          std::count_if(_sizes_send_fwd.begin(), _sizes_send_fwd.end(),
+                        [](int n) { return n > 0; }),
+          recv_buffer.size() * sizeof(T), MPI_Wtime() - t0);
+    }
 
     // Copy or accumulate into "local_data"
     if (std::int32_t size = this->size_local(); size > 0)
@@ -380,25 +456,29 @@ public:
       const int n = local_data.size() / size;
       const std::vector<std::int32_t>& shared_indices
           = _shared_indices->array();
-      switch (op)
+      auto unpack = [&](auto bs)
       {
-      case Mode::insert:
-        for (std::size_t i = 0; i < shared_indices.size(); ++i)
-        {
-          const std::int32_t index = shared_indices[i];
-          std::copy_n(std::next(recv_buffer.cbegin(), n * i), n,
-                      std::next(local_data.begin(), n * index));
-        }
-        break;
-      case Mode::add:
-        for (std::size_t i = 0; i < shared_indices.size(); ++i)
+        switch (op)
         {
-          const std::int32_t index = shared_indices[i];
-          for (int j = 0; j < n; ++j)
-            local_data[index * n + j] += recv_buffer[i * n + j];
+        case Mode::insert:
+          for (std::size_t i = 0; i < shared_indices.size(); ++i)
+          {
+            const std::int32_t index = shared_indices[i];
+            for (int j = 0; j < bs; ++j)
+              local_data[index * bs + j] = recv_buffer[i * bs + j];
+          }
+          break;
+        case Mode::add:
+          for (std::size_t i = 0; i < shared_indices.size(); ++i)
+          {
+            const std::int32_t index = shared_indices[i];
+            for (int j = 0; j < bs; ++j)
+              local_data[index * bs + j] += recv_buffer[i * bs + j];
+          }
+          break;
         }
-        break;
-      }
+      };
+      dispatch_block_size(n, unpack);
     }
   }
 
@@ -458,12 +538,22 @@ private:
   // - out-edges (dest) are to the owning ranks of my ghost indices
   dolfinx::MPI::Comm _comm_ghost_to_owner;
 
+  // Communicator with the union of the in- and out-edges of
+  // _comm_owner_to_ghost as both in- and out-edges (see
+  // IndexMap::comm_symmetric)
+  dolfinx::MPI::Comm _comm_symmetric;
+
   // MPI sizes and displacements for forward (owner -> ghost) scatter
   std::vector<int> _sizes_recv_fwd, _sizes_send_fwd, _displs_recv_fwd;
 
   // Local-to-global map for ghost indices
   std::vector<std::int64_t> _ghosts;
 
+  // Sorted ghost (global) indices and the local position of each
+  // sorted ghost, for global-to-local lookups
+  std::vector<std::int64_t> _ghosts_sorted;
+  std::vector<std::int32_t> _ghosts_sorted_local;
+
   // Owning neighborhood rank (out edge) on '_comm_owner_to_ghost'
   // communicator for each ghost index
   std::vector<std::int32_t> _ghost_owners;
@@ -476,4 +566,20 @@ private:
   std::unique_ptr<graph::AdjacencyList<std::int32_t>> _shared_indices;
 };
 
+/// Create an index map of a subset of the indices of an index map, e.g.
+/// of the entities of a submesh. The owned indices of the sub-map are
+/// the owned indices in @p indices, in the same order. The ghosts of
+/// the sub-map are the ghosts in @p indices that are in the sub-map on
+/// their owner. Ghosts that the owner does not include are dropped.
+///
+/// @note Collective
+/// @param[in] map The index map
+/// @param[in] indices Sorted, unique local indices (owned and ghost) of
+/// @p map
+/// @return The sub-map and, for each local index (owned and ghost) of
+/// the sub-map, the local index in @p map
+std::pair<IndexMap, std::vector<std::int32_t>>
+create_sub_index_map(const IndexMap& map,
+                     const xtl::span<const std::int32_t>& indices);
+
 } // namespace dolfinx::common
@@ -7,6 +7,12 @@
 #include "MPI.h"
 #include <algorithm>
 
+namespace
+{
+// Communicator size from which sparse (NBX) communication is used
+int sparse_threshold = 1024;
+} // namespace
+
 //-----------------------------------------------------------------------------
 dolfinx::MPI::Comm::Comm(MPI_Comm comm, bool duplicate)
 {
@@ -137,6 +143,9 @@ int dolfinx::MPI::index_owner(int size, std::size_t index, std::size_t N)
 std::vector<int> dolfinx::MPI::compute_graph_edges(MPI_Comm comm,
                                                    const std::set<int>& edges)
 {
+  if (dolfinx::MPI::size(comm) >= sparse_threshold)
+    return compute_graph_edges_nbx(comm, edges);
+
   // Send '1' to ranks that I have a edge to
   std::vector<std::uint8_t> edge_count(dolfinx::MPI::size(comm), 0);
   for (auto e : edges)
@@ -155,6 +164,69 @@ std::vector<int> dolfinx::MPI::compute_graph_edges(MPI_Comm comm,
   return edges1;
 }
 //-----------------------------------------------------------------------------
+std::vector<int>
+dolfinx::MPI::compute_graph_edges_nbx(MPI_Comm comm, const std::set<int>& edges)
+{
+  // Use a duplicate communicator so that messages cannot be matched by
+  // a subsequent exchange on a rank that has already completed
+  dolfinx::MPI::Comm _comm(comm);
+
+  // Start a synchronous send to each rank that I have an edge to
+  const std::uint8_t msg = 1;
+  std::vector<MPI_Request> send_requests(edges.size());
+  std::size_t i = 0;
+  for (int e : edges)
+  {
+    MPI_Issend(&msg, 1, MPI_UINT8_T, e, 0, _comm.comm(),
+               &send_requests[i++]);
+  }
+
+  // Receive messages until all sends on all ranks have been matched,
+  // which is detected by a non-blocking barrier that is entered when
+  // the sends of the caller have completed
+  std::vector<int> edges1;
+  MPI_Request barrier_request = MPI_REQUEST_NULL;
+  bool barrier_active = false;
+  int done = 0;
+  while (!done)
+  {
+    int flag = 0;
+    MPI_Status status;
+    MPI_Iprobe(MPI_ANY_SOURCE, 0, _comm.comm(), &flag, &status);
+    if (flag)
+    {
+      std::uint8_t msg_recv;
+      MPI_Recv(&msg_recv, 1, MPI_UINT8_T, status.MPI_SOURCE, 0, _comm.comm(),
+               MPI_STATUS_IGNORE);
+      edges1.push_back(status.MPI_SOURCE);
+    }
+
+    if (barrier_active)
+      MPI_Test(&barrier_request, &done, MPI_STATUS_IGNORE);
+    else
+    {
+      int sent = 0;
+      MPI_Testall(send_requests.size(), send_requests.data(), &sent,
+                  MPI_STATUSES_IGNORE);
+      if (sent)
+      {
+        MPI_Ibarrier(_comm.comm(), &barrier_request);
+        barrier_active = true;
+      }
+    }
+  }
+
+  std::sort(edges1.begin(), edges1.end());
+  return edges1;
+}
+//-----------------------------------------------------------------------------
+int dolfinx::MPI::sparse_exchange_threshold() { return sparse_threshold; }
+//-----------------------------------------------------------------------------
+void dolfinx::MPI::set_sparse_exchange_threshold(int size)
+{
+  sparse_threshold = size;
+}
+//-----------------------------------------------------------------------------
 std::tuple<std::vector<int>, std::vector<int>>
 dolfinx::MPI::neighbors(MPI_Comm neighbor_comm)
 {
@@ -6,10 +6,12 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <complex>
 #include <cstdint>
+#include <dolfinx/common/timing.h>
 #include <dolfinx/graph/AdjacencyList.h>
 #include <iostream>
 #include <numeric>
@@ -70,10 +72,23 @@ public:
 
   /// Send in_values[p0] to process p0 and receive values from process
   /// p1 in out_values[p1]
+  /// @note If the size of @p comm is at least
+  /// MPI::sparse_exchange_threshold(), MPI::all_to_all_nbx is used
   template <typename T>
   static graph::AdjacencyList<T>
   all_to_all(MPI_Comm comm, const graph::AdjacencyList<T>& send_data);
 
+  /// Sparse version of MPI::all_to_all. Only non-empty messages are
+  /// sent, using synchronous point-to-point sends and a non-blocking
+  /// barrier to detect completion (the NBX algorithm, Hoefler et al.,
+  /// 2010). No collective with O(size(comm)) data is used.
+  /// @param[in] comm The MPI communicator
+  /// @param[in] send_data The data to send to each rank
+  /// @return The data received from each rank
+  template <typename T>
+  static graph::AdjacencyList<T>
+  all_to_all_nbx(MPI_Comm comm, const graph::AdjacencyList<T>& send_data);
+
   /// @todo Experimental. Maybe be moved or removed.
   ///
   /// Compute communication graph edges. The caller provides edges that
@@ -86,9 +101,33 @@ public:
   /// @param[in] edges Communication edges between the caller and the
   ///   ranks in @p edges.
   /// @return Ranks that have defined edges from them to this rank
+  /// @note If the size of @p comm is at least
+  /// MPI::sparse_exchange_threshold(), MPI::compute_graph_edges_nbx is
+  /// used
   static std::vector<int> compute_graph_edges(MPI_Comm comm,
                                               const std::set<int>& edges);
 
+  /// Compute communication graph edges (see MPI::compute_graph_edges)
+  /// using the NBX algorithm. The communication cost depends on the
+  /// number of edges only, and not on the size of the communicator.
+  /// @param[in] comm The MPI communicator
+  /// @param[in] edges Communication edges between the caller and the
+  ///   ranks in @p edges.
+  /// @return Ranks that have defined edges from them to this rank,
+  /// sorted
+  static std::vector<int> compute_graph_edges_nbx(MPI_Comm comm,
+                                                  const std::set<int>& edges);
+
+  /// Communicator size from which MPI::all_to_all and
+  /// MPI::compute_graph_edges use sparse (NBX) communication. The
+  /// default is 1024.
+  static int sparse_exchange_threshold();
+
+  /// Set the communicator size from which MPI::all_to_all and
+  /// MPI::compute_graph_edges use sparse (NBX) communication
+  /// @param[in] size The communicator size
+  static void set_sparse_exchange_threshold(int size);
+
   /// Neighborhood all-to-all. Send data to neighbors.
   /// Send in_values[n0] to neighbor process n0 and receive values from neighbor
   /// process n1 in out_values[n1]
@@ -156,6 +195,11 @@ inline MPI_Datatype MPI::mpi_type<std::complex<double>>()
   return MPI_DOUBLE_COMPLEX;
 }
 template <>
+inline MPI_Datatype MPI::mpi_type<signed char>()
+{
+  return MPI_SIGNED_CHAR;
+}
+template <>
 inline MPI_Datatype MPI::mpi_type<short int>()
 {
   return MPI_SHORT;
@@ -207,6 +251,8 @@ dolfinx::MPI::all_to_all(MPI_Comm comm,
 
   const int comm_size = MPI::size(comm);
   assert(send_data.num_nodes() == comm_size);
+  if (comm_size >= sparse_exchange_threshold())
+    return all_to_all_nbx(comm, send_data);
 
   // Data size per destination rank
   std::vector<int> send_size(comm_size);
@@ -214,6 +260,8 @@ dolfinx::MPI::all_to_all(MPI_Comm comm,
                            send_offsets.end(), send_size.begin());
 
   // Get received data sizes from each rank
+  const bool log = dolfinx::communication_log();
+  const double t0 = log ? MPI_Wtime() : 0.0;
   std::vector<int> recv_size(comm_size);
   MPI_Alltoall(send_size.data(), 1, mpi_type<int>(), recv_size.data(), 1,
                mpi_type<int>(), comm);
@@ -229,6 +277,14 @@ dolfinx::MPI::all_to_all(MPI_Comm comm,
   MPI_Alltoallv(values_in.data(), send_size.data(), send_offsets.data(),
                 mpi_type<T>(), recv_values.data(), recv_size.data(),
                 recv_offset.data(), mpi_type<T>(), comm);
+  if (log)
+  {
+    dolfinx::register_communication(
+        "MPI::all_to_all", comm_size,
+        std::count_if(recv_size.begin(), recv_size.end(),
+                      [](int n) { return n > 0; }),
+        recv_values.size() * sizeof(T), MPI_Wtime() - t0);
+  }
 
   return graph::AdjacencyList<T>(std::move(recv_values),
                                  std::move(recv_offset));
@@ -236,6 +292,99 @@ dolfinx::MPI::all_to_all(MPI_Comm comm,
 //-----------------------------------------------------------------------------
 template <typename T>
 graph::AdjacencyList<T>
+dolfinx::MPI::all_to_all_nbx(MPI_Comm comm,
+                             const graph::AdjacencyList<T>& send_data)
+{
+  const std::vector<std::int32_t>& send_offsets = send_data.offsets();
+  const std::vector<T>& values_in = send_data.array();
+
+  const int comm_size = MPI::size(comm);
+  assert(send_data.num_nodes() == comm_size);
+
+  // Use a duplicate communicator so that messages cannot be matched by
+  // a subsequent exchange on a rank that has already completed
+  MPI::Comm _comm(comm);
+
+  // Start synchronous sends of non-empty messages
+  const bool log = dolfinx::communication_log();
+  const double t0 = log ? MPI_Wtime() : 0.0;
+  std::vector<MPI_Request> send_requests;
+  for (int p = 0; p < comm_size; ++p)
+  {
+    if (int size = send_offsets[p + 1] - send_offsets[p]; size > 0)
+    {
+      MPI_Request& request = send_requests.emplace_back();
+      MPI_Issend(values_in.data() + send_offsets[p], size, mpi_type<T>(), p,
+                 0, _comm.comm(), &request);
+    }
+  }
+
+  // Receive messages until all sends on all ranks have been matched,
+  // which is detected by a non-blocking barrier that is entered when
+  // the sends of the caller have completed
+  std::vector<std::pair<int, std::vector<T>>> recv_data;
+  MPI_Request barrier_request = MPI_REQUEST_NULL;
+  bool barrier_active = false;
+  int done = 0;
+  while (!done)
+  {
+    int flag = 0;
+    MPI_Status status;
+    MPI_Iprobe(MPI_ANY_SOURCE, 0, _comm.comm(), &flag, &status);
+    if (flag)
+    {
+      int count = 0;
+      MPI_Get_count(&status, mpi_type<T>(), &count);
+      auto& [src, data]
+          = recv_data.emplace_back(status.MPI_SOURCE, std::vector<T>(count));
+      MPI_Recv(data.data(), count, mpi_type<T>(), src, 0, _comm.comm(),
+               MPI_STATUS_IGNORE);
+    }
+
+    if (barrier_active)
+      MPI_Test(&barrier_request, &done, MPI_STATUS_IGNORE);
+    else
+    {
+      int sent = 0;
+      MPI_Testall(send_requests.size(), send_requests.data(), &sent,
+                  MPI_STATUSES_IGNORE);
+      if (sent)
+      {
+        MPI_Ibarrier(_comm.comm(), &barrier_request);
+        barrier_active = true;
+      }
+    }
+  }
+
+  if (log)
+  {
+    std::int64_t bytes = 0;
+    for (auto& d : recv_data)
+      bytes += d.second.size() * sizeof(T);
+    dolfinx::register_communication("MPI::all_to_all_nbx", comm_size,
+                                    recv_data.size(), bytes,
+                                    MPI_Wtime() - t0);
+  }
+
+  // Order received data by source rank
+  std::sort(recv_data.begin(), recv_data.end(),
+            [](auto& a, auto& b) { return a.first < b.first; });
+  std::vector<std::int32_t> recv_offsets(comm_size + 1, 0);
+  for (auto& d : recv_data)
+    recv_offsets[d.first + 1] = d.second.size();
+  std::partial_sum(recv_offsets.begin(), recv_offsets.end(),
+                   recv_offsets.begin());
+  std::vector<T> recv_values;
+  recv_values.reserve(recv_offsets.back());
+  for (auto& d : recv_data)
+    recv_values.insert(recv_values.end(), d.second.begin(), d.second.end());
+
+  return graph::AdjacencyList<T>(std::move(recv_values),
+                                 std::move(recv_offsets));
+}
+//-----------------------------------------------------------------------------
+template <typename T>
+graph::AdjacencyList<T>
 dolfinx::MPI::neighbor_all_to_all(MPI_Comm neighbor_comm,
                                   const graph::AdjacencyList<T>& send_data)
 {
@@ -251,6 +400,8 @@ dolfinx::MPI::neighbor_all_to_all(MPI_Comm neighbor_comm,
   std::adjacent_difference(std::next(send_data.offsets().begin()),
                            send_data.offsets().end(), send_sizes.begin());
   // Get receive sizes
+  const bool log = dolfinx::communication_log();
+  const double t0 = log ? MPI_Wtime() : 0.0;
   MPI_Neighbor_alltoall(send_sizes.data(), 1, MPI::mpi_type<int>(),
                         recv_sizes.data(), 1, MPI::mpi_type<int>(),
                         neighbor_comm);
@@ -267,6 +418,14 @@ dolfinx::MPI::neighbor_all_to_all(MPI_Comm neighbor_comm,
       send_data.array().data(), send_sizes.data(), send_data.offsets().data(),
       MPI::mpi_type<T>(), recv_data.data(), recv_sizes.data(),
       recv_offsets.data(), MPI::mpi_type<T>(), neighbor_comm);
+  if (log)
+  {
+    dolfinx::register_communication(
+        "MPI::neighbor_all_to_all", indegree,
+        std::count_if(recv_sizes.begin(), std::prev(recv_sizes.end()),
+                      [](int n) { return n > 0; }),
+        recv_data.size() * sizeof(T), MPI_Wtime() - t0);
+  }
 
   return graph::AdjacencyList<T>(std::move(recv_data), std::move(recv_offsets));
 }
@@ -0,0 +1,814 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include "IndexMap.h"
+#include "MPI.h"
+#include "cpu.h"
+#include "utils.h"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include <xtl/xspan.hpp>
+
+namespace dolfinx::common
+{
+
+/// A reusable plan for the ghost updates of an IndexMap with block size
+/// bs and data of type T.
+///
+/// The send/receive buffers, the MPI sizes and displacements, and the
+/// position of each ghost in the receive buffer are computed once, at
+/// construction. With MPI-4, persistent neighborhood collectives
+/// (`MPI_Neighbor_alltoallv_init`) are created on the first scatter
+/// and re-started by subsequent scatters. Otherwise the communication
+/// is posted with `MPI_Ineighbor_alltoallv`.
+///
+/// If the ghosts are numbered contiguously by owning rank (in ascending
+/// rank order, see fem::build_dofmap_data), the forward scatter
+/// receives directly into the ghost array and no unpacking is
+/// required.
+///
+/// The forward and reverse scatters share the buffers, so only one
+/// scatter can be in progress at a time. The buffers are allocated
+/// with the allocator of the data, e.g. la::Vector.
+///
+/// The packing and unpacking of the buffers can be replaced by custom
+/// functions, e.g. kernels that run on a device when the buffers are
+/// allocated in device-accessible memory, see
+/// Scatterer::scatter_fwd_begin.
+///
+/// Optionally (Scatterer::enable_shared_memory), values are exchanged
+/// with neighbors on the same node through MPI-3 shared memory
+/// windows: each rank packs its send buffer into a window, and the
+/// neighbors on the node copy their values directly from it. Messages
+/// are only used for neighbors on other nodes.
+template <typename T, class Allocator = std::allocator<T>>
+class Scatterer
+{
+public:
+  /// Create a scatterer
+  /// @note Not collective. Communication is first performed by the
+  /// first call to scatter_fwd_begin or scatter_rev_begin.
+  /// @param[in] map The index map that describes the parallel layout of
+  /// the data
+  /// @param[in] bs The number of values per index
+  /// @param[in] alloc The memory allocator for the buffers
+  Scatterer(const std::shared_ptr<const IndexMap>& map, int bs,
+            const Allocator& alloc = Allocator())
+      : _map(map), _bs(bs), _buffer_local(alloc), _buffer_remote(alloc)
+  {
+    assert(_map);
+    const graph::AdjacencyList<std::int32_t>& shared_indices
+        = _map->shared_indices();
+
+    // Neighbors that own ghosts of the caller (in-edges on the forward
+    // communicator)
+    MPI_Comm comm = _map->comm(IndexMap::Direction::forward);
+    int indegree(-1), outdegree(-2), weighted(-1);
+    MPI_Dist_graph_neighbors_count(comm, &indegree, &outdegree, &weighted);
+    std::vector<int> neighbors_in(indegree), neighbors_out(outdegree);
+    MPI_Dist_graph_neighbors(comm, indegree, neighbors_in.data(),
+                             MPI_UNWEIGHTED, outdegree, neighbors_out.data(),
+                             MPI_UNWEIGHTED);
+    _empty = indegree == 0 and outdegree == 0;
+
+    // Owned values sent to each neighbor, in the order of the shared
+    // indices
+    const std::vector<std::int32_t>& offsets = shared_indices.offsets();
+    for (std::size_t p = 0; p + 1 < offsets.size(); ++p)
+    {
+      _sizes_local.push_back(_bs * (offsets[p + 1] - offsets[p]));
+      _displs_local.push_back(_bs * offsets[p]);
+    }
+
+    // Ghost values received from each neighbor, grouped by owner
+    const std::vector<int> owners = _map->ghost_owner_rank();
+    std::vector<std::int32_t> neighbor(owners.size());
+    std::vector<std::int32_t> sizes(indegree, 0);
+    for (std::size_t i = 0; i < owners.size(); ++i)
+    {
+      auto it = std::find(neighbors_in.begin(), neighbors_in.end(), owners[i]);
+      assert(it != neighbors_in.end());
+      neighbor[i] = std::distance(neighbors_in.begin(), it);
+      sizes[neighbor[i]] += 1;
+    }
+
+    std::vector<std::int32_t> displs(indegree + 1, 0);
+    std::partial_sum(sizes.begin(), sizes.end(), std::next(displs.begin()));
+    for (int p = 0; p < indegree; ++p)
+    {
+      _sizes_remote.push_back(_bs * sizes[p]);
+      _displs_remote.push_back(_bs * displs[p]);
+    }
+
+    // Position of each ghost in the receive buffer
+    _ghost_pos.resize(owners.size());
+    for (std::size_t i = 0; i < owners.size(); ++i)
+      _ghost_pos[i] = displs[neighbor[i]]++;
+    for (std::size_t i = 0; i < _ghost_pos.size(); ++i)
+      _owner_sorted = _owner_sorted and _ghost_pos[i] == std::int32_t(i);
+
+    // Avoid passing null pointers to MPI
+    for (auto v : {&_sizes_local, &_displs_local, &_sizes_remote,
+                   &_displs_remote})
+    {
+      if (v->empty())
+        v->push_back(0);
+    }
+
+    _size_local = _bs * shared_indices.array().size();
+    _size_remote = _bs * owners.size();
+    _buffer_local.resize(_size_local);
+    _buffer_remote.resize(_size_remote);
+    _local = _buffer_local.data();
+    _remote = _buffer_remote.data();
+  }
+
+  /// Copy constructor (deleted)
+  Scatterer(const Scatterer& scatterer) = delete;
+
+  /// Move constructor (deleted). Persistent requests hold the addresses
+  /// of the buffers.
+  Scatterer(Scatterer&& scatterer) = delete;
+
+  /// Destructor
+  /// @note Collective MPI operation on the ranks of the node if shared
+  /// memory is enabled (Scatterer::enable_shared_memory), since the
+  /// windows and the node communicator are freed. The ranks of the node
+  /// must then destroy the scatterer in the same order.
+  ~Scatterer()
+  {
+    int finalized = 0;
+    MPI_Finalized(&finalized);
+    if (!finalized)
+    {
+      free_requests();
+      for (MPI_Win* win : {&_win_local, &_win_remote})
+      {
+        if (*win != MPI_WIN_NULL)
+          MPI_Win_free(win);
+      }
+      for (MPI_Group* group : {&_group_owners, &_group_ghosters})
+      {
+        if (*group != MPI_GROUP_NULL and *group != MPI_GROUP_EMPTY)
+          MPI_Group_free(group);
+      }
+      if (_shm_comm != MPI_COMM_NULL)
+        MPI_Comm_free(&_shm_comm);
+    }
+  }
+
+  /// Assignment operator (deleted)
+  Scatterer& operator=(const Scatterer& scatterer) = delete;
+
+  /// Move assignment operator (deleted)
+  Scatterer& operator=(Scatterer&& scatterer) = delete;
+
+  /// Exchange values with neighbors on the same node (ranks that share
+  /// memory, `MPI_COMM_TYPE_SHARED`) through MPI-3 shared memory
+  /// windows, and with messages only for neighbors on other nodes.
+  ///
+  /// The send buffers are allocated in the windows, and the neighbors
+  /// on the node copy their values directly from the windows of the
+  /// sending rank, synchronized by post-start-complete-wait epochs on
+  /// the groups of neighbors. This avoids a copy through MPI and the
+  /// message matching for on-node neighbors in hybrid runs.
+  /// @note Collective MPI operation. All ranks of the index map
+  /// communicator must call this function, including ranks without
+  /// neighbors.
+  /// @note Has no effect if shared memory is already enabled.
+  /// @note The destructor becomes a collective operation on the ranks
+  /// of the node, see Scatterer::~Scatterer.
+  /// @note The windows are in host memory, so custom pack and unpack
+  /// functions must be able to access host memory.
+  void enable_shared_memory()
+  {
+    if (_shm_comm != MPI_COMM_NULL)
+      return;
+
+    // Owners (in-edges) and ghosting ranks (out-edges) of the forward
+    // communicator
+    auto neighbors = [](MPI_Comm comm)
+    {
+      int indegree(-1), outdegree(-2), weighted(-1);
+      MPI_Dist_graph_neighbors_count(comm, &indegree, &outdegree, &weighted);
+      std::array<std::vector<int>, 2> n
+          = {std::vector<int>(indegree), std::vector<int>(outdegree)};
+      MPI_Dist_graph_neighbors(comm, indegree, n[0].data(), MPI_UNWEIGHTED,
+                               outdegree, n[1].data(), MPI_UNWEIGHTED);
+      return n;
+    };
+    MPI_Comm comm_fwd = _map->comm(IndexMap::Direction::forward);
+    MPI_Comm comm_rev = _map->comm(IndexMap::Direction::reverse);
+    const auto [owners, ghosters] = neighbors(comm_fwd);
+    const auto [src_rev, dest_rev] = neighbors(comm_rev);
+
+    // Rank of each neighbor in the node communicator, or MPI_UNDEFINED
+    // if the neighbor is on another node
+    MPI_Comm_split_type(comm_fwd, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL,
+                        &_shm_comm);
+    MPI_Group group, group_shm;
+    MPI_Comm_group(comm_fwd, &group);
+    MPI_Comm_group(_shm_comm, &group_shm);
+    auto node_ranks = [group, group_shm](const std::vector<int>& ranks)
+    {
+      std::vector<int> r(ranks.size(), MPI_UNDEFINED);
+      if (!ranks.empty())
+      {
+        MPI_Group_translate_ranks(group, ranks.size(), ranks.data(),
+                                  group_shm, r.data());
+      }
+      return r;
+    };
+    const std::vector<int> shm_owners = node_ranks(owners);
+    const std::vector<int> shm_ghosters = node_ranks(ghosters);
+
+    auto create_group = [group_shm](std::vector<int> ranks)
+    {
+      ranks.erase(std::remove(ranks.begin(), ranks.end(), MPI_UNDEFINED),
+                  ranks.end());
+      MPI_Group g;
+      MPI_Group_incl(group_shm, ranks.size(), ranks.data(), &g);
+      return g;
+    };
+    _group_owners = create_group(shm_owners);
+    _group_ghosters = create_group(shm_ghosters);
+    MPI_Group_free(&group);
+    MPI_Group_free(&group_shm);
+
+    // Send the displacement of the values for each ghosting rank in the
+    // local buffer (forward), and of the values for each owner in the
+    // remote buffer (reverse)
+    std::vector<int> displs_owner(std::max<std::size_t>(owners.size(), 1));
+    MPI_Neighbor_alltoall(_displs_local.data(), 1, MPI_INT,
+                          displs_owner.data(), 1, MPI_INT, comm_fwd);
+
+    auto index = [](const std::vector<int>& v, int r)
+    { return std::distance(v.begin(), std::find(v.begin(), v.end(), r)); };
+    std::vector<int> send_rev(std::max<std::size_t>(dest_rev.size(), 1));
+    for (std::size_t k = 0; k < dest_rev.size(); ++k)
+      send_rev[k] = _displs_remote[index(owners, dest_rev[k])];
+    std::vector<int> recv_rev(std::max<std::size_t>(src_rev.size(), 1));
+    MPI_Neighbor_alltoall(send_rev.data(), 1, MPI_INT, recv_rev.data(), 1,
+                          MPI_INT, comm_rev);
+    std::vector<int> displs_ghoster(ghosters.size());
+    for (std::size_t k = 0; k < src_rev.size(); ++k)
+      displs_ghoster[index(ghosters, src_rev[k])] = recv_rev[k];
+
+    // Allocate the send/receive buffers in the windows
+    auto allocate = [comm = _shm_comm](std::size_t size, MPI_Win& win)
+    {
+      T* base = nullptr;
+      MPI_Win_allocate_shared(size * sizeof(T), sizeof(T), MPI_INFO_NULL,
+                              comm, &base, &win);
+      return base;
+    };
+    _local = allocate(_size_local, _win_local);
+    _remote = allocate(_size_remote, _win_remote);
+
+    // The buffers are replaced by the windows
+    std::vector<T, Allocator>(_buffer_local.get_allocator())
+        .swap(_buffer_local);
+    std::vector<T, Allocator>(_buffer_remote.get_allocator())
+        .swap(_buffer_remote);
+
+    auto query = [](MPI_Win win, int rank)
+    {
+      MPI_Aint size;
+      int disp_unit;
+      T* base = nullptr;
+      MPI_Win_shared_query(win, rank, &size, &disp_unit, &base);
+      return const_cast<const T*>(base);
+    };
+
+    // Copy the ghost values owned on the node from the local buffer of
+    // the owner, and do not send them as messages
+    for (std::size_t p = 0; p < owners.size(); ++p)
+    {
+      if (shm_owners[p] != MPI_UNDEFINED and _sizes_remote[p] > 0)
+      {
+        _shm_fwd.emplace_back(
+            _displs_remote[p], _sizes_remote[p],
+            query(_win_local, shm_owners[p]) + displs_owner[p]);
+      }
+      if (shm_owners[p] != MPI_UNDEFINED)
+        _sizes_remote[p] = 0;
+    }
+
+    // Copy the ghost values of ranks on the node from their remote
+    // buffer
+    for (std::size_t q = 0; q < ghosters.size(); ++q)
+    {
+      if (shm_ghosters[q] != MPI_UNDEFINED and _sizes_local[q] > 0)
+      {
+        _shm_rev.emplace_back(
+            _displs_local[q], _sizes_local[q],
+            query(_win_remote, shm_ghosters[q]) + displs_ghoster[q]);
+      }
+      if (shm_ghosters[q] != MPI_UNDEFINED)
+        _sizes_local[q] = 0;
+    }
+
+    // The requests are re-created with the new sizes and buffers
+    free_requests();
+    _bound_fwd = {nullptr, nullptr};
+    _bound_rev = {nullptr, nullptr};
+  }
+
+  /// Return true if values are exchanged with neighbors on the same
+  /// node through shared memory, see Scatterer::enable_shared_memory
+  bool shared_memory() const { return _shm_comm != MPI_COMM_NULL; }
+
+  /// Gather blocks of values into a buffer, `out[bs * i + j] = in[bs *
+  /// idx[i] + j]`. This is the default function to pack the send buffer
+  /// of the forward scatter and to unpack the receive buffer of the
+  /// forward scatter.
+  /// @param[in] idx The block indices in `in`
+  /// @param[in] bs The block size
+  /// @param[in] in The values to gather from
+  /// @param[out] out The buffer, of size `bs * idx.size()`
+  static void gather(const xtl::span<const std::int32_t>& idx, int bs,
+                     const xtl::span<const T>& in, const xtl::span<T>& out)
+  {
+    if constexpr (std::is_same_v<T, double>)
+    {
+      // Use the kernel that is compiled for the instruction set of the
+      // CPU
+      cpu::gather(idx.data(), idx.size(), bs, in.data(), out.data());
+      return;
+    }
+
+    auto g = [&](auto bs)
+    {
+      for (std::size_t i = 0; i < idx.size(); ++i)
+        for (int j = 0; j < bs; ++j)
+          out[bs * i + j] = in[bs * idx[i] + j];
+    };
+    dispatch_block_size(bs, g);
+  }
+
+  /// Scatter blocks of values from a buffer, `out[bs * idx[i] + j] =
+  /// in[bs * i + j]` (insert) or `out[bs * idx[i] + j] += in[bs * i +
+  /// j]` (add). This is the default function to pack the send buffer of
+  /// the reverse scatter and to unpack the receive buffer of the reverse
+  /// scatter.
+  /// @param[in] idx The block indices in `out`
+  /// @param[in] bs The block size
+  /// @param[in] in The buffer, of size `bs * idx.size()`
+  /// @param[in,out] out The values to set or add to
+  /// @param[in] op The accumulation option
+  static void scatter(const xtl::span<const std::int32_t>& idx, int bs,
+                      const xtl::span<const T>& in, const xtl::span<T>& out,
+                      IndexMap::Mode op)
+  {
+    if constexpr (std::is_same_v<T, double>)
+    {
+      if (op == IndexMap::Mode::add)
+      {
+        cpu::scatter_add(idx.data(), idx.size(), bs, in.data(), out.data());
+        return;
+      }
+    }
+
+    auto s = [&](auto bs)
+    {
+      switch (op)
+      {
+      case IndexMap::Mode::insert:
+        for (std::size_t i = 0; i < idx.size(); ++i)
+          for (int j = 0; j < bs; ++j)
+            out[bs * idx[i] + j] = in[bs * i + j];
+        break;
+      case IndexMap::Mode::add:
+        for (std::size_t i = 0; i < idx.size(); ++i)
+          for (int j = 0; j < bs; ++j)
+            out[bs * idx[i] + j] += in[bs * i + j];
+        break;
+      }
+    };
+    dispatch_block_size(bs, s);
+  }
+
+  /// Start a non-blocking send of owned values to the ranks that ghost
+  /// them. The communication is completed by Scatterer::scatter_fwd_end.
+  ///
+  /// The send buffer is packed by the function `pack`, which has the
+  /// signature of Scatterer::gather and is called with
+  /// Scatterer::local_indices. A function that runs on a device (e.g.
+  /// a CUDA kernel launch that is synchronized before returning) can be
+  /// passed if the data and buffers are in device-accessible memory,
+  /// e.g. with a managed-memory Allocator, in which case the buffers
+  /// are passed directly to a device-aware MPI and no copy to the host
+  /// is required.
+  /// @note Collective MPI operation
+  /// @param[in] local_data The owned values. Size must be `bs *
+  /// size_local()`. The values are copied into a send buffer, so the
+  /// array may be changed before the communication is completed.
+  /// @param[in] remote_data The ghost values to set with the received
+  /// data. Size must be `bs * num_ghosts()`. The same array must be
+  /// passed to Scatterer::scatter_fwd_end, and it must not be accessed
+  /// before the communication is completed.
+  /// @param[in] pack The function that packs the send buffer
+  template <typename Functor>
+  void scatter_fwd_begin(const xtl::span<const T>& local_data,
+                         const xtl::span<T>& remote_data, Functor pack)
+  {
+    if (_empty)
+      return;
+    if (local_data.size() != std::size_t(_bs * _map->size_local()))
+      throw std::runtime_error("Inconsistent data size.");
+    if (remote_data.size() != _size_remote)
+      throw std::runtime_error("Inconsistent data size.");
+
+    // Pack send buffer
+    pack(local_indices(), _bs, local_data,
+         xtl::span<T>(_local, _size_local));
+
+    // Expose the packed values to the neighbors on the node
+    if (_win_local != MPI_WIN_NULL)
+      MPI_Win_post(_group_ghosters, MPI_MODE_NOPUT, _win_local);
+
+    // Receive directly into the ghost array if the ghosts are sorted by
+    // owner
+    T* recv = _owner_sorted ? remote_data.data() : _remote;
+    start(_request_fwd, _bound_fwd, _local, _sizes_local, _displs_local,
+          recv, _sizes_remote, _displs_remote,
+          _map->comm(IndexMap::Direction::forward));
+  }
+
+  /// Start a non-blocking send of owned values to the ranks that ghost
+  /// them, packing the send buffer on the host with Scatterer::gather.
+  /// @note Collective MPI operation
+  /// @param[in] local_data The owned values
+  /// @param[in] remote_data The ghost values to set with the received
+  /// data
+  void scatter_fwd_begin(const xtl::span<const T>& local_data,
+                         const xtl::span<T>& remote_data)
+  {
+    scatter_fwd_begin(local_data, remote_data, gather);
+  }
+
+  /// Complete a forward scatter started by Scatterer::scatter_fwd_begin
+  ///
+  /// If the ghosts are not sorted by owner, the receive buffer is
+  /// unpacked by the function `unpack`, which has the signature of
+  /// Scatterer::gather and is called with Scatterer::ghost_positions.
+  /// @note Collective MPI operation
+  /// @param[in,out] remote_data The ghost values to set with the
+  /// received data. It must be the array passed to
+  /// Scatterer::scatter_fwd_begin.
+  /// @param[in] unpack The function that unpacks the receive buffer
+  template <typename Functor>
+  void scatter_fwd_end(const xtl::span<T>& remote_data, Functor unpack)
+  {
+    if (_empty)
+      return;
+
+    const bool log = dolfinx::communication_log();
+    const double t0 = log ? MPI_Wtime() : 0.0;
+    MPI_Wait(&_request_fwd, MPI_STATUS_IGNORE);
+    assert(remote_data.size() == _size_remote);
+
+    // Copy the values of owners on the node into the receive buffer
+    T* recv = _owner_sorted ? remote_data.data() : _remote;
+    if (_win_local != MPI_WIN_NULL)
+    {
+      MPI_Win_start(_group_owners, 0, _win_local);
+      copy_shared(_shm_fwd, recv);
+      MPI_Win_complete(_win_local);
+      MPI_Win_wait(_win_local);
+    }
+    if (log)
+      log_communication("Scatterer::scatter_fwd", _sizes_remote, t0,
+                        _map->comm(IndexMap::Direction::forward));
+
+    if (!_owner_sorted)
+    {
+      unpack(ghost_positions(), _bs,
+             xtl::span<const T>(recv, _size_remote), remote_data);
+    }
+  }
+
+  /// Complete a forward scatter started by Scatterer::scatter_fwd_begin,
+  /// unpacking the receive buffer on the host with Scatterer::gather
+  /// @note Collective MPI operation
+  /// @param[in,out] remote_data The ghost values to set with the
+  /// received data
+  void scatter_fwd_end(const xtl::span<T>& remote_data)
+  {
+    scatter_fwd_end(remote_data, gather);
+  }
+
+  /// Send owned values to the ranks that ghost them
+  /// @note Collective MPI operation
+  /// @param[in] local_data The owned values
+  /// @param[in,out] remote_data The ghost values
+  void scatter_fwd(const xtl::span<const T>& local_data,
+                   const xtl::span<T>& remote_data)
+  {
+    scatter_fwd_begin(local_data, remote_data);
+    scatter_fwd_end(remote_data);
+  }
+
+  /// Start a non-blocking send of ghost values to the owning ranks. The
+  /// communication is completed by Scatterer::scatter_rev_end.
+  ///
+  /// The send buffer is packed by the function `pack`, which has the
+  /// signature of Scatterer::scatter and is called with
+  /// Scatterer::ghost_positions and IndexMap::Mode::insert. See
+  /// Scatterer::scatter_fwd_begin for the use of device functions.
+  /// @note Collective MPI operation
+  /// @param[in] remote_data The ghost values. Size must be `bs *
+  /// num_ghosts()`. The values are copied into a send buffer, so the
+  /// array may be changed before the communication is completed.
+  /// @param[in] pack The function that packs the send buffer
+  template <typename Functor>
+  void scatter_rev_begin(const xtl::span<const T>& remote_data, Functor pack)
+  {
+    if (_empty)
+      return;
+    if (remote_data.size() != _size_remote)
+      throw std::runtime_error("Inconsistent data size.");
+
+    // Pack send buffer
+    pack(ghost_positions(), _bs, remote_data,
+         xtl::span<T>(_remote, _size_remote),
+         IndexMap::Mode::insert);
+
+    // Expose the packed values to the owners on the node
+    if (_win_remote != MPI_WIN_NULL)
+      MPI_Win_post(_group_owners, MPI_MODE_NOPUT, _win_remote);
+
+    start(_request_rev, _bound_rev, _remote, _sizes_remote, _displs_remote,
+          _local, _sizes_local, _displs_local,
+          _map->comm(IndexMap::Direction::reverse));
+  }
+
+  /// Start a non-blocking send of ghost values to the owning ranks,
+  /// packing the send buffer on the host with Scatterer::scatter
+  /// @note Collective MPI operation
+  /// @param[in] remote_data The ghost values
+  void scatter_rev_begin(const xtl::span<const T>& remote_data)
+  {
+    scatter_rev_begin(remote_data, scatter);
+  }
+
+  /// Complete a reverse scatter started by Scatterer::scatter_rev_begin
+  ///
+  /// The receive buffer is unpacked by the function `unpack`, which has
+  /// the signature of Scatterer::scatter and is called with
+  /// Scatterer::local_indices and `op`.
+  /// @note Collective MPI operation
+  /// @param[in,out] local_data The owned values to sum/set with the
+  /// received ghost values. Size must be `bs * size_local()`.
+  /// @param[in] op The accumulation option
+  /// @param[in] unpack The function that unpacks the receive buffer
+  template <typename Functor>
+  void scatter_rev_end(const xtl::span<T>& local_data, IndexMap::Mode op,
+                       Functor unpack)
+  {
+    if (_empty)
+      return;
+
+    const bool log = dolfinx::communication_log();
+    const double t0 = log ? MPI_Wtime() : 0.0;
+    MPI_Wait(&_request_rev, MPI_STATUS_IGNORE);
+    assert(local_data.size() == std::size_t(_bs * _map->size_local()));
+
+    // Copy the values of ghosting ranks on the node into the receive
+    // buffer
+    if (_win_remote != MPI_WIN_NULL)
+    {
+      MPI_Win_start(_group_ghosters, 0, _win_remote);
+      copy_shared(_shm_rev, _local);
+      MPI_Win_complete(_win_remote);
+      MPI_Win_wait(_win_remote);
+    }
+    if (log)
+      log_communication("Scatterer::scatter_rev", _sizes_local, t0,
+                        _map->comm(IndexMap::Direction::reverse));
+
+    unpack(local_indices(), _bs,
+           xtl::span<const T>(_local, _size_local), local_data, op);
+  }
+
+  /// Complete a reverse scatter started by Scatterer::scatter_rev_begin,
+  /// unpacking the receive buffer on the host with Scatterer::scatter
+  /// @note Collective MPI operation
+  /// @param[in,out] local_data The owned values to sum/set with the
+  /// received ghost values
+  /// @param[in] op The accumulation option
+  void scatter_rev_end(const xtl::span<T>& local_data, IndexMap::Mode op)
+  {
+    scatter_rev_end(local_data, op, scatter);
+  }
+
+  /// Send ghost values to the owning ranks
+  /// @note Collective MPI operation
+  /// @param[in,out] local_data The owned values
+  /// @param[in] remote_data The ghost values
+  /// @param[in] op The accumulation option
+  void scatter_rev(const xtl::span<T>& local_data,
+                   const xtl::span<const T>& remote_data, IndexMap::Mode op)
+  {
+    scatter_rev_begin(remote_data);
+    scatter_rev_end(local_data, op);
+  }
+
+  /// The index map
+  std::shared_ptr<const IndexMap> map() const { return _map; }
+
+  /// The number of values per index
+  int bs() const { return _bs; }
+
+  /// Block indices of the owned values in the send buffer of the
+  /// forward scatter (the shared indices of the index map, ordered by
+  /// neighbor). For use by custom pack and unpack functions, e.g. to be
+  /// copied to a device once.
+  xtl::span<const std::int32_t> local_indices() const
+  {
+    return _map->shared_indices().array();
+  }
+
+  /// Block position of each ghost in the receive buffer of the forward
+  /// scatter (and the send buffer of the reverse scatter). For use by
+  /// custom pack and unpack functions.
+  xtl::span<const std::int32_t> ghost_positions() const
+  {
+    return _ghost_pos;
+  }
+
+  /// Return true if the ghosts are numbered contiguously by owning
+  /// rank, in which case the forward scatter receives directly into
+  /// the ghost array
+  bool owner_sorted() const { return _owner_sorted; }
+
+  /// Return the memory allocated by the scatterer, i.e. by the buffers
+  /// (including the shared memory windows) and the communication
+  /// sizes, displacements and ghost positions
+  /// @return The number of bytes
+  std::size_t memory_usage() const
+  {
+    std::size_t size = (_buffer_local.capacity() + _buffer_remote.capacity())
+                       * sizeof(T);
+    if (_win_local != MPI_WIN_NULL)
+      size += (_size_local + _size_remote) * sizeof(T);
+    for (auto v : {&_sizes_local, &_displs_local, &_sizes_remote,
+                   &_displs_remote})
+    {
+      size += v->capacity() * sizeof(int);
+    }
+    size += _ghost_pos.capacity() * sizeof(std::int32_t);
+    size += (_shm_fwd.capacity() + _shm_rev.capacity())
+            * sizeof(std::tuple<int, int, const T*>);
+    return size;
+  }
+
+private:
+  // Copy the segments (offset, size, source) of the receive buffer that
+  // are read from the windows of neighbors on the node
+  static void copy_shared(const std::vector<std::tuple<int, int, const T*>>&
+                              segments,
+                          T* recv_buffer)
+  {
+    for (auto [offset, size, src] : segments)
+      std::copy_n(src, size, std::next(recv_buffer, offset));
+  }
+
+  // Register the statistics of a scatter that received messages of
+  // the sizes recv_sizes on the neighborhood communicator comm, and
+  // that started to wait at time t0 (see dolfinx::communication_log).
+  // Values received through shared memory are not counted.
+  static void log_communication(const std::string& site,
+                                const std::vector<int>& recv_sizes,
+                                double t0, MPI_Comm comm)
+  {
+    const double wait = MPI_Wtime() - t0;
+    int indegree(-1), outdegree(-2), weighted(-1);
+    MPI_Dist_graph_neighbors_count(comm, &indegree, &outdegree, &weighted);
+    std::int64_t messages = 0, size = 0;
+    for (int n : recv_sizes)
+    {
+      messages += n > 0;
+      size += n;
+    }
+    dolfinx::register_communication(site, indegree, messages,
+                                    size * sizeof(T), wait);
+  }
+
+  // Free the (persistent) requests
+  void free_requests()
+  {
+    for (MPI_Request* request : {&_request_fwd, &_request_rev})
+    {
+      if (*request != MPI_REQUEST_NULL)
+        MPI_Request_free(request);
+    }
+  }
+
+  // Start a neighborhood all-to-all, creating the persistent request on
+  // first use if supported. The request is re-created if the buffers
+  // differ from the buffers it was created with (bound).
+  static void start(MPI_Request& request, std::array<const T*, 2>& bound,
+                    const T* send_buffer, const std::vector<int>& send_sizes,
+                    const std::vector<int>& send_displs, T* recv_buffer,
+                    const std::vector<int>& recv_sizes,
+                    const std::vector<int>& recv_displs, MPI_Comm comm)
+  {
+#if MPI_VERSION >= 4
+    if (request != MPI_REQUEST_NULL
+        and (bound[0] != send_buffer or bound[1] != recv_buffer))
+    {
+      MPI_Request_free(&request);
+    }
+
+    if (request == MPI_REQUEST_NULL)
+    {
+      MPI_Neighbor_alltoallv_init(send_buffer, send_sizes.data(),
+                                  send_displs.data(), MPI::mpi_type<T>(),
+                                  recv_buffer, recv_sizes.data(),
+                                  recv_displs.data(), MPI::mpi_type<T>(),
+                                  comm, MPI_INFO_NULL, &request);
+    }
+    MPI_Start(&request);
+#else
+    MPI_Ineighbor_alltoallv(send_buffer, send_sizes.data(), send_displs.data(),
+                            MPI::mpi_type<T>(), recv_buffer, recv_sizes.data(),
+                            recv_displs.data(), MPI::mpi_type<T>(), comm,
+                            &request);
+#endif
+    bound = {send_buffer, recv_buffer};
+  }
+
+  // Map describing the data layout
+  std::shared_ptr<const IndexMap> _map;
+
+  // Block size
+  int _bs;
+
+  // True if the caller has no neighbors
+  bool _empty;
+
+  // MPI sizes and displacements (unrolled) for owned values that are
+  // ghosts on other ranks (local) and for ghost values (remote),
+  // ordered as the neighbors of the forward communicator. The sizes for
+  // neighbors on the node are zero if shared memory is enabled.
+  std::vector<int> _sizes_local, _displs_local, _sizes_remote, _displs_remote;
+
+  // Position (block) of each ghost in the remote buffer
+  std::vector<std::int32_t> _ghost_pos;
+
+  // True if _ghost_pos is the identity
+  bool _owner_sorted = true;
+
+  // Buffers for owned values that are ghosts on other ranks (local)
+  // and ghost values (remote). These are released if the shared
+  // memory windows are used.
+  std::vector<T, Allocator> _buffer_local, _buffer_remote;
+
+  // Sizes of the local and remote buffers (or windows)
+  std::size_t _size_local = 0, _size_remote = 0;
+
+  // Send/receive buffers in use. These point to _buffer_local and
+  // _buffer_remote, or to the shared memory windows.
+  T* _local = nullptr;
+  T* _remote = nullptr;
+
+  // Communicator of the ranks on the node, shared memory windows of the
+  // local and remote buffers, and groups (in _shm_comm) of the owners
+  // and ghosting ranks on the node
+  MPI_Comm _shm_comm = MPI_COMM_NULL;
+  MPI_Win _win_local = MPI_WIN_NULL;
+  MPI_Win _win_remote = MPI_WIN_NULL;
+  MPI_Group _group_owners = MPI_GROUP_NULL;
+  MPI_Group _group_ghosters = MPI_GROUP_NULL;
+
+  // Segments (offset, size, source) of the receive buffers that are
+  // copied from the windows of neighbors on the node, for the forward
+  // and reverse scatters
+  std::vector<std::tuple<int, int, const T*>> _shm_fwd, _shm_rev;
+
+  // Requests for the forward and reverse scatters. With MPI-4 these are
+  // persistent.
+  MPI_Request _request_fwd = MPI_REQUEST_NULL;
+  MPI_Request _request_rev = MPI_REQUEST_NULL;
+
+  // Send and receive buffers of the forward and reverse requests
+  std::array<const T*, 2> _bound_fwd = {nullptr, nullptr};
+  std::array<const T*, 2> _bound_rev = {nullptr, nullptr};
+};
+
+} // namespace dolfinx::common
@@ -0,0 +1,197 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "TaskGraph.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+using namespace dolfinx;
+using namespace dolfinx::common;
+
+//-----------------------------------------------------------------------------
+std::size_t TaskGraph::add(const std::string& name, std::function<void()> f,
+                           const std::vector<Data>& inputs,
+                           const std::vector<Data>& outputs, bool collective)
+{
+  const std::size_t task = _tasks.size();
+  _tasks.push_back({name, std::move(f), collective, {}, {}});
+
+  std::vector<std::size_t> dependencies;
+  for (Data x : inputs)
+  {
+    if (auto it = _writer.find(x); it != _writer.end())
+      dependencies.push_back(it->second);
+  }
+
+  for (Data x : outputs)
+  {
+    if (auto it = _writer.find(x); it != _writer.end())
+      dependencies.push_back(it->second);
+    if (auto it = _readers.find(x); it != _readers.end())
+    {
+      dependencies.insert(dependencies.end(), it->second.begin(),
+                          it->second.end());
+      _readers.erase(it);
+    }
+    _writer[x] = task;
+  }
+
+  // Register the reads after the writes, so that the readers of data
+  // that is read and written by the task are the later tasks
+  for (Data x : inputs)
+  {
+    if (std::find(outputs.begin(), outputs.end(), x) == outputs.end())
+      _readers[x].push_back(task);
+  }
+
+  if (collective)
+  {
+    if (_collective >= 0)
+      dependencies.push_back(_collective);
+    _collective = task;
+  }
+
+  for (std::size_t d : dependencies)
+    add_dependency(task, d);
+
+  return task;
+}
+//-----------------------------------------------------------------------------
+void TaskGraph::add_dependency(std::size_t task, std::size_t dependency)
+{
+  if (task >= _tasks.size() or dependency >= task)
+    throw std::runtime_error("Invalid dependency of task");
+
+  std::vector<std::size_t>& d = _tasks[task].dependencies;
+  auto it = std::lower_bound(d.begin(), d.end(), dependency);
+  if (it == d.end() or *it != dependency)
+  {
+    d.insert(it, dependency);
+    _tasks[dependency].successors.push_back(task);
+  }
+}
+//-----------------------------------------------------------------------------
+std::size_t TaskGraph::size() const { return _tasks.size(); }
+//-----------------------------------------------------------------------------
+const std::vector<std::size_t>&
+TaskGraph::dependencies(std::size_t task) const
+{
+  return _tasks.at(task).dependencies;
+}
+//-----------------------------------------------------------------------------
+void TaskGraph::run() { run(common::thread_pool()); }
+//-----------------------------------------------------------------------------
+void TaskGraph::run(ThreadPool& pool)
+{
+  const std::size_t n = _tasks.size();
+
+  // Number of dependencies of each task that are not complete
+  std::unique_ptr<std::atomic<std::size_t>[]> count(
+      new std::atomic<std::size_t>[n]);
+  for (std::size_t i = 0; i < n; ++i)
+    count[i] = _tasks[i].dependencies.size();
+  std::atomic<std::size_t> remaining(n);
+
+  // Collective tasks that are ready, executed by the calling thread
+  std::mutex mutex;
+  std::deque<std::size_t> collective;
+
+  std::atomic<bool> failed(false);
+  std::exception_ptr error;
+
+  // Execute a task and release the successors that are ready. A task
+  // that is not collective is queued on the pool as soon as it is
+  // ready, and does not block, so that the threads that wait for
+  // nested loops of other tasks may execute it.
+  std::function<void(std::size_t)> execute;
+  auto release = [&](std::size_t i)
+  {
+    if (_tasks[i].collective)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      collective.push_back(i);
+    }
+    else
+      pool.submit([&execute, i]() { execute(i); });
+  };
+
+  execute = [&](std::size_t i)
+  {
+    Task& task = _tasks[i];
+    if (!failed)
+    {
+      try
+      {
+        if (task.name.empty())
+          task.f();
+        else
+        {
+          common::Timer timer("TaskGraph: " + task.name);
+          task.f();
+        }
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error)
+          error = std::current_exception();
+        failed = true;
+      }
+    }
+
+    for (std::size_t s : task.successors)
+    {
+      if (--count[s] == 0)
+        release(s);
+    }
+    --remaining;
+  };
+
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    if (_tasks[i].dependencies.empty())
+      release(i);
+  }
+
+  while (remaining > 0)
+  {
+    std::int64_t i = -1;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!collective.empty())
+      {
+        i = collective.front();
+        collective.pop_front();
+      }
+    }
+
+    if (i >= 0)
+      execute(i);
+    else if (!pool.run_task())
+      std::this_thread::yield();
+  }
+
+  clear();
+  if (error)
+    std::rethrow_exception(error);
+}
+//-----------------------------------------------------------------------------
+void TaskGraph::clear()
+{
+  _tasks.clear();
+  _writer.clear();
+  _readers.clear();
+  _collective = -1;
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,128 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace dolfinx::common
+{
+class ThreadPool;
+
+/// A graph of tasks that are executed concurrently on a ThreadPool, in
+/// an order that respects the dependencies of the tasks.
+///
+/// A task declares the data that it reads and writes, and depends on
+/// the tasks added before it that write data it reads (read after
+/// write), or that read or write data it writes (write after read and
+/// write after write). Independent tasks, e.g. writing the solution of
+/// step n to file and assembling the vector of step n + 1 into a
+/// different vector, are executed concurrently.
+///
+/// Tasks that communicate, e.g. a scatter of a vector, a linear solve
+/// or collective output, are marked as collective. The collective tasks
+/// are executed by the thread that calls TaskGraph::run, in the order
+/// in which they are added, so that every process calls the collective
+/// operations in the same order and MPI is only called by the main
+/// thread (`MPI_THREAD_FUNNELED`). Tasks that are not collective must
+/// not call MPI.
+///
+/// Example of a time step loop in which output of step n overlaps
+/// assembly of step n + 1:
+/// @code
+/// common::TaskGraph graph;
+/// for (int n = 0; n < num_steps; ++n)
+/// {
+///   graph.add("assemble", [&]() { assemble_vector(b, L); }, {&u0},
+///             {&b});
+///   graph.add("scatter", [&]() { b.scatter_rev(...); }, {}, {&b}, true);
+///   graph.add("solve", [&]() { solver.solve(u, b); }, {&b}, {&u}, true);
+///   graph.add("copy", [&]() { copy(u, u0); }, {&u}, {&u0});
+///   graph.run();
+/// }
+/// @endcode
+class TaskGraph
+{
+public:
+  /// Data that is read or written by a task, identified by its address
+  using Data = const void*;
+
+  /// Create an empty graph
+  TaskGraph() = default;
+
+  /// Move constructor
+  TaskGraph(TaskGraph&& graph) = default;
+
+  /// Destructor
+  ~TaskGraph() = default;
+
+  /// Move assignment
+  TaskGraph& operator=(TaskGraph&& graph) = default;
+
+  /// Add a task
+  /// @param[in] name The name of the task. If not empty, the task is
+  /// timed by a common::Timer with the name `TaskGraph: <name>`.
+  /// @param[in] f The function of the task
+  /// @param[in] inputs The data that is read by the task
+  /// @param[in] outputs The data that is written by the task
+  /// @param[in] collective True if the task calls MPI
+  /// @return The index of the task
+  std::size_t add(const std::string& name, std::function<void()> f,
+                  const std::vector<Data>& inputs,
+                  const std::vector<Data>& outputs, bool collective = false);
+
+  /// Add an explicit dependency between two tasks
+  /// @param[in] task The index of the task
+  /// @param[in] dependency The index of a task, which must have been
+  /// added before @p task, that must complete before @p task starts
+  void add_dependency(std::size_t task, std::size_t dependency);
+
+  /// Number of tasks
+  std::size_t size() const;
+
+  /// Get the dependencies of a task
+  /// @param[in] task The index of the task
+  /// @return The sorted indices of the tasks that must complete before
+  /// the task starts
+  const std::vector<std::size_t>& dependencies(std::size_t task) const;
+
+  /// Execute the tasks on the thread pool of the library, see
+  /// common::thread_pool, and remove them from the graph. Returns when
+  /// all tasks are complete.
+  /// @note If a task throws, the tasks that have not started are not
+  /// executed, and the first exception is rethrown after the running
+  /// tasks are complete
+  void run();
+
+  /// Execute the tasks on a thread pool, see TaskGraph::run
+  /// @param[in] pool The thread pool
+  void run(ThreadPool& pool);
+
+  /// Remove the tasks
+  void clear();
+
+private:
+  struct Task
+  {
+    std::string name;
+    std::function<void()> f;
+    bool collective;
+    std::vector<std::size_t> dependencies, successors;
+  };
+  std::vector<Task> _tasks;
+
+  // Last task that writes each data, the tasks that read each data
+  // since the last write, and the last collective task
+  std::map<Data, std::size_t> _writer;
+  std::map<Data, std::vector<std::size_t>> _readers;
+  std::int64_t _collective = -1;
+};
+
+} // namespace dolfinx::common
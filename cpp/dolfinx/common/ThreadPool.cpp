@@ -0,0 +1,208 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "ThreadPool.h"
+#include <cstdlib>
+#include <dolfinx/common/log.h>
+#include <string>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace dolfinx;
+using namespace dolfinx::common;
+
+namespace
+{
+// The pool and the queue of the calling thread, if it is a worker
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local int current_queue = 0;
+
+// The pool of the library, and its configuration. A size of zero uses
+// the environment or the hardware.
+std::mutex pool_mutex;
+std::unique_ptr<ThreadPool> pool;
+int pool_size = 0;
+int pool_pin = -1;
+
+// Get the CPUs that the process may run on
+std::vector<int> affinity()
+{
+  std::vector<int> cpus;
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0)
+  {
+    for (int c = 0; c < CPU_SETSIZE; ++c)
+    {
+      if (CPU_ISSET(c, &set))
+        cpus.push_back(c);
+    }
+  }
+#endif
+  return cpus;
+}
+} // namespace
+
+//-----------------------------------------------------------------------------
+ThreadPool::ThreadPool(int num_threads, bool pin)
+{
+  const int num_workers = std::max(num_threads, 1) - 1;
+  for (int i = 0; i <= num_workers; ++i)
+    _queues.push_back(std::make_unique<Queue>());
+
+  const std::vector<int> cpus = pin ? affinity() : std::vector<int>();
+  if (pin and cpus.empty())
+    LOG(WARNING) << "Pinning of threads is not supported on this system.";
+
+  for (int i = 1; i <= num_workers; ++i)
+  {
+    _threads.emplace_back(&ThreadPool::work, this, i);
+#ifdef __linux__
+    if (!cpus.empty())
+    {
+      // Worker i on CPU i, the calling thread is usually on the first
+      // CPU
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      CPU_SET(cpus[i % cpus.size()], &set);
+      pthread_setaffinity_np(_threads.back().native_handle(), sizeof(set),
+                             &set);
+    }
+#endif
+  }
+}
+//-----------------------------------------------------------------------------
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _cv.notify_all();
+  for (auto& t : _threads)
+    t.join();
+}
+//-----------------------------------------------------------------------------
+int ThreadPool::size() const { return _queues.size(); }
+//-----------------------------------------------------------------------------
+void ThreadPool::submit(std::function<void()> task)
+{
+  const std::size_t q = current_pool == this
+                            ? current_queue
+                            : _next.fetch_add(1) % _queues.size();
+  {
+    std::lock_guard<std::mutex> lock(_queues[q]->mutex);
+    _queues[q]->tasks.push_back(std::move(task));
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    ++_num_tasks;
+  }
+  _cv.notify_one();
+}
+//-----------------------------------------------------------------------------
+bool ThreadPool::run_task()
+{
+  std::function<void()> task;
+
+  // Take the newest task of the own queue, or steal the oldest task of
+  // another queue
+  const std::size_t q0 = current_pool == this ? current_queue : 0;
+  for (std::size_t k = 0; k < _queues.size() and !task; ++k)
+  {
+    Queue& queue = *_queues[(q0 + k) % _queues.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.tasks.empty())
+    {
+      if (k == 0)
+      {
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+      }
+      else
+      {
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+      }
+    }
+  }
+
+  if (!task)
+    return false;
+
+  --_num_tasks;
+  task();
+  return true;
+}
+//-----------------------------------------------------------------------------
+void ThreadPool::wait(const std::atomic<int>& remaining)
+{
+  while (remaining > 0)
+  {
+    if (!run_task())
+      std::this_thread::yield();
+  }
+}
+//-----------------------------------------------------------------------------
+void ThreadPool::work(int i)
+{
+  current_pool = this;
+  current_queue = i;
+  while (true)
+  {
+    if (run_task())
+      continue;
+
+    // Write the buffered log messages of the thread while it is idle
+    log::flush_thread_buffer();
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _cv.wait(lock, [this]() { return _stop or _num_tasks > 0; });
+    if (_stop and _num_tasks == 0)
+      return;
+  }
+}
+//-----------------------------------------------------------------------------
+ThreadPool& common::thread_pool()
+{
+  std::lock_guard<std::mutex> lock(pool_mutex);
+  if (!pool)
+  {
+    int num_threads = pool_size;
+    if (num_threads == 0)
+    {
+      if (const char* env = std::getenv("DOLFINX_NUM_THREADS"))
+        num_threads = std::stoi(env);
+      else
+        num_threads = std::thread::hardware_concurrency();
+    }
+
+    bool pin = pool_pin == 1;
+    if (pool_pin == -1)
+    {
+      const char* env = std::getenv("DOLFINX_PIN_THREADS");
+      pin = env and std::string(env) == "1";
+    }
+
+    pool = std::make_unique<ThreadPool>(num_threads, pin);
+  }
+
+  return *pool;
+}
+//-----------------------------------------------------------------------------
+void common::set_thread_pool(int num_threads, bool pin)
+{
+  std::lock_guard<std::mutex> lock(pool_mutex);
+  pool_size = std::max(num_threads, 0);
+  pool_pin = pin;
+  pool.reset();
+}
+//-----------------------------------------------------------------------------
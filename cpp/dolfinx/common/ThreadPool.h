@@ -0,0 +1,175 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dolfinx::common
+{
+
+/// A pool of worker threads that executes the parallel loops of the
+/// library, see common::for_each_part.
+///
+/// Each worker has a queue of tasks. A worker takes tasks from the back
+/// of its own queue, and steals tasks from the front of the queues of
+/// the other workers when its queue is empty. A thread that waits for
+/// the parts of a loop executes queued tasks while it waits, so loops
+/// can be nested, e.g. a loop over the colours of a mesh in which each
+/// part computes a recursive subdivision in parallel.
+class ThreadPool
+{
+public:
+  /// Create a thread pool
+  /// @param[in] num_threads The number of threads that execute a loop,
+  /// including the thread that calls ThreadPool::parallel_for. The pool
+  /// has `num_threads - 1` worker threads.
+  /// @param[in] pin True to pin each worker thread to one of the CPUs
+  /// that the process may run on, in the order of the CPUs (Linux
+  /// only). If the processes of a job are bound to NUMA domains, e.g.
+  /// by `mpirun --bind-to numa`, the workers of a process then stay in
+  /// the domain of the process.
+  ThreadPool(int num_threads, bool pin = false);
+
+  /// Copy constructor
+  ThreadPool(const ThreadPool& pool) = delete;
+
+  /// Destructor. Waits for the workers to finish the queued tasks.
+  ~ThreadPool();
+
+  /// Assignment operator
+  ThreadPool& operator=(const ThreadPool& pool) = delete;
+
+  /// Number of threads that execute a loop, including the calling
+  /// thread
+  int size() const;
+
+  /// Call f(i0, i1, t) for the contiguous parts [i0, i1) of the range
+  /// [0, n), with up to @p num_threads parts. Part 0 is executed by the
+  /// calling thread and the other parts are executed concurrently by
+  /// the workers. The parts are executed by at most ThreadPool::size
+  /// threads, but the part index t is always in [0, num_threads), so it
+  /// can be used to index per-part data. Returns when all parts are
+  /// complete.
+  /// @param[in] n The size of the range
+  /// @param[in] num_threads The maximum number of parts
+  /// @param[in] f The function to call. It must be safe to call
+  /// concurrently for different parts.
+  /// @return The number of parts
+  /// @note If f throws, the first exception is rethrown after all
+  /// parts are complete
+  template <typename F>
+  int parallel_for(std::int64_t n, int num_threads, F&& f)
+  {
+    const int nt = std::clamp<std::int64_t>(n, 1, std::max(num_threads, 1));
+    if (nt == 1)
+    {
+      f(0, n, 0);
+      return 1;
+    }
+
+    std::atomic<int> remaining(nt - 1);
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto part = [&](int t)
+    {
+      try
+      {
+        f((n * t) / nt, (n * (t + 1)) / nt, t);
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error)
+          error = std::current_exception();
+      }
+    };
+
+    for (int t = 1; t < nt; ++t)
+    {
+      submit(
+          [&part, &remaining, t]()
+          {
+            part(t);
+            --remaining;
+          });
+    }
+    part(0);
+    wait(remaining);
+
+    if (error)
+      std::rethrow_exception(error);
+    return nt;
+  }
+
+  /// Queue a task. The task is queued on the queue of the calling
+  /// thread if it is a worker, or else on a queue chosen in turn. The
+  /// task should not block waiting for other tasks, except by
+  /// ThreadPool::parallel_for.
+  /// @param[in] task The task
+  void submit(std::function<void()> task);
+
+  /// Execute one queued task, taken from the queue of the calling
+  /// thread or stolen from another queue
+  /// @return False if there are no queued tasks
+  bool run_task();
+
+private:
+  // Execute queued tasks until the counter is zero
+  void wait(const std::atomic<int>& remaining);
+
+  // Worker loop of worker i
+  void work(int i);
+
+  // Queues of tasks, with queue 0 for the threads that are not workers
+  // and queue i for worker i
+  struct Queue
+  {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+  std::vector<std::unique_ptr<Queue>> _queues;
+
+  // Number of queued tasks, an index for choosing a queue, the workers
+  // wait on the condition variable when there are no tasks
+  std::atomic<std::int64_t> _num_tasks{0};
+  std::atomic<std::size_t> _next{0};
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  bool _stop = false;
+
+  std::vector<std::thread> _threads;
+};
+
+/// Get the thread pool that is used by the parallel loops of the
+/// library. The pool is created on first use, with the number of
+/// threads set by common::set_thread_pool, or else by the environment
+/// variable `DOLFINX_NUM_THREADS` or else the number of hardware
+/// threads. The workers are pinned if set by common::set_thread_pool,
+/// or else if the environment variable `DOLFINX_PIN_THREADS` is `1`.
+/// @return The thread pool
+ThreadPool& thread_pool();
+
+/// Set the size of the thread pool of the library and if the workers
+/// are pinned, see ThreadPool. The pool is recreated on next use.
+/// @note Must not be called while the pool executes a loop
+/// @param[in] num_threads The number of threads, including the calling
+/// thread. If zero, the number of threads is set by the environment or
+/// the hardware.
+/// @param[in] pin True to pin the workers to CPUs
+void set_thread_pool(int num_threads, bool pin = false);
+
+} // namespace dolfinx::common
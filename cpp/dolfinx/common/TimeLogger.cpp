@@ -7,11 +7,38 @@
 #include "TimeLogger.h"
 #include <dolfinx/common/MPI.h>
 #include <dolfinx/common/log.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
 #include <variant>
 
 using namespace dolfinx;
 using namespace dolfinx::common;
 
+namespace
+{
+// Escape a string for use in a JSON string
+std::string json_escape(const std::string& s)
+{
+  std::string out;
+  out.reserve(s.size());
+  for (char c : s)
+  {
+    if (c == '"' or c == '\\')
+      out += '\\';
+    if (static_cast<unsigned char>(c) < 0x20)
+      out += ' ';
+    else
+      out += c;
+  }
+  return out;
+}
+} // namespace
+
 //-----------------------------------------------------------------------------
 void TimeLogger::register_timing(std::string task, double wall, double user,
                                  double system)
@@ -27,6 +54,7 @@ void TimeLogger::register_timing(std::string task, double wall, double user,
   DLOG(INFO) << line;
 
   // Store values for summary
+  std::lock_guard<std::mutex> lock(_mutex);
   if (auto it = _timings.find(task); it != _timings.end())
   {
     std::get<0>(it->second) += 1;
@@ -38,6 +66,397 @@ void TimeLogger::register_timing(std::string task, double wall, double user,
     _timings.insert({task, {1, wall, user, system}});
 }
 //-----------------------------------------------------------------------------
+void TimeLogger::register_nested_timing(const std::string& path, double wall)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto& [num_timings, total] = _nested_timings[path];
+  num_timings += 1;
+  total += wall;
+}
+//-----------------------------------------------------------------------------
+void TimeLogger::set_trace(bool enable) { _trace = enable; }
+//-----------------------------------------------------------------------------
+bool TimeLogger::trace() const { return _trace; }
+//-----------------------------------------------------------------------------
+void TimeLogger::set_counters(bool enable)
+{
+  if (enable and !perf::available())
+  {
+    throw std::runtime_error("Hardware performance counters are not "
+                             "available (see perf_event_open(2))");
+  }
+  _counters_log = enable;
+}
+//-----------------------------------------------------------------------------
+bool TimeLogger::counters() const { return _counters_log; }
+//-----------------------------------------------------------------------------
+void TimeLogger::register_counters(
+    const std::string& task,
+    const std::array<std::int64_t, perf::num_counters>& counters)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto& totals = _counters[task];
+  for (int i = 0; i < perf::num_counters; ++i)
+    totals[i] += counters[i];
+}
+//-----------------------------------------------------------------------------
+void TimeLogger::register_event(const std::string& task,
+                                std::chrono::system_clock::time_point start,
+                                double wall)
+{
+  if (!_trace)
+    return;
+
+  // Buffer of this thread, which is created by the first event of the
+  // thread. The logger is a singleton, so the buffer stays valid.
+  thread_local std::vector<Event>* events = nullptr;
+  if (!events)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    events = _events.emplace_back(std::make_unique<std::vector<Event>>())
+                 .get();
+  }
+
+  const std::int64_t t0
+      = std::chrono::duration_cast<std::chrono::microseconds>(
+            start.time_since_epoch())
+            .count();
+  events->push_back({task, t0, static_cast<std::int64_t>(wall * 1e6)});
+}
+//-----------------------------------------------------------------------------
+void TimeLogger::write_trace(MPI_Comm mpi_comm, const std::string& filename)
+{
+  // Format the events of this rank as a comma-separated list of
+  // complete ('X') events
+  const int rank = dolfinx::MPI::rank(mpi_comm);
+  std::stringstream ss;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (std::size_t t = 0; t < _events.size(); ++t)
+    {
+      for (const Event& e : *_events[t])
+      {
+        ss << ",\n{\"name\":\"" << json_escape(e.task)
+           << "\",\"cat\":\"dolfinx\",\"ph\":\"X\",\"ts\":" << e.start
+           << ",\"dur\":" << e.duration << ",\"pid\":" << rank
+           << ",\"tid\":" << t << "}";
+      }
+    }
+  }
+  const std::string local = ss.str();
+
+  // Gather the events on rank 0
+  const int size = dolfinx::MPI::size(mpi_comm);
+  const int local_size = local.size();
+  std::vector<int> sizes(size), displs(size + 1, 0);
+  MPI_Gather(&local_size, 1, MPI_INT, sizes.data(), 1, MPI_INT, 0, mpi_comm);
+  std::partial_sum(sizes.begin(), sizes.end(), std::next(displs.begin()));
+  std::string events(displs.back(), ' ');
+  MPI_Gatherv(local.data(), local_size, MPI_CHAR, events.data(), sizes.data(),
+              displs.data(), MPI_CHAR, 0, mpi_comm);
+
+  if (rank == 0)
+  {
+    std::ofstream file(filename);
+    if (!file)
+      throw std::runtime_error("Unable to open file \"" + filename + "\".");
+
+    // Drop the separator before the first event
+    if (!events.empty())
+      events.erase(0, 1);
+    file << "{\"traceEvents\":[" << events << "\n]}\n";
+  }
+}
+//-----------------------------------------------------------------------------
+void TimeLogger::set_communication_log(bool enable)
+{
+  _communication_log = enable;
+}
+//-----------------------------------------------------------------------------
+bool TimeLogger::communication_log() const { return _communication_log; }
+//-----------------------------------------------------------------------------
+void TimeLogger::register_communication(const std::string& site,
+                                        int neighbors, std::int64_t messages,
+                                        std::int64_t bytes, double wait)
+{
+  if (!_communication_log)
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto& [num_calls, total_neighbors, total_messages, total_bytes,
+           total_wait]
+        = _communication[site];
+    num_calls += 1;
+    total_neighbors += neighbors;
+    total_messages += messages;
+    total_bytes += bytes;
+    total_wait += wait;
+  }
+
+  register_timing("MPI wait: " + site, wait, 0.0, 0.0);
+}
+//-----------------------------------------------------------------------------
+Table TimeLogger::communication()
+{
+  Table table("Summary of communication");
+  std::lock_guard<std::mutex> lock(_mutex);
+  for (auto& [site, stats] : _communication)
+  {
+    const auto [num_calls, neighbors, messages, bytes, wait] = stats;
+    const double n = num_calls;
+
+    // NB - the cast to std::variant should not be needed: needed by Intel
+    // compiler.
+    table.set(site, "reps", std::variant<std::string, int, double>(num_calls));
+    table.set(site, "neighbors avg", static_cast<double>(neighbors) / n);
+    table.set(site, "messages avg", static_cast<double>(messages) / n);
+    table.set(site, "bytes avg", static_cast<double>(bytes) / n);
+    table.set(site, "bytes tot", static_cast<double>(bytes));
+    table.set(site, "wait avg", wait / n);
+    table.set(site, "wait tot", wait);
+  }
+
+  return table;
+}
+//-----------------------------------------------------------------------------
+void TimeLogger::list_communication(MPI_Comm mpi_comm)
+{
+  Table table = this->communication();
+  table = table.reduce(mpi_comm, Table::Reduction::average);
+  const std::string str = "\n" + table.str();
+  if (dolfinx::MPI::rank(mpi_comm) == 0)
+    std::cout << str << std::endl;
+}
+//-----------------------------------------------------------------------------
+void TimeLogger::write_communication(MPI_Comm mpi_comm,
+                                     const std::string& filename)
+{
+  // Format the rows of this rank, quoting the site names
+  const int rank = dolfinx::MPI::rank(mpi_comm);
+  std::stringstream ss;
+  ss.precision(std::numeric_limits<double>::max_digits10);
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto& [site, stats] : _communication)
+    {
+      const auto [num_calls, neighbors, messages, bytes, wait] = stats;
+      std::string name;
+      for (char c : site)
+        name += c == '"' ? std::string(2, c) : std::string(1, c);
+      ss << rank << ",\"" << name << "\"," << num_calls << "," << neighbors
+         << "," << messages << "," << bytes << "," << wait << "\n";
+    }
+  }
+  const std::string local = ss.str();
+
+  // Gather the rows on rank 0
+  const int size = dolfinx::MPI::size(mpi_comm);
+  const int local_size = local.size();
+  std::vector<int> sizes(size), displs(size + 1, 0);
+  MPI_Gather(&local_size, 1, MPI_INT, sizes.data(), 1, MPI_INT, 0, mpi_comm);
+  std::partial_sum(sizes.begin(), sizes.end(), std::next(displs.begin()));
+  std::string rows(displs.back(), ' ');
+  MPI_Gatherv(local.data(), local_size, MPI_CHAR, rows.data(), sizes.data(),
+              displs.data(), MPI_CHAR, 0, mpi_comm);
+
+  if (rank == 0)
+  {
+    std::ofstream file(filename);
+    if (!file)
+      throw std::runtime_error("Unable to open file \"" + filename + "\".");
+    file << "rank,site,calls,neighbors,messages,bytes,wait\n" << rows;
+  }
+}
+//-----------------------------------------------------------------------------
+void TimeLogger::register_io(const std::string& site, const std::string& name,
+                             std::int64_t bytes, double time, bool collective)
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto& [num_calls, num_collective, total_bytes, total_time]
+        = _io[{site, name}];
+    num_calls += 1;
+    num_collective += collective;
+    total_bytes += bytes;
+    total_time += time;
+  }
+
+  register_timing("I/O: " + site, time, 0.0, 0.0);
+}
+//-----------------------------------------------------------------------------
+Table TimeLogger::io_statistics()
+{
+  Table table("Summary of I/O");
+  std::lock_guard<std::mutex> lock(_mutex);
+  for (auto& [key, stats] : _io)
+  {
+    const auto [num_calls, num_collective, bytes, time] = stats;
+    const std::string row = key.first + ": " + key.second;
+
+    // NB - the cast to std::variant should not be needed: needed by Intel
+    // compiler.
+    table.set(row, "reps", std::variant<std::string, int, double>(num_calls));
+    table.set(row, "collective",
+              std::variant<std::string, int, double>(num_collective));
+    table.set(row, "bytes tot", static_cast<double>(bytes));
+    table.set(row, "time tot", time);
+    table.set(row, "MB/s", time > 0.0 ? bytes / (1e6 * time) : 0.0);
+  }
+
+  return table;
+}
+//-----------------------------------------------------------------------------
+Table TimeLogger::io_summary(MPI_Comm mpi_comm)
+{
+  // Call sites and names (separated by '\0') and the statistics of this
+  // rank
+  std::string keys;
+  std::vector<double> stats;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto& [key, s] : _io)
+    {
+      keys += key.first + '\0' + key.second + '\0';
+      const auto [num_calls, num_collective, bytes, time] = s;
+      stats.insert(stats.end(), {static_cast<double>(num_calls),
+                                 static_cast<double>(num_collective),
+                                 static_cast<double>(bytes), time});
+    }
+  }
+
+  // Gather the keys and statistics on rank 0
+  const int mpi_size = dolfinx::MPI::size(mpi_comm);
+  std::vector<int> pcounts(mpi_size), offsets(mpi_size + 1, 0);
+  const int local_size_str = keys.size();
+  MPI_Gather(&local_size_str, 1, MPI_INT, pcounts.data(), 1, MPI_INT, 0,
+             mpi_comm);
+  std::partial_sum(pcounts.begin(), pcounts.end(), offsets.begin() + 1);
+  std::vector<char> keys_all(offsets.back());
+  MPI_Gatherv(keys.data(), keys.size(), MPI_CHAR, keys_all.data(),
+              pcounts.data(), offsets.data(), MPI_CHAR, 0, mpi_comm);
+
+  std::vector<int> vcounts(mpi_size), voffsets(mpi_size + 1, 0);
+  const int local_size = stats.size();
+  MPI_Gather(&local_size, 1, MPI_INT, vcounts.data(), 1, MPI_INT, 0,
+             mpi_comm);
+  std::partial_sum(vcounts.begin(), vcounts.end(), voffsets.begin() + 1);
+  std::vector<double> stats_all(voffsets.back());
+  MPI_Gatherv(stats.data(), stats.size(), MPI_DOUBLE, stats_all.data(),
+              vcounts.data(), voffsets.data(), MPI_DOUBLE, 0, mpi_comm);
+
+  Table table("Summary of I/O across ranks");
+  if (dolfinx::MPI::rank(mpi_comm) > 0)
+    return table;
+
+  // Aggregate the statistics of the ranks: (num_ranks, max calls, max
+  // collective calls, total bytes, max time, min bandwidth, slowest
+  // rank)
+  std::map<std::string, std::tuple<int, int, int, double, double, double, int>>
+      summary;
+  for (int p = 0; p < mpi_size; ++p)
+  {
+    std::stringstream s(std::string(keys_all.begin() + offsets[p],
+                                    keys_all.begin() + offsets[p + 1]));
+    std::string site, name;
+    for (int i = voffsets[p]; std::getline(s, site, '\0')
+                              and std::getline(s, name, '\0');
+         i += 4)
+    {
+      const double bytes = stats_all[i + 2];
+      const double time = stats_all[i + 3];
+      auto it = summary
+                    .try_emplace(site + ": " + name, 0, 0, 0, 0.0, -1.0,
+                                 std::numeric_limits<double>::max(), -1)
+                    .first;
+      auto& [ranks, calls, collective, bytes_tot, time_max, bw_min, slowest]
+          = it->second;
+      ranks += 1;
+      calls = std::max(calls, static_cast<int>(stats_all[i]));
+      collective = std::max(collective, static_cast<int>(stats_all[i + 1]));
+      bytes_tot += bytes;
+      if (time > time_max)
+      {
+        time_max = time;
+        slowest = p;
+      }
+      if (time > 0.0)
+        bw_min = std::min(bw_min, bytes / (1e6 * time));
+    }
+  }
+
+  for (auto& [row, s] : summary)
+  {
+    const auto [ranks, calls, collective, bytes, time, bw_min, slowest] = s;
+
+    // NB - the cast to std::variant should not be needed: needed by Intel
+    // compiler.
+    using value_t = std::variant<std::string, int, double>;
+    table.set(row, "ranks", value_t(ranks));
+    table.set(row, "reps", value_t(calls));
+    table.set(row, "collective", value_t(collective));
+    table.set(row, "bytes tot", bytes);
+    table.set(row, "time max", time);
+    table.set(row, "MB/s", time > 0.0 ? bytes / (1e6 * time) : 0.0);
+    table.set(row, "MB/s min",
+              bw_min < std::numeric_limits<double>::max() ? bw_min : 0.0);
+    table.set(row, "slowest rank", value_t(slowest));
+  }
+
+  return table;
+}
+//-----------------------------------------------------------------------------
+void TimeLogger::list_io(MPI_Comm mpi_comm)
+{
+  const Table table = this->io_summary(mpi_comm);
+  if (dolfinx::MPI::rank(mpi_comm) == 0)
+    std::cout << "\n" << table.str() << std::endl;
+}
+//-----------------------------------------------------------------------------
+void TimeLogger::write_io(MPI_Comm mpi_comm, const std::string& filename)
+{
+  // Format the rows of this rank, quoting the site and dataset names
+  const int rank = dolfinx::MPI::rank(mpi_comm);
+  std::stringstream ss;
+  ss.precision(std::numeric_limits<double>::max_digits10);
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto& [key, stats] : _io)
+    {
+      const auto [num_calls, num_collective, bytes, time] = stats;
+      ss << rank;
+      for (const std::string& str : {key.first, key.second})
+      {
+        std::string quoted;
+        for (char c : str)
+          quoted += c == '"' ? std::string(2, c) : std::string(1, c);
+        ss << ",\"" << quoted << "\"";
+      }
+      ss << "," << num_calls << "," << num_collective << "," << bytes << ","
+         << time << "\n";
+    }
+  }
+  const std::string local = ss.str();
+
+  // Gather the rows on rank 0
+  const int size = dolfinx::MPI::size(mpi_comm);
+  const int local_size = local.size();
+  std::vector<int> sizes(size), displs(size + 1, 0);
+  MPI_Gather(&local_size, 1, MPI_INT, sizes.data(), 1, MPI_INT, 0, mpi_comm);
+  std::partial_sum(sizes.begin(), sizes.end(), std::next(displs.begin()));
+  std::string rows(displs.back(), ' ');
+  MPI_Gatherv(local.data(), local_size, MPI_CHAR, rows.data(), sizes.data(),
+              displs.data(), MPI_CHAR, 0, mpi_comm);
+
+  if (rank == 0)
+  {
+    std::ofstream file(filename);
+    if (!file)
+      throw std::runtime_error("Unable to open file \"" + filename + "\".");
+    file << "rank,site,name,calls,collective,bytes,time\n" << rows;
+  }
+}
+//-----------------------------------------------------------------------------
 void TimeLogger::list_timings(MPI_Comm mpi_comm, std::set<TimingType> type)
 {
   // Format and reduce to rank 0
@@ -82,6 +501,197 @@ Table TimeLogger::timings(std::set<TimingType> type)
       table.set(task, "sys avg", sys / static_cast<double>(num_timings));
       table.set(task, "sys tot", sys);
     }
+
+    // Counters, with zeros for tasks that were timed without counters
+    // so that the table is complete
+    if (!_counters.empty())
+    {
+      std::array<std::int64_t, perf::num_counters> c = {0};
+      if (auto it = _counters.find(task); it != _counters.end())
+        c = it->second;
+      const auto [cycles, instructions, misses] = c;
+      table.set(task, "cycles tot", static_cast<double>(cycles));
+      table.set(task, "instr tot", static_cast<double>(instructions));
+      table.set(task, "IPC",
+                cycles > 0 ? static_cast<double>(instructions) / cycles
+                           : 0.0);
+      table.set(task, "LLC miss tot", static_cast<double>(misses));
+      table.set(task, "mem MB/s",
+                wall > 0.0 ? misses * perf::cache_line_size / (1e6 * wall)
+                           : 0.0);
+    }
+  }
+
+  return table;
+}
+//-----------------------------------------------------------------------------
+std::map<std::string, std::vector<double>>
+TimeLogger::gather_timings(MPI_Comm mpi_comm, TimingType type)
+{
+  // Task names (separated by '\0') and total times of this rank
+  std::string tasks;
+  std::vector<double> times;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto& [task, timing] : _timings)
+    {
+      tasks += task + '\0';
+      switch (type)
+      {
+      case TimingType::wall:
+        times.push_back(std::get<1>(timing));
+        break;
+      case TimingType::user:
+        times.push_back(std::get<2>(timing));
+        break;
+      case TimingType::system:
+        times.push_back(std::get<3>(timing));
+        break;
+      }
+    }
+  }
+
+  // Gather the names and times on rank 0
+  const int mpi_size = dolfinx::MPI::size(mpi_comm);
+  std::vector<int> pcounts(mpi_size), offsets(mpi_size + 1, 0);
+  const int local_size_str = tasks.size();
+  MPI_Gather(&local_size_str, 1, MPI_INT, pcounts.data(), 1, MPI_INT, 0,
+             mpi_comm);
+  std::partial_sum(pcounts.begin(), pcounts.end(), offsets.begin() + 1);
+  std::vector<char> tasks_all(offsets.back());
+  MPI_Gatherv(tasks.data(), tasks.size(), MPI_CHAR, tasks_all.data(),
+              pcounts.data(), offsets.data(), MPI_CHAR, 0, mpi_comm);
+
+  std::vector<int> vcounts(mpi_size), voffsets(mpi_size + 1, 0);
+  const int local_size = times.size();
+  MPI_Gather(&local_size, 1, MPI_INT, vcounts.data(), 1, MPI_INT, 0,
+             mpi_comm);
+  std::partial_sum(vcounts.begin(), vcounts.end(), voffsets.begin() + 1);
+  std::vector<double> times_all(voffsets.back());
+  MPI_Gatherv(times.data(), times.size(), MPI_DOUBLE, times_all.data(),
+              vcounts.data(), voffsets.data(), MPI_DOUBLE, 0, mpi_comm);
+
+  std::map<std::string, std::vector<double>> timings;
+  if (dolfinx::MPI::rank(mpi_comm) > 0)
+    return timings;
+
+  for (int p = 0; p < mpi_size; ++p)
+  {
+    std::stringstream s(std::string(tasks_all.begin() + offsets[p],
+                                    tasks_all.begin() + offsets[p + 1]));
+    std::string task;
+    for (int i = voffsets[p]; std::getline(s, task, '\0'); ++i)
+    {
+      auto it = timings.try_emplace(task, mpi_size,
+                                    std::numeric_limits<double>::quiet_NaN())
+                    .first;
+      it->second[p] = times_all[i];
+    }
+  }
+
+  return timings;
+}
+//-----------------------------------------------------------------------------
+Table TimeLogger::timing_imbalance(MPI_Comm mpi_comm, TimingType type)
+{
+  Table table("Load imbalance of timings");
+  for (auto& [task, times] : gather_timings(mpi_comm, type))
+  {
+    // Ranks that timed the task, slowest first
+    std::vector<int> ranks;
+    for (std::size_t p = 0; p < times.size(); ++p)
+    {
+      if (!std::isnan(times[p]))
+        ranks.push_back(p);
+    }
+    std::stable_sort(ranks.begin(), ranks.end(),
+                     [&t = times](int p0, int p1) { return t[p0] > t[p1]; });
+
+    const double n = ranks.size();
+    double sum = 0.0, sum2 = 0.0;
+    for (int p : ranks)
+    {
+      sum += times[p];
+      sum2 += times[p] * times[p];
+    }
+    const double mean = sum / n;
+    const double max = times[ranks.front()];
+
+    std::string slowest;
+    for (std::size_t i = 0; i < std::min<std::size_t>(ranks.size(), 3); ++i)
+      slowest += (i > 0 ? ", " : "") + std::to_string(ranks[i]);
+
+    // NB - the cast to std::variant should not be needed: needed by Intel
+    // compiler.
+    table.set(task, "ranks", std::variant<std::string, int, double>(
+                                 static_cast<int>(ranks.size())));
+    table.set(task, "min", times[ranks.back()]);
+    table.set(task, "mean", mean);
+    table.set(task, "max", max);
+    table.set(task, "stddev",
+              std::sqrt(std::max(sum2 / n - mean * mean, 0.0)));
+    table.set(task, "max/mean", mean > 0.0 ? max / mean : 1.0);
+    table.set(task, "slowest ranks",
+              std::variant<std::string, int, double>(slowest));
+  }
+
+  return table;
+}
+//-----------------------------------------------------------------------------
+void TimeLogger::list_timing_imbalance(MPI_Comm mpi_comm, TimingType type)
+{
+  const Table table = this->timing_imbalance(mpi_comm, type);
+  if (dolfinx::MPI::rank(mpi_comm) == 0)
+    std::cout << "\n" << table.str() << std::endl;
+}
+//-----------------------------------------------------------------------------
+void TimeLogger::write_timing_distribution(MPI_Comm mpi_comm,
+                                           const std::string& filename,
+                                           TimingType type)
+{
+  const std::map<std::string, std::vector<double>> timings
+      = gather_timings(mpi_comm, type);
+  if (dolfinx::MPI::rank(mpi_comm) > 0)
+    return;
+
+  std::ofstream file(filename);
+  if (!file)
+    throw std::runtime_error("Unable to open file \"" + filename + "\".");
+
+  const int mpi_size = dolfinx::MPI::size(mpi_comm);
+  file << "task";
+  for (int p = 0; p < mpi_size; ++p)
+    file << "," << p;
+  file << "\n";
+  file.precision(std::numeric_limits<double>::max_digits10);
+  for (auto& [task, times] : timings)
+  {
+    // Quote the task name, doubling any quotes
+    std::string name;
+    for (char c : task)
+      name += c == '"' ? std::string(2, c) : std::string(1, c);
+    file << '"' << name << '"';
+    for (double t : times)
+    {
+      file << ",";
+      if (!std::isnan(t))
+        file << t;
+    }
+    file << "\n";
+  }
+}
+//-----------------------------------------------------------------------------
+Table TimeLogger::nested_timings()
+{
+  Table table("Summary of nested timings");
+  std::lock_guard<std::mutex> lock(_mutex);
+  for (auto& [path, timing] : _nested_timings)
+  {
+    const auto [num_timings, wall] = timing;
+    table.set(path, "reps",
+              std::variant<std::string, int, double>(num_timings));
+    table.set(path, "wall avg", wall / static_cast<double>(num_timings));
+    table.set(path, "wall tot", wall);
   }
 
   return table;
@@ -6,13 +6,22 @@
 
 #pragma once
 
+#include "perf.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <dolfinx/common/Table.h>
 #include <dolfinx/common/timing.h>
 #include <map>
+#include <memory>
 #include <mpi.h>
+#include <mutex>
 #include <set>
 #include <string>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 namespace dolfinx::common
 {
@@ -38,7 +47,141 @@ public:
   void register_timing(std::string task, double wall, double user,
                        double system);
 
-  /// Return a summary of timings and tasks in a Table
+  /// Register the wall time of a task by its nesting in other tasks
+  /// (for later summary)
+  /// @param[in] path The names of the enclosing tasks, outermost first,
+  /// and of the task, separated by " > "
+  /// @param[in] wall The wall time
+  void register_nested_timing(const std::string& path, double wall);
+
+  /// Enable or disable the recording of trace events
+  /// @param[in] enable True to record trace events
+  void set_trace(bool enable);
+
+  /// Return true if trace events are recorded
+  bool trace() const;
+
+  /// Record a trace event for a timing. The events are stored per
+  /// thread, so that threads do not synchronise when recording events.
+  /// Events are not recorded if tracing is disabled.
+  /// @param[in] task The task name
+  /// @param[in] start The start of the timing
+  /// @param[in] wall The wall time
+  void register_event(const std::string& task,
+                      std::chrono::system_clock::time_point start,
+                      double wall);
+
+  /// Write the recorded trace events of all ranks to a file in the
+  /// Chrome trace event format (JSON), which can be viewed with e.g.
+  /// chrome://tracing or Perfetto. Each rank is a process of the trace
+  /// and each thread that recorded events is a thread of the process.
+  /// @note Collective MPI operation. The file is written by rank 0.
+  /// @note Must not be called while other threads record events
+  /// @param[in] mpi_comm MPI Communicator
+  /// @param[in] filename The name of the file
+  void write_trace(MPI_Comm mpi_comm, const std::string& filename);
+
+  /// Enable or disable the recording of the hardware counters of named
+  /// timers
+  /// @param[in] enable True to record hardware counters
+  /// @throws std::runtime_error if enabled and the counters are not
+  /// available on the calling thread
+  void set_counters(bool enable);
+
+  /// Return true if the hardware counters of named timers are recorded
+  bool counters() const;
+
+  /// Register the hardware counters of a timing (for later summary)
+  /// @param[in] task The task name
+  /// @param[in] counters The number of CPU cycles, instructions and
+  /// last level cache misses of the timing
+  void register_counters(
+      const std::string& task,
+      const std::array<std::int64_t, perf::num_counters>& counters);
+
+  /// Enable or disable the recording of communication statistics
+  /// @param[in] enable True to record communication statistics
+  void set_communication_log(bool enable);
+
+  /// Return true if communication statistics are recorded
+  bool communication_log() const;
+
+  /// Register the statistics of a communication (for later summary).
+  /// The wait time is also registered as the timing of the task
+  /// "MPI wait: <site>". Nothing is registered if the recording of
+  /// communication statistics is disabled.
+  /// @param[in] site The name of the call site
+  /// @param[in] neighbors The number of ranks that data could be
+  /// received from
+  /// @param[in] messages The number of non-empty messages received
+  /// @param[in] bytes The number of bytes received
+  /// @param[in] wait The wall time spent waiting for the communication
+  /// to complete
+  void register_communication(const std::string& site, int neighbors,
+                              std::int64_t messages, std::int64_t bytes,
+                              double wait);
+
+  /// Return a summary of the communication statistics of this rank by
+  /// call site in a Table
+  Table communication();
+
+  /// List a summary of the communication statistics by call site.
+  /// ``MPI_AVG`` reduction is printed.
+  /// @note Collective MPI operation
+  /// @param mpi_comm MPI Communicator
+  void list_communication(MPI_Comm mpi_comm);
+
+  /// Write the communication statistics of each rank of a communicator
+  /// to a file in CSV format, with one row per rank and call site
+  /// @note Collective MPI operation. The file is written by rank 0.
+  /// @param[in] mpi_comm MPI Communicator
+  /// @param[in] filename The name of the file
+  void write_communication(MPI_Comm mpi_comm, const std::string& filename);
+
+  /// Register the statistics of a read or write of a dataset or file
+  /// (for later summary). The time is also registered as the timing of
+  /// the task "I/O: <site>".
+  /// @param[in] site The name of the call site, e.g. "HDF5 write"
+  /// @param[in] name The name of the dataset or file
+  /// @param[in] bytes The number of bytes read or written by this rank
+  /// @param[in] time The wall time of the read or write
+  /// @param[in] collective True if the read or write is a collective
+  /// MPI-IO operation
+  void register_io(const std::string& site, const std::string& name,
+                   std::int64_t bytes, double time, bool collective);
+
+  /// Return a summary of the I/O statistics of this rank by call site
+  /// and dataset in a Table
+  Table io_statistics();
+
+  /// Return a summary of the I/O statistics across the ranks of a
+  /// communicator in a Table. For each call site and dataset, the
+  /// columns are: number of ranks, calls and collective calls (max
+  /// over the ranks), total bytes of the ranks, max time, aggregate
+  /// bandwidth (total bytes / max time), min bandwidth of a rank and
+  /// the slowest rank.
+  /// @note Collective MPI operation. The Table is empty on ranks other
+  /// than rank 0.
+  /// @param[in] mpi_comm MPI Communicator
+  Table io_summary(MPI_Comm mpi_comm);
+
+  /// List the summary of the I/O statistics across the ranks of a
+  /// communicator, see TimeLogger::io_summary
+  /// @note Collective MPI operation. The summary is printed by rank 0.
+  /// @param[in] mpi_comm MPI Communicator
+  void list_io(MPI_Comm mpi_comm);
+
+  /// Write the I/O statistics of each rank of a communicator to a file
+  /// in CSV format, with one row per rank, call site and dataset
+  /// @note Collective MPI operation. The file is written by rank 0.
+  /// @param[in] mpi_comm MPI Communicator
+  /// @param[in] filename The name of the file
+  void write_io(MPI_Comm mpi_comm, const std::string& filename);
+
+  /// Return a summary of timings and tasks in a Table. If hardware
+  /// counters have been recorded, the totals of the counters, the
+  /// instructions per cycle and the memory bandwidth estimated from the
+  /// last level cache misses are also given for each task.
   Table timings(std::set<TimingType> type);
 
   /// List a summary of timings and tasks. ``MPI_AVG`` reduction is
@@ -47,6 +190,42 @@ public:
   /// @param type Set of possible timings: wall, user or system
   void list_timings(MPI_Comm mpi_comm, std::set<TimingType> type);
 
+  /// Return a summary of the load imbalance of the tasks across the
+  /// ranks of a communicator in a Table. For each task, the total times
+  /// of the ranks that timed the task give the columns: number of
+  /// ranks, min, mean, max, standard deviation, max/mean, and the
+  /// slowest ranks (up to three, slowest first).
+  /// @note Collective MPI operation. The Table is empty on ranks other
+  /// than rank 0.
+  /// @param[in] mpi_comm MPI Communicator
+  /// @param[in] type The type of time to compare
+  Table timing_imbalance(MPI_Comm mpi_comm, TimingType type);
+
+  /// List the summary of the load imbalance of the tasks across the
+  /// ranks of a communicator, see TimeLogger::timing_imbalance
+  /// @note Collective MPI operation. The summary is printed by rank 0.
+  /// @param[in] mpi_comm MPI Communicator
+  /// @param[in] type The type of time to compare
+  void list_timing_imbalance(MPI_Comm mpi_comm, TimingType type);
+
+  /// Write the total time of each task on each rank of a communicator
+  /// to a file in CSV format, with one row per task and one column per
+  /// rank, e.g. for histograms of the distribution over the ranks.
+  /// Entries for ranks that did not time a task are empty.
+  /// @note Collective MPI operation. The file is written by rank 0.
+  /// @param[in] mpi_comm MPI Communicator
+  /// @param[in] filename The name of the file
+  /// @param[in] type The type of time to write
+  void write_timing_distribution(MPI_Comm mpi_comm,
+                                 const std::string& filename,
+                                 TimingType type);
+
+  /// Return a summary of the wall times of tasks by their nesting in
+  /// other tasks in a Table. The rows are the paths of the tasks (see
+  /// TimeLogger::register_nested_timing), so that the row of a task
+  /// follows the row of the enclosing task.
+  Table nested_timings();
+
   /// Return timing
   /// @param[in] task The task name to retrieve the timing for
   /// @returns Values (count, total wall time, total user time, total
@@ -54,8 +233,53 @@ public:
   std::tuple<int, double, double, double> timing(std::string task);
 
 private:
+  // Gather the total time of each task on each rank to rank 0, map from
+  // task to the times of the ranks (NaN if a rank did not time the
+  // task). The map is empty on other ranks.
+  std::map<std::string, std::vector<double>>
+  gather_timings(MPI_Comm mpi_comm, TimingType type);
+
   // List of timings for tasks, map from string to (num_timings,
   // total_wall_time, total_user_time, total_system_time)
   std::map<std::string, std::tuple<int, double, double, double>> _timings;
+
+  // Timings by path of the task, map from path to (num_timings,
+  // total_wall_time)
+  std::map<std::string, std::pair<int, double>> _nested_timings;
+
+  // Totals of the hardware counters by task
+  std::map<std::string, std::array<std::int64_t, perf::num_counters>>
+      _counters;
+  std::atomic<bool> _counters_log = false;
+
+  // Communication statistics by call site, map from site to
+  // (num_calls, total_neighbors, total_messages, total_bytes,
+  // total_wait)
+  std::map<std::string, std::tuple<int, std::int64_t, std::int64_t,
+                                   std::int64_t, double>>
+      _communication;
+  std::atomic<bool> _communication_log = false;
+
+  // I/O statistics by call site and dataset, map from (site, name) to
+  // (num_calls, num_collective_calls, total_bytes, total_time)
+  std::map<std::pair<std::string, std::string>,
+           std::tuple<int, int, std::int64_t, double>>
+      _io;
+
+  // Trace event (task, start and duration in microseconds)
+  struct Event
+  {
+    std::string task;
+    std::int64_t start, duration;
+  };
+
+  // Recorded trace events of each thread
+  std::vector<std::unique_ptr<std::vector<Event>>> _events;
+  std::atomic<bool> _trace = false;
+
+  // Protects the timings, the hardware counters, the communication and
+  // I/O statistics and the list of event buffers, which may be changed
+  // on different threads
+  std::mutex _mutex;
 };
 } // namespace dolfinx::common
@@ -6,29 +6,53 @@
 
 #include "Timer.h"
 #include "TimeLogManager.h"
+#include <algorithm>
 #include <stdexcept>
+#include <utility>
+#include <vector>
 
 using namespace dolfinx;
 using namespace dolfinx::common;
 
-//-----------------------------------------------------------------------------
-Timer::Timer() : Timer::Timer("")
+namespace
 {
-  // Do nothing
+// Named timers that are running on this thread, in the order in which
+// they were started, with the names of their tasks
+thread_local std::vector<std::pair<const Timer*, const std::string*>>
+    running_timers;
+
+// Find a timer in the running timers
+auto find_running(const Timer* timer)
+{
+  return std::find_if(running_timers.begin(), running_timers.end(),
+                      [timer](auto& t) { return t.first == timer; });
 }
+} // namespace
+
 //-----------------------------------------------------------------------------
-Timer::Timer(const std::string& task) : _task(task)
+Timer::Timer() : Timer::Timer("")
 {
   // Do nothing
 }
 //-----------------------------------------------------------------------------
+Timer::Timer(const std::string& task) : _task(task) { begin_task(); }
+//-----------------------------------------------------------------------------
 Timer::~Timer()
 {
   if (!_timer.is_stopped())
     stop();
+  else if (!_task.empty())
+  {
+    if (auto it = find_running(this); it != running_timers.end())
+      running_timers.erase(it);
+  }
 }
 //-----------------------------------------------------------------------------
-void Timer::start() { _timer.start(); }
+void Timer::start()
+{
+  _timer.start();
+  begin_task();
+}
 //-----------------------------------------------------------------------------
 void Timer::resume()
 {
@@ -44,12 +68,56 @@ void Timer::resume()
 double Timer::stop()
 {
   _timer.stop();
+  std::array<std::int64_t, perf::num_counters> counters = {0};
+  if (_counted)
+  {
+    counters = perf::read();
+    for (int i = 0; i < perf::num_counters; ++i)
+      counters[i] -= _counters_start[i];
+  }
+
   const auto [wall, user, system] = this->elapsed();
   if (!_task.empty())
-    TimeLogManager::logger().register_timing(_task, wall, user, system);
+  {
+    // Path of the task below the timers that were started before it
+    std::string path;
+    auto it = find_running(this);
+    for (auto t = running_timers.begin(); t != it; ++t)
+      path += *t->second + " > ";
+    path += _task;
+    if (it != running_timers.end())
+      running_timers.erase(it);
+
+    TimeLogger& logger = TimeLogManager::logger();
+    logger.register_timing(_task, wall, user, system);
+    logger.register_nested_timing(path, wall);
+    if (_traced)
+      logger.register_event(_task, _start_time, wall);
+    if (_counted)
+      logger.register_counters(_task, counters);
+  }
   return wall;
 }
 //-----------------------------------------------------------------------------
+void Timer::begin_task()
+{
+  if (_task.empty())
+    return;
+
+  // Move the timer to the end of the running timers if it is re-started
+  if (auto it = find_running(this); it != running_timers.end())
+    running_timers.erase(it);
+  running_timers.emplace_back(this, &_task);
+
+  TimeLogger& logger = TimeLogManager::logger();
+  _traced = logger.trace();
+  if (_traced)
+    _start_time = std::chrono::system_clock::now();
+  _counted = logger.counters();
+  if (_counted)
+    _counters_start = perf::read();
+}
+//-----------------------------------------------------------------------------
 std::array<double, 3> Timer::elapsed() const
 {
   const boost::timer::cpu_times elapsed = _timer.elapsed();
@@ -6,8 +6,10 @@
 
 #pragma once
 
+#include "perf.h"
 #include <array>
 #include <boost/timer/timer.hpp>
+#include <chrono>
 #include <string>
 
 namespace dolfinx::common
@@ -26,6 +28,15 @@ namespace dolfinx::common
 /// Timings are stored globally and a summary may be printed by calling
 ///
 ///   list_timings();
+///
+/// Named timers that are started while another named timer is running
+/// on the same thread are nested in it, and their timings are also
+/// summarised by nesting (see nested_timings). If tracing is enabled
+/// (see set_timer_trace), the start and duration of each timing are
+/// recorded for export as a timeline (see write_timer_trace). If
+/// hardware counters are enabled (see set_timer_counters), the CPU
+/// cycles, instructions and last level cache misses of the thread that
+/// starts and stops a named timer are also recorded.
 
 class Timer
 {
@@ -58,5 +69,17 @@ private:
 
   // Implementation of timer
   boost::timer::cpu_timer _timer;
+
+  // Start of the current timing, if it is recorded as a trace event
+  std::chrono::system_clock::time_point _start_time;
+  bool _traced = false;
+
+  // Hardware counters at the start of the current timing, if they are
+  // recorded
+  std::array<std::int64_t, perf::num_counters> _counters_start;
+  bool _counted = false;
+
+  // Register the timer as running on this thread
+  void begin_task();
 };
 } // namespace dolfinx::common
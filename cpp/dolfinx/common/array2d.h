@@ -6,8 +6,10 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <cstdint>
 #include <vector>
 #include <xtl/xspan.hpp>
 
@@ -15,7 +17,11 @@ namespace dolfinx
 {
 
 /// This class provides a dynamic 2-dimensional row-wise array data
-/// structure
+/// structure.
+///
+/// The rows are stored back-to-back, or, for an array created by
+/// array2d::padded, padded to a multiple of a SIMD width and aligned,
+/// see array2d::stride.
 template <typename T, class Allocator = std::allocator<T>>
 class array2d
 {
@@ -37,7 +43,8 @@ public:
   /// @param[in] alloc The memory allocator for the data storage
   array2d(std::array<size_type, 2> shape, value_type value = T(),
           const Allocator& alloc = Allocator())
-      : shape(shape), _storage(shape[0] * shape[1], value, alloc)
+      : shape(shape), _storage(shape[0] * shape[1], value, alloc),
+        _stride(shape[1])
   {
   }
 
@@ -48,7 +55,8 @@ public:
   /// @param[in] alloc The memory allocator for the data storage
   array2d(size_type rows, size_type cols, value_type value = T(),
           const Allocator& alloc = Allocator())
-      : shape({rows, cols}), _storage(shape[0] * shape[1], value, alloc)
+      : shape({rows, cols}), _storage(shape[0] * shape[1], value, alloc),
+        _stride(shape[1])
   {
   }
 
@@ -56,7 +64,7 @@ public:
   /// Constructs a two dimensional array from a vector
   template <typename Vector>
   array2d(std::array<size_type, 2> shape, Vector&& x)
-      : shape(shape), _storage(std::forward<Vector>(x))
+      : shape(shape), _storage(std::forward<Vector>(x)), _stride(shape[1])
   {
     // Do nothing
   }
@@ -64,7 +72,7 @@ public:
   /// Construct a two dimensional array using nested initializer lists
   /// @param[in] list The nested initializer list
   constexpr array2d(std::initializer_list<std::initializer_list<T>> list)
-      : shape({list.size(), (*list.begin()).size()})
+      : shape({list.size(), (*list.begin()).size()}), _stride(shape[1])
   {
     _storage.reserve(shape[0] * shape[1]);
     for (std::initializer_list<T> l : list)
@@ -72,8 +80,41 @@ public:
         _storage.push_back(val);
   }
 
+  /// Construct a two dimensional array with padded, aligned rows. Each
+  /// row is padded to a multiple of @p width values, and starts at an
+  /// address that is a multiple of `width * sizeof(T)` bytes, so that
+  /// kernels may use aligned SIMD loads of the rows.
+  /// @param[in] shape The shape the array {rows, cols}
+  /// @param[in] width The SIMD width (number of values).
+  /// `width * sizeof(T)` must be a power of two.
+  /// @param[in] value Initial value for all entries, including the
+  /// padding
+  /// @param[in] alloc The memory allocator for the data storage
+  /// @return The array
+  static array2d padded(std::array<size_type, 2> shape, size_type width,
+                        value_type value = T(),
+                        const Allocator& alloc = Allocator())
+  {
+    assert(width > 0);
+    const size_type alignment = width * sizeof(T);
+    assert((alignment & (alignment - 1)) == 0);
+    const size_type stride = ((shape[1] + width - 1) / width) * width;
+    array2d x(shape,
+              std::vector<T, Allocator>(shape[0] * stride + width - 1, value,
+                                        alloc));
+    x._stride = stride;
+    x._alignment = alignment;
+    x.realign();
+    return x;
+  }
+
   /// Copy constructor
-  array2d(const array2d& x) = default;
+  array2d(const array2d& x)
+      : shape(x.shape), _storage(x._storage), _stride(x._stride),
+        _offset(x._offset), _alignment(x._alignment)
+  {
+    realign();
+  }
 
   /// Move constructor
   array2d(array2d&& x) = default;
@@ -82,7 +123,16 @@ public:
   ~array2d() = default;
 
   /// Copy assignment
-  array2d& operator=(const array2d& x) = default;
+  array2d& operator=(const array2d& x)
+  {
+    shape = x.shape;
+    _storage = x._storage;
+    _stride = x._stride;
+    _offset = x._offset;
+    _alignment = x._alignment;
+    realign();
+    return *this;
+  }
 
   /// Move assignment
   array2d& operator=(array2d&& x) = default;
@@ -94,7 +144,7 @@ public:
   /// @note No bounds checking is performed
   constexpr reference operator()(size_type i, size_type j)
   {
-    return _storage[i * shape[1] + j];
+    return _storage[_offset + i * _stride + j];
   }
 
   /// Return a reference to the element at specified location (i, j)
@@ -105,7 +155,7 @@ public:
   /// @note No bounds checking is performed
   constexpr const_reference operator()(size_type i, size_type j) const
   {
-    return _storage[i * shape[1] + j];
+    return _storage[_offset + i * _stride + j];
   }
 
   /// Access a row in the array
@@ -113,8 +163,7 @@ public:
   /// @return Span of the row data
   constexpr xtl::span<value_type> row(size_type i)
   {
-    return xtl::span<value_type>(std::next(_storage.data(), i * shape[1]),
-                                 shape[1]);
+    return xtl::span<value_type>(std::next(data(), i * _stride), shape[1]);
   }
 
   /// Access a row in the array (const version)
@@ -122,29 +171,48 @@ public:
   /// @return Span of the row data
   constexpr xtl::span<const value_type> row(size_type i) const
   {
-    return xtl::span<const value_type>(std::next(_storage.data(), i * shape[1]),
+    return xtl::span<const value_type>(std::next(data(), i * _stride),
                                        shape[1]);
   }
 
   /// Get pointer to the first element of the underlying storage
   /// @warning Use this with caution - the data storage may be strided
-  constexpr value_type* data() noexcept { return _storage.data(); }
+  constexpr value_type* data() noexcept
+  {
+    return std::next(_storage.data(), _offset);
+  }
 
   /// Get pointer to the first element of the underlying storage (const
   /// version)
   /// @warning Use this with caution - the data storage may be strided
-  constexpr const value_type* data() const noexcept { return _storage.data(); };
+  constexpr const value_type* data() const noexcept
+  {
+    return std::next(_storage.data(), _offset);
+  }
 
   /// Returns the number of elements in the array
   /// @warning Use this caution - the data storage may be strided, i.e.
   /// the size of the underlying storage may be greater than
   /// sizeof(T)*(rows * cols)
-  constexpr size_type size() const noexcept { return _storage.size(); }
+  constexpr size_type size() const noexcept
+  {
+    return _alignment == 0 ? _storage.size() : shape[0] * _stride;
+  }
 
-  /// Returns the strides of the array
+  /// Number of values between the start of consecutive rows, which is
+  /// larger than the number of columns for a padded array
+  constexpr size_type stride() const noexcept { return _stride; }
+
+  /// Returns the strides of the array (bytes)
   constexpr std::array<size_type, 2> strides() const noexcept
   {
-    return {shape[1] * sizeof(T), sizeof(T)};
+    return {_stride * sizeof(T), sizeof(T)};
+  }
+
+  /// Get the allocator of the underlying storage
+  allocator_type get_allocator() const noexcept
+  {
+    return _storage.get_allocator();
   }
 
   /// Checks whether the container is empty
@@ -155,6 +223,38 @@ public:
   std::array<size_type, 2> shape;
 
 private:
+  // Move the values of a padded array to the first aligned position of
+  // the storage, e.g. after a copy to new storage
+  void realign()
+  {
+    if (_alignment == 0)
+      return;
+
+    const std::uintptr_t p = reinterpret_cast<std::uintptr_t>(_storage.data());
+    assert(p % sizeof(T) == 0);
+    const size_type offset
+        = ((_alignment - p % _alignment) % _alignment) / sizeof(T);
+    const size_type n = shape[0] * _stride;
+    auto first = std::next(_storage.begin(), _offset);
+    if (offset < _offset)
+    {
+      std::copy(first, std::next(first, n),
+                std::next(_storage.begin(), offset));
+    }
+    else if (offset > _offset)
+    {
+      std::copy_backward(first, std::next(first, n),
+                         std::next(_storage.begin(), offset + n));
+    }
+    _offset = offset;
+  }
+
   std::vector<T, Allocator> _storage;
+
+  // Number of values between rows, offset of the first value in the
+  // storage and the alignment (bytes) of the rows (0 if not padded)
+  size_type _stride;
+  size_type _offset = 0;
+  size_type _alignment = 0;
 };
 } // namespace dolfinx
@@ -0,0 +1,177 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "cpu.h"
+#include "math.h"
+
+// With dispatch, each kernel is compiled for AVX-512, AVX2 and the
+// target of the build. The dynamic loader calls a resolver that
+// selects the version for the CPU (GNU indirect functions), so a call
+// costs the same as a call through a function pointer.
+#if defined(DOLFINX_CPU_DISPATCH) and defined(__x86_64__)                      \
+    and defined(__GNUC__) and defined(__linux__)
+#define DOLFINX_HAS_CPU_DISPATCH
+#define DOLFINX_CPU_CLONES                                                     \
+  __attribute__((target_clones("avx512f", "avx2", "default"), flatten))
+#else
+#define DOLFINX_CPU_CLONES
+#endif
+
+using namespace dolfinx;
+
+namespace
+{
+//-----------------------------------------------------------------------------
+template <typename T>
+inline T dot_impl(const T* x, const T* y, std::size_t n)
+{
+  // Accumulate in several partial sums so that the loop is vectorised
+  // without reassociation
+  constexpr std::size_t w = 8;
+  T s[w] = {0};
+  std::size_t i = 0;
+  for (; i + w <= n; i += w)
+    for (std::size_t j = 0; j < w; ++j)
+      s[j] += x[i + j] * y[i + j];
+  T sum = 0;
+  for (std::size_t j = 0; j < w; ++j)
+    sum += s[j];
+  for (; i < n; ++i)
+    sum += x[i] * y[i];
+  return sum;
+}
+//-----------------------------------------------------------------------------
+template <typename T>
+inline void axpy_impl(T* r, T alpha, const T* x, const T* y, std::size_t n)
+{
+  for (std::size_t i = 0; i < n; ++i)
+    r[i] = alpha * x[i] + y[i];
+}
+//-----------------------------------------------------------------------------
+// Call f with the block size as a compile-time constant for the common
+// block sizes
+template <typename F>
+inline void dispatch_block_size(int bs, F&& f)
+{
+  switch (bs)
+  {
+  case 1:
+    f(std::integral_constant<int, 1>());
+    break;
+  case 2:
+    f(std::integral_constant<int, 2>());
+    break;
+  case 3:
+    f(std::integral_constant<int, 3>());
+    break;
+  default:
+    f(bs);
+  }
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
+//-----------------------------------------------------------------------------
+cpu::isa cpu::detected_isa()
+{
+#ifdef DOLFINX_HAS_CPU_DISPATCH
+  // Same order of preference as the resolver of the kernels
+  if (__builtin_cpu_supports("avx512f"))
+    return isa::avx512;
+  else if (__builtin_cpu_supports("avx2"))
+    return isa::avx2;
+#endif
+  return isa::generic;
+}
+//-----------------------------------------------------------------------------
+std::string cpu::to_string(isa i)
+{
+  switch (i)
+  {
+  case isa::avx2:
+    return "avx2";
+  case isa::avx512:
+    return "avx512";
+  default:
+    return "generic";
+  }
+}
+//-----------------------------------------------------------------------------
+bool cpu::has_dispatch()
+{
+#ifdef DOLFINX_HAS_CPU_DISPATCH
+  return true;
+#else
+  return false;
+#endif
+}
+//-----------------------------------------------------------------------------
+DOLFINX_CPU_CLONES
+double cpu::dot(const double* x, const double* y, std::size_t n)
+{
+  return dot_impl(x, y, n);
+}
+//-----------------------------------------------------------------------------
+DOLFINX_CPU_CLONES
+float cpu::dot(const float* x, const float* y, std::size_t n)
+{
+  return dot_impl(x, y, n);
+}
+//-----------------------------------------------------------------------------
+DOLFINX_CPU_CLONES
+void cpu::axpy(double* r, double alpha, const double* x, const double* y,
+               std::size_t n)
+{
+  axpy_impl(r, alpha, x, y, n);
+}
+//-----------------------------------------------------------------------------
+DOLFINX_CPU_CLONES
+void cpu::axpy(float* r, float alpha, const float* x, const float* y,
+               std::size_t n)
+{
+  axpy_impl(r, alpha, x, y, n);
+}
+//-----------------------------------------------------------------------------
+DOLFINX_CPU_CLONES
+void cpu::gather(const std::int32_t* idx, std::size_t n, int bs,
+                 const double* in, double* out)
+{
+  dispatch_block_size(bs,
+                      [&](auto bs)
+                      {
+                        for (std::size_t i = 0; i < n; ++i)
+                          for (int j = 0; j < bs; ++j)
+                            out[bs * i + j] = in[bs * idx[i] + j];
+                      });
+}
+//-----------------------------------------------------------------------------
+DOLFINX_CPU_CLONES
+void cpu::scatter_add(const std::int32_t* idx, std::size_t n, int bs,
+                      const double* in, double* out)
+{
+  dispatch_block_size(bs,
+                      [&](auto bs)
+                      {
+                        for (std::size_t i = 0; i < n; ++i)
+                          for (int j = 0; j < bs; ++j)
+                            out[bs * idx[i] + j] += in[bs * i + j];
+                      });
+}
+//-----------------------------------------------------------------------------
+DOLFINX_CPU_CLONES
+void cpu::det_batch(std::size_t m, std::size_t n, const double* A,
+                    double* detA)
+{
+  math::det_batch<double>(m, n, A, detA);
+}
+//-----------------------------------------------------------------------------
+DOLFINX_CPU_CLONES
+void cpu::pinv_batch(std::size_t m, std::size_t k, std::size_t n,
+                     const double* A, double* B, double* detA)
+{
+  math::pinv_batch<double>(m, k, n, A, B, detA);
+}
+//-----------------------------------------------------------------------------
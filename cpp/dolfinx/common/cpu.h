@@ -0,0 +1,89 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/// Kernels that are compiled for several instruction sets, with the
+/// instruction set selected when the library is loaded by detecting
+/// the features of the CPU. This allows a single build of DOLFINx to
+/// use AVX2 or AVX-512 on the CPUs that support them. Dispatch is
+/// enabled with the CMake option DOLFINX_CPU_DISPATCH on x86-64 with
+/// GCC or Clang, otherwise the kernels are compiled once for the
+/// target of the build.
+namespace dolfinx::cpu
+{
+
+/// Instruction sets that the kernels are compiled for
+enum class isa
+{
+  generic,
+  avx2,
+  avx512
+};
+
+/// Instruction set used by the kernels on the CPU that the process
+/// runs on
+/// @return The instruction set, which is isa::generic if dispatch is
+/// disabled
+isa detected_isa();
+
+/// Name of an instruction set
+/// @param[in] i The instruction set
+/// @return The name
+std::string to_string(isa i);
+
+/// Return true if the kernels are compiled for several instruction
+/// sets and selected at run time
+bool has_dispatch();
+
+/// Compute the sum of x[i] * y[i] for i < n
+double dot(const double* x, const double* y, std::size_t n);
+
+/// Compute the sum of x[i] * y[i] for i < n
+float dot(const float* x, const float* y, std::size_t n);
+
+/// Compute r[i] = alpha * x[i] + y[i] for i < n. @p r may be @p y.
+void axpy(double* r, double alpha, const double* x, const double* y,
+          std::size_t n);
+
+/// Compute r[i] = alpha * x[i] + y[i] for i < n. @p r may be @p y.
+void axpy(float* r, float alpha, const float* x, const float* y,
+          std::size_t n);
+
+/// Gather blocks of values, `out[bs * i + j] = in[bs * idx[i] + j]`
+/// for i < n, see common::Scatterer::gather
+/// @param[in] idx The block indices in @p in (size n)
+/// @param[in] n The number of blocks
+/// @param[in] bs The block size
+/// @param[in] in The values to gather from
+/// @param[out] out The gathered values (size bs * n)
+void gather(const std::int32_t* idx, std::size_t n, int bs,
+            const double* in, double* out);
+
+/// Add blocks of values, `out[bs * idx[i] + j] += in[bs * i + j]` for
+/// i < n, see common::Scatterer::scatter
+/// @param[in] idx The block indices in @p out (size n)
+/// @param[in] n The number of blocks
+/// @param[in] bs The block size
+/// @param[in] in The values to add (size bs * n)
+/// @param[in,out] out The values to add to
+void scatter_add(const std::int32_t* idx, std::size_t n, int bs,
+                 const double* in, double* out);
+
+/// Compute the determinants of n square matrices, see math::det_batch
+void det_batch(std::size_t m, std::size_t n, const double* A,
+               double* detA);
+
+/// Compute the (pseudo-)inverses of n matrices, and optionally their
+/// (pseudo-)determinants, see math::pinv_batch
+void pinv_batch(std::size_t m, std::size_t k, std::size_t n,
+                const double* A, double* B, double* detA = nullptr);
+
+} // namespace dolfinx::cpu
@@ -41,4 +41,10 @@ bool has_parmetis();
 /// Return true if DOLFINx is compiled with KaHIP
 bool has_kahip();
 
+/// Return true if DOLFINx is compiled with zlib
+bool has_zlib();
+
+/// Return true if DOLFINx is compiled with ADIOS2
+bool has_adios2();
+
 } // namespace dolfinx
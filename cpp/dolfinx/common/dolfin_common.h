@@ -12,11 +12,16 @@ namespace dolfinx
 
 // DOLFINx common
 
+#include <dolfinx/common/Arena.h>
 #include <dolfinx/common/MPI.h>
 #include <dolfinx/common/Table.h>
+#include <dolfinx/common/TaskGraph.h>
+#include <dolfinx/common/ThreadPool.h>
 #include <dolfinx/common/Timer.h>
+#include <dolfinx/common/cpu.h>
 #include <dolfinx/common/defines.h>
 #include <dolfinx/common/init.h>
+#include <dolfinx/common/perf.h>
 #include <dolfinx/common/subsystem.h>
 #include <dolfinx/common/timing.h>
 #include <dolfinx/common/types.h>
@@ -5,8 +5,10 @@
 // SPDX-License-Identifier:    LGPL-3.0-or-later
 
 #include "init.h"
+#include "ThreadPool.h"
 #include "subsystem.h"
 #include <dolfinx/common/log.h>
+#include <string>
 
 //-----------------------------------------------------------------------------
 void dolfinx::init(int argc, char* argv[])
@@ -14,5 +16,19 @@ void dolfinx::init(int argc, char* argv[])
   common::subsystem::init_logging(argc, argv);
   LOG(INFO) << "Initializing DOLFINx version" << DOLFINX_VERSION;
   common::subsystem::init_petsc(argc, argv);
+
+  // Configure the thread pool
+  int num_threads = 0;
+  bool pin = false;
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string arg(argv[i]);
+    if (arg == "-dolfinx_num_threads" and i + 1 < argc)
+      num_threads = std::stoi(argv[++i]);
+    else if (arg == "-dolfinx_pin_threads")
+      pin = true;
+  }
+  if (num_threads > 0 or pin)
+    common::set_thread_pool(num_threads, pin);
 }
 //-----------------------------------------------------------------------------
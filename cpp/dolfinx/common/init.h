@@ -12,5 +12,10 @@ namespace dolfinx
 /// Initialize DOLFINx (and PETSc) with command-line arguments. This
 /// should not be needed in most cases since the initialization is
 /// otherwise handled automatically.
+///
+/// The thread pool of the library (see common::thread_pool) is
+/// configured by the arguments `-dolfinx_num_threads <n>`, the number
+/// of threads, and `-dolfinx_pin_threads`, to pin the worker threads to
+/// CPUs.
 void init(int argc, char* argv[]);
 } // namespace dolfinx
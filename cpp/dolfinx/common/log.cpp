@@ -6,3 +6,61 @@
 
 #include "log.h"
 #include "loguru.cpp"
+#include <vector>
+
+using namespace dolfinx;
+
+namespace
+{
+// Number of buffered messages of a thread at which the buffer is
+// written to the log
+constexpr std::size_t max_buffer_size = 256;
+
+struct Message
+{
+  loguru::Verbosity verbosity;
+  const char* file;
+  unsigned line;
+  std::string text;
+};
+
+// Messages of a thread, which are written to the log when the thread
+// exits
+struct Buffer
+{
+  ~Buffer() { flush(); }
+
+  void flush()
+  {
+    for (const Message& m : messages)
+      loguru::log(m.verbosity, m.file, m.line, "%s", m.text.c_str());
+    messages.clear();
+  }
+
+  std::vector<Message> messages;
+};
+
+Buffer& thread_buffer()
+{
+  thread_local Buffer buffer;
+  return buffer;
+}
+} // namespace
+
+//-----------------------------------------------------------------------------
+void log::flush_thread_buffer() { thread_buffer().flush(); }
+//-----------------------------------------------------------------------------
+log::BufferedLogger::BufferedLogger(loguru::Verbosity verbosity,
+                                    const char* file, unsigned line)
+    : _verbosity(verbosity), _file(file), _line(line)
+{
+}
+//-----------------------------------------------------------------------------
+log::BufferedLogger::~BufferedLogger()
+{
+  Buffer& buffer = thread_buffer();
+  buffer.messages.push_back({_verbosity, _file, _line, _ss.str()});
+  if (buffer.messages.size() >= max_buffer_size)
+    buffer.flush();
+}
+//-----------------------------------------------------------------------------
@@ -10,3 +10,106 @@
 #define LOGURU_REPLACE_GLOG 1
 
 #include "loguru.hpp"
+#include <sstream>
+#include <string>
+
+/// Largest verbosity of the messages that are compiled. Messages with a
+/// larger verbosity (e.g. `-DDOLFINX_LOG_MAX_VERBOSITY=-1` removes INFO
+/// messages) are eliminated at compile time, including the evaluation
+/// of the stream arguments.
+#ifndef DOLFINX_LOG_MAX_VERBOSITY
+#define DOLFINX_LOG_MAX_VERBOSITY 9
+#endif
+
+// Replace the loguru LOG macros by macros that are eliminated at
+// compile time for verbosities above DOLFINX_LOG_MAX_VERBOSITY. As for
+// loguru, the stream arguments are only evaluated if the message is
+// logged.
+#undef LOG
+#undef VLOG
+#undef LOG_IF
+#undef VLOG_IF
+#define VLOG_IF(verbosity, cond)                                               \
+  ((verbosity) > DOLFINX_LOG_MAX_VERBOSITY) ? (void)0                          \
+                                            : VLOG_IF_S(verbosity, cond)
+#define VLOG(verbosity) VLOG_IF(verbosity, true)
+#define LOG_IF(verbosity_name, cond)                                           \
+  VLOG_IF(loguru::Verbosity_##verbosity_name, cond)
+#define LOG(verbosity_name) VLOG(loguru::Verbosity_##verbosity_name)
+
+/// Log a message of the calling thread to the buffer of the thread,
+/// which is written to the log by dolfinx::log::flush_thread_buffer
+/// (which is called by the threads of common::ThreadPool when they are
+/// idle, and at exit of a thread). Unlike LOG, this does not lock the
+/// log and can be used in threaded loops. Usage:
+/// @code
+/// LOG_THREAD(INFO) << "Computed " << n << " entities";
+/// @endcode
+#define LOG_THREAD(verbosity_name)                                             \
+  ((loguru::Verbosity_##verbosity_name) > DOLFINX_LOG_MAX_VERBOSITY            \
+   or (loguru::Verbosity_##verbosity_name)                                     \
+          > loguru::current_verbosity_cutoff())                                \
+      ? (void)0                                                                \
+      : dolfinx::log::Voidify()                                                \
+            & dolfinx::log::BufferedLogger(                                    \
+                loguru::Verbosity_##verbosity_name, __FILE__, __LINE__)
+
+namespace dolfinx::log
+{
+
+/// Check if messages of a verbosity are logged, e.g. to skip the
+/// computation of values that are only logged
+/// @param[in] verbosity The verbosity, e.g. `loguru::Verbosity_INFO`
+/// @return True if messages with the verbosity are logged
+inline bool is_enabled(loguru::Verbosity verbosity)
+{
+  return verbosity <= DOLFINX_LOG_MAX_VERBOSITY
+         and verbosity <= loguru::current_verbosity_cutoff();
+}
+
+/// Write the messages in the buffer of the calling thread to the log
+void flush_thread_buffer();
+
+/// A stream for a message which is appended to the log buffer of the
+/// calling thread when it is destroyed. Use via LOG_THREAD.
+class BufferedLogger
+{
+public:
+  /// Create a stream for a message
+  BufferedLogger(loguru::Verbosity verbosity, const char* file,
+                 unsigned line);
+
+  /// Copy constructor
+  BufferedLogger(const BufferedLogger& logger) = delete;
+
+  /// Destructor. Appends the message to the buffer of the thread.
+  ~BufferedLogger();
+
+  /// Assignment operator
+  BufferedLogger& operator=(const BufferedLogger& logger) = delete;
+
+  /// Append a value to the message
+  template <typename T>
+  BufferedLogger& operator<<(const T& t)
+  {
+    _ss << t;
+    return *this;
+  }
+
+private:
+  loguru::Verbosity _verbosity;
+  const char* _file;
+  unsigned _line;
+  std::ostringstream _ss;
+};
+
+/// @cond
+// Discard the value of a LOG_THREAD expression, which has lower
+// precedence than operator<<
+struct Voidify
+{
+  void operator&(const BufferedLogger&) {}
+};
+/// @endcond
+
+} // namespace dolfinx::log
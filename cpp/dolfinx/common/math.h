@@ -6,19 +6,88 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cassert>
 #include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#ifdef XTENSOR_USE_XSIMD
+#include <xsimd/xsimd.hpp>
+#endif
 
 namespace dolfinx::math
 {
 
+namespace impl
+{
+/// Fused multiply-add a * b + c of scalars or SIMD batches
+template <typename V>
+inline V fma(const V& a, const V& b, const V& c) noexcept
+{
+#ifdef XTENSOR_USE_XSIMD
+  if constexpr (!std::is_floating_point_v<V>)
+    return xsimd::fma(a, b, c);
+  else
+#endif
+    return std::fma(a, b, c);
+}
+
+/// Square root of a scalar or SIMD batch
+template <typename V>
+inline V sqrt(const V& a) noexcept
+{
+#ifdef XTENSOR_USE_XSIMD
+  if constexpr (!std::is_floating_point_v<V>)
+    return xsimd::sqrt(a);
+  else
+#endif
+    return std::sqrt(a);
+}
+
+/// Call f(load, store) for batches of the matrices [p, p + w) of n
+/// matrices stored in a structure-of-arrays layout, where component c
+/// of matrix p is at `A[c * n + p]`. `load(A, c)` returns component c
+/// of the matrices of the batch, and `store(B, c, v)` sets it. With
+/// xsimd, w is the SIMD width of T (and f is called with scalars for
+/// the remaining matrices), otherwise w = 1, so f must be a generic
+/// callable that supports scalars and SIMD batches.
+template <typename T, typename F>
+void for_each_batch(std::size_t n, F&& f)
+{
+  std::size_t p = 0;
+#ifdef XTENSOR_USE_XSIMD
+  if constexpr (std::is_floating_point_v<T>)
+  {
+    using b_type = xsimd::simd_type<T>;
+    constexpr std::size_t simd_size = b_type::size;
+    for (; p + simd_size <= n; p += simd_size)
+    {
+      f([n, p](const T* A, std::size_t c)
+        { return xsimd::load_unaligned(A + c * n + p); },
+        [n, p](T* B, std::size_t c, const b_type& v)
+        { v.store_unaligned(B + c * n + p); });
+    }
+  }
+#endif
+  for (; p < n; ++p)
+  {
+    f([n, p](const T* A, std::size_t c) { return A[c * n + p]; },
+      [n, p](T* B, std::size_t c, T v) { B[c * n + p] = v; });
+  }
+}
+} // namespace impl
+
 /// Kahan’s method to compute x = ad − bc with fused multiply-adds. The
 /// absolute error is bounded by 1.5 ulps, units of least precision.
 template <typename T>
 inline T difference_of_products(T a, T b, T c, T d) noexcept
 {
   T w = b * c;
-  T err = std::fma(-b, c, w);
-  T diff = std::fma(a, d, -w);
+  T err = impl::fma(-b, c, w);
+  T diff = impl::fma(a, d, -w);
   return (diff + err);
 }
 
@@ -106,4 +175,261 @@ void inv(const U& A, V& B)
   }
 }
 
+/// Compute the determinants of n square matrices (1x1, 2x2 or 3x3),
+/// e.g. the Jacobians at all points of many cells. The matrices are
+/// stored in a structure-of-arrays layout, where entry (i, j) of matrix
+/// p is at `A[(i * m + j) * n + p]`, and the computation is vectorised
+/// across the matrices. See math::det for the formulas.
+/// @param[in] m The number of rows and columns
+/// @param[in] n The number of matrices
+/// @param[in] A The matrices
+/// @param[out] detA The determinants (size n)
+template <typename T>
+void det_batch(std::size_t m, std::size_t n, const T* A, T* detA)
+{
+  switch (m)
+  {
+  case 1:
+    std::copy(A, A + n, detA);
+    break;
+  case 2:
+    impl::for_each_batch<T>(
+        n,
+        [A, detA](auto load, auto store)
+        {
+          store(detA, 0,
+                difference_of_products(load(A, 0), load(A, 1), load(A, 2),
+                                       load(A, 3)));
+        });
+    break;
+  case 3:
+    impl::for_each_batch<T>(
+        n,
+        [A, detA](auto load, auto store)
+        {
+          auto a = [&](int i, int j) { return load(A, 3 * i + j); };
+          auto w0 = difference_of_products(a(1, 1), a(1, 2), a(2, 1), a(2, 2));
+          auto w1 = difference_of_products(a(1, 0), a(1, 2), a(2, 0), a(2, 2));
+          auto w2 = difference_of_products(a(1, 0), a(1, 1), a(2, 0), a(2, 1));
+          auto w3 = difference_of_products(a(0, 0), a(0, 1), w1, w0);
+          store(detA, 0, impl::fma(a(0, 2), w2, w3));
+        });
+    break;
+  default:
+    throw std::runtime_error("math::det_batch is not implemented for "
+                             + std::to_string(m) + "x" + std::to_string(m)
+                             + " matrices.");
+  }
+}
+
+/// Compute the inverses of n square matrices (1x1, 2x2 or 3x3), and
+/// optionally their determinants. The matrices are stored in the
+/// structure-of-arrays layout of math::det_batch.
+/// @warning This function does not check if the matrices are
+/// invertible!
+/// @param[in] m The number of rows and columns
+/// @param[in] n The number of matrices
+/// @param[in] A The matrices
+/// @param[out] B The inverses, in the layout of A
+/// @param[out] detA The determinants (size n), if not null
+template <typename T>
+void inv_batch(std::size_t m, std::size_t n, const T* A, T* B,
+               T* detA = nullptr)
+{
+  switch (m)
+  {
+  case 1:
+    impl::for_each_batch<T>(n,
+                            [A, B, detA](auto load, auto store)
+                            {
+                              auto a = load(A, 0);
+                              store(B, 0, T(1) / a);
+                              if (detA)
+                                store(detA, 0, a);
+                            });
+    break;
+  case 2:
+    impl::for_each_batch<T>(
+        n,
+        [A, B, detA](auto load, auto store)
+        {
+          auto a00 = load(A, 0), a01 = load(A, 1);
+          auto a10 = load(A, 2), a11 = load(A, 3);
+          auto det = difference_of_products(a00, a01, a10, a11);
+          auto idet = T(1) / det;
+          store(B, 0, idet * a11);
+          store(B, 1, -idet * a01);
+          store(B, 2, -idet * a10);
+          store(B, 3, idet * a00);
+          if (detA)
+            store(detA, 0, det);
+        });
+    break;
+  case 3:
+    impl::for_each_batch<T>(
+        n,
+        [A, B, detA](auto load, auto store)
+        {
+          auto a = [&](int i, int j) { return load(A, 3 * i + j); };
+          auto w0 = difference_of_products(a(1, 1), a(1, 2), a(2, 1), a(2, 2));
+          auto w1 = difference_of_products(a(1, 0), a(1, 2), a(2, 0), a(2, 2));
+          auto w2 = difference_of_products(a(1, 0), a(1, 1), a(2, 0), a(2, 1));
+          auto w3 = difference_of_products(a(0, 0), a(0, 1), w1, w0);
+          auto det = impl::fma(a(0, 2), w2, w3);
+          auto idet = T(1) / det;
+          auto b = [&](int i, int j, auto v) { store(B, 3 * i + j, v * idet); };
+          b(0, 0, w0);
+          b(1, 0, -w1);
+          b(2, 0, w2);
+          b(0, 1, difference_of_products(a(0, 2), a(0, 1), a(2, 2), a(2, 1)));
+          b(0, 2, difference_of_products(a(0, 1), a(0, 2), a(1, 1), a(1, 2)));
+          b(1, 1, difference_of_products(a(0, 0), a(0, 2), a(2, 0), a(2, 2)));
+          b(1, 2, difference_of_products(a(1, 0), a(0, 0), a(1, 2), a(0, 2)));
+          b(2, 1, difference_of_products(a(2, 0), a(0, 0), a(2, 1), a(0, 1)));
+          b(2, 2, difference_of_products(a(0, 0), a(1, 0), a(0, 1), a(1, 1)));
+          if (detA)
+            store(detA, 0, det);
+        });
+    break;
+  default:
+    throw std::runtime_error("math::inv_batch is not implemented for "
+                             + std::to_string(m) + "x" + std::to_string(m)
+                             + " matrices.");
+  }
+}
+
+/// Compute the pseudo-inverses `B = (A^T A)^{-1} A^T` of n matrices A
+/// with m rows and k <= m columns (k <= 3, and k <= 2 if k < m), e.g.
+/// the Jacobians of a manifold (3x2, 3x1 or 2x1), and optionally their
+/// pseudo-determinants `sqrt(det(A^T A))`. For square matrices, the
+/// inverse and determinant are computed, see math::inv_batch. The
+/// matrices are stored in the structure-of-arrays layout of
+/// math::det_batch, where entry (i, j) of matrix p is at
+/// `A[(i * k + j) * n + p]`.
+/// @param[in] m The number of rows of A
+/// @param[in] k The number of columns of A
+/// @param[in] n The number of matrices
+/// @param[in] A The matrices
+/// @param[out] B The pseudo-inverses, with k rows and m columns
+/// @param[out] detA The pseudo-determinants (size n), if not null
+template <typename T>
+void pinv_batch(std::size_t m, std::size_t k, std::size_t n, const T* A,
+                T* B, T* detA = nullptr)
+{
+  if (m == k)
+  {
+    inv_batch(m, n, A, B, detA);
+    return;
+  }
+
+  assert(m <= 3);
+  switch (k)
+  {
+  case 1:
+    impl::for_each_batch<T>(
+        n,
+        [m, A, B, detA](auto load, auto store)
+        {
+          auto ata = load(A, 0) * load(A, 0);
+          for (std::size_t i = 1; i < m; ++i)
+            ata = impl::fma(load(A, i), load(A, i), ata);
+          auto iata = T(1) / ata;
+          for (std::size_t i = 0; i < m; ++i)
+            store(B, i, load(A, i) * iata);
+          if (detA)
+            store(detA, 0, impl::sqrt(ata));
+        });
+    break;
+  case 2:
+    impl::for_each_batch<T>(
+        n,
+        [m, A, B, detA](auto load, auto store)
+        {
+          // A^T A and its inverse
+          auto a0 = load(A, 0), a1 = load(A, 1);
+          auto ata00 = a0 * a0, ata01 = a0 * a1, ata11 = a1 * a1;
+          for (std::size_t i = 1; i < m; ++i)
+          {
+            a0 = load(A, 2 * i);
+            a1 = load(A, 2 * i + 1);
+            ata00 = impl::fma(a0, a0, ata00);
+            ata01 = impl::fma(a0, a1, ata01);
+            ata11 = impl::fma(a1, a1, ata11);
+          }
+          auto det = difference_of_products(ata00, ata01, ata01, ata11);
+          auto idet = T(1) / det;
+          for (std::size_t i = 0; i < m; ++i)
+          {
+            a0 = load(A, 2 * i);
+            a1 = load(A, 2 * i + 1);
+            store(B, i, difference_of_products(ata11, ata01, a1, a0) * idet);
+            store(B, m + i,
+                  difference_of_products(ata00, ata01, a0, a1) * idet);
+          }
+          if (detA)
+            store(detA, 0, impl::sqrt(det));
+        });
+    break;
+  default:
+    throw std::runtime_error("math::pinv_batch is not implemented for "
+                             + std::to_string(m) + "x" + std::to_string(k)
+                             + " matrices.");
+  }
+}
+
+/// Solve A X = B for a dense square matrix A by Gaussian elimination
+/// with partial pivoting, e.g. for the cell-interior blocks of element
+/// matrices. The matrices are row-major.
+/// @param[in] n The number of rows and columns of A
+/// @param[in] m The number of columns of B
+/// @param[in,out] A The matrix A (size n * n), which is overwritten by
+/// its factorisation
+/// @param[in,out] B The right-hand sides (size n * m), which are
+/// overwritten by the solution X
+/// @return False if A is singular, in which case A and B are not
+/// valid
+template <typename T>
+bool lu_solve(std::size_t n, std::size_t m, T* A, T* B)
+{
+  using std::abs;
+  for (std::size_t k = 0; k < n; ++k)
+  {
+    // Swap the row with the largest pivot into row k
+    std::size_t p = k;
+    for (std::size_t i = k + 1; i < n; ++i)
+      if (abs(A[i * n + k]) > abs(A[p * n + k]))
+        p = i;
+    if (A[p * n + k] == T(0))
+      return false;
+    if (p != k)
+    {
+      std::swap_ranges(A + k * n, A + (k + 1) * n, A + p * n);
+      std::swap_ranges(B + k * m, B + (k + 1) * m, B + p * m);
+    }
+
+    // Eliminate below the pivot
+    const T a_kk = A[k * n + k];
+    for (std::size_t i = k + 1; i < n; ++i)
+    {
+      const T l = A[i * n + k] / a_kk;
+      for (std::size_t j = k + 1; j < n; ++j)
+        A[i * n + j] -= l * A[k * n + j];
+      for (std::size_t j = 0; j < m; ++j)
+        B[i * m + j] -= l * B[k * m + j];
+    }
+  }
+
+  // Back substitution
+  for (std::size_t k = n; k-- > 0;)
+  {
+    for (std::size_t i = k + 1; i < n; ++i)
+      for (std::size_t j = 0; j < m; ++j)
+        B[k * m + j] -= A[k * n + i] * B[i * m + j];
+    for (std::size_t j = 0; j < m; ++j)
+      B[k * m + j] /= A[k * n + k];
+  }
+
+  return true;
+}
+
 } // namespace dolfinx::math
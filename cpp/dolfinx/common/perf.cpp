@@ -0,0 +1,127 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "perf.h"
+
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace dolfinx;
+
+namespace
+{
+#ifdef __linux__
+//-----------------------------------------------------------------------------
+// Open a hardware counter for the calling thread on any CPU, as the
+// leader of a new group if group is -1
+int open_counter(std::uint64_t config, int group)
+{
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = config;
+  attr.disabled = group == -1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP;
+  return syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+}
+//-----------------------------------------------------------------------------
+// The counters of a thread, which are read together as a group so
+// that they count over the same interval
+class CounterGroup
+{
+public:
+  CounterGroup()
+  {
+    _fd.fill(-1);
+    const std::array<std::uint64_t, perf::num_counters> config
+        = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+           PERF_COUNT_HW_CACHE_MISSES};
+    for (int i = 0; i < perf::num_counters; ++i)
+    {
+      _fd[i] = open_counter(config[i], _fd[0]);
+      if (_fd[i] < 0)
+      {
+        close_all();
+        return;
+      }
+    }
+
+    ioctl(_fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(_fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+
+  CounterGroup(const CounterGroup&) = delete;
+  CounterGroup& operator=(const CounterGroup&) = delete;
+
+  ~CounterGroup() { close_all(); }
+
+  bool valid() const { return _fd[0] >= 0; }
+
+  std::array<std::int64_t, perf::num_counters> read() const
+  {
+    // With PERF_FORMAT_GROUP, the number of counters is followed by the
+    // values
+    std::array<std::uint64_t, perf::num_counters + 1> buffer;
+    std::array<std::int64_t, perf::num_counters> values = {0};
+    if (valid()
+        and ::read(_fd[0], buffer.data(), sizeof(buffer)) == sizeof(buffer))
+    {
+      for (int i = 0; i < perf::num_counters; ++i)
+        values[i] = buffer[i + 1];
+    }
+    return values;
+  }
+
+private:
+  void close_all()
+  {
+    for (int& fd : _fd)
+    {
+      if (fd >= 0)
+        close(fd);
+      fd = -1;
+    }
+  }
+
+  std::array<int, perf::num_counters> _fd;
+};
+//-----------------------------------------------------------------------------
+const CounterGroup& counters()
+{
+  thread_local CounterGroup group;
+  return group;
+}
+//-----------------------------------------------------------------------------
+#endif
+} // namespace
+
+//-----------------------------------------------------------------------------
+bool perf::available()
+{
+#ifdef __linux__
+  return counters().valid();
+#else
+  return false;
+#endif
+}
+//-----------------------------------------------------------------------------
+std::array<std::int64_t, perf::num_counters> perf::read()
+{
+#ifdef __linux__
+  return counters().read();
+#else
+  return {0};
+#endif
+}
+//-----------------------------------------------------------------------------
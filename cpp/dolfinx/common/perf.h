@@ -0,0 +1,37 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+/// Hardware performance counters of the calling thread, which are read
+/// with the Linux perf_event interface. The counters are opened for a
+/// thread by the first call on the thread, count user space only (so
+/// that they are available with the default perf_event_paranoid
+/// setting) and are not available on other platforms.
+namespace dolfinx::perf
+{
+
+/// Number of counters
+constexpr int num_counters = 3;
+
+/// Cache line size in bytes, which is used to estimate the memory
+/// traffic from the number of last level cache misses
+constexpr int cache_line_size = 64;
+
+/// Check whether the counters can be read on the calling thread
+/// @return True if the counters are available
+bool available();
+
+/// Read the counters of the calling thread
+/// @return The number of CPU cycles, instructions and last level cache
+/// misses since the counters were opened for the thread, or zeros if
+/// the counters are not available
+std::array<std::int64_t, num_counters> read();
+
+} // namespace dolfinx::perf
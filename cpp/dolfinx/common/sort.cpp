@@ -0,0 +1,85 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "sort.h"
+#include "utils.h"
+#include <algorithm>
+#include <numeric>
+
+using namespace dolfinx;
+
+//-----------------------------------------------------------------------------
+std::vector<std::int32_t>
+common::sort_by_key(
+    const xtl::span<const std::array<std::uint64_t, 2>>& keys, int num_bits,
+    int num_threads)
+{
+  const std::int32_t n = keys.size();
+  std::vector<std::int32_t> perm(n);
+  std::iota(perm.begin(), perm.end(), 0);
+
+  // Use a comparison sort when the digit histograms would cost more
+  // than the sort
+  constexpr int radix_bits = 16;
+  constexpr std::int32_t radix = 1 << radix_bits;
+  if (n < radix)
+  {
+    std::stable_sort(perm.begin(), perm.end(),
+                     [&keys](auto a, auto b) { return keys[a] < keys[b]; });
+    return perm;
+  }
+
+  std::vector<std::int32_t> perm_next(n);
+  const int nt = std::max(std::min(num_threads, n / radix), 1);
+  std::vector<std::vector<std::int32_t>> offsets(
+      nt, std::vector<std::int32_t>(radix));
+  for (int shift = 0; shift < num_bits; shift += radix_bits)
+  {
+    auto digit = [&keys, shift](std::int32_t i)
+    {
+      return shift < 64 ? (keys[i][1] >> shift) & (radix - 1)
+                        : (keys[i][0] >> (shift - 64)) & (radix - 1);
+    };
+
+    // Count the digits of each thread's part
+    common::for_each_part(
+        n, nt,
+        [&](std::int64_t i0, std::int64_t i1, int t)
+        {
+          std::vector<std::int32_t>& count = offsets[t];
+          std::fill(count.begin(), count.end(), 0);
+          for (std::int64_t i = i0; i < i1; ++i)
+            ++count[digit(perm[i])];
+        });
+
+    // Starting position (by digit, then by thread) of each
+    // thread's digits
+    std::int32_t pos = 0;
+    for (std::int32_t d = 0; d < radix; ++d)
+    {
+      for (int t = 0; t < nt; ++t)
+      {
+        const std::int32_t count = offsets[t][d];
+        offsets[t][d] = pos;
+        pos += count;
+      }
+    }
+
+    // Stable scatter into the new order
+    common::for_each_part(
+        n, nt,
+        [&](std::int64_t i0, std::int64_t i1, int t)
+        {
+          std::vector<std::int32_t>& offset = offsets[t];
+          for (std::int64_t i = i0; i < i1; ++i)
+            perm_next[offset[digit(perm[i])]++] = perm[i];
+        });
+    std::swap(perm, perm_next);
+  }
+
+  return perm;
+}
+//-----------------------------------------------------------------------------
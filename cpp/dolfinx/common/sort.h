@@ -0,0 +1,31 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <xtl/xspan.hpp>
+
+namespace dolfinx::common
+{
+
+/// Compute the permutation that sorts 128-bit integer keys in
+/// ascending order, using a least-significant-digit radix sort with
+/// 16-bit digits. The key entry 0 holds the most significant bits.
+/// Small arrays are sorted with a comparison sort.
+/// @param[in] keys The keys
+/// @param[in] num_bits The number of (least significant) bits of the
+/// keys that may be non-zero
+/// @param[in] num_threads The number of threads
+/// @return The permutation vector that orders the keys. The sort is
+/// stable.
+std::vector<std::int32_t>
+sort_by_key(const xtl::span<const std::array<std::uint64_t, 2>>& keys,
+            int num_bits, int num_threads = 1);
+
+} // namespace dolfinx::common
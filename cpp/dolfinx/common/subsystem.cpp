@@ -5,10 +5,12 @@
 // SPDX-License-Identifier:    LGPL-3.0-or-later
 
 #include "subsystem.h"
+#include <cstdlib>
 #include <dolfinx/common/log.h>
 #include <iostream>
 #include <mpi.h>
 #include <petscsys.h>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -18,6 +20,29 @@
 
 using namespace dolfinx::common;
 
+namespace
+{
+// Get the requested level of thread support of MPI, which can be
+// overridden by the environment
+int thread_level(int required)
+{
+  const char* env = std::getenv("DOLFINX_MPI_THREAD_LEVEL");
+  if (!env)
+    return required;
+
+  const std::string level(env);
+  if (level == "single")
+    return MPI_THREAD_SINGLE;
+  else if (level == "funneled")
+    return MPI_THREAD_FUNNELED;
+  else if (level == "serialized")
+    return MPI_THREAD_SERIALIZED;
+  else if (level == "multiple")
+    return MPI_THREAD_MULTIPLE;
+  throw std::runtime_error("Unknown MPI thread level: " + level);
+}
+} // namespace
+
 //-----------------------------------------------------------------------------
 void subsystem::init_mpi()
 {
@@ -32,15 +57,31 @@ void subsystem::init_mpi()
   subsystem::init_mpi(0, &c);
 }
 //-----------------------------------------------------------------------------
-void subsystem::init_mpi(int argc, char* argv[])
+int subsystem::init_mpi(int argc, char* argv[], int required)
 {
   int mpi_initialized;
   MPI_Initialized(&mpi_initialized);
   if (mpi_initialized)
-    return;
+    return mpi_thread_level();
 
   // Initialise MPI
-  MPI_Init(&argc, &argv);
+  required = thread_level(required);
+  int provided;
+  MPI_Init_thread(&argc, &argv, required, &provided);
+  if (provided < required)
+  {
+    LOG(WARNING) << "MPI provides thread support level " << provided
+                 << ", lower than the requested level " << required << ".";
+  }
+
+  return provided;
+}
+//-----------------------------------------------------------------------------
+int subsystem::mpi_thread_level()
+{
+  int provided;
+  MPI_Query_thread(&provided);
+  return provided;
 }
 //-----------------------------------------------------------------------------
 void subsystem::init_logging(int argc, char* argv[])
@@ -79,7 +120,11 @@ void subsystem::init_petsc(int argc, char* argv[])
   PetscBool is_initialized;
   PetscInitialized(&is_initialized);
   if (!is_initialized)
+  {
+    // PETSc initialises MPI with the level PETSC_MPI_THREAD_REQUIRED
+    PETSC_MPI_THREAD_REQUIRED = thread_level(MPI_THREAD_FUNNELED);
     PetscInitialize(&argc, &argv, nullptr, nullptr);
+  }
 
 #ifdef HAS_SLEPC
   SlepcInitialize(&argc, &argv, nullptr, nullptr);
@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <mpi.h>
+
 namespace dolfinx::common
 {
 
@@ -16,11 +18,26 @@ namespace dolfinx::common
 namespace subsystem
 {
 
-/// Initialise MPI
+/// Initialise MPI, see init_mpi(int, char**, int)
 void init_mpi();
 
-/// Initialise MPI
-void init_mpi(int argc, char* argv[]);
+/// Initialise MPI with `MPI_Init_thread`, if MPI has not been
+/// initialised. The requested level of thread support can be overridden
+/// by the environment variable `DOLFINX_MPI_THREAD_LEVEL` with value
+/// `single`, `funneled`, `serialized` or `multiple`. A warning is
+/// logged if the provided level is lower than the requested level.
+/// @param[in] argc Number of command-line arguments
+/// @param[in] argv Command-line arguments
+/// @param[in] required The requested level of thread support. The
+/// default, `MPI_THREAD_FUNNELED`, is sufficient for the threaded loops
+/// of the library, which do not call MPI. `MPI_THREAD_MULTIPLE` is
+/// required for asynchronous output (see io::AsyncWriter).
+/// @return The provided level of thread support
+int init_mpi(int argc, char* argv[], int required = MPI_THREAD_FUNNELED);
+
+/// Return the level of thread support provided by MPI
+/// @note MPI must be initialised
+int mpi_thread_level();
 
 /// Initialise loguru
 void init_logging(int argc, char* argv[]);
@@ -30,7 +47,8 @@ void init_logging(int argc, char* argv[]);
 void init_petsc();
 
 /// Initialize PETSc (and SLEPc, if configured) with command-line
-/// arguments
+/// arguments. If MPI has not been initialised, PETSc initialises MPI
+/// with the level of thread support of init_mpi.
 void init_petsc(int argc, char* argv[]);
 
 /// Check if MPI has been initialised (returns true if MPI has been
@@ -6,6 +6,7 @@
 
 #include "timing.h"
 #include "Timer.h"
+#include "perf.h"
 #include <dolfinx/common/Table.h>
 #include <dolfinx/common/TimeLogManager.h>
 
@@ -35,3 +36,103 @@ dolfinx::timing(std::string task)
   return TimeLogManager::logger().timing(task);
 }
 //-----------------------------------------------------------------------------
+Table dolfinx::timing_imbalance(MPI_Comm mpi_comm, TimingType type)
+{
+  return TimeLogManager::logger().timing_imbalance(mpi_comm, type);
+}
+//-----------------------------------------------------------------------------
+void dolfinx::list_timing_imbalance(MPI_Comm mpi_comm, TimingType type)
+{
+  TimeLogManager::logger().list_timing_imbalance(mpi_comm, type);
+}
+//-----------------------------------------------------------------------------
+void dolfinx::write_timing_distribution(MPI_Comm mpi_comm,
+                                        const std::string& filename,
+                                        TimingType type)
+{
+  TimeLogManager::logger().write_timing_distribution(mpi_comm, filename,
+                                                     type);
+}
+//-----------------------------------------------------------------------------
+Table dolfinx::nested_timings()
+{
+  return TimeLogManager::logger().nested_timings();
+}
+//-----------------------------------------------------------------------------
+void dolfinx::set_timer_trace(bool enable)
+{
+  TimeLogManager::logger().set_trace(enable);
+}
+//-----------------------------------------------------------------------------
+void dolfinx::write_timer_trace(MPI_Comm mpi_comm, const std::string& filename)
+{
+  TimeLogManager::logger().write_trace(mpi_comm, filename);
+}
+//-----------------------------------------------------------------------------
+void dolfinx::set_timer_counters(bool enable)
+{
+  TimeLogManager::logger().set_counters(enable);
+}
+//-----------------------------------------------------------------------------
+bool dolfinx::timer_counters_available() { return perf::available(); }
+//-----------------------------------------------------------------------------
+void dolfinx::set_communication_log(bool enable)
+{
+  TimeLogManager::logger().set_communication_log(enable);
+}
+//-----------------------------------------------------------------------------
+bool dolfinx::communication_log()
+{
+  return TimeLogManager::logger().communication_log();
+}
+//-----------------------------------------------------------------------------
+void dolfinx::register_communication(const std::string& site, int neighbors,
+                                     std::int64_t messages,
+                                     std::int64_t bytes, double wait)
+{
+  TimeLogManager::logger().register_communication(site, neighbors, messages,
+                                                  bytes, wait);
+}
+//-----------------------------------------------------------------------------
+Table dolfinx::communication()
+{
+  return TimeLogManager::logger().communication();
+}
+//-----------------------------------------------------------------------------
+void dolfinx::list_communication(MPI_Comm mpi_comm)
+{
+  TimeLogManager::logger().list_communication(mpi_comm);
+}
+//-----------------------------------------------------------------------------
+void dolfinx::write_communication(MPI_Comm mpi_comm,
+                                  const std::string& filename)
+{
+  TimeLogManager::logger().write_communication(mpi_comm, filename);
+}
+//-----------------------------------------------------------------------------
+void dolfinx::register_io(const std::string& site, const std::string& name,
+                          std::int64_t bytes, double time, bool collective)
+{
+  TimeLogManager::logger().register_io(site, name, bytes, time, collective);
+}
+//-----------------------------------------------------------------------------
+Table dolfinx::io_statistics()
+{
+  return TimeLogManager::logger().io_statistics();
+}
+//-----------------------------------------------------------------------------
+Table dolfinx::io_summary(MPI_Comm mpi_comm)
+{
+  return TimeLogManager::logger().io_summary(mpi_comm);
+}
+//-----------------------------------------------------------------------------
+void dolfinx::list_io(MPI_Comm mpi_comm)
+{
+  TimeLogManager::logger().list_io(mpi_comm);
+}
+//-----------------------------------------------------------------------------
+void dolfinx::write_io(MPI_Comm mpi_comm, const std::string& filename)
+{
+  TimeLogManager::logger().write_io(mpi_comm, filename);
+}
+//-----------------------------------------------------------------------------
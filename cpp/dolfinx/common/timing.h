@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <dolfinx/common/Table.h>
 #include <mpi.h>
 #include <set>
@@ -33,7 +34,8 @@ enum class TimingType : std::int32_t
 Table timings(std::set<TimingType> type);
 
 /// List a summary of timings and tasks. ``MPI_AVG`` reduction is
-/// printed.
+/// printed. The hardware counters of the tasks are also listed if they
+/// have been recorded, see set_timer_counters.
 /// @param[in] mpi_comm MPI Communicator
 /// @param[in] type Subset of { TimingType::wall, TimingType::user,
 ///                 TimingType::system }
@@ -46,4 +48,156 @@ void list_timings(MPI_Comm mpi_comm, std::set<TimingType> type);
 ///          time) for the task
 std::tuple<std::size_t, double, double, double> timing(std::string task);
 
+/// Return a summary of the load imbalance of the timed tasks across
+/// the ranks of a communicator: number of ranks that timed the task,
+/// min, mean, max, standard deviation, max/mean and the slowest ranks
+/// @note Collective MPI operation. The Table is empty on ranks other
+/// than rank 0.
+/// @param[in] mpi_comm MPI Communicator
+/// @param[in] type The type of time to compare
+/// @returns Table with the imbalance of the total time of each task
+Table timing_imbalance(MPI_Comm mpi_comm,
+                       TimingType type = TimingType::wall);
+
+/// List the load imbalance of the timed tasks across the ranks of a
+/// communicator, see timing_imbalance
+/// @note Collective MPI operation. The summary is printed by rank 0.
+/// @param[in] mpi_comm MPI Communicator
+/// @param[in] type The type of time to compare
+void list_timing_imbalance(MPI_Comm mpi_comm,
+                           TimingType type = TimingType::wall);
+
+/// Write the total time of each task on each rank to a CSV file, with
+/// one row per task and one column per rank, e.g. for histograms
+/// @note Collective MPI operation. The file is written by rank 0.
+/// @param[in] mpi_comm MPI Communicator
+/// @param[in] filename The name of the file
+/// @param[in] type The type of time to write
+void write_timing_distribution(MPI_Comm mpi_comm, const std::string& filename,
+                               TimingType type = TimingType::wall);
+
+/// Return a summary of the wall times of tasks by their nesting in
+/// other tasks, e.g. the row `NewtonSolver::solve > Assemble vector`
+/// holds the timings of the task "Assemble vector" that were timed
+/// while a timer for "NewtonSolver::solve" was running on the same
+/// thread
+/// @returns Table with timings
+Table nested_timings();
+
+/// Enable or disable the recording of timer events for export as a
+/// timeline with write_timer_trace. Recording is disabled by default,
+/// and the overhead of a disabled trace is a flag check per timer.
+/// @param[in] enable True to record timer events
+void set_timer_trace(bool enable);
+
+/// Write the recorded timer events of all ranks to a file in the Chrome
+/// trace event format (JSON), with one process per rank and one thread
+/// per thread that recorded events
+/// @note Collective MPI operation
+/// @param[in] mpi_comm MPI Communicator
+/// @param[in] filename The name of the file, written by rank 0
+void write_timer_trace(MPI_Comm mpi_comm, const std::string& filename);
+
+/// Enable or disable the recording of hardware performance counters
+/// (CPU cycles, instructions and last level cache misses, counted in
+/// user space) by named timers, which are summarised by timings and
+/// list_timings with the instructions per cycle and the memory
+/// bandwidth estimated from the cache misses. The counters are read
+/// with the Linux perf_event interface when a timer starts and stops,
+/// so a timer must be stopped on the thread that started it. Recording
+/// is disabled by default.
+/// @param[in] enable True to record hardware counters
+/// @throws std::runtime_error if enabled and the counters are not
+/// available, e.g. on other platforms or if perf events are disabled
+/// by the kernel
+void set_timer_counters(bool enable);
+
+/// Return true if the hardware counters of the calling thread can be
+/// read, see set_timer_counters
+bool timer_counters_available();
+
+/// Enable or disable the recording of communication statistics (number
+/// of neighbors, messages, bytes and the time spent waiting) by the
+/// ghost updates of IndexMap and Scatterer, the exchanges of
+/// dolfinx::MPI and graph::build::distribute. Recording is disabled by
+/// default.
+/// @param[in] enable True to record communication statistics
+void set_communication_log(bool enable);
+
+/// Return true if communication statistics are recorded
+bool communication_log();
+
+/// Register the statistics of a communication at a call site, see
+/// set_communication_log. The wait time is added to the timings as the
+/// task "MPI wait: <site>".
+/// @param[in] site The name of the call site
+/// @param[in] neighbors The number of ranks that data could be
+/// received from
+/// @param[in] messages The number of non-empty messages received
+/// @param[in] bytes The number of bytes received
+/// @param[in] wait The wall time spent waiting for the communication
+/// to complete
+void register_communication(const std::string& site, int neighbors,
+                            std::int64_t messages, std::int64_t bytes,
+                            double wait);
+
+/// Return a summary of the communication statistics of this rank by
+/// call site
+/// @returns Table with the number of calls and the average number of
+/// neighbors, messages and bytes received, and the wait time
+Table communication();
+
+/// List a summary of the communication statistics by call site.
+/// ``MPI_AVG`` reduction is printed.
+/// @note Collective MPI operation
+/// @param[in] mpi_comm MPI Communicator
+void list_communication(MPI_Comm mpi_comm);
+
+/// Write the communication statistics of each rank to a CSV file, with
+/// one row per rank and call site
+/// @note Collective MPI operation. The file is written by rank 0.
+/// @param[in] mpi_comm MPI Communicator
+/// @param[in] filename The name of the file
+void write_communication(MPI_Comm mpi_comm, const std::string& filename);
+
+/// Register the statistics of a read or write of a dataset or file.
+/// The I/O of HDF5Interface, XDMFFile and VTKFile is registered. The
+/// time is added to the timings as the task "I/O: <site>".
+/// @param[in] site The name of the call site, e.g. "HDF5 write"
+/// @param[in] name The name of the dataset or file
+/// @param[in] bytes The number of bytes read or written by this rank
+/// @param[in] time The wall time of the read or write
+/// @param[in] collective True if the read or write is a collective
+/// MPI-IO operation
+void register_io(const std::string& site, const std::string& name,
+                 std::int64_t bytes, double time, bool collective);
+
+/// Return a summary of the I/O statistics of this rank by call site and
+/// dataset
+/// @returns Table with the number of calls and collective calls, the
+/// bytes, the time and the bandwidth
+Table io_statistics();
+
+/// Return a summary of the I/O statistics across the ranks of a
+/// communicator: number of ranks, calls, total bytes, max time,
+/// aggregate bandwidth, min bandwidth of a rank and the slowest rank
+/// @note Collective MPI operation. The Table is empty on ranks other
+/// than rank 0.
+/// @param[in] mpi_comm MPI Communicator
+/// @returns Table with the I/O statistics of each call site and dataset
+Table io_summary(MPI_Comm mpi_comm);
+
+/// List the summary of the I/O statistics across the ranks of a
+/// communicator, see io_summary
+/// @note Collective MPI operation. The summary is printed by rank 0.
+/// @param[in] mpi_comm MPI Communicator
+void list_io(MPI_Comm mpi_comm);
+
+/// Write the I/O statistics of each rank to a CSV file, with one row
+/// per rank, call site and dataset
+/// @note Collective MPI operation. The file is written by rank 0.
+/// @param[in] mpi_comm MPI Communicator
+/// @param[in] filename The name of the file
+void write_io(MPI_Comm mpi_comm, const std::string& filename);
+
 } // namespace dolfinx
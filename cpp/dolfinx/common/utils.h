@@ -6,19 +6,87 @@
 
 #pragma once
 
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
 #include <boost/functional/hash.hpp>
+#include <cstdint>
 #include <cstring>
 #include <dolfinx/common/MPI.h>
+#include <iterator>
 #include <limits>
 #include <mpi.h>
+#include <numeric>
 #include <sstream>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 namespace dolfinx::common
 {
 
+/// Call a function with a block size that is, for common block sizes,
+/// a compile-time constant. For block sizes 1, 2 and 3, `f` is called
+/// with a `std::integral_constant<int, bs>`, which allows loops over
+/// the block to be unrolled. Otherwise `f` is called with `bs`.
+/// @param[in] bs The block size
+/// @param[in] f The function to call, typically a generic lambda with
+/// one argument that is used as an `int`
+template <typename F>
+void dispatch_block_size(int bs, F&& f)
+{
+  switch (bs)
+  {
+  case 1:
+    f(std::integral_constant<int, 1>());
+    break;
+  case 2:
+    f(std::integral_constant<int, 2>());
+    break;
+  case 3:
+    f(std::integral_constant<int, 3>());
+    break;
+  default:
+    f(bs);
+  }
+}
+
+/// Call f(i0, i1, t) for the contiguous parts [i0, i1) of the range
+/// [0, n), with up to num_threads parts that are processed concurrently
+/// by the threads of the library thread pool (see common::thread_pool)
+/// @return The number of parts
+template <typename F>
+int for_each_part(std::int64_t n, int num_threads, F&& f)
+{
+  const int nt = std::clamp<std::int64_t>(n, 1, std::max(num_threads, 1));
+  if (nt > 1)
+    return thread_pool().parallel_for(n, nt, std::forward<F>(f));
+
+  f(0, n, 0);
+  return 1;
+}
+
+/// Call f(i, t) for each index i in [0, n), with the indices taken in
+/// increasing order by up to num_threads threads of the library thread
+/// pool as each thread completes its previous index. This balances the
+/// load when the costs of the indices differ, e.g. for chunks of
+/// entities of integrals with different costs. The index t of the
+/// thread is in [0, num_threads), so it can be used to index per-thread
+/// data.
+template <typename F>
+void for_each_task(std::int64_t n, int num_threads, F&& f)
+{
+  std::atomic<std::int64_t> next(0);
+  for_each_part(std::min<std::int64_t>(n, std::max(num_threads, 1)),
+                num_threads,
+                [&](std::int64_t, std::int64_t, int t)
+                {
+                  for (std::int64_t i = next++; i < n; i = next++)
+                    f(i, t);
+                });
+}
+
 /// Sort two arrays based on the values in array @p indices. Any
 /// duplicate indices and the corresponding value are removed. In the
 /// case of duplicates, the entry with the smallest value is retained.
@@ -54,6 +122,43 @@ std::pair<U, V> sort_unique(const U& indices, const V& values)
   return {std::move(indices_new), std::move(values_new)};
 }
 
+/// Sum the values in [first, last) using pairwise (cascade)
+/// summation. The result depends only on the values and their order,
+/// and the rounding error grows with the logarithm of the number of
+/// values rather than linearly.
+/// @param[in] first Iterator to the first value
+/// @param[in] last Iterator to one past the last value
+/// @return The sum of the values
+template <typename Iterator>
+typename std::iterator_traits<Iterator>::value_type pairwise_sum(Iterator first,
+                                                                 Iterator last)
+{
+  using T = typename std::iterator_traits<Iterator>::value_type;
+  const auto n = std::distance(first, last);
+  if (n <= 8)
+    return std::accumulate(first, last, T(0));
+  Iterator mid = std::next(first, n / 2);
+  return pairwise_sum(first, mid) + pairwise_sum(mid, last);
+}
+
+/// Sum a value across processes. Unlike MPI_Allreduce, for which the
+/// order of the reduction is implementation defined, the values are
+/// gathered on all processes and summed in rank order (see
+/// pairwise_sum). The result is therefore bitwise reproducible for a
+/// given number of processes, and is the same on all processes. This
+/// function is collective.
+/// @param[in] comm The MPI communicator
+/// @param[in] value The value on this process
+/// @return The sum of the values on all processes
+template <typename T>
+T sum_reproducible(MPI_Comm comm, const T& value)
+{
+  std::vector<T> values(dolfinx::MPI::size(comm));
+  MPI_Allgather(&value, 1, dolfinx::MPI::mpi_type<T>(), values.data(), 1,
+                dolfinx::MPI::mpi_type<T>(), comm);
+  return pairwise_sum(values.begin(), values.end());
+}
+
 /// Indent string block
 std::string indent(std::string block);
 
@@ -75,6 +180,28 @@ std::string container_to_string(const T& x, const int precision,
   return s.str();
 }
 
+/// Compute a hash of a list of integers, e.g. the global vertex
+/// indices of a mesh entity. The hash depends only on the values, and
+/// is the same on all processes and platforms, so that processes can
+/// make the same choice independently, e.g. of the owner of an index
+/// that they share.
+/// @param[in] x The integers
+/// @return The hash
+template <typename U>
+std::uint64_t hash_indices(const U& x)
+{
+  // Mix each value with the finaliser of splitmix64
+  std::uint64_t h = 0;
+  for (auto i : x)
+  {
+    std::uint64_t z = h + 0x9e3779b97f4a7c15 + static_cast<std::uint64_t>(i);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    h = z ^ (z >> 31);
+  }
+  return h;
+}
+
 /// Return a hash of a given object
 template <class T>
 std::size_t hash_local(const T& x)
@@ -0,0 +1,241 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include "DofMap.h"
+#include "Form.h"
+#include "FunctionSpace.h"
+#include <array>
+#include <cstdint>
+#include <dolfinx/common/utils.h>
+#include <dolfinx/la/MatrixCSR.h>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include <xtl/xspan.hpp>
+
+namespace dolfinx::fem
+{
+
+/// Cached insertion positions for repeated assembly of a bilinear form
+/// into a la::MatrixCSR with a fixed sparsity pattern.
+///
+/// The first assembly with a plan records, for every entry of every
+/// element matrix, the position in the matrix value array (see
+/// la::MatrixCSR::values). Subsequent assemblies add the element
+/// matrices directly at the recorded positions, without searching the
+/// rows of the matrix. The plan is rebuilt automatically if it is used
+/// with a different form, sparsity pattern or dofmaps.
+///
+/// Each replayed insertion is checked against the recorded one (size
+/// and a hash of the row and column indices), and the number of
+/// insertions is checked by AssemblyPlan::finish. A mismatch discards
+/// the plan and raises an exception. The values already added to the
+/// matrix are then incomplete, and the matrix must be re-assembled.
+///
+/// Typical usage is
+///
+///     fem::AssemblyPlan<T> plan;
+///     for (...)
+///     {
+///       A.set(0.0);
+///       fem::assemble_matrix(plan.mat_add_values(a, A), a, bcs);
+///       plan.finish();
+///       A.finalize();
+///     }
+///
+/// @note The recorded positions depend on the order in which element
+/// matrices are inserted. Assembly with a plan must therefore be
+/// sequential (`num_threads = 1`), and the same insertion function
+/// must not be used for additional entries, e.g. diagonal entries set
+/// by fem::set_diagonal.
+template <typename T>
+class AssemblyPlan
+{
+public:
+  /// Create an empty plan
+  AssemblyPlan() = default;
+
+  /// Return a function with an interface for adding element matrices
+  /// into A, for use by the finite element assemblers. If the plan is
+  /// valid for the pair (a, A) the values are added at the recorded
+  /// positions, otherwise the positions are recorded while adding the
+  /// values. Calling this function starts a new assembly.
+  /// @param[in] a The bilinear form that will be assembled
+  /// @param[in] A The matrix to assemble into. It must not be
+  /// destroyed while the returned function is used.
+  /// @return Insertion function. When replaying, it throws if an
+  /// insertion differs from the recorded insertion.
+  std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
+                    const std::int32_t*, const T*)>
+  mat_add_values(const Form<T>& a, la::MatrixCSR<T>& A)
+  {
+    // A recording is complete once the next assembly starts
+    finish();
+
+    _pos = 0;
+    _call = 0;
+    if (!valid(a, A))
+    {
+      // Reset and record positions during this assembly
+      reset();
+      _recording = true;
+      _form_id = a.id();
+      _pattern = pattern_hash(A);
+      _dofmaps = {a.function_spaces().at(0)->dofmap(),
+                  a.function_spaces().at(1)->dofmap()};
+      return [this, &A](std::int32_t m, const std::int32_t* rows,
+                        std::int32_t n, const std::int32_t* cols,
+                        const T* vals) -> int
+      {
+        const std::size_t offset = _positions.size();
+        A.positions(xtl::span<const std::int32_t>(rows, m),
+                    xtl::span<const std::int32_t>(cols, n), _positions);
+        _keys.push_back(key(m, rows, n, cols));
+        _sizes.push_back(_positions.size() - offset);
+        xtl::span<T> values = A.values();
+        for (std::size_t i = offset; i < _positions.size(); ++i)
+          values[_positions[i]] += vals[i - offset];
+        return 0;
+      };
+    }
+    else
+    {
+      const std::array<int, 2> bs = A.block_size();
+      return [this, &A, bs](std::int32_t m, const std::int32_t* rows,
+                            std::int32_t n, const std::int32_t* cols,
+                            const T* vals) -> int
+      {
+        const std::size_t size = std::size_t(m) * n * bs[0] * bs[1];
+        if (_call >= _keys.size() or _sizes[_call] != size
+            or _keys[_call] != key(m, rows, n, cols))
+        {
+          reset();
+          throw std::runtime_error("Element matrix insertion does not match "
+                                   "the assembly plan.");
+        }
+
+        xtl::span<T> values = A.values();
+        const std::int32_t* pos = _positions.data() + _pos;
+        for (std::size_t i = 0; i < size; ++i)
+          values[pos[i]] += vals[i];
+        _pos += size;
+        ++_call;
+        return 0;
+      };
+    }
+  }
+
+  /// Complete an assembly. After recording, this marks the recording
+  /// as complete. After replaying, it checks that all recorded
+  /// insertions were replayed.
+  ///
+  /// Calling this function is optional after recording (the next call
+  /// to AssemblyPlan::mat_add_values completes the recording), but is
+  /// required to detect an incomplete replay.
+  void finish()
+  {
+    if (_recording)
+    {
+      _recording = false;
+      _num_recorded = _keys.size();
+    }
+    else if (_num_recorded >= 0 and _call != _keys.size())
+    {
+      reset();
+      throw std::runtime_error("Assembly inserted fewer element matrices "
+                               "than recorded in the assembly plan.");
+    }
+  }
+
+  /// Check if the plan holds recorded positions for assembling the
+  /// form a into the matrix A. The sparsity pattern of A is compared
+  /// by a hash of its row pointers and column indices.
+  /// @param[in] a The bilinear form
+  /// @param[in] A The matrix
+  /// @return True if the recorded positions can be used
+  bool valid(const Form<T>& a, const la::MatrixCSR<T>& A) const
+  {
+    if (_num_recorded < 0 or _recording)
+      return false;
+    else if (a.id() != _form_id or pattern_hash(A) != _pattern)
+      return false;
+    else
+    {
+      for (int i = 0; i < 2; ++i)
+      {
+        auto dofmap = _dofmaps[i].lock();
+        if (!dofmap or dofmap != a.function_spaces().at(i)->dofmap())
+          return false;
+      }
+      return true;
+    }
+  }
+
+  /// Discard the recorded positions
+  void reset()
+  {
+    _positions.clear();
+    _keys.clear();
+    _sizes.clear();
+    _num_recorded = -1;
+    _recording = false;
+    _pos = 0;
+    _call = 0;
+  }
+
+private:
+  // Hash of the size and indices of an element matrix insertion
+  static std::uint64_t key(std::int32_t m, const std::int32_t* rows,
+                           std::int32_t n, const std::int32_t* cols)
+  {
+    const std::array<std::uint64_t, 3> k
+        = {(std::uint64_t(m) << 32) | std::uint32_t(n),
+           common::hash_indices(xtl::span<const std::int32_t>(rows, m)),
+           common::hash_indices(xtl::span<const std::int32_t>(cols, n))};
+    return common::hash_indices(k);
+  }
+
+  // Hash of the sparsity pattern and block size of a matrix
+  static std::uint64_t pattern_hash(const la::MatrixCSR<T>& A)
+  {
+    const std::array<int, 2> bs = A.block_size();
+    const std::array<std::uint64_t, 4> k
+        = {std::uint64_t(bs[0]), std::uint64_t(bs[1]),
+           common::hash_indices(A.row_ptr()), common::hash_indices(A.cols())};
+    return common::hash_indices(k);
+  }
+
+  // Position in the matrix value array of each element matrix entry,
+  // in insertion order
+  std::vector<std::int32_t> _positions;
+
+  // Key (see AssemblyPlan::key) and number of positions of each
+  // recorded insertion
+  std::vector<std::uint64_t> _keys;
+  std::vector<std::size_t> _sizes;
+
+  // Number of recorded insertions (-1 if no recording is complete)
+  std::int64_t _num_recorded = -1;
+
+  // True while positions are being recorded
+  bool _recording = false;
+
+  // Next position and insertion to replay
+  std::size_t _pos = 0;
+  std::size_t _call = 0;
+
+  // Form id and sparsity pattern hash the plan was recorded for
+  std::size_t _form_id = 0;
+  std::uint64_t _pattern = 0;
+
+  // Dofmaps the plan was recorded for
+  std::array<std::weak_ptr<const DofMap>, 2> _dofmaps;
+};
+
+} // namespace dolfinx::fem
@@ -0,0 +1,397 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include "DofMap.h"
+#include "Form.h"
+#include "FunctionSpace.h"
+#include "utils.h"
+#include <algorithm>
+#include <cstdint>
+#include <dolfinx/common/array2d.h>
+#include <dolfinx/common/utils.h>
+#include <dolfinx/la/MatrixCSR.h>
+#include <dolfinx/mesh/Geometry.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+#include <xtl/xspan.hpp>
+
+namespace dolfinx::fem
+{
+
+/// Repeated assembly of the cell integrals of a form with batched
+/// kernels (see Form::set_batch_kernel), from data that is packed once.
+///
+/// On creation, the cell geometry, coefficients and constants of each
+/// integral are packed in the interleaved layout of the batched
+/// kernels, and the position in the target array (la::MatrixCSR::values
+/// or the array of a la::Vector) of every entry of every element tensor
+/// is computed. The positions are stored transposed, i.e. for each
+/// entry of the target array the element tensor entries that are added
+/// to it. An assembly then runs in two data-parallel phases, without
+/// any searching or insertion functions:
+///
+/// 1. the batched kernels compute the element tensors of all batches,
+///    which are kept in one array, and
+/// 2. each entry of the target array gathers and adds its element
+///    tensor entries.
+///
+/// Neither phase writes to memory that is written by another batch or
+/// entry, so both phases are executed concurrently without colouring or
+/// atomics, and the result does not depend on the number of threads.
+/// The data are contiguous arrays that use the allocator `Allocator`,
+/// e.g. an allocator of memory that is shared with an accelerator.
+///
+/// The coefficients and constants can be updated between assemblies
+/// (e.g. in a Newton solver), the mesh geometry, dofmaps, sparsity
+/// pattern and boundary conditions must not change.
+///
+/// Typical usage is
+///
+///     fem::BatchAssembler<T> assembler(a, A, bc0, bc1);
+///     for (...)
+///     {
+///       assembler.update_coefficients(fem::pack_coefficients(a));
+///       A.set(0.0);
+///       assembler.assemble(A.values(), num_threads);
+///       fem::set_diagonal(la::MatrixCSR<T>::mat_add_values(A), V, bcs);
+///       A.finalize();
+///     }
+///
+/// @note Only forms with cell integrals, each with a batched kernel,
+/// are supported, and the elements must not need dof transformations.
+/// @note The element tensors of all cells are stored, which is
+/// `num_cells * ndofs0 * ndofs1` values for a bilinear form.
+template <typename T, class Allocator = std::allocator<T>>
+class BatchAssembler
+{
+  template <typename V>
+  using rebind_t =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<V>;
+
+public:
+  /// Create an assembler of a bilinear form into a matrix
+  /// @param[in] a The bilinear form
+  /// @param[in] A A matrix with the sparsity pattern of `a`. Only the
+  /// sparsity pattern is used.
+  /// @param[in] bc0 Boundary condition markers for the rows. The rows
+  /// that are marked are not assembled. Can be empty.
+  /// @param[in] bc1 Boundary condition markers for the columns. The
+  /// columns that are marked are not assembled. Can be empty.
+  /// @param[in] alloc The allocator for the packed data
+  template <class MatrixAllocator>
+  BatchAssembler(const Form<T>& a, const la::MatrixCSR<T, MatrixAllocator>& A,
+                 const std::vector<bool>& bc0, const std::vector<bool>& bc1,
+                 const Allocator& alloc = Allocator())
+      : _constants(alloc), _tensors(alloc),
+        _offsets(rebind_t<std::int64_t>(alloc)),
+        _indices(rebind_t<std::int64_t>(alloc))
+  {
+    if (a.rank() != 2)
+      throw std::runtime_error("Form must be bilinear.");
+    pack(a, alloc);
+
+    const std::array<int, 2> bs = A.block_size();
+    const fem::DofMap& dofmap0 = *a.function_spaces().at(0)->dofmap();
+    const fem::DofMap& dofmap1 = *a.function_spaces().at(1)->dofmap();
+    if (dofmap0.bs() != bs[0] or dofmap1.bs() != bs[1])
+      throw std::runtime_error("Block sizes of form and matrix differ.");
+
+    std::vector<std::int32_t> pos;
+    build([&](std::int32_t c, std::vector<std::int32_t>& p)
+          {
+            auto dofs0 = dofmap0.list().links(c);
+            auto dofs1 = dofmap1.list().links(c);
+            pos.clear();
+            A.positions(dofs0, dofs1, pos);
+
+            // Skip the entries of rows and columns with boundary
+            // conditions
+            const std::size_t ndim1 = bs[1] * dofs1.size();
+            for (std::size_t i = 0; i < pos.size(); ++i)
+            {
+              const std::size_t r = i / ndim1, s = i % ndim1;
+              if ((!bc0.empty() and bc0[bs[0] * dofs0[r / bs[0]] + r % bs[0]])
+                  or (!bc1.empty()
+                      and bc1[bs[1] * dofs1[s / bs[1]] + s % bs[1]]))
+              {
+                pos[i] = -1;
+              }
+            }
+            p.insert(p.end(), pos.begin(), pos.end());
+          },
+          A.values().size());
+  }
+
+  /// Create an assembler of a linear form into a vector. Boundary
+  /// conditions are applied to the vector as for fem::assemble_vector,
+  /// e.g. by fem::apply_lifting and fem::set_bc.
+  /// @param[in] L The linear form
+  /// @param[in] alloc The allocator for the packed data
+  BatchAssembler(const Form<T>& L, const Allocator& alloc = Allocator())
+      : _constants(alloc), _tensors(alloc),
+        _offsets(rebind_t<std::int64_t>(alloc)),
+        _indices(rebind_t<std::int64_t>(alloc))
+  {
+    if (L.rank() != 1)
+      throw std::runtime_error("Form must be linear.");
+    pack(L, alloc);
+
+    const fem::DofMap& dofmap = *L.function_spaces().at(0)->dofmap();
+    const int bs = dofmap.bs();
+    const common::IndexMap& map = *dofmap.index_map;
+    build(
+        [&](std::int32_t c, std::vector<std::int32_t>& p)
+        {
+          for (std::int32_t dof : dofmap.list().links(c))
+            for (int k = 0; k < bs; ++k)
+              p.push_back(bs * dof + k);
+        },
+        dofmap.index_map_bs() * (map.size_local() + map.num_ghosts()));
+  }
+
+  /// Pack new coefficients, e.g. after the coefficient functions have
+  /// been updated
+  /// @param[in] coeffs The coefficients of each cell, see
+  /// fem::pack_coefficients
+  void update_coefficients(const array2d<T>& coeffs)
+  {
+    const std::size_t num_coeffs = coeffs.shape[1];
+    for (Integral& g : _integrals)
+    {
+      const std::size_t bsize = num_coeffs * g.batch_size;
+      g.w.resize(bsize * g.num_batches());
+      for (std::size_t b = 0; b < g.num_batches(); ++b)
+      {
+        for (int k = 0; k < g.batch_size; ++k)
+        {
+          const std::size_t e = std::min<std::size_t>(b * g.batch_size + k,
+                                                      g.cells.size() - 1);
+          const T* w = coeffs.row(g.cells[e]).data();
+          for (std::size_t j = 0; j < num_coeffs; ++j)
+            g.w[b * bsize + j * g.batch_size + k] = w[j];
+        }
+      }
+    }
+  }
+
+  /// Set new constants
+  /// @param[in] constants The constants, see fem::pack_constants
+  void update_constants(const xtl::span<const T>& constants)
+  {
+    _constants.assign(constants.begin(), constants.end());
+  }
+
+  /// Add the assembled form to an array
+  /// @param[in,out] x The array to add to, i.e. la::MatrixCSR::values
+  /// of a matrix with the sparsity pattern that the assembler was
+  /// created with, or the array of a vector with the layout of the
+  /// dofmap of a linear form (including ghosts)
+  /// @param[in] num_threads The number of threads of the library thread
+  /// pool to use
+  void assemble(const xtl::span<T>& x, int num_threads = 1)
+  {
+    if (x.size() + 1 != _offsets.size())
+      throw std::runtime_error("Array size does not match the assembler.");
+
+    // Compute the element tensors of all batches
+    for (Integral& g : _integrals)
+    {
+      const std::size_t num_coeffs
+          = g.num_batches() > 0 ? g.w.size() / g.num_batches() : 0;
+      const std::size_t num_x
+          = g.num_batches() > 0 ? g.x.size() / g.num_batches() : 0;
+      const std::size_t num_e = _ndim * g.batch_size;
+      common::for_each_part(
+          g.num_batches(), num_threads,
+          [&](std::int64_t b0, std::int64_t b1, int)
+          {
+            for (std::int64_t b = b0; b < b1; ++b)
+            {
+              T* Ab = _tensors.data() + g.offset + b * num_e;
+              std::fill_n(Ab, num_e, T(0));
+              g.kernel(Ab, g.w.data() + b * num_coeffs, _constants.data(),
+                       g.x.data() + b * num_x, nullptr, nullptr);
+            }
+          });
+    }
+
+    // Add the element tensor entries of each entry of x
+    common::for_each_part(
+        x.size(), num_threads,
+        [&](std::int64_t i0, std::int64_t i1, int)
+        {
+          for (std::int64_t i = i0; i < i1; ++i)
+          {
+            T sum = 0;
+            for (std::int64_t j = _offsets[i]; j < _offsets[i + 1]; ++j)
+              sum += _tensors[_indices[j]];
+            x[i] += sum;
+          }
+        });
+  }
+
+  /// Number of cells that are assembled over
+  std::int64_t num_cells() const
+  {
+    std::int64_t n = 0;
+    for (const Integral& g : _integrals)
+      n += g.cells.size();
+    return n;
+  }
+
+private:
+  // Pack the geometry, coefficients and constants of the integrals of
+  // a form
+  void pack(const Form<T>& L, const Allocator& alloc)
+  {
+    if (L.num_integrals(IntegralType::exterior_facet) > 0
+        or L.num_integrals(IntegralType::interior_facet) > 0
+        or L.num_integrals(IntegralType::vertex) > 0)
+    {
+      throw std::runtime_error("Batch assembly supports cell integrals only.");
+    }
+
+    for (auto& V : L.function_spaces())
+    {
+      if (V->element()->needs_dof_transformations())
+        throw std::runtime_error("Batch assembly does not support elements "
+                                 "that need dof transformations.");
+    }
+
+    std::shared_ptr<const mesh::Mesh> mesh = L.mesh();
+    assert(mesh);
+    const mesh::Geometry& geometry = mesh->geometry();
+    const std::size_t num_dofs_g = geometry.dofmap().num_links(0);
+
+    // Size of an element tensor
+    _ndim = 1;
+    for (auto& V : L.function_spaces())
+      _ndim *= V->dofmap()->bs() * V->dofmap()->list().links(0).size();
+
+    std::size_t offset = 0;
+    std::vector<double> x_c(3 * num_dofs_g);
+    for (int i : L.integral_ids(IntegralType::cell))
+    {
+      const auto [kernel, batch_size] = L.batch_kernel(IntegralType::cell, i);
+      if (batch_size < 1)
+        throw std::runtime_error("Batch assembly requires batched kernels.");
+
+      const std::vector<std::int32_t>& cells
+          = L.domains(IntegralType::cell, i);
+      const std::size_t num_batches
+          = (cells.size() + batch_size - 1) / batch_size;
+      Integral& g = _integrals.emplace_back(
+          Integral{kernel, batch_size, cells,
+                   std::vector<double, rebind_t<double>>(
+                       3 * num_dofs_g * batch_size * num_batches,
+                       rebind_t<double>(alloc)),
+                   std::vector<T, Allocator>(alloc), offset});
+      offset += _ndim * batch_size * num_batches;
+
+      // Pack the geometry. A partial batch is padded by repeating the
+      // last cell.
+      const std::size_t bsize = x_c.size() * batch_size;
+      for (std::size_t b = 0; b < num_batches; ++b)
+      {
+        for (int k = 0; k < batch_size; ++k)
+        {
+          const std::size_t e
+              = std::min<std::size_t>(b * batch_size + k, cells.size() - 1);
+          geometry.cell_coordinates(cells[e], x_c);
+          for (std::size_t j = 0; j < x_c.size(); ++j)
+            g.x[b * bsize + j * batch_size + k] = x_c[j];
+        }
+      }
+    }
+    _tensors.resize(offset);
+
+    update_coefficients(pack_coefficients(L));
+    update_constants(pack_constants(L));
+  }
+
+  // Compute the element tensor entries that are added to each entry of
+  // the target array. pos(c, p) appends the position in the target
+  // array of each entry of the element tensor of cell c to p, or -1 if
+  // the entry is not added.
+  template <typename F>
+  void build(F pos, std::size_t size)
+  {
+    std::vector<std::int32_t> p;
+    std::vector<std::pair<std::int32_t, std::int64_t>> entries;
+    for (const Integral& g : _integrals)
+    {
+      for (std::size_t e = 0; e < g.cells.size(); ++e)
+      {
+        p.clear();
+        pos(g.cells[e], p);
+        assert(p.size() == _ndim);
+
+        // Index of the entries in the interleaved element tensors
+        const std::size_t b = e / g.batch_size, k = e % g.batch_size;
+        const std::int64_t base = g.offset + b * _ndim * g.batch_size + k;
+        for (std::size_t j = 0; j < p.size(); ++j)
+          if (p[j] >= 0)
+            entries.push_back({p[j], base + j * g.batch_size});
+      }
+    }
+
+    // Order by target entry. The entries of a target entry are ordered
+    // by cell, so that the sums are independent of the threads.
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](auto& a, auto& b) { return a.first < b.first; });
+    _offsets.assign(size + 1, 0);
+    for (auto& e : entries)
+      ++_offsets[e.first + 1];
+    std::partial_sum(_offsets.begin(), _offsets.end(), _offsets.begin());
+    _indices.resize(entries.size());
+    std::transform(entries.begin(), entries.end(), _indices.begin(),
+                   [](auto& e) { return e.second; });
+  }
+
+  struct Integral
+  {
+    std::function<void(T*, const T*, const T*, const double*, const int*,
+                       const std::uint8_t*)>
+        kernel;
+    int batch_size;
+    std::vector<std::int32_t> cells;
+
+    // Cell geometry and coefficients, interleaved by cell within each
+    // batch
+    std::vector<double, rebind_t<double>> x;
+    std::vector<T, Allocator> w;
+
+    // Offset of the element tensors of the integral in _tensors
+    std::size_t offset;
+
+    std::size_t num_batches() const
+    {
+      return (cells.size() + batch_size - 1) / batch_size;
+    }
+  };
+
+  std::vector<Integral> _integrals;
+  std::vector<T, Allocator> _constants;
+
+  // Size of an element tensor
+  std::size_t _ndim;
+
+  // Element tensors of all batches
+  std::vector<T, Allocator> _tensors;
+
+  // Element tensor entries (indices in _tensors) that are added to each
+  // entry of the target array
+  std::vector<std::int64_t, rebind_t<std::int64_t>> _offsets;
+  std::vector<std::int64_t, rebind_t<std::int64_t>> _indices;
+};
+
+} // namespace dolfinx::fem
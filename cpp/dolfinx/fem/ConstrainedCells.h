@@ -0,0 +1,198 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include "DirichletBC.h"
+#include "DirichletBCs.h"
+#include "DofMap.h"
+#include "Form.h"
+#include "FunctionSpace.h"
+#include "utils.h"
+#include <array>
+#include <cstdint>
+#include <dolfinx/graph/AdjacencyList.h>
+#include <functional>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include <xtl/xspan.hpp>
+
+namespace dolfinx::fem
+{
+
+/// The cells of the cell integrals of a bilinear form, classified by a
+/// set of Dirichlet boundary conditions.
+///
+/// For each cell integral, the cells are split into cells with no
+/// constrained degrees-of-freedom and cells with at least one
+/// constrained degree-of-freedom (see fem::split_cells_by_bc). For the
+/// latter, the element matrix rows and columns that are zeroed are
+/// stored. Matrix assembly with a ConstrainedCells object (see
+/// fem::assemble_matrix) then performs no boundary condition checks
+/// for the cells without constrained dofs, which are typically all
+/// but a thin layer of cells, and zeroes the stored rows and columns
+/// for the remaining cells. The classification is computed once and
+/// re-used for all assemblies of the form with the boundary
+/// conditions.
+///
+/// Typical usage is
+///
+///     fem::ConstrainedCells<T> cells(a, bcs);
+///     for (...)
+///     {
+///       A.set(0.0);
+///       fem::assemble_matrix(la::MatrixCSR<T>::mat_add_values(A), a,
+///                            cells);
+///       A.finalize();
+///     }
+///
+/// @note The classification is not updated if the integration domains
+/// of the form, or the dofs of the boundary conditions, change.
+template <typename T>
+class ConstrainedCells
+{
+public:
+  /// Classify the cells of the cell integrals of a bilinear form
+  /// @param[in] a The bilinear form
+  /// @param[in] bcs Boundary conditions. Boundary conditions that are
+  /// not applied to the test or trial space of `a` are ignored.
+  ConstrainedCells(
+      const Form<T>& a,
+      const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs)
+      : _form_id(a.id())
+  {
+    if (a.rank() != 2)
+      throw std::runtime_error("Form must be a bilinear form.");
+
+    // Dof markers of the test (rows) and trial (columns) spaces. The
+    // markers of a space without boundary conditions are empty.
+    for (int i = 0; i < 2; ++i)
+    {
+      DirichletBCs<T> bcs_V(*a.function_spaces().at(i), bcs);
+      if (!bcs_V.bcs().empty())
+        _markers[i] = bcs_V.markers();
+    }
+
+    const std::array<std::reference_wrapper<const DofMap>, 2> dofmaps
+        = {*a.function_spaces().at(0)->dofmap(),
+           *a.function_spaces().at(1)->dofmap()};
+    for (int id : a.integral_ids(IntegralType::cell))
+    {
+      Cells& cells = _cells[id];
+      std::array<std::vector<std::int32_t>, 2> split = split_cells_by_bc(
+          a.domains(IntegralType::cell, id), {dofmaps[0], dofmaps[1]},
+          {_markers[0], _markers[1]});
+      cells.unconstrained = std::move(split[0]);
+      cells.constrained = std::move(split[1]);
+
+      // Element matrix rows (i = 0) and columns (i = 1) with a boundary
+      // condition applied, for each constrained cell
+      for (int i = 0; i < 2; ++i)
+      {
+        const DofMap& dofmap = dofmaps[i];
+        const int bs = dofmap.bs();
+        std::vector<std::int32_t> data, offsets(1, 0);
+        for (std::int32_t c : cells.constrained)
+        {
+          if (!_markers[i].empty())
+          {
+            xtl::span<const std::int32_t> dofs = dofmap.cell_dofs(c);
+            for (std::size_t j = 0; j < dofs.size(); ++j)
+              for (int k = 0; k < bs; ++k)
+                if (_markers[i][bs * dofs[j] + k])
+                  data.push_back(bs * j + k);
+          }
+          offsets.push_back(data.size());
+        }
+        cells.zeroed[i] = graph::AdjacencyList<std::int32_t>(
+            std::move(data), std::move(offsets));
+      }
+    }
+  }
+
+  /// Copy constructor
+  ConstrainedCells(const ConstrainedCells& cells) = default;
+
+  /// Move constructor
+  ConstrainedCells(ConstrainedCells&& cells) = default;
+
+  /// Destructor
+  ~ConstrainedCells() = default;
+
+  /// Copy assignment
+  ConstrainedCells& operator=(const ConstrainedCells& cells) = default;
+
+  /// Move assignment
+  ConstrainedCells& operator=(ConstrainedCells&& cells) = default;
+
+  /// The identifier of the form (see Form::id) the cells were
+  /// classified for
+  std::size_t form_id() const { return _form_id; }
+
+  /// Dof markers for the test (i = 0) and trial (i = 1) space
+  /// @param[in] i The argument index
+  /// @return Markers (unrolled, including ghosts), with markers[j] =
+  /// true if dof j has a boundary condition applied. The array is
+  /// empty if no boundary condition is applied to the space.
+  const std::vector<bool>& markers(int i) const { return _markers.at(i); }
+
+  /// Cells of the cell integral `id` without constrained dofs
+  /// @param[in] id The integral identifier
+  /// @return The cells
+  const std::vector<std::int32_t>& unconstrained(int id) const
+  {
+    return cells(id).unconstrained;
+  }
+
+  /// Cells of the cell integral `id` with at least one constrained dof
+  /// @param[in] id The integral identifier
+  /// @return The cells
+  const std::vector<std::int32_t>& constrained(int id) const
+  {
+    return cells(id).constrained;
+  }
+
+  /// Element matrix rows (i = 0) or columns (i = 1) to zero for each
+  /// of the cells ConstrainedCells::constrained of integral `id`
+  /// @param[in] id The integral identifier
+  /// @param[in] i The argument index
+  /// @return The local (unrolled) row or column indices of the element
+  /// matrix for each constrained cell
+  const graph::AdjacencyList<std::int32_t>& zeroed(int id, int i) const
+  {
+    return cells(id).zeroed.at(i);
+  }
+
+private:
+  struct Cells
+  {
+    std::vector<std::int32_t> unconstrained, constrained;
+    std::array<graph::AdjacencyList<std::int32_t>, 2> zeroed
+        = {graph::AdjacencyList<std::int32_t>(0),
+           graph::AdjacencyList<std::int32_t>(0)};
+  };
+
+  const Cells& cells(int id) const
+  {
+    auto it = _cells.find(id);
+    if (it == _cells.end())
+      throw std::runtime_error("No cells for requested integral.");
+    return it->second;
+  }
+
+  // The form the cells were classified for
+  std::size_t _form_id;
+
+  // Dof markers for the test and trial spaces
+  std::array<std::vector<bool>, 2> _markers;
+
+  // Classified cells of each cell integral
+  std::map<int, Cells> _cells;
+};
+
+} // namespace dolfinx::fem
@@ -5,10 +5,18 @@
 // SPDX-License-Identifier:    LGPL-3.0-or-later
 
 #include "CoordinateElement.h"
+#include "TabulationCache.h"
+#include <array>
 #include <basix/finite-element.h>
+#include <dolfinx/common/cpu.h>
 #include <dolfinx/common/math.h>
 #include <dolfinx/mesh/cell_types.h>
+#include <functional>
+#include <numeric>
+#include <string>
+#include <vector>
 #include <xtensor-blas/xlinalg.hpp>
+#include <xtensor/xadapt.hpp>
 #include <xtensor/xnoalias.hpp>
 #include <xtensor/xview.hpp>
 
@@ -30,6 +38,48 @@ double compute_determinant(Matrix& A)
     return std::sqrt(math::det(ATA));
   }
 }
+
+// Compute the inverse, or pseudo-inverse if gdim > tdim, K (tdim x
+// gdim) of a Jacobian J (gdim x tdim) and return its (pseudo-)
+// determinant. The matrices are stored row-major in fixed size arrays.
+double compute_inverse(const std::array<double, 9>& J,
+                       std::array<double, 9>& K, std::size_t gdim,
+                       std::size_t tdim)
+{
+  auto _J = xt::adapt(J.data(), gdim * tdim, xt::no_ownership(),
+                      std::array{gdim, tdim});
+  auto _K = xt::adapt(K.data(), tdim * gdim, xt::no_ownership(),
+                      std::array{tdim, gdim});
+  if (gdim == tdim)
+  {
+    math::inv(_J, _K);
+    return math::det(_J);
+  }
+  else
+  {
+    // K = (J^T J)^{-1} J^T
+    std::array<double, 9> A = {0}, Ainv;
+    auto _A = xt::adapt(A.data(), tdim * tdim, xt::no_ownership(),
+                        std::array{tdim, tdim});
+    auto _Ainv = xt::adapt(Ainv.data(), tdim * tdim, xt::no_ownership(),
+                           std::array{tdim, tdim});
+    for (std::size_t i = 0; i < tdim; ++i)
+      for (std::size_t j = 0; j < tdim; ++j)
+        for (std::size_t k = 0; k < gdim; ++k)
+          _A(i, j) += _J(k, i) * _J(k, j);
+    math::inv(_A, _Ainv);
+    for (std::size_t i = 0; i < tdim; ++i)
+    {
+      for (std::size_t j = 0; j < gdim; ++j)
+      {
+        _K(i, j) = 0;
+        for (std::size_t l = 0; l < tdim; ++l)
+          _K(i, j) += _Ainv(i, l) * _J(j, l);
+      }
+    }
+    return std::sqrt(math::det(_A));
+  }
+}
 } // namespace
 
 //-----------------------------------------------------------------------------
@@ -40,6 +90,9 @@ CoordinateElement::CoordinateElement(
   int degree = _element->degree();
   const mesh::CellType cell = cell_shape();
   _is_affine = mesh::is_simplex(cell) and degree == 1;
+  _hash = std::hash<std::string>{}("CoordinateElement("
+                                   + mesh::to_string(cell) + ", "
+                                   + std::to_string(degree) + ")");
 }
 //-----------------------------------------------------------------------------
 CoordinateElement::CoordinateElement(mesh::CellType celltype, int degree)
@@ -72,6 +125,10 @@ int CoordinateElement::topological_dimension() const
   return basix::cell::topology(_element->cell_type()).size() - 1;
 }
 //-----------------------------------------------------------------------------
+int CoordinateElement::degree() const { return _element->degree(); }
+//-----------------------------------------------------------------------------
+std::size_t CoordinateElement::hash() const noexcept { return _hash; }
+//-----------------------------------------------------------------------------
 xt::xtensor<double, 4>
 CoordinateElement::tabulate(int n, const xt::xtensor<double, 2>& X) const
 {
@@ -143,16 +200,14 @@ void CoordinateElement::compute_jacobian_inverse(
   }
   else
   {
-    for (std::size_t p = 0; p < J.shape(0); ++p)
-    {
-      J0 = xt::view(J, p, xt::all(), xt::all());
-      if (gdim == tdim)
-        math::inv(J0, K0);
-      else
-        K0 = xt::linalg::pinv(J0);
-      auto K_ip = xt::view(K, p, xt::all(), xt::all());
-      K_ip.assign(K0);
-    }
+    // Invert the Jacobians of all points at once, stored with the
+    // point as the fastest index
+    const std::size_t num_points = J.shape(0);
+    xt::xtensor<double, 3> Js = xt::transpose(J, {1, 2, 0});
+    xt::xtensor<double, 3> Ks = xt::empty<double>(
+        {std::size_t(tdim), std::size_t(gdim), num_points});
+    cpu::pinv_batch(gdim, tdim, num_points, Js.data(), Ks.data());
+    K.assign(xt::transpose(Ks, {2, 0, 1}));
   }
 }
 //--------------------------------------------------------------------------------
@@ -168,11 +223,17 @@ void CoordinateElement::compute_jacobian_determinant(
   }
   else
   {
-    for (std::size_t p = 0; p < J.shape(0); ++p)
+    const std::size_t num_points = J.shape(0);
+    const std::size_t gdim = J.shape(1);
+    const std::size_t tdim = J.shape(2);
+    xt::xtensor<double, 3> Js = xt::transpose(J, {1, 2, 0});
+    if (gdim == tdim)
+      cpu::det_batch(gdim, num_points, Js.data(), Jdet.data());
+    else
     {
-      auto Jp = xt::view(J, p, xt::all(), xt::all());
-      double det = compute_determinant(Jp);
-      Jdet[p] = det;
+      xt::xtensor<double, 3> Ks = xt::empty<double>({tdim, gdim, num_points});
+      cpu::pinv_batch(gdim, tdim, num_points, Js.data(), Ks.data(),
+                      Jdet.data());
     }
   }
 }
@@ -226,65 +287,117 @@ void CoordinateElement::pull_back(
   assert(detJ.size() == num_points);
   assert(K.size() == num_points * gdim * tdim);
 
-  xt::xtensor<double, 4> dphi({tdim, num_points, d, 1});
   if (_is_affine)
   {
     // Tabulate shape function and first derivative at the origin
     xt::xtensor<double, 2> X0 = xt::zeros<double>({std::size_t(1), tdim});
-    xt::xtensor<double, 4> tabulated_data = _element->tabulate(1, X0);
-    dphi = xt::view(tabulated_data, xt::range(1, tdim + 1), xt::all(),
-                    xt::all(), xt::all());
+    std::shared_ptr<const xt::xtensor<double, 4>> tabulated_data
+        = TabulationCache::instance().tabulate(*this, 1, X0);
+    xt::xtensor<double, 4> dphi
+        = xt::view(*tabulated_data, xt::range(1, tdim + 1), xt::all(),
+                   xt::all(), xt::all());
 
-    // Compute Jacobian, its inverse and determinant
-    compute_jacobian(dphi, cell_geometry, J);
-    compute_jacobian_inverse(J, K);
-    compute_jacobian_determinant(J, detJ);
+    // Compute Jacobian, its inverse and determinant, which are the same
+    // at all points
+    xt::xtensor<double, 3> J0({1, gdim, tdim});
+    xt::xtensor<double, 3> K0({1, tdim, gdim});
+    xt::xtensor<double, 1> detJ0({1});
+    compute_jacobian(dphi, cell_geometry, J0);
+    compute_jacobian_inverse(J0, K0);
+    compute_jacobian_determinant(J0, detJ0);
+    J = xt::broadcast(xt::view(J0, 0, xt::all(), xt::all()), J.shape());
+    K = xt::broadcast(xt::view(K0, 0, xt::all(), xt::all()), K.shape());
+    detJ.fill(detJ0[0]);
 
     // Compute physical coordinates at X=0 (phi(X) * cell_geom).
-    auto phi0 = xt::view(tabulated_data, 0, 0, xt::all(), 0);
+    auto phi0 = xt::view(*tabulated_data, 0, 0, xt::all(), 0);
     auto x0 = xt::linalg::dot(xt::transpose(cell_geometry), phi0);
 
     // Calculate X for each point
-    auto K0 = xt::view(K, 0, xt::all(), xt::all());
+    auto _K0 = xt::view(K0, 0, xt::all(), xt::all());
     for (std::size_t ip = 0; ip < num_points; ++ip)
-      xt::row(X, ip) = xt::linalg::dot(K0, xt::row(x, ip) - x0);
+      xt::row(X, ip) = xt::linalg::dot(_K0, xt::row(x, ip) - x0);
   }
   else
   {
-    xt::xtensor<double, 2> Xk({1, tdim});
-    xt::xtensor<double, 1> dX = xt::empty<double>({tdim});
-    for (std::size_t ip = 0; ip < num_points; ++ip)
+    // Newton iterations on all points at once. In each iteration the
+    // basis is tabulated at the current estimate of all points that
+    // have not converged, and points are removed from the active set
+    // once converged.
+    X.fill(0);
+    std::vector<std::size_t> active(num_points);
+    std::iota(active.begin(), active.end(), 0);
+    xt::xtensor<double, 2> Xk;
+    for (int k = 0; k < non_affine_max_its and !active.empty(); ++k)
     {
-      Xk.fill(0);
-      int k;
-      for (k = 0; k < non_affine_max_its; ++k)
+      Xk.resize({active.size(), tdim});
+      for (std::size_t i = 0; i < active.size(); ++i)
+        for (std::size_t j = 0; j < tdim; ++j)
+          Xk(i, j) = X(active[i], j);
+      const xt::xtensor<double, 4> tabulated_data
+          = _element->tabulate(1, Xk);
+
+      std::size_t num_active = 0;
+      for (std::size_t i = 0; i < active.size(); ++i)
       {
-        xt::xtensor<double, 4> tabulated_data = _element->tabulate(1, Xk);
-        dphi = xt::view(tabulated_data, xt::range(1, tdim + 1), xt::all(),
-                        xt::all(), xt::all());
+        const std::size_t ip = active[i];
 
-        // cell_geometry * phi(0)
-        auto phi0 = xt::view(tabulated_data, 0, 0, xt::all(), 0);
-        auto xk = xt::linalg::dot(xt::transpose(cell_geometry), phi0);
+        // Physical coordinate (xk) and Jacobian (Jk) at the point
+        std::array<double, 3> xk = {0, 0, 0};
+        std::array<double, 9> Jk = {0};
+        for (std::size_t a = 0; a < d; ++a)
+        {
+          const double phi = tabulated_data(0, i, a, 0);
+          for (std::size_t j = 0; j < gdim; ++j)
+          {
+            const double c = cell_geometry(a, j);
+            xk[j] += c * phi;
+            for (std::size_t l = 0; l < tdim; ++l)
+              Jk[j * tdim + l] += c * tabulated_data(l + 1, i, a, 0);
+          }
+        }
 
-        // Compute Jacobian, its inverse and determinant
-        compute_jacobian(dphi, cell_geometry, J);
-        compute_jacobian_inverse(J, K);
-        compute_jacobian_determinant(J, detJ);
+        std::array<double, 9> Kk;
+        const double detJk = compute_inverse(Jk, Kk, gdim, tdim);
 
-        auto K0 = xt::view(K, 0, xt::all(), xt::all());
-        dX = xt::linalg::dot(K0, xt::row(x, ip) - xk);
+        // Newton increment
+        std::array<double, 3> dX = {0, 0, 0};
+        double norm = 0;
+        for (std::size_t l = 0; l < tdim; ++l)
+        {
+          for (std::size_t j = 0; j < gdim; ++j)
+            dX[l] += Kk[l * gdim + j] * (x(ip, j) - xk[j]);
+          norm += dX[l] * dX[l];
+        }
 
-        if (xt::linalg::norm(dX) < non_affine_atol)
-          break;
-        Xk += dX;
-      }
-      xt::row(X, ip) = xt::row(Xk, 0);
-      if (k == non_affine_max_its)
-      {
-        throw std::runtime_error(
-            "Newton method failed to converge for non-affine geometry");
+        if (std::sqrt(norm) < non_affine_atol)
+        {
+          // Store the Jacobian, its inverse and determinant at the
+          // point
+          for (std::size_t j = 0; j < gdim; ++j)
+          {
+            for (std::size_t l = 0; l < tdim; ++l)
+            {
+              J(ip, j, l) = Jk[j * tdim + l];
+              K(ip, l, j) = Kk[l * gdim + j];
+            }
+          }
+          detJ[ip] = detJk;
+        }
+        else
+        {
+          for (std::size_t l = 0; l < tdim; ++l)
+            X(ip, l) += dX[l];
+          active[num_active++] = ip;
+        }
       }
+      active.resize(num_active);
+    }
+
+    if (!active.empty())
+    {
+      throw std::runtime_error(
+          "Newton method failed to converge for non-affine geometry");
     }
   }
 }
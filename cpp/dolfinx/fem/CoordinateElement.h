@@ -47,6 +47,14 @@ public:
   /// Return the topological dimension of the cell shape
   int topological_dimension() const;
 
+  /// Polynomial degree of the map
+  /// @return The degree of the coordinate element
+  int degree() const;
+
+  /// Return simple hash of the cell shape and polynomial degree of the
+  /// map, which identifies the Lagrange basis of the coordinate element
+  std::size_t hash() const noexcept;
+
   /// Compute basis values and derivatives at set of points.
   /// @param[in] n The order of derivatives, up to and including, to
   /// compute. Use 0 for the basis functions only.
@@ -101,7 +109,20 @@ public:
                            const xt::xtensor<double, 2>& phi);
 
   /// Compute reference coordinates X, and J, detJ and K for physical
-  /// coordinates x
+  /// coordinates x. The points x must be in the same cell. For
+  /// non-affine cells, the Newton iterations are performed for all
+  /// points at once, and a point is not iterated further once it has
+  /// converged.
+  /// @param[out] X The reference coordinates, with shape (number of
+  /// points, topological dimension)
+  /// @param[out] J The Jacobian at each point, with shape (number of
+  /// points, geometric dimension, topological dimension)
+  /// @param[out] detJ The determinant of the Jacobian at each point
+  /// @param[out] K The inverse of the Jacobian at each point, with shape
+  /// (number of points, topological dimension, geometric dimension)
+  /// @param[in] x The physical coordinates, with shape (number of
+  /// points, geometric dimension)
+  /// @param[in] cell_geometry The cell node coordinates (physical)
   void pull_back(xt::xtensor<double, 2>& X, xt::xtensor<double, 3>& J,
                  xt::xtensor<double, 1>& detJ, xt::xtensor<double, 3>& K,
                  const xt::xtensor<double, 2>& x,
@@ -134,5 +155,8 @@ private:
 
   // Basix Element
   std::shared_ptr<basix::FiniteElement> _element;
+
+  // Simple hash of the cell shape and degree
+  std::size_t _hash;
 };
 } // namespace dolfinx::fem
@@ -14,8 +14,8 @@
 #include <dolfinx/mesh/Mesh.h>
 #include <dolfinx/mesh/Topology.h>
 #include <dolfinx/mesh/cell_types.h>
-#include <map>
 #include <numeric>
+#include <tuple>
 #include <utility>
 #include <xtensor/xtensor.hpp>
 
@@ -24,112 +24,94 @@ using namespace dolfinx::fem;
 
 namespace
 {
-/// Create a symmetric MPI neighbourhood communciator from an
-/// input neighbourhood communicator
-dolfinx::MPI::Comm create_symmetric_comm(MPI_Comm comm)
-{
-  // assert(comm != MPI_COMM_NULL);
-  int indegree(-1), outdegree(-2), weighted(-1);
-  MPI_Dist_graph_neighbors_count(comm, &indegree, &outdegree, &weighted);
-
-  std::vector<int> neighbors(indegree + outdegree);
-  MPI_Dist_graph_neighbors(comm, indegree, neighbors.data(), MPI_UNWEIGHTED,
-                           outdegree, neighbors.data() + indegree,
-                           MPI_UNWEIGHTED);
-
-  std::sort(neighbors.begin(), neighbors.end());
-  neighbors.erase(std::unique(neighbors.begin(), neighbors.end()),
-                  neighbors.end());
-
-  MPI_Comm comm_sym;
-  std::vector<int> sourceweights(neighbors.size(), 1);
-  std::vector<int> destweights(neighbors.size(), 1);
-  MPI_Dist_graph_create_adjacent(comm, neighbors.size(), neighbors.data(),
-                                 sourceweights.data(), neighbors.size(),
-                                 neighbors.data(), destweights.data(),
-                                 MPI_INFO_NULL, false, &comm_sym);
-
-  return dolfinx::MPI::Comm(comm_sym, false);
-}
-
 //-----------------------------------------------------------------------------
-/// Find DOFs on this processes that are constrained by a Dirichlet
-/// condition detected by another process
+/// Find DOFs on this processes that are constrained by Dirichlet
+/// conditions detected by another process, for several index maps in
+/// the same communication rounds
 ///
-/// @param[in] map The IndexMap with the dof layout
-/// @param[in] dofs_local The IndexMap with the dof layout
-/// @return List of local dofs with boundary conditions applied but
-///   detected by other processes. It may contain duplicate entries.
-std::vector<std::int32_t>
-get_remote_bcs1(const common::IndexMap& map,
-                const std::vector<std::int32_t>& dofs_local)
+/// @param[in] maps The IndexMap with the dof layout of each condition
+/// @param[in] dofs_local The dofs (blocks) detected by this process for
+/// each condition
+/// @return For each condition, the list of local dofs with boundary
+///   conditions applied but detected by other processes. It may contain
+///   duplicate entries.
+std::vector<std::vector<std::int32_t>> get_remote_bcs1(
+    const std::vector<std::reference_wrapper<const common::IndexMap>>& maps,
+    const std::vector<std::vector<std::int32_t>>& dofs_local)
 {
-  dolfinx::MPI::Comm comm
-      = create_symmetric_comm(map.comm(common::IndexMap::Direction::forward));
-
-  // Get number of processes in neighborhood
-  int num_neighbors(-1), outdegree(-2), weighted(-1);
-  MPI_Dist_graph_neighbors_count(comm.comm(), &num_neighbors, &outdegree,
-                                 &weighted);
-
-  // Return early if there are no neighbors
-  if (num_neighbors == 0)
-    return {};
+  assert(maps.size() == dofs_local.size());
+  const std::size_t n = maps.size();
+
+  // Get the (cached) symmetric neighborhood communicators and the
+  // number of processes in each neighborhood
+  std::vector<MPI_Comm> comms(n);
+  std::vector<int> num_neighbors(n);
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    comms[i] = maps[i].get().comm_symmetric();
+    int outdegree(-2), weighted(-1);
+    MPI_Dist_graph_neighbors_count(comms[i], &num_neighbors[i], &outdegree,
+                                   &weighted);
+  }
 
-  // Figure out how many entries to receive from each neighbor
-  const int num_dofs = dofs_local.size();
-  std::vector<int> num_dofs_recv(num_neighbors);
-  MPI_Neighbor_allgather(&num_dofs, 1, MPI_INT, num_dofs_recv.data(), 1,
-                         MPI_INT, comm.comm());
+  // Figure out how many entries to receive from each neighbor. The
+  // exchanges for all conditions are posted before waiting.
+  std::vector<int> num_dofs(n);
+  std::vector<std::vector<int>> num_dofs_recv(n);
+  std::vector<MPI_Request> requests(n, MPI_REQUEST_NULL);
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    if (num_neighbors[i] == 0)
+      continue;
+    num_dofs[i] = dofs_local[i].size();
+    num_dofs_recv[i].resize(num_neighbors[i]);
+    MPI_Ineighbor_allgather(&num_dofs[i], 1, MPI_INT, num_dofs_recv[i].data(),
+                            1, MPI_INT, comms[i], &requests[i]);
+  }
 
   // NOTE: we could consider only dofs that we know are shared
   // Build array of global indices of dofs
-  std::vector<std::int64_t> dofs_global(dofs_local.size());
-  map.local_to_global(dofs_local, dofs_global);
-
-  // Compute displacements for data to receive. Last entry has total
-  // number of received items.
-  std::vector<int> disp(num_neighbors + 1, 0);
-  std::partial_sum(num_dofs_recv.begin(), num_dofs_recv.end(),
-                   std::next(disp.begin()));
-
-  // NOTE: we could use MPI_Neighbor_alltoallv to send only to relevant
-  // processes
+  std::vector<std::vector<std::int64_t>> dofs_global(n);
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    dofs_global[i].resize(dofs_local[i].size());
+    maps[i].get().local_to_global(dofs_local[i], dofs_global[i]);
+  }
+  MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
 
   // Send/receive global index of dofs with bcs to all neighbors
-  std::vector<std::int64_t> dofs_received(disp.back());
-  MPI_Neighbor_allgatherv(dofs_global.data(), dofs_global.size(), MPI_INT64_T,
-                          dofs_received.data(), num_dofs_recv.data(),
-                          disp.data(), MPI_INT64_T, comm.comm());
-
-  // FIXME: check that dofs is sorted
-  // Build vector of local dof indicies that have been marked by another
-  // process
-  const std::array<std::int64_t, 2> range = map.local_range();
-  const std::vector<std::int64_t>& ghosts = map.ghosts();
-
-  // Build map from ghost to local position
-  std::vector<std::pair<std::int64_t, std::int32_t>> global_local_ghosts;
-  const std::int32_t local_size = range[1] - range[0];
-  for (std::size_t i = 0; i < ghosts.size(); ++i)
-    global_local_ghosts.emplace_back(ghosts[i], i + local_size);
-  std::map<std::int64_t, std::int32_t> global_to_local(
-      global_local_ghosts.begin(), global_local_ghosts.end());
+  std::vector<std::vector<int>> disp(n);
+  std::vector<std::vector<std::int64_t>> dofs_received(n);
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    if (num_neighbors[i] == 0)
+      continue;
+
+    // Compute displacements for data to receive. Last entry has total
+    // number of received items.
+    disp[i].resize(num_neighbors[i] + 1, 0);
+    std::partial_sum(num_dofs_recv[i].begin(), num_dofs_recv[i].end(),
+                     std::next(disp[i].begin()));
+
+    // NOTE: we could use MPI_Neighbor_alltoallv to send only to
+    // relevant processes
+    dofs_received[i].resize(disp[i].back());
+    MPI_Ineighbor_allgatherv(dofs_global[i].data(), dofs_global[i].size(),
+                             MPI_INT64_T, dofs_received[i].data(),
+                             num_dofs_recv[i].data(), disp[i].data(),
+                             MPI_INT64_T, comms[i], &requests[i]);
+  }
+  MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
 
-  std::vector<std::int32_t> dofs;
-  for (std::size_t i = 0; i < dofs_received.size(); ++i)
+  // Build vectors of local dof indicies that have been marked by
+  // another process
+  std::vector<std::vector<std::int32_t>> dofs(n);
+  for (std::size_t i = 0; i < n; ++i)
   {
-    if (dofs_received[i] >= range[0] and dofs_received[i] < range[1])
-      dofs.push_back(dofs_received[i] - range[0]);
-    else
-    {
-      // Search in ghosts
-      if (auto it = global_to_local.find(dofs_received[i]);
-          it != global_to_local.end())
-      {
-        dofs.push_back(it->second);
-      }
-    }
+    dofs[i].resize(dofs_received[i].size());
+    maps[i].get().global_to_local(dofs_received[i], dofs[i]);
+    dofs[i].erase(std::remove(dofs[i].begin(), dofs[i].end(), -1),
+                  dofs[i].end());
   }
 
   return dofs;
@@ -152,12 +134,10 @@ get_remote_bcs2(const common::IndexMap& map0, int bs0,
   // NOTE: assumes that dofs are unrolled, i.e. not blocked. Could it be
   // make more efficient to handle the case of a common block size?
 
-  dolfinx::MPI::Comm comm0
-      = create_symmetric_comm(map0.comm(common::IndexMap::Direction::forward));
+  MPI_Comm comm0 = map0.comm_symmetric();
 
   int num_neighbors(-1), outdegree(-2), weighted(-1);
-  MPI_Dist_graph_neighbors_count(comm0.comm(), &num_neighbors, &outdegree,
-                                 &weighted);
+  MPI_Dist_graph_neighbors_count(comm0, &num_neighbors, &outdegree, &weighted);
   assert(num_neighbors == outdegree);
 
   // Return early if there are no neighbors
@@ -168,7 +148,7 @@ get_remote_bcs2(const common::IndexMap& map0, int bs0,
   const int num_dofs = 2 * dofs_local.size();
   std::vector<int> num_dofs_recv(num_neighbors);
   MPI_Neighbor_allgather(&num_dofs, 1, MPI_INT, num_dofs_recv.data(), 1,
-                         MPI_INT, comm0.comm());
+                         MPI_INT, comm0);
 
   // NOTE: we consider only dofs that we know are shared
   // Build array of global indices of dofs
@@ -218,7 +198,7 @@ get_remote_bcs2(const common::IndexMap& map0, int bs0,
       {static_cast<std::size_t>(disp.back() / 2), 2});
   MPI_Neighbor_allgatherv(dofs_global.data(), dofs_global.size(), MPI_INT64_T,
                           dofs_received.data(), num_dofs_recv.data(),
-                          disp.data(), MPI_INT64_T, comm0.comm());
+                          disp.data(), MPI_INT64_T, comm0);
 
   const std::array<std::reference_wrapper<const common::IndexMap>, 2> maps
       = {map0, map1};
@@ -229,35 +209,17 @@ get_remote_bcs2(const common::IndexMap& map0, int bs0,
     // FIXME: check that dofs is sorted?
     // Build vector of local dof indicies that have been marked by
     // another process
-    const std::array<std::int64_t, 2> range = maps[b].get().local_range();
-    const std::vector<std::int64_t>& ghosts = maps[b].get().ghosts();
-
-    // Build map from ghost to local position
-    std::vector<std::pair<std::int64_t, std::int32_t>> global_local_ghosts;
-    const std::int32_t local_size = range[1] - range[0];
-    for (std::size_t i = 0; i < ghosts.size(); ++i)
-      global_local_ghosts.emplace_back(ghosts[i], i + local_size);
-    std::map<std::int64_t, std::int32_t> global_to_local(
-        global_local_ghosts.begin(), global_local_ghosts.end());
+    std::vector<std::int64_t> blocks(dofs_received.shape(0));
+    for (std::size_t i = 0; i < blocks.size(); ++i)
+      blocks[i] = dofs_received(i, b) / bs[b];
+    std::vector<std::int32_t> local(blocks.size());
+    maps[b].get().global_to_local(blocks, local);
 
     std::vector<std::int32_t>& dofs = dofs_array[b];
-    for (std::size_t i = 0; i < dofs_received.shape(0); ++i)
+    for (std::size_t i = 0; i < local.size(); ++i)
     {
-      if (dofs_received(i, b) >= bs[b] * range[0]
-          and dofs_received(i, b) < bs[b] * range[1])
-      {
-        // Owned dof
-        dofs.push_back(dofs_received(i, b) - bs[b] * range[0]);
-      }
-      else
-      {
-        // Search in ghosts
-        if (auto it = global_to_local.find(dofs_received(i, b) / bs[b]);
-            it != global_to_local.end())
-        {
-          dofs.push_back(bs[b] * it->second + dofs_received(i, b) % bs[b]);
-        }
-      }
+      if (local[i] >= 0)
+        dofs.push_back(bs[b] * local[i] + dofs_received(i, b) % bs[b]);
     }
   }
   assert(dofs_array[0].size() == dofs_array[1].size());
@@ -270,6 +232,75 @@ get_remote_bcs2(const common::IndexMap& map0, int bs0,
   return dofs;
 }
 //-----------------------------------------------------------------------------
+/// Find the dofs (blocks) of V in the closure of the entities of
+/// dimension dim that are known to this process
+/// @return The sorted dofs, without duplicates
+std::vector<std::int32_t>
+locate_local_dofs(const fem::FunctionSpace& V, const int dim,
+                  const xtl::span<const std::int32_t>& entities)
+{
+  assert(V.dofmap());
+  std::shared_ptr<const DofMap> dofmap = V.dofmap();
+  assert(V.mesh());
+  std::shared_ptr<const mesh::Mesh> mesh = V.mesh();
+
+  const int tdim = mesh->topology().dim();
+
+  // Initialise entity-cell connectivity
+  // FIXME: cleanup these calls? Some of them happen internally again.
+  mesh->topology_mutable().create_entities(tdim);
+  mesh->topology_mutable().create_connectivity(dim, tdim);
+
+  // Prepare an element - local dof layout for dofs on entities of the
+  // entity_dim
+  const int num_cell_entities
+      = mesh::cell_num_entities(mesh->topology().cell_type(), dim);
+  std::vector<std::vector<int>> entity_dofs;
+  for (int i = 0; i < num_cell_entities; ++i)
+  {
+    entity_dofs.push_back(
+        dofmap->element_dof_layout->entity_closure_dofs(dim, i));
+  }
+
+  auto e_to_c = mesh->topology().connectivity(dim, tdim);
+  assert(e_to_c);
+  auto c_to_e = mesh->topology().connectivity(tdim, dim);
+  assert(c_to_e);
+
+  const int num_entity_closure_dofs
+      = dofmap->element_dof_layout->num_entity_closure_dofs(dim);
+  std::vector<std::int32_t> dofs;
+  for (std::int32_t e : entities)
+  {
+    // Get first attached cell
+    assert(e_to_c->num_links(e) > 0);
+    const int cell = e_to_c->links(e)[0];
+
+    // Get local index of facet with respect to the cell
+    auto entities_d = c_to_e->links(cell);
+    auto it = std::find(entities_d.begin(), entities_d.end(), e);
+    assert(it != entities_d.end());
+    const int entity_local_index = std::distance(entities_d.data(), it);
+
+    // Get cell dofmap
+    auto cell_dofs = dofmap->cell_dofs(cell);
+
+    // Loop over entity dofs
+    for (int j = 0; j < num_entity_closure_dofs; j++)
+    {
+      const int index = entity_dofs[entity_local_index][j];
+      dofs.push_back(cell_dofs[index]);
+    }
+  }
+
+  // TODO: is removing duplicates at this point worth the effort?
+  // Remove duplicates
+  std::sort(dofs.begin(), dofs.end());
+  dofs.erase(std::unique(dofs.begin(), dofs.end()), dofs.end());
+
+  return dofs;
+}
+//-----------------------------------------------------------------------------
 } // namespace
 
 //-----------------------------------------------------------------------------
@@ -404,69 +435,12 @@ fem::locate_dofs_topological(const fem::FunctionSpace& V, const int dim,
                              const xtl::span<const std::int32_t>& entities,
                              bool remote)
 {
-  assert(V.dofmap());
-  std::shared_ptr<const DofMap> dofmap = V.dofmap();
-  assert(V.mesh());
-  std::shared_ptr<const mesh::Mesh> mesh = V.mesh();
-
-  const int tdim = mesh->topology().dim();
-
-  // Initialise entity-cell connectivity
-  // FIXME: cleanup these calls? Some of them happen internally again.
-  mesh->topology_mutable().create_entities(tdim);
-  mesh->topology_mutable().create_connectivity(dim, tdim);
-
-  // Prepare an element - local dof layout for dofs on entities of the
-  // entity_dim
-  const int num_cell_entities
-      = mesh::cell_num_entities(mesh->topology().cell_type(), dim);
-  std::vector<std::vector<int>> entity_dofs;
-  for (int i = 0; i < num_cell_entities; ++i)
-  {
-    entity_dofs.push_back(
-        dofmap->element_dof_layout->entity_closure_dofs(dim, i));
-  }
-
-  auto e_to_c = mesh->topology().connectivity(dim, tdim);
-  assert(e_to_c);
-  auto c_to_e = mesh->topology().connectivity(tdim, dim);
-  assert(c_to_e);
-
-  const int num_entity_closure_dofs
-      = dofmap->element_dof_layout->num_entity_closure_dofs(dim);
-  std::vector<std::int32_t> dofs;
-  for (std::int32_t e : entities)
-  {
-    // Get first attached cell
-    assert(e_to_c->num_links(e) > 0);
-    const int cell = e_to_c->links(e)[0];
-
-    // Get local index of facet with respect to the cell
-    auto entities_d = c_to_e->links(cell);
-    auto it = std::find(entities_d.begin(), entities_d.end(), e);
-    assert(it != entities_d.end());
-    const int entity_local_index = std::distance(entities_d.data(), it);
-
-    // Get cell dofmap
-    auto cell_dofs = dofmap->cell_dofs(cell);
-
-    // Loop over entity dofs
-    for (int j = 0; j < num_entity_closure_dofs; j++)
-    {
-      const int index = entity_dofs[entity_local_index][j];
-      dofs.push_back(cell_dofs[index]);
-    }
-  }
-
-  // TODO: is removing duplicates at this point worth the effort?
-  // Remove duplicates
-  std::sort(dofs.begin(), dofs.end());
-  dofs.erase(std::unique(dofs.begin(), dofs.end()), dofs.end());
-
+  std::vector<std::int32_t> dofs = locate_local_dofs(V, dim, entities);
   if (remote)
   {
+    assert(V.dofmap());
     const std::vector dofs_remote
-        = get_remote_bcs1(*V.dofmap()->index_map, dofs);
+        = get_remote_bcs1({*V.dofmap()->index_map}, {dofs}).front();
 
     // Add received bc indices to dofs_local
     dofs.insert(dofs.end(), dofs_remote.begin(), dofs_remote.end());
@@ -479,6 +453,40 @@ fem::locate_dofs_topological(const fem::FunctionSpace& V, const int dim,
   return dofs;
 }
 //-----------------------------------------------------------------------------
+std::vector<std::vector<std::int32_t>> fem::locate_dofs_topological(
+    const std::vector<
+        std::tuple<std::reference_wrapper<const fem::FunctionSpace>, int,
+                   xtl::span<const std::int32_t>>>& entities,
+    bool remote)
+{
+  std::vector<std::vector<std::int32_t>> dofs;
+  std::vector<std::reference_wrapper<const common::IndexMap>> maps;
+  for (auto& [V, dim, e] : entities)
+  {
+    dofs.push_back(locate_local_dofs(V, dim, e));
+    assert(V.get().dofmap());
+    maps.push_back(*V.get().dofmap()->index_map);
+  }
+
+  if (remote)
+  {
+    // Exchange the dofs of all conditions in the same communication
+    // rounds
+    const std::vector<std::vector<std::int32_t>> dofs_remote
+        = get_remote_bcs1(maps, dofs);
+    for (std::size_t i = 0; i < dofs.size(); ++i)
+    {
+      dofs[i].insert(dofs[i].end(), dofs_remote[i].begin(),
+                     dofs_remote[i].end());
+      std::sort(dofs[i].begin(), dofs[i].end());
+      dofs[i].erase(std::unique(dofs[i].begin(), dofs[i].end()),
+                    dofs[i].end());
+    }
+  }
+
+  return dofs;
+}
+//-----------------------------------------------------------------------------
 std::array<std::vector<std::int32_t>, 2> fem::locate_dofs_geometrical(
     const std::array<std::reference_wrapper<const fem::FunctionSpace>, 2>& V,
     const std::function<xt::xtensor<bool, 1>(const xt::xtensor<double, 2>&)>&
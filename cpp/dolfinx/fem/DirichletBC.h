@@ -6,13 +6,17 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <dolfinx/fem/Function.h>
 #include <dolfinx/fem/FunctionSpace.h>
 #include <dolfinx/la/utils.h>
 #include <functional>
 #include <memory>
+#include <stdexcept>
+#include <tuple>
 #include <vector>
+#include <xtensor/xarray.hpp>
 #include <xtensor/xtensor.hpp>
 #include <xtl/xspan.hpp>
 
@@ -78,6 +82,27 @@ locate_dofs_topological(const fem::FunctionSpace& V, const int dim,
                         const xtl::span<const std::int32_t>& entities,
                         bool remote = true);
 
+/// Find degrees-of-freedom which belong to the provided mesh entities
+/// (topological) for several (space, entity dimension, entities)
+/// triples, e.g. for the boundary conditions of a problem. This is
+/// equivalent to calling fem::locate_dofs_topological for each triple,
+/// but the remotely located degrees-of-freedom of all triples are
+/// exchanged in the same communication rounds.
+///
+/// @param[in] entities The function (sub)space, the topological
+/// dimension of the mesh entities and the indices of the mesh entities
+/// of each triple
+/// @param[in] remote True to return also "remotely located"
+///   degree-of-freedom indices (see fem::locate_dofs_topological)
+/// @return For each triple, the array of DOF index blocks (local to the
+/// MPI rank) in the space. The array uses the block size of the dofmap
+/// associated with the space.
+std::vector<std::vector<std::int32_t>> locate_dofs_topological(
+    const std::vector<
+        std::tuple<std::reference_wrapper<const fem::FunctionSpace>, int,
+                   xtl::span<const std::int32_t>>>& entities,
+    bool remote = true);
+
 /// Finds degrees of freedom whose geometric coordinate is true for the
 /// provided marking function.
 ///
@@ -242,6 +267,95 @@ public:
     return {_dofs0, _owned_indices0};
   }
 
+  /// Access the dof indices (unrolled) in the space of the boundary
+  /// value function g. Entry i is the index in g of the value applied
+  /// to the dof `dof_indices().first[i]`.
+  /// @return Array of dof indices (unrolled) in the space of g
+  xtl::span<const std::int32_t> value_indices() const { return _dofs1_g; }
+
+  /// The array that the boundary values are read from, at the indices
+  /// DirichletBC::value_indices. This is the array of the boundary
+  /// value function g, unless the values have been set by
+  /// DirichletBC::update_values.
+  /// @return The array of boundary values
+  const std::vector<T>& value_array() const
+  {
+    assert(_g);
+    return _values.empty() ? _g->x()->array() : _values;
+  }
+
+  /// Set the boundary values by evaluating an expression at the
+  /// coordinates of the constrained degrees-of-freedom only, rather
+  /// than interpolating the expression into the boundary value
+  /// function g over all cells. This is intended for time-dependent
+  /// boundary data, with one call per time step. The coordinates are
+  /// tabulated on the first call and cached.
+  ///
+  /// After the first call, the boundary values are the values of the
+  /// last evaluation of the expression (see DirichletBC::value_array).
+  /// The function g is not modified.
+  ///
+  /// @param[in] f The expression. It is called with the coordinates of
+  /// the points, shape (3, num_points), and returns the values, shape
+  /// (value_size, num_points), or (num_points,) if the value size is 1.
+  /// @pre The degrees-of-freedom of the element of g are point
+  /// evaluations (see FiniteElement::interpolation_ident), and g is
+  /// not on a subspace
+  void update_values(
+      const std::function<xt::xarray<T>(const xt::xtensor<double, 2>&)>& f)
+  {
+    assert(_g);
+    std::shared_ptr<const fem::FunctionSpace> V = _g->function_space();
+    assert(V);
+    const int bs = V->dofmap()->bs();
+    if (_points.size() == 0)
+    {
+      std::shared_ptr<const fem::FiniteElement> element = V->element();
+      assert(element);
+      if (!element->interpolation_ident() or element->value_size() != bs)
+      {
+        throw std::runtime_error("Boundary values can be updated only for "
+                                 "elements with point evaluation dofs.");
+      }
+
+      // Dof blocks of g with a boundary value, which share a point
+      std::vector<std::int32_t> blocks(_dofs1_g.size());
+      std::transform(_dofs1_g.begin(), _dofs1_g.end(), blocks.begin(),
+                     [bs](auto dof) { return dof / bs; });
+      std::sort(blocks.begin(), blocks.end());
+      blocks.erase(std::unique(blocks.begin(), blocks.end()), blocks.end());
+
+      // Position of the value of each boundary dof in the evaluated
+      // expression, with shape (bs, num_points)
+      _value_positions.resize(_dofs1_g.size());
+      for (std::size_t i = 0; i < _dofs1_g.size(); ++i)
+      {
+        auto it = std::lower_bound(blocks.begin(), blocks.end(),
+                                   _dofs1_g[i] / bs);
+        _value_positions[i] = (_dofs1_g[i] % bs) * blocks.size()
+                              + std::distance(blocks.begin(), it);
+      }
+
+      // Coordinates of the dof blocks
+      const xt::xtensor<double, 2> x = V->tabulate_dof_coordinates(false);
+      _points = xt::xtensor<double, 2>({3, blocks.size()});
+      for (std::size_t p = 0; p < blocks.size(); ++p)
+        for (int j = 0; j < 3; ++j)
+          _points(j, p) = x(blocks[p], j);
+
+      _values.assign(_g->x()->array().size(), 0);
+    }
+
+    const xt::xarray<T> values = f(_points);
+    if (values.size() != std::size_t(bs) * _points.shape(1))
+    {
+      throw std::runtime_error(
+          "Expression values do not match the number of boundary points.");
+    }
+    for (std::size_t i = 0; i < _dofs1_g.size(); ++i)
+      _values[_dofs1_g[i]] = values.data()[_value_positions[i]];
+  }
+
   /// Set bc entries in `x` to `scale * x_bc`
   ///
   /// @param[in] x The array in which to set `scale * x_bc[i]`, where
@@ -255,8 +369,7 @@ public:
   /// @param[in] scale The scaling value to apply
   void set(xtl::span<T> x, double scale = 1.0) const
   {
-    assert(_g);
-    const std::vector<T>& g = _g->x()->array();
+    const std::vector<T>& g = value_array();
     for (std::size_t i = 0; i < _dofs0.size(); ++i)
     {
       if (_dofs0[i] < (std::int32_t)x.size())
@@ -274,8 +387,7 @@ public:
   void set(xtl::span<T> x, const xtl::span<const T>& x0,
            double scale = 1.0) const
   {
-    assert(_g);
-    const std::vector<T>& g = _g->x()->array();
+    const std::vector<T>& g = value_array();
     assert(x.size() <= x0.size());
     for (std::size_t i = 0; i < _dofs0.size(); ++i)
     {
@@ -297,8 +409,7 @@ public:
   /// (the space of the function that provides the dof values)
   void dof_values(xtl::span<T> values) const
   {
-    assert(_g);
-    const std::vector<T>& g = _g->x()->array();
+    const std::vector<T>& g = value_array();
     for (std::size_t i = 0; i < _dofs1_g.size(); ++i)
       values[_dofs0[i]] = g[_dofs1_g[i]];
   }
@@ -329,6 +440,16 @@ private:
   // space of _g
   std::vector<std::int32_t> _dofs0, _dofs1_g;
 
+  // Boundary values set by update_values, at the indices _dofs1_g
+  // (empty if the values are read from _g)
+  std::vector<T> _values;
+
+  // Points at which update_values evaluates the expression, with
+  // shape (3, num_points), and the position in the evaluated values of
+  // the value of each dof in _dofs1_g
+  xt::xtensor<double, 2> _points;
+  std::vector<std::size_t> _value_positions;
+
   // The first _owned_indices in _dofs are owned by this process
   int _owned_indices0 = -1;
   int _owned_indices1 = -1;
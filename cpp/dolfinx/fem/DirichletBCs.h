@@ -0,0 +1,263 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include "DirichletBC.h"
+#include "DofMap.h"
+#include "Function.h"
+#include "FunctionSpace.h"
+#include <algorithm>
+#include <cstdint>
+#include <dolfinx/common/IndexMap.h>
+#include <memory>
+#include <numeric>
+#include <utility>
+#include <vector>
+#include <xtl/xspan.hpp>
+
+namespace dolfinx::fem
+{
+
+/// The Dirichlet boundary conditions on a function space, merged into
+/// a single set of degrees-of-freedom.
+///
+/// The dof indices of all boundary conditions are merged into one
+/// sorted array, in which the owned dofs come before the ghost dofs.
+/// When the boundary conditions overlap, the last boundary condition
+/// in the list is applied, as for fem::set_bc. For each boundary
+/// condition, the dofs it applies to and the indices of the values in
+/// its boundary value function are stored contiguously, so that setting
+/// values is a loop over contiguous index arrays. The dof markers and
+/// the array of boundary values used for lifting are built once and
+/// re-used, rather than being built on each call to fem::apply_lifting.
+///
+/// The boundary values are read from the boundary conditions (see
+/// DirichletBC::value_array) on each call, so changes to the values do
+/// not need to be signalled. The dofs are not updated if the dofs of a
+/// DirichletBC change.
+///
+/// Typical usage is
+///
+///     auto bcs_V = std::make_shared<fem::DirichletBCs<T>>(*V, bcs);
+///     for (...)
+///     {
+///       ...
+///       fem::apply_lifting(b, {a}, {bcs_V}, {}, -1.0);
+///       fem::set_bc(b, *bcs_V);
+///     }
+template <typename T>
+class DirichletBCs
+{
+public:
+  /// Merge the boundary conditions that are applied to a function space
+  /// or one of its subspaces
+  /// @param[in] V The function space
+  /// @param[in] bcs The boundary conditions. Boundary conditions that
+  /// are not applied to V or one of its subspaces are ignored.
+  DirichletBCs(const fem::FunctionSpace& V,
+               const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs)
+  {
+    std::shared_ptr<const common::IndexMap> map = V.dofmap()->index_map;
+    assert(map);
+    const int bs = V.dofmap()->index_map_bs();
+    const std::int32_t size = bs * (map->size_local() + map->num_ghosts());
+    const std::int32_t owned_size = bs * map->size_local();
+
+    for (const std::shared_ptr<const DirichletBC<T>>& bc : bcs)
+    {
+      assert(bc);
+      if (V.contains(*bc->function_space()))
+        _bcs.push_back(bc);
+    }
+
+    // Find the boundary condition, and the index of its value, that is
+    // applied to each dof. Later boundary conditions take precedence.
+    std::vector<std::int32_t> bc_index(size, -1), dofs_g(size);
+    for (std::size_t b = 0; b < _bcs.size(); ++b)
+    {
+      xtl::span<const std::int32_t> dofs = _bcs[b]->dof_indices().first;
+      xtl::span<const std::int32_t> dofs1 = _bcs[b]->value_indices();
+      for (std::size_t i = 0; i < dofs.size(); ++i)
+      {
+        assert(dofs[i] < size);
+        bc_index[dofs[i]] = b;
+        dofs_g[dofs[i]] = dofs1[i];
+      }
+    }
+
+    // Build the merged dof array and markers, and count the dofs of each
+    // boundary condition
+    _markers.assign(size, false);
+    _offsets.assign(_bcs.size() + 1, 0);
+    for (std::int32_t i = 0; i < size; ++i)
+    {
+      if (bc_index[i] >= 0)
+      {
+        _dofs.push_back(i);
+        _markers[i] = true;
+        ++_offsets[bc_index[i] + 1];
+      }
+    }
+    std::partial_sum(_offsets.begin(), _offsets.end(), _offsets.begin());
+    auto it = std::lower_bound(_dofs.begin(), _dofs.end(), owned_size);
+    _owned = std::distance(_dofs.begin(), it);
+
+    // Group the dofs by boundary condition. The dofs of each boundary
+    // condition remain sorted.
+    std::vector<std::int32_t> pos(_offsets.begin(), std::prev(_offsets.end()));
+    _bc_dofs.resize(_dofs.size());
+    _bc_dofs_g.resize(_dofs.size());
+    for (std::int32_t dof : _dofs)
+    {
+      const std::int32_t p = pos[bc_index[dof]]++;
+      _bc_dofs[p] = dof;
+      _bc_dofs_g[p] = dofs_g[dof];
+    }
+
+    _values.assign(size, 0);
+  }
+
+  /// Copy constructor
+  DirichletBCs(const DirichletBCs& bcs) = default;
+
+  /// Move constructor
+  DirichletBCs(DirichletBCs&& bcs) = default;
+
+  /// Destructor
+  ~DirichletBCs() = default;
+
+  /// Copy assignment
+  DirichletBCs& operator=(const DirichletBCs& bcs) = default;
+
+  /// Move assignment
+  DirichletBCs& operator=(DirichletBCs&& bcs) = default;
+
+  /// The boundary conditions that are applied
+  /// @return The boundary conditions, in the order in which they were
+  /// passed to the constructor
+  const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs() const
+  {
+    return _bcs;
+  }
+
+  /// Access the merged dof indices (local indices, unrolled), including
+  /// ghosts, to which a boundary condition is applied, and the number
+  /// of owned dofs
+  /// @return Sorted array of dof indices (unrolled) and the number of
+  /// entries in the array that are owned. Entries `dofs[:pos]` are
+  /// owned and entries `dofs[pos:]` are ghosts.
+  std::pair<xtl::span<const std::int32_t>, std::int32_t> dof_indices() const
+  {
+    return {_dofs, _owned};
+  }
+
+  /// Markers for the dofs (unrolled), including ghosts, with a boundary
+  /// condition applied
+  /// @return Array with markers[i] = true if dof i has a boundary
+  /// condition applied
+  const std::vector<bool>& markers() const { return _markers; }
+
+  /// Set bc entries in `x` to `scale * x_bc`. See DirichletBC::set.
+  /// @param[in] x The array in which to set `scale * x_bc[i]`
+  /// @param[in] scale The scaling value to apply
+  void set(xtl::span<T> x, double scale = 1.0) const
+  {
+    for (std::size_t b = 0; b < _bcs.size(); ++b)
+    {
+      const std::vector<T>& g = _bcs[b]->value_array();
+      const std::int32_t* dofs = _bc_dofs.data();
+      const std::int32_t* dofs_g = _bc_dofs_g.data();
+      const std::int32_t end = this->end(b, x.size());
+      for (std::int32_t i = _offsets[b]; i < end; ++i)
+        x[dofs[i]] = scale * g[dofs_g[i]];
+    }
+  }
+
+  /// Set bc entries in `x` to `scale * (x_bc - x0)`. See
+  /// DirichletBC::set.
+  /// @param[in] x The array in which to set `scale * (x_bc - x0)`
+  /// @param[in] x0 The array used in compute the value to set
+  /// @param[in] scale The scaling value to apply
+  void set(xtl::span<T> x, const xtl::span<const T>& x0,
+           double scale = 1.0) const
+  {
+    assert(x.size() <= x0.size());
+    for (std::size_t b = 0; b < _bcs.size(); ++b)
+    {
+      const std::vector<T>& g = _bcs[b]->value_array();
+      const std::int32_t* dofs = _bc_dofs.data();
+      const std::int32_t* dofs_g = _bc_dofs_g.data();
+      const std::int32_t end = this->end(b, x.size());
+      for (std::int32_t i = _offsets[b]; i < end; ++i)
+        x[dofs[i]] = scale * (g[dofs_g[i]] - x0[dofs[i]]);
+    }
+  }
+
+  /// Set the boundary value for entries with a boundary condition
+  /// applied. Other entries are not modified.
+  /// @param[in,out] values The array in which to set the dof values.
+  /// The array must be at least as long as the number of dofs
+  /// (unrolled), including ghosts, of the function space.
+  void dof_values(xtl::span<T> values) const
+  {
+    assert(values.size() >= _markers.size());
+    for (std::size_t b = 0; b < _bcs.size(); ++b)
+    {
+      const std::vector<T>& g = _bcs[b]->value_array();
+      for (std::int32_t i = _offsets[b]; i < _offsets[b + 1]; ++i)
+        values[_bc_dofs[i]] = g[_bc_dofs_g[i]];
+    }
+  }
+
+  /// The boundary values for all dofs (unrolled), including ghosts, of
+  /// the function space, with the value zero for the dofs that do not
+  /// have a boundary condition applied. The values are read from the
+  /// boundary value functions and are stored in an array that is held
+  /// by this object.
+  /// @note This function is not thread-safe, since it updates the
+  /// array that it returns.
+  /// @return The boundary values
+  const std::vector<T>& values() const
+  {
+    dof_values(_values);
+    return _values;
+  }
+
+private:
+  // One past the last entry of the dofs of boundary condition b that
+  // is less than size
+  std::int32_t end(std::size_t b, std::size_t size) const
+  {
+    auto first = std::next(_bc_dofs.begin(), _offsets[b]);
+    auto last = std::next(_bc_dofs.begin(), _offsets[b + 1]);
+    if (last == first or *std::prev(last) < (std::int32_t)size)
+      return _offsets[b + 1];
+    return std::distance(_bc_dofs.begin(),
+                         std::lower_bound(first, last, (std::int32_t)size));
+  }
+
+  // The boundary conditions
+  std::vector<std::shared_ptr<const DirichletBC<T>>> _bcs;
+
+  // Sorted dof indices with a boundary condition applied, and the
+  // number of owned indices
+  std::vector<std::int32_t> _dofs;
+  std::int32_t _owned = 0;
+
+  // Dof indices (_bc_dofs) and indices into the boundary value function
+  // (_bc_dofs_g) grouped by boundary condition, with the entries for
+  // boundary condition b in [_offsets[b], _offsets[b + 1])
+  std::vector<std::int32_t> _offsets, _bc_dofs, _bc_dofs_g;
+
+  // Markers for the dofs with a boundary condition applied
+  std::vector<bool> _markers;
+
+  // Boundary values for all dofs, updated by values()
+  mutable std::vector<T> _values;
+};
+
+} // namespace dolfinx::fem
@@ -14,6 +14,7 @@
 #include <dolfinx/graph/AdjacencyList.h>
 #include <dolfinx/mesh/Topology.h>
 #include <memory>
+#include <numeric>
 #include <utility>
 
 using namespace dolfinx;
@@ -22,20 +23,10 @@ using namespace dolfinx::fem;
 namespace
 {
 //-----------------------------------------------------------------------------
-template <typename T>
-std::vector<std::int32_t>
-remap_dofs(const std::vector<std::int32_t>& old_to_new,
-           const graph::AdjacencyList<T>& dofs_old)
-{
-  const std::vector<T>& _dofs_old = dofs_old.array();
-  std::vector<std::int32_t> dofmap(_dofs_old.size());
-  for (std::size_t i = 0; i < dofmap.size(); ++i)
-    dofmap[i] = old_to_new[_dofs_old[i]];
-  return dofmap;
-}
-//-----------------------------------------------------------------------------
 // Build a collapsed DofMap from a dofmap view. Extracts dofs and
-// doesn't build a new re-ordered dofmap
+// doesn't build a new re-ordered dofmap. If the view has block
+// structure, the blocks of the collapsed dofmap are numbered by the
+// first dof in each block of the view.
 fem::DofMap build_collapsed_dofmap(MPI_Comm comm, const DofMap& dofmap_view,
                                    const mesh::Topology& topology)
 {
@@ -43,11 +34,14 @@ fem::DofMap build_collapsed_dofmap(MPI_Comm comm, const DofMap& dofmap_view,
       dofmap_view.element_dof_layout->copy());
   assert(element_dof_layout);
 
-  if (element_dof_layout->block_size() > 1)
+  // Get block sizes
+  const int bs_view = dofmap_view.index_map_bs();
+  const int bs = element_dof_layout->block_size();
+  if (bs > 1 and bs_view > 1)
   {
     throw std::runtime_error(
         "Cannot collapse dofmap with block size greater "
-        "than 1 from parent with block size of 1. Create new dofmap first.");
+        "than 1 from parent with block size greater than 1.");
   }
 
   // Get topological dimension
@@ -55,21 +49,23 @@ fem::DofMap build_collapsed_dofmap(MPI_Comm comm, const DofMap& dofmap_view,
   auto cells = topology.connectivity(tdim, 0);
   assert(cells);
 
-  // TODO: The below is just copying the dofmap adjacency list?
-  // Build set of dofs that are in the new dofmap
+  // Build set of dofs that are in the new dofmap. For a view with
+  // block structure, the blocks are identified by their first dof.
+  const int cell_dimension = element_dof_layout->num_dofs();
+  const graph::AdjacencyList<std::int32_t>& dof_array_view = dofmap_view.list();
   std::vector<std::int32_t> dofs_view;
+  dofs_view.reserve(cells->num_nodes() * cell_dimension);
   for (int i = 0; i < cells->num_nodes(); ++i)
   {
-    for (auto dof : dofmap_view.cell_dofs(i))
-      dofs_view.push_back(dof);
+    auto cell_dofs = dof_array_view.links(i);
+    for (int j = 0; j < cell_dimension; ++j)
+      dofs_view.push_back(cell_dofs[bs * j]);
   }
+  std::vector<std::int32_t> dofmap = dofs_view;
   std::sort(dofs_view.begin(), dofs_view.end());
   dofs_view.erase(std::unique(dofs_view.begin(), dofs_view.end()),
                   dofs_view.end());
 
-  // Get block sizes
-  const int bs_view = dofmap_view.index_map_bs();
-
   // Compute sizes
   const std::int32_t num_owned_view = dofmap_view.index_map->size_local();
   const auto it_unowned0 = std::lower_bound(dofs_view.begin(), dofs_view.end(),
@@ -121,26 +117,24 @@ fem::DofMap build_collapsed_dofmap(MPI_Comm comm, const DofMap& dofmap_view,
       ghosts, ghost_owners);
 
   // Create array from dofs in view to new dof indices
-  std::vector<std::int32_t> old_to_new(dofs_view.back() + 1, -1);
+  std::vector<std::int32_t> old_to_new(dofs_view.empty() ? 0
+                                                         : dofs_view.back() + 1,
+                                       -1);
   std::int32_t count = 0;
   for (auto& dof : dofs_view)
     old_to_new[dof] = count++;
 
   // Build new dofmap
-  const graph::AdjacencyList<std::int32_t>& dof_array_view = dofmap_view.list();
-  std::vector<std::int32_t> dofmap = remap_dofs(old_to_new, dof_array_view);
+  std::transform(dofmap.begin(), dofmap.end(), dofmap.begin(),
+                 [&old_to_new](auto dof) { return old_to_new[dof]; });
 
   // Dimension sanity checks
-  assert(element_dof_layout);
-  assert((int)dofmap.size()
-         == (cells->num_nodes() * element_dof_layout->num_dofs()));
+  assert((int)dofmap.size() == (cells->num_nodes() * cell_dimension));
 
-  const int cell_dimension = element_dof_layout->num_dofs();
-  assert(dofmap.size() % cell_dimension == 0);
-  return fem::DofMap(element_dof_layout, index_map, 1,
-                     graph::build_adjacency_list<std::int32_t>(
-                         std::move(dofmap), cell_dimension),
-                     1);
+  return fem::DofMap(
+      element_dof_layout, index_map, bs,
+      graph::AdjacencyList<std::int32_t>(std::move(dofmap), cell_dimension),
+      bs);
 }
 
 } // namespace
@@ -150,10 +144,14 @@ graph::AdjacencyList<std::int32_t>
 fem::transpose_dofmap(const graph::AdjacencyList<std::int32_t>& dofmap,
                       std::int32_t num_cells)
 {
-  // Count number of cell contributions to each global index
-  const std::int32_t max_index = *std::max_element(
-      dofmap.array().begin(),
-      std::next(dofmap.array().begin(), dofmap.offsets()[num_cells]));
+  // Count number of cell contributions to each global index. The
+  // offsets are not used since the dofmap may be compact.
+  std::int32_t max_index = -1;
+  for (int c = 0; c < num_cells; ++c)
+  {
+    for (auto dof : dofmap.links(c))
+      max_index = std::max(max_index, dof);
+  }
 
   std::vector<int> num_local_contributions(max_index + 1, 0);
   for (int c = 0; c < num_cells; ++c)
@@ -189,6 +187,54 @@ fem::transpose_dofmap(const graph::AdjacencyList<std::int32_t>& dofmap,
                                             std::move(index_offsets));
 }
 //-----------------------------------------------------------------------------
+graph::AdjacencyList<std::int32_t>
+fem::compute_component_dofs(const DofMap& dofmap, std::int32_t num_cells)
+{
+  assert(dofmap.element_dof_layout);
+  assert(dofmap.index_map);
+  const int bs = dofmap.bs();
+  const int num_components = dofmap.element_dof_layout->block_size();
+  const std::int32_t num_owned
+      = dofmap.index_map->size_local() * dofmap.index_map_bs();
+
+  // Get the component of each (unrolled) dof. For a dofmap with block
+  // structure the component is the position in the block, and
+  // otherwise the position of the dof in the blocked element layout.
+  std::vector<std::int32_t> count(num_components + 1, 0);
+  std::vector<std::int8_t> component(num_owned, -1);
+  for (std::int32_t c = 0; c < num_cells; ++c)
+  {
+    auto cell_dofs = dofmap.cell_dofs(c);
+    for (std::size_t i = 0; i < cell_dofs.size(); ++i)
+    {
+      for (int k = 0; k < bs; ++k)
+      {
+        const std::int32_t dof = bs * cell_dofs[i] + k;
+        if (dof < num_owned and component[dof] < 0)
+        {
+          const int comp = bs > 1 ? k : i % num_components;
+          component[dof] = comp;
+          ++count[comp + 1];
+        }
+      }
+    }
+  }
+
+  // Pack the dofs of each component, which are sorted as the dofs are
+  // visited in order
+  std::partial_sum(count.begin(), count.end(), count.begin());
+  std::vector<std::int32_t> offsets = count;
+  std::vector<std::int32_t> dofs(count.back());
+  for (std::int32_t dof = 0; dof < num_owned; ++dof)
+  {
+    if (component[dof] >= 0)
+      dofs[count[component[dof]]++] = dof;
+  }
+
+  return graph::AdjacencyList<std::int32_t>(std::move(dofs),
+                                            std::move(offsets));
+}
+//-----------------------------------------------------------------------------
 int DofMap::bs() const noexcept { return _bs; }
 //-----------------------------------------------------------------------------
 DofMap DofMap::extract_sub_dofmap(const std::vector<int>& component) const
@@ -223,8 +269,8 @@ DofMap DofMap::extract_sub_dofmap(const std::vector<int>& component) const
 
   // FIXME X
   return DofMap(sub_element_dof_layout, this->index_map, this->index_map_bs(),
-                graph::build_adjacency_list<std::int32_t>(std::move(dofmap),
-                                                          dofs_per_cell),
+                graph::AdjacencyList<std::int32_t>(std::move(dofmap),
+                                                   dofs_per_cell),
                 1);
 }
 //-----------------------------------------------------------------------------
@@ -236,28 +282,21 @@ std::pair<std::unique_ptr<DofMap>, std::vector<std::int32_t>> DofMap::collapse(
   assert(element_dof_layout);
   assert(index_map);
 
-  // Create new element dof layout and reset parent
-
-  // Parent does not have block structure but sub-map does, so build
-  // new submap to get block structure for collapsed dofmap.
-  // Create new dofmap
   std::unique_ptr<DofMap> dofmap_new;
-  if (this->index_map_bs() == 1 and this->element_dof_layout->block_size() > 1)
+  if (reorder_fn)
   {
-    // Create new element dof layout and reset parent
+    // Build new dofmap from scratch, with re-ordering
     auto collapsed_dof_layout
         = std::make_shared<ElementDofLayout>(element_dof_layout->copy());
-
-    // Parent does not have block structure but sub-map does, so build
-    // new submap to get block structure for collapsed dofmap.
     auto [index_map, bs, dofmap] = fem::build_dofmap_data(
         comm, topology, *collapsed_dof_layout, reorder_fn);
-    dofmap_new = std::make_unique<DofMap>(element_dof_layout, index_map, bs,
+    dofmap_new = std::make_unique<DofMap>(collapsed_dof_layout, index_map, bs,
                                           std::move(dofmap), bs);
   }
   else
   {
-    // Collapse dof map, without build and re-ordering from scratch
+    // Collapse dof map by extracting the dofs of the view, keeping the
+    // parent numbering
     dofmap_new = std::make_unique<DofMap>(
         build_collapsed_dofmap(comm, *this, topology));
   }
@@ -299,3 +338,24 @@ const graph::AdjacencyList<std::int32_t>& DofMap::list() const
 //-----------------------------------------------------------------------------
 int DofMap::index_map_bs() const { return _index_map_bs; }
 //-----------------------------------------------------------------------------
+bool DofMap::compress() const
+{
+  if (!_dofmap_compressed)
+    _dofmap_compressed = graph::compress(_dofmap);
+  return _dofmap_compressed != nullptr;
+}
+//-----------------------------------------------------------------------------
+std::shared_ptr<const graph::CompressedAdjacencyList<std::int32_t>>
+DofMap::compressed_list() const
+{
+  return _dofmap_compressed;
+}
+//-----------------------------------------------------------------------------
+std::size_t DofMap::memory_usage() const
+{
+  std::size_t size = _dofmap.memory_usage();
+  if (_dofmap_compressed)
+    size += _dofmap_compressed->memory_usage();
+  return size;
+}
+//-----------------------------------------------------------------------------
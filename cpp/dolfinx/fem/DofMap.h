@@ -9,6 +9,7 @@
 #include <cstdlib>
 #include <dolfinx/common/MPI.h>
 #include <dolfinx/graph/AdjacencyList.h>
+#include <dolfinx/graph/CompressedAdjacencyList.h>
 #include <dolfinx/graph/scotch.h>
 #include <functional>
 #include <memory>
@@ -57,6 +58,25 @@ graph::AdjacencyList<std::int32_t>
 transpose_dofmap(const graph::AdjacencyList<std::int32_t>& dofmap,
                  std::int32_t num_cells);
 
+class DofMap;
+
+/// Compute the owned dofs of each component of a dofmap, e.g. the x-,
+/// y- and z-components of a vector-valued space, without collapsing
+/// the dofmap. The dofmap may be a view of a sub-dofmap, e.g. of the
+/// velocity sub-space of a mixed space, in which case the components
+/// are the components of the sub-element. The dofs can be used to
+/// create index sets for a field split by adding the offset of the
+/// owned range of the dofmap (see IndexMap::local_range and
+/// DofMap::index_map_bs).
+///
+/// @param[in] dofmap The dofmap
+/// @param[in] num_cells The number of cells in @p dofmap to consider,
+/// typically the number of owned cells
+/// @return The sorted owned dofs (unrolled, local to process) of each
+/// component of the block size of the element dof layout
+graph::AdjacencyList<std::int32_t>
+compute_component_dofs(const DofMap& dofmap, std::int32_t num_cells);
+
 /// Degree-of-freedom map
 ///
 /// This class handles the mapping of degrees of freedom. It builds a
@@ -123,24 +143,46 @@ public:
   /// @return The dofmap for the component
   DofMap extract_sub_dofmap(const std::vector<int>& component) const;
 
-  /// Create a "collapsed" dofmap (collapses a sub-dofmap)
+  /// Create a "collapsed" dofmap (collapses a sub-dofmap). By default
+  /// the dofs of the sub-dofmap are extracted and keep their relative
+  /// order in the parent, and the index map of the collapsed dofmap is
+  /// created by filtering the parent index map. This requires one
+  /// neighbourhood communication to number the ghosts.
   /// @param[in] comm MPI Communicator
   /// @param[in] topology The mesh topology that the dofmap is defined
   /// on
-  /// @param[in] reorder_fn The graph re-ordering function to apply to
-  /// the dof data
-  /// @return The collapsed dofmap
-  std::pair<std::unique_ptr<DofMap>, std::vector<std::int32_t>> collapse(
-      MPI_Comm comm, const mesh::Topology& topology,
-      const std::function<std::vector<int>(
-          const graph::AdjacencyList<std::int32_t>&)>& reorder_fn
-      = [](const graph::AdjacencyList<std::int32_t>& g)
-      { return graph::scotch::compute_gps(g, 2).first; }) const;
+  /// @param[in] reorder_fn If set, a new dofmap is built from the
+  /// element dof layout and re-ordered with this graph re-ordering
+  /// function, rather than extracted from the parent
+  /// @return The collapsed dofmap and the map from the collapsed dof
+  /// indices to the dof indices in the parent
+  std::pair<std::unique_ptr<DofMap>, std::vector<std::int32_t>>
+  collapse(MPI_Comm comm, const mesh::Topology& topology,
+           const std::function<std::vector<int>(
+               const graph::AdjacencyList<std::int32_t>&)>& reorder_fn
+           = nullptr) const;
 
   /// Get dofmap data
   /// @return The adjacency list with dof indices for each cell
   const graph::AdjacencyList<std::int32_t>& list() const;
 
+  /// Store a compressed copy of the dofmap data, see
+  /// graph::CompressedAdjacencyList. Vector assembly of cell integrals
+  /// reads the compressed copy in place of DofMap::list, which reduces
+  /// the memory traffic of the dof gather for low-order elements. The
+  /// copy is not created if the dofs of a cell span more than the
+  /// range of std::uint16_t, e.g. for a dofmap that is not ordered for
+  /// locality.
+  /// @note Not thread safe
+  /// @return True if the compressed copy is stored
+  bool compress() const;
+
+  /// Get the compressed dofmap data
+  /// @return The compressed adjacency list, or nullptr if it is not
+  /// stored, see DofMap::compress
+  std::shared_ptr<const graph::CompressedAdjacencyList<std::int32_t>>
+  compressed_list() const;
+
   /// Layout of dofs on an element
   std::shared_ptr<const ElementDofLayout> element_dof_layout;
 
@@ -150,6 +192,13 @@ public:
   /// Block size associated with the index_map
   int index_map_bs() const;
 
+  /// Return the memory allocated by the dofmap data (DofMap::list and
+  /// DofMap::compressed_list).
+  /// The index map is not included as it may be shared with other
+  /// dofmaps, see common::IndexMap::memory_usage.
+  /// @return The number of bytes
+  std::size_t memory_usage() const;
+
 private:
   // Block size for the IndexMap
   int _index_map_bs = -1;
@@ -157,6 +206,10 @@ private:
   // Cell-local-to-dof map (dofs for cell dofmap[cell])
   graph::AdjacencyList<std::int32_t> _dofmap;
 
+  // Compressed copy of _dofmap (nullptr if not compressed)
+  mutable std::shared_ptr<const graph::CompressedAdjacencyList<std::int32_t>>
+      _dofmap_compressed;
+
   // Block size for the dofmap
   int _bs = -1;
 };
@@ -0,0 +1,240 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include "DirichletBC.h"
+#include "DofMap.h"
+#include "Form.h"
+#include "FunctionSpace.h"
+#include "assemble_matrix_impl.h"
+#include "utils.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <dolfinx/common/IndexMap.h>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include <xtl/xspan.hpp>
+
+namespace dolfinx::fem
+{
+
+/// Cached element matrices of a bilinear form.
+///
+/// The element matrices of all cells are computed by the form kernels
+/// on the first assembly and stored. Subsequent assemblies add the
+/// stored matrices, optionally scaled, without calling the kernels.
+/// This trades memory (see ElementTensorCache::memory_estimate) for
+/// the cost of tabulation, and is intended for forms whose element
+/// matrices do not change between assemblies, e.g. mass and stiffness
+/// matrices with constant material parameters on a fixed mesh.
+///
+/// Typical usage for a form a = c * a0 with a scalar constant c is
+///
+///     fem::ElementTensorCache<T> cache(a0);
+///     for (...)
+///     {
+///       ...
+///       cache.assemble(mat_add, bcs, c);
+///     }
+///
+/// @note The cached matrices are not updated if the mesh geometry, the
+/// coefficients or the constants of the form change. Call
+/// ElementTensorCache::clear to recompute them.
+/// @note Only forms with cell integrals are supported.
+template <typename T>
+class ElementTensorCache
+{
+public:
+  /// Create an empty cache. The element matrices are computed on the
+  /// first assembly.
+  /// @param[in] a The bilinear form
+  explicit ElementTensorCache(const std::shared_ptr<const Form<T>>& a)
+      : _a(a)
+  {
+    assert(_a);
+    if (_a->rank() != 2)
+      throw std::runtime_error("Form must be bilinear.");
+    for (auto type : {IntegralType::exterior_facet,
+                      IntegralType::interior_facet, IntegralType::vertex})
+    {
+      if (_a->num_integrals(type) > 0)
+      {
+        throw std::runtime_error(
+            "Element tensor cache supports cell integrals only.");
+      }
+    }
+  }
+
+  /// Estimate of the memory in bytes required to cache the element
+  /// matrices of a form
+  /// @param[in] a The bilinear form
+  /// @return Memory for the element matrices (bytes)
+  static std::size_t memory_estimate(const Form<T>& a)
+  {
+    const DofMap& dofmap0 = *a.function_spaces().at(0)->dofmap();
+    const DofMap& dofmap1 = *a.function_spaces().at(1)->dofmap();
+    const std::size_t ndim0 = dofmap0.bs() * dofmap0.cell_dofs(0).size();
+    const std::size_t ndim1 = dofmap1.bs() * dofmap1.cell_dofs(0).size();
+    std::size_t num_cells = 0;
+    for (int i : a.integral_ids(IntegralType::cell))
+      num_cells += a.domains(IntegralType::cell, i).size();
+    return num_cells * ndim0 * ndim1 * sizeof(T);
+  }
+
+  /// Add the cached element matrices, multiplied by `scale`, to a
+  /// matrix. The element matrices are computed if the cache is empty.
+  /// @param[in] mat_add The function for adding values into the
+  /// matrix. See fem::assemble_matrix.
+  /// @param[in] bcs Boundary conditions to apply. For boundary
+  /// condition dofs the row and column are zeroed. The diagonal entry
+  /// is not set.
+  /// @param[in] scale The scaling factor for the element matrices
+  template <typename U>
+  void assemble(const U& mat_add,
+                const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs,
+                T scale = 1.0)
+  {
+    if (!_cached)
+      tabulate();
+
+    // Build dof markers
+    std::array<std::vector<bool>, 2> bc;
+    for (auto& _bc : bcs)
+    {
+      assert(_bc);
+      for (int i = 0; i < 2; ++i)
+      {
+        std::shared_ptr<const FunctionSpace> V = _a->function_spaces().at(i);
+        if (V->contains(*_bc->function_space()))
+        {
+          std::shared_ptr<const common::IndexMap> map = V->dofmap()->index_map;
+          bc[i].resize(V->dofmap()->index_map_bs()
+                           * (map->size_local() + map->num_ghosts()),
+                       false);
+          _bc->mark_dofs(bc[i]);
+        }
+      }
+    }
+
+    const DofMap& dofmap0 = *_a->function_spaces().at(0)->dofmap();
+    const DofMap& dofmap1 = *_a->function_spaces().at(1)->dofmap();
+    const int bs0 = dofmap0.bs();
+    const int bs1 = dofmap1.bs();
+    const int ndim0 = bs0 * dofmap0.cell_dofs(0).size();
+    const int ndim1 = bs1 * dofmap1.cell_dofs(0).size();
+    std::vector<T> Ae(ndim0 * ndim1);
+    const T* A_cached = _A.data();
+    for (int i : _a->integral_ids(IntegralType::cell))
+    {
+      for (std::int32_t c : _a->domains(IntegralType::cell, i))
+      {
+        std::transform(A_cached, A_cached + Ae.size(), Ae.begin(),
+                       [scale](auto x) { return scale * x; });
+        A_cached += Ae.size();
+
+        // Zero rows/columns for essential bcs
+        auto dofs0 = dofmap0.cell_dofs(c);
+        auto dofs1 = dofmap1.cell_dofs(c);
+        if (!bc[0].empty())
+        {
+          for (std::size_t j = 0; j < dofs0.size(); ++j)
+          {
+            for (int k = 0; k < bs0; ++k)
+            {
+              if (bc[0][bs0 * dofs0[j] + k])
+              {
+                const int row = bs0 * j + k;
+                std::fill_n(std::next(Ae.begin(), ndim1 * row), ndim1, 0.0);
+              }
+            }
+          }
+        }
+
+        if (!bc[1].empty())
+        {
+          for (std::size_t j = 0; j < dofs1.size(); ++j)
+          {
+            for (int k = 0; k < bs1; ++k)
+            {
+              if (bc[1][bs1 * dofs1[j] + k])
+              {
+                const int col = bs1 * j + k;
+                for (int row = 0; row < ndim0; ++row)
+                  Ae[row * ndim1 + col] = 0.0;
+              }
+            }
+          }
+        }
+
+        mat_add(dofs0.size(), dofs0.data(), dofs1.size(), dofs1.data(),
+                Ae.data());
+      }
+    }
+  }
+
+  /// Remove the cached element matrices. They are recomputed on the
+  /// next assembly.
+  void clear()
+  {
+    _A.clear();
+    _A.shrink_to_fit();
+    _cached = false;
+  }
+
+  /// Return true if the element matrices are cached
+  bool cached() const { return _cached; }
+
+  /// The bilinear form
+  std::shared_ptr<const Form<T>> form() const { return _a; }
+
+private:
+  // Compute and store the element matrices of all cells, in the order
+  // of the integration domains
+  void tabulate()
+  {
+    const std::vector<T> constant_values = pack_constants(*_a);
+    const xtl::span<const T> constants(constant_values);
+    const array2d<T> coeffs = pack_coefficients(*_a);
+    const xtl::span<const std::uint32_t> cell_info = impl::get_cell_info(*_a);
+
+    _A.clear();
+    _A.reserve(memory_estimate(*_a) / sizeof(T));
+    const int bs0 = _a->function_spaces().at(0)->dofmap()->bs();
+    const int bs1 = _a->function_spaces().at(1)->dofmap()->bs();
+    auto record = [this, bs0, bs1](std::int32_t m, const std::int32_t*,
+                                   std::int32_t n, const std::int32_t*,
+                                   const T* Ae) -> int
+    {
+      _A.insert(_A.end(), Ae, Ae + bs0 * m * bs1 * n);
+      return 0;
+    };
+
+    const std::vector<bool> no_bc;
+    for (int i : _a->integral_ids(IntegralType::cell))
+    {
+      impl::assemble_cell_integral(record, *_a, i,
+                                   _a->domains(IntegralType::cell, i),
+                                   constants, coeffs, no_bc, no_bc, cell_info);
+    }
+
+    _cached = true;
+  }
+
+  // The bilinear form
+  std::shared_ptr<const Form<T>> _a;
+
+  // Element matrices (row-major) of all cells, in the order of the
+  // integration domains
+  std::vector<T> _A;
+
+  // True if _A holds the element matrices
+  bool _cached = false;
+};
+
+} // namespace dolfinx::fem
@@ -6,7 +6,9 @@
 
 #pragma once
 
+#include <algorithm>
 #include <dolfinx/common/array2d.h>
+#include <dolfinx/common/utils.h>
 #include <dolfinx/mesh/Mesh.h>
 #include <functional>
 #include <utility>
@@ -86,58 +88,116 @@ public:
   /// @param[out] values A 2D array to store the result. Caller
   /// responsible for correct sizing which should be (num_cells,
   /// num_points * value_size columns).
+  /// @param[in] num_threads The number of threads
   template <typename U>
-  void eval(const xtl::span<const std::int32_t>& active_cells, U& values) const
+  void eval(const xtl::span<const std::int32_t>& active_cells, U& values,
+            int num_threads = 1) const
+  {
+    // Prepare coefficients and constants
+    const array2d<T> coeffs = pack_coefficients(*this);
+    const std::vector<T> constant_data = pack_constants(*this);
+    eval(active_cells, values, coeffs, constant_data, num_threads);
+  }
+
+  /// Evaluate the expression on cells, using coefficient and constant
+  /// data that have been packed, e.g. by a previous call to
+  /// fem::pack_coefficients and fem::pack_constants, so that the data
+  /// can be re-used between evaluations
+  /// @param[in] active_cells Cells on which to evaluate the Expression
+  /// @param[out] values A 2D array to store the result. Caller
+  /// responsible for correct sizing which should be (num_cells,
+  /// num_points * value_size columns).
+  /// @param[in] coeffs The packed coefficients, with a row for each
+  /// cell of the mesh
+  /// @param[in] constants The packed constants
+  /// @param[in] num_threads The number of threads. The active cells are
+  /// split into contiguous parts, which are evaluated concurrently.
+  template <typename U>
+  void eval(const xtl::span<const std::int32_t>& active_cells, U& values,
+            const array2d<T>& coeffs, const xtl::span<const T>& constants,
+            int num_threads = 1) const
   {
     static_assert(std::is_same<T, typename U::value_type>::value,
                   "Expression and array types must be the same");
 
     // Extract data from Expression
     assert(_mesh);
-
-    // Prepare coefficients and constants
-    const array2d<T> coeffs = pack_coefficients(*this);
-    const std::vector<T> constant_data = pack_constants(*this);
-
     const auto& fn = this->get_tabulate_expression();
 
     // Prepare cell geometry
     const graph::AdjacencyList<std::int32_t>& x_dofmap
         = _mesh->geometry().dofmap();
-    const fem::CoordinateElement& cmap = _mesh->geometry().cmap();
 
     // Prepate cell permutation info
     _mesh->topology_mutable().create_entity_permutations();
-    const std::vector<std::uint32_t>& cell_info
-        = _mesh->topology().get_cell_permutation_info();
 
     // FIXME: Add proper interface for num coordinate dofs
     const std::size_t num_dofs_g = x_dofmap.num_links(0);
     const xt::xtensor<double, 2>& x_g = _mesh->geometry().x();
 
-    // Create data structures used in evaluation
-    std::vector<double> coordinate_dofs(3 * num_dofs_g);
-
     // Iterate over cells and 'assemble' into values
-    std::vector<T> values_e(this->num_points() * this->value_size(), 0);
-    for (std::size_t c = 0; c < active_cells.size(); ++c)
+    auto eval_part = [&](std::size_t c0, std::size_t c1, int)
     {
-      const std::int32_t cell = active_cells[c];
-
-      auto x_dofs = x_dofmap.links(cell);
-      for (std::size_t i = 0; i < x_dofs.size(); ++i)
+      // Create data structures used in evaluation
+      std::vector<double> coordinate_dofs(3 * num_dofs_g);
+      std::vector<T> values_e(this->num_points() * this->value_size(), 0);
+      for (std::size_t c = c0; c < c1; ++c)
       {
-        std::copy_n(xt::row(x_g, x_dofs[i]).cbegin(), 3,
-                    std::next(coordinate_dofs.begin(), 3 * i));
+        const std::int32_t cell = active_cells[c];
+
+        auto x_dofs = x_dofmap.links(cell);
+        for (std::size_t i = 0; i < x_dofs.size(); ++i)
+        {
+          std::copy_n(xt::row(x_g, x_dofs[i]).cbegin(), 3,
+                      std::next(coordinate_dofs.begin(), 3 * i));
+        }
+
+        auto coeff_cell = coeffs.row(cell);
+        std::fill(values_e.begin(), values_e.end(), 0.0);
+        fn(values_e.data(), coeff_cell.data(), constants.data(),
+           coordinate_dofs.data());
+
+        for (std::size_t j = 0; j < values_e.size(); ++j)
+          values(c, j) = values_e[j];
       }
+    };
+    common::for_each_part(active_cells.size(), num_threads, eval_part);
+  }
 
-      auto coeff_cell = coeffs.row(cell);
-      std::fill(values_e.begin(), values_e.end(), 0.0);
-      fn(values_e.data(), coeff_cell.data(), constant_data.data(),
-         coordinate_dofs.data());
+  /// Evaluate the expression on cells in chunks of cells, and pass the
+  /// values of each chunk to a function, e.g. to write the values to a
+  /// file. Only the values of one chunk are held in memory.
+  /// @param[in] active_cells Cells on which to evaluate the Expression
+  /// @param[in] f The function that is called for each chunk with the
+  /// cells of the chunk and the values on the cells, with shape
+  /// (num_cells, num_points * value_size) and row-major storage. The
+  /// values are only valid during the call.
+  /// @param[in] chunk_size The maximum number of cells in a chunk
+  /// @param[in] coeffs The packed coefficients, with a row for each
+  /// cell of the mesh
+  /// @param[in] constants The packed constants
+  /// @param[in] num_threads The number of threads used to evaluate each
+  /// chunk
+  void eval_chunked(
+      const xtl::span<const std::int32_t>& active_cells,
+      const std::function<void(const xtl::span<const std::int32_t>&,
+                               const xtl::span<const T>&)>& f,
+      std::size_t chunk_size, const array2d<T>& coeffs,
+      const xtl::span<const T>& constants, int num_threads = 1) const
+  {
+    if (chunk_size == 0)
+      throw std::runtime_error("Chunk size must be positive.");
 
-      for (std::size_t j = 0; j < values_e.size(); ++j)
-        values(c, j) = values_e[j];
+    const std::size_t num_cols = this->num_points() * this->value_size();
+    array2d<T> values(std::min(chunk_size, active_cells.size()), num_cols);
+    for (std::size_t c0 = 0; c0 < active_cells.size(); c0 += chunk_size)
+    {
+      const std::size_t num_cells
+          = std::min(chunk_size, active_cells.size() - c0);
+      xtl::span<const std::int32_t> cells
+          = active_cells.subspan(c0, num_cells);
+      eval(cells, values, coeffs, constants, num_threads);
+      f(cells, xtl::span<const T>(values.data(), num_cells * num_cols));
     }
   }
 
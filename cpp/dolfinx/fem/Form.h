@@ -6,12 +6,19 @@
 
 #pragma once
 
+#include <dolfinx/common/UniqueIdGenerator.h>
 #include <dolfinx/fem/FunctionSpace.h>
+#include <dolfinx/fem/InteriorFacets.h>
 #include <dolfinx/mesh/Mesh.h>
 #include <dolfinx/mesh/MeshTags.h>
+#include <algorithm>
 #include <functional>
+#include <iterator>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace dolfinx::fem
@@ -123,6 +130,11 @@ public:
     // FIXME: do this neatly via a static function
     // Set markers for default integrals
     set_default_domains(*_mesh);
+
+    // Pack the interior facet data, so that it is not created on first
+    // use by (possibly concurrent) assemblers
+    for (int i : integral_ids(IntegralType::interior_facet))
+      update_interior_facets(i);
   }
 
   /// Copy constructor
@@ -143,6 +155,10 @@ public:
   /// @return The mesh
   std::shared_ptr<const mesh::Mesh> mesh() const { return _mesh; }
 
+  /// Get unique identifier for the form
+  /// @returns The unique identifier associated with the object
+  std::size_t id() const { return _unique_id; }
+
   /// Return function spaces for all arguments
   /// @return Function spaces
   const std::vector<std::shared_ptr<const fem::FunctionSpace>>&
@@ -170,6 +186,53 @@ public:
     return it1->second.first;
   }
 
+  /// Set a batched kernel for integral i of given type. A batched
+  /// kernel computes the element tensors of `batch_size` entities in
+  /// one call, which allows generated code to vectorise across
+  /// entities. The element tensor, coefficient and coordinate arrays
+  /// are interleaved by entity, i.e. entry `j` for entity `k` in the
+  /// batch is stored at `j * batch_size + k`. The constants are shared
+  /// by all entities. When a batched kernel is set, the assemblers use
+  /// it in place of the kernel for the integral.
+  /// @note Only cell integrals are supported
+  /// @param[in] type Integral type
+  /// @param[in] i Domain index
+  /// @param[in] kernel The batched kernel
+  /// @param[in] batch_size The number of entities per batch
+  void set_batch_kernel(
+      IntegralType type, int i,
+      const std::function<void(T*, const T*, const T*, const double*,
+                               const int*, const std::uint8_t*)>& kernel,
+      int batch_size)
+  {
+    if (type != IntegralType::cell)
+      throw std::runtime_error("Batched kernels require cell integrals.");
+    if (batch_size < 1)
+      throw std::runtime_error("Invalid kernel batch size.");
+    auto it0 = _integrals.find(type);
+    if (it0 == _integrals.end() or it0->second.find(i) == it0->second.end())
+      throw std::runtime_error("No kernel for requested domain index.");
+    _batch_kernels[type][i] = {kernel, batch_size};
+  }
+
+  /// Get the batched kernel for integral i of given type
+  /// @param[in] type Integral type
+  /// @param[in] i Domain index
+  /// @return Batched kernel, and the number of entities per batch. The
+  /// batch size is zero if no batched kernel has been set.
+  std::pair<std::function<void(T*, const T*, const T*, const double*,
+                               const int*, const std::uint8_t*)>,
+            int>
+  batch_kernel(IntegralType type, int i) const
+  {
+    if (auto it0 = _batch_kernels.find(type); it0 != _batch_kernels.end())
+    {
+      if (auto it1 = it0->second.find(i); it1 != it0->second.end())
+        return it1->second;
+    }
+    return {nullptr, 0};
+  }
+
   /// Get types of integrals in the form
   /// @return Integrals types
   std::set<IntegralType> integral_types() const
@@ -225,6 +288,98 @@ public:
     return it1->second.second;
   }
 
+  /// Get the packed data (cells, local facet indices and facet
+  /// permutations) of the facets of the ith interior facet integral, in
+  /// the order of Form::domains. The data is computed when the form is
+  /// created, and is recomputed if the version of the mesh topology has
+  /// changed (see mesh::Topology::version).
+  /// @note This function is thread safe. A returned reference remains
+  /// valid until the data is recomputed after a change of the topology.
+  /// @param[in] i Integral ID, i.e. (sub)domain index
+  /// @return The packed interior facets
+  const InteriorFacets& interior_facets(int i) const
+  {
+    std::lock_guard<std::mutex> lock(*_interior_facets_mutex);
+    if (auto it = _interior_facets.find(i);
+        it != _interior_facets.end()
+        and it->second.first == _mesh->topology().version())
+    {
+      return it->second.second;
+    }
+    else
+      return update_interior_facets(i);
+  }
+
+  /// Get the cost of an integral per entity of its domain, which is
+  /// used to schedule the chunks of the integrals of the form in
+  /// threaded assembly. The cost is measured on the first threaded
+  /// assembly of a functional.
+  /// @param[in] type The integral type
+  /// @param[in] i Integral ID, i.e. (sub)domain index
+  /// @return The time per entity (s), or zero if it has not been
+  /// measured
+  double cost(IntegralType type, int i) const
+  {
+    auto it = _costs.find({type, i});
+    return it == _costs.end() ? 0.0 : it->second;
+  }
+
+  /// Set the cost of an integral, see Form::cost. The cost only affects
+  /// the scheduling of assembly, not the values that are assembled.
+  /// @note Not thread safe
+  /// @param[in] type The integral type
+  /// @param[in] i Integral ID, i.e. (sub)domain index
+  /// @param[in] cost The time per entity (s)
+  void set_cost(IntegralType type, int i, double cost) const
+  {
+    _costs[{type, i}] = cost;
+  }
+
+  /// Sort the mesh entities of each facet integral by the index of the
+  /// cell that the facet is attached to, so that assembly over facets
+  /// accesses the geometry, dofmaps and packed coefficients of the cells
+  /// in memory order. For interior facets, the lowest index of the two
+  /// attached cells is used. Facets attached to the same cell remain
+  /// sorted by facet index. The entities of cell integrals are already
+  /// sorted by cell index.
+  ///
+  /// The sorting is a one-off cost, and is typically done once after
+  /// the form is created and before it is assembled repeatedly. The
+  /// values of assembled tensors are not changed by the sorting, other
+  /// than by round-off.
+  void sort_domains()
+  {
+    _interior_facets.clear();
+    const int tdim = _mesh->topology().dim();
+    for (IntegralType type :
+         {IntegralType::exterior_facet, IntegralType::interior_facet})
+    {
+      auto it0 = _integrals.find(type);
+      if (it0 == _integrals.end())
+        continue;
+
+      _mesh->topology_mutable().create_connectivity(tdim - 1, tdim);
+      auto f_to_c = _mesh->topology().connectivity(tdim - 1, tdim);
+      assert(f_to_c);
+      for (auto& [id, integral] : it0->second)
+      {
+        std::vector<std::int32_t>& facets = integral.second;
+        std::vector<std::pair<std::int32_t, std::int32_t>> cell_facet;
+        cell_facet.reserve(facets.size());
+        for (std::int32_t f : facets)
+        {
+          auto cells = f_to_c->links(f);
+          assert(!cells.empty());
+          cell_facet.emplace_back(
+              *std::min_element(cells.begin(), cells.end()), f);
+        }
+        std::sort(cell_facet.begin(), cell_facet.end());
+        std::transform(cell_facet.begin(), cell_facet.end(), facets.begin(),
+                       [](auto& cf) { return cf.second; });
+      }
+    }
+  }
+
   /// Access coefficients
   const std::vector<std::shared_ptr<const fem::Function<T>>>
   coefficients() const
@@ -295,66 +450,50 @@ private:
     std::map<int, std::pair<kern, std::vector<std::int32_t>>>& integrals
         = it0->second;
 
-    // Get mesh tag data
-    const std::vector<int>& values = marker.values();
-    const std::vector<std::int32_t>& tagged_entities = marker.indices();
+    // Only owned entities are assembled over
     assert(topology.index_map(dim));
-    const auto entity_end
-        = std::lower_bound(tagged_entities.begin(), tagged_entities.end(),
-                           topology.index_map(dim)->size_local());
+    const std::int32_t num_entities = topology.index_map(dim)->size_local();
 
-    if (dim == tdim - 1)
+    // Get the exterior facets, which are computed once and stored by
+    // the topology
+    std::shared_ptr<const std::vector<std::int32_t>> exterior_facets;
+    if (type == IntegralType::exterior_facet)
     {
-      auto f_to_c = topology.connectivity(tdim - 1, tdim);
-      assert(f_to_c);
+      mesh->topology_mutable().create_boundary_facets();
+      exterior_facets = topology.boundary_facets();
+      assert(exterior_facets);
+    }
+
+    // Get the tagged entities of each integral from the value index of
+    // the mesh tags
+    auto f_to_c = topology.connectivity(tdim - 1, tdim);
+    for (auto& [id, integral] : integrals)
+    {
+      xtl::span<const std::int32_t> tagged_entities = marker.entities(id);
+      const auto entity_end = std::lower_bound(
+          tagged_entities.begin(), tagged_entities.end(), num_entities);
+      std::vector<std::int32_t>& entities = integral.second;
       if (type == IntegralType::exterior_facet)
       {
-        // Only need to consider shared facets when there are no ghost
-        // cells
-        assert(topology.index_map(tdim));
-        std::set<std::int32_t> fwd_shared;
-        if (topology.index_map(tdim)->num_ghosts() == 0)
-        {
-          fwd_shared.insert(
-              topology.index_map(tdim - 1)->shared_indices().array().begin(),
-              topology.index_map(tdim - 1)->shared_indices().array().end());
-        }
-
-        for (auto f = tagged_entities.begin(); f != entity_end; ++f)
-        {
-          // All "owned" facets connected to one cell, that are not
-          // shared, should be external
-          if (f_to_c->num_links(*f) == 1
-              and fwd_shared.find(*f) == fwd_shared.end())
-          {
-            const std::size_t i = std::distance(tagged_entities.cbegin(), f);
-            if (auto it = integrals.find(values[i]); it != integrals.end())
-              it->second.second.push_back(*f);
-          }
-        }
+        // Keep the tagged facets that are exterior facets (both lists
+        // are sorted)
+        std::set_intersection(tagged_entities.begin(), entity_end,
+                              exterior_facets->begin(),
+                              exterior_facets->end(),
+                              std::back_inserter(entities));
       }
       else if (type == IntegralType::interior_facet)
       {
-        for (auto f = tagged_entities.begin(); f != entity_end; ++f)
-        {
-          if (f_to_c->num_links(*f) == 2)
-          {
-            const std::size_t i = std::distance(tagged_entities.cbegin(), f);
-            if (auto it = integrals.find(values[i]); it != integrals.end())
-              it->second.second.push_back(*f);
-          }
-        }
+        assert(f_to_c);
+        std::copy_if(tagged_entities.begin(), entity_end,
+                     std::back_inserter(entities),
+                     [&f_to_c](auto f) { return f_to_c->num_links(f) == 2; });
       }
-    }
-    else
-    {
-      // For cell and vertex integrals use all markers (but not on ghost
-      // entities)
-      for (auto e = tagged_entities.begin(); e != entity_end; ++e)
+      else
       {
-        const std::size_t i = std::distance(tagged_entities.cbegin(), e);
-        if (auto it = integrals.find(values[i]); it != integrals.end())
-          it->second.second.push_back(*e);
+        // For cell and vertex integrals use all markers (but not on
+        // ghost entities)
+        entities.insert(entities.end(), tagged_entities.begin(), entity_end);
       }
     }
   }
@@ -389,32 +528,11 @@ private:
     {
       if (auto it = kernels->second.find(-1); it != kernels->second.end())
       {
-        std::vector<std::int32_t>& active_entities = it->second.second;
-        active_entities.clear();
-
-        // Get number of facets owned by this process
-        mesh.topology_mutable().create_connectivity(tdim - 1, tdim);
-        auto f_to_c = topology.connectivity(tdim - 1, tdim);
-        assert(topology.index_map(tdim - 1));
-        std::set<std::int32_t> fwd_shared_facets;
-
-        // Only need to consider shared facets when there are no ghost cells
-        if (topology.index_map(tdim)->num_ghosts() == 0)
-        {
-          fwd_shared_facets.insert(
-              topology.index_map(tdim - 1)->shared_indices().array().begin(),
-              topology.index_map(tdim - 1)->shared_indices().array().end());
-        }
-
-        const int num_facets = topology.index_map(tdim - 1)->size_local();
-        for (int f = 0; f < num_facets; ++f)
-        {
-          if (f_to_c->num_links(f) == 1
-              and fwd_shared_facets.find(f) == fwd_shared_facets.end())
-          {
-            active_entities.push_back(f);
-          }
-        }
+        // The exterior facets are computed once and stored by the
+        // topology
+        mesh.topology_mutable().create_boundary_facets();
+        assert(topology.boundary_facets());
+        it->second.second = *topology.boundary_facets();
       }
     }
 
@@ -443,6 +561,25 @@ private:
     }
   }
 
+  // Pack the data of the facets of the ith interior facet integral
+  // (see Form::interior_facets) and store it with the version of the
+  // topology
+  const InteriorFacets& update_interior_facets(int i) const
+  {
+    const int tdim = _mesh->topology().dim();
+    _mesh->topology_mutable().create_entities(tdim - 1);
+    _mesh->topology_mutable().create_connectivity(tdim - 1, tdim);
+    _mesh->topology_mutable().create_connectivity(tdim, tdim - 1);
+    _mesh->topology_mutable().create_facet_permutations();
+
+    auto& [version, facets] = _interior_facets[i];
+    version = _mesh->topology().version();
+    facets = fem::pack_interior_facets(
+        _mesh->topology(), domains(IntegralType::interior_facet, i),
+        _mesh->topology().get_facet_permutations());
+    return facets;
+  }
+
   // Function spaces (one for each argument)
   std::vector<std::shared_ptr<const fem::FunctionSpace>> _function_spaces;
 
@@ -461,7 +598,24 @@ private:
            std::map<int, std::pair<kern, std::vector<std::int32_t>>>>
       _integrals;
 
+  // Batched kernels and batch size
+  std::map<IntegralType, std::map<int, std::pair<kern, int>>> _batch_kernels;
+
   // True if permutation data needs to be passed into these integrals
   bool _needs_facet_permutations;
+
+  // Measured cost per entity of each integral
+  mutable std::map<std::pair<IntegralType, int>, double> _costs;
+
+  // Packed data of the facets of each interior facet integral, with
+  // the version of the topology when packed, and the mutex that guards
+  // it
+  mutable std::map<int, std::pair<std::uint64_t, InteriorFacets>>
+      _interior_facets;
+  std::unique_ptr<std::mutex> _interior_facets_mutex
+      = std::make_unique<std::mutex>();
+
+  // Unique identifier
+  std::size_t _unique_id = common::UniqueIdGenerator::id();
 };
 } // namespace dolfinx::fem
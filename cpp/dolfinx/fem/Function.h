@@ -11,13 +11,16 @@
 #include <dolfinx/common/IndexMap.h>
 #include <dolfinx/common/UniqueIdGenerator.h>
 #include <dolfinx/common/array2d.h>
+#include <dolfinx/common/utils.h>
 #include <dolfinx/fem/DofMap.h>
 #include <dolfinx/fem/FiniteElement.h>
+#include <dolfinx/geometry/PointOwnership.h>
 #include <dolfinx/la/PETScVector.h>
 #include <dolfinx/la/Vector.h>
 #include <dolfinx/mesh/Geometry.h>
 #include <dolfinx/mesh/Mesh.h>
 #include <dolfinx/mesh/Topology.h>
+#include <algorithm>
 #include <functional>
 #include <memory>
 #include <numeric>
@@ -234,13 +237,14 @@ public:
   /// @param[in,out] u The values at the points. Values are not computed
   /// for points with a negative cell index. This argument must be
   /// passed with the correct size.
+  ///
+  /// The points are grouped by cell, and the points in a cell are
+  /// pulled back and the basis functions are tabulated at all of the
+  /// points at once.
   void eval(const xt::xtensor<double, 2>& x,
             const xtl::span<const std::int32_t>& cells,
             xt::xtensor<T, 2>& u) const
   {
-    // TODO: This could be easily made more efficient by exploiting points
-    // being ordered by the cell to which they belong.
-
     if (x.shape(0) != cells.size())
     {
       throw std::runtime_error(
@@ -291,21 +295,18 @@ public:
                                "elements. Extract subspaces.");
     }
 
-    // Prepare geometry data structures
-    xt::xtensor<double, 2> X({1, tdim});
-    xt::xtensor<double, 3> J
-        = xt::zeros<double>({static_cast<std::size_t>(1), gdim, tdim});
-    xt::xtensor<double, 3> K
-        = xt::zeros<double>({static_cast<std::size_t>(1), tdim, gdim});
-    xt::xtensor<double, 1> detJ = xt::zeros<double>({1});
+    // Prepare geometry data structures. These are resized for the
+    // number of points in each cell.
+    xt::xtensor<double, 2> X;
+    xt::xtensor<double, 3> J;
+    xt::xtensor<double, 3> K;
+    xt::xtensor<double, 1> detJ;
+    xt::xtensor<double, 2> xp;
 
     // Prepare basis function data structures
-    xt::xtensor<double, 4> basis_derivatives_reference_values(
-        {1, 1, space_dimension, reference_value_size});
-    auto basis_reference_values = xt::view(basis_derivatives_reference_values,
-                                           0, xt::all(), xt::all(), xt::all());
-    xt::xtensor<double, 3> basis_values(
-        {static_cast<std::size_t>(1), space_dimension, value_size});
+    xt::xtensor<double, 4> basis_derivatives_reference_values;
+    xt::xtensor<double, 3> basis_reference_values;
+    xt::xtensor<double, 3> basis_values;
 
     // Create work vector for expansion coefficients
     std::vector<T> coefficients(space_dimension * bs_element);
@@ -320,10 +321,7 @@ public:
         = mesh->topology().get_cell_permutation_info();
     xt::xtensor<double, 2> coordinate_dofs
         = xt::zeros<double>({num_dofs_g, gdim});
-    xt::xtensor<double, 2> xp
-        = xt::zeros<double>({static_cast<std::size_t>(1), gdim});
 
-    // Loop over points
     std::fill(u.data(), u.data() + u.size(), 0.0);
     const std::vector<T>& _v = _x->mutable_array();
 
@@ -333,13 +331,29 @@ public:
         apply_dof_transformation
         = element->get_dof_transformation_function<double>();
 
-    for (std::size_t p = 0; p < cells.size(); ++p)
+    // Group the points by cell, so that the points in a cell are pulled
+    // back and the basis is tabulated at all of them at once
+    std::vector<std::int32_t> perm(cells.size());
+    std::iota(perm.begin(), perm.end(), 0);
+    std::stable_sort(perm.begin(), perm.end(),
+                     [&cells](auto p0, auto p1)
+                     { return cells[p0] < cells[p1]; });
+
+    // Loop over cells
+    const std::size_t ref_size = space_dimension * reference_value_size;
+    for (auto p0 = perm.begin(); p0 != perm.end();)
     {
-      const int cell_index = cells[p];
+      const std::int32_t cell_index = cells[*p0];
+      auto p1 = std::find_if(p0, perm.end(), [&cells, cell_index](auto p)
+                             { return cells[p] != cell_index; });
+      const std::size_t num_points = std::distance(p0, p1);
 
       // Skip negative cell indices
       if (cell_index < 0)
+      {
+        p0 = p1;
         continue;
+      }
 
       // Get cell geometry (coordinate dofs)
       auto x_dofs = x_dofmap.links(cell_index);
@@ -347,46 +361,100 @@ public:
         for (std::size_t j = 0; j < gdim; ++j)
           coordinate_dofs(i, j) = x_g(x_dofs[i], j);
 
-      for (std::size_t j = 0; j < gdim; ++j)
-        xp(0, j) = x(p, j);
-
-      // Compute reference coordinates X, and J, detJ and K
+      // Compute reference coordinates X, and J, detJ and K for the
+      // points in the cell
+      xp.resize({num_points, gdim});
+      for (std::size_t q = 0; q < num_points; ++q)
+        for (std::size_t j = 0; j < gdim; ++j)
+          xp(q, j) = x(p0[q], j);
+      X.resize({num_points, tdim});
+      J.resize({num_points, gdim, tdim});
+      K.resize({num_points, tdim, gdim});
+      detJ.resize({num_points});
       cmap.pull_back(X, J, detJ, K, xp, coordinate_dofs);
 
       // Compute basis on reference element
       element->tabulate(basis_derivatives_reference_values, X, 0);
+      basis_reference_values = xt::view(basis_derivatives_reference_values,
+                                        0, xt::all(), xt::all(), xt::all());
 
-      // Permute the reference values to account for the cell's orientation
-      apply_dof_transformation(xtl::span(basis_reference_values.data(),
-                                         basis_reference_values.size()),
-                               cell_info, cell_index, reference_value_size);
+      // Permute the reference values to account for the cell's
+      // orientation
+      for (std::size_t q = 0; q < num_points; ++q)
+      {
+        apply_dof_transformation(
+            xtl::span(basis_reference_values.data() + q * ref_size, ref_size),
+            cell_info, cell_index, reference_value_size);
+      }
 
       // Push basis forward to physical element
+      basis_values.resize({num_points, space_dimension, value_size});
       element->transform_reference_basis(basis_values, basis_reference_values,
                                          J, detJ, K);
 
       // Get degrees of freedom for current cell
       xtl::span<const std::int32_t> dofs = dofmap->cell_dofs(cell_index);
-      for (std::size_t i = 0; i < dofs.size(); ++i)
-        for (int k = 0; k < bs_dof; ++k)
-          coefficients[bs_dof * i + k] = _v[bs_dof * dofs[i] + k];
+      auto gather = [&](auto bs)
+      {
+        for (std::size_t i = 0; i < dofs.size(); ++i)
+          for (int k = 0; k < bs; ++k)
+            coefficients[bs * i + k] = _v[bs * dofs[i] + k];
+      };
+      common::dispatch_block_size(bs_dof, gather);
 
       // Compute expansion
-      auto u_row = xt::row(u, p);
-      for (int k = 0; k < bs_element; ++k)
+      for (std::size_t q = 0; q < num_points; ++q)
       {
-        for (std::size_t i = 0; i < space_dimension; ++i)
+        auto u_row = xt::row(u, p0[q]);
+        for (int k = 0; k < bs_element; ++k)
         {
-          for (std::size_t j = 0; j < value_size; ++j)
+          for (std::size_t i = 0; i < space_dimension; ++i)
           {
-            u_row[j * bs_element + k]
-                += coefficients[bs_element * i + k] * basis_values(0, i, j);
+            for (std::size_t j = 0; j < value_size; ++j)
+            {
+              u_row[j * bs_element + k]
+                  += coefficients[bs_element * i + k] * basis_values(q, i, j);
+            }
           }
         }
       }
+
+      p0 = p1;
     }
   }
 
+  /// Evaluate the Function at points that are distributed across
+  /// processes (collective). Each process evaluates the Function at the
+  /// points that it owns, and sends the values to the processes that
+  /// passed the points.
+  ///
+  /// @param[in] points The ownership of the points, which can be
+  /// reused for Functions on the same mesh
+  /// @param[in,out] u The values at the points passed by the caller to
+  /// @p points, with shape (num_points, value_size). The values of
+  /// points that do not collide with the mesh are zero.
+  void eval(const geometry::PointOwnership& points, xt::xtensor<T, 2>& u) const
+  {
+    if (u.shape(0) != (std::size_t)points.num_points())
+    {
+      throw std::runtime_error(
+          "Length of array for Function values must be the "
+          "same as the number of points.");
+    }
+
+    const std::vector<double>& x = points.owned_points();
+    const std::vector<std::int32_t>& cells = points.owned_cells();
+    const std::array<std::size_t, 2> shape = {cells.size(), 3};
+    const xt::xtensor<double, 2> _x = xt::adapt(x.data(), x.size(),
+                                               xt::no_ownership(), shape);
+    xt::xtensor<T, 2> u_owned({cells.size(), u.shape(1)});
+    eval(_x, cells, u_owned);
+
+    const std::vector<T> values = points.scatter_values(
+        xtl::span<const T>(u_owned.data(), u_owned.size()), u.shape(1));
+    std::copy(values.begin(), values.end(), u.data());
+  }
+
   /// Compute values at all mesh 'nodes'
   /// @return The values at all geometric points
   xt::xtensor<T, 2> compute_point_values() const
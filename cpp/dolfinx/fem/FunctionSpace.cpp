@@ -10,6 +10,7 @@
 #include <dolfinx/fem/CoordinateElement.h>
 #include <dolfinx/fem/DofMap.h>
 #include <dolfinx/fem/FiniteElement.h>
+#include <dolfinx/fem/TabulationCache.h>
 #include <dolfinx/graph/AdjacencyList.h>
 #include <dolfinx/mesh/Geometry.h>
 #include <dolfinx/mesh/Mesh.h>
@@ -85,17 +86,20 @@ FunctionSpace::collapse() const
   if (_component.empty())
     throw std::runtime_error("Function space is not a subspace");
 
+  // Return cached collapsed space, if available
+  if (_collapsed_space)
+    return {_collapsed_space, _collapsed_dofs};
+
   // Create collapsed DofMap
   std::shared_ptr<fem::DofMap> collapsed_dofmap;
-  std::vector<std::int32_t> collapsed_dofs;
-  std::tie(collapsed_dofmap, collapsed_dofs)
+  std::tie(collapsed_dofmap, _collapsed_dofs)
       = _dofmap->collapse(_mesh->mpi_comm(), _mesh->topology());
 
-  // Create new FunctionSpace and return
-  auto collapsed_sub_space
+  // Create new FunctionSpace and cache
+  _collapsed_space
       = std::make_shared<FunctionSpace>(_mesh, _element, collapsed_dofmap);
 
-  return {std::move(collapsed_sub_space), std::move(collapsed_dofs)};
+  return {_collapsed_space, _collapsed_dofs};
 }
 //-----------------------------------------------------------------------------
 std::vector<int> FunctionSpace::component() const { return _component; }
@@ -174,8 +178,10 @@ FunctionSpace::tabulate_dof_coordinates(bool transpose) const
       apply_dof_transformation
       = _element->get_dof_transformation_function<double>();
 
+  std::shared_ptr<const xt::xtensor<double, 4>> phi_table
+      = TabulationCache::instance().tabulate(cmap, 0, X);
   const xt::xtensor<double, 2> phi
-      = xt::view(cmap.tabulate(0, X), 0, xt::all(), xt::all(), 0);
+      = xt::view(*phi_table, 0, xt::all(), xt::all(), 0);
 
   for (int c = 0; c < num_cells; ++c)
   {
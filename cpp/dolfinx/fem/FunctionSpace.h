@@ -72,7 +72,9 @@ public:
   bool contains(const FunctionSpace& V) const;
 
   /// Collapse a subspace and return a new function space and a map from
-  /// new to old dofs
+  /// new to old dofs. The collapsed space and the map are computed once
+  /// and cached on the subspace, which is itself cached by component on
+  /// the parent space (see FunctionSpace::sub).
   /// @return The new function space and a map from new to old dofs
   std::pair<std::shared_ptr<FunctionSpace>, std::vector<std::int32_t>>
   collapse() const;
@@ -125,6 +127,11 @@ private:
 
   // Cache of subspaces
   mutable std::map<std::vector<int>, std::weak_ptr<FunctionSpace>> _subspaces;
+
+  // Cache of the collapsed space and the map from collapsed to
+  // original dofs
+  mutable std::shared_ptr<FunctionSpace> _collapsed_space;
+  mutable std::vector<std::int32_t> _collapsed_dofs;
 };
 
 /// Extract FunctionSpaces for (0) rows blocks and (1) columns blocks
@@ -0,0 +1,52 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "InteriorFacets.h"
+#include <dolfinx/graph/AdjacencyList.h>
+#include <dolfinx/mesh/Topology.h>
+
+using namespace dolfinx;
+
+//-----------------------------------------------------------------------------
+fem::InteriorFacets
+fem::pack_interior_facets(const mesh::Topology& topology,
+                          const xtl::span<const std::int32_t>& facets,
+                          const xtl::span<const std::uint8_t>& perms)
+{
+  const int tdim = topology.dim();
+  auto f_to_c = topology.connectivity(tdim - 1, tdim);
+  assert(f_to_c);
+  auto c_to_f = topology.connectivity(tdim, tdim - 1);
+  assert(c_to_f);
+
+  InteriorFacets data;
+  data.cells.resize(2 * facets.size());
+  data.local_facets.resize(2 * facets.size());
+  data.perms.resize(2 * facets.size(), 0);
+  for (std::size_t k = 0; k < facets.size(); ++k)
+  {
+    const std::int32_t f = facets[k];
+    auto cells = f_to_c->links(f);
+    assert(cells.size() == 2);
+    for (int i = 0; i < 2; ++i)
+    {
+      auto cell_facets = c_to_f->links(cells[i]);
+      auto it = std::find(cell_facets.begin(), cell_facets.end(), f);
+      assert(it != cell_facets.end());
+      const int local_facet = std::distance(cell_facets.begin(), it);
+      data.cells[2 * k + i] = cells[i];
+      data.local_facets[2 * k + i] = local_facet;
+      if (!perms.empty())
+      {
+        data.perms[2 * k + i]
+            = perms[cells[i] * cell_facets.size() + local_facet];
+      }
+    }
+  }
+
+  return data;
+}
+//-----------------------------------------------------------------------------
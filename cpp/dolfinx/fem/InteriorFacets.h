@@ -0,0 +1,94 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <dolfinx/common/array2d.h>
+#include <vector>
+#include <xtl/xspan.hpp>
+
+namespace dolfinx::mesh
+{
+class Topology;
+}
+
+namespace dolfinx::fem
+{
+
+/// Packed data of a list of interior facets for assembly: for each
+/// facet, the two attached cells, the local index of the facet in each
+/// cell and the permutation of the facet relative to each cell, stored
+/// contiguously in the order of the facet list. Assembly over the
+/// facets then streams through these arrays instead of looking up the
+/// facet-cell connectivities of the topology.
+struct InteriorFacets
+{
+  /// The two cells attached to each facet, `cells[2 * k + i]` for cell
+  /// `i` of facet `k`
+  std::vector<std::int32_t> cells;
+
+  /// The local index of each facet in each of its cells, in the layout
+  /// of InteriorFacets::cells
+  std::vector<int> local_facets;
+
+  /// The permutation of each facet relative to each of its cells, in
+  /// the layout of InteriorFacets::cells
+  std::vector<std::uint8_t> perms;
+
+  /// Number of facets
+  std::size_t size() const { return cells.size() / 2; }
+};
+
+/// Pack the data of a list of interior facets
+/// @param[in] topology The mesh topology. The facet-to-cell and
+/// cell-to-facet connectivities must have been computed.
+/// @param[in] facets The interior facets
+/// @param[in] perms The facet permutations of the topology (see
+/// mesh::Topology::get_facet_permutations). If empty, all permutations
+/// are zero.
+/// @return The packed data, in the order of `facets`
+InteriorFacets
+pack_interior_facets(const mesh::Topology& topology,
+                     const xtl::span<const std::int32_t>& facets,
+                     const xtl::span<const std::uint8_t>& perms);
+
+/// Pack the coefficients of the two cells of each interior facet in the
+/// layout of the interior facet kernels, i.e. row `k` holds
+/// `w[coefficient][restriction][dof]` for facet `k`
+/// @param[in] coeffs The packed coefficients of the cells (see
+/// fem::pack_coefficients)
+/// @param[in] facets The packed interior facets
+/// @param[in] offsets The coefficient offsets (see
+/// Form::coefficient_offsets)
+/// @return The coefficients of the facets
+template <typename T>
+array2d<T> pack_interior_facet_coefficients(const array2d<T>& coeffs,
+                                            const InteriorFacets& facets,
+                                            const xtl::span<const int>& offsets)
+{
+  assert(offsets.back() == (int)coeffs.shape[1]);
+  array2d<T> c(facets.size(), 2 * offsets.back());
+  for (std::size_t k = 0; k < facets.size(); ++k)
+  {
+    auto coeff_cell0 = coeffs.row(facets.cells[2 * k]);
+    auto coeff_cell1 = coeffs.row(facets.cells[2 * k + 1]);
+    auto ck = c.row(k);
+    for (std::size_t i = 0; i < offsets.size() - 1; ++i)
+    {
+      const int num_entries = offsets[i + 1] - offsets[i];
+      std::copy_n(coeff_cell0.data() + offsets[i], num_entries,
+                  std::next(ck.begin(), 2 * offsets[i]));
+      std::copy_n(coeff_cell1.data() + offsets[i], num_entries,
+                  std::next(ck.begin(), offsets[i + 1] + offsets[i]));
+    }
+  }
+  return c;
+}
+
+} // namespace dolfinx::fem
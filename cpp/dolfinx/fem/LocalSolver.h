@@ -0,0 +1,433 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include "DofMap.h"
+#include "Form.h"
+#include "FunctionSpace.h"
+#include "utils.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/utils.h>
+#include <dolfinx/la/Vector.h>
+#include <dolfinx/mesh/Geometry.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include <xtl/xspan.hpp>
+
+namespace dolfinx::fem
+{
+
+/// @cond
+namespace impl
+{
+/// Complex conjugate that preserves real types
+template <typename T>
+T local_conj(T x)
+{
+  if constexpr (std::is_floating_point_v<T>)
+    return x;
+  else
+    return std::conj(x);
+}
+
+/// Factorise W square matrices of size n in place, stored interleaved
+/// (entry (i, j) of matrix w at A[(i * n + j) * W + w]). The LU
+/// factorisation is without pivoting: the unit lower factor is stored
+/// below the diagonal and the upper factor on and above it. The
+/// Cholesky factorisation stores the lower factor L (A = L L^H) on and
+/// below the diagonal.
+/// @return False if a pivot of the LU factorisation is zero, or if a
+/// matrix is not positive-definite for the Cholesky factorisation. The
+/// factorisation is then incomplete.
+template <typename T, int W>
+bool factorize_batch(T* A, int n, bool cholesky)
+{
+  if (cholesky)
+  {
+    for (int j = 0; j < n; ++j)
+    {
+      T* Ajj = A + (j * n + j) * W;
+      for (int k = 0; k < j; ++k)
+      {
+        const T* Ljk = A + (j * n + k) * W;
+        for (int w = 0; w < W; ++w)
+          Ajj[w] -= Ljk[w] * local_conj(Ljk[w]);
+      }
+      for (int w = 0; w < W; ++w)
+      {
+        if (std::real(Ajj[w]) <= 0)
+          return false;
+        Ajj[w] = std::sqrt(Ajj[w]);
+      }
+      for (int i = j + 1; i < n; ++i)
+      {
+        T* Aij = A + (i * n + j) * W;
+        for (int k = 0; k < j; ++k)
+        {
+          const T* Lik = A + (i * n + k) * W;
+          const T* Ljk = A + (j * n + k) * W;
+          for (int w = 0; w < W; ++w)
+            Aij[w] -= Lik[w] * local_conj(Ljk[w]);
+        }
+        for (int w = 0; w < W; ++w)
+          Aij[w] /= Ajj[w];
+      }
+    }
+  }
+  else
+  {
+    for (int k = 0; k < n; ++k)
+    {
+      const T* Akk = A + (k * n + k) * W;
+      for (int w = 0; w < W; ++w)
+      {
+        if (Akk[w] == T(0))
+          return false;
+      }
+      for (int i = k + 1; i < n; ++i)
+      {
+        T* Aik = A + (i * n + k) * W;
+        for (int w = 0; w < W; ++w)
+          Aik[w] /= Akk[w];
+        for (int j = k + 1; j < n; ++j)
+        {
+          T* Aij = A + (i * n + j) * W;
+          const T* Akj = A + (k * n + j) * W;
+          for (int w = 0; w < W; ++w)
+            Aij[w] -= Aik[w] * Akj[w];
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+/// Solve with W matrices factorised by impl::factorize_batch, for the
+/// interleaved right-hand sides b (entry i of system w at b[i * W + w]),
+/// which are overwritten by the solutions
+template <typename T, int W>
+void solve_batch(const T* A, T* b, int n, bool cholesky)
+{
+  // Forward substitution
+  for (int i = 0; i < n; ++i)
+  {
+    T* bi = b + i * W;
+    for (int k = 0; k < i; ++k)
+    {
+      const T* Aik = A + (i * n + k) * W;
+      const T* bk = b + k * W;
+      for (int w = 0; w < W; ++w)
+        bi[w] -= Aik[w] * bk[w];
+    }
+    if (cholesky)
+    {
+      const T* Aii = A + (i * n + i) * W;
+      for (int w = 0; w < W; ++w)
+        bi[w] /= Aii[w];
+    }
+  }
+
+  // Back substitution, with U or L^H
+  for (int i = n - 1; i >= 0; --i)
+  {
+    T* bi = b + i * W;
+    for (int k = i + 1; k < n; ++k)
+    {
+      const T* bk = b + k * W;
+      if (cholesky)
+      {
+        const T* Lki = A + (k * n + i) * W;
+        for (int w = 0; w < W; ++w)
+          bi[w] -= local_conj(Lki[w]) * bk[w];
+      }
+      else
+      {
+        const T* Aik = A + (i * n + k) * W;
+        for (int w = 0; w < W; ++w)
+          bi[w] -= Aik[w] * bk[w];
+      }
+    }
+    const T* Aii = A + (i * n + i) * W;
+    for (int w = 0; w < W; ++w)
+      bi[w] /= cholesky ? local_conj(Aii[w]) : Aii[w];
+  }
+}
+} // namespace impl
+/// @endcond
+
+/// Solution of the cell-local systems A_e x_e = b_e of a bilinear form
+/// `a` and a linear form `L` on a space whose dofs each belong to one
+/// cell, e.g. the inversion of a DG mass matrix, local projections and
+/// the local solvers of hybridised methods.
+///
+/// The element matrices are computed and factorised once
+/// (LocalSolver::factorize). A solve (LocalSolver::solve) computes the
+/// element vectors of `L` and sets the entries of the solution vector
+/// cell by cell, without assembling any global matrix.
+///
+/// The cells are processed in batches of W cells, with the element
+/// matrices and vectors of a batch stored interleaved so that the
+/// factorisation and substitution loops run over the cells of the
+/// batch in the innermost loop, which the compiler vectorises.
+///
+/// @note Only cell integrals are supported, and both arguments of `a`
+/// and the argument of `L` must be in the same function space. The LU
+/// factorisation does not pivot, and Cholesky factorisation requires
+/// Hermitian positive-definite element matrices.
+template <typename T, int W = 8>
+class LocalSolver
+{
+public:
+  /// Factorisation of the element matrices
+  enum class Type
+  {
+    lu,
+    cholesky
+  };
+
+  /// Create a local solver for the forms a and L
+  /// @param[in] a The bilinear form
+  /// @param[in] L The linear form
+  /// @param[in] type The factorisation of the element matrices
+  LocalSolver(const std::shared_ptr<const Form<T>>& a,
+              const std::shared_ptr<const Form<T>>& L, Type type = Type::lu)
+      : _a(a), _L(L), _cholesky(type == Type::cholesky)
+  {
+    assert(_a);
+    assert(_L);
+    if (_a->rank() != 2 or _L->rank() != 1)
+      throw std::runtime_error("Require a bilinear and a linear form.");
+    _V = _a->function_spaces().at(0);
+    if (_a->function_spaces().at(1) != _V or _L->function_spaces().at(0) != _V)
+    {
+      throw std::runtime_error(
+          "Local solver requires the same space for all arguments.");
+    }
+
+    for (const Form<T>* form : {_a.get(), _L.get()})
+    {
+      for (auto type : {IntegralType::exterior_facet,
+                        IntegralType::interior_facet, IntegralType::vertex})
+      {
+        if (form->num_integrals(type) > 0)
+        {
+          throw std::runtime_error(
+              "Local solver supports cell integrals only.");
+        }
+      }
+    }
+
+    // Cells of all integrals
+    for (const Form<T>* form : {_a.get(), _L.get()})
+    {
+      for (int i : form->integral_ids(IntegralType::cell))
+      {
+        const std::vector<std::int32_t>& cells
+            = form->domains(IntegralType::cell, i);
+        _cells.insert(_cells.end(), cells.begin(), cells.end());
+      }
+    }
+    std::sort(_cells.begin(), _cells.end());
+    _cells.erase(std::unique(_cells.begin(), _cells.end()), _cells.end());
+
+    // Check that no dof is shared between the cells
+    const DofMap& dofmap = *_V->dofmap();
+    std::shared_ptr<const common::IndexMap> map = dofmap.index_map;
+    std::vector<bool> used(map->size_local() + map->num_ghosts(), false);
+    for (std::int32_t c : _cells)
+    {
+      for (std::int32_t dof : dofmap.cell_dofs(c))
+      {
+        if (used[dof])
+        {
+          throw std::runtime_error(
+              "Local solver requires a space with cell-local dofs.");
+        }
+        used[dof] = true;
+      }
+    }
+  }
+
+  /// Compute and factorise the element matrices of the bilinear form,
+  /// using its current coefficients and constants. Throws if an element
+  /// matrix has a zero pivot (LU, which does not pivot) or is not
+  /// positive-definite (Cholesky).
+  /// @param[in] num_threads The number of threads
+  void factorize(int num_threads = 1)
+  {
+    const int n = num_cell_dofs();
+    const std::size_t num_batches = (_cells.size() + W - 1) / W;
+    _A.assign(num_batches * n * n * W, 0);
+
+    // The padding systems of the last batch are identities
+    for (std::size_t s = _cells.size(); s < num_batches * W; ++s)
+    {
+      T* A = _A.data() + (s / W) * n * n * W + s % W;
+      for (int i = 0; i < n; ++i)
+        A[(i * n + i) * W] = 1;
+    }
+
+    compute_element_tensors(*_a, n * n, _A, num_threads);
+
+    std::atomic<bool> failed(false);
+    common::for_each_part(
+        num_batches, num_threads,
+        [&](std::int64_t b0, std::int64_t b1, int)
+        {
+          for (std::int64_t b = b0; b < b1; ++b)
+          {
+            if (!impl::factorize_batch<T, W>(_A.data() + b * n * n * W, n,
+                                             _cholesky))
+            {
+              failed = true;
+            }
+          }
+        });
+    if (failed)
+    {
+      _n = -1;
+      throw std::runtime_error(
+          _cholesky ? "Element matrix is not positive-definite."
+                    : "Element matrix has a zero pivot. LU factorisation "
+                      "does not pivot.");
+    }
+    _n = n;
+  }
+
+  /// Solve the local systems for the element vectors of the linear form
+  /// (with its current coefficients and constants), and set the
+  /// entries of x for the dofs of the cells. The ghost entries of x are
+  /// updated.
+  /// @param[in,out] x The solution vector
+  /// @param[in] num_threads The number of threads
+  template <class Allocator>
+  void solve(la::Vector<T, Allocator>& x, int num_threads = 1)
+  {
+    if (_n < 0)
+      throw std::runtime_error("Local solver has not been factorised.");
+    const int n = _n;
+    const std::size_t num_batches = (_cells.size() + W - 1) / W;
+    std::vector<T> b(num_batches * n * W, 0);
+    compute_element_tensors(*_L, n, b, num_threads);
+
+    const DofMap& dofmap = *_V->dofmap();
+    const int bs = dofmap.bs();
+    std::vector<T, Allocator>& _x = x.mutable_array();
+    common::for_each_part(
+        num_batches, num_threads,
+        [&](std::int64_t b0, std::int64_t b1, int)
+        {
+          for (std::int64_t k = b0; k < b1; ++k)
+          {
+            T* bk = b.data() + k * n * W;
+            impl::solve_batch<T, W>(_A.data() + k * n * n * W, bk, n,
+                                    _cholesky);
+            const std::size_t s1 = std::min<std::size_t>((k + 1) * W,
+                                                         _cells.size());
+            for (std::size_t s = k * W; s < s1; ++s)
+            {
+              auto dofs = dofmap.cell_dofs(_cells[s]);
+              for (std::size_t i = 0; i < dofs.size(); ++i)
+                for (int j = 0; j < bs; ++j)
+                  _x[bs * dofs[i] + j] = bk[(bs * i + j) * W + s % W];
+            }
+          }
+        });
+    x.scatter_fwd();
+  }
+
+  /// The cells of the local systems
+  const std::vector<std::int32_t>& cells() const { return _cells; }
+
+private:
+  // Compute the element tensors (of size ndim) of the cell integrals of
+  // a form and add them to the interleaved batch array A
+  void compute_element_tensors(const Form<T>& form, int ndim,
+                               std::vector<T>& A, int num_threads) const
+  {
+    const std::vector<T> constants = pack_constants(form);
+    const array2d<T> coeffs = pack_coefficients(form);
+    const xtl::span<const std::uint32_t> cell_info
+        = impl::get_cell_info(form);
+
+    std::shared_ptr<const FiniteElement> element = _V->element();
+    const bool transform = element->needs_dof_transformations();
+    const auto apply_dof_transformation
+        = element->get_dof_transformation_function<T>();
+    const auto apply_dof_transformation_to_transpose
+        = element->get_dof_transformation_to_transpose_function<T>();
+    const int n = form.rank() == 2 ? num_cell_dofs() : ndim;
+
+    const mesh::Geometry& geometry = _V->mesh()->geometry();
+    const std::size_t num_dofs_g = geometry.dofmap().num_links(0);
+    for (int i : form.integral_ids(IntegralType::cell))
+    {
+      const auto& fn = form.kernel(IntegralType::cell, i);
+      const std::vector<std::int32_t>& cells
+          = form.domains(IntegralType::cell, i);
+      common::for_each_part(
+          cells.size(), num_threads,
+          [&](std::int64_t c0, std::int64_t c1, int)
+          {
+            std::vector<double> coordinate_dofs(3 * num_dofs_g);
+            std::vector<T> Ae(ndim);
+            const xtl::span<T> _Ae(Ae);
+            for (std::int64_t k = c0; k < c1; ++k)
+            {
+              const std::int32_t c = cells[k];
+              geometry.cell_coordinates(c, coordinate_dofs);
+              std::fill(Ae.begin(), Ae.end(), 0);
+              fn(Ae.data(), coeffs.row(c).data(), constants.data(),
+                 coordinate_dofs.data(), nullptr, nullptr);
+              if (transform and (cell_info.empty() or cell_info[c] != 0))
+              {
+                apply_dof_transformation(_Ae, cell_info, c, ndim / n);
+                if (form.rank() == 2)
+                  apply_dof_transformation_to_transpose(_Ae, cell_info, c, n);
+              }
+
+              // Add to the slot of the cell in its batch
+              const std::size_t s
+                  = std::lower_bound(_cells.begin(), _cells.end(), c)
+                    - _cells.begin();
+              T* As = A.data() + (s / W) * ndim * W + s % W;
+              for (int j = 0; j < ndim; ++j)
+                As[j * W] += Ae[j];
+            }
+          });
+    }
+  }
+
+  // Number of (unrolled) dofs of a cell
+  int num_cell_dofs() const
+  {
+    return _V->dofmap()->cell_dofs(0).size() * _V->dofmap()->bs();
+  }
+
+  std::shared_ptr<const Form<T>> _a, _L;
+  std::shared_ptr<const FunctionSpace> _V;
+  bool _cholesky;
+
+  // Cells of the local systems (sorted)
+  std::vector<std::int32_t> _cells;
+
+  // Number of dofs of a cell (-1 before factorisation), and the
+  // interleaved factorised element matrices of the batches
+  int _n = -1;
+  std::vector<T> _A;
+};
+
+} // namespace dolfinx::fem
@@ -0,0 +1,256 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include "DirichletBC.h"
+#include "DofMap.h"
+#include "Form.h"
+#include "FunctionSpace.h"
+#include "PackedCoefficients.h"
+#include "assemble_matrix_impl.h"
+#include "utils.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/la/Vector.h>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include <xtl/xspan.hpp>
+
+namespace dolfinx::fem
+{
+
+/// Matrix-free action of a bilinear form.
+///
+/// Computes y = A x, where A is the matrix of a bilinear form, without
+/// assembling A. The element matrices are computed cell-by-cell (and
+/// facet-by-facet) by the form kernels and applied immediately to the
+/// local entries of x. The forward update of the ghost entries of x is
+/// overlapped with the action on cells that touch only owned degrees of
+/// freedom, and the reverse update of y with the remaining owned cells.
+///
+/// Dirichlet boundary conditions are applied as in fem::assemble_matrix
+/// followed by fem::set_diagonal, i.e. bc rows and columns are zeroed
+/// and `diagonal * x` is set for bc rows.
+///
+/// @note The coefficients of the form are re-packed when their vectors
+/// have changed, see fem::PackedCoefficients.
+template <typename T>
+class MatrixFreeOperator
+{
+public:
+  /// Create matrix-free operator
+  /// @param[in] a The bilinear form
+  /// @param[in] bcs Dirichlet boundary conditions
+  /// @param[in] diagonal The diagonal value for bc rows
+  MatrixFreeOperator(
+      const std::shared_ptr<const Form<T>>& a,
+      const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs,
+      T diagonal = 1.0)
+      : _a(a), _coeffs(*a), _diagonal(diagonal)
+  {
+    assert(_a);
+    if (_a->rank() != 2)
+      throw std::runtime_error("Form must be bilinear.");
+    if (_a->num_integrals(IntegralType::vertex) > 0)
+      throw std::runtime_error("Vertex integrals are not supported.");
+
+    // Build dof markers
+    for (int i = 0; i < 2; ++i)
+    {
+      std::shared_ptr<const DofMap> dofmap
+          = _a->function_spaces().at(i)->dofmap();
+      _maps[i] = dofmap->index_map;
+      _bs[i] = dofmap->index_map_bs();
+    }
+    for (auto& bc : bcs)
+    {
+      assert(bc);
+      for (int i = 0; i < 2; ++i)
+      {
+        if (_a->function_spaces().at(i)->contains(*bc->function_space()))
+        {
+          _bc[i].resize(
+              _bs[i] * (_maps[i]->size_local() + _maps[i]->num_ghosts()),
+              false);
+          bc->mark_dofs(_bc[i]);
+        }
+      }
+    }
+
+    // Owned bc rows. The diagonal is set only for rows that are also
+    // bc columns.
+    if (!_bc[0].empty()
+        and _a->function_spaces()[0] == _a->function_spaces()[1])
+    {
+      for (std::int32_t i = 0; i < _bs[0] * _maps[0]->size_local(); ++i)
+        if (_bc[0][i])
+          _bc_rows.push_back(i);
+    }
+
+    // Split cells into those that touch only owned dofs (interior)
+    // and those that touch ghosts (boundary). The interior cells are
+    // split in two, with the second part processed while the reverse
+    // scatter is in flight. Each part is further split into cells with
+    // and without constrained dofs, so that bc checks are performed
+    // only for the (few) cells that need them.
+    const std::vector<std::reference_wrapper<const DofMap>> dofmaps
+        = {*_a->function_spaces().at(0)->dofmap(),
+           *_a->function_spaces().at(1)->dofmap()};
+    for (int i : _a->integral_ids(IntegralType::cell))
+    {
+      std::array<std::vector<std::int32_t>, 2> split
+          = split_cells_by_ownership(_a->domains(IntegralType::cell, i),
+                                     dofmaps);
+      std::vector<std::int32_t>& interior = split[0];
+      const std::size_t n = interior.size() / 2;
+      const std::array<xtl::span<const std::int32_t>, 3> parts
+          = {xtl::span<const std::int32_t>(interior.data(), n),
+             xtl::span<const std::int32_t>(split[1]),
+             xtl::span<const std::int32_t>(interior.data() + n,
+                                           interior.size() - n)};
+      auto& cells = _cells.emplace_back();
+      for (int p = 0; p < 3; ++p)
+        cells[p] = split_cells_by_bc(parts[p], dofmaps, {_bc[0], _bc[1]});
+    }
+  }
+
+  /// Copy constructor (deleted)
+  MatrixFreeOperator(const MatrixFreeOperator& A) = delete;
+
+  /// Assignment operator (deleted)
+  MatrixFreeOperator& operator=(const MatrixFreeOperator& A) = delete;
+
+  /// Destructor
+  ~MatrixFreeOperator() = default;
+
+  /// Compute y = A x
+  /// @param[in,out] x The vector to apply the operator to. Its ghost
+  /// entries are updated.
+  /// @param[in,out] y The result. Only the owned entries are valid on
+  /// exit.
+  template <class Allocator>
+  void apply(la::Vector<T, Allocator>& x, la::Vector<T, Allocator>& y)
+  {
+    x.scatter_fwd_begin();
+
+    std::vector<T, Allocator>& _y = y.mutable_array();
+    std::fill(_y.begin(), _y.end(), 0);
+    const std::vector<T> constant_values = pack_constants(*_a);
+    const xtl::span<const T> constants(constant_values);
+    const array2d<T>& coeffs = _coeffs.update();
+
+    // Element action, y_e += A_e x_e. This is passed to the assembly
+    // loops as a lambda so that it can be inlined.
+    const std::vector<T, Allocator>& _x = x.array();
+    const int bs0 = _a->function_spaces()[0]->dofmap()->bs();
+    const int bs1 = _a->function_spaces()[1]->dofmap()->bs();
+    auto action = [&_x, &_y, bs0, bs1](std::int32_t m, const std::int32_t* rows,
+                                       std::int32_t n, const std::int32_t* cols,
+                                       const T* Ae) -> int
+    {
+      const int ndim1 = bs1 * n;
+      for (std::int32_t i = 0; i < m; ++i)
+      {
+        for (int k0 = 0; k0 < bs0; ++k0)
+        {
+          const T* Ae_row = Ae + (bs0 * i + k0) * ndim1;
+          T yi = 0;
+          for (std::int32_t j = 0; j < n; ++j)
+            for (int k1 = 0; k1 < bs1; ++k1)
+              yi += Ae_row[bs1 * j + k1] * _x[bs1 * cols[j] + k1];
+          _y[bs0 * rows[i] + k0] += yi;
+        }
+      }
+      return 0;
+    };
+
+    // Interior cells (part 1)
+    apply_cells(action, 0, constants, coeffs);
+
+    // Cells that touch ghosts and facets
+    x.scatter_fwd_end();
+    apply_cells(action, 1, constants, coeffs);
+    impl::assemble_facet_integrals(action, *_a, constants, coeffs, _bc[0],
+                                   _bc[1], impl::get_cell_info(*_a), 1);
+
+    // Interior cells (part 2)
+    y.scatter_rev_begin();
+    apply_cells(action, 2, constants, coeffs);
+    y.scatter_rev_end(common::IndexMap::Mode::add);
+
+    // Set bc rows
+    for (std::int32_t i : _bc_rows)
+      _y[i] = _diagonal * _x[i];
+  }
+
+  /// The bilinear form
+  std::shared_ptr<const Form<T>> form() const { return _a; }
+
+  /// Index maps for the range (0) and the domain (1) of the operator
+  std::array<std::shared_ptr<const common::IndexMap>, 2> index_maps() const
+  {
+    return _maps;
+  }
+
+  /// Block sizes of the index maps for the range (0) and the domain (1)
+  /// of the operator
+  std::array<int, 2> block_size() const { return _bs; }
+
+private:
+  // Apply operator on part p (0: interior 1, 1: boundary, 2: interior
+  // 2) of the cells of each cell integral
+  template <typename U>
+  void apply_cells(const U& action, int p,
+                   const xtl::span<const T>& constants,
+                   const array2d<T>& coeffs)
+  {
+    const xtl::span<const std::uint32_t> cell_info = impl::get_cell_info(*_a);
+    const std::vector<int> ids = _a->integral_ids(IntegralType::cell);
+    const std::vector<bool> no_bc;
+    for (std::size_t i = 0; i < ids.size(); ++i)
+    {
+      // Cells without constrained dofs, with no bc checks
+      impl::assemble_cell_integral(action, *_a, ids[i], _cells[i][p][0],
+                                   constants, coeffs, no_bc, no_bc,
+                                   cell_info);
+
+      // Cells with constrained dofs
+      impl::assemble_cell_integral(action, *_a, ids[i], _cells[i][p][1],
+                                   constants, coeffs, _bc[0], _bc[1],
+                                   cell_info);
+    }
+  }
+
+  // The bilinear form
+  std::shared_ptr<const Form<T>> _a;
+
+  // Packed coefficients
+  PackedCoefficients<T> _coeffs;
+
+  // Index maps and block sizes for the two spaces
+  std::array<std::shared_ptr<const common::IndexMap>, 2> _maps;
+  std::array<int, 2> _bs;
+
+  // Dirichlet bc dof markers for the two spaces
+  std::array<std::vector<bool>, 2> _bc;
+
+  // Owned bc rows (unrolled) and the value of the diagonal
+  std::vector<std::int32_t> _bc_rows;
+  T _diagonal;
+
+  // Cells of each cell integral, split into interior (part 1),
+  // boundary and interior (part 2) cells, and each part split into
+  // cells without (0) and with (1) constrained dofs
+  std::vector<std::array<std::array<std::vector<std::int32_t>, 2>, 3>>
+      _cells;
+};
+
+} // namespace dolfinx::fem
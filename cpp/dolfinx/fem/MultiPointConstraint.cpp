@@ -0,0 +1,63 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "MultiPointConstraint.h"
+#include <algorithm>
+#include <dolfinx/common/MPI.h>
+#include <mpi.h>
+#include <set>
+#include <vector>
+
+using namespace dolfinx;
+
+//-----------------------------------------------------------------------------
+std::shared_ptr<const common::IndexMap>
+fem::extend_index_map(MPI_Comm comm,
+                      std::shared_ptr<const common::IndexMap> map,
+                      const xtl::span<const std::int64_t>& masters)
+{
+  assert(map);
+
+  // Find the masters that are not owned or ghosted
+  std::vector<std::int32_t> local(masters.size());
+  map->global_to_local(masters, local);
+  std::vector<std::int64_t> new_ghosts;
+  for (std::size_t i = 0; i < masters.size(); ++i)
+    if (local[i] < 0)
+      new_ghosts.push_back(masters[i]);
+  std::sort(new_ghosts.begin(), new_ghosts.end());
+  new_ghosts.erase(std::unique(new_ghosts.begin(), new_ghosts.end()),
+                   new_ghosts.end());
+
+  std::int64_t num_new = new_ghosts.size();
+  MPI_Allreduce(MPI_IN_PLACE, &num_new, 1, MPI_INT64_T, MPI_SUM, comm);
+  if (num_new == 0)
+    return map;
+
+  // Compute the owner of each new ghost from the ranges of all
+  // processes
+  const int size = dolfinx::MPI::size(comm);
+  const std::int64_t offset = map->local_range()[0];
+  std::vector<std::int64_t> ranges(size + 1);
+  MPI_Allgather(&offset, 1, MPI_INT64_T, ranges.data(), 1, MPI_INT64_T, comm);
+  ranges[size] = map->size_global();
+
+  std::vector<std::int64_t> ghosts = map->ghosts();
+  std::vector<int> owners = map->ghost_owner_rank();
+  for (std::int64_t g : new_ghosts)
+  {
+    auto it = std::upper_bound(ranges.begin(), ranges.end(), g);
+    owners.push_back(std::distance(ranges.begin(), it) - 1);
+  }
+  ghosts.insert(ghosts.end(), new_ghosts.begin(), new_ghosts.end());
+
+  return std::make_shared<common::IndexMap>(
+      comm, map->size_local(),
+      dolfinx::MPI::compute_graph_edges(
+          comm, std::set<int>(owners.begin(), owners.end())),
+      ghosts, owners);
+}
+//-----------------------------------------------------------------------------
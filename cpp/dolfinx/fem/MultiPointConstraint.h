@@ -0,0 +1,574 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include "DofMap.h"
+#include "Form.h"
+#include "FunctionSpace.h"
+#include <algorithm>
+#include <array>
+#include <complex>
+#include <cstdint>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/MPI.h>
+#include <dolfinx/graph/AdjacencyList.h>
+#include <dolfinx/la/SparsityPattern.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <memory>
+#include <mpi.h>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <xtl/xspan.hpp>
+
+namespace dolfinx::fem
+{
+
+/// Create the index map of a function space extended with the master
+/// degrees-of-freedom of multipoint constraints that are not owned or
+/// ghosted by the calling process
+/// @note Collective
+/// @param[in] comm The MPI communicator of the index map
+/// @param[in] map The (block) index map of the function space
+/// @param[in] masters Global block indices of the masters. Indices that
+/// are already in @p map are ignored.
+/// @return The extended index map, which has the same owned indices
+/// and the ghosts of @p map followed by the new ghosts. If no process
+/// has new ghosts @p map is returned.
+std::shared_ptr<const common::IndexMap>
+extend_index_map(MPI_Comm comm, std::shared_ptr<const common::IndexMap> map,
+                 const xtl::span<const std::int64_t>& masters);
+
+template <typename T>
+class MultiPointConstraint;
+
+/// @cond
+namespace impl
+{
+/// Insertion function that applies a multipoint constraint to element
+/// matrices, see MultiPointConstraint::mat_add_fn
+template <typename T, typename U>
+class ConstrainedMatAdd
+{
+public:
+  ConstrainedMatAdd(const MultiPointConstraint<T>& mpc, const U& mat_add,
+                    std::vector<bool> bc0, std::vector<bool> bc1)
+      : _mpc(mpc), _mat_add(mat_add), _bc0(std::move(bc0)),
+        _bc1(std::move(bc1))
+  {
+  }
+
+  int operator()(std::int32_t m, const std::int32_t* rows, std::int32_t n,
+                 const std::int32_t* cols, const T* vals) const
+  {
+    // Unroll the blocked element dofs
+    const int bs = _mpc.index_map_bs();
+    _rows.resize(m * bs);
+    for (std::int32_t i = 0; i < m; ++i)
+      for (int k = 0; k < bs; ++k)
+        _rows[i * bs + k] = rows[i] * bs + k;
+    _cols.resize(n * bs);
+    for (std::int32_t j = 0; j < n; ++j)
+      for (int k = 0; k < bs; ++k)
+        _cols[j * bs + k] = cols[j] * bs + k;
+
+    // Unconstrained element matrices are passed on unchanged
+    auto is_slave = [&slaves = _mpc.slave_index()](std::int32_t dof)
+    { return slaves[dof] >= 0; };
+    if (std::none_of(_rows.begin(), _rows.end(), is_slave)
+        and std::none_of(_cols.begin(), _cols.end(), is_slave))
+    {
+      return _mat_add(_rows.size(), _rows.data(), _cols.size(), _cols.data(),
+                      vals);
+    }
+
+    // Replace the slaves by their masters. The rows are weighted by the
+    // conjugate of the coefficients, i.e. the element matrix A is
+    // replaced by C^H A C.
+    expand(_rows, _bc0, true, _dofs0, _weights0, _pos0);
+    expand(_cols, _bc1, false, _dofs1, _weights1, _pos1);
+    const std::size_t num_cols = _cols.size();
+    _Ae.resize(_dofs0.size() * _dofs1.size());
+    for (std::size_t i = 0; i < _dofs0.size(); ++i)
+    {
+      const T* row = vals + _pos0[i] * num_cols;
+      for (std::size_t j = 0; j < _dofs1.size(); ++j)
+      {
+        _Ae[i * _dofs1.size() + j]
+            = _weights0[i] * _weights1[j] * row[_pos1[j]];
+      }
+    }
+
+    return _mat_add(_dofs0.size(), _dofs0.data(), _dofs1.size(),
+                    _dofs1.data(), _Ae.data());
+  }
+
+private:
+  // Compute the dofs, weights and positions in the element matrix of
+  // the constrained element dofs. Contributions to master dofs with a
+  // Dirichlet condition are dropped.
+  void expand(const std::vector<std::int32_t>& element_dofs,
+              const std::vector<bool>& bc, bool conjugate,
+              std::vector<std::int32_t>& dofs, std::vector<T>& weights,
+              std::vector<std::int32_t>& pos) const
+  {
+    dofs.clear();
+    weights.clear();
+    pos.clear();
+    const std::vector<std::int32_t>& slave_index = _mpc.slave_index();
+    const graph::AdjacencyList<std::int32_t>& masters = _mpc.masters();
+    const std::vector<T>& coefficients = _mpc.coefficients();
+    for (std::size_t a = 0; a < element_dofs.size(); ++a)
+    {
+      const std::int32_t s = slave_index[element_dofs[a]];
+      if (s < 0)
+      {
+        dofs.push_back(element_dofs[a]);
+        weights.push_back(1);
+        pos.push_back(a);
+        continue;
+      }
+
+      for (std::int32_t k = masters.offsets()[s];
+           k < masters.offsets()[s + 1]; ++k)
+      {
+        const std::int32_t master = masters.array()[k];
+        if (master < (std::int32_t)bc.size() and bc[master])
+          continue;
+        T c = coefficients[k];
+        if constexpr (!std::is_floating_point_v<T>)
+          c = conjugate ? std::conj(c) : c;
+        dofs.push_back(master);
+        weights.push_back(c);
+        pos.push_back(a);
+      }
+    }
+  }
+
+  const MultiPointConstraint<T>& _mpc;
+  U _mat_add;
+  std::vector<bool> _bc0, _bc1;
+
+  // Work arrays
+  mutable std::vector<std::int32_t> _rows, _cols, _dofs0, _dofs1, _pos0,
+      _pos1;
+  mutable std::vector<T> _weights0, _weights1, _Ae;
+};
+} // namespace impl
+/// @endcond
+
+/// Multipoint constraints on the degrees-of-freedom of a function
+/// space, i.e. constraints of the form
+///
+///     u[s] = sum_k c_k u[m_k]
+///
+/// in which the value of a 'slave' degree-of-freedom `s` is a linear
+/// combination of 'master' degrees-of-freedom `m_k`, e.g. for periodic
+/// boundary conditions and tied contact. The constraints are imposed
+/// by eliminating the slaves, i.e. for the matrix C that maps the
+/// unconstrained degrees-of-freedom to all degrees-of-freedom, the
+/// system A x = b is replaced by C^H A C x = C^H b. The rows and
+/// columns of the slaves become zero, apart from a diagonal entry that
+/// is set by the assembler.
+///
+/// The masters may be owned by any process. The index map of the
+/// constraint, MultiPointConstraint::index_map, is the index map of
+/// the function space extended with the masters that are not on the
+/// process, and the matrices (see fem::create_sparsity_pattern) and
+/// vectors of the constrained system use it. The owned entries and the
+/// ghosts of the function space come first, so vectors of the
+/// constrained system and of the function space have the same local
+/// indices.
+///
+/// Typical usage is
+///
+///     fem::MultiPointConstraint<T> mpc(V, slaves, masters, coeffs);
+///     la::SparsityPattern p = fem::create_sparsity_pattern(*a, mpc);
+///     ...
+///     fem::assemble_matrix(mat_add, *a, mpc, bcs);
+///     fem::assemble_vector(b, *L);
+///     mpc.apply_transpose(b);
+///     ... (reverse scatter of b, solve, forward scatter of x)
+///     mpc.backsubstitution(x);
+template <typename T>
+class MultiPointConstraint
+{
+public:
+  /// Create multipoint constraints
+  /// @note Collective
+  /// @param[in] V The function space
+  /// @param[in] slaves The slaves (local indices, unrolled). The
+  /// slaves must be owned by the calling process. The constraints of
+  /// slaves that are ghosts on other processes are sent to these
+  /// processes.
+  /// @param[in] masters The masters of each slave (global indices,
+  /// unrolled). A master must not be a slave.
+  /// @param[in] coefficients The coefficients of the masters, with the
+  /// layout of `masters.array()`
+  MultiPointConstraint(std::shared_ptr<const FunctionSpace> V,
+                       const std::vector<std::int32_t>& slaves,
+                       const graph::AdjacencyList<std::int64_t>& masters,
+                       const std::vector<T>& coefficients)
+      : _function_space(V), _masters(0)
+  {
+    assert(V);
+    std::shared_ptr<const common::IndexMap> map = V->dofmap()->index_map;
+    assert(map);
+    _bs = V->dofmap()->index_map_bs();
+    const std::int32_t owned_size = _bs * map->size_local();
+    if ((std::int32_t)slaves.size() != masters.num_nodes())
+      throw std::runtime_error("Number of slaves and masters do not match.");
+    if (masters.array().size() != coefficients.size())
+    {
+      throw std::runtime_error(
+          "Number of masters and coefficients do not match.");
+    }
+
+    // Position of each owned slave in the input
+    std::vector<std::int32_t> owned_slave(owned_size, -1);
+    for (std::size_t i = 0; i < slaves.size(); ++i)
+    {
+      if (slaves[i] < 0 or slaves[i] >= owned_size)
+        throw std::runtime_error("Slave is not owned by this process.");
+      if (owned_slave[slaves[i]] >= 0)
+        throw std::runtime_error("Slave has more than one constraint.");
+      owned_slave[slaves[i]] = i;
+    }
+
+    // Pack the constraints of the owned slaves that are ghosts on
+    // other processes as (slave, number of masters, masters) and the
+    // coefficients
+    const std::array<std::int64_t, 2> range = map->local_range();
+    MPI_Comm comm = map->comm(common::IndexMap::Direction::forward);
+    const graph::AdjacencyList<std::int32_t>& shared = map->shared_indices();
+    std::vector<std::int64_t> send_dofs;
+    std::vector<T> send_coeffs;
+    std::vector<std::int32_t> offsets_dofs(1, 0), offsets_coeffs(1, 0);
+    for (std::int32_t p = 0; p < shared.num_nodes(); ++p)
+    {
+      for (std::int32_t block : shared.links(p))
+      {
+        for (int k = 0; k < _bs; ++k)
+        {
+          const std::int32_t i = owned_slave[block * _bs + k];
+          if (i < 0)
+            continue;
+          auto m = masters.links(i);
+          send_dofs.push_back(range[0] * _bs + block * _bs + k);
+          send_dofs.push_back(m.size());
+          send_dofs.insert(send_dofs.end(), m.begin(), m.end());
+          send_coeffs.insert(
+              send_coeffs.end(),
+              std::next(coefficients.begin(), masters.offsets()[i]),
+              std::next(coefficients.begin(), masters.offsets()[i + 1]));
+        }
+      }
+      offsets_dofs.push_back(send_dofs.size());
+      offsets_coeffs.push_back(send_coeffs.size());
+    }
+    const graph::AdjacencyList<std::int64_t> recv_dofs
+        = dolfinx::MPI::neighbor_all_to_all(
+            comm, graph::AdjacencyList<std::int64_t>(std::move(send_dofs),
+                                                     std::move(offsets_dofs)));
+    const graph::AdjacencyList<T> recv_coeffs
+        = dolfinx::MPI::neighbor_all_to_all(
+            comm, graph::AdjacencyList<T>(std::move(send_coeffs),
+                                          std::move(offsets_coeffs)));
+
+    // Collect the constraints of the owned and the ghost slaves, with
+    // global masters
+    _slaves = slaves;
+    _num_owned_slaves = slaves.size();
+    std::vector<std::int64_t> masters_global = masters.array();
+    std::vector<std::int32_t> offsets = masters.offsets();
+    _coefficients = coefficients;
+    const std::vector<std::int64_t>& data = recv_dofs.array();
+    std::vector<std::int64_t> ghost_blocks;
+    for (std::size_t pos = 0; pos < data.size();)
+    {
+      ghost_blocks.push_back(data[pos] / _bs);
+      _slaves.push_back(data[pos] % _bs);
+      const std::int64_t num_masters = data[pos + 1];
+      masters_global.insert(masters_global.end(),
+                            std::next(data.begin(), pos + 2),
+                            std::next(data.begin(), pos + 2 + num_masters));
+      offsets.push_back(masters_global.size());
+      pos += 2 + num_masters;
+    }
+    _coefficients.insert(_coefficients.end(), recv_coeffs.array().begin(),
+                         recv_coeffs.array().end());
+
+    std::vector<std::int32_t> ghost_local(ghost_blocks.size());
+    map->global_to_local(ghost_blocks, ghost_local);
+    for (std::size_t i = 0; i < ghost_local.size(); ++i)
+    {
+      assert(ghost_local[i] >= map->size_local());
+      _slaves[_num_owned_slaves + i] += ghost_local[i] * _bs;
+    }
+
+    // Extend the index map with the masters that are not on this
+    // process, and compute the local masters
+    std::vector<std::int64_t> master_blocks(masters_global.size());
+    std::transform(masters_global.begin(), masters_global.end(),
+                   master_blocks.begin(),
+                   [bs = _bs](auto m) { return m / bs; });
+    _index_map = extend_index_map(V->mesh()->mpi_comm(), map, master_blocks);
+    std::vector<std::int32_t> masters_local(master_blocks.size());
+    _index_map->global_to_local(master_blocks, masters_local);
+    for (std::size_t i = 0; i < masters_local.size(); ++i)
+    {
+      assert(masters_local[i] >= 0);
+      masters_local[i] = masters_local[i] * _bs + masters_global[i] % _bs;
+    }
+    _masters = graph::AdjacencyList<std::int32_t>(std::move(masters_local),
+                                                  std::move(offsets));
+
+    // Mark the slaves
+    const std::int32_t size
+        = _bs * (_index_map->size_local() + _index_map->num_ghosts());
+    _slave_index.assign(size, -1);
+    for (std::size_t i = 0; i < _slaves.size(); ++i)
+      _slave_index[_slaves[i]] = i;
+    for (std::int32_t m : _masters.array())
+    {
+      if (_slave_index[m] >= 0)
+        throw std::runtime_error("Master is constrained by another slave.");
+    }
+  }
+
+  /// Copy constructor
+  MultiPointConstraint(const MultiPointConstraint& mpc) = default;
+
+  /// Move constructor
+  MultiPointConstraint(MultiPointConstraint&& mpc) = default;
+
+  /// Destructor
+  ~MultiPointConstraint() = default;
+
+  /// Copy assignment
+  MultiPointConstraint& operator=(const MultiPointConstraint& mpc) = default;
+
+  /// Move assignment
+  MultiPointConstraint& operator=(MultiPointConstraint&& mpc) = default;
+
+  /// The function space of the constraint
+  /// @return The function space
+  std::shared_ptr<const FunctionSpace> function_space() const
+  {
+    return _function_space;
+  }
+
+  /// Index map of the constrained system, i.e. the index map of the
+  /// function space extended with the masters that are not on this
+  /// process
+  /// @return The index map
+  std::shared_ptr<const common::IndexMap> index_map() const
+  {
+    return _index_map;
+  }
+
+  /// Block size of the index map
+  /// @return The block size
+  int index_map_bs() const { return _bs; }
+
+  /// The slaves (local indices, unrolled). The first
+  /// MultiPointConstraint::num_owned_slaves slaves are owned and the
+  /// remaining slaves are ghosts.
+  /// @return The slaves
+  const std::vector<std::int32_t>& slaves() const { return _slaves; }
+
+  /// Number of slaves that are owned by this process
+  /// @return The number of owned slaves
+  std::int32_t num_owned_slaves() const { return _num_owned_slaves; }
+
+  /// The masters of each slave (local indices in
+  /// MultiPointConstraint::index_map, unrolled)
+  /// @return The masters
+  const graph::AdjacencyList<std::int32_t>& masters() const
+  {
+    return _masters;
+  }
+
+  /// The coefficients of the masters, with the layout of
+  /// `masters().array()`
+  /// @return The coefficients
+  const std::vector<T>& coefficients() const { return _coefficients; }
+
+  /// Position in MultiPointConstraint::slaves of each dof (unrolled),
+  /// or -1 if the dof is not a slave
+  /// @return The positions of the dofs
+  const std::vector<std::int32_t>& slave_index() const
+  {
+    return _slave_index;
+  }
+
+  /// Create a function for adding element matrices of a bilinear form
+  /// on MultiPointConstraint::function_space into a matrix of the
+  /// constrained system. The element rows and columns of slaves are
+  /// added to the rows and columns of their masters. The function is
+  /// not safe to call concurrently.
+  /// @param[in] mat_add The function for adding values into the matrix.
+  /// It is called with unrolled local indices in
+  /// MultiPointConstraint::index_map, e.g. la::PETScMatrix::set_fn.
+  /// @param[in] bc0 Dirichlet condition markers for the rows
+  /// (unrolled). Contributions to the rows of marked masters are
+  /// dropped.
+  /// @param[in] bc1 Dirichlet condition markers for the columns
+  /// @return The function for adding values, with the signature of the
+  /// insertion functions of fem::assemble_matrix (blocked indices)
+  template <typename U>
+  impl::ConstrainedMatAdd<T, U>
+  mat_add_fn(const U& mat_add, const std::vector<bool>& bc0 = {},
+             const std::vector<bool>& bc1 = {}) const
+  {
+    return impl::ConstrainedMatAdd<T, U>(*this, mat_add, bc0, bc1);
+  }
+
+  /// Apply the transpose of the constraint to a vector, i.e. add the
+  /// entries of the slaves, weighted by the conjugate coefficients, to
+  /// their masters and zero the entries of the slaves. This is applied
+  /// to an assembled vector before the ghost contributions are sent to
+  /// the owners (reverse scatter), and after the lifting of Dirichlet
+  /// conditions.
+  /// @param[in,out] b The vector, with the layout of
+  /// MultiPointConstraint::index_map
+  void apply_transpose(const xtl::span<T>& b) const
+  {
+    for (std::size_t i = 0; i < _slaves.size(); ++i)
+    {
+      const T bi = b[_slaves[i]];
+      for (std::int32_t k = _masters.offsets()[i];
+           k < _masters.offsets()[i + 1]; ++k)
+      {
+        T c = _coefficients[k];
+        if constexpr (!std::is_floating_point_v<T>)
+          c = std::conj(c);
+        b[_masters.array()[k]] += c * bi;
+      }
+      b[_slaves[i]] = 0;
+    }
+  }
+
+  /// Set the entries of the slaves of a vector from the entries of
+  /// their masters, i.e. compute the solution of the unconstrained
+  /// system from the solution of the constrained system
+  /// @param[in,out] x The vector, with the layout of
+  /// MultiPointConstraint::index_map. The ghost entries must be up to
+  /// date.
+  void backsubstitution(const xtl::span<T>& x) const
+  {
+    for (std::size_t i = 0; i < _slaves.size(); ++i)
+    {
+      T value = 0;
+      for (std::int32_t k = _masters.offsets()[i];
+           k < _masters.offsets()[i + 1]; ++k)
+      {
+        value += _coefficients[k] * x[_masters.array()[k]];
+      }
+      x[_slaves[i]] = value;
+    }
+  }
+
+private:
+  // The function space
+  std::shared_ptr<const FunctionSpace> _function_space;
+
+  // Index map of the constrained system and its block size
+  std::shared_ptr<const common::IndexMap> _index_map;
+  int _bs;
+
+  // Slaves (owned first), and the masters and coefficients of each
+  // slave
+  std::vector<std::int32_t> _slaves;
+  std::int32_t _num_owned_slaves;
+  graph::AdjacencyList<std::int32_t> _masters;
+  std::vector<T> _coefficients;
+
+  // Position of each dof in _slaves, or -1
+  std::vector<std::int32_t> _slave_index;
+};
+
+/// Create the sparsity pattern of a bilinear form with multipoint
+/// constraints, i.e. the pattern of C^H A C, see
+/// fem::MultiPointConstraint. The pattern has the index map of the
+/// constraint, and includes the diagonal entries of the slaves. The
+/// pattern is not finalised.
+/// @param[in] a The bilinear form. The test and trial spaces must be
+/// the function space of the constraint.
+/// @param[in] mpc The multipoint constraint
+/// @return The sparsity pattern
+template <typename T>
+la::SparsityPattern
+create_sparsity_pattern(const Form<T>& a, const MultiPointConstraint<T>& mpc)
+{
+  if (a.rank() != 2)
+  {
+    throw std::runtime_error(
+        "Cannot create sparsity pattern. Form is not a bilinear form");
+  }
+  if (!(*a.function_spaces().at(0) == *mpc.function_space())
+      or !(*a.function_spaces().at(1) == *mpc.function_space()))
+  {
+    throw std::runtime_error("Form is not defined on the function space of "
+                             "the multipoint constraint.");
+  }
+  if (a.num_integrals(IntegralType::interior_facet) > 0)
+  {
+    throw std::runtime_error("Interior facet integrals are not supported "
+                             "with multipoint constraints.");
+  }
+
+  std::shared_ptr<const mesh::Mesh> mesh = a.mesh();
+  assert(mesh);
+  const int bs = mpc.index_map_bs();
+  la::SparsityPattern pattern(mesh->mpi_comm(),
+                              {mpc.index_map(), mpc.index_map()}, {bs, bs});
+
+  // Insert the (blocked) dofs of each cell, with the slaves replaced by
+  // their masters
+  const graph::AdjacencyList<std::int32_t>& dofs
+      = mpc.function_space()->dofmap()->list();
+  const std::vector<std::int32_t>& slave_index = mpc.slave_index();
+  const graph::AdjacencyList<std::int32_t>& masters = mpc.masters();
+  std::vector<std::int32_t> cell_dofs;
+  for (std::int32_t c = 0; c < dofs.num_nodes(); ++c)
+  {
+    cell_dofs.clear();
+    for (std::int32_t block : dofs.links(c))
+    {
+      for (int k = 0; k < bs; ++k)
+      {
+        const std::int32_t s = slave_index[block * bs + k];
+        if (s < 0)
+          cell_dofs.push_back(block);
+        else
+        {
+          for (std::int32_t m : masters.links(s))
+            cell_dofs.push_back(m / bs);
+        }
+      }
+    }
+    std::sort(cell_dofs.begin(), cell_dofs.end());
+    cell_dofs.erase(std::unique(cell_dofs.begin(), cell_dofs.end()),
+                    cell_dofs.end());
+    pattern.insert(cell_dofs, cell_dofs);
+  }
+
+  // Diagonal entries of the owned slaves
+  std::vector<std::int32_t> slave_blocks;
+  for (std::int32_t i = 0; i < mpc.num_owned_slaves(); ++i)
+    slave_blocks.push_back(mpc.slaves()[i] / bs);
+  std::sort(slave_blocks.begin(), slave_blocks.end());
+  slave_blocks.erase(std::unique(slave_blocks.begin(), slave_blocks.end()),
+                     slave_blocks.end());
+  pattern.insert_diagonal(slave_blocks);
+
+  return pattern;
+}
+
+} // namespace dolfinx::fem
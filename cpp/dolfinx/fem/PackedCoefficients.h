@@ -0,0 +1,115 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include "Form.h"
+#include "Function.h"
+#include "utils.h"
+#include <algorithm>
+#include <cstdint>
+#include <dolfinx/common/array2d.h>
+#include <dolfinx/la/Vector.h>
+#include <memory>
+#include <vector>
+
+namespace dolfinx::fem
+{
+
+/// Packed coefficient data of a form that is updated incrementally.
+///
+/// The packed array is held between assemblies. On update, only the
+/// coefficients whose degree-of-freedom vector has changed since the
+/// last update are re-packed. Changes are detected using
+/// la::Vector::version, so coefficient values that are modified
+/// through a reference obtained before the last update must be
+/// signalled by calling la::Vector::increment_version, or by calling
+/// PackedCoefficients::mark_dirty.
+///
+/// Typical usage is
+///
+///     fem::PackedCoefficients<T> coeffs(L);
+///     for (...)
+///     {
+///       ...
+///       fem::assemble_vector(b, L, constants, coeffs.update());
+///     }
+template <typename T>
+class PackedCoefficients
+{
+public:
+  /// Create packed coefficient data for a form. The data is packed on
+  /// the first call to PackedCoefficients::update.
+  /// @param[in] form The form. It must outlive this object.
+  explicit PackedCoefficients(const Form<T>& form)
+      : _form(form), _versions(form.coefficients().size()),
+        _vectors(form.coefficients().size(), nullptr)
+  {
+    // Do nothing
+  }
+
+  /// Re-pack the coefficients that have changed since the last update
+  /// @return The packed coefficient data
+  const array2d<T>& update()
+  {
+    const std::vector<std::shared_ptr<const fem::Function<T>>> coefficients
+        = _form.coefficients();
+    if (!_packed)
+    {
+      _c = pack_coefficients(_form);
+      _packed = true;
+      for (std::size_t i = 0; i < coefficients.size(); ++i)
+      {
+        _vectors[i] = coefficients[i]->x().get();
+        _versions[i] = _vectors[i]->version();
+      }
+      return _c;
+    }
+
+    // Find coefficients with a new or modified vector
+    std::vector<int> dirty;
+    for (std::size_t i = 0; i < coefficients.size(); ++i)
+    {
+      const la::Vector<T>* x = coefficients[i]->x().get();
+      if (x != _vectors[i] or x->version() != _versions[i])
+      {
+        dirty.push_back(i);
+        _vectors[i] = x;
+        _versions[i] = x->version();
+      }
+    }
+
+    impl::pack_coefficients(_form, _c, dirty);
+    return _c;
+  }
+
+  /// Mark all coefficients for re-packing on the next update, e.g.
+  /// after the mesh or the degree-of-freedom maps have changed
+  void mark_dirty()
+  {
+    _packed = false;
+    std::fill(_vectors.begin(), _vectors.end(), nullptr);
+  }
+
+  /// Packed coefficient data from the last update
+  const array2d<T>& array() const { return _c; }
+
+private:
+  // The form
+  const Form<T>& _form;
+
+  // Packed coefficient data
+  array2d<T> _c = array2d<T>(0, 0);
+
+  // True if _c holds packed data
+  bool _packed = false;
+
+  // Vector and vector version of each coefficient at the last update
+  std::vector<std::uint64_t> _versions;
+  std::vector<const la::Vector<T>*> _vectors;
+};
+
+} // namespace dolfinx::fem
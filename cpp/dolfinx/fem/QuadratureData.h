@@ -0,0 +1,229 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include "Form.h"
+#include "Function.h"
+#include "utils.h"
+#include <algorithm>
+#include <cstdint>
+#include <dolfinx/common/array2d.h>
+#include <dolfinx/la/Vector.h>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include <xtl/xspan.hpp>
+
+namespace dolfinx::fem
+{
+
+/// Storage of a state at the quadrature points of each cell, e.g. the
+/// history variables of a plasticity or damage model, in the packed
+/// coefficient data of a form.
+///
+/// The state is a coefficient of the form, typically a Function in a
+/// quadrature element space, whose values are used to initialise the
+/// state. The state is then held in the columns of the coefficient in
+/// the packed coefficient array, which is laid out cell-major and
+/// passed to the assemblers as for PackedCoefficients. Kernels read the
+/// state of a cell from the coefficient array. The assemblers pass the
+/// coefficient data to kernels as `const`, so kernels cannot write the
+/// state. Instead, the state is modified in place between assemblies,
+/// through QuadratureData::state or QuadratureData::update_state (e.g.
+/// a return mapping at the quadrature points), without being packed
+/// again or scattered to ghosts. The other coefficients are re-packed
+/// on update when their degree-of-freedom vector has changed (see
+/// PackedCoefficients).
+///
+/// A copy of the state at the last accepted step is also held, so that
+/// a step can be accepted (QuadratureData::commit) or rejected
+/// (QuadratureData::revert).
+///
+/// Typical usage is
+///
+///     fem::QuadratureData<T> data(a, index);
+///     for (...)
+///     {
+///       fem::assemble_matrix(mat_add, a, constants, data.update(), bcs);
+///       ...
+///       data.update_state([](auto cell, auto state, auto w) { ... });
+///       data.commit();
+///     }
+template <typename T>
+class QuadratureData
+{
+public:
+  /// Create quadrature point storage for a coefficient of a form. The
+  /// data is packed on the first call to QuadratureData::update.
+  /// @param[in] form The form. It must outlive this object.
+  /// @param[in] index The index of the coefficient of the form that
+  /// holds the state
+  QuadratureData(const Form<T>& form, int index)
+      : _form(form), _index(index), _versions(form.coefficients().size()),
+        _vectors(form.coefficients().size(), nullptr)
+  {
+    const std::vector<std::shared_ptr<const fem::Function<T>>>& coefficients
+        = form.coefficients();
+    if (index < 0 or index >= (int)coefficients.size())
+      throw std::runtime_error("Invalid coefficient index.");
+    if (coefficients[index]
+            ->function_space()
+            ->element()
+            ->needs_dof_transformations())
+    {
+      throw std::runtime_error(
+          "Quadrature data must not need dof transformations.");
+    }
+
+    const std::vector<int> offsets = form.coefficient_offsets();
+    _offset = offsets[index];
+    _size = offsets[index + 1] - offsets[index];
+  }
+
+  /// Re-pack the coefficients, other than the state, that have changed
+  /// since the last update. On the first call, all coefficients are
+  /// packed and the state is initialised from its coefficient.
+  /// @return The packed coefficient data
+  const array2d<T>& update()
+  {
+    const std::vector<std::shared_ptr<const fem::Function<T>>> coefficients
+        = _form.coefficients();
+    if (!_packed)
+    {
+      _c = pack_coefficients(_form);
+      _previous = array2d<T>(_c.shape[0], _size);
+      _packed = true;
+      for (std::size_t i = 0; i < coefficients.size(); ++i)
+      {
+        _vectors[i] = coefficients[i]->x().get();
+        _versions[i] = _vectors[i]->version();
+      }
+      commit();
+      return _c;
+    }
+
+    // Find coefficients with a new or modified vector, excluding the
+    // state
+    std::vector<int> dirty;
+    for (std::size_t i = 0; i < coefficients.size(); ++i)
+    {
+      const la::Vector<T>* x = coefficients[i]->x().get();
+      if ((int)i != _index
+          and (x != _vectors[i] or x->version() != _versions[i]))
+      {
+        dirty.push_back(i);
+        _vectors[i] = x;
+        _versions[i] = x->version();
+      }
+    }
+
+    impl::pack_coefficients(_form, _c, dirty);
+    return _c;
+  }
+
+  /// The state on a cell, which can be modified in place.
+  /// QuadratureData::update must have been called.
+  /// @param[in] cell The cell index (local to process)
+  /// @return The state at the quadrature points of the cell, with the
+  /// layout of the dofs of the coefficient on the cell
+  xtl::span<T> state(std::int32_t cell)
+  {
+    assert(_packed);
+    return _c.row(cell).subspan(_offset, _size);
+  }
+
+  /// The state on a cell. QuadratureData::update must have been called.
+  /// @param[in] cell The cell index (local to process)
+  /// @return The state at the quadrature points of the cell
+  xtl::span<const T> state(std::int32_t cell) const
+  {
+    assert(_packed);
+    return _c.row(cell).subspan(_offset, _size);
+  }
+
+  /// Update the state on each cell from the packed coefficient data,
+  /// e.g. with a constitutive model at the quadrature points.
+  /// QuadratureData::update must have been called.
+  /// @param[in] f The function that is called for each cell `c` as
+  /// `f(c, state, w)`, where `state` (`xtl::span<T>`) is the state on
+  /// the cell, which `f` may modify, and `w` (`xtl::span<const T>`) is
+  /// the coefficient data of the cell, including the state
+  template <typename F>
+  void update_state(F&& f)
+  {
+    assert(_packed);
+    for (std::size_t c = 0; c < _c.shape[0]; ++c)
+    {
+      xtl::span<T> w = _c.row(c);
+      f(std::int32_t(c), w.subspan(_offset, _size), xtl::span<const T>(w));
+    }
+  }
+
+  /// The state on a cell at the last accepted step
+  /// @param[in] cell The cell index (local to process)
+  /// @return The state at the quadrature points of the cell
+  xtl::span<const T> previous(std::int32_t cell) const
+  {
+    assert(_packed);
+    return _previous.row(cell);
+  }
+
+  /// Accept the current state, which becomes the state at the last
+  /// accepted step
+  void commit()
+  {
+    assert(_packed);
+    for (std::size_t c = 0; c < _c.shape[0]; ++c)
+    {
+      xtl::span<const T> s = _c.row(c).subspan(_offset, _size);
+      std::copy(s.begin(), s.end(), _previous.row(c).begin());
+    }
+  }
+
+  /// Reject the current state, and restore the state at the last
+  /// accepted step
+  void revert()
+  {
+    assert(_packed);
+    for (std::size_t c = 0; c < _c.shape[0]; ++c)
+    {
+      xtl::span<const T> s = _previous.row(c);
+      std::copy(s.begin(), s.end(), _c.row(c).subspan(_offset).begin());
+    }
+  }
+
+  /// Offset of the state in the coefficient data of a cell
+  std::size_t offset() const { return _offset; }
+
+  /// Size of the state on a cell
+  std::size_t size() const { return _size; }
+
+  /// Packed coefficient data from the last update
+  const array2d<T>& array() const { return _c; }
+
+private:
+  // The form
+  const Form<T>& _form;
+
+  // Index of the state coefficient, and its offset and size in the
+  // coefficient data of a cell
+  int _index;
+  std::size_t _offset, _size;
+
+  // Packed coefficient data, and the state at the last accepted step
+  array2d<T> _c = array2d<T>(0, 0);
+  array2d<T> _previous = array2d<T>(0, 0);
+
+  // True if _c holds packed data
+  bool _packed = false;
+
+  // Vector and vector version of each coefficient at the last update
+  std::vector<std::uint64_t> _versions;
+  std::vector<const la::Vector<T>*> _vectors;
+};
+
+} // namespace dolfinx::fem
@@ -0,0 +1,125 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "StaticCondensation.h"
+#include <algorithm>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/MPI.h>
+#include <dolfinx/graph/AdjacencyList.h>
+#include <set>
+
+using namespace dolfinx;
+
+//-----------------------------------------------------------------------------
+std::vector<int> fem::condensed_element_dofs(const ElementDofLayout& layout,
+                                             int tdim)
+{
+  const std::vector<int> interior = layout.entity_dofs(tdim, 0);
+  std::vector<int> dofs;
+  for (int j = 0; j < layout.num_dofs(); ++j)
+  {
+    if (std::find(interior.begin(), interior.end(), j) == interior.end())
+      dofs.push_back(j);
+  }
+  return dofs;
+}
+//-----------------------------------------------------------------------------
+fem::DofMap fem::create_condensed_dofmap(MPI_Comm comm, const DofMap& dofmap,
+                                         int tdim)
+{
+  const ElementDofLayout& layout = *dofmap.element_dof_layout;
+  const std::vector<int> kept = condensed_element_dofs(layout, tdim);
+
+  // Layout of the condensed element, with the kept dofs numbered in
+  // order and no dofs on the cell interior
+  std::vector<int> old_to_new_local(layout.num_dofs(), -1);
+  for (std::size_t k = 0; k < kept.size(); ++k)
+    old_to_new_local[kept[k]] = k;
+  auto renumber = [&](const std::vector<std::vector<std::set<int>>>& dofs)
+  {
+    std::vector<std::vector<std::set<int>>> new_dofs(dofs.size());
+    for (std::size_t d = 0; d < dofs.size(); ++d)
+    {
+      for (const std::set<int>& e : dofs[d])
+      {
+        std::set<int>& new_e = new_dofs[d].emplace_back();
+        for (int j : e)
+          if (old_to_new_local[j] >= 0)
+            new_e.insert(old_to_new_local[j]);
+      }
+    }
+    return new_dofs;
+  };
+  auto element_dof_layout = std::make_shared<ElementDofLayout>(
+      layout.block_size(), renumber(layout.entity_dofs_all()),
+      renumber(layout.entity_closure_dofs_all()), std::vector<int>(),
+      std::vector<std::shared_ptr<const ElementDofLayout>>());
+
+  // Cell dofs of the condensed dofmap, in the parent numbering
+  const graph::AdjacencyList<std::int32_t>& list = dofmap.list();
+  const std::int32_t num_cells = list.num_nodes();
+  std::vector<std::int32_t> cell_dofs(num_cells * kept.size());
+  for (std::int32_t c = 0; c < num_cells; ++c)
+  {
+    auto dofs = list.links(c);
+    for (std::size_t k = 0; k < kept.size(); ++k)
+      cell_dofs[c * kept.size() + k] = dofs[kept[k]];
+  }
+
+  // Number the kept owned dofs in the order of the parent
+  const common::IndexMap& map = *dofmap.index_map;
+  const std::int32_t size_local = map.size_local();
+  const std::int32_t num_ghosts = map.num_ghosts();
+  std::vector<std::int32_t> old_to_new(size_local + num_ghosts, -1);
+  for (std::int32_t dof : cell_dofs)
+    old_to_new[dof] = 0;
+  std::int32_t num_owned = 0;
+  for (std::int32_t i = 0; i < size_local; ++i)
+    if (old_to_new[i] == 0)
+      old_to_new[i] = num_owned++;
+
+  // Send the new global indices of owned dofs to the processes that
+  // ghost them
+  const std::int64_t process_offset
+      = dolfinx::MPI::global_offset(comm, num_owned, true);
+  std::vector<std::int64_t> global_index(size_local, -1);
+  for (std::int32_t i = 0; i < size_local; ++i)
+    if (old_to_new[i] >= 0)
+      global_index[i] = old_to_new[i] + process_offset;
+  std::vector<std::int64_t> global_index_remote(num_ghosts);
+  map.scatter_fwd(xtl::span<const std::int64_t>(global_index),
+                  xtl::span<std::int64_t>(global_index_remote), 1);
+
+  // Kept ghosts, in the order of the parent
+  const std::vector<int> ghost_owners_old = map.ghost_owner_rank();
+  std::vector<std::int64_t> ghosts;
+  std::vector<int> ghost_owners;
+  for (std::int32_t i = 0; i < num_ghosts; ++i)
+  {
+    if (old_to_new[size_local + i] == 0)
+    {
+      assert(global_index_remote[i] >= 0);
+      old_to_new[size_local + i] = num_owned + ghosts.size();
+      ghosts.push_back(global_index_remote[i]);
+      ghost_owners.push_back(ghost_owners_old[i]);
+    }
+  }
+
+  auto index_map = std::make_shared<common::IndexMap>(
+      comm, num_owned,
+      dolfinx::MPI::compute_graph_edges(
+          comm, std::set<int>(ghost_owners.begin(), ghost_owners.end())),
+      ghosts, ghost_owners);
+
+  std::transform(cell_dofs.begin(), cell_dofs.end(), cell_dofs.begin(),
+                 [&old_to_new](auto dof) { return old_to_new[dof]; });
+  const int degree = kept.size();
+  return DofMap(
+      element_dof_layout, index_map, dofmap.index_map_bs(),
+      graph::AdjacencyList<std::int32_t>(std::move(cell_dofs), degree),
+      dofmap.bs());
+}
+//-----------------------------------------------------------------------------
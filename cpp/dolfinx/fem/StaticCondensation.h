@@ -0,0 +1,421 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include "DirichletBC.h"
+#include "DofMap.h"
+#include "ElementDofLayout.h"
+#include "Form.h"
+#include "FunctionSpace.h"
+#include "utils.h"
+#include <algorithm>
+#include <cstdint>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/math.h>
+#include <dolfinx/la/SparsityPattern.h>
+#include <dolfinx/mesh/Geometry.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <memory>
+#include <mpi.h>
+#include <stdexcept>
+#include <vector>
+#include <xtl/xspan.hpp>
+
+namespace dolfinx::fem
+{
+
+/// Compute the local (blocked) dofs of an element that are not
+/// associated with the interior of the cell
+/// @param[in] layout The element dof layout
+/// @param[in] tdim The topological dimension of the cell
+/// @return The local dofs, in increasing order
+std::vector<int> condensed_element_dofs(const ElementDofLayout& layout,
+                                        int tdim);
+
+/// Create the dofmap of the dofs of a dofmap that are not associated
+/// with the interior of cells. The dofs are numbered in the order of
+/// the parent dofmap, and the cell dofs are the parent cell dofs at
+/// the local dofs fem::condensed_element_dofs.
+/// @param[in] comm MPI communicator
+/// @param[in] dofmap The parent dofmap
+/// @param[in] tdim The topological dimension of the cells
+/// @return The condensed dofmap
+/// @note Collective MPI operation
+DofMap create_condensed_dofmap(MPI_Comm comm, const DofMap& dofmap, int tdim);
+
+/// Assembly of a linear system with the cell-interior dofs eliminated
+/// (static condensation).
+///
+/// The element matrix of each cell is split into the blocks of the
+/// interior (i) and other (b) dofs of the cell, and the Schur
+/// complement system
+///
+///     (A_bb - A_bi A_ii^{-1} A_ib) x_b = b_b - A_bi A_ii^{-1} b_i
+///
+/// is assembled on a dofmap without the interior dofs (see
+/// fem::create_condensed_dofmap). Interior dofs couple only to the dofs
+/// of their cell, so the interior values are recovered cell by cell
+/// after the solve:
+///
+///     x_i = A_ii^{-1} (b_i - A_ib x_b).
+///
+/// For high-order elements most dofs are interior, so the condensed
+/// system has far fewer rows and nonzeros.
+///
+/// Typical usage, with a la::MatrixCSR `A` and la::Vector `b` and `x`
+/// on the condensed dofmap is
+///
+///     fem::StaticCondensation<T> sc(a, L);
+///     la::SparsityPattern p = sc.create_sparsity_pattern();
+///     p.assemble();
+///     ...
+///     sc.assemble(la::MatrixCSR<T>::mat_add_values(A), b.mutable_array(),
+///                 bcs);
+///     A.finalize();
+///     b.scatter_rev(common::IndexMap::Mode::add);
+///     ... solve A x = b and update the ghosts of x ...
+///     sc.recover(x.array(), u->x()->mutable_array());
+///
+/// @note Only cell integrals are supported, and both arguments of `a`
+/// and the argument of `L` must be in the same function space. The
+/// element matrix blocks A_ii must be invertible.
+template <typename T>
+class StaticCondensation
+{
+public:
+  /// Create a condensation of the forms a and L
+  /// @param[in] a The bilinear form
+  /// @param[in] L The linear form
+  /// @note Collective MPI operation
+  StaticCondensation(const std::shared_ptr<const Form<T>>& a,
+                     const std::shared_ptr<const Form<T>>& L)
+      : _a(a), _L(L)
+  {
+    assert(_a);
+    assert(_L);
+    if (_a->rank() != 2 or _L->rank() != 1)
+      throw std::runtime_error("Require a bilinear and a linear form.");
+    _V = _a->function_spaces().at(0);
+    if (_a->function_spaces().at(1) != _V or _L->function_spaces().at(0) != _V)
+    {
+      throw std::runtime_error(
+          "Static condensation requires the same space for all arguments.");
+    }
+
+    for (const Form<T>* form : {_a.get(), _L.get()})
+    {
+      for (auto type : {IntegralType::exterior_facet,
+                        IntegralType::interior_facet, IntegralType::vertex})
+      {
+        if (form->num_integrals(type) > 0)
+        {
+          throw std::runtime_error(
+              "Static condensation supports cell integrals only.");
+        }
+      }
+    }
+
+    std::shared_ptr<const mesh::Mesh> mesh = _V->mesh();
+    assert(mesh);
+    const int tdim = mesh->topology().dim();
+    const DofMap& dofmap = *_V->dofmap();
+    _dofmap = std::make_shared<DofMap>(
+        create_condensed_dofmap(mesh->mpi_comm(), dofmap, tdim));
+
+    // Local unrolled dofs of the interior and the other dofs of the
+    // element. The latter are in the order of the condensed element.
+    const int bs = dofmap.bs();
+    const std::vector<int> kept
+        = condensed_element_dofs(*dofmap.element_dof_layout, tdim);
+    for (int j = 0; j < dofmap.element_dof_layout->num_dofs(); ++j)
+    {
+      const bool interior
+          = std::find(kept.begin(), kept.end(), j) == kept.end();
+      for (int k = 0; k < bs; ++k)
+        (interior ? _interior : _boundary).push_back(bs * j + k);
+    }
+
+    // Cells of each integral (sorted), and of all integrals
+    for (const Form<T>* form : {_a.get(), _L.get()})
+    {
+      auto& domains = form == _a.get() ? _domains_a : _domains_L;
+      for (int i : form->integral_ids(IntegralType::cell))
+      {
+        std::vector<std::int32_t> cells = form->domains(IntegralType::cell, i);
+        std::sort(cells.begin(), cells.end());
+        _cells.insert(_cells.end(), cells.begin(), cells.end());
+        domains.push_back({i, std::move(cells)});
+      }
+    }
+    std::sort(_cells.begin(), _cells.end());
+    _cells.erase(std::unique(_cells.begin(), _cells.end()), _cells.end());
+  }
+
+  /// The dofmap of the condensed system
+  std::shared_ptr<const DofMap> dofmap() const { return _dofmap; }
+
+  /// Create the sparsity pattern of the condensed system. The pattern
+  /// is not finalised (see la::SparsityPattern::assemble).
+  la::SparsityPattern create_sparsity_pattern() const
+  {
+    std::shared_ptr<const mesh::Mesh> mesh = _V->mesh();
+    return fem::create_sparsity_pattern(mesh->topology(),
+                                        {{*_dofmap, *_dofmap}},
+                                        {IntegralType::cell});
+  }
+
+  /// Assemble the condensed system. The element matrices and vectors
+  /// are computed from the current coefficients and constants of the
+  /// forms, and the data for the recovery of the interior dofs (see
+  /// StaticCondensation::recover) is stored.
+  ///
+  /// Boundary conditions are applied to the condensed element systems:
+  /// the columns of boundary condition dofs are moved to the
+  /// right-hand side, the rows and columns are zeroed, and the diagonal
+  /// entry and right-hand side entry of each owned boundary condition
+  /// dof are set to one and the boundary value.
+  /// @param[in] mat_add The function for adding values into the
+  /// condensed matrix (using the blocked dofs of
+  /// StaticCondensation::dofmap). See fem::assemble_matrix.
+  /// @param[in,out] b The array of the condensed vector (including
+  /// ghosts) to add to
+  /// @param[in] bcs Boundary conditions on the space of the forms
+  /// @note Boundary conditions must not be applied to interior dofs
+  template <typename U>
+  void assemble(const U& mat_add, xtl::span<T> b,
+                const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs)
+  {
+    const DofMap& dofmap = *_V->dofmap();
+    const int bs = dofmap.bs();
+    const std::size_t ni = _interior.size();
+    const std::size_t nb = _boundary.size();
+    const std::size_t n = ni + nb;
+
+    // Boundary condition markers and values in the parent numbering
+    std::vector<bool> bc_marker;
+    std::vector<T> bc_value;
+    for (auto& bc : bcs)
+    {
+      assert(bc);
+      if (_V->contains(*bc->function_space()))
+      {
+        std::shared_ptr<const common::IndexMap> map = dofmap.index_map;
+        const std::size_t size = dofmap.index_map_bs()
+                                 * (map->size_local() + map->num_ghosts());
+        bc_marker.resize(size, false);
+        bc_value.resize(size, 0);
+        bc->mark_dofs(bc_marker);
+        bc->set(xtl::span<T>(bc_value));
+      }
+    }
+
+    const std::vector<T> constants_a = pack_constants(*_a);
+    const std::vector<T> constants_L = pack_constants(*_L);
+    const array2d<T> coeffs_a = pack_coefficients(*_a);
+    const array2d<T> coeffs_L = pack_coefficients(*_L);
+    const xtl::span<const std::uint32_t> cell_info = impl::get_cell_info(*_a);
+
+    std::shared_ptr<const FiniteElement> element = _V->element();
+    const bool transform = element->needs_dof_transformations();
+    const auto apply_dof_transformation
+        = element->get_dof_transformation_function<T>();
+    const auto apply_dof_transformation_to_transpose
+        = element->get_dof_transformation_to_transpose_function<T>();
+
+    const mesh::Geometry& geometry = _V->mesh()->geometry();
+    std::vector<double> coordinate_dofs(3 * geometry.dofmap().num_links(0));
+
+    std::vector<T> Ae(n * n), be(n), Aii(ni * ni), S(nb * nb), g(nb);
+    _X.resize(_cells.size() * ni * (nb + 1));
+    const xtl::span<T> _Ae(Ae), _be(be);
+    std::vector<std::int32_t> bc_dofs;
+    std::vector<T> bc_dof_values;
+    for (std::size_t s = 0; s < _cells.size(); ++s)
+    {
+      const std::int32_t c = _cells[s];
+
+      // Compute the element matrix and vector
+      geometry.cell_coordinates(c, coordinate_dofs);
+      std::fill(Ae.begin(), Ae.end(), 0);
+      std::fill(be.begin(), be.end(), 0);
+      for (auto& [i, cells] : _domains_a)
+      {
+        if (std::binary_search(cells.begin(), cells.end(), c))
+        {
+          _a->kernel(IntegralType::cell, i)(
+              Ae.data(), coeffs_a.row(c).data(), constants_a.data(),
+              coordinate_dofs.data(), nullptr, nullptr);
+        }
+      }
+      for (auto& [i, cells] : _domains_L)
+      {
+        if (std::binary_search(cells.begin(), cells.end(), c))
+        {
+          _L->kernel(IntegralType::cell, i)(
+              be.data(), coeffs_L.row(c).data(), constants_L.data(),
+              coordinate_dofs.data(), nullptr, nullptr);
+        }
+      }
+
+      if (transform and (cell_info.empty() or cell_info[c] != 0))
+      {
+        apply_dof_transformation(_Ae, cell_info, c, n);
+        apply_dof_transformation_to_transpose(_Ae, cell_info, c, n);
+        apply_dof_transformation(_be, cell_info, c, 1);
+      }
+
+      // X = A_ii^{-1} [A_ib | b_i]
+      T* X = _X.data() + s * ni * (nb + 1);
+      for (std::size_t i = 0; i < ni; ++i)
+      {
+        for (std::size_t j = 0; j < ni; ++j)
+          Aii[i * ni + j] = Ae[_interior[i] * n + _interior[j]];
+        for (std::size_t j = 0; j < nb; ++j)
+          X[i * (nb + 1) + j] = Ae[_interior[i] * n + _boundary[j]];
+        X[i * (nb + 1) + nb] = be[_interior[i]];
+      }
+      if (!math::lu_solve(ni, nb + 1, Aii.data(), X))
+      {
+        throw std::runtime_error(
+            "Interior block of element matrix is singular.");
+      }
+
+      // S = A_bb - A_bi X_ib and g = b_b - A_bi X_i
+      for (std::size_t i = 0; i < nb; ++i)
+      {
+        const T* A_bi = Ae.data() + _boundary[i] * n;
+        for (std::size_t j = 0; j < nb; ++j)
+        {
+          T sum = Ae[_boundary[i] * n + _boundary[j]];
+          for (std::size_t k = 0; k < ni; ++k)
+            sum -= A_bi[_interior[k]] * X[k * (nb + 1) + j];
+          S[i * nb + j] = sum;
+        }
+        T sum = be[_boundary[i]];
+        for (std::size_t k = 0; k < ni; ++k)
+          sum -= A_bi[_interior[k]] * X[k * (nb + 1) + nb];
+        g[i] = sum;
+      }
+
+      // Apply boundary conditions and add to the condensed system
+      auto dofs = dofmap.cell_dofs(c);
+      auto cdofs = _dofmap->cell_dofs(c);
+      if (!bc_marker.empty())
+      {
+        for (std::size_t j = 0; j < nb; ++j)
+        {
+          const std::int32_t dof
+              = bs * dofs[_boundary[j] / bs] + _boundary[j] % bs;
+          if (bc_marker[dof])
+          {
+            for (std::size_t i = 0; i < nb; ++i)
+            {
+              g[i] -= S[i * nb + j] * bc_value[dof];
+              S[i * nb + j] = 0;
+              S[j * nb + i] = 0;
+            }
+            g[j] = 0;
+            bc_dofs.push_back(bs * cdofs[j / bs] + j % bs);
+            bc_dof_values.push_back(bc_value[dof]);
+          }
+        }
+      }
+
+      mat_add(cdofs.size(), cdofs.data(), cdofs.size(), cdofs.data(),
+              S.data());
+      for (std::size_t j = 0; j < nb; ++j)
+        b[bs * cdofs[j / bs] + j % bs] += g[j];
+    }
+
+    // Set the diagonal and right-hand side of owned boundary
+    // condition dofs
+    std::vector<std::pair<std::int32_t, T>> bc_data;
+    for (std::size_t k = 0; k < bc_dofs.size(); ++k)
+      bc_data.push_back({bc_dofs[k], bc_dof_values[k]});
+    std::sort(bc_data.begin(), bc_data.end(),
+              [](auto& x, auto& y) { return x.first < y.first; });
+    bc_data.erase(std::unique(bc_data.begin(), bc_data.end(),
+                              [](auto& x, auto& y)
+                              { return x.first == y.first; }),
+                  bc_data.end());
+    const std::int32_t num_owned = bs * _dofmap->index_map->size_local();
+    std::vector<T> one(bs * bs, 0);
+    for (auto [dof, value] : bc_data)
+    {
+      if (dof < num_owned)
+      {
+        const std::int32_t block = dof / bs;
+        one[(dof % bs) * bs + dof % bs] = 1;
+        mat_add(1, &block, 1, &block, one.data());
+        one[(dof % bs) * bs + dof % bs] = 0;
+        b[dof] = value;
+      }
+    }
+  }
+
+  /// Recover the solution on the parent dofmap from the solution of
+  /// the condensed system, using the data of the last
+  /// StaticCondensation::assemble
+  /// @param[in] x_c The solution of the condensed system, including
+  /// up-to-date ghost values
+  /// @param[out] x The array of the solution on the parent dofmap. The
+  /// dofs of the cells of the forms are set, the ghost values must be
+  /// updated by the caller.
+  void recover(const xtl::span<const T>& x_c, xtl::span<T> x) const
+  {
+    const std::size_t ni = _interior.size();
+    const std::size_t nb = _boundary.size();
+    if (_X.size() != _cells.size() * ni * (nb + 1))
+      throw std::runtime_error("The condensed system has not been assembled.");
+
+    const DofMap& dofmap = *_V->dofmap();
+    const int bs = dofmap.bs();
+    std::vector<T> xb(nb);
+    for (std::size_t s = 0; s < _cells.size(); ++s)
+    {
+      auto dofs = dofmap.cell_dofs(_cells[s]);
+      auto cdofs = _dofmap->cell_dofs(_cells[s]);
+      for (std::size_t j = 0; j < nb; ++j)
+      {
+        xb[j] = x_c[bs * cdofs[j / bs] + j % bs];
+        x[bs * dofs[_boundary[j] / bs] + _boundary[j] % bs] = xb[j];
+      }
+
+      const T* X = _X.data() + s * ni * (nb + 1);
+      for (std::size_t i = 0; i < ni; ++i)
+      {
+        T xi = X[i * (nb + 1) + nb];
+        for (std::size_t j = 0; j < nb; ++j)
+          xi -= X[i * (nb + 1) + j] * xb[j];
+        x[bs * dofs[_interior[i] / bs] + _interior[i] % bs] = xi;
+      }
+    }
+  }
+
+private:
+  // The forms and their function space
+  std::shared_ptr<const Form<T>> _a, _L;
+  std::shared_ptr<const FunctionSpace> _V;
+
+  // The condensed dofmap
+  std::shared_ptr<const DofMap> _dofmap;
+
+  // Local unrolled interior and other dofs of the element
+  std::vector<int> _interior, _boundary;
+
+  // (integral ID, sorted cells) of the cell integrals of a and L
+  std::vector<std::pair<int, std::vector<std::int32_t>>> _domains_a,
+      _domains_L;
+
+  // Cells of all integrals
+  std::vector<std::int32_t> _cells;
+
+  // A_ii^{-1} [A_ib | b_i] of each cell, row-major
+  std::vector<T> _X;
+};
+
+} // namespace dolfinx::fem
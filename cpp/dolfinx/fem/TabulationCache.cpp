@@ -0,0 +1,155 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "TabulationCache.h"
+#include "CoordinateElement.h"
+#include "FiniteElement.h"
+#include <algorithm>
+
+using namespace dolfinx;
+using namespace dolfinx::fem;
+
+namespace
+{
+// Combine a hash value with the hash of v
+template <typename U>
+void hash_combine(std::size_t& seed, const U& v)
+{
+  seed ^= std::hash<U>{}(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+} // namespace
+
+//-----------------------------------------------------------------------------
+TabulationCache::TabulationCache(std::size_t capacity) : _capacity(capacity)
+{
+  // Do nothing
+}
+//-----------------------------------------------------------------------------
+TabulationCache& TabulationCache::instance()
+{
+  static TabulationCache cache;
+  return cache;
+}
+//-----------------------------------------------------------------------------
+std::shared_ptr<const xt::xtensor<double, 4>>
+TabulationCache::tabulate(const FiniteElement& element,
+                          const xt::xtensor<double, 2>& X, int order)
+{
+  return get(element.hash(), X, order,
+             [&element, &X, order]()
+             {
+               xt::xtensor<double, 4> values;
+               element.tabulate(values, X, order);
+               return values;
+             });
+}
+//-----------------------------------------------------------------------------
+std::shared_ptr<const xt::xtensor<double, 4>>
+TabulationCache::tabulate(const CoordinateElement& cmap, int n,
+                          const xt::xtensor<double, 2>& X)
+{
+  return get(cmap.hash(), X, n,
+             [&cmap, &X, n]() { return cmap.tabulate(n, X); });
+}
+//-----------------------------------------------------------------------------
+std::size_t TabulationCache::size() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _entries.size();
+}
+//-----------------------------------------------------------------------------
+std::size_t TabulationCache::capacity() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _capacity;
+}
+//-----------------------------------------------------------------------------
+void TabulationCache::set_capacity(std::size_t capacity)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _capacity = capacity;
+  trim();
+}
+//-----------------------------------------------------------------------------
+void TabulationCache::clear()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _index.clear();
+  _entries.clear();
+}
+//-----------------------------------------------------------------------------
+std::shared_ptr<const xt::xtensor<double, 4>>
+TabulationCache::get(std::size_t element_hash, const xt::xtensor<double, 2>& X,
+                     int order,
+                     const std::function<xt::xtensor<double, 4>()>& tabulate)
+{
+  std::size_t key = element_hash;
+  hash_combine(key, order);
+  hash_combine(key, X.shape(0));
+  hash_combine(key, X.shape(1));
+  for (double x : X)
+    hash_combine(key, x);
+
+  // Find the table and move it to the front of the list, checking that
+  // the points are equal in case of a hash collision. The mutex must be
+  // held.
+  auto find = [&]() -> std::shared_ptr<const xt::xtensor<double, 4>>
+  {
+    auto [first, last] = _index.equal_range(key);
+    for (auto it = first; it != last; ++it)
+    {
+      const Entry& e = *it->second;
+      if (e.element_hash == element_hash and e.order == order
+          and e.X.shape() == X.shape()
+          and std::equal(e.X.begin(), e.X.end(), X.begin()))
+      {
+        _entries.splice(_entries.begin(), _entries, it->second);
+        return e.values;
+      }
+    }
+    return nullptr;
+  };
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (auto values = find(); values)
+      return values;
+  }
+
+  // Tabulate without holding the lock
+  auto values = std::make_shared<const xt::xtensor<double, 4>>(tabulate());
+
+  // Another thread may have added the table in the meantime
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (auto cached = find(); cached)
+    return cached;
+  if (_capacity == 0)
+    return values;
+
+  _entries.push_front({key, element_hash, order, X, values});
+  _index.emplace(key, _entries.begin());
+  trim();
+  return values;
+}
+//-----------------------------------------------------------------------------
+void TabulationCache::trim()
+{
+  while (_entries.size() > _capacity)
+  {
+    auto last = std::prev(_entries.end());
+    auto [first, end] = _index.equal_range(last->key);
+    for (auto it = first; it != end; ++it)
+    {
+      if (it->second == last)
+      {
+        _index.erase(it);
+        break;
+      }
+    }
+    _entries.pop_back();
+  }
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,126 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <xtensor/xtensor.hpp>
+
+namespace dolfinx::fem
+{
+class CoordinateElement;
+class FiniteElement;
+
+/// A least-recently-used cache of tabulated basis functions.
+///
+/// Tables are keyed by the element hash, the reference points and the
+/// derivative order, and are returned as shared immutable arrays, so
+/// that the same basis is not tabulated again when an element is
+/// tabulated repeatedly at the same points, e.g. at the interpolation
+/// points of an element. When the cache is full, the least recently
+/// used table is removed. Tables that have been removed from the cache
+/// remain valid while they are held by a caller.
+///
+/// The cache can be used from several threads.
+class TabulationCache
+{
+public:
+  /// Create a cache
+  /// @param[in] capacity The maximum number of tables held by the cache
+  explicit TabulationCache(std::size_t capacity = 64);
+
+  /// Copy constructor (deleted)
+  TabulationCache(const TabulationCache& cache) = delete;
+
+  /// Destructor
+  ~TabulationCache() = default;
+
+  /// Assignment operator (deleted)
+  TabulationCache& operator=(const TabulationCache& cache) = delete;
+
+  /// The cache that is shared by the library
+  /// @return The cache
+  static TabulationCache& instance();
+
+  /// Tabulate the basis functions of an element, or return the cached
+  /// table. See FiniteElement::tabulate.
+  /// @param[in] element The element
+  /// @param[in] X The reference points, with shape (number of points,
+  /// topological dimension)
+  /// @param[in] order The order of derivatives, up to and including, to
+  /// tabulate
+  /// @return The basis functions (and derivatives). The shape is
+  /// (derivative, number point, number of basis fn, value size).
+  std::shared_ptr<const xt::xtensor<double, 4>>
+  tabulate(const FiniteElement& element, const xt::xtensor<double, 2>& X,
+           int order);
+
+  /// Tabulate the basis functions of a coordinate element, or return
+  /// the cached table. See CoordinateElement::tabulate.
+  /// @param[in] cmap The coordinate element
+  /// @param[in] n The order of derivatives, up to and including, to
+  /// tabulate
+  /// @param[in] X The reference points, with shape (number of points,
+  /// topological dimension)
+  /// @return The basis functions (and derivatives). The shape is
+  /// (derivative, number point, number of basis fn, 1).
+  std::shared_ptr<const xt::xtensor<double, 4>>
+  tabulate(const CoordinateElement& cmap, int n,
+           const xt::xtensor<double, 2>& X);
+
+  /// Number of tables held by the cache
+  std::size_t size() const;
+
+  /// The maximum number of tables held by the cache
+  std::size_t capacity() const;
+
+  /// Set the maximum number of tables held by the cache. Least
+  /// recently used tables are removed if the cache holds more tables.
+  /// @param[in] capacity The maximum number of tables
+  void set_capacity(std::size_t capacity);
+
+  /// Remove all tables from the cache
+  void clear();
+
+private:
+  // Cached table
+  struct Entry
+  {
+    std::size_t key;
+    std::size_t element_hash;
+    int order;
+    xt::xtensor<double, 2> X;
+    std::shared_ptr<const xt::xtensor<double, 4>> values;
+  };
+
+  // Return the table for (element_hash, X, order), calling tabulate
+  // if it is not in the cache
+  std::shared_ptr<const xt::xtensor<double, 4>>
+  get(std::size_t element_hash, const xt::xtensor<double, 2>& X, int order,
+      const std::function<xt::xtensor<double, 4>()>& tabulate);
+
+  // Remove least recently used tables until the cache holds no more
+  // than _capacity tables. The mutex must be held.
+  void trim();
+
+  std::size_t _capacity;
+
+  // Tables, sorted from most to least recently used
+  std::list<Entry> _entries;
+
+  // Map from the hash of (element hash, points, order) to the tables
+  // with that hash
+  std::unordered_multimap<std::size_t, std::list<Entry>::iterator> _index;
+
+  mutable std::mutex _mutex;
+};
+
+} // namespace dolfinx::fem
@@ -0,0 +1,218 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "TensorProductOperator.h"
+#include "CoordinateElement.h"
+#include <cmath>
+#include <dolfinx/common/math.h>
+#include <dolfinx/mesh/Geometry.h>
+#include <tuple>
+#include <xtensor/xtensor.hpp>
+
+using namespace dolfinx;
+
+namespace
+{
+// Tolerance for matching the coordinates of interpolation points
+constexpr double tol = 1.0e-10;
+
+// Gauss-Legendre points (in increasing order) and weights on [0, 1]
+std::pair<std::vector<double>, std::vector<double>> gauss_legendre(int n)
+{
+  std::vector<double> x(n), w(n);
+  for (int i = 0; i < n; ++i)
+  {
+    // Newton iteration for the i-th root of the Legendre polynomial
+    // P_n on [-1, 1], from the Chebyshev-like initial guess
+    double t = std::cos(M_PI * (i + 0.75) / (n + 0.5));
+    double dp = 0.0;
+    for (int it = 0; it < 100; ++it)
+    {
+      double p0 = 1.0, p1 = t;
+      for (int k = 2; k <= n; ++k)
+      {
+        const double p2 = ((2 * k - 1) * t * p1 - (k - 1) * p0) / k;
+        p0 = p1;
+        p1 = p2;
+      }
+      if (n == 1)
+        p0 = 1.0;
+      dp = n * (t * p1 - p0) / (t * t - 1.0);
+      const double dt = p1 / dp;
+      t -= dt;
+      if (std::abs(dt) < 1e-15)
+        break;
+    }
+
+    x[i] = 0.5 * (1.0 - t);
+    w[i] = 1.0 / ((1.0 - t * t) * dp * dp);
+  }
+  return {std::move(x), std::move(w)};
+}
+} // namespace
+
+//-----------------------------------------------------------------------------
+fem::TensorProductBasis
+fem::create_tensor_product_basis(const FiniteElement& element, int tdim)
+{
+  if (element.block_size() != 1 or element.value_size() != 1)
+    throw std::runtime_error("Sum factorisation requires a scalar element.");
+
+  const xt::xtensor<double, 2>& X = element.interpolation_points();
+  const int num_dofs = element.space_dimension();
+  if ((int)X.shape(0) != num_dofs or (int)X.shape(1) != tdim)
+  {
+    throw std::runtime_error(
+        "Sum factorisation requires a Lagrange element.");
+  }
+
+  // 1D nodes
+  std::vector<double> nodes;
+  for (int i = 0; i < num_dofs; ++i)
+    nodes.push_back(X(i, 0));
+  std::sort(nodes.begin(), nodes.end());
+  nodes.erase(std::unique(nodes.begin(), nodes.end(),
+                          [](double a, double b)
+                          { return std::abs(a - b) < tol; }),
+              nodes.end());
+
+  TensorProductBasis basis;
+  const int n = nodes.size();
+  basis.n = n;
+  basis.nq = n;
+
+  // Lexicographic position of each dof
+  int size = 1;
+  for (int k = 0; k < tdim; ++k)
+    size *= n;
+  if (size != num_dofs)
+    throw std::runtime_error("Element is not a tensor-product element.");
+  std::vector<bool> used(num_dofs, false);
+  for (int i = 0; i < num_dofs; ++i)
+  {
+    std::int32_t pos = 0;
+    for (int k = 0; k < tdim; ++k)
+    {
+      auto it = std::find_if(nodes.begin(), nodes.end(), [x = X(i, k)](double y)
+                             { return std::abs(x - y) < tol; });
+      if (it == nodes.end())
+        throw std::runtime_error("Element is not a tensor-product element.");
+      pos = pos * n + std::distance(nodes.begin(), it);
+    }
+    if (used[pos])
+      throw std::runtime_error("Element is not a tensor-product element.");
+    used[pos] = true;
+    basis.dof_to_lex.push_back(pos);
+  }
+
+  // 1D Lagrange basis on the nodes, and its derivatives, at the
+  // quadrature points
+  std::tie(basis.points, basis.weights) = gauss_legendre(basis.nq);
+  const int nq = basis.nq;
+  basis.phi.resize(nq * n);
+  basis.dphi.resize(nq * n);
+  for (int q = 0; q < nq; ++q)
+  {
+    const double x = basis.points[q];
+    for (int j = 0; j < n; ++j)
+    {
+      double phi = 1.0, dphi = 0.0;
+      for (int m = 0; m < n; ++m)
+      {
+        if (m == j)
+          continue;
+        const double s = 1.0 / (nodes[j] - nodes[m]);
+        dphi = dphi * (x - nodes[m]) * s + phi * s;
+        phi *= (x - nodes[m]) * s;
+      }
+      basis.phi[q * n + j] = phi;
+      basis.dphi[q * n + j] = dphi;
+    }
+  }
+
+  basis.phiT.resize(n * nq);
+  basis.dphiT.resize(n * nq);
+  for (int q = 0; q < nq; ++q)
+  {
+    for (int j = 0; j < n; ++j)
+    {
+      basis.phiT[j * nq + q] = basis.phi[q * n + j];
+      basis.dphiT[j * nq + q] = basis.dphi[q * n + j];
+    }
+  }
+
+  return basis;
+}
+//-----------------------------------------------------------------------------
+std::vector<double>
+fem::compute_tensor_product_geometry(const mesh::Mesh& mesh,
+                                     const TensorProductBasis& basis,
+                                     std::int32_t num_cells)
+{
+  const mesh::Geometry& geometry = mesh.geometry();
+  const int tdim = mesh.topology().dim();
+  if (geometry.dim() != tdim)
+  {
+    throw std::runtime_error(
+        "Sum factorisation requires the geometric and topological "
+        "dimensions to be equal.");
+  }
+
+  // Quadrature points and weights in lexicographic order
+  const int nq = basis.nq;
+  int num_points = 1;
+  for (int k = 0; k < tdim; ++k)
+    num_points *= nq;
+  xt::xtensor<double, 2> Xq({std::size_t(num_points), std::size_t(tdim)});
+  std::vector<double> wq(num_points, 1.0);
+  for (int p = 0; p < num_points; ++p)
+  {
+    for (int k = tdim - 1, idx = p; k >= 0; --k, idx /= nq)
+    {
+      Xq(p, k) = basis.points[idx % nq];
+      wq[p] *= basis.weights[idx % nq];
+    }
+  }
+
+  const xt::xtensor<double, 4> phi = geometry.cmap().tabulate(1, Xq);
+  const std::size_t num_dofs_g = geometry.dofmap().num_links(0);
+  std::vector<double> coordinate_dofs(3 * num_dofs_g);
+
+  const int stride = tdim * tdim + 1;
+  std::vector<double> G(std::size_t(num_cells) * num_points * stride);
+  xt::xtensor<double, 2> J({std::size_t(tdim), std::size_t(tdim)});
+  xt::xtensor<double, 2> K({std::size_t(tdim), std::size_t(tdim)});
+  for (std::int32_t c = 0; c < num_cells; ++c)
+  {
+    geometry.cell_coordinates(c, coordinate_dofs);
+    for (int p = 0; p < num_points; ++p)
+    {
+      J.fill(0);
+      for (std::size_t a = 0; a < num_dofs_g; ++a)
+        for (int i = 0; i < tdim; ++i)
+          for (int j = 0; j < tdim; ++j)
+            J(i, j) += coordinate_dofs[3 * a + i] * phi(j + 1, p, a, 0);
+      const double s = wq[p] * std::abs(math::det(J));
+      math::inv(J, K);
+
+      double* Gp = G.data() + (std::size_t(c) * num_points + p) * stride;
+      for (int i = 0; i < tdim; ++i)
+      {
+        for (int j = 0; j < tdim; ++j)
+        {
+          double KKT = 0.0;
+          for (int k = 0; k < tdim; ++k)
+            KKT += K(i, k) * K(j, k);
+          Gp[i * tdim + j] = s * KKT;
+        }
+      }
+      Gp[tdim * tdim] = s;
+    }
+  }
+
+  return G;
+}
+//-----------------------------------------------------------------------------
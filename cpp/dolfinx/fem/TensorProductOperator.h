@@ -0,0 +1,382 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include "DirichletBC.h"
+#include "DofMap.h"
+#include "FiniteElement.h"
+#include "FunctionSpace.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/la/Vector.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace dolfinx::fem
+{
+
+/// One-dimensional data for sum factorisation on a tensor-product
+/// Lagrange element (quadrilateral or hexahedron) of degree `n - 1`,
+/// with an `nq`-point Gauss-Legendre rule in each direction.
+///
+/// The dofs of a cell are ordered lexicographically for sum
+/// factorisation: the dof with 1D indices `(i_0, ..., i_{d-1})`, where
+/// `i_k` is the index of its node in direction `X_k`, is at position
+/// `(i_0 * n + i_1) * n + ...`. The quadrature points are ordered in
+/// the same way.
+struct TensorProductBasis
+{
+  /// Number of 1D basis functions and quadrature points
+  int n, nq;
+
+  /// 1D quadrature points on [0, 1] and weights
+  std::vector<double> points, weights;
+
+  /// 1D basis functions and derivatives at the quadrature points,
+  /// `phi[q * n + j]`, and their transposes `phiT[j * nq + q]`
+  std::vector<double> phi, dphi, phiT, dphiT;
+
+  /// Lexicographic position of each dof of the element
+  std::vector<std::int32_t> dof_to_lex;
+};
+
+/// Create the 1D data for sum factorisation on a tensor-product
+/// Lagrange element. The 1D nodes are the distinct coordinates of the
+/// interpolation points of the element.
+/// @param[in] element The element, which must be a scalar Lagrange
+/// element on a quadrilateral or hexahedron
+/// @param[in] tdim The topological dimension of the cell
+/// @return The 1D data, with `nq = n` (exact mass matrices on affine
+/// cells)
+TensorProductBasis create_tensor_product_basis(const FiniteElement& element,
+                                               int tdim);
+
+/// Compute the geometry data of the cells for sum-factorised operators:
+/// for each cell and each quadrature point (in lexicographic order) the
+/// symmetric matrix `w |det J| J^{-1} J^{-T}` (row-major, tdim x tdim)
+/// followed by `w |det J|`, where `w` is the quadrature weight
+/// @param[in] mesh The mesh
+/// @param[in] basis The 1D data
+/// @param[in] num_cells The number of cells (from cell 0)
+/// @return The geometry data, `(tdim * tdim + 1) * nq^tdim` values per
+/// cell
+std::vector<double>
+compute_tensor_product_geometry(const mesh::Mesh& mesh,
+                                const TensorProductBasis& basis,
+                                std::int32_t num_cells);
+
+namespace impl
+{
+/// Apply the m x n matrix M along the middle axis of a tensor of shape
+/// (nleft, n, nright), giving a tensor of shape (nleft, m, nright)
+template <typename T, int m, int n>
+void contract(const double* M, const T* in, T* out, int nleft, int nright)
+{
+  for (int a = 0; a < nleft; ++a)
+  {
+    for (int i = 0; i < m; ++i)
+    {
+      T* out_i = out + (a * m + i) * nright;
+      for (int b = 0; b < nright; ++b)
+        out_i[b] = 0;
+      for (int j = 0; j < n; ++j)
+      {
+        const double Mij = M[i * n + j];
+        const T* in_j = in + (a * n + j) * nright;
+        for (int b = 0; b < nright; ++b)
+          out_i[b] += Mij * in_j[b];
+      }
+    }
+  }
+}
+
+/// Apply a 1D matrix (m x n) along each of the d axes of a tensor with
+/// n^d entries, using M1 on axis l and M on the other axes
+template <typename T, int d, int m, int n>
+void contract_all(const double* M, const double* M1, int l, const T* in,
+                  T* out, T* work)
+{
+  constexpr int size = []()
+  {
+    int s = 1;
+    for (int k = 0; k < d; ++k)
+      s *= std::max(m, n);
+    return s;
+  }();
+  static_assert(size > 0);
+
+  int nleft = 1, nright = 1;
+  for (int k = 1; k < d; ++k)
+    nright *= n;
+  const T* src = in;
+  for (int k = 0; k < d; ++k)
+  {
+    T* dst = k == d - 1 ? out : (k % 2 == 0 ? work : work + size);
+    contract<T, m, n>(k == l ? M1 : M, src, dst, nleft, nright);
+    src = dst;
+    nleft *= m;
+    if (k < d - 1)
+      nright /= n;
+  }
+}
+
+/// Compute y_e = A_e x_e for the element matrix A_e of the form
+/// kappa (grad u, grad v) + sigma (u, v) on one cell, by sum
+/// factorisation. The dofs are in lexicographic order.
+template <typename T, int d, int n, int nq>
+void apply_tensor_product(const TensorProductBasis& basis, const double* G,
+                          T kappa, T sigma, const T* xe, T* ye)
+{
+  constexpr int size = []()
+  {
+    int s = 1;
+    for (int k = 0; k < d; ++k)
+      s *= std::max(n, nq);
+    return s;
+  }();
+  constexpr int num_points = []()
+  {
+    int s = 1;
+    for (int k = 0; k < d; ++k)
+      s *= nq;
+    return s;
+  }();
+  constexpr int num_dofs = []()
+  {
+    int s = 1;
+    for (int k = 0; k < d; ++k)
+      s *= n;
+    return s;
+  }();
+
+  std::array<T, size> u;
+  std::array<std::array<T, size>, d> du;
+  std::array<T, 2 * size> work;
+  std::array<T, num_dofs> tmp;
+
+  // Values and reference gradients at the quadrature points
+  const double* phi = basis.phi.data();
+  const double* dphi = basis.dphi.data();
+  contract_all<T, d, nq, n>(phi, phi, -1, xe, u.data(), work.data());
+  for (int l = 0; l < d; ++l)
+    contract_all<T, d, nq, n>(phi, dphi, l, xe, du[l].data(), work.data());
+
+  // Apply the geometry and the coefficients at the quadrature points
+  for (int q = 0; q < num_points; ++q)
+  {
+    const double* Gq = G + q * (d * d + 1);
+    std::array<T, d> g;
+    for (int i = 0; i < d; ++i)
+    {
+      g[i] = 0;
+      for (int j = 0; j < d; ++j)
+        g[i] += Gq[i * d + j] * du[j][q];
+    }
+    for (int i = 0; i < d; ++i)
+      du[i][q] = kappa * g[i];
+    u[q] *= sigma * Gq[d * d];
+  }
+
+  // Integrate against the test functions
+  const double* phiT = basis.phiT.data();
+  const double* dphiT = basis.dphiT.data();
+  contract_all<T, d, n, nq>(phiT, phiT, -1, u.data(), ye, work.data());
+  for (int l = 0; l < d; ++l)
+  {
+    contract_all<T, d, n, nq>(phiT, dphiT, l, du[l].data(), tmp.data(),
+                              work.data());
+    for (int i = 0; i < num_dofs; ++i)
+      ye[i] += tmp[i];
+  }
+}
+} // namespace impl
+
+/// Matrix-free action of the bilinear form
+///
+///     a(u, v) = kappa (grad u, grad v) + sigma (u, v)
+///
+/// for scalar Lagrange spaces on quadrilateral and hexahedral meshes,
+/// by sum factorisation. The element action is computed from the 1D
+/// basis (see fem::TensorProductBasis) in O(p^{d+1}) operations per
+/// cell, rather than the O(p^{2d}) of the assembled element matrix,
+/// with the degree a compile-time constant (degrees 1 to 8). The
+/// geometry data at the quadrature points are computed once.
+///
+/// Dirichlet boundary conditions are applied as for
+/// fem::MatrixFreeOperator.
+template <typename T>
+class TensorProductOperator
+{
+public:
+  /// Create a sum-factorised operator
+  /// @param[in] V The function space
+  /// @param[in] kappa The diffusion coefficient
+  /// @param[in] sigma The reaction (mass) coefficient
+  /// @param[in] bcs Dirichlet boundary conditions
+  /// @param[in] diagonal The diagonal value for bc rows
+  TensorProductOperator(
+      const std::shared_ptr<const FunctionSpace>& V, T kappa, T sigma,
+      const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs,
+      T diagonal = 1.0)
+      : _V(V), _kappa(kappa), _sigma(sigma), _diagonal(diagonal)
+  {
+    assert(_V);
+    std::shared_ptr<const mesh::Mesh> mesh = _V->mesh();
+    assert(mesh);
+    const mesh::Topology& topology = mesh->topology();
+    _tdim = topology.dim();
+    if (topology.cell_type() != mesh::CellType::quadrilateral
+        and topology.cell_type() != mesh::CellType::hexahedron)
+    {
+      throw std::runtime_error("Sum factorisation requires quadrilateral or "
+                               "hexahedral cells.");
+    }
+    if (_V->dofmap()->bs() != 1)
+      throw std::runtime_error("Sum factorisation requires a scalar space.");
+
+    _basis = create_tensor_product_basis(*_V->element(), _tdim);
+    if (_basis.n < 2 or _basis.n > 9)
+    {
+      throw std::runtime_error("Sum factorisation is not implemented for "
+                               "degree "
+                               + std::to_string(_basis.n - 1) + ".");
+    }
+    _num_cells = topology.index_map(_tdim)->size_local();
+    _G = compute_tensor_product_geometry(*mesh, _basis, _num_cells);
+
+    // Build dof markers, and the owned bc rows
+    std::shared_ptr<const common::IndexMap> map = _V->dofmap()->index_map;
+    for (auto& bc : bcs)
+    {
+      assert(bc);
+      if (_V->contains(*bc->function_space()))
+      {
+        _bc.resize(map->size_local() + map->num_ghosts(), false);
+        bc->mark_dofs(_bc);
+      }
+    }
+    for (std::int32_t i = 0; i < (std::int32_t)_bc.size(); ++i)
+      if (i < map->size_local() and _bc[i])
+        _bc_rows.push_back(i);
+  }
+
+  /// Compute y = A x
+  /// @param[in,out] x The vector to apply the operator to. Its ghost
+  /// entries are updated.
+  /// @param[in,out] y The result. Only the owned entries are valid on
+  /// exit.
+  template <class Allocator>
+  void apply(la::Vector<T, Allocator>& x, la::Vector<T, Allocator>& y)
+  {
+    x.scatter_fwd();
+    std::vector<T, Allocator>& _y = y.mutable_array();
+    std::fill(_y.begin(), _y.end(), 0);
+    const std::vector<T, Allocator>& _x = x.array();
+
+    auto apply_cells = [&](auto d, auto n)
+    {
+      constexpr int _d = decltype(d)::value;
+      constexpr int _n = decltype(n)::value;
+      constexpr int num_dofs = _d == 2 ? _n * _n : _n * _n * _n;
+      constexpr int num_points = num_dofs;
+      std::array<T, num_dofs> xe, ye;
+      const graph::AdjacencyList<std::int32_t>& dofmap
+          = _V->dofmap()->list();
+      const std::vector<std::int32_t>& lex = _basis.dof_to_lex;
+      for (std::int32_t c = 0; c < _num_cells; ++c)
+      {
+        auto dofs = dofmap.links(c);
+        for (int i = 0; i < num_dofs; ++i)
+        {
+          xe[lex[i]] = (!_bc.empty() and _bc[dofs[i]]) ? T(0) : _x[dofs[i]];
+        }
+
+        impl::apply_tensor_product<T, _d, _n, _n>(
+            _basis, _G.data() + c * num_points * (_d * _d + 1), _kappa,
+            _sigma, xe.data(), ye.data());
+
+        for (int i = 0; i < num_dofs; ++i)
+        {
+          if (_bc.empty() or !_bc[dofs[i]])
+            _y[dofs[i]] += ye[lex[i]];
+        }
+      }
+    };
+
+    // Dispatch over the dimension and the number of 1D dofs
+    auto dispatch = [&](auto d)
+    {
+      switch (_basis.n)
+      {
+      case 2:
+        apply_cells(d, std::integral_constant<int, 2>());
+        break;
+      case 3:
+        apply_cells(d, std::integral_constant<int, 3>());
+        break;
+      case 4:
+        apply_cells(d, std::integral_constant<int, 4>());
+        break;
+      case 5:
+        apply_cells(d, std::integral_constant<int, 5>());
+        break;
+      case 6:
+        apply_cells(d, std::integral_constant<int, 6>());
+        break;
+      case 7:
+        apply_cells(d, std::integral_constant<int, 7>());
+        break;
+      case 8:
+        apply_cells(d, std::integral_constant<int, 8>());
+        break;
+      case 9:
+        apply_cells(d, std::integral_constant<int, 9>());
+        break;
+      default:
+        throw std::runtime_error("Unsupported degree.");
+      }
+    };
+    if (_tdim == 2)
+      dispatch(std::integral_constant<int, 2>());
+    else
+      dispatch(std::integral_constant<int, 3>());
+
+    y.scatter_rev(common::IndexMap::Mode::add);
+    for (std::int32_t i : _bc_rows)
+      _y[i] = _diagonal * _x[i];
+  }
+
+  /// The function space
+  std::shared_ptr<const FunctionSpace> function_space() const { return _V; }
+
+  /// The 1D data of the sum factorisation
+  const TensorProductBasis& basis() const { return _basis; }
+
+private:
+  std::shared_ptr<const FunctionSpace> _V;
+  int _tdim;
+  T _kappa, _sigma;
+
+  // 1D basis and the geometry data of the owned cells
+  TensorProductBasis _basis;
+  std::int32_t _num_cells;
+  std::vector<double> _G;
+
+  // Dirichlet bc dof markers, the owned bc rows and the value of the
+  // diagonal
+  std::vector<bool> _bc;
+  std::vector<std::int32_t> _bc_rows;
+  T _diagonal;
+};
+
+} // namespace dolfinx::fem
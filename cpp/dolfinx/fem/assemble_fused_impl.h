@@ -0,0 +1,356 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include "Form.h"
+#include "assemble_matrix_impl.h"
+#include "assemble_vector_impl.h"
+#include "utils.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/utils.h>
+#include <dolfinx/mesh/Geometry.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <dolfinx/mesh/Topology.h>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <vector>
+#include <xtl/xspan.hpp>
+
+namespace dolfinx::fem::impl
+{
+
+/// Assemble a cell integral of forms concurrently, see assemble_fused
+/// @param[in] mesh The mesh
+/// @param[in] forms The forms
+/// @param[in] domains The cells of the integral for each form, or
+/// nullptr if the form has no integral with the id
+/// @param[in] chunk_size The number of cells in a chunk
+/// @param[in] num_threads The number of threads
+/// @param[in] assemble Function that assembles the integral of a form
+/// (first argument) over cells (second argument)
+template <typename T, typename Fn>
+void assemble_fused_threaded(
+    const mesh::Mesh& mesh,
+    const std::vector<std::reference_wrapper<const Form<T>>>& forms,
+    const std::vector<const std::vector<std::int32_t>*>& domains,
+    int chunk_size, int num_threads, const Fn& assemble)
+{
+  // Cells of the integral of any form
+  std::vector<std::int32_t> cells;
+  for (auto d : domains)
+    if (d)
+      cells.insert(cells.end(), d->begin(), d->end());
+  std::sort(cells.begin(), cells.end());
+  cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+
+  // Build the graph from each cell to the row dofs of all forms, with
+  // the dofs of different dofmaps numbered consecutively
+  const int tdim = mesh.topology().dim();
+  const std::int32_t num_cells
+      = mesh.topology().index_map(tdim)->size_local()
+        + mesh.topology().index_map(tdim)->num_ghosts();
+  std::vector<const graph::AdjacencyList<std::int32_t>*> dofmaps;
+  for (std::size_t k = 0; k < forms.size(); ++k)
+  {
+    const graph::AdjacencyList<std::int32_t>& dofs
+        = forms[k].get().function_spaces().at(0)->dofmap()->list();
+    if (domains[k]
+        and std::find(dofmaps.begin(), dofmaps.end(), &dofs) == dofmaps.end())
+    {
+      dofmaps.push_back(&dofs);
+    }
+  }
+
+  std::vector<std::int32_t> offsets(num_cells + 1, 0);
+  for (std::int32_t c : cells)
+    for (auto dofs : dofmaps)
+      offsets[c + 1] += dofs->num_links(c);
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+  std::vector<std::int32_t> data(offsets.back());
+  std::int32_t offset = 0;
+  std::vector<std::int32_t> pos(offsets.begin(), std::prev(offsets.end()));
+  for (auto dofs : dofmaps)
+  {
+    const std::vector<std::int32_t>& array = dofs->array();
+    const std::int32_t num_dofs
+        = array.empty() ? 0 : *std::max_element(array.begin(), array.end()) + 1;
+    for (std::int32_t c : cells)
+      for (std::int32_t dof : dofs->links(c))
+        data[pos[c]++] = dof + offset;
+    offset += num_dofs;
+  }
+
+  const graph::AdjacencyList<std::int32_t> colours = compute_colouring(
+      mesh.topology(),
+      graph::AdjacencyList<std::int32_t>(std::move(data), std::move(offsets)),
+      IntegralType::cell, cells);
+
+  // Assemble the chunks of each colour concurrently. Each task runs the
+  // kernels of all forms on its chunk.
+  for (std::int32_t c = 0; c < colours.num_nodes(); ++c)
+  {
+    std::vector<std::int32_t> entities(colours.links(c).begin(),
+                                       colours.links(c).end());
+    std::sort(entities.begin(), entities.end());
+    const std::int64_t num_chunks
+        = (std::int64_t(entities.size()) + chunk_size - 1) / chunk_size;
+    common::for_each_task(
+        num_chunks, num_threads,
+        [&](std::int64_t i, int)
+        {
+          const std::size_t c0 = i * chunk_size;
+          const std::size_t c1
+              = std::min(c0 + chunk_size, entities.size());
+          const xtl::span<const std::int32_t> chunk(entities.data() + c0,
+                                                    c1 - c0);
+          std::vector<std::int32_t> _cells;
+          for (std::size_t k = 0; k < forms.size(); ++k)
+          {
+            if (!domains[k])
+              continue;
+            if (domains[k]->size() == cells.size())
+              assemble(k, chunk);
+            else
+            {
+              _cells.clear();
+              std::set_intersection(chunk.begin(), chunk.end(),
+                                    domains[k]->begin(), domains[k]->end(),
+                                    std::back_inserter(_cells));
+              if (!_cells.empty())
+                assemble(k, xtl::span<const std::int32_t>(_cells));
+            }
+          }
+        });
+  }
+}
+
+/// Assemble bilinear and linear forms in a single traversal of the
+/// cells. The cells are processed in contiguous chunks of `chunk_size`
+/// cells, and all cell kernels of all forms are executed on a chunk
+/// before moving to the next, so that the geometry, dofmaps and
+/// coefficients of a chunk are re-used from cache. Facet integrals are
+/// assembled form-by-form after the cells.
+///
+/// The coordinates of the cells of a chunk are gathered once and
+/// passed to the kernels of all forms, unless the geometry is packed
+/// (see mesh::Geometry::pack_coordinates) or a batched kernel is used.
+/// Forms with the same coefficients share one packed coefficient
+/// array.
+///
+/// If num_threads > 1, the cells are coloured such that no two cells
+/// of the same colour share a row (test space) degree-of-freedom of any
+/// of the bilinear forms, and the chunks of cells of each colour are
+/// assembled concurrently. In this case the functions in mat_set are
+/// called concurrently and must be safe for concurrent insertion into
+/// disjoint sets of rows of the same matrix. Calls for different
+/// bilinear forms do not need to be synchronised with each other.
+/// @param[in] mat_set The functions for adding values into the matrix
+/// of each bilinear form
+/// @param[in] a The bilinear forms
+/// @param[in] bc Boundary condition markers for the rows (0) and
+/// columns (1) of each bilinear form
+/// @param[in,out] b The vectors to assemble the linear forms into
+/// @param[in] L The linear forms
+/// @param[in] chunk_size The number of cells in a chunk
+/// @param[in] num_threads The number of threads
+template <typename T>
+void assemble_fused(
+    const std::vector<
+        std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
+                          const std::int32_t*, const T*)>>& mat_set,
+    const std::vector<std::reference_wrapper<const Form<T>>>& a,
+    const std::vector<std::array<std::vector<bool>, 2>>& bc,
+    const std::vector<xtl::span<T>>& b,
+    const std::vector<std::reference_wrapper<const Form<T>>>& L,
+    int chunk_size, int num_threads = 1)
+{
+  assert(mat_set.size() == a.size());
+  assert(bc.size() == a.size());
+  assert(b.size() == L.size());
+  if (chunk_size < 1)
+    throw std::runtime_error("Chunk size must be positive.");
+  if (num_threads < 1)
+    throw std::runtime_error("Number of threads must be positive.");
+
+  // Collect forms, with the bilinear forms first
+  std::vector<std::reference_wrapper<const Form<T>>> forms(a.begin(),
+                                                           a.end());
+  forms.insert(forms.end(), L.begin(), L.end());
+  if (forms.empty())
+    return;
+
+  std::shared_ptr<const mesh::Mesh> mesh = forms.front().get().mesh();
+  assert(mesh);
+  for (const Form<T>& form : forms)
+  {
+    if (form.mesh() != mesh)
+      throw std::runtime_error("Fused forms must be defined on the same mesh.");
+  }
+
+  // Pack constants and coefficients, and get permutation data. The
+  // coefficients are packed once for forms with the same coefficients.
+  std::vector<std::vector<T>> constants;
+  std::vector<std::shared_ptr<const array2d<T>>> coeffs;
+  std::vector<xtl::span<const std::uint32_t>> cell_info;
+  for (std::size_t k = 0; k < forms.size(); ++k)
+  {
+    const Form<T>& form = forms[k];
+    constants.push_back(pack_constants(form));
+    auto it = std::find_if(forms.begin(), std::next(forms.begin(), k),
+                           [&form](const Form<T>& f)
+                           { return f.coefficients() == form.coefficients(); });
+    if (it != std::next(forms.begin(), k))
+      coeffs.push_back(coeffs[std::distance(forms.begin(), it)]);
+    else
+    {
+      coeffs.push_back(
+          std::make_shared<const array2d<T>>(fem::pack_coefficients(form)));
+    }
+    cell_info.push_back(get_cell_info(form));
+  }
+
+  // Assemble the cell integrals of all forms chunk-by-chunk. The
+  // integration domains are sorted, so the cells of a chunk are a
+  // contiguous range of each domain.
+  std::set<int> ids;
+  for (const Form<T>& form : forms)
+  {
+    const std::vector<int> form_ids = form.integral_ids(IntegralType::cell);
+    ids.insert(form_ids.begin(), form_ids.end());
+  }
+
+  const int tdim = mesh->topology().dim();
+  const std::int32_t num_cells
+      = mesh->topology().index_map(tdim)->size_local()
+        + mesh->topology().index_map(tdim)->num_ghosts();
+  for (int id : ids)
+  {
+    std::vector<const std::vector<std::int32_t>*> domains(forms.size(),
+                                                          nullptr);
+    for (std::size_t k = 0; k < forms.size(); ++k)
+    {
+      const std::vector<int> form_ids
+          = forms[k].get().integral_ids(IntegralType::cell);
+      if (std::find(form_ids.begin(), form_ids.end(), id) != form_ids.end())
+      {
+        domains[k] = &forms[k].get().domains(IntegralType::cell, id);
+        assert(std::is_sorted(domains[k]->begin(), domains[k]->end()));
+      }
+    }
+
+    // Assemble the cell integral of form k over cells, with the cell
+    // coordinates x_cells of the cells [c0, c0 + n) if not empty
+    auto assemble = [&](std::size_t k,
+                        const xtl::span<const std::int32_t>& cells,
+                        const xtl::span<const double>& x_cells = {},
+                        std::int32_t c0 = 0)
+    {
+      const xtl::span<const T> _constants(constants[k]);
+      if (k < a.size())
+      {
+        assemble_cell_integral(mat_set[k], forms[k].get(), id, cells,
+                               _constants, *coeffs[k], bc[k][0], bc[k][1],
+                               cell_info[k], x_cells, c0);
+      }
+      else
+      {
+        assemble_cell_integral(b[k - a.size()], forms[k].get(), id, cells,
+                               _constants, *coeffs[k], cell_info[k], x_cells,
+                               c0);
+      }
+    };
+
+    if (num_threads > 1)
+    {
+      assemble_fused_threaded(*mesh, forms, domains, chunk_size, num_threads,
+                              assemble);
+      continue;
+    }
+
+    // Gather the cell coordinates of a chunk once for all forms, unless
+    // the coordinates are packed
+    const mesh::Geometry& geometry = mesh->geometry();
+    const bool gather
+        = num_cells > 0 and geometry.packed_coordinates().empty();
+    const std::size_t num_dofs_g
+        = num_cells > 0 ? geometry.dofmap().num_links(0) : 0;
+    std::vector<double> x_chunk(gather ? 3 * num_dofs_g * chunk_size : 0);
+    std::vector<std::int8_t> gathered(gather ? chunk_size : 0);
+
+    std::vector<std::size_t> pos(forms.size(), 0);
+    std::vector<xtl::span<const std::int32_t>> cells(forms.size());
+    for (std::int32_t c0 = 0; c0 < num_cells; c0 += chunk_size)
+    {
+      // Cells of each domain in [c0, c1)
+      const std::int32_t c1 = std::min(c0 + chunk_size, num_cells);
+      for (std::size_t k = 0; k < forms.size(); ++k)
+      {
+        if (!domains[k])
+          continue;
+        auto it0 = std::next(domains[k]->begin(), pos[k]);
+        auto it1 = std::lower_bound(it0, domains[k]->end(), c1);
+        const std::size_t num = std::distance(it0, it1);
+        cells[k] = xtl::span<const std::int32_t>(domains[k]->data() + pos[k],
+                                                 num);
+        pos[k] += num;
+      }
+
+      if (gather)
+      {
+        std::fill(gathered.begin(), gathered.end(), 0);
+        for (std::size_t k = 0; k < forms.size(); ++k)
+        {
+          if (!domains[k])
+            continue;
+          for (std::int32_t c : cells[k])
+          {
+            if (!gathered[c - c0])
+            {
+              geometry.cell_coordinates(
+                  c, xtl::span<double>(x_chunk.data()
+                                           + 3 * num_dofs_g * (c - c0),
+                                       3 * num_dofs_g));
+              gathered[c - c0] = 1;
+            }
+          }
+        }
+      }
+
+      for (std::size_t k = 0; k < forms.size(); ++k)
+      {
+        if (domains[k] and !cells[k].empty())
+          assemble(k, cells[k], x_chunk, c0);
+      }
+    }
+  }
+
+  // Assemble facet integrals
+  for (std::size_t k = 0; k < forms.size(); ++k)
+  {
+    const xtl::span<const T> _constants(constants[k]);
+    if (k < a.size())
+    {
+      assemble_facet_integrals(mat_set[k], forms[k].get(), _constants,
+                               *coeffs[k], bc[k][0], bc[k][1], cell_info[k],
+                               num_threads);
+    }
+    else
+    {
+      assemble_facet_integrals(b[k - a.size()], forms[k].get(), _constants,
+                               *coeffs[k], cell_info[k], num_threads);
+    }
+  }
+}
+
+} // namespace dolfinx::fem::impl
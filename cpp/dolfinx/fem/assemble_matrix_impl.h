@@ -6,8 +6,10 @@
 
 #pragma once
 
+#include "ConstrainedCells.h"
 #include "DofMap.h"
 #include "Form.h"
+#include "InteriorFacets.h"
 #include "utils.h"
 #include <dolfinx/fem/FunctionSpace.h>
 #include <dolfinx/graph/AdjacencyList.h>
@@ -17,6 +19,7 @@
 #include <dolfinx/mesh/Topology.h>
 #include <functional>
 #include <iterator>
+#include <type_traits>
 #include <vector>
 
 namespace dolfinx::fem::impl
@@ -27,21 +30,43 @@ namespace dolfinx::fem::impl
 /// local indices. Rows (bc0) and columns (bc1) with Dirichlet
 /// conditions are zeroed. Markers (bc0 and bc1) can be empty if not bcs
 /// are applied. Matrix is not finalised.
-
-template <typename T>
-void assemble_matrix(
-    const std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
-                            const std::int32_t*, const T*)>& mat_set_values,
-    const Form<T>& a, const xtl::span<const T>& constants,
-    const array2d<T>& coeffs, const std::vector<bool>& bc0,
-    const std::vector<bool>& bc1);
+///
+/// If num_threads > 1, the entities of each integration domain are
+/// coloured such that no two entities of the same colour share a row
+/// (test space) degree-of-freedom, and the entities of each colour are
+/// assembled concurrently. In this case mat_set_values is called
+/// concurrently and must be safe for concurrent insertion into
+/// disjoint sets of rows.
+///
+/// @tparam U The type of the insertion function. It is a callable with
+/// the signature `int(std::int32_t m, const std::int32_t* rows,
+/// std::int32_t n, const std::int32_t* cols, const T* vals)`, e.g. a
+/// std::function or a lambda. Passing a lambda allows the compiler to
+/// inline the insertion into the assembly loops.
+template <typename T, typename U>
+void assemble_matrix(const U& mat_set_values, const Form<T>& a,
+                     const xtl::span<const T>& constants,
+                     const array2d<T>& coeffs, const std::vector<bool>& bc0,
+                     const std::vector<bool>& bc1, int num_threads = 1);
 
 /// Execute kernel over cells and accumulate result in matrix
-template <typename T>
+/// @tparam _bs0 The block size of the test function dof map. If less
+/// than zero the block size is determined at runtime. If `_bs0` is
+/// positive the block size is used as a compile-time constant, which
+/// has performance benefits.
+/// @tparam _bs1 The block size of the trial function dof map.
+/// @tparam _transform If false, the dof transformations are not
+/// applied. Use only when neither element needs dof transformations.
+/// @param[in] x_cells Coordinates of the geometry dofs of the cells
+/// `[c0, c0 + n)`, packed by cell as in mesh::Geometry::packed_coordinates,
+/// e.g. gathered once for several forms. It must contain the cells in
+/// `active_cells`. If empty, the coordinates are read from the
+/// geometry.
+/// @param[in] c0 The first cell in `x_cells`
+template <typename T, int _bs0 = -1, int _bs1 = -1, bool _transform = true,
+          typename U>
 void assemble_cells(
-    const std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
-                            const std::int32_t*, const T*)>& mat_set,
-    const mesh::Geometry& geometry,
+    const U& mat_set, const mesh::Geometry& geometry,
     const xtl::span<const std::int32_t>& active_cells,
     const std::function<void(const xtl::span<T>&,
                              const xtl::span<const std::uint32_t>&,
@@ -57,20 +82,31 @@ void assemble_cells(
     const std::function<void(T*, const T*, const T*, const double*, const int*,
                              const std::uint8_t*)>& kernel,
     const array2d<T>& coeffs, const xtl::span<const T>& constants,
-    const xtl::span<const std::uint32_t>& cell_info)
+    const xtl::span<const std::uint32_t>& cell_info,
+    const xtl::span<const double>& x_cells = {}, std::int32_t c0 = 0)
 {
+  assert(_bs0 < 0 or _bs0 == bs0);
+  assert(_bs1 < 0 or _bs1 == bs1);
+
+  // Block sizes, which are compile-time constants if _bs0 and _bs1 are
+  // positive
+  const int block_size0 = _bs0 > 0 ? _bs0 : bs0;
+  const int block_size1 = _bs1 > 0 ? _bs1 : bs1;
+
   // Prepare cell geometry
   const graph::AdjacencyList<std::int32_t>& x_dofmap = geometry.dofmap();
 
   // FIXME: Add proper interface for num coordinate dofs
   const std::size_t num_dofs_g = x_dofmap.num_links(0);
-  const xt::xtensor<double, 2>& x_g = geometry.x();
+  const xtl::span<const double> x_packed
+      = x_cells.empty() ? geometry.packed_coordinates() : x_cells;
+  const std::int32_t x_offset = x_cells.empty() ? 0 : c0;
 
   // Iterate over active cells
   const int num_dofs0 = dofmap0.links(0).size();
   const int num_dofs1 = dofmap1.links(0).size();
-  const int ndim0 = bs0 * num_dofs0;
-  const int ndim1 = bs1 * num_dofs1;
+  const int ndim0 = block_size0 * num_dofs0;
+  const int ndim1 = block_size1 * num_dofs1;
   std::vector<T> Ae(ndim0 * ndim1);
   const xtl::span<T> _Ae(Ae);
   std::vector<double> coordinate_dofs(3 * num_dofs_g);
@@ -78,20 +114,28 @@ void assemble_cells(
   for (std::int32_t c : active_cells)
   {
     // Get cell coordinates/geometry
-    auto x_dofs = x_dofmap.links(c);
-    for (std::size_t i = 0; i < x_dofs.size(); ++i)
+    const double* coords = coordinate_dofs.data();
+    if (!x_packed.empty())
+      coords = std::next(x_packed.data(), 3 * num_dofs_g * (c - x_offset));
+    else
     {
-      std::copy_n(xt::row(x_g, x_dofs[i]).begin(), 3,
-                  std::next(coordinate_dofs.begin(), 3 * i));
+      geometry.cell_coordinates(c, coordinate_dofs);
     }
 
     // Tabulate tensor
     std::fill(Ae.begin(), Ae.end(), 0);
-    kernel(Ae.data(), coeffs.row(c).data(), constants.data(),
-           coordinate_dofs.data(), nullptr, nullptr);
+    kernel(Ae.data(), coeffs.row(c).data(), constants.data(), coords, nullptr,
+           nullptr);
 
-    apply_dof_transformation(_Ae, cell_info, c, ndim1);
-    apply_dof_transformation_to_transpose(_Ae, cell_info, c, ndim0);
+    if constexpr (_transform)
+    {
+      // The transformations are the identity if cell_info[c] is zero
+      if (cell_info.empty() or cell_info[c] != 0)
+      {
+        apply_dof_transformation(_Ae, cell_info, c, ndim1);
+        apply_dof_transformation_to_transpose(_Ae, cell_info, c, ndim0);
+      }
+    }
 
     // Zero rows/columns for essential bcs
     auto dofs0 = dofmap0.links(c);
@@ -100,12 +144,12 @@ void assemble_cells(
     {
       for (int i = 0; i < num_dofs0; ++i)
       {
-        for (int k = 0; k < bs0; ++k)
+        for (int k = 0; k < block_size0; ++k)
         {
-          if (bc0[bs0 * dofs0[i] + k])
+          if (bc0[block_size0 * dofs0[i] + k])
           {
             // Zero row bs0 * i + k
-            const int row = bs0 * i + k;
+            const int row = block_size0 * i + k;
             std::fill_n(std::next(Ae.begin(), ndim1 * row), ndim1, 0.0);
           }
         }
@@ -116,12 +160,12 @@ void assemble_cells(
     {
       for (int j = 0; j < num_dofs1; ++j)
       {
-        for (int k = 0; k < bs1; ++k)
+        for (int k = 0; k < block_size1; ++k)
         {
-          if (bc1[bs1 * dofs1[j] + k])
+          if (bc1[block_size1 * dofs1[j] + k])
           {
             // Zero column bs1 * j + k
-            const int col = bs1 * j + k;
+            const int col = block_size1 * j + k;
             for (int row = 0; row < ndim0; ++row)
               Ae[row * ndim1 + col] = 0.0;
           }
@@ -133,12 +177,214 @@ void assemble_cells(
   }
 }
 
+/// Execute kernel over cells with constrained degrees-of-freedom and
+/// accumulate result in matrix. The element matrix rows and columns
+/// to zero are precomputed (see ConstrainedCells), so no boundary
+/// condition markers are checked.
+/// @param[in] rows The local (unrolled) rows of the element matrix to
+/// zero for each cell in `cells`
+/// @param[in] cols The local (unrolled) columns of the element matrix
+/// to zero for each cell in `cells`
+template <typename T, typename U>
+void assemble_constrained_cells(
+    const U& mat_set, const mesh::Geometry& geometry,
+    const xtl::span<const std::int32_t>& cells,
+    const std::function<void(const xtl::span<T>&,
+                             const xtl::span<const std::uint32_t>&,
+                             std::int32_t, int)>
+        apply_dof_transformation,
+    const graph::AdjacencyList<std::int32_t>& dofmap0, const int bs0,
+    const std::function<void(const xtl::span<T>&,
+                             const xtl::span<const std::uint32_t>&,
+                             std::int32_t, int)>
+        apply_dof_transformation_to_transpose,
+    const graph::AdjacencyList<std::int32_t>& dofmap1, const int bs1,
+    const graph::AdjacencyList<std::int32_t>& rows,
+    const graph::AdjacencyList<std::int32_t>& cols,
+    const std::function<void(T*, const T*, const T*, const double*, const int*,
+                             const std::uint8_t*)>& kernel,
+    const array2d<T>& coeffs, const xtl::span<const T>& constants,
+    const xtl::span<const std::uint32_t>& cell_info)
+{
+  if (cells.empty())
+    return;
+  assert(rows.num_nodes() == (std::int32_t)cells.size());
+  assert(cols.num_nodes() == (std::int32_t)cells.size());
+
+  // Prepare cell geometry
+  const graph::AdjacencyList<std::int32_t>& x_dofmap = geometry.dofmap();
+
+  // FIXME: Add proper interface for num coordinate dofs
+  const std::size_t num_dofs_g = x_dofmap.num_links(0);
+  const xtl::span<const double> x_packed = geometry.packed_coordinates();
+
+  const int ndim0 = bs0 * dofmap0.num_links(0);
+  const int ndim1 = bs1 * dofmap1.num_links(0);
+  std::vector<T> Ae(ndim0 * ndim1);
+  const xtl::span<T> _Ae(Ae);
+  std::vector<double> coordinate_dofs(3 * num_dofs_g);
+  for (std::size_t j = 0; j < cells.size(); ++j)
+  {
+    const std::int32_t c = cells[j];
+
+    // Get cell coordinates/geometry
+    const double* coords = coordinate_dofs.data();
+    if (!x_packed.empty())
+      coords = std::next(x_packed.data(), 3 * num_dofs_g * c);
+    else
+      geometry.cell_coordinates(c, coordinate_dofs);
+
+    // Tabulate tensor
+    std::fill(Ae.begin(), Ae.end(), 0);
+    kernel(Ae.data(), coeffs.row(c).data(), constants.data(), coords, nullptr,
+           nullptr);
+    if (cell_info.empty() or cell_info[c] != 0)
+    {
+      apply_dof_transformation(_Ae, cell_info, c, ndim1);
+      apply_dof_transformation_to_transpose(_Ae, cell_info, c, ndim0);
+    }
+
+    // Zero rows/columns for essential bcs
+    for (std::int32_t row : rows.links(j))
+      std::fill_n(std::next(Ae.begin(), ndim1 * row), ndim1, 0.0);
+    for (std::int32_t col : cols.links(j))
+      for (int row = 0; row < ndim0; ++row)
+        Ae[row * ndim1 + col] = 0.0;
+
+    auto dofs0 = dofmap0.links(c);
+    auto dofs1 = dofmap1.links(c);
+    mat_set(dofs0.size(), dofs0.data(), dofs1.size(), dofs1.data(), Ae.data());
+  }
+}
+
+/// Execute a batched kernel over cells and accumulate result in
+/// matrix. See Form::set_batch_kernel for the data layout.
+template <typename T, bool _transform = true, typename U>
+void assemble_cells_batched(
+    const U& mat_set, const mesh::Geometry& geometry,
+    const xtl::span<const std::int32_t>& active_cells,
+    const std::function<void(const xtl::span<T>&,
+                             const xtl::span<const std::uint32_t>&,
+                             std::int32_t, int)>
+        apply_dof_transformation,
+    const graph::AdjacencyList<std::int32_t>& dofmap0, const int bs0,
+    const std::function<void(const xtl::span<T>&,
+                             const xtl::span<const std::uint32_t>&,
+                             std::int32_t, int)>
+        apply_dof_transformation_to_transpose,
+    const graph::AdjacencyList<std::int32_t>& dofmap1, const int bs1,
+    const std::vector<bool>& bc0, const std::vector<bool>& bc1,
+    const std::function<void(T*, const T*, const T*, const double*, const int*,
+                             const std::uint8_t*)>& kernel,
+    int batch_size, const array2d<T>& coeffs,
+    const xtl::span<const T>& constants,
+    const xtl::span<const std::uint32_t>& cell_info)
+{
+  // Prepare cell geometry
+  const graph::AdjacencyList<std::int32_t>& x_dofmap = geometry.dofmap();
+
+  // FIXME: Add proper interface for num coordinate dofs
+  const std::size_t num_dofs_g = x_dofmap.num_links(0);
+
+  const int num_dofs0 = dofmap0.links(0).size();
+  const int num_dofs1 = dofmap1.links(0).size();
+  const int ndim0 = bs0 * num_dofs0;
+  const int ndim1 = bs1 * num_dofs1;
+  const std::size_t num_coeffs = coeffs.shape[1];
+  std::vector<T> Ae(ndim0 * ndim1);
+  const xtl::span<T> _Ae(Ae);
+
+  // Batch data, interleaved by cell
+  std::vector<T> Ab(Ae.size() * batch_size);
+  std::vector<T> wb(num_coeffs * batch_size);
+  std::vector<double> coordinate_dofs(3 * num_dofs_g * batch_size);
+  std::vector<double> x_c(3 * num_dofs_g);
+
+  for (std::size_t b = 0; b < active_cells.size(); b += batch_size)
+  {
+    // Pack batch. A partial batch is padded by repeating the last cell.
+    const std::size_t num_cells
+        = std::min<std::size_t>(batch_size, active_cells.size() - b);
+    for (int k = 0; k < batch_size; ++k)
+    {
+      const std::int32_t c
+          = active_cells[b + std::min<std::size_t>(k, num_cells - 1)];
+      geometry.cell_coordinates(c, x_c);
+      for (std::size_t i = 0; i < x_c.size(); ++i)
+        coordinate_dofs[i * batch_size + k] = x_c[i];
+      const T* w = coeffs.row(c).data();
+      for (std::size_t j = 0; j < num_coeffs; ++j)
+        wb[j * batch_size + k] = w[j];
+    }
+
+    // Tabulate tensors for the batch
+    std::fill(Ab.begin(), Ab.end(), 0);
+    kernel(Ab.data(), wb.data(), constants.data(), coordinate_dofs.data(),
+           nullptr, nullptr);
+
+    // Unpack and add each element tensor
+    for (std::size_t k = 0; k < num_cells; ++k)
+    {
+      const std::int32_t c = active_cells[b + k];
+      for (std::size_t j = 0; j < Ae.size(); ++j)
+        Ae[j] = Ab[j * batch_size + k];
+
+      if constexpr (_transform)
+      {
+        if (cell_info.empty() or cell_info[c] != 0)
+        {
+          apply_dof_transformation(_Ae, cell_info, c, ndim1);
+          apply_dof_transformation_to_transpose(_Ae, cell_info, c, ndim0);
+        }
+      }
+
+      // Zero rows/columns for essential bcs
+      auto dofs0 = dofmap0.links(c);
+      auto dofs1 = dofmap1.links(c);
+      if (!bc0.empty())
+      {
+        for (int i = 0; i < num_dofs0; ++i)
+        {
+          for (int k0 = 0; k0 < bs0; ++k0)
+          {
+            if (bc0[bs0 * dofs0[i] + k0])
+            {
+              // Zero row bs0 * i + k0
+              const int row = bs0 * i + k0;
+              std::fill_n(std::next(Ae.begin(), ndim1 * row), ndim1, 0.0);
+            }
+          }
+        }
+      }
+
+      if (!bc1.empty())
+      {
+        for (int j = 0; j < num_dofs1; ++j)
+        {
+          for (int k1 = 0; k1 < bs1; ++k1)
+          {
+            if (bc1[bs1 * dofs1[j] + k1])
+            {
+              // Zero column bs1 * j + k1
+              const int col = bs1 * j + k1;
+              for (int row = 0; row < ndim0; ++row)
+                Ae[row * ndim1 + col] = 0.0;
+            }
+          }
+        }
+      }
+
+      mat_set(dofs0.size(), dofs0.data(), dofs1.size(), dofs1.data(),
+              Ae.data());
+    }
+  }
+}
+
 /// Execute kernel over exterior facets and  accumulate result in Mat
-template <typename T>
+template <typename T, typename U>
 void assemble_exterior_facets(
-    const std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
-                            const std::int32_t*, const T*)>& mat_set,
-    const mesh::Mesh& mesh, const xtl::span<const std::int32_t>& active_facets,
+    const U& mat_set, const mesh::Mesh& mesh,
+    const xtl::span<const std::int32_t>& active_facets,
     const std::function<void(const xtl::span<T>&,
                              const xtl::span<const std::uint32_t>&,
                              std::int32_t, int)>& apply_dof_transformation,
@@ -161,7 +407,9 @@ void assemble_exterior_facets(
 
   // FIXME: Add proper interface for num coordinate dofs
   const std::size_t num_dofs_g = x_dofmap.num_links(0);
-  const xt::xtensor<double, 2>& x_g = mesh.geometry().x();
+  const mesh::Geometry& geometry = mesh.geometry();
+  const xtl::span<const double> x_packed
+      = mesh.geometry().packed_coordinates();
 
   // Data structures used in assembly
   std::vector<double> coordinate_dofs(3 * num_dofs_g);
@@ -190,18 +438,18 @@ void assemble_exterior_facets(
     const int local_facet = std::distance(facets.begin(), it);
 
     // Get cell coordinates/geometry
-    auto x_dofs = x_dofmap.links(cells[0]);
-    for (std::size_t i = 0; i < x_dofs.size(); ++i)
+    const double* coords = coordinate_dofs.data();
+    if (!x_packed.empty())
+      coords = std::next(x_packed.data(), 3 * num_dofs_g * cells[0]);
+    else
     {
-      std::copy_n(xt::row(x_g, x_dofs[i]).begin(), 3,
-                  std::next(coordinate_dofs.begin(), 3 * i));
+      geometry.cell_coordinates(cells[0], coordinate_dofs);
     }
 
     // Tabulate tensor
     std::fill(Ae.begin(), Ae.end(), 0);
-    kernel(Ae.data(), coeffs.row(cells[0]).data(), constants.data(),
-           coordinate_dofs.data(), &local_facet,
-           &perms[cells[0] * facets.size() + local_facet]);
+    kernel(Ae.data(), coeffs.row(cells[0]).data(), constants.data(), coords,
+           &local_facet, &perms[cells[0] * facets.size() + local_facet]);
 
     apply_dof_transformation(_Ae, cell_info, cells[0], ndim1);
     apply_dof_transformation_to_transpose(_Ae, cell_info, cells[0], ndim0);
@@ -245,12 +493,15 @@ void assemble_exterior_facets(
   }
 }
 
-/// Execute kernel over interior facets and  accumulate result in Mat
-template <typename T>
+/// Execute kernel over packed interior facets and accumulate result in
+/// Mat
+/// @param[in] facets The packed facets
+/// @param[in] coeffs The coefficients of the facets (see
+/// fem::pack_interior_facet_coefficients)
+template <typename T, typename U>
 void assemble_interior_facets(
-    const std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
-                            const std::int32_t*, const T*)>& mat_set,
-    const mesh::Mesh& mesh, const xtl::span<const std::int32_t>& active_facets,
+    const U& mat_set, const mesh::Geometry& geometry,
+    const InteriorFacets& facets,
     const std::function<void(const xtl::span<T>&,
                              const xtl::span<const std::uint32_t>&,
                              std::int32_t, int)>& apply_dof_transformation,
@@ -262,66 +513,32 @@ void assemble_interior_facets(
     const std::vector<bool>& bc1,
     const std::function<void(T*, const T*, const T*, const double*, const int*,
                              const std::uint8_t*)>& kernel,
-    const array2d<T>& coeffs, const xtl::span<const int>& offsets,
-    const xtl::span<const T>& constants,
-    const xtl::span<const std::uint32_t>& cell_info,
-    const xtl::span<const std::uint8_t>& perms)
+    const array2d<T>& coeffs, const xtl::span<const T>& constants,
+    const xtl::span<const std::uint32_t>& cell_info)
 {
-  const int tdim = mesh.topology().dim();
-
-  // Prepare cell geometry
-  const graph::AdjacencyList<std::int32_t>& x_dofmap = mesh.geometry().dofmap();
-
   // FIXME: Add proper interface for num coordinate dofs
-  const std::size_t num_dofs_g = x_dofmap.num_links(0);
-  const xt::xtensor<double, 2>& x_g = mesh.geometry().x();
+  const std::size_t num_dofs_g = geometry.dofmap().num_links(0);
 
   // Data structures used in assembly
   xt::xtensor<double, 3> coordinate_dofs({2, num_dofs_g, 3});
-  std::vector<T> Ae, be;
-  std::vector<T> coeff_array(2 * offsets.back());
-  assert(offsets.back() == coeffs.shape[1]);
+  std::vector<T> Ae;
+  assert(facets.size() == coeffs.shape[0]);
 
   // Temporaries for joint dofmaps
   std::vector<std::int32_t> dmapjoint0, dmapjoint1;
 
   // Iterate over all facets
-  auto c = mesh.topology().connectivity(tdim - 1, tdim);
-  assert(c);
-  auto c_to_f = mesh.topology().connectivity(tdim, tdim - 1);
-  assert(c_to_f);
-
-  for (std::int32_t facet_index : active_facets)
+  for (std::size_t f = 0; f < facets.size(); ++f)
   {
-    // Create attached cells
-    auto cells = c->links(facet_index);
-    assert(cells.size() == 2);
-
-    // Get local index of facet with respect to the cell
-    auto facets0 = c_to_f->links(cells[0]);
-    const auto* it0 = std::find(facets0.begin(), facets0.end(), facet_index);
-    assert(it0 != facets0.end());
-    const int local_facet0 = std::distance(facets0.begin(), it0);
-    auto facets1 = c_to_f->links(cells[1]);
-    const auto* it1 = std::find(facets1.begin(), facets1.end(), facet_index);
-    assert(it1 != facets1.end());
-    const int local_facet1 = std::distance(facets1.begin(), it1);
-
-    const std::array local_facet = {local_facet0, local_facet1};
+    const std::int32_t* cells = facets.cells.data() + 2 * f;
 
     // Get cell geometry
-    auto x_dofs0 = x_dofmap.links(cells[0]);
-    for (std::size_t i = 0; i < x_dofs0.size(); ++i)
-    {
-      std::copy_n(xt::view(x_g, x_dofs0[i]).begin(), 3,
-                  xt::view(coordinate_dofs, 0, i, xt::all()).begin());
-    }
-    auto x_dofs1 = x_dofmap.links(cells[1]);
-    for (std::size_t i = 0; i < x_dofs1.size(); ++i)
-    {
-      std::copy_n(xt::view(x_g, x_dofs1[i]).begin(), 3,
-                  xt::view(coordinate_dofs, 1, i, xt::all()).begin());
-    }
+    geometry.cell_coordinates(
+        cells[0], xtl::span<double>(coordinate_dofs.data(), 3 * num_dofs_g));
+    geometry.cell_coordinates(
+        cells[1], xtl::span<double>(std::next(coordinate_dofs.data(),
+                                              3 * num_dofs_g),
+                                    3 * num_dofs_g));
 
     // Get dof maps for cells and pack
     xtl::span<const std::int32_t> dmap0_cell0 = dofmap0.cell_dofs(cells[0]);
@@ -338,34 +555,15 @@ void assemble_interior_facets(
     std::copy(dmap1_cell1.begin(), dmap1_cell1.end(),
               std::next(dmapjoint1.begin(), dmap1_cell0.size()));
 
-    // Layout for the restricted coefficients is flattened
-    // w[coefficient][restriction][dof]
-    auto coeff_cell0 = coeffs.row(cells[0]);
-    auto coeff_cell1 = coeffs.row(cells[1]);
-
-    // Loop over coefficients
-    for (std::size_t i = 0; i < offsets.size() - 1; ++i)
-    {
-      // Loop over entries for coefficient i
-      const int num_entries = offsets[i + 1] - offsets[i];
-      std::copy_n(coeff_cell0.data() + offsets[i], num_entries,
-                  std::next(coeff_array.begin(), 2 * offsets[i]));
-      std::copy_n(coeff_cell1.data() + offsets[i], num_entries,
-                  std::next(coeff_array.begin(), offsets[i + 1] + offsets[i]));
-    }
-
     const int num_rows = bs0 * dmapjoint0.size();
     const int num_cols = bs1 * dmapjoint1.size();
 
     // Tabulate tensor
     Ae.resize(num_rows * num_cols);
     std::fill(Ae.begin(), Ae.end(), 0);
-
-    const int facets_per_cell = facets0.size();
-    const std::array perm{perms[cells[0] * facets_per_cell + local_facet[0]],
-                          perms[cells[1] * facets_per_cell + local_facet[1]]};
-    kernel(Ae.data(), coeff_array.data(), constants.data(),
-           coordinate_dofs.data(), local_facet.data(), perm.data());
+    kernel(Ae.data(), coeffs.row(f).data(), constants.data(),
+           coordinate_dofs.data(), facets.local_facets.data() + 2 * f,
+           facets.perms.data() + 2 * f);
 
     apply_dof_transformation(Ae, cell_info, cells[0], num_cols);
     apply_dof_transformation_to_transpose(Ae, cell_info, cells[0], num_rows);
@@ -407,14 +605,151 @@ void assemble_interior_facets(
   }
 }
 
-template <typename T>
-void assemble_matrix(
-    const std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
-                            const std::int32_t*, const T*)>& mat_set,
-    const Form<T>& a, const xtl::span<const T>& constants,
-    const array2d<T>& coeffs, const std::vector<bool>& bc0,
-    const std::vector<bool>& bc1)
+/// Execute kernel over interior facets and  accumulate result in Mat
+template <typename T, typename U>
+void assemble_interior_facets(
+    const U& mat_set, const mesh::Mesh& mesh,
+    const xtl::span<const std::int32_t>& active_facets,
+    const std::function<void(const xtl::span<T>&,
+                             const xtl::span<const std::uint32_t>&,
+                             std::int32_t, int)>& apply_dof_transformation,
+    const DofMap& dofmap0, int bs0,
+    const std::function<
+        void(const xtl::span<T>&, const xtl::span<const std::uint32_t>&,
+             std::int32_t, int)>& apply_dof_transformation_to_transpose,
+    const DofMap& dofmap1, int bs1, const std::vector<bool>& bc0,
+    const std::vector<bool>& bc1,
+    const std::function<void(T*, const T*, const T*, const double*, const int*,
+                             const std::uint8_t*)>& kernel,
+    const array2d<T>& coeffs, const xtl::span<const int>& offsets,
+    const xtl::span<const T>& constants,
+    const xtl::span<const std::uint32_t>& cell_info,
+    const xtl::span<const std::uint8_t>& perms)
+{
+  const InteriorFacets facets
+      = pack_interior_facets(mesh.topology(), active_facets, perms);
+  assemble_interior_facets<T>(
+      mat_set, mesh.geometry(), facets, apply_dof_transformation, dofmap0,
+      bs0, apply_dof_transformation_to_transpose, dofmap1, bs1, bc0, bc1,
+      kernel, pack_interior_facet_coefficients(coeffs, facets, offsets),
+      constants, cell_info);
+}
+
+/// Assemble a cell integral of a bilinear form over a subset of the
+/// integration domain
+/// @param[in] mat_set The function for adding values into the matrix
+/// @param[in] a The bilinear form
+/// @param[in] i The integral ID
+/// @param[in] cells The cells to assemble over
+/// @param[in] constants Packed constants that appear in `a`
+/// @param[in] coeffs Packed coefficients that appear in `a`
+/// @param[in] bc0 Boundary condition markers for the rows
+/// @param[in] bc1 Boundary condition markers for the columns
+/// @param[in] cell_info The cell permutation data
+/// @param[in] x_cells Packed coordinates of the cells `[c0, c0 + n)`,
+/// see impl::assemble_cells. Not used by batched kernels.
+/// @param[in] c0 The first cell in `x_cells`
+template <typename T, typename U>
+void assemble_cell_integral(const U& mat_set, const Form<T>& a, int i,
+                            const xtl::span<const std::int32_t>& cells,
+                            const xtl::span<const T>& constants,
+                            const array2d<T>& coeffs,
+                            const std::vector<bool>& bc0,
+                            const std::vector<bool>& bc1,
+                            const xtl::span<const std::uint32_t>& cell_info,
+                            const xtl::span<const double>& x_cells = {},
+                            std::int32_t c0 = 0)
 {
+  std::shared_ptr<const mesh::Mesh> mesh = a.mesh();
+  assert(mesh);
+  const fem::DofMap& dofmap0 = *a.function_spaces().at(0)->dofmap();
+  const fem::DofMap& dofmap1 = *a.function_spaces().at(1)->dofmap();
+  std::shared_ptr<const fem::FiniteElement> element0
+      = a.function_spaces().at(0)->element();
+  std::shared_ptr<const fem::FiniteElement> element1
+      = a.function_spaces().at(1)->element();
+  const std::function<void(const xtl::span<T>&,
+                           const xtl::span<const std::uint32_t>&, std::int32_t,
+                           int)>
+      apply_dof_transformation = element0->get_dof_transformation_function<T>();
+  const std::function<void(const xtl::span<T>&,
+                           const xtl::span<const std::uint32_t>&, std::int32_t,
+                           int)>
+      apply_dof_transformation_to_transpose
+      = element1->get_dof_transformation_to_transpose_function<T>();
+
+  // Elements that do not need dof transformations (e.g. Lagrange) are
+  // assembled by loops without any transformation calls
+  const bool transform = element0->needs_dof_transformations()
+                         or element1->needs_dof_transformations();
+  const auto batch = a.batch_kernel(IntegralType::cell, i);
+  if (batch.second > 0 and transform)
+  {
+    impl::assemble_cells_batched<T, true>(
+        mat_set, mesh->geometry(), cells, apply_dof_transformation,
+        dofmap0.list(), dofmap0.bs(), apply_dof_transformation_to_transpose,
+        dofmap1.list(), dofmap1.bs(), bc0, bc1, batch.first, batch.second,
+        coeffs, constants, cell_info);
+  }
+  else if (batch.second > 0)
+  {
+    impl::assemble_cells_batched<T, false>(
+        mat_set, mesh->geometry(), cells, apply_dof_transformation,
+        dofmap0.list(), dofmap0.bs(), apply_dof_transformation_to_transpose,
+        dofmap1.list(), dofmap1.bs(), bc0, bc1, batch.first, batch.second,
+        coeffs, constants, cell_info);
+  }
+  else
+  {
+    // Use compile-time block sizes for common cases, e.g. vector-valued
+    // spaces in 2D and 3D
+    const int bs0 = dofmap0.bs();
+    const int bs1 = dofmap1.bs();
+    auto assemble = [&](auto bs, auto _transform)
+    {
+      constexpr int _bs = decltype(bs)::value;
+      impl::assemble_cells<T, _bs, _bs, decltype(_transform)::value>(
+          mat_set, mesh->geometry(), cells, apply_dof_transformation,
+          dofmap0.list(), bs0, apply_dof_transformation_to_transpose,
+          dofmap1.list(), bs1, bc0, bc1, a.kernel(IntegralType::cell, i),
+          coeffs, constants, cell_info, x_cells, c0);
+    };
+    auto dispatch = [&](auto _transform)
+    {
+      if (bs0 == 1 and bs1 == 1)
+        assemble(std::integral_constant<int, 1>(), _transform);
+      else if (bs0 == 2 and bs1 == 2)
+        assemble(std::integral_constant<int, 2>(), _transform);
+      else if (bs0 == 3 and bs1 == 3)
+        assemble(std::integral_constant<int, 3>(), _transform);
+      else
+        assemble(std::integral_constant<int, -1>(), _transform);
+    };
+
+    if (transform)
+      dispatch(std::true_type());
+    else
+      dispatch(std::false_type());
+  }
+}
+
+/// Assemble the exterior and interior facet integrals of a bilinear
+/// form into a matrix. See impl::assemble_matrix.
+template <typename T, typename U>
+void assemble_facet_integrals(const U& mat_set, const Form<T>& a,
+                              const xtl::span<const T>& constants,
+                              const array2d<T>& coeffs,
+                              const std::vector<bool>& bc0,
+                              const std::vector<bool>& bc1,
+                              const xtl::span<const std::uint32_t>& cell_info,
+                              int num_threads)
+{
+  if (a.num_integrals(IntegralType::exterior_facet) == 0
+      and a.num_integrals(IntegralType::interior_facet) == 0)
+  {
+    return;
+  }
+
   std::shared_ptr<const mesh::Mesh> mesh = a.mesh();
   assert(mesh);
   const int tdim = mesh->topology().dim();
@@ -445,59 +780,154 @@ void assemble_matrix(
       apply_dof_transformation_to_transpose
       = element1->get_dof_transformation_to_transpose_function<T>();
 
-  const bool needs_transformation_data
-      = element0->needs_dof_transformations()
-        or element1->needs_dof_transformations()
-        or a.needs_facet_permutations();
-  xtl::span<const std::uint32_t> cell_info;
-  if (needs_transformation_data)
-  {
-    mesh->topology_mutable().create_entity_permutations();
-    cell_info = xtl::span(mesh->topology().get_cell_permutation_info());
-  }
-
-  for (int i : a.integral_ids(IntegralType::cell))
-  {
-    const auto& fn = a.kernel(IntegralType::cell, i);
-    const std::vector<std::int32_t>& active_cells
-        = a.domains(IntegralType::cell, i);
-    impl::assemble_cells<T>(mat_set, mesh->geometry(), active_cells,
-                            apply_dof_transformation, dofs0, bs0,
-                            apply_dof_transformation_to_transpose, dofs1, bs1,
-                            bc0, bc1, fn, coeffs, constants, cell_info);
-  }
+  mesh->topology_mutable().create_connectivity(tdim - 1, tdim);
+  mesh->topology_mutable().create_facet_permutations();
+  const std::vector<std::uint8_t>& perms
+      = mesh->topology().get_facet_permutations();
 
-  if (a.num_integrals(IntegralType::exterior_facet) > 0
-      or a.num_integrals(IntegralType::interior_facet) > 0)
+  for (int i : a.integral_ids(IntegralType::exterior_facet))
   {
-    mesh->topology_mutable().create_connectivity(tdim - 1, tdim);
-    mesh->topology_mutable().create_entity_permutations();
-    const std::vector<std::uint8_t>& perms
-        = mesh->topology().get_facet_permutations();
-
-    for (int i : a.integral_ids(IntegralType::exterior_facet))
+    const auto& fn = a.kernel(IntegralType::exterior_facet, i);
+    const std::vector<std::int32_t>& active_facets
+        = a.domains(IntegralType::exterior_facet, i);
+    auto assemble = [&](const xtl::span<const std::int32_t>& facets)
     {
-      const auto& fn = a.kernel(IntegralType::exterior_facet, i);
-      const std::vector<std::int32_t>& active_facets
-          = a.domains(IntegralType::exterior_facet, i);
       impl::assemble_exterior_facets<T>(
-          mat_set, *mesh, active_facets, apply_dof_transformation, dofs0, bs0,
+          mat_set, *mesh, facets, apply_dof_transformation, dofs0, bs0,
           apply_dof_transformation_to_transpose, dofs1, bs1, bc0, bc1, fn,
           coeffs, constants, cell_info, perms);
+    };
+
+    if (num_threads > 1)
+    {
+      impl::parallel_for_colours(
+          compute_colouring(mesh->topology(), dofs0,
+                            IntegralType::exterior_facet, active_facets),
+          num_threads, assemble);
     }
+    else
+      assemble(active_facets);
+  }
 
-    const std::vector<int> c_offsets = a.coefficient_offsets();
-    for (int i : a.integral_ids(IntegralType::interior_facet))
+  const std::vector<int> c_offsets = a.coefficient_offsets();
+  for (int i : a.integral_ids(IntegralType::interior_facet))
+  {
+    const auto& fn = a.kernel(IntegralType::interior_facet, i);
+    const std::vector<std::int32_t>& active_facets
+        = a.domains(IntegralType::interior_facet, i);
+    auto assemble = [&](const xtl::span<const std::int32_t>& facets)
     {
-      const auto& fn = a.kernel(IntegralType::interior_facet, i);
-      const std::vector<std::int32_t>& active_facets
-          = a.domains(IntegralType::interior_facet, i);
       impl::assemble_interior_facets<T>(
-          mat_set, *mesh, active_facets, apply_dof_transformation, *dofmap0,
-          bs0, apply_dof_transformation_to_transpose, *dofmap1, bs1, bc0, bc1,
+          mat_set, *mesh, facets, apply_dof_transformation, *dofmap0, bs0,
+          apply_dof_transformation_to_transpose, *dofmap1, bs1, bc0, bc1,
           fn, coeffs, c_offsets, constants, cell_info, perms);
+    };
+
+    if (num_threads > 1)
+    {
+      impl::parallel_for_colours(
+          compute_colouring(mesh->topology(), dofs0,
+                            IntegralType::interior_facet, active_facets),
+          num_threads, assemble);
+    }
+    else
+    {
+      // Stream through the cached facet data of the integral
+      const InteriorFacets& facets = a.interior_facets(i);
+      impl::assemble_interior_facets<T>(
+          mat_set, mesh->geometry(), facets, apply_dof_transformation,
+          *dofmap0, bs0, apply_dof_transformation_to_transpose, *dofmap1,
+          bs1, bc0, bc1, fn,
+          pack_interior_facet_coefficients(coeffs, facets, c_offsets),
+          constants, cell_info);
     }
   }
 }
 
+template <typename T, typename U>
+void assemble_matrix(const U& mat_set, const Form<T>& a,
+                     const xtl::span<const T>& constants,
+                     const array2d<T>& coeffs, const std::vector<bool>& bc0,
+                     const std::vector<bool>& bc1, int num_threads)
+{
+  std::shared_ptr<const mesh::Mesh> mesh = a.mesh();
+  assert(mesh);
+  const graph::AdjacencyList<std::int32_t>& dofs0
+      = a.function_spaces().at(0)->dofmap()->list();
+
+  const xtl::span<const std::uint32_t> cell_info = get_cell_info(a);
+  for (int i : a.integral_ids(IntegralType::cell))
+  {
+    const std::vector<std::int32_t>& active_cells
+        = a.domains(IntegralType::cell, i);
+    auto assemble = [&](const xtl::span<const std::int32_t>& cells)
+    {
+      assemble_cell_integral(mat_set, a, i, cells, constants, coeffs, bc0,
+                             bc1, cell_info);
+    };
+
+    if (num_threads > 1)
+    {
+      impl::parallel_for_colours(
+          compute_colouring(mesh->topology(), dofs0, IntegralType::cell,
+                            active_cells),
+          num_threads, assemble);
+    }
+    else
+      assemble(active_cells);
+  }
+
+  assemble_facet_integrals(mat_set, a, constants, coeffs, bc0, bc1, cell_info,
+                           num_threads);
+}
+
+/// Assemble a bilinear form into a matrix, with the cells of the cell
+/// integrals classified by the boundary conditions. See
+/// fem::assemble_matrix.
+template <typename T, typename U>
+void assemble_matrix(const U& mat_set, const Form<T>& a,
+                     const xtl::span<const T>& constants,
+                     const array2d<T>& coeffs,
+                     const ConstrainedCells<T>& cells)
+{
+  std::shared_ptr<const mesh::Mesh> mesh = a.mesh();
+  assert(mesh);
+  const fem::DofMap& dofmap0 = *a.function_spaces().at(0)->dofmap();
+  const fem::DofMap& dofmap1 = *a.function_spaces().at(1)->dofmap();
+  std::shared_ptr<const fem::FiniteElement> element0
+      = a.function_spaces().at(0)->element();
+  std::shared_ptr<const fem::FiniteElement> element1
+      = a.function_spaces().at(1)->element();
+  const std::function<void(const xtl::span<T>&,
+                           const xtl::span<const std::uint32_t>&, std::int32_t,
+                           int)>
+      apply_dof_transformation = element0->get_dof_transformation_function<T>();
+  const std::function<void(const xtl::span<T>&,
+                           const xtl::span<const std::uint32_t>&, std::int32_t,
+                           int)>
+      apply_dof_transformation_to_transpose
+      = element1->get_dof_transformation_to_transpose_function<T>();
+
+  const xtl::span<const std::uint32_t> cell_info = get_cell_info(a);
+  const std::vector<bool> no_bc;
+  for (int i : a.integral_ids(IntegralType::cell))
+  {
+    // Cells without constrained dofs, with no bc checks
+    assemble_cell_integral(mat_set, a, i, cells.unconstrained(i), constants,
+                           coeffs, no_bc, no_bc, cell_info);
+
+    // Cells with constrained dofs, with precomputed rows and columns to
+    // zero
+    assemble_constrained_cells<T>(
+        mat_set, mesh->geometry(), cells.constrained(i),
+        apply_dof_transformation, dofmap0.list(), dofmap0.bs(),
+        apply_dof_transformation_to_transpose, dofmap1.list(), dofmap1.bs(),
+        cells.zeroed(i, 0), cells.zeroed(i, 1),
+        a.kernel(IntegralType::cell, i), coeffs, constants, cell_info);
+  }
+
+  assemble_facet_integrals(mat_set, a, constants, coeffs, cells.markers(0),
+                           cells.markers(1), cell_info, 1);
+}
+
 } // namespace dolfinx::fem::impl
@@ -10,64 +10,83 @@
 #include "utils.h"
 #include <dolfinx/common/IndexMap.h>
 #include <dolfinx/common/types.h>
+#include <dolfinx/common/utils.h>
 #include <dolfinx/fem/Constant.h>
 #include <dolfinx/fem/FunctionSpace.h>
 #include <dolfinx/mesh/Geometry.h>
 #include <dolfinx/mesh/Mesh.h>
 #include <dolfinx/mesh/Topology.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <functional>
+#include <limits>
 #include <memory>
+#include <numeric>
+#include <utility>
 #include <vector>
 
 namespace dolfinx::fem::impl
 {
 
-/// Assemble functional over cells
+/// Assemble functional over cells for each row (ensemble member) of
+/// `constants`, adding the result for member `m` to `values[m]`
 template <typename T>
-T assemble_cells(const mesh::Geometry& geometry,
-                 const xtl::span<const std::int32_t>& active_cells,
-                 const std::function<void(T*, const T*, const T*, const double*,
-                                          const int*, const std::uint8_t*)>& fn,
-                 const xtl::span<const T>& constants, const array2d<T>& coeffs)
+void assemble_cells(xtl::span<T> values, const mesh::Geometry& geometry,
+                    const xtl::span<const std::int32_t>& active_cells,
+                    const std::function<void(T*, const T*, const T*,
+                                             const double*, const int*,
+                                             const std::uint8_t*)>& fn,
+                    const array2d<T>& constants, const array2d<T>& coeffs)
 {
+  assert(values.size() == constants.shape[0]);
+
   // Prepare cell geometry
   const graph::AdjacencyList<std::int32_t>& x_dofmap = geometry.dofmap();
 
   // FIXME: Add proper interface for num coordinate dofs
   const std::size_t num_dofs_g = x_dofmap.num_links(0);
-  const xt::xtensor<double, 2>& x_g = geometry.x();
+  const xtl::span<const double> x_packed = geometry.packed_coordinates();
 
   // Create data structures used in assembly
   std::vector<double> coordinate_dofs(3 * num_dofs_g);
 
   // Iterate over all cells
-  T value(0);
   for (std::int32_t c : active_cells)
   {
     // Get cell coordinates/geometry
-    auto x_dofs = x_dofmap.links(c);
-    for (std::size_t i = 0; i < x_dofs.size(); ++i)
+    const double* coords = coordinate_dofs.data();
+    if (!x_packed.empty())
+      coords = std::next(x_packed.data(), 3 * num_dofs_g * c);
+    else
     {
-      std::copy_n(xt::row(x_g, x_dofs[i]).begin(), 3,
-                  std::next(coordinate_dofs.begin(), 3 * i));
+      geometry.cell_coordinates(c, coordinate_dofs);
     }
 
+    // The geometry and coefficients of the cell are shared by all
+    // ensemble members
     auto coeff_cell = coeffs.row(c);
-    fn(&value, coeff_cell.data(), constants.data(), coordinate_dofs.data(),
-       nullptr, nullptr);
+    for (std::size_t m = 0; m < values.size(); ++m)
+    {
+      fn(&values[m], coeff_cell.data(), constants.row(m).data(), coords,
+         nullptr, nullptr);
+    }
   }
-
-  return value;
 }
 
-/// Execute kernel over exterior facets and accumulate result
+/// Execute kernel over exterior facets and accumulate result for each
+/// row (ensemble member) of `constants`
 template <typename T>
-T assemble_exterior_facets(
-    const mesh::Mesh& mesh, const xtl::span<const std::int32_t>& active_facets,
+void assemble_exterior_facets(
+    xtl::span<T> values, const mesh::Mesh& mesh,
+    const xtl::span<const std::int32_t>& active_facets,
     const std::function<void(T*, const T*, const T*, const double*, const int*,
                              const std::uint8_t*)>& fn,
-    const xtl::span<const T>& constants, const array2d<T>& coeffs,
+    const array2d<T>& constants, const array2d<T>& coeffs,
     const xtl::span<const std::uint8_t>& perms)
 {
+  assert(values.size() == constants.shape[0]);
+
   const int tdim = mesh.topology().dim();
 
   // Prepare cell geometry
@@ -75,7 +94,9 @@ T assemble_exterior_facets(
 
   // FIXME: Add proper interface for num coordinate dofs
   const std::size_t num_dofs_g = x_dofmap.num_links(0);
-  const xt::xtensor<double, 2>& x_g = mesh.geometry().x();
+  const mesh::Geometry& geometry = mesh.geometry();
+  const xtl::span<const double> x_packed
+      = mesh.geometry().packed_coordinates();
 
   // Create data structures used in assembly
   std::vector<double> coordinate_dofs(3 * num_dofs_g);
@@ -86,7 +107,6 @@ T assemble_exterior_facets(
   assert(c_to_f);
 
   // Iterate over all facets
-  T value(0);
   for (std::int32_t facet : active_facets)
   {
     // Create attached cell
@@ -100,31 +120,37 @@ T assemble_exterior_facets(
     const int local_facet = std::distance(facets.data(), it);
 
     // Get cell coordinates/geometry
-    auto x_dofs = x_dofmap.links(cell);
-    for (std::size_t i = 0; i < x_dofs.size(); ++i)
+    const double* coords = coordinate_dofs.data();
+    if (!x_packed.empty())
+      coords = std::next(x_packed.data(), 3 * num_dofs_g * cell);
+    else
     {
-      std::copy_n(xt::row(x_g, x_dofs[i]).begin(), 3,
-                  std::next(coordinate_dofs.begin(), 3 * i));
+      geometry.cell_coordinates(cell, coordinate_dofs);
     }
 
     auto coeff_cell = coeffs.row(cell);
-    fn(&value, coeff_cell.data(), constants.data(), coordinate_dofs.data(),
-       &local_facet, &perms[cell * facets.size() + local_facet]);
+    for (std::size_t m = 0; m < values.size(); ++m)
+    {
+      fn(&values[m], coeff_cell.data(), constants.row(m).data(), coords,
+         &local_facet, &perms[cell * facets.size() + local_facet]);
+    }
   }
-
-  return value;
 }
 
-/// Assemble functional over interior facets
+/// Assemble functional over interior facets for each row (ensemble
+/// member) of `constants`
 template <typename T>
-T assemble_interior_facets(
-    const mesh::Mesh& mesh, const xtl::span<const std::int32_t>& active_facets,
+void assemble_interior_facets(
+    xtl::span<T> values, const mesh::Mesh& mesh,
+    const xtl::span<const std::int32_t>& active_facets,
     const std::function<void(T*, const T*, const T*, const double*, const int*,
                              const std::uint8_t*)>& fn,
-    const xtl::span<const T>& constants, const array2d<T>& coeffs,
+    const array2d<T>& constants, const array2d<T>& coeffs,
     const xtl::span<const int>& offsets,
     const xtl::span<const std::uint8_t>& perms)
 {
+  assert(values.size() == constants.shape[0]);
+
   const int tdim = mesh.topology().dim();
 
   // Prepare cell geometry
@@ -132,7 +158,7 @@ T assemble_interior_facets(
 
   // FIXME: Add proper interface for num coordinate dofs
   const std::size_t num_dofs_g = x_dofmap.num_links(0);
-  const xt::xtensor<double, 2>& x_g = mesh.geometry().x();
+  const mesh::Geometry& geometry = mesh.geometry();
 
   // Create data structures used in assembly
   xt::xtensor<double, 3> coordinate_dofs({2, num_dofs_g, 3});
@@ -145,7 +171,6 @@ T assemble_interior_facets(
   assert(c_to_f);
 
   // Iterate over all facets
-  T value = 0;
   for (std::int32_t f : active_facets)
   {
     // Create attached cell
@@ -165,18 +190,12 @@ T assemble_interior_facets(
     }
 
     // Get cell geometry
-    auto x_dofs0 = x_dofmap.links(cells[0]);
-    for (std::size_t i = 0; i < x_dofs0.size(); ++i)
-    {
-      std::copy_n(xt::view(x_g, x_dofs0[i]).begin(), 3,
-                  xt::view(coordinate_dofs, 0, i, xt::all()).begin());
-    }
-    auto x_dofs1 = x_dofmap.links(cells[1]);
-    for (std::size_t i = 0; i < x_dofs1.size(); ++i)
-    {
-      std::copy_n(xt::view(x_g, x_dofs1[i]).begin(), 3,
-                  xt::view(coordinate_dofs, 1, i, xt::all()).begin());
-    }
+    geometry.cell_coordinates(
+        cells[0], xtl::span<double>(coordinate_dofs.data(), 3 * num_dofs_g));
+    geometry.cell_coordinates(
+        cells[1], xtl::span<double>(std::next(coordinate_dofs.data(),
+                                              3 * num_dofs_g),
+                                    3 * num_dofs_g));
 
     // Layout for the restricted coefficients is flattened
     // w[coefficient][restriction][dof]
@@ -196,64 +215,224 @@ T assemble_interior_facets(
 
     const std::array perm{perms[cells[0] * facets_per_cell + local_facet[0]],
                           perms[cells[1] * facets_per_cell + local_facet[1]]};
-    fn(&value, coeff_array.data(), constants.data(), coordinate_dofs.data(),
-       local_facet.data(), perm.data());
+    for (std::size_t m = 0; m < values.size(); ++m)
+    {
+      fn(&values[m], coeff_array.data(), constants.row(m).data(),
+         coordinate_dofs.data(), local_facet.data(), perm.data());
+    }
   }
-
-  return value;
 }
 
-/// Assemble functional into an scalar
+/// Assemble functional for each row (ensemble member) of `constants`.
+///
+/// The integration domains are split into chunks with a fixed number of
+/// entities. The contribution of each chunk is computed separately,
+/// concurrently if `num_threads > 1`, and the chunk contributions are
+/// summed pairwise in a fixed order. The result is therefore bitwise
+/// independent of the number of threads.
+///
+/// If `num_threads > 1`, the chunks of all integrals are scheduled
+/// together, and are taken by the threads as they become idle. The
+/// cost of each integral is measured on the first threaded assembly
+/// (see Form::cost), and on later assemblies consecutive chunks of an
+/// integral are grouped into tasks with similar costs, which are
+/// scheduled from the most to the least expensive.
+/// @param[in] M The form (functional) to assemble
+/// @param[in] constants The constants of each ensemble member (row),
+/// as produced by fem::pack_constants
+/// @param[in] coeffs The coefficients that appear in `M`
+/// @param[in] num_threads The number of threads to use
+/// @return The value of the functional for each ensemble member
 template <typename T>
-T assemble_scalar(const fem::Form<T>& M, const xtl::span<const T>& constants,
-                  const array2d<T>& coeffs)
+std::vector<T> assemble_scalar(const fem::Form<T>& M,
+                               const array2d<T>& constants,
+                               const array2d<T>& coeffs, int num_threads = 1)
 {
   std::shared_ptr<const mesh::Mesh> mesh = M.mesh();
   assert(mesh);
   const int tdim = mesh->topology().dim();
 
-  T value(0);
+  // Collect the integrals, each as a function that assembles over a
+  // subset of its domain
+  using Integral = std::function<void(xtl::span<T>,
+                                      const xtl::span<const std::int32_t>&)>;
+  std::vector<std::pair<Integral, xtl::span<const std::int32_t>>> integrals;
+  std::vector<std::pair<IntegralType, int>> ids;
   for (int i : M.integral_ids(IntegralType::cell))
   {
-    const auto& fn = M.kernel(IntegralType::cell, i);
-    const std::vector<std::int32_t>& active_cells
-        = M.domains(IntegralType::cell, i);
-    value += impl::assemble_cells(mesh->geometry(), active_cells, fn, constants,
-                                  coeffs);
+    ids.emplace_back(IntegralType::cell, i);
+    integrals.emplace_back(
+        [&, &fn = M.kernel(IntegralType::cell, i)](
+            xtl::span<T> values, const xtl::span<const std::int32_t>& cells)
+        {
+          impl::assemble_cells(values, mesh->geometry(), cells, fn, constants,
+                               coeffs);
+        },
+        M.domains(IntegralType::cell, i));
   }
 
+  const std::vector<int> c_offsets = M.coefficient_offsets();
   if (M.num_integrals(IntegralType::exterior_facet) > 0
       or M.num_integrals(IntegralType::interior_facet) > 0)
   {
     // FIXME: cleanup these calls? Some of these happen internally again.
     mesh->topology_mutable().create_entities(tdim - 1);
     mesh->topology_mutable().create_connectivity(tdim - 1, tdim);
-    mesh->topology_mutable().create_entity_permutations();
-
-    const std::vector<std::uint8_t>& perms
-        = mesh->topology().get_facet_permutations();
+    mesh->topology_mutable().create_facet_permutations();
 
+    const xtl::span<const std::uint8_t> perms(
+        mesh->topology().get_facet_permutations());
     for (int i : M.integral_ids(IntegralType::exterior_facet))
     {
-      const auto& fn = M.kernel(IntegralType::exterior_facet, i);
-      const std::vector<std::int32_t>& active_facets
-          = M.domains(IntegralType::exterior_facet, i);
-      value += impl::assemble_exterior_facets(*mesh, active_facets, fn,
-                                              constants, coeffs, perms);
+      ids.emplace_back(IntegralType::exterior_facet, i);
+      integrals.emplace_back(
+          [&, perms, &fn = M.kernel(IntegralType::exterior_facet, i)](
+              xtl::span<T> values, const xtl::span<const std::int32_t>& facets)
+          {
+            impl::assemble_exterior_facets(values, *mesh, facets, fn,
+                                           constants, coeffs, perms);
+          },
+          M.domains(IntegralType::exterior_facet, i));
     }
 
-    const std::vector<int> c_offsets = M.coefficient_offsets();
     for (int i : M.integral_ids(IntegralType::interior_facet))
     {
-      const auto& fn = M.kernel(IntegralType::interior_facet, i);
-      const std::vector<std::int32_t>& active_facets
-          = M.domains(IntegralType::interior_facet, i);
-      value += impl::assemble_interior_facets(
-          *mesh, active_facets, fn, constants, coeffs, c_offsets, perms);
+      ids.emplace_back(IntegralType::interior_facet, i);
+      integrals.emplace_back(
+          [&, perms, &fn = M.kernel(IntegralType::interior_facet, i)](
+              xtl::span<T> values, const xtl::span<const std::int32_t>& facets)
+          {
+            impl::assemble_interior_facets(values, *mesh, facets, fn,
+                                           constants, coeffs, c_offsets,
+                                           perms);
+          },
+          M.domains(IntegralType::interior_facet, i));
+    }
+  }
+
+  // Split the domains into chunks (integral, offset, size). The chunks
+  // do not depend on the number of threads.
+  constexpr std::size_t chunk_size = 256;
+  std::vector<std::array<std::size_t, 3>> chunks;
+  for (std::size_t k = 0; k < integrals.size(); ++k)
+  {
+    const std::size_t n = integrals[k].second.size();
+    for (std::size_t offset = 0; offset < n; offset += chunk_size)
+      chunks.push_back({k, offset, std::min(chunk_size, n - offset)});
+  }
+
+  const std::size_t num_chunks = chunks.size();
+
+  // Get the measured cost of each chunk
+  std::vector<double> chunk_cost(num_chunks, 0);
+  bool measured = true;
+  for (std::size_t c = 0; c < num_chunks; ++c)
+  {
+    auto [k, offset, size] = chunks[c];
+    chunk_cost[c] = M.cost(ids[k].first, ids[k].second) * size;
+    measured = measured and chunk_cost[c] > 0;
+  }
+
+  // Group consecutive chunks of an integral into tasks [c0, c1), with a
+  // cost of about 1/8 of the cost per thread. Without measured costs,
+  // each chunk is a task and the costs are measured.
+  std::vector<std::array<std::size_t, 2>> tasks;
+  const bool measure = num_threads > 1 and !measured;
+  if (num_threads > 1 and measured)
+  {
+    const double target
+        = std::accumulate(chunk_cost.begin(), chunk_cost.end(), 0.0)
+          / (8 * num_threads);
+    std::vector<double> task_cost;
+    for (std::size_t c = 0; c < num_chunks; ++c)
+    {
+      if (tasks.empty() or chunks[c][0] != chunks[c - 1][0]
+          or task_cost.back() + chunk_cost[c] > target)
+      {
+        tasks.push_back({c, c});
+        task_cost.push_back(0);
+      }
+      tasks.back()[1] = c + 1;
+      task_cost.back() += chunk_cost[c];
     }
+
+    std::vector<std::size_t> order(tasks.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&task_cost](std::size_t a, std::size_t b)
+                     { return task_cost[a] > task_cost[b]; });
+    std::vector<std::array<std::size_t, 2>> sorted(tasks.size());
+    for (std::size_t j = 0; j < order.size(); ++j)
+      sorted[j] = tasks[order[j]];
+    tasks = std::move(sorted);
   }
+  else
+  {
+    for (std::size_t c = 0; c < num_chunks; ++c)
+      tasks.push_back({c, c + 1});
+  }
+
+  // Compute the contribution of each chunk
+  const std::size_t num_members = constants.shape[0];
+  array2d<T> partial_values(chunks.size(), num_members, 0);
+  std::vector<double> chunk_time(measure ? num_chunks : 0, 0);
+  auto assemble = [&](std::int64_t j, int)
+  {
+    for (std::size_t c = tasks[j][0]; c < tasks[j][1]; ++c)
+    {
+      auto [k, offset, size] = chunks[c];
+      const auto t0 = std::chrono::steady_clock::now();
+      integrals[k].first(partial_values.row(c),
+                         integrals[k].second.subspan(offset, size));
+      if (measure)
+      {
+        chunk_time[c] = std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() - t0)
+                            .count();
+      }
+    }
+  };
+  common::for_each_task(tasks.size(), num_threads, assemble);
 
-  return value;
+  // Store the measured cost per entity of each integral
+  if (measure)
+  {
+    std::vector<double> time(integrals.size(), 0);
+    for (std::size_t c = 0; c < num_chunks; ++c)
+      time[chunks[c][0]] += chunk_time[c];
+    for (std::size_t k = 0; k < integrals.size(); ++k)
+    {
+      if (const std::size_t n = integrals[k].second.size(); n > 0)
+      {
+        M.set_cost(ids[k].first, ids[k].second,
+                   std::max(time[k] / n, std::numeric_limits<double>::min()));
+      }
+    }
+  }
+
+  // Sum the chunk contributions in chunk order
+  std::vector<T> values(num_members, 0);
+  std::vector<T> column(num_chunks);
+  for (std::size_t m = 0; m < num_members; ++m)
+  {
+    for (std::size_t c = 0; c < num_chunks; ++c)
+      column[c] = partial_values(c, m);
+    values[m] = common::pairwise_sum(column.begin(), column.end());
+  }
+
+  return values;
+}
+
+/// Assemble functional into an scalar. See the ensemble version of
+/// this function for the threaded, reproducible summation.
+template <typename T>
+T assemble_scalar(const fem::Form<T>& M, const xtl::span<const T>& constants,
+                  const array2d<T>& coeffs, int num_threads = 1)
+{
+  // Single ensemble member
+  array2d<T> _constants(1, constants.size());
+  std::copy(constants.begin(), constants.end(), _constants.data());
+  return impl::assemble_scalar(M, _constants, coeffs, num_threads).front();
 }
 
 } // namespace dolfinx::fem::impl
@@ -7,19 +7,26 @@
 #pragma once
 
 #include "DirichletBC.h"
+#include "DirichletBCs.h"
 #include "DofMap.h"
 #include "Form.h"
+#include "InteriorFacets.h"
 #include "utils.h"
 #include <dolfinx/common/IndexMap.h>
 #include <dolfinx/common/types.h>
 #include <dolfinx/fem/Constant.h>
 #include <dolfinx/fem/FunctionSpace.h>
 #include <dolfinx/graph/AdjacencyList.h>
+#include <dolfinx/la/Vector.h>
 #include <dolfinx/mesh/Geometry.h>
 #include <dolfinx/mesh/Mesh.h>
 #include <dolfinx/mesh/Topology.h>
+#include <algorithm>
 #include <functional>
 #include <memory>
+#include <set>
+#include <stdexcept>
+#include <type_traits>
 #include <vector>
 #include <xtensor/xbuilder.hpp>
 #include <xtensor/xtensor.hpp>
@@ -63,7 +70,6 @@ void _lift_bc_cells(
 
   // FIXME: Add proper interface for num coordinate dofs
   const std::size_t num_dofs_g = x_dofmap.num_links(0);
-  const xt::xtensor<double, 2>& x_g = geometry.x();
 
   // Data structures used in bc application
   std::vector<double> coordinate_dofs(3 * num_dofs_g);
@@ -107,12 +113,7 @@ void _lift_bc_cells(
       continue;
 
     // Get cell coordinates/geometry
-    auto x_dofs = x_dofmap.links(c);
-    for (std::size_t i = 0; i < x_dofs.size(); ++i)
-    {
-      std::copy_n(xt::row(x_g, x_dofs[i]).begin(), 3,
-                  std::next(coordinate_dofs.begin(), i * 3));
-    }
+    geometry.cell_coordinates(c, coordinate_dofs);
 
     // Size data structure for assembly
     auto dmap0 = dofmap0.links(c);
@@ -217,7 +218,9 @@ void _lift_bc_exterior_facets(
 
   // FIXME: Add proper interface for num coordinate dofs
   const std::size_t num_dofs_g = x_dofmap.num_links(0);
-  const xt::xtensor<double, 2>& x_g = mesh.geometry().x();
+  const mesh::Geometry& geometry = mesh.geometry();
+  const xtl::span<const double> x_packed
+      = mesh.geometry().packed_coordinates();
 
   // Data structures used in bc application
   std::vector<double> coordinate_dofs(3 * num_dofs_g);
@@ -265,11 +268,12 @@ void _lift_bc_exterior_facets(
       continue;
 
     // Get cell coordinates/geometry
-    auto x_dofs = x_dofmap.links(cell);
-    for (std::size_t i = 0; i < x_dofs.size(); ++i)
+    const double* coords = coordinate_dofs.data();
+    if (!x_packed.empty())
+      coords = std::next(x_packed.data(), 3 * num_dofs_g * cell);
+    else
     {
-      std::copy_n(xt::row(x_g, x_dofs[i]).begin(), 3,
-                  std::next(coordinate_dofs.begin(), 3 * i));
+      geometry.cell_coordinates(cell, coordinate_dofs);
     }
 
     // Size data structure for assembly
@@ -281,9 +285,8 @@ void _lift_bc_exterior_facets(
     auto coeff_array = coeffs.row(cell);
     Ae.resize(num_rows * num_cols);
     std::fill(Ae.begin(), Ae.end(), 0);
-    kernel(Ae.data(), coeff_array.data(), constants.data(),
-           coordinate_dofs.data(), &local_facet,
-           &perms[cell * facets.size() + local_facet]);
+    kernel(Ae.data(), coeff_array.data(), constants.data(), coords,
+           &local_facet, &perms[cell * facets.size() + local_facet]);
     apply_dof_transformation(Ae, cell_info, cell, num_cols);
     apply_dof_transformation_to_transpose(Ae, cell_info, cell, num_rows);
 
@@ -346,7 +349,7 @@ void _lift_bc_interior_facets(
 
   // FIXME: Add proper interface for num coordinate dofs
   const std::size_t num_dofs_g = x_dofmap.num_links(0);
-  const xt::xtensor<double, 2>& x_g = mesh.geometry().x();
+  const mesh::Geometry& geometry = mesh.geometry();
 
   // Data structures used in assembly
   xt::xtensor<double, 3> coordinate_dofs({2, num_dofs_g, 3});
@@ -386,18 +389,12 @@ void _lift_bc_interior_facets(
     const std::array local_facet{local_facet0, local_facet1};
 
     // Get cell geometry
-    auto x_dofs0 = x_dofmap.links(cells[0]);
-    for (std::size_t i = 0; i < x_dofs0.size(); ++i)
-    {
-      std::copy_n(xt::view(x_g, x_dofs0[i]).begin(), 3,
-                  xt::view(coordinate_dofs, 0, i, xt::all()).begin());
-    }
-    auto x_dofs1 = x_dofmap.links(cells[1]);
-    for (std::size_t i = 0; i < x_dofs1.size(); ++i)
-    {
-      std::copy_n(xt::view(x_g, x_dofs1[i]).begin(), 3,
-                  xt::view(coordinate_dofs, 1, i, xt::all()).begin());
-    }
+    geometry.cell_coordinates(
+        cells[0], xtl::span<double>(coordinate_dofs.data(), 3 * num_dofs_g));
+    geometry.cell_coordinates(
+        cells[1], xtl::span<double>(std::next(coordinate_dofs.data(),
+                                              3 * num_dofs_g),
+                                    3 * num_dofs_g));
 
     // Get dof maps for cells and pack
     const xtl::span<const std::int32_t> dmap0_cell0 = dofmap0.links(cells[0]);
@@ -530,18 +527,31 @@ void _lift_bc_interior_facets(
 /// less than zero the block size is determined at runtime. If `_bs` is
 /// positive the block size is used as a compile-time constant, which
 /// has performance benefits.
-template <typename T, int _bs = -1>
+/// @tparam _transform If false, the dof transformation is not applied.
+/// Use only when the element does not need dof transformations.
+/// @tparam DofList The type of the dofmap data, either
+/// graph::AdjacencyList or graph::CompressedAdjacencyList, in which
+/// case the dofs are decoded in the scatter loop
+/// @param[in] x_cells Coordinates of the geometry dofs of the cells
+/// `[c0, c0 + n)`, packed by cell as in mesh::Geometry::packed_coordinates,
+/// e.g. gathered once for several forms. It must contain the cells in
+/// `active_cells`. If empty, the coordinates are read from the
+/// geometry.
+/// @param[in] c0 The first cell in `x_cells`
+template <typename T, int _bs = -1, bool _transform = true,
+          typename DofList = graph::AdjacencyList<std::int32_t>>
 void assemble_cells(
     const std::function<void(const xtl::span<T>&,
                              const xtl::span<const std::uint32_t>&,
                              std::int32_t, int)>& apply_dof_transformation,
     xtl::span<T> b, const mesh::Geometry& geometry,
-    const xtl::span<const std::int32_t>& active_cells,
-    const graph::AdjacencyList<std::int32_t>& dofmap, int bs,
+    const xtl::span<const std::int32_t>& active_cells, const DofList& dofmap,
+    int bs,
     const std::function<void(T*, const T*, const T*, const double*, const int*,
                              const std::uint8_t*)>& kernel,
     const xtl::span<const T>& constants, const array2d<T>& coeffs,
-    const xtl::span<const std::uint32_t>& cell_info)
+    const xtl::span<const std::uint32_t>& cell_info,
+    const xtl::span<const double>& x_cells = {}, std::int32_t c0 = 0)
 {
   assert(_bs < 0 or _bs == bs);
 
@@ -550,7 +560,9 @@ void assemble_cells(
 
   // FIXME: Add proper interface for num coordinate dofs
   const int num_dofs_g = x_dofmap.num_links(0);
-  const xt::xtensor<double, 2>& x_g = geometry.x();
+  const xtl::span<const double> x_packed
+      = x_cells.empty() ? geometry.packed_coordinates() : x_cells;
+  const std::int32_t x_offset = x_cells.empty() ? 0 : c0;
 
   // FIXME: Add proper interface for num_dofs
   // Create data structures used in assembly
@@ -563,18 +575,24 @@ void assemble_cells(
   for (std::int32_t c : active_cells)
   {
     // Get cell coordinates/geometry
-    auto x_dofs = x_dofmap.links(c);
-    for (std::size_t i = 0; i < x_dofs.size(); ++i)
+    const double* coords = coordinate_dofs.data();
+    if (!x_packed.empty())
+      coords = std::next(x_packed.data(), 3 * num_dofs_g * (c - x_offset));
+    else
     {
-      std::copy_n(xt::row(x_g, x_dofs[i]).begin(), 3,
-                  std::next(coordinate_dofs.begin(), 3 * i));
+      geometry.cell_coordinates(c, coordinate_dofs);
     }
 
     // Tabulate vector for cell
     std::fill(be.begin(), be.end(), 0);
-    kernel(be.data(), coeffs.row(c).data(), constants.data(),
-           coordinate_dofs.data(), nullptr, nullptr);
-    apply_dof_transformation(_be, cell_info, c, 1);
+    kernel(be.data(), coeffs.row(c).data(), constants.data(), coords, nullptr,
+           nullptr);
+    if constexpr (_transform)
+    {
+      // The transformation is the identity if cell_info[c] is zero
+      if (cell_info.empty() or cell_info[c] != 0)
+        apply_dof_transformation(_be, cell_info, c, 1);
+    }
 
     // Scatter cell vector to 'global' vector array
     auto dofs = dofmap.links(c);
@@ -593,6 +611,165 @@ void assemble_cells(
   }
 }
 
+/// Execute a batched kernel over cells and accumulate result in
+/// vector. See Form::set_batch_kernel for the data layout.
+template <typename T, bool _transform = true>
+void assemble_cells_batched(
+    const std::function<void(const xtl::span<T>&,
+                             const xtl::span<const std::uint32_t>&,
+                             std::int32_t, int)>& apply_dof_transformation,
+    xtl::span<T> b, const mesh::Geometry& geometry,
+    const xtl::span<const std::int32_t>& active_cells,
+    const graph::AdjacencyList<std::int32_t>& dofmap, int bs,
+    const std::function<void(T*, const T*, const T*, const double*, const int*,
+                             const std::uint8_t*)>& kernel,
+    int batch_size, const xtl::span<const T>& constants,
+    const array2d<T>& coeffs, const xtl::span<const std::uint32_t>& cell_info)
+{
+  // Prepare cell geometry
+  const graph::AdjacencyList<std::int32_t>& x_dofmap = geometry.dofmap();
+
+  // FIXME: Add proper interface for num coordinate dofs
+  const int num_dofs_g = x_dofmap.num_links(0);
+
+  // Create data structures used in assembly
+  const int num_dofs = dofmap.links(0).size();
+  const std::size_t num_coeffs = coeffs.shape[1];
+  std::vector<T> be(bs * num_dofs);
+  const xtl::span<T> _be(be);
+
+  // Batch data, interleaved by cell
+  std::vector<T> bb(be.size() * batch_size);
+  std::vector<T> wb(num_coeffs * batch_size);
+  std::vector<double> coordinate_dofs(3 * num_dofs_g * batch_size);
+  std::vector<double> x_c(3 * num_dofs_g);
+
+  for (std::size_t p = 0; p < active_cells.size(); p += batch_size)
+  {
+    // Pack batch. A partial batch is padded by repeating the last cell.
+    const std::size_t num_cells
+        = std::min<std::size_t>(batch_size, active_cells.size() - p);
+    for (int k = 0; k < batch_size; ++k)
+    {
+      const std::int32_t c
+          = active_cells[p + std::min<std::size_t>(k, num_cells - 1)];
+      geometry.cell_coordinates(c, x_c);
+      for (std::size_t i = 0; i < x_c.size(); ++i)
+        coordinate_dofs[i * batch_size + k] = x_c[i];
+      const T* w = coeffs.row(c).data();
+      for (std::size_t j = 0; j < num_coeffs; ++j)
+        wb[j * batch_size + k] = w[j];
+    }
+
+    // Tabulate vectors for the batch
+    std::fill(bb.begin(), bb.end(), 0);
+    kernel(bb.data(), wb.data(), constants.data(), coordinate_dofs.data(),
+           nullptr, nullptr);
+
+    // Unpack and scatter each cell vector to 'global' vector array
+    for (std::size_t k = 0; k < num_cells; ++k)
+    {
+      const std::int32_t c = active_cells[p + k];
+      for (std::size_t j = 0; j < be.size(); ++j)
+        be[j] = bb[j * batch_size + k];
+      if constexpr (_transform)
+      {
+        if (cell_info.empty() or cell_info[c] != 0)
+          apply_dof_transformation(_be, cell_info, c, 1);
+      }
+
+      auto dofs = dofmap.links(c);
+      for (int i = 0; i < num_dofs; ++i)
+        for (int j = 0; j < bs; ++j)
+          b[bs * dofs[i] + j] += be[bs * i + j];
+    }
+  }
+}
+
+/// Execute the cell kernels of several linear forms with the same test
+/// space over cells and accumulate the results in a multi-column
+/// vector. The entry for column `j` of (unrolled) row `i` is stored at
+/// `b[i * num_columns + j]`.
+/// @tparam T The scalar type
+/// @tparam _bs The block size of the form test function dof map. If
+/// less than zero the block size is determined at runtime.
+/// @tparam _transform If false, the dof transformation is not applied.
+/// Use only when the element does not need dof transformations.
+/// @param[in] columns The column of `b` that each kernel is assembled
+/// into
+template <typename T, int _bs = -1, bool _transform = true>
+void assemble_cells_multi(
+    const std::function<void(const xtl::span<T>&,
+                             const xtl::span<const std::uint32_t>&,
+                             std::int32_t, int)>& apply_dof_transformation,
+    xtl::span<T> b, int num_columns, const std::vector<int>& columns,
+    const mesh::Geometry& geometry,
+    const xtl::span<const std::int32_t>& active_cells,
+    const graph::AdjacencyList<std::int32_t>& dofmap, int bs,
+    const std::vector<std::reference_wrapper<const std::function<void(
+        T*, const T*, const T*, const double*, const int*,
+        const std::uint8_t*)>>>& kernels,
+    const std::vector<xtl::span<const T>>& constants,
+    const std::vector<std::reference_wrapper<const array2d<T>>>& coeffs,
+    const xtl::span<const std::uint32_t>& cell_info)
+{
+  assert(_bs < 0 or _bs == bs);
+  assert(columns.size() == kernels.size());
+  assert(constants.size() == kernels.size());
+  assert(coeffs.size() == kernels.size());
+  const int block_size = _bs > 0 ? _bs : bs;
+
+  // Prepare cell geometry
+  const graph::AdjacencyList<std::int32_t>& x_dofmap = geometry.dofmap();
+  const int num_dofs_g = x_dofmap.num_links(0);
+  const xtl::span<const double> x_packed = geometry.packed_coordinates();
+
+  // Cell vectors of all kernels, stored one after the other
+  const int num_dofs = dofmap.links(0).size();
+  const int ndim = block_size * num_dofs;
+  std::vector<double> coordinate_dofs(3 * num_dofs_g);
+  std::vector<T> be(ndim * kernels.size());
+
+  for (std::int32_t c : active_cells)
+  {
+    // Get cell coordinates/geometry
+    const double* coords = coordinate_dofs.data();
+    if (!x_packed.empty())
+      coords = std::next(x_packed.data(), 3 * num_dofs_g * c);
+    else
+    {
+      geometry.cell_coordinates(c, coordinate_dofs);
+    }
+
+    // Tabulate the cell vector of each kernel
+    std::fill(be.begin(), be.end(), 0);
+    for (std::size_t k = 0; k < kernels.size(); ++k)
+    {
+      const xtl::span<T> _be(be.data() + k * ndim, ndim);
+      kernels[k].get()(_be.data(), coeffs[k].get().row(c).data(),
+                       constants[k].data(), coords, nullptr, nullptr);
+      if constexpr (_transform)
+      {
+        if (cell_info.empty() or cell_info[c] != 0)
+          apply_dof_transformation(_be, cell_info, c, 1);
+      }
+    }
+
+    // Scatter cell vectors to the multi-column array, with the columns
+    // of a row adjacent in memory
+    auto dofs = dofmap.links(c);
+    for (int i = 0; i < num_dofs; ++i)
+    {
+      for (int j = 0; j < block_size; ++j)
+      {
+        T* b_row = b.data() + (block_size * dofs[i] + j) * num_columns;
+        for (std::size_t k = 0; k < kernels.size(); ++k)
+          b_row[columns[k]] += be[k * ndim + block_size * i + j];
+      }
+    }
+  }
+}
+
 /// Execute kernel over cells and accumulate result in vector
 /// @tparam T The scalar type
 /// @tparam _bs The block size of the form test function dof map. If
@@ -622,7 +799,9 @@ void assemble_exterior_facets(
 
   // FIXME: Add proper interface for num coordinate dofs
   const std::size_t num_dofs_g = x_dofmap.num_links(0);
-  const xt::xtensor<double, 2>& x_g = mesh.geometry().x();
+  const mesh::Geometry& geometry = mesh.geometry();
+  const xtl::span<const double> x_packed
+      = mesh.geometry().packed_coordinates();
 
   // FIXME: Add proper interface for num_dofs
   // Create data structures used in assembly
@@ -648,18 +827,18 @@ void assemble_exterior_facets(
     const int local_facet = std::distance(facets.begin(), it);
 
     // Get cell coordinates/geometry
-    auto x_dofs = x_dofmap.links(cell);
-    for (std::size_t i = 0; i < x_dofs.size(); ++i)
+    const double* coords = coordinate_dofs.data();
+    if (!x_packed.empty())
+      coords = std::next(x_packed.data(), 3 * num_dofs_g * cell);
+    else
     {
-      std::copy_n(xt::row(x_g, x_dofs[i]).begin(), 3,
-                  std::next(coordinate_dofs.begin(), 3 * i));
+      geometry.cell_coordinates(cell, coordinate_dofs);
     }
 
     // Tabulate element vector
     std::fill(be.begin(), be.end(), 0);
-    fn(be.data(), coeffs.row(cell).data(), constants.data(),
-       coordinate_dofs.data(), &local_facet,
-       &perms[cell * facets.size() + local_facet]);
+    fn(be.data(), coeffs.row(cell).data(), constants.data(), coords,
+       &local_facet, &perms[cell * facets.size() + local_facet]);
 
     apply_dof_transformation(_be, cell_info, cell, 1);
 
@@ -680,95 +859,49 @@ void assemble_exterior_facets(
   }
 }
 
-/// Assemble linear form interior facet integrals into an vector
+/// Assemble linear form interior facet integrals into an vector, for
+/// packed interior facets
 /// @tparam T The scalar type
 /// @tparam _bs The block size of the form test function dof map. If
 /// less than zero the block size is determined at runtime. If `_bs` is
 /// positive the block size is used as a compile-time constant, which
 /// has performance benefits.
+/// @param[in] facets The packed facets
+/// @param[in] coeffs The coefficients of the facets (see
+/// fem::pack_interior_facet_coefficients)
 template <typename T, int _bs = -1>
 void assemble_interior_facets(
     const std::function<void(const xtl::span<T>&,
                              const xtl::span<const std::uint32_t>&,
                              std::int32_t, int)>& apply_dof_transformation,
-    xtl::span<T> b, const mesh::Mesh& mesh,
-    const xtl::span<const std::int32_t>& active_facets,
-    const fem::DofMap& dofmap,
+    xtl::span<T> b, const mesh::Geometry& geometry,
+    const InteriorFacets& facets, const fem::DofMap& dofmap,
     const std::function<void(T*, const T*, const T*, const double*, const int*,
                              const std::uint8_t*)>& fn,
     const xtl::span<const T>& constants, const array2d<T>& coeffs,
-    const xtl::span<const int>& offsets,
-    const xtl::span<const std::uint32_t>& cell_info,
-    const xtl::span<const std::uint8_t>& perms)
+    const xtl::span<const std::uint32_t>& cell_info)
 {
-  const int tdim = mesh.topology().dim();
-
-  // Prepare cell geometry
-  const graph::AdjacencyList<std::int32_t>& x_dofmap = mesh.geometry().dofmap();
-
   // FIXME: Add proper interface for num coordinate dofs
-  const std::size_t num_dofs_g = x_dofmap.num_links(0);
-  const xt::xtensor<double, 2>& x_g = mesh.geometry().x();
+  const std::size_t num_dofs_g = geometry.dofmap().num_links(0);
 
   // Create data structures used in assembly
   xt::xtensor<double, 3> coordinate_dofs({2, num_dofs_g, 3});
   std::vector<T> be;
-  std::vector<T> coeff_array(2 * offsets.back());
-  assert(offsets.back() == int(coeffs.shape[1]));
+  assert(facets.size() == coeffs.shape[0]);
 
   const int bs = dofmap.bs();
   assert(_bs < 0 or _bs == bs);
-  auto f_to_c = mesh.topology().connectivity(tdim - 1, tdim);
-  assert(f_to_c);
-  auto c_to_f = mesh.topology().connectivity(tdim, tdim - 1);
-  assert(c_to_f);
-  for (std::int32_t f : active_facets)
+  for (std::size_t f = 0; f < facets.size(); ++f)
   {
-    // Get attached cell indices
-    auto cells = f_to_c->links(f);
-    assert(cells.size() == 2);
-
-    const int facets_per_cell = c_to_f->num_links(cells[0]);
-
-    // Create attached cells
-    std::array<int, 2> local_facet;
-    for (int i = 0; i < 2; ++i)
-    {
-      auto facets = c_to_f->links(cells[i]);
-      auto it = std::find(facets.begin(), facets.end(), f);
-      assert(it != facets.end());
-      local_facet[i] = std::distance(facets.begin(), it);
-    }
+    const std::int32_t* cells = facets.cells.data() + 2 * f;
 
     // Get cell geometry
-    auto x_dofs0 = x_dofmap.links(cells[0]);
-    for (std::size_t i = 0; i < x_dofs0.size(); ++i)
-    {
-      std::copy_n(xt::view(x_g, x_dofs0[i]).begin(), 3,
-                  xt::view(coordinate_dofs, 0, i, xt::all()).begin());
-    }
-    auto x_dofs1 = x_dofmap.links(cells[1]);
-    for (std::size_t i = 0; i < x_dofs1.size(); ++i)
-    {
-      std::copy_n(xt::view(x_g, x_dofs1[i]).begin(), 3,
-                  xt::view(coordinate_dofs, 1, i, xt::all()).begin());
-    }
-
-    // Layout for the restricted coefficients is flattened
-    // w[coefficient][restriction][dof]
-    auto coeff_cell0 = coeffs.row(cells[0]);
-    auto coeff_cell1 = coeffs.row(cells[1]);
-
-    // Loop over coefficients
-    for (std::size_t i = 0; i < offsets.size() - 1; ++i)
-    {
-      // Loop over entries for coefficient i
-      const int num_entries = offsets[i + 1] - offsets[i];
-      std::copy_n(coeff_cell0.data() + offsets[i], num_entries,
-                  std::next(coeff_array.begin(), 2 * offsets[i]));
-      std::copy_n(coeff_cell1.data() + offsets[i], num_entries,
-                  std::next(coeff_array.begin(), offsets[i + 1] + offsets[i]));
-    }
+    geometry.cell_coordinates(
+        cells[0], xtl::span<double>(coordinate_dofs.data(), 3 * num_dofs_g));
+    geometry.cell_coordinates(
+        cells[1], xtl::span<double>(std::next(coordinate_dofs.data(),
+                                              3 * num_dofs_g),
+                                    3 * num_dofs_g));
 
     // Get dofmaps for cells
     xtl::span<const std::int32_t> dmap0 = dofmap.cell_dofs(cells[0]);
@@ -777,10 +910,9 @@ void assemble_interior_facets(
     // Tabulate element vector
     be.resize(bs * (dmap0.size() + dmap1.size()));
     std::fill(be.begin(), be.end(), 0);
-    const std::array perm{perms[cells[0] * facets_per_cell + local_facet[0]],
-                          perms[cells[1] * facets_per_cell + local_facet[1]]};
-    fn(be.data(), coeff_array.data(), constants.data(), coordinate_dofs.data(),
-       local_facet.data(), perm.data());
+    fn(be.data(), coeffs.row(f).data(), constants.data(),
+       coordinate_dofs.data(), facets.local_facets.data() + 2 * f,
+       facets.perms.data() + 2 * f);
 
     apply_dof_transformation(be, cell_info, cells[0], 1);
 
@@ -806,30 +938,192 @@ void assemble_interior_facets(
   }
 }
 
-/// Modify RHS vector to account for boundary condition such that:
-///
-/// b <- b - scale * A (x_bc - x0)
-///
+/// Assemble linear form interior facet integrals into an vector
+/// @tparam T The scalar type
+/// @tparam _bs The block size of the form test function dof map. If
+/// less than zero the block size is determined at runtime. If `_bs` is
+/// positive the block size is used as a compile-time constant, which
+/// has performance benefits.
+template <typename T, int _bs = -1>
+void assemble_interior_facets(
+    const std::function<void(const xtl::span<T>&,
+                             const xtl::span<const std::uint32_t>&,
+                             std::int32_t, int)>& apply_dof_transformation,
+    xtl::span<T> b, const mesh::Mesh& mesh,
+    const xtl::span<const std::int32_t>& active_facets,
+    const fem::DofMap& dofmap,
+    const std::function<void(T*, const T*, const T*, const double*, const int*,
+                             const std::uint8_t*)>& fn,
+    const xtl::span<const T>& constants, const array2d<T>& coeffs,
+    const xtl::span<const int>& offsets,
+    const xtl::span<const std::uint32_t>& cell_info,
+    const xtl::span<const std::uint8_t>& perms)
+{
+  const InteriorFacets facets
+      = pack_interior_facets(mesh.topology(), active_facets, perms);
+  assemble_interior_facets<T, _bs>(
+      apply_dof_transformation, b, mesh.geometry(), facets, dofmap, fn,
+      constants, pack_interior_facet_coefficients(coeffs, facets, offsets),
+      cell_info);
+}
+
+/// Execute the kernel of a linear form over cells and, in the same
+/// traversal, modify the cell vectors of cells with boundary condition
+/// dofs such that be <- be - scale * Ae (x_bc - x0), where Ae is
+/// computed by the kernel of a bilinear form. The geometry of each cell
+/// is gathered once for both kernels.
+/// @tparam T The scalar type
+/// @tparam _bs0 The block size of the test function dof map. If less
+/// than zero the block size is determined at runtime.
+/// @tparam _bs1 The block size of the trial function dof map of the
+/// bilinear form
+/// @tparam _transform If false, the dof transformations are not
+/// applied. Use only when the elements do not need dof
+/// transformations.
+template <typename T, int _bs0 = -1, int _bs1 = -1, bool _transform = true>
+void assemble_cells_lifted(
+    xtl::span<T> b, const mesh::Geometry& geometry,
+    const xtl::span<const std::int32_t>& active_cells,
+    const std::function<void(const xtl::span<T>&,
+                             const xtl::span<const std::uint32_t>&,
+                             std::int32_t, int)>& apply_dof_transformation,
+    const graph::AdjacencyList<std::int32_t>& dofmap0, int bs0,
+    const std::function<
+        void(const xtl::span<T>&, const xtl::span<const std::uint32_t>&,
+             std::int32_t, int)>& apply_dof_transformation_to_transpose,
+    const graph::AdjacencyList<std::int32_t>& dofmap1, int bs1,
+    const std::function<void(T*, const T*, const T*, const double*, const int*,
+                             const std::uint8_t*)>& kernel_L,
+    const xtl::span<const T>& constants_L, const array2d<T>& coeffs_L,
+    const std::function<void(T*, const T*, const T*, const double*, const int*,
+                             const std::uint8_t*)>& kernel_a,
+    const xtl::span<const T>& constants_a, const array2d<T>& coeffs_a,
+    const xtl::span<const std::uint32_t>& cell_info,
+    const xtl::span<const T>& bc_values1, const std::vector<bool>& bc_markers1,
+    const xtl::span<const T>& x0, double scale)
+{
+  assert(_bs0 < 0 or _bs0 == bs0);
+  assert(_bs1 < 0 or _bs1 == bs1);
+  const int block_size0 = _bs0 > 0 ? _bs0 : bs0;
+  const int block_size1 = _bs1 > 0 ? _bs1 : bs1;
+
+  // Prepare cell geometry
+  const graph::AdjacencyList<std::int32_t>& x_dofmap = geometry.dofmap();
+  const int num_dofs_g = x_dofmap.num_links(0);
+  const xtl::span<const double> x_packed = geometry.packed_coordinates();
+
+  // Create data structures used in assembly
+  const int num_rows = block_size0 * dofmap0.links(0).size();
+  const int num_cols = block_size1 * dofmap1.links(0).size();
+  std::vector<double> coordinate_dofs(3 * num_dofs_g);
+  std::vector<T> be(num_rows);
+  std::vector<T> Ae(num_rows * num_cols);
+  const xtl::span<T> _be(be), _Ae(Ae);
+
+  for (std::int32_t c : active_cells)
+  {
+    // Get cell coordinates/geometry
+    const double* coords = coordinate_dofs.data();
+    if (!x_packed.empty())
+      coords = std::next(x_packed.data(), 3 * num_dofs_g * c);
+    else
+    {
+      geometry.cell_coordinates(c, coordinate_dofs);
+    }
+
+    // Tabulate vector for cell
+    std::fill(be.begin(), be.end(), 0);
+    kernel_L(be.data(), coeffs_L.row(c).data(), constants_L.data(), coords,
+             nullptr, nullptr);
+    if constexpr (_transform)
+    {
+      if (cell_info.empty() or cell_info[c] != 0)
+        apply_dof_transformation(_be, cell_info, c, 1);
+    }
+
+    // Check if bc is applied to cell
+    auto dofs1 = dofmap1.links(c);
+    bool has_bc = false;
+    for (std::size_t j = 0; j < dofs1.size() and !has_bc; ++j)
+    {
+      for (int k = 0; k < block_size1; ++k)
+      {
+        assert(block_size1 * dofs1[j] + k < (int)bc_markers1.size());
+        if (bc_markers1[block_size1 * dofs1[j] + k])
+        {
+          has_bc = true;
+          break;
+        }
+      }
+    }
+
+    if (has_bc)
+    {
+      // Tabulate matrix for cell and subtract bc columns
+      std::fill(Ae.begin(), Ae.end(), 0);
+      kernel_a(Ae.data(), coeffs_a.row(c).data(), constants_a.data(), coords,
+               nullptr, nullptr);
+      if constexpr (_transform)
+      {
+        if (cell_info.empty() or cell_info[c] != 0)
+        {
+          apply_dof_transformation(_Ae, cell_info, c, num_cols);
+          apply_dof_transformation_to_transpose(_Ae, cell_info, c, num_rows);
+        }
+      }
+
+      for (std::size_t j = 0; j < dofs1.size(); ++j)
+      {
+        for (int k = 0; k < block_size1; ++k)
+        {
+          const std::int32_t jj = block_size1 * dofs1[j] + k;
+          if (bc_markers1[jj])
+          {
+            const T bc = bc_values1[jj];
+            const T _x0 = x0.empty() ? 0.0 : x0[jj];
+            const int col = block_size1 * j + k;
+            for (int m = 0; m < num_rows; ++m)
+              be[m] -= Ae[m * num_cols + col] * scale * (bc - _x0);
+          }
+        }
+      }
+    }
+
+    // Scatter cell vector to 'global' vector array
+    auto dofs0 = dofmap0.links(c);
+    for (std::size_t i = 0; i < dofs0.size(); ++i)
+      for (int k = 0; k < block_size0; ++k)
+        b[block_size0 * dofs0[i] + k] += be[block_size0 * i + k];
+  }
+}
+
+/// Modify RHS vector to account for boundary condition for a cell
+/// integral of a bilinear form over a subset of the integration
+/// domain. See lift_bc.
 /// @param[in,out] b The vector to be modified
 /// @param[in] a The bilinear form that generates A
+/// @param[in] i The integral ID
+/// @param[in] cells The cells to apply the lifting over
 /// @param[in] constants Constants that appear in `a`
 /// @param[in] coeffs Coefficients that appear in `a`
+/// @param[in] cell_info The cell permutation data
 /// @param[in] bc_values1 The boundary condition 'values'
 /// @param[in] bc_markers1 The indices (columns of A, rows of x) to
 /// which bcs belong
-/// @param[in] x0 The array used in the lifting, typically a 'current
-/// solution' in a Newton method
+/// @param[in] x0 The array used in the lifting
 /// @param[in] scale Scaling to apply
 template <typename T>
-void lift_bc(xtl::span<T> b, const Form<T>& a,
-             const xtl::span<const T>& constants, const array2d<T>& coeffs,
-             const xtl::span<const T>& bc_values1,
-             const std::vector<bool>& bc_markers1, const xtl::span<const T>& x0,
-             double scale)
+void lift_bc_cell_integral(xtl::span<T> b, const Form<T>& a, int i,
+                           const xtl::span<const std::int32_t>& cells,
+                           const xtl::span<const T>& constants,
+                           const array2d<T>& coeffs,
+                           const xtl::span<const std::uint32_t>& cell_info,
+                           const xtl::span<const T>& bc_values1,
+                           const std::vector<bool>& bc_markers1,
+                           const xtl::span<const T>& x0, double scale)
 {
   std::shared_ptr<const mesh::Mesh> mesh = a.mesh();
   assert(mesh);
-  const int tdim = mesh->topology().dim();
 
   // Get dofmap for columns and rows of a
   assert(a.function_spaces().at(0));
@@ -845,18 +1139,6 @@ void lift_bc(xtl::span<T> b, const Form<T>& a,
   std::shared_ptr<const fem::FiniteElement> element1
       = a.function_spaces()[1]->element();
 
-  const bool needs_transformation_data
-      = element0->needs_dof_transformations()
-        or element1->needs_dof_transformations()
-        or a.needs_facet_permutations();
-
-  xtl::span<const std::uint32_t> cell_info;
-  if (needs_transformation_data)
-  {
-    mesh->topology_mutable().create_entity_permutations();
-    cell_info = xtl::span(mesh->topology().get_cell_permutation_info());
-  }
-
   const std::function<void(const xtl::span<T>&,
                            const xtl::span<const std::uint32_t>&, std::int32_t,
                            int)>
@@ -867,68 +1149,147 @@ void lift_bc(xtl::span<T> b, const Form<T>& a,
       apply_dof_transformation_to_transpose
       = element1->get_dof_transformation_to_transpose_function<T>();
 
-  for (int i : a.integral_ids(IntegralType::cell))
+  const auto& kernel = a.kernel(IntegralType::cell, i);
+  if (bs0 == 1 and bs1 == 1)
   {
-    const auto& kernel = a.kernel(IntegralType::cell, i);
-    const std::vector<std::int32_t>& active_cells
-        = a.domains(IntegralType::cell, i);
-    if (bs0 == 1 and bs1 == 1)
-    {
-      _lift_bc_cells<T, 1, 1>(
-          b, mesh->geometry(), kernel, active_cells, apply_dof_transformation,
-          dofmap0, bs0, apply_dof_transformation_to_transpose, dofmap1, bs1,
-          constants, coeffs, cell_info, bc_values1, bc_markers1, x0, scale);
-    }
-    else if (bs0 == 3 and bs1 == 3)
-    {
-      _lift_bc_cells<T, 3, 3>(
-          b, mesh->geometry(), kernel, active_cells, apply_dof_transformation,
-          dofmap0, bs0, apply_dof_transformation_to_transpose, dofmap1, bs1,
-          constants, coeffs, cell_info, bc_values1, bc_markers1, x0, scale);
-    }
-    else
-    {
-      _lift_bc_cells(
-          b, mesh->geometry(), kernel, active_cells, apply_dof_transformation,
-          dofmap0, bs0, apply_dof_transformation_to_transpose, dofmap1, bs1,
-          constants, coeffs, cell_info, bc_values1, bc_markers1, x0, scale);
-    }
+    _lift_bc_cells<T, 1, 1>(
+        b, mesh->geometry(), kernel, cells, apply_dof_transformation, dofmap0,
+        bs0, apply_dof_transformation_to_transpose, dofmap1, bs1, constants,
+        coeffs, cell_info, bc_values1, bc_markers1, x0, scale);
+  }
+  else if (bs0 == 2 and bs1 == 2)
+  {
+    _lift_bc_cells<T, 2, 2>(
+        b, mesh->geometry(), kernel, cells, apply_dof_transformation, dofmap0,
+        bs0, apply_dof_transformation_to_transpose, dofmap1, bs1, constants,
+        coeffs, cell_info, bc_values1, bc_markers1, x0, scale);
+  }
+  else if (bs0 == 3 and bs1 == 3)
+  {
+    _lift_bc_cells<T, 3, 3>(
+        b, mesh->geometry(), kernel, cells, apply_dof_transformation, dofmap0,
+        bs0, apply_dof_transformation_to_transpose, dofmap1, bs1, constants,
+        coeffs, cell_info, bc_values1, bc_markers1, x0, scale);
+  }
+  else
+  {
+    _lift_bc_cells(b, mesh->geometry(), kernel, cells,
+                   apply_dof_transformation, dofmap0, bs0,
+                   apply_dof_transformation_to_transpose, dofmap1, bs1,
+                   constants, coeffs, cell_info, bc_values1, bc_markers1, x0,
+                   scale);
   }
+}
 
-  if (a.num_integrals(IntegralType::exterior_facet) > 0
-      or a.num_integrals(IntegralType::interior_facet) > 0)
+/// Modify RHS vector to account for boundary condition for the
+/// exterior and interior facet integrals of a bilinear form. See
+/// lift_bc.
+template <typename T>
+void lift_bc_facet_integrals(xtl::span<T> b, const Form<T>& a,
+                             const xtl::span<const T>& constants,
+                             const array2d<T>& coeffs,
+                             const xtl::span<const std::uint32_t>& cell_info,
+                             const xtl::span<const T>& bc_values1,
+                             const std::vector<bool>& bc_markers1,
+                             const xtl::span<const T>& x0, double scale)
+{
+  if (a.num_integrals(IntegralType::exterior_facet) == 0
+      and a.num_integrals(IntegralType::interior_facet) == 0)
   {
-    // FIXME: cleanup these calls? Some of the happen internally again.
-    mesh->topology_mutable().create_entities(tdim - 1);
-    mesh->topology_mutable().create_connectivity(tdim - 1, tdim);
-    mesh->topology_mutable().create_entity_permutations();
-
-    const std::vector<std::uint8_t>& perms
-        = mesh->topology().get_facet_permutations();
-    for (int i : a.integral_ids(IntegralType::exterior_facet))
-    {
-      const auto& kernel = a.kernel(IntegralType::exterior_facet, i);
-      const std::vector<std::int32_t>& active_facets
-          = a.domains(IntegralType::exterior_facet, i);
-      _lift_bc_exterior_facets(
-          b, *mesh, kernel, active_facets, apply_dof_transformation, dofmap0,
-          bs0, apply_dof_transformation_to_transpose, dofmap1, bs1, constants,
-          coeffs, cell_info, perms, bc_values1, bc_markers1, x0, scale);
-    }
+    return;
+  }
 
-    const std::vector<int> c_offsets = a.coefficient_offsets();
-    for (int i : a.integral_ids(IntegralType::interior_facet))
-    {
-      const auto& kernel = a.kernel(IntegralType::interior_facet, i);
-      const std::vector<std::int32_t>& active_facets
-          = a.domains(IntegralType::interior_facet, i);
-      _lift_bc_interior_facets(b, *mesh, kernel, active_facets,
-                               apply_dof_transformation, dofmap0, bs0,
-                               apply_dof_transformation_to_transpose, dofmap1,
-                               bs1, constants, coeffs, c_offsets, cell_info,
-                               perms, bc_values1, bc_markers1, x0, scale);
-    }
+  std::shared_ptr<const mesh::Mesh> mesh = a.mesh();
+  assert(mesh);
+  const int tdim = mesh->topology().dim();
+
+  // Get dofmap for columns and rows of a
+  assert(a.function_spaces().at(0));
+  assert(a.function_spaces().at(1));
+  const graph::AdjacencyList<std::int32_t>& dofmap0
+      = a.function_spaces()[0]->dofmap()->list();
+  const int bs0 = a.function_spaces()[0]->dofmap()->bs();
+  std::shared_ptr<const fem::FiniteElement> element0
+      = a.function_spaces()[0]->element();
+  const graph::AdjacencyList<std::int32_t>& dofmap1
+      = a.function_spaces()[1]->dofmap()->list();
+  const int bs1 = a.function_spaces()[1]->dofmap()->bs();
+  std::shared_ptr<const fem::FiniteElement> element1
+      = a.function_spaces()[1]->element();
+
+  const std::function<void(const xtl::span<T>&,
+                           const xtl::span<const std::uint32_t>&, std::int32_t,
+                           int)>
+      apply_dof_transformation = element0->get_dof_transformation_function<T>();
+  const std::function<void(const xtl::span<T>&,
+                           const xtl::span<const std::uint32_t>&, std::int32_t,
+                           int)>
+      apply_dof_transformation_to_transpose
+      = element1->get_dof_transformation_to_transpose_function<T>();
+
+  // FIXME: cleanup these calls? Some of the happen internally again.
+  mesh->topology_mutable().create_entities(tdim - 1);
+  mesh->topology_mutable().create_connectivity(tdim - 1, tdim);
+  mesh->topology_mutable().create_facet_permutations();
+
+  const std::vector<std::uint8_t>& perms
+      = mesh->topology().get_facet_permutations();
+  for (int i : a.integral_ids(IntegralType::exterior_facet))
+  {
+    const auto& kernel = a.kernel(IntegralType::exterior_facet, i);
+    const std::vector<std::int32_t>& active_facets
+        = a.domains(IntegralType::exterior_facet, i);
+    _lift_bc_exterior_facets(
+        b, *mesh, kernel, active_facets, apply_dof_transformation, dofmap0,
+        bs0, apply_dof_transformation_to_transpose, dofmap1, bs1, constants,
+        coeffs, cell_info, perms, bc_values1, bc_markers1, x0, scale);
+  }
+
+  const std::vector<int> c_offsets = a.coefficient_offsets();
+  for (int i : a.integral_ids(IntegralType::interior_facet))
+  {
+    const auto& kernel = a.kernel(IntegralType::interior_facet, i);
+    const std::vector<std::int32_t>& active_facets
+        = a.domains(IntegralType::interior_facet, i);
+    _lift_bc_interior_facets(b, *mesh, kernel, active_facets,
+                             apply_dof_transformation, dofmap0, bs0,
+                             apply_dof_transformation_to_transpose, dofmap1,
+                             bs1, constants, coeffs, c_offsets, cell_info,
+                             perms, bc_values1, bc_markers1, x0, scale);
+  }
+}
+
+/// Modify RHS vector to account for boundary condition such that:
+///
+/// b <- b - scale * A (x_bc - x0)
+///
+/// @param[in,out] b The vector to be modified
+/// @param[in] a The bilinear form that generates A
+/// @param[in] constants Constants that appear in `a`
+/// @param[in] coeffs Coefficients that appear in `a`
+/// @param[in] bc_values1 The boundary condition 'values'
+/// @param[in] bc_markers1 The indices (columns of A, rows of x) to
+/// which bcs belong
+/// @param[in] x0 The array used in the lifting, typically a 'current
+/// solution' in a Newton method
+/// @param[in] scale Scaling to apply
+template <typename T>
+void lift_bc(xtl::span<T> b, const Form<T>& a,
+             const xtl::span<const T>& constants, const array2d<T>& coeffs,
+             const xtl::span<const T>& bc_values1,
+             const std::vector<bool>& bc_markers1, const xtl::span<const T>& x0,
+             double scale)
+{
+  const xtl::span<const std::uint32_t> cell_info = get_cell_info(a);
+  for (int i : a.integral_ids(IntegralType::cell))
+  {
+    lift_bc_cell_integral(b, a, i, a.domains(IntegralType::cell, i),
+                          constants, coeffs, cell_info, bc_values1,
+                          bc_markers1, x0, scale);
   }
+
+  lift_bc_facet_integrals(b, a, constants, coeffs, cell_info, bc_values1,
+                          bc_markers1, x0, scale);
 }
 
 /// Modify b such that:
@@ -1008,23 +1369,91 @@ void apply_lifting(
   }
 }
 
-/// Assemble linear form into a vector
-/// @param[in,out] b The vector to be assembled. It will not be zeroed
-/// before assembly.
-/// @param[in] L The linear forms to assemble into b
+/// Modify b such that:
+///
+///   b <- b - scale * A_j (g_j - x0_j)
+///
+/// where j is a block (nest) index. For non-blocked problem j = 0.
+/// The boundary conditions bcs1 are merged boundary conditions on the
+/// trial spaces V_j, whose dof markers and boundary value arrays are
+/// re-used. A null entry in bcs1 means that no boundary conditions are
+/// applied to V_j. See apply_lifting.
+template <typename T>
+void apply_lifting(
+    xtl::span<T> b, const std::vector<std::shared_ptr<const Form<T>>> a,
+    const std::vector<xtl::span<const T>>& constants,
+    const std::vector<const array2d<T>*>& coeffs,
+    const std::vector<std::shared_ptr<const DirichletBCs<T>>>& bcs1,
+    const std::vector<xtl::span<const T>>& x0, double scale)
+{
+  if (!x0.empty() and x0.size() != a.size())
+  {
+    throw std::runtime_error(
+        "Mismatch in size between x0 and bilinear form in assembler.");
+  }
+
+  if (a.size() != bcs1.size())
+  {
+    throw std::runtime_error(
+        "Mismatch in size between a and bcs in assembler.");
+  }
+
+  for (std::size_t j = 0; j < a.size(); ++j)
+  {
+    if (a[j] and bcs1[j] and !bcs1[j]->bcs().empty())
+    {
+      auto V1 = a[j]->function_spaces()[1];
+      assert(V1);
+      auto map1 = V1->dofmap()->index_map;
+      const int bs1 = V1->dofmap()->index_map_bs();
+      assert(map1);
+      const std::size_t crange
+          = bs1 * (map1->size_local() + map1->num_ghosts());
+      if (bcs1[j]->markers().size() != crange)
+      {
+        throw std::runtime_error(
+            "Boundary conditions are not on the trial space of the form.");
+      }
+
+      assert(coeffs[j]);
+      const std::vector<T>& bc_values1 = bcs1[j]->values();
+      if (!x0.empty())
+      {
+        lift_bc<T>(b, *a[j], constants[j], *coeffs[j], bc_values1,
+                   bcs1[j]->markers(), x0[j], scale);
+      }
+      else
+      {
+        lift_bc<T>(b, *a[j], constants[j], *coeffs[j], bc_values1,
+                   bcs1[j]->markers(), xtl::span<const T>(), scale);
+      }
+    }
+  }
+}
+
+/// Assemble a cell integral of a linear form over a subset of the
+/// integration domain
+/// @param[in,out] b The vector to be assembled
+/// @param[in] L The linear form
+/// @param[in] i The integral ID
+/// @param[in] cells The cells to assemble over
 /// @param[in] constants Packed constants that appear in `L`
 /// @param[in] coeffs Packed coefficients that appear in `L`
+/// @param[in] cell_info The cell permutation data
+/// @param[in] x_cells Packed coordinates of the cells `[c0, c0 + n)`,
+/// see impl::assemble_cells. Not used by batched kernels.
+/// @param[in] c0 The first cell in `x_cells`
 template <typename T>
-void assemble_vector(xtl::span<T> b, const Form<T>& L,
-                     const xtl::span<const T>& constants,
-                     const array2d<T>& coeffs)
+void assemble_cell_integral(xtl::span<T> b, const Form<T>& L, int i,
+                            const xtl::span<const std::int32_t>& cells,
+                            const xtl::span<const T>& constants,
+                            const array2d<T>& coeffs,
+                            const xtl::span<const std::uint32_t>& cell_info,
+                            const xtl::span<const double>& x_cells = {},
+                            std::int32_t c0 = 0)
 {
   std::shared_ptr<const mesh::Mesh> mesh = L.mesh();
   assert(mesh);
-  const int tdim = mesh->topology().dim();
-
-  // Get dofmap data
-  assert(L.function_spaces().at(0));
   std::shared_ptr<const fem::FiniteElement> element
       = L.function_spaces().at(0)->element();
   std::shared_ptr<const fem::DofMap> dofmap
@@ -1038,100 +1467,742 @@ void assemble_vector(xtl::span<T> b, const Form<T>& L,
                            int)>
       apply_dof_transformation = element->get_dof_transformation_function<T>();
 
-  const bool needs_transformation_data
-      = element->needs_dof_transformations() or L.needs_facet_permutations();
-  xtl::span<const std::uint32_t> cell_info;
-  if (needs_transformation_data)
+  // Elements that do not need dof transformations (e.g. Lagrange) are
+  // assembled by loops without any transformation calls
+  const bool transform = element->needs_dof_transformations();
+  const auto& fn = L.kernel(IntegralType::cell, i);
+  const auto batch = L.batch_kernel(IntegralType::cell, i);
+  if (batch.second > 0)
   {
-    mesh->topology_mutable().create_entity_permutations();
-    cell_info = xtl::span(mesh->topology().get_cell_permutation_info());
+    if (transform)
+    {
+      impl::assemble_cells_batched<T, true>(
+          apply_dof_transformation, b, mesh->geometry(), cells, dofs, bs,
+          batch.first, batch.second, constants, coeffs, cell_info);
+    }
+    else
+    {
+      impl::assemble_cells_batched<T, false>(
+          apply_dof_transformation, b, mesh->geometry(), cells, dofs, bs,
+          batch.first, batch.second, constants, coeffs, cell_info);
+    }
+    return;
   }
 
-  for (int i : L.integral_ids(IntegralType::cell))
+  // Read the compressed dofmap, if stored
+  auto assemble = [&](const auto& list)
   {
-    const auto& fn = L.kernel(IntegralType::cell, i);
-    const std::vector<std::int32_t>& active_cells
-        = L.domains(IntegralType::cell, i);
-    if (bs == 1)
+    using U = std::decay_t<decltype(list)>;
+    if (transform and bs == 1)
+    {
+      impl::assemble_cells<T, 1, true, U>(
+          apply_dof_transformation, b, mesh->geometry(), cells, list, bs, fn,
+          constants, coeffs, cell_info, x_cells, c0);
+    }
+    else if (transform)
     {
-      impl::assemble_cells<T, 1>(apply_dof_transformation, b, mesh->geometry(),
-                                 active_cells, dofs, bs, fn, constants, coeffs,
-                                 cell_info);
+      impl::assemble_cells<T, -1, true, U>(
+          apply_dof_transformation, b, mesh->geometry(), cells, list, bs, fn,
+          constants, coeffs, cell_info, x_cells, c0);
+    }
+    else if (bs == 1)
+    {
+      impl::assemble_cells<T, 1, false, U>(
+          apply_dof_transformation, b, mesh->geometry(), cells, list, bs, fn,
+          constants, coeffs, cell_info, x_cells, c0);
+    }
+    else if (bs == 2)
+    {
+      impl::assemble_cells<T, 2, false, U>(
+          apply_dof_transformation, b, mesh->geometry(), cells, list, bs, fn,
+          constants, coeffs, cell_info, x_cells, c0);
     }
     else if (bs == 3)
     {
-      impl::assemble_cells<T, 3>(apply_dof_transformation, b, mesh->geometry(),
-                                 active_cells, dofs, bs, fn, constants, coeffs,
-                                 cell_info);
+      impl::assemble_cells<T, 3, false, U>(
+          apply_dof_transformation, b, mesh->geometry(), cells, list, bs, fn,
+          constants, coeffs, cell_info, x_cells, c0);
     }
     else
     {
-      impl::assemble_cells(apply_dof_transformation, b, mesh->geometry(),
-                           active_cells, dofs, bs, fn, constants, coeffs,
-                           cell_info);
+      impl::assemble_cells<T, -1, false, U>(
+          apply_dof_transformation, b, mesh->geometry(), cells, list, bs, fn,
+          constants, coeffs, cell_info, x_cells, c0);
     }
+  };
+
+  if (auto dofs_compressed = dofmap->compressed_list())
+    assemble(*dofs_compressed);
+  else
+    assemble(dofs);
+}
+
+/// Assemble the exterior and interior facet integrals of a linear form
+/// into a vector
+/// @param[in,out] b The vector to be assembled
+/// @param[in] L The linear form
+/// @param[in] constants Packed constants that appear in `L`
+/// @param[in] coeffs Packed coefficients that appear in `L`
+/// @param[in] cell_info The cell permutation data
+/// @param[in] num_threads Number of threads to use
+template <typename T>
+void assemble_facet_integrals(xtl::span<T> b, const Form<T>& L,
+                              const xtl::span<const T>& constants,
+                              const array2d<T>& coeffs,
+                              const xtl::span<const std::uint32_t>& cell_info,
+                              int num_threads)
+{
+  if (L.num_integrals(IntegralType::exterior_facet) == 0
+      and L.num_integrals(IntegralType::interior_facet) == 0)
+  {
+    return;
   }
 
-  if (L.num_integrals(IntegralType::exterior_facet) > 0
-      or L.num_integrals(IntegralType::interior_facet) > 0)
+  std::shared_ptr<const mesh::Mesh> mesh = L.mesh();
+  assert(mesh);
+  const int tdim = mesh->topology().dim();
+
+  // Get dofmap data
+  std::shared_ptr<const fem::FiniteElement> element
+      = L.function_spaces().at(0)->element();
+  std::shared_ptr<const fem::DofMap> dofmap
+      = L.function_spaces().at(0)->dofmap();
+  assert(dofmap);
+  const graph::AdjacencyList<std::int32_t>& dofs = dofmap->list();
+  const int bs = dofmap->bs();
+
+  const std::function<void(const xtl::span<T>&,
+                           const xtl::span<const std::uint32_t>&, std::int32_t,
+                           int)>
+      apply_dof_transformation = element->get_dof_transformation_function<T>();
+
+  // FIXME: cleanup these calls? Some of the happen internally again.
+  mesh->topology_mutable().create_entities(tdim - 1);
+  mesh->topology_mutable().create_connectivity(tdim - 1, tdim);
+  mesh->topology_mutable().create_facet_permutations();
+
+  const std::vector<std::uint8_t>& perms
+      = mesh->topology().get_facet_permutations();
+  for (int i : L.integral_ids(IntegralType::exterior_facet))
   {
-    // FIXME: cleanup these calls? Some of the happen internally again.
-    mesh->topology_mutable().create_entities(tdim - 1);
-    mesh->topology_mutable().create_connectivity(tdim - 1, tdim);
-    mesh->topology_mutable().create_entity_permutations();
-
-    const std::vector<std::uint8_t>& perms
-        = mesh->topology().get_facet_permutations();
-    for (int i : L.integral_ids(IntegralType::exterior_facet))
+    const auto& fn = L.kernel(IntegralType::exterior_facet, i);
+    const std::vector<std::int32_t>& active_facets
+        = L.domains(IntegralType::exterior_facet, i);
+    auto assemble = [&](const xtl::span<const std::int32_t>& facets)
     {
-      const auto& fn = L.kernel(IntegralType::exterior_facet, i);
-      const std::vector<std::int32_t>& active_facets
-          = L.domains(IntegralType::exterior_facet, i);
       if (bs == 1)
       {
-        impl::assemble_exterior_facets<T, 1>(
-            apply_dof_transformation, b, *mesh, active_facets, dofs, bs, fn,
-            constants, coeffs, cell_info, perms);
+        impl::assemble_exterior_facets<T, 1>(apply_dof_transformation, b,
+                                             *mesh, facets, dofs, bs, fn,
+                                             constants, coeffs, cell_info,
+                                             perms);
       }
       else if (bs == 3)
       {
-        impl::assemble_exterior_facets<T, 3>(
-            apply_dof_transformation, b, *mesh, active_facets, dofs, bs, fn,
-            constants, coeffs, cell_info, perms);
+        impl::assemble_exterior_facets<T, 3>(apply_dof_transformation, b,
+                                             *mesh, facets, dofs, bs, fn,
+                                             constants, coeffs, cell_info,
+                                             perms);
       }
       else
       {
         impl::assemble_exterior_facets(apply_dof_transformation, b, *mesh,
-                                       active_facets, dofs, bs, fn, constants,
+                                       facets, dofs, bs, fn, constants,
                                        coeffs, cell_info, perms);
       }
+    };
+
+    if (num_threads > 1)
+    {
+      impl::parallel_for_colours(
+          compute_colouring(mesh->topology(), dofs,
+                            IntegralType::exterior_facet, active_facets),
+          num_threads, assemble);
     }
+    else
+      assemble(active_facets);
+  }
 
-    const std::vector<int> c_offsets = L.coefficient_offsets();
-    for (int i : L.integral_ids(IntegralType::interior_facet))
+  const std::vector<int> c_offsets = L.coefficient_offsets();
+  for (int i : L.integral_ids(IntegralType::interior_facet))
+  {
+    const auto& fn = L.kernel(IntegralType::interior_facet, i);
+    const std::vector<std::int32_t>& active_facets
+        = L.domains(IntegralType::interior_facet, i);
+    auto assemble = [&](const xtl::span<const std::int32_t>& facets)
     {
-      const auto& fn = L.kernel(IntegralType::interior_facet, i);
-      const std::vector<std::int32_t>& active_facets
-          = L.domains(IntegralType::interior_facet, i);
       if (bs == 1)
       {
         impl::assemble_interior_facets<T, 1>(
-            apply_dof_transformation, b, *mesh, active_facets, *dofmap, fn,
+            apply_dof_transformation, b, *mesh, facets, *dofmap, fn,
             constants, coeffs, c_offsets, cell_info, perms);
       }
       else if (bs == 3)
       {
         impl::assemble_interior_facets<T, 3>(
-            apply_dof_transformation, b, *mesh, active_facets, *dofmap, fn,
+            apply_dof_transformation, b, *mesh, facets, *dofmap, fn,
             constants, coeffs, c_offsets, cell_info, perms);
       }
       else
       {
         impl::assemble_interior_facets(apply_dof_transformation, b, *mesh,
-                                       active_facets, *dofmap, fn, constants,
+                                       facets, *dofmap, fn, constants,
                                        coeffs, c_offsets, cell_info, perms);
       }
+    };
+
+    if (num_threads > 1)
+    {
+      impl::parallel_for_colours(
+          compute_colouring(mesh->topology(), dofs,
+                            IntegralType::interior_facet, active_facets),
+          num_threads, assemble);
+    }
+    else
+    {
+      // Stream through the cached facet data of the integral
+      const InteriorFacets& facets = L.interior_facets(i);
+      const array2d<T> facet_coeffs
+          = pack_interior_facet_coefficients(coeffs, facets, c_offsets);
+      if (bs == 1)
+      {
+        impl::assemble_interior_facets<T, 1>(
+            apply_dof_transformation, b, mesh->geometry(), facets, *dofmap,
+            fn, constants, facet_coeffs, cell_info);
+      }
+      else if (bs == 3)
+      {
+        impl::assemble_interior_facets<T, 3>(
+            apply_dof_transformation, b, mesh->geometry(), facets, *dofmap,
+            fn, constants, facet_coeffs, cell_info);
+      }
+      else
+      {
+        impl::assemble_interior_facets(apply_dof_transformation, b,
+                                       mesh->geometry(), facets, *dofmap, fn,
+                                       constants, facet_coeffs, cell_info);
+      }
+    }
+  }
+}
+
+/// Assemble linear form into a vector
+/// @param[in,out] b The vector to be assembled. It will not be zeroed
+/// before assembly.
+/// @param[in] L The linear forms to assemble into b
+/// @param[in] constants Packed constants that appear in `L`
+/// @param[in] coeffs Packed coefficients that appear in `L`
+/// @param[in] num_threads Number of threads to use. If greater than
+/// one, the entities of each integration domain are coloured and the
+/// entities of each colour are assembled concurrently.
+template <typename T>
+void assemble_vector(xtl::span<T> b, const Form<T>& L,
+                     const xtl::span<const T>& constants,
+                     const array2d<T>& coeffs, int num_threads = 1)
+{
+  std::shared_ptr<const mesh::Mesh> mesh = L.mesh();
+  assert(mesh);
+  const graph::AdjacencyList<std::int32_t>& dofs
+      = L.function_spaces().at(0)->dofmap()->list();
+  const xtl::span<const std::uint32_t> cell_info = get_cell_info(L);
+
+  for (int i : L.integral_ids(IntegralType::cell))
+  {
+    const std::vector<std::int32_t>& active_cells
+        = L.domains(IntegralType::cell, i);
+    auto assemble = [&](const xtl::span<const std::int32_t>& cells)
+    { assemble_cell_integral(b, L, i, cells, constants, coeffs, cell_info); };
+
+    if (num_threads > 1)
+    {
+      impl::parallel_for_colours(compute_colouring(mesh->topology(), dofs,
+                                                   IntegralType::cell,
+                                                   active_cells),
+                                 num_threads, assemble);
+    }
+    else
+      assemble(active_cells);
+  }
+
+  assemble_facet_integrals(b, L, constants, coeffs, cell_info, num_threads);
+}
+
+/// Assemble linear form into a ghosted vector, with the ghost updates
+/// overlapped with assembly. See fem::assemble_vector.
+/// @param[in,out] b The vector to be assembled. It will not be zeroed
+/// before assembly.
+/// @param[in] L The linear form to assemble into b
+/// @param[in] constants Packed constants that appear in `L`
+/// @param[in,out] x Vectors for which the ghost values are updated
+template <typename T, class Allocator>
+void assemble_vector(
+    la::Vector<T, Allocator>& b, const Form<T>& L,
+    const xtl::span<const T>& constants,
+    const std::vector<std::reference_wrapper<la::Vector<T>>>& x)
+{
+  for (la::Vector<T>& _x : x)
+    _x.scatter_fwd_begin();
+
+  const xtl::span<T> _b(b.mutable_array());
+  std::shared_ptr<const mesh::Mesh> mesh = L.mesh();
+  assert(mesh);
+  const int tdim = mesh->topology().dim();
+  const xtl::span<const std::uint32_t> cell_info = get_cell_info(L);
+
+  // Pack coefficients. The ghost values of x are not yet updated, so
+  // cells with ghost coefficient dofs are re-packed later.
+  array2d<T> coeffs = fem::pack_coefficients(L);
+  std::vector<std::reference_wrapper<const DofMap>> dofmaps;
+  for (auto& coefficient : L.coefficients())
+    dofmaps.push_back(*coefficient->function_space()->dofmap());
+  std::vector<std::int32_t> cells(
+      mesh->topology().index_map(tdim)->size_local()
+      + mesh->topology().index_map(tdim)->num_ghosts());
+  std::iota(cells.begin(), cells.end(), 0);
+  const std::vector<std::int32_t> coeff_ghost_cells
+      = split_cells_by_ownership(cells, dofmaps)[1];
+
+  // Split cell integral domains into cells that touch only owned dofs
+  // of b and x, and cells that touch ghosts. The owned cells are
+  // split in two parts, which are assembled while the forward and
+  // reverse scatters are in flight.
+  dofmaps.push_back(*L.function_spaces().at(0)->dofmap());
+  const std::vector<int> ids = L.integral_ids(IntegralType::cell);
+  std::vector<std::array<std::vector<std::int32_t>, 2>> split;
+  for (int i : ids)
+    split.push_back(split_cells_by_ownership(L.domains(IntegralType::cell, i),
+                                             dofmaps));
+
+  std::vector<std::size_t> num_first;
+  for (std::size_t k = 0; k < ids.size(); ++k)
+  {
+    num_first.push_back(split[k][0].size() / 2);
+    const xtl::span<const std::int32_t> cells0(split[k][0]);
+    assemble_cell_integral(_b, L, ids[k], cells0.first(num_first[k]),
+                           constants, coeffs, cell_info);
+  }
+
+  // Complete ghost updates and assemble cells that touch ghosts
+  for (la::Vector<T>& _x : x)
+    _x.scatter_fwd_end();
+  std::vector<int> indices(L.coefficients().size());
+  std::iota(indices.begin(), indices.end(), 0);
+  pack_coefficients(L, coeffs, indices, coeff_ghost_cells);
+  for (std::size_t k = 0; k < ids.size(); ++k)
+  {
+    assemble_cell_integral(_b, L, ids[k], split[k][1], constants, coeffs,
+                           cell_info);
+  }
+  assemble_facet_integrals(_b, L, constants, coeffs, cell_info, 1);
+
+  // Send ghost contributions and assemble remaining owned cells
+  b.scatter_rev_begin();
+  for (std::size_t k = 0; k < ids.size(); ++k)
+  {
+    const xtl::span<const std::int32_t> cells1(split[k][0]);
+    assemble_cell_integral(_b, L, ids[k], cells1.subspan(num_first[k]),
+                           constants, coeffs, cell_info);
+  }
+  b.scatter_rev_end(common::IndexMap::Mode::add);
+}
+
+/// Assemble linear form into the owned entries of a vector without a
+/// reverse scatter, by integrating over all owned and ghost cells that
+/// have an owned dof. See fem::assemble_vector_owned.
+/// @param[in,out] b The vector to be assembled (including ghosts). It
+/// will not be zeroed before assembly. The ghost entries are not
+/// modified.
+/// @param[in] L The linear form
+/// @param[in] constants Packed constants that appear in `L`
+/// @param[in] coeffs Packed coefficients that appear in `L`
+/// @param[in] num_threads Number of threads to use
+template <typename T>
+void assemble_vector_owned(xtl::span<T> b, const Form<T>& L,
+                           const xtl::span<const T>& constants,
+                           const array2d<T>& coeffs, int num_threads = 1)
+{
+  for (auto type : {IntegralType::exterior_facet,
+                    IntegralType::interior_facet, IntegralType::vertex})
+  {
+    if (L.num_integrals(type) > 0)
+    {
+      throw std::runtime_error(
+          "Owner-computes assembly supports cell integrals only.");
+    }
+  }
+
+  // The subdomain data of ghost cells is not known
+  const std::vector<int> ids = L.integral_ids(IntegralType::cell);
+  if (std::any_of(ids.begin(), ids.end(), [](int i) { return i != -1; }))
+  {
+    throw std::runtime_error("Owner-computes assembly does not support "
+                             "cell integrals over subdomains.");
+  }
+  if (ids.empty())
+    return;
+
+  // Owned and ghost cells with an owned dof
+  std::shared_ptr<const mesh::Mesh> mesh = L.mesh();
+  assert(mesh);
+  const int tdim = mesh->topology().dim();
+  std::shared_ptr<const DofMap> dofmap = L.function_spaces().at(0)->dofmap();
+  const graph::AdjacencyList<std::int32_t>& dofs = dofmap->list();
+  const std::int32_t size_local = dofmap->index_map->size_local();
+  const std::int32_t num_cells
+      = mesh->topology().index_map(tdim)->size_local()
+        + mesh->topology().index_map(tdim)->num_ghosts();
+  std::vector<std::int32_t> cells;
+  for (std::int32_t c = 0; c < num_cells; ++c)
+  {
+    auto cell_dofs = dofs.links(c);
+    if (std::any_of(cell_dofs.begin(), cell_dofs.end(),
+                    [size_local](auto dof) { return dof < size_local; }))
+    {
+      cells.push_back(c);
+    }
+  }
+
+  // Check that every cell with an owned dof is on this process by
+  // comparing, for each owned dof, the number of local cells with the
+  // dof to the number of cells with the dof on all processes (each cell
+  // counted by its owner)
+  std::shared_ptr<const common::IndexMap> index_map = dofmap->index_map;
+  const std::int32_t num_owned_cells
+      = mesh->topology().index_map(tdim)->size_local();
+  std::vector<std::int32_t> count(size_local + index_map->num_ghosts(), 0);
+  std::vector<std::int32_t> count_local(size_local, 0);
+  for (std::int32_t c = 0; c < num_owned_cells; ++c)
+    for (std::int32_t dof : dofs.links(c))
+      ++count[dof];
+  for (std::int32_t c : cells)
+    for (std::int32_t dof : dofs.links(c))
+      if (dof < size_local)
+        ++count_local[dof];
+  index_map->scatter_rev(
+      xtl::span<std::int32_t>(count.data(), size_local),
+      xtl::span<const std::int32_t>(count.data() + size_local,
+                                    index_map->num_ghosts()),
+      1, common::IndexMap::Mode::add);
+  std::int32_t incomplete = !std::equal(count_local.begin(),
+                                        count_local.end(), count.begin());
+  MPI_Allreduce(MPI_IN_PLACE, &incomplete, 1, MPI_INT32_T, MPI_MAX,
+                mesh->mpi_comm());
+  if (incomplete)
+  {
+    throw std::runtime_error("Owner-computes assembly requires every cell "
+                             "with an owned dof to be on the process. "
+                             "Add ghost cell layers.");
+  }
+
+  // Keep the ghost entries of b
+  const std::size_t num_owned = dofmap->index_map_bs() * size_local;
+  const std::vector<T> ghosts(std::next(b.begin(), num_owned), b.end());
+
+  const xtl::span<const std::uint32_t> cell_info = get_cell_info(L);
+  auto assemble = [&](const xtl::span<const std::int32_t>& cells)
+  { assemble_cell_integral(b, L, -1, cells, constants, coeffs, cell_info); };
+  if (num_threads > 1)
+  {
+    impl::parallel_for_colours(
+        compute_colouring(mesh->topology(), dofs, IntegralType::cell, cells),
+        num_threads, assemble);
+  }
+  else
+    assemble(cells);
+
+  std::copy(ghosts.begin(), ghosts.end(), std::next(b.begin(), num_owned));
+}
+
+/// Assemble linear form into a vector and modify it for boundary
+/// conditions such that
+///
+///   b <- b + L - scale * A (x_bc - x0)
+///
+/// with the lifting applied in the same traversal of the cells as the
+/// assembly of L for cell integrals of L and a on the same domain. See
+/// fem::assemble_vector.
+/// @param[in,out] b The vector to be assembled. It will not be zeroed
+/// before assembly.
+/// @param[in] L The linear form
+/// @param[in] constants_L Packed constants that appear in `L`
+/// @param[in] coeffs_L Packed coefficients that appear in `L`
+/// @param[in] a The bilinear form that generates A
+/// @param[in] constants_a Packed constants that appear in `a`
+/// @param[in] coeffs_a Packed coefficients that appear in `a`
+/// @param[in] bcs1 The boundary conditions on the trial space of `a`
+/// @param[in] x0 The array used in the lifting. If empty it is treated
+/// as zero.
+/// @param[in] scale Scaling to apply
+template <typename T>
+void assemble_vector_lifted(
+    xtl::span<T> b, const Form<T>& L, const xtl::span<const T>& constants_L,
+    const array2d<T>& coeffs_L, const Form<T>& a,
+    const xtl::span<const T>& constants_a, const array2d<T>& coeffs_a,
+    const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs1,
+    const xtl::span<const T>& x0, double scale)
+{
+  if (L.function_spaces().at(0) != a.function_spaces().at(0))
+  {
+    throw std::runtime_error(
+        "Linear and bilinear forms must have the same test space.");
+  }
+
+  if (bcs1.empty())
+  {
+    assemble_vector(b, L, constants_L, coeffs_L);
+    return;
+  }
+
+  // Build bc markers and values
+  std::shared_ptr<const FunctionSpace> V0 = a.function_spaces()[0];
+  std::shared_ptr<const FunctionSpace> V1 = a.function_spaces()[1];
+  std::shared_ptr<const common::IndexMap> map1 = V1->dofmap()->index_map;
+  const int crange = V1->dofmap()->index_map_bs()
+                     * (map1->size_local() + map1->num_ghosts());
+  std::vector<bool> bc_markers1(crange, false);
+  std::vector<T> bc_values1(crange, 0.0);
+  for (const std::shared_ptr<const DirichletBC<T>>& bc : bcs1)
+  {
+    bc->mark_dofs(bc_markers1);
+    bc->dof_values(bc_values1);
+  }
+
+  std::shared_ptr<const mesh::Mesh> mesh = L.mesh();
+  assert(mesh);
+  if (a.mesh() != mesh)
+    throw std::runtime_error("Forms must be defined on the same mesh.");
+  const xtl::span<const std::uint32_t> cell_info_L = get_cell_info(L);
+  const xtl::span<const std::uint32_t> cell_info_a = get_cell_info(a);
+
+  const DofMap& dofmap0 = *V0->dofmap();
+  const DofMap& dofmap1 = *V1->dofmap();
+  std::shared_ptr<const fem::FiniteElement> element0 = V0->element();
+  std::shared_ptr<const fem::FiniteElement> element1 = V1->element();
+  const std::function<void(const xtl::span<T>&,
+                           const xtl::span<const std::uint32_t>&, std::int32_t,
+                           int)>
+      apply_dof_transformation = element0->get_dof_transformation_function<T>();
+  const std::function<void(const xtl::span<T>&,
+                           const xtl::span<const std::uint32_t>&, std::int32_t,
+                           int)>
+      apply_dof_transformation_to_transpose
+      = element1->get_dof_transformation_to_transpose_function<T>();
+  const bool transform = element0->needs_dof_transformations()
+                         or element1->needs_dof_transformations();
+
+  // Cell integrals of L. Integrals of a on the same domain are applied
+  // in the same traversal.
+  const std::vector<int> ids_a = a.integral_ids(IntegralType::cell);
+  std::vector<int> fused;
+  for (int i : L.integral_ids(IntegralType::cell))
+  {
+    const std::vector<std::int32_t>& cells = L.domains(IntegralType::cell, i);
+    if (std::find(ids_a.begin(), ids_a.end(), i) == ids_a.end()
+        or a.domains(IntegralType::cell, i) != cells)
+    {
+      assemble_cell_integral(b, L, i, cells, constants_L, coeffs_L,
+                             cell_info_L);
+      continue;
+    }
+
+    fused.push_back(i);
+    const int bs0 = dofmap0.bs();
+    const int bs1 = dofmap1.bs();
+    auto assemble = [&](auto bs, auto _transform)
+    {
+      constexpr int _bs = decltype(bs)::value;
+      impl::assemble_cells_lifted<T, _bs, _bs, decltype(_transform)::value>(
+          b, mesh->geometry(), cells, apply_dof_transformation,
+          dofmap0.list(), bs0, apply_dof_transformation_to_transpose,
+          dofmap1.list(), bs1, L.kernel(IntegralType::cell, i), constants_L,
+          coeffs_L, a.kernel(IntegralType::cell, i), constants_a, coeffs_a,
+          cell_info_a.empty() ? cell_info_L : cell_info_a, bc_values1,
+          bc_markers1, x0, scale);
+    };
+    auto dispatch = [&](auto _transform)
+    {
+      if (bs0 == 1 and bs1 == 1)
+        assemble(std::integral_constant<int, 1>(), _transform);
+      else if (bs0 == 2 and bs1 == 2)
+        assemble(std::integral_constant<int, 2>(), _transform);
+      else if (bs0 == 3 and bs1 == 3)
+        assemble(std::integral_constant<int, 3>(), _transform);
+      else
+        assemble(std::integral_constant<int, -1>(), _transform);
+    };
+
+    if (transform)
+      dispatch(std::true_type());
+    else
+      dispatch(std::false_type());
+  }
+
+  // Remaining cell integrals of a
+  for (int i : ids_a)
+  {
+    if (std::find(fused.begin(), fused.end(), i) == fused.end())
+    {
+      lift_bc_cell_integral(b, a, i, a.domains(IntegralType::cell, i),
+                            constants_a, coeffs_a, cell_info_a, bc_values1,
+                            bc_markers1, x0, scale);
+    }
+  }
+
+  assemble_facet_integrals(b, L, constants_L, coeffs_L, cell_info_L, 1);
+  lift_bc_facet_integrals(b, a, constants_a, coeffs_a, cell_info_a,
+                          xtl::span<const T>(bc_values1), bc_markers1, x0,
+                          scale);
+}
+
+/// Assemble linear forms with the same test space into a multi-column
+/// vector. See fem::assemble_multi_vector.
+/// @param[in,out] b The multi-column vector to be assembled. It will
+/// not be zeroed before assembly.
+/// @param[in] L The linear forms, one for each column of `b`
+/// @param[in] constants Packed constants that appear in each form
+/// @param[in] coeffs Packed coefficients that appear in each form
+template <typename T>
+void assemble_multi_vector(
+    xtl::span<T> b, const std::vector<std::reference_wrapper<const Form<T>>>& L,
+    const std::vector<xtl::span<const T>>& constants,
+    const std::vector<std::reference_wrapper<const array2d<T>>>& coeffs)
+{
+  assert(constants.size() == L.size());
+  assert(coeffs.size() == L.size());
+  if (L.empty())
+    return;
+
+  std::shared_ptr<const FunctionSpace> V
+      = L.front().get().function_spaces().at(0);
+  for (const Form<T>& form : L)
+  {
+    if (form.rank() != 1)
+      throw std::runtime_error("Forms must be linear.");
+    if (form.function_spaces().at(0) != V)
+      throw std::runtime_error("Linear forms must have the same test space.");
+  }
+
+  std::shared_ptr<const mesh::Mesh> mesh = L.front().get().mesh();
+  assert(mesh);
+  std::shared_ptr<const fem::FiniteElement> element = V->element();
+  std::shared_ptr<const fem::DofMap> dofmap = V->dofmap();
+  assert(dofmap);
+  const int bs = dofmap->bs();
+  const int num_columns = L.size();
+  const std::size_t num_rows = dofmap->index_map_bs()
+                               * (dofmap->index_map->size_local()
+                                  + dofmap->index_map->num_ghosts());
+  if (b.size() != num_rows * num_columns)
+    throw std::runtime_error("Multi-column vector has the wrong size.");
+
+  const std::function<void(const xtl::span<T>&,
+                           const xtl::span<const std::uint32_t>&, std::int32_t,
+                           int)>
+      apply_dof_transformation = element->get_dof_transformation_function<T>();
+
+  // The permutation data is the same for all forms, but is computed
+  // only if one of them needs it
+  std::vector<xtl::span<const std::uint32_t>> cell_info;
+  xtl::span<const std::uint32_t> _cell_info;
+  for (const Form<T>& form : L)
+  {
+    cell_info.push_back(get_cell_info(form));
+    if (!cell_info.back().empty())
+      _cell_info = cell_info.back();
+  }
+
+  std::set<int> ids;
+  for (const Form<T>& form : L)
+  {
+    const std::vector<int> form_ids = form.integral_ids(IntegralType::cell);
+    ids.insert(form_ids.begin(), form_ids.end());
+  }
+
+  for (int id : ids)
+  {
+    // Group the forms with the same integration domain, so that the
+    // kernels of a group are executed in a single traversal of the
+    // cells
+    std::vector<const std::vector<std::int32_t>*> domains;
+    std::vector<std::vector<int>> groups;
+    for (int k = 0; k < num_columns; ++k)
+    {
+      const std::vector<int> form_ids
+          = L[k].get().integral_ids(IntegralType::cell);
+      if (std::find(form_ids.begin(), form_ids.end(), id) == form_ids.end())
+        continue;
+
+      const std::vector<std::int32_t>& domain
+          = L[k].get().domains(IntegralType::cell, id);
+      auto it = std::find_if(domains.begin(), domains.end(),
+                             [&domain](auto d) { return *d == domain; });
+      if (it == domains.end())
+      {
+        domains.push_back(&domain);
+        groups.push_back({k});
+      }
+      else
+        groups[std::distance(domains.begin(), it)].push_back(k);
     }
+
+    for (std::size_t g = 0; g < groups.size(); ++g)
+    {
+      std::vector<std::reference_wrapper<const std::function<void(
+          T*, const T*, const T*, const double*, const int*,
+          const std::uint8_t*)>>>
+          kernels;
+      std::vector<xtl::span<const T>> _constants;
+      std::vector<std::reference_wrapper<const array2d<T>>> _coeffs;
+      for (int k : groups[g])
+      {
+        kernels.push_back(L[k].get().kernel(IntegralType::cell, id));
+        _constants.push_back(constants[k]);
+        _coeffs.push_back(coeffs[k]);
+      }
+
+      auto assemble = [&](auto _bs, auto _transform)
+      {
+        impl::assemble_cells_multi<T, decltype(_bs)::value,
+                                   decltype(_transform)::value>(
+            apply_dof_transformation, b, num_columns, groups[g],
+            mesh->geometry(), *domains[g], dofmap->list(), bs, kernels,
+            _constants, _coeffs, _cell_info);
+      };
+      auto dispatch = [&](auto _transform)
+      {
+        if (bs == 1)
+          assemble(std::integral_constant<int, 1>(), _transform);
+        else if (bs == 2)
+          assemble(std::integral_constant<int, 2>(), _transform);
+        else if (bs == 3)
+          assemble(std::integral_constant<int, 3>(), _transform);
+        else
+          assemble(std::integral_constant<int, -1>(), _transform);
+      };
+
+      if (element->needs_dof_transformations())
+        dispatch(std::true_type());
+      else
+        dispatch(std::false_type());
+    }
+  }
+
+  // Assemble facet integrals form-by-form and add to the columns
+  std::vector<T> bk;
+  for (int k = 0; k < num_columns; ++k)
+  {
+    const Form<T>& form = L[k];
+    if (form.num_integrals(IntegralType::exterior_facet) == 0
+        and form.num_integrals(IntegralType::interior_facet) == 0)
+    {
+      continue;
+    }
+
+    bk.assign(num_rows, 0);
+    assemble_facet_integrals(xtl::span<T>(bk), form, constants[k], coeffs[k],
+                             cell_info[k], 1);
+    for (std::size_t i = 0; i < bk.size(); ++i)
+      b[i * num_columns + k] += bk[i];
   }
 }
 } // namespace dolfinx::fem::impl
@@ -6,10 +6,15 @@
 
 #pragma once
 
+#include "assemble_fused_impl.h"
 #include "assemble_matrix_impl.h"
 #include "assemble_scalar_impl.h"
 #include "assemble_vector_impl.h"
+#include <algorithm>
+#include <array>
+#include <functional>
 #include <memory>
+#include <stdexcept>
 #include <vector>
 #include <xtl/xspan.hpp>
 
@@ -20,6 +25,8 @@ class DirichletBC;
 template <typename T>
 class Form;
 class FunctionSpace;
+template <typename T>
+class MultiPointConstraint;
 
 // -- Scalar ----------------------------------------------------------------
 
@@ -30,26 +37,50 @@ class FunctionSpace;
 /// @param[in] M The form (functional) to assemble
 /// @param[in] constants The constants that appear in `M`
 /// @param[in] coeffs The coefficients that appear in `M`
+/// @param[in] num_threads The number of threads to use. The result is
+/// bitwise independent of the number of threads.
 /// @return The contribution to the form (functional) from the local
 /// process
 template <typename T>
 T assemble_scalar(const Form<T>& M, const xtl::span<const T>& constants,
-                  const array2d<T>& coeffs)
+                  const array2d<T>& coeffs, int num_threads = 1)
 {
-  return impl::assemble_scalar(M, constants, coeffs);
+  return impl::assemble_scalar(M, constants, coeffs, num_threads);
 }
 
 /// Assemble functional into scalar
-/// @note Caller is responsible for accumulation across processes.
+/// @note Caller is responsible for accumulation across processes. Use
+/// common::sum_reproducible for a reproducible accumulation.
 /// @param[in] M The form (functional) to assemble
+/// @param[in] num_threads The number of threads to use. The result is
+/// bitwise independent of the number of threads.
 /// @return The contribution to the form (functional) from the local
 ///   process
 template <typename T>
-T assemble_scalar(const Form<T>& M)
+T assemble_scalar(const Form<T>& M, int num_threads = 1)
 {
   const std::vector<T> constants = pack_constants(M);
   const array2d<T> coeffs = pack_coefficients(M);
-  return assemble_scalar(M, tcb::make_span(constants), coeffs);
+  return assemble_scalar(M, tcb::make_span(constants), coeffs, num_threads);
+}
+
+/// Assemble functional for an ensemble of constants values, e.g. for
+/// parameter studies. Each row of `constants` holds the packed
+/// constants of one ensemble member in the layout of
+/// fem::pack_constants. The geometry and coefficients of a cell are
+/// gathered once and the kernel is executed for all members.
+/// @note Caller is responsible for accumulation across processes.
+/// @param[in] M The form (functional) to assemble
+/// @param[in] constants The constants of each ensemble member (row)
+/// @param[in] coeffs The coefficients that appear in `M`
+/// @param[in] num_threads The number of threads to use
+/// @return The contribution to the form (functional) from the local
+/// process for each ensemble member
+template <typename T>
+std::vector<T> assemble_scalar(const Form<T>& M, const array2d<T>& constants,
+                               const array2d<T>& coeffs, int num_threads = 1)
+{
+  return impl::assemble_scalar(M, constants, coeffs, num_threads);
 }
 
 // -- Vectors ----------------------------------------------------------------
@@ -62,24 +93,224 @@ T assemble_scalar(const Form<T>& M)
 /// @param[in] L The linear forms to assemble into b
 /// @param[in] constants The constants that appear in `L`
 /// @param[in] coeffs The coefficients that appear in `L`
+/// @param[in] num_threads The number of threads to use. If greater
+/// than one, the mesh entities are coloured and entities of the same
+/// colour are assembled concurrently.
 template <typename T>
 void assemble_vector(xtl::span<T> b, const Form<T>& L,
                      const xtl::span<const T>& constants,
-                     const array2d<T>& coeffs)
+                     const array2d<T>& coeffs, int num_threads = 1)
 {
-  impl::assemble_vector(b, L, constants, coeffs);
+  impl::assemble_vector(b, L, constants, coeffs, num_threads);
 }
 
 /// Assemble linear form into a vector
 /// @param[in,out] b The vector to be assembled. It will not be zeroed
 /// before assembly.
 /// @param[in] L The linear forms to assemble into b
+/// @param[in] num_threads The number of threads to use. If greater
+/// than one, the mesh entities are coloured and entities of the same
+/// colour are assembled concurrently.
 template <typename T>
-void assemble_vector(xtl::span<T> b, const Form<T>& L)
+void assemble_vector(xtl::span<T> b, const Form<T>& L, int num_threads = 1)
 {
   const std::vector<T> constants = pack_constants(L);
   const array2d<T> coeffs = pack_coefficients(L);
-  assemble_vector(b, L, tcb::make_span(constants), coeffs);
+  assemble_vector(b, L, tcb::make_span(constants), coeffs, num_threads);
+}
+
+/// Assemble linear form into a vector with a different value type,
+/// e.g. a single-precision form (`T = float`) into a double-precision
+/// vector. The kernels, packed coefficients and element vectors use
+/// the value type of the form, and the contributions are accumulated
+/// in a work array of type `T` that is added to `b`.
+/// @param[in,out] b The vector to be assembled. It will not be zeroed
+/// before assembly.
+/// @param[in] L The linear forms to assemble into b
+/// @param[in] num_threads The number of threads to use
+template <typename U, typename T>
+void assemble_vector(xtl::span<U> b, const Form<T>& L, int num_threads = 1)
+{
+  std::vector<T> _b(b.size(), 0);
+  assemble_vector(xtl::span<T>(_b), L, num_threads);
+  std::transform(_b.begin(), _b.end(), b.begin(), b.begin(),
+                 [](auto x, auto y) { return y + static_cast<U>(x); });
+}
+
+/// Assemble linear form into a ghosted vector, with the ghost updates
+/// overlapped with assembly. The forward scatter of the vectors `x` is
+/// started first and cells that touch only owned degrees-of-freedom are
+/// assembled while it is in flight. After the cells with ghost
+/// degrees-of-freedom and the facet integrals have been assembled, the
+/// reverse scatter of b is started and the remaining owned cells are
+/// assembled.
+/// @param[in,out] b The vector to be assembled. It will not be zeroed
+/// before assembly. On exit the ghost contributions have been added to
+/// the owned entries.
+/// @param[in] L The linear form to assemble into b
+/// @param[in,out] x Vectors whose ghost values are updated (forward
+/// scatter) during assembly, typically the vectors of the coefficients
+/// of `L` that have been modified since the last ghost update
+template <typename T, class Allocator>
+void assemble_vector(
+    la::Vector<T, Allocator>& b, const Form<T>& L,
+    const std::vector<std::reference_wrapper<la::Vector<T>>>& x)
+{
+  const std::vector<T> constants = pack_constants(L);
+  impl::assemble_vector(b, L, tcb::make_span(constants), x);
+}
+
+/// Assemble linear form into the owned entries of a vector by owner
+/// computes, i.e. without a reverse scatter: all owned and ghost cells
+/// with an owned dof are integrated, and only the contributions to
+/// owned entries are kept. Cells on the process boundary are
+/// integrated by each process that has them, which trades redundant
+/// computation for not sending the ghost contributions.
+///
+/// The result is equal to fem::assemble_vector followed by a reverse
+/// scatter only if every cell with an owned dof is present on the
+/// process. This holds for spaces with dofs on cells only (e.g. DG)
+/// with any ghost mode, and for spaces with dofs on cells and facets
+/// only with mesh::GhostMode::shared_facet. For spaces with dofs on
+/// vertices or edges (e.g. Lagrange) it depends on the number of ghost
+/// cell layers (see mesh::partition_cells_graph) and on the mesh. One
+/// layer is not enough in general. A number of layers at least the
+/// largest number of facet steps between the cells around a vertex is
+/// enough, e.g. three layers for a generation::RectangleMesh of
+/// triangles with the "right" diagonal.
+///
+/// The coverage is checked on each call, which exchanges one integer
+/// per shared dof, and an exception is thrown on all processes if a
+/// cell is missing. This function is collective. The ghost values of
+/// the coefficients must be up to date.
+/// @param[in,out] b The vector to be assembled (including ghosts). It
+/// will not be zeroed before assembly. The ghost entries are not
+/// modified.
+/// @param[in] L The linear form, with cell integrals over the whole
+/// mesh only
+/// @param[in] constants The constants that appear in `L`
+/// @param[in] coeffs The coefficients that appear in `L`
+/// @param[in] num_threads The number of threads to use
+template <typename T>
+void assemble_vector_owned(xtl::span<T> b, const Form<T>& L,
+                           const xtl::span<const T>& constants,
+                           const array2d<T>& coeffs, int num_threads = 1)
+{
+  impl::assemble_vector_owned(b, L, constants, coeffs, num_threads);
+}
+
+/// Assemble linear form into the owned entries of a vector by owner
+/// computes, see fem::assemble_vector_owned
+/// @param[in,out] b The vector to be assembled (including ghosts). It
+/// will not be zeroed before assembly. The ghost entries are not
+/// modified.
+/// @param[in] L The linear form
+/// @param[in] num_threads The number of threads to use
+template <typename T>
+void assemble_vector_owned(xtl::span<T> b, const Form<T>& L,
+                           int num_threads = 1)
+{
+  const std::vector<T> constants = pack_constants(L);
+  const array2d<T> coeffs = pack_coefficients(L);
+  assemble_vector_owned(b, L, tcb::make_span(constants), coeffs,
+                        num_threads);
+}
+
+/// Assemble linear form into a vector and modify it for the boundary
+/// conditions of a bilinear form, i.e.
+///
+///   b <- b + L - scale * A (g - x0)
+///
+/// This is equivalent to fem::assemble_vector followed by
+/// fem::apply_lifting for a single bilinear form, but for cell
+/// integrals of L and a on the same domain the lifting is applied in
+/// the same traversal of the cells, with the cell geometry gathered
+/// once. The bilinear form is tabulated only on cells with boundary
+/// condition dofs.
+///
+/// Ghost contributions are not accumulated (not sent to owner), and
+/// the boundary condition values are not set (see fem::set_bc).
+/// @param[in,out] b The vector to be assembled. It will not be zeroed
+/// before assembly.
+/// @param[in] L The linear form
+/// @param[in] a The bilinear form, with the same test space as `L`
+/// @param[in] bcs1 The boundary conditions on the trial space of `a`
+/// @param[in] x0 The array used in the lifting. If empty it is treated
+/// as zero.
+/// @param[in] scale Scaling to apply
+template <typename T>
+void assemble_vector(
+    xtl::span<T> b, const Form<T>& L, const Form<T>& a,
+    const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs1,
+    const xtl::span<const T>& x0, double scale)
+{
+  const std::vector<T> constants_L = pack_constants(L);
+  const array2d<T> coeffs_L = pack_coefficients(L);
+  const std::vector<T> constants_a = pack_constants(a);
+  const array2d<T> coeffs_a = pack_coefficients(a);
+  impl::assemble_vector_lifted(b, L, tcb::make_span(constants_L), coeffs_L,
+                               a, tcb::make_span(constants_a), coeffs_a, bcs1,
+                               x0, scale);
+}
+
+/// Assemble linear forms with the same test space into a multi-column
+/// vector, e.g. the right-hand sides of several load cases. The cell
+/// kernels of forms with the same integration domain are executed in a
+/// single traversal of the cells, so the geometry and dofmap of a cell
+/// are gathered once for all forms.
+///
+/// The entry for column `j` of (unrolled) row `i` of the vector is
+/// stored at `b[i * L.size() + j]`, i.e. the columns are interleaved.
+/// The owned rows can be copied into a dense matrix for use with
+/// la::PETScKrylovSolver::solve(Mat, const Mat), and the ghost
+/// contributions accumulated using a la::Vector with block size
+/// `bs * L.size()`.
+/// @param[in,out] b The multi-column vector to be assembled. It will
+/// not be zeroed before assembly.
+/// @param[in] L The linear forms, one for each column of `b`
+template <typename T>
+void assemble_multi_vector(
+    xtl::span<T> b, const std::vector<std::reference_wrapper<const Form<T>>>& L)
+{
+  std::vector<std::vector<T>> constants;
+  std::vector<array2d<T>> coeffs;
+  for (const Form<T>& form : L)
+  {
+    constants.push_back(pack_constants(form));
+    coeffs.push_back(pack_coefficients(form));
+  }
+
+  const std::vector<xtl::span<const T>> _constants(constants.begin(),
+                                                   constants.end());
+  const std::vector<std::reference_wrapper<const array2d<T>>> _coeffs(
+      coeffs.begin(), coeffs.end());
+  impl::assemble_multi_vector(b, L, _constants, _coeffs);
+}
+
+/// Assemble linear form for an ensemble of constants values into a
+/// multi-column vector, with one column for each ensemble member. Each
+/// row of `constants` holds the packed constants of one member in the
+/// layout of fem::pack_constants. The geometry and coefficients of a
+/// cell are gathered once and the kernel is executed for all members.
+/// The vector layout is as for fem::assemble_multi_vector.
+/// @param[in,out] b The multi-column vector to be assembled. It will
+/// not be zeroed before assembly.
+/// @param[in] L The linear form
+/// @param[in] constants The constants of each ensemble member (row)
+/// @param[in] coeffs The coefficients that appear in `L`
+template <typename T>
+void assemble_vector(xtl::span<T> b, const Form<T>& L,
+                     const array2d<T>& constants, const array2d<T>& coeffs)
+{
+  const std::size_t num_members = constants.shape[0];
+  const std::vector<std::reference_wrapper<const Form<T>>> forms(num_members,
+                                                                 L);
+  std::vector<xtl::span<const T>> _constants;
+  for (std::size_t m = 0; m < num_members; ++m)
+    _constants.push_back(constants.row(m));
+  const std::vector<std::reference_wrapper<const array2d<T>>> _coeffs(
+      num_members, coeffs);
+  impl::assemble_multi_vector(b, forms, _constants, _coeffs);
 }
 
 // FIXME: clarify how x0 is used
@@ -153,22 +384,97 @@ void apply_lifting(
   apply_lifting(b, a, _constants, _coeffs, bcs1, x0, scale);
 }
 
+/// Modify b such that:
+///
+///   b <- b - scale * A_j (g_j - x0_j)
+///
+/// where j is a block (nest) index. The boundary conditions bcs1 are
+/// merged boundary conditions on the trial spaces V_j, and a null entry
+/// means that no boundary conditions are applied to V_j. The dof
+/// markers and boundary value arrays of the merged boundary conditions
+/// are re-used, rather than built on each call.
+///
+/// Ghost contributions are not accumulated (not sent to owner). Caller
+/// is responsible for calling VecGhostUpdateBegin/End.
+template <typename T>
+void apply_lifting(
+    xtl::span<T> b, const std::vector<std::shared_ptr<const Form<T>>>& a,
+    const std::vector<xtl::span<const T>>& constants,
+    const std::vector<const array2d<T>*>& coeffs,
+    const std::vector<std::shared_ptr<const DirichletBCs<T>>>& bcs1,
+    const std::vector<xtl::span<const T>>& x0, double scale)
+{
+  impl::apply_lifting(b, a, constants, coeffs, bcs1, x0, scale);
+}
+
+/// Modify b such that:
+///
+///   b <- b - scale * A_j (g_j - x0_j)
+///
+/// where j is a block (nest) index, using merged boundary conditions.
+/// Coefficients and constants are packed on the fly. See
+/// apply_lifting.
+template <typename T>
+void apply_lifting(
+    xtl::span<T> b, const std::vector<std::shared_ptr<const Form<T>>>& a,
+    const std::vector<std::shared_ptr<const DirichletBCs<T>>>& bcs1,
+    const std::vector<xtl::span<const T>>& x0, double scale)
+{
+  std::vector<array2d<T>> coeffs;
+  std::vector<std::vector<T>> constants;
+  for (auto _a : a)
+  {
+    if (_a)
+    {
+      coeffs.push_back(pack_coefficients(*_a));
+      constants.push_back(pack_constants(*_a));
+    }
+    else
+    {
+      coeffs.push_back(array2d<T>(0, 0));
+      constants.push_back({});
+    }
+  }
+
+  std::vector<const array2d<T>*> _coeffs;
+  std::for_each(coeffs.begin(), coeffs.end(),
+                [&_coeffs](const auto& c) { _coeffs.push_back(&c); });
+  std::vector<xtl::span<const T>> _constants(constants.begin(),
+                                             constants.end());
+  apply_lifting(b, a, _constants, _coeffs, bcs1, x0, scale);
+}
+
 // -- Matrices ---------------------------------------------------------------
 
 /// Assemble bilinear form into a matrix
+///
+/// The function for adding values into the matrix, `mat_add`, is a
+/// callable with the signature `int(std::int32_t m, const std::int32_t*
+/// rows, std::int32_t n, const std::int32_t* cols, const T* vals)`. The
+/// row and column indices are blocked local indices and `vals` is the
+/// row-major element matrix. It may be a std::function, or a lambda,
+/// which the compiler can inline into the assembly loops. This is
+/// significant for low-order elements. The matrix may have a different
+/// value type than the form, e.g. a single-precision form is assembled
+/// into a double-precision matrix with
+/// `la::MatrixCSR<double>::mat_add_values<float>(A)`.
+///
 /// @param[in] mat_add The function for adding values into the matrix
 /// @param[in] a The bilinear from to assemble
 /// @param[in] constants Constants that appear in `a`
 /// @param[in] coeffs Coefficients that appear in `a`
 /// @param[in] bcs Boundary conditions to apply. For boundary condition
 ///  dofs the row and column are zeroed. The diagonal  entry is not set.
-template <typename T>
+/// @param[in] num_threads The number of threads to use. If greater
+/// than one, the mesh entities are coloured and entities of the same
+/// colour are assembled concurrently. `mat_add` must then be safe to
+/// call concurrently for disjoint sets of rows.
+template <typename T, typename U>
 void assemble_matrix(
-    const std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
-                            const std::int32_t*, const T*)>& mat_add,
-    const Form<T>& a, const xtl::span<const T>& constants,
+    const U& mat_add, const Form<T>& a, const xtl::span<const T>& constants,
     const array2d<T>& coeffs,
-    const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs)
+    const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs,
+    int num_threads = 1)
 {
   // Index maps for dof ranges
   auto map0 = a.function_spaces().at(0)->dofmap()->index_map;
@@ -201,7 +507,7 @@ void assemble_matrix(
 
   // Assemble
   impl::assemble_matrix(mat_add, a, constants, coeffs, dof_marker0,
-                        dof_marker1);
+                        dof_marker1, num_threads);
 }
 
 /// Assemble bilinear form into a matrix
@@ -209,19 +515,66 @@ void assemble_matrix(
 /// @param[in] a The bilinear from to assemble
 /// @param[in] bcs Boundary conditions to apply. For boundary condition
 ///  dofs the row and column are zeroed. The diagonal  entry is not set.
-template <typename T>
+/// @param[in] num_threads The number of threads to use. If greater
+/// than one, `mat_add` must be safe to call concurrently for disjoint
+/// sets of rows.
+template <typename T, typename U>
 void assemble_matrix(
-    const std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
-                            const std::int32_t*, const T*)>& mat_add,
-    const Form<T>& a,
-    const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs)
+    const U& mat_add, const Form<T>& a,
+    const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs,
+    int num_threads = 1)
 {
   // Prepare constants and coefficients
   const std::vector<T> constants = pack_constants(a);
   const array2d<T> coeffs = pack_coefficients(a);
 
   // Assemble
-  assemble_matrix(mat_add, a, tcb::make_span(constants), coeffs, bcs);
+  assemble_matrix(mat_add, a, tcb::make_span(constants), coeffs, bcs,
+                  num_threads);
+}
+
+/// Assemble bilinear form into a matrix, with the cells of the cell
+/// integrals classified by the boundary conditions in advance. The
+/// result is the same as for assembly with the boundary conditions
+/// used to create `cells`, but no boundary condition checks are
+/// performed for cells without constrained dofs. Assembly is
+/// sequential.
+/// @param[in] mat_add The function for adding values into the matrix
+/// @param[in] a The bilinear from to assemble
+/// @param[in] constants Constants that appear in `a`
+/// @param[in] coeffs Coefficients that appear in `a`
+/// @param[in] cells The cells of `a` classified by the boundary
+/// conditions
+template <typename T, typename U>
+void assemble_matrix(const U& mat_add, const Form<T>& a,
+                     const xtl::span<const T>& constants,
+                     const array2d<T>& coeffs,
+                     const ConstrainedCells<T>& cells)
+{
+  if (cells.form_id() != a.id())
+  {
+    throw std::runtime_error(
+        "Constrained cells were classified for a different form.");
+  }
+  impl::assemble_matrix(mat_add, a, constants, coeffs, cells);
+}
+
+/// Assemble bilinear form into a matrix, with the cells of the cell
+/// integrals classified by the boundary conditions in advance
+/// @param[in] mat_add The function for adding values into the matrix
+/// @param[in] a The bilinear from to assemble
+/// @param[in] cells The cells of `a` classified by the boundary
+/// conditions
+template <typename T, typename U>
+void assemble_matrix(const U& mat_add, const Form<T>& a,
+                     const ConstrainedCells<T>& cells)
+{
+  // Prepare constants and coefficients
+  const std::vector<T> constants = pack_constants(a);
+  const array2d<T> coeffs = pack_coefficients(a);
+
+  // Assemble
+  assemble_matrix(mat_add, a, tcb::make_span(constants), coeffs, cells);
 }
 
 /// Assemble bilinear form into a matrix. Matrix must already be
@@ -236,17 +589,19 @@ void assemble_matrix(
 /// @param[in] dof_marker1 Boundary condition markers for the columns.
 /// If bc[i] is true then rows i in A will be zeroed. The index i is a
 /// local index.
-template <typename T>
-void assemble_matrix(
-    const std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
-                            const std::int32_t*, const T*)>& mat_add,
-    const Form<T>& a, const xtl::span<const T>& constants,
-    const array2d<T>& coeffs, const std::vector<bool>& dof_marker0,
-    const std::vector<bool>& dof_marker1)
+/// @param[in] num_threads The number of threads to use. If greater
+/// than one, `mat_add` must be safe to call concurrently for disjoint
+/// sets of rows.
+template <typename T, typename U>
+void assemble_matrix(const U& mat_add, const Form<T>& a,
+                     const xtl::span<const T>& constants,
+                     const array2d<T>& coeffs,
+                     const std::vector<bool>& dof_marker0,
+                     const std::vector<bool>& dof_marker1, int num_threads = 1)
 
 {
   impl::assemble_matrix(mat_add, a, constants, coeffs, dof_marker0,
-                        dof_marker1);
+                        dof_marker1, num_threads);
 }
 
 /// Assemble bilinear form into a matrix. Matrix must already be
@@ -259,12 +614,13 @@ void assemble_matrix(
 /// @param[in] dof_marker1 Boundary condition markers for the columns.
 ///   If bc[i] is true then rows i in A will be zeroed. The index i is a
 ///   local index.
-template <typename T>
-void assemble_matrix(
-    const std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
-                            const std::int32_t*, const T*)>& mat_add,
-    const Form<T>& a, const std::vector<bool>& dof_marker0,
-    const std::vector<bool>& dof_marker1)
+/// @param[in] num_threads The number of threads to use. If greater
+///   than one, `mat_add` must be safe to call concurrently for disjoint
+///   sets of rows.
+template <typename T, typename U>
+void assemble_matrix(const U& mat_add, const Form<T>& a,
+                     const std::vector<bool>& dof_marker0,
+                     const std::vector<bool>& dof_marker1, int num_threads = 1)
 
 {
   // Prepare constants and coefficients
@@ -273,7 +629,66 @@ void assemble_matrix(
 
   // Assemble
   assemble_matrix(mat_add, a, tcb::make_span(constants), coeffs, dof_marker0,
-                  dof_marker1);
+                  dof_marker1, num_threads);
+}
+
+/// Assemble a bilinear form with multipoint constraints into a matrix,
+/// i.e. assemble C^H A C (see fem::MultiPointConstraint). The matrix
+/// must already be initialised, e.g. from
+/// fem::create_sparsity_pattern(a, mpc). Does not zero or finalise the
+/// matrix. The diagonal entries of the owned slaves are set, and the
+/// diagonal entries of Dirichlet rows are not.
+/// @param[in] mat_add The function for adding values into the matrix.
+/// It is called with unrolled local indices in the index map of the
+/// constraint, e.g. la::PETScMatrix::set_fn.
+/// @param[in] a The bilinear form. The test and trial spaces must be
+/// the function space of the constraint.
+/// @param[in] mpc The multipoint constraint
+/// @param[in] bcs Boundary conditions to apply. For boundary condition
+/// dofs the row and column are zeroed. Slaves must not have boundary
+/// conditions.
+/// @param[in] diagonal The value of the diagonal entries of the slaves
+template <typename T, typename U>
+void assemble_matrix(
+    const U& mat_add, const Form<T>& a, const MultiPointConstraint<T>& mpc,
+    const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs,
+    T diagonal = 1.0)
+{
+  std::shared_ptr<const fem::FunctionSpace> V = mpc.function_space();
+  if (!(*a.function_spaces().at(0) == *V)
+      or !(*a.function_spaces().at(1) == *V))
+  {
+    throw std::runtime_error("Form is not defined on the function space of "
+                             "the multipoint constraint.");
+  }
+
+  // Build dof markers
+  std::vector<bool> dof_marker;
+  std::shared_ptr<const common::IndexMap> map = V->dofmap()->index_map;
+  const int bs = V->dofmap()->index_map_bs();
+  for (const auto& bc : bcs)
+  {
+    assert(bc);
+    if (V->contains(*bc->function_space()))
+    {
+      dof_marker.resize(bs * (map->size_local() + map->num_ghosts()), false);
+      bc->mark_dofs(dof_marker);
+    }
+  }
+
+  // Assemble, with the element matrices constrained on insertion
+  const std::vector<T> constants = pack_constants(a);
+  const array2d<T> coeffs = pack_coefficients(a);
+  impl::assemble_matrix(mpc.mat_add_fn(mat_add, dof_marker, dof_marker), a,
+                        tcb::make_span(constants), coeffs, dof_marker,
+                        dof_marker);
+
+  // Set the diagonal entries of the slaves
+  for (std::int32_t i = 0; i < mpc.num_owned_slaves(); ++i)
+  {
+    const std::int32_t dof = mpc.slaves()[i];
+    mat_add(1, &dof, 1, &dof, &diagonal);
+  }
 }
 
 /// Sets a value to the diagonal of a matrix for specified rows. It is
@@ -333,6 +748,215 @@ void set_diagonal(
   }
 }
 
+// -- Diagonals --------------------------------------------------------------
+
+/// Assemble the diagonal, or the diagonal blocks, of the matrix of a
+/// bilinear form into an array, without assembling the matrix. This
+/// is what Jacobi and Chebyshev smoothers of matrix-free operators
+/// need. Only the diagonal entries (or the diagonal bs x bs blocks) of
+/// each element matrix are added.
+///
+/// For the diagonal, entry `bs * i + k` of `d` is the diagonal entry of
+/// the row of component `k` of the (blocked) dof `i`. For the diagonal
+/// blocks, entry `(bs * i + k0) * bs + k1` of `d` is entry (k0, k1) of
+/// the diagonal block of dof `i`.
+///
+/// Boundary condition dofs are treated as in fem::assemble_matrix
+/// followed by fem::set_diagonal: the rows and columns of the matrix
+/// are zeroed and `diagonal` is set for owned rows.
+///
+/// Ghost contributions are not accumulated (not sent to owner).
+/// @param[in,out] d The array to assemble into (including ghosts). It
+/// is not zeroed before assembly.
+/// @param[in] a The bilinear form, with the same test and trial space
+/// @param[in] constants Constants that appear in `a`
+/// @param[in] coeffs Coefficients that appear in `a`
+/// @param[in] bcs Boundary conditions to apply
+/// @param[in] block If true, assemble the diagonal blocks rather than
+/// the diagonal
+/// @param[in] diagonal The diagonal value for boundary condition rows
+/// @param[in] num_threads The number of threads to use
+template <typename T>
+void assemble_diagonal(
+    xtl::span<T> d, const Form<T>& a, const xtl::span<const T>& constants,
+    const array2d<T>& coeffs,
+    const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs,
+    bool block = false, T diagonal = 1.0, int num_threads = 1)
+{
+  std::shared_ptr<const FunctionSpace> V = a.function_spaces().at(0);
+  if (a.function_spaces().at(1) != V)
+  {
+    throw std::runtime_error(
+        "Diagonal assembly requires the same test and trial space.");
+  }
+  std::shared_ptr<const DofMap> dofmap = V->dofmap();
+  const int bs = dofmap->bs();
+  if (bs != dofmap->index_map_bs())
+    throw std::runtime_error("Unsupported dofmap block size.");
+  std::shared_ptr<const common::IndexMap> map = dofmap->index_map;
+  const std::int32_t num_dofs = map->size_local() + map->num_ghosts();
+  if ((int)d.size() != (block ? bs * bs : bs) * num_dofs)
+    throw std::runtime_error("Array size does not match the bilinear form.");
+
+  std::vector<bool> bc_marker;
+  for (auto& bc : bcs)
+  {
+    assert(bc);
+    if (V->contains(*bc->function_space()))
+    {
+      bc_marker.resize(bs * num_dofs, false);
+      bc->mark_dofs(bc_marker);
+    }
+  }
+
+  // Add the diagonal (blocks) of the element matrices. Only entries
+  // for the same row and column dof are added, so the function is safe
+  // to call concurrently for disjoint sets of rows.
+  auto diag_add = [d, bs, block](std::int32_t m, const std::int32_t* rows,
+                                 std::int32_t n, const std::int32_t* cols,
+                                 const T* Ae) -> int
+  {
+    const int ndim1 = bs * n;
+    for (std::int32_t i = 0; i < m; ++i)
+    {
+      for (std::int32_t j = 0; j < n; ++j)
+      {
+        if (rows[i] != cols[j])
+          continue;
+        for (int k0 = 0; k0 < bs; ++k0)
+        {
+          const T* Ae_row = Ae + (bs * i + k0) * ndim1 + bs * j;
+          if (block)
+          {
+            T* d_row = d.data() + (bs * rows[i] + k0) * bs;
+            for (int k1 = 0; k1 < bs; ++k1)
+              d_row[k1] += Ae_row[k1];
+          }
+          else
+            d[bs * rows[i] + k0] += Ae_row[k0];
+        }
+      }
+    }
+    return 0;
+  };
+  impl::assemble_matrix(diag_add, a, constants, coeffs, bc_marker, bc_marker,
+                        num_threads);
+
+  // Set owned bc rows
+  for (std::int32_t i = 0; i < (std::int32_t)bc_marker.size(); ++i)
+  {
+    if (i < bs * map->size_local() and bc_marker[i])
+    {
+      const std::int32_t k = i % bs;
+      if (block)
+        d[(i - k) * bs + k * bs + k] = diagonal;
+      else
+        d[i] = diagonal;
+    }
+  }
+}
+
+/// Assemble the diagonal, or the diagonal blocks, of the matrix of a
+/// bilinear form into a vector, see fem::assemble_diagonal. The vector
+/// is zeroed, and the ghost contributions are accumulated on the owners
+/// (reverse scatter). Ghost entries are not updated on exit.
+/// @param[in,out] d The vector, on the index map of the space of `a`
+/// with the block size of the dofmap (diagonal) or its square (diagonal
+/// blocks)
+/// @param[in] a The bilinear form, with the same test and trial space
+/// @param[in] bcs Boundary conditions to apply
+/// @param[in] diagonal The diagonal value for boundary condition rows
+/// @param[in] num_threads The number of threads to use
+template <typename T, class Allocator>
+void assemble_diagonal(
+    la::Vector<T, Allocator>& d, const Form<T>& a,
+    const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs,
+    T diagonal = 1.0, int num_threads = 1)
+{
+  const std::vector<T> constants = pack_constants(a);
+  const array2d<T> coeffs = pack_coefficients(a);
+  const int bs = a.function_spaces().at(0)->dofmap()->bs();
+  const bool block = bs > 1 and d.bs() == bs * bs;
+
+  // The bc rows are zeroed on all processes and the diagonal is set
+  // only on the owner, so the reverse scatter preserves it
+  std::vector<T, Allocator>& _d = d.mutable_array();
+  std::fill(_d.begin(), _d.end(), 0);
+  assemble_diagonal(xtl::span<T>(_d), a, tcb::make_span(constants), coeffs,
+                    bcs, block, diagonal, num_threads);
+  d.scatter_rev(common::IndexMap::Mode::add);
+}
+
+// -- Fused assembly ---------------------------------------------------------
+
+/// Assemble bilinear and linear forms that are defined on the same mesh
+/// in a single traversal of the mesh cells, e.g. the Jacobian and the
+/// residual of a Newton iteration. The cell kernels of all forms are
+/// executed on a chunk of cells before moving to the next chunk, so
+/// that the mesh geometry and dofmap data are loaded from memory once.
+/// The cell coordinates of a chunk are gathered once for all forms,
+/// and forms with the same coefficients share the packed coefficients.
+/// Facet integrals are assembled form-by-form.
+///
+/// The matrices and vectors are not zeroed or finalised, and the
+/// diagonal entries for Dirichlet rows are not set. Blocked and nested
+/// systems can be assembled by passing an insertion function for each
+/// block.
+/// @param[in] mat_add The functions for adding values into the matrix
+/// of each bilinear form
+/// @param[in] a The bilinear forms
+/// @param[in,out] b The vectors to assemble the linear forms into
+/// @param[in] L The linear forms
+/// @param[in] bcs Boundary conditions to apply to the bilinear forms.
+/// For boundary condition dofs the row and column are zeroed.
+/// @param[in] chunk_size The number of cells that are processed by all
+/// forms before moving to the next cells
+/// @param[in] num_threads The number of threads. If greater than one,
+/// the functions in @p mat_add are called concurrently and must be safe
+/// for concurrent insertion into disjoint rows of the same matrix.
+template <typename T>
+void assemble_fused(
+    const std::vector<
+        std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
+                          const std::int32_t*, const T*)>>& mat_add,
+    const std::vector<std::reference_wrapper<const Form<T>>>& a,
+    const std::vector<xtl::span<T>>& b,
+    const std::vector<std::reference_wrapper<const Form<T>>>& L,
+    const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs,
+    int chunk_size = 128, int num_threads = 1)
+{
+  if (mat_add.size() != a.size())
+    throw std::runtime_error("Mismatch in number of matrices and forms.");
+  if (b.size() != L.size())
+    throw std::runtime_error("Mismatch in number of vectors and forms.");
+
+  // Build dof markers for each bilinear form
+  std::vector<std::array<std::vector<bool>, 2>> bc_markers(a.size());
+  for (std::size_t k = 0; k < a.size(); ++k)
+  {
+    for (int i = 0; i < 2; ++i)
+    {
+      std::shared_ptr<const fem::FunctionSpace> V
+          = a[k].get().function_spaces().at(i);
+      std::shared_ptr<const common::IndexMap> map = V->dofmap()->index_map;
+      const int bs = V->dofmap()->index_map_bs();
+      for (const auto& bc : bcs)
+      {
+        assert(bc);
+        if (V->contains(*bc->function_space()))
+        {
+          bc_markers[k][i].resize(bs * (map->size_local() + map->num_ghosts()),
+                                  false);
+          bc->mark_dofs(bc_markers[k][i]);
+        }
+      }
+    }
+  }
+
+  impl::assemble_fused(mat_add, a, bc_markers, b, L, chunk_size,
+                       num_threads);
+}
+
 // -- Setting bcs ------------------------------------------------------------
 
 // FIXME: Move these function elsewhere?
@@ -372,6 +996,26 @@ void set_bc(xtl::span<T> b,
   }
 }
 
+/// Set bc values in owned (local) part of the vector, multiplied by
+/// 'scale', using merged boundary conditions. The vectors b and x0 must
+/// have the same local size.
+template <typename T>
+void set_bc(xtl::span<T> b, const DirichletBCs<T>& bcs,
+            const xtl::span<const T>& x0, double scale = 1.0)
+{
+  if (b.size() > x0.size())
+    throw std::runtime_error("Size mismatch between b and x0 vectors.");
+  bcs.set(b, x0, scale);
+}
+
+/// Set bc values in owned (local) part of the vector, multiplied by
+/// 'scale', using merged boundary conditions
+template <typename T>
+void set_bc(xtl::span<T> b, const DirichletBCs<T>& bcs, double scale = 1.0)
+{
+  bcs.set(b, scale);
+}
+
 // FIXME: Handle null block
 // FIXME: Pass function spaces rather than forms
 
@@ -5,13 +5,13 @@
 // SPDX-License-Identifier:    LGPL-3.0-or-later
 
 #include "discreteoperators.h"
+#include "sparsitybuild.h"
 
 using namespace dolfinx;
 
 //-----------------------------------------------------------------------------
-la::SparsityPattern
-fem::create_sparsity_discrete_gradient(const fem::FunctionSpace& V0,
-                                       const fem::FunctionSpace& V1)
+void fem::detail::check_discrete_gradient_spaces(const fem::FunctionSpace& V0,
+                                                 const fem::FunctionSpace& V1)
 {
   // Get mesh
   std::shared_ptr<const mesh::Mesh> mesh = V0.mesh();
@@ -48,6 +48,19 @@ fem::create_sparsity_discrete_gradient(const fem::FunctionSpace& V0,
         "Cannot compute discrete gradient operator. Function "
         "space is not a linear nodal function space");
   }
+}
+//-----------------------------------------------------------------------------
+la::SparsityPattern
+fem::create_sparsity_discrete_gradient(const fem::FunctionSpace& V0,
+                                       const fem::FunctionSpace& V1)
+{
+  // Get mesh
+  std::shared_ptr<const mesh::Mesh> mesh = V0.mesh();
+  assert(mesh);
+
+  // Check that V0 is a lowest-order edge space and V1 is a linear
+  // nodal space on the same mesh
+  fem::detail::check_discrete_gradient_spaces(V0, V1);
 
   // Build maps from entities to local dof indices
   std::shared_ptr<const dolfinx::fem::ElementDofLayout> layout0
@@ -136,3 +149,34 @@ fem::create_sparsity_discrete_gradient(const fem::FunctionSpace& V0,
   pattern.assemble();
   return pattern;
 }
+la::SparsityPattern
+fem::create_sparsity_interpolation(const fem::FunctionSpace& V0,
+                                   const fem::FunctionSpace& V1)
+{
+  std::shared_ptr<const mesh::Mesh> mesh = V0.mesh();
+  assert(mesh);
+  assert(V1.mesh());
+  if (mesh->id() != V1.mesh()->id())
+  {
+    throw std::runtime_error("Cannot compute interpolation matrix. Function "
+                             "spaces do not share the same mesh");
+  }
+
+  const std::shared_ptr<const fem::DofMap> dofmap0 = V0.dofmap();
+  const std::shared_ptr<const fem::DofMap> dofmap1 = V1.dofmap();
+  assert(dofmap0);
+  assert(dofmap1);
+  std::array<std::shared_ptr<const common::IndexMap>, 2> index_maps
+      = {{dofmap0->index_map, dofmap1->index_map}};
+  std::array<int, 2> block_sizes
+      = {dofmap0->index_map_bs(), dofmap1->index_map_bs()};
+
+  // The local interpolation matrix couples all dofs of a cell in V0 to
+  // all dofs of the cell in V1
+  la::SparsityPattern pattern(mesh->mpi_comm(), index_maps, block_sizes);
+  sparsitybuild::cells(pattern, mesh->topology(),
+                       {{std::cref(*dofmap0), std::cref(*dofmap1)}});
+  pattern.assemble();
+  return pattern;
+}
+//-----------------------------------------------------------------------------
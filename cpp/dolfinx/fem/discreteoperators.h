@@ -6,19 +6,32 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/utils.h>
 #include <dolfinx/fem/DofMap.h>
 #include <dolfinx/fem/FunctionSpace.h>
+#include <dolfinx/fem/interpolate.h>
 #include <dolfinx/la/SparsityPattern.h>
 #include <dolfinx/mesh/Mesh.h>
 #include <memory>
+#include <tuple>
 #include <vector>
 #include <xtl/xspan.hpp>
 
 namespace dolfinx::fem
 {
 
+namespace detail
+{
+/// Check that V0 is a lowest-order edge space and V1 is a linear nodal
+/// space on the same mesh, and throw an exception otherwise. The edges
+/// of the mesh are created if they do not exist.
+void check_discrete_gradient_spaces(const fem::FunctionSpace& V0,
+                                    const fem::FunctionSpace& V1);
+} // namespace detail
+
 /// @todo Improve documentation
 /// This function class computes the sparsity pattern for discrete gradient
 /// operators (matrices) that map derivatives of finite element functions into
@@ -63,6 +76,60 @@ void assemble_discrete_gradient(
     const std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
                             const std::int32_t*, const T*)>& mat_set,
     const fem::FunctionSpace& V0, const fem::FunctionSpace& V1);
+
+/// Compute the owned rows of the discrete gradient operator A that
+/// takes a \f$w \in H^1\f$ (P1, nodal Lagrange) to \f$v \in
+/// H(curl)\f$ (lowest order Nedelec), i.e. v = Aw, in compressed sparse
+/// row format. See assemble_discrete_gradient.
+///
+/// Each row of A has exactly two entries, so the arrays are written
+/// directly in one pass over the edges, which are split between
+/// threads, without building a sparsity pattern or calling an insertion
+/// function.
+///
+/// @param[in] V0 A H(curl) space
+/// @param[in] V1 A P1 Lagrange space
+/// @param[in] num_threads The number of threads
+/// @return The values, the global column indices and the row offsets
+/// of the owned rows. The entries of row i are in [offsets[i],
+/// offsets[i + 1]).
+template <typename T>
+std::tuple<std::vector<T>, std::vector<std::int64_t>,
+           std::vector<std::int32_t>>
+discrete_gradient_csr(const fem::FunctionSpace& V0,
+                      const fem::FunctionSpace& V1, int num_threads = 1);
+
+/// Build the sparsity pattern for the matrix A that interpolates a
+/// finite element function w in V1 into V0, i.e. v = Aw where v is in
+/// V0. The spaces must be on the same mesh.
+///
+/// @param[in] V0 The space to interpolate into
+/// @param[in] V1 The space to interpolate from
+/// @return The sparsity pattern
+la::SparsityPattern create_sparsity_interpolation(const fem::FunctionSpace& V0,
+                                                  const fem::FunctionSpace& V1);
+
+/// Assemble the matrix A that interpolates a finite element function w
+/// in V1 into V0, i.e. v = Aw where v is in V0, e.g. a prolongation
+/// operator for p-multigrid. The spaces must be on the same mesh, and
+/// the local interpolation matrix of a cell is computed by
+/// fem::InterpolationOperator, which has the same restrictions on the
+/// elements. The entries of A are set on the cells owned by this
+/// process, and an entry that is shared by cells has the same value on
+/// each cell, so `mat_set` should insert rather than add values.
+///
+/// @note If V0 is continuous and V1 is discontinuous, the
+/// interpolation is not well defined on the shared entities of cells.
+///
+/// @param[in] mat_set A function (or lambda capture) to set values in a
+/// matrix, using blocked indices
+/// @param[in] V0 The space to interpolate into
+/// @param[in] V1 The space to interpolate from
+template <typename T>
+void assemble_interpolation_matrix(
+    const std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
+                            const std::int32_t*, const T*)>& mat_set,
+    const fem::FunctionSpace& V0, const fem::FunctionSpace& V1);
 } // namespace dolfinx::fem
 
 using namespace dolfinx;
@@ -76,37 +143,9 @@ void fem::assemble_discrete_gradient(
   std::shared_ptr<const mesh::Mesh> mesh = V0.mesh();
   assert(mesh);
 
-  // Check that mesh is the same for both function spaces
-  assert(V1.mesh());
-  if (mesh != V1.mesh())
-  {
-    throw std::runtime_error("Compute discrete gradient operator. Function "
-                             "spaces do not share the same mesh");
-  }
-
-  // Check that V0 is a (lowest-order) edge basis
-  mesh->topology_mutable().create_entities(1);
-  std::int64_t num_edges_global = mesh->topology().index_map(1)->size_global();
-  const std::int64_t V0dim
-      = V0.dofmap()->index_map->size_global() * V0.dofmap()->index_map_bs();
-  if (V0dim != num_edges_global)
-  {
-    throw std::runtime_error(
-        "Cannot compute discrete gradient operator. Function "
-        "spaces is not a lowest-order edge space");
-  }
-
-  // Check that V1 is a linear nodal basis
-  const std::int64_t num_vertices_global
-      = mesh->topology().index_map(0)->size_global();
-  const std::int64_t V1dim
-      = V1.dofmap()->index_map->size_global() * V1.dofmap()->index_map_bs();
-  if (V1dim != num_vertices_global)
-  {
-    throw std::runtime_error(
-        "Cannot compute discrete gradient operator. Function "
-        "space is not a linear nodal function space");
-  }
+  // Check that V0 is a lowest-order edge space and V1 is a linear
+  // nodal space on the same mesh
+  fem::detail::check_discrete_gradient_spaces(V0, V1);
 
   // Build maps from entities to local dof indices
   std::shared_ptr<const dolfinx::fem::ElementDofLayout> layout0
@@ -203,3 +242,153 @@ void fem::assemble_discrete_gradient(
   }
 }
 //-----------------------------------------------------------------------------
+template <typename T>
+std::tuple<std::vector<T>, std::vector<std::int64_t>,
+           std::vector<std::int32_t>>
+fem::discrete_gradient_csr(const fem::FunctionSpace& V0,
+                           const fem::FunctionSpace& V1, int num_threads)
+{
+  std::shared_ptr<const mesh::Mesh> mesh = V0.mesh();
+  assert(mesh);
+  fem::detail::check_discrete_gradient_spaces(V0, V1);
+
+  // Initialize required connectivities
+  const int tdim = mesh->topology().dim();
+  mesh->topology_mutable().create_connectivity(1, 0);
+  auto e_to_v = mesh->topology().connectivity(1, 0);
+  mesh->topology_mutable().create_connectivity(tdim, 1);
+  auto c_to_e = mesh->topology().connectivity(tdim, 1);
+  mesh->topology_mutable().create_connectivity(1, tdim);
+  auto e_to_c = mesh->topology().connectivity(1, tdim);
+  mesh->topology_mutable().create_connectivity(tdim, 0);
+  auto c_to_v = mesh->topology().connectivity(tdim, 0);
+
+  // Create local lookup tables for the cell dof on each local edge
+  // (V0) and vertex (V1)
+  const fem::ElementDofLayout& layout0 = *V0.dofmap()->element_dof_layout;
+  const fem::ElementDofLayout& layout1 = *V1.dofmap()->element_dof_layout;
+  const mesh::CellType cell_type = mesh->topology().cell_type();
+  std::vector<int> local_edge_dof(mesh::cell_num_entities(cell_type, 1));
+  for (std::size_t i = 0; i < local_edge_dof.size(); ++i)
+  {
+    assert(layout0.entity_dofs(1, i).size() == 1);
+    local_edge_dof[i] = layout0.entity_dofs(1, i)[0];
+  }
+  std::vector<int> local_vertex_dof(mesh::cell_num_entities(cell_type, 0));
+  for (std::size_t i = 0; i < local_vertex_dof.size(); ++i)
+  {
+    assert(layout1.entity_dofs(0, i).size() == 1);
+    local_vertex_dof[i] = layout1.entity_dofs(0, i)[0];
+  }
+
+  const fem::DofMap& dofmap0 = *V0.dofmap();
+  const fem::DofMap& dofmap1 = *V1.dofmap();
+  const std::int32_t num_rows = dofmap0.index_map->size_local();
+  const std::int32_t size_local1 = dofmap1.index_map->size_local();
+  const std::int64_t offset1 = dofmap1.index_map->local_range()[0];
+  const std::vector<std::int64_t>& ghosts1 = dofmap1.index_map->ghosts();
+  const std::vector<std::int64_t>& global_indices
+      = mesh->topology().index_map(0)->global_indices();
+
+  // Each owned row has two entries
+  std::vector<T> values(2 * num_rows);
+  std::vector<std::int64_t> cols(2 * num_rows);
+  std::vector<std::int32_t> offsets(num_rows + 1);
+  for (std::int32_t i = 0; i <= num_rows; ++i)
+    offsets[i] = 2 * i;
+
+  // Compute the row of each edge. The dof of an owned row is on exactly
+  // one edge, so each row is written by one thread.
+  const std::int32_t num_edges = mesh->topology().index_map(1)->size_local()
+                                 + mesh->topology().index_map(1)->num_ghosts();
+  common::for_each_part(
+      num_edges, num_threads,
+      [&](std::int32_t e0, std::int32_t e1, int)
+      {
+        for (std::int32_t e = e0; e < e1; ++e)
+        {
+          // Find local index of edge in one of the cells it is part of
+          xtl::span<const std::int32_t> cells = e_to_c->links(e);
+          assert(cells.size() > 0);
+          const std::int32_t cell = cells[0];
+          xtl::span<const std::int32_t> edges = c_to_e->links(cell);
+          const auto it = std::find(edges.begin(), edges.end(), e);
+          assert(it != edges.end());
+          const std::int32_t row
+              = dofmap0.cell_dofs(cell)[local_edge_dof[std::distance(
+                  edges.begin(), it)]];
+          if (row >= num_rows)
+            continue;
+
+          // Find the local index of each vertex of the edge in the cell
+          // and map to the global dof index
+          xtl::span<const std::int32_t> vertices = e_to_v->links(e);
+          assert(vertices.size() == 2);
+          xtl::span<const std::int32_t> cell_vertices = c_to_v->links(cell);
+          xtl::span<const std::int32_t> dofs1 = dofmap1.cell_dofs(cell);
+          for (int i = 0; i < 2; ++i)
+          {
+            const auto it = std::find(cell_vertices.begin(),
+                                      cell_vertices.end(), vertices[i]);
+            assert(it != cell_vertices.end());
+            const std::int32_t dof
+                = dofs1[local_vertex_dof[std::distance(cell_vertices.begin(),
+                                                       it)]];
+            cols[2 * row + i] = dof < size_local1
+                                    ? offset1 + dof
+                                    : ghosts1[dof - size_local1];
+          }
+
+          const bool flip
+              = global_indices[vertices[1]] < global_indices[vertices[0]];
+          values[2 * row] = flip ? 1 : -1;
+          values[2 * row + 1] = flip ? -1 : 1;
+        }
+      });
+
+  return {std::move(values), std::move(cols), std::move(offsets)};
+}
+//-----------------------------------------------------------------------------
+template <typename T>
+void fem::assemble_interpolation_matrix(
+    const std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
+                            const std::int32_t*, const T*)>& mat_set,
+    const fem::FunctionSpace& V0, const fem::FunctionSpace& V1)
+{
+  // Compute the local interpolation matrix, which also checks that the
+  // spaces are compatible
+  const fem::InterpolationOperator op(V0, V1);
+  const xt::xtensor<double, 2>& M = op.matrix();
+  const int bs = V0.element()->block_size();
+  const std::size_t num_dofs0 = M.shape(0);
+  const std::size_t num_dofs1 = M.shape(1);
+
+  // Expand the local matrix to the (unrolled) dofs of the blocked
+  // elements, which are ordered i * bs + k for dof i of component k
+  const std::size_t ndim0 = bs * num_dofs0;
+  const std::size_t ndim1 = bs * num_dofs1;
+  std::vector<T> Ae(ndim0 * ndim1, 0);
+  for (std::size_t i = 0; i < num_dofs0; ++i)
+    for (std::size_t j = 0; j < num_dofs1; ++j)
+      for (int k = 0; k < bs; ++k)
+        Ae[(i * bs + k) * ndim1 + j * bs + k] = M(i, j);
+
+  std::shared_ptr<const mesh::Mesh> mesh = V0.mesh();
+  assert(mesh);
+  const int tdim = mesh->topology().dim();
+  const std::int32_t num_cells = mesh->topology().index_map(tdim)->size_local();
+  const std::shared_ptr<const fem::DofMap> dofmap0 = V0.dofmap();
+  const std::shared_ptr<const fem::DofMap> dofmap1 = V1.dofmap();
+  assert(dofmap0);
+  assert(dofmap1);
+  for (std::int32_t c = 0; c < num_cells; ++c)
+  {
+    xtl::span<const std::int32_t> dofs0 = dofmap0->cell_dofs(c);
+    xtl::span<const std::int32_t> dofs1 = dofmap1->cell_dofs(c);
+    assert(dofs0.size() * dofmap0->bs() == ndim0);
+    assert(dofs1.size() * dofmap1->bs() == ndim1);
+    mat_set(dofs0.size(), dofs0.data(), dofs1.size(), dofs1.data(),
+            Ae.data());
+  }
+}
+//-----------------------------------------------------------------------------
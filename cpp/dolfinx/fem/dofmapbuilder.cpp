@@ -7,7 +7,9 @@
 #include "dofmapbuilder.h"
 #include "ElementDofLayout.h"
 #include <algorithm>
+#include <atomic>
 #include <cstdlib>
+#include <dolfinx/common/Arena.h>
 #include <dolfinx/common/IndexMap.h>
 #include <dolfinx/common/MPI.h>
 #include <dolfinx/common/Timer.h>
@@ -15,6 +17,7 @@
 #include <dolfinx/graph/AdjacencyList.h>
 #include <dolfinx/mesh/Topology.h>
 #include <iterator>
+#include <limits>
 #include <memory>
 #include <numeric>
 #include <random>
@@ -48,7 +51,8 @@ reorder_owned(const graph::AdjacencyList<std::int32_t>& dofmap,
   std::vector<std::int32_t> graph_data, graph_offsets;
 
   // Compute maximum number of graph out edges edges per dof
-  std::vector<int> num_edges(owned_size);
+  common::ArenaScope scope;
+  std::pmr::vector<int> num_edges(owned_size, scope.resource());
   for (std::int32_t cell = 0; cell < dofmap.num_nodes(); ++cell)
   {
     auto nodes = dofmap.links(cell);
@@ -68,10 +72,11 @@ reorder_owned(const graph::AdjacencyList<std::int32_t>& dofmap,
   }
 
   // Compute adjacency list with duplicate edges
-  std::vector<std::int32_t> offsets(num_edges.size() + 1, 0);
+  std::pmr::vector<std::int32_t> offsets(num_edges.size() + 1, 0,
+                                         scope.resource());
   std::partial_sum(num_edges.begin(), num_edges.end(),
                    std::next(offsets.begin(), 1));
-  std::vector<std::int32_t> edges(offsets.back());
+  std::pmr::vector<std::int32_t> edges(offsets.back(), scope.resource());
   for (std::int32_t cell = 0; cell < dofmap.num_nodes(); ++cell)
   {
     auto nodes = dofmap.links(cell);
@@ -123,13 +128,15 @@ reorder_owned(const graph::AdjacencyList<std::int32_t>& dofmap,
 /// @param [in] mesh The mesh to build the dofmap on
 /// @param [in] topology The mesh topology
 /// @param [in] element_dof_layout The layout of dofs on a cell
+/// @param [in] num_threads The number of threads
 /// @return Returns {dofmap (local to the process), local-to-global map
 /// to get the global index of local dof i, dof indices, vector of
 /// {dimension, mesh entity index} for each local dof i}
 std::tuple<graph::AdjacencyList<std::int32_t>, std::vector<std::int64_t>,
            std::vector<std::pair<std::int8_t, std::int32_t>>>
 build_basic_dofmap(const mesh::Topology& topology,
-                   const fem::ElementDofLayout& element_dof_layout)
+                   const fem::ElementDofLayout& element_dof_layout,
+                   int num_threads)
 {
   // Start timer for dofmap initialization
   common::Timer t0("Init dofmap from element dofmap");
@@ -139,8 +146,8 @@ build_basic_dofmap(const mesh::Topology& topology,
 
   // Generate and number required mesh entities
   std::vector<bool> needs_entities(D + 1, false);
-  std::vector<std::int32_t> num_mesh_entities_local(D + 1, 0),
-      num_mesh_entities_global(D + 1, 0);
+  std::vector<std::int32_t> num_mesh_entities_local(D + 1, 0);
+  std::vector<std::int64_t> num_mesh_entities_global(D + 1, 0);
   for (int d = 0; d <= D; ++d)
   {
     if (element_dof_layout.num_entity_dofs(d) > 0)
@@ -176,10 +183,21 @@ build_basic_dofmap(const mesh::Topology& topology,
     }
   }
 
+  // Offsets of the dofs of each dimension in the local and global dof
+  // numbering. The dofs of each entity are numbered contiguously.
+  std::vector<std::int32_t> offset_local(D + 2, 0);
+  std::vector<std::int64_t> offset_global(D + 2, 0);
+  for (int d = 0; d <= D; ++d)
+  {
+    const int num_entity_dofs = element_dof_layout.num_entity_dofs(d);
+    offset_local[d + 1]
+        = offset_local[d] + num_entity_dofs * num_mesh_entities_local[d];
+    offset_global[d + 1]
+        = offset_global[d] + num_entity_dofs * num_mesh_entities_global[d];
+  }
+
   // Number of dofs on this process
-  std::int32_t local_size(0), d(0);
-  for (std::int32_t n : num_mesh_entities_local)
-    local_size += n * element_dof_layout.num_entity_dofs(d++);
+  const std::int32_t local_size = offset_local.back();
 
   // Number of dofs per cell
   const int local_dim = element_dof_layout.num_dofs();
@@ -192,87 +210,69 @@ build_basic_dofmap(const mesh::Topology& topology,
   std::partial_sum(std::next(cell_ptr.begin(), 1), cell_ptr.end(),
                    std::next(cell_ptr.begin(), 1));
 
-  // Allocate entity indices array
-  std::vector<std::vector<int32_t>> entity_indices_local(D + 1);
-  std::vector<std::vector<int64_t>> entity_indices_global(D + 1);
-  for (int d = 0; d <= D; ++d)
-  {
-    const int num_entities = mesh::cell_num_entities(topology.cell_type(), d);
-    entity_indices_local[d].resize(num_entities);
-    entity_indices_global[d].resize(num_entities);
-  }
-
   // Entity dofs on cell (dof = entity_dofs[dim][entity][index])
   const std::vector<std::vector<std::set<int>>>& entity_dofs
       = element_dof_layout.entity_dofs_all();
 
-  // Storage for local-to-global map
-  std::vector<std::int64_t> local_to_global(local_size);
-
-  // Dof -> (dim, entity index) marker
-  std::vector<std::pair<std::int8_t, std::int32_t>> dof_entity(local_size);
-
-  // Loops over cells and build dofmaps from ElementDofmap
-  for (int c = 0; c < connectivity[0]->num_nodes(); ++c)
-  {
-    // Get local (process) and global indices for each cell entity
-    for (int d = 0; d < D; ++d)
-    {
-      if (needs_entities[d])
+  // Loop over cells and build dofmaps from ElementDofmap
+  common::for_each_part(
+      num_cells, num_threads,
+      [&](std::int64_t c0, std::int64_t c1, int)
       {
-        auto entities = connectivity[d]->links(c);
-        for (std::size_t i = 0; i < entities.size(); ++i)
+        for (std::int64_t c = c0; c < c1; ++c)
         {
-          entity_indices_local[d][i] = entities[i];
-          entity_indices_global[d][i] = global_indices[d][entities[i]];
+          for (int d = 0; d <= D; ++d)
+          {
+            if (!needs_entities[d])
+              continue;
+
+            // Iterate over each entity of dimension d, with the cell
+            // handled separately as the cell -> cell connectivity is
+            // not stored
+            const std::int32_t num_entity_dofs
+                = element_dof_layout.num_entity_dofs(d);
+            for (std::size_t e = 0; e < entity_dofs[d].size(); ++e)
+            {
+              const std::int32_t entity
+                  = d < D ? connectivity[d]->links(c)[e] : c;
+              std::int32_t count = 0;
+              for (int dof_local : entity_dofs[d][e])
+              {
+                dofs[cell_ptr[c] + dof_local]
+                    = offset_local[d] + num_entity_dofs * entity + count++;
+              }
+            }
+          }
         }
-      }
-    }
+      });
 
-    // Handle cell index separately because cell.entities(D) doesn't work.
-    if (needs_entities[D])
-    {
-      entity_indices_global[D][0] = global_indices[D][c];
-      entity_indices_local[D][0] = c;
-    }
-
-    // Iterate over each topological dimension
-    std::int32_t offset_local = 0;
-    std::int64_t offset_global = 0;
-    for (auto e_dofs_d = entity_dofs.begin(); e_dofs_d != entity_dofs.end();
-         ++e_dofs_d)
-    {
-      const std::size_t d = std::distance(entity_dofs.begin(), e_dofs_d);
+  // Loop over the mesh entities and compute the global index and the
+  // (dimension, entity index) of each dof
+  std::vector<std::int64_t> local_to_global(local_size);
+  std::vector<std::pair<std::int8_t, std::int32_t>> dof_entity(local_size);
+  for (int d = 0; d <= D; ++d)
+  {
+    if (!needs_entities[d])
+      continue;
 
-      // Iterate over each entity of current dimension d
-      for (auto e_dofs = e_dofs_d->begin(); e_dofs != e_dofs_d->end(); ++e_dofs)
-      {
-        // Get entity indices (local to cell, local to process, and
-        // global)
-        const std::size_t e = std::distance(e_dofs_d->begin(), e_dofs);
-        const std::int32_t e_index_local = entity_indices_local[d][e];
-        const std::int64_t e_index_global = entity_indices_global[d][e];
-
-        // Loop over dofs belong to entity e of dimension d (d, e)
-        // d: topological dimension
-        // e: local entity index
-        // dof_local: local index of dof at (d, e)
-        const std::size_t num_entity_dofs = e_dofs->size();
-        for (auto dof_local = e_dofs->begin(); dof_local != e_dofs->end();
-             ++dof_local)
+    const int num_entity_dofs = element_dof_layout.num_entity_dofs(d);
+    common::for_each_part(
+        num_mesh_entities_local[d], num_threads,
+        [&, d, num_entity_dofs](std::int64_t e0, std::int64_t e1, int)
         {
-          const std::int32_t count = std::distance(e_dofs->begin(), dof_local);
-          const std::int32_t dof
-              = offset_local + num_entity_dofs * e_index_local + count;
-          dofs[cell_ptr[c] + *dof_local] = dof;
-          local_to_global[dof]
-              = offset_global + num_entity_dofs * e_index_global + count;
-          dof_entity[dof] = {d, e_index_local};
-        }
-      }
-      offset_local += entity_dofs[d][0].size() * num_mesh_entities_local[d];
-      offset_global += entity_dofs[d][0].size() * num_mesh_entities_global[d];
-    }
+          for (std::int64_t e = e0; e < e1; ++e)
+          {
+            for (int k = 0; k < num_entity_dofs; ++k)
+            {
+              const std::int32_t dof
+                  = offset_local[d] + num_entity_dofs * e + k;
+              local_to_global[dof] = offset_global[d]
+                                     + num_entity_dofs * global_indices[d][e]
+                                     + k;
+              dof_entity[dof] = {d, e};
+            }
+          }
+        });
   }
 
   return {
@@ -293,6 +293,7 @@ build_basic_dofmap(const mesh::Topology& topology,
 /// @param [in] topology The mesh topology
 /// @param [in] reorder_fn Graph reordering function that is applied for
 /// dof re-ordering
+/// @param [in] num_threads The number of threads
 /// @return The pair (old-to-new local index map, M), where M is the
 /// number of dofs owned by this process
 std::pair<std::vector<std::int32_t>, std::int32_t> compute_reordering_map(
@@ -300,7 +301,8 @@ std::pair<std::vector<std::int32_t>, std::int32_t> compute_reordering_map(
     const std::vector<std::pair<std::int8_t, std::int32_t>>& dof_entity,
     const mesh::Topology& topology,
     const std::function<std::vector<int>(
-        const graph::AdjacencyList<std::int32_t>&)>& reorder_fn)
+        const graph::AdjacencyList<std::int32_t>&)>& reorder_fn,
+    int num_threads)
 {
   common::Timer t0("Compute dof reordering map");
 
@@ -325,22 +327,105 @@ std::pair<std::vector<std::int32_t>, std::int32_t> compute_reordering_map(
   // Create map from old index to new contiguous numbering for locally
   // owned dofs. Set to -1 for unowned dofs.
   std::vector<int> original_to_contiguous(dof_entity.size(), -1);
-  std::int32_t counter_owned(0), counter_unowned(owned_size);
-  for (std::int32_t cell = 0; cell < dofmap.num_nodes(); ++cell)
+  auto owned = [&offset = std::as_const(offset), &dof_entity](std::int32_t dof)
+  {
+    const std::pair<std::int8_t, std::int32_t>& e = dof_entity[dof];
+    return e.second < offset[e.first];
+  };
+  const std::vector<std::int32_t>& dofs = dofmap.array();
+  if (num_threads <= 1)
   {
-    auto dofs = dofmap.links(cell);
-    for (std::size_t i = 0; i < dofs.size(); ++i)
+    std::int32_t counter_owned(0), counter_unowned(owned_size);
+    for (std::int32_t dof : dofs)
     {
-      if (original_to_contiguous[dofs[i]] == -1)
+      if (original_to_contiguous[dof] == -1)
       {
-        const std::pair<std::int8_t, std::int32_t>& e = dof_entity[dofs[i]];
-        if (e.second < offset[e.first])
-          original_to_contiguous[dofs[i]] = counter_owned++;
+        if (owned(dof))
+          original_to_contiguous[dof] = counter_owned++;
         else
-          original_to_contiguous[dofs[i]] = counter_unowned++;
+          original_to_contiguous[dof] = counter_unowned++;
       }
     }
   }
+  else
+  {
+    // Find the first position of each dof in the dofmap. The dofs that
+    // are first found in a part of the dofmap are numbered after the
+    // dofs that are first found in the preceding parts, in the order of
+    // the serial computation.
+    common::ArenaScope scope;
+    std::pmr::vector<std::atomic<std::int64_t>> first(dof_entity.size(),
+                                                      scope.resource());
+    common::for_each_part(
+        first.size(), num_threads,
+        [&first](std::int64_t i0, std::int64_t i1, int)
+        {
+          for (std::int64_t i = i0; i < i1; ++i)
+          {
+            first[i].store(std::numeric_limits<std::int64_t>::max(),
+                           std::memory_order_relaxed);
+          }
+        });
+    common::for_each_part(
+        dofs.size(), num_threads,
+        [&](std::int64_t p0, std::int64_t p1, int)
+        {
+          for (std::int64_t p = p0; p < p1; ++p)
+          {
+            std::atomic<std::int64_t>& f = first[dofs[p]];
+            std::int64_t current = f.load(std::memory_order_relaxed);
+            while (p < current
+                   and !f.compare_exchange_weak(current, p,
+                                                std::memory_order_relaxed))
+            {
+            }
+          }
+        });
+
+    // Count the owned and unowned dofs that are first found in each
+    // part, and compute the first index of each part
+    std::vector<std::int32_t> num_owned(num_threads + 1, 0),
+        num_unowned(num_threads + 1, 0);
+    const int num_parts = common::for_each_part(
+        dofs.size(), num_threads,
+        [&](std::int64_t p0, std::int64_t p1, int t)
+        {
+          for (std::int64_t p = p0; p < p1; ++p)
+          {
+            if (first[dofs[p]].load(std::memory_order_relaxed) == p)
+            {
+              if (owned(dofs[p]))
+                ++num_owned[t + 1];
+              else
+                ++num_unowned[t + 1];
+            }
+          }
+        });
+    num_unowned[0] = owned_size;
+    std::partial_sum(num_owned.begin(),
+                     std::next(num_owned.begin(), num_parts + 1),
+                     num_owned.begin());
+    std::partial_sum(num_unowned.begin(),
+                     std::next(num_unowned.begin(), num_parts + 1),
+                     num_unowned.begin());
+
+    common::for_each_part(
+        dofs.size(), num_threads,
+        [&](std::int64_t p0, std::int64_t p1, int t)
+        {
+          std::int32_t counter_owned = num_owned[t];
+          std::int32_t counter_unowned = num_unowned[t];
+          for (std::int64_t p = p0; p < p1; ++p)
+          {
+            if (const std::int32_t dof = dofs[p];
+                first[dof].load(std::memory_order_relaxed) == p)
+            {
+              original_to_contiguous[dof]
+                  = owned(dof) ? counter_owned++ : counter_unowned++;
+            }
+          }
+        });
+  }
 
   if (reorder_fn)
   {
@@ -349,9 +434,10 @@ std::pair<std::vector<std::int32_t>, std::int32_t> compute_reordering_map(
     // Apply graph reordering to owned dofs
     const std::vector<int> node_remap
         = reorder_owned(dofmap, owned_size, original_to_contiguous, reorder_fn);
-    std::for_each(original_to_contiguous.begin(), original_to_contiguous.end(),
-                  [&node_remap, owned_size](auto index)
-                  { return index < owned_size ? node_remap[index] : index; });
+    std::transform(original_to_contiguous.begin(),
+                   original_to_contiguous.end(), original_to_contiguous.begin(),
+                   [&node_remap, owned_size](auto index)
+                   { return index < owned_size ? node_remap[index] : index; });
   }
 
   return {std::move(original_to_contiguous), owned_size};
@@ -369,6 +455,9 @@ std::pair<std::vector<std::int32_t>, std::int32_t> compute_reordering_map(
 /// @param [in] dof_entity The ith entry gives (topological dim, local
 /// index) of the mesh entity to which node i (old local index) is
 /// associated
+/// @param [in] local_work Work that does not depend on the global
+/// indices of the unowned dofs, which is done while the indices are
+/// communicated
 /// @returns The (0) global indices for unowned dofs, (1) owner rank of
 /// each unowned dof
 std::pair<std::vector<std::int64_t>, std::vector<int>> get_global_indices(
@@ -376,7 +465,8 @@ std::pair<std::vector<std::int64_t>, std::vector<int>> get_global_indices(
     const std::int64_t process_offset,
     const std::vector<std::int64_t>& global_indices_old,
     const std::vector<std::int32_t>& old_to_new,
-    const std::vector<std::pair<std::int8_t, std::int32_t>>& dof_entity)
+    const std::vector<std::pair<std::int8_t, std::int32_t>>& dof_entity,
+    const std::function<void()>& local_work)
 {
   assert(dof_entity.size() == global_indices_old.size());
 
@@ -472,6 +562,9 @@ std::pair<std::vector<std::int64_t>, std::vector<int>> get_global_indices(
     }
   }
 
+  if (local_work)
+    local_work();
+
   std::vector<std::int64_t> local_to_global_new(old_to_new.size() - num_owned);
   std::vector<int> local_to_global_new_owner(old_to_new.size() - num_owned);
   for (std::size_t i = 0; i < requests_dim.size(); ++i)
@@ -516,7 +609,8 @@ fem::build_dofmap_data(
     MPI_Comm comm, const mesh::Topology& topology,
     const ElementDofLayout& element_dof_layout,
     const std::function<std::vector<int>(
-        const graph::AdjacencyList<std::int32_t>&)>& reorder_fn)
+        const graph::AdjacencyList<std::int32_t>&)>& reorder_fn,
+    bool sort_ghosts, int num_threads)
 {
   common::Timer t0("Build dofmap data");
 
@@ -527,7 +621,7 @@ fem::build_dofmap_data(
   // pair {dimension, mesh entity index} giving the mesh entity that dof
   // i is associated with.
   const auto [node_graph0, local_to_global0, dof_entity0]
-      = build_basic_dofmap(topology, element_dof_layout);
+      = build_basic_dofmap(topology, element_dof_layout, num_threads);
 
   // Compute global dofmap dimension
   std::int64_t global_dimension = 0;
@@ -543,19 +637,65 @@ fem::build_dofmap_data(
 
   // Build re-ordering map for data locality and get number of owned
   // nodes
-  const auto [old_to_new, num_owned]
-      = compute_reordering_map(node_graph0, dof_entity0, topology, reorder_fn);
+  auto [old_to_new, num_owned] = compute_reordering_map(
+      node_graph0, dof_entity0, topology, reorder_fn, num_threads);
 
   // Compute process offset for owned nodes
   const std::int64_t process_offset
       = dolfinx::MPI::global_offset(comm, num_owned, true);
 
+  // Build re-ordered dofmap while the global indices of the unowned
+  // dofs are communicated
+  std::vector<std::int32_t> dofmap(node_graph0.array().size());
+  auto remap_dofs = [&dofmap, &node_graph0 = std::as_const(node_graph0),
+                     &old_to_new = std::as_const(old_to_new), num_threads]()
+  {
+    const std::vector<std::int32_t>& old_nodes = node_graph0.array();
+    common::for_each_part(
+        old_nodes.size(), num_threads,
+        [&](std::int64_t i0, std::int64_t i1, int)
+        {
+          for (std::int64_t i = i0; i < i1; ++i)
+            dofmap[i] = old_to_new[old_nodes[i]];
+        });
+  };
+
   // Get global indices for unowned dofs
-  const auto [local_to_global_unowned, local_to_global_owner]
+  auto [local_to_global_unowned, local_to_global_owner]
       = get_global_indices(topology, num_owned, process_offset,
-                           local_to_global0, old_to_new, dof_entity0);
+                           local_to_global0, old_to_new, dof_entity0,
+                           remap_dofs);
   assert(local_to_global_unowned.size() == local_to_global_owner.size());
 
+  // Renumber unowned dofs such that they are contiguous by owning rank
+  // (ascending). Ghost updates can then receive directly into the ghost
+  // region of a vector.
+  if (sort_ghosts)
+  {
+    const std::vector<int>& owners = local_to_global_owner;
+    std::vector<std::int32_t> perm(owners.size());
+    std::iota(perm.begin(), perm.end(), 0);
+    std::stable_sort(perm.begin(), perm.end(),
+                     [&owners](auto a, auto b)
+                     { return owners[a] < owners[b]; });
+
+    std::vector<std::int32_t> pos(perm.size());
+    std::vector<std::int64_t> ghosts(perm.size());
+    std::vector<int> ghost_owners(perm.size());
+    for (std::size_t i = 0; i < perm.size(); ++i)
+    {
+      pos[perm[i]] = i;
+      ghosts[i] = local_to_global_unowned[perm[i]];
+      ghost_owners[i] = owners[perm[i]];
+    }
+
+    for (std::int32_t& node : dofmap)
+      if (node >= num_owned)
+        node = num_owned + pos[node - num_owned];
+    local_to_global_unowned = std::move(ghosts);
+    local_to_global_owner = std::move(ghost_owners);
+  }
+
   // Create IndexMap for dofs range on this process
   auto index_map = std::make_unique<common::IndexMap>(
       comm, num_owned,
@@ -565,25 +705,12 @@ fem::build_dofmap_data(
       local_to_global_unowned, local_to_global_owner);
   assert(index_map);
 
-  // Build re-ordered dofmap
-  std::vector<std::int32_t> dofmap(node_graph0.array().size());
-  for (std::int32_t cell = 0; cell < node_graph0.num_nodes(); ++cell)
-  {
-    // Get dof order on this cell
-    auto old_nodes = node_graph0.links(cell);
-    const std::int32_t local_dim0 = old_nodes.size();
-
-    for (std::int32_t j = 0; j < local_dim0; ++j)
-    {
-      const std::int32_t old_node = old_nodes[j];
-      const std::int32_t new_node = old_to_new[old_node];
-      dofmap[local_dim0 * cell + j] = new_node;
-    }
-  }
-
-  assert(dofmap.size() % node_graph0.num_nodes() == 0);
+  // Each cell has the same number of dofs, so the dofmap is stored in
+  // the compact format without offsets
+  const int degree
+      = node_graph0.num_nodes() > 0 ? node_graph0.num_links(0) : 1;
+  assert(dofmap.size() % degree == 0);
   return {std::move(index_map), element_dof_layout.block_size(),
-          graph::build_adjacency_list<std::int32_t>(
-              std::move(dofmap), dofmap.size() / node_graph0.num_nodes())};
+          graph::AdjacencyList<std::int32_t>(std::move(dofmap), degree)};
 }
 //-----------------------------------------------------------------------------
@@ -35,12 +35,18 @@ class CoordinateElement;
 /// function space
 /// @param[in] reorder_fn Graph reordering function that is applied to
 /// the dofmap
+/// @param[in] sort_ghosts If true, the unowned dofs are numbered
+/// contiguously by owning rank (in ascending rank order). This permits
+/// ghost updates without unpacking received data.
+/// @param[in] num_threads The number of threads used to build the
+/// dofmap and the dof re-ordering map
 /// @return The index map and local to global DOF data for the DOF map
 std::tuple<std::shared_ptr<common::IndexMap>, int,
            graph::AdjacencyList<std::int32_t>>
 build_dofmap_data(MPI_Comm comm, const mesh::Topology& topology,
                   const ElementDofLayout& element_dof_layout,
                   const std::function<std::vector<int>(
-                      const graph::AdjacencyList<std::int32_t>&)>& reorder_fn);
+                      const graph::AdjacencyList<std::int32_t>&)>& reorder_fn,
+                  bool sort_ghosts = false, int num_threads = 1);
 
 } // namespace dolfinx::fem
@@ -11,13 +11,27 @@ namespace dolfinx
 
 // DOLFINx fem interface
 
+#include <dolfinx/fem/AssemblyPlan.h>
+#include <dolfinx/fem/BatchAssembler.h>
+#include <dolfinx/fem/ConstrainedCells.h>
 #include <dolfinx/fem/CoordinateElement.h>
 #include <dolfinx/fem/DirichletBC.h>
+#include <dolfinx/fem/DirichletBCs.h>
 #include <dolfinx/fem/DofMap.h>
+#include <dolfinx/fem/ElementTensorCache.h>
 #include <dolfinx/fem/FiniteElement.h>
 #include <dolfinx/fem/Form.h>
 #include <dolfinx/fem/Function.h>
 #include <dolfinx/fem/FunctionSpace.h>
+#include <dolfinx/fem/InteriorFacets.h>
+#include <dolfinx/fem/LocalSolver.h>
+#include <dolfinx/fem/MatrixFreeOperator.h>
+#include <dolfinx/fem/MultiPointConstraint.h>
+#include <dolfinx/fem/PackedCoefficients.h>
+#include <dolfinx/fem/QuadratureData.h>
+#include <dolfinx/fem/StaticCondensation.h>
+#include <dolfinx/fem/TabulationCache.h>
+#include <dolfinx/fem/TensorProductOperator.h>
 #include <dolfinx/fem/assembler.h>
 #include <dolfinx/fem/discreteoperators.h>
 #include <dolfinx/fem/sparsitybuild.h>
@@ -6,13 +6,47 @@
 
 #include "interpolate.h"
 #include "FiniteElement.h"
+#include "TabulationCache.h"
+#include <dolfinx/common/IndexMap.h>
 #include <dolfinx/mesh/Mesh.h>
+#include <dolfinx/mesh/Topology.h>
+#include <numeric>
 #include <xtensor/xbuilder.hpp>
+#include <xtensor/xmanipulation.hpp>
 #include <xtensor/xtensor.hpp>
 #include <xtensor/xview.hpp>
 
 using namespace dolfinx;
 
+namespace
+{
+//-----------------------------------------------------------------------------
+// Return all cells, including ghosts, of a mesh
+std::vector<std::int32_t> all_cells(const mesh::Mesh& mesh)
+{
+  const int tdim = mesh.topology().dim();
+  auto cell_map = mesh.topology().index_map(tdim);
+  assert(cell_map);
+  std::vector<std::int32_t> cells(cell_map->size_local()
+                                  + cell_map->num_ghosts());
+  std::iota(cells.begin(), cells.end(), 0);
+  return cells;
+}
+//-----------------------------------------------------------------------------
+// Compute the ownership of points with shape (3, num_points)
+geometry::PointOwnership create_ownership(const mesh::Mesh& mesh,
+                                          const xt::xtensor<double, 2>& x,
+                                          int num_threads)
+{
+  assert(x.shape(0) == 3);
+  const xt::xtensor<double, 2> points = xt::transpose(x);
+  return geometry::PointOwnership(
+      mesh, xtl::span<const double>(points.data(), points.size()),
+      num_threads);
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
 //-----------------------------------------------------------------------------
 xt::xtensor<double, 2>
 fem::interpolation_coords(const fem::FiniteElement& element,
@@ -29,8 +63,10 @@ fem::interpolation_coords(const fem::FiniteElement& element,
 
   // Get the interpolation points on the reference cells
   const xt::xtensor<double, 2>& X = element.interpolation_points();
+  std::shared_ptr<const xt::xtensor<double, 4>> phi_table
+      = fem::TabulationCache::instance().tabulate(cmap, 0, X);
   const xt::xtensor<double, 2> phi
-      = xt::view(cmap.tabulate(0, X), 0, xt::all(), xt::all(), 0);
+      = xt::view(*phi_table, 0, xt::all(), xt::all(), 0);
 
   // Push reference coordinates (X) forward to the physical coordinates
   // (x) for each cell
@@ -64,3 +100,86 @@ fem::interpolation_coords(const fem::FiniteElement& element,
   return x;
 }
 //-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+fem::InterpolationPlan::InterpolationPlan(const fem::FunctionSpace& V,
+                                          const mesh::Mesh& mesh,
+                                          int num_threads)
+    : _mesh_u(V.mesh()->id()), _mesh_v(mesh.id()),
+      _element_hash(V.element()->hash()), _cells(all_cells(*V.mesh())),
+      _x(fem::interpolation_coords(*V.element(), *V.mesh(), _cells)),
+      _ownership(create_ownership(mesh, _x, num_threads))
+{
+}
+//-----------------------------------------------------------------------------
+fem::InterpolationOperator::InterpolationOperator(const fem::FunctionSpace& V0,
+                                                  const fem::FunctionSpace& V1)
+    : _mesh(V0.mesh()->id()), _element_hash0(V0.element()->hash()),
+      _element_hash1(V1.element()->hash())
+{
+  assert(V0.mesh());
+  assert(V1.mesh());
+  if (V0.mesh()->id() != V1.mesh()->id())
+  {
+    throw std::runtime_error(
+        "Interpolation operator requires spaces on the same mesh.");
+  }
+
+  std::shared_ptr<const fem::FiniteElement> e0 = V0.element();
+  std::shared_ptr<const fem::FiniteElement> e1 = V1.element();
+  assert(e0);
+  assert(e1);
+  auto is_mixed = [](const fem::FiniteElement& e)
+  {
+    return e.num_sub_elements() > 0
+           and e.num_sub_elements() != e.block_size();
+  };
+  if (is_mixed(*e0) or is_mixed(*e1))
+  {
+    throw std::runtime_error(
+        "Interpolation operator does not support mixed elements.");
+  }
+
+  if (e0->block_size() != e1->block_size()
+      or e0->reference_value_size() != e1->reference_value_size())
+  {
+    throw std::runtime_error("Interpolation operator requires elements with "
+                             "the same block size and value size.");
+  }
+
+  if (!e0->interpolation_ident() or !e1->interpolation_ident()
+      or e0->needs_dof_transformations() or e1->needs_dof_transformations())
+  {
+    throw std::runtime_error(
+        "Interpolation operator requires elements with an identity map and "
+        "without dof transformations.");
+  }
+
+  _bs = e0->block_size();
+
+  // Tabulate the basis functions of the (scalar) sub-element of V1 at
+  // the interpolation points of V0
+  const xt::xtensor<double, 2>& X = e0->interpolation_points();
+  std::shared_ptr<const xt::xtensor<double, 4>> phi_table
+      = fem::TabulationCache::instance().tabulate(*e1, X, 0);
+  const xt::xtensor<double, 4>& phi = *phi_table;
+  const std::size_t num_points = phi.shape(1);
+  const std::size_t num_dofs1 = phi.shape(2);
+  const std::size_t value_size = phi.shape(3);
+  const std::size_t num_dofs0 = e0->space_dimension() / _bs;
+
+  // Interpolate each basis function of V1 in V0, which gives a column
+  // of the local interpolation matrix
+  _matrix = xt::zeros<double>({num_dofs0, num_dofs1});
+  xt::xtensor<double, 2> values({value_size, num_points});
+  std::vector<double> column(num_dofs0);
+  for (std::size_t j = 0; j < num_dofs1; ++j)
+  {
+    for (std::size_t p = 0; p < num_points; ++p)
+      for (std::size_t m = 0; m < value_size; ++m)
+        values(m, p) = phi(0, p, j, m);
+    e0->interpolate(values, xtl::span<double>(column));
+    for (std::size_t i = 0; i < num_dofs0; ++i)
+      _matrix(i, j) = column[i];
+  }
+}
+//-----------------------------------------------------------------------------
@@ -7,10 +7,15 @@
 #pragma once
 
 #include "FunctionSpace.h"
+#include <algorithm>
+#include <dolfinx/common/utils.h>
 #include <dolfinx/fem/DofMap.h>
 #include <dolfinx/fem/FiniteElement.h>
+#include <dolfinx/fem/TabulationCache.h>
+#include <dolfinx/geometry/PointOwnership.h>
 #include <dolfinx/mesh/Mesh.h>
 #include <functional>
+#include <mutex>
 #include <variant>
 #include <xtensor/xadapt.hpp>
 #include <xtensor/xarray.hpp>
@@ -39,7 +44,13 @@ interpolation_coords(const fem::FiniteElement& element, const mesh::Mesh& mesh,
                      const xtl::span<const std::int32_t>& cells);
 
 /// Interpolate a finite element Function (on possibly non-matching
-/// meshes) in another finite element space
+/// meshes) in another finite element space. If the meshes differ, the
+/// interpolation points of u are located in the mesh of v, see
+/// InterpolationPlan. If the meshes are the same and the elements
+/// differ, the local interpolation matrix is computed, see
+/// InterpolationOperator. Use an InterpolationPlan or an
+/// InterpolationOperator directly to interpolate repeatedly between the
+/// same spaces.
 /// @param[out] u The function to interpolate into
 /// @param[in] v The function to be interpolated
 template <typename T>
@@ -63,6 +74,27 @@ void interpolate(
     const xt::xtensor<double, 2>& x,
     const xtl::span<const std::int32_t>& cells);
 
+/// Interpolate an expression in a finite element space on a set of
+/// cells, which are processed in chunks. The interpolation points of
+/// each chunk of cells are computed and the expression is evaluated at
+/// them for each chunk, so that the memory used scales with the chunk
+/// size rather than with the number of cells.
+///
+/// @param[out] u The function to interpolate into
+/// @param[in] f The expression to be interpolated. It is called once
+/// for each chunk, with the points of the chunk. It must be safe to
+/// call f from several threads at once if num_threads > 1.
+/// @param[in] cells Indices of the cells in the mesh on which to
+/// interpolate
+/// @param[in] chunk_size The number of cells in each chunk
+/// @param[in] num_threads The number of threads that process chunks
+template <typename T>
+void interpolate(
+    Function<T>& u,
+    const std::function<xt::xarray<T>(const xt::xtensor<double, 2>&)>& f,
+    const xtl::span<const std::int32_t>& cells, std::size_t chunk_size,
+    int num_threads = 1);
+
 /// Interpolate an expression f(x)
 ///
 /// @note  This interface uses an expression function f that has an
@@ -86,6 +118,240 @@ void interpolate_c(
     const xt::xtensor<double, 2>& x,
     const xtl::span<const std::int32_t>& cells);
 
+/// Migrate a finite element Function to a redistributed copy of its
+/// mesh (see mesh::redistribute). The degrees-of-freedom of each cell
+/// are copied from the rank that owned the cell in the original mesh.
+///
+/// @note Collective over the mesh communicator. The ghost values of @p
+/// v must be up to date.
+/// @param[out] u The function on the redistributed mesh. Its element
+/// must be the same as the element of @p v.
+/// @param[in] v The function on the original mesh
+/// @param[in] cells The global index in the original mesh of each cell
+/// (owned and ghost) of the mesh of @p u, as returned by
+/// mesh::redistribute
+template <typename T>
+void migrate_function(Function<T>& u, const Function<T>& v,
+                      const xtl::span<const std::int64_t>& cells);
+
+/// A plan for interpolating finite element Functions defined on a
+/// mesh that may not match, and may be partitioned differently from,
+/// the mesh of the space that is interpolated into. The interpolation
+/// points of the space are located in the other mesh once, when the
+/// plan is created (see geometry::PointOwnership). Interpolating a
+/// Function then only evaluates it at the points that are owned by
+/// each process and sends the values to the processes that need them.
+///
+/// Interpolation points that are outside the other mesh are assigned
+/// the value zero.
+class InterpolationPlan
+{
+public:
+  /// Create an interpolation plan (collective)
+  /// @param[in] V The space to interpolate into
+  /// @param[in] mesh The mesh of the Functions to be interpolated,
+  /// distributed over the same communicator as the mesh of V
+  /// @param[in] num_threads The number of threads used to locate the
+  /// interpolation points
+  InterpolationPlan(const FunctionSpace& V, const mesh::Mesh& mesh,
+                    int num_threads = 1);
+
+  /// Move constructor
+  InterpolationPlan(InterpolationPlan&& plan) = default;
+
+  /// Destructor
+  ~InterpolationPlan() = default;
+
+  /// Move assignment
+  InterpolationPlan& operator=(InterpolationPlan&& plan) = default;
+
+  /// The interpolation points of the space, with shape (3, num_points)
+  const xt::xtensor<double, 2>& points() const { return _x; }
+
+  /// The ownership of the interpolation points in the other mesh
+  const geometry::PointOwnership& ownership() const { return _ownership; }
+
+  /// Interpolate a Function in the space of another Function
+  /// (collective)
+  /// @param[out] u The function to interpolate into. Its space must be
+  /// the space that the plan was created for.
+  /// @param[in] v The function to be interpolated. It must be defined
+  /// on the mesh that the plan was created for, and its ghost values
+  /// must be up-to-date.
+  template <typename T>
+  void interpolate(Function<T>& u, const Function<T>& v) const
+  {
+    assert(u.function_space());
+    assert(v.function_space());
+    assert(u.function_space()->mesh());
+    assert(v.function_space()->mesh());
+    if (u.function_space()->mesh()->id() != _mesh_u
+        or u.function_space()->element()->hash() != _element_hash)
+    {
+      throw std::runtime_error("Function to interpolate into is not in the "
+                               "space of the interpolation plan.");
+    }
+    if (v.function_space()->mesh()->id() != _mesh_v)
+    {
+      throw std::runtime_error("Function to be interpolated is not on the "
+                               "mesh of the interpolation plan.");
+    }
+
+    const std::size_t value_size = u.function_space()->element()->value_size();
+    if (v.function_space()->element()->value_size() != (int)value_size)
+    {
+      throw std::runtime_error("Cannot interpolate function with different "
+                               "value size.");
+    }
+
+    // Evaluate v at the interpolation points
+    xt::xtensor<T, 2> values({_x.shape(1), value_size});
+    v.eval(_ownership, values);
+
+    // Interpolate the values, which are computed at the points that
+    // are passed to the expression
+    auto f = [&values](const xt::xtensor<double, 2>&) -> xt::xarray<T>
+    { return xt::transpose(values); };
+    fem::interpolate<T>(u, f, _x, _cells);
+  }
+
+private:
+  // Ids of the meshes and the element hash of the space, used to check
+  // the Functions
+  std::size_t _mesh_u, _mesh_v, _element_hash;
+
+  // Cells (local to process) of the mesh of the space, including
+  // ghosts, and their interpolation points
+  std::vector<std::int32_t> _cells;
+  xt::xtensor<double, 2> _x;
+
+  // Ownership of the interpolation points in the other mesh
+  geometry::PointOwnership _ownership;
+};
+
+/// An operator for interpolating finite element Functions between two
+/// spaces on the same mesh. The matrix that maps the degrees-of-freedom
+/// of a cell in one space to the degrees-of-freedom of the cell in the
+/// other space is computed once, when the operator is created, by
+/// tabulating the basis functions of the space that is interpolated
+/// from at the interpolation points of the space that is interpolated
+/// into. Interpolating a Function is then a matrix-vector product on
+/// each cell.
+///
+/// The local matrix is the same for every cell, so the elements of
+/// both spaces must have an identity map from the reference cell (see
+/// FiniteElement::interpolation_ident) and must not need dof
+/// transformations, e.g. Lagrange and discontinuous Lagrange elements.
+class InterpolationOperator
+{
+public:
+  /// Create an interpolation operator
+  /// @param[in] V0 The space to interpolate into
+  /// @param[in] V1 The space to interpolate from, on the same mesh as
+  /// V0
+  InterpolationOperator(const FunctionSpace& V0, const FunctionSpace& V1);
+
+  /// Move constructor
+  InterpolationOperator(InterpolationOperator&& op) = default;
+
+  /// Destructor
+  ~InterpolationOperator() = default;
+
+  /// Move assignment
+  InterpolationOperator& operator=(InterpolationOperator&& op) = default;
+
+  /// The local interpolation matrix of a cell, with shape
+  /// (num_dofs0, num_dofs1), where num_dofs0 and num_dofs1 are the
+  /// number of dofs of the (scalar) sub-elements of V0 and V1. The
+  /// matrix is applied to each component of blocked elements.
+  const xt::xtensor<double, 2>& matrix() const { return _matrix; }
+
+  /// Interpolate a Function in the space of another Function
+  /// @param[out] u The function to interpolate into. Its space must be
+  /// the space V0 that the operator was created for.
+  /// @param[in] v The function to be interpolated. Its space must be
+  /// the space V1 that the operator was created for.
+  template <typename T>
+  void interpolate(Function<T>& u, const Function<T>& v) const
+  {
+    assert(u.function_space());
+    assert(v.function_space());
+    assert(u.function_space()->mesh());
+    assert(v.function_space()->mesh());
+    if (u.function_space()->mesh()->id() != _mesh
+        or u.function_space()->element()->hash() != _element_hash0)
+    {
+      throw std::runtime_error("Function to interpolate into is not in the "
+                               "space of the interpolation operator.");
+    }
+    if (v.function_space()->mesh()->id() != _mesh
+        or v.function_space()->element()->hash() != _element_hash1)
+    {
+      throw std::runtime_error("Function to be interpolated is not in the "
+                               "space of the interpolation operator.");
+    }
+
+    const auto mesh = u.function_space()->mesh();
+    const int tdim = mesh->topology().dim();
+    auto map = mesh->topology().index_map(tdim);
+    assert(map);
+    const std::int32_t num_cells = map->size_local() + map->num_ghosts();
+
+    std::shared_ptr<const fem::DofMap> dofmap0 = u.function_space()->dofmap();
+    std::shared_ptr<const fem::DofMap> dofmap1 = v.function_space()->dofmap();
+    assert(dofmap0);
+    assert(dofmap1);
+    const int dofmap_bs0 = dofmap0->bs();
+    const int dofmap_bs1 = dofmap1->bs();
+
+    std::vector<T>& coeffs = u.x()->mutable_array();
+    const std::vector<T>& v_array = v.x()->array();
+
+    // Iterate over all cells, including ghosts, so that the ghost
+    // values of u are also up-to-date
+    const std::size_t num_dofs0 = _matrix.shape(0);
+    const std::size_t num_dofs1 = _matrix.shape(1);
+    std::vector<T> v_local(num_dofs1);
+    for (std::int32_t c = 0; c < num_cells; ++c)
+    {
+      xtl::span<const std::int32_t> dofs0 = dofmap0->cell_dofs(c);
+      xtl::span<const std::int32_t> dofs1 = dofmap1->cell_dofs(c);
+      for (int k = 0; k < _bs; ++k)
+      {
+        // Extract component k of the dofs of v on the cell
+        for (std::size_t j = 0; j < num_dofs1; ++j)
+        {
+          const int dof = j * _bs + k;
+          std::div_t pos = std::div(dof, dofmap_bs1);
+          v_local[j] = v_array[dofmap_bs1 * dofs1[pos.quot] + pos.rem];
+        }
+
+        // Compute component k of the dofs of u on the cell
+        for (std::size_t i = 0; i < num_dofs0; ++i)
+        {
+          T value = 0;
+          for (std::size_t j = 0; j < num_dofs1; ++j)
+            value += _matrix(i, j) * v_local[j];
+          const int dof = i * _bs + k;
+          std::div_t pos = std::div(dof, dofmap_bs0);
+          coeffs[dofmap_bs0 * dofs0[pos.quot] + pos.rem] = value;
+        }
+      }
+    }
+  }
+
+private:
+  // Id of the mesh and the element hashes of the spaces, used to check
+  // the Functions
+  std::size_t _mesh, _element_hash0, _element_hash1;
+
+  // Block size of the elements
+  int _bs;
+
+  // Local interpolation matrix, with shape (num_dofs0, num_dofs1)
+  xt::xtensor<double, 2> _matrix;
+};
+
 namespace detail
 {
 
@@ -177,25 +443,44 @@ void interpolate(Function<T>& u, const Function<T>& v)
     }
   }
 
-  detail::interpolate_from_any(u, v);
+  assert(u.function_space()->mesh());
+  assert(v.function_space()->mesh());
+  if (u.function_space()->mesh()->id() != v.function_space()->mesh()->id())
+  {
+    InterpolationPlan plan(*u.function_space(), *v.function_space()->mesh());
+    plan.interpolate(u, v);
+  }
+  else if (v.function_space()->element()->hash() != element->hash())
+  {
+    InterpolationOperator op(*u.function_space(), *v.function_space());
+    op.interpolate(u, v);
+  }
+  else
+    detail::interpolate_from_any(u, v);
 }
 //----------------------------------------------------------------------------
+namespace detail
+{
+/// Compute the degrees-of-freedom of u on a set of cells from the
+/// values of an expression at the interpolation points of the cells,
+/// and set them in the degree-of-freedom vector of u.
+/// @param[out] u The function to interpolate into
+/// @param[in] values The expression values, with shape (value size,
+/// number of cells * number of interpolation points). An array with
+/// shape (number of cells * number of interpolation points) is
+/// accepted for scalar elements and is reshaped.
+/// @param[in] cells Indices of the cells in the mesh
+/// @param[in] mutex If not null, the mutex is locked while the
+/// degrees-of-freedom are set in the vector of u
 template <typename T>
-void interpolate(
-    Function<T>& u,
-    const std::function<xt::xarray<T>(const xt::xtensor<double, 2>&)>& f,
-    const xt::xtensor<double, 2>& x, const xtl::span<const std::int32_t>& cells)
+void interpolate_cells(Function<T>& u, xt::xarray<T>& values,
+                       const xtl::span<const std::int32_t>& cells,
+                       std::mutex* mutex = nullptr)
 {
   const std::shared_ptr<const FiniteElement> element
       = u.function_space()->element();
   assert(element);
   const int element_bs = element->block_size();
-  if (int num_sub = element->num_sub_elements();
-      num_sub > 0 and num_sub != element_bs)
-  {
-    throw std::runtime_error("Cannot directly interpolate a mixed space. "
-                             "Interpolate into subspaces.");
-  }
 
   // Get mesh
   assert(u.function_space());
@@ -207,35 +492,23 @@ void interpolate(
 
   // Get the interpolation points on the reference cells
   const xt::xtensor<double, 2>& X = element->interpolation_points();
+  const std::size_t num_points = X.shape(0);
 
-  if (X.shape(0) == 0)
-  {
-    throw std::runtime_error(
-        "Interpolation into this space is not yet supported.");
-  }
-
-  mesh->topology_mutable().create_entity_permutations();
   const std::vector<std::uint32_t>& cell_info
       = mesh->topology().get_cell_permutation_info();
 
-  // Evaluate function at physical points. The returned array has a
-  // number of rows equal to the number of components of the function,
-  // and the number of columns is equal to the number of evaluation
-  // points.
-  xt::xarray<T> values = f(x);
-
   if (values.dimension() == 1)
   {
     if (element->value_size() != 1)
       throw std::runtime_error("Interpolation data has the wrong shape.");
-    values.reshape(
-        {static_cast<std::size_t>(element->value_size()), x.shape(1)});
+    values.reshape({static_cast<std::size_t>(element->value_size()),
+                    values.shape(0)});
   }
 
   if (values.shape(0) != element->value_size())
     throw std::runtime_error("Interpolation data has the wrong shape.");
 
-  if (values.shape(1) != cells.size() * X.shape(0))
+  if (values.shape(1) != cells.size() * num_points)
     throw std::runtime_error("Interpolation data has the wrong shape.");
 
   // Get dofmap
@@ -243,37 +516,35 @@ void interpolate(
   assert(dofmap);
   const int dofmap_bs = dofmap->bs();
 
-  // Loop over cells and compute interpolation dofs
+  // Loop over cells and compute interpolation dofs. The dofs of cell
+  // cells[c] are computed in cell_coeffs[c * space_dim:(c + 1) *
+  // space_dim].
   const int num_scalar_dofs = element->space_dimension() / element_bs;
   const int value_size = element->value_size() / element_bs;
-
-  std::vector<T>& coeffs = u.x()->mutable_array();
+  const int space_dim = element->space_dimension();
+  std::vector<T> cell_coeffs(cells.size() * space_dim);
   std::vector<T> _coeffs(num_scalar_dofs);
 
-  const std::function<void(const xtl::span<T>&,
-                           const xtl::span<const std::uint32_t>&, std::int32_t,
-                           int)>
-      apply_inverse_transpose_dof_transformation
-      = element->get_dof_transformation_function<T>(true, true, true);
-
   // This assumes that any element with an identity interpolation matrix is a
   // point evaluation
   if (element->interpolation_ident())
   {
-    for (std::int32_t c : cells)
+    const std::function<void(const xtl::span<T>&,
+                             const xtl::span<const std::uint32_t>&,
+                             std::int32_t, int)>
+        apply_inverse_transpose_dof_transformation
+        = element->get_dof_transformation_function<T>(true, true, true);
+
+    for (std::size_t c = 0; c < cells.size(); ++c)
     {
-      xtl::span<const std::int32_t> dofs = dofmap->cell_dofs(c);
       for (int k = 0; k < element_bs; ++k)
       {
         for (int i = 0; i < num_scalar_dofs; ++i)
           _coeffs[i] = values(k, c * num_scalar_dofs + i);
-        apply_inverse_transpose_dof_transformation(_coeffs, cell_info, c, 1);
+        apply_inverse_transpose_dof_transformation(_coeffs, cell_info,
+                                                   cells[c], 1);
         for (int i = 0; i < num_scalar_dofs; ++i)
-        {
-          const int dof = i * element_bs + k;
-          std::div_t pos = std::div(dof, dofmap_bs);
-          coeffs[dofmap_bs * dofs[pos.quot] + pos.rem] = _coeffs[i];
-        }
+          cell_coeffs[c * space_dim + i * element_bs + k] = _coeffs[i];
       }
     }
   }
@@ -290,20 +561,22 @@ void interpolate(
     const xt::xtensor<double, 2>& x_g = mesh->geometry().x();
 
     // Create data structures for Jacobian info
-    xt::xtensor<double, 3> J = xt::empty<double>({int(X.shape(0)), gdim, tdim});
-    xt::xtensor<double, 3> K = xt::empty<double>({int(X.shape(0)), tdim, gdim});
-    xt::xtensor<double, 1> detJ = xt::empty<double>({X.shape(0)});
+    xt::xtensor<double, 3> J = xt::empty<double>({int(num_points), gdim, tdim});
+    xt::xtensor<double, 3> K = xt::empty<double>({int(num_points), tdim, gdim});
+    xt::xtensor<double, 1> detJ = xt::empty<double>({num_points});
 
     xt::xtensor<double, 2> coordinate_dofs
         = xt::empty<double>({num_dofs_g, gdim});
 
-    xt::xtensor<T, 3> reference_data({X.shape(0), 1, value_size});
-    xt::xtensor<T, 3> _vals({X.shape(0), 1, value_size});
+    xt::xtensor<T, 3> reference_data({num_points, 1, value_size});
+    xt::xtensor<T, 3> _vals({num_points, 1, value_size});
 
     // Tabulate 1st order derivatives of shape functions at interpolation coords
+    std::shared_ptr<const xt::xtensor<double, 4>> phi_table
+        = TabulationCache::instance().tabulate(cmap, 1, X);
     xt::xtensor<double, 4> dphi
-        = xt::view(cmap.tabulate(1, X), xt::range(1, tdim + 1), xt::all(),
-                   xt::all(), xt::all());
+        = xt::view(*phi_table, xt::range(1, tdim + 1), xt::all(), xt::all(),
+                   xt::all());
 
     const std::function<void(const xtl::span<T>&,
                              const xtl::span<const std::uint32_t>&,
@@ -311,9 +584,9 @@ void interpolate(
         apply_inverse_transpose_dof_transformation
         = element->get_dof_transformation_function<T>(true, true);
 
-    for (std::int32_t c : cells)
+    for (std::size_t c = 0; c < cells.size(); ++c)
     {
-      auto x_dofs = x_dofmap.links(c);
+      auto x_dofs = x_dofmap.links(cells[c]);
       for (int i = 0; i < num_dofs_g; ++i)
         for (int j = 0; j < gdim; ++j)
           coordinate_dofs(i, j) = x_g(x_dofs[i], j);
@@ -323,13 +596,12 @@ void interpolate(
       cmap.compute_jacobian_inverse(J, K);
       cmap.compute_jacobian_determinant(J, detJ);
 
-      xtl::span<const std::int32_t> dofs = dofmap->cell_dofs(c);
       for (int k = 0; k < element_bs; ++k)
       {
         // Extract computed expression values for element block k
         for (int m = 0; m < value_size; ++m)
         {
-          std::copy_n(&values(k * value_size + m, c * X.shape(0)), X.shape(0),
+          std::copy_n(&values(k * value_size + m, c * num_points), num_points,
                       xt::view(_vals, xt::all(), 0, m).begin());
         }
 
@@ -339,20 +611,106 @@ void interpolate(
         xt::xtensor<T, 2> ref_data
             = xt::transpose(xt::view(reference_data, xt::all(), 0, xt::all()));
         element->interpolate(ref_data, tcb::make_span(_coeffs));
-        apply_inverse_transpose_dof_transformation(_coeffs, cell_info, c, 1);
+        apply_inverse_transpose_dof_transformation(_coeffs, cell_info,
+                                                   cells[c], 1);
 
         assert(_coeffs.size() == num_scalar_dofs);
-
-        // Copy interpolation dofs into coefficient vector
         for (int i = 0; i < num_scalar_dofs; ++i)
-        {
-          const int dof = i * element_bs + k;
-          std::div_t pos = std::div(dof, dofmap_bs);
-          coeffs[dofmap_bs * dofs[pos.quot] + pos.rem] = _coeffs[i];
-        }
+          cell_coeffs[c * space_dim + i * element_bs + k] = _coeffs[i];
       }
     }
   }
+
+  // Copy interpolation dofs into coefficient vector
+  std::unique_lock<std::mutex> lock;
+  if (mutex)
+    lock = std::unique_lock<std::mutex>(*mutex);
+  std::vector<T>& coeffs = u.x()->mutable_array();
+  for (std::size_t c = 0; c < cells.size(); ++c)
+  {
+    xtl::span<const std::int32_t> dofs = dofmap->cell_dofs(cells[c]);
+    for (int dof = 0; dof < space_dim; ++dof)
+    {
+      std::div_t pos = std::div(dof, dofmap_bs);
+      coeffs[dofmap_bs * dofs[pos.quot] + pos.rem]
+          = cell_coeffs[c * space_dim + dof];
+    }
+  }
+}
+
+/// Check that an element can be interpolated into directly, and
+/// compute the cell permutation data of the mesh
+/// @param[in] V The space to interpolate into
+inline void prepare_interpolation(const FunctionSpace& V)
+{
+  std::shared_ptr<const FiniteElement> element = V.element();
+  assert(element);
+  if (int num_sub = element->num_sub_elements();
+      num_sub > 0 and num_sub != element->block_size())
+  {
+    throw std::runtime_error("Cannot directly interpolate a mixed space. "
+                             "Interpolate into subspaces.");
+  }
+
+  if (element->interpolation_points().shape(0) == 0)
+  {
+    throw std::runtime_error(
+        "Interpolation into this space is not yet supported.");
+  }
+
+  assert(V.mesh());
+  V.mesh()->topology_mutable().create_entity_permutations();
+}
+} // namespace detail
+//----------------------------------------------------------------------------
+template <typename T>
+void interpolate(
+    Function<T>& u,
+    const std::function<xt::xarray<T>(const xt::xtensor<double, 2>&)>& f,
+    const xt::xtensor<double, 2>& x, const xtl::span<const std::int32_t>& cells)
+{
+  assert(u.function_space());
+  detail::prepare_interpolation(*u.function_space());
+
+  // Evaluate function at physical points. The returned array has a
+  // number of rows equal to the number of components of the function,
+  // and the number of columns is equal to the number of evaluation
+  // points.
+  xt::xarray<T> values = f(x);
+  detail::interpolate_cells(u, values, cells);
+}
+//----------------------------------------------------------------------------
+template <typename T>
+void interpolate(
+    Function<T>& u,
+    const std::function<xt::xarray<T>(const xt::xtensor<double, 2>&)>& f,
+    const xtl::span<const std::int32_t>& cells, std::size_t chunk_size,
+    int num_threads)
+{
+  assert(u.function_space());
+  detail::prepare_interpolation(*u.function_space());
+  const FiniteElement& element = *u.function_space()->element();
+  const mesh::Mesh& mesh = *u.function_space()->mesh();
+
+  if (chunk_size == 0)
+    throw std::runtime_error("Chunk size must be greater than zero.");
+  const std::size_t num_chunks = (cells.size() + chunk_size - 1) / chunk_size;
+  std::mutex mutex;
+  common::for_each_part(
+      num_chunks, num_threads,
+      [&](std::int64_t c0, std::int64_t c1, int)
+      {
+        for (std::int64_t chunk = c0; chunk < c1; ++chunk)
+        {
+          const std::size_t offset = chunk * chunk_size;
+          xtl::span<const std::int32_t> _cells = cells.subspan(
+              offset, std::min(chunk_size, cells.size() - offset));
+          const xt::xtensor<double, 2> x
+              = interpolation_coords(element, mesh, _cells);
+          xt::xarray<T> values = f(x);
+          detail::interpolate_cells(u, values, _cells, &mutex);
+        }
+      });
 }
 //----------------------------------------------------------------------------
 template <typename T>
@@ -380,5 +738,69 @@ void interpolate_c(
   interpolate<T>(u, fn, x, cells);
 }
 //----------------------------------------------------------------------------
+template <typename T>
+void migrate_function(Function<T>& u, const Function<T>& v,
+                      const xtl::span<const std::int64_t>& cells)
+{
+  assert(u.function_space());
+  assert(v.function_space());
+  const auto element = u.function_space()->element();
+  assert(element);
+  if (v.function_space()->element()->hash() != element->hash())
+  {
+    throw std::runtime_error(
+        "Migrating functions between different elements not supported.");
+  }
+
+  // The cell-local order of the degrees-of-freedom depends on the
+  // global vertex numbering for elements with dof transformations,
+  // which changes when the mesh is redistributed
+  if (element->needs_dof_transformations()
+      or element->needs_dof_permutations())
+  {
+    throw std::runtime_error("Migrating functions in elements with dof "
+                             "transformations not supported (yet).");
+  }
+
+  const auto mesh0 = v.function_space()->mesh();
+  assert(mesh0);
+  const int tdim = mesh0->topology().dim();
+  auto cell_map0 = mesh0->topology().index_map(tdim);
+  assert(cell_map0);
+
+  // Pack the degrees-of-freedom of the owned cells of the original mesh
+  std::shared_ptr<const fem::DofMap> dofmap_v = v.function_space()->dofmap();
+  assert(dofmap_v);
+  const int bs = dofmap_v->bs();
+  const std::vector<T>& v_array = v.x()->array();
+  std::vector<T> data;
+  std::vector<std::int32_t> offsets = {0};
+  for (std::int32_t c = 0; c < cell_map0->size_local(); ++c)
+  {
+    for (std::int32_t dof : dofmap_v->cell_dofs(c))
+      for (int k = 0; k < bs; ++k)
+        data.push_back(v_array[bs * dof + k]);
+    offsets.push_back(data.size());
+  }
+  const graph::AdjacencyList<T> cell_data = mesh::migrate_cell_data(
+      mesh0->mpi_comm(), *cell_map0,
+      graph::AdjacencyList<T>(std::move(data), std::move(offsets)), cells);
+
+  // Copy the degrees-of-freedom to the cells of the new mesh
+  const auto dofmap_u = u.function_space()->dofmap();
+  assert(dofmap_u);
+  assert(bs == dofmap_u->bs());
+  std::vector<T>& coeffs = u.x()->mutable_array();
+  for (std::size_t c = 0; c < cells.size(); ++c)
+  {
+    xtl::span<const std::int32_t> cell_dofs = dofmap_u->cell_dofs(c);
+    auto values = cell_data.links(c);
+    assert(values.size() == bs * cell_dofs.size());
+    for (std::size_t i = 0; i < cell_dofs.size(); ++i)
+      for (int k = 0; k < bs; ++k)
+        coeffs[bs * cell_dofs[i] + k] = values[bs * i + k];
+  }
+}
+//----------------------------------------------------------------------------
 
 } // namespace dolfinx::fem
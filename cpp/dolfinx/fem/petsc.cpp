@@ -5,17 +5,74 @@
 // SPDX-License-Identifier:    LGPL-3.0-or-later
 
 #include "petsc.h"
+#include "MatrixFreeOperator.h"
 #include "assembler.h"
+#include "discreteoperators.h"
 #include "sparsitybuild.h"
 #include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/log.h>
 #include <dolfinx/fem/FunctionSpace.h>
 #include <dolfinx/la/PETScMatrix.h>
 #include <dolfinx/la/PETScVector.h>
 #include <dolfinx/la/SparsityPattern.h>
+#include <dolfinx/la/Vector.h>
 #include <xtl/xspan.hpp>
 
 using namespace dolfinx;
 
+namespace
+{
+// Context for a matrix-free shell matrix
+struct MatrixFreeContext
+{
+  std::shared_ptr<fem::MatrixFreeOperator<PetscScalar>> A;
+  la::Vector<PetscScalar> x, y;
+};
+//-----------------------------------------------------------------------------
+PetscErrorCode mat_free_mult(Mat A, Vec x, Vec y)
+{
+  MatrixFreeContext* ctx = nullptr;
+  MatShellGetContext(A, &ctx);
+  assert(ctx);
+
+  // Copy owned entries of x into the ghosted work vector
+  const PetscScalar* _x = nullptr;
+  VecGetArrayRead(x, &_x);
+  std::vector<PetscScalar>& x_array = ctx->x.mutable_array();
+  const std::int32_t n1 = ctx->x.bs() * ctx->x.map()->size_local();
+  std::copy_n(_x, n1, x_array.begin());
+  VecRestoreArrayRead(x, &_x);
+
+  try
+  {
+    ctx->A->apply(ctx->x, ctx->y);
+  }
+  catch (const std::exception& e)
+  {
+    LOG(ERROR) << "Matrix-free operator action failed: " << e.what();
+    return PETSC_ERR_LIB;
+  }
+
+  // Copy owned entries of the result
+  PetscScalar* _y = nullptr;
+  VecGetArray(y, &_y);
+  const std::int32_t n0 = ctx->y.bs() * ctx->y.map()->size_local();
+  std::copy_n(ctx->y.array().begin(), n0, _y);
+  VecRestoreArray(y, &_y);
+
+  return 0;
+}
+//-----------------------------------------------------------------------------
+PetscErrorCode mat_free_destroy(Mat A)
+{
+  MatrixFreeContext* ctx = nullptr;
+  MatShellGetContext(A, &ctx);
+  delete ctx;
+  return 0;
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
 //-----------------------------------------------------------------------------
 Mat dolfinx::fem::create_matrix(const Form<PetscScalar>& a,
                                 const std::string& type)
@@ -77,7 +134,10 @@ Mat fem::create_matrix_block(
         if (form->num_integrals(IntegralType::interior_facet) > 0)
         {
           mesh->topology_mutable().create_entities(tdim - 1);
-          sparsitybuild::interior_facets(*sp, mesh->topology(), dofmaps);
+          mesh->topology_mutable().create_connectivity(tdim - 1, tdim);
+          sparsitybuild::cell_pairs(
+              *sp, mesh->topology(), dofmaps,
+              form->num_integrals(IntegralType::cell) == 0);
         }
         if (form->num_integrals(IntegralType::exterior_facet) > 0)
         {
@@ -104,13 +164,6 @@ Mat fem::create_matrix_block(
     }
   }
 
-  // FIXME: This is computed again inside the SparsityPattern
-  // constructor, but we also need to outside to build the PETSc
-  // local-to-global map. Compute outside and pass into SparsityPattern
-  // constructor.
-  auto [rank_offset, local_offset, ghosts, owner]
-      = common::stack_index_maps(maps[0]);
-
   // Create merged sparsity pattern
   std::vector<std::vector<const la::SparsityPattern*>> p(V[0].size());
   for (std::size_t row = 0; row < V[0].size(); ++row)
@@ -126,21 +179,14 @@ Mat fem::create_matrix_block(
   Mat A = la::create_petsc_matrix(mesh->mpi_comm(), pattern, type);
 
   // Create row and column local-to-global maps (field0, field1, field2,
-  // etc), i.e. ghosts of field0 appear before owned indices of field1
+  // etc), i.e. ghosts of field0 appear before owned indices of field1,
+  // from the stacked index maps of the sparsity pattern
   std::array<std::vector<PetscInt>, 2> _maps;
   for (int d = 0; d < 2; ++d)
   {
-    for (std::size_t f = 0; f < maps[d].size(); ++f)
-    {
-      const common::IndexMap& map = maps[d][f].first.get();
-      const int bs = maps[d][f].second;
-      const std::int32_t size_local = bs * map.size_local();
-      const std::vector global = map.global_indices();
-      for (std::int32_t i = 0; i < size_local; ++i)
-        _maps[d].push_back(i + rank_offset + local_offset[f]);
-      for (std::size_t i = size_local; i < bs * global.size(); ++i)
-        _maps[d].push_back(ghosts[f][i - size_local]);
-    }
+    const std::vector<std::int64_t> global
+        = common::stack_local_to_global(maps[d], *pattern.index_map(d));
+    _maps[d].assign(global.begin(), global.end());
   }
 
   // Create PETSc local-to-global map/index sets and attach to matrix
@@ -213,6 +259,57 @@ Mat fem::create_matrix_nest(
   return A;
 }
 //-----------------------------------------------------------------------------
+Mat fem::create_matrix_free(
+    std::shared_ptr<fem::MatrixFreeOperator<PetscScalar>> A)
+{
+  assert(A);
+  const std::array<std::shared_ptr<const common::IndexMap>, 2> maps
+      = A->index_maps();
+  const std::array<int, 2> bs = A->block_size();
+  auto ctx = new MatrixFreeContext{A, la::Vector<PetscScalar>(maps[1], bs[1]),
+                                   la::Vector<PetscScalar>(maps[0], bs[0])};
+
+  Mat B;
+  const MPI_Comm comm = A->form()->mesh()->mpi_comm();
+  PetscErrorCode ierr = MatCreateShell(
+      comm, bs[0] * maps[0]->size_local(), bs[1] * maps[1]->size_local(),
+      bs[0] * maps[0]->size_global(), bs[1] * maps[1]->size_global(), ctx,
+      &B);
+  if (ierr != 0)
+  {
+    delete ctx;
+    la::petsc_error(ierr, __FILE__, "MatCreateShell");
+  }
+  MatShellSetOperation(B, MATOP_MULT, (void (*)(void))mat_free_mult);
+  MatShellSetOperation(B, MATOP_DESTROY, (void (*)(void))mat_free_destroy);
+  MatSetUp(B);
+
+  return B;
+}
+//-----------------------------------------------------------------------------
+Mat fem::create_discrete_gradient(const fem::FunctionSpace& V0,
+                                  const fem::FunctionSpace& V1,
+                                  int num_threads)
+{
+  auto [values, cols, offsets]
+      = fem::discrete_gradient_csr<PetscScalar>(V0, V1, num_threads);
+
+  // PETSc copies the arrays, which must have type PetscInt
+  const std::vector<PetscInt> _offsets(offsets.begin(), offsets.end());
+  const std::vector<PetscInt> _cols(cols.begin(), cols.end());
+
+  Mat A;
+  assert(V0.mesh());
+  PetscErrorCode ierr = MatCreateMPIAIJWithArrays(
+      V0.mesh()->mpi_comm(), V0.dofmap()->index_map->size_local(),
+      V1.dofmap()->index_map->size_local(), PETSC_DETERMINE, PETSC_DETERMINE,
+      _offsets.data(), _cols.data(), values.data(), &A);
+  if (ierr != 0)
+    la::petsc_error(ierr, __FILE__, "MatCreateMPIAIJWithArrays");
+
+  return A;
+}
+//-----------------------------------------------------------------------------
 Vec fem::create_vector_block(
     const std::vector<
         std::pair<std::reference_wrapper<const common::IndexMap>, int>>& maps)
@@ -231,16 +328,7 @@ Vec fem::create_vector_block(
   for (auto& sub_owner : ghost_new_owners)
     ghost_owners.insert(ghost_owners.end(), sub_owner.begin(), sub_owner.end());
 
-  std::vector<int> dest_ranks;
-  for (auto& map : maps)
-  {
-    const auto [_, ranks] = dolfinx::MPI::neighbors(
-        map.first.get().comm(common::IndexMap::Direction::forward));
-    dest_ranks.insert(dest_ranks.end(), ranks.begin(), ranks.end());
-  }
-  std::sort(dest_ranks.begin(), dest_ranks.end());
-  dest_ranks.erase(std::unique(dest_ranks.begin(), dest_ranks.end()),
-                   dest_ranks.end());
+  const std::vector<int> dest_ranks = common::stack_dest_ranks(maps);
 
   // Create map for combined problem, and create vector
   common::IndexMap index_map(
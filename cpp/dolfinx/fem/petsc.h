@@ -26,10 +26,15 @@ class DirichletBC;
 template <typename T>
 class Form;
 class FunctionSpace;
+template <typename T>
+class MatrixFreeOperator;
 
 /// Create a matrix
 /// @param[in] a A bilinear form
-/// @param[in] type The PETSc matrix type to create
+/// @param[in] type The PETSc matrix type to create. If empty the PETSc
+/// default is used. If the test and trial spaces have the same block
+/// size, `"baij"` creates a block matrix with one column index per
+/// block, which the assemblers fill by block insertion.
 /// @return A sparse matrix with a layout and sparsity that matches the
 /// bilinear form. The caller is responsible for destroying the Mat
 /// object.
@@ -55,6 +60,29 @@ Mat create_matrix_nest(
     const std::vector<std::vector<const fem::Form<PetscScalar>*>>& a,
     const std::vector<std::vector<std::string>>& types);
 
+/// Create a PETSc shell matrix (MATSHELL) that applies a matrix-free
+/// operator. The returned matrix supports MatMult and can be used as
+/// the operator of a la::PETScKrylovSolver, e.g. via la::PETScOperator,
+/// or as the Jacobian of a nls::NewtonSolver.
+/// @param[in] A The matrix-free operator. It is held by the matrix.
+/// @return A shell matrix. The caller is responsible for destroying
+/// the Mat object.
+Mat create_matrix_free(std::shared_ptr<MatrixFreeOperator<PetscScalar>> A);
+
+/// Create the discrete gradient operator that takes a \f$w \in H^1\f$
+/// (P1, nodal Lagrange) to \f$v \in H(curl)\f$ (lowest order
+/// Nedelec), i.e. v = Aw. The matrix is created from the compressed
+/// sparse row arrays computed by fem::discrete_gradient_csr, without
+/// building a sparsity pattern.
+/// @param[in] V0 A H(curl) space
+/// @param[in] V1 A P1 Lagrange space
+/// @param[in] num_threads The number of threads used to compute the
+/// matrix entries
+/// @return The assembled matrix. The caller is responsible for
+/// destroying the Mat object.
+Mat create_discrete_gradient(const FunctionSpace& V0, const FunctionSpace& V1,
+                             int num_threads = 1);
+
 /// Initialise monolithic vector. Vector is not zeroed.
 ///
 /// The caller is responsible for destroying the Mat object
@@ -10,6 +10,8 @@
 #include <dolfinx/graph/AdjacencyList.h>
 #include <dolfinx/la/SparsityPattern.h>
 #include <dolfinx/mesh/Topology.h>
+#include <algorithm>
+#include <vector>
 
 using namespace dolfinx;
 using namespace dolfinx::fem;
@@ -76,6 +78,55 @@ void sparsitybuild::interior_facets(
   }
 }
 //-----------------------------------------------------------------------------
+void sparsitybuild::cell_pairs(
+    la::SparsityPattern& pattern, const mesh::Topology& topology,
+    const std::array<const std::reference_wrapper<const fem::DofMap>, 2>&
+        dofmaps,
+    bool diagonal)
+{
+  const int D = topology.dim();
+  if (!topology.connectivity(D - 1, 0))
+    throw std::runtime_error("Topology facets have not been created.");
+
+  auto connectivity = topology.connectivity(D - 1, D);
+  if (!connectivity)
+    throw std::runtime_error("Facet-cell connectivity has not been computed.");
+
+  // Pairs of cells that share an owned interior facet, ordered so that
+  // a pair that shares several facets appears once
+  auto map = topology.index_map(D - 1);
+  assert(map);
+  const std::int32_t num_facets = map->size_local();
+  std::vector<std::pair<std::int32_t, std::int32_t>> pairs;
+  for (int f = 0; f < num_facets; ++f)
+  {
+    if (auto cells = connectivity->links(f); cells.size() == 2)
+      pairs.emplace_back(std::minmax(cells[0], cells[1]));
+  }
+  std::sort(pairs.begin(), pairs.end());
+  pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+  const fem::DofMap& dofmap0 = dofmaps[0].get();
+  const fem::DofMap& dofmap1 = dofmaps[1].get();
+  for (auto [c0, c1] : pairs)
+  {
+    pattern.insert(dofmap0.cell_dofs(c0), dofmap1.cell_dofs(c1));
+    pattern.insert(dofmap0.cell_dofs(c1), dofmap1.cell_dofs(c0));
+  }
+
+  if (diagonal)
+  {
+    std::vector<std::int32_t> cells;
+    cells.reserve(2 * pairs.size());
+    for (auto [c0, c1] : pairs)
+      cells.insert(cells.end(), {c0, c1});
+    std::sort(cells.begin(), cells.end());
+    cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+    for (std::int32_t c : cells)
+      pattern.insert(dofmap0.cell_dofs(c), dofmap1.cell_dofs(c));
+  }
+}
+//-----------------------------------------------------------------------------
 void sparsitybuild::exterior_facets(
     la::SparsityPattern& pattern, const mesh::Topology& topology,
     const std::array<const std::reference_wrapper<const fem::DofMap>, 2>&
@@ -39,6 +39,28 @@ void interior_facets(
     const std::array<const std::reference_wrapper<const fem::DofMap>, 2>&
         dofmaps);
 
+/// Insert the entries that couple the pairs of cells that share an
+/// owned interior facet into a sparsity pattern. Each pair of
+/// neighbouring cells is inserted once, and only the blocks that
+/// couple the two cells are inserted, rather than the dofs of both
+/// cells for each facet as by sparsitybuild::interior_facets. The
+/// assembled pattern is the same as for sparsitybuild::interior_facets
+/// if @p diagonal is true, or for sparsitybuild::interior_facets and
+/// sparsitybuild::cells if the cells are inserted separately.
+/// @param[in,out] pattern The sparsity pattern
+/// @param[in] topology The mesh topology, with the facet-to-cell
+/// connectivity
+/// @param[in] dofmaps The dofmaps of the rows and columns
+/// @param[in] diagonal If true, the blocks that couple the dofs of each
+/// cell with an owned interior facet to themselves are also inserted
+/// (once per cell). Set to false if sparsitybuild::cells is also called
+/// for the pattern, which inserts these blocks.
+void cell_pairs(
+    la::SparsityPattern& pattern, const mesh::Topology& topology,
+    const std::array<const std::reference_wrapper<const fem::DofMap>, 2>&
+        dofmaps,
+    bool diagonal);
+
 /// Iterate over exterior facets and insert entries into sparsity pattern
 void exterior_facets(
     la::SparsityPattern& pattern, const mesh::Topology& topology,
@@ -5,12 +5,14 @@
 // SPDX-License-Identifier:    LGPL-3.0-or-later
 
 #include "utils.h"
+#include <algorithm>
 #include <array>
 #include <basix/finite-element.h>
 #include <dolfinx/common/IndexMap.h>
 #include <dolfinx/common/Timer.h>
 #include <dolfinx/common/log.h>
 #include <dolfinx/common/types.h>
+#include <dolfinx/common/utils.h>
 #include <dolfinx/fem/Constant.h>
 #include <dolfinx/fem/DofMap.h>
 #include <dolfinx/fem/FiniteElement.h>
@@ -19,6 +21,7 @@
 #include <dolfinx/fem/FunctionSpace.h>
 #include <dolfinx/fem/dofmapbuilder.h>
 #include <dolfinx/fem/sparsitybuild.h>
+#include <dolfinx/graph/colouring.h>
 #include <dolfinx/la/SparsityPattern.h>
 #include <dolfinx/mesh/Mesh.h>
 #include <dolfinx/mesh/Topology.h>
@@ -49,27 +52,91 @@ la::SparsityPattern fem::create_sparsity_pattern(
   la::SparsityPattern pattern(
       dofmaps[0].get().index_map->comm(common::IndexMap::Direction::forward),
       index_maps, bs);
-  for (auto type : integrals)
+  // The interior facet entries are inserted once for each pair of
+  // neighbouring cells, without the blocks of the cells if these are
+  // inserted for the cell integrals
+  const bool has_cells
+      = integrals.find(fem::IntegralType::cell) != integrals.end();
+  auto insert = [&]()
   {
-    if (type == fem::IntegralType::cell)
+    for (auto type : integrals)
     {
-      sparsitybuild::cells(pattern, topology, {{dofmaps[0], dofmaps[1]}});
+      if (type == fem::IntegralType::cell)
+      {
+        sparsitybuild::cells(pattern, topology, {{dofmaps[0], dofmaps[1]}});
+      }
+      else if (type == fem::IntegralType::interior_facet)
+      {
+        sparsitybuild::cell_pairs(pattern, topology,
+                                  {{dofmaps[0], dofmaps[1]}}, !has_cells);
+      }
+      else if (type == fem::IntegralType::exterior_facet)
+      {
+        sparsitybuild::exterior_facets(pattern, topology,
+                                       {{dofmaps[0], dofmaps[1]}});
+      }
     }
-    else if (type == fem::IntegralType::interior_facet)
+  };
+
+  // Count the entries of each row in a first pass, and insert into
+  // preallocated storage in the second pass
+  pattern.count_begin();
+  insert();
+  pattern.count_end();
+  insert();
+
+  t0.stop();
+
+  return pattern;
+}
+//-----------------------------------------------------------------------------
+graph::AdjacencyList<std::int32_t>
+fem::compute_colouring(const mesh::Topology& topology,
+                       const graph::AdjacencyList<std::int32_t>& dofmap,
+                       IntegralType type,
+                       const xtl::span<const std::int32_t>& entities)
+{
+  // Build graph from each entity to the dofs of the attached cell(s)
+  std::vector<std::int32_t> data, offsets(1, 0);
+  offsets.reserve(entities.size() + 1);
+  const int tdim = topology.dim();
+  std::shared_ptr<const graph::AdjacencyList<std::int32_t>> f_to_c;
+  if (type == IntegralType::exterior_facet
+      or type == IntegralType::interior_facet)
+  {
+    f_to_c = topology.connectivity(tdim - 1, tdim);
+    if (!f_to_c)
+      throw std::runtime_error("Facet-to-cell connectivity is missing.");
+  }
+
+  for (std::int32_t e : entities)
+  {
+    if (type == IntegralType::cell)
     {
-      sparsitybuild::interior_facets(pattern, topology,
-                                     {{dofmaps[0], dofmaps[1]}});
+      auto dofs = dofmap.links(e);
+      data.insert(data.end(), dofs.begin(), dofs.end());
     }
-    else if (type == fem::IntegralType::exterior_facet)
+    else if (type == IntegralType::exterior_facet
+             or type == IntegralType::interior_facet)
     {
-      sparsitybuild::exterior_facets(pattern, topology,
-                                     {{dofmaps[0], dofmaps[1]}});
+      for (std::int32_t c : f_to_c->links(e))
+      {
+        auto dofs = dofmap.links(c);
+        data.insert(data.end(), dofs.begin(), dofs.end());
+      }
     }
+    else
+      throw std::runtime_error("Unsupported integral type for colouring.");
+    offsets.push_back(data.size());
   }
 
-  t0.stop();
-
-  return pattern;
+  // Colour graph and map graph nodes back to entity indices
+  graph::AdjacencyList<std::int32_t> colours = graph::compute_colouring(
+      graph::AdjacencyList<std::int32_t>(std::move(data), std::move(offsets)));
+  std::vector<std::int32_t>& nodes = colours.array();
+  std::transform(nodes.begin(), nodes.end(), nodes.begin(),
+                 [&entities](auto n) { return entities[n]; });
+  return colours;
 }
 //-----------------------------------------------------------------------------
 fem::ElementDofLayout
@@ -171,7 +238,8 @@ fem::create_dofmap(MPI_Comm comm, const ufc_dofmap& ufc_dofmap,
                    mesh::Topology& topology,
                    const std::function<std::vector<int>(
                        const graph::AdjacencyList<std::int32_t>&)>& reorder_fn,
-                   std::shared_ptr<const dolfinx::fem::FiniteElement> element)
+                   std::shared_ptr<const dolfinx::fem::FiniteElement> element,
+                   bool sort_ghosts, int num_threads)
 {
   auto element_dof_layout = std::make_shared<ElementDofLayout>(
       create_element_dof_layout(ufc_dofmap, topology.cell_type()));
@@ -185,7 +253,7 @@ fem::create_dofmap(MPI_Comm comm, const ufc_dofmap& ufc_dofmap,
     {
       // Create local entities
       const auto [cell_entity, entity_vertex, index_map]
-          = mesh::compute_entities(comm, topology, d);
+          = mesh::compute_entities(comm, topology, d, num_threads);
       if (cell_entity)
         topology.set_connectivity(cell_entity, topology.dim(), d);
       if (entity_vertex)
@@ -195,8 +263,9 @@ fem::create_dofmap(MPI_Comm comm, const ufc_dofmap& ufc_dofmap,
     }
   }
 
-  auto [index_map, bs, dofmap]
-      = fem::build_dofmap_data(comm, topology, *element_dof_layout, reorder_fn);
+  auto [index_map, bs, dofmap] = fem::build_dofmap_data(
+      comm, topology, *element_dof_layout, reorder_fn, sort_ghosts,
+      num_threads);
 
   // If the element's DOF transformations are permutations, permute the DOF
   // numbering on each cell
@@ -204,14 +273,20 @@ fem::create_dofmap(MPI_Comm comm, const ufc_dofmap& ufc_dofmap,
   {
     const int D = topology.dim();
     const int num_cells = topology.connectivity(D, 0)->num_nodes();
-    topology.create_entity_permutations();
+    topology.create_entity_permutations(num_threads);
     const std::vector<std::uint32_t>& cell_info
         = topology.get_cell_permutation_info();
 
     const std::function<void(const xtl::span<std::int32_t>&, std::uint32_t)>
         unpermute_dofs = element->get_dof_permutation_function(true, true);
-    for (std::int32_t cell = 0; cell < num_cells; ++cell)
-      unpermute_dofs(dofmap.links(cell), cell_info[cell]);
+    common::for_each_part(
+        num_cells, num_threads,
+        [&unpermute_dofs, &cell_info, &dofmap = dofmap](std::int64_t c0,
+                                                        std::int64_t c1, int)
+        {
+          for (std::int64_t cell = c0; cell < c1; ++cell)
+            unpermute_dofs(dofmap.links(cell), cell_info[cell]);
+        });
   }
 
   return DofMap(element_dof_layout, index_map, bs, std::move(dofmap), bs);
@@ -256,3 +331,59 @@ std::shared_ptr<fem::FunctionSpace> fem::create_functionspace(
   return V;
 }
 //-----------------------------------------------------------------------------
+std::array<std::vector<std::int32_t>, 2> fem::split_cells_by_ownership(
+    const xtl::span<const std::int32_t>& cells,
+    const std::vector<std::reference_wrapper<const DofMap>>& dofmaps)
+{
+  std::vector<std::int32_t> size_local;
+  for (const DofMap& dofmap : dofmaps)
+  {
+    assert(dofmap.index_map);
+    size_local.push_back(dofmap.index_map->size_local());
+  }
+
+  std::array<std::vector<std::int32_t>, 2> split;
+  for (std::int32_t c : cells)
+  {
+    bool owned = true;
+    for (std::size_t i = 0; i < dofmaps.size() and owned; ++i)
+    {
+      auto dofs = dofmaps[i].get().cell_dofs(c);
+      owned = std::all_of(dofs.begin(), dofs.end(),
+                          [n = size_local[i]](auto d) { return d < n; });
+    }
+    split[owned ? 0 : 1].push_back(c);
+  }
+
+  return split;
+}
+//-----------------------------------------------------------------------------
+std::array<std::vector<std::int32_t>, 2> fem::split_cells_by_bc(
+    const xtl::span<const std::int32_t>& cells,
+    const std::vector<std::reference_wrapper<const DofMap>>& dofmaps,
+    const std::vector<std::reference_wrapper<const std::vector<bool>>>& bcs)
+{
+  assert(dofmaps.size() == bcs.size());
+  std::array<std::vector<std::int32_t>, 2> split;
+  for (std::int32_t c : cells)
+  {
+    bool constrained = false;
+    for (std::size_t i = 0; i < dofmaps.size() and !constrained; ++i)
+    {
+      const std::vector<bool>& bc = bcs[i];
+      if (bc.empty())
+        continue;
+
+      const int bs = dofmaps[i].get().bs();
+      for (std::int32_t dof : dofmaps[i].get().cell_dofs(c))
+      {
+        for (int k = 0; k < bs; ++k)
+          constrained = constrained or bc[bs * dof + k];
+      }
+    }
+    split[constrained ? 1 : 0].push_back(c);
+  }
+
+  return split;
+}
+//-----------------------------------------------------------------------------
@@ -9,13 +9,19 @@
 #include "CoordinateElement.h"
 #include "DofMap.h"
 #include "ElementDofLayout.h"
+#include <algorithm>
+#include <array>
+#include <dolfinx/common/Table.h>
 #include <dolfinx/common/types.h>
+#include <dolfinx/common/utils.h>
 #include <dolfinx/fem/Form.h>
 #include <dolfinx/fem/Function.h>
 #include <dolfinx/la/SparsityPattern.h>
 #include <dolfinx/mesh/cell_types.h>
+#include <dolfinx/mesh/utils.h>
 #include <functional>
 #include <memory>
+#include <numeric>
 #include <set>
 #include <string>
 #include <ufc.h>
@@ -108,7 +114,8 @@ la::SparsityPattern create_sparsity_pattern(const Form<T>& a)
 
 /// Create a sparsity pattern for a given form. The pattern is not
 /// finalised, i.e. the caller is responsible for calling
-/// SparsityPattern::assemble.
+/// SparsityPattern::assemble. The pattern is built in two passes over
+/// the integration entities (see SparsityPattern::count_begin).
 la::SparsityPattern create_sparsity_pattern(
     const mesh::Topology& topology,
     const std::array<const std::reference_wrapper<const fem::DofMap>, 2>&
@@ -128,11 +135,16 @@ ElementDofLayout create_element_dof_layout(const ufc_dofmap& dofmap,
 /// @param[in] element The finite element
 /// @param[in] reorder_fn The graph reordering function called on the
 /// dofmap
+/// @param[in] sort_ghosts If true, the ghost dofs are numbered
+/// contiguously by owning rank, see fem::build_dofmap_data
+/// @param[in] num_threads The number of threads used to build the
+/// dofmap
 DofMap
 create_dofmap(MPI_Comm comm, const ufc_dofmap& dofmap, mesh::Topology& topology,
               const std::function<std::vector<int>(
                   const graph::AdjacencyList<std::int32_t>&)>& reorder_fn,
-              std::shared_ptr<const dolfinx::fem::FiniteElement> element);
+              std::shared_ptr<const dolfinx::fem::FiniteElement> element,
+              bool sort_ghosts = false, int num_threads = 1);
 
 /// Get the name of each coefficient in a UFC form
 /// @param[in] ufc_form The UFC form
@@ -372,21 +384,101 @@ std::shared_ptr<fem::FunctionSpace> create_functionspace(
         std::vector<int>(const graph::AdjacencyList<std::int32_t>&)>& reorder_fn
     = nullptr);
 
+/// Compute a colouring of the mesh entities of an integration domain
+/// such that no two entities with the same colour share a
+/// degree-of-freedom. Entities of the same colour can be assembled
+/// concurrently.
+/// @param[in] topology The mesh topology. For facet integrals the
+/// facet-to-cell connectivity must have been computed.
+/// @param[in] dofmap The (block) dofmap that defines sharing between
+/// entities, i.e. the dofmap of the test space
+/// @param[in] type The integral type
+/// @param[in] entities The entities of the integration domain (cells
+/// for cell integrals, facets for facet integrals)
+/// @return The entity indices for each colour, i.e. `colours.links(c)`
+/// are the entities with colour `c`
+graph::AdjacencyList<std::int32_t>
+compute_colouring(const mesh::Topology& topology,
+                  const graph::AdjacencyList<std::int32_t>& dofmap,
+                  IntegralType type,
+                  const xtl::span<const std::int32_t>& entities);
+
+/// Split cells into cells for which all degrees-of-freedom of the
+/// given dofmaps are owned by this process, and cells with at least
+/// one ghost degree-of-freedom. The order of the cells is preserved.
+/// @param[in] cells The cells to split
+/// @param[in] dofmaps The dofmaps
+/// @return The cells with only owned degrees-of-freedom (0) and the
+/// cells with ghost degrees-of-freedom (1)
+std::array<std::vector<std::int32_t>, 2> split_cells_by_ownership(
+    const xtl::span<const std::int32_t>& cells,
+    const std::vector<std::reference_wrapper<const DofMap>>& dofmaps);
+
+/// Split cells into cells with no constrained degrees-of-freedom and
+/// cells with at least one constrained degree-of-freedom. The order of
+/// the cells is preserved. Assembly over the first set can then skip
+/// the boundary condition checks, which typically applies to all but a
+/// thin layer of cells.
+/// @param[in] cells The cells to split
+/// @param[in] dofmaps The dofmaps
+/// @param[in] bcs Boundary condition markers for the (unrolled)
+/// degrees-of-freedom of each dofmap. An empty marker array indicates
+/// that the dofmap has no constrained degrees-of-freedom.
+/// @return The cells with no constrained degrees-of-freedom (0) and the
+/// cells with constrained degrees-of-freedom (1)
+std::array<std::vector<std::int32_t>, 2> split_cells_by_bc(
+    const xtl::span<const std::int32_t>& cells,
+    const std::vector<std::reference_wrapper<const DofMap>>& dofmaps,
+    const std::vector<std::reference_wrapper<const std::vector<bool>>>& bcs);
+
 namespace impl
 {
+/// Execute a function over the entities of each colour using threads.
+/// The colours are processed in turn, and the entities of a colour are
+/// split into (at most) `4 * num_threads` contiguous chunks that are
+/// passed concurrently to `fn`, with the chunks taken by the threads as
+/// they become idle.
+/// @param[in] colours The entities for each colour
+/// @param[in] num_threads The number of threads
+/// @param[in] fn The function to execute. It is called with a span of
+/// entities and must be safe to call concurrently for entities of the
+/// same colour.
+template <typename Fn>
+void parallel_for_colours(const graph::AdjacencyList<std::int32_t>& colours,
+                          int num_threads, const Fn& fn)
+{
+  assert(num_threads > 0);
+  for (std::int32_t c = 0; c < colours.num_nodes(); ++c)
+  {
+    xtl::span<const std::int32_t> entities = colours.links(c);
+    if (entities.empty())
+      continue;
+    const std::int64_t n = entities.size();
+    const std::int64_t num_chunks = std::min<std::int64_t>(n, 4 * num_threads);
+    common::for_each_task(num_chunks, num_threads,
+                          [&entities, &fn, n, num_chunks](std::int64_t k, int)
+                          {
+                            const std::int64_t c0 = (n * k) / num_chunks;
+                            const std::int64_t c1 = (n * (k + 1)) / num_chunks;
+                            fn(entities.subspan(c0, c1 - c0));
+                          });
+  }
+}
+
 // Pack a single coefficient
 template <typename T, int _bs = -1>
 void pack_coefficient(
     array2d<T>& c, const std::vector<T>& v,
     const xtl::span<const std::uint32_t>& cell_info, const fem::DofMap& dofmap,
-    std::int32_t num_cells, std::int32_t offset, int space_dim,
+    const xtl::span<const std::int32_t>& cells, std::int32_t offset,
+    int space_dim,
     const std::function<void(const xtl::span<T>&,
                              const xtl::span<const std::uint32_t>&,
                              std::int32_t, int)>& transform)
 {
   const int bs = dofmap.bs();
   assert(_bs < 0 or _bs == bs);
-  for (std::int32_t cell = 0; cell < num_cells; ++cell)
+  for (std::int32_t cell : cells)
   {
     auto dofs = dofmap.cell_dofs(cell);
     auto cell_coeff = c.row(cell).subspan(offset, space_dim);
@@ -412,28 +504,146 @@ void pack_coefficient(
 }
 } // namespace impl
 
-// NOTE: This is subject to change
-/// Pack coefficients of u of generic type U ready for assembly
+namespace impl
+{
+/// Pack the coefficients of u with the given indices into an existing
+/// array for a subset of cells. Columns of other coefficients and rows
+/// of other cells are not modified.
+/// @param[in] u The form or expression
+/// @param[in,out] c The packed coefficient array. It must have shape
+/// (num_cells, u.coefficient_offsets().back())
+/// @param[in] indices The indices of the coefficients to pack
+/// @param[in] cells The cells to pack the coefficients for
 template <typename U>
-array2d<typename U::scalar_type> pack_coefficients(const U& u)
+void pack_coefficients(const U& u, array2d<typename U::scalar_type>& c,
+                       const std::vector<int>& indices,
+                       const xtl::span<const std::int32_t>& cells)
 {
   using T = typename U::scalar_type;
+  if (indices.empty())
+    return;
 
-  // Get form coefficient offsets and dofmaps
+  // Get form coefficient offsets
   const std::vector<std::shared_ptr<const fem::Function<T>>> coefficients
       = u.coefficients();
   const std::vector<int> offsets = u.coefficient_offsets();
-  std::vector<const fem::DofMap*> dofmaps(coefficients.size());
-  std::vector<const fem::FiniteElement*> elements(coefficients.size());
-  std::vector<std::reference_wrapper<const std::vector<T>>> v;
-  v.reserve(coefficients.size());
-  for (std::size_t i = 0; i < coefficients.size(); ++i)
+
+  // Get mesh
+  std::shared_ptr<const mesh::Mesh> mesh = u.mesh();
+  assert(mesh);
+  [[maybe_unused]] auto cell_map
+      = mesh->topology().index_map(mesh->topology().dim());
+  assert(c.shape[0]
+         == (std::size_t)(cell_map->size_local() + cell_map->num_ghosts()));
+  assert(c.shape[1] == (std::size_t)offsets.back());
+
+  bool needs_dof_transformations = false;
+  for (int coeff : indices)
   {
-    elements[i] = coefficients[i]->function_space()->element().get();
-    dofmaps[i] = coefficients[i]->function_space()->dofmap().get();
-    v.push_back(coefficients[i]->x()->array());
+    const fem::FiniteElement& element
+        = *coefficients[coeff]->function_space()->element();
+    if (element.needs_dof_transformations())
+    {
+      needs_dof_transformations = true;
+      mesh->topology_mutable().create_entity_permutations();
+    }
   }
 
+  // Iterate over coefficients
+  xtl::span<const std::uint32_t> cell_info;
+  if (needs_dof_transformations)
+    cell_info = xtl::span(mesh->topology().get_cell_permutation_info());
+  for (int coeff : indices)
+  {
+    const fem::FiniteElement& element
+        = *coefficients[coeff]->function_space()->element();
+    const fem::DofMap& dofmap
+        = *coefficients[coeff]->function_space()->dofmap();
+    const std::vector<T>& v = coefficients[coeff]->x()->array();
+    const std::function<void(const xtl::span<T>&,
+                             const xtl::span<const std::uint32_t>&,
+                             std::int32_t, int)>
+        transformation
+        = element.get_dof_transformation_function<T>(false, true);
+    if (int bs = dofmap.bs(); bs == 1)
+    {
+      impl::pack_coefficient<T, 1>(c, v, cell_info, dofmap, cells,
+                                   offsets[coeff], element.space_dimension(),
+                                   transformation);
+    }
+    else if (bs == 2)
+    {
+      impl::pack_coefficient<T, 2>(c, v, cell_info, dofmap, cells,
+                                   offsets[coeff], element.space_dimension(),
+                                   transformation);
+    }
+    else if (bs == 3)
+    {
+      impl::pack_coefficient<T, 3>(c, v, cell_info, dofmap, cells,
+                                   offsets[coeff], element.space_dimension(),
+                                   transformation);
+    }
+    else
+    {
+      impl::pack_coefficient<T>(c, v, cell_info, dofmap, cells,
+                                offsets[coeff], element.space_dimension(),
+                                transformation);
+    }
+  }
+}
+
+/// Pack the coefficients of u with the given indices into an existing
+/// array for all cells. Columns of other coefficients are not modified.
+/// @param[in] u The form or expression
+/// @param[in,out] c The packed coefficient array. It must have shape
+/// (num_cells, u.coefficient_offsets().back())
+/// @param[in] indices The indices of the coefficients to pack
+template <typename U>
+void pack_coefficients(const U& u, array2d<typename U::scalar_type>& c,
+                       const std::vector<int>& indices)
+{
+  std::vector<std::int32_t> cells(c.shape[0]);
+  std::iota(cells.begin(), cells.end(), 0);
+  pack_coefficients(u, c, indices, cells);
+}
+} // namespace impl
+
+namespace impl
+{
+/// Return the cell permutation data required to assemble a form. The
+/// data is empty if it is not required.
+template <typename T>
+xtl::span<const std::uint32_t> get_cell_info(const Form<T>& form)
+{
+  std::shared_ptr<const mesh::Mesh> mesh = form.mesh();
+  assert(mesh);
+  bool needs_transformation_data = form.needs_facet_permutations();
+  for (auto& V : form.function_spaces())
+    needs_transformation_data |= V->element()->needs_dof_transformations();
+  if (needs_transformation_data)
+  {
+    mesh->topology_mutable().create_entity_permutations();
+    return xtl::span(mesh->topology().get_cell_permutation_info());
+  }
+  else
+    return xtl::span<const std::uint32_t>();
+}
+} // namespace impl
+
+// NOTE: This is subject to change
+/// Pack coefficients of u of generic type U ready for assembly
+/// @param[in] u The form or expression
+/// @param[in] width If greater than one, the row of each cell is
+/// padded to a multiple of @p width values and aligned, see
+/// array2d::padded, so that kernels may use aligned loads of the
+/// coefficients. The assemblers accept padded arrays.
+/// @return The coefficients of each cell (row)
+template <typename U>
+array2d<typename U::scalar_type> pack_coefficients(const U& u,
+                                                   std::size_t width = 1)
+{
+  using T = typename U::scalar_type;
+
   // Get mesh
   std::shared_ptr<const mesh::Mesh> mesh = u.mesh();
   assert(mesh);
@@ -443,56 +653,13 @@ array2d<typename U::scalar_type> pack_coefficients(const U& u)
         + mesh->topology().index_map(tdim)->num_ghosts();
 
   // Copy data into coefficient array
-  array2d<T> c(num_cells, offsets.back());
-  if (!coefficients.empty())
-  {
-    bool needs_dof_transformations = false;
-    for (std::size_t coeff = 0; coeff < dofmaps.size(); ++coeff)
-    {
-      if (elements[coeff]->needs_dof_transformations())
-      {
-        needs_dof_transformations = true;
-        mesh->topology_mutable().create_entity_permutations();
-      }
-    }
-
-    // Iterate over coefficients
-    xtl::span<const std::uint32_t> cell_info;
-    if (needs_dof_transformations)
-      cell_info = xtl::span(mesh->topology().get_cell_permutation_info());
-    for (std::size_t coeff = 0; coeff < dofmaps.size(); ++coeff)
-    {
-      const std::function<void(const xtl::span<T>&,
-                               const xtl::span<const std::uint32_t>&,
-                               std::int32_t, int)>
-          transformation
-          = elements[coeff]->get_dof_transformation_function<T>(false, true);
-      if (int bs = dofmaps[coeff]->bs(); bs == 1)
-      {
-        impl::pack_coefficient<T, 1>(
-            c, v[coeff], cell_info, *dofmaps[coeff], num_cells, offsets[coeff],
-            elements[coeff]->space_dimension(), transformation);
-      }
-      else if (bs == 2)
-      {
-        impl::pack_coefficient<T, 2>(
-            c, v[coeff], cell_info, *dofmaps[coeff], num_cells, offsets[coeff],
-            elements[coeff]->space_dimension(), transformation);
-      }
-      else if (bs == 3)
-      {
-        impl::pack_coefficient<T, 3>(
-            c, v[coeff], cell_info, *dofmaps[coeff], num_cells, offsets[coeff],
-            elements[coeff]->space_dimension(), transformation);
-      }
-      else
-      {
-        impl::pack_coefficient<T>(
-            c, v[coeff], cell_info, *dofmaps[coeff], num_cells, offsets[coeff],
-            elements[coeff]->space_dimension(), transformation);
-      }
-    }
-  }
+  const std::array<std::size_t, 2> shape
+      = {std::size_t(num_cells), std::size_t(u.coefficient_offsets().back())};
+  array2d<T> c = width > 1 ? array2d<T>::padded(shape, width)
+                           : array2d<T>(shape);
+  std::vector<int> indices(u.coefficients().size());
+  std::iota(indices.begin(), indices.end(), 0);
+  impl::pack_coefficients(u, c, indices);
 
   return c;
 }
@@ -525,4 +692,78 @@ std::vector<typename U::scalar_type> pack_constants(const U& u)
   return constant_values;
 }
 
+/// Return a summary of the memory allocated on this rank by the data
+/// that a form is assembled with: the mesh (see mesh::memory_usage),
+/// the dofmaps and index maps of the function spaces of the arguments
+/// and coefficients, the coefficient vectors and the coefficients that
+/// are packed for each assembly (see fem::pack_coefficients). The
+/// values are in megabytes (column "MB"). Use Table::reduce for the
+/// min, max or average over the ranks.
+/// @param[in] form The form
+/// @return Table with the memory usage
+template <typename T>
+Table memory_usage(const Form<T>& form)
+{
+  std::shared_ptr<const mesh::Mesh> mesh = form.mesh();
+  assert(mesh);
+  Table table = mesh::memory_usage(*mesh);
+  double total = std::get<double>(table.get("Total", "MB"));
+  auto set = [&table, &total](std::string row, std::size_t bytes)
+  {
+    table.set(row, "MB", bytes / 1.0e6);
+    total += bytes / 1.0e6;
+  };
+
+  // Index maps that have been counted
+  const int tdim = mesh->topology().dim();
+  std::vector<const common::IndexMap*> maps;
+  for (int d = 0; d <= tdim; ++d)
+    maps.push_back(mesh->topology().index_map(d).get());
+  maps.push_back(mesh->geometry().index_map().get());
+
+  // Distinct function spaces of the arguments and coefficients
+  std::vector<const FunctionSpace*> spaces;
+  for (auto& V : form.function_spaces())
+    spaces.push_back(V.get());
+  for (auto& u : form.coefficients())
+    spaces.push_back(u->function_space().get());
+  for (std::size_t i = 0; i < spaces.size(); ++i)
+  {
+    if (std::find(spaces.begin(), std::next(spaces.begin(), i), spaces[i])
+        != std::next(spaces.begin(), i))
+    {
+      continue;
+    }
+
+    std::shared_ptr<const DofMap> dofmap = spaces[i]->dofmap();
+    const std::string name = "Function space " + std::to_string(i);
+    set(name + " dofmap", dofmap->memory_usage());
+    if (const common::IndexMap* map = dofmap->index_map.get();
+        std::find(maps.begin(), maps.end(), map) == maps.end())
+    {
+      maps.push_back(map);
+      set(name + " index map", map->memory_usage());
+    }
+  }
+
+  // Coefficient vectors, and the array of coefficients packed by cell
+  const std::vector<std::shared_ptr<const Function<T>>>& coefficients
+      = form.coefficients();
+  for (std::size_t i = 0; i < coefficients.size(); ++i)
+  {
+    set("Coefficient " + std::to_string(i) + " (" + coefficients[i]->name
+            + ")",
+        coefficients[i]->x()->memory_usage());
+  }
+  const std::int32_t num_cells
+      = mesh->topology().index_map(tdim)->size_local()
+        + mesh->topology().index_map(tdim)->num_ghosts();
+  set("Packed coefficients",
+      std::size_t(num_cells) * form.coefficient_offsets().back() * sizeof(T));
+
+  table.set("Total", "MB", total);
+  table.name = "Memory usage of form";
+  return table;
+}
+
 } // namespace dolfinx::fem
@@ -5,6 +5,7 @@
 // SPDX-License-Identifier:    LGPL-3.0-or-later
 
 #include "BoxMesh.h"
+#include "StructuredGrid.h"
 #include <cfloat>
 #include <cmath>
 #include <dolfinx/common/MPI.h>
@@ -209,3 +210,35 @@ mesh::Mesh BoxMesh::create(MPI_Comm comm,
   }
 }
 //-----------------------------------------------------------------------------
+generation::StructuredGrid
+BoxMesh::create_grid(MPI_Comm comm,
+                     const std::array<std::array<double, 3>, 2>& p,
+                     std::array<std::size_t, 3> n, mesh::CellType celltype)
+{
+  const std::vector<std::int64_t> num_cells(n.begin(), n.end());
+  switch (celltype)
+  {
+  case mesh::CellType::tetrahedron:
+    return StructuredGrid(comm, p, num_cells, celltype,
+                          {{0, 1, 3, 7},
+                           {0, 1, 7, 5},
+                           {0, 5, 7, 4},
+                           {0, 3, 2, 7},
+                           {0, 6, 4, 7},
+                           {0, 2, 6, 7}});
+  case mesh::CellType::hexahedron:
+    return StructuredGrid(comm, p, num_cells, celltype,
+                          {{0, 1, 2, 3, 4, 5, 6, 7}});
+  default:
+    throw std::runtime_error("Generate box mesh. Wrong cell type");
+  }
+}
+//-----------------------------------------------------------------------------
+mesh::Mesh BoxMesh::create_block(MPI_Comm comm,
+                                 const std::array<std::array<double, 3>, 2>& p,
+                                 std::array<std::size_t, 3> n,
+                                 mesh::CellType celltype)
+{
+  return create_grid(comm, p, n, celltype).create_mesh();
+}
+//-----------------------------------------------------------------------------
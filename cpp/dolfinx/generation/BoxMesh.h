@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include "StructuredGrid.h"
 #include <array>
 #include <cstddef>
 #include <dolfinx/graph/AdjacencyList.h>
@@ -45,4 +46,39 @@ create(MPI_Comm comm, const std::array<std::array<double, 3>, 2>& p,
        = static_cast<graph::AdjacencyList<std::int32_t> (*)(
            MPI_Comm, int, int, const graph::AdjacencyList<std::int64_t>&,
            mesh::GhostMode)>(&mesh::partition_cells_graph));
+
+/// Create the local part of a structured grid of the rectangular prism
+/// spanned by the two points @p p, with the cells of BoxMesh::create
+/// and the distribution of BoxMesh::create_block. The grid computes the
+/// cell vertices and the vertex coordinates on the fly, and a mesh of
+/// the grid is created by StructuredGrid::create_mesh.
+///
+/// @param[in] comm MPI communicator to build the grid on
+/// @param[in] p Points of box
+/// @param[in] n Number of cells in each direction
+/// @param[in] celltype Cell shape
+/// @return Structured grid
+StructuredGrid create_grid(MPI_Comm comm,
+                           const std::array<std::array<double, 3>, 2>& p,
+                           std::array<std::size_t, 3> n,
+                           mesh::CellType celltype);
+
+/// Create a uniform mesh::Mesh over the rectangular prism spanned by the
+/// two points @p p, which is distributed by a block decomposition of
+/// the grid over a Cartesian grid of processes. The partition, the
+/// ghost vertices, the IndexMaps and the connectivities are computed
+/// directly from the grid, without graph partitioning and
+/// redistribution of the cells, and the mesh has no ghost cells. The
+/// cells are the cells of BoxMesh::create.
+///
+/// @param[in] comm MPI communicator to build mesh on
+/// @param[in] p Points of box
+/// @param[in] n Number of cells in each direction. The number of
+/// processes along an axis, chosen by `MPI_Dims_create`, must not be
+/// larger than the number of cells.
+/// @param[in] celltype Cell shape
+/// @return Mesh
+mesh::Mesh create_block(MPI_Comm comm,
+                        const std::array<std::array<double, 3>, 2>& p,
+                        std::array<std::size_t, 3> n, mesh::CellType celltype);
 } // namespace dolfinx::generation::BoxMesh
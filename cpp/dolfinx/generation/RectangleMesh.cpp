@@ -5,6 +5,7 @@
 // SPDX-License-Identifier:    LGPL-3.0-or-later
 
 #include "RectangleMesh.h"
+#include "StructuredGrid.h"
 #include <cfloat>
 #include <cmath>
 #include <dolfinx/common/MPI.h>
@@ -303,3 +304,42 @@ mesh::Mesh RectangleMesh::create(MPI_Comm comm,
   }
 }
 //-----------------------------------------------------------------------------
+generation::StructuredGrid RectangleMesh::create_grid(
+    MPI_Comm comm, const std::array<std::array<double, 3>, 2>& p,
+    std::array<std::size_t, 2> n, mesh::CellType celltype,
+    const std::string& diagonal)
+{
+  const std::vector<std::int64_t> num_cells(n.begin(), n.end());
+  switch (celltype)
+  {
+  case mesh::CellType::triangle:
+    if (diagonal == "left")
+    {
+      return StructuredGrid(comm, p, num_cells, celltype,
+                            {{0, 1, 2}, {1, 2, 3}});
+    }
+    else if (diagonal == "right")
+    {
+      return StructuredGrid(comm, p, num_cells, celltype,
+                            {{0, 1, 3}, {0, 2, 3}});
+    }
+    else
+    {
+      throw std::runtime_error("Unknown diagonal string for block mesh: "
+                               + diagonal);
+    }
+  case mesh::CellType::quadrilateral:
+    return StructuredGrid(comm, p, num_cells, celltype, {{0, 1, 2, 3}});
+  default:
+    throw std::runtime_error("Generate rectangle mesh. Wrong cell type");
+  }
+}
+//-----------------------------------------------------------------------------
+mesh::Mesh RectangleMesh::create_block(
+    MPI_Comm comm, const std::array<std::array<double, 3>, 2>& p,
+    std::array<std::size_t, 2> n, mesh::CellType celltype,
+    const std::string& diagonal)
+{
+  return create_grid(comm, p, n, celltype, diagonal).create_mesh();
+}
+//-----------------------------------------------------------------------------
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include "StructuredGrid.h"
 #include <array>
 #include <dolfinx/common/MPI.h>
 #include <dolfinx/mesh/Mesh.h>
@@ -63,4 +64,42 @@ mesh::Mesh create(MPI_Comm comm, const std::array<std::array<double, 3>, 2>& p,
                   const mesh::GhostMode ghost_mode,
                   const mesh::CellPartitionFunction& partitioner,
                   const std::string& diagonal = "right");
+
+/// Create the local part of a structured grid of the rectangle spanned
+/// by the two points @p p, with the distribution of
+/// RectangleMesh::create_block. The grid computes the cell vertices and
+/// the vertex coordinates on the fly, and a mesh of the grid is created
+/// by StructuredGrid::create_mesh.
+///
+/// @param[in] comm MPI communicator to build the grid on
+/// @param[in] p Two corner points
+/// @param[in] n Number of cells in each direction
+/// @param[in] celltype Cell shape
+/// @param[in] diagonal Direction of diagonals: "left" or "right"
+/// @return Structured grid
+StructuredGrid create_grid(MPI_Comm comm,
+                           const std::array<std::array<double, 3>, 2>& p,
+                           std::array<std::size_t, 2> n,
+                           mesh::CellType celltype,
+                           const std::string& diagonal = "right");
+
+/// Create a uniform mesh::Mesh over the rectangle spanned by the two
+/// points @p p, which is distributed by a block decomposition of the
+/// grid over a Cartesian grid of processes. The partition, the ghost
+/// vertices, the IndexMaps and the connectivities are computed directly
+/// from the grid, without graph partitioning and redistribution of the
+/// cells, and the mesh has no ghost cells.
+///
+/// @param[in] comm MPI communicator to build the mesh on
+/// @param[in] p Two corner points
+/// @param[in] n Number of cells in each direction. The number of
+/// processes along an axis, chosen by `MPI_Dims_create`, must not be
+/// larger than the number of cells.
+/// @param[in] celltype Cell shape
+/// @param[in] diagonal Direction of diagonals: "left" or "right"
+/// @return Mesh
+mesh::Mesh create_block(MPI_Comm comm,
+                        const std::array<std::array<double, 3>, 2>& p,
+                        std::array<std::size_t, 2> n, mesh::CellType celltype,
+                        const std::string& diagonal = "right");
 } // namespace dolfinx::generation::RectangleMesh
@@ -0,0 +1,336 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "StructuredGrid.h"
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/Timer.h>
+#include <dolfinx/fem/CoordinateElement.h>
+#include <dolfinx/graph/AdjacencyList.h>
+#include <dolfinx/mesh/Geometry.h>
+#include <dolfinx/mesh/Topology.h>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
+#include <xtensor/xtensor.hpp>
+
+using namespace dolfinx;
+using namespace dolfinx::generation;
+
+//-----------------------------------------------------------------------------
+StructuredGrid::StructuredGrid(MPI_Comm comm,
+                               const std::array<std::array<double, 3>, 2>& p,
+                               const std::vector<std::int64_t>& n,
+                               mesh::CellType celltype,
+                               const std::vector<std::vector<int>>& cube_cells)
+    : _comm(comm), _cell_type(celltype), _dim(n.size()),
+      _cube_cells(cube_cells), _x0({0, 0, 0}), _h({0, 0, 0}), _n({0, 0, 0}),
+      _dims({1, 1, 1})
+{
+  if (_dim != 2 and _dim != 3)
+    throw std::runtime_error("Structured grid must have 2 or 3 axes");
+  if (_cube_cells.empty())
+    throw std::runtime_error("Structured grid has no cells in a cube");
+
+  // Bounds and spacing of the grid. The unused axes have no cubes and
+  // one process.
+  for (int i = 0; i < _dim; ++i)
+  {
+    if (n[i] < 1)
+      throw std::runtime_error("Mesh has non-positive number of cells");
+    _x0[i] = std::min(p[0][i], p[1][i]);
+    const double x1 = std::max(p[0][i], p[1][i]);
+    if (std::abs(x1 - _x0[i]) < 2.0 * DBL_EPSILON)
+      throw std::runtime_error("Mesh has zero width in some direction");
+    _h[i] = (x1 - _x0[i]) / static_cast<double>(n[i]);
+    _n[i] = n[i];
+  }
+
+  // Grid of processes. The largest number of processes is used along
+  // the axis with the most cubes.
+  const int mpi_size = dolfinx::MPI::size(comm);
+  std::vector<int> dims_sorted(_dim, 0);
+  MPI_Dims_create(mpi_size, _dim, dims_sorted.data());
+  std::vector<int> axes(_dim);
+  std::iota(axes.begin(), axes.end(), 0);
+  std::stable_sort(axes.begin(), axes.end(),
+                   [&n](auto a, auto b) { return n[a] > n[b]; });
+  for (int i = 0; i < _dim; ++i)
+  {
+    _dims[axes[i]] = dims_sorted[i];
+    if (_dims[axes[i]] > n[axes[i]])
+    {
+      throw std::runtime_error(
+          "Too many processes for a block decomposition of the mesh");
+    }
+  }
+
+  // Offset of the global indices of the owned vertices of each process
+  _offsets.resize(mpi_size + 1, 0);
+  for (int r = 0; r < mpi_size; ++r)
+  {
+    const std::array<int, 3> b = block(r);
+    std::int64_t num_owned = 1;
+    for (int i = 0; i < 3; ++i)
+    {
+      const std::array<std::int64_t, 2> vr = vertex_range(i, b[i]);
+      num_owned *= vr[1] - vr[0];
+    }
+    _offsets[r + 1] = _offsets[r] + num_owned;
+  }
+
+  // Cubes and owned vertices of this process, and the box of the
+  // vertices of the cubes. An unused axis has one layer of cubes,
+  // which is not crossed by the cells.
+  _block = block(dolfinx::MPI::rank(comm));
+  for (int i = 0; i < 3; ++i)
+  {
+    _cr[i] = dolfinx::MPI::local_range(_block[i], _n[i], _dims[i]);
+    _vr[i] = vertex_range(i, _block[i]);
+    _box[i] = _cr[i][1] - _cr[i][0] + 1;
+    _nc[i] = std::max<std::int64_t>(_box[i] - 1, 1);
+  }
+
+  // The ghosts are the vertices of the box that are not owned, in
+  // lexicographic order
+  for (std::int64_t k = 0; k < _box[2]; ++k)
+  {
+    for (std::int64_t j = 0; j < _box[1]; ++j)
+    {
+      for (std::int64_t i = 0; i < _box[0]; ++i)
+      {
+        if (_cr[0][0] + i >= _vr[0][1] or _cr[1][0] + j >= _vr[1][1]
+            or _cr[2][0] + k >= _vr[2][1])
+        {
+          _ghosts.push_back((k * _box[1] + j) * _box[0] + i);
+        }
+      }
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+mesh::CellType StructuredGrid::cell_type() const { return _cell_type; }
+//-----------------------------------------------------------------------------
+int StructuredGrid::dim() const { return _dim; }
+//-----------------------------------------------------------------------------
+std::int32_t StructuredGrid::num_cells() const
+{
+  return _nc[0] * _nc[1] * _nc[2] * _cube_cells.size();
+}
+//-----------------------------------------------------------------------------
+std::int32_t StructuredGrid::num_owned_vertices() const
+{
+  const int rank = block_rank(_block);
+  return _offsets[rank + 1] - _offsets[rank];
+}
+//-----------------------------------------------------------------------------
+std::int32_t StructuredGrid::num_vertices() const
+{
+  return num_owned_vertices() + _ghosts.size();
+}
+//-----------------------------------------------------------------------------
+std::int64_t StructuredGrid::num_vertices_global() const
+{
+  return _offsets.back();
+}
+//-----------------------------------------------------------------------------
+std::array<std::int64_t, 3> StructuredGrid::cube(std::int32_t c) const
+{
+  assert(c >= 0 and c < num_cells());
+  const std::int64_t q = c / _cube_cells.size();
+  return {_cr[0][0] + q % _nc[0], _cr[1][0] + (q / _nc[0]) % _nc[1],
+          _cr[2][0] + q / (_nc[0] * _nc[1])};
+}
+//-----------------------------------------------------------------------------
+void StructuredGrid::cell_vertices(
+    std::int32_t c, const xtl::span<std::int32_t>& vertices) const
+{
+  const std::array<std::int64_t, 3> q = cube(c);
+  const std::vector<int>& cell = _cube_cells[c % _cube_cells.size()];
+  assert(vertices.size() == cell.size());
+  for (std::size_t i = 0; i < cell.size(); ++i)
+  {
+    vertices[i] = local_vertex({q[0] + (cell[i] & 1),
+                                q[1] + ((cell[i] >> 1) & 1),
+                                q[2] + ((cell[i] >> 2) & 1)});
+  }
+}
+//-----------------------------------------------------------------------------
+int StructuredGrid::num_cell_vertices() const
+{
+  return _cube_cells.front().size();
+}
+//-----------------------------------------------------------------------------
+std::array<std::int64_t, 3> StructuredGrid::vertex(std::int32_t v) const
+{
+  const std::int32_t num_owned = num_owned_vertices();
+  assert(v >= 0 and v < num_vertices());
+  if (v < num_owned)
+  {
+    const std::int64_t m0 = _vr[0][1] - _vr[0][0];
+    const std::int64_t m1 = _vr[1][1] - _vr[1][0];
+    return {_vr[0][0] + v % m0, _vr[1][0] + (v / m0) % m1,
+            _vr[2][0] + v / (m0 * m1)};
+  }
+  else
+  {
+    const std::int64_t pos = _ghosts[v - num_owned];
+    return {_cr[0][0] + pos % _box[0], _cr[1][0] + (pos / _box[0]) % _box[1],
+            _cr[2][0] + pos / (_box[0] * _box[1])};
+  }
+}
+//-----------------------------------------------------------------------------
+std::int32_t
+StructuredGrid::local_vertex(const std::array<std::int64_t, 3>& v) const
+{
+  if (v[0] < _vr[0][1] and v[1] < _vr[1][1] and v[2] < _vr[2][1])
+  {
+    return ((v[2] - _vr[2][0]) * (_vr[1][1] - _vr[1][0]) + v[1] - _vr[1][0])
+               * (_vr[0][1] - _vr[0][0])
+           + v[0] - _vr[0][0];
+  }
+  else
+  {
+    const std::int64_t pos
+        = ((v[2] - _cr[2][0]) * _box[1] + v[1] - _cr[1][0]) * _box[0] + v[0]
+          - _cr[0][0];
+    auto it = std::lower_bound(_ghosts.begin(), _ghosts.end(), pos);
+    assert(it != _ghosts.end() and *it == pos);
+    return num_owned_vertices() + std::distance(_ghosts.begin(), it);
+  }
+}
+//-----------------------------------------------------------------------------
+std::array<double, 3> StructuredGrid::x(std::int32_t v) const
+{
+  const std::array<std::int64_t, 3> p = vertex(v);
+  return {_x0[0] + _h[0] * static_cast<double>(p[0]),
+          _x0[1] + _h[1] * static_cast<double>(p[1]),
+          _x0[2] + _h[2] * static_cast<double>(p[2])};
+}
+//-----------------------------------------------------------------------------
+std::pair<std::int64_t, int>
+StructuredGrid::global_vertex(const std::array<std::int64_t, 3>& v) const
+{
+  std::array<int, 3> b;
+  std::int64_t index = 0;
+  for (int i = 2; i >= 0; --i)
+  {
+    b[i] = v[i] == _n[i] ? _dims[i] - 1
+                         : dolfinx::MPI::index_owner(_dims[i], v[i], _n[i]);
+    const std::array<std::int64_t, 2> vr = vertex_range(i, b[i]);
+    index = index * (vr[1] - vr[0]) + v[i] - vr[0];
+  }
+  const int owner = block_rank(b);
+  return {_offsets[owner] + index, owner};
+}
+//-----------------------------------------------------------------------------
+std::int64_t
+StructuredGrid::lexicographic_index(const std::array<std::int64_t, 3>& v) const
+{
+  return (v[2] * (_n[1] + 1) + v[1]) * (_n[0] + 1) + v[0];
+}
+//-----------------------------------------------------------------------------
+mesh::Mesh StructuredGrid::create_mesh() const
+{
+  common::Timer timer("Build mesh of structured grid");
+
+  MPI_Comm comm = _comm.comm();
+  const int mpi_rank = dolfinx::MPI::rank(comm);
+  const std::int32_t num_owned = num_owned_vertices();
+  const std::int32_t num_local = num_vertices();
+
+  // Ghosts and their owners, coordinates and input global indices
+  std::vector<std::int64_t> ghosts(_ghosts.size());
+  std::vector<int> ghost_owners(_ghosts.size());
+  std::vector<std::int64_t> input_indices(num_local);
+  xt::xtensor<double, 2> x({std::size_t(num_local), std::size_t(_dim)});
+  for (std::int32_t v = 0; v < num_local; ++v)
+  {
+    const std::array<std::int64_t, 3> p = vertex(v);
+    if (v >= num_owned)
+    {
+      std::tie(ghosts[v - num_owned], ghost_owners[v - num_owned])
+          = global_vertex(p);
+    }
+    input_indices[v] = lexicographic_index(p);
+    for (int d = 0; d < _dim; ++d)
+      x(v, d) = _x0[d] + _h[d] * static_cast<double>(p[d]);
+  }
+
+  // The owned vertices are ghosted by the processes of the blocks
+  // below this block along some axes
+  std::vector<int> dest_ranks;
+  for (int k = std::max(_block[2] - 1, 0); k <= _block[2]; ++k)
+  {
+    for (int j = std::max(_block[1] - 1, 0); j <= _block[1]; ++j)
+    {
+      for (int i = std::max(_block[0] - 1, 0); i <= _block[0]; ++i)
+      {
+        if (int r = block_rank({i, j, k}); r != mpi_rank)
+          dest_ranks.push_back(r);
+      }
+    }
+  }
+  std::sort(dest_ranks.begin(), dest_ranks.end());
+
+  auto index_map_v = std::make_shared<common::IndexMap>(
+      comm, num_owned, dest_ranks, ghosts, ghost_owners);
+
+  // Cell-vertex connectivity
+  const std::int32_t num_cells = this->num_cells();
+  const int num_cell_vertices = this->num_cell_vertices();
+  std::vector<std::int32_t> cells(num_cells * num_cell_vertices);
+  for (std::int32_t c = 0; c < num_cells; ++c)
+  {
+    cell_vertices(c, xtl::span(cells.data() + c * num_cell_vertices,
+                               num_cell_vertices));
+  }
+  std::vector<std::int32_t> offsets(num_cells + 1);
+  for (std::int32_t c = 0; c <= num_cells; ++c)
+    offsets[c] = c * num_cell_vertices;
+  auto c_to_v = std::make_shared<graph::AdjacencyList<std::int32_t>>(
+      std::move(cells), std::move(offsets));
+
+  mesh::Topology topology(comm, _cell_type);
+  const int tdim = topology.dim();
+  topology.set_index_map(0, index_map_v);
+  topology.set_connectivity(
+      std::make_shared<graph::AdjacencyList<std::int32_t>>(num_local), 0, 0);
+  topology.set_index_map(tdim,
+                         std::make_shared<common::IndexMap>(comm, num_cells));
+  topology.set_connectivity(c_to_v, tdim, 0);
+
+  // The geometry dofmap is the cell-vertex connectivity, and the
+  // coordinates of the ghosts are known
+  mesh::Geometry geometry(index_map_v, c_to_v,
+                          fem::CoordinateElement(_cell_type, 1), std::move(x),
+                          std::move(input_indices));
+
+  return mesh::Mesh(comm, std::move(topology), std::move(geometry));
+}
+//-----------------------------------------------------------------------------
+std::array<std::int64_t, 2> StructuredGrid::vertex_range(int i, int b) const
+{
+  std::array r = dolfinx::MPI::local_range(b, _n[i], _dims[i]);
+  if (b == _dims[i] - 1)
+    ++r[1];
+  return r;
+}
+//-----------------------------------------------------------------------------
+std::array<int, 3> StructuredGrid::block(int r) const
+{
+  return {r % _dims[0], (r / _dims[0]) % _dims[1], r / (_dims[0] * _dims[1])};
+}
+//-----------------------------------------------------------------------------
+int StructuredGrid::block_rank(const std::array<int, 3>& b) const
+{
+  return (b[2] * _dims[1] + b[1]) * _dims[0] + b[0];
+}
+//-----------------------------------------------------------------------------
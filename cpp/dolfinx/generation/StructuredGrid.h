@@ -0,0 +1,175 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <dolfinx/common/MPI.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <dolfinx/mesh/cell_types.h>
+#include <utility>
+#include <vector>
+#include <xtl/xspan.hpp>
+
+namespace dolfinx::generation
+{
+
+/// The local part of a structured grid of `n[0] x n[1] (x n[2])` cubes
+/// that is distributed by a block decomposition, with an implicit
+/// topology and geometry.
+///
+/// The processes are arranged in a Cartesian grid (see
+/// `MPI_Dims_create`), and each process owns a block of cubes. A
+/// process owns the vertices of its block except the vertices on the
+/// upper boundaries of the block that are not on the boundary of the
+/// grid. The vertices of the cells, the vertex coordinates and the
+/// global indices and owners of the vertices are computed from the
+/// grid indices of the cubes and vertices when requested, and only the
+/// (boundary) ghost vertices are stored. No communication is needed to
+/// create the grid.
+///
+/// The local indices of the cells and vertices are the indices of the
+/// mesh created by StructuredGrid::create_mesh. The cells are ordered
+/// by cube, with the cubes in lexicographic order (first axis fastest),
+/// and the owned vertices are in lexicographic order, followed by the
+/// ghosts.
+class StructuredGrid
+{
+public:
+  /// Create the local part of a structured grid
+  /// @param[in] comm The MPI communicator
+  /// @param[in] p Two opposite corner points of the grid
+  /// @param[in] n The number of cubes along each axis (2 or 3 axes).
+  /// The number of processes along an axis must not be larger than the
+  /// number of cubes.
+  /// @param[in] celltype The cell type
+  /// @param[in] cube_cells The cells of a cube, as lists of the corners
+  /// of the cube. Corner k is at the offsets `k & 1`, `(k >> 1) & 1`
+  /// and `(k >> 2) & 1` along the axes.
+  StructuredGrid(MPI_Comm comm, const std::array<std::array<double, 3>, 2>& p,
+                 const std::vector<std::int64_t>& n, mesh::CellType celltype,
+                 const std::vector<std::vector<int>>& cube_cells);
+
+  /// Copy constructor
+  StructuredGrid(const StructuredGrid& grid) = default;
+
+  /// Move constructor
+  StructuredGrid(StructuredGrid&& grid) = default;
+
+  /// Destructor
+  ~StructuredGrid() = default;
+
+  /// Copy assignment
+  StructuredGrid& operator=(const StructuredGrid& grid) = delete;
+
+  /// Move assignment
+  StructuredGrid& operator=(StructuredGrid&& grid) = default;
+
+  /// Cell type
+  mesh::CellType cell_type() const;
+
+  /// Geometric dimension of the grid
+  int dim() const;
+
+  /// Number of local cells
+  std::int32_t num_cells() const;
+
+  /// Number of owned vertices
+  std::int32_t num_owned_vertices() const;
+
+  /// Number of local (owned and ghost) vertices
+  std::int32_t num_vertices() const;
+
+  /// Global number of vertices
+  std::int64_t num_vertices_global() const;
+
+  /// Get the grid indices of the cube of a cell
+  /// @param[in] c The local index of the cell
+  /// @return The grid indices of the lowest corner of the cube
+  std::array<std::int64_t, 3> cube(std::int32_t c) const;
+
+  /// Get the vertices of a cell
+  /// @param[in] c The local index of the cell
+  /// @param[out] vertices The local indices of the vertices of the cell
+  void cell_vertices(std::int32_t c,
+                     const xtl::span<std::int32_t>& vertices) const;
+
+  /// Number of vertices of a cell
+  int num_cell_vertices() const;
+
+  /// Get the grid indices of a vertex
+  /// @param[in] v The local index of the vertex
+  std::array<std::int64_t, 3> vertex(std::int32_t v) const;
+
+  /// Get the local index of a vertex of the cubes of this process
+  /// @param[in] v The grid indices of the vertex
+  /// @return The local index of the vertex
+  std::int32_t local_vertex(const std::array<std::int64_t, 3>& v) const;
+
+  /// Get the coordinates of a vertex
+  /// @param[in] v The local index of the vertex
+  std::array<double, 3> x(std::int32_t v) const;
+
+  /// Get the global index and the owner of a vertex of the grid
+  /// @param[in] v The grid indices of the vertex
+  /// @return The global index of the vertex and the rank of its owner
+  std::pair<std::int64_t, int>
+  global_vertex(const std::array<std::int64_t, 3>& v) const;
+
+  /// Get the lexicographic index of a vertex of the grid, with the
+  /// first axis fastest
+  /// @param[in] v The grid indices of the vertex
+  /// @return The index, which is the input global index of the vertex
+  /// in the mesh created by StructuredGrid::create_mesh
+  std::int64_t
+  lexicographic_index(const std::array<std::int64_t, 3>& v) const;
+
+  /// Create a mesh of the grid, with the IndexMaps and the cell-vertex
+  /// connectivity of the grid and no ghost cells
+  /// @note Collective
+  /// @return The mesh
+  mesh::Mesh create_mesh() const;
+
+private:
+  // Range of the vertices owned by a block along an axis
+  std::array<std::int64_t, 2> vertex_range(int i, int b) const;
+
+  // Position of a process in the process grid
+  std::array<int, 3> block(int r) const;
+
+  // Rank of the process at a position of the process grid
+  int block_rank(const std::array<int, 3>& b) const;
+
+  // Communicator
+  dolfinx::MPI::Comm _comm;
+
+  mesh::CellType _cell_type;
+  int _dim;
+  std::vector<std::vector<int>> _cube_cells;
+
+  // Lowest corner and spacing of the grid, and number of cubes along
+  // each axis (0 for an unused axis)
+  std::array<double, 3> _x0, _h;
+  std::array<std::int64_t, 3> _n;
+
+  // Number of processes along each axis, and position of this process
+  std::array<int, 3> _dims, _block;
+
+  // Offset of the global indices of the owned vertices of each process
+  std::vector<std::int64_t> _offsets;
+
+  // Ranges of the cubes and owned vertices of this process along each
+  // axis, the size of the box of the vertices of the cubes, and the
+  // number of cubes (1 along an unused axis)
+  std::array<std::array<std::int64_t, 2>, 3> _cr, _vr;
+  std::array<std::int64_t, 3> _box, _nc;
+
+  // Sorted positions in the box of the ghost vertices
+  std::vector<std::int64_t> _ghosts;
+};
+
+} // namespace dolfinx::generation
@@ -10,9 +10,12 @@
 #include <dolfinx/common/IndexMap.h>
 #include <dolfinx/common/MPI.h>
 #include <dolfinx/common/log.h>
+#include <dolfinx/common/utils.h>
 #include <dolfinx/mesh/Geometry.h>
 #include <dolfinx/mesh/Mesh.h>
 #include <dolfinx/mesh/utils.h>
+#include <cmath>
+#include <limits>
 
 using namespace dolfinx;
 using namespace dolfinx::geometry;
@@ -33,38 +36,54 @@ std::vector<std::int32_t> range(const mesh::Mesh& mesh, int tdim)
   return r;
 }
 //-----------------------------------------------------------------------------
-// Compute bounding box of mesh entity
-std::array<std::array<double, 3>, 2>
-compute_bbox_of_entity(const mesh::Mesh& mesh, int dim, std::int32_t index)
+// Compute the padded bounding boxes of mesh entities
+std::vector<std::pair<std::array<std::array<double, 3>, 2>, std::int32_t>>
+compute_leaf_bboxes(const mesh::Mesh& mesh, int dim,
+                    const xtl::span<const std::int32_t>& entities,
+                    double padding, int num_threads)
 {
-  // Get the geometrical indices for the mesh entity
-  const int tdim = mesh.topology().dim();
-  const xt::xtensor<double, 2>& xg = mesh.geometry().x();
+  std::vector<std::pair<std::array<std::array<double, 3>, 2>, std::int32_t>>
+      leaf_bboxes(entities.size());
+  if (entities.empty())
+    return leaf_bboxes;
 
+  // Get the geometrical indices of all entities at once
+  const int tdim = mesh.topology().dim();
   mesh.topology_mutable().create_connectivity(dim, tdim);
-
-  // FIXME: return of small dynamic array is expensive
-  const std::array<std::int32_t, 1> entity = {index};
   const xt::xtensor<std::int32_t, 2> vertex_indices
-      = mesh::entities_to_geometry(mesh, dim, entity, false);
-  auto entity_vertices = xt::row(vertex_indices, 0);
-
-  std::array<std::array<double, 3>, 2> b;
-  b[0] = {xg(entity_vertices[0], 0), xg(entity_vertices[0], 1),
-          xg(entity_vertices[0], 2)};
-  b[1] = b[0];
+      = mesh::entities_to_geometry(mesh, dim, entities, false);
+  const xt::xtensor<double, 2>& xg = mesh.geometry().x();
 
-  // Compute min and max over vertices
-  for (const int local_vertex : entity_vertices)
+  // Compute min and max over the vertices of each entity
+  auto compute = [&](std::int64_t e0, std::int64_t e1, int)
   {
-    for (int j = 0; j < 3; ++j)
+    for (std::int64_t e = e0; e < e1; ++e)
     {
-      b[0][j] = std::min(b[0][j], xg(local_vertex, j));
-      b[1][j] = std::max(b[1][j], xg(local_vertex, j));
+      std::array<std::array<double, 3>, 2>& b = leaf_bboxes[e].first;
+      const std::int32_t v0 = vertex_indices(e, 0);
+      b[0] = {xg(v0, 0), xg(v0, 1), xg(v0, 2)};
+      b[1] = b[0];
+      for (std::size_t i = 1; i < vertex_indices.shape(1); ++i)
+      {
+        const std::int32_t v = vertex_indices(e, i);
+        for (int j = 0; j < 3; ++j)
+        {
+          b[0][j] = std::min(b[0][j], xg(v, j));
+          b[1][j] = std::max(b[1][j], xg(v, j));
+        }
+      }
+
+      for (int j = 0; j < 3; ++j)
+      {
+        b[0][j] -= padding;
+        b[1][j] += padding;
+      }
+      leaf_bboxes[e].second = entities[e];
     }
-  }
+  };
+  common::for_each_part(entities.size(), num_threads, compute);
 
-  return b;
+  return leaf_bboxes;
 }
 //-----------------------------------------------------------------------------
 // Compute bounding box of bounding boxes
@@ -88,82 +107,266 @@ std::array<std::array<double, 3>, 2> compute_bbox_of_bboxes(
 
   return b;
 }
-//------------------------------------------------------------------------------
-int _build_from_leaf(
+//-----------------------------------------------------------------------------
+// Surface area of a bounding box, or its length if the box is flat in
+// more than one direction
+double bbox_area(const std::array<std::array<double, 3>, 2>& b, bool length)
+{
+  const double dx = b[1][0] - b[0][0];
+  const double dy = b[1][1] - b[0][1];
+  const double dz = b[1][2] - b[0][2];
+  return length ? dx + dy + dz : dx * dy + dy * dz + dz * dx;
+}
+//-----------------------------------------------------------------------------
+// Partition the leaves of a node with bounding box b between its two
+// children, and return the first leaf of the second child
+template <typename Iterator>
+Iterator split_leaves(Iterator begin, Iterator end,
+                      const std::array<std::array<double, 3>, 2>& b,
+                      geometry::BuildStrategy strategy)
+{
+  // Twice the midpoint of a box along an axis
+  auto midpoint = [](const auto& p, int axis)
+  { return p.first[0][axis] + p.first[1][axis]; };
+
+  if (strategy == geometry::BuildStrategy::sah)
+  {
+    // Compute the bounding box of the midpoints
+    std::array<std::array<double, 3>, 2> c;
+    c[0].fill(std::numeric_limits<double>::max());
+    c[1].fill(std::numeric_limits<double>::lowest());
+    for (auto it = begin; it != end; ++it)
+    {
+      for (int j = 0; j < 3; ++j)
+      {
+        c[0][j] = std::min(c[0][j], midpoint(*it, j));
+        c[1][j] = std::max(c[1][j], midpoint(*it, j));
+      }
+    }
+
+    // Bin the boxes by midpoint along each axis and compute the cost
+    // n_0 A_0 + n_1 A_1 of splitting at each bin boundary
+    constexpr int num_bins = 16;
+    const bool length = bbox_area(b, false) == 0.0;
+    double best_cost = std::numeric_limits<double>::max();
+    int best_axis = -1, best_bin = 0;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      const double width = c[1][axis] - c[0][axis];
+      if (width <= 0.0)
+        continue;
+
+      std::array<std::int64_t, num_bins> count{};
+      std::array<std::array<std::array<double, 3>, 2>, num_bins> bins;
+      for (auto& bin : bins)
+      {
+        bin[0].fill(std::numeric_limits<double>::max());
+        bin[1].fill(std::numeric_limits<double>::lowest());
+      }
+      for (auto it = begin; it != end; ++it)
+      {
+        const int k = std::min<int>(
+            num_bins * (midpoint(*it, axis) - c[0][axis]) / width,
+            num_bins - 1);
+        ++count[k];
+        for (int j = 0; j < 3; ++j)
+        {
+          bins[k][0][j] = std::min(bins[k][0][j], it->first[0][j]);
+          bins[k][1][j] = std::max(bins[k][1][j], it->first[1][j]);
+        }
+      }
+
+      // Sweep from the right to get the cost on the right of each
+      // boundary, then from the left
+      std::array<double, num_bins> right_cost{};
+      std::array<std::array<double, 3>, 2> acc = bins[num_bins - 1];
+      std::int64_t n = count[num_bins - 1];
+      for (int k = num_bins - 1; k > 0; --k)
+      {
+        for (int j = 0; j < 3; ++j)
+        {
+          acc[0][j] = std::min(acc[0][j], bins[k][0][j]);
+          acc[1][j] = std::max(acc[1][j], bins[k][1][j]);
+        }
+        n += k < num_bins - 1 ? count[k] : 0;
+        right_cost[k] = n > 0 ? n * bbox_area(acc, length) : 0.0;
+      }
+
+      acc = bins[0];
+      n = 0;
+      for (int k = 0; k < num_bins - 1; ++k)
+      {
+        for (int j = 0; j < 3; ++j)
+        {
+          acc[0][j] = std::min(acc[0][j], bins[k][0][j]);
+          acc[1][j] = std::max(acc[1][j], bins[k][1][j]);
+        }
+        n += count[k];
+        const double cost = (n > 0 ? n * bbox_area(acc, length) : 0.0)
+                            + right_cost[k + 1];
+        if (cost < best_cost)
+        {
+          best_cost = cost;
+          best_axis = axis;
+          best_bin = k + 1;
+        }
+      }
+    }
+
+    // The first and last bins along an axis with a positive width are
+    // not empty, so both children get at least one leaf
+    if (best_axis >= 0)
+    {
+      const double width = c[1][best_axis] - c[0][best_axis];
+      const double x0 = c[0][best_axis];
+      return std::partition(
+          begin, end,
+          [&](const auto& p)
+          {
+            const double x = midpoint(p, best_axis);
+            return std::min<int>(num_bins * (x - x0) / width, num_bins - 1)
+                   < best_bin;
+          });
+    }
+
+    // All midpoints coincide, so fall back to a median split
+  }
+
+  // Split at the median along the longest axis
+  std::array<double, 3> b_diff;
+  std::transform(b[1].begin(), b[1].end(), b[0].begin(), b_diff.begin(),
+                 std::minus<double>());
+  const int axis = std::distance(
+      b_diff.begin(), std::max_element(b_diff.begin(), b_diff.end()));
+  auto middle = std::next(begin, std::distance(begin, end) / 2);
+  std::nth_element(begin, middle, end,
+                   [&midpoint, axis](const auto& p0, const auto& p1) -> bool
+                   { return midpoint(p0, axis) < midpoint(p1, axis); });
+  return middle;
+}
+//-----------------------------------------------------------------------------
+// Build the tree for the leaves. A tree with n leaves has 2n - 1 nodes
+// and the nodes are stored in post-order, i.e. a node is stored after
+// both of its children and the root is stored last. The node i of the
+// tree is stored in bboxes[2 * i:2 * i + 2] and bbox_coordinates[6 * i:6
+// * i + 6], and has global index i + offset.
+void _build_from_leaf(
     xtl::span<std::pair<std::array<std::array<double, 3>, 2>, std::int32_t>>
         leaf_bboxes,
-    std::vector<std::array<int, 2>>& bboxes,
-    std::vector<double>& bbox_coordinates)
+    const xtl::span<std::int32_t>& bboxes,
+    const xtl::span<double>& bbox_coordinates, std::int32_t offset,
+    geometry::BuildStrategy strategy, int num_threads)
 {
+  const std::size_t root = 2 * leaf_bboxes.size() - 2;
+  assert(bboxes.size() == 2 * (root + 1));
+  assert(bbox_coordinates.size() == 6 * (root + 1));
   if (leaf_bboxes.size() == 1)
   {
-    // Reached leaf
-
-    // Get bounding box coordinates for leaf
+    // Reached leaf, store entity index and bounding box coordinates
     const std::int32_t entity_index = leaf_bboxes[0].second;
-    const std::array<double, 3> b0 = leaf_bboxes[0].first[0];
-    const std::array<double, 3> b1 = leaf_bboxes[0].first[1];
+    bboxes[0] = entity_index;
+    bboxes[1] = entity_index;
+    std::copy_n(leaf_bboxes[0].first[0].begin(), 3, bbox_coordinates.begin());
+    std::copy_n(leaf_bboxes[0].first[1].begin(), 3,
+                std::next(bbox_coordinates.begin(), 3));
+    return;
+  }
 
-    // Store bounding box data
-    bboxes.push_back({entity_index, entity_index});
-    bbox_coordinates.insert(bbox_coordinates.end(), b0.begin(), b0.end());
-    bbox_coordinates.insert(bbox_coordinates.end(), b1.begin(), b1.end());
-    return bboxes.size() - 1;
+  // Compute bounding box of all bounding boxes and split the leaves
+  const std::array<std::array<double, 3>, 2> b
+      = compute_bbox_of_bboxes(leaf_bboxes);
+  auto middle
+      = split_leaves(leaf_bboxes.begin(), leaf_bboxes.end(), b, strategy);
+
+  // The first child has 2m - 1 nodes, where m is its number of leaves
+  const std::size_t m = std::distance(leaf_bboxes.begin(), middle);
+  const std::size_t n0 = 2 * m - 1;
+  auto build0 = [&](int nt)
+  {
+    _build_from_leaf(xtl::span(leaf_bboxes.begin(), middle),
+                     bboxes.subspan(0, 2 * n0),
+                     bbox_coordinates.subspan(0, 6 * n0), offset, strategy,
+                     nt);
+  };
+  auto build1 = [&](int nt)
+  {
+    _build_from_leaf(xtl::span(middle, leaf_bboxes.end()),
+                     bboxes.subspan(2 * n0, 2 * (root - n0)),
+                     bbox_coordinates.subspan(6 * n0, 6 * (root - n0)),
+                     offset + n0, strategy, nt);
+  };
+
+  // Build the children on separate threads while threads are
+  // available, which writes to disjoint parts of the arrays
+  constexpr std::size_t min_parallel_size = 4096;
+  if (num_threads > 1 and leaf_bboxes.size() > min_parallel_size)
+  {
+    common::for_each_part(2, 2,
+                          [&](std::int64_t, std::int64_t, int t)
+                          {
+                            if (t == 0)
+                              build0(num_threads / 2);
+                            else
+                              build1(num_threads - num_threads / 2);
+                          });
   }
   else
   {
-    // Compute bounding box of all bounding boxes
-    std::array<std::array<double, 3>, 2> b
-        = compute_bbox_of_bboxes(leaf_bboxes);
-    std::array<double, 3> b0 = b[0];
-    std::array<double, 3> b1 = b[1];
-
-    // Sort bounding boxes along longest axis
-    std::array<double, 3> b_diff;
-    std::transform(b1.begin(), b1.end(), b0.begin(), b_diff.begin(),
-                   std::minus<double>());
-    const std::size_t axis = std::distance(
-        b_diff.begin(), std::max_element(b_diff.begin(), b_diff.end()));
-
-    auto middle = std::next(leaf_bboxes.begin(), leaf_bboxes.size() / 2);
-
-    std::nth_element(leaf_bboxes.begin(), middle, leaf_bboxes.end(),
-                     [axis](const auto& p0, const auto& p1) -> bool {
-                       const double x0 = p0.first[0][axis] + p0.first[1][axis];
-                       const double x1 = p1.first[0][axis] + p1.first[1][axis];
-                       return x0 < x1;
-                     });
-
-    // Split bounding boxes into two groups and call recursively
-    std::array bbox{_build_from_leaf(xtl::span(leaf_bboxes.begin(), middle),
-                                     bboxes, bbox_coordinates),
-                    _build_from_leaf(xtl::span(middle, leaf_bboxes.end()),
-                                     bboxes, bbox_coordinates)};
-
-    // Store bounding box data. Note that root box will be added last.
-    bboxes.push_back(bbox);
-    bbox_coordinates.insert(bbox_coordinates.end(), b0.begin(), b0.end());
-    bbox_coordinates.insert(bbox_coordinates.end(), b1.begin(), b1.end());
-    return bboxes.size() - 1;
+    build0(1);
+    build1(1);
   }
+
+  // Store bounding box data. Note that root box is stored last.
+  bboxes[2 * root] = offset + n0 - 1;
+  bboxes[2 * root + 1] = offset + root - 1;
+  std::copy_n(b[0].begin(), 3, std::next(bbox_coordinates.begin(), 6 * root));
+  std::copy_n(b[1].begin(), 3,
+              std::next(bbox_coordinates.begin(), 6 * root + 3));
 }
 //-----------------------------------------------------------------------------
 std::pair<std::vector<std::int32_t>, std::vector<double>> build_from_leaf(
     std::vector<std::pair<std::array<std::array<double, 3>, 2>, std::int32_t>>
-        leaf_bboxes)
+        leaf_bboxes,
+    geometry::BuildStrategy strategy = geometry::BuildStrategy::median,
+    int num_threads = 1)
 {
-  std::vector<std::array<std::int32_t, 2>> bboxes;
-  std::vector<double> bbox_coordinates;
-  _build_from_leaf(leaf_bboxes, bboxes, bbox_coordinates);
+  const std::size_t num_nodes = 2 * leaf_bboxes.size() - 1;
+  std::vector<std::int32_t> bbox_array(2 * num_nodes);
+  std::vector<double> bbox_coordinates(6 * num_nodes);
+  _build_from_leaf(leaf_bboxes, bbox_array, bbox_coordinates, 0, strategy,
+                   num_threads);
+  return {std::move(bbox_array), std::move(bbox_coordinates)};
+}
+//-----------------------------------------------------------------------------
+// Compute the sum of the areas of the non-leaf nodes of a tree relative
+// to the area of the root (see bbox_area)
+double tree_cost(const std::vector<std::int32_t>& bboxes,
+                 const std::vector<double>& bbox_coordinates)
+{
+  if (bboxes.empty())
+    return 0.0;
 
-  std::vector<std::int32_t> bbox_array(2 * bboxes.size());
-  for (std::size_t i = 0; i < bboxes.size(); ++i)
+  auto get_bbox = [&bbox_coordinates](std::size_t node)
   {
-    bbox_array[2 * i] = bboxes[i][0];
-    bbox_array[2 * i + 1] = bboxes[i][1];
-  }
-
-  return {std::move(bbox_array), std::move(bbox_coordinates)};
+    std::array<std::array<double, 3>, 2> b;
+    std::copy_n(std::next(bbox_coordinates.begin(), 6 * node), 3,
+                b[0].begin());
+    std::copy_n(std::next(bbox_coordinates.begin(), 6 * node + 3), 3,
+                b[1].begin());
+    return b;
+  };
+
+  const std::size_t root = bboxes.size() / 2 - 1;
+  const bool length = bbox_area(get_bbox(root), false) == 0.0;
+  const double root_area = bbox_area(get_bbox(root), length);
+  if (root_area == 0.0)
+    return 0.0;
+
+  double cost = 0.0;
+  for (std::size_t i = 0; i <= root; ++i)
+    if (bboxes[2 * i] != bboxes[2 * i + 1])
+      cost += bbox_area(get_bbox(i), length);
+  return cost / root_area;
 }
 //-----------------------------------------------------------------------------
 int _build_from_point(
@@ -222,16 +425,20 @@ int _build_from_point(
 
 //-----------------------------------------------------------------------------
 BoundingBoxTree::BoundingBoxTree(const mesh::Mesh& mesh, int tdim,
-                                 double padding)
-    : BoundingBoxTree::BoundingBoxTree(mesh, tdim, range(mesh, tdim), padding)
+                                 double padding, BuildStrategy strategy,
+                                 int num_threads)
+    : BoundingBoxTree::BoundingBoxTree(mesh, tdim, range(mesh, tdim), padding,
+                                       strategy, num_threads)
 {
   // Do nothing
 }
 //-----------------------------------------------------------------------------
 BoundingBoxTree::BoundingBoxTree(const mesh::Mesh& mesh, int tdim,
                                  const xtl::span<const std::int32_t>& entities,
-                                 double padding)
-    : _tdim(tdim)
+                                 double padding, BuildStrategy strategy,
+                                 int num_threads)
+    : _tdim(tdim), _mesh_entities(true), _padding(padding),
+      _strategy(strategy)
 {
   if (tdim < 0 or tdim > mesh.topology().dim())
   {
@@ -244,22 +451,17 @@ BoundingBoxTree::BoundingBoxTree(const mesh::Mesh& mesh, int tdim,
 
   // Create bounding boxes for all mesh entities (leaves)
   std::vector<std::pair<std::array<std::array<double, 3>, 2>, std::int32_t>>
-      leaf_bboxes;
-  leaf_bboxes.reserve(entities.size());
-  for (std::int32_t e : entities)
-  {
-    std::array<std::array<double, 3>, 2> b
-        = compute_bbox_of_entity(mesh, tdim, e);
-    std::for_each(b[0].begin(), b[0].end(),
-                  [padding](double& x) { x -= padding; });
-    std::for_each(b[1].begin(), b[1].end(),
-                  [padding](double& x) { x += padding; });
-    leaf_bboxes.emplace_back(b, e);
-  }
+      leaf_bboxes
+      = compute_leaf_bboxes(mesh, tdim, entities, padding, num_threads);
 
   // Recursively build the bounding box tree from the leaves
   if (!leaf_bboxes.empty())
-    std::tie(_bboxes, _bbox_coordinates) = build_from_leaf(leaf_bboxes);
+  {
+    std::tie(_bboxes, _bbox_coordinates)
+        = build_from_leaf(std::move(leaf_bboxes), strategy, num_threads);
+  }
+  _cost = tree_cost(_bboxes, _bbox_coordinates);
+  create_nodes();
 
   LOG(INFO) << "Computed bounding box tree with " << num_bboxes()
             << " nodes for " << entities.size() << " entities.";
@@ -283,6 +485,7 @@ BoundingBoxTree::BoundingBoxTree(
       _bboxes[2 * i + 1] = bboxes[i][1];
     }
   }
+  create_nodes();
 
   LOG(INFO) << "Computed bounding box tree with " << num_bboxes()
             << " nodes for " << num_leaves << " points.";
@@ -292,7 +495,71 @@ BoundingBoxTree::BoundingBoxTree(std::vector<std::int32_t>&& bboxes,
                                  std::vector<double>&& bbox_coords)
     : _tdim(0), _bboxes(bboxes), _bbox_coordinates(bbox_coords)
 {
-  // Do nothing
+  create_nodes();
+}
+//-----------------------------------------------------------------------------
+bool BoundingBoxTree::refit(const mesh::Mesh& mesh, double max_cost_ratio,
+                            int num_threads)
+{
+  if (!_mesh_entities)
+  {
+    throw std::runtime_error(
+        "Only trees built for mesh entities can be refitted.");
+  }
+
+  // Get the leaf nodes and their entities
+  std::vector<std::int32_t> leaves, entities;
+  for (std::int32_t i = 0; i < num_bboxes(); ++i)
+  {
+    if (_bboxes[2 * i] == _bboxes[2 * i + 1])
+    {
+      leaves.push_back(i);
+      entities.push_back(_bboxes[2 * i]);
+    }
+  }
+
+  // Recompute the leaf bounding boxes
+  const std::vector<
+      std::pair<std::array<std::array<double, 3>, 2>, std::int32_t>>
+      leaf_bboxes
+      = compute_leaf_bboxes(mesh, _tdim, entities, _padding, num_threads);
+  for (std::size_t k = 0; k < leaves.size(); ++k)
+  {
+    auto b = std::next(_bbox_coordinates.begin(), 6 * leaves[k]);
+    std::copy_n(leaf_bboxes[k].first[0].begin(), 3, b);
+    std::copy_n(leaf_bboxes[k].first[1].begin(), 3, std::next(b, 3));
+  }
+
+  // Compute the bounding box of each non-leaf node from its children.
+  // A node is stored after its children, so one pass is sufficient.
+  for (std::int32_t i = 0; i < num_bboxes(); ++i)
+  {
+    if (const std::int32_t c0 = _bboxes[2 * i], c1 = _bboxes[2 * i + 1];
+        c0 != c1)
+    {
+      for (int j = 0; j < 3; ++j)
+      {
+        _bbox_coordinates[6 * i + j] = std::min(
+            _bbox_coordinates[6 * c0 + j], _bbox_coordinates[6 * c1 + j]);
+        _bbox_coordinates[6 * i + 3 + j]
+            = std::max(_bbox_coordinates[6 * c0 + 3 + j],
+                       _bbox_coordinates[6 * c1 + 3 + j]);
+      }
+    }
+  }
+
+  // Rebuild the tree if its quality has decreased too much
+  if (max_cost_ratio > 0.0
+      and tree_cost(_bboxes, _bbox_coordinates) > max_cost_ratio * _cost)
+  {
+    LOG(INFO) << "Rebuilding bounding box tree after refit.";
+    *this = BoundingBoxTree(mesh, _tdim, entities, _padding, _strategy,
+                            num_threads);
+    return true;
+  }
+
+  create_nodes();
+  return false;
 }
 //-----------------------------------------------------------------------------
 BoundingBoxTree BoundingBoxTree::create_global_tree(const MPI_Comm& comm) const
@@ -375,3 +642,35 @@ BoundingBoxTree::get_bbox(std::size_t node) const
   return x;
 }
 //-----------------------------------------------------------------------------
+void BoundingBoxTree::create_nodes()
+{
+  static_assert(sizeof(Node) == 32, "Unexpected size of compact node");
+
+  // Round a coordinate down or up to single precision
+  auto lower = [](double x)
+  {
+    float y = x;
+    return y > x ? std::nextafter(y, -std::numeric_limits<float>::infinity())
+                 : y;
+  };
+  auto upper = [](double x)
+  {
+    float y = x;
+    return y < x ? std::nextafter(y, std::numeric_limits<float>::infinity())
+                 : y;
+  };
+
+  _nodes.resize(num_bboxes());
+  for (std::size_t i = 0; i < _nodes.size(); ++i)
+  {
+    Node& node = _nodes[i];
+    for (int j = 0; j < 3; ++j)
+    {
+      node.x0[j] = lower(_bbox_coordinates[6 * i + j]);
+      node.x1[j] = upper(_bbox_coordinates[6 * i + 3 + j]);
+    }
+    node.child0 = _bboxes[2 * i];
+    node.child1 = _bboxes[2 * i + 1];
+  }
+}
+//-----------------------------------------------------------------------------
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <array>
+#include <dolfinx/common/AlignedAllocator.h>
 #include <dolfinx/common/MPI.h>
 #include <vector>
 #include <xtl/xspan.hpp>
@@ -19,6 +20,19 @@ class Mesh;
 namespace dolfinx::geometry
 {
 
+/// Enum for the strategy used to split the leaves of a node of a
+/// BoundingBoxTree between its two children
+enum class BuildStrategy : int
+{
+  /// Split at the median of the bounding box midpoints along the
+  /// longest axis of the node, which gives a balanced tree
+  median,
+  /// Split at the plane (from a set of equally spaced candidate planes
+  /// along each axis) that minimises the surface area heuristic, which
+  /// gives fewer overlapping boxes for meshes with graded cells
+  sah
+};
+
 /// Axis-Aligned bounding box binary tree. It is used to find entities
 /// in a collection (often a mesh::Mesh).
 
@@ -26,6 +40,22 @@ class BoundingBoxTree
 {
 
 public:
+  /// A node of the tree in a compact layout, with the bounding box in
+  /// single precision (rounded outwards so that it contains the bounding
+  /// box in double precision) next to the child nodes. A node has 32
+  /// bytes, so that a traversal step reads one cache line.
+  struct Node
+  {
+    /// Lower corner of the bounding box
+    std::array<float, 3> x0;
+    /// First child node, see bbox()
+    std::int32_t child0;
+    /// Upper corner of the bounding box
+    std::array<float, 3> x1;
+    /// Second child node, see bbox()
+    std::int32_t child1;
+  };
+
   /// Constructor
   /// @param[in] mesh The mesh for building the bounding box tree
   /// @param[in] tdim The topological dimension of the mesh entities to
@@ -34,9 +64,14 @@ public:
   /// compute the bounding box for (may be empty, if none).
   /// @param[in] padding A float perscribing how much the bounding box
   /// of each entity should be padded
+  /// @param[in] strategy The strategy for splitting the nodes
+  /// @param[in] num_threads The number of threads used to compute the
+  /// leaf bounding boxes and to build the subtrees
   BoundingBoxTree(const mesh::Mesh& mesh, int tdim,
                   const xtl::span<const std::int32_t>& entities,
-                  double padding = 0);
+                  double padding = 0,
+                  BuildStrategy strategy = BuildStrategy::median,
+                  int num_threads = 1);
 
   /// Constructor
   /// @param[in] mesh The mesh for building the bounding box tree
@@ -44,7 +79,12 @@ public:
   /// build the bounding box tree for
   /// @param[in] padding A float perscribing how much the bounding box
   /// of each entity should be padded
-  BoundingBoxTree(const mesh::Mesh& mesh, int tdim, double padding = 0);
+  /// @param[in] strategy The strategy for splitting the nodes
+  /// @param[in] num_threads The number of threads used to compute the
+  /// leaf bounding boxes and to build the subtrees
+  BoundingBoxTree(const mesh::Mesh& mesh, int tdim, double padding = 0,
+                  BuildStrategy strategy = BuildStrategy::median,
+                  int num_threads = 1);
 
   /// Constructor @param[in] points Cloud of points, with associated
   /// point identifier index, to build the bounding box tree around
@@ -72,6 +112,24 @@ public:
   /// the upper corner
   std::array<std::array<double, 3>, 2> get_bbox(std::size_t node) const;
 
+  /// Recompute the bounding boxes of the nodes from the current
+  /// geometry of the mesh, e.g. after the mesh has moved, without
+  /// changing the tree structure. The quality of the tree decreases if
+  /// the entities move relative to each other, so the tree can instead
+  /// be rebuilt from the entities when its quality becomes too low.
+  ///
+  /// @note The tree must have been built for entities of @p mesh
+  /// @param[in] mesh The mesh that the tree was built for
+  /// @param[in] max_cost_ratio If positive, the tree is rebuilt if the
+  /// sum of the surface areas of its nodes, relative to the area of the
+  /// root, exceeds the same measure when the tree was built times this
+  /// ratio
+  /// @param[in] num_threads The number of threads used to compute the
+  /// leaf bounding boxes
+  /// @return True if the tree was rebuilt
+  bool refit(const mesh::Mesh& mesh, double max_cost_ratio = -1,
+             int num_threads = 1);
+
   /// Compute a global bounding tree (collective on comm)
   /// This can be used to find which process a point might have a
   /// collision with.
@@ -101,6 +159,13 @@ public:
     return {_bboxes[2 * node], _bboxes[2 * node + 1]};
   }
 
+  /// The nodes of the tree in the compact layout, which has the same
+  /// node numbering as bbox() and get_bbox()
+  const std::vector<Node, common::AlignedAllocator<Node>>& nodes() const
+  {
+    return _nodes;
+  }
+
 private:
   // Constructor
   BoundingBoxTree(std::vector<std::int32_t>&& bboxes,
@@ -112,10 +177,26 @@ private:
   // Print out recursively, for debugging
   void tree_print(std::stringstream& s, int i) const;
 
+  // Create the compact nodes from _bboxes and _bbox_coordinates
+  void create_nodes();
+
   // List of bounding boxes (parent-child-entity relations)
   std::vector<std::int32_t> _bboxes;
 
   // List of bounding box coordinates
   std::vector<double> _bbox_coordinates;
+
+  // Nodes in compact layout
+  std::vector<Node, common::AlignedAllocator<Node>> _nodes;
+
+  // True if the leaves are mesh entities, and the padding and build
+  // strategy, which are used when the tree is refitted
+  bool _mesh_entities = false;
+  double _padding = 0;
+  BuildStrategy _strategy = BuildStrategy::median;
+
+  // Sum of the node surface areas relative to the area of the root when
+  // the tree was built
+  double _cost = 0;
 };
 } // namespace dolfinx::geometry
@@ -0,0 +1,218 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "PointOwnership.h"
+#include "BoundingBoxTree.h"
+#include "utils.h"
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/Timer.h>
+#include <dolfinx/common/log.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <dolfinx/mesh/Topology.h>
+#include <numeric>
+#include <set>
+
+using namespace dolfinx;
+using namespace dolfinx::geometry;
+
+namespace
+{
+//-----------------------------------------------------------------------------
+// Create a neighbourhood communicator
+MPI_Comm create_neighbor_comm(MPI_Comm comm, const std::vector<int>& sources,
+                              const std::vector<int>& destinations)
+{
+  MPI_Comm neighbor_comm;
+  MPI_Dist_graph_create_adjacent(comm, sources.size(), sources.data(),
+                                 MPI_UNWEIGHTED, destinations.size(),
+                                 destinations.data(), MPI_UNWEIGHTED,
+                                 MPI_INFO_NULL, false, &neighbor_comm);
+  return neighbor_comm;
+}
+//-----------------------------------------------------------------------------
+// Multiply offsets by a block size
+std::vector<std::int32_t> scale_offsets(const std::vector<std::int32_t>& x,
+                                        int bs)
+{
+  std::vector<std::int32_t> offsets(x.size());
+  std::transform(x.begin(), x.end(), offsets.begin(),
+                 [bs](std::int32_t offset) { return bs * offset; });
+  return offsets;
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
+//-----------------------------------------------------------------------------
+PointOwnership::PointOwnership(const mesh::Mesh& mesh,
+                               const xtl::span<const double>& points,
+                               int num_threads)
+    : _comm(MPI_COMM_NULL, false), _num_points(points.size() / 3),
+      _owners(_num_points, -1)
+{
+  common::Timer timer("Compute point ownership");
+  assert(points.size() % 3 == 0);
+  MPI_Comm comm = mesh.comm();
+  const int tdim = mesh.topology().dim();
+  auto cell_map = mesh.topology().index_map(tdim);
+  assert(cell_map);
+  const std::int32_t num_owned_cells = cell_map->size_local();
+
+  // Find the processes whose cells may collide with each point
+  const BoundingBoxTree tree(mesh, tdim, 0.0, BuildStrategy::median,
+                             num_threads);
+  const BoundingBoxTree global_tree = tree.create_global_tree(comm);
+  const graph::AdjacencyList<std::int32_t> candidates
+      = compute_collisions(global_tree, points, num_threads);
+
+  // Create the neighbourhoods of the processes that the caller sends
+  // points to and receives points from
+  std::vector<int> dest(candidates.array().begin(), candidates.array().end());
+  std::sort(dest.begin(), dest.end());
+  dest.erase(std::unique(dest.begin(), dest.end()), dest.end());
+  std::vector<int> src = dolfinx::MPI::compute_graph_edges(
+      comm, std::set<int>(dest.begin(), dest.end()));
+  std::sort(src.begin(), src.end());
+  const dolfinx::MPI::Comm comm_fwd(create_neighbor_comm(comm, src, dest),
+                                    false);
+  const dolfinx::MPI::Comm comm_rev(create_neighbor_comm(comm, dest, src),
+                                    false);
+
+  // Pack the points for each candidate process, ordered by neighbour
+  std::vector<std::int32_t> send_offsets(dest.size() + 1, 0);
+  for (std::int32_t r : candidates.array())
+  {
+    const int n = std::lower_bound(dest.begin(), dest.end(), r) - dest.begin();
+    ++send_offsets[n + 1];
+  }
+  std::partial_sum(send_offsets.begin(), send_offsets.end(),
+                   send_offsets.begin());
+  std::vector<std::int32_t> send_indices(send_offsets.back());
+  std::vector<double> send_points(3 * send_offsets.back());
+  {
+    std::vector<std::int32_t> pos(send_offsets.begin(),
+                                  std::prev(send_offsets.end()));
+    for (std::int32_t i = 0; i < candidates.num_nodes(); ++i)
+    {
+      for (std::int32_t r : candidates.links(i))
+      {
+        const int n
+            = std::lower_bound(dest.begin(), dest.end(), r) - dest.begin();
+        const std::int32_t k = pos[n]++;
+        send_indices[k] = i;
+        std::copy_n(std::next(points.begin(), 3 * i), 3,
+                    std::next(send_points.begin(), 3 * k));
+      }
+    }
+  }
+  const graph::AdjacencyList<double> recv_points
+      = dolfinx::MPI::neighbor_all_to_all(
+          comm_fwd.comm(),
+          graph::AdjacencyList<double>(std::move(send_points),
+                                       scale_offsets(send_offsets, 3)));
+
+  // Find an owned cell that collides with each received point
+  const graph::AdjacencyList<std::int32_t> colliding_cells
+      = compute_colliding_cells(mesh, tree, recv_points.array(), 0,
+                                num_threads);
+  std::vector<std::int32_t> recv_cells(colliding_cells.num_nodes(), -1);
+  for (std::int32_t i = 0; i < colliding_cells.num_nodes(); ++i)
+  {
+    for (std::int32_t c : colliding_cells.links(i))
+    {
+      if (c < num_owned_cells)
+      {
+        recv_cells[i] = c;
+        break;
+      }
+    }
+  }
+
+  // Return whether each point was found to the process that sent it,
+  // and take the process with the lowest rank that found a point as
+  // its owner
+  std::vector<std::int32_t> recv_offsets(recv_points.offsets().size());
+  std::transform(recv_points.offsets().begin(), recv_points.offsets().end(),
+                 recv_offsets.begin(),
+                 [](std::int32_t offset) { return offset / 3; });
+  std::vector<std::int8_t> found(recv_cells.size());
+  std::transform(recv_cells.begin(), recv_cells.end(), found.begin(),
+                 [](std::int32_t c) { return c >= 0; });
+  const graph::AdjacencyList<std::int8_t> sent_found
+      = dolfinx::MPI::neighbor_all_to_all(
+          comm_rev.comm(), graph::AdjacencyList<std::int8_t>(
+                               std::move(found), std::vector(recv_offsets)));
+  assert(sent_found.array().size() == send_indices.size());
+  for (std::size_t n = 0; n < dest.size(); ++n)
+  {
+    for (std::int32_t k = send_offsets[n]; k < send_offsets[n + 1]; ++k)
+    {
+      if (int& owner = _owners[send_indices[k]];
+          sent_found.array()[k] and owner < 0)
+      {
+        owner = dest[n];
+      }
+    }
+  }
+
+  // Tell each candidate process whether it owns the points that were
+  // sent to it
+  std::vector<std::int8_t> owned(send_indices.size());
+  for (std::size_t n = 0; n < dest.size(); ++n)
+    for (std::int32_t k = send_offsets[n]; k < send_offsets[n + 1]; ++k)
+      owned[k] = _owners[send_indices[k]] == dest[n];
+  const graph::AdjacencyList<std::int8_t> recv_owned
+      = dolfinx::MPI::neighbor_all_to_all(
+          comm_fwd.comm(), graph::AdjacencyList<std::int8_t>(
+                               std::move(owned), std::vector(send_offsets)));
+
+  // Store the owned points, ordered by the process that sent them, and
+  // the processes that the values at the owned points are sent to
+  std::vector<int> value_dest;
+  _send_offsets.push_back(0);
+  for (std::size_t n = 0; n < src.size(); ++n)
+  {
+    for (std::int32_t k = recv_offsets[n]; k < recv_offsets[n + 1]; ++k)
+    {
+      if (recv_owned.array()[k])
+      {
+        assert(recv_cells[k] >= 0);
+        _owned_cells.push_back(recv_cells[k]);
+        _owned_points.insert(_owned_points.end(),
+                             std::next(recv_points.array().begin(), 3 * k),
+                             std::next(recv_points.array().begin(), 3 * k + 3));
+      }
+    }
+
+    if (_owned_cells.size() > (std::size_t)_send_offsets.back())
+    {
+      value_dest.push_back(src[n]);
+      _send_offsets.push_back(_owned_cells.size());
+    }
+  }
+
+  // The values at the points of the caller are received from the
+  // owners, in the order that the points were sent to them
+  std::vector<int> value_src;
+  for (std::size_t n = 0; n < dest.size(); ++n)
+  {
+    const std::size_t num_positions = _recv_positions.size();
+    for (std::int32_t k = send_offsets[n]; k < send_offsets[n + 1]; ++k)
+    {
+      if (std::int32_t i = send_indices[k]; _owners[i] == dest[n])
+        _recv_positions.push_back(i);
+    }
+    if (_recv_positions.size() > num_positions)
+      value_src.push_back(dest[n]);
+  }
+
+  _comm = dolfinx::MPI::Comm(create_neighbor_comm(comm, value_src, value_dest),
+                             false);
+
+  LOG(INFO) << "Computed ownership of " << _num_points << " points, of which "
+            << _recv_positions.size() << " were found. Owning "
+            << _owned_cells.size() << " points.";
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,130 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <dolfinx/common/MPI.h>
+#include <dolfinx/graph/AdjacencyList.h>
+#include <vector>
+#include <xtl/xspan.hpp>
+
+namespace dolfinx::mesh
+{
+class Mesh;
+}
+
+namespace dolfinx::geometry
+{
+
+/// The owning process and cell of a set of points in a distributed
+/// mesh. Each point is owned by one process, which has an owned cell
+/// that collides with the point. If a point collides with owned cells
+/// of more than one process, the process with the lowest rank owns the
+/// point.
+///
+/// The ownership is computed once, and can then be used to send values
+/// computed by the owning processes (e.g. by Function::eval at the owned
+/// points) back to the processes that passed the points, using
+/// neighbourhood communication between these processes only.
+
+class PointOwnership
+{
+public:
+  /// Compute the ownership of points (collective)
+  /// @param[in] mesh The mesh
+  /// @param[in] points The points of the caller, with shape
+  /// (num_points, 3) and row-major storage
+  /// @param[in] num_threads The number of threads used for the tree
+  /// construction and the point searches
+  PointOwnership(const mesh::Mesh& mesh, const xtl::span<const double>& points,
+                 int num_threads = 1);
+
+  /// Move constructor
+  PointOwnership(PointOwnership&& ownership) = default;
+
+  /// Destructor
+  ~PointOwnership() = default;
+
+  /// Move assignment
+  PointOwnership& operator=(PointOwnership&& ownership) = default;
+
+  /// The number of points passed by the caller
+  std::int32_t num_points() const { return _num_points; }
+
+  /// The rank of the owning process of each point passed by the
+  /// caller, or -1 if the point does not collide with the mesh
+  const std::vector<int>& owners() const { return _owners; }
+
+  /// The points owned by the caller, with shape (num_owned_points, 3)
+  /// and row-major storage
+  const std::vector<double>& owned_points() const { return _owned_points; }
+
+  /// The cell (local to process) that collides with each point owned by
+  /// the caller
+  const std::vector<std::int32_t>& owned_cells() const
+  {
+    return _owned_cells;
+  }
+
+  /// Send values at the owned points to the processes that passed the
+  /// points (collective)
+  /// @param[in] values The values at the points owned by the caller,
+  /// with shape (num_owned_points, bs) and row-major storage
+  /// @param[in] bs The number of values for each point
+  /// @return The values at the points passed by the caller, with shape
+  /// (num_points, bs). The values of points that do not collide with
+  /// the mesh are zero.
+  template <typename T>
+  std::vector<T> scatter_values(const xtl::span<const T>& values,
+                                int bs) const
+  {
+    assert(values.size() == bs * _owned_cells.size());
+    std::vector<std::int32_t> send_offsets(_send_offsets.size());
+    std::transform(_send_offsets.begin(), _send_offsets.end(),
+                   send_offsets.begin(),
+                   [bs](std::int32_t offset) { return bs * offset; });
+    const graph::AdjacencyList<T> recv_values = MPI::neighbor_all_to_all(
+        _comm.comm(),
+        graph::AdjacencyList<T>(std::vector<T>(values.begin(), values.end()),
+                                std::move(send_offsets)));
+
+    // The values are received in the order of the positions
+    assert(recv_values.array().size() == bs * _recv_positions.size());
+    std::vector<T> u(bs * _num_points, 0);
+    for (std::size_t i = 0; i < _recv_positions.size(); ++i)
+    {
+      std::copy_n(std::next(recv_values.array().begin(), bs * i), bs,
+                  std::next(u.begin(), bs * _recv_positions[i]));
+    }
+
+    return u;
+  }
+
+private:
+  // Neighbourhood communicator from the owning processes to the
+  // processes that passed the points
+  dolfinx::MPI::Comm _comm;
+
+  // Number of points passed by the caller, and their owning processes
+  std::int32_t _num_points;
+  std::vector<int> _owners;
+
+  // Owned points and the cells that collide with them, ordered by the
+  // neighbourhood rank of the process that passed them
+  std::vector<double> _owned_points;
+  std::vector<std::int32_t> _owned_cells;
+
+  // Offsets of the owned points of each destination of _comm
+  std::vector<std::int32_t> _send_offsets;
+
+  // Index of the point passed by the caller for each value that is
+  // received from the owning processes
+  std::vector<std::int32_t> _recv_positions;
+};
+} // namespace dolfinx::geometry
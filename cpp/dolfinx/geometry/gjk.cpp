@@ -5,62 +5,75 @@
 // SPDX-License-Identifier:    LGPL-3.0-or-later
 
 #include "gjk.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
 #include <stdexcept>
-#include <tuple>
-#include <xtensor-blas/xlinalg.hpp>
-#include <xtensor/xbuilder.hpp>
-#include <xtensor/xfixed.hpp>
-#include <xtensor/xnorm.hpp>
-#include <xtensor/xsort.hpp>
-#include <xtensor/xtensor.hpp>
 
 using namespace dolfinx;
 
 namespace
 {
-// Find the resulting sub-simplex of the input simplex which is nearest to the
-// origin. Also, return the shortest vector from the origin to the resulting
-// simplex.
-std::pair<xt::xtensor<double, 2>, xt::xtensor_fixed<double, xt::xshape<3>>>
-nearest_simplex(const xt::xtensor<double, 2>& s)
+using vec3 = std::array<double, 3>;
+
+//----------------------------------------------------------------------------
+double dot(const vec3& a, const vec3& b)
+{
+  return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+//----------------------------------------------------------------------------
+vec3 sub(const vec3& a, const vec3& b)
+{
+  return {a[0] - b[0], a[1] - b[1], a[2] - b[2]};
+}
+//----------------------------------------------------------------------------
+vec3 cross(const vec3& a, const vec3& b)
+{
+  return {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2],
+          a[0] * b[1] - a[1] * b[0]};
+}
+//----------------------------------------------------------------------------
+// Point a + lm * (b - a)
+vec3 lerp(const vec3& a, const vec3& b, double lm)
 {
-  assert(s.shape(1) == 3);
-  const std::size_t s_rows = s.shape(0);
-  switch (s_rows)
+  return {a[0] + lm * (b[0] - a[0]), a[1] + lm * (b[1] - a[1]),
+          a[2] + lm * (b[2] - a[2])};
+}
+//----------------------------------------------------------------------------
+// Replace the simplex s, with n points, by its sub-simplex which is
+// nearest to the origin, and return the shortest vector from the origin
+// to the sub-simplex. The simplex is stored in a fixed-size array so no
+// memory is allocated.
+vec3 nearest_simplex(std::array<vec3, 4>& s, int& n)
+{
+  switch (n)
   {
   case 2:
   {
-    auto s0 = xt::row(s, 0);
-    auto s1 = xt::row(s, 1);
-    const double lm = -xt::sum(s0 * (s1 - s0))() / xt::norm_sq(s1 - s0)();
+    const vec3 ds = sub(s[1], s[0]);
+    const double lm = -dot(s[0], ds) / dot(ds, ds);
     if (lm >= 0.0 and lm <= 1.0)
     {
       // The origin is between A and B
-      auto v = s0 + lm * (s1 - s0);
-      return {s, v};
+      return lerp(s[0], s[1], lm);
     }
 
+    n = 1;
     if (lm < 0.0)
-      return {xt::reshape_view(s0, {1, 3}), s0};
-    else
-      return {xt::reshape_view(s1, {1, 3}), s1};
+      return s[0];
+    s[0] = s[1];
+    return s[0];
   }
   case 4:
   {
-    auto s0 = xt::row(s, 0);
-    auto s1 = xt::row(s, 1);
-    auto s2 = xt::row(s, 2);
-    auto s3 = xt::row(s, 3);
-    auto W1 = xt::linalg::cross(s0, s1);
-    auto W2 = xt::linalg::cross(s2, s3);
-
-    xt::xtensor_fixed<double, xt::xshape<4>> B;
-    B[0] = xt::sum(s2 * W1)();
-    B[1] = -xt::sum(s3 * W1)();
-    B[2] = xt::sum(s0 * W2)();
-    B[3] = -xt::sum(s1 * W2)();
-
-    const bool signDetM = std::signbit(xt::sum(B)());
+    const vec3 W1 = cross(s[0], s[1]);
+    const vec3 W2 = cross(s[2], s[3]);
+
+    const std::array<double, 4> B
+        = {dot(s[2], W1), -dot(s[3], W1), dot(s[0], W2), -dot(s[1], W2)};
+
+    const bool signDetM = std::signbit(B[0] + B[1] + B[2] + B[3]);
     std::array<bool, 4> f_inside;
     for (int i = 0; i < 4; ++i)
       f_inside[i] = (std::signbit(B[i]) == signDetM);
@@ -68,53 +81,60 @@ nearest_simplex(const xt::xtensor<double, 2>& s)
     if (f_inside[1] and f_inside[2] and f_inside[3])
     {
       if (f_inside[0]) // The origin is inside the tetrahedron
-        return {s, xt::zeros<double>({3})};
+        return {0, 0, 0};
       else // The origin projection P faces BCD
-        return nearest_simplex(xt::view(s, xt::range(0, 3), xt::all()));
+      {
+        n = 3;
+        return nearest_simplex(s, n);
+      }
     }
 
     // Test ACD, ABD and/or ABC.
-    xt::xtensor<double, 2> smin;
-    xt::xtensor_fixed<double, xt::xshape<3>> vmin = xt::zeros<double>({3});
+    std::array<vec3, 4> smin;
+    int nmin = 0;
+    vec3 vmin = {0, 0, 0};
     constexpr int facets[3][3] = {{0, 1, 3}, {0, 2, 3}, {1, 2, 3}};
     double qmin = std::numeric_limits<double>::max();
     for (int i = 0; i < 3; ++i)
     {
       if (f_inside[i + 1] == false)
       {
-        xt::xtensor_fixed<double, xt::xshape<3, 3>> M;
-        xt::row(M, 0) = xt::row(s, facets[i][0]);
-        xt::row(M, 1) = xt::row(s, facets[i][1]);
-        xt::row(M, 2) = xt::row(s, facets[i][2]);
-
-        const auto [snew, v] = nearest_simplex(M);
-        const double q = xt::norm_sq(v)();
+        std::array<vec3, 4> M
+            = {s[facets[i][0]], s[facets[i][1]], s[facets[i][2]]};
+        int nM = 3;
+        const vec3 v = nearest_simplex(M, nM);
+        const double q = dot(v, v);
         if (q < qmin)
         {
           qmin = q;
           vmin = v;
-          smin = snew;
+          smin = M;
+          nmin = nM;
         }
       }
     }
 
-    return {std::move(smin), vmin};
+    s = smin;
+    n = nmin;
+    return vmin;
   }
   }
 
-  assert(s.shape(0) == 3);
-  const auto a = xt::row(s, 0);
-  const auto b = xt::row(s, 1);
-  const auto c = xt::row(s, 2);
-  const double ab2 = xt::norm_sq(a - b)();
-  const double ac2 = xt::norm_sq(a - c)();
-  const double bc2 = xt::norm_sq(b - c)();
-  const xt::xtensor_fixed<double, xt::xshape<3>> lm
-      = {xt::sum(a * (a - b))() / ab2, xt::sum(a * (a - c))() / ac2,
-         xt::sum(b * (b - c))() / bc2};
+  assert(n == 3);
+  const vec3& a = s[0];
+  const vec3& b = s[1];
+  const vec3& c = s[2];
+  const vec3 ab = sub(a, b);
+  const vec3 ac = sub(a, c);
+  const vec3 bc = sub(b, c);
+  const double ab2 = dot(ab, ab);
+  const double ac2 = dot(ac, ac);
+  const double bc2 = dot(bc, bc);
+  const std::array<double, 3> lm
+      = {dot(a, ab) / ab2, dot(a, ac) / ac2, dot(b, bc) / bc2};
 
   // Calculate triangle ABC
-  const double caba = xt::sum((c - a) * (b - a))();
+  const double caba = dot(ac, ab);
   const double c2 = 1 - caba * caba / (ab2 * ac2);
   const double lbb = (lm[0] - lm[1] * caba / ab2) / c2;
   const double lcc = (lm[1] - lm[0] * caba / ac2) / c2;
@@ -123,58 +143,70 @@ nearest_simplex(const xt::xtensor<double, 2>& s)
   if (lbb >= 0.0 and lcc >= 0.0 and (lbb + lcc) <= 1.0)
   {
     // Calculate intersection more accurately
-    auto v = xt::linalg::cross(c - a, b - a);
+    vec3 v = cross(sub(c, a), sub(b, a));
 
     // Barycentre of triangle
-    auto p = (a + b + c) / 3.0;
+    const vec3 p = {(a[0] + b[0] + c[0]) / 3.0, (a[1] + b[1] + c[1]) / 3.0,
+                    (a[2] + b[2] + c[2]) / 3.0};
 
     // Renormalise n in plane of ABC
-    v *= xt::sum(v * p) / xt::norm_sq(v);
-    return {std::move(s), v};
+    const double scale = dot(v, p) / dot(v, v);
+    for (double& vi : v)
+      vi *= scale;
+    return v;
   }
 
   // Get closest point
-  std::size_t i = xt::argmin(xt::norm_sq(s, {1}))();
-  xt::xtensor_fixed<double, xt::xshape<3>> vmin = xt::row(s, i);
-  double qmin = xt::norm_sq(vmin)();
-
-  xt::xtensor<double, 2> smin({1, 3});
-  xt::row(smin, 0) = vmin;
+  const std::array<double, 3> q = {dot(a, a), dot(b, b), dot(c, c)};
+  const int i = std::distance(q.begin(), std::min_element(q.begin(), q.end()));
+  vec3 vmin = s[i];
+  double qmin = q[i];
+  std::array<int, 2> smin = {i, -1};
 
   // Check if edges are closer
   constexpr const int f[3][2] = {{0, 1}, {0, 2}, {1, 2}};
-  for (std::size_t i = 0; i < s.shape(0); ++i)
+  for (int j = 0; j < 3; ++j)
   {
-    auto s0 = xt::row(s, f[i][0]);
-    auto s1 = xt::row(s, f[i][1]);
-    if (lm[i] > 0 and lm[i] < 1)
+    if (lm[j] > 0 and lm[j] < 1)
     {
-      auto v = s0 + lm[i] * (s1 - s0);
-      const double qnorm = xt::norm_sq(v)();
+      const vec3 v = lerp(s[f[j][0]], s[f[j][1]], lm[j]);
+      const double qnorm = dot(v, v);
       if (qnorm < qmin)
       {
         vmin = v;
         qmin = qnorm;
-        smin.resize({2, 3});
-        xt::row(smin, 0) = s0;
-        xt::row(smin, 1) = s1;
+        smin = {f[j][0], f[j][1]};
       }
     }
   }
 
-  return {std::move(smin), vmin};
+  // Edges are stored in increasing vertex order, so s[smin[0]] is not
+  // overwritten before it is read
+  if (smin[1] < 0)
+  {
+    s[0] = s[smin[0]];
+    n = 1;
+  }
+  else
+  {
+    s[0] = s[smin[0]];
+    s[1] = s[smin[1]];
+    n = 2;
+  }
+
+  return vmin;
 }
 //----------------------------------------------------------------------------
-// Support function, finds point p in bd which maximises p.v
-xt::xtensor_fixed<double, xt::xshape<3>>
-support(const xt::xtensor<double, 2>& bd,
-        const xt::xtensor_fixed<double, xt::xshape<3>>& v)
+// Support function, finds point p in bd (shape (num_points, 3)) which
+// maximises p.v
+vec3 support(const xtl::span<const double>& bd, const vec3& v)
 {
-  int i = 0;
-  double qmax = xt::sum(xt::row(bd, 0) * v)();
-  for (std::size_t m = 1; m < bd.shape(0); ++m)
+  std::size_t i = 0;
+  double qmax = bd[0] * v[0] + bd[1] * v[1] + bd[2] * v[2];
+  for (std::size_t m = 1; m < bd.size() / 3; ++m)
   {
-    double q = xt::sum(xt::row(bd, m) * v)();
+    const double q
+        = bd[3 * m] * v[0] + bd[3 * m + 1] * v[1] + bd[3 * m + 2] * v[2];
     if (q > qmax)
     {
       qmax = q;
@@ -182,16 +214,16 @@ support(const xt::xtensor<double, 2>& bd,
     }
   }
 
-  return xt::row(bd, i);
+  return {bd[3 * i], bd[3 * i + 1], bd[3 * i + 2]};
 }
 } // namespace
 //----------------------------------------------------------------------------
-xt::xtensor_fixed<double, xt::xshape<3>>
-geometry::compute_distance_gjk(const xt::xtensor<double, 2>& p,
-                               const xt::xtensor<double, 2>& q)
+std::array<double, 3>
+geometry::compute_distance_gjk(const xtl::span<const double>& p,
+                               const xtl::span<const double>& q)
 {
-  assert(p.shape(1) == 3);
-  assert(q.shape(1) == 3);
+  assert(p.size() % 3 == 0 and !p.empty());
+  assert(q.size() % 3 == 0 and !q.empty());
 
   constexpr int maxk = 10; // Maximum number of iterations of the GJK algorithm
 
@@ -199,46 +231,43 @@ geometry::compute_distance_gjk(const xt::xtensor<double, 2>& p,
   constexpr double eps = 1e-12;
 
   // Initialise vector and simplex
-  xt::xtensor_fixed<double, xt::xshape<3>> v = xt::row(p, 0) - xt::row(q, 0);
-  xt::xtensor<double, 2> s({1, 3});
-  xt::row(s, 0) = v;
+  vec3 v = {p[0] - q[0], p[1] - q[1], p[2] - q[2]};
+  std::array<vec3, 4> s = {v};
+  int n = 1;
 
   // Begin GJK iteration
   int k;
   for (k = 0; k < maxk; ++k)
   {
     // Support function
-    const xt::xtensor_fixed<double, xt::xshape<3>> w
-        = support(p, -v) - support(q, v);
+    const vec3 w = sub(support(p, {-v[0], -v[1], -v[2]}), support(q, v));
 
     // Break if any existing points are the same as w
-    assert(s.shape(1) == 3);
-    std::size_t m;
-    for (m = 0; m < s.shape(0); ++m)
+    int m;
+    for (m = 0; m < n; ++m)
     {
-      if (xt::row(s, m) == w)
+      if (s[m] == w)
         break;
     }
 
-    if (m != s.shape(0))
+    if (m != n)
       break;
 
     // 1st exit condition (v - w).v = 0
-    const double vnorm2 = xt::norm_sq(v)();
-    const double vw = vnorm2 - xt::sum(v * w)();
+    const double vnorm2 = dot(v, v);
+    const double vw = vnorm2 - dot(v, w);
     if (vw < (eps * vnorm2) or vw < eps)
       break;
 
     // Add new vertex to simplex
-    s = xt::vstack(xt::xtuple(s, xt::reshape_view(w, {1, 3})));
-    assert(s.shape(1) == 3);
+    assert(n < 4);
+    s[n++] = w;
 
     // Find nearest subset of simplex
-    std::tie(s, v) = nearest_simplex(s);
-    assert(s.shape(1) == 3);
+    v = nearest_simplex(s, n);
 
     // 2nd exit condition - intersecting or touching
-    if (xt::norm_sq(v)() < eps * eps)
+    if (dot(v, v) < eps * eps)
       break;
   }
 
@@ -248,3 +277,15 @@ geometry::compute_distance_gjk(const xt::xtensor<double, 2>& p,
   return v;
 }
 //----------------------------------------------------------------------------
+xt::xtensor_fixed<double, xt::xshape<3>>
+geometry::compute_distance_gjk(const xt::xtensor<double, 2>& p,
+                               const xt::xtensor<double, 2>& q)
+{
+  assert(p.shape(1) == 3);
+  assert(q.shape(1) == 3);
+  const std::array<double, 3> v
+      = compute_distance_gjk(xtl::span<const double>(p.data(), p.size()),
+                             xtl::span<const double>(q.data(), q.size()));
+  return {v[0], v[1], v[2]};
+}
+//----------------------------------------------------------------------------
@@ -6,8 +6,10 @@
 
 #pragma once
 
+#include <array>
 #include <xtensor/xfixed.hpp>
 #include <xtensor/xtensor.hpp>
+#include <xtl/xspan.hpp>
 
 namespace dolfinx::geometry
 {
@@ -23,4 +25,16 @@ xt::xtensor_fixed<double, xt::xshape<3>>
 compute_distance_gjk(const xt::xtensor<double, 2>& p,
                      const xt::xtensor<double, 2>& q);
 
+/// Calculate the distance between two convex bodies p and q, each
+/// defined by a set of points, using the Gilbert–Johnson–Keerthi (GJK)
+/// distance algorithm. This version does not allocate memory.
+///
+/// @param[in] p Body 1 list of points, shape (num_points, 3) with
+/// row-major storage
+/// @param[in] q Body 2 list of points, shape (num_points, 3) with
+/// row-major storage
+/// @return shortest vector between bodies
+std::array<double, 3> compute_distance_gjk(const xtl::span<const double>& p,
+                                           const xtl::span<const double>& q);
+
 } // namespace dolfinx::geometry
@@ -8,10 +8,22 @@
 #include "utils.h"
 #include "BoundingBoxTree.h"
 #include "gjk.h"
+#include <basix/cell.h>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/Timer.h>
 #include <dolfinx/common/log.h>
+#include <dolfinx/common/utils.h>
+#include <dolfinx/fem/CoordinateElement.h>
 #include <dolfinx/mesh/Geometry.h>
 #include <dolfinx/mesh/Mesh.h>
+#include <dolfinx/mesh/Topology.h>
+#include <dolfinx/mesh/cell_types.h>
 #include <dolfinx/mesh/utils.h>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <set>
+#include <tuple>
 #include <xtensor/xfixed.hpp>
 #include <xtensor/xnorm.hpp>
 
@@ -28,19 +40,34 @@ constexpr bool is_leaf(const std::array<int, 2>& bbox)
 }
 //-----------------------------------------------------------------------------
 bool point_in_bbox(const std::array<std::array<double, 3>, 2>& b,
-                   const std::array<double, 3>& x)
+                   const double* x)
 {
-  xt::xtensor_fixed<double, xt::xshape<3>> _x, b0, b1;
+  constexpr double rtol = 1e-14;
   for (int i = 0; i < 3; ++i)
   {
-    _x[i] = x[i];
-    b0[i] = b[0][i];
-    b1[i] = b[1][i];
+    const double eps0 = rtol * (b[1][i] - b[0][i]);
+    if (x[i] < b[0][i] - eps0 or x[i] > b[1][i] + eps0)
+      return false;
   }
-
+  return true;
+}
+//-----------------------------------------------------------------------------
+// Check whether the point x is in the single precision bounding box of
+// a node. The box contains the double precision box, so this test is
+// true whenever point_in_bbox is true.
+bool point_in_node(const geometry::BoundingBoxTree::Node& node,
+                   const double* x)
+{
   constexpr double rtol = 1e-14;
-  auto eps0 = rtol * (b1 - b0);
-  return xt::all(_x >= (b0 - eps0)) and xt::all(_x <= (b1 + eps0));
+  for (int i = 0; i < 3; ++i)
+  {
+    const double b0 = node.x0[i];
+    const double b1 = node.x1[i];
+    const double eps0 = rtol * (b1 - b0);
+    if (x[i] < b0 - eps0 or x[i] > b1 + eps0)
+      return false;
+  }
+  return true;
 }
 //-----------------------------------------------------------------------------
 bool bbox_in_bbox(const std::array<std::array<double, 3>, 2>& a,
@@ -116,37 +143,6 @@ std::pair<std::int32_t, double> _compute_closest_entity(
   }
 }
 //-----------------------------------------------------------------------------
-// Compute collisions with point (recursive)
-void _compute_collisions_point(const geometry::BoundingBoxTree& tree,
-                               const std::array<double, 3>& p, int node,
-                               std::vector<int>& entities)
-{
-  // Get children of current bounding box node
-  const std::array bbox = tree.bbox(node);
-
-  if (!point_in_bbox(tree.get_bbox(node), p))
-  {
-    // If point is not in bounding box, then don't search further
-    return;
-  }
-  else if (is_leaf(bbox))
-  {
-    // If box is a leaf (which we know contains the point), then add it
-
-    // child_1 denotes entity for leaves
-    const int entity_index = bbox[1];
-
-    // Add the candidate
-    entities.push_back(entity_index);
-  }
-  else
-  {
-    // Check both children
-    _compute_collisions_point(tree, p, bbox[0], entities);
-    _compute_collisions_point(tree, p, bbox[1], entities);
-  }
-}
-//-----------------------------------------------------------------------------
 // Compute collisions with tree (recursive)
 void _compute_collisions_tree(const geometry::BoundingBoxTree& A,
                               const geometry::BoundingBoxTree& B, int node_A,
@@ -201,7 +197,266 @@ void _compute_collisions_tree(const geometry::BoundingBoxTree& A,
   // the logic is easier to follow.
 }
 //-----------------------------------------------------------------------------
+// Visit the leaves whose bounding box contains the point x, depth
+// first with the first child before the second child, using an explicit
+// stack of nodes. The traversal stops when f(entity) returns true.
+// Internal nodes are tested against the compact single precision nodes,
+// and leaves against the double precision boxes, so the leaves that are
+// visited do not depend on the rounding of the compact nodes.
+template <typename F>
+void visit_collisions_point(const geometry::BoundingBoxTree& tree,
+                            const double* x, std::vector<std::int32_t>& stack,
+                            F&& f)
+{
+  const auto& nodes = tree.nodes();
+  stack.clear();
+  if (!nodes.empty())
+    stack.push_back(nodes.size() - 1);
+  while (!stack.empty())
+  {
+    const std::int32_t i = stack.back();
+    stack.pop_back();
+    const geometry::BoundingBoxTree::Node& node = nodes[i];
+    if (!point_in_node(node, x))
+      continue;
+
+    if (node.child0 == node.child1)
+    {
+      if (point_in_bbox(tree.get_bbox(i), x) and f(node.child1))
+        return;
+    }
+    else
+    {
+      stack.push_back(node.child1);
+      stack.push_back(node.child0);
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+// Check whether the box b = (x0, x1) collides with the single precision
+// bounding box of a node, with the tolerance of bbox_in_bbox
+bool bbox_in_node(const double* b,
+                  const geometry::BoundingBoxTree::Node& node)
+{
+  constexpr double rtol = 1e-14;
+  for (int i = 0; i < 3; ++i)
+  {
+    const double a0 = node.x0[i];
+    const double a1 = node.x1[i];
+    const double eps0 = rtol * (a1 - a0);
+    if (b[3 + i] < a0 - eps0 or b[i] > a1 + eps0)
+      return false;
+  }
+  return true;
+}
+//-----------------------------------------------------------------------------
+// Visit the leaves whose bounding box collides with the box b = (x0,
+// x1), in the same way as visit_collisions_point
+template <typename F>
+void visit_collisions_bbox(const geometry::BoundingBoxTree& tree,
+                           const double* b, std::vector<std::int32_t>& stack,
+                           F&& f)
+{
+  const std::array<std::array<double, 3>, 2> bbox
+      = {{{b[0], b[1], b[2]}, {b[3], b[4], b[5]}}};
+  const auto& nodes = tree.nodes();
+  stack.clear();
+  if (!nodes.empty())
+    stack.push_back(nodes.size() - 1);
+  while (!stack.empty())
+  {
+    const std::int32_t i = stack.back();
+    stack.pop_back();
+    const geometry::BoundingBoxTree::Node& node = nodes[i];
+    if (!bbox_in_node(b, node))
+      continue;
 
+    if (node.child0 == node.child1)
+    {
+      if (bbox_in_bbox(bbox, tree.get_bbox(i)))
+        f(node.child1);
+    }
+    else
+    {
+      stack.push_back(node.child1);
+      stack.push_back(node.child0);
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+// Create a neighbourhood communicator
+MPI_Comm create_neighbor_comm(MPI_Comm comm, const std::vector<int>& sources,
+                              const std::vector<int>& destinations)
+{
+  MPI_Comm neighbor_comm;
+  MPI_Dist_graph_create_adjacent(comm, sources.size(), sources.data(),
+                                 MPI_UNWEIGHTED, destinations.size(),
+                                 destinations.data(), MPI_UNWEIGHTED,
+                                 MPI_INFO_NULL, false, &neighbor_comm);
+  return neighbor_comm;
+}
+//-----------------------------------------------------------------------------
+// Compute the outward unit normal n_f and offset b_f of each facet f of
+// a reference cell, such that the reference point X is outside facet f
+// by n_f.X - b_f. The normals are returned with shape (num_facets, 3).
+std::pair<std::vector<double>, std::vector<double>>
+reference_facet_planes(mesh::CellType cell_type)
+{
+  const int tdim = mesh::cell_dim(cell_type);
+  const xt::xtensor<double, 2> v = basix::cell::geometry(
+      basix::cell::str_to_type(mesh::to_string(cell_type)));
+  const graph::AdjacencyList<int> facets
+      = mesh::get_entity_vertices(cell_type, tdim - 1);
+
+  std::array<double, 3> midpoint = {0, 0, 0};
+  for (std::size_t i = 0; i < v.shape(0); ++i)
+    for (int j = 0; j < tdim; ++j)
+      midpoint[j] += v(i, j) / v.shape(0);
+
+  std::vector<double> normals(3 * facets.num_nodes(), 0);
+  std::vector<double> offsets(facets.num_nodes());
+  for (int f = 0; f < facets.num_nodes(); ++f)
+  {
+    auto fv = facets.links(f);
+    double* n = normals.data() + 3 * f;
+    if (tdim == 1)
+      n[0] = 1;
+    else if (tdim == 2)
+    {
+      n[0] = v(fv[1], 1) - v(fv[0], 1);
+      n[1] = v(fv[0], 0) - v(fv[1], 0);
+    }
+    else
+    {
+      std::array<double, 3> a, b;
+      for (int j = 0; j < 3; ++j)
+      {
+        a[j] = v(fv[1], j) - v(fv[0], j);
+        b[j] = v(fv[2], j) - v(fv[0], j);
+      }
+      n[0] = a[1] * b[2] - a[2] * b[1];
+      n[1] = a[2] * b[0] - a[0] * b[2];
+      n[2] = a[0] * b[1] - a[1] * b[0];
+    }
+
+    // Normalise, and orient the normal away from the cell midpoint
+    double norm = 0, b = 0, m = 0;
+    for (int j = 0; j < tdim; ++j)
+    {
+      norm += n[j] * n[j];
+      b += n[j] * v(fv[0], j);
+      m += n[j] * midpoint[j];
+    }
+    const double scale = (m > b ? -1 : 1) / std::sqrt(norm);
+    std::transform(n, n + 3, n, [scale](double x) { return scale * x; });
+    offsets[f] = scale * b;
+  }
+
+  return {std::move(normals), std::move(offsets)};
+}
+//-----------------------------------------------------------------------------
+// Compute the squared distance from the point p to a cell, using a
+// caller-provided array for the cell nodes
+double squared_distance_cell(const mesh::Geometry& geometry, std::int32_t c,
+                             const std::array<double, 3>& p,
+                             std::vector<double>& nodes)
+{
+  const xt::xtensor<double, 2>& x = geometry.x();
+  auto dofs = geometry.dofmap().links(c);
+  nodes.resize(3 * dofs.size());
+  for (std::size_t i = 0; i < dofs.size(); ++i)
+    for (std::size_t j = 0; j < 3; ++j)
+      nodes[3 * i + j] = x(dofs[i], j);
+  const std::array<double, 3> d = geometry::compute_distance_gjk(p, nodes);
+  return d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+}
+//-----------------------------------------------------------------------------
+// Compute the squared distance from the point x to the single precision
+// bounding box of a node, which is a lower bound for the distance to
+// the double precision box
+double squared_distance_node(const geometry::BoundingBoxTree::Node& node,
+                             const double* x)
+{
+  double d2 = 0.0;
+  for (int i = 0; i < 3; ++i)
+  {
+    const double d = std::max(
+        {double(node.x0[i]) - x[i], x[i] - double(node.x1[i]), 0.0});
+    d2 += d * d;
+  }
+  return d2;
+}
+//-----------------------------------------------------------------------------
+// Compute the order of the points x (shape (num_points, 3), row-major)
+// along a Morton (Z-order) curve through their bounding box
+std::vector<std::int32_t> compute_morton_order(const xtl::span<const double>& x)
+{
+  const std::size_t num_points = x.size() / 3;
+  std::array<double, 3> x0, x1;
+  x0.fill(std::numeric_limits<double>::max());
+  x1.fill(std::numeric_limits<double>::lowest());
+  for (std::size_t i = 0; i < num_points; ++i)
+  {
+    for (int j = 0; j < 3; ++j)
+    {
+      x0[j] = std::min(x0[j], x[3 * i + j]);
+      x1[j] = std::max(x1[j], x[3 * i + j]);
+    }
+  }
+
+  // Quantise the coordinates to 21 bits, and interleave the bits
+  constexpr int num_bits = 21;
+  constexpr double scale = (std::uint64_t(1) << num_bits) - 1;
+  std::vector<std::pair<std::uint64_t, std::int32_t>> codes(num_points);
+  for (std::size_t i = 0; i < num_points; ++i)
+  {
+    std::uint64_t code = 0;
+    for (int j = 0; j < 3; ++j)
+    {
+      const double h = x1[j] - x0[j];
+      const std::uint64_t q
+          = h > 0 ? std::uint64_t((x[3 * i + j] - x0[j]) / h * scale) : 0;
+      for (int b = 0; b < num_bits; ++b)
+        code |= ((q >> b) & 1) << (3 * b + j);
+    }
+    codes[i] = {code, std::int32_t(i)};
+  }
+  std::sort(codes.begin(), codes.end());
+
+  std::vector<std::int32_t> order(num_points);
+  std::transform(codes.begin(), codes.end(), order.begin(),
+                 [](auto& c) { return c.second; });
+  return order;
+}
+//-----------------------------------------------------------------------------
+// Build the adjacency list of num_points nodes, where f(i0, i1, links,
+// num_links) appends the links of the nodes [i0, i1) to links and sets
+// num_links[i - i0] for each node i. The ranges are processed on
+// num_threads threads.
+template <typename F>
+graph::AdjacencyList<std::int32_t>
+create_point_links(std::int64_t num_points, int num_threads, F&& f)
+{
+  std::vector<std::int32_t> offsets(num_points + 1, 0);
+  std::vector<std::vector<std::int32_t>> links(std::max(num_threads, 1));
+  const int num_parts = common::for_each_part(
+      num_points, num_threads,
+      [&](std::int64_t i0, std::int64_t i1, int t)
+      {
+        f(i0, i1, links[t],
+          xtl::span<std::int32_t>(offsets.data() + i0 + 1, i1 - i0));
+      });
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+  std::vector<std::int32_t> array;
+  array.reserve(offsets.back());
+  for (int t = 0; t < num_parts; ++t)
+    array.insert(array.end(), links[t].begin(), links[t].end());
+
+  return graph::AdjacencyList<std::int32_t>(std::move(array),
+                                            std::move(offsets));
+}
+//-----------------------------------------------------------------------------
 } // namespace
 
 //-----------------------------------------------------------------------------
@@ -241,16 +496,281 @@ geometry::compute_collisions(const BoundingBoxTree& tree0,
   return entities;
 }
 //-----------------------------------------------------------------------------
+graph::AdjacencyList<std::int64_t> geometry::compute_distributed_collisions(
+    const mesh::Mesh& mesh0, const BoundingBoxTree& tree0,
+    const mesh::Mesh& mesh1, const BoundingBoxTree& tree1, bool exact,
+    int num_threads)
+{
+  common::Timer timer("Compute distributed collisions");
+  MPI_Comm comm = mesh0.comm();
+  const int dim0 = tree0.tdim();
+  const int dim1 = tree1.tdim();
+
+  // Get the entities and bounding boxes of the leaves of tree0
+  std::vector<std::int32_t> entities0;
+  std::vector<double> bboxes0;
+  for (std::int32_t i = 0; i < tree0.num_bboxes(); ++i)
+  {
+    if (const std::array bbox = tree0.bbox(i); is_leaf(bbox))
+    {
+      entities0.push_back(bbox[1]);
+      const std::array<std::array<double, 3>, 2> b = tree0.get_bbox(i);
+      bboxes0.insert(bboxes0.end(), b[0].begin(), b[0].end());
+      bboxes0.insert(bboxes0.end(), b[1].begin(), b[1].end());
+    }
+  }
+
+  // Find the processes whose part of mesh1 may collide with each leaf
+  const BoundingBoxTree global_tree1 = tree1.create_global_tree(comm);
+  const graph::AdjacencyList<std::int32_t> candidates = create_point_links(
+      entities0.size(), num_threads,
+      [&](std::int64_t i0, std::int64_t i1, std::vector<std::int32_t>& ranks,
+          const xtl::span<std::int32_t>& num_ranks)
+      {
+        std::vector<std::int32_t> stack;
+        for (std::int64_t i = i0; i < i1; ++i)
+        {
+          const std::size_t size = ranks.size();
+          visit_collisions_bbox(global_tree1, bboxes0.data() + 6 * i, stack,
+                                [&ranks](std::int32_t r)
+                                { ranks.push_back(r); });
+          num_ranks[i - i0] = ranks.size() - size;
+        }
+      });
+
+  // Create the neighbourhoods of the processes that the caller sends
+  // boxes to and receives boxes from
+  std::vector<int> dest(candidates.array().begin(), candidates.array().end());
+  std::sort(dest.begin(), dest.end());
+  dest.erase(std::unique(dest.begin(), dest.end()), dest.end());
+  std::vector<int> src = dolfinx::MPI::compute_graph_edges(
+      comm, std::set<int>(dest.begin(), dest.end()));
+  std::sort(src.begin(), src.end());
+  const dolfinx::MPI::Comm comm_fwd(create_neighbor_comm(comm, src, dest),
+                                    false);
+  const dolfinx::MPI::Comm comm_rev(create_neighbor_comm(comm, dest, src),
+                                    false);
+
+  // Pack the bounding box of each leaf for each candidate process,
+  // followed by the vertex coordinates of its entity for the exact
+  // test. The number of vertices is the same on all processes.
+  const int num_vertices0 = mesh::num_cell_vertices(
+      mesh::cell_entity_type(mesh0.topology().cell_type(), dim0));
+  const int bs = exact ? 6 + 3 * num_vertices0 : 6;
+  const xt::xtensor<std::int32_t, 2> geometry0
+      = exact ? mesh::entities_to_geometry(mesh0, dim0, entities0, false)
+              : xt::xtensor<std::int32_t, 2>({0, 0});
+  const xt::xtensor<double, 2>& x0 = mesh0.geometry().x();
+  std::vector<std::int32_t> send_offsets(dest.size() + 1, 0);
+  for (std::int32_t r : candidates.array())
+  {
+    const int n = std::lower_bound(dest.begin(), dest.end(), r) - dest.begin();
+    ++send_offsets[n + 1];
+  }
+  std::partial_sum(send_offsets.begin(), send_offsets.end(),
+                   send_offsets.begin());
+  std::vector<std::int32_t> send_indices(send_offsets.back());
+  std::vector<double> send_data(bs * send_offsets.back());
+  {
+    std::vector<std::int32_t> pos(send_offsets.begin(),
+                                  std::prev(send_offsets.end()));
+    for (std::int32_t i = 0; i < candidates.num_nodes(); ++i)
+    {
+      for (std::int32_t r : candidates.links(i))
+      {
+        const int n
+            = std::lower_bound(dest.begin(), dest.end(), r) - dest.begin();
+        const std::int32_t k = pos[n]++;
+        send_indices[k] = i;
+        auto data = std::next(send_data.begin(), bs * k);
+        std::copy_n(std::next(bboxes0.begin(), 6 * i), 6, data);
+        for (std::size_t j = 0; j < geometry0.shape(1); ++j)
+          for (int l = 0; l < 3; ++l)
+            data[6 + 3 * j + l] = x0(geometry0(i, j), l);
+      }
+    }
+  }
+  std::vector<std::int32_t> send_data_offsets(send_offsets.size());
+  std::transform(send_offsets.begin(), send_offsets.end(),
+                 send_data_offsets.begin(),
+                 [bs](std::int32_t offset) { return bs * offset; });
+  const graph::AdjacencyList<double> recv_data
+      = dolfinx::MPI::neighbor_all_to_all(
+          comm_fwd.comm(),
+          graph::AdjacencyList<double>(std::move(send_data),
+                                       std::move(send_data_offsets)));
+
+  // Get the vertex coordinates of the entities of the leaves of tree1
+  // for the exact test
+  std::vector<std::int32_t> entities1;
+  for (std::int32_t i = 0; i < tree1.num_bboxes(); ++i)
+    if (const std::array bbox = tree1.bbox(i); is_leaf(bbox))
+      entities1.push_back(bbox[1]);
+  const xt::xtensor<std::int32_t, 2> geometry1
+      = exact ? mesh::entities_to_geometry(mesh1, dim1, entities1, false)
+              : xt::xtensor<std::int32_t, 2>({0, 0});
+  std::vector<std::int32_t> rows1;
+  if (exact and !entities1.empty())
+  {
+    rows1.resize(*std::max_element(entities1.begin(), entities1.end()) + 1);
+    for (std::size_t i = 0; i < entities1.size(); ++i)
+      rows1[entities1[i]] = i;
+  }
+  const xt::xtensor<double, 2>& x1 = mesh1.geometry().x();
+
+  // Compute the entities of mesh1 that collide with each received leaf
+  const std::size_t num_recv = recv_data.array().size() / bs;
+  const graph::AdjacencyList<std::int32_t> collisions = create_point_links(
+      num_recv, num_threads,
+      [&](std::int64_t i0, std::int64_t i1, std::vector<std::int32_t>& links,
+          const xtl::span<std::int32_t>& num_links)
+      {
+        constexpr double eps2 = 1e-20;
+        std::vector<std::int32_t> stack;
+        std::vector<double> q(3 * geometry1.shape(1));
+        for (std::int64_t i = i0; i < i1; ++i)
+        {
+          const double* data = recv_data.array().data() + bs * i;
+          const xtl::span<const double> p(data + 6, bs - 6);
+          const std::size_t size = links.size();
+          visit_collisions_bbox(
+              tree1, data, stack,
+              [&](std::int32_t e)
+              {
+                if (exact)
+                {
+                  for (std::size_t j = 0; j < geometry1.shape(1); ++j)
+                    for (int l = 0; l < 3; ++l)
+                      q[3 * j + l] = x1(geometry1(rows1[e], j), l);
+                  const std::array<double, 3> d = compute_distance_gjk(p, q);
+                  if (d[0] * d[0] + d[1] * d[1] + d[2] * d[2] >= eps2)
+                    return;
+                }
+                links.push_back(e);
+              });
+          num_links[i - i0] = links.size() - size;
+        }
+      });
+
+  // Send the number of colliding entities of each received leaf, and
+  // their global indices, back to the processes that sent the leaves
+  std::vector<std::int32_t> recv_offsets(recv_data.offsets().size());
+  std::transform(recv_data.offsets().begin(), recv_data.offsets().end(),
+                 recv_offsets.begin(),
+                 [bs](std::int32_t offset) { return offset / bs; });
+  std::vector<std::int32_t> num_collisions(num_recv);
+  for (std::size_t i = 0; i < num_recv; ++i)
+    num_collisions[i] = collisions.num_links(i);
+  std::vector<std::int32_t> collision_offsets(recv_offsets.size());
+  std::transform(recv_offsets.begin(), recv_offsets.end(),
+                 collision_offsets.begin(),
+                 [&collisions](std::int32_t offset)
+                 { return collisions.offsets()[offset]; });
+  std::vector<std::int64_t> global_collisions(collisions.array().size());
+  mesh1.topology().index_map(dim1)->local_to_global(collisions.array(),
+                                                    global_collisions);
+  const graph::AdjacencyList<std::int32_t> sent_num_collisions
+      = dolfinx::MPI::neighbor_all_to_all(
+          comm_rev.comm(),
+          graph::AdjacencyList<std::int32_t>(std::move(num_collisions),
+                                             std::move(recv_offsets)));
+  const graph::AdjacencyList<std::int64_t> sent_collisions
+      = dolfinx::MPI::neighbor_all_to_all(
+          comm_rev.comm(),
+          graph::AdjacencyList<std::int64_t>(std::move(global_collisions),
+                                             std::move(collision_offsets)));
+  assert(sent_num_collisions.array().size() == send_indices.size());
+
+  // Collect the colliding entities of mesh1 for each entity of mesh0.
+  // An entity of mesh1 may be found by more than one process if it is a
+  // ghost.
+  auto map0 = mesh0.topology().index_map(dim0);
+  assert(map0);
+  const std::int32_t num_entities0 = map0->size_local() + map0->num_ghosts();
+  std::vector<std::int32_t> offsets(num_entities0 + 1, 0);
+  for (std::size_t k = 0; k < send_indices.size(); ++k)
+    offsets[entities0[send_indices[k]] + 1] += sent_num_collisions.array()[k];
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+  std::vector<std::int64_t> array(offsets.back());
+  {
+    std::vector<std::int32_t> pos(offsets.begin(), std::prev(offsets.end()));
+    auto it = sent_collisions.array().begin();
+    for (std::size_t k = 0; k < send_indices.size(); ++k)
+    {
+      const std::int32_t e = entities0[send_indices[k]];
+      const std::int32_t n = sent_num_collisions.array()[k];
+      std::copy_n(it, n, std::next(array.begin(), pos[e]));
+      pos[e] += n;
+      it += n;
+    }
+  }
+
+  // Sort the entities of mesh1 for each entity of mesh0 and remove
+  // duplicates
+  std::int32_t num_unique = 0;
+  for (std::int32_t e = 0; e < num_entities0; ++e)
+  {
+    auto first = std::next(array.begin(), offsets[e]);
+    auto last = std::next(array.begin(), offsets[e + 1]);
+    std::sort(first, last);
+    last = std::unique(first, last);
+    offsets[e] = num_unique;
+    num_unique = std::distance(array.begin(),
+                               std::copy(first, last, std::next(array.begin(),
+                                                                num_unique)));
+  }
+  offsets.back() = num_unique;
+  array.resize(num_unique);
+
+  LOG(INFO) << "Computed " << num_unique << " distributed collisions for "
+            << entities0.size() << " entities.";
+
+  return graph::AdjacencyList<std::int64_t>(std::move(array),
+                                            std::move(offsets));
+}
+//-----------------------------------------------------------------------------
 std::vector<int> geometry::compute_collisions(const BoundingBoxTree& tree,
                                               const std::array<double, 3>& p)
 {
   std::vector<int> entities;
-  if (tree.num_bboxes() > 0)
-    _compute_collisions_point(tree, p, tree.num_bboxes() - 1, entities);
+  std::vector<std::int32_t> stack;
+  visit_collisions_point(tree, p.data(), stack,
+                         [&entities](std::int32_t e)
+                         {
+                           entities.push_back(e);
+                           return false;
+                         });
 
   return entities;
 }
 //-----------------------------------------------------------------------------
+graph::AdjacencyList<std::int32_t>
+geometry::compute_collisions(const BoundingBoxTree& tree,
+                             const xtl::span<const double>& points,
+                             int num_threads)
+{
+  assert(points.size() % 3 == 0);
+  auto compute = [&](std::int64_t i0, std::int64_t i1,
+                     std::vector<std::int32_t>& entities,
+                     const xtl::span<std::int32_t>& num_entities)
+  {
+    std::vector<std::int32_t> stack;
+    for (std::int64_t i = i0; i < i1; ++i)
+    {
+      const std::size_t size = entities.size();
+      visit_collisions_point(tree, points.data() + 3 * i, stack,
+                             [&entities](std::int32_t e)
+                             {
+                               entities.push_back(e);
+                               return false;
+                             });
+      num_entities[i - i0] = entities.size() - size;
+    }
+  };
+
+  return create_point_links(points.size() / 3, num_threads, compute);
+}
+//-----------------------------------------------------------------------------
 double geometry::compute_squared_distance_bbox(
     const std::array<std::array<double, 3>, 2>& b,
     const std::array<double, 3>& x)
@@ -305,6 +825,127 @@ geometry::compute_closest_entity(const BoundingBoxTree& tree,
   return {index, std::sqrt(distance2)};
 }
 //-----------------------------------------------------------------------------
+std::pair<std::vector<std::int32_t>, std::vector<double>>
+geometry::compute_closest_entities(const BoundingBoxTree& tree,
+                                   const xtl::span<const double>& points,
+                                   const mesh::Mesh& mesh, int k,
+                                   int num_threads)
+{
+  assert(points.size() % 3 == 0);
+  if (k < 1)
+    throw std::runtime_error("Number of closest entities must be positive.");
+
+  // The entity connectivities used by squared_distance are created
+  // before the threaded search
+  const int tdim = mesh.topology().dim();
+  const int dim = tree.tdim();
+  if (dim > 0 and dim < tdim)
+  {
+    mesh.topology_mutable().create_connectivity(dim, tdim);
+    mesh.topology_mutable().create_connectivity(tdim, dim);
+  }
+
+  // Exact squared distance from the point p to the entity of a leaf
+  const mesh::Geometry& geometry = mesh.geometry();
+  auto leaf_distance = [&](std::int32_t node, const std::array<double, 3>& p,
+                           std::vector<double>& nodes)
+  {
+    if (dim == 0)
+    {
+      const std::array<double, 3> x = tree.get_bbox(node)[0];
+      return (x[0] - p[0]) * (x[0] - p[0]) + (x[1] - p[1]) * (x[1] - p[1])
+             + (x[2] - p[2]) * (x[2] - p[2]);
+    }
+    else if (dim == tdim)
+      return squared_distance_cell(geometry, tree.bbox(node)[1], p, nodes);
+    else
+      return geometry::squared_distance(mesh, dim, tree.bbox(node)[1], p);
+  };
+
+  const std::size_t num_points = points.size() / 3;
+  std::vector<std::int32_t> entities(k * num_points, -1);
+  std::vector<double> distances(k * num_points, -1);
+  const std::vector<std::int32_t> order = compute_morton_order(points);
+  const auto& nodes = tree.nodes();
+  auto compute = [&](std::int64_t i0, std::int64_t i1, int)
+  {
+    // Min-heap of {squared distance to box, node} to visit, and max-heap
+    // of {squared distance, leaf} of the k closest leaves found so far
+    using Item = std::pair<double, std::int32_t>;
+    std::vector<Item> queue, closest;
+    std::vector<double> x;
+    for (std::int64_t i = i0; i < i1; ++i)
+    {
+      const std::int32_t pi = order[i];
+      const std::array<double, 3> p
+          = {points[3 * pi], points[3 * pi + 1], points[3 * pi + 2]};
+
+      // The closest leaves of the previous point along the curve bound
+      // the distance to the k-th closest leaf of this point
+      for (Item& c : closest)
+        c.first = leaf_distance(c.second, p, x);
+      std::make_heap(closest.begin(), closest.end());
+
+      queue.clear();
+      if (!nodes.empty())
+        queue.push_back({0.0, nodes.size() - 1});
+      while (!queue.empty())
+      {
+        std::pop_heap(queue.begin(), queue.end(), std::greater<Item>());
+        const auto [r2, i_node] = queue.back();
+        queue.pop_back();
+        if ((int)closest.size() == k and r2 >= closest.front().first)
+          break;
+
+        const BoundingBoxTree::Node& node = nodes[i_node];
+        if (node.child0 == node.child1)
+        {
+          auto it = std::find_if(closest.begin(), closest.end(),
+                                 [i_node = i_node](auto& c)
+                                 { return c.second == i_node; });
+          if (it != closest.end())
+            continue;
+
+          const double d2 = leaf_distance(i_node, p, x);
+          if ((int)closest.size() < k)
+          {
+            closest.push_back({d2, i_node});
+            std::push_heap(closest.begin(), closest.end());
+          }
+          else if (d2 < closest.front().first)
+          {
+            std::pop_heap(closest.begin(), closest.end());
+            closest.back() = {d2, i_node};
+            std::push_heap(closest.begin(), closest.end());
+          }
+        }
+        else
+        {
+          for (std::int32_t child : {node.child0, node.child1})
+          {
+            const double c2 = squared_distance_node(nodes[child], p.data());
+            if ((int)closest.size() < k or c2 < closest.front().first)
+            {
+              queue.push_back({c2, child});
+              std::push_heap(queue.begin(), queue.end(), std::greater<Item>());
+            }
+          }
+        }
+      }
+
+      std::sort_heap(closest.begin(), closest.end());
+      for (std::size_t j = 0; j < closest.size(); ++j)
+      {
+        entities[k * pi + j] = nodes[closest[j].second].child1;
+        distances[k * pi + j] = std::sqrt(closest[j].first);
+      }
+    }
+  };
+  common::for_each_part(num_points, num_threads, compute);
+
+  return {std::move(entities), std::move(distances)};
+}
+//-----------------------------------------------------------------------------
 double geometry::squared_distance(const mesh::Mesh& mesh, int dim,
                                   std::int32_t index,
                                   const std::array<double, 3>& p)
@@ -316,18 +957,10 @@ double geometry::squared_distance(const mesh::Mesh& mesh, int dim,
 
   const graph::AdjacencyList<std::int32_t>& x_dofmap = geometry.dofmap();
 
-  xt::xtensor_fixed<double, xt::xshape<1, 3>> _p;
-  std::copy(p.begin(), p.end(), _p.data());
-
   if (dim == tdim)
   {
-    auto dofs = x_dofmap.links(index);
-    xt::xtensor<double, 2> nodes({dofs.size(), 3});
-    for (std::size_t i = 0; i < dofs.size(); ++i)
-      for (std::size_t j = 0; j < 3; ++j)
-        nodes(i, j) = geom_dofs(dofs[i], j);
-
-    return xt::norm_sq(geometry::compute_distance_gjk(_p, nodes))();
+    std::vector<double> nodes;
+    return squared_distance_cell(geometry, index, p, nodes);
   }
   else
   {
@@ -352,12 +985,13 @@ double geometry::squared_distance(const mesh::Mesh& mesh, int dim,
     const std::vector<int> entity_dofs
         = geometry.cmap().dof_layout().entity_closure_dofs(dim,
                                                            local_cell_entity);
-    xt::xtensor<double, 2> nodes({entity_dofs.size(), 3});
+    std::vector<double> nodes(3 * entity_dofs.size());
     for (std::size_t i = 0; i < entity_dofs.size(); i++)
       for (std::size_t j = 0; j < 3; ++j)
-        nodes(i, j) = geom_dofs(dofs[entity_dofs[i]], j);
+        nodes[3 * i + j] = geom_dofs(dofs[entity_dofs[i]], j);
 
-    return xt::norm_sq(geometry::compute_distance_gjk(_p, nodes))();
+    const std::array<double, 3> d = geometry::compute_distance_gjk(p, nodes);
+    return d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
   }
 }
 //-------------------------------------------------------------------------------
@@ -382,3 +1016,199 @@ std::vector<std::int32_t> geometry::select_colliding_cells(
   return result;
 }
 //-------------------------------------------------------------------------------
+graph::AdjacencyList<std::int32_t> geometry::select_colliding_cells(
+    const mesh::Mesh& mesh,
+    const graph::AdjacencyList<std::int32_t>& candidate_cells,
+    const xtl::span<const double>& points, int n, int num_threads)
+{
+  assert(points.size() == 3 * candidate_cells.num_nodes());
+  const double eps2 = 1e-20;
+  const mesh::Geometry& geometry = mesh.geometry();
+  auto compute = [&](std::int64_t i0, std::int64_t i1,
+                     std::vector<std::int32_t>& cells,
+                     const xtl::span<std::int32_t>& num_cells)
+  {
+    std::array<double, 3> p;
+    std::vector<double> nodes;
+    for (std::int64_t i = i0; i < i1; ++i)
+    {
+      std::copy_n(points.data() + 3 * i, 3, p.begin());
+      int count = 0;
+      for (std::int32_t c : candidate_cells.links(i))
+      {
+        if (squared_distance_cell(geometry, c, p, nodes) < eps2)
+        {
+          cells.push_back(c);
+          if (++count == n)
+            break;
+        }
+      }
+      num_cells[i - i0] = count;
+    }
+  };
+
+  return create_point_links(candidate_cells.num_nodes(), num_threads,
+                            compute);
+}
+//-----------------------------------------------------------------------------
+graph::AdjacencyList<std::int32_t>
+geometry::compute_colliding_cells(const mesh::Mesh& mesh,
+                                  const BoundingBoxTree& tree,
+                                  const xtl::span<const double>& points,
+                                  int n, int num_threads)
+{
+  assert(points.size() % 3 == 0);
+  assert(tree.tdim() == mesh.topology().dim());
+  const double eps2 = 1e-20;
+  const mesh::Geometry& geometry = mesh.geometry();
+  auto compute = [&](std::int64_t i0, std::int64_t i1,
+                     std::vector<std::int32_t>& cells,
+                     const xtl::span<std::int32_t>& num_cells)
+  {
+    std::vector<std::int32_t> stack;
+    std::array<double, 3> p;
+    std::vector<double> nodes;
+    for (std::int64_t i = i0; i < i1; ++i)
+    {
+      std::copy_n(points.data() + 3 * i, 3, p.begin());
+      int count = 0;
+      visit_collisions_point(
+          tree, points.data() + 3 * i, stack,
+          [&](std::int32_t c)
+          {
+            if (squared_distance_cell(geometry, c, p, nodes) < eps2)
+            {
+              cells.push_back(c);
+              return ++count == n;
+            }
+            return false;
+          });
+      num_cells[i - i0] = count;
+    }
+  };
+
+  return create_point_links(points.size() / 3, num_threads, compute);
+}
+//-----------------------------------------------------------------------------
+std::vector<std::int32_t> geometry::locate_cells(
+    const mesh::Mesh& mesh, const BoundingBoxTree& tree,
+    const xtl::span<const double>& points,
+    const xtl::span<const std::int32_t>& cells, int max_steps,
+    int num_threads)
+{
+  assert(points.size() == 3 * cells.size());
+  const mesh::Topology& topology = mesh.topology();
+  const int tdim = topology.dim();
+  mesh.topology_mutable().create_entities(tdim - 1);
+  mesh.topology_mutable().create_connectivity(tdim, tdim - 1);
+  mesh.topology_mutable().create_connectivity(tdim - 1, tdim);
+  auto c_to_f = topology.connectivity(tdim, tdim - 1);
+  assert(c_to_f);
+  auto f_to_c = topology.connectivity(tdim - 1, tdim);
+  assert(f_to_c);
+
+  std::vector<double> normals, offsets;
+  std::tie(normals, offsets) = reference_facet_planes(topology.cell_type());
+  const mesh::Geometry& geometry = mesh.geometry();
+  const fem::CoordinateElement& cmap = geometry.cmap();
+  const graph::AdjacencyList<std::int32_t>& x_dofmap = geometry.dofmap();
+  const xt::xtensor<double, 2>& x_g = geometry.x();
+  const std::size_t gdim = geometry.dim();
+  const std::size_t num_dofs_g = cmap.dof_layout().num_dofs();
+
+  // Walk from the initial cell of each point. The result is -1 if the
+  // walk fails.
+  constexpr double eps = 1e-12;
+  std::vector<std::int32_t> located(cells.size(), -1);
+  auto walk = [&](std::int64_t i0, std::int64_t i1, int)
+  {
+    xt::xtensor<double, 2> coordinate_dofs({num_dofs_g, gdim});
+    xt::xtensor<double, 2> x({1, gdim});
+    xt::xtensor<double, 2> X({1, std::size_t(tdim)});
+    xt::xtensor<double, 3> J({1, gdim, std::size_t(tdim)});
+    xt::xtensor<double, 3> K({1, std::size_t(tdim), gdim});
+    xt::xtensor<double, 1> detJ({1});
+    for (std::int64_t i = i0; i < i1; ++i)
+    {
+      for (std::size_t j = 0; j < gdim; ++j)
+        x(0, j) = points[3 * i + j];
+
+      std::int32_t c = cells[i];
+      for (int step = 0; c >= 0 and step < max_steps; ++step)
+      {
+        auto dofs = x_dofmap.links(c);
+        for (std::size_t k = 0; k < dofs.size(); ++k)
+          for (std::size_t j = 0; j < gdim; ++j)
+            coordinate_dofs(k, j) = x_g(dofs[k], j);
+
+        // The Newton solver for non-affine cells may fail for points
+        // far outside the cell
+        try
+        {
+          cmap.pull_back(X, J, detJ, K, x, coordinate_dofs);
+        }
+        catch (const std::runtime_error&)
+        {
+          break;
+        }
+
+        // Find the facet that the reference point is furthest outside of
+        int facet = -1;
+        double d_max = eps;
+        for (std::size_t f = 0; f < offsets.size(); ++f)
+        {
+          double d = -offsets[f];
+          for (int j = 0; j < tdim; ++j)
+            d += normals[3 * f + j] * X(0, j);
+          if (d > d_max)
+          {
+            facet = f;
+            d_max = d;
+          }
+        }
+
+        if (facet < 0)
+        {
+          located[i] = c;
+          break;
+        }
+
+        // Move to the cell on the other side of the facet, if there is
+        // one on this process
+        auto facet_cells = f_to_c->links(c_to_f->links(c)[facet]);
+        if (facet_cells.size() == 1)
+          break;
+        c = facet_cells[0] == c ? facet_cells[1] : facet_cells[0];
+      }
+    }
+  };
+  common::for_each_part(cells.size(), num_threads, walk);
+
+  // Locate the remaining points with the bounding box tree
+  std::vector<std::int32_t> remaining;
+  std::vector<double> remaining_points;
+  for (std::size_t i = 0; i < located.size(); ++i)
+  {
+    if (located[i] < 0)
+    {
+      remaining.push_back(i);
+      remaining_points.insert(remaining_points.end(),
+                              std::next(points.begin(), 3 * i),
+                              std::next(points.begin(), 3 * i + 3));
+    }
+  }
+  if (!remaining.empty())
+  {
+    const graph::AdjacencyList<std::int32_t> colliding_cells
+        = compute_colliding_cells(mesh, tree, remaining_points, 1,
+                                  num_threads);
+    for (std::size_t k = 0; k < remaining.size(); ++k)
+    {
+      if (auto c = colliding_cells.links(k); !c.empty())
+        located[remaining[k]] = c[0];
+    }
+  }
+
+  return located;
+}
+//-----------------------------------------------------------------------------
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <array>
+#include <dolfinx/graph/AdjacencyList.h>
 #include <utility>
 #include <vector>
 #include <xtl/xspan.hpp>
@@ -38,6 +39,30 @@ create_midpoint_tree(const mesh::Mesh& mesh, int tdim,
 std::vector<std::array<int, 2>>
 compute_collisions(const BoundingBoxTree& tree0, const BoundingBoxTree& tree1);
 
+/// Compute the collisions between the entities of two distributed
+/// meshes (collective). The leaf bounding boxes of tree0 are sent to
+/// the processes whose part of mesh1 they may collide with, and
+/// collisions are computed by the receiving processes against tree1.
+/// @param[in] mesh0 The first mesh
+/// @param[in] tree0 A bounding box tree for entities (local to
+/// process) of mesh0
+/// @param[in] mesh1 The second mesh, distributed over the same
+/// communicator as mesh0
+/// @param[in] tree1 A bounding box tree for entities (local to
+/// process) of mesh1
+/// @param[in] exact If true, pairs of entities with colliding bounding
+/// boxes are only kept if the convex hulls of their vertices collide,
+/// using the GJK algorithm. Otherwise, all pairs of entities with
+/// colliding bounding boxes are returned.
+/// @param[in] num_threads The number of threads
+/// @return For each entity (local to process) of mesh0 with the
+/// dimension of tree0, the sorted global indices of the colliding
+/// entities of mesh1
+graph::AdjacencyList<std::int64_t> compute_distributed_collisions(
+    const mesh::Mesh& mesh0, const BoundingBoxTree& tree0,
+    const mesh::Mesh& mesh1, const BoundingBoxTree& tree1, bool exact = true,
+    int num_threads = 1);
+
 /// Compute all collisions between bounding boxes and point
 /// @param[in] tree The bounding box tree
 /// @param[in] p The point
@@ -45,6 +70,17 @@ compute_collisions(const BoundingBoxTree& tree0, const BoundingBoxTree& tree1);
 std::vector<int> compute_collisions(const BoundingBoxTree& tree,
                                     const std::array<double, 3>& p);
 
+/// Compute all collisions between bounding boxes and a set of points
+/// @param[in] tree The bounding box tree
+/// @param[in] points The points, with shape (num_points, 3) and row-major
+/// storage
+/// @param[in] num_threads The number of threads
+/// @return The bounding box leaves (local to process) that contain each
+/// point, in the order returned by compute_collisions for a single point
+graph::AdjacencyList<std::int32_t>
+compute_collisions(const BoundingBoxTree& tree,
+                   const xtl::span<const double>& points, int num_threads = 1);
+
 /// Compute closest mesh entity (local to process) for the topological distance
 /// of the bounding box tree and distance and a point
 /// @param[in] tree The bounding box tree
@@ -58,6 +94,27 @@ compute_closest_entity(const BoundingBoxTree& tree,
                        const std::array<double, 3>& p, const mesh::Mesh& mesh,
                        double R = -1);
 
+/// Compute the k closest mesh entities (local to process) of the
+/// bounding box tree leaves to each of a set of points. The tree is
+/// traversed best first, and the points are processed in the order of a
+/// Morton (Z-order) curve through them, with the closest entities of
+/// each point used to bound the search for the next point.
+/// @param[in] tree The bounding box tree
+/// @param[in] points The points, with shape (num_points, 3) and row-major
+/// storage
+/// @param[in] mesh The mesh
+/// @param[in] k The number of closest entities for each point
+/// @param[in] num_threads The number of threads
+/// @return The local indices of the closest entities to each point and
+/// their distances from the point, both with shape (num_points, k) and
+/// row-major storage and sorted by increasing distance. If the tree has
+/// fewer than k leaves, the remaining entities and distances are -1.
+std::pair<std::vector<std::int32_t>, std::vector<double>>
+compute_closest_entities(const BoundingBoxTree& tree,
+                         const xtl::span<const double>& points,
+                         const mesh::Mesh& mesh, int k = 1,
+                         int num_threads = 1);
+
 /// Compute squared distance between point and bounding box wih index
 /// "node". Returns zero if point is inside box.
 double
@@ -92,4 +149,65 @@ std::vector<std::int32_t>
 select_colliding_cells(const dolfinx::mesh::Mesh& mesh,
                        const xtl::span<const std::int32_t>& candidate_cells,
                        const std::array<double, 3>& p, int n);
+
+/// For each point, select up to n cells (local to process) from its
+/// candidate cells which actually collide with the point. See
+/// select_colliding_cells for a single point.
+/// @param[in] mesh Mesh
+/// @param[in] candidate_cells The candidate cells of each point, e.g.
+/// computed by compute_collisions
+/// @param[in] points The points, with shape (num_points, 3) and row-major
+/// storage
+/// @param[in] n Maximum number of positive results for each point, or
+/// zero to select all colliding cells
+/// @param[in] num_threads The number of threads
+/// @return The cells which collide with each point
+graph::AdjacencyList<std::int32_t> select_colliding_cells(
+    const dolfinx::mesh::Mesh& mesh,
+    const graph::AdjacencyList<std::int32_t>& candidate_cells,
+    const xtl::span<const double>& points, int n, int num_threads = 1);
+
+/// Compute up to n cells (local to process) which collide with each
+/// point. This is equivalent to compute_collisions followed by
+/// select_colliding_cells, but the candidate cells are tested as they
+/// are found, and the search for a point stops once n cells are found.
+/// @param[in] mesh Mesh
+/// @param[in] tree The bounding box tree for the cells of the mesh
+/// @param[in] points The points, with shape (num_points, 3) and row-major
+/// storage
+/// @param[in] n Maximum number of positive results for each point, or
+/// zero to select all colliding cells
+/// @param[in] num_threads The number of threads
+/// @return The cells which collide with each point
+graph::AdjacencyList<std::int32_t>
+compute_colliding_cells(const mesh::Mesh& mesh, const BoundingBoxTree& tree,
+                        const xtl::span<const double>& points, int n,
+                        int num_threads = 1);
+
+/// Compute the cell (local to process) that contains each point by
+/// walking through the mesh from a given cell for each point, e.g. the
+/// cell that contained a particle at the previous step. In each step
+/// of the walk the point is pulled back to the reference cell, and the
+/// walk moves to the neighbouring cell across the facet that the
+/// reference point is furthest outside of. The cell that contains a
+/// point may be a ghost cell, in which case the point is owned by
+/// another process. Points for which the walk fails, e.g. when it
+/// reaches a facet with no neighbouring cell on this process, are
+/// located with the bounding box tree.
+/// @param[in] mesh The mesh
+/// @param[in] tree The bounding box tree for the cells of the mesh
+/// @param[in] points The points, with shape (num_points, 3) and row-major
+/// storage
+/// @param[in] cells The cell to start the walk from for each point, or
+/// -1 to locate the point with the bounding box tree
+/// @param[in] max_steps The maximum number of cells visited by the walk
+/// for each point
+/// @param[in] num_threads The number of threads
+/// @return The cell that contains each point, or -1 if the point is not
+/// in a cell on this process
+std::vector<std::int32_t>
+locate_cells(const mesh::Mesh& mesh, const BoundingBoxTree& tree,
+             const xtl::span<const double>& points,
+             const xtl::span<const std::int32_t>& cells, int max_steps = 32,
+             int num_threads = 1);
 } // namespace dolfinx::geometry
@@ -8,8 +8,10 @@
 
 #include <cassert>
 #include <dolfinx/common/array2d.h>
+#include <memory>
 #include <numeric>
 #include <sstream>
+#include <stdexcept>
 #include <utility>
 #include <vector>
 #include <xtensor/xtensor.hpp>
@@ -71,6 +73,21 @@ public:
     assert(_offsets.back() == (std::int32_t)_array.size());
   }
 
+  /// Construct a compact adjacency list for a graph with constant
+  /// degree (valency). The offsets are not stored, which reduces the
+  /// memory footprint; see AdjacencyList::is_compact.
+  /// @param [in] data Adjacency array
+  /// @param [in] degree The number of (outgoing) edges for each node.
+  /// Must be greater than zero.
+  template <typename U, typename = std::enable_if_t<std::is_same<
+                            std::vector<T>, std::decay_t<U>>::value>>
+  AdjacencyList(U&& data, int degree)
+      : _array(std::forward<U>(data)), _degree(degree)
+  {
+    assert(degree > 0);
+    assert(_array.size() % degree == 0);
+  }
+
   /// Set all connections for all entities (T is a '2D' container, e.g.
   /// a std::vector<<std::vector<std::size_t>>,
   /// std::vector<<std::set<std::size_t>>, etc)
@@ -107,18 +124,36 @@ public:
   /// Equality operator
   bool operator==(const AdjacencyList& list) const
   {
-    return this->_array == list._array and this->_offsets == list._offsets;
+    if (!this->is_compact() and !list.is_compact())
+      return this->_array == list._array and this->_offsets == list._offsets;
+
+    if (this->_array != list._array or this->num_nodes() != list.num_nodes())
+      return false;
+    for (std::int32_t i = 0; i < this->num_nodes(); ++i)
+    {
+      if (this->num_links(i) != list.num_links(i))
+        return false;
+    }
+    return true;
   }
 
   /// Get the number of nodes
   /// @return The number of nodes
-  std::int32_t num_nodes() const { return _offsets.size() - 1; }
+  std::int32_t num_nodes() const
+  {
+    if (_degree > 0)
+      return _array.size() / _degree;
+    else
+      return _offsets.size() - 1;
+  }
 
   /// Number of connections for given node
   /// @param [in] node Node index
   /// @return The number of outgoing links (edges) from the node
   int num_links(int node) const
   {
+    if (_degree > 0)
+      return _degree;
     assert((node + 1) < (int)_offsets.size());
     return _offsets[node + 1] - _offsets[node];
   }
@@ -129,6 +164,8 @@ public:
   /// AdjacencyList:num_links(node).
   xtl::span<T> links(int node)
   {
+    if (_degree > 0)
+      return xtl::span<T>(_array.data() + std::size_t(node) * _degree, _degree);
     return xtl::span<T>(_array.data() + _offsets[node],
                         _offsets[node + 1] - _offsets[node]);
   }
@@ -139,6 +176,11 @@ public:
   /// AdjacencyList:num_links(node).
   xtl::span<const T> links(int node) const
   {
+    if (_degree > 0)
+    {
+      return xtl::span<const T>(_array.data() + std::size_t(node) * _degree,
+                                _degree);
+    }
     return xtl::span<const T>(_array.data() + _offsets[node],
                               _offsets[node + 1] - _offsets[node]);
   }
@@ -150,7 +192,30 @@ public:
   std::vector<T>& array() { return _array; }
 
   /// Offset for each node in array() (const version)
-  const std::vector<std::int32_t>& offsets() const { return _offsets; }
+  /// @pre The adjacency list is not compact, see
+  /// AdjacencyList::is_compact
+  const std::vector<std::int32_t>& offsets() const
+  {
+    if (_degree > 0)
+    {
+      throw std::runtime_error(
+          "Offsets are not stored for a compact adjacency list.");
+    }
+    return _offsets;
+  }
+
+  /// Check if the adjacency list is stored in the compact format for
+  /// graphs with constant degree, in which the offsets are not stored
+  /// @return True if the adjacency list is compact
+  bool is_compact() const { return _degree > 0; }
+
+  /// Return the memory allocated by the adjacency list
+  /// @return The number of bytes allocated for the links and offsets
+  std::size_t memory_usage() const
+  {
+    return _array.capacity() * sizeof(T)
+           + _offsets.capacity() * sizeof(std::int32_t);
+  }
 
   /// Copy of the Adjacency List if the specified type is different from the
   /// current type, ele return a reference.
@@ -165,6 +230,11 @@ public:
 
     if constexpr (std::is_same<X, T>::value)
       return *this;
+    else if (_degree > 0)
+    {
+      return graph::AdjacencyList<X>(
+          std::vector<X>(_array.begin(), _array.end()), _degree);
+    }
     else
     {
       return graph::AdjacencyList<X>(
@@ -178,7 +248,7 @@ public:
     std::stringstream s;
     s << "<AdjacencyList> with " + std::to_string(this->num_nodes()) + " nodes"
       << std::endl;
-    for (std::size_t e = 0; e < _offsets.size() - 1; ++e)
+    for (std::int32_t e = 0; e < this->num_nodes(); ++e)
     {
       s << "  " << e << ": [";
       for (auto link : this->links(e))
@@ -192,10 +262,37 @@ private:
   // Connections for all entities stored as a contiguous array
   std::vector<T> _array;
 
-  // Position of first connection for each entity (using local index)
+  // Position of first connection for each entity (using local index).
+  // Empty for compact lists.
   std::vector<std::int32_t> _offsets;
+
+  // Number of connections for each entity for compact lists, otherwise
+  // -1
+  int _degree = -1;
 };
 
+/// Create a compact copy of an adjacency list if it has constant degree
+/// (valency), see AdjacencyList::is_compact
+/// @param [in] list The adjacency list
+/// @return A compact copy of @p list, or nullptr if @p list is already
+/// compact, has no links or does not have constant degree
+template <typename T>
+std::shared_ptr<AdjacencyList<T>> compact(const AdjacencyList<T>& list)
+{
+  if (list.is_compact() or list.array().empty())
+    return nullptr;
+
+  const int degree = list.num_links(0);
+  for (std::int32_t i = 1; i < list.num_nodes(); ++i)
+  {
+    if (list.num_links(i) != degree)
+      return nullptr;
+  }
+
+  return std::make_shared<AdjacencyList<T>>(std::vector<T>(list.array()),
+                                            degree);
+}
+
 /// Construct an adjacency list from array of data for a graph with
 /// constant degree (valency). A constant degree graph has the same
 /// number of edges for every node.
@@ -0,0 +1,85 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "colouring.h"
+#include <algorithm>
+#include <dolfinx/graph/AdjacencyList.h>
+#include <numeric>
+
+using namespace dolfinx;
+
+//-----------------------------------------------------------------------------
+graph::AdjacencyList<std::int32_t>
+graph::compute_colouring(const graph::AdjacencyList<std::int32_t>& graph)
+{
+  const std::int32_t num_nodes = graph.num_nodes();
+  const std::vector<std::int32_t>& links = graph.array();
+  if (links.empty())
+  {
+    // No node shares a link, so all nodes can have the same colour
+    std::vector<std::int32_t> nodes(num_nodes);
+    std::iota(nodes.begin(), nodes.end(), 0);
+    return graph::AdjacencyList<std::int32_t>(
+        std::move(nodes), std::vector<std::int32_t>{0, num_nodes});
+  }
+
+  // Build the transpose graph (link -> nodes)
+  const std::int32_t num_links
+      = *std::max_element(links.begin(), links.end()) + 1;
+  std::vector<std::int32_t> offsets_t(num_links + 1, 0);
+  for (std::int32_t l : links)
+    ++offsets_t[l + 1];
+  std::partial_sum(offsets_t.begin(), offsets_t.end(), offsets_t.begin());
+  std::vector<std::int32_t> data_t(offsets_t.back());
+  {
+    std::vector<std::int32_t> pos(offsets_t.begin(),
+                                  std::prev(offsets_t.end()));
+    for (std::int32_t n = 0; n < num_nodes; ++n)
+      for (std::int32_t l : graph.links(n))
+        data_t[pos[l]++] = n;
+  }
+
+  // Greedy colouring. 'marker[c] == n' means that colour c is used by a
+  // neighbour of node n.
+  std::vector<std::int32_t> colour(num_nodes, -1);
+  std::vector<std::int32_t> marker;
+  std::int32_t num_colours = 0;
+  for (std::int32_t n = 0; n < num_nodes; ++n)
+  {
+    for (std::int32_t l : graph.links(n))
+    {
+      for (std::int32_t k = offsets_t[l]; k < offsets_t[l + 1]; ++k)
+      {
+        if (const std::int32_t c = colour[data_t[k]]; c >= 0)
+          marker[c] = n;
+      }
+    }
+
+    // Find lowest colour not used by a neighbour
+    const auto it = std::find_if(marker.begin(), marker.end(),
+                                 [n](auto m) { return m != n; });
+    colour[n] = std::distance(marker.begin(), it);
+    if (colour[n] == num_colours)
+    {
+      marker.push_back(-1);
+      ++num_colours;
+    }
+  }
+
+  // Group nodes by colour
+  std::vector<std::int32_t> offsets(num_colours + 1, 0);
+  for (std::int32_t c : colour)
+    ++offsets[c + 1];
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+  std::vector<std::int32_t> data(offsets.back());
+  std::vector<std::int32_t> pos(offsets.begin(), std::prev(offsets.end()));
+  for (std::int32_t n = 0; n < num_nodes; ++n)
+    data[pos[colour[n]]++] = n;
+
+  return graph::AdjacencyList<std::int32_t>(std::move(data),
+                                            std::move(offsets));
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,31 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace dolfinx::graph
+{
+
+template <typename T>
+class AdjacencyList;
+
+/// Compute a greedy colouring of the nodes of a graph such that no two
+/// nodes with the same colour share a link. The graph is typically a
+/// map from mesh entities (cells) to degrees-of-freedom, in which case
+/// no two cells of the same colour share a degree-of-freedom.
+///
+/// @param[in] graph The graph. Node `i` is connected to the links
+/// `graph.links(i)`.
+/// @return The nodes for each colour, i.e. `colours.links(c)` is the
+/// list of nodes with colour `c`. Within each colour the nodes are
+/// ordered by increasing index.
+AdjacencyList<std::int32_t>
+compute_colouring(const AdjacencyList<std::int32_t>& graph);
+
+} // namespace dolfinx::graph
@@ -13,4 +13,6 @@ namespace dolfinx
 // DOLFINx graph interface
 
 #include <dolfinx/graph/boostordering.h>
+#include <dolfinx/graph/colouring.h>
+#include <dolfinx/graph/ordering.h>
 #include <dolfinx/graph/partition.h>
@@ -6,11 +6,13 @@
 
 #include "kahip.h"
 #include <algorithm>
+#include <array>
 #include <dolfinx/common/MPI.h>
 #include <dolfinx/common/Timer.h>
 #include <dolfinx/graph/AdjacencyList.h>
 #include <map>
 #include <set>
+#include <stdexcept>
 #include <vector>
 
 #ifdef HAS_KAHIP
@@ -24,46 +26,82 @@ using namespace dolfinx;
 //----------------------------------------------------------------------------
 std::function<graph::AdjacencyList<std::int32_t>(
     MPI_Comm, int, const graph::AdjacencyList<std::int64_t>&, std::int32_t,
-    bool)>
+    bool, const xtl::span<const std::int32_t>&,
+    const xtl::span<const std::int32_t>&)>
 graph::kahip::partitioner(int mode, int seed, double imbalance,
                           bool suppress_output)
 {
   return [mode, seed, imbalance,
           suppress_output](MPI_Comm mpi_comm, int nparts,
                            const graph::AdjacencyList<std::int64_t>& graph,
-                           std::int32_t, bool ghosting) {
+                           std::int32_t, bool ghosting,
+                           const xtl::span<const std::int32_t>& node_weights,
+                           const xtl::span<const std::int32_t>& edge_weights) {
     common::Timer timer("Compute graph partition (KaHIP)");
 
-    const auto& local_graph = graph.as_type<unsigned long long>();
     const int num_processes = dolfinx::MPI::size(mpi_comm);
     const int process_number = dolfinx::MPI::rank(mpi_comm);
 
-    // Graph does not have vertex or adjacency weights, so we use null
-    // pointers as arguments
-    unsigned long long *vwgt(nullptr), *adjcwgt(nullptr);
+    if (!node_weights.empty()
+        and (int)node_weights.size() != graph.num_nodes())
+    {
+      throw std::runtime_error("Node weights size mismatch");
+    }
+    if (!edge_weights.empty()
+        and edge_weights.size() != graph.array().size())
+    {
+      throw std::runtime_error("Edge weights size mismatch");
+    }
+
+    // Use null pointers as arguments if the graph does not have vertex
+    // or adjacency weights. Weights must be set on all ranks or on none.
+    std::array<int, 2> has_weights
+        = {!node_weights.empty(), !edge_weights.empty()};
+    MPI_Allreduce(MPI_IN_PLACE, has_weights.data(), 2, MPI_INT, MPI_MAX,
+                  mpi_comm);
+    std::vector<unsigned long long> _vwgt, _adjcwgt;
+    if (has_weights[0])
+    {
+      _vwgt.assign(node_weights.begin(), node_weights.end());
+      _vwgt.resize(std::max(1, graph.num_nodes()), 1);
+    }
+    if (has_weights[1])
+    {
+      _adjcwgt.assign(edge_weights.begin(), edge_weights.end());
+      _adjcwgt.resize(std::max(std::size_t(1), graph.array().size()),
+                      1);
+    }
+    unsigned long long* vwgt = _vwgt.empty() ? nullptr : _vwgt.data();
+    unsigned long long* adjcwgt = _adjcwgt.empty() ? nullptr : _adjcwgt.data();
 
     // Call KaHIP to partition graph
     common::Timer timer1("KaHIP: call ParHIPPartitionKWay");
 
     // Compute distribution across all ranks
     std::vector<unsigned long long> node_dist(num_processes + 1, 0);
-    const unsigned long long num_local_nodes = local_graph.num_nodes();
+    const unsigned long long num_local_nodes = graph.num_nodes();
     MPI_Allgather(&num_local_nodes, 1, MPI_UNSIGNED_LONG_LONG,
                   node_dist.data() + 1, 1, MPI_UNSIGNED_LONG_LONG, mpi_comm);
     std::partial_sum(node_dist.begin(), node_dist.end(), node_dist.begin());
 
+    // The graph links (global indices) are passed to KaHIP without a
+    // copy. The indices are non-negative and unsigned long long has the
+    // size of std::int64_t. KaHIP does not modify the graph data. Only
+    // the offsets, with one entry per node, are copied.
+    static_assert(sizeof(unsigned long long) == sizeof(std::int64_t));
+    unsigned long long* adj_graph_array = reinterpret_cast<unsigned long long*>(
+        const_cast<std::int64_t*>(graph.array().data()));
+
     // Partition graph
     std::vector<unsigned long long> part(num_local_nodes);
     std::vector<unsigned long long> adj_graph_offsets(
-        local_graph.offsets().begin(), local_graph.offsets().end());
+        graph.offsets().begin(), graph.offsets().end());
     int edgecut = 0;
     double _imbalance = imbalance;
-    ParHIPPartitionKWay(
-        const_cast<unsigned long long*>(node_dist.data()),
-        const_cast<unsigned long long*>(adj_graph_offsets.data()),
-        const_cast<unsigned long long*>(local_graph.array().data()), vwgt,
-        adjcwgt, &nparts, &_imbalance, suppress_output, seed, mode, &edgecut,
-        part.data(), &mpi_comm);
+    ParHIPPartitionKWay(node_dist.data(), adj_graph_offsets.data(),
+                        adj_graph_array, vwgt, adjcwgt, &nparts, &_imbalance,
+                        suppress_output, seed, mode, &edgecut, part.data(),
+                        &mpi_comm);
     timer1.stop();
 
     const unsigned long long elm_begin = node_dist[process_number];
@@ -82,7 +120,7 @@ graph::kahip::partitioner(int mode, int seed, double imbalance,
       // local indexing "i"
       for (int i = 0; i < ncells; i++)
       {
-        const auto edges = local_graph.links(i);
+        const auto edges = graph.links(i);
         for (std::size_t j = 0; j < edges.size(); ++j)
         {
           const unsigned long long other_cell = edges[j];
@@ -128,8 +166,8 @@ graph::kahip::partitioner(int mode, int seed, double imbalance,
       for (std::size_t p = 0; p < recv_cell_partition.size(); p += 2)
         cell_ownership[recv_cell_partition[p]] = recv_cell_partition[p + 1];
 
-      const std::vector<std::int32_t>& xadj = local_graph.offsets();
-      const std::vector<unsigned long long>& adjncy = local_graph.array();
+      const std::vector<std::int32_t>& xadj = graph.offsets();
+      const std::vector<std::int64_t>& adjncy = graph.array();
 
       // Generate map for where new boundary cells need to be sent
       for (std::int32_t i = 0; i < ncells; i++)
@@ -10,6 +10,7 @@
 #include <dolfinx/graph/AdjacencyList.h>
 #include <functional>
 #include <mpi.h>
+#include <xtl/xspan.hpp>
 
 /// Interfaces to KaHIP parallel partitioner
 namespace dolfinx::graph::kahip
@@ -25,7 +26,8 @@ namespace dolfinx::graph::kahip
 /// @return A KaHIP graph partitioning function with specified parameter
 /// options
 std::function<graph::AdjacencyList<std::int32_t>(
-    MPI_Comm, int, const AdjacencyList<std::int64_t>&, std::int32_t, bool)>
+    MPI_Comm, int, const AdjacencyList<std::int64_t>&, std::int32_t, bool,
+    const xtl::span<const std::int32_t>&, const xtl::span<const std::int32_t>&)>
 partitioner(int mode = 1, int seed = 0, double imbalance = 0.03,
             bool suppress_output = true);
 
@@ -0,0 +1,449 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "ordering.h"
+#include "AdjacencyList.h"
+#include <algorithm>
+#include <cassert>
+#include <dolfinx/common/Timer.h>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+using namespace dolfinx;
+
+namespace
+{
+//-----------------------------------------------------------------------------
+// Compute the level structure rooted at a node, i.e. the nodes that
+// are reachable from the root in breadth-first order, and the offset
+// of each level in this list. Only nodes with the same label as the
+// root are visited. The level of each visited node is stored in
+// 'level', which must be -1 for all nodes with the label of the root
+// on entry. The work arrays 'nodes' and 'offsets' are overwritten.
+void compute_level_structure(const graph::AdjacencyList<std::int32_t>& graph,
+                             std::int32_t root,
+                             const std::vector<std::int32_t>& label,
+                             std::vector<std::int32_t>& level,
+                             std::vector<std::int32_t>& nodes,
+                             std::vector<std::int32_t>& offsets)
+{
+  nodes.assign(1, root);
+  offsets.assign(1, 0);
+  level[root] = 0;
+  std::size_t begin = 0;
+  while (begin < nodes.size())
+  {
+    const std::size_t end = nodes.size();
+    offsets.push_back(end);
+    const std::int32_t l = offsets.size() - 1;
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      for (std::int32_t e : graph.links(nodes[i]))
+      {
+        if (label[e] == label[root] and level[e] == -1)
+        {
+          level[e] = l;
+          nodes.push_back(e);
+        }
+      }
+    }
+    begin = end;
+  }
+}
+//-----------------------------------------------------------------------------
+// Reset the level of the nodes in a level structure to -1
+void reset_levels(const std::vector<std::int32_t>& nodes,
+                  std::vector<std::int32_t>& level)
+{
+  for (std::int32_t n : nodes)
+    level[n] = -1;
+}
+//-----------------------------------------------------------------------------
+// Compute the width (largest number of nodes in a level) of a level
+// structure
+std::int32_t width(const std::vector<std::int32_t>& offsets)
+{
+  std::int32_t w = 0;
+  for (std::size_t i = 0; i + 1 < offsets.size(); ++i)
+    w = std::max(w, offsets[i + 1] - offsets[i]);
+  return w;
+}
+//-----------------------------------------------------------------------------
+// Find a pseudo-peripheral node of the subgraph that contains a node,
+// using the algorithm of George and Liu
+std::int32_t
+pseudo_peripheral_node(const graph::AdjacencyList<std::int32_t>& graph,
+                       std::int32_t root,
+                       const std::vector<std::int32_t>& label,
+                       std::vector<std::int32_t>& level,
+                       std::vector<std::int32_t>& nodes,
+                       std::vector<std::int32_t>& offsets)
+{
+  auto degree_less = [&graph](std::int32_t a, std::int32_t b)
+  { return graph.num_links(a) < graph.num_links(b); };
+
+  compute_level_structure(graph, root, label, level, nodes, offsets);
+  while (true)
+  {
+    // Take the node of smallest degree in the last level
+    const std::size_t depth = offsets.size();
+    const std::int32_t x = *std::min_element(
+        std::next(nodes.begin(), offsets[offsets.size() - 2]), nodes.end(),
+        degree_less);
+    reset_levels(nodes, level);
+
+    compute_level_structure(graph, x, label, level, nodes, offsets);
+    if (offsets.size() <= depth)
+    {
+      reset_levels(nodes, level);
+      return x;
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+// Append the nodes reachable from a node to 'order' in Cuthill-McKee
+// order, i.e. breadth-first with the unnumbered links of each node
+// appended by increasing degree. Only nodes with the same label as
+// 'start' are visited.
+void cuthill_mckee(const graph::AdjacencyList<std::int32_t>& graph,
+                   std::int32_t start, const std::vector<std::int32_t>& label,
+                   std::vector<bool>& numbered,
+                   std::vector<std::int32_t>& order)
+{
+  auto degree_less = [&graph](std::int32_t a, std::int32_t b)
+  { return graph.num_links(a) < graph.num_links(b); };
+
+  numbered[start] = true;
+  order.push_back(start);
+  for (std::size_t i = order.size() - 1; i < order.size(); ++i)
+  {
+    const std::size_t first = order.size();
+    for (std::int32_t e : graph.links(order[i]))
+    {
+      if (label[e] == label[start] and !numbered[e])
+      {
+        numbered[e] = true;
+        order.push_back(e);
+      }
+    }
+    std::stable_sort(std::next(order.begin(), first), order.end(),
+                     degree_less);
+  }
+}
+//-----------------------------------------------------------------------------
+// Compute the reverse Cuthill-McKee re-ordering of the subgraphs of
+// nodes with the same label. The nodes of each component of a subgraph
+// are numbered consecutively.
+std::vector<int> rcm(const graph::AdjacencyList<std::int32_t>& graph,
+                     const std::vector<std::int32_t>& label)
+{
+  const std::int32_t n = graph.num_nodes();
+  std::vector<std::int32_t> level(n, -1), nodes, offsets;
+  std::vector<bool> numbered(n, false);
+  std::vector<std::int32_t> order;
+  order.reserve(n);
+  for (std::int32_t i = 0; i < n; ++i)
+  {
+    if (numbered[i])
+      continue;
+
+    const std::int32_t start
+        = pseudo_peripheral_node(graph, i, label, level, nodes, offsets);
+    const std::size_t begin = order.size();
+    cuthill_mckee(graph, start, label, numbered, order);
+    std::reverse(std::next(order.begin(), begin), order.end());
+  }
+
+  std::vector<int> map(n);
+  for (std::int32_t i = 0; i < n; ++i)
+    map[order[i]] = i;
+  return map;
+}
+//-----------------------------------------------------------------------------
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+std::vector<int>
+graph::reorder_rcm(const graph::AdjacencyList<std::int32_t>& graph)
+{
+  common::Timer timer("Compute graph re-ordering (RCM)");
+  return rcm(graph, std::vector<std::int32_t>(graph.num_nodes(), 0));
+}
+//-----------------------------------------------------------------------------
+std::vector<int>
+graph::reorder_blocked_rcm(const graph::AdjacencyList<std::int32_t>& graph,
+                           std::int32_t block_size)
+{
+  common::Timer timer("Compute graph re-ordering (blocked RCM)");
+  if (block_size <= 0)
+    throw std::runtime_error("Block size must be greater than zero.");
+
+  // Label the nodes by their block. The nodes of a block are
+  // contiguous, so the blocks keep their order when the components of
+  // the subgraphs are numbered in the order of their lowest node.
+  std::vector<std::int32_t> label(graph.num_nodes());
+  for (std::size_t i = 0; i < label.size(); ++i)
+    label[i] = i / block_size;
+  return rcm(graph, label);
+}
+//-----------------------------------------------------------------------------
+std::vector<int>
+graph::reorder_gps(const graph::AdjacencyList<std::int32_t>& graph)
+{
+  common::Timer timer("Compute graph re-ordering (GPS)");
+
+  auto degree_less = [&graph](std::int32_t a, std::int32_t b)
+  { return graph.num_links(a) < graph.num_links(b); };
+
+  const std::int32_t n = graph.num_nodes();
+  const std::vector<std::int32_t> label(n, 0);
+  std::vector<std::int32_t> level(n, -1), nodes, offsets;
+  std::vector<std::int32_t> level_u(n), level_v(n), component, candidates;
+  std::vector<std::int32_t> part(n, -1), rest, rest_offsets, parts;
+  std::vector<std::int32_t> count, inc_u, inc_v;
+  std::vector<bool> numbered(n, false);
+  std::vector<std::int32_t> order;
+  order.reserve(n);
+  for (std::int32_t i = 0; i < n; ++i)
+  {
+    if (numbered[i])
+      continue;
+
+    // Start from the node of smallest degree in the component
+    compute_level_structure(graph, i, label, level, nodes, offsets);
+    std::int32_t u = *std::min_element(nodes.begin(), nodes.end(), degree_less);
+    reset_levels(nodes, level);
+
+    // Step 1: find the endpoints u and v of a pseudo-diameter. The
+    // level structures rooted at the nodes in the last level of the
+    // level structure of u are computed (one node for each degree). If
+    // one is deeper, it replaces u; otherwise v is the root of the
+    // narrowest of them.
+    std::int32_t v = -1, width_u = 0, width_v = 0, num_levels = 0;
+    compute_level_structure(graph, u, label, level, nodes, offsets);
+    while (true)
+    {
+      const std::size_t depth = offsets.size();
+      num_levels = depth - 1;
+      component = nodes;
+      for (std::int32_t node : nodes)
+        level_u[node] = level[node];
+      width_u = width(offsets);
+
+      candidates.assign(std::next(nodes.begin(), offsets[offsets.size() - 2]),
+                        nodes.end());
+      std::stable_sort(candidates.begin(), candidates.end(), degree_less);
+      candidates.erase(std::unique(candidates.begin(), candidates.end(),
+                                   [&graph](std::int32_t a, std::int32_t b) {
+                                     return graph.num_links(a)
+                                            == graph.num_links(b);
+                                   }),
+                       candidates.end());
+      reset_levels(nodes, level);
+
+      bool deeper = false;
+      v = -1;
+      width_v = std::numeric_limits<std::int32_t>::max();
+      for (std::int32_t w : candidates)
+      {
+        compute_level_structure(graph, w, label, level, nodes, offsets);
+        if (offsets.size() > depth)
+        {
+          u = w;
+          deeper = true;
+          break;
+        }
+
+        if (std::int32_t width_w = width(offsets); width_w < width_v)
+        {
+          v = w;
+          width_v = width_w;
+          for (std::int32_t node : nodes)
+            level_v[node] = level[node];
+        }
+        reset_levels(nodes, level);
+      }
+
+      if (!deeper)
+        break;
+    }
+    assert(v != -1);
+
+    // Step 2: combine the level structures of u and v. For node w, the
+    // level pair is (level_u[w], K - 1 - level_v[w]), where K is the
+    // number of levels. Nodes with equal levels in the pair keep them,
+    // and each of the remaining connected components is placed in the
+    // levels of u or v, whichever gives the smaller width.
+    for (std::int32_t w : component)
+      level_v[w] = num_levels - 1 - level_v[w];
+    count.assign(num_levels, 0);
+    inc_u.assign(num_levels, 0);
+    inc_v.assign(num_levels, 0);
+    for (std::int32_t w : component)
+    {
+      if (level_u[w] == level_v[w])
+      {
+        level[w] = level_u[w];
+        ++count[level[w]];
+      }
+    }
+
+    // Compute the connected components of the unassigned nodes
+    rest.clear();
+    rest_offsets.assign(1, 0);
+    for (std::int32_t w : component)
+    {
+      if (level[w] != -1 or part[w] != -1)
+        continue;
+      const std::int32_t p = rest_offsets.size() - 1;
+      part[w] = p;
+      rest.push_back(w);
+      for (std::size_t j = rest_offsets.back(); j < rest.size(); ++j)
+      {
+        for (std::int32_t e : graph.links(rest[j]))
+        {
+          if (level[e] == -1 and part[e] == -1)
+          {
+            part[e] = p;
+            rest.push_back(e);
+          }
+        }
+      }
+      rest_offsets.push_back(rest.size());
+    }
+
+    // Place the components, largest first
+    parts.resize(rest_offsets.size() - 1);
+    std::iota(parts.begin(), parts.end(), 0);
+    std::stable_sort(parts.begin(), parts.end(),
+                     [&rest_offsets](std::int32_t a, std::int32_t b)
+                     {
+                       return rest_offsets[a + 1] - rest_offsets[a]
+                              > rest_offsets[b + 1] - rest_offsets[b];
+                     });
+    for (std::int32_t p : parts)
+    {
+      auto p0 = std::next(rest.begin(), rest_offsets[p]);
+      auto p1 = std::next(rest.begin(), rest_offsets[p + 1]);
+      std::for_each(p0, p1,
+                    [&](std::int32_t w)
+                    {
+                      ++inc_u[level_u[w]];
+                      ++inc_v[level_v[w]];
+                    });
+      std::int32_t h0 = 0, l0 = 0;
+      std::for_each(p0, p1,
+                    [&](std::int32_t w)
+                    {
+                      h0 = std::max(h0, count[level_u[w]] + inc_u[level_u[w]]);
+                      l0 = std::max(l0, count[level_v[w]] + inc_v[level_v[w]]);
+                    });
+      const bool use_u = h0 < l0 or (h0 == l0 and width_u <= width_v);
+      std::for_each(p0, p1,
+                    [&](std::int32_t w)
+                    {
+                      inc_u[level_u[w]] = 0;
+                      inc_v[level_v[w]] = 0;
+                      level[w] = use_u ? level_u[w] : level_v[w];
+                      ++count[level[w]];
+                      part[w] = -1;
+                    });
+    }
+
+    // Step 3: number the nodes level by level, starting from the
+    // endpoint of smaller degree
+    std::int32_t start = u;
+    if (graph.num_links(v) < graph.num_links(u))
+    {
+      start = v;
+      for (std::int32_t w : component)
+        level[w] = num_levels - 1 - level[w];
+    }
+
+    // Sort the nodes of each level by degree
+    offsets.assign(num_levels + 1, 0);
+    for (std::int32_t w : component)
+      ++offsets[level[w] + 1];
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    nodes.resize(component.size());
+    {
+      std::vector<std::int32_t> pos(offsets.begin(), offsets.end() - 1);
+      for (std::int32_t w : component)
+        nodes[pos[level[w]]++] = w;
+    }
+    for (std::int32_t l = 0; l < num_levels; ++l)
+    {
+      std::stable_sort(std::next(nodes.begin(), offsets[l]),
+                       std::next(nodes.begin(), offsets[l + 1]), degree_less);
+    }
+
+    const std::size_t begin = order.size();
+    numbered[start] = true;
+    order.push_back(start);
+    std::size_t first = begin;
+    for (std::int32_t l = 0; l < num_levels; ++l)
+    {
+      // Number the nodes in the level, taking the unnumbered links in
+      // the level of the numbered nodes by increasing degree, and the
+      // unnumbered node of smallest degree when there are none
+      std::size_t pos = first;
+      std::int32_t j = offsets[l];
+      while (true)
+      {
+        for (; pos < order.size(); ++pos)
+        {
+          const std::size_t f = order.size();
+          for (std::int32_t e : graph.links(order[pos]))
+          {
+            if (level[e] == l and !numbered[e])
+            {
+              numbered[e] = true;
+              order.push_back(e);
+            }
+          }
+          std::stable_sort(std::next(order.begin(), f), order.end(),
+                           degree_less);
+        }
+
+        while (j < offsets[l + 1] and numbered[nodes[j]])
+          ++j;
+        if (j == offsets[l + 1])
+          break;
+        numbered[nodes[j]] = true;
+        order.push_back(nodes[j]);
+      }
+
+      // Number the links in the next level of the nodes in this level
+      const std::size_t next = order.size();
+      for (std::size_t k = first; k < next; ++k)
+      {
+        const std::size_t f = order.size();
+        for (std::int32_t e : graph.links(order[k]))
+        {
+          if (level[e] == l + 1 and !numbered[e])
+          {
+            numbered[e] = true;
+            order.push_back(e);
+          }
+        }
+        std::stable_sort(std::next(order.begin(), f), order.end(),
+                         degree_less);
+      }
+      first = next;
+    }
+    assert(order.size() - begin == component.size());
+    std::reverse(std::next(order.begin(), begin), order.end());
+    reset_levels(component, level);
+  }
+
+  std::vector<int> map(n);
+  for (std::int32_t i = 0; i < n; ++i)
+    map[order[i]] = i;
+  return map;
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,65 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace dolfinx::graph
+{
+
+template <typename T>
+class AdjacencyList;
+
+/// Compute a bandwidth reducing re-ordering (map[old] -> new) of the
+/// nodes of a graph using the reverse Cuthill-McKee algorithm. Each
+/// connected component of the graph is numbered from a
+/// pseudo-peripheral node, and the components are numbered in the
+/// order of their lowest node index.
+///
+/// The re-ordering is local to the graph, and the function has the
+/// signature of the re-ordering functions used for dofmaps (see
+/// fem::create_dofmap) and can be passed directly.
+///
+/// @param[in] graph An undirected graph, i.e. node j is a link of node
+/// i if and only if node i is a link of node j
+/// @return The new index of each node
+std::vector<int> reorder_rcm(const AdjacencyList<std::int32_t>& graph);
+
+/// Compute a bandwidth reducing re-ordering (map[old] -> new) of the
+/// nodes of a graph using the Gibbs-Poole-Stockmeyer algorithm. The
+/// endpoints of a pseudo-diameter of each connected component are found
+/// first, and the two level structures rooted at the endpoints are then
+/// combined into a level structure of smaller width, which is numbered
+/// level by level. The numbering is reversed, as for reverse
+/// Cuthill-McKee.
+///
+/// This computes a re-ordering with similar bandwidth to
+/// graph::scotch::compute_gps, without calling SCOTCH.
+///
+/// @param[in] graph An undirected graph
+/// @return The new index of each node
+std::vector<int> reorder_gps(const AdjacencyList<std::int32_t>& graph);
+
+/// Compute a re-ordering (map[old] -> new) of the nodes of a graph
+/// whose nodes are already numbered in a spatially coherent order,
+/// e.g. dofs numbered by iterating over cells that are ordered along a
+/// space filling curve (see mesh::CellReordering::morton). The nodes
+/// are split into consecutive blocks, which keep their relative order,
+/// and the nodes in each block are re-ordered by reverse Cuthill-McKee
+/// applied to the subgraph of the block. This keeps the locality of the
+/// original ordering at large distances, while reducing the bandwidth
+/// within each block.
+///
+/// @param[in] graph An undirected graph
+/// @param[in] block_size The number of nodes in each block. The blocks
+/// should be small enough that the nodes of a block fit in cache.
+/// @return The new index of each node
+std::vector<int> reorder_blocked_rcm(const AdjacencyList<std::int32_t>& graph,
+                                     std::int32_t block_size = 4096);
+
+} // namespace dolfinx::graph
@@ -8,8 +8,12 @@
 #include <dolfinx/common/MPI.h>
 #include <dolfinx/common/Timer.h>
 #include <dolfinx/common/log.h>
+#include <algorithm>
+#include <array>
 #include <map>
 #include <set>
+#include <stdexcept>
+#include <type_traits>
 #include <vector>
 
 #ifdef HAS_PARMETIS
@@ -22,6 +26,22 @@ using namespace dolfinx;
 namespace
 {
 //-----------------------------------------------------------------------------
+// Return a pointer to the data in x as type X. The data is only copied
+// (into work) if the sizes of X and T differ. ParMETIS is not
+// const-correct, but does not modify the graph data.
+template <typename X, typename T>
+X* data_as(const std::vector<T>& x, std::vector<X>& work)
+{
+  static_assert(std::is_integral_v<X> and std::is_integral_v<T>);
+  if constexpr (sizeof(X) == sizeof(T))
+    return reinterpret_cast<X*>(const_cast<T*>(x.data()));
+  else
+  {
+    work.assign(x.begin(), x.end());
+    return work.data();
+  }
+}
+//-----------------------------------------------------------------------------
 template <typename T>
 std::vector<int> adaptive_repartition(MPI_Comm mpi_comm,
                                       const graph::AdjacencyList<T>& adj_graph,
@@ -125,16 +145,17 @@ std::vector<int> refine(MPI_Comm mpi_comm,
 } // namespace
 
 //-----------------------------------------------------------------------------
-graph::partition_fn graph::parmetis::partitioner(std::array<int, 3> options)
+graph::partition_fn graph::parmetis::partitioner(double imbalance,
+                                                 std::array<int, 3> options)
 {
-  return [options](MPI_Comm mpi_comm, idx_t nparts,
+  return [imbalance, options](MPI_Comm mpi_comm, idx_t nparts,
                    const graph::AdjacencyList<std::int64_t>& graph,
-                   std::int32_t, bool ghosting) {
+                   std::int32_t, bool ghosting,
+                   const xtl::span<const std::int32_t>& node_weights,
+                   const xtl::span<const std::int32_t>& edge_weights) {
     LOG(INFO) << "Compute graph partition using ParMETIS";
     common::Timer timer("Compute graph partition (ParMETIS)");
 
-    const auto& local_graph = graph.as_type<idx_t>();
-
     std::map<std::int64_t, std::vector<int>> ghost_procs;
     const int rank = dolfinx::MPI::rank(mpi_comm);
     const int size = dolfinx::MPI::size(mpi_comm);
@@ -146,33 +167,65 @@ graph::partition_fn graph::parmetis::partitioner(std::array<int, 3> options)
     // Strange weight arrays needed by ParMETIS
     idx_t ncon = 1;
 
+    if (!node_weights.empty()
+        and (int)node_weights.size() != graph.num_nodes())
+    {
+      throw std::runtime_error("Node weights size mismatch");
+    }
+    if (!edge_weights.empty()
+        and edge_weights.size() != graph.array().size())
+    {
+      throw std::runtime_error("Edge weights size mismatch");
+    }
+
+    // The weight flag must be the same on all ranks, including on ranks
+    // that have no nodes
+    std::array<int, 2> has_weights
+        = {!node_weights.empty(), !edge_weights.empty()};
+    MPI_Allreduce(MPI_IN_PLACE, has_weights.data(), 2, MPI_INT, MPI_MAX,
+                  mpi_comm);
+    std::vector<idx_t> vwgt, adjwgt;
+    if (has_weights[0])
+    {
+      vwgt.assign(node_weights.begin(), node_weights.end());
+      vwgt.resize(std::max(1, graph.num_nodes()), 1);
+    }
+    if (has_weights[1])
+    {
+      adjwgt.assign(edge_weights.begin(), edge_weights.end());
+      adjwgt.resize(std::max(std::size_t(1), graph.array().size()), 1);
+    }
+
     // Prepare remaining arguments for ParMETIS
-    idx_t* elmwgt = nullptr;
-    idx_t wgtflag = 0;
+    idx_t* elmwgt = vwgt.empty() ? nullptr : vwgt.data();
+    idx_t* edgewgt = adjwgt.empty() ? nullptr : adjwgt.data();
+    idx_t wgtflag = (has_weights[0] ? 2 : 0) + (has_weights[1] ? 1 : 0);
     idx_t edgecut = 0;
     idx_t numflag = 0;
     std::vector<real_t> tpwgts(ncon * nparts,
                                1.0 / static_cast<real_t>(nparts));
-    std::vector<real_t> ubvec(ncon, 1.05);
+    std::vector<real_t> ubvec(ncon, 1.0 + imbalance);
 
     // Communicate number of nodes between all processors
     std::vector<idx_t> node_dist(size + 1, 0);
-    const idx_t num_local_cells = local_graph.num_nodes();
+    const idx_t num_local_cells = graph.num_nodes();
     MPI_Allgather(&num_local_cells, 1, MPI::mpi_type<idx_t>(),
                   node_dist.data() + 1, 1, MPI::mpi_type<idx_t>(), mpi_comm);
     std::partial_sum(node_dist.begin(), node_dist.end(), node_dist.begin());
 
-    // Note: ParMETIS is not const-correct, so we throw away const-ness
-    // and trust ParMETIS to not modify the data.
+    // Pass the graph to ParMETIS without a copy if idx_t has the size
+    // of the graph index types. Otherwise, the graph is copied to
+    // idx_t.
+    std::vector<idx_t> xadj_work, adjncy_work;
+    idx_t* graph_offsets = data_as(graph.offsets(), xadj_work);
+    idx_t* graph_array = data_as(graph.array(), adjncy_work);
 
     // Call ParMETIS to partition graph
     common::Timer timer1("ParMETIS: call ParMETIS_V3_PartKway");
     std::vector<idx_t> part(num_local_cells);
     assert(!part.empty());
     int err = ParMETIS_V3_PartKway(
-        const_cast<idx_t*>(node_dist.data()),
-        const_cast<idx_t*>(local_graph.offsets().data()),
-        const_cast<idx_t*>(local_graph.array().data()), elmwgt, nullptr,
+        node_dist.data(), graph_offsets, graph_array, elmwgt, edgewgt,
         &wgtflag, &numflag, &ncon, &nparts, tpwgts.data(), ubvec.data(),
         _options.data(), &edgecut, part.data(), &mpi_comm);
     assert(err == METIS_OK);
@@ -197,8 +250,8 @@ graph::partition_fn graph::parmetis::partitioner(std::array<int, 3> options)
       // local indexing "i"
       for (int i = 0; i < ncells; i++)
       {
-        const auto edges = local_graph.links(i);
-        for (int j = 0; j < local_graph.num_links(i); ++j)
+        const auto edges = graph.links(i);
+        for (int j = 0; j < graph.num_links(i); ++j)
         {
           const idx_t other_cell = edges[j];
           if (other_cell < elm_begin || other_cell >= elm_end)
@@ -244,8 +297,8 @@ graph::partition_fn graph::parmetis::partitioner(std::array<int, 3> options)
       for (std::size_t p = 0; p < recv_cell_partition.size(); p += 2)
         cell_ownership[recv_cell_partition[p]] = recv_cell_partition[p + 1];
 
-      const std::vector<std::int32_t>& xadj = local_graph.offsets();
-      const std::vector<idx_t>& adjncy = local_graph.array();
+      const std::vector<std::int32_t>& xadj = graph.offsets();
+      const std::vector<std::int64_t>& adjncy = graph.array();
 
       // Generate map for where new boundary cells need to be sent
       for (std::int32_t i = 0; i < ncells; i++)
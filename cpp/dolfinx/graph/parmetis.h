@@ -7,6 +7,7 @@
 #pragma once
 
 #include "partition.h"
+#include <array>
 #include <cstdint>
 #include <dolfinx/common/MPI.h>
 #include <dolfinx/graph/AdjacencyList.h>
@@ -17,9 +18,14 @@ namespace dolfinx::graph::parmetis
 
 /// Create a graph partitioning function that uses ParMETIS
 ///
-/// param[in] options The ParMETIS option. See ParMETIS manual for
-/// details.
-graph::partition_fn partitioner(std::array<int, 3> options = {0, 0, 0});
+/// @param[in] imbalance The allowable imbalance (between 0 and 1). The
+/// smaller value the more balanced the partitioning must be.
+/// @param[in] options The ParMETIS options, i.e. {use options, debug
+/// level, random number generator seed}. The debug level and seed are
+/// used only if the first option is 1. See ParMETIS manual for details.
+/// @return A graph partitioning function
+graph::partition_fn partitioner(double imbalance = 0.05,
+                                std::array<int, 3> options = {0, 0, 0});
 
 #endif
 } // namespace dolfinx::graph::parmetis
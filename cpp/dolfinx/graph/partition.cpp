@@ -7,10 +7,16 @@
 #include "partition.h"
 #include "scotch.h"
 #include <algorithm>
+#include <array>
+#include <dolfinx/common/Arena.h>
 #include <dolfinx/common/IndexMap.h>
 #include <dolfinx/common/log.h>
+#include <dolfinx/common/timing.h>
 #include <dolfinx/graph/AdjacencyList.h>
+#include <iterator>
 #include <memory>
+#include <numeric>
+#include <set>
 #include <unordered_map>
 
 using namespace dolfinx;
@@ -19,10 +25,517 @@ using namespace dolfinx;
 graph::AdjacencyList<std::int32_t>
 graph::partition_graph(const MPI_Comm comm, int nparts,
                        const AdjacencyList<std::int64_t>& local_graph,
-                       std::int32_t num_ghost_nodes, bool ghosting)
+                       std::int32_t num_ghost_nodes, bool ghosting,
+                       const xtl::span<const std::int32_t>& node_weights,
+                       const xtl::span<const std::int32_t>& edge_weights)
 {
   return graph::scotch::partitioner()(comm, nparts, local_graph,
-                                      num_ghost_nodes, ghosting);
+                                      num_ghost_nodes, ghosting, node_weights,
+                                      edge_weights);
+}
+//-----------------------------------------------------------------------------
+graph::partition_fn
+graph::create_hierarchical_partitioner(const graph::partition_fn& partfn)
+{
+  return [partfn](MPI_Comm comm, int nparts,
+                  const AdjacencyList<std::int64_t>& graph,
+                  std::int32_t num_ghost_nodes, bool ghosting,
+                  const xtl::span<const std::int32_t>& node_weights,
+                  const xtl::span<const std::int32_t>& edge_weights)
+             -> graph::AdjacencyList<std::int32_t>
+  {
+    common::Timer timer("Compute hierarchical graph partition");
+    const int size = dolfinx::MPI::size(comm);
+    const int rank = dolfinx::MPI::rank(comm);
+
+    // Group the ranks by compute node. The ranks of a node communicator
+    // are in the order of the ranks in comm.
+    MPI_Comm node_comm;
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL,
+                        &node_comm);
+    dolfinx::MPI::Comm _node_comm(node_comm, false);
+    const int node_rank = dolfinx::MPI::rank(node_comm);
+    const int leader = node_rank == 0 ? 1 : 0;
+    int num_nodes = 0;
+    MPI_Allreduce(&leader, &num_nodes, 1, MPI_INT, MPI_SUM, comm);
+    if (nparts != size or num_nodes == 1 or num_nodes == size)
+    {
+      return partfn(comm, nparts, graph, num_ghost_nodes, ghosting,
+                    node_weights, edge_weights);
+    }
+
+    // Compute the index of each compute node and its ranks
+    int node = 0;
+    MPI_Exscan(&leader, &node, 1, MPI_INT, MPI_SUM, comm);
+    if (rank == 0)
+      node = 0;
+    MPI_Bcast(&node, 1, MPI_INT, 0, node_comm);
+    std::vector<int> rank_node(size);
+    MPI_Allgather(&node, 1, MPI_INT, rank_node.data(), 1, MPI_INT, comm);
+    std::vector<std::vector<int>> node_ranks(num_nodes);
+    for (int r = 0; r < size; ++r)
+      node_ranks[rank_node[r]].push_back(r);
+
+    std::array<int, 2> has_weights
+        = {!node_weights.empty(), !edge_weights.empty()};
+    MPI_Allreduce(MPI_IN_PLACE, has_weights.data(), 2, MPI_INT, MPI_MAX,
+                  comm);
+
+    // Partition the graph into one part per compute node
+    const std::int32_t num_local = graph.num_nodes();
+    std::vector<std::int32_t> node_part(num_local);
+    {
+      const AdjacencyList<std::int32_t> part
+          = partfn(comm, num_nodes, graph, num_ghost_nodes, false,
+                   node_weights, edge_weights);
+      for (std::int32_t i = 0; i < num_local; ++i)
+        node_part[i] = part.links(i)[0];
+    }
+
+    // Number the graph nodes of each part contiguously, in the order of
+    // the ranks and of the nodes on each rank
+    std::vector<std::int64_t> part_offset(num_nodes, 0),
+        part_count(num_nodes, 0), part_size(num_nodes);
+    for (std::int32_t p : node_part)
+      ++part_count[p];
+    MPI_Exscan(part_count.data(), part_offset.data(), num_nodes, MPI_INT64_T,
+               MPI_SUM, comm);
+    if (rank == 0)
+      std::fill(part_offset.begin(), part_offset.end(), 0);
+    MPI_Allreduce(part_count.data(), part_size.data(), num_nodes,
+                  MPI_INT64_T, MPI_SUM, comm);
+    xt::xtensor<std::int64_t, 2> part_index({std::size_t(num_local), 2});
+    for (std::int32_t i = 0; i < num_local; ++i)
+    {
+      part_index(i, 0) = node_part[i];
+      part_index(i, 1) = part_offset[node_part[i]]++;
+    }
+
+    // Fetch the part and the part index of the off-rank neighbours
+    const std::int64_t offset
+        = dolfinx::MPI::global_offset(comm, num_local, true);
+    std::vector<std::int64_t> ghosts;
+    std::copy_if(graph.array().begin(), graph.array().end(),
+                 std::back_inserter(ghosts),
+                 [offset, num_local](auto n)
+                 { return n < offset or n >= offset + num_local; });
+    std::sort(ghosts.begin(), ghosts.end());
+    ghosts.erase(std::unique(ghosts.begin(), ghosts.end()), ghosts.end());
+    const xt::xtensor<std::int64_t, 2> ghost_part_index
+        = build::distribute_data<std::int64_t>(comm, ghosts, part_index);
+    auto get_part_index = [&](std::int64_t n) -> std::array<std::int64_t, 2>
+    {
+      if (n >= offset and n < offset + num_local)
+        return {part_index(n - offset, 0), part_index(n - offset, 1)};
+      auto it = std::lower_bound(ghosts.begin(), ghosts.end(), n);
+      const std::size_t pos = std::distance(ghosts.begin(), it);
+      return {ghost_part_index(pos, 0), ghost_part_index(pos, 1)};
+    };
+
+    // Send each graph node, with its weight and its edges within the
+    // part, to a rank of the compute node of the part. Each record is
+    // [index, weight, num_edges, (edge, [edge weight])...].
+    std::vector<std::vector<std::int64_t>> send_data(size);
+    std::vector<std::vector<std::int32_t>> send_nodes(size);
+    std::size_t e = 0;
+    for (std::int32_t i = 0; i < num_local; ++i)
+    {
+      const std::int32_t p = node_part[i];
+      const std::int64_t index = part_index(i, 1);
+      const int dest = node_ranks[p][dolfinx::MPI::index_owner(
+          node_ranks[p].size(), index, part_size[p])];
+      send_nodes[dest].push_back(i);
+      std::vector<std::int64_t>& data = send_data[dest];
+      data.push_back(index);
+      data.push_back(node_weights.empty() ? 1 : node_weights[i]);
+      const std::size_t num_edges_pos = data.size();
+      data.push_back(0);
+      for (std::int64_t n : graph.links(i))
+      {
+        if (const auto [pn, index_n] = get_part_index(n); pn == p)
+        {
+          data.push_back(index_n);
+          if (has_weights[1])
+            data.push_back(edge_weights.empty() ? 1 : edge_weights[e]);
+          ++data[num_edges_pos];
+        }
+        ++e;
+      }
+    }
+    const AdjacencyList<std::int64_t> recv_data = dolfinx::MPI::all_to_all(
+        comm, AdjacencyList<std::int64_t>(send_data));
+
+    // Find the record of each graph node of the part on this rank
+    const int num_node_ranks = node_ranks[node].size();
+    const std::array<std::int64_t, 2> range = dolfinx::MPI::local_range(
+        node_rank, part_size[node], num_node_ranks);
+    const std::int32_t num_sub = range[1] - range[0];
+    const std::vector<std::int64_t>& buffer = recv_data.array();
+    const int record_stride = has_weights[1] ? 2 : 1;
+    std::vector<std::size_t> records(num_sub);
+    std::vector<std::vector<std::int32_t>> recv_nodes(size);
+    for (int r = 0; r < size; ++r)
+    {
+      std::size_t pos = recv_data.offsets()[r];
+      while (pos < std::size_t(recv_data.offsets()[r + 1]))
+      {
+        const std::int32_t i = buffer[pos] - range[0];
+        records[i] = pos;
+        recv_nodes[r].push_back(i);
+        pos += 3 + record_stride * buffer[pos + 2];
+      }
+    }
+
+    // Build the subgraph of the part on this rank, and partition it
+    // across the ranks of the compute node
+    std::vector<std::int64_t> sub_edges;
+    std::vector<std::int32_t> sub_offsets = {0};
+    std::vector<std::int32_t> sub_node_weights(num_sub), sub_edge_weights;
+    for (std::int32_t i = 0; i < num_sub; ++i)
+    {
+      const std::size_t pos = records[i];
+      sub_node_weights[i] = buffer[pos + 1];
+      for (std::int64_t j = 0; j < buffer[pos + 2]; ++j)
+      {
+        sub_edges.push_back(buffer[pos + 3 + record_stride * j]);
+        if (has_weights[1])
+          sub_edge_weights.push_back(buffer[pos + 4 + record_stride * j]);
+      }
+      sub_offsets.push_back(sub_edges.size());
+    }
+    std::vector<std::int64_t> sub_ghosts;
+    std::copy_if(sub_edges.begin(), sub_edges.end(),
+                 std::back_inserter(sub_ghosts),
+                 [&range](auto n) { return n < range[0] or n >= range[1]; });
+    std::sort(sub_ghosts.begin(), sub_ghosts.end());
+    sub_ghosts.erase(std::unique(sub_ghosts.begin(), sub_ghosts.end()),
+                     sub_ghosts.end());
+    const AdjacencyList<std::int32_t> sub_part = partfn(
+        node_comm, num_node_ranks,
+        AdjacencyList<std::int64_t>(std::move(sub_edges),
+                                    std::move(sub_offsets)),
+        sub_ghosts.size(), false,
+        has_weights[0] ? xtl::span<const std::int32_t>(sub_node_weights)
+                       : xtl::span<const std::int32_t>(),
+        has_weights[1] ? xtl::span<const std::int32_t>(sub_edge_weights)
+                       : xtl::span<const std::int32_t>());
+
+    // Return the destination rank to the rank that sent the graph node
+    std::vector<std::vector<std::int32_t>> send_dest(size);
+    for (int r = 0; r < size; ++r)
+      for (std::int32_t i : recv_nodes[r])
+        send_dest[r].push_back(node_ranks[node][sub_part.links(i)[0]]);
+    const AdjacencyList<std::int32_t> recv_dest = dolfinx::MPI::all_to_all(
+        comm, AdjacencyList<std::int32_t>(send_dest));
+    std::vector<std::int32_t> dest(num_local);
+    for (int r = 0; r < size; ++r)
+    {
+      auto d = recv_dest.links(r);
+      for (std::size_t j = 0; j < d.size(); ++j)
+        dest[send_nodes[r][j]] = d[j];
+    }
+
+    if (!ghosting)
+      return build_adjacency_list<std::int32_t>(std::move(dest), 1);
+
+    // Add the destination of the neighbours as ghost destinations, with
+    // the owning rank first
+    xt::xtensor<std::int32_t, 2> _dest({std::size_t(num_local), 1});
+    std::copy(dest.begin(), dest.end(), _dest.begin());
+    const xt::xtensor<std::int32_t, 2> ghost_dest
+        = build::distribute_data<std::int32_t>(comm, ghosts, _dest);
+    std::vector<std::int32_t> dests, offsets = {0};
+    for (std::int32_t i = 0; i < num_local; ++i)
+    {
+      const std::size_t begin = dests.size();
+      dests.push_back(dest[i]);
+      for (std::int64_t n : graph.links(i))
+      {
+        std::int32_t d;
+        if (n >= offset and n < offset + num_local)
+          d = dest[n - offset];
+        else
+        {
+          auto it = std::lower_bound(ghosts.begin(), ghosts.end(), n);
+          d = ghost_dest(std::distance(ghosts.begin(), it), 0);
+        }
+        if (std::find(std::next(dests.begin(), begin), dests.end(), d)
+            == dests.end())
+        {
+          dests.push_back(d);
+        }
+      }
+      offsets.push_back(dests.size());
+    }
+
+    return AdjacencyList<std::int32_t>(std::move(dests), std::move(offsets));
+  };
+}
+//-----------------------------------------------------------------------------
+graph::partition_fn
+graph::create_diffusion_partitioner(const graph::partition_fn& partfn,
+                                    double imbalance, int max_iterations)
+{
+  return [partfn, imbalance,
+          max_iterations](MPI_Comm comm, int nparts,
+                          const AdjacencyList<std::int64_t>& graph,
+                          std::int32_t num_ghost_nodes, bool ghosting,
+                          const xtl::span<const std::int32_t>& node_weights,
+                          const xtl::span<const std::int32_t>& edge_weights)
+             -> graph::AdjacencyList<std::int32_t>
+  {
+    common::Timer timer("Compute diffusion graph re-partition");
+    const int size = dolfinx::MPI::size(comm);
+    const int rank = dolfinx::MPI::rank(comm);
+    if (nparts != size)
+    {
+      return partfn(comm, nparts, graph, num_ghost_nodes, ghosting,
+                    node_weights, edge_weights);
+    }
+
+    const std::int32_t num_local = graph.num_nodes();
+    if (!node_weights.empty() and (int)node_weights.size() != num_local)
+      throw std::runtime_error("Node weights size mismatch");
+
+    // Get the range of the graph nodes on each rank
+    std::vector<std::int64_t> rank_offsets(size + 1, 0);
+    const std::int64_t num_local64 = num_local;
+    MPI_Allgather(&num_local64, 1, MPI_INT64_T, rank_offsets.data() + 1, 1,
+                  MPI_INT64_T, comm);
+    std::partial_sum(rank_offsets.begin(), rank_offsets.end(),
+                     rank_offsets.begin());
+    const std::int64_t offset = rank_offsets[rank];
+    auto owner = [&rank_offsets](std::int64_t n) -> int
+    {
+      return std::distance(rank_offsets.begin(),
+                           std::upper_bound(rank_offsets.begin(),
+                                            rank_offsets.end(), n))
+             - 1;
+    };
+
+    // Get the off-rank neighbours of the graph nodes and their ranks,
+    // which are the neighbours of this rank in the graph of the parts
+    std::vector<std::int64_t> ghosts;
+    std::copy_if(graph.array().begin(), graph.array().end(),
+                 std::back_inserter(ghosts),
+                 [offset, num_local](auto n)
+                 { return n < offset or n >= offset + num_local; });
+    std::sort(ghosts.begin(), ghosts.end());
+    ghosts.erase(std::unique(ghosts.begin(), ghosts.end()), ghosts.end());
+    std::vector<int> neighbors(ghosts.size());
+    std::transform(ghosts.begin(), ghosts.end(), neighbors.begin(), owner);
+    neighbors.erase(std::unique(neighbors.begin(), neighbors.end()),
+                    neighbors.end());
+    const std::size_t num_neighbors = neighbors.size();
+
+    MPI_Comm neighbor_comm;
+    MPI_Dist_graph_create_adjacent(comm, neighbors.size(), neighbors.data(),
+                                   MPI_UNWEIGHTED, neighbors.size(),
+                                   neighbors.data(), MPI_UNWEIGHTED,
+                                   MPI_INFO_NULL, false, &neighbor_comm);
+    const dolfinx::MPI::Comm _neighbor_comm(neighbor_comm, false);
+
+    // Compute the load to move to each neighbouring part by first-order
+    // diffusion on the graph of the parts. In each iteration the load
+    // a(l_i - l_j) moves from part i to part j, with a = 1 / (max(d_i,
+    // d_j) + 1) and d the number of neighbours of a part, until the
+    // largest load is within the imbalance tolerance. The buffers have
+    // an extra entry as OpenMPI fails for null pointers.
+    double load = node_weights.empty()
+                      ? num_local
+                      : std::accumulate(node_weights.begin(),
+                                        node_weights.end(), 0.0);
+    double mean_load = 0.0;
+    MPI_Allreduce(&load, &mean_load, 1, MPI_DOUBLE, MPI_SUM, comm);
+    mean_load /= size;
+    const int degree = num_neighbors;
+    std::vector<int> neighbor_degree(num_neighbors + 1);
+    MPI_Neighbor_allgather(&degree, 1, MPI_INT, neighbor_degree.data(), 1,
+                           MPI_INT, _neighbor_comm.comm());
+    std::vector<double> flow(num_neighbors + 1, 0.0);
+    std::vector<double> neighbor_load(num_neighbors + 1);
+    for (int iter = 0; iter < max_iterations; ++iter)
+    {
+      double max_load = 0.0;
+      MPI_Allreduce(&load, &max_load, 1, MPI_DOUBLE, MPI_MAX, comm);
+      if (max_load <= imbalance * mean_load)
+        break;
+
+      MPI_Neighbor_allgather(&load, 1, MPI_DOUBLE, neighbor_load.data(), 1,
+                             MPI_DOUBLE, _neighbor_comm.comm());
+      double dload = 0.0;
+      for (std::size_t j = 0; j < num_neighbors; ++j)
+      {
+        const double f = (load - neighbor_load[j])
+                         / (std::max(degree, neighbor_degree[j]) + 1);
+        flow[j] += f;
+        dload += f;
+      }
+      load -= dload;
+    }
+
+    // Move graph nodes to the neighbouring parts with a positive flow,
+    // starting with the largest flow. The nodes are taken in
+    // breadth-first order from the nodes with an edge to the
+    // neighbouring part, so that the moved nodes are next to the
+    // neighbouring part.
+    std::vector<std::int32_t> dest(num_local, rank);
+    std::vector<std::size_t> order(num_neighbors);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+              [&flow](auto a, auto b) { return flow[a] > flow[b]; });
+    std::vector<std::size_t> visited(num_local, num_neighbors);
+    std::vector<std::int32_t> queue;
+    for (std::size_t j : order)
+    {
+      double remaining = flow[j];
+      if (remaining <= 0.0)
+        break;
+
+      auto in_part_j = [&](std::int64_t n)
+      {
+        return (n < offset or n >= offset + num_local)
+               and owner(n) == neighbors[j];
+      };
+      queue.clear();
+      for (std::int32_t i = 0; i < num_local; ++i)
+      {
+        if (dest[i] != rank)
+          continue;
+        auto links = graph.links(i);
+        if (std::any_of(links.begin(), links.end(), in_part_j))
+        {
+          visited[i] = j;
+          queue.push_back(i);
+        }
+      }
+
+      for (std::size_t head = 0; head < queue.size() and remaining > 0.0;
+           ++head)
+      {
+        const std::int32_t i = queue[head];
+        const double w = node_weights.empty() ? 1.0 : node_weights[i];
+        if (w > 2.0 * remaining)
+          continue;
+
+        dest[i] = neighbors[j];
+        remaining -= w;
+        for (std::int64_t n : graph.links(i))
+        {
+          if (n >= offset and n < offset + num_local)
+          {
+            const std::int32_t k = n - offset;
+            if (dest[k] == rank and visited[k] != j)
+            {
+              visited[k] = j;
+              queue.push_back(k);
+            }
+          }
+        }
+      }
+    }
+
+    if (!ghosting)
+      return build_adjacency_list<std::int32_t>(std::move(dest), 1);
+
+    // Add the destination of the neighbours as ghost destinations, with
+    // the owning rank first
+    xt::xtensor<std::int32_t, 2> _dest({std::size_t(num_local), 1});
+    std::copy(dest.begin(), dest.end(), _dest.begin());
+    const xt::xtensor<std::int32_t, 2> ghost_dest
+        = build::distribute_data<std::int32_t>(comm, ghosts, _dest);
+    std::vector<std::int32_t> dests, offsets = {0};
+    for (std::int32_t i = 0; i < num_local; ++i)
+    {
+      const std::size_t begin = dests.size();
+      dests.push_back(dest[i]);
+      for (std::int64_t n : graph.links(i))
+      {
+        std::int32_t d;
+        if (n >= offset and n < offset + num_local)
+          d = dest[n - offset];
+        else
+        {
+          auto it = std::lower_bound(ghosts.begin(), ghosts.end(), n);
+          d = ghost_dest(std::distance(ghosts.begin(), it), 0);
+        }
+        if (std::find(std::next(dests.begin(), begin), dests.end(), d)
+            == dests.end())
+        {
+          dests.push_back(d);
+        }
+      }
+      offsets.push_back(dests.size());
+    }
+
+    return AdjacencyList<std::int32_t>(std::move(dests), std::move(offsets));
+  };
+}
+//-----------------------------------------------------------------------------
+Table graph::compute_partition_quality(
+    MPI_Comm comm, int nparts, const AdjacencyList<std::int64_t>& local_graph,
+    const AdjacencyList<std::int32_t>& dest,
+    const xtl::span<const std::int32_t>& node_weights)
+{
+  common::Timer timer("Compute partition quality");
+  const std::int32_t num_nodes = local_graph.num_nodes();
+  assert(dest.num_nodes() == num_nodes);
+  assert(node_weights.empty() or (int)node_weights.size() == num_nodes);
+
+  // Part of each node
+  xt::xtensor<std::int32_t, 2> part({std::size_t(num_nodes), 1});
+  for (std::int32_t i = 0; i < num_nodes; ++i)
+    part(i, 0) = dest.links(i)[0];
+
+  // Fetch the part of the neighbours of the nodes
+  std::vector<std::int64_t> nbrs(local_graph.array());
+  std::sort(nbrs.begin(), nbrs.end());
+  nbrs.erase(std::unique(nbrs.begin(), nbrs.end()), nbrs.end());
+  const xt::xtensor<std::int32_t, 2> nbr_part
+      = build::distribute_data<std::int32_t>(comm, nbrs, part);
+
+  // Count the cut edges, and the other parts that each node is adjacent
+  // to
+  std::array<std::int64_t, 2> local_counts = {0, 0};
+  std::vector<std::int32_t> parts;
+  for (std::int32_t i = 0; i < num_nodes; ++i)
+  {
+    parts.clear();
+    for (std::int64_t j : local_graph.links(i))
+    {
+      auto it = std::lower_bound(nbrs.begin(), nbrs.end(), j);
+      assert(it != nbrs.end() and *it == j);
+      const std::int32_t q = nbr_part(std::distance(nbrs.begin(), it), 0);
+      if (q != part(i, 0))
+        parts.push_back(q);
+    }
+    local_counts[0] += parts.size();
+    std::sort(parts.begin(), parts.end());
+    auto it = std::unique(parts.begin(), parts.end());
+    local_counts[1] += std::distance(parts.begin(), it);
+  }
+  std::array<std::int64_t, 2> counts;
+  MPI_Allreduce(local_counts.data(), counts.data(), 2, MPI_INT64_T, MPI_SUM,
+                comm);
+
+  // Weight of each part
+  std::vector<std::int64_t> weights(nparts, 0);
+  for (std::int32_t i = 0; i < num_nodes; ++i)
+    weights[part(i, 0)] += node_weights.empty() ? 1 : node_weights[i];
+  MPI_Allreduce(MPI_IN_PLACE, weights.data(), nparts, MPI_INT64_T, MPI_SUM,
+                comm);
+  const auto [min, max] = std::minmax_element(weights.begin(), weights.end());
+  const double mean
+      = std::accumulate(weights.begin(), weights.end(), 0.0) / nparts;
+
+  // Each cut edge is counted from both of its nodes
+  Table table("Partition quality");
+  table.set("Edge cut", "value", counts[0] / 2.0);
+  table.set("Communication volume", "value", double(counts[1]));
+  table.set("Max part weight", "value", double(*max));
+  table.set("Min part weight", "value", double(*min));
+  table.set("Imbalance", "value", mean > 0.0 ? *max / mean : 1.0);
+  return table;
 }
 //-----------------------------------------------------------------------------
 std::tuple<graph::AdjacencyList<std::int64_t>, std::vector<int>,
@@ -36,55 +549,95 @@ graph::build::distribute(MPI_Comm comm,
   assert(list.num_nodes() == (int)destinations.num_nodes());
   const std::int64_t offset_global
       = dolfinx::MPI::global_offset(comm, list.num_nodes(), true);
-  const int size = dolfinx::MPI::size(comm);
 
-  // Compute number of links to send to each process
-  std::vector<int> num_per_dest_send(size, 0);
+  // Get the (sorted) ranks that nodes are sent to
+  std::vector<int> dest(destinations.array().begin(),
+                        destinations.array().end());
+  std::sort(dest.begin(), dest.end());
+  dest.erase(std::unique(dest.begin(), dest.end()), dest.end());
+
+  // Get the ranks that nodes are received from, and create the
+  // neighbourhood communicator. For large communicators the source
+  // ranks are computed by sparse (NBX) communication, see
+  // dolfinx::MPI::compute_graph_edges.
+  std::vector<int> sources = dolfinx::MPI::compute_graph_edges(
+      comm, std::set<int>(dest.begin(), dest.end()));
+  std::sort(sources.begin(), sources.end());
+  MPI_Comm neighbor_comm;
+  MPI_Dist_graph_create_adjacent(comm, sources.size(), sources.data(),
+                                 MPI_UNWEIGHTED, dest.size(), dest.data(),
+                                 MPI_UNWEIGHTED, MPI_INFO_NULL, false,
+                                 &neighbor_comm);
+  const dolfinx::MPI::Comm _neighbor_comm(neighbor_comm, false);
+
+  // Compute number of links to send to each destination, adding '1' to
+  // handle the empty case as OpenMPI fails for null pointers
+  auto neighbor = [&dest](int r)
+  { return std::lower_bound(dest.begin(), dest.end(), r) - dest.begin(); };
+  std::vector<int> num_per_dest_send(dest.size() + 1, 0);
   for (int i = 0; i < destinations.num_nodes(); ++i)
   {
     int list_num_links = list.num_links(i) + 3;
     auto dests = destinations.links(i);
     for (std::int32_t d : dests)
-      num_per_dest_send[d] += list_num_links;
+      num_per_dest_send[neighbor(d)] += list_num_links;
   }
 
   // Compute send array displacements
-  std::vector<int> disp_send(size + 1, 0);
-  std::partial_sum(num_per_dest_send.begin(), num_per_dest_send.end(),
-                   disp_send.begin() + 1);
+  std::vector<int> disp_send(dest.size() + 1, 0);
+  std::partial_sum(num_per_dest_send.begin(),
+                   std::prev(num_per_dest_send.end()), disp_send.begin() + 1);
 
   // Send/receive number of items to communicate
-  std::vector<int> num_per_dest_recv(size, 0);
-  MPI_Alltoall(num_per_dest_send.data(), 1, MPI_INT, num_per_dest_recv.data(),
-               1, MPI_INT, comm);
+  const bool log = dolfinx::communication_log();
+  const double t0 = log ? MPI_Wtime() : 0.0;
+  std::vector<int> num_per_dest_recv(sources.size() + 1, 0);
+  MPI_Neighbor_alltoall(num_per_dest_send.data(), 1, MPI_INT,
+                        num_per_dest_recv.data(), 1, MPI_INT,
+                        _neighbor_comm.comm());
 
   // Compute receive array displacements
-  std::vector<int> disp_recv(size + 1, 0);
-  std::partial_sum(num_per_dest_recv.begin(), num_per_dest_recv.end(),
-                   disp_recv.begin() + 1);
+  std::vector<int> disp_recv(sources.size() + 1, 0);
+  std::partial_sum(num_per_dest_recv.begin(),
+                   std::prev(num_per_dest_recv.end()), disp_recv.begin() + 1);
 
-  // Prepare send buffer
+  // Prepare send buffer, with the data for each destination packed
+  // contiguously
   std::vector<int> offset = disp_send;
   std::vector<std::int64_t> data_send(disp_send.back());
   for (int i = 0; i < list.num_nodes(); ++i)
   {
     auto links = list.links(i);
     auto dests = destinations.links(i);
-    for (auto dest : dests)
+    for (auto d : dests)
     {
-      data_send[offset[dest]++] = dests[0];
-      data_send[offset[dest]++] = i + offset_global;
-      data_send[offset[dest]++] = links.size();
+      int& pos = offset[neighbor(d)];
+      data_send[pos++] = dests[0];
+      data_send[pos++] = i + offset_global;
+      data_send[pos++] = links.size();
       for (std::size_t k = 0; k < links.size(); ++k)
-        data_send[offset[dest]++] = links[k];
+        data_send[pos++] = links[k];
     }
   }
 
-  // Send/receive data
-  std::vector<std::int64_t> data_recv(disp_recv.back());
-  MPI_Alltoallv(data_send.data(), num_per_dest_send.data(), disp_send.data(),
-                MPI_INT64_T, data_recv.data(), num_per_dest_recv.data(),
-                disp_recv.data(), MPI_INT64_T, comm);
+  // Send/receive data. The receive buffer is a temporary of the
+  // arena, the send buffer is freed before the lists are unpacked.
+  common::ArenaScope scope;
+  std::pmr::vector<std::int64_t> data_recv(disp_recv.back(),
+                                           scope.resource());
+  MPI_Neighbor_alltoallv(data_send.data(), num_per_dest_send.data(),
+                         disp_send.data(), MPI_INT64_T, data_recv.data(),
+                         num_per_dest_recv.data(), disp_recv.data(),
+                         MPI_INT64_T, _neighbor_comm.comm());
+  if (log)
+  {
+    dolfinx::register_communication(
+        "graph::build::distribute", sources.size(),
+        std::count_if(num_per_dest_recv.begin(),
+                      std::prev(num_per_dest_recv.end()),
+                      [](int n) { return n > 0; }),
+        data_recv.size() * sizeof(std::int64_t), MPI_Wtime() - t0);
+  }
 
   // Force memory to be freed
   std::vector<int>().swap(num_per_dest_send);
@@ -104,9 +657,10 @@ graph::build::distribute(MPI_Comm comm,
   std::vector<int> ghost_src;
   std::vector<int> ghost_index_owner;
 
-  for (std::size_t p = 0; p < disp_recv.size() - 1; ++p)
+  for (std::size_t n = 0; n < sources.size(); ++n)
   {
-    for (int i = disp_recv[p]; i < disp_recv[p + 1];)
+    const int p = sources[n];
+    for (int i = disp_recv[n]; i < disp_recv[n + 1];)
     {
       if (data_recv[i] == mpi_rank)
       {
@@ -9,10 +9,13 @@
 #include <algorithm>
 #include <cstdint>
 #include <dolfinx/common/MPI.h>
+#include <dolfinx/common/Table.h>
 #include <dolfinx/common/Timer.h>
 #include <dolfinx/graph/AdjacencyList.h>
 #include <functional>
 #include <mpi.h>
+#include <numeric>
+#include <set>
 #include <utility>
 #include <vector>
 #include <xtl/xspan.hpp>
@@ -30,10 +33,18 @@ namespace dolfinx::graph
 /// local_graph that are owned on other processes
 /// @param ghosting Flag to enable ghosting of the output node
 /// distribution
+/// @param node_weights Weight of each node in @p local_graph. If empty,
+/// all nodes have unit weight.
+/// @param edge_weights Weight of each edge in @p local_graph, in the
+/// same order as `local_graph.array()`. The weights must be symmetric,
+/// i.e. the edge (i, j) has the same weight on the ranks owning i and
+/// j. If empty, all edges have unit weight.
 /// @return Destination rank for each input node
 using partition_fn = std::function<graph::AdjacencyList<std::int32_t>(
     MPI_Comm comm, int nparts, const AdjacencyList<std::int64_t>& local_graph,
-    std::int32_t num_ghost_nodes, bool ghosting)>;
+    std::int32_t num_ghost_nodes, bool ghosting,
+    const xtl::span<const std::int32_t>& node_weights,
+    const xtl::span<const std::int32_t>& edge_weights)>;
 
 /// Partition graph across processes using  the default graph
 /// partitioner
@@ -45,11 +56,89 @@ using partition_fn = std::function<graph::AdjacencyList<std::int32_t>(
 /// local_graph that are owned on other processes
 /// @param ghosting Flag to enable ghosting of the output node
 /// distribution
+/// @param node_weights Weight of each node in @p local_graph (unit
+/// weights if empty)
+/// @param edge_weights Weight of each edge in @p local_graph (unit
+/// weights if empty)
 /// @return Destination rank for each input node
 AdjacencyList<std::int32_t>
 partition_graph(const MPI_Comm comm, int nparts,
                 const AdjacencyList<std::int64_t>& local_graph,
-                std::int32_t num_ghost_nodes, bool ghosting);
+                std::int32_t num_ghost_nodes, bool ghosting,
+                const xtl::span<const std::int32_t>& node_weights = {},
+                const xtl::span<const std::int32_t>& edge_weights = {});
+
+/// Create a graph partitioner that is aware of the compute nodes
+/// (shared-memory domains) of the MPI communicator. The graph is first
+/// partitioned into one part per compute node, and the part of each
+/// compute node is then partitioned across the ranks of the node using
+/// a communicator of the node ranks. Neighbouring parts are therefore
+/// mostly on the same compute node, and most of the ghost exchange is
+/// between ranks on the same node.
+///
+/// The computed partition is balanced if all compute nodes have the
+/// same number of ranks. The partitioner falls back to @p partfn if
+/// the number of parts is not the communicator size, or if there is
+/// one compute node or one rank per compute node.
+///
+/// @param[in] partfn The graph partitioner used at both levels
+/// @return A graph partitioning function
+partition_fn
+create_hierarchical_partitioner(const partition_fn& partfn = &partition_graph);
+
+/// Create a graph re-partitioner that starts from the current
+/// distribution of the graph, i.e. the nodes on a rank are in the part
+/// of the rank, and moves nodes between neighbouring parts to reduce
+/// the load imbalance. The load to move between neighbouring parts is
+/// computed by first-order diffusion on the graph of the parts, and
+/// the moved nodes are taken from next to the neighbouring part. Only
+/// the imbalance is moved, so the partitioner is cheap and moves little
+/// data when the graph is close to balanced, e.g. after mesh
+/// refinement.
+///
+/// The quality of the partition (the number of cut edges) is not
+/// improved. The partitioner falls back to @p partfn if the number of
+/// parts is not the communicator size.
+///
+/// @param[in] partfn The graph partitioner used if the number of parts
+/// is not the communicator size
+/// @param[in] imbalance The tolerated ratio of the largest load of a
+/// part to the mean load
+/// @param[in] max_iterations The maximum number of diffusion
+/// iterations
+/// @return A graph partitioning function
+partition_fn
+create_diffusion_partitioner(const partition_fn& partfn = &partition_graph,
+                             double imbalance = 1.05,
+                             int max_iterations = 100);
+
+/// Compute quality measures of a partition of a distributed graph,
+/// e.g. to compare graph partitioners before distributing a mesh. The
+/// global index of each node is assumed to be the local index plus the
+/// offset for this rank, and the graph must be symmetric. The table has
+/// the (global) values:
+///
+/// - "Edge cut": the number of edges between nodes in different parts
+/// - "Communication volume": the sum over the nodes of the number of
+///   other parts that a node is adjacent to, i.e. the number of ghost
+///   copies of the nodes for one layer of ghosts
+/// - "Max part weight" and "Min part weight"
+/// - "Imbalance": the ratio of the largest part weight to the mean
+///
+/// @note Collective
+/// @param[in] comm MPI Communicator that the graph is distributed across
+/// @param[in] nparts Number of parts
+/// @param[in] local_graph Node connectivity graph
+/// @param[in] dest Destination rank for each node in @p local_graph, as
+/// computed by a graph::partition_fn. The first destination of a node
+/// is its part.
+/// @param[in] node_weights Weight of each node in @p local_graph (unit
+/// weights if empty)
+/// @return Table with the quality measures (column "value")
+Table compute_partition_quality(
+    MPI_Comm comm, int nparts, const AdjacencyList<std::int64_t>& local_graph,
+    const AdjacencyList<std::int32_t>& dest,
+    const xtl::span<const std::int32_t>& node_weights = {});
 
 /// Tools for distributed graphs
 ///
@@ -58,7 +147,9 @@ namespace build
 {
 /// Distribute adjacency list nodes to destination ranks. The global
 /// index of each node is assumed to be the local index plus the
-/// offset for this rank.
+/// offset for this rank. The data is exchanged over a neighbourhood
+/// communicator of the destination and source ranks, with the nodes
+/// for each destination packed into one message.
 ///
 /// @param[in] comm MPI Communicator
 /// @param[in] list The adjacency list to distribute
@@ -84,7 +175,9 @@ compute_ghost_indices(MPI_Comm comm,
                       const xtl::span<const std::int64_t>& global_indices,
                       const xtl::span<const int>& ghost_owners);
 
-/// Distribute data to process ranks where it it required
+/// Distribute data to process ranks where it it required. The
+/// requests and the data are exchanged over neighbourhood
+/// communicators of the owning and requesting ranks.
 ///
 /// @param[in] comm The MPI communicator
 /// @param[in] indices Global indices of the data required by this
@@ -147,8 +240,7 @@ build::distribute_data(MPI_Comm comm,
   std::partial_sum(global_sizes.begin(), global_sizes.end(),
                    global_offsets.begin() + 1);
 
-  // Build index data requests
-  std::vector<int> number_index_send(size, 0);
+  // Compute the owner of each index
   std::vector<int> index_owner(indices.size());
   std::vector<int> index_order(indices.size());
   std::iota(index_order.begin(), index_order.end(), 0);
@@ -162,52 +254,81 @@ build::distribute_data(MPI_Comm comm,
     while (indices[j] >= global_offsets[p + 1])
       ++p;
     index_owner[j] = p;
-    number_index_send[p]++;
+  }
+
+  // Get the (sorted) owning ranks that indices are sent to and the
+  // ranks that indices are received from, and create the
+  // neighbourhood communicators for the requests and the replies
+  std::vector<int> dest(index_owner.begin(), index_owner.end());
+  std::sort(dest.begin(), dest.end());
+  dest.erase(std::unique(dest.begin(), dest.end()), dest.end());
+  std::vector<int> src = dolfinx::MPI::compute_graph_edges(
+      comm, std::set<int>(dest.begin(), dest.end()));
+  std::sort(src.begin(), src.end());
+  MPI_Comm comm0, comm1;
+  MPI_Dist_graph_create_adjacent(comm, src.size(), src.data(), MPI_UNWEIGHTED,
+                                 dest.size(), dest.data(), MPI_UNWEIGHTED,
+                                 MPI_INFO_NULL, false, &comm0);
+  MPI_Dist_graph_create_adjacent(comm, dest.size(), dest.data(),
+                                 MPI_UNWEIGHTED, src.size(), src.data(),
+                                 MPI_UNWEIGHTED, MPI_INFO_NULL, false, &comm1);
+  const dolfinx::MPI::Comm comm_fwd(comm0, false);
+  const dolfinx::MPI::Comm comm_rev(comm1, false);
+
+  // Count the indices to send to each owner. Add '1' to handle the
+  // empty case as OpenMPI fails for null pointers.
+  std::vector<int> number_index_send(dest.size() + 1, 0);
+  for (int& owner : index_owner)
+  {
+    owner = std::lower_bound(dest.begin(), dest.end(), owner) - dest.begin();
+    number_index_send[owner]++;
   }
 
   // Compute send displacements
-  std::vector<int> disp_index_send(size + 1, 0);
-  std::partial_sum(number_index_send.begin(), number_index_send.end(),
+  std::vector<int> disp_index_send(dest.size() + 1, 0);
+  std::partial_sum(number_index_send.begin(),
+                   std::prev(number_index_send.end()),
                    disp_index_send.begin() + 1);
 
-  // Pack global index send data
+  // Pack global index send data, and keep the position of each index
+  // in the send buffer
   std::vector<std::int64_t> indices_send(disp_index_send.back());
+  std::vector<int> index_pos(indices.size());
   std::vector<int> disp_tmp = disp_index_send;
   for (std::size_t i = 0; i < indices.size(); ++i)
   {
-    const int owner = index_owner[i];
-    indices_send[disp_tmp[owner]++] = indices[i];
+    const int pos = disp_tmp[index_owner[i]]++;
+    indices_send[pos] = indices[i];
+    index_pos[i] = pos;
   }
 
   // Send/receive number of indices to communicate to each process
-  std::vector<int> number_index_recv(size);
-  MPI_Alltoall(number_index_send.data(), 1, MPI_INT, number_index_recv.data(),
-               1, MPI_INT, comm);
+  std::vector<int> number_index_recv(src.size() + 1, 0);
+  MPI_Neighbor_alltoall(number_index_send.data(), 1, MPI_INT,
+                        number_index_recv.data(), 1, MPI_INT, comm_fwd.comm());
 
   // Compute receive displacements
-  std::vector<int> disp_index_recv(size + 1, 0);
-  std::partial_sum(number_index_recv.begin(), number_index_recv.end(),
+  std::vector<int> disp_index_recv(src.size() + 1, 0);
+  std::partial_sum(number_index_recv.begin(),
+                   std::prev(number_index_recv.end()),
                    disp_index_recv.begin() + 1);
 
   // Send/receive global indices
   std::vector<std::int64_t> indices_recv(disp_index_recv.back());
-  MPI_Alltoallv(indices_send.data(), number_index_send.data(),
-                disp_index_send.data(), MPI_INT64_T, indices_recv.data(),
-                number_index_recv.data(), disp_index_recv.data(), MPI_INT64_T,
-                comm);
+  MPI_Neighbor_alltoallv(indices_send.data(), number_index_send.data(),
+                         disp_index_send.data(), MPI_INT64_T,
+                         indices_recv.data(), number_index_recv.data(),
+                         disp_index_recv.data(), MPI_INT64_T, comm_fwd.comm());
 
   assert(x.shape(1) != 0);
   // Pack point data to send back (transpose)
   xt::xtensor<T, 2> x_return({indices_recv.size(), x.shape(1)});
-  for (int p = 0; p < size; ++p)
+  for (std::size_t i = 0; i < indices_recv.size(); ++i)
   {
-    for (int i = disp_index_recv[p]; i < disp_index_recv[p + 1]; ++i)
-    {
-      const std::int32_t index_local = indices_recv[i] - global_offsets[rank];
-      assert(index_local >= 0);
-      for (std::size_t j = 0; j < x.shape(1); ++j)
-        x_return(i, j) = x(index_local, j);
-    }
+    const std::int32_t index_local = indices_recv[i] - global_offsets[rank];
+    assert(index_local >= 0);
+    for (std::size_t j = 0; j < x.shape(1); ++j)
+      x_return(i, j) = x(index_local, j);
   }
 
   MPI_Datatype compound_type;
@@ -215,14 +336,20 @@ build::distribute_data(MPI_Comm comm,
   MPI_Type_commit(&compound_type);
 
   // Send back point data
-  xt::xtensor<T, 2> my_x(
+  xt::xtensor<T, 2> x_recv(
       {static_cast<std::size_t>(disp_index_send.back()), x.shape(1)});
-  MPI_Alltoallv(x_return.data(), number_index_recv.data(),
-                disp_index_recv.data(), compound_type, my_x.data(),
-                number_index_send.data(), disp_index_send.data(), compound_type,
-                comm);
+  MPI_Neighbor_alltoallv(x_return.data(), number_index_recv.data(),
+                         disp_index_recv.data(), compound_type, x_recv.data(),
+                         number_index_send.data(), disp_index_send.data(),
+                         compound_type, comm_rev.comm());
   MPI_Type_free(&compound_type);
 
+  // Order received data by the requested indices
+  xt::xtensor<T, 2> my_x({indices.size(), x.shape(1)});
+  for (std::size_t i = 0; i < indices.size(); ++i)
+    for (std::size_t j = 0; j < x.shape(1); ++j)
+      my_x(i, j) = x_recv(index_pos[i], j);
+
   return my_x;
 }
 
@@ -7,13 +7,16 @@
 #include "scotch.h"
 #include "AdjacencyList.h"
 #include <algorithm>
+#include <array>
 #include <dolfinx/common/MPI.h>
 #include <dolfinx/common/Timer.h>
 #include <dolfinx/common/log.h>
 #include <map>
 #include <numeric>
 #include <set>
+#include <stdexcept>
 #include <string>
+#include <thread>
 
 extern "C"
 {
@@ -23,6 +26,57 @@ extern "C"
 
 using namespace dolfinx;
 
+namespace
+{
+// Partition a SCOTCH distributed graph, using a pool of num_threads
+// threads on each process if num_threads > 1. Returns the SCOTCH error
+// code.
+int dgraph_part(SCOTCH_Dgraph& dgraph, SCOTCH_Num nparts,
+                SCOTCH_Strat& strat, SCOTCH_Num* partition,
+                int num_threads, int seed)
+{
+  if (num_threads <= 1)
+    return SCOTCH_dgraphPart(&dgraph, nparts, &strat, partition);
+
+#if SCOTCH_VERSION >= 7
+  // Create a context with a pool of num_threads threads. Thread 0 is
+  // the calling thread, the other threads are held by SCOTCH until
+  // the context is destroyed.
+  SCOTCH_Context context;
+  SCOTCH_contextInit(&context);
+  SCOTCH_contextRandomSeed(&context, seed);
+  if (SCOTCH_contextThreadImport1(&context, num_threads))
+  {
+    SCOTCH_contextExit(&context);
+    throw std::runtime_error("Error creating SCOTCH thread pool");
+  }
+  std::vector<std::thread> pool;
+  for (int t = 1; t < num_threads; ++t)
+    pool.emplace_back([&context, t]()
+                      { SCOTCH_contextThreadImport2(&context, t); });
+  SCOTCH_contextThreadImport2(&context, 0);
+
+  // Bind the graph to the context and partition it
+  SCOTCH_Dgraph cdgraph;
+  int err = SCOTCH_contextBindDgraph(&context, &dgraph, &cdgraph);
+  if (err == 0)
+  {
+    err = SCOTCH_dgraphPart(&cdgraph, nparts, &strat, partition);
+    SCOTCH_dgraphExit(&cdgraph);
+  }
+
+  SCOTCH_contextExit(&context);
+  for (std::thread& t : pool)
+    t.join();
+  return err;
+#else
+  LOG(WARNING) << "Threaded partitioning requires SCOTCH 7 or later. "
+                  "Using a single thread.";
+  return SCOTCH_dgraphPart(&dgraph, nparts, &strat, partition);
+#endif
+}
+} // namespace
+
 //-----------------------------------------------------------------------------
 std::pair<std::vector<int>, std::vector<int>>
 graph::scotch::compute_gps(const AdjacencyList<std::int32_t>& graph,
@@ -117,12 +171,16 @@ graph::scotch::compute_reordering(const AdjacencyList<std::int32_t>& graph,
 }
 //-----------------------------------------------------------------------------
 graph::partition_fn graph::scotch::partitioner(graph::scotch::strategy strategy,
-                                               double imbalance, int seed)
+                                               double imbalance, int seed,
+                                               int num_threads)
 {
   return
-      [imbalance, strategy, seed](const MPI_Comm mpi_comm, int nparts,
-                                  const AdjacencyList<std::int64_t>& graph,
-                                  std::int32_t num_ghost_nodes, bool ghosting)
+      [imbalance, strategy, seed,
+       num_threads](const MPI_Comm mpi_comm, int nparts,
+             const AdjacencyList<std::int64_t>& graph,
+             std::int32_t num_ghost_nodes, bool ghosting,
+             const xtl::span<const std::int32_t>& node_weights,
+             const xtl::span<const std::int32_t>& edge_weights)
   {
     LOG(INFO) << "Compute graph partition using PT-SCOTCH";
     common::Timer timer("Compute graph partition (SCOTCH)");
@@ -138,8 +196,6 @@ graph::partition_fn graph::scotch::partitioner(graph::scotch::strategy strategy,
     // Number of local graph vertices
     const SCOTCH_Num vertlocnbr = local_graph.num_nodes();
 
-    std::vector<SCOTCH_Num> node_weights;
-
     // Get graph data. vertloctab needs to be copied to match the
     // SCOTCH_Num type.
     const SCOTCH_Num* edgeloctab = local_graph.array().data();
@@ -154,14 +210,30 @@ graph::partition_fn graph::scotch::partitioner(graph::scotch::strategy strategy,
     if (SCOTCH_dgraphInit(&dgrafdat, mpi_comm) != 0)
       throw std::runtime_error("Error initializing SCOTCH graph");
 
-    // FIXME: If the nodes have weights but this rank has no nodes, then
-    //        SCOTCH may deadlock since vload.data() will be nullptr on
-    //        this rank but not null on all other ranks.
-
-    // Handle cell weights (if any)
-    std::vector<SCOTCH_Num> vload;
-    if (!node_weights.empty())
+    if (!node_weights.empty() and (int)node_weights.size() != vertlocnbr)
+      throw std::runtime_error("Node weights size mismatch");
+    if (!edge_weights.empty() and (int)edge_weights.size() != edgeloctab_size)
+      throw std::runtime_error("Edge weights size mismatch");
+
+    // SCOTCH requires the weight arrays to be either set on all ranks
+    // or on none, including on ranks that have no nodes
+    std::array<int, 2> has_weights
+        = {!node_weights.empty(), !edge_weights.empty()};
+    MPI_Allreduce(MPI_IN_PLACE, has_weights.data(), 2, MPI_INT, MPI_MAX,
+                  mpi_comm);
+
+    // Handle node and edge weights (if any)
+    std::vector<SCOTCH_Num> vload, eload;
+    if (has_weights[0])
+    {
       vload.assign(node_weights.begin(), node_weights.end());
+      vload.resize(std::max(SCOTCH_Num(1), vertlocnbr), 1);
+    }
+    if (has_weights[1])
+    {
+      eload.assign(edge_weights.begin(), edge_weights.end());
+      eload.resize(std::max(1, edgeloctab_size), 1);
+    }
 
     // Set seed and reset SCOTCH random number generator to produce
     // deterministic partitions on repeated calls
@@ -173,8 +245,10 @@ graph::partition_fn graph::scotch::partitioner(graph::scotch::strategy strategy,
     common::Timer timer1("SCOTCH: call SCOTCH_dgraphBuild");
     if (SCOTCH_dgraphBuild(
             &dgrafdat, baseval, vertlocnbr, vertlocnbr, vertloctab.data(),
-            nullptr, vload.data(), nullptr, edgeloctab_size, edgeloctab_size,
-            const_cast<SCOTCH_Num*>(edgeloctab), nullptr, nullptr))
+            nullptr, vload.empty() ? nullptr : vload.data(), nullptr,
+            edgeloctab_size, edgeloctab_size,
+            const_cast<SCOTCH_Num*>(edgeloctab), nullptr,
+            eload.empty() ? nullptr : eload.data()))
     {
       throw std::runtime_error("Error building SCOTCH graph");
     }
@@ -226,8 +300,11 @@ graph::partition_fn graph::scotch::partitioner(graph::scotch::strategy strategy,
 
     // Partition the graph
     common::Timer timer2("SCOTCH: call SCOTCH_dgraphPart");
-    if (SCOTCH_dgraphPart(&dgrafdat, nparts, &strat, cell_partition.data()))
+    if (dgraph_part(dgrafdat, nparts, strat, cell_partition.data(),
+                    num_threads, seed))
+    {
       throw std::runtime_error("Error during SCOTCH partitioning");
+    }
     timer2.stop();
 
     // Create a map of local nodes to their additional destination
@@ -35,9 +35,14 @@ enum class strategy
 /// @param[in] imbalance The allowable imbalance (between 0 and 1). The
 /// smaller value the more balanced the partitioning must be.
 /// @param[in] seed Random number generator seed
+/// @param[in] num_threads Number of threads per process used by the
+/// threaded algorithms of PT-SCOTCH. With more than one thread, the
+/// graph is partitioned in a SCOTCH context (requires SCOTCH 7 or
+/// later, otherwise a single thread is used).
 /// @return A graph partitioning function
 graph::partition_fn partitioner(scotch::strategy strategy = strategy::none,
-                                double imbalance = 0.025, int seed = 0);
+                                double imbalance = 0.025, int seed = 0,
+                                int num_threads = 1);
 
 /// Compute reordering (map[old] -> new) using Gibbs-Poole-Stockmeyer
 /// (GPS) re-ordering
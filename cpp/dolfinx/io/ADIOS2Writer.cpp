@@ -0,0 +1,189 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#ifdef HAS_ADIOS2
+
+#include "ADIOS2Writer.h"
+#include <adios2.h>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/fem/DofMap.h>
+#include <dolfinx/fem/Function.h>
+#include <dolfinx/fem/FunctionSpace.h>
+#include <dolfinx/mesh/Geometry.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <dolfinx/mesh/Topology.h>
+#include <dolfinx/mesh/cell_types.h>
+#include <iterator>
+#include <vector>
+
+using namespace dolfinx;
+using namespace dolfinx::io;
+
+namespace
+{
+//-----------------------------------------------------------------------------
+
+// Get the variable with the given name, defining it if it does not
+// exist, and select the block of this process
+template <typename T>
+adios2::Variable<T> define_variable(adios2::IO& io, const std::string& name,
+                                    const adios2::Dims& shape,
+                                    const adios2::Dims& start,
+                                    const adios2::Dims& count)
+{
+  if (adios2::Variable<T> var = io.InquireVariable<T>(name); var)
+  {
+    var.SetShape(shape);
+    var.SetSelection({start, count});
+    return var;
+  }
+  else
+    return io.DefineVariable<T>(name, shape, start, count);
+}
+//-----------------------------------------------------------------------------
+template <typename T>
+void _write_function(adios2::IO& io, adios2::Engine& engine,
+                     const fem::Function<T>& u, double t)
+{
+  assert(u.function_space());
+  std::shared_ptr<const mesh::Mesh> mesh = u.function_space()->mesh();
+  assert(mesh);
+  std::shared_ptr<const fem::DofMap> dofmap = u.function_space()->dofmap();
+  assert(dofmap);
+  if (dofmap->bs() != dofmap->index_map_bs())
+    throw std::runtime_error("Writing of subspaces not supported.");
+
+  std::shared_ptr<const common::IndexMap> dof_map = dofmap->index_map;
+  assert(dof_map);
+  const std::size_t bs = dofmap->bs();
+  adios2::Variable<T> values = define_variable<T>(
+      io, u.name, {bs * dof_map->size_global()},
+      {bs * dof_map->local_range()[0]}, {bs * dof_map->size_local()});
+
+  // The global dofs of the owned cells are only put in the first step
+  // in which the Function is written
+  const std::string dofmap_name = u.name + "_dofmap";
+  const bool put_dofmap = !io.InquireVariable<std::int64_t>(dofmap_name);
+  std::vector<std::int64_t> dofs_g;
+  adios2::Variable<std::int64_t> cell_dofs;
+  if (put_dofmap)
+  {
+    const int tdim = mesh->topology().dim();
+    std::shared_ptr<const common::IndexMap> cell_map
+        = mesh->topology().index_map(tdim);
+    assert(cell_map);
+    const std::size_t num_cells = cell_map->size_local();
+    const std::size_t num_cell_dofs = dofmap->element_dof_layout->num_dofs();
+    std::vector<std::int32_t> dofs(
+        dofmap->list().array().begin(),
+        std::next(dofmap->list().array().begin(), num_cells * num_cell_dofs));
+    dofs_g.resize(dofs.size());
+    dof_map->local_to_global(dofs, dofs_g);
+    cell_dofs = io.DefineVariable<std::int64_t>(
+        dofmap_name, {std::size_t(cell_map->size_global()), num_cell_dofs},
+        {std::size_t(cell_map->local_range()[0]), 0},
+        {num_cells, num_cell_dofs});
+  }
+
+  adios2::Variable<double> time = io.InquireVariable<double>("time");
+  if (!time)
+    time = io.DefineVariable<double>("time");
+
+  // The deferred puts are performed by EndStep, while the arrays are
+  // still alive
+  engine.BeginStep();
+  if (dolfinx::MPI::rank(mesh->mpi_comm()) == 0)
+    engine.Put(time, t);
+  engine.Put(values, u.x()->array().data(), adios2::Mode::Deferred);
+  if (put_dofmap)
+    engine.Put(cell_dofs, dofs_g.data(), adios2::Mode::Deferred);
+  engine.EndStep();
+}
+//-----------------------------------------------------------------------------
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+ADIOS2Writer::ADIOS2Writer(MPI_Comm comm, const std::string& filename,
+                           const std::string& engine,
+                           const std::map<std::string, std::string>& parameters)
+    : _comm(comm), _adios(std::make_unique<adios2::ADIOS>(comm))
+{
+  _io = std::make_unique<adios2::IO>(_adios->DeclareIO("dolfinx"));
+  _io->SetEngine(engine);
+  _io->SetParameters(parameters);
+  _engine = std::make_unique<adios2::Engine>(
+      _io->Open(filename, adios2::Mode::Write));
+}
+//-----------------------------------------------------------------------------
+ADIOS2Writer::~ADIOS2Writer() { close(); }
+//-----------------------------------------------------------------------------
+void ADIOS2Writer::close()
+{
+  if (_engine and *_engine)
+    _engine->Close();
+}
+//-----------------------------------------------------------------------------
+void ADIOS2Writer::write_mesh(const mesh::Mesh& mesh)
+{
+  assert(_engine and *_engine);
+  const mesh::Geometry& geometry = mesh.geometry();
+  std::shared_ptr<const common::IndexMap> x_map = geometry.index_map();
+  assert(x_map);
+  const int tdim = mesh.topology().dim();
+  std::shared_ptr<const common::IndexMap> cell_map
+      = mesh.topology().index_map(tdim);
+  assert(cell_map);
+
+  // Owned geometry nodes, which are the first rows of the coordinates
+  const std::size_t gdim = geometry.x().shape(1);
+  adios2::Variable<double> x = define_variable<double>(
+      *_io, "geometry", {std::size_t(x_map->size_global()), gdim},
+      {std::size_t(x_map->local_range()[0]), 0},
+      {std::size_t(x_map->size_local()), gdim});
+
+  // Global geometry nodes of the owned cells
+  const graph::AdjacencyList<std::int32_t>& x_dofmap = geometry.dofmap();
+  const std::size_t num_cells = cell_map->size_local();
+  const std::size_t num_nodes = geometry.cmap().dof_layout().num_dofs();
+  std::vector<std::int32_t> nodes(
+      x_dofmap.array().begin(),
+      std::next(x_dofmap.array().begin(), num_cells * num_nodes));
+  std::vector<std::int64_t> nodes_g(nodes.size());
+  x_map->local_to_global(nodes, nodes_g);
+  adios2::Variable<std::int64_t> topology = define_variable<std::int64_t>(
+      *_io, "topology", {std::size_t(cell_map->size_global()), num_nodes},
+      {std::size_t(cell_map->local_range()[0]), 0}, {num_cells, num_nodes});
+
+  if (!_io->InquireAttribute<std::string>("cell_type"))
+  {
+    _io->DefineAttribute<std::string>(
+        "cell_type", mesh::to_string(mesh.topology().cell_type()));
+  }
+
+  _engine->BeginStep();
+  _engine->Put(x, geometry.x().data(), adios2::Mode::Deferred);
+  _engine->Put(topology, nodes_g.data(), adios2::Mode::Deferred);
+  _engine->EndStep();
+}
+//-----------------------------------------------------------------------------
+void ADIOS2Writer::write_function(const fem::Function<double>& u, double t)
+{
+  assert(_engine and *_engine);
+  _write_function(*_io, *_engine, u, t);
+}
+//-----------------------------------------------------------------------------
+void ADIOS2Writer::write_function(const fem::Function<std::complex<double>>& u,
+                                  double t)
+{
+  assert(_engine and *_engine);
+  _write_function(*_io, *_engine, u, t);
+}
+//-----------------------------------------------------------------------------
+MPI_Comm ADIOS2Writer::comm() const { return _comm.comm(); }
+//-----------------------------------------------------------------------------
+
+#endif
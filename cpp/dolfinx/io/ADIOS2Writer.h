@@ -0,0 +1,116 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#ifdef HAS_ADIOS2
+
+#include <complex>
+#include <dolfinx/common/MPI.h>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace adios2
+{
+class ADIOS;
+class IO;
+class Engine;
+} // namespace adios2
+
+namespace dolfinx::fem
+{
+template <typename T>
+class Function;
+}
+
+namespace dolfinx::mesh
+{
+class Mesh;
+}
+
+namespace dolfinx::io
+{
+
+/// Output of meshes and functions with ADIOS2, to BP files or to a
+/// staging engine such as SST for in-situ analysis.
+///
+/// Each call to ADIOS2Writer::write_mesh and
+/// ADIOS2Writer::write_function is one ADIOS2 step. The arrays are
+/// global arrays in the native DOLFINx layout, and each process puts
+/// its owned rows as one block:
+///
+/// - `geometry`: the owned geometry nodes, shape (num_nodes, gdim)
+/// - `topology`: the global geometry nodes of the owned cells, in
+///   DOLFINx ordering, shape (num_cells, num_nodes_per_cell). The cell
+///   type is the attribute `cell_type`.
+/// - `<name>`: the owned degrees-of-freedom of the Function `name`,
+///   shape (num_dofs * bs). The global degrees-of-freedom of the owned
+///   cells are the array `<name>_dofmap`, which is put in the first step
+///   in which the Function is written.
+/// - `time`: the time stamp of a step in which Functions are written.
+///
+/// The degrees-of-freedom are put directly from the Function arrays,
+/// without copying (deferred puts that are performed at the end of
+/// the step).
+class ADIOS2Writer
+{
+public:
+  /// Create a writer
+  /// @param[in] comm The MPI communicator
+  /// @param[in] filename The name of the BP file, or of the stream for
+  /// staging engines
+  /// @param[in] engine The ADIOS2 engine type, e.g. "BP4", "BP5" or
+  /// "SST"
+  /// @param[in] parameters Parameters of the engine, e.g.
+  /// {{"QueueLimit", "2"}} for SST
+  ADIOS2Writer(MPI_Comm comm, const std::string& filename,
+               const std::string& engine = "BP4",
+               const std::map<std::string, std::string>& parameters = {});
+
+  /// Copy constructor (deleted)
+  ADIOS2Writer(const ADIOS2Writer& writer) = delete;
+
+  /// Destructor
+  ~ADIOS2Writer();
+
+  /// Assignment operator (deleted)
+  ADIOS2Writer& operator=(const ADIOS2Writer& writer) = delete;
+
+  /// Close the engine
+  void close();
+
+  /// Write the geometry and topology of a mesh
+  /// @note Collective
+  /// @param[in] mesh The mesh
+  void write_mesh(const mesh::Mesh& mesh);
+
+  /// Write the degrees-of-freedom of a Function
+  /// @note Collective
+  /// @param[in] u The Function
+  /// @param[in] t The time stamp of the step
+  void write_function(const fem::Function<double>& u, double t);
+
+  /// Write the degrees-of-freedom of a complex Function
+  /// @note Collective
+  /// @param[in] u The Function
+  /// @param[in] t The time stamp of the step
+  void write_function(const fem::Function<std::complex<double>>& u, double t);
+
+  /// Get the MPI communicator
+  /// @return The MPI communicator
+  MPI_Comm comm() const;
+
+private:
+  dolfinx::MPI::Comm _comm;
+  std::unique_ptr<adios2::ADIOS> _adios;
+  std::unique_ptr<adios2::IO> _io;
+  std::unique_ptr<adios2::Engine> _engine;
+};
+
+} // namespace dolfinx::io
+
+#endif
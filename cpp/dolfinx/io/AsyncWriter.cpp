@@ -0,0 +1,126 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "AsyncWriter.h"
+#include <dolfinx/common/log.h>
+#include <mpi.h>
+#include <utility>
+
+using namespace dolfinx;
+using namespace dolfinx::io;
+
+//-----------------------------------------------------------------------------
+AsyncWriter::AsyncWriter(std::size_t max_pending) : _max_pending(max_pending)
+{
+  if (_max_pending == 0)
+    return;
+
+  int provided;
+  MPI_Query_thread(&provided);
+  if (provided == MPI_THREAD_MULTIPLE)
+    _thread = std::thread(&AsyncWriter::run, this);
+  else
+  {
+    LOG(WARNING) << "MPI has not been initialised with MPI_THREAD_MULTIPLE. "
+                    "Output is not written asynchronously.";
+  }
+}
+//-----------------------------------------------------------------------------
+AsyncWriter::~AsyncWriter()
+{
+  if (!_thread.joinable())
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _cv.notify_all();
+  _thread.join();
+
+  if (_error)
+  {
+    try
+    {
+      std::rethrow_exception(_error);
+    }
+    catch (const std::exception& e)
+    {
+      LOG(ERROR) << "Asynchronous write failed: " << e.what();
+    }
+    catch (...)
+    {
+      LOG(ERROR) << "Asynchronous write failed.";
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+void AsyncWriter::submit(std::function<void()> task)
+{
+  if (!_thread.joinable())
+  {
+    task();
+    return;
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _cv.wait(lock, [this]() { return _tasks.size() < _max_pending; });
+    _tasks.push_back(std::move(task));
+  }
+  _cv.notify_all();
+}
+//-----------------------------------------------------------------------------
+void AsyncWriter::wait()
+{
+  std::unique_lock<std::mutex> lock(_mutex);
+  _cv.wait(lock, [this]() { return _tasks.empty(); });
+  if (_error)
+    std::rethrow_exception(std::exchange(_error, nullptr));
+}
+//-----------------------------------------------------------------------------
+std::size_t AsyncWriter::num_pending() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _tasks.size();
+}
+//-----------------------------------------------------------------------------
+bool AsyncWriter::asynchronous() const { return _thread.joinable(); }
+//-----------------------------------------------------------------------------
+void AsyncWriter::run()
+{
+  while (true)
+  {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _cv.wait(lock, [this]() { return _stop or !_tasks.empty(); });
+      if (_tasks.empty())
+        return;
+      task = std::move(_tasks.front());
+    }
+
+    // Perform the task without holding the lock
+    std::exception_ptr error;
+    try
+    {
+      task();
+    }
+    catch (...)
+    {
+      error = std::current_exception();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (error and !_error)
+        _error = error;
+      _tasks.pop_front();
+    }
+    _cv.notify_all();
+  }
+}
+//-----------------------------------------------------------------------------
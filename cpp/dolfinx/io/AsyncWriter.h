@@ -0,0 +1,168 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include "VTKFile.h"
+#include "XDMFFile.h"
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <dolfinx/fem/Function.h>
+#include <dolfinx/la/Vector.h>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dolfinx::io
+{
+
+/// Write output in a background thread.
+///
+/// Writes are queued as tasks that are performed, in order, by a
+/// dedicated I/O thread, so that the computation continues while the
+/// data is written. The data of a Function is copied when the write is
+/// queued, so the Function can be modified as soon as
+/// AsyncWriter::write_function returns. The mesh is not copied and must
+/// not be modified while writes are pending. The number of pending
+/// writes, and therefore the memory used for the copies, is bounded by
+/// the maximum number of pending writes: a write blocks while the
+/// queue is full.
+///
+/// Collective writes are performed by the I/O thread on each process,
+/// which requires MPI to have been initialised with
+/// MPI_THREAD_MULTIPLE. Otherwise, or if the maximum number of pending
+/// writes is zero, the writes are performed when they are queued. The
+/// files that are written to must not be used directly while writes
+/// are pending, and HDF5 must not be used by other threads unless it
+/// is thread-safe. Call AsyncWriter::wait before such use.
+///
+/// Typical usage is
+///
+///     io::AsyncWriter writer(2);
+///     for (...)
+///     {
+///       ...
+///       writer.write_function(file, u, t);
+///     }
+///     writer.wait();
+class AsyncWriter
+{
+public:
+  /// Create a writer, and start the I/O thread
+  /// @param[in] max_pending The maximum number of pending writes,
+  /// including the write in progress. If zero, writes are performed
+  /// when they are queued.
+  explicit AsyncWriter(std::size_t max_pending = 2);
+
+  /// Copy constructor (deleted)
+  AsyncWriter(const AsyncWriter& writer) = delete;
+
+  /// Destructor. Waits for the pending writes to finish. Errors from
+  /// the pending writes are logged.
+  ~AsyncWriter();
+
+  /// Assignment operator (deleted)
+  AsyncWriter& operator=(const AsyncWriter& writer) = delete;
+
+  /// Queue a task for the I/O thread. Blocks while the maximum number
+  /// of writes is pending.
+  /// @param[in] task The task. It must be collective if the I/O uses a
+  /// communicator, and must be queued in the same order on all
+  /// processes.
+  void submit(std::function<void()> task);
+
+  /// Queue the write of a copy of a Function to an XDMF file. See
+  /// XDMFFile::write_function.
+  /// @param[in] file The file, which must outlive the write
+  /// @param[in] u The Function
+  /// @param[in] t The time stamp to associate with the Function
+  /// @param[in] mesh_xpath XPath for a Grid under which Function will
+  /// be inserted
+  template <typename T>
+  void write_function(XDMFFile& file, const fem::Function<T>& u, double t,
+                      const std::string& mesh_xpath
+                      = "/Xdmf/Domain/Grid[@GridType='Uniform'][1]")
+  {
+    std::shared_ptr<const fem::Function<T>> v = snapshot(u);
+    submit([&file, v, t, mesh_xpath]()
+           { file.write_function(*v, t, mesh_xpath); });
+  }
+
+  /// Queue the write of copies of Functions to a VTK file. See
+  /// VTKFile::write.
+  /// @param[in] file The file, which must outlive the write
+  /// @param[in] u The Functions
+  /// @param[in] t The time stamp to associate with the Functions
+  template <typename T>
+  void write_function(
+      VTKFile& file,
+      const std::vector<std::reference_wrapper<const fem::Function<T>>>& u,
+      double t)
+  {
+    std::vector<std::shared_ptr<const fem::Function<T>>> v;
+    for (const fem::Function<T>& ui : u)
+      v.push_back(snapshot(ui));
+    submit(
+        [&file, v, t]()
+        {
+          std::vector<std::reference_wrapper<const fem::Function<T>>> refs;
+          for (auto& vi : v)
+            refs.push_back(*vi);
+          file.write(refs, t);
+        });
+  }
+
+  /// Wait until all pending writes have finished
+  /// @note Rethrows the first exception thrown by a pending write
+  void wait();
+
+  /// Number of pending writes, including the write in progress
+  std::size_t num_pending() const;
+
+  /// True if writes are performed by the I/O thread
+  bool asynchronous() const;
+
+  /// Copy a Function, including its name and degree-of-freedom values.
+  /// The copy shares the function space of `u`.
+  /// @param[in] u The Function
+  /// @return The copy
+  template <typename T>
+  static std::shared_ptr<const fem::Function<T>>
+  snapshot(const fem::Function<T>& u)
+  {
+    auto x = std::make_shared<la::Vector<T>>(*u.x());
+    auto v = std::make_shared<fem::Function<T>>(u.function_space(), x);
+    v->name = u.name;
+    return v;
+  }
+
+private:
+  // Perform the queued tasks until the writer is destroyed
+  void run();
+
+  std::size_t _max_pending;
+
+  // Queued tasks. The task in progress is removed when it has
+  // finished.
+  std::deque<std::function<void()>> _tasks;
+
+  // True when the I/O thread should stop once the queue is empty
+  bool _stop = false;
+
+  // First exception thrown by a task since the last wait
+  std::exception_ptr _error;
+
+  mutable std::mutex _mutex;
+  std::condition_variable _cv;
+  std::thread _thread;
+};
+
+} // namespace dolfinx::io
@@ -56,16 +56,28 @@ bool has_group(const hid_t handle, const std::string& group_name)
 
 //-----------------------------------------------------------------------------
 hid_t HDF5Interface::open_file(MPI_Comm mpi_comm, const std::string& filename,
-                               const std::string& mode, const bool use_mpi_io)
+                               const std::string& mode, const bool use_mpi_io,
+                               const FileOptions& options)
 {
   // Set parallel access with communicator
   const hid_t plist_id = H5Pcreate(H5P_FILE_ACCESS);
 
+  // Align large objects, e.g. to the stripe size of the file system
+  if (options.alignment > 0
+      and H5Pset_alignment(plist_id, options.alignment_threshold,
+                           options.alignment)
+              < 0)
+  {
+    throw std::runtime_error("Call to H5Pset_alignment unsuccessful");
+  }
+
 #ifdef H5_HAVE_PARALLEL
   if (use_mpi_io)
   {
     MPI_Info info;
     MPI_Info_create(&info);
+    for (auto& [key, value] : options.mpi_hints)
+      MPI_Info_set(info, key.c_str(), value.c_str());
     if (H5Pset_fapl_mpio(plist_id, mpi_comm, info) < 0)
       throw std::runtime_error("Call to H5Pset_fapl_mpio unsuccessful");
     MPI_Info_free(&info);
@@ -243,3 +255,23 @@ bool HDF5Interface::get_mpi_atomicity(const hid_t handle)
   return static_cast<bool>(atomic);
 }
 //-----------------------------------------------------------------------------
+hid_t HDF5Interface::transfer_properties(const WriteOptions& options)
+{
+  const hid_t plist_id = H5Pcreate(H5P_DATASET_XFER);
+  if (options.use_mpi_io)
+  {
+#ifdef H5_HAVE_PARALLEL
+    if (H5Pset_dxpl_mpio(plist_id, options.collective ? H5FD_MPIO_COLLECTIVE
+                                                      : H5FD_MPIO_INDEPENDENT)
+        < 0)
+    {
+      throw std::runtime_error("Call to H5Pset_dxpl_mpio unsuccessful");
+    }
+#else
+    throw std::runtime_error("HDF5 library has not been configured with MPI");
+#endif
+  }
+
+  return plist_id;
+}
+//-----------------------------------------------------------------------------
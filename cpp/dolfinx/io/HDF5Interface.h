@@ -6,14 +6,18 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <chrono>
 #include <cstdint>
 #include <dolfinx/common/log.h>
+#include <dolfinx/common/timing.h>
 #include <hdf5.h>
 #include <mpi.h>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace dolfinx::io
@@ -25,13 +29,68 @@ class HDF5Interface
 {
 #define HDF5_FAIL -1
 public:
+  /// Options for opening a file
+  struct FileOptions
+  {
+    /// Alignment (bytes) of the objects in the file that are at least
+    /// alignment_threshold bytes large, e.g. the stripe size of a
+    /// parallel file system. No alignment if zero. See H5Pset_alignment.
+    hsize_t alignment = 0;
+
+    /// Size (bytes) from which objects are aligned
+    hsize_t alignment_threshold = 0;
+
+    /// MPI-IO hints as (key, value) pairs, e.g. ("cb_nodes", "8"),
+    /// ("striping_factor", "16") or ("striping_unit", "1048576"). The
+    /// hints are used only with MPI-IO.
+    std::vector<std::pair<std::string, std::string>> mpi_hints;
+  };
+
+  /// Options for writing a dataset
+  struct WriteOptions
+  {
+    /// True if MPI-IO should be used
+    bool use_mpi_io = false;
+
+    /// True if collective MPI-IO should be used, otherwise independent
+    /// MPI-IO is used
+    bool collective = true;
+
+    /// True if chunking should be used. Chunking is always used when a
+    /// filter is applied.
+    bool use_chunking = false;
+
+    /// Number of rows of a chunk. If zero, the number of rows is half
+    /// of the number of rows of the dataset, limited to [1024, 1048576].
+    std::int64_t chunk_rows = 0;
+
+    /// Level (1-9) of the deflate (gzip) compression. No compression if
+    /// zero.
+    int deflate_level = 0;
+
+    /// True if the shuffle filter should be applied before compression
+    bool shuffle = false;
+
+    /// True if szip compression should be used. HDF5 must have been
+    /// built with szip encoding.
+    bool szip = false;
+
+    /// Number of decimal digits of floating point data that are kept by
+    /// the lossy scale-offset filter, i.e. the absolute error is at most
+    /// 0.5 * 10^(-digits). The filter is not applied if negative, and is
+    /// not applied to integer data.
+    int scale_offset_digits = -1;
+  };
+
   /// Open HDF5 and return file descriptor
   /// @param[in] mpi_comm MPI communicator
   /// @param[in] filename Name of the HDF5 file to open
   /// @param[in] mode Mode in which to open the file (w, r, a)
   /// @param[in] use_mpi_io True if MPI-IO should be used
+  /// @param[in] options Alignment and MPI-IO hints
   static hid_t open_file(MPI_Comm mpi_comm, const std::string& filename,
-                         const std::string& mode, const bool use_mpi_io);
+                         const std::string& mode, const bool use_mpi_io,
+                         const FileOptions& options = FileOptions());
 
   /// Close HDF5 file
   /// @param[in] handle HDF5 file handle
@@ -61,7 +120,53 @@ public:
                             const T* data,
                             const std::array<std::int64_t, 2>& range,
                             const std::vector<std::int64_t>& global_size,
-                            bool use_mpi_io, bool use_chunking);
+                            bool use_mpi_io, bool use_chunking)
+  {
+    WriteOptions options;
+    options.use_mpi_io = use_mpi_io;
+    options.use_chunking = use_chunking;
+    write_dataset(handle, dataset_path, data, range, global_size, options);
+  }
+
+  /// Write data to existing HDF file as defined by range blocks on each
+  /// process
+  /// @param[in] handle HDF5 file handle
+  /// @param[in] dataset_path Path for the dataset in the HDF5 file
+  /// @param[in] data Data to be written, flattened into 1D vector
+  ///   (row-major storage)
+  /// @param[in] range The local range on this processor
+  /// @param[in] global_size The global shape shape of the array
+  /// @param[in] options Options for MPI-IO, chunking and compression
+  template <typename T>
+  static void write_dataset(const hid_t handle, const std::string& dataset_path,
+                            const T* data,
+                            const std::array<std::int64_t, 2>& range,
+                            const std::vector<std::int64_t>& global_size,
+                            const WriteOptions& options);
+
+  /// Append rows to an extendible HDF5 dataset, as defined by range
+  /// blocks on each process. The dataset is created, with chunked
+  /// storage, if it does not exist. This allows a series of arrays,
+  /// e.g. the values of a function at each time step, to be stored in
+  /// one dataset.
+  /// @param[in] handle HDF5 file handle
+  /// @param[in] dataset_path Path for the dataset in the HDF5 file
+  /// @param[in] data Data to be written, flattened into 1D vector
+  ///   (row-major storage)
+  /// @param[in] range The local range (in the rows that are appended)
+  ///   on this processor
+  /// @param[in] global_size The global shape of the rows that are
+  ///   appended. The number of columns must be the same as the number
+  ///   of columns of the existing dataset.
+  /// @param[in] options Options for MPI-IO, chunking and compression.
+  ///   The options are used only when the dataset is created.
+  /// @return The global row at which the data has been appended
+  template <typename T>
+  static std::int64_t
+  append_dataset(const hid_t handle, const std::string& dataset_path,
+                 const T* data, const std::array<std::int64_t, 2>& range,
+                 const std::vector<std::int64_t>& global_size,
+                 const WriteOptions& options);
 
   /// Read data from a HDF5 dataset "dataset_path" as defined by range
   /// blocks on each process.
@@ -109,6 +214,14 @@ private:
   /// @param[in] dataset_path Data set path to add
   static void add_group(const hid_t handle, const std::string& dataset_path);
 
+  // Add the filters in options to a dataset creation property list
+  template <typename T>
+  static void add_filters(const hid_t plist_id, const WriteOptions& options);
+
+  // Create a dataset transfer property list for options. The list must
+  // be closed by the caller.
+  static hid_t transfer_properties(const WriteOptions& options);
+
   // Return HDF5 data type
   template <typename T>
   static hid_t hdf5_type()
@@ -159,8 +272,10 @@ template <typename T>
 inline void HDF5Interface::write_dataset(
     const hid_t file_handle, const std::string& dataset_path, const T* data,
     const std::array<std::int64_t, 2>& range,
-    const std::vector<int64_t>& global_size, bool use_mpi_io, bool use_chunking)
+    const std::vector<int64_t>& global_size, const WriteOptions& options)
 {
+  auto timer_start = std::chrono::system_clock::now();
+
   // Data rank
   const std::size_t rank = global_size.size();
   assert(rank != 0);
@@ -192,20 +307,35 @@ inline void HDF5Interface::write_dataset(
   const hid_t filespace0 = H5Screate_simple(rank, dimsf.data(), nullptr);
   assert(filespace0 != HDF5_FAIL);
 
-  // Set chunking parameters
+  // Set chunking parameters. Filters require chunking.
+  bool scale_offset = false;
+  if constexpr (std::is_floating_point_v<T>)
+    scale_offset = options.scale_offset_digits >= 0;
+  const bool use_filters = options.deflate_level > 0 or options.szip
+                           or options.shuffle or scale_offset;
+  const bool use_chunking
+      = (options.use_chunking or use_filters) and dimsf[0] > 0;
   hid_t chunking_properties;
   if (use_chunking)
   {
-    // Set chunk size and limit to 1kB min/1MB max
-    hsize_t chunk_size = dimsf[0] / 2;
-    if (chunk_size > 1048576)
-      chunk_size = 1048576;
-    if (chunk_size < 1024)
-      chunk_size = 1024;
-
-    hsize_t chunk_dims[2] = {chunk_size, dimsf[1]};
+    // Set chunk size and limit to 1kB min/1MB max, unless set
+    hsize_t chunk_size = options.chunk_rows;
+    if (chunk_size == 0)
+    {
+      chunk_size = dimsf[0] / 2;
+      if (chunk_size > 1048576)
+        chunk_size = 1048576;
+      if (chunk_size < 1024)
+        chunk_size = 1024;
+    }
+
+    // Chunks cannot be larger than the (fixed size) dataset
+    chunk_size = std::min(chunk_size, dimsf[0]);
+    hsize_t chunk_dims[2] = {chunk_size, rank == 2 ? dimsf[1] : 1};
     chunking_properties = H5Pcreate(H5P_DATASET_CREATE);
     H5Pset_chunk(chunking_properties, rank, chunk_dims);
+
+    add_filters<T>(chunking_properties, options);
   }
   else
     chunking_properties = H5P_DEFAULT;
@@ -235,16 +365,7 @@ inline void HDF5Interface::write_dataset(
   assert(status != HDF5_FAIL);
 
   // Set parallel access
-  const hid_t plist_id = H5Pcreate(H5P_DATASET_XFER);
-  if (use_mpi_io)
-  {
-#ifdef H5_HAVE_PARALLEL
-    status = H5Pset_dxpl_mpio(plist_id, H5FD_MPIO_COLLECTIVE);
-    assert(status != HDF5_FAIL);
-#else
-    throw std::runtime_error("HDF5 library has not been configured with MPI");
-#endif
-  }
+  const hid_t plist_id = transfer_properties(options);
 
   // Write local dataset into selected hyperslab
   status = H5Dwrite(dset_id, h5type, memspace, filespace1, plist_id, data);
@@ -272,6 +393,170 @@ inline void HDF5Interface::write_dataset(
   // Release file-access template
   status = H5Pclose(plist_id);
   assert(status != HDF5_FAIL);
+
+  std::chrono::duration<double> dt
+      = std::chrono::system_clock::now() - timer_start;
+  std::int64_t num_bytes = sizeof(T);
+  for (hsize_t c : count)
+    num_bytes *= c;
+  dolfinx::register_io("HDF5 write", dataset_path, num_bytes, dt.count(),
+                       options.use_mpi_io and options.collective);
+}
+//---------------------------------------------------------------------------
+template <typename T>
+inline std::int64_t HDF5Interface::append_dataset(
+    const hid_t file_handle, const std::string& dataset_path, const T* data,
+    const std::array<std::int64_t, 2>& range,
+    const std::vector<int64_t>& global_size, const WriteOptions& options)
+{
+  auto timer_start = std::chrono::system_clock::now();
+
+  // Data rank
+  const std::size_t rank = global_size.size();
+  assert(rank != 0);
+  if (rank > 2)
+  {
+    throw std::runtime_error("Cannot append to dataset in HDF5 file. "
+                             "Only rank 1 and rank 2 dataset are supported");
+  }
+
+  // Get HDF5 data type
+  const hid_t h5type = hdf5_type<T>();
+
+  // Generic status report
+  herr_t status;
+
+  // Open and extend the dataset, or create it
+  std::vector<hsize_t> dimsf(global_size.begin(), global_size.end());
+  hsize_t row0 = 0;
+  hid_t dset_id;
+  if (has_dataset(file_handle, dataset_path))
+  {
+    dset_id = H5Dopen2(file_handle, dataset_path.c_str(), H5P_DEFAULT);
+    assert(dset_id != HDF5_FAIL);
+
+    const hid_t dataspace = H5Dget_space(dset_id);
+    assert(dataspace != HDF5_FAIL);
+    std::vector<hsize_t> dims0(rank);
+    if (H5Sget_simple_extent_ndims(dataspace) != (int)rank)
+      throw std::runtime_error("Cannot append data of different rank.");
+    H5Sget_simple_extent_dims(dataspace, dims0.data(), nullptr);
+    status = H5Sclose(dataspace);
+    assert(status != HDF5_FAIL);
+    if (rank == 2 and dims0[1] != dimsf[1])
+    {
+      throw std::runtime_error(
+          "Cannot append data with a different number of columns.");
+    }
+
+    row0 = dims0[0];
+    dimsf[0] += row0;
+    if (H5Dset_extent(dset_id, dimsf.data()) < 0)
+      throw std::runtime_error("Call to H5Dset_extent unsuccessful");
+  }
+  else
+  {
+    std::vector<hsize_t> maxdims = dimsf;
+    maxdims[0] = H5S_UNLIMITED;
+    const hid_t filespace0
+        = H5Screate_simple(rank, dimsf.data(), maxdims.data());
+    assert(filespace0 != HDF5_FAIL);
+
+    // Extendible datasets require chunking. By default, the rows that
+    // are appended at once are stored in one chunk, limited to 1MB.
+    std::vector<hsize_t> chunk_dims = dimsf;
+    chunk_dims[0] = options.chunk_rows;
+    if (chunk_dims[0] == 0)
+      chunk_dims[0] = std::clamp<hsize_t>(dimsf[0], 1, 1048576);
+    const hid_t chunking_properties = H5Pcreate(H5P_DATASET_CREATE);
+    H5Pset_chunk(chunking_properties, rank, chunk_dims.data());
+    add_filters<T>(chunking_properties, options);
+
+    // Check that group exists and recursively create if required
+    const std::string group_name(dataset_path, 0, dataset_path.rfind('/'));
+    add_group(file_handle, group_name);
+
+    dset_id = H5Dcreate2(file_handle, dataset_path.c_str(), h5type,
+                         filespace0, H5P_DEFAULT, chunking_properties,
+                         H5P_DEFAULT);
+    assert(dset_id != HDF5_FAIL);
+
+    status = H5Pclose(chunking_properties);
+    assert(status != HDF5_FAIL);
+    status = H5Sclose(filespace0);
+    assert(status != HDF5_FAIL);
+  }
+
+  // Create a local data space
+  std::vector<hsize_t> count(global_size.begin(), global_size.end());
+  count[0] = range[1] - range[0];
+  const hid_t memspace = H5Screate_simple(rank, count.data(), nullptr);
+  assert(memspace != HDF5_FAIL);
+
+  // Select the appended rows of this process - a hyperslab
+  std::vector<hsize_t> offset(rank, 0);
+  offset[0] = row0 + range[0];
+  const hid_t filespace1 = H5Dget_space(dset_id);
+  status = H5Sselect_hyperslab(filespace1, H5S_SELECT_SET, offset.data(),
+                               nullptr, count.data(), nullptr);
+  assert(status != HDF5_FAIL);
+
+  // Write local dataset into selected hyperslab
+  const hid_t plist_id = transfer_properties(options);
+  status = H5Dwrite(dset_id, h5type, memspace, filespace1, plist_id, data);
+  assert(status != HDF5_FAIL);
+
+  status = H5Pclose(plist_id);
+  assert(status != HDF5_FAIL);
+  status = H5Sclose(filespace1);
+  assert(status != HDF5_FAIL);
+  status = H5Sclose(memspace);
+  assert(status != HDF5_FAIL);
+  status = H5Dclose(dset_id);
+  assert(status != HDF5_FAIL);
+
+  std::chrono::duration<double> dt
+      = std::chrono::system_clock::now() - timer_start;
+  std::int64_t num_bytes = sizeof(T);
+  for (hsize_t c : count)
+    num_bytes *= c;
+  dolfinx::register_io("HDF5 append", dataset_path, num_bytes, dt.count(),
+                       options.use_mpi_io and options.collective);
+
+  return row0;
+}
+//---------------------------------------------------------------------------
+template <typename T>
+inline void HDF5Interface::add_filters(const hid_t plist_id,
+                                       const WriteOptions& options)
+{
+  // Add filters, in the order in which they are applied
+  if constexpr (std::is_floating_point_v<T>)
+  {
+    if (options.scale_offset_digits >= 0
+        and H5Pset_scaleoffset(plist_id, H5Z_SO_FLOAT_DSCALE,
+                               options.scale_offset_digits)
+                < 0)
+    {
+      throw std::runtime_error("Call to H5Pset_scaleoffset unsuccessful");
+    }
+  }
+  if (options.shuffle and H5Pset_shuffle(plist_id) < 0)
+    throw std::runtime_error("Call to H5Pset_shuffle unsuccessful");
+  if (options.deflate_level > 0
+      and H5Pset_deflate(plist_id, options.deflate_level) < 0)
+  {
+    throw std::runtime_error("Call to H5Pset_deflate unsuccessful");
+  }
+  if (options.szip)
+  {
+#ifdef H5_HAVE_FILTER_SZIP
+    if (H5Pset_szip(plist_id, H5_SZIP_NN_OPTION_MASK, 16) < 0)
+      throw std::runtime_error("Call to H5Pset_szip unsuccessful");
+#else
+    throw std::runtime_error("HDF5 library has not been configured with szip");
+#endif
+  }
 }
 //---------------------------------------------------------------------------
 template <typename T>
@@ -352,9 +637,13 @@ HDF5Interface::read_dataset(const hid_t file_handle,
 
   auto timer_end = std::chrono::system_clock::now();
   std::chrono::duration<double> dt = (timer_end - timer_start);
-  double data_rate = data.size() * sizeof(T) / (1e6 * dt.count());
-
-  LOG(INFO) << "HDF5 Read data rate: " << data_rate << "MB/s";
+  if (dolfinx::log::is_enabled(loguru::Verbosity_INFO))
+  {
+    double data_rate = data.size() * sizeof(T) / (1e6 * dt.count());
+    LOG(INFO) << "HDF5 Read data rate: " << data_rate << "MB/s";
+  }
+  dolfinx::register_io("HDF5 read", dataset_path, data.size() * sizeof(T),
+                       dt.count(), false);
 
   return data;
 }
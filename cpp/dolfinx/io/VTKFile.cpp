@@ -7,10 +7,15 @@
 #include "VTKFile.h"
 #include "cells.h"
 #include "pugixml.hpp"
+#include "utils.h"
 #include "xdmf_utils.h"
+#include <algorithm>
+#include <array>
 #include <boost/filesystem.hpp>
+#include <chrono>
 #include <dolfinx/common/IndexMap.h>
 #include <dolfinx/common/MPI.h>
+#include <dolfinx/common/timing.h>
 #include <dolfinx/fem/DofMap.h>
 #include <dolfinx/fem/FiniteElement.h>
 #include <dolfinx/fem/Function.h>
@@ -18,12 +23,25 @@
 #include <dolfinx/la/PETScVector.h>
 #include <dolfinx/mesh/Geometry.h>
 #include <dolfinx/mesh/Mesh.h>
+#include <dolfinx/mesh/MeshTags.h>
 #include <dolfinx/mesh/Topology.h>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 #include <xtensor/xcomplex.hpp>
 #include <xtl/xspan.hpp>
 
+#ifdef HAS_ZLIB
+#include <zlib.h>
+#endif
+
 using namespace dolfinx;
 
 namespace
@@ -101,16 +119,210 @@ std::int8_t get_vtk_cell_type(mesh::CellType cell, int dim)
   }
 }
 
-/// Convert and Eigen array/matrix to a std::string
+/// Convert an array to a std::string. Integers of type char are
+/// written as numbers.
 template <typename T>
 std::string xt_to_string(const T& x, int precision)
 {
   std::stringstream s;
   s.precision(precision);
-  for (std::uint32_t i = 0; i < x.size(); ++i)
-    s << x[i] << " ";
+  for (std::size_t i = 0; i < x.size(); ++i)
+    s << +x[i] << " ";
   return s.str();
 }
+//----------------------------------------------------------------------------
+
+/// Writer of the values of DataArray nodes with an encoding. For the
+/// binary encodings, the values are not converted to text but are
+/// appended to a buffer, which is written after the XML document when
+/// the VTU file is saved.
+class DataArrayWriter
+{
+public:
+  /// Create a writer
+  /// @param[in] encoding The encoding of the values
+  explicit DataArrayWriter(io::VTKFile::Encoding encoding)
+      : _encoding(encoding)
+  {
+    // Do nothing
+  }
+
+  /// Set the values of a DataArray node
+  /// @param[in,out] node The DataArray node
+  /// @param[in] x The values
+  template <typename T>
+  void write(pugi::xml_node& node, const xtl::span<const T>& x)
+  {
+    if (_encoding == io::VTKFile::Encoding::ASCII)
+    {
+      node.append_attribute("format") = "ascii";
+      node.append_child(pugi::node_pcdata)
+          .set_value(xt_to_string(x, 16).c_str());
+      return;
+    }
+
+    // The offset is the position of the array in the appended data
+    node.append_attribute("format") = "appended";
+    node.append_attribute("offset") = (unsigned long long)_data.size();
+    const char* bytes = reinterpret_cast<const char*>(x.data());
+    const std::uint64_t num_bytes = x.size() * sizeof(T);
+    if (_encoding == io::VTKFile::Encoding::Raw)
+    {
+      // The values are preceded by their size in bytes
+      append(&num_bytes, 1);
+      _data.insert(_data.end(), bytes, bytes + num_bytes);
+    }
+    else
+      compress(bytes, num_bytes);
+  }
+
+  /// Save a VTU document, followed by the appended data
+  /// @param[in,out] doc The VTU document. The AppendedData node is
+  /// added to the document for the binary encodings.
+  /// @param[in] filename The name of the file
+  void save(pugi::xml_document& doc,
+            const boost::filesystem::path& filename) const
+  {
+    if (_encoding == io::VTKFile::Encoding::ASCII)
+    {
+      io::save_xml(doc, filename.string(), "VTK write");
+      return;
+    }
+
+    auto timer_start = std::chrono::system_clock::now();
+
+    pugi::xml_node vtk_node = doc.child("VTKFile");
+    vtk_node.attribute("version") = "1.0";
+    vtk_node.append_attribute("byte_order")
+        = is_little_endian() ? "LittleEndian" : "BigEndian";
+    vtk_node.append_attribute("header_type") = "UInt64";
+    if (_encoding == io::VTKFile::Encoding::ZLib)
+      vtk_node.append_attribute("compressor") = "vtkZLibDataCompressor";
+    pugi::xml_node appended_node = vtk_node.append_child("AppendedData");
+    appended_node.append_attribute("encoding") = "raw";
+    appended_node.append_child(pugi::node_pcdata).set_value("_");
+
+    // Write the document, with the raw data inserted after the '_'
+    // marker of the AppendedData node
+    std::ostringstream ss;
+    doc.save(ss, "  ");
+    const std::string xml = ss.str();
+    const std::size_t pos = xml.rfind("_</AppendedData>");
+    assert(pos != std::string::npos);
+    std::ofstream file(filename.c_str(), std::ios::binary);
+    if (!file)
+    {
+      throw std::runtime_error("Could not open VTU file for writing: "
+                               + filename.string());
+    }
+    file.write(xml.data(), pos + 1);
+    file.write(_data.data(), _data.size());
+    file.write(xml.data() + pos + 1, xml.size() - pos - 1);
+    file.close();
+
+    std::chrono::duration<double> dt
+        = std::chrono::system_clock::now() - timer_start;
+    dolfinx::register_io("VTK write", filename.string(),
+                         xml.size() + _data.size(), dt.count(), false);
+  }
+
+  /// Appended data
+  const std::vector<char>& data() const { return _data; }
+
+  /// Add a Piece node of another writer, and its appended data, to a
+  /// VTU grid node. The offsets of the data arrays of the piece are
+  /// shifted to the end of the appended data of this writer.
+  /// @param[in,out] grid_node The UnstructuredGrid node
+  /// @param[in] piece_node The Piece node to add
+  /// @param[in] data The appended data of the piece
+  void append_piece(pugi::xml_node& grid_node, const pugi::xml_node& piece_node,
+                    const xtl::span<const char>& data)
+  {
+    pugi::xml_node piece = grid_node.append_copy(piece_node);
+    if (_encoding != io::VTKFile::Encoding::ASCII)
+    {
+      for (pugi::xml_node node : piece.children())
+      {
+        for (pugi::xml_node array : node.children("DataArray"))
+        {
+          pugi::xml_attribute offset = array.attribute("offset");
+          offset = offset.as_ullong() + (unsigned long long)_data.size();
+        }
+      }
+      _data.insert(_data.end(), data.begin(), data.end());
+    }
+  }
+
+private:
+  // Return true if the byte order of the machine is little endian
+  static bool is_little_endian()
+  {
+    const std::uint16_t x = 1;
+    return *reinterpret_cast<const std::uint8_t*>(&x) == 1;
+  }
+
+  // Append n values to the appended data
+  template <typename T>
+  void append(const T* x, std::size_t n)
+  {
+    const char* bytes = reinterpret_cast<const char*>(x);
+    _data.insert(_data.end(), bytes, bytes + n * sizeof(T));
+  }
+
+  // Append values compressed with zlib to the appended data, in the
+  // layout of vtkZLibDataCompressor. The values are compressed in
+  // blocks, and are preceded by the number of blocks, the uncompressed
+  // size of a block, the uncompressed size of the last block if it is
+  // partial (zero otherwise) and the compressed size of each block.
+  void compress([[maybe_unused]] const char* bytes,
+                [[maybe_unused]] std::uint64_t num_bytes)
+  {
+#ifdef HAS_ZLIB
+    const std::uint64_t block_size = 32768;
+    const std::uint64_t num_blocks = (num_bytes + block_size - 1) / block_size;
+    std::vector<std::uint64_t> header(3 + num_blocks);
+    header[0] = num_blocks;
+    header[1] = block_size;
+    header[2] = num_bytes % block_size;
+
+    // Reserve space for the header, which is set when the compressed
+    // sizes are known
+    const std::size_t header_pos = _data.size();
+    append(header.data(), header.size());
+    for (std::uint64_t b = 0; b < num_blocks; ++b)
+    {
+      const std::uint64_t offset = b * block_size;
+      const uLong size = std::min(block_size, num_bytes - offset);
+      uLongf compressed_size = compressBound(size);
+      const std::size_t pos = _data.size();
+      _data.resize(pos + compressed_size);
+      if (compress2(reinterpret_cast<Bytef*>(_data.data() + pos),
+                    &compressed_size,
+                    reinterpret_cast<const Bytef*>(bytes + offset), size,
+                    Z_DEFAULT_COMPRESSION)
+          != Z_OK)
+      {
+        throw std::runtime_error("Compression of VTK data with zlib failed");
+      }
+      _data.resize(pos + compressed_size);
+      header[3 + b] = compressed_size;
+    }
+    std::copy_n(reinterpret_cast<const char*>(header.data()),
+                header.size() * sizeof(std::uint64_t),
+                std::next(_data.begin(), header_pos));
+#else
+    throw std::runtime_error(
+        "DOLFINx has not been built with zlib. VTK data cannot be "
+        "compressed.");
+#endif
+  }
+
+  // The encoding
+  io::VTKFile::Encoding _encoding;
+
+  // Appended data
+  std::vector<char> _data;
+};
 
 void add_pvtu_mesh(pugi::xml_node& node)
 {
@@ -123,7 +335,8 @@ void add_pvtu_mesh(pugi::xml_node& node)
 /// At data to a pugixml node
 template <typename Scalar>
 void _add_data(const fem::Function<Scalar>& u,
-               const xt::xtensor<Scalar, 2>& values, pugi::xml_node& data_node)
+               const xt::xtensor<Scalar, 2>& values, pugi::xml_node& data_node,
+               DataArrayWriter& writer)
 {
   const int rank = u.function_space()->element()->value_rank();
   const int dim = u.function_space()->element()->value_size();
@@ -151,6 +364,15 @@ void _add_data(const fem::Function<Scalar>& u,
         "Cannot write data to VTK file. "
         "Only scalar, vector and tensor functions can be saved in VTK format");
   }
+
+  // Number of components of the VTK array. 2D vectors and tensors are
+  // padded with 0.0 to make them 3D.
+  int num_comp = 1;
+  if (rank == 1)
+    num_comp = 3;
+  else if (rank == 2)
+    num_comp = 9;
+
   // Loop for complex numbers, saved as real and imaginary part
   std::vector<std::string> components = {""};
   if constexpr (!std::is_scalar<Scalar>::value)
@@ -158,165 +380,167 @@ void _add_data(const fem::Function<Scalar>& u,
 
   for (const auto& component : components)
   {
+    std::string name = component + u.name;
+    xt::xtensor<double, 2> values_comp;
     if constexpr (!std::is_scalar<Scalar>::value)
     {
-      pugi::xml_node field_node = data_node.append_child("DataArray");
-      field_node.append_attribute("type") = "Float64";
-      field_node.append_attribute("Name") = (component + "_" + u.name).c_str();
-      field_node.append_attribute("format") = "ascii";
-      xt::xtensor<double, 2> values_comp;
-
+      name = component + "_" + u.name;
       if (component == "real")
         values_comp = xt::real(values);
       else if (component == "imag")
         values_comp = xt::imag(values);
-      if (rank == 0)
-      {
-        field_node.append_child(pugi::node_pcdata)
-            .set_value(xt_to_string(values_comp, 16).c_str());
-      }
-
-      else if (rank == 1)
-      {
-        field_node.append_attribute("NumberOfComponents") = 3;
-        if (dim == 2)
-        {
-          assert(values_comp.shape(1) == 2);
-          std::stringstream ss;
-          for (std::size_t i = 0; i < values_comp.shape(0); ++i)
-          {
-            for (int j = 0; j < 2; ++j)
-              ss << values_comp(i, j) << " ";
-            ss << 0.0 << " ";
-          }
-          field_node.append_child(pugi::node_pcdata)
-              .set_value(ss.str().c_str());
-        }
-        else
-        {
-          assert(values_comp.shape(2) == 3);
-          field_node.append_child(pugi::node_pcdata)
-              .set_value(xt_to_string(values_comp, 16).c_str());
-        }
-      }
-      else if (rank == 2)
-      {
-        field_node.append_attribute("NumberOfComponents") = 9;
-        if (dim == 4)
-        {
-          // Pad 2D tensors with 0.0 to make them 3D
-          std::stringstream ss;
-          for (std::size_t i = 0; i < values_comp.shape(0); ++i)
-          {
-            for (int j = 0; j < 2; ++j)
-            {
-              ss << values_comp(i, (2 * j + 0)) << " ";
-              ss << values_comp(i, (2 * j + 1)) << " ";
-              ss << 0.0 << " ";
-            }
-            ss << 0.0 << " ";
-            ss << 0.0 << " ";
-            ss << 0.0 << "  ";
-          }
-          field_node.append_child(pugi::node_pcdata)
-              .set_value(ss.str().c_str());
-        }
-        else
-        {
-          field_node.append_child(pugi::node_pcdata)
-              .set_value(xt_to_string(values_comp, 16).c_str());
-        }
-      }
     }
     else
-    {
-      pugi::xml_node field_node = data_node.append_child("DataArray");
-      field_node.append_attribute("type") = "Float64";
-      field_node.append_attribute("Name") = (component + u.name).c_str();
-      field_node.append_attribute("format") = "ascii";
+      values_comp = values;
 
-      if (rank == 0)
-      {
-        field_node.append_child(pugi::node_pcdata)
-            .set_value(xt_to_string(values, 16).c_str());
-      }
-      else if (rank == 1)
+    std::vector<double> data(values_comp.shape(0) * num_comp, 0.0);
+    for (std::size_t i = 0; i < values_comp.shape(0); ++i)
+    {
+      if (rank == 2 and dim == 4)
       {
-        field_node.append_attribute("NumberOfComponents") = 3;
-        if (dim == 2)
-        {
-          assert(values.shape(1) == 2);
-          std::stringstream ss;
-          for (size_t i = 0; i < values.shape(0); ++i)
-          {
-            for (int j = 0; j < 2; ++j)
-              ss << values(i, j) << " ";
-            ss << 0.0 << " ";
-          }
-          field_node.append_child(pugi::node_pcdata)
-              .set_value(ss.str().c_str());
-        }
-        else
+        for (int j = 0; j < 2; ++j)
         {
-          assert(values.shape(1) == 3);
-          field_node.append_child(pugi::node_pcdata)
-              .set_value(xt_to_string(values, 16).c_str());
+          data[i * num_comp + 3 * j] = values_comp(i, 2 * j);
+          data[i * num_comp + 3 * j + 1] = values_comp(i, 2 * j + 1);
         }
       }
-      else if (rank == 2)
+      else
       {
-        field_node.append_attribute("NumberOfComponents") = 9;
-        if (dim == 4)
-        {
-          // Pad 2D tensors with 0.0 to make them 3D
-          std::stringstream ss;
-          for (size_t i = 0; i < values.shape(0); ++i)
-          {
-            for (int j = 0; j < 2; ++j)
-            {
-              ss << values(i, (2 * j + 0)) << " ";
-              ss << values(i, (2 * j + 1)) << " ";
-              ss << 0.0 << " ";
-            }
-            ss << 0.0 << " ";
-            ss << 0.0 << " ";
-            ss << 0.0 << "  ";
-          }
-          field_node.append_child(pugi::node_pcdata)
-              .set_value(ss.str().c_str());
-        }
-        else
-        {
-          field_node.append_child(pugi::node_pcdata)
-              .set_value(xt_to_string(values, 16).c_str());
-        }
+        for (std::size_t j = 0; j < values_comp.shape(1); ++j)
+          data[i * num_comp + j] = values_comp(i, j);
       }
     }
+
+    pugi::xml_node field_node = data_node.append_child("DataArray");
+    field_node.append_attribute("type") = "Float64";
+    field_node.append_attribute("Name") = name.c_str();
+    if (rank > 0)
+      field_node.append_attribute("NumberOfComponents") = num_comp;
+    writer.write(field_node, xtl::span<const double>(data));
   }
 }
 //----------------------------------------------------------------------------
 void add_data(const fem::Function<double>& u,
-              const xt::xtensor<double, 2>& values, pugi::xml_node& data_node)
+              const xt::xtensor<double, 2>& values, pugi::xml_node& data_node,
+              DataArrayWriter& writer)
 {
-  _add_data(u, values, data_node);
+  _add_data(u, values, data_node, writer);
 }
 //----------------------------------------------------------------------------
 void add_data(const fem::Function<std::complex<double>>& u,
               const xt::xtensor<std::complex<double>, 2>& values,
-              pugi::xml_node& data_node)
+              pugi::xml_node& data_node, DataArrayWriter& writer)
+{
+  _add_data(u, values, data_node, writer);
+}
+//----------------------------------------------------------------------------
+
+/// Get the VTK connectivity of the cells of a mesh, i.e. the geometry
+/// nodes of the cells in VTK ordering. The connectivity of the most
+/// recently written meshes is cached by mesh id, so that it is not
+/// recomputed when the same mesh is written repeatedly, e.g. when a
+/// moving mesh or a time series of Functions is written.
+std::shared_ptr<const std::vector<std::int32_t>>
+vtk_connectivity(const mesh::Mesh& mesh)
+{
+  constexpr std::size_t capacity = 4;
+  static std::mutex mutex;
+  static std::list<
+      std::pair<std::size_t, std::shared_ptr<const std::vector<std::int32_t>>>>
+      cache;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = std::find_if(cache.begin(), cache.end(),
+                           [id = mesh.id()](auto& e) { return e.first == id; });
+    if (it != cache.end())
+    {
+      cache.splice(cache.begin(), cache, it);
+      return it->second;
+    }
+  }
+
+  // Get map from VTK index i to DOLFIN index j
+  const mesh::Topology& topology = mesh.topology();
+  const mesh::Geometry& geometry = mesh.geometry();
+  const int num_nodes = geometry.cmap().dof_layout().num_dofs();
+  std::vector<std::uint8_t> map
+      = io::cells::dolfinx_to_vtk(topology.cell_type(), num_nodes);
+  // TODO: Remove when when paraview issue 19433 is resolved
+  // (https://gitlab.kitware.com/paraview/paraview/issues/19433)
+  if (topology.cell_type() == mesh::CellType::hexahedron and num_nodes == 27)
+  {
+    map = {0,  9, 12, 3,  1, 10, 13, 4,  18, 15, 21, 6,  19, 16,
+           22, 7, 2,  11, 5, 14, 8,  17, 20, 23, 24, 25, 26};
+  }
+
+  const graph::AdjacencyList<std::int32_t>& x_dofmap = geometry.dofmap();
+  auto connectivity
+      = std::make_shared<std::vector<std::int32_t>>(x_dofmap.array().size());
+  io::cells::permute_cells(xtl::span<const std::int32_t>(x_dofmap.array()),
+                           num_nodes, map, xtl::span(*connectivity));
+
+  std::lock_guard<std::mutex> lock(mutex);
+  cache.emplace_front(mesh.id(), connectivity);
+  if (cache.size() > capacity)
+    cache.pop_back();
+  return connectivity;
+}
+//----------------------------------------------------------------------------
+
+/// Get the geometry nodes of a list of cells
+/// @param[in] geometry The mesh geometry
+/// @param[in] cells The cells
+/// @return The geometry nodes of the cells, sorted and without
+/// duplicates
+std::vector<std::int32_t> cell_nodes(const mesh::Geometry& geometry,
+                                     const xtl::span<const std::int32_t>& cells)
 {
-  _add_data(u, values, data_node);
+  const graph::AdjacencyList<std::int32_t>& x_dofmap = geometry.dofmap();
+  std::vector<std::int32_t> nodes;
+  for (std::int32_t c : cells)
+  {
+    auto x_dofs = x_dofmap.links(c);
+    nodes.insert(nodes.end(), x_dofs.begin(), x_dofs.end());
+  }
+  std::sort(nodes.begin(), nodes.end());
+  nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+  return nodes;
+}
+//----------------------------------------------------------------------------
+
+/// Extract rows of a 2D array
+template <typename T>
+xt::xtensor<T, 2> extract_rows(const xt::xtensor<T, 2>& values,
+                               const xtl::span<const std::int32_t>& rows)
+{
+  xt::xtensor<T, 2> values_r({rows.size(), values.shape(1)});
+  for (std::size_t i = 0; i < rows.size(); ++i)
+    for (std::size_t j = 0; j < values.shape(1); ++j)
+      values_r(i, j) = values(rows[i], j);
+  return values_r;
 }
 //----------------------------------------------------------------------------
 
 /// At mesh geometry and topology data to a pugixml node. The function /
 /// adds the Points and Cells nodes to the input node/
-void add_mesh(const mesh::Mesh& mesh, pugi::xml_node& piece_node)
+/// @param[in] mesh The mesh
+/// @param[in] cells The cells to add. All owned cells are added if
+/// empty.
+/// @param[in] nodes The geometry nodes of @p cells (see cell_nodes),
+/// which are added with a compact numbering
+/// @param[in,out] piece_node The Piece node
+/// @param[in,out] writer The writer of the data arrays
+void add_mesh(const mesh::Mesh& mesh,
+              const xtl::span<const std::int32_t>& cells,
+              const xtl::span<const std::int32_t>& nodes,
+              pugi::xml_node& piece_node, DataArrayWriter& writer)
 {
   const mesh::Topology& topology = mesh.topology();
   const mesh::Geometry& geometry = mesh.geometry();
   const int tdim = topology.dim();
-  const std::int32_t num_cells = topology.index_map(tdim)->size_local();
+  const std::int32_t num_cells
+      = cells.empty() ? topology.index_map(tdim)->size_local() : cells.size();
 
   // Add geometry (points)
 
@@ -324,9 +548,17 @@ void add_mesh(const mesh::Mesh& mesh, pugi::xml_node& piece_node)
   pugi::xml_node x_node = points_node.append_child("DataArray");
   x_node.append_attribute("type") = "Float64";
   x_node.append_attribute("NumberOfComponents") = "3";
-  x_node.append_attribute("format") = "ascii";
-  auto x = geometry.x();
-  x_node.append_child(pugi::node_pcdata).set_value(xt_to_string(x, 16).c_str());
+  auto& x = geometry.x();
+  if (cells.empty())
+    writer.write(x_node, xtl::span<const double>(x.data(), x.size()));
+  else
+  {
+    std::vector<double> x_r(3 * nodes.size());
+    for (std::size_t i = 0; i < nodes.size(); ++i)
+      std::copy_n(std::next(x.data(), 3 * nodes[i]), 3,
+                  std::next(x_r.begin(), 3 * i));
+    writer.write(x_node, xtl::span<const double>(x_r));
+  }
 
   // Add topology(cells)
 
@@ -336,60 +568,131 @@ void add_mesh(const mesh::Mesh& mesh, pugi::xml_node& piece_node)
   pugi::xml_node connectivity_node = cells_node.append_child("DataArray");
   connectivity_node.append_attribute("type") = "Int32";
   connectivity_node.append_attribute("Name") = "connectivity";
-  connectivity_node.append_attribute("format") = "ascii";
-
-  // Get map from VTK index i to DOLFIN index j
-  int num_nodes = geometry.cmap().dof_layout().num_dofs();
 
-  std::vector<std::uint8_t> map = io::cells::transpose(
-      io::cells::perm_vtk(topology.cell_type(), num_nodes));
-  // TODO: Remove when when paraview issue 19433 is resolved
-  // (https://gitlab.kitware.com/paraview/paraview/issues/19433)
-  if (topology.cell_type() == mesh::CellType::hexahedron and num_nodes == 27)
+  std::shared_ptr<const std::vector<std::int32_t>> connectivity
+      = vtk_connectivity(mesh);
+  if (cells.empty())
   {
-    map = {0,  9, 12, 3,  1, 10, 13, 4,  18, 15, 21, 6,  19, 16,
-           22, 7, 2,  11, 5, 14, 8,  17, 20, 23, 24, 25, 26};
+    writer.write(connectivity_node,
+                 xtl::span<const std::int32_t>(*connectivity));
   }
-
-  std::stringstream ss;
-  for (int c = 0; c < x_dofmap.num_nodes(); ++c)
+  else
   {
-    xtl::span<const std::int32_t> cell = x_dofmap.links(c);
-    const int num_cell_dofs = cell.size();
-    for (int i = 0; i < num_cell_dofs; ++i)
-      ss << cell[map[i]] << " ";
+    // Renumber the nodes of the cells to their positions in nodes
+    std::vector<std::int32_t> connectivity_r;
+    for (std::int32_t c : cells)
+    {
+      // The geometry dofmap may be compact, so the position of the
+      // cell is computed from its (constant) number of nodes
+      auto it = std::next(connectivity->begin(),
+                          std::size_t(c) * x_dofmap.num_links(c));
+      std::transform(it, std::next(it, x_dofmap.num_links(c)),
+                     std::back_inserter(connectivity_r),
+                     [&nodes](std::int32_t n) -> std::int32_t
+                     {
+                       return std::distance(
+                           nodes.begin(),
+                           std::lower_bound(nodes.begin(), nodes.end(), n));
+                     });
+    }
+    writer.write(connectivity_node,
+                 xtl::span<const std::int32_t>(connectivity_r));
   }
-  connectivity_node.append_child(pugi::node_pcdata).set_value(ss.str().c_str());
 
   pugi::xml_node offsets_node = cells_node.append_child("DataArray");
   offsets_node.append_attribute("type") = "Int32";
   offsets_node.append_attribute("Name") = "offsets";
-  offsets_node.append_attribute("format") = "ascii";
-  const std::vector<std::int32_t>& offsets = x_dofmap.offsets();
-  std::stringstream ss_offset;
-  ss_offset.precision(0);
-  for (std::int32_t i = 1; i <= num_cells; ++i)
-    ss_offset << offsets[i] << " ";
-
-  offsets_node.append_child(pugi::node_pcdata)
-      .set_value(ss_offset.str().c_str());
+  std::vector<std::int32_t> offsets(num_cells);
+  std::int32_t offset = 0;
+  for (std::int32_t i = 0; i < num_cells; ++i)
+  {
+    offset += x_dofmap.num_links(cells.empty() ? i : cells[i]);
+    offsets[i] = offset;
+  }
+  writer.write(offsets_node, xtl::span<const std::int32_t>(offsets));
 
   pugi::xml_node type_node = cells_node.append_child("DataArray");
   type_node.append_attribute("type") = "Int8";
   type_node.append_attribute("Name") = "types";
-  type_node.append_attribute("format") = "ascii";
-  int celltype = get_vtk_cell_type(topology.cell_type(), tdim);
-  std::stringstream s;
-  for (std::int32_t c = 0; c < num_cells; ++c)
-    s << celltype << " ";
-  type_node.append_child(pugi::node_pcdata).set_value(s.str().c_str());
+  const std::vector<std::int8_t> types(
+      num_cells, get_vtk_cell_type(topology.cell_type(), tdim));
+  writer.write(type_node, xtl::span<const std::int8_t>(types));
+}
+//----------------------------------------------------------------------------
+/// Gather the pieces of the ranks of a group to the first rank of the
+/// group, which saves them to one VTU file
+/// @param[in,out] vtu The VTU document of this rank, with one Piece node
+/// @param[in,out] writer The writer of the data arrays of the piece
+/// @param[in] comm The communicator of the group
+/// @param[in] filename The name of the VTU file
+void save_vtu(pugi::xml_document& vtu, DataArrayWriter& writer,
+              MPI_Comm comm, const boost::filesystem::path& filename)
+{
+  const int size = dolfinx::MPI::size(comm);
+  const int rank = dolfinx::MPI::rank(comm);
+  if (size > 1)
+  {
+    pugi::xml_node grid_node = vtu.child("VTKFile").child("UnstructuredGrid");
+    assert(grid_node);
+
+    // Pack the XML of the piece followed by its appended data
+    std::ostringstream ss;
+    grid_node.child("Piece").print(ss, "", pugi::format_raw);
+    const std::string xml = ss.str();
+    std::vector<char> buffer(xml.begin(), xml.end());
+    buffer.insert(buffer.end(), writer.data().begin(), writer.data().end());
+    if (buffer.size() > (std::size_t)std::numeric_limits<int>::max())
+      throw std::runtime_error("VTK piece is too large to be gathered.");
+
+    // Gather the sizes of the XML and data of each piece
+    const std::array<std::int64_t, 2> sizes
+        = {(std::int64_t)xml.size(), (std::int64_t)writer.data().size()};
+    std::vector<std::int64_t> all_sizes(rank == 0 ? 2 * size : 0);
+    MPI_Gather(sizes.data(), 2, MPI_INT64_T, all_sizes.data(), 2,
+               MPI_INT64_T, 0, comm);
+
+    std::vector<int> counts, displs(1, 0);
+    if (rank == 0)
+    {
+      for (int r = 0; r < size; ++r)
+      {
+        const std::int64_t count = all_sizes[2 * r] + all_sizes[2 * r + 1];
+        if (displs.back() + count > std::numeric_limits<int>::max())
+          throw std::runtime_error("VTK pieces are too large to be gathered.");
+        counts.push_back((int)count);
+        displs.push_back(displs.back() + (int)count);
+      }
+    }
+
+    std::vector<char> recv_buffer(rank == 0 ? displs.back() : 0);
+    MPI_Gatherv(buffer.data(), buffer.size(), MPI_CHAR, recv_buffer.data(),
+                counts.data(), displs.data(), MPI_CHAR, 0, comm);
+    if (rank != 0)
+      return;
+
+    // Add the pieces of the other ranks after the piece of this rank
+    for (int r = 1; r < size; ++r)
+    {
+      const char* p = recv_buffer.data() + displs[r];
+      pugi::xml_document piece;
+      if (!piece.load_buffer(p, all_sizes[2 * r]))
+        throw std::runtime_error("Could not parse gathered VTK piece.");
+      writer.append_piece(
+          grid_node, piece.first_child(),
+          xtl::span<const char>(p + all_sizes[2 * r], all_sizes[2 * r + 1]));
+    }
+  }
+
+  writer.save(vtu, filename);
 }
 //----------------------------------------------------------------------------
 template <typename Scalar>
 void write_function(
     const std::vector<std::reference_wrapper<const fem::Function<Scalar>>>& u,
     double time, std::unique_ptr<pugi::xml_document>& xml_doc,
-    const std::string filename)
+    const std::string filename, io::VTKFile::Encoding encoding,
+    MPI_Comm group_comm, int group, int num_groups,
+    const std::vector<std::int32_t>& cells)
 {
   if (!xml_doc)
     throw std::runtime_error("VTKFile has already been closed");
@@ -427,9 +730,13 @@ void write_function(
   const mesh::Topology& topology = mesh->topology();
   const mesh::Geometry& geometry = mesh->geometry();
   const int tdim = topology.dim();
+  const std::vector<std::int32_t> nodes = cell_nodes(geometry, cells);
   const std::int32_t num_points
-      = geometry.index_map()->size_local() + geometry.index_map()->num_ghosts();
-  const std::int32_t num_cells = topology.index_map(tdim)->size_local();
+      = cells.empty() ? geometry.index_map()->size_local()
+                            + geometry.index_map()->num_ghosts()
+                      : nodes.size();
+  const std::int32_t num_cells
+      = cells.empty() ? topology.index_map(tdim)->size_local() : cells.size();
 
   // Create a VTU XML object
   pugi::xml_document xml_vtu;
@@ -444,7 +751,8 @@ void write_function(
   piece_node.append_attribute("NumberOfCells") = num_cells;
 
   // Add mesh data to "Piece" node
-  add_mesh(*mesh, piece_node);
+  DataArrayWriter writer(encoding);
+  add_mesh(*mesh, cells, nodes, piece_node, writer);
 
   // Loop through functions to add data types and ranks
   for (auto _u : u)
@@ -493,135 +801,54 @@ void write_function(
           _values(i, j) = values[i * value_size + j];
         }
       }
+      if (!cells.empty())
+        _values = extract_rows(_values, xtl::span<const std::int32_t>(cells));
       pugi::xml_node data_node = piece_node.child("CellData");
       assert(!data_node.empty());
-      add_data(_u, _values, data_node);
+      add_data(_u, _values, data_node, writer);
     }
     else
     {
-      // Check if the function space is Lagrangian
+      // Lagrange functions with the degree-of-freedom layout of the
+      // geometry are written at the geometry nodes directly. Other
+      // functions are interpolated into a first order Lagrange space.
       // NOTE: This should be changed if we add option to visualize DG
-      std::shared_ptr<const dolfinx::fem::FiniteElement> element
-          = _u.get().function_space()->element();
-      if ((element->family().compare("Lagrange") == 0)
-          or (element->family().compare("Q") == 0))
+      std::shared_ptr<const fem::FunctionSpace> V
+          = _u.get().function_space();
+      xt::xtensor<Scalar, 2> point_values;
+      if (io::xdmf_utils::has_geometry_dof_layout(*V))
       {
-        // Extract mesh data
-        int tdim = mesh->topology().dim();
-        auto cmap = mesh->geometry().cmap();
-        auto geometry_layout = cmap.dof_layout();
-        // Extract function value
         const std::vector<Scalar>& func_values = _u.get().x()->array();
-
-        // Compute in tensor (one for scalar function, . . .)
-        const size_t value_size_loc = element->value_size();
-
-        // FIXME: Add proper interface for num coordinate dofs
+        std::shared_ptr<const fem::DofMap> dofmap = V->dofmap();
+        const int bs = dofmap->bs();
         const graph::AdjacencyList<std::int32_t>& x_dofmap
             = mesh->geometry().dofmap();
-        const int num_dofs_g = x_dofmap.num_links(0);
-
-        auto map = mesh->topology().index_map(tdim);
-        assert(map);
-        const std::int32_t num_cells = map->size_local();
-
-        // Resize array for holding point values
-        xt::xtensor<Scalar, 2> point_values(
-            {mesh->geometry().x().shape(0), value_size_loc});
-
-        // If scalar function space
-        if (element->num_sub_elements() == 0)
+        point_values = xt::zeros<Scalar>(
+            {mesh->geometry().x().shape(0), static_cast<std::size_t>(bs)});
+        for (std::int32_t c = 0; c < x_dofmap.num_nodes(); ++c)
         {
-          auto dofmap = _u.get().function_space()->dofmap();
-          auto element_layout = dofmap->element_dof_layout;
-          for (std::int32_t i = 0; i <= tdim; i++)
+          auto x_dofs = x_dofmap.links(c);
+          auto cell_dofs = dofmap->cell_dofs(c);
+          for (std::size_t i = 0; i < x_dofs.size(); ++i)
           {
-            // Check that subelement layout matches geometry layout
-            if (geometry_layout.num_entity_dofs(i)
-                != element_layout->num_entity_dofs(i))
-            {
-              // throw std::runtime_error("Can only save Lagrange finite element
-              // "
-              //                          "functions of same order "
-              //                          "as the mesh geometry");
-              LOG(WARNING) << "Output data is interpolated into a first order "
-                              "Lagrange space.";
-              point_values = _u.get().compute_point_values();
-            }
-          }
-          // Loop through cells
-          for (std::int32_t c = 0; c < num_cells; ++c)
-          {
-            // Get local to global dof ordering for geometry and function
-            auto dofs = x_dofmap.links(c);
-            auto cell_dofs = dofmap->cell_dofs(c);
-            for (std::int32_t i = 0; i < num_dofs_g; i++)
-            {
-              point_values(dofs[i], 0) = func_values[cell_dofs[i]];
-            }
+            for (int k = 0; k < bs; ++k)
+              point_values(x_dofs[i], k) = func_values[bs * cell_dofs[i] + k];
           }
         }
-
-        // Loop through each vector/tensor component
-        bool element_matching_mesh = true;
-        for (std::int32_t k = 0; k < element->num_sub_elements(); k++)
-        {
-          auto dofmap = _u.get().function_space()->sub({k})->dofmap();
-          auto element_layout = dofmap->element_dof_layout;
-
-          for (std::int32_t i = 0; i <= tdim; i++)
-          {
-            // Check that subelement layout matches geometry layout
-            if (geometry_layout.num_entity_dofs(i)
-                != element_layout->num_entity_dofs(i))
-            {
-              element_matching_mesh = false;
-              break;
-              // throw std::runtime_error("Can only save Lagrange finite
-              // element
-              // "
-              //                          "functions of same order "
-              //                          "as the mesh geometry");
-            }
-          }
-          if (element_matching_mesh)
-          {
-            // Loop through cells
-            for (std::int32_t c = 0; c < num_cells; ++c)
-            {
-              // Get local to global dof ordering for geometry and function
-              auto dofs = x_dofmap.links(c);
-              auto cell_dofs = dofmap->cell_dofs(c);
-              for (std::int32_t i = 0; i < num_dofs_g; i++)
-              {
-                point_values(dofs[i], k) = func_values[cell_dofs[i]];
-              }
-            }
-          }
-          else
-          {
-            LOG(WARNING) << "Output data is interpolated into a first order "
-                            "Lagrange space.";
-            break;
-          }
-        }
-        if (!element_matching_mesh)
-          point_values = _u.get().compute_point_values();
-        pugi::xml_node data_node = piece_node.child("PointData");
-        assert(!data_node.empty());
-        add_data(_u, point_values, data_node);
       }
       else
       {
         LOG(WARNING) << "Output data is interpolated into a first order "
                         "Lagrange space.";
-        xt::xtensor<Scalar, 2> point_values = _u.get().compute_point_values();
-        pugi::xml_node data_node = piece_node.child("PointData");
-        assert(!data_node.empty());
-        add_data(_u, point_values, data_node);
-        // throw std::runtime_error("Can only visualize Lagrange finite
-        // elements");
+        point_values = _u.get().compute_point_values();
       }
+
+      if (!cells.empty())
+        point_values = extract_rows(point_values,
+                                    xtl::span<const std::int32_t>(nodes));
+      pugi::xml_node data_node = piece_node.child("PointData");
+      assert(!data_node.empty());
+      add_data(_u, point_values, data_node, writer);
     }
   }
 
@@ -629,10 +856,10 @@ void write_function(
   boost::filesystem::path vtu(p.parent_path());
   if (!p.parent_path().empty())
     vtu += "/";
-  vtu += p.stem().string() + "_p" + std::to_string(mpi_rank) + "_"
+  vtu += p.stem().string() + "_p" + std::to_string(group) + "_"
          + counter_str;
   vtu.replace_extension("vtu");
-  xml_vtu.save_file(vtu.c_str(), "  ");
+  save_vtu(xml_vtu, writer, group_comm, vtu);
 
   // Create a PVTU XML object on rank 0
   boost::filesystem::path p_pvtu(p.parent_path());
@@ -690,9 +917,8 @@ void write_function(
         data_node.append_attribute("NumberOfComponents") = ncomps;
       }
 
-      // Add data for each process to the PVTU object
-      const int mpi_size = dolfinx::MPI::size(mpi_comm);
-      for (int i = 0; i < mpi_size; ++i)
+      // Add data for each file to the PVTU object
+      for (int i = 0; i < num_groups; ++i)
       {
         boost::filesystem::path vtu = p.stem();
         vtu += "_p" + std::to_string(i) + "_" + counter_str;
@@ -703,7 +929,7 @@ void write_function(
       }
     }
     // Write PVTU file
-    xml_pvtu.save_file(p_pvtu.c_str(), "  ");
+    io::save_xml(xml_pvtu, p_pvtu.string(), "VTK write");
   }
 
   // Append PVD file
@@ -719,9 +945,45 @@ void write_function(
 
 //----------------------------------------------------------------------------
 io::VTKFile::VTKFile(MPI_Comm comm, const std::string filename,
-                     const std::string)
-    : _filename(filename), _comm(comm)
+                     const std::string, Encoding encoding,
+                     int ranks_per_file)
+    : _filename(filename), _encoding(encoding), _comm(comm),
+      _group_comm(MPI_COMM_NULL), _group(0), _num_groups(0), _stride(1),
+      _num_writes(0)
 {
+#ifndef HAS_ZLIB
+  if (encoding == Encoding::ZLib)
+  {
+    throw std::runtime_error(
+        "DOLFINx has not been built with zlib. Cannot create VTKFile with "
+        "ZLib encoding.");
+  }
+#endif
+
+  // Group the ranks that write to the same VTU file
+  if (ranks_per_file < 0)
+    throw std::runtime_error("Number of ranks per VTU file is negative.");
+  const int mpi_rank = MPI::rank(_comm.comm());
+  MPI_Comm group_comm;
+  if (ranks_per_file == 0)
+  {
+    MPI_Comm_split_type(_comm.comm(), MPI_COMM_TYPE_SHARED, mpi_rank,
+                        MPI_INFO_NULL, &group_comm);
+  }
+  else
+  {
+    MPI_Comm_split(_comm.comm(), mpi_rank / ranks_per_file, mpi_rank,
+                   &group_comm);
+  }
+  _group_comm = MPI::Comm(group_comm, false);
+
+  // Number the files by the first rank of each group
+  int is_first = MPI::rank(group_comm) == 0 ? 1 : 0;
+  MPI_Exscan(&is_first, &_group, 1, MPI_INT, MPI_SUM, _comm.comm());
+  if (mpi_rank == 0)
+    _group = 0;
+  MPI_Allreduce(&is_first, &_num_groups, 1, MPI_INT, MPI_SUM, _comm.comm());
+
   _pvd_xml = std::make_unique<pugi::xml_document>();
   assert(_pvd_xml);
   pugi::xml_node vtk_node = _pvd_xml->append_child("VTKFile");
@@ -740,7 +1002,7 @@ void io::VTKFile::close()
 {
   if (_pvd_xml and MPI::rank(_comm.comm()) == 0)
   {
-    bool status = _pvd_xml->save_file(_filename.c_str(), "  ");
+    bool status = io::save_xml(*_pvd_xml, _filename, "VTK write");
     if (status == false)
     {
       throw std::runtime_error(
@@ -756,14 +1018,63 @@ void io::VTKFile::flush()
     throw std::runtime_error("VTKFile has already been closed");
 
   if (MPI::rank(_comm.comm()) == 0)
-    _pvd_xml->save_file(_filename.c_str(), "  ");
+    io::save_xml(*_pvd_xml, _filename, "VTK write");
+}
+//----------------------------------------------------------------------------
+void io::VTKFile::set_cells(const xtl::span<const std::int32_t>& cells)
+{
+  _cells.assign(cells.begin(), cells.end());
+}
+//----------------------------------------------------------------------------
+void io::VTKFile::set_cells(const mesh::MeshTags<std::int32_t>& tags,
+                            std::int32_t value)
+{
+  std::shared_ptr<const mesh::Mesh> mesh = tags.mesh();
+  assert(mesh);
+  const int tdim = mesh->topology().dim();
+  const std::int32_t num_cells = mesh->topology().index_map(tdim)->size_local();
+  std::vector<std::int32_t> entities = tags.find(value);
+
+  if (tags.dim() == tdim)
+    _cells = std::move(entities);
+  else
+  {
+    auto e_to_c = mesh->topology().connectivity(tags.dim(), tdim);
+    if (!e_to_c)
+    {
+      throw std::runtime_error("Connectivity from the tagged entities to the "
+                               "cells has not been computed.");
+    }
+    _cells.clear();
+    for (std::int32_t e : entities)
+    {
+      auto cells = e_to_c->links(e);
+      _cells.insert(_cells.end(), cells.begin(), cells.end());
+    }
+  }
+
+  // Keep the owned cells, without duplicates
+  std::sort(_cells.begin(), _cells.end());
+  _cells.erase(std::unique(_cells.begin(), _cells.end()), _cells.end());
+  _cells.erase(std::lower_bound(_cells.begin(), _cells.end(), num_cells),
+               _cells.end());
+}
+//----------------------------------------------------------------------------
+void io::VTKFile::set_stride(int stride)
+{
+  if (stride < 1)
+    throw std::runtime_error("Output stride must be positive.");
+  _stride = stride;
 }
 //----------------------------------------------------------------------------
 void io::VTKFile::write(
     const std::vector<std::reference_wrapper<const fem::Function<double>>>& u,
     double time)
 {
-  write_function(u, time, _pvd_xml, _filename);
+  if (_num_writes++ % _stride != 0)
+    return;
+  write_function(u, time, _pvd_xml, _filename, _encoding, _group_comm.comm(),
+                 _group, _num_groups, _cells);
 }
 //----------------------------------------------------------------------------
 void io::VTKFile::write(
@@ -771,13 +1082,18 @@ void io::VTKFile::write(
         std::reference_wrapper<const fem::Function<std::complex<double>>>>& u,
     double time)
 {
-  write_function(u, time, _pvd_xml, _filename);
+  if (_num_writes++ % _stride != 0)
+    return;
+  write_function(u, time, _pvd_xml, _filename, _encoding, _group_comm.comm(),
+                 _group, _num_groups, _cells);
 }
 //----------------------------------------------------------------------------
 void io::VTKFile::write(const mesh::Mesh& mesh, double time)
 {
   if (!_pvd_xml)
     throw std::runtime_error("VTKFile has already been closed");
+  if (_num_writes++ % _stride != 0)
+    return;
 
   const int mpi_rank = MPI::rank(_comm.comm());
   boost::filesystem::path p(_filename);
@@ -794,9 +1110,13 @@ void io::VTKFile::write(const mesh::Mesh& mesh, double time)
   const mesh::Topology& topology = mesh.topology();
   const mesh::Geometry& geometry = mesh.geometry();
   const int tdim = topology.dim();
+  const std::vector<std::int32_t> nodes = cell_nodes(geometry, _cells);
   const std::int32_t num_points
-      = geometry.index_map()->size_local() + geometry.index_map()->num_ghosts();
-  const std::int32_t num_cells = topology.index_map(tdim)->size_local();
+      = _cells.empty() ? geometry.index_map()->size_local()
+                             + geometry.index_map()->num_ghosts()
+                       : nodes.size();
+  const std::int32_t num_cells
+      = _cells.empty() ? topology.index_map(tdim)->size_local() : _cells.size();
 
   // Create a VTU XML object
   pugi::xml_document xml_vtu;
@@ -811,16 +1131,17 @@ void io::VTKFile::write(const mesh::Mesh& mesh, double time)
   piece_node.append_attribute("NumberOfCells") = num_cells;
 
   // Add mesh data to "Piece" node
-  add_mesh(mesh, piece_node);
+  DataArrayWriter writer(_encoding);
+  add_mesh(mesh, _cells, nodes, piece_node, writer);
 
   // Save VTU XML to file
   boost::filesystem::path vtu(p.parent_path());
   if (!p.parent_path().empty())
     vtu += "/";
-  vtu += p.stem().string() + "_p" + std::to_string(mpi_rank) + "_"
+  vtu += p.stem().string() + "_p" + std::to_string(_group) + "_"
          + counter_str;
   vtu.replace_extension("vtu");
-  xml_vtu.save_file(vtu.c_str(), "  ");
+  save_vtu(xml_vtu, writer, _group_comm.comm(), vtu);
 
   // Create a PVTU XML object on rank 0
   boost::filesystem::path p_pvtu(p.parent_path());
@@ -840,9 +1161,8 @@ void io::VTKFile::write(const mesh::Mesh& mesh, double time)
     // Add mesh metadata to PVTU object
     add_pvtu_mesh(grid_node);
 
-    // Add data for each process to the PVTU object
-    const int mpi_size = MPI::size(_comm.comm());
-    for (int i = 0; i < mpi_size; ++i)
+    // Add data for each file to the PVTU object
+    for (int i = 0; i < _num_groups; ++i)
     {
       boost::filesystem::path vtu = p.stem();
       vtu += "_p" + std::to_string(i) + "_" + counter_str;
@@ -852,7 +1172,7 @@ void io::VTKFile::write(const mesh::Mesh& mesh, double time)
     }
 
     // Write PVTU file
-    xml_pvtu.save_file(p_pvtu.c_str(), "  ");
+    io::save_xml(xml_pvtu, p_pvtu.string(), "VTK write");
   }
 
   // Append PVD file
@@ -6,11 +6,14 @@
 
 #pragma once
 
+#include <cstdint>
 #include <dolfinx/common/MPI.h>
 #include <dolfinx/fem/Function.h>
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
+#include <xtl/xspan.hpp>
 
 namespace pugi
 {
@@ -26,6 +29,8 @@ class Function;
 namespace dolfinx::mesh
 {
 class Mesh;
+template <typename T>
+class MeshTags;
 }
 
 namespace dolfinx::io
@@ -44,9 +49,31 @@ namespace dolfinx::io
 class VTKFile
 {
 public:
+  /// Encoding of the data arrays in the VTU files
+  enum class Encoding
+  {
+    ASCII,
+    Raw,
+    ZLib
+  };
+
   /// Create VTK file
+  /// @param[in] comm The MPI communicator
+  /// @param[in] filename Name of the PVD file
+  /// @param[in] file_mode The file mode
+  /// @param[in] encoding The encoding of the data arrays. With
+  /// Encoding::ASCII the values are written as text. With Encoding::Raw
+  /// the values are written as raw binary data that is appended to the
+  /// VTU files, and with Encoding::ZLib the appended data is compressed
+  /// with zlib, which requires DOLFINx to be built with zlib.
+  /// @param[in] ranks_per_file The number of consecutive ranks whose
+  /// pieces are gathered by the first rank of the group and written to
+  /// one VTU file. If zero, the ranks on each shared memory node are
+  /// grouped. The default writes one VTU file per rank. Grouping ranks
+  /// reduces the number of files that are created by each output.
   VTKFile(MPI_Comm comm, const std::string filename,
-          const std::string file_mode);
+          const std::string file_mode, Encoding encoding = Encoding::ASCII,
+          int ranks_per_file = 1);
 
   /// Destructor
   ~VTKFile();
@@ -57,6 +84,30 @@ public:
   /// Flushes XML files to disk
   void flush();
 
+  /// Restrict the output to a region of interest. Only the given cells
+  /// and their geometry nodes are written by later calls to
+  /// VTKFile::write, with the nodes renumbered to a compact local
+  /// geometry. The cell indices refer to the mesh that is written.
+  /// @param[in] cells The local indices of owned cells to write. If
+  /// empty, all cells are written (default).
+  void set_cells(const xtl::span<const std::int32_t>& cells);
+
+  /// Restrict the output to the cells that are incident to the
+  /// entities with a given tag value, e.g. the cells at a tagged
+  /// boundary, see VTKFile::set_cells
+  /// @note The connectivity from the entities of the MeshTags to the
+  /// cells must have been computed
+  /// @param[in] tags The MeshTags
+  /// @param[in] value The tag value of the entities
+  void set_cells(const mesh::MeshTags<std::int32_t>& tags,
+                 std::int32_t value);
+
+  /// Write the output of only every stride-th call to VTKFile::write,
+  /// e.g. to decimate the output of a time series. The first call is
+  /// always written.
+  /// @param[in] stride The stride (default 1, all calls are written)
+  void set_stride(int stride);
+
   /// Write mesh to file. Supports arbitrary order Lagrange
   /// isoparametric cells.
   /// @param[in] mesh The Mesh to write to file
@@ -83,7 +134,25 @@ private:
 
   std::string _filename;
 
+  // Encoding of the data arrays
+  Encoding _encoding;
+
   // MPI communicator
   dolfinx::MPI::Comm _comm;
+
+  // Communicator of the ranks that write to the same VTU file, the
+  // index of the file (on the first rank of the group) and the number
+  // of files
+  dolfinx::MPI::Comm _group_comm;
+  int _group;
+  int _num_groups;
+
+  // Cells that are written (all cells if empty)
+  std::vector<std::int32_t> _cells;
+
+  // Stride of the calls to write that are written, and the number of
+  // calls
+  int _stride;
+  std::int64_t _num_writes;
 };
 } // namespace dolfinx::io
@@ -6,7 +6,9 @@
 
 #include "XDMFFile.h"
 #include "cells.h"
+#include "checkpoint.h"
 #include "pugixml.hpp"
+#include "utils.h"
 #include "xdmf_function.h"
 #include "xdmf_mesh.h"
 #include "xdmf_meshtags.h"
@@ -14,7 +16,9 @@
 #include "xdmf_utils.h"
 #include <boost/filesystem.hpp>
 #include <boost/lexical_cast.hpp>
+#include <chrono>
 #include <dolfinx/common/log.h>
+#include <dolfinx/common/timing.h>
 #include <dolfinx/common/utils.h>
 #include <dolfinx/fem/Function.h>
 #include <dolfinx/graph/AdjacencyList.h>
@@ -22,6 +26,8 @@
 #include <dolfinx/mesh/Mesh.h>
 #include <dolfinx/mesh/MeshTags.h>
 #include <dolfinx/mesh/utils.h>
+#include <fstream>
+#include <iterator>
 
 using namespace dolfinx;
 using namespace dolfinx::io;
@@ -31,8 +37,12 @@ namespace
 template <typename Scalar>
 void _write_function(dolfinx::MPI::Comm& comm,
                      const fem::Function<Scalar>& function, const double t,
-                     const std::string& mesh_xpath, pugi::xml_document& xml_doc,
-                     hid_t h5_id, const std::string& filename)
+                     const std::string& mesh_xpath,
+                     const std::string& geometry_xpath,
+                     pugi::xml_document& xml_doc,
+                     hid_t h5_id,
+                     const HDF5Interface::WriteOptions& h5_options,
+                     const std::string& filename)
 {
   const std::string timegrid_xpath
       = "/Xdmf/Domain/Grid[@GridType='Collection'][@Name='" + function.name
@@ -63,12 +73,31 @@ void _write_function(dolfinx::MPI::Comm& comm,
                  << "'. Write mesh before function!";
   }
 
-  const std::string ref_path
-      = "xpointer(" + mesh_xpath + "/*[self::Topology or self::Geometry])";
-
-  pugi::xml_node topo_geo_ref = grid_node.append_child("xi:include");
-  topo_geo_ref.append_attribute("xpointer") = ref_path.c_str();
-  assert(topo_geo_ref);
+  if (geometry_xpath.empty())
+  {
+    const std::string ref_path
+        = "xpointer(" + mesh_xpath + "/*[self::Topology or self::Geometry])";
+    pugi::xml_node topo_geo_ref = grid_node.append_child("xi:include");
+    topo_geo_ref.append_attribute("xpointer") = ref_path.c_str();
+    assert(topo_geo_ref);
+  }
+  else
+  {
+    // Refer to the moved geometry, e.g. for ALE
+    if (!xml_doc.select_node(geometry_xpath.c_str()).node())
+    {
+      throw std::runtime_error("No Geometry found at '" + geometry_xpath
+                               + "'.");
+    }
+    const std::string topo_path = "xpointer(" + mesh_xpath + "/Topology)";
+    pugi::xml_node topo_ref = grid_node.append_child("xi:include");
+    topo_ref.append_attribute("xpointer") = topo_path.c_str();
+    assert(topo_ref);
+    const std::string geo_path = "xpointer(" + geometry_xpath + ")";
+    pugi::xml_node geo_ref = grid_node.append_child("xi:include");
+    geo_ref.append_attribute("xpointer") = geo_path.c_str();
+    assert(geo_ref);
+  }
 
   std::string t_str = boost::lexical_cast<std::string>(t);
   pugi::xml_node time_node = grid_node.append_child("Time");
@@ -76,11 +105,58 @@ void _write_function(dolfinx::MPI::Comm& comm,
   assert(time_node);
 
   // Add the mesh Grid to the domain
-  xdmf_function::add_function(comm.comm(), function, t, grid_node, h5_id);
+  xdmf_function::add_function(comm.comm(), function, t, grid_node, h5_id,
+                              h5_options);
 
   // Save XML file (on process 0 only)
   if (dolfinx::MPI::rank(comm.comm()) == 0)
-    xml_doc.save_file(filename.c_str(), "  ");
+    io::save_xml(xml_doc, filename, "XDMF write");
+}
+//-----------------------------------------------------------------------------
+
+// Load the XML document of an XDMF file. The file is read from disk on
+// process 0 only, and its text is broadcast to the other processes,
+// which parse it from memory.
+void load_xml(MPI_Comm comm, const std::string& filename,
+              pugi::xml_document& xml_doc)
+{
+  std::string buffer;
+  std::int64_t size = 0;
+  if (dolfinx::MPI::rank(comm) == 0)
+  {
+    auto timer_start = std::chrono::system_clock::now();
+    std::ifstream file(filename, std::ios::binary);
+    if (file)
+    {
+      buffer.assign(std::istreambuf_iterator<char>(file),
+                    std::istreambuf_iterator<char>());
+      size = buffer.size();
+      std::chrono::duration<double> dt
+          = std::chrono::system_clock::now() - timer_start;
+      dolfinx::register_io("XDMF read", filename, size, dt.count(), false);
+    }
+    else
+      size = -1;
+  }
+  MPI_Bcast(&size, 1, MPI_INT64_T, 0, comm);
+  if (size < 0)
+    throw std::runtime_error("Failed to open XDMF file \"" + filename + "\".");
+  buffer.resize(size);
+  MPI_Bcast(buffer.data(), size, MPI_CHAR, 0, comm);
+
+  pugi::xml_parse_result result
+      = xml_doc.load_buffer(buffer.data(), buffer.size());
+  if (!result)
+  {
+    throw std::runtime_error("Failed to parse XDMF file \"" + filename
+                             + "\": " + result.description());
+  }
+
+  if (xml_doc.child("Xdmf").empty())
+    throw std::runtime_error("Empty <Xdmf> root node.");
+
+  if (xml_doc.child("Xdmf").child("Domain").empty())
+    throw std::runtime_error("Empty <Domain> node.");
 }
 //-----------------------------------------------------------------------------
 
@@ -88,9 +164,12 @@ void _write_function(dolfinx::MPI::Comm& comm,
 
 //-----------------------------------------------------------------------------
 XDMFFile::XDMFFile(MPI_Comm comm, const std::string filename,
-                   const std::string file_mode, const Encoding encoding)
+                   const std::string file_mode, const Encoding encoding,
+                   const HDF5Interface::FileOptions& file_options,
+                   const HDF5Interface::WriteOptions& write_options)
     : _mpi_comm(comm), _filename(filename), _file_mode(file_mode),
-      _xml_doc(new pugi::xml_document), _encoding(encoding)
+      _h5_options(write_options), _xml_doc(new pugi::xml_document),
+      _encoding(encoding)
 {
   // Handle HDF5 and XDMF files with the file mode. At the end of this
   // we will have _hdf5_file and _xml_doc both pointing to a valid and
@@ -104,8 +183,9 @@ XDMFFile::XDMFFile(MPI_Comm comm, const std::string filename,
     // Open HDF5 file
     const std::string hdf5_filename = xdmf_utils::get_hdf5_filename(_filename);
     const bool mpi_io = MPI::size(_mpi_comm.comm()) > 1 ? true : false;
+    _h5_options.use_mpi_io = mpi_io;
     _h5_id = HDF5Interface::open_file(_mpi_comm.comm(), hdf5_filename,
-                                      file_mode, mpi_io);
+                                      file_mode, mpi_io, file_options);
     assert(_h5_id > 0);
     LOG(INFO) << "Opened HDF5 file with id \"" << _h5_id << "\"";
   }
@@ -118,14 +198,7 @@ XDMFFile::XDMFFile(MPI_Comm comm, const std::string filename,
   if (_file_mode == "r")
   {
     // Load XML doc from file
-    pugi::xml_parse_result result = _xml_doc->load_file(_filename.c_str());
-    assert(result);
-
-    if (_xml_doc->child("Xdmf").empty())
-      throw std::runtime_error("Empty <Xdmf> root node.");
-
-    if (_xml_doc->child("Xdmf").child("Domain").empty())
-      throw std::runtime_error("Empty <Domain> node.");
+    load_xml(_mpi_comm.comm(), _filename, *_xml_doc);
   }
   else if (_file_mode == "w")
   {
@@ -144,17 +217,15 @@ XDMFFile::XDMFFile(MPI_Comm comm, const std::string filename,
   }
   else if (_file_mode == "a")
   {
-    if (boost::filesystem::exists(_filename))
+    // Check for the file on process 0 only, so that all processes agree
+    int exists = 0;
+    if (dolfinx::MPI::rank(_mpi_comm.comm()) == 0)
+      exists = boost::filesystem::exists(_filename);
+    MPI_Bcast(&exists, 1, MPI_INT, 0, _mpi_comm.comm());
+    if (exists)
     {
       // Load XML doc from file
-      pugi::xml_parse_result result = _xml_doc->load_file(_filename.c_str());
-      assert(result);
-
-      if (_xml_doc->child("Xdmf").empty())
-        throw std::runtime_error("Empty <Xdmf> root node.");
-
-      if (_xml_doc->child("Xdmf").child("Domain").empty())
-        throw std::runtime_error("Empty <Domain> node.");
+      load_xml(_mpi_comm.comm(), _filename, *_xml_doc);
     }
     else
     {
@@ -184,18 +255,30 @@ void XDMFFile::close()
   _h5_id = -1;
 }
 //-----------------------------------------------------------------------------
-void XDMFFile::write_mesh(const mesh::Mesh& mesh, const std::string xpath)
+void XDMFFile::write_mesh(const mesh::Mesh& mesh, const std::string xpath,
+                          bool write_partition)
 {
   pugi::xml_node node = _xml_doc->select_node(xpath.c_str()).node();
   if (!node)
     throw std::runtime_error("XML node '" + xpath + "' not found.");
 
   // Add the mesh Grid to the domain
-  xdmf_mesh::add_mesh(_mpi_comm.comm(), node, _h5_id, mesh, mesh.name);
+  xdmf_mesh::add_mesh(_mpi_comm.comm(), node, _h5_id, _h5_options, mesh,
+                      mesh.name);
+
+  // Add the cell partition to the mesh Grid
+  if (write_partition)
+  {
+    pugi::xml_node grid_node = node.last_child();
+    assert(grid_node);
+    xdmf_mesh::add_partition_data(_mpi_comm.comm(), grid_node, _h5_id,
+                                  _h5_options,
+                                  "/Mesh/" + mesh.name, mesh);
+  }
 
   // Save XML file (on process 0 only)
   if (MPI::rank(_mpi_comm.comm()) == 0)
-    _xml_doc->save_file(_filename.c_str(), "  ");
+    io::save_xml(*_xml_doc, _filename, "XDMF write");
 }
 //-----------------------------------------------------------------------------
 void XDMFFile::write_geometry(const mesh::Geometry& geometry,
@@ -212,12 +295,12 @@ void XDMFFile::write_geometry(const mesh::Geometry& geometry,
   grid_node.append_attribute("GridType") = "Uniform";
 
   const std::string path_prefix = "/Geometry/" + name;
-  xdmf_mesh::add_geometry_data(_mpi_comm.comm(), grid_node, _h5_id, path_prefix,
-                               geometry);
+  xdmf_mesh::add_geometry_data(_mpi_comm.comm(), grid_node, _h5_id,
+                               _h5_options, path_prefix, geometry);
 
   // Save XML file (on process 0 only)
   if (MPI::rank(_mpi_comm.comm()) == 0)
-    _xml_doc->save_file(_filename.c_str(), "  ");
+    io::save_xml(*_xml_doc, _filename, "XDMF write");
 }
 //-----------------------------------------------------------------------------
 mesh::Mesh XDMFFile::read_mesh(const fem::CoordinateElement& element,
@@ -225,15 +308,60 @@ mesh::Mesh XDMFFile::read_mesh(const fem::CoordinateElement& element,
                                const std::string name,
                                const std::string xpath) const
 {
-  // Read mesh data
-  const xt::xtensor<std::int64_t, 2> cells
-      = XDMFFile::read_topology_data(name, xpath);
-  const xt::xtensor<double, 2> x = XDMFFile::read_geometry_data(name, xpath);
+  pugi::xml_node node = _xml_doc->select_node(xpath.c_str()).node();
+  if (!node)
+    throw std::runtime_error("XML node '" + xpath + "' not found.");
 
-  // Create mesh
-  auto [data, offset] = graph::create_adjacency_data(cells);
-  graph::AdjacencyList<std::int64_t> cells_adj(std::move(data),
-                                               std::move(offset));
+  pugi::xml_node grid_node
+      = node.select_node(("Grid[@Name='" + name + "']").c_str()).node();
+  if (!grid_node)
+    throw std::runtime_error("<Grid> with name '" + name + "' not found.");
+
+  // Read mesh data. The block of cells of each process is read directly
+  // into the adjacency list that is passed to the partitioner.
+  LOG(INFO) << "Read mesh data \"" << name << "\" at \"" << xpath << "\"";
+  const graph::AdjacencyList<std::int64_t> cells_adj
+      = xdmf_mesh::read_topology_adjacency(_mpi_comm.comm(), _h5_id,
+                                           grid_node);
+  const xt::xtensor<double, 2> x
+      = xdmf_mesh::read_geometry_data(_mpi_comm.comm(), _h5_id, grid_node);
+
+  // Use the saved cell partition if it was computed on the same number
+  // of processes. The saved destinations include the ghosts of the
+  // saved mesh, so they can only be used for a ghosted mesh when the
+  // saved mesh was ghosted.
+  if (xdmf_mesh::has_partition_data(_mpi_comm.comm(), grid_node))
+  {
+    const graph::AdjacencyList<std::int32_t> dest
+        = xdmf_mesh::read_partition_data(_mpi_comm.comm(), _h5_id,
+                                         grid_node);
+    std::int32_t max_dest = 0;
+    for (std::int32_t c = 0; c < dest.num_nodes(); ++c)
+      max_dest = std::max(max_dest, dest.num_links(c));
+    MPI_Allreduce(MPI_IN_PLACE, &max_dest, 1, MPI_INT32_T, MPI_MAX,
+                  _mpi_comm.comm());
+    if (mode == mesh::GhostMode::none or max_dest > 1
+        or dolfinx::MPI::size(_mpi_comm.comm()) == 1)
+    {
+      LOG(INFO) << "Using saved cell partition of mesh \"" << name << "\"";
+      auto partitioner
+          = [&dest](MPI_Comm, int, int,
+                    const graph::AdjacencyList<std::int64_t>& cells,
+                    mesh::GhostMode)
+      {
+        if (cells.num_nodes() != dest.num_nodes())
+        {
+          throw std::runtime_error(
+              "Saved cell partition does not match the cells.");
+        }
+        return dest;
+      };
+      mesh::Mesh mesh = mesh::create_mesh(_mpi_comm.comm(), cells_adj,
+                                          element, x, mode, partitioner);
+      mesh.name = name;
+      return mesh;
+    }
+  }
 
   mesh::Mesh mesh
       = mesh::create_mesh(_mpi_comm.comm(), cells_adj, element, x, mode);
@@ -276,15 +404,51 @@ XDMFFile::read_geometry_data(const std::string name,
 }
 //-----------------------------------------------------------------------------
 void XDMFFile::write_function(const fem::Function<double>& u, double t,
-                              const std::string& mesh_xpath)
+                              const std::string& mesh_xpath,
+                              const std::string& geometry_xpath)
 {
-  _write_function(_mpi_comm, u, t, mesh_xpath, *_xml_doc, _h5_id, _filename);
+  _write_function(_mpi_comm, u, t, mesh_xpath, geometry_xpath, *_xml_doc,
+                  _h5_id, _h5_options, _filename);
 }
 //-----------------------------------------------------------------------------
 void XDMFFile::write_function(const fem::Function<std::complex<double>>& u,
-                              double t, const std::string& mesh_xpath)
+                              double t, const std::string& mesh_xpath,
+                              const std::string& geometry_xpath)
+{
+  _write_function(_mpi_comm, u, t, mesh_xpath, geometry_xpath, *_xml_doc,
+                  _h5_id, _h5_options, _filename);
+}
+//-----------------------------------------------------------------------------
+void XDMFFile::write_checkpoint(const fem::Function<double>& u,
+                                const std::string& name)
+{
+  if (_encoding != Encoding::HDF5)
+    throw std::runtime_error("Checkpoints require HDF5 encoding.");
+  checkpoint::write_function(_h5_id, _h5_options, u, name);
+}
+//-----------------------------------------------------------------------------
+void XDMFFile::write_checkpoint(const fem::Function<std::complex<double>>& u,
+                                const std::string& name)
+{
+  if (_encoding != Encoding::HDF5)
+    throw std::runtime_error("Checkpoints require HDF5 encoding.");
+  checkpoint::write_function(_h5_id, _h5_options, u, name);
+}
+//-----------------------------------------------------------------------------
+void XDMFFile::read_checkpoint(fem::Function<double>& u,
+                               const std::string& name) const
+{
+  if (_encoding != Encoding::HDF5)
+    throw std::runtime_error("Checkpoints require HDF5 encoding.");
+  checkpoint::read_function(_h5_id, u, name);
+}
+//-----------------------------------------------------------------------------
+void XDMFFile::read_checkpoint(fem::Function<std::complex<double>>& u,
+                               const std::string& name) const
 {
-  _write_function(_mpi_comm, u, t, mesh_xpath, *_xml_doc, _h5_id, _filename);
+  if (_encoding != Encoding::HDF5)
+    throw std::runtime_error("Checkpoints require HDF5 encoding.");
+  checkpoint::read_function(_h5_id, u, name);
 }
 //-----------------------------------------------------------------------------
 void XDMFFile::write_meshtags(const mesh::MeshTags<std::int32_t>& meshtags,
@@ -305,11 +469,11 @@ void XDMFFile::write_meshtags(const mesh::MeshTags<std::int32_t>& meshtags,
   geo_ref_node.append_attribute("xpointer") = geo_ref_path.c_str();
   assert(geo_ref_node);
   xdmf_meshtags::add_meshtags(_mpi_comm.comm(), meshtags, grid_node, _h5_id,
-                              meshtags.name);
+                              _h5_options, meshtags.name);
 
   // Save XML file (on process 0 only)
   if (MPI::rank(_mpi_comm.comm()) == 0)
-    _xml_doc->save_file(_filename.c_str(), "  ");
+    io::save_xml(*_xml_doc, _filename, "XDMF write");
 }
 //-----------------------------------------------------------------------------
 mesh::MeshTags<std::int32_t>
@@ -337,7 +501,7 @@ XDMFFile::read_meshtags(const std::shared_ptr<const mesh::Mesh>& mesh,
 
   // Permute entities from VTK to DOLFINx ordering
   xt::xtensor<std::int64_t, 2> entities1 = io::cells::compute_permutation(
-      entities, io::cells::perm_vtk(cell_type, entities.shape(1)));
+      entities, io::cells::vtk_to_dolfinx(cell_type, entities.shape(1)));
 
   const auto [entities_local, values_local]
       = xdmf_utils::extract_local_entities(*mesh, mesh::cell_dim(cell_type),
@@ -393,7 +557,7 @@ void XDMFFile::write_information(const std::string name,
 
   // Save XML file (on process 0 only)
   if (MPI::rank(_mpi_comm.comm()) == 0)
-    _xml_doc->save_file(_filename.c_str(), "  ");
+    io::save_xml(*_xml_doc, _filename, "XDMF write");
 }
 //-----------------------------------------------------------------------------
 std::string XDMFFile::read_information(const std::string name,
@@ -66,9 +66,23 @@ public:
   static const Encoding default_encoding = Encoding::HDF5;
 
   /// Constructor
+  /// @param[in] comm The MPI communicator
+  /// @param[in] filename Name of the XDMF file
+  /// @param[in] file_mode The file mode (r, w, a)
+  /// @param[in] encoding The encoding of the data
+  /// @param[in] file_options Alignment and MPI-IO hints for the HDF5
+  /// file
+  /// @param[in] write_options Chunking and compression of the HDF5
+  /// datasets that are written. MPI-IO is used if the communicator has
+  /// more than one process, and HDF5Interface::WriteOptions::use_mpi_io
+  /// is ignored.
   XDMFFile(MPI_Comm comm, const std::string filename,
            const std::string file_mode,
-           const Encoding encoding = default_encoding);
+           const Encoding encoding = default_encoding,
+           const HDF5Interface::FileOptions& file_options
+           = HDF5Interface::FileOptions(),
+           const HDF5Interface::WriteOptions& write_options
+           = HDF5Interface::WriteOptions());
 
   /// Destructor
   ~XDMFFile();
@@ -83,8 +97,13 @@ public:
   /// Save Mesh
   /// @param[in] mesh
   /// @param[in] xpath XPath where Mesh Grid will be written
+  /// @param[in] write_partition If true, the cell partition of the mesh
+  ///   is saved with the mesh. read_mesh uses it when reading the mesh
+  ///   on the same number of processes, which avoids re-partitioning
+  ///   the mesh. Requires HDF5 encoding.
   void write_mesh(const mesh::Mesh& mesh,
-                  const std::string xpath = "/Xdmf/Domain");
+                  const std::string xpath = "/Xdmf/Domain",
+                  bool write_partition = false);
 
   /// Save Geometry
   /// @param[in] geometry
@@ -94,6 +113,12 @@ public:
                       const std::string xpath = "/Xdmf/Domain");
 
   /// Read in Mesh
+  ///
+  /// If the mesh was saved with its cell partition on the same number
+  /// of processes, the saved partition is used to distribute the cells
+  /// and the dual graph is not built. The mesh is otherwise
+  /// partitioned with the default graph partitioner.
+  ///
   /// @param[in] element Element that describes the geometry of a cell
   /// @param[in] mode The type of ghosting/halo to use for the mesh when
   ///   distributed in parallel
@@ -129,22 +154,76 @@ public:
                                                 = "/Xdmf/Domain");
 
   /// Write Function
+  ///
+  /// The Function refers to the topology and geometry of a mesh that
+  /// has been written to the file, so that the mesh is written only
+  /// once for a time series. With HDF5 encoding, the values at all
+  /// times are appended to one dataset for each Function.
+  ///
   /// @param[in] u The Function to write to file
   /// @param[in] t The time stamp to associate with the Function
   /// @param[in] mesh_xpath XPath for a Grid under which Function will
   /// be inserted
+  /// @param[in] geometry_xpath XPath of a Geometry, e.g. written by
+  /// XDMFFile::write_geometry when the mesh has moved, which replaces
+  /// the Geometry of the mesh Grid. The Geometry of the mesh Grid is
+  /// used if empty.
   void write_function(const fem::Function<double>& u, double t,
                       const std::string& mesh_xpath
-                      = "/Xdmf/Domain/Grid[@GridType='Uniform'][1]");
+                      = "/Xdmf/Domain/Grid[@GridType='Uniform'][1]",
+                      const std::string& geometry_xpath = "");
 
   /// Write Function
+  ///
+  /// The Function refers to the topology and geometry of a mesh that
+  /// has been written to the file, so that the mesh is written only
+  /// once for a time series. With HDF5 encoding, the values at all
+  /// times are appended to one dataset for each Function.
+  ///
   /// @param[in] u The Function to write to file
   /// @param[in] t The time stamp to associate with the Function
   /// @param[in] mesh_xpath XPath for a Grid under which Function will
   /// be inserted
+  /// @param[in] geometry_xpath XPath of a Geometry, e.g. written by
+  /// XDMFFile::write_geometry when the mesh has moved, which replaces
+  /// the Geometry of the mesh Grid. The Geometry of the mesh Grid is
+  /// used if empty.
   void write_function(const fem::Function<std::complex<double>>& u, double t,
                       const std::string& mesh_xpath
-                      = "/Xdmf/Domain/Grid[@GridType='Uniform'][1]");
+                      = "/Xdmf/Domain/Grid[@GridType='Uniform'][1]",
+                      const std::string& geometry_xpath = "");
+
+  /// Write the degrees-of-freedom of a Function in their native layout,
+  /// for restarting a computation. The mesh of the Function should be
+  /// written with XDMFFile::write_mesh, with its partition. See
+  /// io::checkpoint. Requires HDF5 encoding.
+  /// @param[in] u The Function
+  /// @param[in] name The name of the checkpoint
+  void write_checkpoint(const fem::Function<double>& u,
+                        const std::string& name);
+
+  /// Write the degrees-of-freedom of a complex Function in their
+  /// native layout. See XDMFFile::write_checkpoint.
+  /// @param[in] u The Function
+  /// @param[in] name The name of the checkpoint
+  void write_checkpoint(const fem::Function<std::complex<double>>& u,
+                        const std::string& name);
+
+  /// Read the degrees-of-freedom of a Function that were written with
+  /// XDMFFile::write_checkpoint. The mesh of the Function must have
+  /// been read from the mesh that was written with the Function. See
+  /// io::checkpoint.
+  /// @param[in,out] u The Function
+  /// @param[in] name The name of the checkpoint
+  void read_checkpoint(fem::Function<double>& u,
+                       const std::string& name) const;
+
+  /// Read the degrees-of-freedom of a complex Function that were
+  /// written with XDMFFile::write_checkpoint
+  /// @param[in,out] u The Function
+  /// @param[in] name The name of the checkpoint
+  void read_checkpoint(fem::Function<std::complex<double>>& u,
+                       const std::string& name) const;
 
   /// Write MeshTags
   /// @param[in] meshtags
@@ -194,6 +273,9 @@ private:
   // HDF5 file handle
   hid_t _h5_id;
 
+  // Options for writing HDF5 datasets
+  HDF5Interface::WriteOptions _h5_options;
+
   // The XML document currently representing the XDMF which needs to be
   // kept open for time series etc.
   std::unique_ptr<pugi::xml_document> _xml_doc;
@@ -5,11 +5,15 @@
 // SPDX-License-Identifier:    LGPL-3.0-or-later
 
 #include "cells.h"
+#include <array>
 #include <dolfinx/common/log.h>
 #include <dolfinx/mesh/Mesh.h>
 #include <dolfinx/mesh/cell_types.h>
+#include <map>
+#include <mutex>
 #include <numeric>
 #include <stdexcept>
+#include <utility>
 #include <xtensor/xview.hpp>
 
 using namespace dolfinx;
@@ -275,6 +279,32 @@ std::vector<std::uint8_t> gmsh_quadrilateral(int num_nodes)
     throw std::runtime_error("Higher order GMSH quadrilateral not supported");
   }
 }
+//-----------------------------------------------------------------------------
+
+// Get the VTK to DOLFINx permutation array and its transpose, which are
+// computed on first use for each cell type and number of nodes
+const std::array<std::vector<std::uint8_t>, 2>&
+cached_perm_vtk(mesh::CellType type, int num_nodes)
+{
+  static std::mutex mutex;
+  static std::map<std::pair<mesh::CellType, int>,
+                  std::array<std::vector<std::uint8_t>, 2>>
+      cache;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = cache.find({type, num_nodes});
+  if (it == cache.end())
+  {
+    std::vector<std::uint8_t> p = io::cells::perm_vtk(type, num_nodes);
+    std::vector<std::uint8_t> p_t = io::cells::transpose(p);
+    it = cache.insert({{type, num_nodes}, {std::move(p), std::move(p_t)}})
+             .first;
+  }
+
+  // References to the values of a std::map remain valid when other
+  // values are inserted
+  return it->second;
+}
 } // namespace
 //-----------------------------------------------------------------------------
 std::vector<std::uint8_t> io::cells::perm_vtk(mesh::CellType type,
@@ -350,18 +380,26 @@ io::cells::transpose(const std::vector<std::uint8_t>& map)
   return transpose;
 }
 //-----------------------------------------------------------------------------
+const std::vector<std::uint8_t>&
+io::cells::vtk_to_dolfinx(mesh::CellType type, int num_nodes)
+{
+  return cached_perm_vtk(type, num_nodes)[0];
+}
+//-----------------------------------------------------------------------------
+const std::vector<std::uint8_t>&
+io::cells::dolfinx_to_vtk(mesh::CellType type, int num_nodes)
+{
+  return cached_perm_vtk(type, num_nodes)[1];
+}
+//-----------------------------------------------------------------------------
 xt::xtensor<std::int64_t, 2>
 io::cells::compute_permutation(const xt::xtensor<std::int64_t, 2>& cells,
                                const std::vector<std::uint8_t>& p)
 {
   xt::xtensor<std::int64_t, 2> cells_new(cells.shape());
-  for (std::size_t c = 0; c < cells_new.shape(0); ++c)
-  {
-    auto cell = xt::row(cells, c);
-    auto cell_new = xt::row(cells_new, c);
-    for (std::size_t i = 0; i < cell_new.shape(0); ++i)
-      cell_new[i] = cell[p[i]];
-  }
+  permute_cells(xtl::span<const std::int64_t>(cells.data(), cells.size()),
+                cells.shape(1), p,
+                xtl::span<std::int64_t>(cells_new.data(), cells_new.size()));
   return cells_new;
 }
 //-----------------------------------------------------------------------------
@@ -6,10 +6,12 @@
 
 #pragma once
 
+#include <cassert>
 #include <cstdint>
 #include <dolfinx/mesh/cell_types.h>
 #include <vector>
 #include <xtensor/xtensor.hpp>
+#include <xtl/xspan.hpp>
 
 namespace dolfinx::mesh
 {
@@ -109,6 +111,51 @@ std::vector<std::uint8_t> perm_gmsh(mesh::CellType type, int num_nodes);
 ///   transpose will be `{3 , 0, 1, 2 }`.
 std::vector<std::uint8_t> transpose(const std::vector<std::uint8_t>& map);
 
+/// Permutation array to map from VTK to DOLFINx node ordering, as
+/// computed by perm_vtk. The array is computed once for each cell type
+/// and number of nodes, and is cached.
+/// @param[in] type The cell shape
+/// @param[in] num_nodes The number of cell 'nodes'
+/// @return Permutation array `p`, i.e. `a_dolfin[i] = a_vtk[p[i]]`
+const std::vector<std::uint8_t>& vtk_to_dolfinx(mesh::CellType type,
+                                                int num_nodes);
+
+/// Permutation array to map from DOLFINx to VTK node ordering, i.e. the
+/// transpose of the array computed by perm_vtk. The array is computed
+/// once for each cell type and number of nodes, and is cached.
+/// @param[in] type The cell shape
+/// @param[in] num_nodes The number of cell 'nodes'
+/// @return Permutation array `p`, i.e. `a_vtk[i] = a_dolfin[p[i]]`
+const std::vector<std::uint8_t>& dolfinx_to_vtk(mesh::CellType type,
+                                                int num_nodes);
+
+/// Gather the nodes of cells that are stored row-wise, i.e.
+/// `cells_p[c * m + i] = cells[c * num_nodes + p[i]]`, where `m` is the
+/// size of `p`. The rows of the input have a fixed width, so the gather
+/// is a simple loop that the compiler can vectorise.
+/// @param[in] cells The nodes of the cells, with `num_nodes` nodes per
+/// cell
+/// @param[in] num_nodes The number of nodes of each cell in `cells`
+/// @param[in] p The local nodes of each cell to gather, e.g. a
+/// permutation array
+/// @param[out] cells_p The gathered nodes, which must not overlap
+/// `cells`
+template <typename T, typename U>
+void permute_cells(const xtl::span<const T>& cells, std::size_t num_nodes,
+                   const std::vector<U>& p, const xtl::span<T>& cells_p)
+{
+  const std::size_t m = p.size();
+  const std::size_t num_cells = num_nodes > 0 ? cells.size() / num_nodes : 0;
+  assert(cells_p.size() == num_cells * m);
+  for (std::size_t c = 0; c < num_cells; ++c)
+  {
+    const T* cell = cells.data() + c * num_nodes;
+    T* cell_p = cells_p.data() + c * m;
+    for (std::size_t i = 0; i < m; ++i)
+      cell_p[i] = cell[p[i]];
+  }
+}
+
 /// Permute cell topology by applying a permutation array for each cell
 /// @param[in] cells Array of cell topologies, with each row
 ///   representing a cell
@@ -0,0 +1,380 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "checkpoint.h"
+#include <algorithm>
+#include <array>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/MPI.h>
+#include <dolfinx/common/log.h>
+#include <dolfinx/fem/DofMap.h>
+#include <dolfinx/fem/FiniteElement.h>
+#include <dolfinx/fem/Function.h>
+#include <dolfinx/fem/FunctionSpace.h>
+#include <dolfinx/graph/AdjacencyList.h>
+#include <dolfinx/la/Vector.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <dolfinx/mesh/utils.h>
+#include <map>
+#include <type_traits>
+#include <vector>
+
+using namespace dolfinx;
+using namespace dolfinx::io;
+
+namespace
+{
+// Number of doubles that hold a value of type T
+template <typename T>
+constexpr int value_width()
+{
+  return std::is_same_v<T, double> ? 1 : 2;
+}
+//-----------------------------------------------------------------------------
+// Write the ownership ranges of an index map, with the global size at
+// the end, from process 0
+void write_ranges(MPI_Comm comm, hid_t h5_id, const std::string& path,
+                  const common::IndexMap& map,
+                  const HDF5Interface::WriteOptions& h5_options)
+{
+  const int size = dolfinx::MPI::size(comm);
+  std::vector<std::int64_t> ranges(size + 1, map.size_global());
+  const std::int64_t offset = map.local_range()[0];
+  MPI_Allgather(&offset, 1, MPI_INT64_T, ranges.data(), 1, MPI_INT64_T, comm);
+  const std::int64_t n = dolfinx::MPI::rank(comm) == 0 ? size + 1 : 0;
+  HDF5Interface::write_dataset(h5_id, path, ranges.data(),
+                               {size + 1 - n, size + 1}, {size + 1},
+                               h5_options);
+}
+//-----------------------------------------------------------------------------
+// Global indices of the geometry nodes of the cells (owned and ghost)
+// of a mesh. If input is true, the input global indices are used,
+// otherwise the global indices of the geometry index map, which are
+// the input indices when the mesh is read from a file.
+std::vector<std::int64_t> cell_nodes(const mesh::Mesh& mesh,
+                                     std::int32_t num_cells, bool input)
+{
+  const graph::AdjacencyList<std::int32_t>& x_dofmap
+      = mesh.geometry().dofmap();
+  std::vector<std::int32_t> nodes;
+  for (std::int32_t c = 0; c < num_cells; ++c)
+  {
+    auto x_dofs = x_dofmap.links(c);
+    nodes.insert(nodes.end(), x_dofs.begin(), x_dofs.end());
+  }
+  std::vector<std::int64_t> nodes_g(nodes.size());
+  if (input)
+  {
+    const std::vector<std::int64_t>& input_indices
+        = mesh.geometry().input_global_indices();
+    std::transform(nodes.begin(), nodes.end(), nodes_g.begin(),
+                   [&input_indices](auto n) { return input_indices[n]; });
+  }
+  else
+    mesh.geometry().index_map()->local_to_global(nodes, nodes_g);
+  return nodes_g;
+}
+//-----------------------------------------------------------------------------
+template <typename T>
+void _write_function(hid_t h5_id, const HDF5Interface::WriteOptions& h5_options,
+                     const fem::Function<T>& u, const std::string& name)
+{
+  assert(u.function_space());
+  std::shared_ptr<const mesh::Mesh> mesh = u.function_space()->mesh();
+  assert(mesh);
+  const MPI_Comm comm = mesh->mpi_comm();
+  std::shared_ptr<const fem::DofMap> dofmap = u.function_space()->dofmap();
+  assert(dofmap);
+  if (dofmap->bs() != dofmap->index_map_bs())
+    throw std::runtime_error("Checkpointing of subspaces not supported.");
+  const std::string path = "/Checkpoint/" + name;
+
+  // Ownership ranges of the cells and dofs
+  const int tdim = mesh->topology().dim();
+  std::shared_ptr<const common::IndexMap> cell_map
+      = mesh->topology().index_map(tdim);
+  assert(cell_map);
+  std::shared_ptr<const common::IndexMap> dof_map = dofmap->index_map;
+  assert(dof_map);
+  write_ranges(comm, h5_id, path + "/cell_ranges", *cell_map, h5_options);
+  write_ranges(comm, h5_id, path + "/dof_ranges", *dof_map, h5_options);
+
+  // Geometry nodes of the owned cells
+  const std::int32_t num_cells = cell_map->size_local();
+  const std::array cell_range = cell_map->local_range();
+  const std::int64_t num_cells_global = cell_map->size_global();
+  const std::vector<std::int64_t> nodes = cell_nodes(*mesh, num_cells, false);
+  const std::int64_t num_nodes
+      = mesh->geometry().cmap().dof_layout().num_dofs();
+  HDF5Interface::write_dataset(h5_id, path + "/cell_nodes", nodes.data(),
+                               cell_range, {num_cells_global, num_nodes},
+                               h5_options);
+
+  // Global dofs of the owned cells
+  const std::int64_t num_cell_dofs = dofmap->element_dof_layout->num_dofs();
+  std::vector<std::int32_t> dofs(
+      dofmap->list().array().begin(),
+      std::next(dofmap->list().array().begin(), num_cells * num_cell_dofs));
+  std::vector<std::int64_t> dofs_g(dofs.size());
+  dof_map->local_to_global(dofs, dofs_g);
+  HDF5Interface::write_dataset(h5_id, path + "/cell_dofs", dofs_g.data(),
+                               cell_range, {num_cells_global, num_cell_dofs},
+                               h5_options);
+
+  // Owned dofs, with the real and imaginary parts of complex values in
+  // consecutive columns
+  const int bs = dofmap->bs();
+  const std::int64_t width = bs * value_width<T>();
+  const double* x = reinterpret_cast<const double*>(u.x()->array().data());
+  HDF5Interface::write_dataset(h5_id, path + "/x", x, dof_map->local_range(),
+                               {dof_map->size_global(), width}, h5_options);
+}
+//-----------------------------------------------------------------------------
+template <typename T>
+void _read_function(hid_t h5_id, fem::Function<T>& u, const std::string& name)
+{
+  assert(u.function_space());
+  std::shared_ptr<const mesh::Mesh> mesh = u.function_space()->mesh();
+  assert(mesh);
+  const MPI_Comm comm = mesh->mpi_comm();
+  const int rank = dolfinx::MPI::rank(comm);
+  const int size = dolfinx::MPI::size(comm);
+  std::shared_ptr<const fem::DofMap> dofmap = u.function_space()->dofmap();
+  assert(dofmap);
+  if (dofmap->bs() != dofmap->index_map_bs())
+    throw std::runtime_error("Checkpointing of subspaces not supported.");
+  const std::string path = "/Checkpoint/" + name;
+  if (!HDF5Interface::has_dataset(h5_id, path + "/x"))
+    throw std::runtime_error("No checkpoint named \"" + name + "\".");
+
+  const int tdim = mesh->topology().dim();
+  std::shared_ptr<const common::IndexMap> cell_map
+      = mesh->topology().index_map(tdim);
+  assert(cell_map);
+  std::shared_ptr<const common::IndexMap> dof_map = dofmap->index_map;
+  assert(dof_map);
+
+  // Check that the saved data matches the function space
+  const int bs = dofmap->bs();
+  const std::int64_t width = bs * value_width<T>();
+  const std::int64_t num_nodes
+      = mesh->geometry().cmap().dof_layout().num_dofs();
+  const std::int64_t num_cell_dofs = dofmap->element_dof_layout->num_dofs();
+  const std::vector<std::int64_t> shape_x
+      = HDF5Interface::get_dataset_shape(h5_id, path + "/x");
+  const std::vector<std::int64_t> shape_nodes
+      = HDF5Interface::get_dataset_shape(h5_id, path + "/cell_nodes");
+  const std::vector<std::int64_t> shape_dofs
+      = HDF5Interface::get_dataset_shape(h5_id, path + "/cell_dofs");
+  if (shape_x.size() != 2 or shape_x[0] != dof_map->size_global()
+      or shape_x[1] != width or shape_nodes[0] != cell_map->size_global()
+      or shape_nodes[1] != num_nodes or shape_dofs[1] != num_cell_dofs)
+  {
+    throw std::runtime_error(
+        "Checkpoint does not match the function space or mesh.");
+  }
+
+  std::vector<T>& x = u.x()->mutable_array();
+  double* _x = reinterpret_cast<double*>(x.data());
+
+  // Read the values directly if each process has the cells and dofs
+  // that it had when the Function was saved
+  const std::vector<std::int64_t> cell_ranges
+      = HDF5Interface::read_dataset<std::int64_t>(h5_id, path + "/cell_ranges",
+                                                  {-1, -1});
+  const std::vector<std::int64_t> dof_ranges
+      = HDF5Interface::read_dataset<std::int64_t>(h5_id, path + "/dof_ranges",
+                                                  {-1, -1});
+  const std::int32_t num_cells = cell_map->size_local();
+  if (cell_ranges.size() == std::size_t(size + 1))
+  {
+    const std::array cell_range{cell_ranges[rank], cell_ranges[rank + 1]};
+    const std::array dof_range{dof_ranges[rank], dof_ranges[rank + 1]};
+    int same = cell_range == cell_map->local_range()
+               and dof_range == dof_map->local_range();
+    MPI_Allreduce(MPI_IN_PLACE, &same, 1, MPI_INT, MPI_MIN, comm);
+    if (same)
+    {
+      // Compare the geometry nodes and the dofs of the cells
+      const std::vector<std::int64_t> nodes0
+          = HDF5Interface::read_dataset<std::int64_t>(
+              h5_id, path + "/cell_nodes", cell_range);
+      const std::vector<std::int64_t> dofs0
+          = HDF5Interface::read_dataset<std::int64_t>(
+              h5_id, path + "/cell_dofs", cell_range);
+      std::vector<std::int32_t> dofs(
+          dofmap->list().array().begin(),
+          std::next(dofmap->list().array().begin(),
+                    num_cells * num_cell_dofs));
+      std::vector<std::int64_t> dofs1(dofs.size());
+      dof_map->local_to_global(dofs, dofs1);
+      same = nodes0 == cell_nodes(*mesh, num_cells, true) and dofs0 == dofs1;
+      MPI_Allreduce(MPI_IN_PLACE, &same, 1, MPI_INT, MPI_MIN, comm);
+    }
+
+    if (same)
+    {
+      LOG(INFO) << "Reading checkpoint \"" << name << "\" in native layout";
+      const std::vector<double> x0
+          = HDF5Interface::read_dataset<double>(h5_id, path + "/x", dof_range);
+      std::copy(x0.begin(), x0.end(), _x);
+      u.x()->scatter_fwd();
+      return;
+    }
+  }
+
+  // The cell-local order of the degrees-of-freedom depends on the
+  // global vertex numbering for elements with dof transformations,
+  // which changes when the mesh is distributed differently
+  const std::shared_ptr<const fem::FiniteElement> element
+      = u.function_space()->element();
+  assert(element);
+  if (element->needs_dof_transformations()
+      or element->needs_dof_permutations())
+  {
+    throw std::runtime_error(
+        "Redistributing checkpoints of functions in elements with dof "
+        "transformations not supported (yet).");
+  }
+
+  // Read a block of the saved cells and of the saved dofs on each
+  // process
+  const std::array cell_range
+      = dolfinx::MPI::local_range(rank, shape_nodes[0], size);
+  const std::vector<std::int64_t> nodes0
+      = HDF5Interface::read_dataset<std::int64_t>(h5_id, path + "/cell_nodes",
+                                                  cell_range);
+  const std::vector<std::int64_t> dofs0
+      = HDF5Interface::read_dataset<std::int64_t>(h5_id, path + "/cell_dofs",
+                                                  cell_range);
+  const std::array dof_range
+      = dolfinx::MPI::local_range(rank, shape_x[0], size);
+  std::vector<double> x0
+      = HDF5Interface::read_dataset<double>(h5_id, path + "/x", dof_range);
+
+  // Get the values of the dofs of the block of cells
+  const common::IndexMap x0_map(comm, dof_range[1] - dof_range[0]);
+  std::vector<std::int32_t> x0_offsets(dof_range[1] - dof_range[0] + 1);
+  for (std::size_t i = 0; i < x0_offsets.size(); ++i)
+    x0_offsets[i] = i * width;
+  const graph::AdjacencyList<double> cell_values0 = mesh::migrate_cell_data(
+      comm, x0_map,
+      graph::AdjacencyList<double>(std::move(x0), std::move(x0_offsets)),
+      dofs0);
+
+  // Send the geometry nodes and values of the saved cells, and the
+  // geometry nodes of the cells of this process, to the 'post office'
+  // rank of the first node of the cell
+  const std::int32_t num_cells_all = num_cells + cell_map->num_ghosts();
+  const std::vector<std::int64_t> nodes1
+      = cell_nodes(*mesh, num_cells_all, true);
+  const std::int64_t num_nodes_global
+      = mesh->geometry().index_map()->size_global();
+  std::vector<std::vector<std::int64_t>> send_nodes0(size), send_nodes1(size);
+  std::vector<std::vector<double>> send_values0(size);
+  std::vector<std::vector<std::int32_t>> send_cells1(size);
+  const std::int64_t cell_width = num_cell_dofs * width;
+  for (std::size_t c = 0; c < nodes0.size() / num_nodes; ++c)
+  {
+    auto n = std::next(nodes0.begin(), c * num_nodes);
+    const int p = dolfinx::MPI::index_owner(size, *n, num_nodes_global);
+    send_nodes0[p].insert(send_nodes0[p].end(), n, std::next(n, num_nodes));
+    auto v = std::next(cell_values0.array().begin(), c * cell_width);
+    send_values0[p].insert(send_values0[p].end(), v,
+                           std::next(v, cell_width));
+  }
+  for (std::int32_t c = 0; c < num_cells_all; ++c)
+  {
+    auto n = std::next(nodes1.begin(), c * num_nodes);
+    const int p = dolfinx::MPI::index_owner(size, *n, num_nodes_global);
+    send_nodes1[p].insert(send_nodes1[p].end(), n, std::next(n, num_nodes));
+    send_cells1[p].push_back(c);
+  }
+  const graph::AdjacencyList<std::int64_t> recv_nodes0
+      = dolfinx::MPI::all_to_all(
+          comm, graph::AdjacencyList<std::int64_t>(send_nodes0));
+  const graph::AdjacencyList<double> recv_values0 = dolfinx::MPI::all_to_all(
+      comm, graph::AdjacencyList<double>(send_values0));
+  const graph::AdjacencyList<std::int64_t> recv_nodes1
+      = dolfinx::MPI::all_to_all(
+          comm, graph::AdjacencyList<std::int64_t>(send_nodes1));
+
+  // Match the requested cells with the saved cells, and reply with the
+  // values in the order of the requests
+  std::map<std::vector<std::int64_t>, const double*> saved_cells;
+  for (std::size_t i = 0; i < recv_nodes0.array().size() / num_nodes; ++i)
+  {
+    auto n = std::next(recv_nodes0.array().begin(), i * num_nodes);
+    saved_cells.emplace(std::vector<std::int64_t>(n, std::next(n, num_nodes)),
+                        recv_values0.array().data() + i * cell_width);
+  }
+  std::vector<std::vector<double>> send_values1(size);
+  std::vector<std::int64_t> key(num_nodes);
+  for (int p = 0; p < size; ++p)
+  {
+    auto nodes = recv_nodes1.links(p);
+    for (std::size_t i = 0; i < nodes.size(); i += num_nodes)
+    {
+      std::copy_n(std::next(nodes.begin(), i), num_nodes, key.begin());
+      auto it = saved_cells.find(key);
+      if (it == saved_cells.end())
+        throw std::runtime_error("Cell not found in checkpoint.");
+      send_values1[p].insert(send_values1[p].end(), it->second,
+                             it->second + cell_width);
+    }
+  }
+  const graph::AdjacencyList<double> recv_values1 = dolfinx::MPI::all_to_all(
+      comm, graph::AdjacencyList<double>(send_values1));
+
+  // Copy the values to the dofs of the cells
+  for (int p = 0; p < size; ++p)
+  {
+    auto values = recv_values1.links(p);
+    for (std::size_t i = 0; i < send_cells1[p].size(); ++i)
+    {
+      xtl::span<const std::int32_t> cell_dofs
+          = dofmap->cell_dofs(send_cells1[p][i]);
+      for (std::size_t j = 0; j < cell_dofs.size(); ++j)
+      {
+        std::copy_n(std::next(values.begin(), i * cell_width + j * width),
+                    width, _x + cell_dofs[j] * width);
+      }
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
+//-----------------------------------------------------------------------------
+void checkpoint::write_function(hid_t h5_id,
+                                const HDF5Interface::WriteOptions& h5_options,
+                                const fem::Function<double>& u,
+                                const std::string& name)
+{
+  _write_function(h5_id, h5_options, u, name);
+}
+//-----------------------------------------------------------------------------
+void checkpoint::write_function(hid_t h5_id,
+                                const HDF5Interface::WriteOptions& h5_options,
+                                const fem::Function<std::complex<double>>& u,
+                                const std::string& name)
+{
+  _write_function(h5_id, h5_options, u, name);
+}
+//-----------------------------------------------------------------------------
+void checkpoint::read_function(hid_t h5_id, fem::Function<double>& u,
+                               const std::string& name)
+{
+  _read_function(h5_id, u, name);
+}
+//-----------------------------------------------------------------------------
+void checkpoint::read_function(hid_t h5_id,
+                               fem::Function<std::complex<double>>& u,
+                               const std::string& name)
+{
+  _read_function(h5_id, u, name);
+}
+//-----------------------------------------------------------------------------
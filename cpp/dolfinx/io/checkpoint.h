@@ -0,0 +1,85 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include "HDF5Interface.h"
+#include <complex>
+#include <hdf5.h>
+#include <mpi.h>
+#include <string>
+
+namespace dolfinx::fem
+{
+template <typename T>
+class Function;
+}
+
+namespace dolfinx::io
+{
+
+/// Checkpointing of the degrees-of-freedom of Functions in HDF5 files.
+///
+/// The degrees-of-freedom of a Function are saved in their native
+/// layout, i.e. the owned values of each process in the order of the
+/// dof index map, with one collective contiguous write per array. For
+/// each owned cell, the global indices of its geometry nodes and of its
+/// dofs are also saved, together with the ownership ranges of the
+/// cells and dofs on each process.
+///
+/// A Function is restored on a mesh that has been read from the mesh
+/// that was written with XDMFFile::write_mesh, in the same file or in
+/// another file. When the mesh is read on the same number of processes
+/// using the saved cell partition (see XDMFFile::write_mesh), the cells
+/// and dofs of each process are the same as when the Function was
+/// saved, and the values of each process are read directly, without
+/// communication. Otherwise, the values are redistributed by matching
+/// the cells by their geometry nodes (see
+/// mesh::Geometry::input_global_indices), which requires an element
+/// without dof transformations.
+namespace checkpoint
+{
+
+/// Write the degrees-of-freedom of a Function
+/// @note Collective
+/// @param[in] h5_id The HDF5 file handle
+/// @param[in] h5_options Options for writing HDF5 datasets
+/// @param[in] u The Function
+/// @param[in] name The name of the checkpoint. The data is saved in the
+/// group /Checkpoint/<name> of the file.
+void write_function(hid_t h5_id, const HDF5Interface::WriteOptions& h5_options,
+                    const fem::Function<double>& u, const std::string& name);
+
+/// Write the degrees-of-freedom of a complex Function
+/// @note Collective
+/// @param[in] h5_id The HDF5 file handle
+/// @param[in] h5_options Options for writing HDF5 datasets
+/// @param[in] u The Function
+/// @param[in] name The name of the checkpoint
+void write_function(hid_t h5_id, const HDF5Interface::WriteOptions& h5_options,
+                    const fem::Function<std::complex<double>>& u,
+                    const std::string& name);
+
+/// Read the degrees-of-freedom of a Function
+/// @note Collective
+/// @param[in] h5_id The HDF5 file handle
+/// @param[in,out] u The Function, whose function space must be the
+/// same as the function space of the Function that was saved, on the
+/// same mesh, possibly distributed differently
+/// @param[in] name The name of the checkpoint
+void read_function(hid_t h5_id, fem::Function<double>& u,
+                   const std::string& name);
+
+/// Read the degrees-of-freedom of a complex Function
+/// @note Collective
+/// @param[in] h5_id The HDF5 file handle
+/// @param[in,out] u The Function
+/// @param[in] name The name of the checkpoint
+void read_function(hid_t h5_id, fem::Function<std::complex<double>>& u,
+                   const std::string& name);
+
+} // namespace checkpoint
+} // namespace dolfinx::io
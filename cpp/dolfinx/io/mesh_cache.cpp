@@ -0,0 +1,440 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "mesh_cache.h"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <climits>
+#include <cstring>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/MPI.h>
+#include <dolfinx/fem/CoordinateElement.h>
+#include <dolfinx/graph/AdjacencyList.h>
+#include <dolfinx/mesh/Geometry.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <dolfinx/mesh/Topology.h>
+#include <dolfinx/mesh/cell_types.h>
+#include <fcntl.h>
+#include <memory>
+#include <numeric>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include <xtl/xspan.hpp>
+
+using namespace dolfinx;
+using namespace dolfinx::io;
+
+namespace
+{
+// Identifies a mesh cache file and the version of its layout
+constexpr std::array<char, 8> file_magic
+    = {'D', 'O', 'L', 'F', 'X', 'M', 'S', 'H'};
+constexpr std::int32_t file_version = 2;
+
+// Header of a mesh cache file. It is followed by the byte offsets of
+// the blocks of the processes (comm_size + 1 values), and by the
+// blocks.
+struct Header
+{
+  std::array<char, 8> magic;
+  std::int32_t version;
+  std::int32_t comm_size;
+  std::int32_t cell_type;
+  std::int32_t degree;
+  std::int32_t gdim;
+  std::int32_t tdim;
+};
+static_assert(sizeof(Header) % 8 == 0);
+
+//-----------------------------------------------------------------------------
+
+// Append an array to a block, as its size followed by the data, padded
+// to a multiple of 8 bytes so that the next array is aligned
+template <typename T>
+void pack(std::vector<char>& block, const xtl::span<const T>& data)
+{
+  const std::int64_t size = data.size();
+  const char* p = reinterpret_cast<const char*>(&size);
+  block.insert(block.end(), p, p + sizeof(size));
+  p = reinterpret_cast<const char*>(data.data());
+  block.insert(block.end(), p, p + data.size_bytes());
+  block.resize(block.size() + (8 - block.size() % 8) % 8, 0);
+}
+//-----------------------------------------------------------------------------
+
+// Get the next array of a block that is mapped in memory, and advance
+// the position past it. The data is not copied.
+template <typename T>
+xtl::span<const T> unpack(const char*& p, const char* end)
+{
+  std::int64_t size = 0;
+  if (std::distance(p, end) < (std::ptrdiff_t)sizeof(size))
+    throw std::runtime_error("Mesh cache file is truncated.");
+  std::memcpy(&size, p, sizeof(size));
+  p += sizeof(size);
+  if (size < 0)
+    throw std::runtime_error("Invalid mesh cache file.");
+
+  const std::size_t num_bytes = 8 * ((size * sizeof(T) + 7) / 8);
+  if (std::distance(p, end) < (std::ptrdiff_t)num_bytes)
+    throw std::runtime_error("Mesh cache file is truncated.");
+  xtl::span<const T> data(reinterpret_cast<const T*>(p), size);
+  p += num_bytes;
+  return data;
+}
+//-----------------------------------------------------------------------------
+void pack_flag(std::vector<char>& block, bool flag)
+{
+  const std::int32_t value = flag;
+  pack(block, xtl::span<const std::int32_t>(&value, 1));
+}
+//-----------------------------------------------------------------------------
+bool unpack_flag(const char*& p, const char* end)
+{
+  xtl::span<const std::int32_t> value = unpack<std::int32_t>(p, end);
+  if (value.size() != 1)
+    throw std::runtime_error("Invalid mesh cache file.");
+  return value[0];
+}
+//-----------------------------------------------------------------------------
+
+// Pack the data that is required to re-create an IndexMap with the
+// same ownership and ghosts
+void pack_index_map(std::vector<char>& block, const common::IndexMap& map)
+{
+  const std::int32_t size_local = map.size_local();
+  pack(block, xtl::span<const std::int32_t>(&size_local, 1));
+  const auto [_, dest_ranks] = dolfinx::MPI::neighbors(
+      map.comm(common::IndexMap::Direction::forward));
+  pack<int>(block, dest_ranks);
+  pack<std::int64_t>(block, map.ghosts());
+  pack<int>(block, map.ghost_owner_rank());
+}
+//-----------------------------------------------------------------------------
+std::shared_ptr<const common::IndexMap>
+unpack_index_map(MPI_Comm comm, const char*& p, const char* end)
+{
+  xtl::span<const std::int32_t> size_local = unpack<std::int32_t>(p, end);
+  if (size_local.size() != 1)
+    throw std::runtime_error("Invalid mesh cache file.");
+  xtl::span<const int> dest_ranks = unpack<int>(p, end);
+  xtl::span<const std::int64_t> ghosts = unpack<std::int64_t>(p, end);
+  xtl::span<const int> src_ranks = unpack<int>(p, end);
+  return std::make_shared<common::IndexMap>(comm, size_local[0], dest_ranks,
+                                            ghosts, src_ranks);
+}
+//-----------------------------------------------------------------------------
+void pack_adjacency_list(std::vector<char>& block,
+                         const graph::AdjacencyList<std::int32_t>& list)
+{
+  // The degree of a compact list, or zero. The offsets are stored only
+  // for lists that are not compact.
+  const std::int32_t degree = list.is_compact() ? list.num_links(0) : 0;
+  pack(block, xtl::span<const std::int32_t>(&degree, 1));
+  pack<std::int32_t>(block, list.array());
+  if (degree == 0)
+    pack<std::int32_t>(block, list.offsets());
+}
+//-----------------------------------------------------------------------------
+graph::AdjacencyList<std::int32_t> unpack_adjacency_list(const char*& p,
+                                                         const char* end)
+{
+  xtl::span<const std::int32_t> degree = unpack<std::int32_t>(p, end);
+  if (degree.size() != 1 or degree[0] < 0)
+    throw std::runtime_error("Invalid mesh cache file.");
+  xtl::span<const std::int32_t> array = unpack<std::int32_t>(p, end);
+  if (degree[0] > 0)
+  {
+    if (array.size() % degree[0] != 0)
+      throw std::runtime_error("Invalid mesh cache file.");
+    return graph::AdjacencyList<std::int32_t>(
+        std::vector<std::int32_t>(array.begin(), array.end()), degree[0]);
+  }
+
+  xtl::span<const std::int32_t> offsets = unpack<std::int32_t>(p, end);
+  return graph::AdjacencyList<std::int32_t>(
+      std::vector<std::int32_t>(array.begin(), array.end()),
+      std::vector<std::int32_t>(offsets.begin(), offsets.end()));
+}
+//-----------------------------------------------------------------------------
+
+// Read-only memory map of a file, which is unmapped on destruction
+class MappedFile
+{
+public:
+  // Map the file. On failure, data() is null.
+  explicit MappedFile(const std::string& filename)
+  {
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd == -1)
+      return;
+
+    struct stat st;
+    if (::fstat(fd, &st) == 0 and st.st_size > 0)
+    {
+      void* addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (addr != MAP_FAILED)
+      {
+        _data = static_cast<const char*>(addr);
+        _size = st.st_size;
+      }
+    }
+
+    // The mapping remains valid after the file descriptor is closed
+    ::close(fd);
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  ~MappedFile()
+  {
+    if (_data)
+      ::munmap(const_cast<char*>(_data), _size);
+  }
+
+  const char* data() const { return _data; }
+  std::size_t size() const { return _size; }
+
+private:
+  const char* _data = nullptr;
+  std::size_t _size = 0;
+};
+//-----------------------------------------------------------------------------
+
+// Check the header of a mapped mesh cache file for reading on a
+// communicator of the given size. Returns an error message, which is
+// empty if the file can be read.
+std::string check_header(const MappedFile& file, int comm_size)
+{
+  if (!file.data())
+    return "Failed to map mesh cache file.";
+  if (file.size() < sizeof(Header))
+    return "Invalid mesh cache file.";
+
+  Header header;
+  std::memcpy(&header, file.data(), sizeof(Header));
+  if (header.magic != file_magic)
+    return "File is not a mesh cache file.";
+  if (header.version != file_version)
+    return "Unsupported mesh cache file version.";
+  if (header.comm_size != comm_size)
+  {
+    return "Mesh cache file was written on "
+           + std::to_string(header.comm_size)
+           + " processes, and cannot be read on "
+           + std::to_string(comm_size) + " processes.";
+  }
+
+  const std::size_t offsets_size = sizeof(std::int64_t) * (comm_size + 1);
+  if (file.size() < sizeof(Header) + offsets_size)
+    return "Mesh cache file is truncated.";
+  std::int64_t end = 0;
+  std::memcpy(&end, file.data() + sizeof(Header) + offsets_size
+                        - sizeof(std::int64_t),
+              sizeof(end));
+  if (end < 0 or (std::size_t)end > file.size())
+    return "Mesh cache file is truncated.";
+
+  return std::string();
+}
+//-----------------------------------------------------------------------------
+
+// Write bytes at an offset of a file, in chunks that fit the int count
+// of MPI-IO
+void write_at(MPI_File fh, MPI_Offset offset, const char* data,
+              std::size_t size)
+{
+  while (size > 0)
+  {
+    const int count = std::min(size, std::size_t(INT_MAX));
+    MPI_File_write_at(fh, offset, data, count, MPI_CHAR, MPI_STATUS_IGNORE);
+    offset += count;
+    data += count;
+    size -= count;
+  }
+}
+//-----------------------------------------------------------------------------
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+void mesh_cache::write(const mesh::Mesh& mesh, const std::string& filename)
+{
+  MPI_Comm comm = mesh.mpi_comm();
+  const int rank = dolfinx::MPI::rank(comm);
+  const int size = dolfinx::MPI::size(comm);
+
+  const mesh::Topology& topology = mesh.topology();
+  const mesh::Geometry& geometry = mesh.geometry();
+  const int tdim = topology.dim();
+  const int gdim = geometry.dim();
+
+  // Pack the block of this process
+  std::vector<char> block;
+  pack<char>(block, xtl::span<const char>(mesh.name.data(), mesh.name.size()));
+  for (int d = 0; d <= tdim; ++d)
+  {
+    std::shared_ptr<const common::IndexMap> map = topology.index_map(d);
+    pack_flag(block, bool(map));
+    if (map)
+      pack_index_map(block, *map);
+  }
+
+  for (int d0 = 0; d0 <= tdim; ++d0)
+  {
+    for (int d1 = 0; d1 <= tdim; ++d1)
+    {
+      std::shared_ptr<const graph::AdjacencyList<std::int32_t>> c
+          = topology.connectivity(d0, d1);
+      pack_flag(block, bool(c));
+      if (c)
+        pack_adjacency_list(block, *c);
+    }
+  }
+
+  assert(geometry.index_map());
+  pack_index_map(block, *geometry.index_map());
+
+  // The geometry dofmap is stored once if it is shared with the
+  // cell-vertex connectivity
+  const bool shared_dofmap
+      = &geometry.dofmap() == topology.connectivity(tdim, 0).get();
+  pack_flag(block, shared_dofmap);
+  if (!shared_dofmap)
+    pack_adjacency_list(block, geometry.dofmap());
+
+  // Coordinates, without the padding of the geometry to 3D
+  const xt::xtensor<double, 2>& x = geometry.x();
+  std::vector<double> x_g(x.shape(0) * gdim);
+  for (std::size_t i = 0; i < x.shape(0); ++i)
+    for (int j = 0; j < gdim; ++j)
+      x_g[i * gdim + j] = x(i, j);
+  pack<double>(block, x_g);
+  pack<std::int64_t>(block, geometry.input_global_indices());
+
+  // Compute the byte offsets of the blocks of all processes
+  const std::int64_t block_size = block.size();
+  std::vector<std::int64_t> offsets(size + 1);
+  MPI_Allgather(&block_size, 1, MPI_INT64_T, offsets.data() + 1, 1,
+                MPI_INT64_T, comm);
+  offsets[0] = sizeof(Header) + sizeof(std::int64_t) * offsets.size();
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+  MPI_File fh;
+  if (MPI_File_open(comm, filename.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                    MPI_INFO_NULL, &fh)
+      != MPI_SUCCESS)
+  {
+    throw std::runtime_error("Failed to open mesh cache file: " + filename);
+  }
+  MPI_File_set_size(fh, 0);
+
+  if (rank == 0)
+  {
+    Header header;
+    header.magic = file_magic;
+    header.version = file_version;
+    header.comm_size = size;
+    header.cell_type = static_cast<std::int32_t>(topology.cell_type());
+    header.degree = geometry.cmap().degree();
+    header.gdim = gdim;
+    header.tdim = tdim;
+    write_at(fh, 0, reinterpret_cast<const char*>(&header), sizeof(Header));
+    write_at(fh, sizeof(Header), reinterpret_cast<const char*>(offsets.data()),
+             sizeof(std::int64_t) * offsets.size());
+  }
+  write_at(fh, offsets[rank], block.data(), block.size());
+
+  MPI_File_close(&fh);
+}
+//-----------------------------------------------------------------------------
+mesh::Mesh mesh_cache::read(MPI_Comm comm, const std::string& filename)
+{
+  const int rank = dolfinx::MPI::rank(comm);
+  const int size = dolfinx::MPI::size(comm);
+
+  // Map the file. Only the pages of the header and of the block of this
+  // process are read from disk.
+  MappedFile file(filename);
+
+  // Check the file on all processes before any collective construction
+  const std::string error = check_header(file, size);
+  int failed = !error.empty();
+  MPI_Allreduce(MPI_IN_PLACE, &failed, 1, MPI_INT, MPI_MAX, comm);
+  if (failed)
+  {
+    throw std::runtime_error(error.empty() ? "Failed to read mesh cache "
+                                             "file on another process."
+                                           : error + " File: " + filename);
+  }
+
+  Header header;
+  std::memcpy(&header, file.data(), sizeof(Header));
+  std::array<std::int64_t, 2> range;
+  std::memcpy(range.data(),
+              file.data() + sizeof(Header) + sizeof(std::int64_t) * rank,
+              sizeof(range));
+  const char* p = file.data() + range[0];
+  const char* end = file.data() + range[1];
+
+  const mesh::CellType cell_type
+      = static_cast<mesh::CellType>(header.cell_type);
+  const int tdim = header.tdim;
+  const int gdim = header.gdim;
+
+  xtl::span<const char> name = unpack<char>(p, end);
+  mesh::Topology topology(comm, cell_type);
+  for (int d = 0; d <= tdim; ++d)
+  {
+    if (unpack_flag(p, end))
+      topology.set_index_map(d, unpack_index_map(comm, p, end));
+  }
+
+  for (int d0 = 0; d0 <= tdim; ++d0)
+  {
+    for (int d1 = 0; d1 <= tdim; ++d1)
+    {
+      if (unpack_flag(p, end))
+      {
+        topology.set_connectivity(
+            std::make_shared<graph::AdjacencyList<std::int32_t>>(
+                unpack_adjacency_list(p, end)),
+            d0, d1);
+      }
+    }
+  }
+
+  std::shared_ptr<const common::IndexMap> x_map
+      = unpack_index_map(comm, p, end);
+  std::shared_ptr<const graph::AdjacencyList<std::int32_t>> dofmap;
+  if (unpack_flag(p, end))
+    dofmap = topology.connectivity(tdim, 0);
+  else
+  {
+    dofmap = std::make_shared<const graph::AdjacencyList<std::int32_t>>(
+        unpack_adjacency_list(p, end));
+  }
+
+  xtl::span<const double> x_g = unpack<double>(p, end);
+  xt::xtensor<double, 2> x(
+      {x_g.size() / gdim, static_cast<std::size_t>(gdim)});
+  std::copy(x_g.begin(), x_g.end(), x.begin());
+  xtl::span<const std::int64_t> igi = unpack<std::int64_t>(p, end);
+
+  mesh::Geometry geometry(x_map, dofmap,
+                          fem::CoordinateElement(cell_type, header.degree),
+                          std::move(x),
+                          std::vector<std::int64_t>(igi.begin(), igi.end()));
+
+  mesh::Mesh mesh(comm, std::move(topology), std::move(geometry));
+  mesh.name = std::string(name.begin(), name.end());
+  return mesh;
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,57 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <mpi.h>
+#include <string>
+
+namespace dolfinx::mesh
+{
+class Mesh;
+}
+
+namespace dolfinx::io
+{
+
+/// Binary cache of a distributed mesh, for fast start up of repeated
+/// runs on the same number of processes.
+///
+/// The cache stores the mesh exactly as it is distributed in memory:
+/// for each process, the IndexMaps and the computed connectivities of
+/// the topology, and the geometry (IndexMap, dofmap, coordinates and
+/// input global indices). The data of each process is one contiguous
+/// block of the file, in the native layout of the arrays.
+///
+/// Reading maps the file into memory and constructs the mesh from the
+/// block of the calling process, without parsing, partitioning or
+/// computing connectivities. The entity permutations and the exterior
+/// facets are not stored, and are computed on demand from the cached
+/// connectivities.
+///
+/// @note The file layout depends on the byte order and the size of the
+/// integer types, and a cache can only be read on a system of the same
+/// type as the system that wrote it.
+namespace mesh_cache
+{
+
+/// Write a mesh cache
+/// @note Collective
+/// @param[in] mesh The mesh
+/// @param[in] filename The name of the file
+void write(const mesh::Mesh& mesh, const std::string& filename);
+
+/// Read a mesh cache
+/// @note Collective
+/// @param[in] comm The MPI communicator, which must have the same size
+/// as the communicator of the mesh that was written
+/// @param[in] filename The name of the file
+/// @return The mesh, with the distribution, entities and connectivities
+/// of the mesh that was written
+mesh::Mesh read(MPI_Comm comm, const std::string& filename);
+
+} // namespace mesh_cache
+} // namespace dolfinx::io
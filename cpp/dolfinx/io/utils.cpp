@@ -5,7 +5,10 @@
 // SPDX-License-Identifier:    LGPL-3.0-or-later
 
 #include "utils.h"
+#include "pugixml.hpp"
 #include <boost/filesystem.hpp>
+#include <chrono>
+#include <dolfinx/common/timing.h>
 
 using namespace dolfinx;
 
@@ -16,3 +19,17 @@ std::string io::get_filename(const std::string& fullname)
   return p.filename().string();
 }
 //-----------------------------------------------------------------------------
+bool io::save_xml(const pugi::xml_document& doc, const std::string& filename,
+                  const std::string& site)
+{
+  auto timer_start = std::chrono::system_clock::now();
+  const bool saved = doc.save_file(filename.c_str(), "  ");
+  std::chrono::duration<double> dt
+      = std::chrono::system_clock::now() - timer_start;
+
+  boost::system::error_code ec;
+  const std::uintmax_t size = boost::filesystem::file_size(filename, ec);
+  dolfinx::register_io(site, filename, ec ? 0 : size, dt.count(), false);
+  return saved;
+}
+//-----------------------------------------------------------------------------
@@ -8,6 +8,11 @@
 
 #include <string>
 
+namespace pugi
+{
+class xml_document;
+}
+
 /// Tools for supporting IO
 namespace dolfinx::io
 {
@@ -17,4 +22,14 @@ namespace dolfinx::io
 /// @return The filename (without path)
 std::string get_filename(const std::string& fullname);
 
+/// Save an XML document to a file, and register the size of the file
+/// and the time in the I/O statistics (see dolfinx::register_io)
+/// @param[in] doc The XML document
+/// @param[in] filename The name of the file
+/// @param[in] site The call site of the I/O statistics, e.g. "XDMF
+/// write"
+/// @return True if the file was saved
+bool save_xml(const pugi::xml_document& doc, const std::string& filename,
+              const std::string& site);
+
 } // namespace dolfinx::io
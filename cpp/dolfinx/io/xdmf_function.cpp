@@ -8,7 +8,6 @@
 #include "pugixml.hpp"
 #include "xdmf_mesh.h"
 #include "xdmf_utils.h"
-#include <boost/lexical_cast.hpp>
 #include <dolfinx/common/IndexMap.h>
 #include <dolfinx/fem/DofMap.h>
 #include <dolfinx/fem/FiniteElement.h>
@@ -76,7 +75,8 @@ int get_padded_width(const fem::FiniteElement& e)
 //-----------------------------------------------------------------------------
 template <typename Scalar>
 void _add_function(MPI_Comm comm, const fem::Function<Scalar>& u,
-                   const double t, pugi::xml_node& xml_node, const hid_t h5_id)
+                   const double t, pugi::xml_node& xml_node, const hid_t h5_id,
+                   const HDF5Interface::WriteOptions& h5_options)
 {
   LOG(INFO) << "Adding function to node \"" << xml_node.path('/') << "\"";
 
@@ -110,23 +110,31 @@ void _add_function(MPI_Comm comm, const fem::Function<Scalar>& u,
   if constexpr (!std::is_scalar<Scalar>::value)
     components = {"real", "imag"};
 
-  std::string t_str = boost::lexical_cast<std::string>(t);
-  std::replace(t_str.begin(), t_str.end(), '.', '_');
+  // With HDF5 storage, the values at all times are appended to one
+  // dataset for each function (component)
+  auto add_data_item = [&](pugi::xml_node& node, const std::string& path,
+                           const auto& x, std::int64_t offset)
+  {
+    if (h5_id < 0)
+    {
+      xdmf_utils::add_data_item(node, h5_id, path, x, offset,
+                                {num_values, width}, "", h5_options);
+    }
+    else
+    {
+      xdmf_utils::append_data_item(node, h5_id, path, x, offset,
+                                   {num_values, width}, "", h5_options);
+    }
+  };
 
   for (const auto& component : components)
   {
     std::string attr_name;
-    std::string dataset_name;
     if (component.empty())
-    {
       attr_name = u.name;
-      dataset_name = "/Function/" + attr_name + "/" + t_str;
-    }
     else
-    {
       attr_name = component + "_" + u.name;
-      dataset_name = "/Function/" + attr_name + "/" + t_str;
-    }
+    const std::string dataset_name = "/Function/" + attr_name + "/values";
     // Add attribute node
     pugi::xml_node attribute_node = xml_node.append_child("Attribute");
     assert(attribute_node);
@@ -135,7 +143,6 @@ void _add_function(MPI_Comm comm, const fem::Function<Scalar>& u,
         = rank_to_string(value_rank).c_str();
     attribute_node.append_attribute("Center") = cell_centred ? "Cell" : "Node";
 
-    const bool use_mpi_io = (dolfinx::MPI::size(comm) > 1);
     if constexpr (!std::is_scalar<Scalar>::value)
     {
       // Complex case
@@ -156,9 +163,8 @@ void _add_function(MPI_Comm comm, const fem::Function<Scalar>& u,
       // Add data item of component
       const std::int64_t offset = dolfinx::MPI::global_offset(
           comm, component_data_values.size() / width, true);
-      xdmf_utils::add_data_item(attribute_node, h5_id, dataset_name,
-                                component_data_values, offset,
-                                {num_values, width}, "", use_mpi_io);
+      add_data_item(attribute_node, dataset_name, component_data_values,
+                    offset);
     }
     else
     {
@@ -167,9 +173,7 @@ void _add_function(MPI_Comm comm, const fem::Function<Scalar>& u,
       // Add data item
       const std::int64_t offset
           = dolfinx::MPI::global_offset(comm, data_values.size() / width, true);
-      xdmf_utils::add_data_item(attribute_node, h5_id, dataset_name,
-                                data_values, offset, {num_values, width}, "",
-                                use_mpi_io);
+      add_data_item(attribute_node, dataset_name, data_values, offset);
     }
   }
 }
@@ -179,16 +183,18 @@ void _add_function(MPI_Comm comm, const fem::Function<Scalar>& u,
 //-----------------------------------------------------------------------------
 void xdmf_function::add_function(MPI_Comm comm, const fem::Function<double>& u,
                                  const double t, pugi::xml_node& xml_node,
-                                 const hid_t h5_id)
+                                 const hid_t h5_id,
+                                 const HDF5Interface::WriteOptions& h5_options)
 {
-  _add_function(comm, u, t, xml_node, h5_id);
+  _add_function(comm, u, t, xml_node, h5_id, h5_options);
 }
 //-----------------------------------------------------------------------------
 void xdmf_function::add_function(MPI_Comm comm,
                                  const fem::Function<std::complex<double>>& u,
                                  const double t, pugi::xml_node& xml_node,
-                                 const hid_t h5_id)
+                                 const hid_t h5_id,
+                                 const HDF5Interface::WriteOptions& h5_options)
 {
-  _add_function(comm, u, t, xml_node, h5_id);
+  _add_function(comm, u, t, xml_node, h5_id, h5_options);
 }
 //-----------------------------------------------------------------------------
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include "HDF5Interface.h"
 #include <complex>
 #include <hdf5.h>
 #include <mpi.h>
@@ -31,11 +32,13 @@ namespace xdmf_function
 
 /// TODO
 void add_function(MPI_Comm comm, const fem::Function<double>& u, const double t,
-                  pugi::xml_node& xml_node, const hid_t h5_id);
+                  pugi::xml_node& xml_node, const hid_t h5_id,
+                  const HDF5Interface::WriteOptions& h5_options);
 
 /// TODO
 void add_function(MPI_Comm comm, const fem::Function<std::complex<double>>& u,
-                  const double t, pugi::xml_node& xml_node, const hid_t h5_id);
+                  const double t, pugi::xml_node& xml_node, const hid_t h5_id,
+                  const HDF5Interface::WriteOptions& h5_options);
 
 } // namespace xdmf_function
 } // namespace io
@@ -10,6 +10,8 @@
 #include "xdmf_read.h"
 #include "xdmf_utils.h"
 #include <dolfinx/fem/ElementDofLayout.h>
+#include <algorithm>
+#include <numeric>
 #include <xtensor/xadapt.hpp>
 
 using namespace dolfinx;
@@ -18,6 +20,7 @@ using namespace dolfinx::io;
 //-----------------------------------------------------------------------------
 void xdmf_mesh::add_topology_data(
     MPI_Comm comm, pugi::xml_node& xml_node, const hid_t h5_id,
+    const HDF5Interface::WriteOptions& h5_options,
     const std::string path_prefix, const mesh::Topology& topology,
     const mesh::Geometry& geometry, const int dim,
     const xtl::span<const std::int32_t>& active_entities)
@@ -52,8 +55,8 @@ void xdmf_mesh::add_topology_data(
   const std::int64_t offset_g = map_g->local_range()[0];
 
   const std::vector<std::int64_t>& ghosts = map_g->ghosts();
-  const std::vector vtk_map = io::cells::transpose(
-      io::cells::perm_vtk(entity_cell_type, num_nodes_per_entity));
+  const std::vector<std::uint8_t>& vtk_map
+      = io::cells::dolfinx_to_vtk(entity_cell_type, num_nodes_per_entity);
   auto map_e = topology.index_map(dim);
   assert(map_e);
   if (dim == tdim)
@@ -137,15 +140,14 @@ void xdmf_mesh::add_topology_data(
   const std::int64_t offset
       = dolfinx::MPI::global_offset(comm, num_entities_local, true);
 
-  const bool use_mpi_io = (dolfinx::MPI::size(comm) > 1);
   xdmf_utils::add_data_item(topology_node, h5_id, h5_path, topology_data,
-                            offset, shape, number_type, use_mpi_io);
+                            offset, shape, number_type, h5_options);
 }
 //-----------------------------------------------------------------------------
-void xdmf_mesh::add_geometry_data(MPI_Comm comm, pugi::xml_node& xml_node,
-                                  const hid_t h5_id,
-                                  const std::string path_prefix,
-                                  const mesh::Geometry& geometry)
+void xdmf_mesh::add_geometry_data(
+    MPI_Comm comm, pugi::xml_node& xml_node, const hid_t h5_id,
+    const HDF5Interface::WriteOptions& h5_options,
+    const std::string path_prefix, const mesh::Geometry& geometry)
 {
 
   LOG(INFO) << "Adding geometry data to node \"" << xml_node.path('/') << "\"";
@@ -188,14 +190,14 @@ void xdmf_mesh::add_geometry_data(MPI_Comm comm, pugi::xml_node& xml_node,
 
   const std::int64_t offset
       = dolfinx::MPI::global_offset(comm, num_points_local, true);
-  const bool use_mpi_io = (dolfinx::MPI::size(comm) > 1);
   xdmf_utils::add_data_item(geometry_node, h5_id, h5_path, x, offset, shape, "",
-                            use_mpi_io);
+                            h5_options);
 }
 //----------------------------------------------------------------------------
 void xdmf_mesh::add_mesh(MPI_Comm comm, pugi::xml_node& xml_node,
-                         const hid_t h5_id, const mesh::Mesh& mesh,
-                         const std::string name)
+                         const hid_t h5_id,
+                         const HDF5Interface::WriteOptions& h5_options,
+                         const mesh::Mesh& mesh, const std::string name)
 {
   LOG(INFO) << "Adding mesh to node \"" << xml_node.path('/') << "\"";
 
@@ -217,12 +219,111 @@ void xdmf_mesh::add_mesh(MPI_Comm comm, pugi::xml_node& xml_node,
   std::vector<std::int32_t> active_cells(num_cells);
   std::iota(active_cells.begin(), active_cells.end(), 0);
 
-  add_topology_data(comm, grid_node, h5_id, path_prefix, mesh.topology(),
-                    mesh.geometry(), tdim,
+  add_topology_data(comm, grid_node, h5_id, h5_options, path_prefix,
+                    mesh.topology(), mesh.geometry(), tdim,
                     xtl::span<std::int32_t>(active_cells.data(), num_cells));
 
   // Add geometry node and attributes (including writing data)
-  add_geometry_data(comm, grid_node, h5_id, path_prefix, mesh.geometry());
+  add_geometry_data(comm, grid_node, h5_id, h5_options, path_prefix,
+                    mesh.geometry());
+}
+//----------------------------------------------------------------------------
+void xdmf_mesh::add_partition_data(
+    MPI_Comm comm, pugi::xml_node& xml_node, const hid_t h5_id,
+    const HDF5Interface::WriteOptions& h5_options,
+    const std::string path_prefix, const mesh::Mesh& mesh)
+{
+  LOG(INFO) << "Adding partition data to node \"" << xml_node.path('/')
+            << "\"";
+
+  if (h5_id < 0)
+  {
+    throw std::runtime_error(
+        "Cell partition can only be saved with HDF5 encoding.");
+  }
+
+  // Pack the destination ranks of the owned cells, with the owner first
+  // followed by the (sorted) ranks that ghost the cell
+  auto map = mesh.topology().index_map(mesh.topology().dim());
+  assert(map);
+  const int rank = dolfinx::MPI::rank(comm);
+  const std::int32_t num_cells = map->size_local();
+  const graph::AdjacencyList<int> sharing_ranks = map->compute_sharing_ranks();
+  std::vector<std::int32_t> num_dest(num_cells), dest;
+  for (std::int32_t c = 0; c < num_cells; ++c)
+  {
+    auto ranks = sharing_ranks.links(c);
+    num_dest[c] = ranks.size() + 1;
+    dest.push_back(rank);
+    dest.insert(dest.end(), ranks.begin(), ranks.end());
+  }
+
+  // Add Information node, with the number of processes as the value
+  pugi::xml_node partition_node = xml_node.append_child("Information");
+  assert(partition_node);
+  partition_node.append_attribute("Name") = "Partition";
+  partition_node.append_attribute("Value") = dolfinx::MPI::size(comm);
+
+  // Add DataItem nodes for the number of destinations of each cell and
+  // for the destinations
+  xdmf_utils::add_data_item(
+      partition_node, h5_id, path_prefix + "/partition/num_destinations",
+      num_dest, map->local_range()[0], {map->size_global()}, "Int",
+      h5_options);
+
+  const std::int64_t num_dest_local = dest.size();
+  std::int64_t num_dest_global = 0;
+  MPI_Allreduce(&num_dest_local, &num_dest_global, 1, MPI_INT64_T, MPI_SUM,
+                comm);
+  const std::int64_t offset
+      = dolfinx::MPI::global_offset(comm, num_dest_local, true);
+  xdmf_utils::add_data_item(partition_node, h5_id,
+                            path_prefix + "/partition/destinations", dest,
+                            offset, {num_dest_global}, "Int", h5_options);
+}
+//----------------------------------------------------------------------------
+bool xdmf_mesh::has_partition_data(MPI_Comm comm, const pugi::xml_node& node)
+{
+  pugi::xml_node partition_node
+      = node.select_node("Information[@Name='Partition']").node();
+  return partition_node
+         and partition_node.attribute("Value").as_int()
+                 == dolfinx::MPI::size(comm);
+}
+//----------------------------------------------------------------------------
+graph::AdjacencyList<std::int32_t>
+xdmf_mesh::read_partition_data(MPI_Comm comm, const hid_t h5_id,
+                               const pugi::xml_node& node)
+{
+  if (!has_partition_data(comm, node))
+  {
+    throw std::runtime_error(
+        "Mesh has no cell partition for this number of processes.");
+  }
+
+  pugi::xml_node partition_node
+      = node.select_node("Information[@Name='Partition']").node();
+  pugi::xml_node num_dest_node = partition_node.child("DataItem");
+  assert(num_dest_node);
+  pugi::xml_node dest_node = num_dest_node.next_sibling("DataItem");
+  assert(dest_node);
+
+  // Read the number of destinations of each cell. The cells are read in
+  // the same range as the cells in read_topology_data.
+  const std::vector num_dest
+      = xdmf_read::get_dataset<std::int32_t>(comm, num_dest_node, h5_id);
+  std::vector<std::int32_t> offsets(num_dest.size() + 1, 0);
+  std::partial_sum(num_dest.begin(), num_dest.end(),
+                   std::next(offsets.begin()));
+
+  // Read the destinations of the cells
+  const std::int64_t offset
+      = dolfinx::MPI::global_offset(comm, offsets.back(), true);
+  std::vector dest = xdmf_read::get_dataset<std::int32_t>(
+      comm, dest_node, h5_id, {offset, offset + offsets.back()});
+
+  return graph::AdjacencyList<std::int32_t>(std::move(dest),
+                                            std::move(offsets));
 }
 //----------------------------------------------------------------------------
 xt::xtensor<double, 2> xdmf_mesh::read_geometry_data(MPI_Comm comm,
@@ -266,9 +367,9 @@ xt::xtensor<double, 2> xdmf_mesh::read_geometry_data(MPI_Comm comm,
                    xt::no_ownership(), shape);
 }
 //----------------------------------------------------------------------------
-xt::xtensor<std::int64_t, 2>
-xdmf_mesh::read_topology_data(MPI_Comm comm, const hid_t h5_id,
-                              const pugi::xml_node& node)
+graph::AdjacencyList<std::int64_t>
+xdmf_mesh::read_topology_adjacency(MPI_Comm comm, const hid_t h5_id,
+                                   const pugi::xml_node& node)
 {
   // Get topology node
   pugi::xml_node topology_node = node.child("Topology");
@@ -287,17 +388,45 @@ xdmf_mesh::read_topology_data(MPI_Comm comm, const hid_t h5_id,
   const std::vector tdims = xdmf_utils::get_dataset_shape(topology_data_node);
   const std::size_t npoint_per_cell = tdims[1];
 
-  // Read topology data
+  // Read the contiguous block of cells of this process
   std::vector<std::int64_t> topology_data
       = xdmf_read::get_dataset<std::int64_t>(comm, topology_data_node, h5_id);
   const std::size_t num_local_cells = topology_data.size() / npoint_per_cell;
 
-  std::array<std::size_t, 2> shape = {num_local_cells, npoint_per_cell};
-  auto cells_vtk = xt::adapt(topology_data.data(), topology_data.size(),
-                             xt::no_ownership(), shape);
+  // Permute cells from VTK to DOLFINx ordering in place
+  const std::vector<std::uint8_t>& perm
+      = io::cells::vtk_to_dolfinx(cell_type, npoint_per_cell);
+  std::vector<std::int64_t> cell_vtk(npoint_per_cell);
+  for (std::size_t c = 0; c < num_local_cells; ++c)
+  {
+    auto cell = std::next(topology_data.begin(), c * npoint_per_cell);
+    std::copy_n(cell, npoint_per_cell, cell_vtk.begin());
+    for (std::size_t i = 0; i < npoint_per_cell; ++i)
+      cell[i] = cell_vtk[perm[i]];
+  }
 
-  //  Permute cells from VTK to DOLFINx ordering
-  return io::cells::compute_permutation(
-      cells_vtk, io::cells::perm_vtk(cell_type, cells_vtk.shape(1)));
+  std::vector<std::int32_t> offsets(num_local_cells + 1);
+  for (std::size_t c = 0; c < offsets.size(); ++c)
+    offsets[c] = c * npoint_per_cell;
+
+  return graph::AdjacencyList<std::int64_t>(std::move(topology_data),
+                                            std::move(offsets));
+}
+//----------------------------------------------------------------------------
+xt::xtensor<std::int64_t, 2>
+xdmf_mesh::read_topology_data(MPI_Comm comm, const hid_t h5_id,
+                              const pugi::xml_node& node)
+{
+  pugi::xml_node topology_data_node = node.child("Topology").child("DataItem");
+  assert(topology_data_node);
+  const std::size_t npoint_per_cell
+      = xdmf_utils::get_dataset_shape(topology_data_node)[1];
+
+  const graph::AdjacencyList<std::int64_t> cells
+      = read_topology_adjacency(comm, h5_id, node);
+  const std::size_t num_local_cells = cells.num_nodes();
+  std::array<std::size_t, 2> shape = {num_local_cells, npoint_per_cell};
+  return xt::adapt(cells.array().data(), cells.array().size(),
+                   xt::no_ownership(), shape);
 }
 //----------------------------------------------------------------------------
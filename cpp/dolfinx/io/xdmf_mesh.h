@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include "HDF5Interface.h"
+#include <dolfinx/graph/AdjacencyList.h>
 #include <dolfinx/mesh/cell_types.h>
 #include <hdf5.h>
 #include <mpi.h>
@@ -38,12 +40,14 @@ namespace io::xdmf_mesh
 /// Creates new Grid with Topology and Geometry xml nodes for mesh. In
 /// HDF file data is stored under path prefix.
 void add_mesh(MPI_Comm comm, pugi::xml_node& xml_node, const hid_t h5_id,
+              const HDF5Interface::WriteOptions& h5_options,
               const mesh::Mesh& mesh, const std::string path_prefix);
 
 /// Add Topology xml node
 /// @param[in] comm
 /// @param[in] xml_node
 /// @param[in] h5_id
+/// @param[in] h5_options Options for writing HDF5 datasets
 /// @param[in] path_prefix
 /// @param[in] topology
 /// @param[in] geometry
@@ -52,21 +56,57 @@ void add_mesh(MPI_Comm comm, pugi::xml_node& xml_node, const hid_t h5_id,
 ///   whose topology will be saved. This is used to save subsets of
 ///   Mesh.
 void add_topology_data(MPI_Comm comm, pugi::xml_node& xml_node,
-                       const hid_t h5_id, const std::string path_prefix,
+                       const hid_t h5_id,
+                       const HDF5Interface::WriteOptions& h5_options,
+                       const std::string path_prefix,
                        const mesh::Topology& topology,
                        const mesh::Geometry& geometry, const int cell_dim,
                        const xtl::span<const std::int32_t>& active_entities);
 
 /// Add Geometry xml node
 void add_geometry_data(MPI_Comm comm, pugi::xml_node& xml_node,
-                       const hid_t h5_id, const std::string path_prefix,
+                       const hid_t h5_id,
+                       const HDF5Interface::WriteOptions& h5_options,
+                       const std::string path_prefix,
                        const mesh::Geometry& geometry);
 
+/// Add the cell partition of a mesh to xml node
+///
+/// Adds an Information node that holds the destination ranks of the
+/// owned cells, i.e. the owning rank followed by the ranks that ghost
+/// the cell, in the format returned by mesh::CellPartitionFunction. The
+/// cells are in the order in which add_mesh writes them. Only HDF5
+/// storage is supported.
+void add_partition_data(MPI_Comm comm, pugi::xml_node& xml_node,
+                        const hid_t h5_id,
+                        const HDF5Interface::WriteOptions& h5_options,
+                        const std::string path_prefix,
+                        const mesh::Mesh& mesh);
+
+/// Check if a mesh Grid node has a cell partition that was saved for
+/// the number of processes in @p comm
+bool has_partition_data(MPI_Comm comm, const pugi::xml_node& node);
+
+/// Read the cell partition of a mesh Grid node
+/// @returns The destination ranks of the cells that read_topology_data
+/// returns on this process
+graph::AdjacencyList<std::int32_t>
+read_partition_data(MPI_Comm comm, const hid_t h5_id,
+                    const pugi::xml_node& node);
+
 /// Read Geometry data
 /// @returns geometry
 xt::xtensor<double, 2> read_geometry_data(MPI_Comm comm, const hid_t h5_id,
                                           const pugi::xml_node& node);
 
+/// Read Topology data as an adjacency list that can be passed to the
+/// mesh partitioner. Each process reads one contiguous block of cells,
+/// which is permuted in place from VTK to DOLFINx ordering.
+/// @returns The cells of this process
+graph::AdjacencyList<std::int64_t>
+read_topology_adjacency(MPI_Comm comm, const hid_t h5_id,
+                        const pugi::xml_node& node);
+
 /// Read Topology data
 /// @returns ((cell type, degree), topology)
 xt::xtensor<std::int64_t, 2> read_topology_data(MPI_Comm comm,
@@ -27,6 +27,7 @@ namespace xdmf_meshtags
 template <typename T>
 void add_meshtags(MPI_Comm comm, const mesh::MeshTags<T>& meshtags,
                   pugi::xml_node& xml_node, const hid_t h5_id,
+                  const HDF5Interface::WriteOptions& h5_options,
                   const std::string name)
 {
   // Get mesh
@@ -45,8 +46,8 @@ void add_meshtags(MPI_Comm comm, const mesh::MeshTags<T>& meshtags,
 
   const std::string path_prefix = "/MeshTags/" + name;
   xdmf_mesh::add_topology_data(
-      comm, xml_node, h5_id, path_prefix, mesh->topology(), mesh->geometry(),
-      dim,
+      comm, xml_node, h5_id, h5_options, path_prefix, mesh->topology(),
+      mesh->geometry(), dim,
       xtl::span<const std::int32_t>(meshtags.indices().data(),
                                     num_active_entities));
 
@@ -63,12 +64,10 @@ void add_meshtags(MPI_Comm comm, const mesh::MeshTags<T>& meshtags,
                 comm);
   const std::int64_t offset
       = dolfinx::MPI::global_offset(comm, num_active_entities, true);
-  const bool use_mpi_io = (dolfinx::MPI::size(comm) > 1);
-
   xdmf_utils::add_data_item(
       attribute_node, h5_id, path_prefix + "/Values",
       xtl::span<const T>(meshtags.values().data(), num_active_entities), offset,
-      {global_num_values, 1}, "", use_mpi_io);
+      {global_num_values, 1}, "", h5_options);
 }
 
 } // namespace xdmf_meshtags
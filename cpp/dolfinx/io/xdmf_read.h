@@ -98,9 +98,10 @@ std::vector<T> get_dataset(MPI_Comm comm, const pugi::xml_node& dataset_node,
       }
       else if (!shape_xml.empty() and shape_hdf5.size() == 1)
       {
-        // Size of dims > 0
-        std::int64_t d = std::accumulate(shape_xml.begin(), shape_xml.end(), 1,
-                                         std::multiplies<std::int64_t>());
+        // Number of values per row
+        std::int64_t d
+            = std::accumulate(std::next(shape_xml.begin()), shape_xml.end(),
+                              std::int64_t(1), std::multiplies<std::int64_t>());
 
         // Check for data size consistency
         if (d * shape_xml[0] != shape_hdf5[0])
@@ -111,7 +112,7 @@ std::vector<T> get_dataset(MPI_Comm comm, const pugi::xml_node& dataset_node,
 
         // Compute data range to read
         range = dolfinx::MPI::local_range(mpi_rank, shape_xml[0],
-                                          dolfinx::MPI::rank(comm));
+                                          dolfinx::MPI::size(comm));
         range[0] *= d;
         range[1] *= d;
       }
@@ -5,6 +5,7 @@
 // SPDX-License-Identifier:    LGPL-3.0-or-later
 
 #include "xdmf_utils.h"
+#include "cells.h"
 #include "pugixml.hpp"
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
@@ -51,12 +52,42 @@ std::vector<Scalar> _get_point_data_values(const fem::Function<Scalar>& u)
 {
   std::shared_ptr<const mesh::Mesh> mesh = u.function_space()->mesh();
   assert(mesh);
-  const xt::xtensor<Scalar, 2> data_values = u.compute_point_values();
-
   const int width = get_padded_width(*u.function_space()->element());
   assert(mesh->geometry().index_map());
   const std::size_t num_local_points
       = mesh->geometry().index_map()->size_local();
+
+  if (xdmf_utils::has_geometry_dof_layout(*u.function_space()))
+  {
+    // Copy the degrees-of-freedom at the owned geometry nodes directly
+    // into the padded array
+    const int value_rank = u.function_space()->element()->value_rank();
+    std::shared_ptr<const fem::DofMap> dofmap = u.function_space()->dofmap();
+    const int bs = dofmap->bs();
+    const graph::AdjacencyList<std::int32_t>& x_dofmap
+        = mesh->geometry().dofmap();
+    const std::vector<Scalar>& _u = u.x()->array();
+    std::vector<Scalar> _data_values(width * num_local_points, 0.0);
+    for (std::int32_t c = 0; c < x_dofmap.num_nodes(); ++c)
+    {
+      auto x_dofs = x_dofmap.links(c);
+      auto dofs = dofmap->cell_dofs(c);
+      for (std::size_t i = 0; i < x_dofs.size(); ++i)
+      {
+        if (static_cast<std::size_t>(x_dofs[i]) >= num_local_points)
+          continue;
+        for (int j = 0; j < bs; ++j)
+        {
+          int tensor_2d_offset = (j > 1 && value_rank == 2 && bs == 4) ? 1 : 0;
+          _data_values[x_dofs[i] * width + j + tensor_2d_offset]
+              = _u[bs * dofs[i] + j];
+        }
+      }
+    }
+    return _data_values;
+  }
+
+  const xt::xtensor<Scalar, 2> data_values = u.compute_point_values();
   assert(data_values.shape(0) >= num_local_points);
 
   // FIXME: Unpick the below code for the new layout of data from
@@ -301,6 +332,38 @@ std::int64_t xdmf_utils::get_num_cells(const pugi::xml_node& topology_node)
   return std::max(num_cells_topology, tdims[0]);
 }
 //----------------------------------------------------------------------------
+bool xdmf_utils::has_geometry_dof_layout(const fem::FunctionSpace& V)
+{
+  std::shared_ptr<const fem::FiniteElement> element = V.element();
+  assert(element);
+  if (element->family() != "Lagrange" and element->family() != "Q")
+    return false;
+
+  std::shared_ptr<const fem::DofMap> dofmap = V.dofmap();
+  assert(dofmap);
+  if (dofmap->bs() != element->value_size()
+      or dofmap->bs() != dofmap->index_map_bs())
+  {
+    return false;
+  }
+
+  std::shared_ptr<const mesh::Mesh> mesh = V.mesh();
+  assert(mesh);
+  const fem::ElementDofLayout& x_layout
+      = mesh->geometry().cmap().dof_layout();
+  assert(dofmap->element_dof_layout);
+  for (int d = 0; d <= mesh->topology().dim(); ++d)
+  {
+    if (dofmap->element_dof_layout->num_entity_dofs(d)
+        != x_layout.num_entity_dofs(d))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+//----------------------------------------------------------------------------
 std::vector<double>
 xdmf_utils::get_point_data_values(const fem::Function<double>& u)
 {
@@ -407,11 +470,11 @@ xdmf_utils::extract_local_entities(const mesh::Mesh& mesh, const int entity_dim,
   // communication
   xt::xtensor<std::int64_t, 2> entities_vertices(
       {entities.shape(0), num_vertices_per_entity});
-  for (std::size_t e = 0; e < entities_vertices.shape(0); ++e)
-  {
-    for (std::size_t i = 0; i < entities_vertices.shape(1); ++i)
-      entities_vertices(e, i) = entities(e, entity_vertex_dofs[i]);
-  }
+  io::cells::permute_cells(
+      xtl::span<const std::int64_t>(entities.data(), entities.size()),
+      entities.shape(1), entity_vertex_dofs,
+      xtl::span<std::int64_t>(entities_vertices.data(),
+                              entities_vertices.size()));
 
   // -------------------
   // 1. Send this rank's global "input" nodes indices to the
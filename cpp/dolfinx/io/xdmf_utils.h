@@ -34,7 +34,8 @@ class Function;
 namespace fem
 {
 class CoordinateElement;
-}
+class FunctionSpace;
+} // namespace fem
 
 namespace mesh
 {
@@ -60,8 +61,16 @@ std::vector<std::int64_t> get_dataset_shape(const pugi::xml_node& dataset_node);
 /// Get number of cells from an XML Topology node
 std::int64_t get_num_cells(const pugi::xml_node& topology_node);
 
+/// Check if the degrees-of-freedom of a function space are the values
+/// at the geometry nodes of its mesh, i.e. if the space is a (blocked)
+/// Lagrange space with the same degree-of-freedom layout as the mesh
+/// geometry
+bool has_geometry_dof_layout(const fem::FunctionSpace& V);
+
 /// Get point data values for linear or quadratic mesh into flattened 2D
-/// array
+/// array. If the function space has the degree-of-freedom layout of the
+/// mesh geometry (see has_geometry_dof_layout), the values are copied
+/// from the degrees-of-freedom of the Function, without interpolation.
 std::vector<double> get_point_data_values(const fem::Function<double>& u);
 std::vector<std::complex<double>>
 get_point_data_values(const fem::Function<std::complex<double>>& u);
@@ -104,7 +113,8 @@ void add_data_item(pugi::xml_node& xml_node, const hid_t h5_id,
                    const std::string h5_path, const T& x,
                    const std::int64_t offset,
                    const std::vector<std::int64_t> shape,
-                   const std::string number_type, const bool use_mpi_io)
+                   const std::string number_type,
+                   const HDF5Interface::WriteOptions& h5_options)
 {
   // Add DataItem node
   assert(xml_node);
@@ -159,7 +169,7 @@ void add_data_item(pugi::xml_node& xml_node, const hid_t h5_id,
 
     const std::array local_range{offset, offset + local_shape0};
     HDF5Interface::write_dataset(h5_id, h5_path, x.data(), local_range, shape,
-                                 use_mpi_io, false);
+                                 h5_options);
 
     // Add partitioning attribute to dataset
     // std::vector<std::size_t> partitions;
@@ -170,5 +180,78 @@ void add_data_item(pugi::xml_node& xml_node, const hid_t h5_id,
   }
 }
 
+/// Add a DataItem node for rows that are appended to an extendible
+/// HDF5 dataset, e.g. the values of a function at a time step of a time
+/// series, which are all stored in one dataset. The DataItem is a
+/// HyperSlab of the dataset, and the dimensions of the dataset are
+/// updated in the DataItems of the document that refer to it. Requires
+/// HDF5 storage.
+/// @param[in] xml_node The node to which the DataItem is added
+/// @param[in] h5_id The HDF5 file handle
+/// @param[in] h5_path The path of the dataset in the HDF5 file
+/// @param[in] x The data on this process (row-major storage)
+/// @param[in] offset The global row (in the appended rows) of the data
+/// on this process
+/// @param[in] shape The global shape of the appended rows
+/// @param[in] number_type The XDMF number type, or empty for the
+/// default type
+/// @param[in] h5_options Options for writing HDF5 datasets
+template <typename T>
+void append_data_item(pugi::xml_node& xml_node, const hid_t h5_id,
+                      const std::string h5_path, const T& x,
+                      const std::int64_t offset,
+                      const std::vector<std::int64_t> shape,
+                      const std::string number_type,
+                      const HDF5Interface::WriteOptions& h5_options)
+{
+  assert(xml_node);
+  assert(h5_id >= 0);
+  assert(shape.size() == 2);
+
+  // Append the data to the dataset
+  assert(x.size() % shape[1] == 0);
+  const std::int64_t local_shape0 = x.size() / shape[1];
+  const std::array local_range{offset, offset + local_shape0};
+  const std::int64_t row0 = HDF5Interface::append_dataset(
+      h5_id, h5_path, x.data(), local_range, shape, h5_options);
+
+  // Add HyperSlab DataItem node
+  pugi::xml_node slab_node = xml_node.append_child("DataItem");
+  assert(slab_node);
+  slab_node.append_attribute("ItemType") = "HyperSlab";
+  const std::string dims
+      = std::to_string(shape[0]) + " " + std::to_string(shape[1]);
+  slab_node.append_attribute("Dimensions") = dims.c_str();
+
+  // Add the selection (start, stride and count) of the appended rows
+  pugi::xml_node select_node = slab_node.append_child("DataItem");
+  assert(select_node);
+  select_node.append_attribute("Dimensions") = "3 2";
+  select_node.append_attribute("Format") = "XML";
+  const std::string select = std::to_string(row0) + " 0 1 1 " + dims;
+  select_node.append_child(pugi::node_pcdata).set_value(select.c_str());
+
+  // Add the dataset
+  pugi::xml_node data_item_node = slab_node.append_child("DataItem");
+  assert(data_item_node);
+  data_item_node.append_attribute("Dimensions") = "";
+  if (!number_type.empty())
+    data_item_node.append_attribute("NumberType") = number_type.c_str();
+  data_item_node.append_attribute("Format") = "HDF";
+  const std::string filename
+      = dolfinx::io::get_filename(HDF5Interface::get_filename(h5_id));
+  const std::string xdmf_path = filename + ":" + h5_path;
+  data_item_node.append_child(pugi::node_pcdata).set_value(xdmf_path.c_str());
+
+  // Update the dimensions of the dataset in all DataItems that refer to
+  // it
+  const std::string dims_total
+      = std::to_string(row0 + shape[0]) + " " + std::to_string(shape[1]);
+  const std::string xpath
+      = "//DataItem[@Format='HDF'][text()='" + xdmf_path + "']";
+  for (pugi::xpath_node node : xml_node.root().select_nodes(xpath.c_str()))
+    node.node().attribute("Dimensions") = dims_total.c_str();
+}
+
 } // namespace io::xdmf_utils
 } // namespace dolfinx
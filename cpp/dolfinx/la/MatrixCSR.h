@@ -0,0 +1,670 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include "SparsityPattern.h"
+#include "Vector.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/MPI.h>
+#include <dolfinx/common/utils.h>
+#include <dolfinx/graph/AdjacencyList.h>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <vector>
+#include <xtl/xspan.hpp>
+
+namespace dolfinx::la
+{
+
+/// Distributed sparse matrix in block compressed sparse row (BSR)
+/// format
+///
+/// The matrix is created from an assembled la::SparsityPattern. Each
+/// process stores the rows that it owns, split into a 'diagonal' block
+/// (columns owned by the process) and an 'off-diagonal' block (ghost
+/// columns), followed by the ghost rows that the process can add to.
+/// Ghost row contributions are sent to the row owner by
+/// MatrixCSR::finalize, using the neighbourhood communicator of the
+/// row IndexMap.
+///
+/// The matrix is stored by dense `bs0 x bs1` blocks, where `(bs0, bs1)`
+/// are the block sizes of the sparsity pattern, with one (local,
+/// process-wise) block column index per block. The values of a block
+/// are contiguous and row-major, and the values of all blocks are
+/// stored in one contiguous array ordered as [diagonal block |
+/// off-diagonal block | ghost rows]. Block columns are sorted within
+/// each block row; in the off-diagonal block they are sorted by global
+/// index.
+///
+/// The matrix-vector product MatrixCSR::mult overlaps the ghost update
+/// of the vector with the product of the diagonal block.
+
+template <typename T, class Allocator = std::allocator<T>>
+class MatrixCSR
+{
+public:
+  /// The value type
+  using value_type = T;
+
+  /// The allocator type
+  using allocator_type = Allocator;
+
+  /// Return a function with an interface for adding values to the
+  /// matrix A, using blocked local indices. The function has the
+  /// interface that is required by the finite element assemblers. The
+  /// function is a lambda, so that it can be inlined by the assemblers.
+  /// @tparam U The value type of the element matrices, e.g. `float` to
+  /// assemble a single-precision form into a double-precision matrix
+  /// @param[in] A The matrix to add values to
+  template <typename U = T>
+  static auto mat_add_values(MatrixCSR& A)
+  {
+    return [&A](std::int32_t m, const std::int32_t* rows, std::int32_t n,
+                const std::int32_t* cols, const U* vals) -> int {
+      const std::size_t size = m * n * A._bs[0] * A._bs[1];
+      A.add(xtl::span<const U>(vals, size),
+            xtl::span<const std::int32_t>(rows, m),
+            xtl::span<const std::int32_t>(cols, n));
+      return 0;
+    };
+  }
+
+  /// Create a distributed matrix
+  /// @param[in] p The sparsity pattern. It must have been assembled.
+  /// @param[in] alloc The memory allocator for the values
+  /// @note Collective MPI operation
+  MatrixCSR(const SparsityPattern& p, const Allocator& alloc = Allocator())
+      : _index_maps({p.index_map(0), p.index_map(1)}),
+        _bs({p.block_size(0), p.block_size(1)}),
+        _col_indices(p.column_indices()), _data(alloc)
+  {
+    const int bsize = _bs[0] * _bs[1];
+    const std::int32_t num_ghosts0 = _index_maps[0]->num_ghosts();
+    const std::array local_range0 = _index_maps[0]->local_range();
+    const std::array local_range1 = _index_maps[1]->local_range();
+    _num_owned_rows = _index_maps[0]->size_local();
+    _local_size1 = _index_maps[1]->size_local();
+
+    // Append the block columns of a pattern to the column indices
+    auto append = [&](const graph::AdjacencyList<std::int32_t>& pattern,
+                      std::vector<std::int32_t>& row_ptr)
+    {
+      row_ptr.resize(pattern.num_nodes() + 1);
+      row_ptr[0] = _cols.size();
+      for (std::int32_t r = 0; r < pattern.num_nodes(); ++r)
+      {
+        auto links = pattern.links(r);
+        _cols.insert(_cols.end(), links.begin(), links.end());
+        row_ptr[r + 1] = _cols.size();
+      }
+    };
+
+    _cols.reserve(p.diagonal_pattern().array().size()
+                  + p.off_diagonal_pattern().array().size()
+                  + p.ghost_row_pattern().array().size());
+    append(p.diagonal_pattern(), _row_ptr);
+    append(p.off_diagonal_pattern(), _row_ptr_off);
+    append(p.ghost_row_pattern(), _row_ptr_ghost);
+    _data.resize(bsize * _cols.size(), 0);
+
+    // Sort off-diagonal columns by global index
+    for (std::int32_t r = 0; r < _num_owned_rows; ++r)
+    {
+      std::sort(std::next(_cols.begin(), _row_ptr_off[r]),
+                std::next(_cols.begin(), _row_ptr_off[r + 1]),
+                [&](auto c0, auto c1)
+                { return _col_indices[c0] < _col_indices[c1]; });
+    }
+
+    // Get ghost->owner communicator for rows
+    MPI_Comm comm = _index_maps[0]->comm(common::IndexMap::Direction::reverse);
+    const auto [src_ranks, dest_ranks] = dolfinx::MPI::neighbors(comm);
+
+    // Find neighbourhood rank of the owner of each ghost row
+    const std::vector<int> ghost_owners0 = _index_maps[0]->ghost_owner_rank();
+    std::vector<int> ghost_to_neighbour(num_ghosts0);
+    for (std::int32_t i = 0; i < num_ghosts0; ++i)
+    {
+      auto it = std::find(dest_ranks.begin(), dest_ranks.end(),
+                          ghost_owners0[i]);
+      assert(it != dest_ranks.end());
+      ghost_to_neighbour[i] = std::distance(dest_ranks.begin(), it);
+    }
+
+    // Compute number of ghost row blocks to send to each neighbour
+    std::vector<std::int32_t> block_disp(dest_ranks.size() + 1, 0);
+    for (std::int32_t i = 0; i < num_ghosts0; ++i)
+    {
+      block_disp[ghost_to_neighbour[i] + 1]
+          += _row_ptr_ghost[i + 1] - _row_ptr_ghost[i];
+    }
+    std::partial_sum(block_disp.begin(), block_disp.end(),
+                     block_disp.begin());
+
+    // Pack (global block row, global block column) pairs for each
+    // ghost row block, and store the position of each block in the
+    // send buffer
+    std::vector<std::int64_t> ghost_index_data(2 * block_disp.back());
+    {
+      std::vector<std::int32_t> insert_pos(block_disp.begin(),
+                                           std::prev(block_disp.end()));
+      const std::vector<std::int64_t>& ghosts0 = _index_maps[0]->ghosts();
+      _ghost_send_pos.reserve(block_disp.back());
+      for (std::int32_t i = 0; i < num_ghosts0; ++i)
+      {
+        const int neighbour = ghost_to_neighbour[i];
+        for (std::int32_t j = _row_ptr_ghost[i]; j < _row_ptr_ghost[i + 1];
+             ++j)
+        {
+          const std::int32_t pos = insert_pos[neighbour]++;
+          _ghost_send_pos.push_back(pos);
+          ghost_index_data[2 * pos] = ghosts0[i];
+          ghost_index_data[2 * pos + 1] = _col_indices[_cols[j]];
+        }
+      }
+    }
+
+    // Sizes and displacements of the values to send
+    _send_disp.resize(block_disp.size());
+    std::transform(block_disp.begin(), block_disp.end(), _send_disp.begin(),
+                   [bsize](auto d) { return bsize * d; });
+    _send_sizes.resize(dest_ranks.size());
+    std::adjacent_difference(std::next(_send_disp.begin()), _send_disp.end(),
+                             _send_sizes.begin());
+
+    // Send ghost row indices to the row owners
+    std::vector<std::int32_t> index_disp(block_disp.size());
+    std::transform(block_disp.begin(), block_disp.end(), index_disp.begin(),
+                   [](auto d) { return 2 * d; });
+    const graph::AdjacencyList<std::int64_t> ghost_index_in
+        = dolfinx::MPI::neighbor_all_to_all(
+            comm, graph::AdjacencyList<std::int64_t>(
+                      std::move(ghost_index_data), std::move(index_disp)));
+
+    // Store receive sizes and displacements for the values
+    const std::vector<std::int32_t>& recv_offsets = ghost_index_in.offsets();
+    _recv_disp.resize(recv_offsets.size());
+    std::transform(recv_offsets.begin(), recv_offsets.end(),
+                   _recv_disp.begin(),
+                   [bsize](auto d) { return bsize * (d / 2); });
+    _recv_sizes.resize(src_ranks.size());
+    std::adjacent_difference(std::next(_recv_disp.begin()), _recv_disp.end(),
+                             _recv_sizes.begin());
+
+    // Global-to-local map for ghost columns
+    std::map<std::int64_t, std::int32_t> global_to_local;
+    for (std::size_t i = _local_size1; i < _col_indices.size(); ++i)
+      global_to_local.insert({_col_indices[i], i});
+
+    // Compute position in the owned rows of each received block
+    const std::vector<std::int64_t>& ghost_index = ghost_index_in.array();
+    _unpack_pos.reserve(ghost_index.size() / 2);
+    for (std::size_t i = 0; i < ghost_index.size(); i += 2)
+    {
+      const std::int32_t row = ghost_index[i] - local_range0[0];
+      assert(row >= 0 and row < _num_owned_rows);
+
+      const std::int64_t col = ghost_index[i + 1];
+      std::int32_t col_local;
+      if (col >= local_range1[0] and col < local_range1[1])
+        col_local = col - local_range1[0];
+      else
+      {
+        auto it = global_to_local.find(col);
+        assert(it != global_to_local.end());
+        col_local = it->second;
+      }
+
+      const std::int32_t pos = find_position(row, col_local);
+      if (pos < 0)
+        throw std::runtime_error("Ghost row entry is not in the sparsity "
+                                 "pattern of the owning process.");
+      _unpack_pos.push_back(pos);
+    }
+
+    _ghost_value_send.resize(bsize * _ghost_send_pos.size());
+    _ghost_value_recv.resize(bsize * _unpack_pos.size());
+
+    // Position of the ghost columns in vectors with the column index
+    // map. Ghost columns that were added by the sparsity pattern are
+    // not in the column index map, in which case the products use a
+    // vector with all local columns as ghosts.
+    const std::int32_t num_ghost_cols = _col_indices.size() - _local_size1;
+    _ghost_col_pos.resize(num_ghost_cols);
+    _index_maps[1]->global_to_local(
+        xtl::span<const std::int64_t>(_col_indices.data() + _local_size1,
+                                      num_ghost_cols),
+        _ghost_col_pos);
+    int missing = std::any_of(_ghost_col_pos.begin(), _ghost_col_pos.end(),
+                              [](auto pos) { return pos < 0; });
+    MPI_Allreduce(MPI_IN_PLACE, &missing, 1, MPI_INT, MPI_LOR, p.mpi_comm());
+    if (missing)
+    {
+      std::iota(_ghost_col_pos.begin(), _ghost_col_pos.end(), _local_size1);
+
+      // Owner of each ghost column, from the ranges of all processes
+      MPI_Comm comm = p.mpi_comm();
+      const int size = dolfinx::MPI::size(comm);
+      std::vector<std::int64_t> ranges(size + 1);
+      MPI_Allgather(&local_range1[0], 1, MPI_INT64_T, ranges.data(), 1,
+                    MPI_INT64_T, comm);
+      ranges[size] = _index_maps[1]->size_global();
+      std::vector<int> owners(num_ghost_cols);
+      for (std::int32_t i = 0; i < num_ghost_cols; ++i)
+      {
+        auto it = std::upper_bound(ranges.begin(), ranges.end(),
+                                   _col_indices[_local_size1 + i]);
+        owners[i] = std::distance(ranges.begin(), it) - 1;
+      }
+
+      auto map = std::make_shared<common::IndexMap>(
+          comm, _local_size1,
+          dolfinx::MPI::compute_graph_edges(
+              comm, std::set<int>(owners.begin(), owners.end())),
+          xtl::span<const std::int64_t>(_col_indices.data() + _local_size1,
+                                        num_ghost_cols),
+          owners);
+      _x_cols = std::make_shared<Vector<T, Allocator>>(map, _bs[1], alloc);
+    }
+  }
+
+  /// Copy constructor
+  MatrixCSR(const MatrixCSR& A) = default;
+
+  /// Move constructor
+  MatrixCSR(MatrixCSR&& A) = default;
+
+  /// Destructor
+  ~MatrixCSR() = default;
+
+  /// Copy assignment
+  MatrixCSR& operator=(const MatrixCSR& A) = default;
+
+  /// Move assignment
+  MatrixCSR& operator=(MatrixCSR&& A) = default;
+
+  /// Set all entries (including ghost rows) to a value
+  /// @param[in] x The value to set all entries to
+  void set(T x) { std::fill(_data.begin(), _data.end(), x); }
+
+  /// Add a dense block of values to the matrix. The block must be in
+  /// the sparsity pattern.
+  /// @param[in] x The `m` by `n` dense block of values (row-major) to
+  /// add, where `m = bs0 * rows.size()` and `n = bs1 * cols.size()`
+  /// @param[in] rows The block row indices of `x`, using local indices.
+  /// Rows may be owned or ghost rows.
+  /// @param[in] cols The block column indices of `x`, using local
+  /// indices
+  /// @note The values may have a different type than the matrix, in
+  /// which case they are converted to `T` before they are added
+  template <typename U>
+  void add(const xtl::span<const U>& x,
+           const xtl::span<const std::int32_t>& rows,
+           const xtl::span<const std::int32_t>& cols)
+  {
+    const int bs0 = _bs[0];
+    const int bs1 = _bs[1];
+    const std::size_t ldx = bs1 * cols.size();
+    assert(x.size() == bs0 * rows.size() * ldx);
+    for (std::size_t r = 0; r < rows.size(); ++r)
+    {
+      // Find the position of each block in the row, and add the values
+      for (std::size_t c = 0; c < cols.size(); ++c)
+      {
+        const std::int32_t pos = find_position(rows[r], cols[c]);
+        if (pos < 0)
+          throw std::runtime_error("Entry is not in the sparsity pattern.");
+        T* block = _data.data() + bs0 * bs1 * pos;
+        const U* xb = x.data() + bs0 * r * ldx + bs1 * c;
+        for (int k0 = 0; k0 < bs0; ++k0)
+          for (int k1 = 0; k1 < bs1; ++k1)
+            block[k0 * bs1 + k1] += static_cast<T>(xb[k0 * ldx + k1]);
+      }
+    }
+  }
+
+  /// Compute the positions in MatrixCSR::values of the entries of a
+  /// dense block, in the same (row-major) order as the values passed to
+  /// MatrixCSR::add. The block must be in the sparsity pattern.
+  /// @param[in] rows The block row indices, using local indices
+  /// @param[in] cols The block column indices, using local indices
+  /// @param[in,out] pos The positions, which are appended to `pos`
+  void positions(const xtl::span<const std::int32_t>& rows,
+                 const xtl::span<const std::int32_t>& cols,
+                 std::vector<std::int32_t>& pos) const
+  {
+    const int bs0 = _bs[0];
+    const int bs1 = _bs[1];
+    std::vector<std::int32_t> blocks(cols.size());
+    for (std::size_t r = 0; r < rows.size(); ++r)
+    {
+      for (std::size_t c = 0; c < cols.size(); ++c)
+      {
+        blocks[c] = find_position(rows[r], cols[c]);
+        if (blocks[c] < 0)
+          throw std::runtime_error("Entry is not in the sparsity pattern.");
+      }
+
+      for (int k0 = 0; k0 < bs0; ++k0)
+        for (std::int32_t b : blocks)
+          for (int k1 = 0; k1 < bs1; ++k1)
+            pos.push_back(bs0 * bs1 * b + k0 * bs1 + k1);
+    }
+  }
+
+  /// Begin transfer of ghost row contributions to the row owners.
+  /// @note Collective MPI operation
+  void finalize_begin()
+  {
+    const int bsize = _bs[0] * _bs[1];
+    const T* ghost_data = _data.data() + bsize * _row_ptr_ghost.front();
+    for (std::size_t j = 0; j < _ghost_send_pos.size(); ++j)
+    {
+      std::copy_n(ghost_data + bsize * j, bsize,
+                  std::next(_ghost_value_send.begin(),
+                            bsize * _ghost_send_pos[j]));
+    }
+
+    MPI_Ineighbor_alltoallv(
+        _ghost_value_send.data(), _send_sizes.data(), _send_disp.data(),
+        dolfinx::MPI::mpi_type<T>(), _ghost_value_recv.data(),
+        _recv_sizes.data(), _recv_disp.data(), dolfinx::MPI::mpi_type<T>(),
+        _index_maps[0]->comm(common::IndexMap::Direction::reverse),
+        &_request);
+  }
+
+  /// End transfer of ghost row contributions. The received values are
+  /// added to the owned rows, and the ghost rows are zeroed.
+  /// @note Collective MPI operation
+  void finalize_end()
+  {
+    MPI_Wait(&_request, MPI_STATUS_IGNORE);
+    const int bsize = _bs[0] * _bs[1];
+    for (std::size_t i = 0; i < _unpack_pos.size(); ++i)
+    {
+      T* block = _data.data() + bsize * _unpack_pos[i];
+      const T* recv = _ghost_value_recv.data() + bsize * i;
+      for (int k = 0; k < bsize; ++k)
+        block[k] += recv[k];
+    }
+    std::fill(std::next(_data.begin(), bsize * _row_ptr_ghost.front()),
+              _data.end(), 0);
+  }
+
+  /// Send ghost row contributions to the row owners. Equivalent to
+  /// calling MatrixCSR::finalize_begin and MatrixCSR::finalize_end.
+  /// @note Collective MPI operation
+  void finalize()
+  {
+    finalize_begin();
+    finalize_end();
+  }
+
+  /// Compute the squared Frobenius norm of the owned rows
+  /// @note Collective MPI operation
+  double squared_norm() const
+  {
+    const std::int32_t num_owned = num_nonzeros();
+    const double result = std::transform_reduce(
+        _data.begin(), std::next(_data.begin(), num_owned), 0.0,
+        std::plus<double>(), [](T val) { return std::norm(val); });
+    double norm2;
+    MPI_Allreduce(&result, &norm2, 1, MPI_DOUBLE, MPI_SUM,
+                  _index_maps[0]->comm(common::IndexMap::Direction::forward));
+    return norm2;
+  }
+
+  /// Compute the product y = A x for the owned rows. The ghost update
+  /// of x is started, the product of the diagonal block is computed
+  /// while the ghost values are communicated, and the product of the
+  /// off-diagonal block is added when the update is complete.
+  /// @note Collective MPI operation
+  /// @param[in,out] x The vector to multiply, with the layout of the
+  /// column index map and block size of the matrix. The ghost entries
+  /// are updated.
+  /// @param[in,out] y The product, with the layout of the row index
+  /// map and block size of the matrix. The ghost entries are not set.
+  /// Must not be @p x.
+  /// @param[in] num_threads The number of threads that compute the
+  /// products of the rows
+  void mult(Vector<T, Allocator>& x, Vector<T, Allocator>& y,
+            int num_threads = 1)
+  {
+    if (x.map()->size_local() != _local_size1 or x.bs() != _bs[1])
+      throw std::runtime_error("Vector does not match the matrix columns.");
+    if (y.map()->size_local() != _num_owned_rows or y.bs() != _bs[0])
+      throw std::runtime_error("Vector does not match the matrix rows.");
+
+    Vector<T, Allocator>* xc = &x;
+    if (_x_cols)
+    {
+      std::copy_n(x.array().begin(), _bs[1] * _local_size1,
+                  _x_cols->mutable_array().begin());
+      xc = _x_cols.get();
+    }
+
+    const T* _x = xc->array().data();
+    T* _y = y.mutable_array().data();
+    xc->scatter_fwd_begin();
+    mult_block<false>(_x, _y, num_threads);
+    xc->scatter_fwd_end();
+    mult_block<true>(_x, _y, num_threads);
+  }
+
+  /// Copy the owned rows into a dense row-major array. The number of
+  /// columns is the number of local (owned and ghost) columns.
+  /// @return Dense copy of the owned rows
+  std::vector<T> to_dense() const
+  {
+    const int bs0 = _bs[0];
+    const int bs1 = _bs[1];
+    const std::size_t ncols = bs1 * _col_indices.size();
+    std::vector<T> A(bs0 * _num_owned_rows * ncols, 0);
+    auto copy_row = [&](std::int32_t r, std::int32_t j0, std::int32_t j1)
+    {
+      for (std::int32_t j = j0; j < j1; ++j)
+      {
+        const T* block = _data.data() + bs0 * bs1 * j;
+        for (int k0 = 0; k0 < bs0; ++k0)
+        {
+          std::copy_n(block + k0 * bs1, bs1,
+                      std::next(A.begin(), (bs0 * r + k0) * ncols
+                                               + bs1 * _cols[j]));
+        }
+      }
+    };
+    for (std::int32_t r = 0; r < _num_owned_rows; ++r)
+    {
+      copy_row(r, _row_ptr[r], _row_ptr[r + 1]);
+      copy_row(r, _row_ptr_off[r], _row_ptr_off[r + 1]);
+    }
+    return A;
+  }
+
+  /// Index map for the rows (dim = 0) or columns (dim = 1).
+  /// @note The column index map does not include the ghost columns
+  /// that were added when the sparsity pattern was assembled. See
+  /// MatrixCSR::column_indices.
+  std::shared_ptr<const common::IndexMap> index_map(int dim) const
+  {
+    return _index_maps.at(dim);
+  }
+
+  /// Block sizes of the rows and columns
+  std::array<int, 2> block_size() const { return _bs; }
+
+  /// Global (block) indices of the local columns, including the ghost
+  /// columns
+  const std::vector<std::int64_t>& column_indices() const
+  {
+    return _col_indices;
+  }
+
+  /// Number of non-zeros in the owned rows
+  std::int32_t num_nonzeros() const
+  {
+    return _bs[0] * _bs[1] * _row_ptr_off.back();
+  }
+
+  /// Matrix values, see the class documentation for the layout
+  xtl::span<T> values() { return _data; }
+
+  /// Matrix values, see the class documentation for the layout
+  xtl::span<const T> values() const { return _data; }
+
+  /// Local block column index of every block. The values of block `j`
+  /// are `values()[bs0 * bs1 * j + k0 * bs1 + k1]`, for `0 <= k0 <
+  /// bs0`, `0 <= k1 < bs1`.
+  const std::vector<std::int32_t>& cols() const { return _cols; }
+
+  /// Offsets into MatrixCSR::cols for each owned block row of the
+  /// diagonal block
+  const std::vector<std::int32_t>& row_ptr() const { return _row_ptr; }
+
+  /// Offsets into MatrixCSR::cols for each owned block row of the
+  /// off-diagonal block
+  const std::vector<std::int32_t>& off_diagonal_row_ptr() const
+  {
+    return _row_ptr_off;
+  }
+
+  /// Offsets into MatrixCSR::cols for each ghost block row
+  const std::vector<std::int32_t>& ghost_row_ptr() const
+  {
+    return _row_ptr_ghost;
+  }
+
+private:
+  // Compute y = A_d x for the diagonal block (off_diagonal = false) or
+  // y += A_o x for the off-diagonal block, for the owned rows. The
+  // block sizes are compile-time constants for common sizes, so that
+  // the loops over the blocks are unrolled.
+  template <bool off_diagonal>
+  void mult_block(const T* x, T* y, int num_threads) const
+  {
+    const std::vector<std::int32_t>& row_ptr
+        = off_diagonal ? _row_ptr_off : _row_ptr;
+    common::dispatch_block_size(
+        _bs[0],
+        [&](auto bs0)
+        {
+          common::dispatch_block_size(
+              _bs[1],
+              [&](auto bs1)
+              {
+                common::for_each_part(
+                    _num_owned_rows, num_threads,
+                    [&](std::int64_t r0, std::int64_t r1, int)
+                    {
+                      for (std::int64_t r = r0; r < r1; ++r)
+                      {
+                        T* yr = y + bs0 * r;
+                        if constexpr (!off_diagonal)
+                          std::fill_n(yr, int(bs0), T(0));
+                        for (std::int32_t j = row_ptr[r]; j < row_ptr[r + 1];
+                             ++j)
+                        {
+                          std::int32_t c = _cols[j];
+                          if constexpr (off_diagonal)
+                            c = _ghost_col_pos[c - _local_size1];
+                          const T* A = _data.data() + bs0 * bs1 * j;
+                          const T* xc = x + bs1 * c;
+                          for (int k0 = 0; k0 < bs0; ++k0)
+                            for (int k1 = 0; k1 < bs1; ++k1)
+                              yr[k0] += A[k0 * bs1 + k1] * xc[k1];
+                        }
+                      }
+                    });
+              });
+        });
+  }
+
+  // Block position in _cols of the block (row, col), using local block
+  // indices. Returns -1 if the block is not in the sparsity pattern.
+  std::int32_t find_position(std::int32_t row, std::int32_t col) const
+  {
+    std::vector<std::int32_t>::const_iterator it, it1;
+    if (row >= _num_owned_rows)
+    {
+      const std::int32_t r = row - _num_owned_rows;
+      auto it0 = std::next(_cols.begin(), _row_ptr_ghost[r]);
+      it1 = std::next(_cols.begin(), _row_ptr_ghost[r + 1]);
+      it = std::lower_bound(it0, it1, col);
+    }
+    else if (col < _local_size1)
+    {
+      auto it0 = std::next(_cols.begin(), _row_ptr[row]);
+      it1 = std::next(_cols.begin(), _row_ptr[row + 1]);
+      it = std::lower_bound(it0, it1, col);
+    }
+    else
+    {
+      auto it0 = std::next(_cols.begin(), _row_ptr_off[row]);
+      it1 = std::next(_cols.begin(), _row_ptr_off[row + 1]);
+      it = std::lower_bound(it0, it1, _col_indices[col],
+                            [&](std::int32_t c, std::int64_t gc)
+                            { return _col_indices[c] < gc; });
+    }
+
+    if (it == it1 or *it != col)
+      return -1;
+    else
+      return std::distance(_cols.begin(), it);
+  }
+
+  // Maps for the distribution of the rows and columns
+  std::array<std::shared_ptr<const common::IndexMap>, 2> _index_maps;
+
+  // Block sizes
+  std::array<int, 2> _bs;
+
+  // Number of owned block rows and owned block columns
+  std::int32_t _num_owned_rows, _local_size1;
+
+  // Global (block) column indices, including ghost columns
+  std::vector<std::int64_t> _col_indices;
+
+  // Matrix values (by block) and local block column indices
+  std::vector<T, Allocator> _data;
+  std::vector<std::int32_t> _cols;
+
+  // Row offsets into _data/_cols for the diagonal block, off-diagonal
+  // block and the ghost rows
+  std::vector<std::int32_t> _row_ptr, _row_ptr_off, _row_ptr_ghost;
+
+  // Block position in the send buffer of each ghost row block
+  std::vector<std::int32_t> _ghost_send_pos;
+
+  // Block position in _cols of each received ghost row block
+  std::vector<std::int32_t> _unpack_pos;
+
+  // Send/receive sizes and displacements for the ghost row values
+  std::vector<int> _send_sizes, _send_disp, _recv_sizes, _recv_disp;
+
+  // Buffers for the ghost row values
+  std::vector<T> _ghost_value_send, _ghost_value_recv;
+
+  // MPI request for non-blocking finalize
+  MPI_Request _request = MPI_REQUEST_NULL;
+
+  // Local (block) index of each ghost column in the vectors that are
+  // multiplied by the matrix
+  std::vector<std::int32_t> _ghost_col_pos;
+
+  // Vector with all local columns as ghosts, used by MatrixCSR::mult if
+  // the column index map does not include all ghost columns. Copies of
+  // the matrix share the vector.
+  std::shared_ptr<Vector<T, Allocator>> _x_cols;
+};
+
+} // namespace dolfinx::la
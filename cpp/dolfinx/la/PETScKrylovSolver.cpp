@@ -37,7 +37,10 @@ PETScKrylovSolver::PETScKrylovSolver(KSP ksp, bool inc_ref_count) : _ksp(ksp)
 }
 //-----------------------------------------------------------------------------
 PETScKrylovSolver::PETScKrylovSolver(PETScKrylovSolver&& solver)
-    : _ksp(std::exchange(solver._ksp, nullptr))
+    : _ksp(std::exchange(solver._ksp, nullptr)),
+      _reuse(std::move(solver._reuse)),
+      _num_reuse_solves(solver._num_reuse_solves),
+      _reuse_iterations(solver._reuse_iterations), _rebuild(solver._rebuild)
 {
   // Do nothing
 }
@@ -51,6 +54,10 @@ PETScKrylovSolver::~PETScKrylovSolver()
 PETScKrylovSolver& PETScKrylovSolver::operator=(PETScKrylovSolver&& solver)
 {
   std::swap(_ksp, solver._ksp);
+  std::swap(_reuse, solver._reuse);
+  std::swap(_num_reuse_solves, solver._num_reuse_solves);
+  std::swap(_reuse_iterations, solver._reuse_iterations);
+  std::swap(_rebuild, solver._rebuild);
   return *this;
 }
 //-----------------------------------------------------------------------------
@@ -98,6 +105,7 @@ int PETScKrylovSolver::solve(Vec x, const Vec b, bool transpose) const
   LOG(INFO) << "PETSc Krylov solver starting to solve system.";
 
   // Solve system
+  reuse_begin();
   if (!transpose)
   {
     ierr = KSPSolve(_ksp, b, x);
@@ -135,6 +143,7 @@ int PETScKrylovSolver::solve(Vec x, const Vec b, bool transpose) const
   ierr = KSPGetConvergedReason(_ksp, &reason);
   if (ierr != 0)
     petsc_error(ierr, __FILE__, "KSPGetConvergedReason");
+  reuse_end(num_iterations, reason >= 0);
   if (reason < 0)
   {
     /*
@@ -171,6 +180,34 @@ int PETScKrylovSolver::solve(Vec x, const Vec b, bool transpose) const
   return num_iterations;
 }
 //-----------------------------------------------------------------------------
+int PETScKrylovSolver::solve(Mat X, const Mat B) const
+{
+  common::Timer timer("PETSc Krylov solver (multiple right-hand sides)");
+  assert(X);
+  assert(B);
+
+  LOG(INFO) << "PETSc Krylov solver starting to solve system with multiple "
+               "right-hand sides.";
+
+  reuse_begin();
+  PetscErrorCode ierr = KSPMatSolve(_ksp, B, X);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "KSPMatSolve");
+
+  PetscInt num_iterations = 0;
+  ierr = KSPGetIterationNumber(_ksp, &num_iterations);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "KSPGetIterationNumber");
+
+  KSPConvergedReason reason;
+  ierr = KSPGetConvergedReason(_ksp, &reason);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "KSPGetConvergedReason");
+  reuse_end(num_iterations, reason >= 0);
+
+  return num_iterations;
+}
+//-----------------------------------------------------------------------------
 void PETScKrylovSolver::set_dm(DM dm)
 {
   assert(_ksp);
@@ -215,3 +252,82 @@ void PETScKrylovSolver::set_from_options() const
 //-----------------------------------------------------------------------------
 KSP PETScKrylovSolver::ksp() const { return _ksp; }
 //-----------------------------------------------------------------------------
+void PETScKrylovSolver::set_preconditioner_reuse(
+    const PreconditionerReuse& policy)
+{
+  _reuse = policy;
+  _rebuild = true;
+}
+//-----------------------------------------------------------------------------
+const std::optional<PreconditionerReuse>&
+PETScKrylovSolver::preconditioner_reuse() const
+{
+  return _reuse;
+}
+//-----------------------------------------------------------------------------
+void PETScKrylovSolver::rebuild_preconditioner() { _rebuild = true; }
+//-----------------------------------------------------------------------------
+void PETScKrylovSolver::set_up()
+{
+  assert(_ksp);
+  reuse_begin();
+  PetscErrorCode ierr = KSPSetUp(_ksp);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "KSPSetUp");
+}
+//-----------------------------------------------------------------------------
+void PETScKrylovSolver::reuse_begin() const
+{
+  if (!_reuse)
+    return;
+
+  assert(_ksp);
+  const bool rebuild = _rebuild
+                       or (_reuse->max_solves > 0
+                           and _num_reuse_solves >= _reuse->max_solves);
+  PetscErrorCode ierr
+      = KSPSetReusePreconditioner(_ksp, rebuild ? PETSC_FALSE : PETSC_TRUE);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "KSPSetReusePreconditioner");
+
+  if (rebuild)
+  {
+    LOG(INFO) << "Rebuilding preconditioner after " << _num_reuse_solves
+              << " solves.";
+    if (_reuse->keep_symbolic)
+    {
+      // The methods have no effect for other preconditioner types
+      PC pc;
+      KSPGetPC(_ksp, &pc);
+      ierr = PCGAMGSetReuseInterpolation(pc, PETSC_TRUE);
+      if (ierr != 0)
+        petsc_error(ierr, __FILE__, "PCGAMGSetReuseInterpolation");
+      ierr = PCFactorSetReuseOrdering(pc, PETSC_TRUE);
+      if (ierr != 0)
+        petsc_error(ierr, __FILE__, "PCFactorSetReuseOrdering");
+    }
+    _num_reuse_solves = 0;
+    _rebuild = false;
+  }
+}
+//-----------------------------------------------------------------------------
+void PETScKrylovSolver::reuse_end(int num_iterations, bool converged) const
+{
+  if (!_reuse)
+    return;
+
+  // A stale preconditioner is rebuilt if the solver did not converge or
+  // the number of iterations has grown too much
+  if (_num_reuse_solves == 0)
+    _reuse_iterations = num_iterations;
+  else if (!converged)
+    _rebuild = true;
+  else if (_reuse->max_iteration_growth > 0.0
+           and num_iterations > (1.0 + _reuse->max_iteration_growth)
+                                    * _reuse_iterations)
+  {
+    _rebuild = true;
+  }
+  ++_num_reuse_solves;
+}
+//-----------------------------------------------------------------------------
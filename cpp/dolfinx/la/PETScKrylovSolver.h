@@ -10,6 +10,7 @@
 #include <petscksp.h>
 #include <petscmat.h>
 #include <petscvec.h>
+#include <optional>
 #include <string>
 
 namespace dolfinx::fem
@@ -20,6 +21,31 @@ class PETScDMCollection;
 namespace dolfinx::la
 {
 
+/// Policy for reusing the preconditioner of a la::PETScKrylovSolver
+/// when the operators change between solves, e.g. in nonlinear and
+/// transient problems. The preconditioner is rebuilt at the first
+/// solve, and later when one of the criteria is met. In between, the
+/// preconditioner built for an earlier operator is applied.
+struct PreconditionerReuse
+{
+  /// Rebuild the preconditioner after this number of solves with the
+  /// same preconditioner. If <= 0 the number of solves is not limited.
+  int max_solves = 0;
+
+  /// Rebuild the preconditioner at the next solve if the number of
+  /// iterations grows by more than this fraction relative to the first
+  /// solve with the current preconditioner, e.g. 0.5 for 50%. If <= 0
+  /// the number of iterations is not checked.
+  double max_iteration_growth = 0.0;
+
+  /// When rebuilding, keep the symbolic part of the setup and only
+  /// update the numeric values: the interpolation operators of
+  /// algebraic multigrid (PCGAMG) and the ordering of factorisations
+  /// are reused. The symbolic factorisation of LU/ILU is reused by
+  /// PETSc if the nonzero pattern of the operator is unchanged.
+  bool keep_symbolic = false;
+};
+
 /// This class implements Krylov methods for linear systems of the form
 /// Ax = b. It is a wrapper for the Krylov solvers of PETSc.
 
@@ -60,6 +86,16 @@ public:
   /// = b if transpose is true)
   int solve(Vec x, const Vec b, bool transpose = false) const;
 
+  /// Solve linear systems AX = B for several right-hand sides, stored
+  /// as the columns of a dense matrix B, using the block Krylov methods
+  /// of PETSc (KSPMatSolve). Methods without a block variant solve for
+  /// each column in turn.
+  /// @param[out] X Dense matrix for the solutions, with the same
+  /// layout as B
+  /// @param[in] B Dense matrix (MATDENSE) of the right-hand sides
+  /// @return The number of iterations
+  int solve(Mat X, const Mat B) const;
+
   /// Sets the prefix used by PETSc when searching the PETSc options
   /// database
   void set_options_prefix(std::string options_prefix);
@@ -74,6 +110,26 @@ public:
   /// Return PETSc KSP pointer
   KSP ksp() const;
 
+  /// Set the policy for reusing the preconditioner between solves. By
+  /// default no policy is set, and PETSc rebuilds the preconditioner
+  /// whenever the operators change (unless reuse is requested through
+  /// the PETSc options).
+  /// @param[in] policy The reuse policy
+  void set_preconditioner_reuse(const PreconditionerReuse& policy);
+
+  /// Return the preconditioner reuse policy, if one has been set
+  const std::optional<PreconditionerReuse>& preconditioner_reuse() const;
+
+  /// Rebuild the preconditioner at the next solve, regardless of the
+  /// reuse policy
+  void rebuild_preconditioner();
+
+  /// Set up the solver and the preconditioner for the current operators,
+  /// following the preconditioner reuse policy. The setup is otherwise
+  /// done by the next solve, and calling it first allows the time of
+  /// the preconditioner setup to be measured separately.
+  void set_up();
+
   /// Set the DM
   void set_dm(DM dm);
 
@@ -81,7 +137,24 @@ public:
   void set_dm_active(bool val);
 
 private:
+  // Set whether the preconditioner is rebuilt in the next solve,
+  // following the reuse policy
+  void reuse_begin() const;
+
+  // Update the reuse state after a solve
+  void reuse_end(int num_iterations, bool converged) const;
+
   // PETSc solver pointer
   KSP _ksp;
+
+  // Preconditioner reuse policy
+  std::optional<PreconditionerReuse> _reuse;
+
+  // Number of solves with the current preconditioner, the number of
+  // iterations of the first of these solves and whether the
+  // preconditioner should be rebuilt at the next solve
+  mutable int _num_reuse_solves = 0;
+  mutable int _reuse_iterations = 0;
+  mutable bool _rebuild = true;
 };
 } // namespace dolfinx::la
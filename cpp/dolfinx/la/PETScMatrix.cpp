@@ -6,6 +6,7 @@
 // SPDX-License-Identifier:    LGPL-3.0-or-later
 
 #include "PETScMatrix.h"
+#include "MatrixCSR.h"
 #include "PETScVector.h"
 #include "VectorSpaceBasis.h"
 #include "utils.h"
@@ -14,6 +15,10 @@
 #include <dolfinx/common/Timer.h>
 #include <dolfinx/common/log.h>
 #include <dolfinx/la/SparsityPattern.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
 #include <iostream>
 #include <sstream>
 
@@ -62,37 +67,134 @@ Mat la::create_petsc_matrix(
   if (ierr != 0)
     petsc_error(ierr, __FILE__, "MatSetFromOptions");
 
+  // Symmetric block matrices (SBAIJ) store the upper triangle only
+  MatType mat_type;
+  MatGetType(A, &mat_type);
+  const bool symmetric = std::strstr(mat_type, MATSBAIJ) != nullptr;
+  if (symmetric and bs[0] != bs[1])
+  {
+    throw std::runtime_error(
+        "Symmetric matrix requires equal row and column block sizes.");
+  }
+
   // Find a common block size across rows/columns
   const int _bs = (bs[0] == bs[1] ? bs[0] : 1);
 
-  // Build data to initialise sparsity pattern (modify for block size)
-  std::vector<PetscInt> _nnz_diag, _nnz_offdiag;
-  if (bs[0] == bs[1])
+  // AIJ and BAIJ matrices are given the complete (block) CSR structure
+  // of the sparsity pattern, which fixes the nonzero structure before
+  // the first assembly. Other types are preallocated from the number
+  // of nonzeros per row.
+  PetscBool is_aij = PETSC_FALSE, is_baij = PETSC_FALSE;
+  PetscObjectTypeCompareAny((PetscObject)A, &is_aij, MATSEQAIJ, MATMPIAIJ,
+                            "");
+  PetscObjectTypeCompareAny((PetscObject)A, &is_baij, MATSEQBAIJ, MATMPIBAIJ,
+                            "");
+  if (is_aij or (is_baij and bs[0] == bs[1]))
   {
-    _nnz_diag.resize(maps[0]->size_local());
-    _nnz_offdiag.resize(maps[0]->size_local());
-    for (std::size_t i = 0; i < _nnz_diag.size(); ++i)
-      _nnz_diag[i] = diagonal_pattern.links(i).size();
-    for (std::size_t i = 0; i < _nnz_offdiag.size(); ++i)
-      _nnz_offdiag[i] = off_diagonal_pattern.links(i).size();
+    // Set the block sizes before the preallocation sets up the layout
+    ierr = MatSetBlockSizes(A, bs[0], bs[1]);
+    if (ierr != 0)
+      petsc_error(ierr, __FILE__, "MatSetBlockSizes");
+
+    // Row (block) size and column expansion of the CSR arrays
+    const int bs0 = is_baij ? 1 : bs[0];
+    const int bs1 = is_baij ? 1 : bs[1];
+
+    // Build CSR arrays with local rows and sorted global columns
+    const std::vector<std::int64_t> columns = sparsity_pattern.column_indices();
+    const std::int32_t num_rows = maps[0]->size_local();
+    std::vector<PetscInt> row_ptr(bs0 * num_rows + 1, 0);
+    std::vector<PetscInt> cols;
+    cols.reserve(bs0 * bs1 * sparsity_pattern.num_nonzeros());
+    std::vector<PetscInt> row;
+    for (std::int32_t i = 0; i < num_rows; ++i)
+    {
+      row.clear();
+      for (auto& pattern : {std::cref(diagonal_pattern),
+                            std::cref(off_diagonal_pattern)})
+      {
+        for (std::int32_t c : pattern.get().links(i))
+        {
+          for (int k = 0; k < bs1; ++k)
+            row.push_back(bs1 * columns[c] + k);
+        }
+      }
+      std::sort(row.begin(), row.end());
+      for (int k = 0; k < bs0; ++k)
+      {
+        cols.insert(cols.end(), row.begin(), row.end());
+        row_ptr[bs0 * i + k + 1] = cols.size();
+      }
+    }
+
+    // Only the method that matches the matrix type has an effect
+    if (is_baij)
+    {
+      ierr = MatSeqBAIJSetPreallocationCSR(A, _bs, row_ptr.data(),
+                                           cols.data(), nullptr);
+      if (ierr != 0)
+        petsc_error(ierr, __FILE__, "MatSeqBAIJSetPreallocationCSR");
+      ierr = MatMPIBAIJSetPreallocationCSR(A, _bs, row_ptr.data(),
+                                           cols.data(), nullptr);
+      if (ierr != 0)
+        petsc_error(ierr, __FILE__, "MatMPIBAIJSetPreallocationCSR");
+    }
+    else
+    {
+      ierr = MatSeqAIJSetPreallocationCSR(A, row_ptr.data(), cols.data(),
+                                          nullptr);
+      if (ierr != 0)
+        petsc_error(ierr, __FILE__, "MatSeqAIJSetPreallocationCSR");
+      ierr = MatMPIAIJSetPreallocationCSR(A, row_ptr.data(), cols.data(),
+                                          nullptr);
+      if (ierr != 0)
+        petsc_error(ierr, __FILE__, "MatMPIAIJSetPreallocationCSR");
+    }
   }
   else
   {
-    // Expand for block size 1
-    _nnz_diag.resize(maps[0]->size_local() * bs[0]);
-    _nnz_offdiag.resize(maps[0]->size_local() * bs[0]);
-    for (std::size_t i = 0; i < _nnz_diag.size(); ++i)
-      _nnz_diag[i] = bs[1] * diagonal_pattern.links(i / bs[0]).size();
-    for (std::size_t i = 0; i < _nnz_offdiag.size(); ++i)
-      _nnz_offdiag[i] = bs[1] * off_diagonal_pattern.links(i / bs[0]).size();
+    // Build data to initialise sparsity pattern (modify for block size)
+    std::vector<PetscInt> _nnz_diag, _nnz_offdiag;
+    if (bs[0] == bs[1])
+    {
+      _nnz_diag.resize(maps[0]->size_local());
+      _nnz_offdiag.resize(maps[0]->size_local());
+      for (std::size_t i = 0; i < _nnz_diag.size(); ++i)
+        _nnz_diag[i] = diagonal_pattern.links(i).size();
+      for (std::size_t i = 0; i < _nnz_offdiag.size(); ++i)
+        _nnz_offdiag[i] = off_diagonal_pattern.links(i).size();
+    }
+    else
+    {
+      // Expand for block size 1
+      _nnz_diag.resize(maps[0]->size_local() * bs[0]);
+      _nnz_offdiag.resize(maps[0]->size_local() * bs[0]);
+      for (std::size_t i = 0; i < _nnz_diag.size(); ++i)
+        _nnz_diag[i] = bs[1] * diagonal_pattern.links(i / bs[0]).size();
+      for (std::size_t i = 0; i < _nnz_offdiag.size(); ++i)
+        _nnz_offdiag[i] = bs[1] * off_diagonal_pattern.links(i / bs[0]).size();
+    }
+
+    // Number of non-zero blocks in the upper triangle for symmetric
+    // storage
+    std::vector<PetscInt> _nnz_diag_upper, _nnz_offdiag_upper;
+    if (symmetric)
+    {
+      const std::array<std::vector<std::int32_t>, 2> nnz_upper
+          = sparsity_pattern.num_nonzeros_upper();
+      _nnz_diag_upper.assign(nnz_upper[0].begin(), nnz_upper[0].end());
+      _nnz_offdiag_upper.assign(nnz_upper[1].begin(), nnz_upper[1].end());
+    }
+
+    // Allocate space for matrix
+    ierr = MatXAIJSetPreallocation(
+        A, _bs, _nnz_diag.data(), _nnz_offdiag.data(),
+        symmetric ? _nnz_diag_upper.data() : nullptr,
+        symmetric ? _nnz_offdiag_upper.data() : nullptr);
+    if (ierr != 0)
+      petsc_error(ierr, __FILE__, "MatXIJSetPreallocation");
   }
 
-  // Allocate space for matrix
-  ierr = MatXAIJSetPreallocation(A, _bs, _nnz_diag.data(), _nnz_offdiag.data(),
-                                 nullptr, nullptr);
-  if (ierr != 0)
-    petsc_error(ierr, __FILE__, "MatXIJSetPreallocation");
-
   // Set block sizes
   ierr = MatSetBlockSizes(A, bs[0], bs[1]);
   if (ierr != 0)
@@ -153,9 +255,86 @@ Mat la::create_petsc_matrix(
   if (ierr != 0)
     petsc_error(ierr, __FILE__, "MatSetOption");
 
+  // Full element matrices can be added to a symmetric matrix; the
+  // entries below the diagonal are discarded on insertion
+  if (symmetric)
+  {
+    ierr = MatSetOption(A, MAT_IGNORE_LOWER_TRIANGULAR, PETSC_TRUE);
+    if (ierr != 0)
+      petsc_error(ierr, __FILE__, "MatSetOption");
+  }
+
   return A;
 }
 //-----------------------------------------------------------------------------
+Mat la::create_petsc_matrix(la::MatrixCSR<PetscScalar>& A)
+{
+  // The values of a block matrix are stored by blocks, which is not
+  // compatible with the (scalar) row layout of MATMPIAIJ
+  if (A.block_size() != std::array{1, 1})
+  {
+    throw std::runtime_error(
+        "Sharing the values of a MatrixCSR requires block size 1.");
+  }
+
+  const std::array maps = {A.index_map(0), A.index_map(1)};
+  const std::int64_t M = maps[0]->size_global();
+  const std::int64_t N = maps[1]->size_global();
+  const std::int32_t m = maps[0]->size_local();
+  const std::int32_t n = maps[1]->size_local();
+
+  // Copy row offsets and column indices, using global column indices
+  // for the off-diagonal block. PETSc keeps pointers to the index
+  // arrays (and may modify the off-diagonal column indices), so they
+  // are attached to the Mat and destroyed with it.
+  auto indices = std::make_unique<std::array<std::vector<PetscInt>, 4>>();
+  auto& [i_diag, j_diag, i_off, j_off] = *indices;
+  const std::vector<std::int32_t>& cols = A.cols();
+  const std::vector<std::int32_t>& row_ptr = A.row_ptr();
+  const std::vector<std::int32_t>& row_ptr_off = A.off_diagonal_row_ptr();
+  const std::vector<std::int64_t>& col_indices = A.column_indices();
+  i_diag.assign(row_ptr.begin(), row_ptr.end());
+  j_diag.assign(cols.begin(), std::next(cols.begin(), row_ptr.back()));
+  i_off.resize(row_ptr_off.size());
+  std::transform(row_ptr_off.begin(), row_ptr_off.end(), i_off.begin(),
+                 [offset = row_ptr_off.front()](auto d) { return d - offset; });
+  j_off.resize(row_ptr_off.back() - row_ptr_off.front());
+  std::transform(std::next(cols.begin(), row_ptr_off.front()),
+                 std::next(cols.begin(), row_ptr_off.back()), j_off.begin(),
+                 [&col_indices](auto c) { return col_indices[c]; });
+
+  PetscScalar* values = A.values().data();
+  Mat mat;
+  PetscErrorCode ierr = MatCreateMPIAIJWithSplitArrays(
+      maps[0]->comm(common::IndexMap::Direction::forward), m, n, M, N,
+      i_diag.data(), j_diag.data(), values, i_off.data(), j_off.data(),
+      values + row_ptr_off.front(), &mat);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "MatCreateMPIAIJWithSplitArrays");
+
+  // Attach the index arrays to the Mat
+  PetscContainer container;
+  ierr = PetscContainerCreate(PETSC_COMM_SELF, &container);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "PetscContainerCreate");
+  PetscContainerSetPointer(container, indices.release());
+  PetscContainerSetUserDestroy(container,
+                               [](void* ctx) -> PetscErrorCode
+                               {
+                                 delete static_cast<
+                                     std::array<std::vector<PetscInt>, 4>*>(
+                                     ctx);
+                                 return 0;
+                               });
+  ierr = PetscObjectCompose((PetscObject)mat, "dolfinx_csr_indices",
+                            (PetscObject)container);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "PetscObjectCompose");
+  PetscContainerDestroy(&container);
+
+  return mat;
+}
+//-----------------------------------------------------------------------------
 MatNullSpace la::create_petsc_nullspace(MPI_Comm comm,
                                         const la::VectorSpaceBasis& nullspace)
 {
@@ -214,9 +393,9 @@ std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
                   const std::int32_t*, const PetscScalar*)>
 PETScMatrix::set_block_fn(Mat A, InsertMode mode)
 {
-  return [A, mode, cache = std::vector<PetscInt>()](
-             std::int32_t m, const std::int32_t* rows, std::int32_t n,
-             const std::int32_t* cols, const PetscScalar* vals) mutable {
+  auto set = [A, mode, cache = std::vector<PetscInt>()](
+                 std::int32_t m, const std::int32_t* rows, std::int32_t n,
+                 const std::int32_t* cols, const PetscScalar* vals) mutable {
     PetscErrorCode ierr;
 #ifdef PETSC_USE_64BIT_INDICES
     cache.resize(m + n);
@@ -234,6 +413,44 @@ PETScMatrix::set_block_fn(Mat A, InsertMode mode)
 #endif
     return 0;
   };
+
+#ifdef DEBUG
+  // Symmetric matrices store the upper triangle only, so check that
+  // diagonal element blocks are symmetric
+  MatType type;
+  MatGetType(A, &type);
+  if (std::strstr(type, MATSBAIJ))
+  {
+    PetscInt bs = 1;
+    MatGetBlockSize(A, &bs);
+    return [set, bs](std::int32_t m, const std::int32_t* rows,
+                     std::int32_t n, const std::int32_t* cols,
+                     const PetscScalar* vals) mutable {
+      if (m == n and std::equal(rows, rows + m, cols))
+      {
+        const std::int32_t ndim = bs * m;
+        for (std::int32_t i = 0; i < ndim; ++i)
+        {
+          for (std::int32_t j = i + 1; j < ndim; ++j)
+          {
+            const PetscScalar a_ij = vals[i * ndim + j];
+            const PetscScalar a_ji = vals[j * ndim + i];
+            const double tol
+                = 1.0e-10 * std::max(std::abs(a_ij), std::abs(a_ji));
+            if (std::abs(a_ij - a_ji) > tol + 1.0e-14)
+            {
+              throw std::runtime_error(
+                  "Non-symmetric element matrix added to symmetric matrix.");
+            }
+          }
+        }
+      }
+      return set(m, rows, n, cols, vals);
+    };
+  }
+#endif
+
+  return set;
 }
 //-----------------------------------------------------------------------------
 std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
@@ -10,6 +10,7 @@
 #include "PETScOperator.h"
 #include "utils.h"
 #include <functional>
+#include <memory>
 #include <petscmat.h>
 #include <string>
 
@@ -18,11 +19,35 @@ namespace dolfinx::la
 class SparsityPattern;
 class VectorSpaceBasis;
 
+template <typename T, class Allocator>
+class MatrixCSR;
+
 /// Create a PETSc Mat. Caller is responsible for destroying the
 /// returned object.
+///
+/// For AIJ and BAIJ matrices the complete nonzero structure of the
+/// sparsity pattern is passed to PETSc (MatXXXAIJSetPreallocationCSR),
+/// and the entries of the pattern are set to zero. The structure is
+/// therefore fixed on creation and the first assembly is as fast as
+/// subsequent assemblies. Other types are preallocated from the number
+/// of nonzeros in each row.
 Mat create_petsc_matrix(MPI_Comm comm, const SparsityPattern& sparsity_pattern,
                         const std::string& type = std::string());
 
+/// Create a PETSc Mat of type MATMPIAIJ that shares the values of a
+/// la::MatrixCSR (calls MatCreateMPIAIJWithSplitArrays). The values are
+/// not copied, so changes to the values of A are seen by the PETSc Mat
+/// and A must outlive the returned object. Only the column indices are
+/// copied. The block sizes of A must be 1. Caller is responsible for
+/// destroying the returned object.
+/// @note After modifying the values of A, the state of the returned
+/// Mat should be increased (PetscObjectStateIncrease) so that PETSc
+/// discards cached data.
+/// @param[in] A The matrix
+/// @return The PETSc matrix
+Mat create_petsc_matrix(
+    MatrixCSR<PetscScalar, std::allocator<PetscScalar>>& A);
+
 /// Create PETSc MatNullSpace. Caller is responsible for destruction
 /// returned object.
 MatNullSpace create_petsc_nullspace(MPI_Comm comm,
@@ -192,6 +192,13 @@ PETScVector::PETScVector(const common::IndexMap& map, int bs)
   // Do nothing
 }
 //-----------------------------------------------------------------------------
+PETScVector::PETScVector(const std::shared_ptr<la::Vector<PetscScalar>>& x)
+    : _x(la::create_ghosted_vector(*x->map(), x->bs(), x->mutable_array())),
+      _vector(x)
+{
+  // Do nothing
+}
+//-----------------------------------------------------------------------------
 PETScVector::PETScVector(Vec x, bool inc_ref_count) : _x(x)
 {
   assert(x);
@@ -199,7 +206,10 @@ PETScVector::PETScVector(Vec x, bool inc_ref_count) : _x(x)
     PetscObjectReference((PetscObject)_x);
 }
 //-----------------------------------------------------------------------------
-PETScVector::PETScVector(PETScVector&& v) : _x(std::exchange(v._x, nullptr)) {}
+PETScVector::PETScVector(PETScVector&& v)
+    : _x(std::exchange(v._x, nullptr)), _vector(std::move(v._vector))
+{
+}
 //-----------------------------------------------------------------------------
 PETScVector::~PETScVector()
 {
@@ -210,6 +220,7 @@ PETScVector::~PETScVector()
 PETScVector& PETScVector::operator=(PETScVector&& v)
 {
   std::swap(_x, v._x);
+  std::swap(_vector, v._vector);
   return *this;
 }
 //-----------------------------------------------------------------------------
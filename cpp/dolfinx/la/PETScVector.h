@@ -7,10 +7,12 @@
 
 #pragma once
 
+#include "Vector.h"
 #include "utils.h"
 #include <array>
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <petscvec.h>
 #include <vector>
 #include <xtl/xspan.hpp>
@@ -101,6 +103,18 @@ public:
   /// @param[in] bs the block size
   PETScVector(const common::IndexMap& map, int bs);
 
+  /// Create a PETSc vector that shares the data of a vector, i.e. the
+  /// owned and ghost entries of the PETSc vector are the entries of
+  /// `x.mutable_array()`. The ghost layout is that of the index map of
+  /// `x`. The PETScVector holds a reference to `x`.
+  ///
+  /// Collective
+  ///
+  /// @param[in] x The vector to wrap
+  /// @note Modification of the data through the PETSc vector does not
+  /// increment the version of `x`, see la::Vector::increment_version.
+  explicit PETScVector(const std::shared_ptr<la::Vector<PetscScalar>>& x);
+
   // Delete copy constructor to avoid accidental copying of 'heavy' data
   PETScVector(const PETScVector& x) = delete;
 
@@ -170,5 +184,8 @@ public:
 private:
   // PETSc Vec pointer
   Vec _x;
+
+  // Vector that holds the data of _x, if the data is shared
+  std::shared_ptr<la::Vector<PetscScalar>> _vector;
 };
 } // namespace dolfinx::la
@@ -0,0 +1,102 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <dolfinx/common/MPI.h>
+#include <mpi.h>
+#include <utility>
+#include <vector>
+
+namespace dolfinx::la
+{
+
+/// Handle to a non-blocking global sum of several values.
+///
+/// The reduction is started when the handle is created and the summed
+/// values are available after Reduction::wait. This allows a number of
+/// inner products and norms to be reduced with one collective, and the
+/// latency of the collective to be hidden behind local work, e.g. in
+/// pipelined Krylov methods. See la::inner_products_begin.
+///
+/// @note The communicator must remain valid until the reduction is
+/// complete.
+template <typename T>
+class Reduction
+{
+public:
+  /// Start the sum over all ranks of the local values
+  /// @note Collective MPI operation
+  /// @param[in] comm The MPI communicator
+  /// @param[in] local The local values. All ranks must pass the same
+  /// number of values.
+  Reduction(MPI_Comm comm, std::vector<T> local)
+      : _local(std::move(local)), _global(_local.size())
+  {
+    if (!_local.empty())
+    {
+      MPI_Iallreduce(_local.data(), _global.data(), _local.size(),
+                     dolfinx::MPI::mpi_type<T>(), MPI_SUM, comm, &_request);
+    }
+  }
+
+  /// Copy constructor (deleted)
+  Reduction(const Reduction& r) = delete;
+
+  /// Move constructor
+  Reduction(Reduction&& r) noexcept
+      : _local(std::move(r._local)), _global(std::move(r._global)),
+        _request(std::exchange(r._request, MPI_REQUEST_NULL))
+  {
+  }
+
+  /// Destructor. Waits for the reduction to complete if
+  /// Reduction::wait has not been called.
+  ~Reduction()
+  {
+    if (_request != MPI_REQUEST_NULL)
+    {
+      int finalized = 0;
+      MPI_Finalized(&finalized);
+      if (!finalized)
+        MPI_Wait(&_request, MPI_STATUS_IGNORE);
+    }
+  }
+
+  /// Assignment operator (deleted)
+  Reduction& operator=(const Reduction& r) = delete;
+
+  /// Move assignment operator (deleted)
+  Reduction& operator=(Reduction&& r) = delete;
+
+  /// Test if the reduction is complete, without blocking
+  /// @return True if the summed values are available
+  bool test()
+  {
+    int flag = 1;
+    if (_request != MPI_REQUEST_NULL)
+      MPI_Test(&_request, &flag, MPI_STATUS_IGNORE);
+    return flag;
+  }
+
+  /// Wait for the reduction to complete
+  /// @return The summed values, in the order of the local values
+  const std::vector<T>& wait()
+  {
+    if (_request != MPI_REQUEST_NULL)
+      MPI_Wait(&_request, MPI_STATUS_IGNORE);
+    return _global;
+  }
+
+private:
+  // Local values (send buffer) and summed values (receive buffer)
+  std::vector<T> _local, _global;
+
+  // Request for the reduction
+  MPI_Request _request = MPI_REQUEST_NULL;
+};
+
+} // namespace dolfinx::la
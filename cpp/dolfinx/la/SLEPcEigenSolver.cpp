@@ -9,11 +9,14 @@
 #include "SLEPcEigenSolver.h"
 #include "VectorSpaceBasis.h"
 #include "utils.h"
+#include <algorithm>
 #include <dolfinx/common/MPI.h>
+#include <dolfinx/common/Timer.h>
 #include <dolfinx/common/log.h>
 #include <dolfinx/la/PETScVector.h>
 #include <petscmat.h>
 #include <slepcversion.h>
+#include <utility>
 
 using namespace dolfinx;
 using namespace dolfinx::la;
@@ -36,13 +39,17 @@ SLEPcEigenSolver::SLEPcEigenSolver(EPS eps, bool inc_ref_count) : _eps(eps)
 }
 //-----------------------------------------------------------------------------
 SLEPcEigenSolver::SLEPcEigenSolver(SLEPcEigenSolver&& solver)
-    : _eps(std::exchange(solver._eps, nullptr))
+    : _eps(std::exchange(solver._eps, nullptr)), _reuse(solver._reuse),
+      _rebuild(solver._rebuild), _warm_start(solver._warm_start),
+      _initial_space(std::move(solver._initial_space)),
+      _timings(solver._timings)
 {
-  // Do nothing
+  solver._initial_space.clear();
 }
 //-----------------------------------------------------------------------------
 SLEPcEigenSolver::~SLEPcEigenSolver()
 {
+  destroy_initial_space();
   if (_eps)
     EPSDestroy(&_eps);
 }
@@ -50,6 +57,11 @@ SLEPcEigenSolver::~SLEPcEigenSolver()
 SLEPcEigenSolver& SLEPcEigenSolver::operator=(SLEPcEigenSolver&& solver)
 {
   std::swap(_eps, solver._eps);
+  std::swap(_reuse, solver._reuse);
+  std::swap(_rebuild, solver._rebuild);
+  std::swap(_warm_start, solver._warm_start);
+  std::swap(_initial_space, solver._initial_space);
+  std::swap(_timings, solver._timings);
   return *this;
 }
 //-----------------------------------------------------------------------------
@@ -91,8 +103,33 @@ void SLEPcEigenSolver::solve(std::int64_t n)
   // Set any options from the PETSc database
   EPSSetFromOptions(_eps);
 
+  // Set up the solver and the spectral transformation separately from
+  // the iterations, so that their times are measured separately
+  common::Timer t0("SLEPc eigen solver setup");
+  reuse_begin();
+  if (!_initial_space.empty())
+  {
+    PetscErrorCode ierr = EPSSetInitialSpace(_eps, _initial_space.size(),
+                                             _initial_space.data());
+    if (ierr != 0)
+      petsc_error(ierr, __FILE__, "EPSSetInitialSpace");
+    destroy_initial_space();
+  }
+  PetscErrorCode ierr = EPSSetUp(_eps);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "EPSSetUp");
+  _timings[0] = t0.stop();
+  _rebuild = false;
+
   // Solve eigenvalue problem
-  EPSSolve(_eps);
+  common::Timer t1("SLEPc eigen solver iterations");
+  ierr = EPSSolve(_eps);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "EPSSolve");
+  _timings[1] = t1.stop();
+
+  if (_warm_start)
+    store_initial_space();
 
   // Check for convergence
   EPSConvergedReason reason;
@@ -110,6 +147,99 @@ void SLEPcEigenSolver::solve(std::int64_t n)
             << num_iterations << " iterations.";
 }
 //-----------------------------------------------------------------------------
+void SLEPcEigenSolver::set_factorisation_reuse(bool reuse)
+{
+  _reuse = reuse;
+  _rebuild = true;
+}
+//-----------------------------------------------------------------------------
+void SLEPcEigenSolver::rebuild_factorisation() { _rebuild = true; }
+//-----------------------------------------------------------------------------
+void SLEPcEigenSolver::set_initial_space(const std::vector<Vec>& x)
+{
+  destroy_initial_space();
+  for (Vec v : x)
+  {
+    Vec w;
+    PetscErrorCode ierr = VecDuplicate(v, &w);
+    if (ierr != 0)
+      petsc_error(ierr, __FILE__, "VecDuplicate");
+    VecCopy(v, w);
+    _initial_space.push_back(w);
+  }
+}
+//-----------------------------------------------------------------------------
+void SLEPcEigenSolver::set_warm_start(bool warm_start)
+{
+  _warm_start = warm_start;
+}
+//-----------------------------------------------------------------------------
+std::array<double, 2> SLEPcEigenSolver::timings() const { return _timings; }
+//-----------------------------------------------------------------------------
+void SLEPcEigenSolver::reuse_begin()
+{
+  if (!_reuse)
+    return;
+
+  assert(_eps);
+  ST st;
+  EPSGetST(_eps, &st);
+
+  // The shifted operator keeps its nonzero pattern, which is the union
+  // of the patterns of the operators, when the values change
+  PetscErrorCode ierr = STSetMatStructure(st, SAME_NONZERO_PATTERN);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "STSetMatStructure");
+
+  KSP ksp;
+  STGetKSP(st, &ksp);
+  ierr = KSPSetReusePreconditioner(ksp, _rebuild ? PETSC_FALSE : PETSC_TRUE);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "KSPSetReusePreconditioner");
+  if (_rebuild)
+  {
+    // The method has no effect for solvers other than factorisations
+    PC pc;
+    KSPGetPC(ksp, &pc);
+    ierr = PCFactorSetReuseOrdering(pc, PETSC_TRUE);
+    if (ierr != 0)
+      petsc_error(ierr, __FILE__, "PCFactorSetReuseOrdering");
+  }
+}
+//-----------------------------------------------------------------------------
+void SLEPcEigenSolver::store_initial_space()
+{
+  destroy_initial_space();
+
+  assert(_eps);
+  Mat A, B;
+  EPSGetOperators(_eps, &A, &B);
+  PetscInt num_converged = 0;
+  EPSGetConverged(_eps, &num_converged);
+
+  // The dimension of the initial space may not exceed the dimension of
+  // the subspace of the solver
+  PetscInt nev, ncv, mpd;
+  EPSGetDimensions(_eps, &nev, &ncv, &mpd);
+  const PetscInt n = std::min(num_converged, ncv);
+  for (PetscInt i = 0; i < n; ++i)
+  {
+    Vec x;
+    MatCreateVecs(A, &x, nullptr);
+    PetscErrorCode ierr = EPSGetEigenvector(_eps, i, x, nullptr);
+    if (ierr != 0)
+      petsc_error(ierr, __FILE__, "EPSGetEigenvector");
+    _initial_space.push_back(x);
+  }
+}
+//-----------------------------------------------------------------------------
+void SLEPcEigenSolver::destroy_initial_space()
+{
+  for (Vec& x : _initial_space)
+    VecDestroy(&x);
+  _initial_space.clear();
+}
+//-----------------------------------------------------------------------------
 std::complex<PetscReal> SLEPcEigenSolver::get_eigenvalue(int i) const
 {
   assert(_eps);
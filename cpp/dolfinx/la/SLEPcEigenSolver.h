@@ -9,11 +9,13 @@
 #ifdef HAS_SLEPC
 
 #include "dolfinx/common/MPI.h"
+#include <array>
 #include <memory>
 #include <petscmat.h>
 #include <petscvec.h>
 #include <slepceps.h>
 #include <string>
+#include <vector>
 
 namespace dolfinx::la
 {
@@ -21,6 +23,12 @@ class VectorSpaceBasis;
 
 /// This class provides an eigenvalue solver for PETSc matrices. It is a
 /// wrapper for the SLEPc eigenvalue solver.
+///
+/// For sequences of nearby eigenvalue problems, e.g. in parametric
+/// studies, the factorisation of the spectral transformation can be
+/// kept between solves (see set_factorisation_reuse) and the
+/// eigenvectors of a solve can be used as the initial space of the next
+/// solve (see set_warm_start).
 
 class SLEPcEigenSolver
 {
@@ -56,6 +64,43 @@ public:
   /// Compute the n first eigenpairs of the matrix A (solve Ax = \lambda x)
   void solve(std::int64_t n);
 
+  /// Keep the factorisation of the linear solver of the spectral
+  /// transformation (e.g. for shift-and-invert) between solves. The
+  /// factorisation is then only computed by the first solve and by the
+  /// first solve after rebuild_factorisation. When it is recomputed,
+  /// the nonzero pattern of the shifted operator and the ordering of
+  /// the factorisation are kept, so that only the numeric factorisation
+  /// is repeated.
+  /// @note If the values of the operators change, a kept factorisation
+  /// is exact only if rebuild_factorisation is called. With an
+  /// iterative solver for the spectral transformation, the kept
+  /// factorisation is a preconditioner for the changed operators.
+  /// @param[in] reuse True to keep the factorisation
+  void set_factorisation_reuse(bool reuse);
+
+  /// Recompute the factorisation of the spectral transformation at the
+  /// next solve, e.g. after the values of the operators have changed,
+  /// see set_factorisation_reuse
+  void rebuild_factorisation();
+
+  /// Set the initial space of the next solve, e.g. approximate
+  /// eigenvectors from a previous solve. The vectors are used by the
+  /// next solve only.
+  /// @param[in] x Vectors with the layout of the operators
+  void set_initial_space(const std::vector<Vec>& x);
+
+  /// Use the converged eigenvectors of each solve as the initial space
+  /// of the next solve, for a sequence of nearby eigenvalue problems
+  /// @param[in] warm_start True to use warm starts
+  void set_warm_start(bool warm_start);
+
+  /// Wall times of the setup (including the factorisation of the
+  /// spectral transformation) and of the iterations of the last solve.
+  /// The times are also added to the timings of the tasks "SLEPc eigen
+  /// solver setup" and "SLEPc eigen solver iterations".
+  /// @return The setup and iteration times in seconds
+  std::array<double, 2> timings() const;
+
   /// Get ith eigenvalue
   std::complex<PetscReal> get_eigenvalue(int i) const;
 
@@ -87,8 +132,33 @@ public:
   MPI_Comm mpi_comm() const;
 
 private:
+  // Set the reuse of the factorisation of the spectral transformation
+  // for the next solve
+  void reuse_begin();
+
+  // Store the converged eigenvectors as the initial space of the next
+  // solve
+  void store_initial_space();
+
+  // Destroy the vectors of the initial space
+  void destroy_initial_space();
+
   // SLEPc solver pointer
   EPS _eps;
+
+  // Keep the factorisation of the spectral transformation, and whether
+  // it is recomputed at the next solve
+  bool _reuse = false;
+  bool _rebuild = true;
+
+  // Use the eigenvectors of the last solve as the initial space
+  bool _warm_start = false;
+
+  // Initial space of the next solve
+  std::vector<Vec> _initial_space;
+
+  // Setup and iteration times of the last solve
+  std::array<double, 2> _timings = {0, 0};
 };
 } // namespace dolfinx::la
 #endif
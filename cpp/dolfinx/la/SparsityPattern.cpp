@@ -10,12 +10,29 @@
 #include <dolfinx/common/MPI.h>
 #include <dolfinx/common/Timer.h>
 #include <dolfinx/common/log.h>
+#include <dolfinx/common/utils.h>
 #include <dolfinx/graph/AdjacencyList.h>
 #include <map>
 
 using namespace dolfinx;
 using namespace dolfinx::la;
 
+namespace
+{
+/// Call f(i) for i in [0, n), with the range split into contiguous
+/// parts that are processed by up to num_threads threads
+template <typename F>
+void for_each_row(std::int32_t n, int num_threads, F&& f)
+{
+  common::for_each_part(n, num_threads,
+                        [&f](std::int64_t i0, std::int64_t i1, int)
+                        {
+                          for (std::int64_t i = i0; i < i1; ++i)
+                            f(i);
+                        });
+}
+} // namespace
+
 //-----------------------------------------------------------------------------
 SparsityPattern::SparsityPattern(
     MPI_Comm comm,
@@ -40,42 +57,53 @@ SparsityPattern::SparsityPattern(
   // FIXME: - Add range/bound checks for each block
   //        - Check for compatible block sizes for each block
 
-  const auto [rank_offset0, local_offset0, ghosts_new0, owners0]
-      = common::stack_index_maps(maps[0]);
-  const auto [rank_offset1, local_offset1, ghosts_new1, owners1]
-      = common::stack_index_maps(maps[1]);
-
-  std::vector<std::int64_t> ghosts0, ghosts1;
-  std::vector<std::int32_t> ghost_offsets0(1, 0);
-  std::vector<std::int32_t> ghost_offsets1(1, 0);
-  for (const std::vector<std::int64_t>& ghosts : ghosts_new0)
+  // Create the stacked index maps. The column map is the row map if the
+  // row and column maps are the same.
+  auto create_map = [comm](const auto& maps)
   {
-    ghost_offsets0.push_back(ghost_offsets0.back() + ghosts.size());
-    ghosts0.insert(ghosts0.end(), ghosts.begin(), ghosts.end());
-  }
-  for (const std::vector<std::int64_t>& ghosts : ghosts_new1)
+    const auto [rank_offset, local_offset, ghosts_new, owners]
+        = common::stack_index_maps(maps);
+    std::vector<std::int64_t> ghosts;
+    for (const std::vector<std::int64_t>& g : ghosts_new)
+      ghosts.insert(ghosts.end(), g.begin(), g.end());
+    std::vector<int> ghost_owners;
+    for (const std::vector<int>& o : owners)
+      ghost_owners.insert(ghost_owners.end(), o.begin(), o.end());
+    return std::make_shared<common::IndexMap>(
+        comm, local_offset.back(), common::stack_dest_ranks(maps), ghosts,
+        ghost_owners);
+  };
+
+  auto same = [](auto& m0, auto& m1)
+  { return &m0.first.get() == &m1.first.get() and m0.second == m1.second; };
+  _index_maps[0] = create_map(maps[0]);
+  if (std::equal(maps[0].begin(), maps[0].end(), maps[1].begin(),
+                 maps[1].end(), same))
   {
-    ghost_offsets1.push_back(ghost_offsets1.back() + ghosts.size());
-    ghosts1.insert(ghosts1.end(), ghosts.begin(), ghosts.end());
+    _index_maps[1] = _index_maps[0];
   }
+  else
+    _index_maps[1] = create_map(maps[1]);
 
-  std::vector<int> ghost_owners0, ghost_owners1;
-  for (const std::vector<int>& owners : owners0)
-    ghost_owners0.insert(ghost_owners0.end(), owners.begin(), owners.end());
-  for (const std::vector<int>& owners : owners1)
-    ghost_owners1.insert(ghost_owners1.end(), owners.begin(), owners.end());
-
-  // Create new IndexMaps
-  _index_maps[0] = std::make_shared<common::IndexMap>(
-      comm, local_offset0.back(),
-      dolfinx::MPI::compute_graph_edges(
-          comm, std::set<int>(ghost_owners0.begin(), ghost_owners0.end())),
-      ghosts0, ghost_owners0);
-  _index_maps[1] = std::make_shared<common::IndexMap>(
-      comm, local_offset1.back(),
-      dolfinx::MPI::compute_graph_edges(
-          comm, std::set<int>(ghost_owners1.begin(), ghost_owners1.end())),
-      ghosts1, ghost_owners1);
+  // Offsets of the maps in the stacked maps
+  std::array<std::vector<std::int32_t>, 2> local_offset;
+  std::array<std::vector<std::int32_t>, 2> ghost_offset;
+  for (std::size_t d = 0; d < 2; ++d)
+  {
+    local_offset[d].push_back(0);
+    ghost_offset[d].push_back(0);
+    for (auto& [map, bs] : maps[d])
+    {
+      local_offset[d].push_back(local_offset[d].back()
+                                + bs * map.get().size_local());
+      ghost_offset[d].push_back(ghost_offset[d].back()
+                                + bs * map.get().num_ghosts());
+    }
+  }
+  const std::vector<std::int32_t>& local_offset0 = local_offset[0];
+  const std::vector<std::int32_t>& local_offset1 = local_offset[1];
+  const std::vector<std::int32_t>& ghost_offsets0 = ghost_offset[0];
+  const std::vector<std::int32_t>& ghost_offsets1 = ghost_offset[1];
 
   _cache_owned.resize(_index_maps[0]->size_local());
   _cache_unowned.resize(_index_maps[0]->num_ghosts());
@@ -102,6 +130,11 @@ SparsityPattern::SparsityPattern(
         throw std::runtime_error("Sub-sparsity pattern has been finalised. "
                                  "Cannot compute stacked pattern.");
       }
+      if (p->_counting)
+      {
+        throw std::runtime_error("Sub-sparsity pattern is being counted. "
+                                 "Cannot compute stacked pattern.");
+      }
 
       const int bs_dof0 = bs[0][row];
       const int bs_dof1 = bs[1][col];
@@ -109,7 +142,7 @@ SparsityPattern::SparsityPattern(
       // Iterate over owned rows cache
       for (std::int32_t i = 0; i < num_rows_local; ++i)
       {
-        for (std::int32_t c_old : p->_cache_owned[i])
+        for (std::int32_t c_old : p->cached_row(i))
         {
           const std::int32_t r_new = bs_dof0 * i + local_offset0[row];
           const std::int32_t c_new = (c_old < num_cols_local)
@@ -128,7 +161,7 @@ SparsityPattern::SparsityPattern(
       // Iterate over unowned rows cache
       for (std::int32_t i = 0; i < num_ghost_rows_local; ++i)
       {
-        for (std::int32_t c_old : p->_cache_unowned[i])
+        for (std::int32_t c_old : p->cached_row(num_rows_local + i))
         {
           const std::int32_t r_new = bs_dof0 * i + ghost_offsets0[row];
           const std::int32_t c_new = (c_old < num_cols_local)
@@ -176,58 +209,162 @@ void SparsityPattern::insert(const xtl::span<const std::int32_t>& rows,
         "Cannot insert into sparsity pattern. It has already been assembled");
   }
 
-  assert(_index_maps[0]);
-  const std::int32_t local_size0 = _index_maps[0]->size_local();
-  const std::int32_t size0 = local_size0 + _index_maps[0]->num_ghosts();
+  for (std::int32_t row : rows)
+    insert_row(row, cols);
+}
+//-----------------------------------------------------------------------------
+void SparsityPattern::insert_diagonal(const std::vector<int32_t>& rows)
+{
+  if (_diagonal)
+  {
+    throw std::runtime_error(
+        "Cannot insert into sparsity pattern. It has already been assembled");
+  }
 
   for (std::int32_t row : rows)
+    insert_row(row, xtl::span<const std::int32_t>(&row, 1));
+}
+//-----------------------------------------------------------------------------
+void SparsityPattern::count_begin()
+{
+  if (_diagonal)
+    throw std::runtime_error("Sparsity pattern has already been finalised.");
+  if (_counting or !_cache_offsets.empty())
+    throw std::runtime_error("Sparsity pattern is already being counted.");
+  for (auto cache : {&_cache_owned, &_cache_unowned})
   {
-    if (row < local_size0)
-      _cache_owned[row].insert(_cache_owned[row].end(), cols.begin(),
-                               cols.end());
-    else if (row < size0)
-    {
-      _cache_unowned[row - local_size0].insert(
-          _cache_unowned[row - local_size0].end(), cols.begin(), cols.end());
-    }
-    else
+    if (std::any_of(cache->begin(), cache->end(),
+                    [](auto& row) { return !row.empty(); }))
     {
       throw std::runtime_error(
-          "Cannot insert rows that do not exist in the IndexMap.");
+          "Cannot count insertions. Entries have already been inserted.");
     }
   }
+
+  assert(_index_maps[0]);
+  _row_counts.assign(
+      _index_maps[0]->size_local() + _index_maps[0]->num_ghosts(), 0);
+  _counting = true;
 }
 //-----------------------------------------------------------------------------
-void SparsityPattern::insert_diagonal(const std::vector<int32_t>& rows)
+void SparsityPattern::count_end()
 {
-  if (_diagonal)
+  if (!_counting)
+    throw std::runtime_error("Sparsity pattern is not being counted.");
+
+  // Add counts of ghost rows to the owned rows, which receive the
+  // ghost row entries in SparsityPattern::assemble
+  assert(_index_maps[0]);
+  const std::int32_t local_size0 = _index_maps[0]->size_local();
+  std::vector<std::int64_t> counts(_row_counts);
+  _index_maps[0]->scatter_rev(
+      xtl::span<std::int64_t>(counts.data(), local_size0),
+      xtl::span<const std::int64_t>(counts.data() + local_size0,
+                                      counts.size() - local_size0),
+      1, common::IndexMap::Mode::add);
+
+  // Allocate compressed storage
+  _cache_offsets.resize(counts.size() + 1);
+  _cache_offsets[0] = 0;
+  std::partial_sum(counts.begin(), counts.end(),
+                   std::next(_cache_offsets.begin()));
+  _cache_data.resize(_cache_offsets.back());
+  _cache_pos.assign(_cache_offsets.begin(), std::prev(_cache_offsets.end()));
+
+  std::vector<std::int64_t>().swap(_row_counts);
+  std::vector<std::vector<std::int32_t>>().swap(_cache_owned);
+  std::vector<std::vector<std::int32_t>>().swap(_cache_unowned);
+  _counting = false;
+}
+//-----------------------------------------------------------------------------
+void SparsityPattern::insert_row(std::int32_t row,
+                                 const xtl::span<const std::int32_t>& cols)
+{
+  assert(_index_maps[0]);
+  const std::int32_t local_size0 = _index_maps[0]->size_local();
+  const std::int32_t size0 = local_size0 + _index_maps[0]->num_ghosts();
+  if (row >= size0)
   {
     throw std::runtime_error(
-        "Cannot insert into sparsity pattern. It has already been assembled");
+        "Cannot insert rows that do not exist in the IndexMap.");
+  }
+
+  // Rows that exceed the count of the first pass of a two-pass
+  // construction revert the pattern to per-row storage
+  if (!_cache_offsets.empty()
+      and _cache_pos[row] + static_cast<std::int64_t>(cols.size())
+              > _cache_offsets[row + 1])
+  {
+    LOG(WARNING) << "Sparsity pattern insertions exceed the count of the "
+                    "first pass. Reverting to uncompressed storage.";
+    decompress();
   }
 
+  if (_counting)
+    _row_counts[row] += cols.size();
+  else if (!_cache_offsets.empty())
+  {
+    std::copy(cols.begin(), cols.end(),
+              std::next(_cache_data.begin(), _cache_pos[row]));
+    _cache_pos[row] += cols.size();
+  }
+  else if (row < local_size0)
+    _cache_owned[row].insert(_cache_owned[row].end(), cols.begin(), cols.end());
+  else
+  {
+    _cache_unowned[row - local_size0].insert(
+        _cache_unowned[row - local_size0].end(), cols.begin(), cols.end());
+  }
+}
+//-----------------------------------------------------------------------------
+void SparsityPattern::decompress()
+{
   assert(_index_maps[0]);
   const std::int32_t local_size0 = _index_maps[0]->size_local();
-  const std::int32_t size0 = local_size0 + _index_maps[0]->num_ghosts();
+  std::vector<std::vector<std::int32_t>> owned(local_size0),
+      unowned(_index_maps[0]->num_ghosts());
+  for (std::int32_t i = 0; i < local_size0; ++i)
+  {
+    xtl::span<const std::int32_t> row = cached_row(i);
+    owned[i].assign(row.begin(), row.end());
+  }
+  for (std::size_t i = 0; i < unowned.size(); ++i)
+  {
+    xtl::span<const std::int32_t> row = cached_row(local_size0 + i);
+    unowned[i].assign(row.begin(), row.end());
+  }
 
-  for (std::int32_t row : rows)
+  _cache_owned = std::move(owned);
+  _cache_unowned = std::move(unowned);
+  std::vector<std::int32_t>().swap(_cache_data);
+  std::vector<std::int64_t>().swap(_cache_offsets);
+  std::vector<std::int64_t>().swap(_cache_pos);
+}
+//-----------------------------------------------------------------------------
+xtl::span<const std::int32_t>
+SparsityPattern::cached_row(std::int32_t row) const
+{
+  if (!_cache_offsets.empty())
   {
-    if (row < local_size0)
-      _cache_owned[row].push_back(row);
-    else if (row < size0)
-      _cache_unowned[row - local_size0].push_back(row);
-    else
-    {
-      throw std::runtime_error(
-          "Cannot insert rows that do not exist in the IndexMap.");
-    }
+    return xtl::span<const std::int32_t>(
+        _cache_data.data() + _cache_offsets[row],
+        _cache_pos[row] - _cache_offsets[row]);
   }
+
+  assert(_index_maps[0]);
+  const std::int32_t local_size0 = _index_maps[0]->size_local();
+  if (row < local_size0)
+    return _cache_owned[row];
+  else
+    return _cache_unowned[row - local_size0];
 }
 //-----------------------------------------------------------------------------
-void SparsityPattern::assemble()
+void SparsityPattern::assemble(int num_threads)
 {
   if (_diagonal)
     throw std::runtime_error("Sparsity pattern has already been finalised.");
+  if (_counting)
+    throw std::runtime_error("Sparsity pattern is still being counted.");
   assert(!_off_diagonal);
 
   common::Timer t0("SparsityPattern::assemble");
@@ -244,6 +381,32 @@ void SparsityPattern::assemble()
   const std::array local_range1 = _index_maps[1]->local_range();
   _col_ghosts = _index_maps[1]->ghosts();
 
+  // Sort and remove duplicate column indices in row i (owned or ghost)
+  auto sort_row = [this, local_size0](std::int32_t i)
+  {
+    if (_cache_offsets.empty())
+    {
+      std::vector<std::int32_t>& row = i < local_size0
+                                           ? _cache_owned[i]
+                                           : _cache_unowned[i - local_size0];
+      std::sort(row.begin(), row.end());
+      row.erase(std::unique(row.begin(), row.end()), row.end());
+    }
+    else
+    {
+      auto first = std::next(_cache_data.begin(), _cache_offsets[i]);
+      auto last = std::next(_cache_data.begin(), _cache_pos[i]);
+      std::sort(first, last);
+      _cache_pos[i] = std::distance(_cache_data.begin(),
+                                    std::unique(first, last));
+    }
+  };
+
+  // Sort ghost rows before sending them to the owner
+  for_each_row(num_ghosts0, num_threads,
+               [&sort_row, local_size0](std::int32_t i)
+               { sort_row(local_size0 + i); });
+
   // Global to local map for ghost columns
   std::map<std::int64_t, std::int32_t> global_to_local;
   std::int32_t local_i = local_size1;
@@ -274,7 +437,8 @@ void SparsityPattern::assemble()
 
     // Add to src size
     assert(ghost_to_neighbour_rank[i] < (int)data_per_proc.size());
-    data_per_proc[ghost_to_neighbour_rank[i]] += 2 * _cache_unowned[i].size();
+    data_per_proc[ghost_to_neighbour_rank[i]]
+        += 2 * cached_row(local_size0 + i).size();
   }
 
   // Compute send displacements
@@ -289,7 +453,7 @@ void SparsityPattern::assemble()
   for (int i = 0; i < num_ghosts0; ++i)
   {
     const int neighbour_rank = ghost_to_neighbour_rank[i];
-    for (std::int32_t col_local : _cache_unowned[i])
+    for (std::int32_t col_local : cached_row(local_size0 + i))
     {
       // Get index in send buffer
       const std::int32_t pos = insert_pos[neighbour_rank];
@@ -317,11 +481,11 @@ void SparsityPattern::assemble()
   {
     const std::int32_t row_local = in_ghost_data[i] - local_range0[0];
     const std::int64_t col = in_ghost_data[i + 1];
+    std::int32_t col_local;
     if (col >= local_range1[0] and col < local_range1[1])
     {
       // Convert to local column index
-      const std::int32_t J = col - local_range1[0];
-      _cache_owned[row_local].push_back(J);
+      col_local = col - local_range1[0];
     }
     else
     {
@@ -332,35 +496,68 @@ void SparsityPattern::assemble()
         _col_ghosts.push_back(col);
         ++local_i;
       }
-      const std::int32_t col_local = it.first->second;
-      _cache_owned[row_local].push_back(col_local);
+      col_local = it.first->second;
     }
+
+    // The capacity of compressed rows includes the ghost row entries
+    // of other ranks, see count_end
+    insert_row(row_local, xtl::span<const std::int32_t>(&col_local, 1));
   }
+  for_each_row(local_size0, num_threads, sort_row);
 
-  // Sort and remove duplicate column indices in each owned row
+  // Keep the (sorted) ghost rows for matrix types that store ghost
+  // rows
+  std::vector<std::int32_t> ghost_rows_data,
+      ghost_rows_offsets(num_ghosts0 + 1, 0);
+  for (std::int32_t i = 0; i < num_ghosts0; ++i)
+  {
+    xtl::span<const std::int32_t> row = cached_row(local_size0 + i);
+    ghost_rows_data.insert(ghost_rows_data.end(), row.begin(), row.end());
+    ghost_rows_offsets[i + 1] = ghost_rows_data.size();
+  }
+  std::vector<std::vector<std::int32_t>>().swap(_cache_unowned);
+
+  // Split owned rows into owned ("diagonal") and non-owned columns.
+  // The rows are sorted, so the owned columns come first.
   std::vector<std::int32_t> adj_counts(local_size0, 0),
       adj_counts_off(local_size0, 0);
   std::vector<std::int32_t> adj_data, adj_data_off;
-  for (std::int32_t i = 0; i < local_size0; ++i)
+  if (_cache_offsets.empty())
   {
-    std::vector<std::int32_t>& row = _cache_owned[i];
-    std::sort(row.begin(), row.end());
-    const std::vector<std::int32_t>::iterator it_end
-        = std::unique(row.begin(), row.end());
-
-    // Find position of first "off-diagonal" column
-    const std::vector<std::int32_t>::iterator it_diag
-        = std::lower_bound(row.begin(), it_end, local_size1);
-
-    // Store owned columns
-    adj_data.insert(adj_data.end(), row.begin(), it_diag);
-    adj_counts[i] += (it_diag - row.begin());
-
-    // Store non-owned columns
-    adj_data_off.insert(adj_data_off.end(), it_diag, it_end);
-    adj_counts_off[i] += (it_end - it_diag);
+    for (std::int32_t i = 0; i < local_size0; ++i)
+    {
+      const std::vector<std::int32_t>& row = _cache_owned[i];
+      auto it_diag = std::lower_bound(row.begin(), row.end(), local_size1);
+      adj_data.insert(adj_data.end(), row.begin(), it_diag);
+      adj_counts[i] = std::distance(row.begin(), it_diag);
+      adj_data_off.insert(adj_data_off.end(), it_diag, row.end());
+      adj_counts_off[i] = std::distance(it_diag, row.end());
+    }
+    std::vector<std::vector<std::int32_t>>().swap(_cache_owned);
+  }
+  else
+  {
+    // Compact the owned columns in place. The write position never
+    // exceeds the start of the row that is read.
+    std::int64_t pos = 0;
+    for (std::int32_t i = 0; i < local_size0; ++i)
+    {
+      auto first = std::next(_cache_data.begin(), _cache_offsets[i]);
+      auto last = std::next(_cache_data.begin(), _cache_pos[i]);
+      auto it_diag = std::lower_bound(first, last, local_size1);
+      adj_data_off.insert(adj_data_off.end(), it_diag, last);
+      adj_counts_off[i] = std::distance(it_diag, last);
+      adj_counts[i] = std::distance(first, it_diag);
+      if (pos != _cache_offsets[i])
+        std::copy(first, it_diag, std::next(_cache_data.begin(), pos));
+      pos += adj_counts[i];
+    }
+    _cache_data.resize(pos);
+    _cache_data.shrink_to_fit();
+    adj_data = std::move(_cache_data);
+    std::vector<std::int64_t>().swap(_cache_offsets);
+    std::vector<std::int64_t>().swap(_cache_pos);
   }
-  std::vector<std::vector<std::int32_t>>().swap(_cache_owned);
 
   // Compute offsets for diagonal and off-diagonal block adjacency lists
   std::vector<std::int32_t> adj_offsets(local_size0 + 1),
@@ -387,6 +584,9 @@ void SparsityPattern::assemble()
 
   _off_diagonal = std::make_shared<graph::AdjacencyList<std::int32_t>>(
       std::move(adj_data_off), std::move(adj_offsets_off));
+
+  _ghost_rows = std::make_shared<graph::AdjacencyList<std::int32_t>>(
+      std::move(ghost_rows_data), std::move(ghost_rows_offsets));
 }
 //-----------------------------------------------------------------------------
 std::int64_t SparsityPattern::num_nonzeros() const
@@ -397,6 +597,42 @@ std::int64_t SparsityPattern::num_nonzeros() const
   return _diagonal->array().size() + _off_diagonal->array().size();
 }
 //-----------------------------------------------------------------------------
+std::array<std::vector<std::int32_t>, 2>
+SparsityPattern::num_nonzeros_upper() const
+{
+  if (!_diagonal)
+    throw std::runtime_error("Sparsity pattern has not been finalised.");
+  assert(_off_diagonal);
+  const std::array range0 = _index_maps[0]->local_range();
+  if (range0 != _index_maps[1]->local_range())
+  {
+    throw std::runtime_error(
+        "Upper triangular pattern requires matching row and column maps.");
+  }
+
+  // Owned columns have the same local-to-global offset as the rows, so
+  // the diagonal block can be tested with local indices
+  const std::int32_t num_rows = _diagonal->num_nodes();
+  std::array<std::vector<std::int32_t>, 2> nnz
+      = {std::vector<std::int32_t>(num_rows),
+         std::vector<std::int32_t>(num_rows)};
+  const std::vector<std::int64_t> columns = column_indices();
+  for (std::int32_t i = 0; i < num_rows; ++i)
+  {
+    auto cols = _diagonal->links(i);
+    nnz[0][i] = std::distance(std::lower_bound(cols.begin(), cols.end(), i),
+                              cols.end());
+
+    const std::int64_t row = range0[0] + i;
+    auto cols_off = _off_diagonal->links(i);
+    nnz[1][i] = std::count_if(cols_off.begin(), cols_off.end(),
+                              [&columns, row](std::int32_t j)
+                              { return columns[j] > row; });
+  }
+
+  return nnz;
+}
+//-----------------------------------------------------------------------------
 const graph::AdjacencyList<std::int32_t>&
 SparsityPattern::diagonal_pattern() const
 {
@@ -413,5 +649,34 @@ SparsityPattern::off_diagonal_pattern() const
   return *_off_diagonal;
 }
 //-----------------------------------------------------------------------------
+const graph::AdjacencyList<std::int32_t>&
+SparsityPattern::ghost_row_pattern() const
+{
+  if (!_ghost_rows)
+    throw std::runtime_error("Sparsity pattern has not been finalised.");
+  return *_ghost_rows;
+}
+//-----------------------------------------------------------------------------
 MPI_Comm SparsityPattern::mpi_comm() const { return _mpi_comm.comm(); }
 //-----------------------------------------------------------------------------
+std::size_t SparsityPattern::memory_usage() const
+{
+  std::size_t size = _col_ghosts.capacity() * sizeof(std::int64_t);
+  for (auto cache : {&_cache_owned, &_cache_unowned})
+  {
+    size += cache->capacity() * sizeof(std::vector<std::int32_t>);
+    for (auto& row : *cache)
+      size += row.capacity() * sizeof(std::int32_t);
+  }
+  size += _cache_data.capacity() * sizeof(std::int32_t);
+  for (auto v : {&_row_counts, &_cache_offsets, &_cache_pos})
+    size += v->capacity() * sizeof(std::int64_t);
+  for (auto p : {&_diagonal, &_off_diagonal, &_ghost_rows})
+  {
+    if (*p)
+      size += (*p)->memory_usage();
+  }
+
+  return size;
+}
+//-----------------------------------------------------------------------------
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <array>
 #include <dolfinx/common/MPI.h>
 #include <memory>
 #include <utility>
@@ -28,6 +29,15 @@ namespace dolfinx::la
 
 /// This class provides a sparsity pattern data structure that can be
 /// used to initialize sparse matrices.
+///
+/// The pattern can be built in one or two passes. In a single pass,
+/// the inserted column indices are cached in a growing list for each
+/// row. In the two-pass mode (SparsityPattern::count_begin and
+/// SparsityPattern::count_end), the first pass only counts the
+/// insertions for each row, and the second pass inserts into
+/// preallocated compressed row storage that is compacted in place by
+/// SparsityPattern::assemble. This reduces the peak memory for
+/// patterns with many duplicate entries, e.g. for high-order elements.
 
 class SparsityPattern
 {
@@ -96,12 +106,37 @@ public:
   ///   indices must exist in the row IndexMap.
   void insert_diagonal(const std::vector<std::int32_t>& rows);
 
+  /// Start the first (counting) pass of a two-pass construction. Until
+  /// SparsityPattern::count_end is called, SparsityPattern::insert and
+  /// SparsityPattern::insert_diagonal count the number of column
+  /// indices for each row without storing them. Must be called before
+  /// any insertion.
+  void count_begin();
+
+  /// End the first pass of a two-pass construction and allocate
+  /// compressed storage for the rows from the counts. The counts of
+  /// ghost rows are added to the counts of the owned rows by the row
+  /// owner. Insertions in the second pass that exceed the counts
+  /// revert the pattern to the storage of the single pass mode.
+  /// @note Collective
+  void count_end();
+
   /// Finalize sparsity pattern and communicate off-process entries
-  void assemble();
+  /// @param[in] num_threads The number of threads used to sort and
+  /// remove duplicate column indices in the rows
+  void assemble(int num_threads = 1);
 
   /// Return number of local nonzeros
   std::int64_t num_nonzeros() const;
 
+  /// Number of non-zeros in the upper triangle (global column index
+  /// greater than or equal to the global row index) of each owned row,
+  /// as required for symmetric matrix storage. The row and column index
+  /// maps must have the same local ranges.
+  /// @return The number of upper triangular non-zeros in each owned row
+  /// of the diagonal (0) and off-diagonal (1) blocks
+  std::array<std::vector<std::int32_t>, 2> num_nonzeros_upper() const;
+
   /// Sparsity pattern for the owned (diagonal) block. Uses local
   /// indices for the columns.
   const graph::AdjacencyList<std::int32_t>& diagonal_pattern() const;
@@ -110,10 +145,32 @@ public:
   /// indices for the columns. Translate to global with column IndexMap.
   const graph::AdjacencyList<std::int32_t>& off_diagonal_pattern() const;
 
+  /// Sparsity pattern for the ghost (un-owned) rows, i.e. the entries
+  /// that are sent to the row owner by SparsityPattern::assemble. Row
+  /// `i` corresponds to the `i`th ghost in the row IndexMap. Uses local
+  /// indices for the columns.
+  const graph::AdjacencyList<std::int32_t>& ghost_row_pattern() const;
+
   /// Return MPI communicator
   MPI_Comm mpi_comm() const;
 
+  /// Return the memory allocated by the sparsity pattern, i.e. by the
+  /// caches of unassembled entries and by the finalised pattern. The
+  /// index maps are not included, see common::IndexMap::memory_usage.
+  /// @return The number of bytes
+  std::size_t memory_usage() const;
+
 private:
+  // Insert column indices into a row (owned or ghost)
+  void insert_row(std::int32_t row, const xtl::span<const std::int32_t>& cols);
+
+  // Move the compressed cache of a two-pass construction into per-row
+  // storage
+  void decompress();
+
+  // Cached (unassembled) column indices of a row (owned or ghost)
+  xtl::span<const std::int32_t> cached_row(std::int32_t row) const;
+
   // MPI communicator
   dolfinx::MPI::Comm _mpi_comm;
 
@@ -128,8 +185,23 @@ private:
   std::vector<std::vector<std::int32_t>> _cache_owned;
   std::vector<std::vector<std::int32_t>> _cache_unowned;
 
+  // Number of insertions for each row (owned and ghost) in the
+  // counting pass of a two-pass construction. Repeated insertions are
+  // counted, so 64-bit integers are used.
+  std::vector<std::int64_t> _row_counts;
+  bool _counting = false;
+
+  // Compressed cache for the entries on owned and ghost rows in the
+  // second pass of a two-pass construction. Row i has capacity
+  // [_cache_offsets[i], _cache_offsets[i + 1]) and its entries are in
+  // [_cache_offsets[i], _cache_pos[i]). The cache holds duplicate
+  // entries, so the offsets are 64-bit integers.
+  std::vector<std::int32_t> _cache_data;
+  std::vector<std::int64_t> _cache_offsets, _cache_pos;
+
   // Sparsity pattern data (computed once pattern is finalised)
   std::shared_ptr<graph::AdjacencyList<std::int32_t>> _diagonal;
   std::shared_ptr<graph::AdjacencyList<std::int32_t>> _off_diagonal;
+  std::shared_ptr<graph::AdjacencyList<std::int32_t>> _ghost_rows;
 };
 } // namespace dolfinx::la
@@ -6,51 +6,179 @@
 
 #pragma once
 
+#include "Reduction.h"
 #include "utils.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <complex>
 #include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/Scatterer.h>
+#include <dolfinx/common/cpu.h>
 #include <limits>
 #include <memory>
 #include <numeric>
+#include <stdexcept>
+#include <type_traits>
 #include <vector>
 #include <xtl/xspan.hpp>
 
+#ifdef XTENSOR_USE_XSIMD
+#include <xsimd/xsimd.hpp>
+#endif
+
 namespace dolfinx::la
 {
 
+namespace impl
+{
+/// Compute r[i] = op(x[i], y[i]) for i < n. For real types, the
+/// operation is applied to SIMD batches if xsimd is available, so `op`
+/// must be a generic callable that supports scalars and batches.
+template <typename T, typename Op>
+void transform(T* r, const T* x, const T* y, std::size_t n, Op op)
+{
+  std::size_t i = 0;
+#ifdef XTENSOR_USE_XSIMD
+  if constexpr (std::is_floating_point_v<T>)
+  {
+    using b_type = xsimd::simd_type<T>;
+    constexpr std::size_t simd_size = b_type::size;
+    for (; i + simd_size <= n; i += simd_size)
+    {
+      const b_type xb = xsimd::load_unaligned(x + i);
+      const b_type yb = xsimd::load_unaligned(y + i);
+      xsimd::store_unaligned(r + i, op(xb, yb));
+    }
+  }
+#endif
+  for (; i < n; ++i)
+    r[i] = op(x[i], y[i]);
+}
+
+/// Compute the sum of op(x[i], y[i]) for i < n. For real types, the
+/// operation is applied to SIMD batches if xsimd is available.
+template <typename T, typename Op>
+T transform_reduce(const T* x, const T* y, std::size_t n, Op op)
+{
+  std::size_t i = 0;
+  T sum = 0;
+#ifdef XTENSOR_USE_XSIMD
+  if constexpr (std::is_floating_point_v<T>)
+  {
+    using b_type = xsimd::simd_type<T>;
+    constexpr std::size_t simd_size = b_type::size;
+    b_type sum_b(T(0));
+    for (; i + simd_size <= n; i += simd_size)
+    {
+      sum_b += op(xsimd::load_unaligned(x + i), xsimd::load_unaligned(y + i));
+    }
+    sum = xsimd::hadd(sum_b);
+  }
+#endif
+  for (; i < n; ++i)
+    sum += op(x[i], y[i]);
+  return sum;
+}
+
+/// Compute the sum of conj(x[i]) * y[i] for i < n. For double and
+/// float, the kernel that is compiled for the instruction set of the
+/// CPU is used (see cpu::dot).
+template <typename T>
+T dot(const T* x, const T* y, std::size_t n)
+{
+  if constexpr (std::is_same_v<T, double> or std::is_same_v<T, float>)
+    return cpu::dot(x, y, n);
+  else if constexpr (std::is_floating_point_v<T>)
+    return transform_reduce(x, y, n, [](auto x, auto y) { return x * y; });
+  else
+  {
+    T sum = 0;
+    for (std::size_t i = 0; i < n; ++i)
+      sum += std::conj(x[i]) * y[i];
+    return sum;
+  }
+}
+
+/// Compute r[i] = alpha * x[i] + y[i] for i < n. For double and float,
+/// the kernel that is compiled for the instruction set of the CPU is
+/// used (see cpu::axpy).
+template <typename T>
+void axpy(T* r, T alpha, const T* x, const T* y, std::size_t n)
+{
+  if constexpr (std::is_same_v<T, double> or std::is_same_v<T, float>)
+    cpu::axpy(r, alpha, x, y, n);
+  else
+    impl::transform(r, x, y, n,
+                    [alpha](auto x, auto y) { return alpha * x + y; });
+}
+} // namespace impl
+
 /// Distributed vector
 
 template <typename T, class Allocator = std::allocator<T>>
 class Vector
 {
 public:
+  /// \cond DO_NOT_DOCUMENT
+  using value_type = T;
+  using allocator_type = Allocator;
+  /// \endcond
+
   /// Create a distributed vector
+  /// @param[in] map The index map that describes the parallel layout
+  /// @param[in] bs The block size
+  /// @param[in] alloc The memory allocator for the data and for the
+  /// ghost update buffers
   Vector(const std::shared_ptr<const common::IndexMap>& map, int bs,
          const Allocator& alloc = Allocator())
       : _map(map), _bs(bs),
+        _scatterer(
+            std::make_shared<common::Scatterer<T, Allocator>>(map, bs, alloc)),
         _x(bs * (map->size_local() + map->num_ghosts()), alloc)
   {
-    if (bs == 1)
-      _datatype = MPI::mpi_type<T>();
-    else
-    {
-      MPI_Type_contiguous(bs, dolfinx::MPI::mpi_type<T>(), &_datatype);
-      MPI_Type_commit(&_datatype);
-    }
   }
 
-  /// Copy constructor
-  Vector(const Vector& x) = default;
+  /// Create a distributed vector that shares the plan and buffers for
+  /// ghost updates with other vectors, e.g. the vectors of a
+  /// la::VectorPool
+  /// @note The ghost updates of vectors that share a scatterer must not
+  /// overlap, i.e. the update of a vector must end before the update of
+  /// another vector begins.
+  /// @param[in] map The index map that describes the parallel layout
+  /// @param[in] bs The block size
+  /// @param[in] scatterer The scatterer for the ghost updates, which
+  /// must have been created for @p map and @p bs
+  /// @param[in] alloc The memory allocator for the data
+  Vector(const std::shared_ptr<const common::IndexMap>& map, int bs,
+         std::shared_ptr<common::Scatterer<T, Allocator>> scatterer,
+         const Allocator& alloc = Allocator())
+      : _map(map), _bs(bs), _scatterer(scatterer),
+        _x(bs * (map->size_local() + map->num_ghosts()), alloc)
+  {
+    assert(_scatterer);
+  }
+
+  /// Copy constructor. The copy has its own ghost update buffers.
+  /// @note Collective MPI operation if shared memory ghost updates are
+  /// enabled for `x`
+  Vector(const Vector& x)
+      : _map(x._map), _bs(x._bs), _x(x._x), _version(x._version)
+  {
+    _scatterer = std::make_shared<common::Scatterer<T, Allocator>>(
+        _map, _bs, _x.get_allocator());
+    if (x._scatterer->shared_memory())
+      _scatterer->enable_shared_memory();
+  }
 
   /// Move constructor
   Vector(Vector&& x) noexcept = default;
 
   /// Destructor
-  ~Vector()
-  {
-    if (_datatype and _datatype != MPI::mpi_type<T>())
-      MPI_Type_free(&_datatype);
-  }
+  /// @note Collective MPI operation on the ranks of the node if this is
+  /// the last vector that holds a scatterer with shared memory enabled,
+  /// see common::Scatterer::~Scatterer
+  ~Vector() = default;
 
   // Assignment operator (disabled)
   Vector& operator=(const Vector& x) = delete;
@@ -58,26 +186,60 @@ public:
   /// Move Assignment operator
   Vector& operator=(Vector&& x) = default;
 
+  /// Update ghosts of ranks on the same node through shared memory
+  /// windows, and with messages only for ranks on other nodes. See
+  /// common::Scatterer::enable_shared_memory.
+  /// @note Collective MPI operation
+  /// @note The destruction of the vector then becomes a collective
+  /// operation on the ranks of the node
+  void enable_shared_memory_scatter() { _scatterer->enable_shared_memory(); }
+
   /// Begin scatter of local data from owner to ghosts on other ranks
   /// @note Collective MPI operation
+  /// @note The ghost entries must not be accessed until
+  /// Vector::scatter_fwd_end is called. If the ghosts are sorted by
+  /// owner, they are received in place.
   void scatter_fwd_begin()
+  {
+    this->scatter_fwd_begin(common::Scatterer<T, Allocator>::gather);
+  }
+
+  /// Begin scatter of local data from owner to ghosts on other ranks,
+  /// with a custom function to pack the send buffer, e.g. a device
+  /// kernel if the Allocator provides device-accessible memory. See
+  /// common::Scatterer::scatter_fwd_begin.
+  /// @note Collective MPI operation
+  /// @param[in] pack The function that packs the send buffer
+  template <typename Functor>
+  void scatter_fwd_begin(Functor pack)
   {
     assert(_map);
     const std::int32_t local_size = _bs * _map->size_local();
     xtl::span<const T> xlocal(_x.data(), local_size);
-    _map->scatter_fwd_begin(xlocal, _datatype, _request, _buffer_send_fwd,
-                            _buffer_recv_fwd);
+    xtl::span xremote(_x.data() + local_size, _map->num_ghosts() * _bs);
+    _scatterer->scatter_fwd_begin(xlocal, xremote, pack);
   }
 
   /// End scatter of local data from owner to ghosts on other ranks
   /// @note Collective MPI operation
   void scatter_fwd_end()
+  {
+    this->scatter_fwd_end(common::Scatterer<T, Allocator>::gather);
+  }
+
+  /// End scatter of local data from owner to ghosts on other ranks,
+  /// with a custom function to unpack the receive buffer. See
+  /// common::Scatterer::scatter_fwd_end.
+  /// @note Collective MPI operation
+  /// @param[in] unpack The function that unpacks the receive buffer
+  template <typename Functor>
+  void scatter_fwd_end(Functor unpack)
   {
     assert(_map);
     const std::int32_t local_size = _bs * _map->size_local();
     xtl::span xremote(_x.data() + local_size, _map->num_ghosts() * _bs);
-    _map->scatter_fwd_end(xremote, _request,
-                          xtl::span<const T>(_buffer_recv_fwd));
+    _scatterer->scatter_fwd_end(xremote, unpack);
+    ++_version;
   }
 
   /// Scatter local data to ghost positions on other ranks
@@ -91,12 +253,21 @@ public:
   /// Start scatter of  ghost data to owner
   /// @note Collective MPI operation
   void scatter_rev_begin()
+  {
+    this->scatter_rev_begin(common::Scatterer<T, Allocator>::scatter);
+  }
+
+  /// Start scatter of ghost data to owner, with a custom function to
+  /// pack the send buffer. See common::Scatterer::scatter_rev_begin.
+  /// @note Collective MPI operation
+  /// @param[in] pack The function that packs the send buffer
+  template <typename Functor>
+  void scatter_rev_begin(Functor pack)
   {
     const std::int32_t local_size = _bs * _map->size_local();
     xtl::span<const T> xremote(_x.data() + local_size,
                                _map->num_ghosts() * _bs);
-    _map->scatter_rev_begin(xremote, _datatype, _request, _buffer_recv_fwd,
-                            _buffer_send_fwd);
+    _scatterer->scatter_rev_begin(xremote, pack);
   }
 
   /// End scatter of ghost data to owner. This process may receive data from
@@ -106,11 +277,23 @@ public:
   /// values (add or insert)
   /// @note Collective MPI operation
   void scatter_rev_end(dolfinx::common::IndexMap::Mode op)
+  {
+    this->scatter_rev_end(op, common::Scatterer<T, Allocator>::scatter);
+  }
+
+  /// End scatter of ghost data to owner, with a custom function to
+  /// unpack the receive buffer. See common::Scatterer::scatter_rev_end.
+  /// @param[in] op The operation to perform when adding/setting
+  /// received values (add or insert)
+  /// @param[in] unpack The function that unpacks the receive buffer
+  /// @note Collective MPI operation
+  template <typename Functor>
+  void scatter_rev_end(dolfinx::common::IndexMap::Mode op, Functor unpack)
   {
     const std::int32_t local_size = _bs * _map->size_local();
     xtl::span xlocal(_x.data(), local_size);
-    _map->scatter_rev_end(xlocal, _request,
-                          xtl::span<const T>(_buffer_send_fwd), op);
+    _scatterer->scatter_rev_end(xlocal, op, unpack);
+    ++_version;
   }
 
   /// Scatter ghost data to owner. This process may receive data from
@@ -126,16 +309,42 @@ public:
 
   /// Compute the norm of the vector
   /// @note Collective MPI operation
-  /// @param type Norm type (supported types are \f$L^2\f$ and \f$L^\infty\f$)
+  /// @param type Norm type (supported types are \f$L^1\f$, \f$L^2\f$
+  /// and \f$L^\infty\f$)
   T norm(la::Norm type = la::Norm::l2) const
   {
     switch (type)
     {
+    case la::Norm::l1:
+    {
+      const std::int32_t size_local = _bs * _map->size_local();
+      double local_l1 = 0.0;
+      if constexpr (std::is_floating_point_v<T>)
+      {
+        local_l1 = impl::transform_reduce(
+            _x.data(), _x.data(), size_local,
+            [](auto x, auto)
+            {
+              using std::abs;
+              return abs(x);
+            });
+      }
+      else
+      {
+        for (std::int32_t i = 0; i < size_local; ++i)
+          local_l1 += std::abs(_x[i]);
+      }
+
+      double l1 = 0.0;
+      MPI_Allreduce(&local_l1, &l1, 1, MPI_DOUBLE, MPI_SUM,
+                    _map->comm(common::IndexMap::Direction::forward));
+      return l1;
+    }
     case la::Norm::l2:
       return std::sqrt(this->squared_norm());
     case la::Norm::linf:
     {
-      const std::int32_t size_local = _map->size_local();
+      const std::int32_t size_local = _bs * _map->size_local();
       double local_linf = 0.0;
       if (size_local > 0)
       {
@@ -159,10 +368,19 @@ public:
   /// @note Collective MPI operation
   double squared_norm() const
   {
-    const std::int32_t size_local = _map->size_local();
-    double result = std::transform_reduce(
-        _x.begin(), std::next(_x.begin(), size_local), 0.0, std::plus<double>(),
-        [](T val) { return std::norm(val); });
+    const std::int32_t size_local = _bs * _map->size_local();
+    double result = 0.0;
+    if constexpr (std::is_floating_point_v<T>)
+    {
+      result = impl::transform_reduce(_x.data(), _x.data(), size_local,
+                                      [](auto x, auto y) { return x * y; });
+    }
+    else
+    {
+      result = std::transform_reduce(
+          _x.begin(), std::next(_x.begin(), size_local), 0.0,
+          std::plus<double>(), [](T val) { return std::norm(val); });
+    }
     double norm2;
     MPI_Allreduce(&result, &norm2, 1, MPI_DOUBLE, MPI_SUM,
                   _map->comm(common::IndexMap::Direction::forward));
@@ -178,8 +396,37 @@ public:
   /// Get local part of the vector (const version)
   const std::vector<T, Allocator>& array() const { return _x; }
 
-  /// Get local part of the vector
-  std::vector<T, Allocator>& mutable_array() { return _x; }
+  /// Get the allocator of the vector data
+  allocator_type get_allocator() const { return _x.get_allocator(); }
+
+  /// Get local part of the vector. Increments the version of the
+  /// vector.
+  std::vector<T, Allocator>& mutable_array()
+  {
+    ++_version;
+    return _x;
+  }
+
+  /// Version of the vector data. The version is incremented when
+  /// mutable access to the data is requested and when ghost values are
+  /// updated. It can be used to detect if the vector may have changed.
+  /// @note Modifications through a reference obtained before the last
+  /// version increment are not detected. Call
+  /// Vector::increment_version after such modifications.
+  std::uint64_t version() const { return _version; }
+
+  /// Increment the version of the vector data, see Vector::version
+  void increment_version() { ++_version; }
+
+  /// Return the memory allocated by the vector, i.e. by the data and
+  /// the buffers for ghost updates. The index map is not included, see
+  /// common::IndexMap::memory_usage. Buffers that are shared with other
+  /// vectors are included.
+  /// @return The number of bytes
+  std::size_t memory_usage() const
+  {
+    return _x.capacity() * sizeof(T) + _scatterer->memory_usage();
+  }
 
 private:
   // Map describing the data layout
@@ -188,13 +435,15 @@ private:
   // Block size
   int _bs;
 
-  // Data type and buffers for ghost scatters
-  MPI_Datatype _datatype = MPI_DATATYPE_NULL;
-  MPI_Request _request = MPI_REQUEST_NULL;
-  std::vector<T> _buffer_send_fwd, _buffer_recv_fwd;
+  // Plan and buffers for ghost updates, which may be shared with other
+  // vectors
+  std::shared_ptr<common::Scatterer<T, Allocator>> _scatterer;
 
   // Data
   std::vector<T, Allocator> _x;
+
+  // Data version
+  std::uint64_t _version = 0;
 };
 
 /// Compute the inner product of two vectors. The two vectors must have
@@ -209,20 +458,7 @@ T inner_product(const Vector<T, Allocator>& a, const Vector<T, Allocator>& b)
   const std::int32_t local_size = a.bs() * a.map()->size_local();
   if (local_size != b.bs() * b.map()->size_local())
     throw std::runtime_error("Incompatible vector sizes");
-  const std::vector<T>& x_a = a.array();
-  const std::vector<T>& x_b = b.array();
-
-  const T local = std::transform_reduce(
-      x_a.begin(), x_a.begin() + local_size, x_b.begin(), static_cast<T>(0),
-      std::plus<T>(),
-      [](T a, T b) -> T
-      {
-        if constexpr (std::is_same<T, std::complex<double>>::value
-                      or std::is_same<T, std::complex<float>>::value)
-          return std::conj(a) * b;
-        else
-          return a * b;
-      });
+  const T local = impl::dot(a.array().data(), b.array().data(), local_size);
 
   T result;
   MPI_Allreduce(&local, &result, 1, dolfinx::MPI::mpi_type<T>(), MPI_SUM,
@@ -230,4 +466,272 @@ T inner_product(const Vector<T, Allocator>& a, const Vector<T, Allocator>& b)
   return result;
 }
 
+/// Start the computation of the inner products of several pairs of
+/// vectors, with a single pass over the vector data and a single
+/// non-blocking global reduction. The vectors of each pair must have
+/// the same parallel layout, and all vectors must share the
+/// communicator of the first vector. Squared norms are computed with
+/// pairs `{&x, &x}`.
+///
+/// The local inner products are accumulated block-by-block, so that
+/// a vector that appears in several pairs is read from memory only
+/// once.
+/// @note Collective
+/// @param[in] pairs The pairs of vectors `{a_k, b_k}`
+/// @return Handle to the reduction, with `a_k^{H} b_k` in position `k`
+/// after Reduction::wait
+template <typename T, class Allocator = std::allocator<T>>
+Reduction<T> inner_products_begin(
+    const std::vector<std::array<const Vector<T, Allocator>*, 2>>& pairs)
+{
+  if (pairs.empty())
+    return Reduction<T>(MPI_COMM_NULL, {});
+
+  const std::int32_t local_size
+      = pairs[0][0]->bs() * pairs[0][0]->map()->size_local();
+  for (auto& p : pairs)
+  {
+    if (p[0]->bs() * p[0]->map()->size_local() != local_size
+        or p[1]->bs() * p[1]->map()->size_local() != local_size)
+    {
+      throw std::runtime_error("Incompatible vector sizes");
+    }
+  }
+
+  constexpr std::int32_t block = 1024;
+  std::vector<T> local(pairs.size(), 0);
+  for (std::int32_t i0 = 0; i0 < local_size; i0 += block)
+  {
+    const std::int32_t n = std::min(block, local_size - i0);
+    for (std::size_t k = 0; k < pairs.size(); ++k)
+    {
+      local[k] += impl::dot(pairs[k][0]->array().data() + i0,
+                            pairs[k][1]->array().data() + i0, n);
+    }
+  }
+
+  return Reduction<T>(
+      pairs[0][0]->map()->comm(common::IndexMap::Direction::forward),
+      std::move(local));
+}
+
+/// Compute the inner products of several pairs of vectors with a single
+/// global reduction, see la::inner_products_begin
+/// @note Collective
+/// @param[in] pairs The pairs of vectors `{a_k, b_k}`
+/// @return The inner products `a_k^{H} b_k`
+template <typename T, class Allocator = std::allocator<T>>
+std::vector<T> inner_products(
+    const std::vector<std::array<const Vector<T, Allocator>*, 2>>& pairs)
+{
+  return inner_products_begin(pairs).wait();
+}
+
+/// @cond
+namespace impl
+{
+// Check that two vectors have the same layout and return the size of
+// their arrays (owned and ghost entries)
+template <typename T, class AllocatorT, typename U, class AllocatorU>
+std::size_t check_layout(const Vector<T, AllocatorT>& x,
+                         const Vector<U, AllocatorU>& y)
+{
+  if (x.bs() * x.map()->size_local() != y.bs() * y.map()->size_local()
+      or x.array().size() != y.array().size())
+  {
+    throw std::runtime_error("Incompatible vector sizes");
+  }
+  return x.array().size();
+}
+} // namespace impl
+/// @endcond
+
+// The BLAS-1 operations below are applied to both the owned and the
+// ghost entries, so that ghost entries that are up-to-date remain
+// up-to-date without communication.
+
+/// Compute y = alpha x + y
+/// @param[in,out] y The result
+/// @param[in] alpha The scalar
+/// @param[in] x A vector with the same layout as @p y
+template <typename T, class Allocator>
+void axpy(Vector<T, Allocator>& y, T alpha, const Vector<T, Allocator>& x)
+{
+  const std::size_t n = impl::check_layout(x, y);
+  T* _y = y.mutable_array().data();
+  impl::axpy(_y, alpha, x.array().data(), _y, n);
+}
+
+/// Compute y = alpha x + beta y
+/// @param[in,out] y The result
+/// @param[in] alpha The scalar for @p x
+/// @param[in] x A vector with the same layout as @p y
+/// @param[in] beta The scalar for @p y
+template <typename T, class Allocator>
+void axpby(Vector<T, Allocator>& y, T alpha, const Vector<T, Allocator>& x,
+           T beta)
+{
+  const std::size_t n = impl::check_layout(x, y);
+  T* _y = y.mutable_array().data();
+  impl::transform(_y, x.array().data(), _y, n,
+                  [alpha, beta](auto x, auto y)
+                  { return alpha * x + beta * y; });
+}
+
+/// Compute w = alpha x + y
+/// @param[out] w The result
+/// @param[in] alpha The scalar
+/// @param[in] x A vector with the same layout as @p w
+/// @param[in] y A vector with the same layout as @p w
+template <typename T, class Allocator>
+void waxpy(Vector<T, Allocator>& w, T alpha, const Vector<T, Allocator>& x,
+           const Vector<T, Allocator>& y)
+{
+  const std::size_t n = impl::check_layout(x, w);
+  impl::check_layout(y, w);
+  impl::axpy(w.mutable_array().data(), alpha, x.array().data(),
+             y.array().data(), n);
+}
+
+/// Compute the linear combination y = sum_i alpha_i x_i in a single
+/// pass over the vectors, e.g. for the stage updates of Runge-Kutta and
+/// BDF schemes. The sum is accumulated block-by-block in a buffer, so
+/// that each vector is read once, y is written once, and @p y may also
+/// be one of the vectors @p x.
+/// @param[out] y The result
+/// @param[in] alpha The coefficients
+/// @param[in] x Vectors with the same layout as @p y, with the same
+/// number of vectors as coefficients
+template <typename T, class Allocator>
+void linear_combination(Vector<T, Allocator>& y, const std::vector<T>& alpha,
+                        const std::vector<const Vector<T, Allocator>*>& x)
+{
+  if (alpha.size() != x.size())
+    throw std::runtime_error("Number of coefficients and vectors differ");
+  const std::size_t n = y.array().size();
+  for (auto xi : x)
+    impl::check_layout(*xi, y);
+
+  T* _y = y.mutable_array().data();
+  if (x.empty())
+  {
+    std::fill_n(_y, n, T(0));
+    return;
+  }
+
+  constexpr std::size_t block = 1024;
+  std::array<T, block> sum;
+  for (std::size_t i0 = 0; i0 < n; i0 += block)
+  {
+    const std::size_t m = std::min(block, n - i0);
+    const T a0 = alpha[0];
+    const T* x0 = x[0]->array().data() + i0;
+    impl::transform(sum.data(), x0, x0, m,
+                    [a0](auto x, auto) { return a0 * x; });
+    for (std::size_t k = 1; k < x.size(); ++k)
+    {
+      impl::axpy(sum.data(), alpha[k], x[k]->array().data() + i0, sum.data(),
+                 m);
+    }
+    std::copy_n(sum.data(), m, _y + i0);
+  }
+}
+
+/// Compute x = alpha x
+/// @param[in,out] x The vector
+/// @param[in] alpha The scalar
+template <typename T, class Allocator>
+void scale(Vector<T, Allocator>& x, T alpha)
+{
+  T* _x = x.mutable_array().data();
+  impl::transform(_x, _x, _x, x.array().size(),
+                  [alpha](auto x, auto) { return alpha * x; });
+}
+
+/// Copy the values of a vector into a vector with another value type,
+/// e.g. to apply a single-precision preconditioner (la::Vector<float>,
+/// la::MatrixCSR<float>) inside a double-precision solver
+/// @param[out] y The result, with values `x` converted to `U`
+/// @param[in] x A vector with the same layout as @p y
+template <typename U, class AllocatorU, typename T, class AllocatorT>
+void copy(Vector<U, AllocatorU>& y, const Vector<T, AllocatorT>& x)
+{
+  const std::size_t n = impl::check_layout(x, y);
+  const T* _x = x.array().data();
+  U* _y = y.mutable_array().data();
+  for (std::size_t i = 0; i < n; ++i)
+    _y[i] = static_cast<U>(_x[i]);
+}
+
+/// Compute the pointwise product w[i] = x[i] * y[i]
+/// @param[out] w The result
+/// @param[in] x A vector with the same layout as @p w
+/// @param[in] y A vector with the same layout as @p w
+template <typename T, class Allocator>
+void pointwise_mult(Vector<T, Allocator>& w, const Vector<T, Allocator>& x,
+                    const Vector<T, Allocator>& y)
+{
+  const std::size_t n = impl::check_layout(x, w);
+  impl::check_layout(y, w);
+  impl::transform(w.mutable_array().data(), x.array().data(),
+                  y.array().data(), n,
+                  [](auto x, auto y) { return x * y; });
+}
+
+/// Compute the pointwise quotient w[i] = x[i] / y[i]
+/// @param[out] w The result
+/// @param[in] x A vector with the same layout as @p w
+/// @param[in] y A vector with the same layout as @p w. The owned
+/// entries must be non-zero.
+template <typename T, class Allocator>
+void pointwise_divide(Vector<T, Allocator>& w, const Vector<T, Allocator>& x,
+                      const Vector<T, Allocator>& y)
+{
+  const std::size_t n = impl::check_layout(x, w);
+  impl::check_layout(y, w);
+  impl::transform(w.mutable_array().data(), x.array().data(),
+                  y.array().data(), n,
+                  [](auto x, auto y) { return x / y; });
+}
+
+/// Compute the maximum of the (owned) entries of a real vector
+/// @note Collective MPI operation
+/// @param[in] x The vector
+/// @return The maximum entry
+template <typename T, class Allocator>
+T max(const Vector<T, Allocator>& x)
+{
+  static_assert(std::is_floating_point_v<T>, "Vector must be real.");
+  const std::vector<T, Allocator>& _x = x.array();
+  const std::int32_t size_local = x.bs() * x.map()->size_local();
+  T local = std::numeric_limits<T>::lowest();
+  if (size_local > 0)
+    local = *std::max_element(_x.begin(), std::next(_x.begin(), size_local));
+
+  T result;
+  MPI_Allreduce(&local, &result, 1, dolfinx::MPI::mpi_type<T>(), MPI_MAX,
+                x.map()->comm(common::IndexMap::Direction::forward));
+  return result;
+}
+
+/// Compute the minimum of the (owned) entries of a real vector
+/// @note Collective MPI operation
+/// @param[in] x The vector
+/// @return The minimum entry
+template <typename T, class Allocator>
+T min(const Vector<T, Allocator>& x)
+{
+  static_assert(std::is_floating_point_v<T>, "Vector must be real.");
+  const std::vector<T, Allocator>& _x = x.array();
+  const std::int32_t size_local = x.bs() * x.map()->size_local();
+  T local = std::numeric_limits<T>::max();
+  if (size_local > 0)
+    local = *std::min_element(_x.begin(), std::next(_x.begin(), size_local));
+
+  T result;
+  MPI_Allreduce(&local, &result, 1, dolfinx::MPI::mpi_type<T>(), MPI_MIN,
+                x.map()->comm(common::IndexMap::Direction::forward));
+  return result;
+}
+
 } // namespace dolfinx::la
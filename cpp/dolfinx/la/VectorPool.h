@@ -0,0 +1,143 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include "Vector.h"
+#include <cstddef>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/Scatterer.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace dolfinx::la
+{
+
+/// A pool of distributed vectors with the same parallel layout, e.g.
+/// for the stage and history vectors of multi-stage time integrators.
+///
+/// Vectors are handed out by VectorPool::get and are returned to the
+/// pool when the last reference to them is released, so that repeated
+/// temporaries re-use the same memory rather than allocating new
+/// vectors. The vectors share the plan and buffers for ghost updates,
+/// so the ghost updates of vectors of a pool must not overlap (see
+/// Vector::Vector). A pooled vector can be used as the vector of a
+/// fem::Function on a space with the same dofmap.
+///
+/// The pool may be destroyed before the vectors that it handed out,
+/// which are then freed when they are released.
+template <typename T, class Allocator = std::allocator<T>>
+class VectorPool
+{
+public:
+  /// Create an empty pool
+  /// @param[in] map The index map that describes the parallel layout
+  /// @param[in] bs The block size
+  /// @param[in] alloc The memory allocator for the vectors
+  VectorPool(const std::shared_ptr<const common::IndexMap>& map, int bs,
+             const Allocator& alloc = Allocator())
+      : _map(map), _bs(bs), _alloc(alloc),
+        _scatterer(
+            std::make_shared<common::Scatterer<T, Allocator>>(map, bs, alloc)),
+        _state(std::make_shared<State>())
+  {
+  }
+
+  /// Copy constructor (deleted)
+  VectorPool(const VectorPool& pool) = delete;
+
+  /// Move constructor
+  VectorPool(VectorPool&& pool) = default;
+
+  /// Destructor
+  ~VectorPool() = default;
+
+  /// Assignment operator (deleted)
+  VectorPool& operator=(const VectorPool& pool) = delete;
+
+  /// Move assignment
+  VectorPool& operator=(VectorPool&& pool) = default;
+
+  /// Get a vector from the pool, or a new vector if the pool is empty
+  /// @note The values of a re-used vector are those of its previous
+  /// use, and the vector is not zeroed
+  /// @note Thread safe
+  /// @return The vector, which is returned to the pool when the last
+  /// reference to it is released
+  std::shared_ptr<Vector<T, Allocator>> get()
+  {
+    std::unique_ptr<Vector<T, Allocator>> x;
+    {
+      std::lock_guard<std::mutex> lock(_state->mutex);
+      if (!_state->free.empty())
+      {
+        x = std::move(_state->free.back());
+        _state->free.pop_back();
+      }
+    }
+
+    if (!x)
+    {
+      x = std::make_unique<Vector<T, Allocator>>(_map, _bs, _scatterer,
+                                                 _alloc);
+    }
+
+    std::weak_ptr<State> state = _state;
+    return std::shared_ptr<Vector<T, Allocator>>(
+        x.release(),
+        [state](Vector<T, Allocator>* x)
+        {
+          std::unique_ptr<Vector<T, Allocator>> _x(x);
+          if (std::shared_ptr<State> s = state.lock(); s)
+          {
+            std::lock_guard<std::mutex> lock(s->mutex);
+            s->free.push_back(std::move(_x));
+          }
+        });
+  }
+
+  /// Number of vectors that are held by the pool for re-use
+  std::size_t size() const
+  {
+    std::lock_guard<std::mutex> lock(_state->mutex);
+    return _state->free.size();
+  }
+
+  /// Free the vectors that are held by the pool for re-use
+  void clear()
+  {
+    std::lock_guard<std::mutex> lock(_state->mutex);
+    _state->free.clear();
+  }
+
+  /// Get IndexMap
+  std::shared_ptr<const common::IndexMap> map() const { return _map; }
+
+  /// Get block size
+  int bs() const { return _bs; }
+
+private:
+  // Layout and allocator of the vectors
+  std::shared_ptr<const common::IndexMap> _map;
+  int _bs;
+  Allocator _alloc;
+
+  // Plan and buffers for ghost updates, shared by the vectors
+  std::shared_ptr<common::Scatterer<T, Allocator>> _scatterer;
+
+  // Vectors that are available for re-use. The state is shared with
+  // the deleters of the vectors that are in use, which do not return
+  // their vector once the pool is destroyed.
+  struct State
+  {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Vector<T, Allocator>>> free;
+  };
+  std::shared_ptr<State> _state;
+};
+
+} // namespace dolfinx::la
@@ -6,6 +6,7 @@
 
 #include "VectorSpaceBasis.h"
 #include "PETScVector.h"
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 
@@ -22,43 +23,60 @@ VectorSpaceBasis::VectorSpaceBasis(
 //-----------------------------------------------------------------------------
 void VectorSpaceBasis::orthonormalize(double tol)
 {
+  std::vector<Vec> basis(_basis.size());
+  std::transform(_basis.begin(), _basis.end(), basis.begin(),
+                 [](auto& b)
+                 {
+                   assert(b);
+                   return b->vec();
+                 });
+
   // Loop over each vector in basis
-  for (std::size_t i = 0; i < _basis.size(); ++i)
+  std::vector<PetscScalar> dots(_basis.size()), alpha(_basis.size());
+  for (std::size_t i = 0; i < basis.size(); ++i)
   {
-    assert(_basis[i]);
     // Orthogonalize vector i with respect to previously orthonormalized
-    // vectors
-    for (std::size_t j = 0; j < i; ++j)
+    // vectors. The second pass also computes <x_i, x_i>, which gives
+    // the norm of the orthogonalized vector from Pythagoras' theorem.
+    PetscReal norm2 = 0.0;
+    for (int pass = 0; pass < 2; ++pass)
     {
-      PetscScalar dot_ij = 0.0;
-      VecDot(_basis[i]->vec(), _basis[j]->vec(), &dot_ij);
-      VecAXPY(_basis[i]->vec(), -dot_ij, _basis[j]->vec());
+      const int n = pass == 0 ? i : i + 1;
+      if (n > 0)
+        VecMDot(basis[i], n, basis.data(), dots.data());
+      std::transform(dots.begin(), std::next(dots.begin(), i), alpha.begin(),
+                     [](auto d) { return -d; });
+      if (i > 0)
+        VecMAXPY(basis[i], i, alpha.data(), basis.data());
+      if (pass == 1)
+      {
+        norm2 = PetscRealPart(dots[i]);
+        for (std::size_t j = 0; j < i; ++j)
+          norm2 -= PetscRealPart(dots[j] * PetscConj(dots[j]));
+      }
     }
 
     // Normalise basis function
-    PetscReal norm = 0.0;
-    VecNormalize(_basis[i]->vec(), &norm);
+    const PetscReal norm = std::sqrt(std::max(norm2, PetscReal(0)));
     if (norm < tol)
     {
       throw std::runtime_error(
           "VectorSpaceBasis has linear dependency. Cannot orthogonalize.");
     }
+    VecScale(basis[i], 1.0 / norm);
   }
 }
 //-----------------------------------------------------------------------------
 bool VectorSpaceBasis::is_orthonormal(double tol) const
 {
-  for (std::size_t i = 0; i < _basis.size(); i++)
+  const std::vector<PetscScalar>& G = gram();
+  const std::size_t n = _basis.size();
+  for (std::size_t i = 0; i < n; i++)
   {
-    for (std::size_t j = i; j < _basis.size(); j++)
+    for (std::size_t j = i; j < n; j++)
     {
-      assert(_basis[i]);
-      assert(_basis[j]);
       const double delta_ij = (i == j) ? 1.0 : 0.0;
-      PetscScalar dot_ij = 0.0;
-      VecDot(_basis[i]->vec(), _basis[j]->vec(), &dot_ij);
-
-      if (std::abs(delta_ij - dot_ij) > tol)
+      if (std::abs(delta_ij - G[i * n + j]) > tol)
         return false;
     }
   }
@@ -68,19 +86,14 @@ bool VectorSpaceBasis::is_orthonormal(double tol) const
 //-----------------------------------------------------------------------------
 bool VectorSpaceBasis::is_orthogonal(double tol) const
 {
-  for (std::size_t i = 0; i < _basis.size(); i++)
+  const std::vector<PetscScalar>& G = gram();
+  const std::size_t n = _basis.size();
+  for (std::size_t i = 0; i < n; i++)
   {
-    for (std::size_t j = i; j < _basis.size(); j++)
+    for (std::size_t j = i + 1; j < n; j++)
     {
-      assert(_basis[i]);
-      assert(_basis[j]);
-      if (i != j)
-      {
-        PetscScalar dot_ij = 0.0;
-        VecDot(_basis[i]->vec(), _basis[j]->vec(), &dot_ij);
-        if (std::abs(dot_ij) > tol)
-          return false;
-      }
+      if (std::abs(G[i * n + j]) > tol)
+        return false;
     }
   }
 
@@ -90,37 +103,84 @@ bool VectorSpaceBasis::is_orthogonal(double tol) const
 bool VectorSpaceBasis::in_nullspace(const Mat A, double tol) const
 {
   assert(A);
+  if (_basis.empty())
+    return true;
+
   Vec y = nullptr;
   MatCreateVecs(A, nullptr, &y);
+  Vec* Ax = nullptr;
+  VecDuplicateVecs(y, _basis.size(), &Ax);
+  VecDestroy(&y);
 
-  bool in_space = true;
-  for (const auto& x : _basis)
+  // Compute the norms with one (split-phase) reduction
+  std::vector<PetscReal> norms(_basis.size());
+  for (std::size_t i = 0; i < _basis.size(); ++i)
   {
-    assert(x);
-    assert(x->vec());
-    MatMult(A, x->vec(), y);
-    PetscReal norm = 0.0;
-    VecNorm(y, NORM_2, &norm);
-    if (norm > tol)
-    {
-      in_space = false;
-      break;
-    }
+    assert(_basis[i]);
+    assert(_basis[i]->vec());
+    MatMult(A, _basis[i]->vec(), Ax[i]);
   }
+  for (std::size_t i = 0; i < _basis.size(); ++i)
+    VecNormBegin(Ax[i], NORM_2, &norms[i]);
+  for (std::size_t i = 0; i < _basis.size(); ++i)
+    VecNormEnd(Ax[i], NORM_2, &norms[i]);
 
-  VecDestroy(&y);
-  return in_space;
+  VecDestroyVecs(_basis.size(), &Ax);
+  return std::all_of(norms.begin(), norms.end(),
+                     [tol](auto norm) { return norm <= tol; });
 }
 //-----------------------------------------------------------------------------
 void VectorSpaceBasis::orthogonalize(PETScVector& x) const
 {
-  for (std::size_t i = 0; i < _basis.size(); i++)
+  if (_basis.empty())
+    return;
+
+  std::vector<Vec> basis(_basis.size());
+  std::transform(_basis.begin(), _basis.end(), basis.begin(),
+                 [](auto& b)
+                 {
+                   assert(b);
+                   return b->vec();
+                 });
+  std::vector<PetscScalar> dots(_basis.size());
+  for (int pass = 0; pass < 2; ++pass)
+  {
+    VecMDot(x.vec(), basis.size(), basis.data(), dots.data());
+    std::transform(dots.begin(), dots.end(), dots.begin(),
+                   [](auto d) { return -d; });
+    VecMAXPY(x.vec(), basis.size(), dots.data(), basis.data());
+  }
+}
+//-----------------------------------------------------------------------------
+const std::vector<PetscScalar>& VectorSpaceBasis::gram() const
+{
+  const std::size_t n = _basis.size();
+  std::vector<PetscObjectState> state(n);
+  for (std::size_t i = 0; i < n; ++i)
   {
     assert(_basis[i]);
-    PetscScalar dot = 0.0;
-    VecDot(_basis[i]->vec(), x.vec(), &dot);
-    VecAXPY(x.vec(), -dot, _basis[i]->vec());
+    PetscObjectStateGet((PetscObject)_basis[i]->vec(), &state[i]);
   }
+
+  if (state != _gram_state or _gram.size() != n * n)
+  {
+    // Compute the upper triangle with one (split-phase) reduction
+    _gram.resize(n * n);
+    for (std::size_t i = 0; i < n; ++i)
+      for (std::size_t j = i; j < n; ++j)
+        VecDotBegin(_basis[j]->vec(), _basis[i]->vec(), &_gram[i * n + j]);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      for (std::size_t j = i; j < n; ++j)
+      {
+        VecDotEnd(_basis[j]->vec(), _basis[i]->vec(), &_gram[i * n + j]);
+        _gram[j * n + i] = PetscConj(_gram[i * n + j]);
+      }
+    }
+    _gram_state = std::move(state);
+  }
+
+  return _gram;
 }
 //-----------------------------------------------------------------------------
 int VectorSpaceBasis::dim() const { return _basis.size(); }
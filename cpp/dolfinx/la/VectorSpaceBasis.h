@@ -36,6 +36,10 @@ public:
   /// Apply the Gram-Schmidt process to orthonormalize the basis. Throws
   /// an error if a (near) linear dependency is detected. Error is
   /// thrown if <x_i, x_i> < tol.
+  ///
+  /// Classical Gram-Schmidt with reorthogonalisation (CGS2) is used, so
+  /// that the inner products of each vector with the preceding vectors
+  /// are computed with one reduction per pass.
   void orthonormalize(double tol = 1.0e-10);
 
   /// Test if basis is orthonormal
@@ -44,10 +48,12 @@ public:
   /// Test if basis is orthogonal
   bool is_orthogonal(double tol = 1.0e-10) const;
 
-  /// Test if basis is in null space of A
+  /// Test if basis is in null space of A. The norms of A x_i are
+  /// computed with one reduction.
   bool in_nullspace(const Mat A, double tol = 1.0e-10) const;
 
-  /// Orthogonalize x with respect to basis
+  /// Orthogonalize x with respect to basis, using two passes of
+  /// classical Gram-Schmidt with one reduction per pass
   void orthogonalize(PETScVector& x) const;
 
   /// Number of vectors in the basis
@@ -57,6 +63,15 @@ public:
   std::shared_ptr<const PETScVector> operator[](int i) const;
 
 private:
+  // Return the Gram matrix (row-major) of the basis. It is cached, and
+  // recomputed (with one reduction) if a basis vector has changed.
+  const std::vector<PetscScalar>& gram() const;
+
   const std::vector<std::shared_ptr<PETScVector>> _basis;
+
+  // Cached Gram matrix, and the state of the basis vectors when it was
+  // computed
+  mutable std::vector<PetscScalar> _gram;
+  mutable std::vector<PetscObjectState> _gram_state;
 };
 } // namespace dolfinx::la
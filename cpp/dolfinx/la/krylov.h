@@ -0,0 +1,407 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include "Vector.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+// Native Krylov solvers for la::Vector
+//
+// The solvers take the operator and the preconditioner as callables,
+//
+//     action(x, y):  compute y = A x
+//     precond(r, z): compute z = M r
+//
+// with x, y, r and z of type la::Vector. The action may update the
+// ghost entries of x, e.g. fem::MatrixFreeOperator::apply, and only
+// the owned entries of y and z are used. Global reductions are fused,
+// see la::inner_products_begin.
+
+namespace dolfinx::la
+{
+
+/// Result of a solve with one of the native Krylov solvers
+struct KrylovResult
+{
+  /// Number of iterations
+  int iterations = 0;
+
+  /// Norm of the final residual
+  double residual_norm = 0.0;
+
+  /// True if the residual norm has been reduced by the relative
+  /// tolerance
+  bool converged = false;
+};
+
+/// @cond
+namespace impl
+{
+/// Complex conjugate that preserves real types
+template <typename T>
+T conj(T x)
+{
+  if constexpr (std::is_floating_point_v<T>)
+    return x;
+  else
+    return std::conj(x);
+}
+
+/// Compute r = b - A x, with y as work vector
+template <typename T, class Allocator, typename U>
+void residual(Vector<T, Allocator>& r, const Vector<T, Allocator>& b,
+              Vector<T, Allocator>& x, Vector<T, Allocator>& y, U& action)
+{
+  action(x, y);
+  waxpy(r, T(-1), y, b);
+}
+} // namespace impl
+/// @endcond
+
+/// Solve A x = b with the preconditioned conjugate gradient method. The
+/// operator and the preconditioner must be Hermitian positive definite.
+///
+/// The inner product for the step length and the fused inner product
+/// and residual norm for the search direction require two global
+/// reductions per iteration.
+/// @note Collective
+/// @param[in,out] x The initial guess on entry and the solution on exit
+/// @param[in] b The right-hand side
+/// @param[in] action The action of the operator, `action(x, y)`
+/// @param[in] precond The preconditioner, `precond(r, z)`
+/// @param[in] kmax The maximum number of iterations
+/// @param[in] rtol The tolerance on the residual norm, relative to the
+/// initial residual norm
+/// @return Iteration count and convergence information
+template <typename T, class Allocator, typename U, typename V>
+KrylovResult cg(Vector<T, Allocator>& x, const Vector<T, Allocator>& b,
+                U&& action, V&& precond, int kmax, double rtol)
+{
+  using _Vector = Vector<T, Allocator>;
+  _Vector r(b), z(b), p(b), y(b);
+
+  impl::residual(r, b, x, y, action);
+  precond(r, z);
+  std::copy(z.array().begin(), z.array().end(), p.mutable_array().begin());
+
+  std::vector<T> v = inner_products<T, Allocator>({{&r, &z}, {&r, &r}});
+  T gamma = v[0];
+  KrylovResult result;
+  result.residual_norm = std::sqrt(std::real(v[1]));
+  const double tol = rtol * result.residual_norm;
+  while (result.residual_norm > tol and result.iterations < kmax)
+  {
+    action(p, y);
+    const T alpha = gamma / inner_product(p, y);
+    axpy(x, alpha, p);
+    axpy(r, -alpha, y);
+    precond(r, z);
+
+    v = inner_products<T, Allocator>({{&r, &z}, {&r, &r}});
+    const T beta = v[0] / gamma;
+    axpby(p, T(1), z, beta);
+    gamma = v[0];
+    result.residual_norm = std::sqrt(std::real(v[1]));
+    ++result.iterations;
+  }
+
+  result.converged = result.residual_norm <= tol;
+  return result;
+}
+
+/// Solve A x = b with the unpreconditioned conjugate gradient method,
+/// see la::cg
+template <typename T, class Allocator, typename U>
+KrylovResult cg(Vector<T, Allocator>& x, const Vector<T, Allocator>& b,
+                U&& action, int kmax, double rtol)
+{
+  auto identity = [](const Vector<T, Allocator>& r, Vector<T, Allocator>& z)
+  { std::copy(r.array().begin(), r.array().end(), z.mutable_array().begin()); };
+  return cg(x, b, action, identity, kmax, rtol);
+}
+
+/// Solve A x = b with the pipelined preconditioned conjugate gradient
+/// method of Ghysels and Vanroose (Parallel Computing 40, 2014). The
+/// operator and the preconditioner must be Hermitian positive definite.
+///
+/// The method requires a single global reduction per iteration, which
+/// is overlapped with the application of the preconditioner and the
+/// operator. The vector updates are fused into a single pass over
+/// memory. It uses more work vectors than la::cg, and rounding errors
+/// may limit the attainable accuracy for small tolerances.
+/// @note Collective
+/// @param[in,out] x The initial guess on entry and the solution on exit
+/// @param[in] b The right-hand side
+/// @param[in] action The action of the operator, `action(x, y)`
+/// @param[in] precond The preconditioner, `precond(r, z)`
+/// @param[in] kmax The maximum number of iterations
+/// @param[in] rtol The tolerance on the residual norm, relative to the
+/// initial residual norm
+/// @return Iteration count and convergence information
+template <typename T, class Allocator, typename U, typename V>
+KrylovResult pipelined_cg(Vector<T, Allocator>& x,
+                          const Vector<T, Allocator>& b, U&& action,
+                          V&& precond, int kmax, double rtol)
+{
+  using _Vector = Vector<T, Allocator>;
+  _Vector r(b), u(b), w(b), m(b), n(b);
+
+  // Search directions and their images, initially zero
+  _Vector p(b.map(), b.bs()), s(b.map(), b.bs()), q(b.map(), b.bs()),
+      z(b.map(), b.bs());
+
+  impl::residual(r, b, x, w, action);
+  precond(r, u);
+  action(u, w);
+
+  KrylovResult result;
+  double tol = 0.0;
+  T gamma0 = 0, alpha0 = 0;
+  while (true)
+  {
+    // Start reduction and overlap with preconditioner and operator
+    Reduction<T> reduction
+        = inner_products_begin<T, Allocator>({{&r, &u}, {&u, &w}, {&r, &r}});
+    precond(w, m);
+    action(m, n);
+    const std::vector<T>& v = reduction.wait();
+    const T gamma = v[0];
+    const T delta = v[1];
+    result.residual_norm = std::sqrt(std::real(v[2]));
+    if (result.iterations == 0)
+      tol = rtol * result.residual_norm;
+    if (result.residual_norm <= tol or result.iterations == kmax)
+      break;
+
+    T alpha, beta;
+    if (result.iterations == 0)
+    {
+      beta = 0;
+      alpha = gamma / delta;
+    }
+    else
+    {
+      beta = gamma / gamma0;
+      alpha = gamma / (delta - beta * gamma / alpha0);
+    }
+
+    // Update vectors (owned and ghost entries)
+    T* _x = x.mutable_array().data();
+    T* _r = r.mutable_array().data();
+    T* _u = u.mutable_array().data();
+    T* _w = w.mutable_array().data();
+    T* _p = p.mutable_array().data();
+    T* _s = s.mutable_array().data();
+    T* _q = q.mutable_array().data();
+    T* _z = z.mutable_array().data();
+    const T* _m = m.array().data();
+    const T* _n = n.array().data();
+    for (std::size_t i = 0; i < b.array().size(); ++i)
+    {
+      _z[i] = _n[i] + beta * _z[i];
+      _q[i] = _m[i] + beta * _q[i];
+      _s[i] = _w[i] + beta * _s[i];
+      _p[i] = _u[i] + beta * _p[i];
+      _x[i] += alpha * _p[i];
+      _r[i] -= alpha * _s[i];
+      _u[i] -= alpha * _q[i];
+      _w[i] -= alpha * _z[i];
+    }
+
+    gamma0 = gamma;
+    alpha0 = alpha;
+    ++result.iterations;
+  }
+
+  result.converged = result.residual_norm <= tol;
+  return result;
+}
+
+/// Solve A x = b with the unpreconditioned pipelined conjugate gradient
+/// method, see la::pipelined_cg
+template <typename T, class Allocator, typename U>
+KrylovResult pipelined_cg(Vector<T, Allocator>& x,
+                          const Vector<T, Allocator>& b, U&& action, int kmax,
+                          double rtol)
+{
+  auto identity = [](const Vector<T, Allocator>& r, Vector<T, Allocator>& z)
+  { std::copy(r.array().begin(), r.array().end(), z.mutable_array().begin()); };
+  return pipelined_cg(x, b, action, identity, kmax, rtol);
+}
+
+/// Solve A x = b with the restarted, right-preconditioned GMRES method.
+///
+/// The Arnoldi basis is orthogonalised by classical Gram-Schmidt, with
+/// the inner products with the basis vectors and the norm of the new
+/// vector computed by a single fused reduction per iteration. The norm
+/// of the orthogonalised vector follows from the Pythagorean theorem.
+/// If cancellation is detected, a second Gram-Schmidt pass (with one
+/// more reduction) is performed.
+/// @note Collective
+/// @param[in,out] x The initial guess on entry and the solution on exit
+/// @param[in] b The right-hand side
+/// @param[in] action The action of the operator, `action(x, y)`
+/// @param[in] precond The preconditioner, `precond(r, z)`
+/// @param[in] kmax The maximum number of iterations
+/// @param[in] rtol The tolerance on the residual norm, relative to the
+/// initial residual norm
+/// @param[in] restart The number of iterations between restarts
+/// @return Iteration count and convergence information
+template <typename T, class Allocator, typename U, typename V>
+KrylovResult gmres(Vector<T, Allocator>& x, const Vector<T, Allocator>& b,
+                   U&& action, V&& precond, int kmax, double rtol,
+                   int restart = 30)
+{
+  if (restart < 1)
+    throw std::runtime_error("GMRES restart must be positive.");
+
+  using _Vector = Vector<T, Allocator>;
+  _Vector r(b), w(b), z(b);
+  std::vector<_Vector> basis;
+  basis.reserve(restart + 1);
+  for (int i = 0; i < restart + 1; ++i)
+    basis.emplace_back(b.map(), b.bs());
+
+  // Hessenberg matrix (column-major), Givens rotations and rhs of the
+  // least-squares problem
+  const int ld = restart + 1;
+  std::vector<T> H(ld * restart), cs(restart), sn(restart), g(ld);
+
+  // Subtract projection of w onto the first j + 1 basis vectors and
+  // add the coefficients to h. Returns the squared norm of w after
+  // orthogonalisation, and the squared norm before.
+  auto orthogonalize = [&basis, &w](int j, T* h) -> std::array<double, 2>
+  {
+    std::vector<std::array<const _Vector*, 2>> pairs;
+    for (int i = 0; i <= j; ++i)
+      pairs.push_back({&basis[i], &w});
+    pairs.push_back({&w, &w});
+    const std::vector<T> v = inner_products<T, Allocator>(pairs);
+    const double ww = std::real(v[j + 1]);
+    double hh = 0.0;
+    for (int i = 0; i <= j; ++i)
+    {
+      axpy(w, -v[i], basis[i]);
+      h[i] += v[i];
+      hh += std::norm(v[i]);
+    }
+    return {ww - hh, ww};
+  };
+
+  impl::residual(r, b, x, w, action);
+  KrylovResult result;
+  result.residual_norm = std::sqrt(r.squared_norm());
+  const double tol = rtol * result.residual_norm;
+  while (result.residual_norm > tol and result.iterations < kmax)
+  {
+    // Initialise basis and least-squares rhs
+    std::fill(g.begin(), g.end(), 0);
+    g[0] = result.residual_norm;
+    std::fill(H.begin(), H.end(), 0);
+    std::copy(r.array().begin(), r.array().end(),
+              basis[0].mutable_array().begin());
+    scale(basis[0], T(1.0 / result.residual_norm));
+
+    int j = 0;
+    while (j < restart and result.iterations < kmax)
+    {
+      precond(basis[j], z);
+      action(z, w);
+
+      // Orthogonalise, with reorthogonalisation on cancellation
+      T* h = H.data() + ld * j;
+      std::array<double, 2> norms = orthogonalize(j, h);
+      if (norms[0] < 0.5 * norms[1])
+        norms = orthogonalize(j, h);
+      h[j + 1] = std::sqrt(std::max(norms[0], 0.0));
+      if (std::abs(h[j + 1]) > 0.0)
+      {
+        std::copy(w.array().begin(), w.array().end(),
+                  basis[j + 1].mutable_array().begin());
+        scale(basis[j + 1], T(1.0) / h[j + 1]);
+      }
+
+      // Apply previous rotations to the new column and compute the
+      // rotation that eliminates h[j + 1]
+      for (int i = 0; i < j; ++i)
+      {
+        const T hi = cs[i] * h[i] + sn[i] * h[i + 1];
+        h[i + 1] = -impl::conj(sn[i]) * h[i] + cs[i] * h[i + 1];
+        h[i] = hi;
+      }
+      const double a = std::abs(h[j]);
+      const double rho = std::sqrt(a * a + std::norm(h[j + 1]));
+      if (rho == 0.0)
+      {
+        cs[j] = 1;
+        sn[j] = 0;
+      }
+      else if (a == 0.0)
+      {
+        cs[j] = 0;
+        sn[j] = impl::conj(h[j + 1]) / T(rho);
+        h[j] = rho;
+      }
+      else
+      {
+        cs[j] = a / rho;
+        sn[j] = (h[j] / T(a)) * impl::conj(h[j + 1]) / T(rho);
+        h[j] = (h[j] / T(a)) * T(rho);
+      }
+      h[j + 1] = 0;
+      g[j + 1] = -impl::conj(sn[j]) * g[j];
+      g[j] = cs[j] * g[j];
+
+      ++j;
+      ++result.iterations;
+      if (std::abs(g[j]) <= tol)
+        break;
+    }
+
+    // Solve the triangular system and update x += M V y
+    std::vector<T> y(j);
+    for (int i = j - 1; i >= 0; --i)
+    {
+      T yi = g[i];
+      for (int l = i + 1; l < j; ++l)
+        yi -= H[ld * l + i] * y[l];
+      y[i] = yi / H[ld * i + i];
+    }
+    scale(w, T(0));
+    for (int i = 0; i < j; ++i)
+      axpy(w, y[i], basis[i]);
+    precond(w, z);
+    axpy(x, T(1), z);
+
+    // Recompute the true residual
+    impl::residual(r, b, x, w, action);
+    result.residual_norm = std::sqrt(r.squared_norm());
+  }
+
+  result.converged = result.residual_norm <= tol;
+  return result;
+}
+
+/// Solve A x = b with the restarted, unpreconditioned GMRES method,
+/// see la::gmres
+template <typename T, class Allocator, typename U>
+KrylovResult gmres(Vector<T, Allocator>& x, const Vector<T, Allocator>& b,
+                   U&& action, int kmax, double rtol, int restart = 30)
+{
+  auto identity = [](const Vector<T, Allocator>& r, Vector<T, Allocator>& z)
+  { std::copy(r.array().begin(), r.array().end(), z.mutable_array().begin()); };
+  return gmres(x, b, action, identity, kmax, rtol, restart);
+}
+
+} // namespace dolfinx::la
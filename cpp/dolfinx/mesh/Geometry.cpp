@@ -6,8 +6,13 @@
 
 #include "Geometry.h"
 #include "Topology.h"
+#include "cell_types.h"
+#include <algorithm>
 #include <boost/functional/hash.hpp>
+#include <cfloat>
+#include <cmath>
 #include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/cpu.h>
 #include <dolfinx/fem/ElementDofLayout.h>
 #include <dolfinx/fem/dofmapbuilder.h>
 #include <dolfinx/graph/partition.h>
@@ -20,7 +25,7 @@ int Geometry::dim() const { return _dim; }
 //-----------------------------------------------------------------------------
 const graph::AdjacencyList<std::int32_t>& Geometry::dofmap() const
 {
-  return _dofmap;
+  return *_dofmap;
 }
 //-----------------------------------------------------------------------------
 std::shared_ptr<const common::IndexMap> Geometry::index_map() const
@@ -28,9 +33,72 @@ std::shared_ptr<const common::IndexMap> Geometry::index_map() const
   return _index_map;
 }
 //-----------------------------------------------------------------------------
-xt::xtensor<double, 2>& Geometry::x() { return _x; }
+xt::xtensor<double, 2>& Geometry::x()
+{
+  if (_single_precision)
+  {
+    throw std::runtime_error("Geometry coordinates are stored in single "
+                             "precision. Call store_double_precision first.");
+  }
+  std::vector<double>().swap(_packed_x);
+  ++_version;
+  return _x;
+}
+//-----------------------------------------------------------------------------
+const xt::xtensor<double, 2>& Geometry::x() const
+{
+  if (_single_precision)
+  {
+    throw std::runtime_error("Geometry coordinates are stored in single "
+                             "precision. Call store_double_precision first.");
+  }
+  return _x;
+}
+//-----------------------------------------------------------------------------
+void Geometry::store_single_precision()
+{
+  if (_single_precision)
+    return;
+
+  // Check that the coordinates can be represented
+  if (std::any_of(_x.begin(), _x.end(),
+                  [](auto x) { return std::abs(x) > FLT_MAX; }))
+  {
+    throw std::runtime_error(
+        "Geometry coordinates are out of the single precision range.");
+  }
+
+  const std::size_t num_points = _x.shape(0);
+  _x_single.resize(num_points * _dim);
+  for (std::size_t i = 0; i < num_points; ++i)
+    for (int j = 0; j < _dim; ++j)
+      _x_single[i * _dim + j] = _x(i, j);
+
+  // Release the double-precision coordinates
+  _x = xt::xtensor<double, 2>({0, 3});
+  _single_precision = true;
+  ++_version;
+}
+//-----------------------------------------------------------------------------
+void Geometry::store_double_precision()
+{
+  if (!_single_precision)
+    return;
+
+  const std::size_t num_points = _x_single.size() / _dim;
+  _x = xt::zeros<double>({num_points, static_cast<std::size_t>(3)});
+  for (std::size_t i = 0; i < num_points; ++i)
+    for (int j = 0; j < _dim; ++j)
+      _x(i, j) = _x_single[i * _dim + j];
+
+  std::vector<float>().swap(_x_single);
+  _single_precision = false;
+  ++_version;
+}
+//-----------------------------------------------------------------------------
+bool Geometry::single_precision() const { return _single_precision; }
 //-----------------------------------------------------------------------------
-const xt::xtensor<double, 2>& Geometry::x() const { return _x; }
+xtl::span<const float> Geometry::x_single() const { return _x_single; }
 //-----------------------------------------------------------------------------
 const fem::CoordinateElement& Geometry::cmap() const { return _cmap; }
 //-----------------------------------------------------------------------------
@@ -39,6 +107,51 @@ const std::vector<std::int64_t>& Geometry::input_global_indices() const
   return _input_global_indices;
 }
 //-----------------------------------------------------------------------------
+void Geometry::pack_coordinates()
+{
+  const std::int32_t num_cells = _dofmap->num_nodes();
+  const std::size_t num_dofs_g = num_cells > 0 ? _dofmap->num_links(0) : 0;
+  _packed_x.resize(3 * num_dofs_g * num_cells);
+  if (!_single_precision)
+  {
+    // The packed coordinates are the points of the dofmap array
+    const std::vector<std::int32_t>& dofs = _dofmap->array();
+    assert(dofs.size() == num_dofs_g * num_cells);
+    cpu::gather(dofs.data(), dofs.size(), 3, _x.data(), _packed_x.data());
+  }
+  else
+  {
+    for (std::int32_t c = 0; c < num_cells; ++c)
+    {
+      this->cell_coordinates(
+          c,
+          xtl::span<double>(std::next(_packed_x.data(), 3 * num_dofs_g * c),
+                            3 * num_dofs_g));
+    }
+  }
+  _packed_version = _version;
+}
+//-----------------------------------------------------------------------------
+void Geometry::clear_packed_coordinates()
+{
+  std::vector<double>().swap(_packed_x);
+}
+//-----------------------------------------------------------------------------
+xtl::span<const double> Geometry::packed_coordinates() const
+{
+  if (_packed_version != _version)
+    return xtl::span<const double>();
+  return _packed_x;
+}
+//-----------------------------------------------------------------------------
+std::size_t Geometry::memory_usage() const
+{
+  return _dofmap->memory_usage() + _x.size() * sizeof(double)
+         + _x_single.capacity() * sizeof(float)
+         + _input_global_indices.capacity() * sizeof(std::int64_t)
+         + _packed_x.capacity() * sizeof(double);
+}
+//-----------------------------------------------------------------------------
 
 //-----------------------------------------------------------------------------
 mesh::Geometry mesh::create_geometry(
@@ -49,6 +162,56 @@ mesh::Geometry mesh::create_geometry(
     const std::function<std::vector<int>(
         const graph::AdjacencyList<std::int32_t>&)>& reorder_fn)
 {
+  // If the geometry dofs are the cell vertices, use the vertices of the
+  // topology as the geometry dofs
+  const fem::ElementDofLayout& layout = coordinate_element.dof_layout();
+  const int num_vertices_per_cell
+      = mesh::num_cell_vertices(topology.cell_type());
+  bool vertex_dofs = !reorder_fn
+                     and !coordinate_element.needs_dof_permutations()
+                     and layout.num_dofs() == num_vertices_per_cell;
+  for (int v = 0; vertex_dofs and v < num_vertices_per_cell; ++v)
+    vertex_dofs = layout.entity_dofs(0, v) == std::vector<int>{v};
+  if (vertex_dofs)
+  {
+    const int tdim = topology.dim();
+    auto c_to_v = topology.connectivity(tdim, 0);
+    assert(c_to_v);
+    auto map_v = topology.index_map(0);
+    assert(map_v);
+    assert(c_to_v->num_nodes() == cell_nodes.num_nodes());
+
+    // Input global index of each vertex. The cell nodes and the cell
+    // vertices are in the same order.
+    std::vector<std::int64_t> igi(map_v->size_local() + map_v->num_ghosts(),
+                                  -1);
+    for (std::int32_t c = 0; c < c_to_v->num_nodes(); ++c)
+    {
+      auto vertices = c_to_v->links(c);
+      auto nodes = cell_nodes.links(c);
+      for (std::size_t i = 0; i < vertices.size(); ++i)
+        igi[vertices[i]] = nodes[i];
+    }
+    assert(std::find(igi.begin(), igi.end(), -1) == igi.end());
+
+    // Fetch the vertex coordinates by global index from other ranks
+    std::vector<std::int64_t> indices(igi);
+    std::sort(indices.begin(), indices.end());
+    const xt::xtensor<double, 2> coords
+        = graph::build::distribute_data<double>(comm, indices, x);
+    xt::xtensor<double, 2> xg({igi.size(), coords.shape(1)});
+    for (std::size_t i = 0; i < igi.size(); ++i)
+    {
+      auto it = std::lower_bound(indices.begin(), indices.end(), igi[i]);
+      assert(it != indices.end() and *it == igi[i]);
+      auto row = xt::row(coords, std::distance(indices.begin(), it));
+      std::copy(row.cbegin(), row.cend(), xt::row(xg, i).begin());
+    }
+
+    return Geometry(map_v, c_to_v, coordinate_element, std::move(xg),
+                    std::move(igi));
+  }
+
   // TODO: make sure required entities are initialised, or extend
   // fem::build_dofmap_data
 
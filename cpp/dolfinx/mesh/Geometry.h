@@ -6,16 +6,22 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
 #include <dolfinx/common/MPI.h>
 #include <dolfinx/fem/CoordinateElement.h>
 #include <dolfinx/graph/AdjacencyList.h>
 #include <dolfinx/graph/scotch.h>
 #include <functional>
+#include <iterator>
 #include <memory>
+#include <type_traits>
 #include <vector>
 #include <xtensor/xbuilder.hpp>
 #include <xtensor/xtensor.hpp>
 #include <xtensor/xview.hpp>
+#include <xtl/xspan.hpp>
 
 namespace dolfinx::common
 {
@@ -37,14 +43,30 @@ class Geometry
 {
 public:
   /// Constructor
+  ///
+  /// The dofmap is either a graph::AdjacencyList, or a shared pointer
+  /// to one that is shared with other objects, e.g. the cell-vertex
+  /// connectivity of the topology for a geometry with dofs only at the
+  /// vertices.
   template <typename AdjacencyList32, typename Array, typename Vector64>
   Geometry(const std::shared_ptr<const common::IndexMap>& index_map,
            AdjacencyList32&& dofmap, const fem::CoordinateElement& element,
            Array&& x, Vector64&& input_global_indices)
-      : _dim(x.shape(1)), _dofmap(std::forward<AdjacencyList32>(dofmap)),
-        _index_map(index_map), _cmap(element), _x(std::forward<Array>(x)),
+      : _dim(x.shape(1)), _index_map(index_map), _cmap(element),
+        _x(std::forward<Array>(x)),
         _input_global_indices(std::forward<Vector64>(input_global_indices))
   {
+    using dofmap_ptr
+        = std::shared_ptr<const graph::AdjacencyList<std::int32_t>>;
+    if constexpr (std::is_convertible_v<AdjacencyList32, dofmap_ptr>)
+      _dofmap = std::forward<AdjacencyList32>(dofmap);
+    else
+    {
+      _dofmap = std::make_shared<const graph::AdjacencyList<std::int32_t>>(
+          std::forward<AdjacencyList32>(dofmap));
+    }
+    assert(_dofmap);
+
     assert(_x.shape(1) > 0 and _x.shape(1) <= 3);
     if (_x.shape(0) != _input_global_indices.size())
       throw std::runtime_error("Size mis-match");
@@ -83,12 +105,91 @@ public:
   /// Index map
   std::shared_ptr<const common::IndexMap> index_map() const;
 
-  /// Geometry degrees-of-freedom
+  /// Geometry degrees-of-freedom. Increments the version of the
+  /// geometry.
+  /// @note Calling this function clears the packed cell coordinates,
+  /// see Geometry::pack_coordinates
+  /// @note Throws if the coordinates are stored in single precision,
+  /// see Geometry::store_single_precision
   xt::xtensor<double, 2>& x();
 
   /// Geometry degrees-of-freedom
+  /// @note Throws if the coordinates are stored in single precision,
+  /// see Geometry::store_single_precision
   const xt::xtensor<double, 2>& x() const;
 
+  /// Version of the coordinates. The version is incremented when
+  /// mutable access to the coordinates is requested (Geometry::x) and
+  /// when the precision of the stored coordinates is changed. Data
+  /// derived from the coordinates, e.g. packed cell geometry or
+  /// bounding box trees, can be checked against it in O(1).
+  /// @note Modifications through a reference obtained before the last
+  /// version increment are not detected. Call
+  /// Geometry::increment_version after such modifications.
+  std::uint64_t version() const { return _version; }
+
+  /// Increment the version of the coordinates, see Geometry::version
+  void increment_version() { ++_version; }
+
+  /// Store the coordinates in single precision with Geometry::dim
+  /// components per point, in place of the double-precision array with
+  /// three components per point. This reduces the memory used by the
+  /// coordinates by a factor of 2 to 6, depending on the geometric
+  /// dimension. It is safe when the rounding error of single precision
+  /// relative to the extent of the mesh is acceptable. The assemblers
+  /// convert the coordinates of each cell to double precision. The
+  /// array Geometry::x is not available while the coordinates are
+  /// stored in single precision, so operations that use it (e.g.
+  /// interpolation, mesh refinement and output) need
+  /// Geometry::store_double_precision to be called first.
+  void store_single_precision();
+
+  /// Store the coordinates in double precision. This restores
+  /// Geometry::x after Geometry::store_single_precision, with the
+  /// coordinates rounded to single precision.
+  void store_double_precision();
+
+  /// Check if the coordinates are stored in single precision
+  /// @return True if the coordinates are stored in single precision
+  bool single_precision() const;
+
+  /// Coordinates stored in single precision
+  /// @return The coordinates, with Geometry::dim components per point.
+  /// The array is empty if the coordinates are stored in double
+  /// precision.
+  xtl::span<const float> x_single() const;
+
+  /// Copy the coordinates of the geometry dofs of a cell into an array,
+  /// in double precision and with three components per dof, as
+  /// expected by the kernels
+  /// @param[in] c The cell index
+  /// @param[out] coordinate_dofs The coordinates of the cell dofs. It
+  /// must have size at least 3 times the number of dofs per cell.
+  void cell_coordinates(std::int32_t c,
+                        const xtl::span<double>& coordinate_dofs) const
+  {
+    auto x_dofs = _dofmap->links(c);
+    assert(coordinate_dofs.size() >= 3 * x_dofs.size());
+    if (!_single_precision)
+    {
+      for (std::size_t i = 0; i < x_dofs.size(); ++i)
+      {
+        std::copy_n(std::next(_x.data(), 3 * x_dofs[i]), 3,
+                    std::next(coordinate_dofs.begin(), 3 * i));
+      }
+    }
+    else
+    {
+      for (std::size_t i = 0; i < x_dofs.size(); ++i)
+      {
+        auto x = std::next(_x_single.begin(), _dim * x_dofs[i]);
+        std::copy_n(x, _dim, std::next(coordinate_dofs.begin(), 3 * i));
+        std::fill_n(std::next(coordinate_dofs.begin(), 3 * i + _dim),
+                    3 - _dim, 0.0);
+      }
+    }
+  }
+
   /// The element that describes the geometry map
   /// @return The coordinate/geometry element
   const fem::CoordinateElement& cmap() const;
@@ -96,12 +197,39 @@ public:
   /// Global user indices
   const std::vector<std::int64_t>& input_global_indices() const;
 
+  /// Pack the coordinates of the geometry dofs of each cell into a
+  /// contiguous array, which the assemblers use in place of gathering
+  /// the cell coordinates through the dofmap. The packed coordinates
+  /// are kept until Geometry::x (non-const) or
+  /// Geometry::clear_packed_coordinates is called, and are not used
+  /// once the version of the geometry has changed (see
+  /// Geometry::version).
+  void pack_coordinates();
+
+  /// Discard the packed cell coordinates
+  void clear_packed_coordinates();
+
+  /// Packed cell coordinates. The coordinates of geometry dof `i` of
+  /// cell `c` start at `3 * (c * num_dofs_per_cell + i)`.
+  /// @return The packed coordinates. The array is empty if the
+  /// coordinates have not been packed at the current version.
+  xtl::span<const double> packed_coordinates() const;
+
+  /// Return the memory allocated by the geometry, i.e. by the dofmap,
+  /// the coordinates (including the packed coordinates) and the input
+  /// global indices. The index map is not included, see
+  /// common::IndexMap::memory_usage. The dofmap is included even when
+  /// it is shared with the topology.
+  /// @return The number of bytes
+  std::size_t memory_usage() const;
+
 private:
   // Geometric dimension
   int _dim;
 
-  // Map per cell for extracting coordinate data
-  graph::AdjacencyList<std::int32_t> _dofmap;
+  // Map per cell for extracting coordinate data, which may be shared
+  // with the topology
+  std::shared_ptr<const graph::AdjacencyList<std::int32_t>> _dofmap;
 
   // IndexMap for geometry 'dofmap'
   std::shared_ptr<const common::IndexMap> _index_map;
@@ -114,9 +242,30 @@ private:
 
   // Global indices as provided on Geometry creation
   std::vector<std::int64_t> _input_global_indices;
+
+  // Coordinates packed by cell (empty if not packed), and the version
+  // of the coordinates when packed
+  std::vector<double> _packed_x;
+  std::uint64_t _packed_version = 0;
+
+  // Version of the coordinates
+  std::uint64_t _version = 0;
+
+  // True if the coordinates are stored in single precision
+  bool _single_precision = false;
+
+  // Coordinates in single precision, with _dim components per point
+  // (empty if stored in double precision)
+  std::vector<float> _x_single;
 };
 
 /// Build Geometry
+///
+/// If the coordinate element has one dof at each vertex and no other
+/// dofs (e.g. affine P1 simplices), and no reordering function is
+/// given, the geometry dofs are the vertices of the topology. The
+/// geometry then shares the cell-vertex connectivity and vertex index
+/// map of the topology instead of building its own dofmap.
 /// @todo document
 mesh::Geometry
 create_geometry(MPI_Comm comm, const Topology& topology,
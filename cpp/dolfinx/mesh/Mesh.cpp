@@ -10,13 +10,20 @@
 #include "Topology.h"
 #include "topologycomputation.h"
 #include "utils.h"
+#include <algorithm>
+#include <array>
 #include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/Timer.h>
 #include <dolfinx/common/utils.h>
 #include <dolfinx/fem/CoordinateElement.h>
 #include <dolfinx/graph/AdjacencyList.h>
+#include <dolfinx/graph/ordering.h>
 #include <dolfinx/graph/partition.h>
 #include <dolfinx/mesh/cell_types.h>
+#include <limits>
 #include <memory>
+#include <numeric>
+#include <xtensor/xbuilder.hpp>
 
 #include "graphbuild.h"
 
@@ -49,28 +56,215 @@ reorder_list(const graph::AdjacencyList<T>& list,
 
   return list_new;
 }
-} // namespace
+//-----------------------------------------------------------------------------
+
+/// Compute the re-ordering (map[old] -> new) that sorts points along a
+/// Morton (Z-order) space-filling curve through their bounding box
+/// @param[in] x The points, shape=(num_points, gdim) with gdim <= 3
+/// @return The re-ordering
+std::vector<int> compute_morton_reordering(const xt::xtensor<double, 2>& x)
+{
+  const std::size_t num_points = x.shape(0);
+  const std::size_t gdim = x.shape(1);
+  assert(gdim <= 3);
 
+  // Bounding box of the points
+  std::array<double, 3> x0, x1;
+  x0.fill(std::numeric_limits<double>::max());
+  x1.fill(std::numeric_limits<double>::lowest());
+  for (std::size_t i = 0; i < num_points; ++i)
+  {
+    for (std::size_t j = 0; j < gdim; ++j)
+    {
+      x0[j] = std::min(x0[j], x(i, j));
+      x1[j] = std::max(x1[j], x(i, j));
+    }
+  }
+  std::array<double, 3> h;
+  std::transform(x1.begin(), x1.end(), x0.begin(), h.begin(),
+                 [](double b, double a) { return b - a; });
+
+  // Quantise the coordinates to 21 bits, and interleave the bits to
+  // compute the position of each point along the curve
+  constexpr int num_bits = 21;
+  constexpr double scale = (std::uint64_t(1) << num_bits) - 1;
+  std::vector<std::pair<std::uint64_t, std::int32_t>> codes(num_points);
+  for (std::size_t i = 0; i < num_points; ++i)
+  {
+    std::uint64_t code = 0;
+    for (std::size_t j = 0; j < gdim; ++j)
+    {
+      const std::uint64_t q
+          = h[j] > 0 ? std::uint64_t((x(i, j) - x0[j]) / h[j] * scale) : 0;
+      for (int b = 0; b < num_bits; ++b)
+        code |= ((q >> b) & 1) << (b * gdim + j);
+    }
+    codes[i] = {code, std::int32_t(i)};
+  }
+  std::sort(codes.begin(), codes.end());
+
+  std::vector<int> remap(num_points);
+  for (std::size_t i = 0; i < num_points; ++i)
+    remap[codes[i].second] = i;
+  return remap;
+}
 //-----------------------------------------------------------------------------
-Mesh mesh::create_mesh(MPI_Comm comm,
-                       const graph::AdjacencyList<std::int64_t>& cells,
-                       const fem::CoordinateElement& element,
-                       const xt::xtensor<double, 2>& x,
-                       mesh::GhostMode ghost_mode)
+
+/// Compute the position of a point along a Hilbert curve through the
+/// unit (hyper)cube, using the algorithm of J. Skilling, "Programming
+/// the Hilbert curve", AIP Conference Proceedings 707 (2004)
+/// @param[in] q The coordinates of the point quantised to @p num_bits
+/// bits each
+/// @param[in] dim The number of coordinates (<= 3)
+/// @param[in] num_bits The number of bits per coordinate (<= 21)
+/// @return The position along the curve
+std::uint64_t hilbert_index(std::array<std::uint32_t, 3> q, int dim,
+                            int num_bits)
 {
-  return create_mesh(
-      comm, cells, element, x, ghost_mode,
-      static_cast<graph::AdjacencyList<std::int32_t> (*)(
-          MPI_Comm, int, int, const graph::AdjacencyList<std::int64_t>&,
-          mesh::GhostMode)>(&mesh::partition_cells_graph));
+  // Inverse undo excess work
+  const std::uint32_t m = std::uint32_t(1) << (num_bits - 1);
+  for (std::uint32_t b = m; b > 1; b >>= 1)
+  {
+    const std::uint32_t p = b - 1;
+    for (int i = 0; i < dim; ++i)
+    {
+      if (q[i] & b)
+        q[0] ^= p;
+      else
+      {
+        const std::uint32_t t = (q[0] ^ q[i]) & p;
+        q[0] ^= t;
+        q[i] ^= t;
+      }
+    }
+  }
+
+  // Gray encode
+  for (int i = 1; i < dim; ++i)
+    q[i] ^= q[i - 1];
+  std::uint32_t t = 0;
+  for (std::uint32_t b = m; b > 1; b >>= 1)
+    if (q[dim - 1] & b)
+      t ^= b - 1;
+  for (int i = 0; i < dim; ++i)
+    q[i] ^= t;
+
+  // Interleave the bits of the transposed index
+  std::uint64_t index = 0;
+  for (int b = num_bits - 1; b >= 0; --b)
+    for (int i = 0; i < dim; ++i)
+      index = (index << 1) | ((q[i] >> b) & 1);
+  return index;
 }
 //-----------------------------------------------------------------------------
-Mesh mesh::create_mesh(MPI_Comm comm,
+
+/// Compute the destination rank of the cells that share a facet with
+/// the cells on this rank, i.e. the ghost destinations, and return
+/// the destination ranks using the format of CellPartitionFunction
+/// @param[in] comm The MPI communicator
+/// @param[in] cells The cells on this rank
+/// @param[in] tdim The topological dimension
+/// @param[in] part The destination rank of each cell on this rank
+/// @return The destination ranks of each cell, with the owning rank
+/// first
+graph::AdjacencyList<std::int32_t>
+add_ghost_destinations(MPI_Comm comm,
                        const graph::AdjacencyList<std::int64_t>& cells,
-                       const fem::CoordinateElement& element,
-                       const xt::xtensor<double, 2>& x,
-                       mesh::GhostMode ghost_mode,
-                       const mesh::CellPartitionFunction& cell_partitioner)
+                       int tdim, const std::vector<std::int32_t>& part)
+{
+  const int size = dolfinx::MPI::size(comm);
+  const std::int32_t num_cells = cells.num_nodes();
+  const auto [dual_graph, graph_info]
+      = mesh::build_dual_graph(comm, cells, tdim);
+
+  // Global offset of the cells on each rank
+  const std::int64_t offset
+      = dolfinx::MPI::global_offset(comm, num_cells, true);
+  std::vector<std::int64_t> offsets(size + 1, 0);
+  MPI_Allgather(&offset, 1, MPI_INT64_T, offsets.data(), 1, MPI_INT64_T,
+                comm);
+  const std::int64_t num_cells_local = num_cells;
+  MPI_Allreduce(&num_cells_local, &offsets.back(), 1, MPI_INT64_T, MPI_SUM,
+                comm);
+
+  // Request the destination of the neighbouring cells that are on
+  // other ranks from the rank that holds them
+  std::vector<std::vector<std::int64_t>> request(size);
+  for (std::int32_t c = 0; c < num_cells; ++c)
+  {
+    for (std::int64_t cn : dual_graph.links(c))
+    {
+      if (cn < offset or cn >= offset + num_cells)
+      {
+        auto it = std::upper_bound(offsets.begin(), offsets.end(), cn);
+        request[std::distance(offsets.begin(), it) - 1].push_back(cn);
+      }
+    }
+  }
+  for (auto& r : request)
+  {
+    std::sort(r.begin(), r.end());
+    r.erase(std::unique(r.begin(), r.end()), r.end());
+  }
+  const graph::AdjacencyList<std::int64_t> requested
+      = dolfinx::MPI::all_to_all(comm,
+                                 graph::AdjacencyList<std::int64_t>(request));
+  std::vector<std::int64_t> reply(requested.array().size());
+  std::transform(requested.array().begin(), requested.array().end(),
+                 reply.begin(), [&part, offset = offset](auto cn)
+                 { return part[cn - offset]; });
+  const graph::AdjacencyList<std::int64_t> replied = dolfinx::MPI::all_to_all(
+      comm,
+      graph::AdjacencyList<std::int64_t>(std::move(reply),
+                                         requested.offsets()));
+
+  // Destination of a cell, looking up cells on other ranks in the
+  // replies (in the order of the requests)
+  auto destination = [&, offset = offset](std::int64_t cn)
+  {
+    if (cn >= offset and cn < offset + num_cells)
+      return part[cn - offset];
+    auto it = std::upper_bound(offsets.begin(), offsets.end(), cn);
+    const int rank = std::distance(offsets.begin(), it) - 1;
+    auto pos = std::lower_bound(request[rank].begin(), request[rank].end(),
+                                cn);
+    return std::int32_t(
+        replied.links(rank)[std::distance(request[rank].begin(), pos)]);
+  };
+
+  // Owner first, followed by the ranks of the cells that share a facet
+  std::vector<std::int32_t> dest, dest_offsets = {0};
+  dest.reserve(num_cells);
+  for (std::int32_t c = 0; c < num_cells; ++c)
+  {
+    const std::size_t c_begin = dest.size();
+    dest.push_back(part[c]);
+    for (std::int64_t cn : dual_graph.links(c))
+    {
+      if (const std::int32_t r = destination(cn);
+          std::find(std::next(dest.begin(), c_begin), dest.end(), r)
+          == dest.end())
+      {
+        dest.push_back(r);
+      }
+    }
+    dest_offsets.push_back(dest.size());
+  }
+
+  return graph::AdjacencyList<std::int32_t>(std::move(dest),
+                                            std::move(dest_offsets));
+}
+//-----------------------------------------------------------------------------
+/// Create a mesh using a provided mesh partitioning function, see
+/// mesh::create_mesh
+/// @return The mesh and the input global index of each cell (owned and
+/// ghost) of the mesh
+std::pair<Mesh, std::vector<std::int64_t>>
+create_mesh_impl(MPI_Comm comm, const graph::AdjacencyList<std::int64_t>& cells,
+                 const fem::CoordinateElement& element,
+                 const xt::xtensor<double, 2>& x, mesh::GhostMode ghost_mode,
+                 const mesh::CellPartitionFunction& cell_partitioner,
+                 mesh::CellReordering reordering)
 {
   if (ghost_mode == mesh::GhostMode::shared_vertex)
     throw std::runtime_error("Ghost mode via vertex currently disabled.");
@@ -102,19 +296,67 @@ Mesh mesh::create_mesh(MPI_Comm comm,
       = mesh::extract_topology(element.cell_shape(), element.dof_layout(),
                                cell_nodes0);
 
-  // Build local dual graph for owned cells to apply re-ordering to
+  // Compute re-ordering of the owned cells
   const std::int32_t num_owned_cells
       = cells_extracted0.num_nodes() - ghost_owners.size();
-  auto [g, m] = mesh::build_local_dual_graph(
-      xtl::span<const std::int64_t>(
-          cells_extracted0.array().data(),
-          cells_extracted0.offsets()[num_owned_cells + 1]),
-      xtl::span<const std::int32_t>(cells_extracted0.offsets().data(),
-                                    num_owned_cells + 1),
-      tdim);
+  std::vector<int> remap;
+  switch (reordering)
+  {
+  case mesh::CellReordering::none:
+    remap.resize(num_owned_cells);
+    std::iota(remap.begin(), remap.end(), 0);
+    break;
+  case mesh::CellReordering::gps:
+  case mesh::CellReordering::reverse_cuthill_mckee:
+  {
+    // Build local dual graph for owned cells to apply re-ordering to
+    auto [g, m] = mesh::build_local_dual_graph(
+        xtl::span<const std::int64_t>(
+            cells_extracted0.array().data(),
+            cells_extracted0.offsets()[num_owned_cells]),
+        xtl::span<const std::int32_t>(cells_extracted0.offsets().data(),
+                                      num_owned_cells + 1),
+        tdim);
+    if (reordering == mesh::CellReordering::gps)
+      remap = graph::reorder_gps(g);
+    else
+      remap = graph::reorder_rcm(g);
+    break;
+  }
+  case mesh::CellReordering::morton:
+  {
+    // Fetch the coordinates of the owned cell nodes, and compute the
+    // cell midpoints
+    const std::int32_t num_owned_nodes
+        = cell_nodes0.offsets()[num_owned_cells];
+    std::vector<std::int64_t> nodes(
+        cell_nodes0.array().begin(),
+        std::next(cell_nodes0.array().begin(), num_owned_nodes));
+    std::sort(nodes.begin(), nodes.end());
+    nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+    const xt::xtensor<double, 2> coords
+        = graph::build::distribute_data<double>(comm, nodes, x);
 
-  // Compute re-ordering of local dual graph
-  const std::vector<int> remap = graph::scotch::compute_gps(g, 25).first;
+    xt::xtensor<double, 2> midpoints
+        = xt::zeros<double>({std::size_t(num_owned_cells), coords.shape(1)});
+    for (std::int32_t c = 0; c < num_owned_cells; ++c)
+    {
+      auto cell = cell_nodes0.links(c);
+      for (std::int64_t node : cell)
+      {
+        auto it = std::lower_bound(nodes.begin(), nodes.end(), node);
+        assert(it != nodes.end() and *it == node);
+        const std::size_t pos = std::distance(nodes.begin(), it);
+        for (std::size_t j = 0; j < coords.shape(1); ++j)
+          midpoints(c, j) += coords(pos, j) / cell.size();
+      }
+    }
+    remap = compute_morton_reordering(midpoints);
+    break;
+  }
+  default:
+    throw std::runtime_error("Unknown cell reordering.");
+  }
 
   // Create re-ordered cell lists
   std::vector<std::int64_t> original_cell_index(original_cell_index0);
@@ -166,10 +408,453 @@ Mesh mesh::create_mesh(MPI_Comm comm,
   Geometry geometry
       = mesh::create_geometry(comm, topology, element, cell_nodes1, x);
 
-  return Mesh(comm, std::move(topology), std::move(geometry));
+  original_cell_index.resize(n_cells_local);
+  return {Mesh(comm, std::move(topology), std::move(geometry)),
+          std::move(original_cell_index)};
 }
 //-----------------------------------------------------------------------------
 
+/// Create the index map of a subset of the local indices of an index
+/// map, adding the owned indices that are in the subset on another rank
+/// @param[in] map The index map
+/// @param[in] indices Local indices (owned and ghost) of @p map
+/// @return The sub-map, and the local index in @p map of each local
+/// index of the sub-map
+std::pair<std::shared_ptr<common::IndexMap>, std::vector<std::int32_t>>
+create_sub_map(const common::IndexMap& map,
+               const xtl::span<const std::int32_t>& indices)
+{
+  const std::int32_t size_local = map.size_local();
+  std::vector<std::int32_t> marker(size_local + map.num_ghosts(), 0);
+  for (std::int32_t i : indices)
+    marker[i] = 1;
+  map.scatter_rev(xtl::span<std::int32_t>(marker.data(), size_local),
+                  xtl::span<const std::int32_t>(
+                      std::next(marker.data(), size_local), map.num_ghosts()),
+                  1, common::IndexMap::Mode::add);
+
+  std::vector<std::int32_t> sub_indices;
+  for (std::size_t i = 0; i < marker.size(); ++i)
+    if (marker[i] > 0)
+      sub_indices.push_back(i);
+
+  auto [sub_map, sub_to_parent]
+      = common::create_sub_index_map(map, sub_indices);
+  return {std::make_shared<common::IndexMap>(std::move(sub_map)),
+          std::move(sub_to_parent)};
+}
+//-----------------------------------------------------------------------------
+
+/// Renumber a list of local indices of a map by their position in
+/// the list of parent indices of a sub-map
+std::vector<std::int32_t>
+renumber(const xtl::span<const std::int32_t>& indices,
+         const std::vector<std::int32_t>& sub_to_parent, std::size_t size)
+{
+  std::vector<std::int32_t> parent_to_sub(size, -1);
+  for (std::size_t i = 0; i < sub_to_parent.size(); ++i)
+    parent_to_sub[sub_to_parent[i]] = i;
+
+  std::vector<std::int32_t> sub(indices.size());
+  std::transform(indices.begin(), indices.end(), sub.begin(),
+                 [&parent_to_sub](auto i)
+                 {
+                   assert(parent_to_sub[i] >= 0);
+                   return parent_to_sub[i];
+                 });
+  return sub;
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
+//-----------------------------------------------------------------------------
+mesh::CellPartitionFunction
+mesh::create_cell_partitioner_sfc(const xt::xtensor<double, 2>& x)
+{
+  return [x](MPI_Comm comm, int nparts, int tdim,
+             const graph::AdjacencyList<std::int64_t>& cells,
+             mesh::GhostMode ghost_mode)
+  {
+    common::Timer timer("Compute space-filling curve partition of cells");
+    const std::int32_t num_cells = cells.num_nodes();
+    const std::size_t gdim = x.shape(1);
+    if (gdim > 3)
+      throw std::runtime_error("Unsupported geometric dimension.");
+
+    // Fetch the coordinates of the cell vertices, and compute the cell
+    // midpoints
+    std::vector<std::int64_t> nodes(cells.array());
+    std::sort(nodes.begin(), nodes.end());
+    nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+    const xt::xtensor<double, 2> coords
+        = graph::build::distribute_data<double>(comm, nodes, x);
+    xt::xtensor<double, 2> midpoints
+        = xt::zeros<double>({std::size_t(num_cells), gdim});
+    for (std::int32_t c = 0; c < num_cells; ++c)
+    {
+      auto vertices = cells.links(c);
+      for (std::int64_t v : vertices)
+      {
+        auto it = std::lower_bound(nodes.begin(), nodes.end(), v);
+        assert(it != nodes.end() and *it == v);
+        const std::size_t pos = std::distance(nodes.begin(), it);
+        for (std::size_t j = 0; j < gdim; ++j)
+          midpoints(c, j) += coords(pos, j) / vertices.size();
+      }
+    }
+
+    // Bounding box of all midpoints
+    std::array<double, 3> x0, x1;
+    x0.fill(std::numeric_limits<double>::max());
+    x1.fill(std::numeric_limits<double>::lowest());
+    for (std::int32_t c = 0; c < num_cells; ++c)
+    {
+      for (std::size_t j = 0; j < gdim; ++j)
+      {
+        x0[j] = std::min(x0[j], midpoints(c, j));
+        x1[j] = std::max(x1[j], midpoints(c, j));
+      }
+    }
+    MPI_Allreduce(MPI_IN_PLACE, x0.data(), 3, MPI_DOUBLE, MPI_MIN, comm);
+    MPI_Allreduce(MPI_IN_PLACE, x1.data(), 3, MPI_DOUBLE, MPI_MAX, comm);
+
+    // Position of each cell along the curve through the directions in
+    // which the mesh is not flat (e.g. the x-y plane for a 2D mesh with
+    // three coordinates)
+    std::vector<std::size_t> axes;
+    for (std::size_t j = 0; j < gdim; ++j)
+      if (x1[j] > x0[j])
+        axes.push_back(j);
+    constexpr int num_bits = 21;
+    constexpr double scale = (std::uint32_t(1) << num_bits) - 1;
+    std::vector<std::uint64_t> keys(num_cells, 0);
+    for (std::int32_t c = 0; c < num_cells and !axes.empty(); ++c)
+    {
+      std::array<std::uint32_t, 3> q = {0, 0, 0};
+      for (std::size_t i = 0; i < axes.size(); ++i)
+      {
+        const std::size_t j = axes[i];
+        q[i] = (midpoints(c, j) - x0[j]) / (x1[j] - x0[j]) * scale;
+      }
+      keys[c] = hilbert_index(q, axes.size(), num_bits);
+    }
+
+    // Take regularly spaced samples of the sorted keys on each rank,
+    // with each sample representing an equal share of the local cells
+    std::vector<std::uint64_t> sorted_keys(keys);
+    std::sort(sorted_keys.begin(), sorted_keys.end());
+    const int num_samples = std::min(num_cells, 16 * nparts);
+    std::vector<std::uint64_t> samples(num_samples);
+    for (int i = 0; i < num_samples; ++i)
+    {
+      samples[i] = sorted_keys[(std::int64_t(2 * i + 1) * num_cells)
+                               / (2 * num_samples)];
+    }
+    const double weight
+        = num_samples > 0 ? double(num_cells) / num_samples : 0.0;
+
+    // Gather the samples from all ranks
+    const int size = dolfinx::MPI::size(comm);
+    std::vector<int> counts(size), displs(size + 1, 0);
+    MPI_Allgather(&num_samples, 1, MPI_INT, counts.data(), 1, MPI_INT, comm);
+    std::partial_sum(counts.begin(), counts.end(), std::next(displs.begin()));
+    std::vector<std::uint64_t> all_samples(displs.back());
+    MPI_Allgatherv(samples.data(), num_samples, MPI_UINT64_T,
+                   all_samples.data(), counts.data(), displs.data(),
+                   MPI_UINT64_T, comm);
+    std::vector<double> weights(size);
+    MPI_Allgather(&weight, 1, MPI_DOUBLE, weights.data(), 1, MPI_DOUBLE, comm);
+
+    // Compute the splitters that divide the sorted samples into parts
+    // of equal weight
+    std::vector<std::pair<std::uint64_t, double>> weighted(displs.back());
+    for (int r = 0; r < size; ++r)
+      for (int i = displs[r]; i < displs[r + 1]; ++i)
+        weighted[i] = {all_samples[i], weights[r]};
+    std::sort(weighted.begin(), weighted.end());
+    const double total = std::accumulate(
+        weighted.begin(), weighted.end(), 0.0,
+        [](double sum, auto& w) { return sum + w.second; });
+    std::vector<std::uint64_t> splitters;
+    splitters.reserve(nparts - 1);
+    double cumulative = 0.0;
+    for (auto [key, w] : weighted)
+    {
+      cumulative += w;
+      while (int(splitters.size()) < nparts - 1
+             and cumulative >= total * (splitters.size() + 1) / nparts)
+      {
+        splitters.push_back(key);
+      }
+    }
+    splitters.resize(nparts - 1, std::numeric_limits<std::uint64_t>::max());
+
+    // Destination of each cell
+    std::vector<std::int32_t> part(num_cells);
+    std::transform(keys.begin(), keys.end(), part.begin(),
+                   [&splitters](auto key)
+                   {
+                     return std::distance(splitters.begin(),
+                                          std::lower_bound(splitters.begin(),
+                                                           splitters.end(),
+                                                           key));
+                   });
+
+    if (ghost_mode == mesh::GhostMode::none)
+      return graph::build_adjacency_list<std::int32_t>(std::move(part), 1);
+    else
+      return add_ghost_destinations(comm, cells, tdim, part);
+  };
+}
+//-----------------------------------------------------------------------------
+mesh::CellPartitionFunction
+mesh::create_cell_partitioner(const graph::partition_fn& partfn,
+                              int num_ghost_layers)
+{
+  return [partfn, num_ghost_layers](
+             MPI_Comm comm, int nparts, int tdim,
+             const graph::AdjacencyList<std::int64_t>& cells,
+             mesh::GhostMode ghost_mode)
+  {
+    return mesh::partition_cells_graph(comm, nparts, tdim, cells, ghost_mode,
+                                       partfn, {}, num_ghost_layers);
+  };
+}
+//-----------------------------------------------------------------------------
+Mesh mesh::create_mesh(MPI_Comm comm,
+                       const graph::AdjacencyList<std::int64_t>& cells,
+                       const fem::CoordinateElement& element,
+                       const xt::xtensor<double, 2>& x,
+                       mesh::GhostMode ghost_mode,
+                       mesh::CellReordering reordering)
+{
+  return create_mesh(
+      comm, cells, element, x, ghost_mode,
+      static_cast<graph::AdjacencyList<std::int32_t> (*)(
+          MPI_Comm, int, int, const graph::AdjacencyList<std::int64_t>&,
+          mesh::GhostMode)>(&mesh::partition_cells_graph),
+      reordering);
+}
+//-----------------------------------------------------------------------------
+Mesh mesh::create_mesh(MPI_Comm comm,
+                       const graph::AdjacencyList<std::int64_t>& cells,
+                       const fem::CoordinateElement& element,
+                       const xt::xtensor<double, 2>& x,
+                       mesh::GhostMode ghost_mode,
+                       const mesh::CellPartitionFunction& cell_partitioner,
+                       mesh::CellReordering reordering)
+{
+  return create_mesh_impl(comm, cells, element, x, ghost_mode,
+                          cell_partitioner, reordering)
+      .first;
+}
+//-----------------------------------------------------------------------------
+std::pair<Mesh, std::vector<std::int64_t>>
+mesh::redistribute(const Mesh& mesh, const xtl::span<const std::int32_t>& dest,
+                   mesh::GhostMode ghost_mode,
+                   mesh::CellReordering reordering)
+{
+  common::Timer timer("Redistribute mesh");
+
+  MPI_Comm comm = mesh.mpi_comm();
+  const int size = dolfinx::MPI::size(comm);
+  const int rank = dolfinx::MPI::rank(comm);
+  const int tdim = mesh.topology().dim();
+  const std::int32_t num_cells = mesh.topology().index_map(tdim)->size_local();
+  if ((std::int32_t)dest.size() != num_cells)
+  {
+    throw std::runtime_error(
+        "Number of destination ranks does not match the number of cells.");
+  }
+
+  // Express the owned cells in terms of the input global indices of
+  // their geometry nodes
+  const Geometry& geometry = mesh.geometry();
+  const graph::AdjacencyList<std::int32_t>& x_dofmap = geometry.dofmap();
+  const std::vector<std::int64_t>& igi = geometry.input_global_indices();
+  std::vector<std::int64_t> cell_nodes;
+  std::vector<std::int32_t> offsets = {0};
+  offsets.reserve(num_cells + 1);
+  for (std::int32_t c = 0; c < num_cells; ++c)
+  {
+    for (std::int32_t n : x_dofmap.links(c))
+      cell_nodes.push_back(igi[n]);
+    offsets.push_back(cell_nodes.size());
+  }
+  const graph::AdjacencyList<std::int64_t> cells(std::move(cell_nodes),
+                                                 std::move(offsets));
+
+  // Send the owned node coordinates to the rank that holds the block
+  // of input global indices that they belong to, which is the input
+  // layout that mesh::create_mesh expects
+  const xt::xtensor<double, 2>& x = geometry.x();
+  const std::size_t gdim = x.shape(1);
+  const std::int64_t num_nodes_global = geometry.index_map()->size_global();
+  const std::int32_t num_nodes = geometry.index_map()->size_local();
+  std::vector<std::vector<std::int64_t>> send_indices(size);
+  std::vector<std::vector<double>> send_x(size);
+  for (std::int32_t i = 0; i < num_nodes; ++i)
+  {
+    const int p = dolfinx::MPI::index_owner(size, igi[i], num_nodes_global);
+    send_indices[p].push_back(igi[i]);
+    for (std::size_t j = 0; j < gdim; ++j)
+      send_x[p].push_back(x(i, j));
+  }
+  const std::vector<std::int64_t> recv_indices
+      = dolfinx::MPI::all_to_all(
+            comm, graph::AdjacencyList<std::int64_t>(send_indices))
+            .array();
+  const std::vector<double> recv_x
+      = dolfinx::MPI::all_to_all(comm,
+                                 graph::AdjacencyList<double>(send_x))
+            .array();
+
+  const std::array<std::int64_t, 2> range
+      = dolfinx::MPI::local_range(rank, num_nodes_global, size);
+  xt::xtensor<double, 2> x_input({std::size_t(range[1] - range[0]), gdim});
+  for (std::size_t i = 0; i < recv_indices.size(); ++i)
+  {
+    const std::int64_t pos = recv_indices[i] - range[0];
+    assert(pos >= 0 and pos < range[1] - range[0]);
+    for (std::size_t j = 0; j < gdim; ++j)
+      x_input(pos, j) = recv_x[i * gdim + j];
+  }
+
+  // The partitioner returns the requested destinations, and adds the
+  // destinations of the cells that are ghosted via a facet
+  const std::vector<std::int32_t> part(dest.begin(), dest.end());
+  auto partitioner
+      = [&part](MPI_Comm comm, int, int tdim,
+                const graph::AdjacencyList<std::int64_t>& cells, GhostMode)
+  { return add_ghost_destinations(comm, cells, tdim, part); };
+
+  return create_mesh_impl(comm, cells, geometry.cmap(), x_input, ghost_mode,
+                          partitioner, reordering);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+std::tuple<Mesh, std::vector<std::int32_t>, std::vector<std::int32_t>,
+           std::vector<std::int32_t>>
+mesh::create_submesh(const Mesh& mesh, int dim,
+                     const xtl::span<const std::int32_t>& entities)
+{
+  common::Timer timer("Create submesh");
+
+  const Topology& topology = mesh.topology();
+  const int tdim = topology.dim();
+  const Geometry& geometry = mesh.geometry();
+  const fem::CoordinateElement& cmap = geometry.cmap();
+  if (dim < 1 or dim > tdim)
+    throw std::runtime_error("Invalid submesh dimension.");
+  if (dim < tdim and cmap.degree() > 1)
+  {
+    throw std::runtime_error(
+        "Submeshes of entities of a higher-order mesh are not supported.");
+  }
+
+  mesh.topology_mutable().create_entities(dim);
+  mesh.topology_mutable().create_connectivity(dim, 0);
+  auto e_to_v = topology.connectivity(dim, 0);
+  assert(e_to_v);
+
+  // Entities of the submesh (the cells)
+  std::vector<std::int32_t> marked(entities.begin(), entities.end());
+  std::sort(marked.begin(), marked.end());
+  marked.erase(std::unique(marked.begin(), marked.end()), marked.end());
+  auto map_e = topology.index_map(dim);
+  assert(map_e);
+  auto [submap_e, sub_e] = create_sub_map(*map_e, marked);
+
+  // Vertices of the submesh
+  std::vector<std::int32_t> e_v;
+  std::vector<std::int32_t> e_offsets(1, 0);
+  for (std::int32_t e : sub_e)
+  {
+    auto vertices = e_to_v->links(e);
+    e_v.insert(e_v.end(), vertices.begin(), vertices.end());
+    e_offsets.push_back(e_v.size());
+  }
+  marked = e_v;
+  std::sort(marked.begin(), marked.end());
+  marked.erase(std::unique(marked.begin(), marked.end()), marked.end());
+  auto map_v = topology.index_map(0);
+  assert(map_v);
+  auto [submap_v, sub_v] = create_sub_map(*map_v, marked);
+
+  // Create the topology, with the entity-vertex connectivity in the
+  // vertex numbering of the submesh
+  const CellType entity_type = cell_entity_type(topology.cell_type(), dim);
+  Topology subtopology(mesh.mpi_comm(), entity_type);
+  subtopology.set_index_map(0, submap_v);
+  subtopology.set_connectivity(
+      std::make_shared<graph::AdjacencyList<std::int32_t>>(sub_v.size()), 0,
+      0);
+  subtopology.set_index_map(dim, submap_e);
+  subtopology.set_connectivity(
+      std::make_shared<graph::AdjacencyList<std::int32_t>>(
+          renumber(e_v, sub_v,
+                   map_v->size_local() + map_v->num_ghosts()),
+          e_offsets),
+      dim, 0);
+
+  // Geometry nodes of each submesh cell. For a submesh of cells the
+  // geometry dofmap of the cells is used, otherwise the coordinate
+  // element is affine and the nodes are the entity vertices.
+  std::vector<std::int32_t> e_x;
+  std::vector<std::int32_t> x_offsets(1, 0);
+  if (dim == tdim)
+  {
+    const graph::AdjacencyList<std::int32_t>& x_dofmap = geometry.dofmap();
+    for (std::int32_t c : sub_e)
+    {
+      auto dofs = x_dofmap.links(c);
+      e_x.insert(e_x.end(), dofs.begin(), dofs.end());
+      x_offsets.push_back(e_x.size());
+    }
+  }
+  else
+  {
+    const xt::xtensor<std::int32_t, 2> entity_x
+        = entities_to_geometry(mesh, dim, sub_e, false);
+    e_x.assign(entity_x.begin(), entity_x.end());
+    for (std::size_t i = 0; i < entity_x.shape(0); ++i)
+      x_offsets.push_back((i + 1) * entity_x.shape(1));
+  }
+  marked = e_x;
+  std::sort(marked.begin(), marked.end());
+  marked.erase(std::unique(marked.begin(), marked.end()), marked.end());
+  auto map_x = geometry.index_map();
+  assert(map_x);
+  auto [submap_x, sub_x] = create_sub_map(*map_x, marked);
+
+  // Copy the coordinates and input global indices of the nodes
+  const xt::xtensor<double, 2>& x = geometry.x();
+  const std::vector<std::int64_t>& igi = geometry.input_global_indices();
+  const int gdim = geometry.dim();
+  xt::xtensor<double, 2> subx(
+      {sub_x.size(), static_cast<std::size_t>(gdim)});
+  std::vector<std::int64_t> sub_igi(sub_x.size());
+  for (std::size_t i = 0; i < sub_x.size(); ++i)
+  {
+    for (int j = 0; j < gdim; ++j)
+      subx(i, j) = x(sub_x[i], j);
+    sub_igi[i] = igi[sub_x[i]];
+  }
+
+  const fem::CoordinateElement subcmap
+      = dim == tdim ? cmap : fem::CoordinateElement(entity_type, 1);
+  Geometry subgeometry(
+      submap_x,
+      graph::AdjacencyList<std::int32_t>(
+          renumber(e_x, sub_x, map_x->size_local() + map_x->num_ghosts()),
+          std::move(x_offsets)),
+      subcmap, std::move(subx), std::move(sub_igi));
+
+  return {Mesh(mesh.mpi_comm(), std::move(subtopology),
+               std::move(subgeometry)),
+          std::move(sub_e), std::move(sub_v), std::move(sub_x)};
+}
 //-----------------------------------------------------------------------------
 Topology& Mesh::topology() { return _topology; }
 //-----------------------------------------------------------------------------
@@ -13,7 +13,10 @@
 #include <dolfinx/common/MPI.h>
 #include <dolfinx/common/UniqueIdGenerator.h>
 #include <string>
+#include <tuple>
 #include <utility>
+#include <vector>
+#include <xtl/xspan.hpp>
 
 namespace dolfinx::fem
 {
@@ -47,6 +50,24 @@ enum class GhostMode : int
   shared_vertex
 };
 
+/// Enum for the reordering of the cells that are owned by a rank,
+/// which is applied when a mesh is created to improve data locality.
+/// The vertices are numbered in the order in which they are first
+/// visited by the (re-ordered) cells, so the cell reordering also
+/// determines the vertex order.
+enum class CellReordering : int
+{
+  /// Keep the order in which the cells are received after partitioning
+  none,
+  /// Gibbs-Poole-Stockmeyer ordering of the local dual graph
+  gps,
+  /// Reverse Cuthill-McKee ordering of the local dual graph
+  reverse_cuthill_mckee,
+  /// Order of the cell midpoints along a Morton (Z-order)
+  /// space-filling curve
+  morton
+};
+
 /// A Mesh consists of a set of connected and numbered mesh topological
 /// entities, and geometry data
 class Mesh
@@ -134,6 +155,37 @@ private:
   std::size_t _unique_id = common::UniqueIdGenerator::id();
 };
 
+/// Create a geometric cell partitioner for mesh::create_mesh. The
+/// cells are ordered along a Hilbert space-filling curve through their
+/// (vertex) midpoints and the curve is split into @p nparts segments
+/// with approximately equal numbers of cells, using the sorted samples
+/// of the curve positions from all ranks. No graph partitioner is
+/// called. The distributed dual graph is only computed if ghosting is
+/// requested, to find the ghost cells.
+///
+/// The partitioner is much cheaper than graph partitioning, and gives
+/// partitions of acceptable quality for meshes with a smooth cell size
+/// distribution.
+///
+/// @param[in] x The coordinates of the mesh nodes on this rank, i.e.
+/// the coordinates that are passed to mesh::create_mesh. The partitioner
+/// keeps a copy.
+/// @return The cell partitioner
+CellPartitionFunction
+create_cell_partitioner_sfc(const xt::xtensor<double, 2>& x);
+
+/// Create a cell partitioner for mesh::create_mesh that applies a graph
+/// partitioner to the dual graph of the mesh, e.g. the compute
+/// node-aware partitioner graph::create_hierarchical_partitioner
+///
+/// @param[in] partfn The graph partitioner
+/// @param[in] num_ghost_layers The number of layers of ghost cells for
+/// a ghosted mesh, see mesh::partition_cells_graph
+/// @return The cell partitioner
+CellPartitionFunction
+create_cell_partitioner(const graph::partition_fn& partfn,
+                        int num_ghost_layers = 1);
+
 /// Create a mesh using the default partitioner. This function takes
 /// mesh input data that is distributed across processes and creates a
 /// @p Mesh, with the cell distribution determined by the default cell
@@ -149,15 +201,70 @@ private:
 /// geometric mapping for cells
 /// @param[in] x The coordinates of mesh nodes
 /// @param[in] ghost_mode The requested type of cell ghosting/overlap
+/// @param[in] reordering The reordering of the owned cells (and
+/// vertices) on each rank. It must be the same on all ranks.
 /// @return A distributed Mesh.
 Mesh create_mesh(MPI_Comm comm, const graph::AdjacencyList<std::int64_t>& cells,
                  const fem::CoordinateElement& element,
-                 const xt::xtensor<double, 2>& x, GhostMode ghost_mode);
+                 const xt::xtensor<double, 2>& x, GhostMode ghost_mode,
+                 CellReordering reordering = CellReordering::gps);
 
 /// Create a mesh using a provided mesh partitioning function
 Mesh create_mesh(MPI_Comm comm, const graph::AdjacencyList<std::int64_t>& cells,
                  const fem::CoordinateElement& element,
                  const xt::xtensor<double, 2>& x, GhostMode ghost_mode,
-                 const CellPartitionFunction& cell_partitioner);
+                 const CellPartitionFunction& cell_partitioner,
+                 CellReordering reordering = CellReordering::gps);
+
+/// Redistribute a mesh across the ranks of its communicator. The owned
+/// cells are sent to the given ranks, with their geometry, and the
+/// topology and index maps of the new mesh are built as in
+/// mesh::create_mesh. The input global indices of the geometry nodes
+/// (Geometry::input_global_indices) are preserved, so data that is
+/// defined in terms of these indices, e.g. tags read from file, can be
+/// read for the new mesh.
+///
+/// Data attached to the original mesh is migrated using the returned
+/// cell map, see mesh::migrate_cell_data, mesh::migrate_meshtags and
+/// fem::migrate_function.
+///
+/// @note Collective over the mesh communicator
+/// @param[in] mesh The mesh to redistribute
+/// @param[in] dest The destination rank of each owned cell of @p mesh
+/// @param[in] ghost_mode The type of cell ghosting of the new mesh
+/// @param[in] reordering The reordering of the owned cells on each rank
+/// @return The redistributed mesh and, for each cell (owned and ghost)
+/// of the new mesh, the global index of the cell in @p mesh
+std::pair<Mesh, std::vector<std::int64_t>>
+redistribute(const Mesh& mesh, const xtl::span<const std::int32_t>& dest,
+             GhostMode ghost_mode,
+             CellReordering reordering = CellReordering::gps);
+
+/// Create a mesh of a subset of the entities of a mesh, e.g. of the
+/// cells of a subdomain or of the facets of a boundary. The cells of
+/// the submesh keep the distribution of the entities of @p mesh, and
+/// the index maps of the submesh are created by filtering the index
+/// maps of @p mesh (see common::create_sub_index_map), so no
+/// repartitioning or parallel topology computation is required.
+///
+/// An entity is in the submesh on the ranks on which it is in @p
+/// entities, and on its owner. The returned maps from the submesh to
+/// @p mesh are used to transfer data between the meshes, e.g. to
+/// assemble coupled problems.
+///
+/// @note Collective over the mesh communicator
+/// @note Geometries of degree greater than one are supported only for
+/// submeshes of cells, i.e. for @p dim equal to the topological
+/// dimension
+/// @param[in] mesh The mesh
+/// @param[in] dim Topological dimension of the entities
+/// @param[in] entities Local indices (owned and ghost) of the entities
+/// @return The submesh and, for each local (owned and ghost) cell,
+/// vertex and geometry node of the submesh, the local index of the
+/// entity, vertex and geometry node in @p mesh
+std::tuple<Mesh, std::vector<std::int32_t>, std::vector<std::int32_t>,
+           std::vector<std::int32_t>>
+create_submesh(const Mesh& mesh, int dim,
+               const xtl::span<const std::int32_t>& entities);
 
 } // namespace dolfinx::mesh
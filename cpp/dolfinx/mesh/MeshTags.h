@@ -9,8 +9,10 @@
 #include "Geometry.h"
 #include "Mesh.h"
 #include "Topology.h"
+#include "utils.h"
 #include <algorithm>
 #include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/MPI.h>
 #include <dolfinx/common/UniqueIdGenerator.h>
 #include <dolfinx/common/utils.h>
 #include <dolfinx/graph/AdjacencyList.h>
@@ -18,6 +20,7 @@
 #include <dolfinx/io/cells.h>
 #include <map>
 #include <memory>
+#include <numeric>
 #include <utility>
 #include <vector>
 #include <xtl/xspan.hpp>
@@ -77,10 +80,19 @@ public:
   MeshTags& operator=(MeshTags&& tags) = default;
 
   /// Find all entities with a given tag value
+  /// @note If the value index has been computed (see
+  /// MeshTags::value_index), it is used instead of searching all
+  /// values
   /// @param[in] value The value
   /// @return Indices of tagged entities
   std::vector<std::int32_t> find(const T value) const
   {
+    if (_value_index)
+    {
+      xtl::span<const std::int32_t> e = entities(value);
+      return std::vector<std::int32_t>(e.begin(), e.end());
+    }
+
     int n = std::count(_values.begin(), _values.end(), value);
     std::vector<std::int32_t> indices(n);
     int counter = 0;
@@ -92,6 +104,62 @@ public:
     return indices;
   }
 
+  /// Return an index of the tagged entities by tag value. The index
+  /// is computed on the first call and is reused by later calls.
+  /// @return The sorted unique tag values, and an adjacency list whose
+  /// links for node `i` are the (sorted) entities with tag value
+  /// `value_index().first[i]`
+  const std::pair<std::vector<T>, graph::AdjacencyList<std::int32_t>>&
+  value_index() const
+  {
+    if (!_value_index)
+    {
+      // Order the tags by value, keeping the entities for each value
+      // sorted
+      std::vector<std::int32_t> perm(_values.size());
+      std::iota(perm.begin(), perm.end(), 0);
+      std::stable_sort(perm.begin(), perm.end(),
+                       [&v = _values](auto p0, auto p1)
+                       { return v[p0] < v[p1]; });
+
+      std::vector<T> values;
+      std::vector<std::int32_t> entities(perm.size());
+      std::vector<std::int32_t> offsets = {0};
+      for (std::size_t i = 0; i < perm.size(); ++i)
+      {
+        const T value = _values[perm[i]];
+        if (values.empty() or values.back() != value)
+        {
+          values.push_back(value);
+          offsets.push_back(offsets.back());
+        }
+        entities[i] = _indices[perm[i]];
+        ++offsets.back();
+      }
+
+      _value_index = std::make_shared<
+          const std::pair<std::vector<T>, graph::AdjacencyList<std::int32_t>>>(
+          std::move(values), graph::AdjacencyList<std::int32_t>(
+                                 std::move(entities), std::move(offsets)));
+    }
+
+    return *_value_index;
+  }
+
+  /// Entities with a given tag value, using the value index (see
+  /// MeshTags::value_index)
+  /// @param[in] value The value
+  /// @return Indices of tagged entities (sorted), empty if no entity
+  /// has the tag value
+  xtl::span<const std::int32_t> entities(const T value) const
+  {
+    const auto& [values, index] = value_index();
+    auto it = std::lower_bound(values.begin(), values.end(), value);
+    if (it == values.end() or *it != value)
+      return xtl::span<const std::int32_t>();
+    return index.links(std::distance(values.begin(), it));
+  }
+
   /// Indices of tagged mesh entities (local-to-process). The indices
   /// are sorted.
   const std::vector<std::int32_t>& indices() const { return _indices; }
@@ -126,6 +194,11 @@ private:
 
   // Values attached to entities
   std::vector<T> _values;
+
+  // Index from tag values to entities, computed on first use
+  mutable std::shared_ptr<
+      const std::pair<std::vector<T>, graph::AdjacencyList<std::int32_t>>>
+      _value_index;
 };
 
 /// Create MeshTags from arrays
@@ -194,4 +267,139 @@ create_meshtags(const std::shared_ptr<const mesh::Mesh>& mesh, const int dim,
   return mesh::MeshTags<T>(mesh, dim, std::move(indices_sorted),
                            std::move(values_sorted));
 }
+
+/// Migrate MeshTags to a redistributed mesh (see mesh::redistribute).
+/// The tags are first made known on all ranks that have a tagged
+/// entity, and the tags of the entities of each cell are then fetched
+/// from the rank that owned the cell in the original mesh.
+///
+/// @note Collective over the mesh communicator
+/// @param[in] tags The tags on the original mesh
+/// @param[in] mesh The redistributed mesh
+/// @param[in] cells The global index in the original mesh of each cell
+/// (owned and ghost) of @p mesh, as returned by mesh::redistribute
+/// @return The tags on @p mesh
+template <typename T>
+mesh::MeshTags<T>
+migrate_meshtags(const mesh::MeshTags<T>& tags,
+                 const std::shared_ptr<const mesh::Mesh>& mesh,
+                 const xtl::span<const std::int64_t>& cells)
+{
+  std::shared_ptr<const mesh::Mesh> mesh0 = tags.mesh();
+  assert(mesh0);
+  assert(mesh);
+  MPI_Comm comm = mesh0->mpi_comm();
+  const int size = dolfinx::MPI::size(comm);
+  const int dim = tags.dim();
+  const int tdim = mesh0->topology().dim();
+  mesh0->topology_mutable().create_entities(dim);
+  mesh0->topology_mutable().create_connectivity(tdim, dim);
+
+  // Mark the tagged entities on this rank
+  auto map_e = mesh0->topology().index_map(dim);
+  assert(map_e);
+  const std::int32_t num_owned = map_e->size_local();
+  const std::int32_t num_ghosts = map_e->num_ghosts();
+  std::vector<std::int32_t> marker(num_owned + num_ghosts, 0);
+  std::vector<T> values(num_owned + num_ghosts);
+  for (std::size_t i = 0; i < tags.indices().size(); ++i)
+  {
+    marker[tags.indices()[i]] = 1;
+    values[tags.indices()[i]] = tags.values()[i];
+  }
+
+  // Send the tags of ghost entities to the owner
+  const std::vector<std::int64_t>& ghosts = map_e->ghosts();
+  const std::vector<int> ghost_owners = map_e->ghost_owner_rank();
+  std::vector<std::vector<std::int64_t>> send_ghosts(size);
+  std::vector<std::vector<T>> send_values(size);
+  for (std::int32_t i = 0; i < num_ghosts; ++i)
+  {
+    if (marker[num_owned + i])
+    {
+      send_ghosts[ghost_owners[i]].push_back(ghosts[i]);
+      send_values[ghost_owners[i]].push_back(values[num_owned + i]);
+    }
+  }
+  const std::vector<std::int64_t> recv_ghosts
+      = dolfinx::MPI::all_to_all(
+            comm, graph::AdjacencyList<std::int64_t>(send_ghosts))
+            .array();
+  const std::vector<T> recv_values
+      = dolfinx::MPI::all_to_all(comm, graph::AdjacencyList<T>(send_values))
+            .array();
+  const std::int64_t offset = map_e->local_range()[0];
+  for (std::size_t i = 0; i < recv_ghosts.size(); ++i)
+  {
+    marker[recv_ghosts[i] - offset] = 1;
+    values[recv_ghosts[i] - offset] = recv_values[i];
+  }
+
+  // Update the ghost entities from the owners
+  map_e->scatter_fwd(
+      xtl::span<const std::int32_t>(marker.data(), num_owned),
+      xtl::span<std::int32_t>(marker.data() + num_owned, num_ghosts), 1);
+  map_e->scatter_fwd(xtl::span<const T>(values.data(), num_owned),
+                     xtl::span<T>(values.data() + num_owned, num_ghosts), 1);
+
+  // Pack the local index and the tag of the tagged entities of each
+  // owned cell
+  auto c_to_e0 = mesh0->topology().connectivity(tdim, dim);
+  assert(c_to_e0);
+  auto cell_map0 = mesh0->topology().index_map(tdim);
+  assert(cell_map0);
+  std::vector<std::int32_t> local_entities, offsets = {0};
+  std::vector<T> cell_values;
+  for (std::int32_t c = 0; c < cell_map0->size_local(); ++c)
+  {
+    auto entities = c_to_e0->links(c);
+    for (std::size_t l = 0; l < entities.size(); ++l)
+    {
+      if (marker[entities[l]])
+      {
+        local_entities.push_back(l);
+        cell_values.push_back(values[entities[l]]);
+      }
+    }
+    offsets.push_back(local_entities.size());
+  }
+  const graph::AdjacencyList<std::int32_t> local_entities1
+      = mesh::migrate_cell_data(
+          comm, *cell_map0,
+          graph::AdjacencyList<std::int32_t>(std::move(local_entities),
+                                             offsets),
+          cells);
+  const graph::AdjacencyList<T> cell_values1 = mesh::migrate_cell_data(
+      comm, *cell_map0,
+      graph::AdjacencyList<T>(std::move(cell_values), std::move(offsets)),
+      cells);
+
+  // Tag the entities of the cells of the new mesh
+  mesh->topology_mutable().create_entities(dim);
+  mesh->topology_mutable().create_connectivity(tdim, dim);
+  auto c_to_e1 = mesh->topology().connectivity(tdim, dim);
+  assert(c_to_e1);
+  if (std::int32_t(cells.size()) != c_to_e1->num_nodes())
+    throw std::runtime_error("Cell map size mismatch");
+  std::vector<std::int32_t> indices1;
+  std::vector<T> values1;
+  for (std::size_t c = 0; c < cells.size(); ++c)
+  {
+    auto entities = c_to_e1->links(c);
+    auto l = local_entities1.links(c);
+    auto v = cell_values1.links(c);
+    for (std::size_t k = 0; k < l.size(); ++k)
+    {
+      indices1.push_back(entities[l[k]]);
+      values1.push_back(v[k]);
+    }
+  }
+
+  auto [indices_sorted, values_sorted]
+      = common::sort_unique(indices1, values1);
+  mesh::MeshTags<T> tags1(mesh, dim, std::move(indices_sorted),
+                          std::move(values_sorted));
+  tags1.name = tags.name;
+  return tags1;
+}
 } // namespace dolfinx::mesh
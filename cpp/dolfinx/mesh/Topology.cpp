@@ -9,6 +9,7 @@
 #include "topologycomputation.h"
 #include "utils.h"
 #include <algorithm>
+#include <array>
 #include <dolfinx/common/IndexMap.h>
 #include <dolfinx/common/log.h>
 #include <dolfinx/common/utils.h>
@@ -16,8 +17,8 @@
 #include <dolfinx/graph/AdjacencyList.h>
 #include <dolfinx/graph/partition.h>
 #include <dolfinx/mesh/Mesh.h>
+#include <map>
 #include <numeric>
-#include <random>
 #include <unordered_map>
 #include <xtl/xspan.hpp>
 
@@ -30,8 +31,8 @@ namespace
 
 /// Compute list of processes sharing the same index
 /// @param unknown_indices List of indices on each process
-/// @return a map to sharing processes for each index, with the (random)
-/// owner as the first in the list
+/// @return a map to sharing processes for each index, with the owner as
+/// the first in the list
 std::unordered_map<std::int64_t, std::vector<int>>
 compute_index_sharing(MPI_Comm comm, std::vector<std::int64_t>& unknown_indices)
 {
@@ -61,36 +62,43 @@ compute_index_sharing(MPI_Comm comm, std::vector<std::int64_t>& unknown_indices)
       = dolfinx::MPI::all_to_all(
           comm, graph::AdjacencyList<std::int64_t>(send_indices));
 
-  // Get index sharing - ownership will be first entry (randomised later)
-  std::unordered_map<std::int64_t, std::vector<int>> index_to_owner;
+  // Get index sharing, as (index, rank) pairs sorted by index
+  std::vector<std::pair<std::int64_t, int>> index_to_rank;
+  index_to_rank.reserve(recv_indices.array().size());
   for (int p = 0; p < recv_indices.num_nodes(); ++p)
   {
-    auto recv_p = recv_indices.links(p);
-    for (std::size_t j = 0; j < recv_p.size(); ++j)
-      index_to_owner[recv_p[j]].push_back(p);
+    for (std::int64_t index : recv_indices.links(p))
+      index_to_rank.push_back({index, p});
   }
+  std::sort(index_to_rank.begin(), index_to_rank.end());
 
-  std::mt19937 g(0);
-  // Randomise ownership
-  for (auto& map_entry : index_to_owner)
+  // Choose the owner of each index from its sharing ranks using a hash
+  // of the index, and make the owner the first entry
+  for (auto it = index_to_rank.begin(); it != index_to_rank.end();)
   {
-    std::vector<int>& procs = map_entry.second;
-    std::shuffle(procs.begin(), procs.end(), g);
+    auto it1 = std::find_if(it, index_to_rank.end(),
+                            [index = it->first](auto& q)
+                            { return q.first != index; });
+    const std::size_t owner
+        = common::hash_indices(std::array{it->first}) % (it1 - it);
+    std::swap(it->second, std::next(it, owner)->second);
+    it = it1;
   }
 
   // Send index ownership data back to all sharing processes
   std::vector<std::vector<int>> send_owner(mpi_size);
   for (int p = 0; p < recv_indices.num_nodes(); ++p)
   {
-    auto recv_p = recv_indices.links(p);
-    for (std::size_t j = 0; j < recv_p.size(); ++j)
+    for (std::int64_t index : recv_indices.links(p))
     {
-      const auto it = index_to_owner.find(recv_p[j]);
-      assert(it != index_to_owner.end());
-      const std::vector<int>& sharing_procs = it->second;
-      send_owner[p].push_back(sharing_procs.size());
-      for (int sp : sharing_procs)
-        send_owner[p].push_back(sp);
+      auto [it0, it1] = std::equal_range(
+          index_to_rank.begin(), index_to_rank.end(),
+          std::pair<std::int64_t, int>(index, 0),
+          [](auto& a, auto& b) { return a.first < b.first; });
+      assert(it0 != it1);
+      send_owner[p].push_back(std::distance(it0, it1));
+      for (auto it = it0; it != it1; ++it)
+        send_owner[p].push_back(it->second);
     }
   }
 
@@ -100,7 +108,7 @@ compute_index_sharing(MPI_Comm comm, std::vector<std::int64_t>& unknown_indices)
       = dolfinx::MPI::all_to_all(comm, graph::AdjacencyList<int>(send_owner));
 
   // Now fill index_to_owner with locally needed indices
-  index_to_owner.clear();
+  std::unordered_map<std::int64_t, std::vector<int>> index_to_owner;
   for (int p = 0; p < mpi_size; ++p)
   {
     const std::vector<std::int64_t>& send_v = send_indices[p];
@@ -117,39 +125,73 @@ compute_index_sharing(MPI_Comm comm, std::vector<std::int64_t>& unknown_indices)
 
   return index_to_owner;
 }
-} // namespace
 
-//-----------------------------------------------------------------------------
-std::vector<bool> mesh::compute_boundary_facets(const Topology& topology)
+/// Compute the owned facets that are on the exterior of the domain,
+/// i.e. are connected to only one cell and are not shared with another
+/// process
+/// @param[in] topology The topology
+/// @return The exterior facets (sorted local indices)
+std::vector<std::int32_t> exterior_facets(const Topology& topology)
 {
   const int tdim = topology.dim();
-
   auto facets = topology.index_map(tdim - 1);
   if (!facets)
     throw std::runtime_error("Facets have not been computed.");
-  std::set<std::int32_t> fwd_shared_facets;
-  if (facets->num_ghosts() == 0)
-  {
-    fwd_shared_facets
-        = std::set<std::int32_t>(facets->shared_indices().array().begin(),
-                                 facets->shared_indices().array().end());
-  }
-
   std::shared_ptr<const graph::AdjacencyList<std::int32_t>> fc
       = topology.connectivity(tdim - 1, tdim);
   if (!fc)
     throw std::runtime_error("Facet-cell connectivity missing.");
-  std::vector<bool> _boundary_facet(facets->size_local(), false);
-  for (std::size_t f = 0; f < _boundary_facet.size(); ++f)
+
+  // Only need to consider shared facets when there are no ghost cells.
+  // With ghost cells, a facet on a process boundary is connected to a
+  // ghost cell.
+  std::vector<std::int32_t> fwd_shared_facets;
+  assert(topology.index_map(tdim));
+  if (topology.index_map(tdim)->num_ghosts() == 0)
+  {
+    const std::vector<std::int32_t>& shared
+        = facets->shared_indices().array();
+    fwd_shared_facets.assign(shared.begin(), shared.end());
+    std::sort(fwd_shared_facets.begin(), fwd_shared_facets.end());
+  }
+
+  std::vector<std::int32_t> exterior;
+  for (std::int32_t f = 0; f < facets->size_local(); ++f)
   {
     if (fc->num_links(f) == 1
-        and fwd_shared_facets.find(f) == fwd_shared_facets.end())
+        and !std::binary_search(fwd_shared_facets.begin(),
+                                fwd_shared_facets.end(), f))
     {
-      _boundary_facet[f] = true;
+      exterior.push_back(f);
     }
   }
 
-  return _boundary_facet;
+  return exterior;
+}
+} // namespace
+
+//-----------------------------------------------------------------------------
+std::vector<bool> mesh::compute_boundary_facets(const Topology& topology)
+{
+  const int tdim = topology.dim();
+  auto facets = topology.index_map(tdim - 1);
+  if (!facets)
+    throw std::runtime_error("Facets have not been computed.");
+
+  // Use the exterior facets stored by the topology if available
+  std::vector<bool> boundary_facet(facets->size_local(), false);
+  if (auto exterior = topology.boundary_facets(); exterior)
+  {
+    for (std::int32_t f : *exterior)
+      boundary_facet[f] = true;
+  }
+  else
+  {
+    for (std::int32_t f : exterior_facets(topology))
+      boundary_facet[f] = true;
+  }
+
+  return boundary_facet;
 }
 //-----------------------------------------------------------------------------
 Topology::Topology(MPI_Comm comm, mesh::CellType type)
@@ -168,6 +210,8 @@ void Topology::set_index_map(int dim,
                              const std::shared_ptr<const common::IndexMap>& map)
 {
   assert(dim < (int)_index_map.size());
+  if (_index_map[dim] and _index_map[dim] != map)
+    ++_version;
   _index_map[dim] = map;
 }
 //-----------------------------------------------------------------------------
@@ -177,7 +221,7 @@ std::shared_ptr<const common::IndexMap> Topology::index_map(int dim) const
   return _index_map[dim];
 }
 //-----------------------------------------------------------------------------
-std::int32_t Topology::create_entities(int dim)
+std::int32_t Topology::create_entities(int dim, int num_threads)
 {
   // TODO: is this check sufficient/correct? Does not catch the cell_entity
   // entity case. Should there also be a check for
@@ -188,7 +232,7 @@ std::int32_t Topology::create_entities(int dim)
 
   // Create local entities
   const auto [cell_entity, entity_vertex, index_map]
-      = mesh::compute_entities(_mpi_comm.comm(), *this, dim);
+      = mesh::compute_entities(_mpi_comm.comm(), *this, dim, num_threads);
 
   if (cell_entity)
     set_connectivity(cell_entity, this->dim(), dim);
@@ -203,14 +247,15 @@ std::int32_t Topology::create_entities(int dim)
   return index_map->size_local();
 }
 //-----------------------------------------------------------------------------
-void Topology::create_connectivity(int d0, int d1)
+void Topology::create_connectivity(int d0, int d1, int num_threads)
 {
   // Make sure entities exist
-  create_entities(d0);
-  create_entities(d1);
+  create_entities(d0, num_threads);
+  create_entities(d1, num_threads);
 
   // Compute connectivity
-  const auto [c_d0_d1, c_d1_d0] = mesh::compute_connectivity(*this, d0, d1);
+  const auto [c_d0_d1, c_d1_d0]
+      = mesh::compute_connectivity(*this, d0, d1, num_threads);
 
   // NOTE: that to compute the (d0, d1) connections is it sometimes
   // necessary to compute the (d1, d0) connections. We store the (d1,
@@ -231,25 +276,34 @@ void Topology::create_connectivity(int d0, int d1)
     set_connectivity(c_d1_d0, d1, d0);
 }
 //-----------------------------------------------------------------------------
-void Topology::create_entity_permutations()
+void Topology::create_entity_permutations(int num_threads)
 {
   if (!_cell_permutations.empty())
     return;
 
   const int tdim = this->dim();
 
-  // FIXME: Is this always required? Could it be made cheaper by doing a
-  // local version? This call does quite a lot of parallel work
+  // FIXME: The permutations only need the cell-vertex connectivity, but
+  // users of the permutations (e.g. mesh::create_geometry) rely on the
+  // entities being created here. This call does quite a lot of parallel
+  // work.
   // Create all mesh entities
   for (int d = 0; d < tdim; ++d)
     create_entities(d);
 
   auto [facet_permutations, cell_permutations]
-      = mesh::compute_entity_permutations(*this);
+      = mesh::compute_entity_permutations(*this, num_threads);
   _facet_permutations = std::move(facet_permutations);
   _cell_permutations = std::move(cell_permutations);
 }
 //-----------------------------------------------------------------------------
+void Topology::create_facet_permutations(int num_threads)
+{
+  if (!_facet_permutations.empty())
+    return;
+  _facet_permutations = mesh::compute_facet_permutations(*this, num_threads);
+}
+//-----------------------------------------------------------------------------
 void Topology::create_connectivity_all()
 {
   // Compute all entities
@@ -262,6 +316,59 @@ void Topology::create_connectivity_all()
       create_connectivity(d0, d1);
 }
 //-----------------------------------------------------------------------------
+void Topology::create_boundary_facets()
+{
+  if (_boundary_facets)
+    return;
+
+  const int tdim = this->dim();
+  create_entities(tdim - 1);
+  create_connectivity(tdim - 1, tdim);
+  _boundary_facets = std::make_shared<const std::vector<std::int32_t>>(
+      exterior_facets(*this));
+}
+//-----------------------------------------------------------------------------
+std::shared_ptr<const std::vector<std::int32_t>>
+Topology::boundary_facets() const
+{
+  return _boundary_facets;
+}
+//-----------------------------------------------------------------------------
+void Topology::release_connectivity(int d0, int d1)
+{
+  assert(d0 < (int)_connectivity.size());
+  assert(d1 < (int)_connectivity[d0].size());
+  if (d1 == 0)
+  {
+    throw std::runtime_error("Connectivity (" + std::to_string(d0)
+                             + ", 0) defines the mesh entities and cannot "
+                               "be released.");
+  }
+  _connectivity[d0][d1] = nullptr;
+}
+//-----------------------------------------------------------------------------
+void Topology::compact_connectivity()
+{
+  // Connectivities that are shared by several pairs of dimensions
+  // remain shared
+  std::map<const graph::AdjacencyList<std::int32_t>*,
+           std::shared_ptr<graph::AdjacencyList<std::int32_t>>>
+      compacted;
+  for (auto& c0 : _connectivity)
+  {
+    for (auto& c : c0)
+    {
+      if (!c)
+        continue;
+      auto it = compacted.find(c.get());
+      if (it == compacted.end())
+        it = compacted.insert({c.get(), graph::compact(*c)}).first;
+      if (it->second)
+        c = it->second;
+    }
+  }
+}
+//-----------------------------------------------------------------------------
 std::shared_ptr<const graph::AdjacencyList<std::int32_t>>
 Topology::connectivity(int d0, int d1) const
 {
@@ -275,6 +382,8 @@ void Topology::set_connectivity(
 {
   assert(d0 < (int)_connectivity.size());
   assert(d1 < (int)_connectivity[d0].size());
+  if (_connectivity[d0][d1] and _connectivity[d0][d1] != c)
+    ++_version;
   _connectivity[d0][d1] = c;
 }
 //-----------------------------------------------------------------------------
@@ -302,6 +411,40 @@ mesh::CellType Topology::cell_type() const { return _cell_type; }
 //-----------------------------------------------------------------------------
 MPI_Comm Topology::mpi_comm() const { return _mpi_comm.comm(); }
 //-----------------------------------------------------------------------------
+std::size_t Topology::memory_usage(int d0, int d1) const
+{
+  assert(d0 < (int)_connectivity.size());
+  assert(d1 < (int)_connectivity[d0].size());
+  if (auto c = _connectivity[d0][d1]; c)
+    return c->memory_usage();
+  else
+    return 0;
+}
+//-----------------------------------------------------------------------------
+std::size_t Topology::memory_usage() const
+{
+  std::size_t size = _facet_permutations.capacity() * sizeof(std::uint8_t)
+                     + _cell_permutations.capacity() * sizeof(std::uint32_t);
+  if (_boundary_facets)
+    size += _boundary_facets->capacity() * sizeof(std::int32_t);
+
+  // Count connectivities that are shared by several pairs of dimensions
+  // once
+  std::vector<const graph::AdjacencyList<std::int32_t>*> connectivities;
+  for (auto& c0 : _connectivity)
+    for (auto& c : c0)
+      if (c)
+        connectivities.push_back(c.get());
+  std::sort(connectivities.begin(), connectivities.end());
+  connectivities.erase(
+      std::unique(connectivities.begin(), connectivities.end()),
+      connectivities.end());
+  for (auto c : connectivities)
+    size += c->memory_usage();
+
+  return size;
+}
+//-----------------------------------------------------------------------------
 Topology
 mesh::create_topology(MPI_Comm comm,
                       const graph::AdjacencyList<std::int64_t>& cells,
@@ -454,6 +597,18 @@ mesh::create_topology(MPI_Comm comm,
   std::set<int> vertex_neighbor_ranks;
   for (const auto& q : global_vertex_to_ranks)
     vertex_neighbor_ranks.insert(q.second.begin(), q.second.end());
+
+  // Ranks that share each cell, if there are ghost cells
+  const graph::AdjacencyList<int> shared_cells
+      = ghost_mode != mesh::GhostMode::none
+            ? index_map_c->compute_sharing_ranks()
+            : graph::AdjacencyList<int>(0);
+
+  // With more than one layer of ghost cells, a rank that shares a cell
+  // with this rank may not share a vertex of an owned cell, so add the
+  // ranks that share cells
+  vertex_neighbor_ranks.insert(shared_cells.array().begin(),
+                               shared_cells.array().end());
   vertex_neighbor_ranks.erase(mpi_rank); // Remove my rank
 
   // Build map from neighbor global rank to neighbor local rank
@@ -524,23 +679,13 @@ mesh::create_topology(MPI_Comm comm,
     // Receive index of ghost vertices that are not on the process
     // boundary from the ghost cell owner. Note: the ghost cell owner
     // might not be the same as the vertex owner.
-    std::map<std::int32_t, std::set<std::int32_t>> shared_cells
-        = index_map_c->compute_shared_indices();
     std::map<std::int64_t, std::set<std::int32_t>> fwd_shared_vertices;
     for (int i = 0; i < index_map_c->size_local(); ++i)
     {
-      if (const auto it = shared_cells.find(i); it != shared_cells.end())
+      if (auto ranks = shared_cells.links(i); !ranks.empty())
       {
         for (std::int32_t v : cells.links(i))
-        {
-          if (const auto vit = fwd_shared_vertices.find(v);
-              vit == fwd_shared_vertices.end())
-          {
-            fwd_shared_vertices.insert({v, it->second});
-          }
-          else
-            vit->second.insert(it->second.begin(), it->second.end());
-        }
+          fwd_shared_vertices[v].insert(ranks.begin(), ranks.end());
       }
     }
 
@@ -623,33 +768,20 @@ mesh::create_topology(MPI_Comm comm,
 
   MPI_Comm_free(&neighbor_comm);
 
+  // Convert the cells (global indexing) to local indexing, discarding
+  // the ghost cells if they are not required. All cells have the same
+  // number of vertices, so the cell-vertex connectivity (which is also
+  // the geometry dofmap for vertex-only geometries) is compact.
   const std::vector<std::int64_t>& cells_array = cells.array();
-  std::shared_ptr<graph::AdjacencyList<std::int32_t>> my_local_cells;
-  if (ghost_mode == mesh::GhostMode::none)
-  {
-    // Convert non-ghost cells (global indexing) to my_local_cells
-    // (local indexing) and discard ghost cells
-    std::vector<std::int32_t> local_offsets(
-        cells.offsets().begin(),
-        std::next(cells.offsets().begin(), num_local_cells + 1));
-
-    std::vector<std::int32_t> cells_array_local(local_offsets.back());
-    for (std::size_t i = 0; i < cells_array_local.size(); ++i)
-      cells_array_local[i] = global_to_local_vertices.at(cells_array[i]);
-
-    my_local_cells = std::make_shared<graph::AdjacencyList<std::int32_t>>(
-        std::move(cells_array_local), std::move(local_offsets));
-  }
-  else
-  {
-    // Convert my_cells (global indexing) to my_local_cells (local
-    // indexing)
-    std::vector<std::int32_t> cells_array_local(cells_array.size());
-    for (std::size_t i = 0; i < cells_array_local.size(); ++i)
-      cells_array_local[i] = global_to_local_vertices.at(cells_array[i]);
-    my_local_cells = std::make_shared<graph::AdjacencyList<std::int32_t>>(
-        std::move(cells_array_local), cells.offsets());
-  }
+  const int num_vertices_per_cell = mesh::num_cell_vertices(cell_type);
+  std::vector<std::int32_t> cells_array_local(
+      ghost_mode == mesh::GhostMode::none
+          ? std::size_t(num_local_cells) * num_vertices_per_cell
+          : cells_array.size());
+  for (std::size_t i = 0; i < cells_array_local.size(); ++i)
+    cells_array_local[i] = global_to_local_vertices.at(cells_array[i]);
+  auto my_local_cells = std::make_shared<graph::AdjacencyList<std::int32_t>>(
+      std::move(cells_array_local), num_vertices_per_cell);
 
   Topology topology(comm, cell_type);
   const int tdim = topology.dim();
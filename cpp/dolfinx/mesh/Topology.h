@@ -38,8 +38,10 @@ enum class CellType;
 class Topology;
 
 /// Compute marker for owned facets that are on the exterior of the
-/// domain, i.e. are connected to only one cell. The function does not
-/// require parallel communication.
+/// domain, i.e. are connected to only one cell and are not shared with
+/// another process. The function does not require parallel
+/// communication. If the exterior facets have been computed by
+/// Topology::create_boundary_facets, they are reused.
 /// @param[in] topology The topology
 /// @return Vector with length equal to the number of owned facets on
 ///   this this process. True if the ith facet (local index) is on the
@@ -128,25 +130,94 @@ public:
   // creation of entities
   /// Create entities of given topological dimension.
   /// @param[in] dim Topological dimension
+  /// @param[in] num_threads The number of threads used to compute the
+  ///   local numbering of the entities
   /// @return Number of newly created entities, returns -1 if entities
   ///   already existed
-  std::int32_t create_entities(int dim);
+  std::int32_t create_entities(int dim, int num_threads = 1);
 
   /// Create connectivity between given pair of dimensions, d0 -> d1
   /// @param[in] d0 Topological dimension
   /// @param[in] d1 Topological dimension
-  void create_connectivity(int d0, int d1);
+  /// @param[in] num_threads The number of threads used to create the
+  ///   entities and to compute the connectivity
+  void create_connectivity(int d0, int d1, int num_threads = 1);
 
   /// Compute entity permutations and reflections
-  void create_entity_permutations();
+  /// @param[in] num_threads The number of threads used to compute the
+  ///   permutations
+  void create_entity_permutations(int num_threads = 1);
+
+  /// Compute the facet permutations only, see get_facet_permutations.
+  /// This is cheaper than create_entity_permutations when the cell
+  /// permutation info is not required, e.g. for forms that only need
+  /// the facet permutations.
+  /// @param[in] num_threads The number of threads used to compute the
+  ///   permutations
+  void create_facet_permutations(int num_threads = 1);
 
   /// Compute all entities and connectivity
   void create_connectivity_all();
 
+  /// Compute the owned exterior facets, see compute_boundary_facets,
+  /// and store them for reuse by functions that work on the boundary,
+  /// e.g. mesh::locate_entities_boundary, mesh::exterior_facet_indices
+  /// and the default exterior facet integrals of fem::Form. Creates the
+  /// facets and the facet-cell connectivity if required. Does nothing
+  /// if the exterior facets have already been computed.
+  /// @note The facets of a topology are not renumbered once created,
+  /// so the stored exterior facets remain valid
+  void create_boundary_facets();
+
+  /// Return the owned exterior facets computed by
+  /// create_boundary_facets
+  /// @return Sorted list of facet indices (local to the process), or
+  /// nullptr if the exterior facets have not been computed
+  std::shared_ptr<const std::vector<std::int32_t>> boundary_facets() const;
+
+  /// Release the connectivity from entities of dimension d0 to
+  /// entities of dimension d1 to free memory. If it is needed again, it
+  /// is recomputed by Topology::create_connectivity.
+  /// @note The connectivities (d, 0) define the entities and cannot be
+  /// released
+  /// @param[in] d0 Topological dimension
+  /// @param[in] d1 Topological dimension
+  void release_connectivity(int d0, int d1);
+
+  /// Store the connectivities with the same number of connections for
+  /// each entity (e.g. cell-to-vertex and cell-to-facet) in the
+  /// compact format without offsets, see
+  /// graph::AdjacencyList::is_compact. Connectivities that are computed
+  /// later are stored in the standard format.
+  void compact_connectivity();
+
+  /// Version of the topology. The version is incremented when an index
+  /// map or a connectivity that has been set is replaced, i.e. when
+  /// data derived from the topology (e.g. packed facet data or
+  /// colourings) may be out of date. Creating an index map or
+  /// connectivity that did not exist does not change the version.
+  /// @return The version
+  std::uint64_t version() const { return _version; }
+
   /// Mesh MPI communicator
   /// @return The communicator on which the topology is distributed
   MPI_Comm mpi_comm() const;
 
+  /// Return the memory allocated by the connectivity d0 -> d1
+  /// @param[in] d0 Topological dimension
+  /// @param[in] d1 Topological dimension
+  /// @return The number of bytes (zero if the connectivity has not
+  /// been computed)
+  std::size_t memory_usage(int d0, int d1) const;
+
+  /// Return the memory allocated by the topology, i.e. by the
+  /// connectivities, the entity permutations and the exterior facets
+  /// (if computed). The index maps are
+  /// not included as they may be shared with other objects, see
+  /// common::IndexMap::memory_usage.
+  /// @return The number of bytes
+  std::size_t memory_usage() const;
+
 private:
   // MPI communicator
   dolfinx::MPI::Comm _mpi_comm;
@@ -169,6 +240,12 @@ private:
   // Cell permutation info. See the documentation for
   // get_cell_permutation_info for documentation of how this is encoded.
   std::vector<std::uint32_t> _cell_permutations;
+
+  // Owned exterior facets
+  std::shared_ptr<const std::vector<std::int32_t>> _boundary_facets;
+
+  // Version of the topology
+  std::uint64_t _version = 0;
 };
 
 /// Create distributed topology
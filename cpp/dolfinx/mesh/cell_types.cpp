@@ -6,14 +6,13 @@
 
 #include "cell_types.h"
 #include "Geometry.h"
+#include "reference_cell.h"
 #include <algorithm>
-#include <basix/cell.h>
 #include <cfloat>
 #include <cstdlib>
 #include <numeric>
 #include <stdexcept>
 #include <xtensor/xbuilder.hpp>
-#include <xtensor/xfixed.hpp>
 
 using namespace dolfinx;
 
@@ -108,10 +107,20 @@ mesh::CellType mesh::cell_facet_type(mesh::CellType type)
 graph::AdjacencyList<int> mesh::get_entity_vertices(mesh::CellType type,
                                                     int dim)
 {
-  const std::vector<std::vector<int>> topology
-      = basix::cell::topology(basix::cell::str_to_type(to_string(type)))[dim];
+  const ReferenceCell& ref = reference_cell(type);
+  std::vector<int> offsets(ref.num_entities[dim] + 1, 0);
+  for (int e = 0; e < ref.num_entities[dim]; ++e)
+    offsets[e + 1] = offsets[e] + ref.num_entity_vertices(dim, e);
 
-  return graph::AdjacencyList<int>(topology);
+  std::vector<int> vertices(offsets.back());
+  for (int e = 0; e < ref.num_entities[dim]; ++e)
+  {
+    std::copy_n(ref.entity_vertices[dim][e].begin(),
+                offsets[e + 1] - offsets[e],
+                std::next(vertices.begin(), offsets[e]));
+  }
+
+  return graph::AdjacencyList<int>(std::move(vertices), std::move(offsets));
 }
 //-----------------------------------------------------------------------------
 xt::xtensor<int, 2> mesh::get_sub_entities(CellType type, int dim0, int dim1)
@@ -127,91 +136,36 @@ xt::xtensor<int, 2> mesh::get_sub_entities(CellType type, int dim0, int dim1)
         "mesh::get_sub_entities supports getting edges (d=1) at present.");
   }
 
-  // TODO: get this data from basix
-  static const xt::xtensor_fixed<int, xt::xshape<1, 3>> triangle = {{0, 1, 2}};
-  static const xt::xtensor_fixed<int, xt::xshape<1, 4>> quadrilateral
-      = {{0, 1, 2, 3}};
-  static const xt::xtensor_fixed<int, xt::xshape<4, 3>> tetrahedron
-      = {{0, 1, 2}, {0, 3, 4}, {1, 3, 5}, {2, 4, 5}};
-  static const xt::xtensor_fixed<int, xt::xshape<6, 4>> hexahedron
-      = {{0, 1, 3, 5},  {0, 2, 4, 8},  {1, 2, 6, 9},
-         {3, 4, 7, 10}, {5, 6, 7, 11}, {8, 9, 10, 11}};
-  switch (type)
-  {
-  case mesh::CellType::interval:
+  const ReferenceCell& ref = reference_cell(type);
+  if (ref.dim < 2)
     return xt::empty<int>({0, 0});
-  case mesh::CellType::point:
-    return xt::empty<int>({0, 0});
-  case mesh::CellType::triangle:
-    return triangle;
-  case mesh::CellType::tetrahedron:
-    return tetrahedron;
-  case mesh::CellType::quadrilateral:
-    return quadrilateral;
-  case mesh::CellType::hexahedron:
-    return hexahedron;
-  default:
-    throw std::runtime_error("Unsupported cell type.");
-  }
-}
-//-----------------------------------------------------------------------------
-int mesh::cell_dim(mesh::CellType type)
-{
-  switch (type)
+
+  // The faces of prisms and pyramids have different numbers of edges
+  const std::size_t num_faces = ref.num_entities[2];
+  const std::size_t num_edges = ref.num_face_vertices[0];
+  for (std::size_t f = 1; f < num_faces; ++f)
   {
-  case mesh::CellType::point:
-    return 0;
-  case mesh::CellType::interval:
-    return 1;
-  case mesh::CellType::triangle:
-    return 2;
-  case mesh::CellType::tetrahedron:
-    return 3;
-  case mesh::CellType::quadrilateral:
-    return 2;
-  case mesh::CellType::pyramid:
-    return 3;
-  case mesh::CellType::prism:
-    return 3;
-  case mesh::CellType::hexahedron:
-    return 3;
-  default:
-    throw std::runtime_error("Unknown cell type.");
+    if ((std::size_t)ref.num_face_vertices[f] != num_edges)
+    {
+      throw std::runtime_error(
+          "mesh::get_sub_entities does not support cells with different "
+          "face types.");
+    }
   }
+
+  xt::xtensor<int, 2> entities({num_faces, num_edges});
+  for (std::size_t f = 0; f < num_faces; ++f)
+    for (std::size_t e = 0; e < num_edges; ++e)
+      entities(f, e) = ref.face_edges[f][e];
+  return entities;
 }
 //-----------------------------------------------------------------------------
+int mesh::cell_dim(mesh::CellType type) { return reference_cell(type).dim; }
+//-----------------------------------------------------------------------------
 int mesh::cell_num_entities(mesh::CellType type, int dim)
 {
   assert(dim <= 3);
-  constexpr std::array<int, 4> point = {1, 0, 0, 0};
-  constexpr std::array<int, 4> interval = {2, 1, 0, 0};
-  constexpr std::array<int, 4> triangle = {3, 3, 1, 0};
-  constexpr std::array<int, 4> quadrilateral = {4, 4, 1, 0};
-  constexpr std::array<int, 4> tetrahedron = {4, 6, 4, 1};
-  constexpr std::array<int, 4> pyramid = {5, 8, 5, 1};
-  constexpr std::array<int, 4> prism = {6, 9, 5, 1};
-  constexpr std::array<int, 4> hexahedron = {8, 12, 6, 1};
-  switch (type)
-  {
-  case mesh::CellType::point:
-    return point[dim];
-  case mesh::CellType::interval:
-    return interval[dim];
-  case mesh::CellType::triangle:
-    return triangle[dim];
-  case mesh::CellType::tetrahedron:
-    return tetrahedron[dim];
-  case mesh::CellType::quadrilateral:
-    return quadrilateral[dim];
-  case mesh::CellType::pyramid:
-    return pyramid[dim];
-  case mesh::CellType::prism:
-    return prism[dim];
-  case mesh::CellType::hexahedron:
-    return hexahedron[dim];
-  default:
-    throw std::runtime_error("Unknown cell type.");
-  }
+  return reference_cell(type).num_entities[dim];
 }
 //-----------------------------------------------------------------------------
 bool mesh::is_simplex(mesh::CellType type)
@@ -227,57 +181,44 @@ int mesh::num_cell_vertices(mesh::CellType type)
 std::map<std::array<int, 2>, std::vector<std::set<int>>>
 mesh::cell_entity_closure(mesh::CellType cell_type)
 {
-  const int cell_dim = mesh::cell_dim(cell_type);
-  std::array<int, 4> num_entities;
-  for (int i = 0; i <= cell_dim; ++i)
-    num_entities[i] = mesh::cell_num_entities(cell_type, i);
-
-  const graph::AdjacencyList<int> edge_v
-      = mesh::get_entity_vertices(cell_type, 1);
-  const auto face_e = mesh::get_sub_entities(cell_type, 2, 1);
+  const ReferenceCell& ref = reference_cell(cell_type);
+  const int cell_dim = ref.dim;
+  const auto& edge_v = ref.entity_vertices[1];
 
   std::map<std::array<int, 2>, std::vector<std::set<int>>> entity_closure;
   for (int dim = 0; dim <= cell_dim; ++dim)
   {
-    for (int entity = 0; entity < num_entities[dim]; ++entity)
+    for (int entity = 0; entity < ref.num_entities[dim]; ++entity)
     {
       // Add self
-      entity_closure[{{dim, entity}}].resize(cell_dim + 1);
-      entity_closure[{{dim, entity}}][dim].insert(entity);
+      std::vector<std::set<int>>& closure = entity_closure[{{dim, entity}}];
+      closure.resize(cell_dim + 1);
+      closure[dim].insert(entity);
 
       if (dim == 3)
       {
         // Add all sub-entities
-        for (int f = 0; f < num_entities[2]; ++f)
-          entity_closure[{{dim, entity}}][2].insert(f);
-        for (int e = 0; e < num_entities[1]; ++e)
-          entity_closure[{{dim, entity}}][1].insert(e);
-        for (int v = 0; v < num_entities[0]; ++v)
-          entity_closure[{{dim, entity}}][0].insert(v);
+        for (int d = 0; d < 3; ++d)
+          for (int e = 0; e < ref.num_entities[d]; ++e)
+            closure[d].insert(e);
       }
 
       if (dim == 2)
       {
-        mesh::CellType face_type = mesh::cell_entity_type(cell_type, 2);
-        const int num_edges = mesh::cell_num_entities(face_type, 1);
-        for (int e = 0; e < num_edges; ++e)
+        for (int e = 0; e < ref.num_face_vertices[entity]; ++e)
         {
-          // Add edge
-          const int edge_index = face_e(entity, e);
-          entity_closure[{{dim, entity}}][1].insert(edge_index);
-          for (int v = 0; v < 2; ++v)
-          {
-            // Add vertex connected to edge
-            entity_closure[{{dim, entity}}][0].insert(
-                edge_v.links(edge_index)[v]);
-          }
+          // Add edge and the vertices connected to the edge
+          const int edge_index = ref.face_edges[entity][e];
+          closure[1].insert(edge_index);
+          closure[0].insert(edge_v[edge_index][0]);
+          closure[0].insert(edge_v[edge_index][1]);
         }
       }
 
       if (dim == 1)
       {
-        entity_closure[{{dim, entity}}][0].insert(edge_v.links(entity)[0]);
-        entity_closure[{{dim, entity}}][0].insert(edge_v.links(entity)[1]);
+        closure[0].insert(edge_v[entity][0]);
+        closure[0].insert(edge_v[entity][1]);
       }
     }
   }
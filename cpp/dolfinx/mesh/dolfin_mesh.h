@@ -17,4 +17,5 @@ namespace dolfinx
 #include <dolfinx/mesh/MeshTags.h>
 #include <dolfinx/mesh/Topology.h>
 #include <dolfinx/mesh/cell_types.h>
+#include <dolfinx/mesh/reference_cell.h>
 #include <dolfinx/mesh/utils.h>
@@ -6,11 +6,18 @@
 
 #include "graphbuild.h"
 #include <algorithm>
+#include <array>
+#include <dolfinx/common/Arena.h>
 #include <dolfinx/common/MPI.h>
 #include <dolfinx/common/Timer.h>
 #include <dolfinx/common/log.h>
+#include <dolfinx/common/sort.h>
+#include <dolfinx/common/utils.h>
 #include <dolfinx/graph/AdjacencyList.h>
 #include <dolfinx/mesh/cell_types.h>
+#include <limits>
+#include <numeric>
+#include <set>
 #include <utility>
 #include <vector>
 #include <xtensor/xview.hpp>
@@ -101,7 +108,9 @@ compute_local_dual_graph_keyed(
   }
 
   // List of facets and associated cells
-  std::vector<std::array<std::int64_t, 5>> facets(num_facets);
+  common::ArenaScope scope;
+  std::pmr::vector<std::array<std::int64_t, 5>> facets(num_facets,
+                                                       scope.resource());
   int counter = 0;
   for (std::int32_t i = 0; i < num_local_cells; ++i)
   {
@@ -192,7 +201,8 @@ compute_local_dual_graph_keyed(
   }
 
   // Get connection counts for each cell
-  std::vector<std::int32_t> num_local_graph(num_local_cells, 0);
+  std::pmr::vector<std::int32_t> num_local_graph(num_local_cells, 0,
+                                                 scope.resource());
   for (std::int32_t cell : local_graph)
   {
     assert(cell < num_local_cells);
@@ -204,7 +214,8 @@ compute_local_dual_graph_keyed(
   std::vector<std::int32_t> local_graph_data(offsets.back());
 
   // Build adjacency data
-  std::vector<std::int32_t> pos(offsets.begin(), offsets.end() - 1);
+  std::pmr::vector<std::int32_t> pos(offsets.begin(), offsets.end() - 1,
+                                     scope.resource());
   for (std::size_t i = 0; i < local_graph.size(); i += 2)
   {
     const std::size_t c0 = local_graph[i];
@@ -224,13 +235,14 @@ compute_local_dual_graph_keyed(
 //-----------------------------------------------------------------------------
 // Build nonlocal part of dual graph for mesh and return number of
 // non-local edges. Note: GraphBuilder::compute_local_dual_graph should
-// be called before this function is called. Returns (ghost vertices,
+// be called before this function is called. The received facets are
+// sorted using num_threads threads. Returns (ghost vertices,
 // num_nonlocal_edges)
 std::pair<graph::AdjacencyList<std::int64_t>, std::int32_t>
 compute_nonlocal_dual_graph(
     const MPI_Comm comm, std::int32_t num_local_cells,
     const xt::xtensor<std::int64_t, 2>& facet_cell_map,
-    const graph::AdjacencyList<std::int32_t>& local_graph)
+    const graph::AdjacencyList<std::int32_t>& local_graph, int num_threads)
 {
   LOG(INFO) << "Build nonlocal part of mesh dual graph";
   common::Timer timer("Compute non-local part of mesh dual graph");
@@ -257,11 +269,9 @@ compute_nonlocal_dual_graph(
   // At this stage facet_cell map only contains facets->cells with edge
   // facets either interprocess or external boundaries
 
-  // Find the global range of the first vertex index of each facet in the list
-  // and use this to divide up the facets between all processes.
-
-  // TODO: improve scalability, possibly by limiting the number of
-  // processes which do the matching, and using a neighbor comm?
+  // Find the global range of the first vertex index of each facet in
+  // the list and use this to divide up the facets between all
+  // processes
   std::int64_t local_min = std::numeric_limits<std::int64_t>::max();
   std::int64_t local_max = 0;
   if (facet_cell_map.shape(0) > 0)
@@ -276,24 +286,56 @@ compute_nonlocal_dual_graph(
   MPI_Allreduce(&local_max, &global_max, 1, MPI_INT64_T, MPI_MAX, comm);
   const std::int64_t global_range = global_max - global_min + 1;
 
+  // Intermediary match-making process for each facet
+  std::vector<int> facet_dest(facet_cell_map.shape(0));
+  for (std::size_t i = 0; i < facet_cell_map.shape(0); ++i)
+  {
+    facet_dest[i] = dolfinx::MPI::index_owner(
+        num_processes, facet_cell_map(i, 0) - global_min, global_range);
+  }
+
+  // Create neighbourhood communicators from the processes that this
+  // process sends facets to, and the processes that send facets to
+  // this process, so that the communication volume scales with the
+  // number of facets on the process boundaries
+  std::vector<int> dest_ranks(facet_dest);
+  std::sort(dest_ranks.begin(), dest_ranks.end());
+  dest_ranks.erase(std::unique(dest_ranks.begin(), dest_ranks.end()),
+                   dest_ranks.end());
+  std::vector<int> src_ranks = dolfinx::MPI::compute_graph_edges(
+      comm, std::set<int>(dest_ranks.begin(), dest_ranks.end()));
+  std::sort(src_ranks.begin(), src_ranks.end());
+  MPI_Comm comm_fwd, comm_rev;
+  MPI_Dist_graph_create_adjacent(
+      comm, src_ranks.size(), src_ranks.data(), MPI_UNWEIGHTED,
+      dest_ranks.size(), dest_ranks.data(), MPI_UNWEIGHTED, MPI_INFO_NULL,
+      false, &comm_fwd);
+  MPI_Dist_graph_create_adjacent(
+      comm, dest_ranks.size(), dest_ranks.data(), MPI_UNWEIGHTED,
+      src_ranks.size(), src_ranks.data(), MPI_UNWEIGHTED, MPI_INFO_NULL,
+      false, &comm_rev);
+  const dolfinx::MPI::Comm neighbor_comm_fwd(comm_fwd, false);
+  const dolfinx::MPI::Comm neighbor_comm_rev(comm_rev, false);
+  for (int& d : facet_dest)
+  {
+    d = std::distance(dest_ranks.begin(),
+                      std::lower_bound(dest_ranks.begin(), dest_ranks.end(),
+                                       d));
+  }
+
   // Send facet-cell map to intermediary match-making processes
 
   // Get cell offset for this process to create global numbering for cells
   const std::int64_t cell_offset
       = dolfinx::MPI::global_offset(comm, num_local_cells, true);
 
-  // Count number of item to send to each rank
-  std::vector<int> p_count(num_processes, 0);
-  for (std::size_t i = 0; i < facet_cell_map.shape(0); ++i)
-  {
-    // Use first vertex of facet to partition into blocks
-    const int dest_proc = dolfinx::MPI::index_owner(
-        num_processes, facet_cell_map(i, 0) - global_min, global_range);
-    p_count[dest_proc] += num_vertices_per_facet + 1;
-  }
+  // Count number of item to send to each neighbour
+  std::vector<int> p_count(dest_ranks.size(), 0);
+  for (int d : facet_dest)
+    p_count[d] += num_vertices_per_facet + 1;
 
   // Create back adjacency list send buffer
-  std::vector<std::int32_t> offsets(num_processes + 1, 0);
+  std::vector<std::int32_t> offsets(dest_ranks.size() + 1, 0);
   std::partial_sum(p_count.begin(), p_count.end(),
                    std::next(offsets.begin(), 1));
   graph::AdjacencyList<std::int64_t> send_buffer(
@@ -303,29 +345,30 @@ compute_nonlocal_dual_graph(
   std::vector<int> pos(send_buffer.num_nodes(), 0);
   for (std::size_t i = 0; i < facet_cell_map.shape(0); ++i)
   {
-    const int dest_proc = dolfinx::MPI::index_owner(
-        num_processes, facet_cell_map(i, 0) - global_min, global_range);
-    xtl::span<std::int64_t> buffer = send_buffer.links(dest_proc);
+    const int dest = facet_dest[i];
+    xtl::span<std::int64_t> buffer = send_buffer.links(dest);
 
     for (int j = 0; j < (num_vertices_per_facet + 1); ++j)
-      buffer[pos[dest_proc] + j] = facet_cell_map(i, j);
-    buffer[pos[dest_proc] + num_vertices_per_facet] += cell_offset;
+      buffer[pos[dest] + j] = facet_cell_map(i, j);
+    buffer[pos[dest] + num_vertices_per_facet] += cell_offset;
 
-    pos[dest_proc] += num_vertices_per_facet + 1;
+    pos[dest] += num_vertices_per_facet + 1;
   }
 
   // Send data
   graph::AdjacencyList<std::int64_t> recvd_buffer
-      = dolfinx::MPI::all_to_all(comm, send_buffer);
+      = dolfinx::MPI::neighbor_all_to_all(neighbor_comm_fwd.comm(),
+                                          send_buffer);
   assert(recvd_buffer.array().size() % (num_vertices_per_facet + 1) == 0);
   const int num_facets
       = recvd_buffer.array().size() / (num_vertices_per_facet + 1);
 
-  // Set up vector of owning processes for each received facet
+  // Set up vector of sending (neighbour) process for each received
+  // facet
   const std::vector<std::int32_t>& recvd_buffer_offsets
       = recvd_buffer.offsets();
   std::vector<int> proc(num_facets);
-  for (int p = 0; p < num_processes; ++p)
+  for (int p = 0; p < recvd_buffer.num_nodes(); ++p)
   {
     for (int j = recvd_buffer_offsets[p] / (num_vertices_per_facet + 1);
          j < recvd_buffer_offsets[p + 1] / (num_vertices_per_facet + 1); ++j)
@@ -343,17 +386,65 @@ compute_nonlocal_dual_graph(
         std::move(recvd_buffer.array()), std::move(offsets));
   }
 
-  // Get permutation that takes facets into sorted order
-  std::vector<int> perm(num_facets);
-  std::iota(perm.begin(), perm.end(), 0);
-  std::sort(perm.begin(), perm.end(), [&recvd_buffer](int a, int b) {
-    return std::lexicographical_compare(
-        recvd_buffer.links(a).begin(), std::prev(recvd_buffer.links(a).end()),
-        recvd_buffer.links(b).begin(), std::prev(recvd_buffer.links(b).end()));
-  });
-
-  // Count data items to send to each rank
-  p_count.assign(num_processes, 0);
+  // Get permutation that takes facets into sorted order. If the facet
+  // vertices (relative to the smallest received vertex index) fit into
+  // 128 bits, pack them into integer keys for a (threaded) radix sort.
+  std::int64_t vmin = std::numeric_limits<std::int64_t>::max();
+  std::int64_t vmax = std::numeric_limits<std::int64_t>::min();
+  for (int i = 0; i < num_facets; ++i)
+  {
+    auto facet = recvd_buffer.links(i);
+    auto [it0, it1]
+        = std::minmax_element(facet.begin(), std::prev(facet.end()));
+    vmin = std::min(vmin, *it0);
+    vmax = std::max(vmax, *it1);
+  }
+  int bits = 1;
+  while (num_facets > 0 and bits < 63 and ((vmax - vmin) >> bits) > 0)
+    ++bits;
+
+  std::vector<std::int32_t> perm;
+  if (bits * num_vertices_per_facet <= 128)
+  {
+    common::ArenaScope scope;
+    std::pmr::vector<std::array<std::uint64_t, 2>> keys(num_facets,
+                                                        scope.resource());
+    common::for_each_part(
+        num_facets, num_threads,
+        [&](std::int64_t i0, std::int64_t i1, int)
+        {
+          for (std::int64_t i = i0; i < i1; ++i)
+          {
+            auto facet = recvd_buffer.links(i);
+            std::array<std::uint64_t, 2>& key = keys[i];
+            key = {0, 0};
+            for (int j = 0; j < num_vertices_per_facet; ++j)
+            {
+              key[0] = (key[0] << bits) | (key[1] >> (64 - bits));
+              key[1] = (key[1] << bits) | std::uint64_t(facet[j] - vmin);
+            }
+          }
+        });
+    perm = common::sort_by_key(keys, bits * num_vertices_per_facet,
+                               num_threads);
+  }
+  else
+  {
+    perm.resize(num_facets);
+    std::iota(perm.begin(), perm.end(), 0);
+    std::sort(perm.begin(), perm.end(),
+              [&recvd_buffer](int a, int b)
+              {
+                return std::lexicographical_compare(
+                    recvd_buffer.links(a).begin(),
+                    std::prev(recvd_buffer.links(a).end()),
+                    recvd_buffer.links(b).begin(),
+                    std::prev(recvd_buffer.links(b).end()));
+              });
+  }
+
+  // Count data items to send to each (neighbour) rank
+  p_count.assign(src_ranks.size(), 0);
   bool this_equal, last_equal = false;
   std::vector<bool> facet_match(num_facets, false);
   for (int i = 1; i < num_facets; ++i)
@@ -380,7 +471,7 @@ compute_nonlocal_dual_graph(
   }
 
   // Create back adjacency list send buffer
-  offsets.assign(num_processes + 1, 0);
+  offsets.assign(src_ranks.size() + 1, 0);
   std::partial_sum(p_count.begin(), p_count.end(),
                    std::next(offsets.begin(), 1));
   send_buffer = graph::AdjacencyList<std::int64_t>(
@@ -412,7 +503,9 @@ compute_nonlocal_dual_graph(
 
   // Send matches to other processes
   const std::vector<std::int64_t> cell_list
-      = dolfinx::MPI::all_to_all(comm, send_buffer).array();
+      = dolfinx::MPI::neighbor_all_to_all(neighbor_comm_rev.comm(),
+                                          send_buffer)
+            .array();
 
   // Ghost nodes: insert connected cells into local map
 
@@ -474,7 +567,7 @@ compute_nonlocal_dual_graph(
 std::pair<graph::AdjacencyList<std::int64_t>, std::array<std::int32_t, 2>>
 mesh::build_dual_graph(const MPI_Comm mpi_comm,
                        const graph::AdjacencyList<std::int64_t>& cell_vertices,
-                       int tdim)
+                       int tdim, int num_threads)
 {
   LOG(INFO) << "Build mesh dual graph";
 
@@ -484,7 +577,8 @@ mesh::build_dual_graph(const MPI_Comm mpi_comm,
 
   // Compute nonlocal part
   auto [graph, num_ghost_nodes] = compute_nonlocal_dual_graph(
-      mpi_comm, cell_vertices.num_nodes(), facet_cell_map, local_graph);
+      mpi_comm, cell_vertices.num_nodes(), facet_cell_map, local_graph,
+      num_threads);
 
   LOG(INFO) << "Graph edges (local:" << local_graph.offsets().back()
             << ", non-local:"
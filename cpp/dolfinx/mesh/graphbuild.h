@@ -20,11 +20,13 @@ enum class CellType;
 
 /// Build distributed dual graph (cell-cell connections) from minimal
 /// mesh data, and return (graph, ghost_vertices, [num local edges,
-/// num non-local edges])
+/// num non-local edges]). Facets on the process boundaries are matched
+/// on intermediary processes using neighbourhood communication, with
+/// the received facets sorted using @p num_threads threads.
 std::pair<graph::AdjacencyList<std::int64_t>, std::array<std::int32_t, 2>>
 build_dual_graph(const MPI_Comm comm,
                  const graph::AdjacencyList<std::int64_t>& cell_vertices,
-                 int tdim);
+                 int tdim, int num_threads = 1);
 
 /// Compute local part of the dual graph (cell-cell connections via
 /// facets)
@@ -5,9 +5,12 @@
 // SPDX-License-Identifier:    LGPL-3.0-or-later
 
 #include "permutationcomputation.h"
+#include "cell_types.h"
+#include "reference_cell.h"
 #include <algorithm>
-#include <bitset>
+#include <array>
 #include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/utils.h>
 #include <dolfinx/graph/AdjacencyList.h>
 #include <dolfinx/mesh/Topology.h>
 
@@ -21,348 +24,209 @@ using namespace dolfinx;
 namespace
 {
 //-----------------------------------------------------------------------------
-template <int BITSETSIZE>
-std::vector<std::bitset<BITSETSIZE>> compute_face_permutations_simplex(
-    const graph::AdjacencyList<std::int32_t>& c_to_v,
-    const graph::AdjacencyList<std::int32_t>& c_to_f,
-    const graph::AdjacencyList<std::int32_t>& f_to_v, int faces_per_cell,
-    const common::IndexMap& im)
-{
-  const std::int32_t num_cells = c_to_v.num_nodes();
-  std::vector<std::bitset<BITSETSIZE>> face_perm(num_cells, 0);
-  std::vector<std::int64_t> cell_vertices, vertices;
-  for (int c = 0; c < num_cells; ++c)
-  {
-    cell_vertices.resize(c_to_v.links(c).size());
-    im.local_to_global(c_to_v.links(c), cell_vertices);
-    auto cell_faces = c_to_f.links(c);
-    for (int i = 0; i < faces_per_cell; ++i)
-    {
-      // Get the face
-      const int face = cell_faces[i];
-      vertices.resize(f_to_v.links(face).size());
-      im.local_to_global(f_to_v.links(face), vertices);
-
-      // Orient that triangle so the the lowest numbered vertex is the
-      // origin, and the next vertex anticlockwise from the lowest has a
-      // lower number than the next vertex clockwise. Find the index of
-      // the lowest numbered vertex
-
-      // Store local vertex indices here
-      std::array<std::int32_t, 3> e_vertices;
-
-      // Find iterators pointing to cell vertex given a vertex on facet
-      for (int j = 0; j < 3; ++j)
-      {
-        auto it = std::find(cell_vertices.begin(), cell_vertices.end(),
-                            vertices[j]);
-        // Get the actual local vertex indices
-        e_vertices[j] = std::distance(cell_vertices.begin(), it);
-      }
-
-      // Number of rotations
-      std::uint8_t min_v = 0;
-      for (int v = 1; v < 3; ++v)
-        if (e_vertices[v] < e_vertices[min_v])
-          min_v = v;
-
-      // pre is the number of the next vertex clockwise from the lowest
-      // numbered vertex
-      const int pre = min_v == 0 ? e_vertices[3 - 1] : e_vertices[min_v - 1];
 
-      // post is the number of the next vertex anticlockwise from the
-      // lowest numbered vertex
-      const int post = min_v == 3 - 1 ? e_vertices[0] : e_vertices[min_v + 1];
-
-      std::uint8_t g_min_v = 0;
-      for (int v = 1; v < 3; ++v)
-        if (vertices[v] < vertices[g_min_v])
-          g_min_v = v;
-
-      // pre is the number of the next vertex clockwise from the lowest
-      // numbered vertex
-      const int g_pre = g_min_v == 0 ? vertices[3 - 1] : vertices[g_min_v - 1];
-
-      // post is the number of the next vertex anticlockwise from the
-      // lowest numbered vertex
-      const int g_post = g_min_v == 3 - 1 ? vertices[0] : vertices[g_min_v + 1];
-
-      std::uint8_t rots = 0;
-      if (g_post > g_pre)
-        rots = min_v <= g_min_v ? g_min_v - min_v : g_min_v + 3 - min_v;
-      else
-        rots = g_min_v <= min_v ? min_v - g_min_v : min_v + 3 - g_min_v;
-
-      face_perm[c][3 * i] = (post > pre) == (g_post < g_pre);
-      face_perm[c][3 * i + 1] = rots % 2;
-      face_perm[c][3 * i + 2] = rots / 2;
-    }
-  }
+/// Compute the permutation number `n` of a triangle, with `n % 2` the
+/// number of reflections and `n / 2` the number of rotations. The
+/// triangle is oriented so that the lowest numbered vertex is the
+/// origin, and the next vertex anticlockwise from the lowest has a
+/// lower number than the next vertex clockwise.
+/// @param[in] g The global indices of the vertices of the triangle, in
+/// the order of the reference triangle
+/// @return The permutation number
+std::uint8_t triangle_permutation(const std::array<std::int64_t, 4>& g)
+{
+  int min_v = 0;
+  for (int v = 1; v < 3; ++v)
+    if (g[v] < g[min_v])
+      min_v = v;
+
+  const bool reflect = g[(min_v + 1) % 3] > g[(min_v + 2) % 3];
+  const int rots = reflect ? min_v : (3 - min_v) % 3;
+  return reflect + 2 * rots;
+}
+//-----------------------------------------------------------------------------
 
-  return face_perm;
+/// Compute the permutation number of a quadrilateral, see
+/// triangle_permutation. The vertices are in tensor-product order, i.e.
+/// the vertices of the reference quadrilateral in anticlockwise order
+/// are 0, 1, 3, 2.
+/// @param[in] g The global indices of the vertices of the
+/// quadrilateral, in the order of the reference quadrilateral
+/// @return The permutation number
+std::uint8_t quadrilateral_permutation(const std::array<std::int64_t, 4>& g)
+{
+  int min_v = 0;
+  for (int v = 1; v < 4; ++v)
+    if (g[v] < g[min_v])
+      min_v = v;
+
+  // The vertices before and after each vertex in anticlockwise order,
+  // and the position of each vertex in the anticlockwise order
+  constexpr std::array<int, 4> pre = {2, 0, 3, 1};
+  constexpr std::array<int, 4> post = {1, 3, 0, 2};
+  constexpr std::array<int, 4> pos = {0, 1, 3, 2};
+
+  const bool reflect = g[post[min_v]] > g[pre[min_v]];
+  const int rots = reflect ? pos[min_v] : (4 - pos[min_v]) % 4;
+  return reflect + 2 * rots;
 }
 //-----------------------------------------------------------------------------
-template <int BITSETSIZE>
-std::vector<std::bitset<BITSETSIZE>>
-compute_face_permutations_tp(const graph::AdjacencyList<std::int32_t>& c_to_v,
-                             const graph::AdjacencyList<std::int32_t>& c_to_f,
-                             const graph::AdjacencyList<std::int32_t>& f_to_v,
-                             int faces_per_cell, const common::IndexMap& im)
+
+/// Compute the permutation number of each face (see
+/// triangle_permutation) and the reflection of each edge of each cell.
+/// The permutations depend only on the global indices of the cell
+/// vertices, so they are computed in one pass over the cell-vertex
+/// connectivity, without the face-vertex and edge-vertex
+/// connectivities.
+/// @param[in] c_to_v The cell-vertex connectivity
+/// @param[in] im The vertex index map
+/// @tparam type The cell type
+/// @param[out] face_perm The permutation number of face `i` of cell `c`
+/// is `face_perm[c * faces_per_cell + i]`. It is empty if face
+/// permutations are not required.
+/// @param[out] edge_refl The reflection of edge `i` of cell `c` is
+/// `edge_refl[c * edges_per_cell + i]`. It is empty if edge
+/// reflections are not required.
+/// @param[in] num_threads The number of threads
+template <mesh::CellType type>
+void compute_permutations(const graph::AdjacencyList<std::int32_t>& c_to_v,
+                          const common::IndexMap& im,
+                          const xtl::span<std::uint8_t>& face_perm,
+                          const xtl::span<std::uint8_t>& edge_refl,
+                          int num_threads)
 {
+  // Reference cell vertices of each face and edge
+  constexpr const mesh::ReferenceCell& ref = mesh::reference_cell(type);
+  const auto& faces = ref.entity_vertices[2];
+  const auto& edges = ref.entity_vertices[1];
+
   const std::int32_t num_cells = c_to_v.num_nodes();
-  std::vector<std::bitset<BITSETSIZE>> face_perm(num_cells, 0);
-  std::vector<std::int64_t> cell_vertices, vertices;
-  for (int c = 0; c < num_cells; ++c)
+  const int num_faces
+      = (ref.dim < 3 or face_perm.empty()) ? 0 : ref.num_entities[2];
+  const int num_edges = edge_refl.empty() ? 0 : ref.num_entities[1];
+  assert(face_perm.size() == (std::size_t)num_cells * num_faces);
+  assert(edge_refl.size() == (std::size_t)num_cells * num_edges);
+  auto compute = [&](std::int32_t c0, std::int32_t c1, int)
   {
-    cell_vertices.resize(c_to_v.links(c).size());
-    im.local_to_global(c_to_v.links(c), cell_vertices);
-
-    auto cell_faces = c_to_f.links(c);
-    for (int i = 0; i < faces_per_cell; ++i)
+    std::array<std::int64_t, ref.num_entities[0]> cell_vertices;
+    std::array<std::int64_t, 4> g;
+    for (std::int32_t c = c0; c < c1; ++c)
     {
-      // Get the face
-      const int face = cell_faces[i];
-      vertices.resize(f_to_v.links(face).size());
-      im.local_to_global(f_to_v.links(face), vertices);
+      auto vertices = c_to_v.links(c);
+      assert(vertices.size() == cell_vertices.size());
+      im.local_to_global(vertices, cell_vertices);
 
-      // Orient that triangle so the the lowest numbered vertex is the
-      // origin, and the next vertex anticlockwise from the lowest has a
-      // lower number than the next vertex clockwise. Find the index of
-      // the lowest numbered vertex
-
-      // Store local vertex indices here
-      std::array<std::int32_t, 4> e_vertices;
-
-      // Find iterators pointing to cell vertex given a vertex on facet
-      for (int j = 0; j < 4; ++j)
+      for (int i = 0; i < num_faces; ++i)
       {
-        auto it = std::find(cell_vertices.begin(), cell_vertices.end(),
-                            vertices[j]);
-        // Get the actual local vertex indices
-        e_vertices[j] = std::distance(cell_vertices.begin(), it);
+        const int num_face_vertices = ref.num_face_vertices[i];
+        for (int j = 0; j < num_face_vertices; ++j)
+          g[j] = cell_vertices[faces[i][j]];
+        face_perm[c * num_faces + i] = num_face_vertices == 3
+                                           ? triangle_permutation(g)
+                                           : quadrilateral_permutation(g);
       }
 
-      // Number of rotations
-      std::uint8_t min_v = 0;
-      for (int v = 1; v < 4; ++v)
-        if (e_vertices[v] < e_vertices[min_v])
-          min_v = v;
-
-      // pre is the (local) number of the next vertex clockwise from the
-      // lowest numbered vertex
-      int pre = 2;
-
-      // post is the (local) number of the next vertex anticlockwise
-      // from the lowest numbered vertex
-      int post = 1;
-
-      assert(min_v < 4);
-      switch (min_v)
+      // An edge is reflected if it is not oriented from the lowest to
+      // the highest numbered vertex
+      for (int i = 0; i < num_edges; ++i)
       {
-      case 1:
-        pre = 0;
-        post = 3;
-        break;
-      case 2:
-        pre = 3;
-        post = 0;
-        min_v = 3;
-        break;
-      case 3:
-        pre = 1;
-        post = 2;
-        min_v = 2;
-        break;
+        const auto [v0, v1] = std::minmax(edges[i][0], edges[i][1]);
+        edge_refl[c * num_edges + i] = cell_vertices[v0] > cell_vertices[v1];
       }
-
-      std::uint8_t g_min_v = 0;
-      for (int v = 1; v < 4; ++v)
-        if (vertices[v] < vertices[g_min_v])
-          g_min_v = v;
-
-      // rots is the number of rotations to get the lowest numbered
-      // vertex to the origin
-      // pre is the (local) number of the next vertex clockwise from the
-      // lowest numbered vertex
-      int g_pre = 2;
-
-      // post is the (local) number of the next vertex anticlockwise
-      // from the lowest numbered vertex
-      int g_post = 1;
-
-      assert(g_min_v < 4);
-      switch (g_min_v)
-      {
-      case 1:
-        g_pre = 0;
-        g_post = 3;
-        break;
-      case 2:
-        g_pre = 3;
-        g_post = 0;
-        g_min_v = 3;
-        break;
-      case 3:
-        g_pre = 1;
-        g_post = 2;
-        g_min_v = 2;
-        break;
-      }
-
-      std::uint8_t rots = 0;
-      if (vertices[g_post] > vertices[g_pre])
-        rots = min_v <= g_min_v ? g_min_v - min_v : g_min_v + 4 - min_v;
-      else
-        rots = g_min_v <= min_v ? min_v - g_min_v : min_v + 4 - g_min_v;
-
-      face_perm[c][3 * i] = (e_vertices[post] > e_vertices[pre])
-                            == (vertices[g_post] < vertices[g_pre]);
-      face_perm[c][3 * i + 1] = rots % 2;
-      face_perm[c][3 * i + 2] = rots / 2;
     }
-  }
-
-  return face_perm;
+  };
+  common::for_each_part(num_cells, num_threads, compute);
 }
 //-----------------------------------------------------------------------------
-template <int BITSETSIZE>
-std::vector<std::bitset<BITSETSIZE>>
-compute_edge_reflections(const mesh::Topology& topology)
+} // namespace
+
+//-----------------------------------------------------------------------------
+std::pair<std::vector<std::uint8_t>, std::vector<std::uint32_t>>
+mesh::compute_entity_permutations(const mesh::Topology& topology,
+                                  int num_threads)
 {
   const int tdim = topology.dim();
-  const mesh::CellType cell_type = topology.cell_type();
-  const int edges_per_cell = cell_num_entities(cell_type, 1);
-
-  const std::int32_t num_cells = topology.connectivity(tdim, 0)->num_nodes();
-
+  const CellType cell_type = topology.cell_type();
   auto c_to_v = topology.connectivity(tdim, 0);
   assert(c_to_v);
-  auto c_to_e = topology.connectivity(tdim, 1);
-  assert(c_to_e);
-  auto e_to_v = topology.connectivity(1, 0);
-  assert(e_to_v);
-
   auto im = topology.index_map(0);
   assert(im);
+  const std::int32_t num_cells = c_to_v->num_nodes();
+  const int facets_per_cell = cell_num_entities(cell_type, tdim - 1);
+
+  // Compute the face permutations and edge reflections of each cell
+  const int faces_per_cell = tdim > 2 ? cell_num_entities(cell_type, 2) : 0;
+  const int edges_per_cell = tdim > 1 ? cell_num_entities(cell_type, 1) : 0;
+  std::vector<std::uint8_t> face_perm(num_cells * faces_per_cell);
+  std::vector<std::uint8_t> edge_refl(num_cells * edges_per_cell);
+  if (tdim > 1)
+  {
+    mesh::cell_type_dispatch(
+        cell_type,
+        [&](auto type)
+        {
+          compute_permutations<decltype(type)::value>(
+              *c_to_v, *im, face_perm, edge_refl, num_threads);
+        });
+  }
 
-  std::vector<std::bitset<BITSETSIZE>> edge_perm(num_cells, 0);
-  std::vector<std::int64_t> cell_vertices, vertices;
-  for (int c = 0; c < c_to_v->num_nodes(); ++c)
+  // Currently, 3 bits are used for each face. If faces with more than 4
+  // sides are implemented, this will need to be increased.
+  assert(faces_per_cell * 3 + edges_per_cell < _BITSETSIZE);
+  std::vector<std::uint32_t> cell_permutation_info(num_cells, 0);
+  for (std::int32_t c = 0; c < num_cells; ++c)
   {
-    cell_vertices.resize(c_to_v->links(c).size());
-    im->local_to_global(c_to_v->links(c), cell_vertices);
-    auto cell_edges = c_to_e->links(c);
+    std::uint32_t& info = cell_permutation_info[c];
+    for (int i = 0; i < faces_per_cell; ++i)
+      info |= std::uint32_t(face_perm[c * faces_per_cell + i]) << (3 * i);
     for (int i = 0; i < edges_per_cell; ++i)
     {
-      vertices.resize(e_to_v->links(cell_edges[i]).size());
-      im->local_to_global(e_to_v->links(cell_edges[i]), vertices);
-
-      // If the entity is an interval, it should be oriented pointing
-      // from the lowest numbered vertex to the highest numbered vertex.
-
-      // Find iterators pointing to cell vertex given a vertex on facet
-      const auto it0
-          = std::find(cell_vertices.begin(), cell_vertices.end(), vertices[0]);
-      const auto it1
-          = std::find(cell_vertices.begin(), cell_vertices.end(), vertices[1]);
-
-      // The number of reflections. Comparing iterators directly instead
-      // of values they point to is sufficient here.
-      edge_perm[c][i] = (it1 < it0) == (vertices[1] > vertices[0]);
+      info |= std::uint32_t(edge_refl[c * edges_per_cell + i])
+              << (3 * faces_per_cell + i);
     }
   }
 
-  return edge_perm;
+  // The facet permutations are the face permutations in 3D and the edge
+  // reflections in 2D
+  std::vector<std::uint8_t> facet_permutations;
+  if (tdim == 3)
+    facet_permutations = std::move(face_perm);
+  else if (tdim == 2)
+    facet_permutations = std::move(edge_refl);
+  else
+    facet_permutations.resize(num_cells * facets_per_cell, 0);
+
+  return {std::move(facet_permutations), std::move(cell_permutation_info)};
 }
 //-----------------------------------------------------------------------------
-template <int BITSETSIZE>
-std::vector<std::bitset<BITSETSIZE>>
-compute_face_permutations(const mesh::Topology& topology)
+std::vector<std::uint8_t>
+mesh::compute_facet_permutations(const mesh::Topology& topology,
+                                 int num_threads)
 {
   const int tdim = topology.dim();
-  assert(tdim > 2);
-  if (!topology.index_map(2))
-    throw std::runtime_error("Faces have not been computed.");
-
-  // If faces have been computed, the below should exist
+  const CellType cell_type = topology.cell_type();
   auto c_to_v = topology.connectivity(tdim, 0);
   assert(c_to_v);
-  auto c_to_f = topology.connectivity(tdim, 2);
-  assert(c_to_f);
-  auto f_to_v = topology.connectivity(2, 0);
-  assert(f_to_v);
-
   auto im = topology.index_map(0);
   assert(im);
-  const mesh::CellType cell_type = topology.cell_type();
-  const int faces_per_cell = cell_num_entities(cell_type, 2);
-  if (cell_type == mesh::CellType::triangle
-      or cell_type == mesh::CellType::tetrahedron)
-  {
-    return compute_face_permutations_simplex<BITSETSIZE>(
-        *c_to_v, *c_to_f, *f_to_v, faces_per_cell, *im);
-  }
-  else
-  {
-    return compute_face_permutations_tp<BITSETSIZE>(*c_to_v, *c_to_f, *f_to_v,
-                                                    faces_per_cell, *im);
-  }
-}
-//-----------------------------------------------------------------------------
-} // namespace
-
-//-----------------------------------------------------------------------------
-std::pair<std::vector<std::uint8_t>, std::vector<std::uint32_t>>
-mesh::compute_entity_permutations(const mesh::Topology& topology)
-{
-  const int tdim = topology.dim();
-  const CellType cell_type = topology.cell_type();
-  const std::int32_t num_cells = topology.connectivity(tdim, 0)->num_nodes();
+  const std::int32_t num_cells = c_to_v->num_nodes();
   const int facets_per_cell = cell_num_entities(cell_type, tdim - 1);
 
-  std::vector<std::uint32_t> cell_permutation_info(num_cells, 0);
-  std::vector<std::uint8_t> facet_permutations(num_cells * facets_per_cell);
-  std::int32_t used_bits = 0;
-  if (tdim > 2)
+  // Only compute the permutations of the faces in 3D and of the edges
+  // in 2D
+  std::vector<std::uint8_t> facet_permutations(num_cells * facets_per_cell,
+                                               0);
+  if (tdim == 3)
   {
-    const int faces_per_cell = cell_num_entities(cell_type, 2);
-    const auto face_perm = compute_face_permutations<_BITSETSIZE>(topology);
-    for (int c = 0; c < num_cells; ++c)
-      cell_permutation_info[c] = face_perm[c].to_ulong();
-
-    // Currently, 3 bits are used for each face. If faces with more than
-    // 4 sides are implemented, this will need to be increased.
-    used_bits += faces_per_cell * 3;
-    assert(tdim == 3);
-    for (int c = 0; c < num_cells; ++c)
-    {
-      for (int i = 0; i < facets_per_cell; ++i)
-      {
-        facet_permutations[c * facets_per_cell + i]
-            = (cell_permutation_info[c] >> (3 * i)) & 7;
-      }
-    }
+    compute_permutations(*c_to_v, *im, cell_type, facet_permutations, {},
+                         num_threads);
   }
-
-  if (tdim > 1)
+  else if (tdim == 2)
   {
-    const int edges_per_cell = cell_num_entities(cell_type, 1);
-    const auto edge_perm = compute_edge_reflections<_BITSETSIZE>(topology);
-    for (int c = 0; c < num_cells; ++c)
-      cell_permutation_info[c] |= edge_perm[c].to_ulong() << used_bits;
-
-    used_bits += edges_per_cell;
-    if (tdim == 2)
-    {
-      for (int c = 0; c < num_cells; ++c)
-      {
-        for (int i = 0; i < facets_per_cell; ++i)
-          facet_permutations[c * facets_per_cell + i] = edge_perm[c][i];
-      }
-    }
+    compute_permutations(*c_to_v, *im, cell_type, {}, facet_permutations,
+                         num_threads);
   }
-  assert(used_bits < _BITSETSIZE);
 
-  return {std::move(facet_permutations), std::move(cell_permutation_info)};
+  return facet_permutations;
 }
 //-----------------------------------------------------------------------------
@@ -66,8 +66,23 @@ class Topology;
 ///    This data is used to correct the direction of vector function
 ///    on permuted facets.
 ///
+/// The permutations depend only on the global indices of the cell
+/// vertices, and are computed from the cell-vertex connectivity.
+///
+/// @param[in] topology The topology
+/// @param[in] num_threads The number of threads
 /// @return Facet permutation and cells permutations
 std::pair<std::vector<std::uint8_t>, std::vector<std::uint32_t>>
-compute_entity_permutations(const Topology& topology);
+compute_entity_permutations(const Topology& topology, int num_threads = 1);
+
+/// Compute the facet rotation and reflection data only, see
+/// compute_entity_permutations. This is cheaper than
+/// compute_entity_permutations in 3D, where the edge reflections are
+/// not computed.
+/// @param[in] topology The topology
+/// @param[in] num_threads The number of threads
+/// @return Facet permutations
+std::vector<std::uint8_t> compute_facet_permutations(const Topology& topology,
+                                                     int num_threads = 1);
 
 } // namespace dolfinx::mesh
@@ -0,0 +1,199 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include "cell_types.h"
+#include <array>
+#include <stdexcept>
+#include <type_traits>
+
+namespace dolfinx::mesh
+{
+
+/// Topology of a reference cell. The local vertices of the entities
+/// are numbered as in Basix.
+///
+/// The tables are constant expressions (see mesh::reference_cell), so
+/// that loops over the entities of a cell type that is known at compile
+/// time have constant bounds and need no allocations:
+/// @code
+/// constexpr const ReferenceCell& ref = reference_cell(CellType::triangle);
+/// for (int e = 0; e < ref.num_entities[1]; ++e)
+///   for (int k = 0; k < 2; ++k)
+///     edges[3 * c + e][k] = cell[ref.entity_vertices[1][e][k]];
+/// @endcode
+struct ReferenceCell
+{
+  /// Topological dimension
+  int dim;
+
+  /// Number of entities of each dimension
+  std::array<int, 4> num_entities;
+
+  /// Number of vertices of each face (entity of dimension 2)
+  std::array<int, 6> num_face_vertices;
+
+  /// `entity_vertices[d][e][k]` is the local vertex `k` of entity `e`
+  /// of dimension `d`, for `k < num_entity_vertices(d, e)`
+  std::array<std::array<std::array<int, 8>, 12>, 4> entity_vertices;
+
+  /// `face_edges[f][k]` is the local edge `k` of face `f`, for `k <
+  /// num_face_vertices[f]`
+  std::array<std::array<int, 4>, 6> face_edges;
+
+  /// Number of vertices of an entity
+  /// @param[in] d The dimension of the entity
+  /// @param[in] e The local index of the entity
+  /// @return The number of vertices of the entity
+  constexpr int num_entity_vertices(int d, int e) const
+  {
+    if (d == dim)
+      return num_entities[0];
+    else if (d == 2)
+      return num_face_vertices[e];
+    else
+      return d + 1;
+  }
+};
+
+namespace impl
+{
+// clang-format off
+inline constexpr ReferenceCell point
+    = {0, {1, 0, 0, 0}, {},
+       {{{{{0}}}}},
+       {}};
+
+inline constexpr ReferenceCell interval
+    = {1, {2, 1, 0, 0}, {},
+       {{{{{0}, {1}}},
+         {{{0, 1}}}}},
+       {}};
+
+inline constexpr ReferenceCell triangle
+    = {2, {3, 3, 1, 0}, {3},
+       {{{{{0}, {1}, {2}}},
+         {{{1, 2}, {0, 2}, {0, 1}}},
+         {{{0, 1, 2}}}}},
+       {{{0, 1, 2}}}};
+
+inline constexpr ReferenceCell quadrilateral
+    = {2, {4, 4, 1, 0}, {4},
+       {{{{{0}, {1}, {2}, {3}}},
+         {{{0, 1}, {0, 2}, {1, 3}, {2, 3}}},
+         {{{0, 1, 2, 3}}}}},
+       {{{0, 1, 2, 3}}}};
+
+inline constexpr ReferenceCell tetrahedron
+    = {3, {4, 6, 4, 1}, {3, 3, 3, 3},
+       {{{{{0}, {1}, {2}, {3}}},
+         {{{2, 3}, {1, 3}, {1, 2}, {0, 3}, {0, 2}, {0, 1}}},
+         {{{1, 2, 3}, {0, 2, 3}, {0, 1, 3}, {0, 1, 2}}},
+         {{{0, 1, 2, 3}}}}},
+       {{{0, 1, 2}, {0, 3, 4}, {1, 3, 5}, {2, 4, 5}}}};
+
+inline constexpr ReferenceCell pyramid
+    = {3, {5, 8, 5, 1}, {4, 3, 3, 3, 3},
+       {{{{{0}, {1}, {2}, {3}, {4}}},
+         {{{0, 1}, {0, 2}, {0, 4}, {1, 3}, {1, 4}, {2, 3}, {2, 4}, {3, 4}}},
+         {{{0, 1, 2, 3}, {0, 1, 4}, {0, 2, 4}, {1, 3, 4}, {2, 3, 4}}},
+         {{{0, 1, 2, 3, 4}}}}},
+       {{{0, 1, 3, 5}, {0, 2, 4}, {1, 2, 6}, {3, 4, 7}, {5, 6, 7}}}};
+
+inline constexpr ReferenceCell prism
+    = {3, {6, 9, 5, 1}, {3, 4, 4, 4, 3},
+       {{{{{0}, {1}, {2}, {3}, {4}, {5}}},
+         {{{0, 1}, {0, 2}, {0, 3}, {1, 2}, {1, 4}, {2, 5}, {3, 4}, {3, 5},
+           {4, 5}}},
+         {{{0, 1, 2}, {0, 1, 3, 4}, {0, 2, 3, 5}, {1, 2, 4, 5}, {3, 4, 5}}},
+         {{{0, 1, 2, 3, 4, 5}}}}},
+       {{{0, 1, 3}, {0, 2, 4, 6}, {1, 2, 5, 7}, {3, 4, 5, 8}, {6, 7, 8}}}};
+
+inline constexpr ReferenceCell hexahedron
+    = {3, {8, 12, 6, 1}, {4, 4, 4, 4, 4, 4},
+       {{{{{0}, {1}, {2}, {3}, {4}, {5}, {6}, {7}}},
+         {{{0, 1}, {0, 2}, {0, 4}, {1, 3}, {1, 5}, {2, 3}, {2, 6}, {3, 7},
+           {4, 5}, {4, 6}, {5, 7}, {6, 7}}},
+         {{{0, 1, 2, 3}, {0, 1, 4, 5}, {0, 2, 4, 6}, {1, 3, 5, 7},
+           {2, 3, 6, 7}, {4, 5, 6, 7}}},
+         {{{0, 1, 2, 3, 4, 5, 6, 7}}}}},
+       {{{0, 1, 3, 5}, {0, 2, 4, 8}, {1, 2, 6, 9}, {3, 4, 7, 10},
+         {5, 6, 7, 11}, {8, 9, 10, 11}}}};
+// clang-format on
+} // namespace impl
+
+/// Get the topology of a reference cell
+/// @param[in] type The cell type
+/// @return The topology of the reference cell
+constexpr const ReferenceCell& reference_cell(CellType type)
+{
+  switch (type)
+  {
+  case CellType::point:
+    return impl::point;
+  case CellType::interval:
+    return impl::interval;
+  case CellType::triangle:
+    return impl::triangle;
+  case CellType::quadrilateral:
+    return impl::quadrilateral;
+  case CellType::tetrahedron:
+    return impl::tetrahedron;
+  case CellType::pyramid:
+    return impl::pyramid;
+  case CellType::prism:
+    return impl::prism;
+  case CellType::hexahedron:
+    return impl::hexahedron;
+  default:
+    throw std::runtime_error("Unknown cell type.");
+  }
+}
+
+/// Call a function that is templated over the cell type with a cell
+/// type that is only known at runtime, so that algorithms can be
+/// instantiated for each cell type and use the reference cell tables as
+/// constant expressions:
+/// @code
+/// cell_type_dispatch(type, [&](auto type)
+/// {
+///   constexpr const ReferenceCell& ref
+///       = reference_cell(decltype(type)::value);
+///   ...
+/// });
+/// @endcode
+/// @param[in] type The cell type
+/// @param[in] f The function, which is called with a
+/// `std::integral_constant<CellType, type>`
+/// @return The value returned by `f`
+template <typename F>
+decltype(auto) cell_type_dispatch(CellType type, F&& f)
+{
+  switch (type)
+  {
+  case CellType::point:
+    return f(std::integral_constant<CellType, CellType::point>());
+  case CellType::interval:
+    return f(std::integral_constant<CellType, CellType::interval>());
+  case CellType::triangle:
+    return f(std::integral_constant<CellType, CellType::triangle>());
+  case CellType::quadrilateral:
+    return f(std::integral_constant<CellType, CellType::quadrilateral>());
+  case CellType::tetrahedron:
+    return f(std::integral_constant<CellType, CellType::tetrahedron>());
+  case CellType::pyramid:
+    return f(std::integral_constant<CellType, CellType::pyramid>());
+  case CellType::prism:
+    return f(std::integral_constant<CellType, CellType::prism>());
+  case CellType::hexahedron:
+    return f(std::integral_constant<CellType, CellType::hexahedron>());
+  default:
+    throw std::runtime_error("Unknown cell type.");
+  }
+}
+
+} // namespace dolfinx::mesh
@@ -7,20 +7,25 @@
 #include "topologycomputation.h"
 #include "Topology.h"
 #include "cell_types.h"
+#include "reference_cell.h"
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <boost/unordered_map.hpp>
 #include <cstdint>
+#include <dolfinx/common/Arena.h>
 #include <dolfinx/common/IndexMap.h>
 #include <dolfinx/common/MPI.h>
 #include <dolfinx/common/Timer.h>
 #include <dolfinx/common/log.h>
+#include <dolfinx/common/sort.h>
 #include <dolfinx/common/utils.h>
 #include <dolfinx/graph/AdjacencyList.h>
 #include <memory>
 #include <numeric>
-#include <random>
 #include <string>
 #include <tuple>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -32,44 +37,12 @@ using namespace dolfinx;
 namespace
 {
 //-----------------------------------------------------------------------------
-/// Get the ownership of an entity shared over several processes
-/// @param processes Set of sharing processes
-/// @param vertices Global vertex indices of entity
-/// @return owning process number
-int get_ownership(std::set<int>& processes, std::vector<std::int64_t>& vertices)
-{
-  // Use a deterministic random number generator, seeded with global vertex
-  // indices ensuring all processes get the same answer
-  std::mt19937 gen;
-  std::seed_seq seq(vertices.begin(), vertices.end());
-  gen.seed(seq);
-  std::vector<int> p(processes.begin(), processes.end());
-  int index = gen() % p.size();
-  int owner = p[index];
-  return owner;
-}
-
-/// Takes an array and computes the sort permutation that would reorder
-/// the rows in ascending order
-/// @param[in] array The input array
-/// @return The permutation vector that would order the rows in
-/// ascending order
-/// @pre Each row of @p array must be sorted
-template <typename T>
-std::vector<std::int32_t> sort_by_perm(const xt::xtensor<T, 2>& array)
-{
-  std::vector<int> index(array.shape(0));
-  std::iota(index.begin(), index.end(), 0);
-  std::sort(index.begin(), index.end(),
-            [&array](int a, int b)
-            {
-              return std::lexicographical_compare(
-                  xt::row(array, a).begin(), xt::row(array, a).end(),
-                  xt::row(array, b).begin(), xt::row(array, b).end());
-            });
+/// Entity key, with the (sorted) vertices of the entity packed into
+/// 128 bits. The first (smallest) vertex is in the most significant
+/// bits, so that keys and sorted vertex lists have the same
+/// (lexicographic) order.
+using key_t = std::array<std::uint64_t, 2>;
 
-  return index;
-}
 //-----------------------------------------------------------------------------
 
 /// Communicate with sharing processes to find out which entities are
@@ -149,13 +122,13 @@ get_local_indexing(
 
   //---------
   // Create an expanded neighbor_comm from shared_vertices
-  const std::map<std::int32_t, std::set<std::int32_t>> shared_vertices
-      = vertex_indexmap->compute_shared_indices();
+  const graph::AdjacencyList<int> shared_vertices
+      = vertex_indexmap->compute_sharing_ranks();
 
-  std::set<std::int32_t> neighbor_set;
-  for (auto& q : shared_vertices)
-    neighbor_set.insert(q.second.begin(), q.second.end());
-  std::vector<std::int32_t> neighbors(neighbor_set.begin(), neighbor_set.end());
+  std::vector<std::int32_t> neighbors(shared_vertices.array());
+  std::sort(neighbors.begin(), neighbors.end());
+  neighbors.erase(std::unique(neighbors.begin(), neighbors.end()),
+                  neighbors.end());
   MPI_Comm neighbor_comm;
   MPI_Dist_graph_create_adjacent(comm, neighbors.size(), neighbors.data(),
                                  MPI_UNWEIGHTED, neighbors.size(),
@@ -173,19 +146,25 @@ get_local_indexing(
   // Get all "possibly shared" entities, based on vertex sharing. Send
   // to other processes, and see if we get the same back.
 
-  // Map for entities to entity index, using global vertex indices
-  std::map<std::vector<std::int64_t>, std::int32_t>
-      global_entity_to_entity_index;
+  // Entities that may be shared, as (sorted global vertices, entity
+  // index) pairs. The vertices are padded with -1 to a fixed size. The
+  // list is sorted by the vertices after it has been built, so that
+  // received entities can be found by bisection.
+  const int num_vertices_per_e = entity_list.shape(1);
+  assert(num_vertices_per_e <= 4);
+  using entity_key_t = std::array<std::int64_t, 4>;
+  std::vector<std::pair<entity_key_t, std::int32_t>> global_entity_to_index;
 
-  // Set of sharing procs for each entity, counting vertex hits
   // Get a list of unique entities
   std::vector<std::int32_t> unique_row(entity_count);
   for (std::size_t i = 0; i < entity_list.shape(0); ++i)
     unique_row[entity_index[i]] = i;
-  const int num_vertices_per_e = entity_list.shape(1);
-  std::unordered_map<int, int> procs;
-  std::vector<std::int64_t> vglobal(num_vertices_per_e);
-  std::vector<std::int32_t> entity_list_i(num_vertices_per_e);
+
+  // An entity may be shared with a process that shares all of its
+  // vertices
+  std::vector<std::int32_t> procs;
+  std::array<std::int32_t, 4> entity_list_i;
+  entity_key_t vglobal;
   for (int i : unique_row)
   {
     std::copy_n(xt::row(entity_list, i).begin(), num_vertices_per_e,
@@ -193,40 +172,48 @@ get_local_indexing(
     procs.clear();
     for (int j = 0; j < num_vertices_per_e; ++j)
     {
-      if (auto it = shared_vertices.find(entity_list_i[j]);
-          it != shared_vertices.end())
-      {
-        for (std::int32_t p : it->second)
-          ++procs[p];
-      }
+      auto p = shared_vertices.links(entity_list_i[j]);
+      procs.insert(procs.end(), p.begin(), p.end());
     }
+    std::sort(procs.begin(), procs.end());
 
-    for (const auto& q : procs)
+    bool shared = false;
+    for (auto it = procs.begin(); it != procs.end();)
     {
-      // If any process shares all vertices, then add to list
-      if (q.second == num_vertices_per_e)
+      auto it1 = std::upper_bound(it, procs.end(), *it);
+      if (std::distance(it, it1) == num_vertices_per_e)
       {
-        vertex_indexmap->local_to_global(entity_list_i, vglobal);
-        std::sort(vglobal.begin(), vglobal.end());
-
-        global_entity_to_entity_index.insert({vglobal, entity_index[i]});
+        if (!shared)
+        {
+          vglobal.fill(-1);
+          vertex_indexmap->local_to_global(
+              xtl::span<const std::int32_t>(entity_list_i.data(),
+                                            num_vertices_per_e),
+              xtl::span<std::int64_t>(vglobal.data(), num_vertices_per_e));
+          std::sort(vglobal.begin(),
+                    std::next(vglobal.begin(), num_vertices_per_e));
+          global_entity_to_index.push_back({vglobal, entity_index[i]});
+          shared = true;
+        }
 
         // Do not send entities which are known to be ghosts
         if (ghost_status[entity_index[i]] != 2)
         {
-          const int p = q.first;
-          auto it = proc_to_neighbor.find(p);
-          assert(it != proc_to_neighbor.end());
-          const int np = it->second;
+          auto it_n = proc_to_neighbor.find(*it);
+          assert(it_n != proc_to_neighbor.end());
+          const int np = it_n->second;
 
           // Entity entity_index[i] may be shared with process p
-          send_entities[np].insert(send_entities[np].end(), vglobal.begin(),
-                                   vglobal.end());
+          send_entities[np].insert(
+              send_entities[np].end(), vglobal.begin(),
+              std::next(vglobal.begin(), num_vertices_per_e));
           send_index[np].push_back(entity_index[i]);
         }
       }
+      it = it1;
     }
   }
+  std::sort(global_entity_to_index.begin(), global_entity_to_index.end());
 
   // Get shared entities of this dimension, and also match up an index
   // for the received entities (from other processes) with the indices
@@ -239,27 +226,29 @@ get_local_indexing(
   const std::vector<std::int64_t>& recv_entities_data = recv_data.array();
   const std::vector<std::int32_t>& recv_offsets = recv_data.offsets();
 
-  // Compare received with sent for each process
-  // Any which are not found will have -1 in recv_index
+  // Compare received with sent for each process. Any which are not
+  // found will have -1 in recv_index. The sharing processes of the
+  // shared entities are stored as (position in global_entity_to_index,
+  // rank) pairs.
   std::vector<std::int32_t> recv_index;
-  std::vector<std::int64_t> recv_vec;
-  std::unordered_map<std::int32_t, std::vector<std::int64_t>>
-      shared_entity_to_global_vertices;
-  std::unordered_map<std::int32_t, std::set<std::int32_t>> shared_entities;
+  recv_index.reserve(recv_entities_data.size() / num_vertices_per_e);
+  std::vector<std::array<std::int32_t, 2>> shared_entities;
   for (int np = 0; np < neighbor_size; ++np)
   {
     for (int j = recv_offsets[np]; j < recv_offsets[np + 1];
          j += num_vertices_per_e)
     {
-      recv_vec.assign(
-          std::next(recv_entities_data.begin(), j),
-          std::next(recv_entities_data.begin(), j + num_vertices_per_e));
-      if (auto it = global_entity_to_entity_index.find(recv_vec);
-          it != global_entity_to_entity_index.end())
+      vglobal.fill(-1);
+      std::copy_n(std::next(recv_entities_data.begin(), j),
+                  num_vertices_per_e, vglobal.begin());
+      auto it = std::lower_bound(
+          global_entity_to_index.begin(), global_entity_to_index.end(),
+          vglobal, [](auto& e, auto& key) { return e.first < key; });
+      if (it != global_entity_to_index.end() and it->first == vglobal)
       {
-        const int p = neighbors[np];
-        shared_entities[it->second].insert(p);
-        shared_entity_to_global_vertices.insert({it->second, recv_vec});
+        shared_entities.push_back(
+            {std::int32_t(std::distance(global_entity_to_index.begin(), it)),
+             neighbors[np]});
         recv_index.push_back(it->second);
       }
       else
@@ -267,10 +256,30 @@ get_local_indexing(
     }
   }
 
-  // Add this rank to the list of sharing processes
+  // Choose the owner of each shared entity from the sorted sharing
+  // processes (including this rank) using a hash of its global
+  // vertices, so that all sharing processes make the same choice
   const int mpi_rank = dolfinx::MPI::rank(comm);
-  std::for_each(shared_entities.begin(), shared_entities.end(),
-                [mpi_rank](auto& q) { q.second.insert(mpi_rank); });
+  std::sort(shared_entities.begin(), shared_entities.end());
+  std::vector<int> owner(entity_count, -1);
+  for (auto it = shared_entities.begin(); it != shared_entities.end();)
+  {
+    const std::int32_t k = (*it)[0];
+    auto it1 = std::find_if(it, shared_entities.end(),
+                            [k](auto& q) { return q[0] != k; });
+    procs.clear();
+    for (auto q = it; q != it1; ++q)
+      procs.push_back((*q)[1]);
+    procs.insert(std::upper_bound(procs.begin(), procs.end(), mpi_rank),
+                 mpi_rank);
+
+    const auto& [key, e] = global_entity_to_index[k];
+    const std::size_t r = common::hash_indices(xtl::span<const std::int64_t>(
+                              key.data(), num_vertices_per_e))
+                          % procs.size();
+    owner[e] = procs[r];
+    it = it1;
+  }
 
   //---------
   // Determine ownership
@@ -286,26 +295,12 @@ get_local_indexing(
       if (ghost_status[i] == 2)
         continue;
 
-      // Definitely local
-      if (const auto it = shared_entities.find(i);
-          ghost_status[i] == 1 or it == shared_entities.end())
+      // Definitely local, or shared and owned by this rank
+      if (ghost_status[i] == 1 or owner[i] == -1 or owner[i] == mpi_rank)
       {
         local_index[i] = c;
         ++c;
       }
-      else
-      {
-        const auto global_vertices_it
-            = shared_entity_to_global_vertices.find(i);
-        assert(global_vertices_it != shared_entity_to_global_vertices.end());
-        int owner_rank = get_ownership(it->second, global_vertices_it->second);
-        if (owner_rank == mpi_rank)
-        {
-          // Take ownership
-          local_index[i] = c;
-          ++c;
-        }
-      }
     }
     num_local = c;
 
@@ -402,6 +397,8 @@ get_local_indexing(
 /// @param[in] shared_vertices TODO
 /// @param[in] cell_type Cell type
 /// @param[in] dim Topological dimension of the entities to be computed
+/// @param[in] num_threads The number of threads used to build and sort
+///   the entity keys
 /// @return Returns the (cell-entity connectivity, entity-cell
 ///   connectivity, index map for the entity distribution across
 ///   processes, shared entities)
@@ -412,7 +409,7 @@ compute_entities_by_key_matching(
     MPI_Comm comm, const graph::AdjacencyList<std::int32_t>& cells,
     const std::shared_ptr<const common::IndexMap>& vertex_index_map,
     const std::shared_ptr<const common::IndexMap>& cell_index_map,
-    mesh::CellType cell_type, int dim)
+    mesh::CellType cell_type, int dim, int num_threads)
 {
   if (dim == 0)
   {
@@ -429,52 +426,114 @@ compute_entities_by_key_matching(
   const std::size_t num_vertices_per_entity
       = mesh::num_cell_vertices(mesh::cell_entity_type(cell_type, dim));
 
-  // Create map from cell vertices to entity vertices
-  auto e_vertices = mesh::get_entity_vertices(cell_type, dim);
-
-  // List of vertices for each entity in each cell
+  // List of vertices for each entity in each cell, using the reference
+  // cell map from cell vertices to entity vertices. The loop is
+  // instantiated for each cell type and entity dimension so that the
+  // loops over the entities and their vertices have constant bounds.
   const std::size_t num_cells = cells.num_nodes();
   xt::xtensor<std::int32_t, 2> entity_list(
       {num_cells * num_entities_per_cell, num_vertices_per_entity});
-  for (std::size_t c = 0; c < num_cells; ++c)
+  auto get_entities = [&](auto type, auto d)
   {
-    // Get vertices from cell
-    auto vertices = cells.links(c);
-    for (int i = 0; i < num_entities_per_cell; ++i)
+    constexpr const mesh::ReferenceCell& ref
+        = mesh::reference_cell(decltype(type)::value);
+    constexpr int e_dim = decltype(d)::value;
+    if constexpr (e_dim <= ref.dim)
     {
-      const std::int32_t idx = c * num_entities_per_cell + i;
-      auto ev = e_vertices.links(i);
-
-      // Get entity vertices
-      assert(e_vertices.num_links(i) == (int)num_vertices_per_entity);
-      for (std::size_t j = 0; j < num_vertices_per_entity; ++j)
-        entity_list(idx, j) = vertices[ev[j]];
+      constexpr int num_entities = ref.num_entities[e_dim];
+      constexpr int num_vertices = ref.num_entity_vertices(e_dim, 0);
+      assert(num_vertices == (int)num_vertices_per_entity);
+      common::for_each_part(
+          num_cells, num_threads,
+          [&](std::int64_t c0, std::int64_t c1, int)
+          {
+            for (std::int64_t c = c0; c < c1; ++c)
+            {
+              // Get vertices from cell
+              auto vertices = cells.links(c);
+              for (int i = 0; i < num_entities; ++i)
+              {
+                const std::int32_t idx = c * num_entities + i;
+                const auto& ev = ref.entity_vertices[e_dim][i];
+                assert(ref.num_entity_vertices(e_dim, i) == num_vertices);
+                for (int j = 0; j < num_vertices; ++j)
+                  entity_list(idx, j) = vertices[ev[j]];
+              }
+            }
+          });
     }
-  }
-
-  // Copy list and sort vertices of each entity into order
-  xt::xtensor<std::int32_t, 2> entity_list_sorted = entity_list;
-  for (std::size_t i = 0; i < entity_list_sorted.shape(0); ++i)
-  {
-    std::sort(xt::row(entity_list_sorted, i).begin(),
-              xt::row(entity_list_sorted, i).end());
-  }
+  };
+  mesh::cell_type_dispatch(
+      cell_type,
+      [&](auto type)
+      {
+        switch (dim)
+        {
+        case 1:
+          get_entities(type, std::integral_constant<int, 1>());
+          break;
+        case 2:
+          get_entities(type, std::integral_constant<int, 2>());
+          break;
+        case 3:
+          get_entities(type, std::integral_constant<int, 3>());
+          break;
+        default:
+          throw std::runtime_error("Invalid entity dimension.");
+        }
+      });
+
+  // Pack the sorted vertices of each entity into a key, using the
+  // number of bits of the largest vertex index for each vertex
+  assert(num_vertices_per_entity <= 4);
+  const std::int32_t max_vertex
+      = cells.array().empty()
+            ? 0
+            : *std::max_element(cells.array().begin(), cells.array().end());
+  int bits = 1;
+  while (bits < 31 and (max_vertex >> bits) > 0)
+    ++bits;
+  common::ArenaScope scope;
+  std::pmr::vector<key_t> keys(entity_list.shape(0), scope.resource());
+  common::for_each_part(
+      keys.size(), num_threads,
+      [&](std::int64_t i0, std::int64_t i1, int)
+      {
+        std::array<std::int32_t, 4> v;
+        for (std::int64_t i = i0; i < i1; ++i)
+        {
+          auto e = xt::row(entity_list, i);
+          std::copy(e.begin(), e.end(), v.begin());
+          std::sort(v.begin(),
+                    std::next(v.begin(), num_vertices_per_entity));
+          key_t& key = keys[i];
+          key = {0, 0};
+          for (std::size_t j = 0; j < num_vertices_per_entity; ++j)
+          {
+            key[0] = (key[0] << bits) | (key[1] >> (64 - bits));
+            key[1] = (key[1] << bits) | std::uint64_t(v[j]);
+          }
+        }
+      });
 
-  // Sort the list and label uniquely
-  const std::vector<std::int32_t> sort_order
-      = sort_by_perm<std::int32_t>(entity_list_sorted);
+  // Sort the keys and label uniquely, in the (lexicographic) order of
+  // the sorted vertex lists
+  const std::vector<std::int32_t> sort_order = common::sort_by_key(
+      keys, bits * num_vertices_per_entity, num_threads);
   std::vector<std::int32_t> entity_index(entity_list.shape(0), 0);
   std::int32_t entity_count = 0;
   std::int32_t last = sort_order[0];
   for (std::size_t i = 1; i < sort_order.size(); ++i)
   {
     std::int32_t j = sort_order[i];
-    if (xt::row(entity_list_sorted, j) != xt::row(entity_list_sorted, last))
+    if (keys[j] != keys[last])
       ++entity_count;
     entity_index[j] = entity_count;
     last = j;
   }
   ++entity_count;
+  keys.clear();
+  keys.shrink_to_fit();
 
   // Communicate with other processes to find out which entities are
   // ghosted and shared. Remap the numbering so that ghosts are at the
@@ -513,33 +572,102 @@ compute_entities_by_key_matching(
 /// @param[in] c_d1_d0 The connectivity from entities of dimension d1 to
 ///   entities of dimension d0
 /// @param[in] num_entities_d0 The number of entities of dimension d0
+/// @param[in] num_threads The number of threads. With more than one
+///   thread the connections are counted and placed concurrently, and
+///   the links of each entity are then sorted, so that the result does
+///   not depend on the number of threads.
 /// @return The connectivity from entities of dimension d0 to entities
 ///   of dimension d1
 graph::AdjacencyList<std::int32_t>
 compute_from_transpose(const graph::AdjacencyList<std::int32_t>& c_d1_d0,
-                       const int num_entities_d0, int d0, int d1)
+                       const int num_entities_d0, int d0, int d1,
+                       int num_threads)
 {
   LOG(INFO) << "Computing mesh connectivity " << d0 << " - " << d1
             << " from transpose.";
 
-  // Compute number of connections for each e0
-  std::vector<std::int32_t> num_connections(num_entities_d0, 0);
-  for (int e1 = 0; e1 < c_d1_d0.num_nodes(); ++e1)
+  common::ArenaScope scope;
+  if (num_threads <= 1)
   {
-    for (std::int32_t e0 : c_d1_d0.links(e1))
-      num_connections[e0]++;
+    // Compute number of connections for each e0
+    std::pmr::vector<std::int32_t> num_connections(num_entities_d0, 0,
+                                                   scope.resource());
+    for (int e1 = 0; e1 < c_d1_d0.num_nodes(); ++e1)
+    {
+      for (std::int32_t e0 : c_d1_d0.links(e1))
+        num_connections[e0]++;
+    }
+
+    // Compute offsets
+    std::vector<std::int32_t> offsets(num_connections.size() + 1, 0);
+    std::partial_sum(num_connections.begin(), num_connections.end(),
+                     std::next(offsets.begin()));
+
+    std::pmr::vector<std::int32_t> counter(num_connections.size(), 0,
+                                           scope.resource());
+    std::vector<std::int32_t> connections(offsets[offsets.size() - 1]);
+    for (int e1 = 0; e1 < c_d1_d0.num_nodes(); ++e1)
+      for (std::int32_t e0 : c_d1_d0.links(e1))
+        connections[offsets[e0] + counter[e0]++] = e1;
+
+    return graph::AdjacencyList<std::int32_t>(std::move(connections),
+                                              std::move(offsets));
   }
 
-  // Compute offsets
-  std::vector<std::int32_t> offsets(num_connections.size() + 1, 0);
-  std::partial_sum(num_connections.begin(), num_connections.end(),
-                   std::next(offsets.begin()));
+  // Compute number of connections for each e0
+  std::pmr::vector<std::atomic<std::int32_t>> counter(num_entities_d0,
+                                                      scope.resource());
+  common::for_each_part(
+      num_entities_d0, num_threads,
+      [&counter](std::int64_t i0, std::int64_t i1, int)
+      {
+        for (std::int64_t i = i0; i < i1; ++i)
+          counter[i].store(0, std::memory_order_relaxed);
+      });
+  common::for_each_part(
+      c_d1_d0.num_nodes(), num_threads,
+      [&](std::int64_t e1_0, std::int64_t e1_1, int)
+      {
+        for (std::int64_t e1 = e1_0; e1 < e1_1; ++e1)
+          for (std::int32_t e0 : c_d1_d0.links(e1))
+            counter[e0].fetch_add(1, std::memory_order_relaxed);
+      });
+
+  // Compute offsets, and reset the counters to the start of each node
+  std::vector<std::int32_t> offsets(num_entities_d0 + 1, 0);
+  for (int e0 = 0; e0 < num_entities_d0; ++e0)
+  {
+    offsets[e0 + 1] = offsets[e0] + counter[e0].load();
+    counter[e0].store(offsets[e0], std::memory_order_relaxed);
+  }
 
-  std::vector<std::int32_t> counter(num_connections.size(), 0);
-  std::vector<std::int32_t> connections(offsets[offsets.size() - 1]);
-  for (int e1 = 0; e1 < c_d1_d0.num_nodes(); ++e1)
-    for (std::int32_t e0 : c_d1_d0.links(e1))
-      connections[offsets[e0] + counter[e0]++] = e1;
+  // Place the connections, and sort the links of each node into the
+  // order of the serial computation
+  std::vector<std::int32_t> connections(offsets.back());
+  common::for_each_part(
+      c_d1_d0.num_nodes(), num_threads,
+      [&](std::int64_t e1_0, std::int64_t e1_1, int)
+      {
+        for (std::int64_t e1 = e1_0; e1 < e1_1; ++e1)
+        {
+          for (std::int32_t e0 : c_d1_d0.links(e1))
+          {
+            connections[counter[e0].fetch_add(
+                1, std::memory_order_relaxed)]
+                = e1;
+          }
+        }
+      });
+  common::for_each_part(
+      num_entities_d0, num_threads,
+      [&](std::int64_t e0_0, std::int64_t e0_1, int)
+      {
+        for (std::int64_t e0 = e0_0; e0 < e0_1; ++e0)
+        {
+          std::sort(std::next(connections.begin(), offsets[e0]),
+                    std::next(connections.begin(), offsets[e0 + 1]));
+        }
+      });
 
   return graph::AdjacencyList<std::int32_t>(std::move(connections),
                                             std::move(offsets));
@@ -552,11 +680,14 @@ compute_from_transpose(const graph::AdjacencyList<std::int32_t>& c_d1_d0,
 /// @param[in] cell_type_d0 The cell type for entities of dimension d0
 /// @param[in] d0 Topological dimension
 /// @param[in] d1 Topological dimension
+/// @param[in] num_threads The number of threads used to look up the d1
+///   entities of the d0 entities
 /// @return The d0 -> d1 connectivity
 graph::AdjacencyList<std::int32_t>
 compute_from_map(const graph::AdjacencyList<std::int32_t>& c_d0_0,
                  const graph::AdjacencyList<std::int32_t>& c_d1_0,
-                 mesh::CellType cell_type_d0, int d0, int d1)
+                 mesh::CellType cell_type_d0, int d0, int d1,
+                 int num_threads)
 {
   assert(d1 > 0);
   assert(d0 > d1);
@@ -568,51 +699,58 @@ compute_from_map(const graph::AdjacencyList<std::int32_t>& c_d0_0,
 
   const std::size_t num_verts_d1
       = mesh::num_cell_vertices(mesh::cell_entity_type(cell_type_d0, d1));
-  std::vector<std::int32_t> key(num_verts_d1);
-  for (int e = 0; e < c_d1_0.num_nodes(); ++e)
   {
-    xtl::span<const std::int32_t> v = c_d1_0.links(e);
-    assert(v.size() == key.size());
-    std::partial_sort_copy(v.begin(), v.end(), key.begin(), key.end());
-    entity_to_index.insert({key, e});
+    std::vector<std::int32_t> key(num_verts_d1);
+    for (int e = 0; e < c_d1_0.num_nodes(); ++e)
+    {
+      xtl::span<const std::int32_t> v = c_d1_0.links(e);
+      assert(v.size() == key.size());
+      std::partial_sort_copy(v.begin(), v.end(), key.begin(), key.end());
+      entity_to_index.insert({key, e});
+    }
   }
 
-  std::vector<std::int32_t> connections;
-  connections.reserve(c_d0_0.num_nodes()
-                      * mesh::cell_num_entities(cell_type_d0, d1));
-  std::vector<std::int32_t> offsets(c_d0_0.num_nodes() + 1, 0);
-
-  // Search for d1 entities of d0 in map, and recover index
+  // Each d0 entity has the same number of d1 entities
   const auto e_vertices_ref = mesh::get_entity_vertices(cell_type_d0, d1);
-  std::vector<int> keys(e_vertices_ref.array().size());
+  const std::int32_t num_entities = e_vertices_ref.num_nodes();
+  std::vector<std::int32_t> offsets(c_d0_0.num_nodes() + 1, 0);
   for (int e = 0; e < c_d0_0.num_nodes(); ++e)
+    offsets[e + 1] = offsets[e] + num_entities;
+  std::vector<std::int32_t> connections(offsets.back());
+
+  // Search for d1 entities of d0 in map, and recover index. The map is
+  // only read, so the entities can be searched for concurrently.
+  auto search = [&](std::int64_t e_0, std::int64_t e_1, int)
   {
-    auto e0 = c_d0_0.links(e);
-    for (int i = 0; i < e_vertices_ref.num_nodes(); ++i)
+    std::vector<std::int32_t> key(num_verts_d1);
+    std::vector<int> keys(e_vertices_ref.array().size());
+    for (std::int64_t e = e_0; e < e_1; ++e)
     {
-      for (int j = 0; j < e_vertices_ref.num_links(i); ++j)
+      auto e0 = c_d0_0.links(e);
+      for (int i = 0; i < e_vertices_ref.num_nodes(); ++i)
       {
-        keys[i * e_vertices_ref.num_links(i) + j]
-            = e0[e_vertices_ref.links(i)[j]];
+        for (int j = 0; j < e_vertices_ref.num_links(i); ++j)
+        {
+          keys[i * e_vertices_ref.num_links(i) + j]
+              = e0[e_vertices_ref.links(i)[j]];
+        }
       }
-    }
 
-    for (int i = 0; i < e_vertices_ref.num_nodes(); ++i)
-    {
-      auto keys_begin
-          = std::next(keys.cbegin(), i * e_vertices_ref.num_links(i));
-      auto keys_end
-          = std::next(keys.cbegin(), (i + 1) * e_vertices_ref.num_links(i));
-      std::partial_sort_copy(keys_begin, keys_end, key.begin(), key.end());
-      const auto it = entity_to_index.find(key);
-      assert(it != entity_to_index.end());
-      connections.push_back(it->second);
+      for (int i = 0; i < e_vertices_ref.num_nodes(); ++i)
+      {
+        auto keys_begin
+            = std::next(keys.cbegin(), i * e_vertices_ref.num_links(i));
+        auto keys_end
+            = std::next(keys.cbegin(), (i + 1) * e_vertices_ref.num_links(i));
+        std::partial_sort_copy(keys_begin, keys_end, key.begin(), key.end());
+        const auto it = entity_to_index.find(key);
+        assert(it != entity_to_index.end());
+        connections[offsets[e] + i] = it->second;
+      }
     }
+  };
+  common::for_each_part(c_d0_0.num_nodes(), num_threads, search);
 
-    offsets[e + 1] = offsets[e] + e_vertices_ref.num_nodes();
-  }
-
-  connections.shrink_to_fit();
   return graph::AdjacencyList<std::int32_t>(std::move(connections),
                                             std::move(offsets));
 }
@@ -623,7 +761,8 @@ compute_from_map(const graph::AdjacencyList<std::int32_t>& c_d0_0,
 std::tuple<std::shared_ptr<graph::AdjacencyList<std::int32_t>>,
            std::shared_ptr<graph::AdjacencyList<std::int32_t>>,
            std::shared_ptr<common::IndexMap>>
-mesh::compute_entities(MPI_Comm comm, const Topology& topology, int dim)
+mesh::compute_entities(MPI_Comm comm, const Topology& topology, int dim,
+                       int num_threads)
 {
   LOG(INFO) << "Computing mesh entities of dimension " << dim;
   const int tdim = topology.dim();
@@ -658,13 +797,15 @@ mesh::compute_entities(MPI_Comm comm, const Topology& topology, int dim)
              std::shared_ptr<graph::AdjacencyList<std::int32_t>>,
              std::shared_ptr<common::IndexMap>>
       data = compute_entities_by_key_matching(
-          comm, *cells, vertex_map, cell_map, topology.cell_type(), dim);
+          comm, *cells, vertex_map, cell_map, topology.cell_type(), dim,
+          num_threads);
 
   return data;
 }
 //-----------------------------------------------------------------------------
 std::array<std::shared_ptr<graph::AdjacencyList<std::int32_t>>, 2>
-mesh::compute_connectivity(const Topology& topology, int d0, int d1)
+mesh::compute_connectivity(const Topology& topology, int d0, int d1,
+                           int num_threads)
 {
   LOG(INFO) << "Requesting connectivity " << d0 << " - " << d1;
 
@@ -708,9 +849,10 @@ mesh::compute_connectivity(const Topology& topology, int d0, int d1)
       auto c_d1_d0 = std::make_shared<graph::AdjacencyList<std::int32_t>>(
           compute_from_map(*c_d1_0, *c_d0_0,
                            mesh::cell_entity_type(topology.cell_type(), d1), d1,
-                           d0));
+                           d0, num_threads));
       auto c_d0_d1 = std::make_shared<graph::AdjacencyList<std::int32_t>>(
-          compute_from_transpose(*c_d1_d0, c_d0_0->num_nodes(), d0, d1));
+          compute_from_transpose(*c_d1_d0, c_d0_0->num_nodes(), d0, d1,
+                                 num_threads));
       return {c_d0_d1, c_d1_d0};
     }
     else
@@ -719,7 +861,7 @@ mesh::compute_connectivity(const Topology& topology, int d0, int d1)
       assert(topology.connectivity(d1, d0));
       auto c_d0_d1 = std::make_shared<graph::AdjacencyList<std::int32_t>>(
           compute_from_transpose(*topology.connectivity(d1, d0),
-                                 c_d0_0->num_nodes(), d0, d1));
+                                 c_d0_0->num_nodes(), d0, d1, num_threads));
       return {c_d0_d1, nullptr};
     }
   }
@@ -730,7 +872,7 @@ mesh::compute_connectivity(const Topology& topology, int d0, int d1)
     auto c_d0_d1
         = std::make_shared<graph::AdjacencyList<std::int32_t>>(compute_from_map(
             *c_d0_0, *c_d1_0, mesh::cell_entity_type(topology.cell_type(), d0),
-            d0, d1));
+            d0, d1, num_threads));
     return {c_d0_d1, nullptr};
   }
   else
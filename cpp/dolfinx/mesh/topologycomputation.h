@@ -34,13 +34,17 @@ class Topology;
 /// @param[in] comm MPI Communicator
 /// @param[in] topology Mesh topology
 /// @param[in] dim The dimension of the entities to create
+/// @param[in] num_threads The number of threads used to compute the
+///   local numbering of the entities. The numbering does not depend on
+///   the number of threads.
 /// @return Tuple of (cell-entity connectivity, entity-vertex
 ///   connectivity, index map). If the entities already exist, then
 ///   {nullptr, nullptr, nullptr} is returned.
 std::tuple<std::shared_ptr<graph::AdjacencyList<std::int32_t>>,
            std::shared_ptr<graph::AdjacencyList<std::int32_t>>,
            std::shared_ptr<common::IndexMap>>
-compute_entities(MPI_Comm comm, const Topology& topology, int dim);
+compute_entities(MPI_Comm comm, const Topology& topology, int dim,
+                 int num_threads = 1);
 
 /// Compute connectivity (d0 -> d1) for given pair of topological
 /// dimensions
@@ -52,7 +56,10 @@ compute_entities(MPI_Comm comm, const Topology& topology, int dim);
 ///   If (d0, d1) is computed and the computation of (d1, d0) was
 ///   required as part of computing (d0, d1), the (d1, d0) is returned
 ///   as the second entry. The second entry is otherwise nullptr.
+/// @param[in] num_threads The number of threads. The result does not
+///   depend on the number of threads.
 std::array<std::shared_ptr<graph::AdjacencyList<std::int32_t>>, 2>
-compute_connectivity(const Topology& topology, int d0, int d1);
+compute_connectivity(const Topology& topology, int d0, int d1,
+                     int num_threads = 1);
 
 } // namespace dolfinx::mesh
@@ -6,18 +6,25 @@
 
 #include "utils.h"
 #include "Geometry.h"
+#include "Mesh.h"
 #include "MeshTags.h"
+#include "Topology.h"
 #include "cell_types.h"
 #include "graphbuild.h"
 #include <algorithm>
+#include <array>
 #include <cfloat>
+#include <cmath>
 #include <cstdlib>
 #include <dolfinx/common/IndexMap.h>
 #include <dolfinx/common/log.h>
+#include <dolfinx/common/utils.h>
 #include <dolfinx/fem/ElementDofLayout.h>
 #include <dolfinx/graph/partition.h>
+#include <iterator>
+#include <numeric>
 #include <stdexcept>
-#include <unordered_set>
+#include <unordered_map>
 #include <xtensor-blas/xlinalg.hpp>
 #include <xtensor/xadapt.hpp>
 #include <xtensor/xbuilder.hpp>
@@ -28,6 +35,204 @@
 
 using namespace dolfinx;
 
+namespace
+{
+/// Add a layer of ghost cells to a cell partition. A cell is also sent
+/// to the destinations of the cells that it shares a facet with, which
+/// grows the ghost region on each rank by one layer of cells.
+/// @param[in] comm The MPI communicator
+/// @param[in] dual_graph The dual graph of the cells on this rank
+/// @param[in] dest The destination ranks of each cell on this rank,
+/// with the owning rank first
+/// @return The destination ranks of each cell, with the owning rank
+/// first
+graph::AdjacencyList<std::int32_t>
+add_ghost_layer(MPI_Comm comm,
+                const graph::AdjacencyList<std::int64_t>& dual_graph,
+                const graph::AdjacencyList<std::int32_t>& dest)
+{
+  const int size = dolfinx::MPI::size(comm);
+  const std::int32_t num_cells = dual_graph.num_nodes();
+
+  // Global offset of the cells on each rank
+  const std::int64_t offset
+      = dolfinx::MPI::global_offset(comm, num_cells, true);
+  std::vector<std::int64_t> offsets(size + 1, 0);
+  MPI_Allgather(&offset, 1, MPI_INT64_T, offsets.data(), 1, MPI_INT64_T,
+                comm);
+  const std::int64_t num_cells_local = num_cells;
+  MPI_Allreduce(&num_cells_local, &offsets.back(), 1, MPI_INT64_T, MPI_SUM,
+                comm);
+
+  // Request the destinations of the neighbouring cells that are on
+  // other ranks from the rank that holds them
+  std::vector<std::vector<std::int64_t>> request(size);
+  for (std::int64_t cn : dual_graph.array())
+  {
+    if (cn < offset or cn >= offset + num_cells)
+    {
+      auto it = std::upper_bound(offsets.begin(), offsets.end(), cn);
+      request[std::distance(offsets.begin(), it) - 1].push_back(cn);
+    }
+  }
+  for (auto& r : request)
+  {
+    std::sort(r.begin(), r.end());
+    r.erase(std::unique(r.begin(), r.end()), r.end());
+  }
+  const graph::AdjacencyList<std::int64_t> requested
+      = dolfinx::MPI::all_to_all(comm,
+                                 graph::AdjacencyList<std::int64_t>(request));
+
+  // Reply with the number of destinations of each requested cell,
+  // followed by the destinations
+  std::vector<std::vector<std::int32_t>> reply(size);
+  for (int p = 0; p < size; ++p)
+  {
+    for (std::int64_t cn : requested.links(p))
+    {
+      auto d = dest.links(cn - offset);
+      reply[p].push_back(d.size());
+      reply[p].insert(reply[p].end(), d.begin(), d.end());
+    }
+  }
+  const graph::AdjacencyList<std::int32_t> replied
+      = dolfinx::MPI::all_to_all(comm,
+                                 graph::AdjacencyList<std::int32_t>(reply));
+
+  // Destinations of the cells on other ranks
+  std::unordered_map<std::int64_t, xtl::span<const std::int32_t>>
+      remote_dest;
+  for (int p = 0; p < size; ++p)
+  {
+    auto data = replied.links(p);
+    std::size_t pos = 0;
+    for (std::int64_t cn : request[p])
+    {
+      remote_dest.insert({cn, data.subspan(pos + 1, data[pos])});
+      pos += data[pos] + 1;
+    }
+  }
+
+  // Owner first, followed by the (sorted) destinations of the cell and
+  // of its neighbours
+  std::vector<std::int32_t> new_dest, new_offsets = {0};
+  std::vector<std::int32_t> ranks;
+  for (std::int32_t c = 0; c < num_cells; ++c)
+  {
+    auto d = dest.links(c);
+    ranks.assign(std::next(d.begin()), d.end());
+    for (std::int64_t cn : dual_graph.links(c))
+    {
+      auto dn = (cn >= offset and cn < offset + num_cells)
+                    ? dest.links(cn - offset)
+                    : remote_dest.at(cn);
+      ranks.insert(ranks.end(), dn.begin(), dn.end());
+    }
+    std::sort(ranks.begin(), ranks.end());
+    ranks.erase(std::unique(ranks.begin(), ranks.end()), ranks.end());
+
+    new_dest.push_back(d[0]);
+    std::copy_if(ranks.begin(), ranks.end(), std::back_inserter(new_dest),
+                 [owner = d[0]](auto r) { return r != owner; });
+    new_offsets.push_back(new_dest.size());
+  }
+
+  return graph::AdjacencyList<std::int32_t>(std::move(new_dest),
+                                            std::move(new_offsets));
+}
+
+/// Geometric marking function
+using marker_fn
+    = std::function<xt::xtensor<bool, 1>(const xt::xtensor<double, 2>&)>;
+
+/// Compute the coordinates of mesh vertices
+/// @param[in] mesh The mesh
+/// @param[in] vertices The vertices (local indices)
+/// @return The coordinates of the vertices, with `x(j, i)` the `j`th
+/// component of `vertices[i]`
+xt::xtensor<double, 2>
+compute_vertex_coords(const mesh::Mesh& mesh,
+                      const xtl::span<const std::int32_t>& vertices)
+{
+  const mesh::Topology& topology = mesh.topology();
+  const int tdim = topology.dim();
+
+  // Get all vertex 'node' indices
+  const graph::AdjacencyList<std::int32_t>& x_dofmap = mesh.geometry().dofmap();
+  const std::int32_t num_vertices = topology.index_map(0)->size_local()
+                                    + topology.index_map(0)->num_ghosts();
+  auto c_to_v = topology.connectivity(tdim, 0);
+  assert(c_to_v);
+  std::vector<std::int32_t> vertex_to_node(num_vertices);
+  for (int c = 0; c < c_to_v->num_nodes(); ++c)
+  {
+    auto x_dofs = x_dofmap.links(c);
+    auto vertices = c_to_v->links(c);
+    for (std::size_t i = 0; i < vertices.size(); ++i)
+      vertex_to_node[vertices[i]] = x_dofs[i];
+  }
+
+  // Pack coordinates of vertices
+  const xt::xtensor<double, 2>& x_nodes = mesh.geometry().x();
+  xt::xtensor<double, 2> x_vertices({3, vertices.size()});
+  for (std::size_t i = 0; i < vertices.size(); ++i)
+    for (std::size_t j = 0; j < 3; ++j)
+      x_vertices(j, i) = x_nodes(vertex_to_node[vertices[i]], j);
+
+  return x_vertices;
+}
+
+/// Evaluate marking functions at vertices and find the mesh entities
+/// whose vertices are all marked
+/// @param[in] e_to_v The entity-to-vertex connectivity
+/// @param[in] entities The entities to check
+/// @param[in] vertex_to_pos The position of each vertex of the
+/// entities in @p x
+/// @param[in] x The coordinates of the vertices, with shape (3,
+/// num_vertices)
+/// @param[in] markers The marking functions
+/// @return The links of node `i` are the entities marked by
+/// `markers[i]`
+graph::AdjacencyList<std::int32_t>
+mark_entities(const graph::AdjacencyList<std::int32_t>& e_to_v,
+              const xtl::span<const std::int32_t>& entities,
+              const xtl::span<const std::int32_t>& vertex_to_pos,
+              const xt::xtensor<double, 2>& x,
+              const std::vector<marker_fn>& markers)
+{
+  // Run the marker functions on the vertex coordinates
+  std::vector<xt::xtensor<bool, 1>> marked;
+  marked.reserve(markers.size());
+  for (auto& marker : markers)
+  {
+    marked.push_back(marker(x));
+    if (marked.back().shape(0) != x.shape(1))
+      throw std::runtime_error("Length of array of markers is wrong.");
+  }
+
+  // Iterate over entities once, and check the entity vertices for each
+  // marker
+  std::vector<std::vector<std::int32_t>> marked_entities(markers.size());
+  for (std::int32_t e : entities)
+  {
+    auto vertices = e_to_v.links(e);
+    for (std::size_t i = 0; i < marked.size(); ++i)
+    {
+      const xt::xtensor<bool, 1>& m = marked[i];
+      if (std::all_of(vertices.begin(), vertices.end(),
+                      [&m, &vertex_to_pos](auto v)
+                      { return m[vertex_to_pos[v]]; }))
+      {
+        marked_entities[i].push_back(e);
+      }
+    }
+  }
+
+  return graph::AdjacencyList<std::int32_t>(marked_entities);
+}
+} // namespace
+
 //-----------------------------------------------------------------------------
 graph::AdjacencyList<std::int64_t>
 mesh::extract_topology(const CellType& cell_type,
@@ -60,9 +265,19 @@ mesh::extract_topology(const CellType& cell_type,
 std::vector<double> mesh::h(const Mesh& mesh,
                             const xtl::span<const std::int32_t>& entities,
                             int dim)
+{
+  std::vector<double> h_cells(entities.size());
+  mesh::h(mesh, entities, dim, h_cells);
+  return h_cells;
+}
+//-----------------------------------------------------------------------------
+void mesh::h(const Mesh& mesh, const xtl::span<const std::int32_t>& entities,
+             int dim, const xtl::span<double>& h, int num_threads)
 {
   if (dim != mesh.topology().dim())
     throw std::runtime_error("Cell size when dim ne tdim  requires updating.");
+  if (h.size() != entities.size())
+    throw std::runtime_error("Size of array for cell sizes is wrong.");
 
   // Get number of cell vertices
   const mesh::CellType type
@@ -72,109 +287,145 @@ std::vector<double> mesh::h(const Mesh& mesh,
   // Get geometry dofmap and dofs
   const mesh::Geometry& geometry = mesh.geometry();
   const graph::AdjacencyList<std::int32_t>& x_dofs = geometry.dofmap();
-  const xt::xtensor<double, 2>& geom_dofs = geometry.x();
-  std::vector<double> h_cells(entities.size(), 0);
+  const double* x = geometry.x().data();
   assert(num_vertices <= 8);
-  xt::xtensor_fixed<double, xt::xshape<8, 3>> points;
-  for (std::size_t e = 0; e < entities.size(); ++e)
-  {
-    // Get the coordinates  of the vertices
-    auto dofs = x_dofs.links(entities[e]);
-    xt::view(points, xt::range(0, num_vertices), xt::all())
-        = xt::view(geom_dofs, xt::keep(dofs), xt::all());
 
-    // Get maximum edge length
-    for (int i = 0; i < num_vertices; ++i)
+  auto compute = [&](std::size_t e0, std::size_t e1, int)
+  {
+    // Vertex coordinates of a block of entities, with p[(i * 3 + k) *
+    // block_size + b] the kth component of vertex i of entity b
+    constexpr std::size_t block_size = 32;
+    std::array<double, 8 * 3 * block_size> p;
+    std::array<double, block_size> h2;
+    for (std::size_t b0 = e0; b0 < e1; b0 += block_size)
     {
-      for (int j = i + 1; j < num_vertices; ++j)
+      const std::size_t nb = std::min(block_size, e1 - b0);
+      for (std::size_t b = 0; b < nb; ++b)
       {
-        auto p0 = xt::row(points, i);
-        auto p1 = xt::row(points, j);
-        h_cells[e] = std::max(h_cells[e], xt::norm_l2(p0 - p1)());
+        auto dofs = x_dofs.links(entities[b0 + b]);
+        for (int i = 0; i < num_vertices; ++i)
+          for (int k = 0; k < 3; ++k)
+            p[(i * 3 + k) * block_size + b] = x[3 * dofs[i] + k];
       }
-    }
-  }
 
-  return h_cells;
+      // Get maximum squared edge length for all entities of the block
+      std::fill_n(h2.begin(), nb, 0.0);
+      for (int i = 0; i < num_vertices; ++i)
+      {
+        for (int j = i + 1; j < num_vertices; ++j)
+        {
+          const double* pi = p.data() + i * 3 * block_size;
+          const double* pj = p.data() + j * 3 * block_size;
+          for (std::size_t b = 0; b < nb; ++b)
+          {
+            double d2 = 0.0;
+            for (int k = 0; k < 3; ++k)
+            {
+              const double d = pj[k * block_size + b] - pi[k * block_size + b];
+              d2 += d * d;
+            }
+            h2[b] = std::max(h2[b], d2);
+          }
+        }
+      }
+
+      for (std::size_t b = 0; b < nb; ++b)
+        h[b0 + b] = std::sqrt(h2[b]);
+    }
+  };
+  common::for_each_part(entities.size(), num_threads, compute);
 }
 //-----------------------------------------------------------------------------
 xt::xtensor<double, 2>
 mesh::cell_normals(const mesh::Mesh& mesh, int dim,
                    const xtl::span<const std::int32_t>& entities)
+{
+  xt::xtensor<double, 2> n({entities.size(), 3});
+  mesh::cell_normals(mesh, dim, entities, xtl::span(n.data(), n.size()));
+  return n;
+}
+//-----------------------------------------------------------------------------
+void mesh::cell_normals(const mesh::Mesh& mesh, int dim,
+                        const xtl::span<const std::int32_t>& entities,
+                        const xtl::span<double>& n, int num_threads)
 {
   const int gdim = mesh.geometry().dim();
   const mesh::CellType type
       = mesh::cell_entity_type(mesh.topology().cell_type(), dim);
+  if (n.size() != 3 * entities.size())
+    throw std::runtime_error("Size of array for normals is wrong.");
 
   // Find geometry nodes for topology entities
-  const xt::xtensor<double, 2>& xg = mesh.geometry().x();
+  const double* xg = mesh.geometry().x().data();
 
   // Orient cells if they are tetrahedron
   bool orient = false;
   if (mesh.topology().cell_type() == mesh::CellType::tetrahedron)
     orient = true;
-  xt::xtensor<std::int32_t, 2> geometry_entities
+  const xt::xtensor<std::int32_t, 2> geometry_entities
       = entities_to_geometry(mesh, dim, entities, orient);
 
-  const std::size_t num_entities = entities.size();
-  xt::xtensor<double, 2> n({num_entities, 3});
+  // Normalise a normal
+  auto normalise = [](double* ni)
+  {
+    const double norm
+        = std::sqrt(ni[0] * ni[0] + ni[1] * ni[1] + ni[2] * ni[2]);
+    for (int k = 0; k < 3; ++k)
+      ni[k] /= norm;
+  };
+
   switch (type)
   {
   case mesh::CellType::interval:
   {
     if (gdim > 2)
       throw std::invalid_argument("Interval cell normal undefined in 3D");
-    for (std::size_t i = 0; i < num_entities; ++i)
+    auto compute = [&](std::size_t e0, std::size_t e1, int)
     {
-      // Get the two vertices as points
-      auto vertices = xt::row(geometry_entities, i);
-      auto p0 = xt::row(xg, vertices[0]);
-      auto p1 = xt::row(xg, vertices[1]);
-
-      // Define normal by rotating tangent counter-clockwise
-      auto t = p1 - p0;
-      auto ni = xt::row(n, i);
-      ni[0] = -t[1];
-      ni[1] = t[0];
-      ni[2] = 0.0;
-      ni /= xt::norm_l2(ni);
-    }
-    return n;
+      for (std::size_t i = e0; i < e1; ++i)
+      {
+        // Get the two vertices as points
+        const double* p0 = xg + 3 * geometry_entities(i, 0);
+        const double* p1 = xg + 3 * geometry_entities(i, 1);
+
+        // Define normal by rotating tangent counter-clockwise
+        double* ni = n.data() + 3 * i;
+        ni[0] = -(p1[1] - p0[1]);
+        ni[1] = p1[0] - p0[0];
+        ni[2] = 0.0;
+        normalise(ni);
+      }
+    };
+    common::for_each_part(entities.size(), num_threads, compute);
+    return;
   }
   case mesh::CellType::triangle:
-  {
-    for (std::size_t i = 0; i < num_entities; ++i)
-    {
-      // Get the three vertices as points
-      auto vertices = xt::row(geometry_entities, i);
-      auto p0 = xt::row(xg, vertices[0]);
-      auto p1 = xt::row(xg, vertices[1]);
-      auto p2 = xt::row(xg, vertices[2]);
-
-      // Define cell normal via cross product of first two edges
-      auto ni = xt::row(n, i);
-      ni = xt::linalg::cross((p1 - p0), (p2 - p0));
-      ni /= xt::norm_l2(ni);
-    }
-    return n;
-  }
   case mesh::CellType::quadrilateral:
   {
-    // TODO: check
-    for (std::size_t i = 0; i < num_entities; ++i)
+    // TODO: check quadrilateral
+    auto compute = [&](std::size_t e0, std::size_t e1, int)
     {
-      // Get three vertices as points
-      auto vertices = xt::row(geometry_entities, i);
-      auto p0 = xt::row(xg, vertices[0]);
-      auto p1 = xt::row(xg, vertices[1]);
-      auto p2 = xt::row(xg, vertices[2]);
-
-      // Defined cell normal via cross product of first two edges:
-      auto ni = xt::row(n, i);
-      ni = xt::linalg::cross((p1 - p0), (p2 - p0));
-      ni /= xt::norm_l2(ni);
-    }
-    return n;
+      for (std::size_t i = e0; i < e1; ++i)
+      {
+        // Get three vertices as points
+        const double* p0 = xg + 3 * geometry_entities(i, 0);
+        const double* p1 = xg + 3 * geometry_entities(i, 1);
+        const double* p2 = xg + 3 * geometry_entities(i, 2);
+
+        // Define cell normal via cross product of first two edges
+        const std::array<double, 3> t0
+            = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+        const std::array<double, 3> t1
+            = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+        double* ni = n.data() + 3 * i;
+        ni[0] = t0[1] * t1[2] - t0[2] * t1[1];
+        ni[1] = t0[2] * t1[0] - t0[0] * t1[2];
+        ni[2] = t0[0] * t1[1] - t0[1] * t1[0];
+        normalise(ni);
+      }
+    };
+    common::for_each_part(entities.size(), num_threads, compute);
+    return;
   }
   default:
     throw std::invalid_argument(
@@ -186,27 +437,56 @@ xt::xtensor<double, 2>
 mesh::midpoints(const mesh::Mesh& mesh, int dim,
                 const xtl::span<const std::int32_t>& entities)
 {
-  const xt::xtensor<double, 2>& x = mesh.geometry().x();
+  xt::xtensor<double, 2> x_mid({entities.size(), 3});
+  mesh::midpoints(mesh, dim, entities, xtl::span(x_mid.data(), x_mid.size()));
+  return x_mid;
+}
+//-----------------------------------------------------------------------------
+void mesh::midpoints(const mesh::Mesh& mesh, int dim,
+                     const xtl::span<const std::int32_t>& entities,
+                     const xtl::span<double>& x_mid, int num_threads)
+{
+  if (x_mid.size() != 3 * entities.size())
+    throw std::runtime_error("Size of array for midpoints is wrong.");
+  const double* x = mesh.geometry().x().data();
 
   // Build map from entity -> geometry dof
   // FIXME: This assumes a linear geometry.
-  xt::xtensor<std::int32_t, 2> entity_to_geometry
+  const xt::xtensor<std::int32_t, 2> entity_to_geometry
       = entities_to_geometry(mesh, dim, entities, false);
+  const std::size_t num_vertices = entity_to_geometry.shape(1);
 
-  xt::xtensor<double, 2> x_mid({entities.size(), 3});
-  for (std::size_t e = 0; e < entity_to_geometry.shape(0); ++e)
+  auto compute = [&](std::size_t e0, std::size_t e1, int)
   {
-    auto rows = xt::row(entity_to_geometry, e);
-    xt::row(x_mid, e) = xt::mean(xt::view(x, xt::keep(rows)), 0);
-  }
-
-  return x_mid;
+    for (std::size_t e = e0; e < e1; ++e)
+    {
+      double* xe = x_mid.data() + 3 * e;
+      std::fill_n(xe, 3, 0.0);
+      for (std::size_t v = 0; v < num_vertices; ++v)
+      {
+        const double* xv = x + 3 * entity_to_geometry(e, v);
+        for (int k = 0; k < 3; ++k)
+          xe[k] += xv[k];
+      }
+      for (int k = 0; k < 3; ++k)
+        xe[k] /= num_vertices;
+    }
+  };
+  common::for_each_part(entities.size(), num_threads, compute);
 }
 //-----------------------------------------------------------------------------
 std::vector<std::int32_t> mesh::locate_entities(
     const mesh::Mesh& mesh, int dim,
     const std::function<xt::xtensor<bool, 1>(const xt::xtensor<double, 2>&)>&
         marker)
+{
+  return locate_entities(mesh, dim, std::vector<marker_fn>{marker}).array();
+}
+//-----------------------------------------------------------------------------
+graph::AdjacencyList<std::int32_t> mesh::locate_entities(
+    const mesh::Mesh& mesh, int dim,
+    const std::vector<std::function<xt::xtensor<bool, 1>(
+        const xt::xtensor<double, 2>&)>>& markers)
 {
   const mesh::Topology& topology = mesh.topology();
   const int tdim = topology.dim();
@@ -217,61 +497,36 @@ std::vector<std::int32_t> mesh::locate_entities(
   if (dim < tdim)
     mesh.topology_mutable().create_connectivity(dim, 0);
 
-  // Get all vertex 'node' indices
-  const graph::AdjacencyList<std::int32_t>& x_dofmap = mesh.geometry().dofmap();
-  const std::int32_t num_vertices = topology.index_map(0)->size_local()
-                                    + topology.index_map(0)->num_ghosts();
-  auto c_to_v = topology.connectivity(tdim, 0);
-  assert(c_to_v);
-  std::vector<std::int32_t> vertex_to_node(num_vertices);
-  for (int c = 0; c < c_to_v->num_nodes(); ++c)
-  {
-    auto x_dofs = x_dofmap.links(c);
-    auto vertices = c_to_v->links(c);
-    for (std::size_t i = 0; i < vertices.size(); ++i)
-      vertex_to_node[vertices[i]] = x_dofs[i];
-  }
+  // Pack coordinates of all vertices
+  auto map_v = topology.index_map(0);
+  assert(map_v);
+  std::vector<std::int32_t> vertices(map_v->size_local()
+                                     + map_v->num_ghosts());
+  std::iota(vertices.begin(), vertices.end(), 0);
+  const xt::xtensor<double, 2> x_vertices
+      = compute_vertex_coords(mesh, vertices);
 
-  // Pack coordinates of vertices
-  const xt::xtensor<double, 2>& x_nodes = mesh.geometry().x();
-  xt::xtensor<double, 2> x_vertices({3, vertex_to_node.size()});
-  for (std::size_t i = 0; i < vertex_to_node.size(); ++i)
-    for (std::size_t j = 0; j < 3; ++j)
-      x_vertices(j, i) = x_nodes(vertex_to_node[i], j);
-
-  // Run marker function on vertex coordinates
-  const xt::xtensor<bool, 1> marked = marker(x_vertices);
-  if (marked.shape(0) != x_vertices.shape(1))
-    throw std::runtime_error("Length of array of markers is wrong.");
-
-  // Iterate over entities to build vector of marked entities
+  // Check all entities against the markers
   auto e_to_v = topology.connectivity(dim, 0);
   assert(e_to_v);
-  std::vector<std::int32_t> entities;
-  for (int e = 0; e < e_to_v->num_nodes(); ++e)
-  {
-    // Iterate over entity vertices
-    bool all_vertices_marked = true;
-    for (std::int32_t v : e_to_v->links(e))
-    {
-      if (!marked[v])
-      {
-        all_vertices_marked = false;
-        break;
-      }
-    }
-
-    if (all_vertices_marked)
-      entities.push_back(e);
-  }
-
-  return entities;
+  std::vector<std::int32_t> entities(e_to_v->num_nodes());
+  std::iota(entities.begin(), entities.end(), 0);
+  return mark_entities(*e_to_v, entities, vertices, x_vertices, markers);
 }
 //-----------------------------------------------------------------------------
 std::vector<std::int32_t> mesh::locate_entities_boundary(
     const mesh::Mesh& mesh, int dim,
     const std::function<xt::xtensor<bool, 1>(const xt::xtensor<double, 2>&)>&
         marker)
+{
+  return locate_entities_boundary(mesh, dim, std::vector<marker_fn>{marker})
+      .array();
+}
+//-----------------------------------------------------------------------------
+graph::AdjacencyList<std::int32_t> mesh::locate_entities_boundary(
+    const mesh::Mesh& mesh, int dim,
+    const std::vector<std::function<xt::xtensor<bool, 1>(
+        const xt::xtensor<double, 2>&)>>& markers)
 {
   const mesh::Topology& topology = mesh.topology();
   const int tdim = topology.dim();
@@ -281,101 +536,55 @@ std::vector<std::int32_t> mesh::locate_entities_boundary(
         "Cannot use mesh::locate_entities_boundary (boundary) for cells.");
   }
 
-  // Compute marker for boundary facets
-  mesh.topology_mutable().create_entities(tdim - 1);
-  mesh.topology_mutable().create_connectivity(tdim - 1, tdim);
-  const std::vector boundary_facet = mesh::compute_boundary_facets(topology);
+  // Get the exterior facets, which are computed once and stored by the
+  // topology
+  mesh.topology_mutable().create_boundary_facets();
+  std::shared_ptr<const std::vector<std::int32_t>> boundary_facets
+      = topology.boundary_facets();
+  assert(boundary_facets);
 
   // Create entities and connectivities
   mesh.topology_mutable().create_entities(dim);
   mesh.topology_mutable().create_connectivity(tdim - 1, dim);
   mesh.topology_mutable().create_connectivity(tdim - 1, 0);
-  mesh.topology_mutable().create_connectivity(0, tdim);
-  mesh.topology_mutable().create_connectivity(tdim, 0);
+  mesh.topology_mutable().create_connectivity(dim, 0);
 
-  // Build set of vertices on boundary and set of boundary entities
+  // Build list of vertices on boundary and list of boundary entities
   auto f_to_v = topology.connectivity(tdim - 1, 0);
   assert(f_to_v);
   auto f_to_e = topology.connectivity(tdim - 1, dim);
   assert(f_to_e);
-  std::unordered_set<std::int32_t> boundary_vertices;
-  std::unordered_set<std::int32_t> facet_entities;
-  for (std::size_t f = 0; f < boundary_facet.size(); ++f)
+  std::vector<std::int32_t> vertices, entities;
+  for (std::int32_t f : *boundary_facets)
   {
-    if (boundary_facet[f])
-    {
-      for (auto e : f_to_e->links(f))
-        facet_entities.insert(e);
-
-      for (auto v : f_to_v->links(f))
-        boundary_vertices.insert(v);
-    }
+    auto e = f_to_e->links(f);
+    entities.insert(entities.end(), e.begin(), e.end());
+    auto v = f_to_v->links(f);
+    vertices.insert(vertices.end(), v.begin(), v.end());
   }
-
-  // Get geometry data
-  const graph::AdjacencyList<std::int32_t>& x_dofmap = mesh.geometry().dofmap();
-  const xt::xtensor<double, 2>& x_nodes = mesh.geometry().x();
-
-  // Build vector of boundary vertices
-  const std::vector<std::int32_t> vertices(boundary_vertices.begin(),
-                                           boundary_vertices.end());
-
-  // Get all vertex 'node' indices
-  auto v_to_c = topology.connectivity(0, tdim);
-  assert(v_to_c);
-  auto c_to_v = topology.connectivity(tdim, 0);
-  assert(c_to_v);
-  xt::xtensor<double, 2> x_vertices({3, vertices.size()});
-  std::vector<std::int32_t> vertex_to_pos(v_to_c->num_nodes(), -1);
+  std::sort(entities.begin(), entities.end());
+  entities.erase(std::unique(entities.begin(), entities.end()),
+                 entities.end());
+  std::sort(vertices.begin(), vertices.end());
+  vertices.erase(std::unique(vertices.begin(), vertices.end()),
+                 vertices.end());
+
+  // Pack coordinates of the boundary vertices
+  const xt::xtensor<double, 2> x_vertices
+      = compute_vertex_coords(mesh, vertices);
+  auto map_v = topology.index_map(0);
+  assert(map_v);
+  std::vector<std::int32_t> vertex_to_pos(
+      map_v->size_local() + map_v->num_ghosts(), -1);
   for (std::size_t i = 0; i < vertices.size(); ++i)
-  {
-    const std::int32_t v = vertices[i];
-
-    // Get first cell and find position
-    const int c = v_to_c->links(v)[0];
-    auto vertices = c_to_v->links(c);
-    auto it = std::find(vertices.begin(), vertices.end(), v);
-    assert(it != vertices.end());
-    const int local_pos = std::distance(vertices.begin(), it);
+    vertex_to_pos[vertices[i]] = i;
 
-    auto dofs = x_dofmap.links(c);
-    for (int j = 0; j < 3; ++j)
-      x_vertices(j, i) = x_nodes(dofs[local_pos], j);
-
-    vertex_to_pos[v] = i;
-  }
-
-  // Run marker function on the vertex coordinates
-  const xt::xtensor<bool, 1> marked = marker(x_vertices);
-  if (marked.shape(0) != x_vertices.shape(1))
-    throw std::runtime_error("Length of array of markers is wrong.");
-
-  // Loop over entities and check vertex markers
+  // Check the boundary entities against the markers. The vertices of
+  // the entities are all on a boundary facet.
   auto e_to_v = topology.connectivity(dim, 0);
   assert(e_to_v);
-  std::vector<std::int32_t> entities;
-  for (auto e : facet_entities)
-  {
-    // Assume all vertices on this entity are marked
-    bool all_vertices_marked = true;
-
-    // Iterate over entity vertices
-    for (auto v : e_to_v->links(e))
-    {
-      const std::int32_t pos = vertex_to_pos[v];
-      if (!marked[pos])
-      {
-        all_vertices_marked = false;
-        break;
-      }
-    }
-
-    // Mark facet with all vertices marked
-    if (all_vertices_marked)
-      entities.push_back(e);
-  }
-
-  return entities;
+  return mark_entities(*e_to_v, entities, vertex_to_pos, x_vertices,
+                       markers);
 }
 //-----------------------------------------------------------------------------
 xt::xtensor<std::int32_t, 2>
@@ -458,39 +667,12 @@ mesh::entities_to_geometry(const mesh::Mesh& mesh, int dim,
 //------------------------------------------------------------------------
 std::vector<std::int32_t> mesh::exterior_facet_indices(const Mesh& mesh)
 {
-  // Note: Possible duplication of mesh::Topology::compute_boundary_facets
-
-  const mesh::Topology& topology = mesh.topology();
-  std::vector<std::int32_t> surface_facets;
-
-  // Get number of facets owned by this process
-  const int tdim = topology.dim();
-  mesh.topology_mutable().create_connectivity(tdim - 1, tdim);
-  auto f_to_c = topology.connectivity(tdim - 1, tdim);
-  assert(topology.index_map(tdim - 1));
-  std::set<std::int32_t> fwd_shared_facets;
-
-  // Only need to consider shared facets when there are no ghost cells
-  if (topology.index_map(tdim)->num_ghosts() == 0)
-  {
-    fwd_shared_facets.insert(
-        topology.index_map(tdim - 1)->shared_indices().array().begin(),
-        topology.index_map(tdim - 1)->shared_indices().array().end());
-  }
-
-  // Find all owned facets (not ghost) with only one attached cell, which are
-  // also not shared forward (ghost on another process)
-  const int num_facets = topology.index_map(tdim - 1)->size_local();
-  for (int f = 0; f < num_facets; ++f)
-  {
-    if (f_to_c->num_links(f) == 1
-        and fwd_shared_facets.find(f) == fwd_shared_facets.end())
-    {
-      surface_facets.push_back(f);
-    }
-  }
-
-  return surface_facets;
+  // The exterior facets are computed once and stored by the topology
+  mesh.topology_mutable().create_boundary_facets();
+  std::shared_ptr<const std::vector<std::int32_t>> facets
+      = mesh.topology().boundary_facets();
+  assert(facets);
+  return *facets;
 }
 //------------------------------------------------------------------------------
 graph::AdjacencyList<std::int32_t>
@@ -506,10 +688,22 @@ graph::AdjacencyList<std::int32_t>
 mesh::partition_cells_graph(MPI_Comm comm, int n, int tdim,
                             const graph::AdjacencyList<std::int64_t>& cells,
                             mesh::GhostMode ghost_mode,
-                            const graph::partition_fn& partfn)
+                            const graph::partition_fn& partfn,
+                            const xtl::span<const std::int32_t>& cell_weights,
+                            int num_ghost_layers)
 {
   LOG(INFO) << "Compute partition of cells across ranks";
 
+  if (ghost_mode != mesh::GhostMode::none and num_ghost_layers < 1)
+    throw std::runtime_error("Number of ghost layers must be at least 1");
+
+  if (!cell_weights.empty()
+      and (std::int32_t)cell_weights.size() != cells.num_nodes())
+  {
+    throw std::runtime_error("Number of cell weights does not match the "
+                             "number of cells");
+  }
+
   // Compute distributed dual graph (for the cells on this process)
   const auto [dual_graph, graph_info]
       = mesh::build_dual_graph(comm, cells, tdim);
@@ -520,7 +714,122 @@ mesh::partition_cells_graph(MPI_Comm comm, int n, int tdim,
   // Just flag any kind of ghosting for now
   bool ghosting = (ghost_mode != mesh::GhostMode::none);
 
-  // Compute partition
-  return partfn(comm, n, dual_graph, num_ghost_nodes, ghosting);
+  // Compute partition, which includes the first layer of ghost cells
+  graph::AdjacencyList<std::int32_t> dest = partfn(
+      comm, n, dual_graph, num_ghost_nodes, ghosting, cell_weights, {});
+
+  // Add the further layers of ghost cells
+  if (ghosting)
+  {
+    for (int i = 1; i < num_ghost_layers; ++i)
+      dest = add_ghost_layer(comm, dual_graph, dest);
+  }
+
+  return dest;
+}
+//-----------------------------------------------------------------------------
+Table mesh::memory_usage(const Mesh& mesh)
+{
+  Table table("Memory usage");
+  double total = 0;
+  auto set = [&table, &total](std::string row, std::size_t bytes)
+  {
+    table.set(row, "MB", bytes / 1.0e6);
+    total += bytes / 1.0e6;
+  };
+
+  // Connectivities, counting connectivities that are shared by several
+  // pairs of dimensions once
+  const Topology& topology = mesh.topology();
+  const int tdim = topology.dim();
+  std::vector<const graph::AdjacencyList<std::int32_t>*> connectivities;
+  std::size_t connectivity_size = 0;
+  for (int d0 = 0; d0 <= tdim; ++d0)
+  {
+    for (int d1 = 0; d1 <= tdim; ++d1)
+    {
+      auto c = topology.connectivity(d0, d1);
+      if (c and std::find(connectivities.begin(), connectivities.end(),
+                          c.get())
+                    == connectivities.end())
+      {
+        connectivities.push_back(c.get());
+        connectivity_size += c->memory_usage();
+        set("Topology connectivity (" + std::to_string(d0) + ", "
+                + std::to_string(d1) + ")",
+            c->memory_usage());
+      }
+    }
+  }
+  set("Topology permutations and exterior facets",
+      topology.memory_usage() - connectivity_size);
+
+  // Index maps, which may be shared by the topology and the geometry
+  std::vector<const common::IndexMap*> maps;
+  for (int d = 0; d <= tdim; ++d)
+  {
+    if (auto map = topology.index_map(d); map)
+    {
+      maps.push_back(map.get());
+      set("Topology index map (" + std::to_string(d) + ")",
+          map->memory_usage());
+    }
+  }
+
+  // The geometry dofmap may be the cell-vertex connectivity, which is
+  // counted with the topology
+  const Geometry& geometry = mesh.geometry();
+  std::size_t geometry_size = geometry.memory_usage();
+  if (&geometry.dofmap() == topology.connectivity(tdim, 0).get())
+    geometry_size -= geometry.dofmap().memory_usage();
+  set("Geometry", geometry_size);
+  if (auto map = geometry.index_map();
+      map and std::find(maps.begin(), maps.end(), map.get()) == maps.end())
+  {
+    set("Geometry index map", map->memory_usage());
+  }
+
+  table.set("Total", "MB", total);
+  return table;
+}
+//-----------------------------------------------------------------------------
+Table mesh::compute_partition_quality(
+    MPI_Comm comm, int n, int tdim,
+    const graph::AdjacencyList<std::int64_t>& cells,
+    const graph::AdjacencyList<std::int32_t>& dest)
+{
+  const auto [dual_graph, graph_info] = build_dual_graph(comm, cells, tdim);
+  return graph::compute_partition_quality(comm, n, dual_graph, dest);
+}
+//-----------------------------------------------------------------------------
+Table mesh::partition_summary(const Mesh& mesh)
+{
+  Table table("Partition summary");
+  const int mpi_size = dolfinx::MPI::size(mesh.mpi_comm());
+  const Topology& topology = mesh.topology();
+  for (int d = 0; d <= topology.dim(); ++d)
+  {
+    auto map = topology.index_map(d);
+    if (!map)
+      continue;
+
+    const auto [src_ranks, dest_ranks] = dolfinx::MPI::neighbors(
+        map->comm(common::IndexMap::Direction::forward));
+    std::vector<int> ranks(src_ranks);
+    ranks.insert(ranks.end(), dest_ranks.begin(), dest_ranks.end());
+    std::sort(ranks.begin(), ranks.end());
+    ranks.erase(std::unique(ranks.begin(), ranks.end()), ranks.end());
+
+    const std::string row = "Topology index map (" + std::to_string(d) + ")";
+    const double mean = double(map->size_global()) / mpi_size;
+    table.set(row, "owned", map->size_local());
+    table.set(row, "ghosts", map->num_ghosts());
+    table.set(row, "neighbours", int(ranks.size()));
+    table.set(row, "send volume",
+              int(map->shared_indices().array().size()));
+    table.set(row, "imbalance", mean > 0.0 ? map->size_local() / mean : 1.0);
+  }
+
+  return table;
 }
 //-----------------------------------------------------------------------------
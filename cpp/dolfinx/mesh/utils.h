@@ -6,10 +6,15 @@
 
 #pragma once
 
+#include <algorithm>
+#include <dolfinx/common/IndexMap.h>
 #include <dolfinx/common/MPI.h>
+#include <dolfinx/common/Table.h>
 #include <dolfinx/graph/AdjacencyList.h>
 #include <dolfinx/graph/partition.h>
 #include <functional>
+#include <stdexcept>
+#include <vector>
 #include <xtl/xspan.hpp>
 
 namespace dolfinx::fem
@@ -40,15 +45,50 @@ extract_topology(const CellType& cell_type, const fem::ElementDofLayout& layout,
 std::vector<double> h(const Mesh& mesh,
                       const xtl::span<const std::int32_t>& entities, int dim);
 
+/// Compute greatest distance between any two vertices of each entity.
+/// The entities are processed in blocks, with the vertex coordinates
+/// of a block packed such that the distances are computed for all
+/// entities of the block at once.
+/// @param[in] mesh The mesh
+/// @param[in] entities The entities (local indices)
+/// @param[in] dim Topological dimension of the entities
+/// @param[out] h The greatest distance for each entity, with length
+/// equal to the number of entities
+/// @param[in] num_threads The number of threads
+void h(const Mesh& mesh, const xtl::span<const std::int32_t>& entities,
+       int dim, const xtl::span<double>& h, int num_threads = 1);
+
 /// Compute normal to given cell (viewed as embedded in 3D)
 xt::xtensor<double, 2>
 cell_normals(const Mesh& mesh, int dim,
              const xtl::span<const std::int32_t>& entities);
 
+/// Compute normal to given cell (viewed as embedded in 3D)
+/// @param[in] mesh The mesh
+/// @param[in] dim Topological dimension of the entities
+/// @param[in] entities The entities (local indices)
+/// @param[out] n The normals, with shape (num_entities, 3) and row-major
+/// storage
+/// @param[in] num_threads The number of threads
+void cell_normals(const Mesh& mesh, int dim,
+                  const xtl::span<const std::int32_t>& entities,
+                  const xtl::span<double>& n, int num_threads = 1);
+
 /// Compute midpoints or mesh entities of a given dimension
 xt::xtensor<double, 2> midpoints(const mesh::Mesh& mesh, int dim,
                                  const xtl::span<const std::int32_t>& entities);
 
+/// Compute midpoints or mesh entities of a given dimension
+/// @param[in] mesh The mesh
+/// @param[in] dim Topological dimension of the entities
+/// @param[in] entities The entities (local indices)
+/// @param[out] x The midpoints, with shape (num_entities, 3) and
+/// row-major storage
+/// @param[in] num_threads The number of threads
+void midpoints(const mesh::Mesh& mesh, int dim,
+               const xtl::span<const std::int32_t>& entities,
+               const xtl::span<double>& x, int num_threads = 1);
+
 /// Compute indices of all mesh entities that evaluate to true for the
 /// provided geometric marking function. An entity is considered marked
 /// if the marker function evaluates true for all of its vertices.
@@ -89,6 +129,40 @@ std::vector<std::int32_t> locate_entities_boundary(
     const std::function<xt::xtensor<bool, 1>(const xt::xtensor<double, 2>&)>&
         marker);
 
+/// Compute indices of all mesh entities that evaluate to true for each
+/// of the provided geometric marking functions. The vertex coordinates
+/// are computed once, and the mesh entities are traversed once for all
+/// markers, which is cheaper than calling locate_entities for each
+/// marker.
+///
+/// @param[in] mesh The mesh
+/// @param[in] dim The topological dimension of the entities to be
+///   considered
+/// @param[in] markers The marking functions
+/// @returns The links of node `i` are the entities (indices local to
+///   the process, including ghosts) marked by `markers[i]`
+graph::AdjacencyList<std::int32_t> locate_entities(
+    const mesh::Mesh& mesh, int dim,
+    const std::vector<std::function<xt::xtensor<bool, 1>(
+        const xt::xtensor<double, 2>&)>>& markers);
+
+/// Compute indices of all mesh entities that are attached to an owned
+/// boundary facet and evaluate to true for each of the provided
+/// geometric marking functions. The exterior facets are computed once
+/// and stored by the topology (see Topology::create_boundary_facets),
+/// and the boundary entities are traversed once for all markers.
+///
+/// @param[in] mesh The mesh
+/// @param[in] dim The topological dimension of the entities to be
+/// considered. Must be less than the topological dimension of the mesh.
+/// @param[in] markers The marking functions
+/// @returns The links of node `i` are the entities (indices local to
+///   the process) marked by `markers[i]`
+graph::AdjacencyList<std::int32_t> locate_entities_boundary(
+    const mesh::Mesh& mesh, int dim,
+    const std::vector<std::function<xt::xtensor<bool, 1>(
+        const xt::xtensor<double, 2>&)>>& markers);
+
 /// Compute the indices the geometry data for the vertices of the given
 /// mesh entities
 ///
@@ -107,7 +181,8 @@ entities_to_geometry(const mesh::Mesh& mesh, int dim,
 
 /// Compute the indices (local) of all exterior facets. An exterior facet
 /// (co-dimension 1) is one that is connected globally to only one cell of
-/// co-dimension 0).
+/// co-dimension 0). The exterior facets are stored by the topology, see
+/// Topology::create_boundary_facets.
 /// @param[in] mesh Mesh
 /// @return List of facet indices of exterior facets of the mesh
 std::vector<std::int32_t> exterior_facet_indices(const Mesh& mesh);
@@ -134,10 +209,142 @@ partition_cells_graph(MPI_Comm comm, int n, int tdim,
 
 /// Compute destination rank for mesh cells on this rank by applying the
 /// a provided graph partitioner to the dual graph of the mesh
+///
+/// @param[in] cell_weights Weight of each cell in @p cells, e.g. the
+/// measured assembly cost of the cell. The partitioner balances the sum
+/// of the weights across the parts. If empty, all cells have unit
+/// weight.
+/// @param[in] num_ghost_layers The number of layers of ghost cells when
+/// @p ghost_mode is not none. One layer ghosts the cells that share a
+/// facet with an owned cell, which is sufficient for interior facet
+/// integrals. Each further layer adds the cells that share a facet with
+/// a ghost cell of the previous layer.
 graph::AdjacencyList<std::int32_t>
 partition_cells_graph(MPI_Comm comm, int n, int tdim,
                       const graph::AdjacencyList<std::int64_t>& cells,
                       mesh::GhostMode ghost_mode,
-                      const graph::partition_fn& partfn);
+                      const graph::partition_fn& partfn,
+                      const xtl::span<const std::int32_t>& cell_weights = {},
+                      int num_ghost_layers = 1);
+
+/// Compute quality measures of a partition of mesh cells, e.g. the
+/// destination ranks computed by mesh::partition_cells_graph or by a
+/// mesh::CellPartitionFunction, from the dual graph of the cells. This
+/// is used to compare cell partitioners before the mesh is created, see
+/// graph::compute_partition_quality for the measures.
+///
+/// @note Collective
+/// @param[in] comm MPI Communicator
+/// @param[in] n Number of partitions
+/// @param[in] tdim Topological dimension
+/// @param[in] cells Cells on this process, as for
+/// mesh::partition_cells_graph
+/// @param[in] dest Destination rank for each cell in @p cells
+/// @return Table with the quality measures
+Table compute_partition_quality(
+    MPI_Comm comm, int n, int tdim,
+    const graph::AdjacencyList<std::int64_t>& cells,
+    const graph::AdjacencyList<std::int32_t>& dest);
+
+/// Return a summary of the parallel distribution of the entities of a
+/// mesh on this rank, with one row per topology index map. The columns
+/// are the number of owned entities ("owned"), ghosts ("ghosts") and
+/// neighbour ranks ("neighbours"), the number of values sent in a
+/// forward scatter of one value per entity ("send volume") and the
+/// ratio of the number of owned entities to the mean over the ranks
+/// ("imbalance"). Use Table::reduce for the min, max or average over
+/// the ranks.
+/// @param[in] mesh The mesh
+/// @return Table with the distribution summary
+Table partition_summary(const Mesh& mesh);
+
+/// Return a summary of the memory allocated by a mesh on this rank,
+/// with one row per computed topology connectivity, for the entity
+/// permutations, per index map and for the geometry. The values are
+/// in megabytes (column "MB"). Use Table::reduce for the min, max or
+/// average over the ranks.
+/// @param[in] mesh The mesh
+/// @return Table with the memory usage
+Table memory_usage(const Mesh& mesh);
+
+/// Fetch data that is attached to the owned cells of a mesh for the
+/// cells of a redistributed mesh (see mesh::redistribute). Each rank
+/// requests the data of its cells from the ranks that owned the cells
+/// in the original mesh.
+///
+/// @note Collective over @p comm
+/// @param[in] comm The MPI communicator of the original and the
+/// redistributed meshes
+/// @param[in] cell_map The cell index map of the original mesh
+/// @param[in] data The data for each owned cell of the original mesh
+/// @param[in] cells The global index in the original mesh of each cell
+/// on this rank, e.g. the cell map returned by mesh::redistribute
+/// @return The data of each cell in @p cells
+template <typename T>
+graph::AdjacencyList<T>
+migrate_cell_data(MPI_Comm comm, const common::IndexMap& cell_map,
+                  const graph::AdjacencyList<T>& data,
+                  const xtl::span<const std::int64_t>& cells)
+{
+  const int size = dolfinx::MPI::size(comm);
+  if (data.num_nodes() != cell_map.size_local())
+    throw std::runtime_error("Cell data size mismatch");
+
+  // Ownership ranges of the cells of the original mesh
+  const std::int64_t offset = cell_map.local_range()[0];
+  std::vector<std::int64_t> ranges(size + 1, cell_map.size_global());
+  MPI_Allgather(&offset, 1, MPI_INT64_T, ranges.data(), 1, MPI_INT64_T,
+                comm);
+
+  // Request the data of each cell from its original owner
+  std::vector<int> owners(cells.size());
+  std::vector<std::vector<std::int64_t>> send_cells(size);
+  for (std::size_t i = 0; i < cells.size(); ++i)
+  {
+    auto it = std::upper_bound(ranges.begin(), ranges.end(), cells[i]);
+    owners[i] = std::distance(ranges.begin(), it) - 1;
+    assert(owners[i] >= 0 and owners[i] < size);
+    send_cells[owners[i]].push_back(cells[i]);
+  }
+  const graph::AdjacencyList<std::int64_t> recv_cells
+      = dolfinx::MPI::all_to_all(
+          comm, graph::AdjacencyList<std::int64_t>(send_cells));
+
+  // Reply with the size and the data of each requested cell
+  std::vector<std::vector<std::int32_t>> send_sizes(size);
+  std::vector<std::vector<T>> send_data(size);
+  for (int p = 0; p < size; ++p)
+  {
+    for (std::int64_t c : recv_cells.links(p))
+    {
+      auto d = data.links(c - offset);
+      send_sizes[p].push_back(d.size());
+      send_data[p].insert(send_data[p].end(), d.begin(), d.end());
+    }
+  }
+  const graph::AdjacencyList<std::int32_t> recv_sizes
+      = dolfinx::MPI::all_to_all(
+          comm, graph::AdjacencyList<std::int32_t>(send_sizes));
+  const graph::AdjacencyList<T> recv_data
+      = dolfinx::MPI::all_to_all(comm, graph::AdjacencyList<T>(send_data));
+
+  // Unpack the replies, which are in the order of the requests to each
+  // rank
+  std::vector<std::int32_t> pos_size(size, 0), pos_data(size, 0);
+  std::vector<T> cell_data;
+  std::vector<std::int32_t> offsets = {0};
+  offsets.reserve(cells.size() + 1);
+  for (std::size_t i = 0; i < cells.size(); ++i)
+  {
+    const int p = owners[i];
+    const std::int32_t n = recv_sizes.links(p)[pos_size[p]++];
+    auto d = recv_data.links(p).subspan(pos_data[p], n);
+    cell_data.insert(cell_data.end(), d.begin(), d.end());
+    pos_data[p] += n;
+    offsets.push_back(cell_data.size());
+  }
+
+  return graph::AdjacencyList<T>(std::move(cell_data), std::move(offsets));
+}
 
 } // namespace dolfinx::mesh
@@ -5,7 +5,11 @@
 // SPDX-License-Identifier:    LGPL-3.0-or-later
 
 #include "NewtonSolver.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <dolfinx/common/MPI.h>
+#include <dolfinx/common/Timer.h>
 #include <dolfinx/common/log.h>
 #include <dolfinx/la/PETScKrylovSolver.h>
 #include <dolfinx/la/PETScOptions.h>
@@ -59,6 +63,15 @@ void update_solution(const nls::NewtonSolver& solver, const Vec dx, Vec x)
   VecAXPY(x, -solver.relaxation_parameter, dx);
 }
 //-----------------------------------------------------------------------------
+// Multiplication by a shell matrix, with the action as context
+PetscErrorCode shell_mult(Mat A, Vec v, Vec y)
+{
+  void* ctx = nullptr;
+  MatShellGetContext(A, &ctx);
+  (*static_cast<std::function<void(Vec, Vec)>*>(ctx))(v, y);
+  return 0;
+}
+//-----------------------------------------------------------------------------
 } // namespace
 
 //-----------------------------------------------------------------------------
@@ -101,6 +114,7 @@ void nls::NewtonSolver::setJ(const std::function<void(const Vec, Mat)>& J,
                              Mat Jmat)
 {
   _fnJ = J;
+  _matrix_free = false;
   _matJ = Jmat;
   PetscObjectReference((PetscObject)_matJ);
 }
@@ -113,6 +127,19 @@ void nls::NewtonSolver::setP(const std::function<void(const Vec, Mat)>& P,
   PetscObjectReference((PetscObject)_matP);
 }
 //-----------------------------------------------------------------------------
+void nls::NewtonSolver::setFJ(
+    const std::function<void(const Vec, Vec, Mat)>& FJ)
+{
+  _fnFJ = FJ;
+}
+//-----------------------------------------------------------------------------
+void nls::NewtonSolver::setJ_matrix_free(
+    const std::function<void(const Vec, const Vec, Vec)>& J)
+{
+  _fnJ_action = J;
+  _matrix_free = true;
+}
+//-----------------------------------------------------------------------------
 const la::PETScKrylovSolver& nls::NewtonSolver::get_krylov_solver() const
 {
   return _solver;
@@ -155,16 +182,35 @@ std::pair<int, bool> dolfinx::nls::NewtonSolver::solve(Vec x)
                              "been provided to the NewtonSolver.");
   }
 
-  if (!_fnJ)
+  if (!_fnJ and !_matrix_free)
   {
     throw std::runtime_error("Function for computing Jacobianhas not "
                              "been provided to the NewtonSolver.");
   }
 
-  if (_system)
-    _system(x);
-  assert(_b);
-  _fnF(x, _b);
+  // Compute the residual, and the Jacobian in the same pass if the
+  // fused function is set and the Jacobian is needed at the solution
+  const bool fused = _fnFJ and !_matrix_free;
+  bool jacobian_ready = false;
+  auto compute_residual = [&](bool with_jacobian)
+  {
+    common::Timer timer("Newton: residual");
+    if (_system)
+      _system(x);
+    assert(_b);
+    if (fused and with_jacobian)
+    {
+      assert(_matJ);
+      _fnFJ(x, _b, _matJ);
+      jacobian_ready = true;
+    }
+    else
+      _fnF(x, _b);
+    return timer.stop();
+  };
+
+  _history.clear();
+  compute_residual(true);
 
   // Check convergence
   bool newton_converged = false;
@@ -182,31 +228,138 @@ std::pair<int, bool> dolfinx::nls::NewtonSolver::solve(Vec x)
                              + convergence_criterion);
   }
 
+  // Matrix-free Jacobian. The action at the latest solution is
+  // computed by the Jacobian action function, or by a finite difference
+  // of the residual, with the residual at the latest solution in _b.
+  Mat matJ = _matJ;
+  Vec x0 = nullptr, Fh = nullptr;
+  std::function<void(Vec, Vec)> action;
+  if (_matrix_free)
+  {
+    if (_fnJ_action)
+      action = [this, x](Vec v, Vec y) { _fnJ_action(x, v, y); };
+    else
+    {
+      VecDuplicate(x, &x0);
+      VecDuplicate(_b, &Fh);
+      action = [this, x, x0, Fh](Vec v, Vec y)
+      {
+        PetscReal norm_v = 0.0, norm_x = 0.0;
+        VecNorm(v, NORM_2, &norm_v);
+        if (norm_v == 0.0)
+        {
+          VecZeroEntries(y);
+          return;
+        }
+        VecNorm(x, NORM_2, &norm_x);
+        const double h
+            = std::sqrt(std::numeric_limits<double>::epsilon())
+              * (1.0 + norm_x) / norm_v;
+
+        // Residual at the perturbed solution, restoring the solution
+        // (and its ghost values) afterwards
+        VecCopy(x, x0);
+        VecAXPY(x, h, v);
+        if (_system)
+          _system(x);
+        _fnF(x, Fh);
+        VecCopy(x0, x);
+        if (_system)
+          _system(x);
+
+        VecWAXPY(y, -1.0, _b, Fh);
+        VecScale(y, 1.0 / h);
+      };
+    }
+
+    PetscInt m, n;
+    VecGetLocalSize(_b, &m);
+    VecGetSize(_b, &n);
+    MatCreateShell(_mpi_comm.comm(), m, m, n, n, &action, &matJ);
+    MatShellSetOperation(matJ, MATOP_MULT, (void (*)(void))shell_mult);
+  }
+
   // FIXME: check that this is efficient if A and/or P are unchanged
   // Set operators
   if (_matP)
-    _solver.set_operators(_matJ, _matP);
+    _solver.set_operators(matJ, _matP);
   else
-    _solver.set_operators(_matJ, _matJ);
+    _solver.set_operators(matJ, matJ);
 
   if (!_dx)
-    MatCreateVecs(_matJ, &_dx, nullptr);
+    MatCreateVecs(matJ, &_dx, nullptr);
+
+  // Norm of the residual, for the Jacobian lag and the forcing terms
+  const bool lag = jacobian_lag > 1;
+  auto norm = [](const Vec b)
+  {
+    PetscReal r = 0.0;
+    VecNorm(b, NORM_2, &r);
+    return r;
+  };
+  double norm_F = (lag or eisenstat_walker) ? norm(_b) : 0.0;
+
+  // The relative tolerance of the Krylov solver, which is restored
+  // after the solve if forcing terms are used
+  KSP ksp = _solver.ksp();
+  PetscReal ksp_rtol, ksp_atol, ksp_dtol;
+  PetscInt ksp_max_it;
+  KSPGetTolerances(ksp, &ksp_rtol, &ksp_atol, &ksp_dtol, &ksp_max_it);
+  double eta = ew_eta0;
 
   // Start iterations
+  _jacobian_evaluations = 0;
+  int num_lagged = 0;
+  bool compute_jacobian = true;
   while (!newton_converged and _iteration < max_it)
   {
-    // Compute Jacobian
-    assert(_matJ);
-    _fnJ(x, _matJ);
+    NewtonIterationRecord record;
+    record.iteration = _iteration + 1;
 
-    if (_fnP)
-      _fnP(x, _matP);
+    // Compute Jacobian. If the Jacobian is not computed, the operators
+    // are unchanged and the preconditioner is reused. A matrix-free
+    // Jacobian is evaluated at the latest solution by its action.
+    record.jacobian_computed
+        = compute_jacobian or num_lagged >= jacobian_lag;
+    if (record.jacobian_computed)
+    {
+      common::Timer timer("Newton: Jacobian");
+      if (!_matrix_free and !jacobian_ready)
+      {
+        assert(_matJ);
+        _fnJ(x, _matJ);
+      }
+      if (_fnP)
+        _fnP(x, _matP);
+      ++_jacobian_evaluations;
+      num_lagged = 0;
+      record.time_jacobian = timer.stop();
+    }
+    ++num_lagged;
+    jacobian_ready = false;
 
-    // Perform linear solve and update total number of Krylov iterations
-    _krylov_iterations += _solver.solve(_dx, _b);
+    // Set up the preconditioner, if it is rebuilt, and perform linear
+    // solve and update total number of Krylov iterations
+    if (eisenstat_walker)
+      KSPSetTolerances(ksp, eta, ksp_atol, ksp_dtol, ksp_max_it);
+    {
+      common::Timer timer("Newton: preconditioner setup");
+      _solver.set_up();
+      record.time_preconditioner = timer.stop();
+    }
+    {
+      common::Timer timer("Newton: Krylov solve");
+      record.krylov_iterations = _solver.solve(_dx, _b);
+      _krylov_iterations += record.krylov_iterations;
+      record.time_krylov = timer.stop();
+    }
 
     // Update solution
-    this->_update_solution(*this, _dx, x);
+    {
+      common::Timer timer("Newton: update");
+      this->_update_solution(*this, _dx, x);
+      record.time_update = timer.stop();
+    }
 
     // Increment iteration count
     ++_iteration;
@@ -214,10 +367,9 @@ std::pair<int, bool> dolfinx::nls::NewtonSolver::solve(Vec x)
     // FIXME: This step is not needed if residual is based on dx and
     //        this has converged.
     // FIXME: But, this function call may update internal variables, etc.
-    // Compute F
-    if (_system)
-      _system(x);
-    _fnF(x, _b);
+    // Compute F, with the Jacobian if it is needed at the next
+    // iteration because of the Jacobian lag
+    record.time_residual = compute_residual(num_lagged >= jacobian_lag);
     // Initialize _residual0
     if (_iteration == 1)
     {
@@ -226,6 +378,26 @@ std::pair<int, bool> dolfinx::nls::NewtonSolver::solve(Vec x)
       _residual0 = _r;
     }
 
+    // Compute the Jacobian at the next iteration if the residual is
+    // not reduced enough, and the next forcing term
+    compute_jacobian = !lag;
+    if (lag or eisenstat_walker)
+    {
+      const double norm_F_old = norm_F;
+      norm_F = norm(_b);
+      const double ratio = norm_F_old > 0.0 ? norm_F / norm_F_old : 0.0;
+      compute_jacobian = compute_jacobian or ratio > jacobian_lag_rate;
+      if (eisenstat_walker)
+      {
+        // Safeguard against forcing terms that decrease too fast
+        const double eta_min = ew_gamma * std::pow(eta, ew_alpha);
+        eta = ew_gamma * std::pow(ratio, ew_alpha);
+        if (eta_min > 0.1)
+          eta = std::max(eta, eta_min);
+        eta = std::min(eta, ew_eta_max);
+      }
+    }
+
     // Test for convergence
     if (convergence_criterion == "residual")
       std::tie(_residual, newton_converged) = this->_converged(*this, _b);
@@ -243,6 +415,35 @@ std::pair<int, bool> dolfinx::nls::NewtonSolver::solve(Vec x)
     }
     else
       throw std::runtime_error("Unknown convergence criterion string.");
+
+    record.residual = _residual;
+    _history.push_back(record);
+    if (report and dolfinx::MPI::rank(_mpi_comm.comm()) == 0)
+    {
+      LOG(INFO) << "Newton iteration " << record.iteration
+                << ": Krylov iterations = " << record.krylov_iterations
+                << ", time (residual, Jacobian, preconditioner, Krylov, "
+                   "update) = ("
+                << record.time_residual << ", " << record.time_jacobian
+                << ", " << record.time_preconditioner << ", "
+                << record.time_krylov << ", " << record.time_update << ")";
+    }
+  }
+
+  if (eisenstat_walker)
+    KSPSetTolerances(ksp, ksp_rtol, ksp_atol, ksp_dtol, ksp_max_it);
+
+  if (_matrix_free)
+  {
+    // Restore the assembled operators, if any, so that the Krylov
+    // solver does not refer to the shell matrix
+    if (_matJ)
+      _solver.set_operators(_matJ, _matP ? _matP : _matJ);
+    MatDestroy(&matJ);
+    if (x0)
+      VecDestroy(&x0);
+    if (Fh)
+      VecDestroy(&Fh);
   }
 
   if (newton_converged)
@@ -281,5 +482,16 @@ double nls::NewtonSolver::residual() const { return _residual; }
 //-----------------------------------------------------------------------------
 double nls::NewtonSolver::residual0() const { return _residual0; }
 //-----------------------------------------------------------------------------
+const std::vector<nls::NewtonIterationRecord>&
+nls::NewtonSolver::history() const
+{
+  return _history;
+}
+//-----------------------------------------------------------------------------
+int nls::NewtonSolver::jacobian_evaluations() const
+{
+  return _jacobian_evaluations;
+}
+//-----------------------------------------------------------------------------
 MPI_Comm nls::NewtonSolver::mpi_comm() const { return _mpi_comm.comm(); }
 //-----------------------------------------------------------------------------
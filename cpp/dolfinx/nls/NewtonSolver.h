@@ -13,6 +13,7 @@
 #include <petscmat.h>
 #include <petscvec.h>
 #include <utility>
+#include <vector>
 
 namespace dolfinx
 {
@@ -25,6 +26,39 @@ class PETScKrylovSolver;
 namespace nls
 {
 
+/// Telemetry of an iteration of NewtonSolver. The times are wall times
+/// in seconds on the calling process, and are also recorded in the
+/// timing table under 'Newton: ...'.
+struct NewtonIterationRecord
+{
+  /// Iteration number (starting from 1)
+  int iteration = 0;
+
+  /// Residual of the convergence check after the iteration
+  double residual = 0.0;
+
+  /// Number of Krylov iterations
+  int krylov_iterations = 0;
+
+  /// True if the Jacobian (and the preconditioner matrix) was computed
+  bool jacobian_computed = false;
+
+  /// Time of the residual computation after the update
+  double time_residual = 0.0;
+
+  /// Time of the Jacobian and preconditioner matrix computation
+  double time_jacobian = 0.0;
+
+  /// Time of the preconditioner setup
+  double time_preconditioner = 0.0;
+
+  /// Time of the Krylov solve
+  double time_krylov = 0.0;
+
+  /// Time of the update of the solution
+  double time_update = 0.0;
+};
+
 /// This class defines a Newton solver for nonlinear systems of
 /// equations of the form \f$F(x) = 0\f$.
 
@@ -62,6 +96,31 @@ public:
   /// @param[in] Jmat The matrix to assemble the Jacobian into
   void setJ(const std::function<void(const Vec, Mat)>& J, Mat Jmat);
 
+  /// Set the function for computing the residual and the Jacobian in
+  /// one pass, e.g. by fem::assemble_fused (optional). It is used
+  /// instead of the residual function when the Jacobian is known to be
+  /// needed at the same solution: at the start of the solve and after
+  /// an update when the Jacobian lag is reached. The Jacobian is then
+  /// also computed after the final update. The functions and the
+  /// vector and matrix of NewtonSolver::setF and NewtonSolver::setJ
+  /// must be set, and are used otherwise.
+  /// @param[in] FJ Function to compute the residual vector b and the
+  /// Jacobian matrix A (x, b, A)
+  void setFJ(const std::function<void(const Vec, Vec, Mat)>& FJ);
+
+  /// Use a matrix-free Jacobian (Jacobian-free Newton-Krylov). The
+  /// Jacobian matrix is not assembled, and the Krylov solver applies
+  /// its action at the latest solution. A preconditioner matrix can be
+  /// set with NewtonSolver::setP, otherwise the Krylov solver must use a
+  /// preconditioner that does not need the matrix entries, e.g.
+  /// 'none'. The setting replaces NewtonSolver::setJ.
+  /// @param[in] J Function to compute the action y = J(x) v of the
+  /// Jacobian (x, v, y). If empty, the action is approximated by the
+  /// finite difference (F(x + h v) - F(x)) / h of the residual, with a
+  /// step h scaled by the norms of x and v.
+  void setJ_matrix_free(
+      const std::function<void(const Vec, const Vec, Vec)>& J = nullptr);
+
   /// Set the function for computing the preconditioner matrix (optional)
   /// @param[in] P Function to compute the preconditioner matrix b (x, P)
   /// @param[in] Pmat The matrix to assemble the preconditioner into
@@ -123,6 +182,14 @@ public:
   /// @return Initial residual
   double residual0() const;
 
+  /// Return the telemetry of the iterations of the last solve
+  /// @return One record per Newton iteration
+  const std::vector<NewtonIterationRecord>& history() const;
+
+  /// Return number of Jacobian evaluations since solve started
+  /// @return Number of Jacobian evaluations
+  int jacobian_evaluations() const;
+
   /// Return MPI communicator
   MPI_Comm mpi_comm() const;
 
@@ -148,6 +215,37 @@ public:
   /// Relaxation parameter
   double relaxation_parameter = 1.0;
 
+  /// Maximum number of Newton iterations with the same Jacobian (and
+  /// preconditioner). The Jacobian is computed at the first iteration
+  /// and when this number is reached or the convergence rate degrades,
+  /// see NewtonSolver::jacobian_lag_rate. If 1, the Jacobian is
+  /// computed at each iteration.
+  int jacobian_lag = 1;
+
+  /// Compute the Jacobian at the next iteration if the norm of the
+  /// residual is reduced by less than this factor in an iteration, i.e.
+  /// if |F(x_k)| > jacobian_lag_rate |F(x_{k-1})|
+  double jacobian_lag_rate = 0.5;
+
+  /// Inexact Newton: set the relative tolerance of the Krylov solver at
+  /// each iteration to the Eisenstat-Walker forcing term (choice 2),
+  /// \f$\eta_k = \gamma (|F(x_k)| / |F(x_{k-1})|)^\alpha\f$, with
+  /// safeguards. The relative tolerance of the Krylov solver is restored
+  /// after the solve.
+  bool eisenstat_walker = false;
+
+  /// Initial Eisenstat-Walker forcing term
+  double ew_eta0 = 0.5;
+
+  /// Maximum Eisenstat-Walker forcing term
+  double ew_eta_max = 0.9;
+
+  /// Eisenstat-Walker parameter gamma
+  double ew_gamma = 0.9;
+
+  /// Eisenstat-Walker parameter alpha
+  double ew_alpha = 1.618033988749895;
+
 private:
   // Function for computing the residual vector. The first argument is
   // the latest solution vector x and the second argument is the
@@ -159,6 +257,15 @@ private:
   // the matrix operator.
   std::function<void(const Vec x, Mat J)> _fnJ;
 
+  // Function for computing the residual vector and the Jacobian matrix
+  // in one pass
+  std::function<void(const Vec x, Vec b, Mat J)> _fnFJ;
+
+  // Function for computing the action of the Jacobian for a
+  // matrix-free Jacobian, and true if the Jacobian is matrix-free
+  std::function<void(const Vec x, const Vec v, Vec y)> _fnJ_action;
+  bool _matrix_free = false;
+
   // Function for computing the preconditioner matrix operator. The
   // first argument is the latest solution vector x and the second
   // argument is the matrix operator.
@@ -189,6 +296,12 @@ private:
   // Number of iterations
   int _iteration;
 
+  // Number of Jacobian evaluations since solve began
+  int _jacobian_evaluations = 0;
+
+  // Telemetry of the iterations since solve began
+  std::vector<NewtonIterationRecord> _history;
+
   // Most recent residual and initial residual
   double _residual, _residual0;
 
@@ -0,0 +1,330 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "MeshHierarchy.h"
+#include "plaza.h"
+#include "utils.h"
+#include <algorithm>
+#include <dolfinx/common/MPI.h>
+#include <dolfinx/mesh/cell_types.h>
+#include <dolfinx/mesh/utils.h>
+#include <iterator>
+#include <mpi.h>
+#include <numeric>
+#include <xtensor/xview.hpp>
+
+using namespace dolfinx;
+using namespace dolfinx::refinement;
+
+namespace
+{
+//-----------------------------------------------------------------------------
+// Find the vertex of mesh0 at each vertex of mesh1, where the two meshes
+// are refinements of the same coarse mesh and the vertices of mesh1 are
+// a subset of the vertices of mesh0. parents0 and parents1 are the
+// parent cells (on the coarse mesh) of the cells of the two meshes. The
+// vertices of a cell of mesh1 are searched for among the vertices of
+// the cells of mesh0 with the same parent. They are at exactly the same
+// points, as the new vertices are computed in the same way.
+std::vector<std::int32_t>
+map_vertices(const mesh::Mesh& mesh0, const std::vector<std::int32_t>& parents0,
+             const mesh::Mesh& mesh1, const std::vector<std::int32_t>& parents1,
+             std::int32_t num_parents)
+{
+  // Children of each parent cell in mesh0
+  std::vector<std::int32_t> offsets(num_parents + 1, 0);
+  for (std::int32_t p : parents0)
+    ++offsets[p + 1];
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+  std::vector<std::int32_t> children(parents0.size());
+  {
+    std::vector<std::int32_t> pos(offsets.begin(), std::prev(offsets.end()));
+    for (std::size_t c = 0; c < parents0.size(); ++c)
+      children[pos[parents0[c]]++] = c;
+  }
+
+  // The geometry node of vertex i of a cell is node i of the cell
+  const int tdim = mesh1.topology().dim();
+  const xt::xtensor<double, 2>& x0 = mesh0.geometry().x();
+  const xt::xtensor<double, 2>& x1 = mesh1.geometry().x();
+  const graph::AdjacencyList<std::int32_t>& x_dofmap0
+      = mesh0.geometry().dofmap();
+  const graph::AdjacencyList<std::int32_t>& x_dofmap1
+      = mesh1.geometry().dofmap();
+  auto c_to_v0 = mesh0.topology().connectivity(tdim, 0);
+  assert(c_to_v0);
+  auto c_to_v1 = mesh1.topology().connectivity(tdim, 0);
+  assert(c_to_v1);
+
+  auto map_v = mesh1.topology().index_map(0);
+  assert(map_v);
+  std::vector<std::int32_t> vertex_map(
+      map_v->size_local() + map_v->num_ghosts(), -1);
+  for (std::size_t c = 0; c < parents1.size(); ++c)
+  {
+    auto vertices = c_to_v1->links(c);
+    auto nodes = x_dofmap1.links(c);
+    const std::int32_t p = parents1[c];
+    for (std::size_t i = 0; i < vertices.size(); ++i)
+    {
+      if (vertex_map[vertices[i]] >= 0)
+        continue;
+      auto x = xt::row(x1, nodes[i]);
+      for (std::int32_t j = offsets[p]; j < offsets[p + 1]; ++j)
+      {
+        auto vertices0 = c_to_v0->links(children[j]);
+        auto nodes0 = x_dofmap0.links(children[j]);
+        for (std::size_t k = 0; k < vertices0.size(); ++k)
+        {
+          if (xt::row(x0, nodes0[k]) == x)
+          {
+            vertex_map[vertices[i]] = vertices0[k];
+            break;
+          }
+        }
+      }
+
+      if (vertex_map[vertices[i]] < 0)
+        throw std::runtime_error("Vertex of coarsened mesh not found.");
+    }
+  }
+
+  return vertex_map;
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
+//-----------------------------------------------------------------------------
+MeshHierarchy::MeshHierarchy(std::shared_ptr<const mesh::Mesh> mesh)
+    : _meshes({mesh})
+{
+  assert(mesh);
+  if (mesh->topology().cell_type() != mesh::CellType::triangle
+      and mesh->topology().cell_type() != mesh::CellType::tetrahedron)
+  {
+    throw std::runtime_error("Refinement only defined for simplices");
+  }
+
+  // The parent maps are local, so the cells must not be ghosted
+  const int tdim = mesh->topology().dim();
+  int num_ghosts = mesh->topology().index_map(tdim)->num_ghosts();
+  MPI_Allreduce(MPI_IN_PLACE, &num_ghosts, 1, MPI_INT, MPI_MAX,
+                mesh->mpi_comm());
+  if (num_ghosts > 0)
+    throw std::runtime_error("MeshHierarchy requires a mesh without ghosts");
+}
+//-----------------------------------------------------------------------------
+void MeshHierarchy::refine(int num_threads)
+{
+  const mesh::Mesh& mesh = *_meshes.back();
+  mesh.topology_mutable().create_entities(1, num_threads);
+  auto [cells, x, parent_cell, parent_facet]
+      = plaza::compute_refinement_data(mesh, num_threads);
+  add_level(cells, x, std::move(parent_cell), parent_facet, num_threads);
+}
+//-----------------------------------------------------------------------------
+void MeshHierarchy::refine(const mesh::MeshTags<std::int8_t>& refinement_marker,
+                           int num_threads)
+{
+  if (refinement_marker.mesh() != _meshes.back())
+    throw std::runtime_error("MeshTags are not on the finest level");
+
+  const mesh::Mesh& mesh = *_meshes.back();
+  mesh.topology_mutable().create_entities(1, num_threads);
+  auto [cells, x, parent_cell, parent_facet]
+      = plaza::compute_refinement_data(mesh, refinement_marker, num_threads);
+  add_level(cells, x, std::move(parent_cell), parent_facet, num_threads);
+}
+//-----------------------------------------------------------------------------
+std::vector<std::int32_t>
+MeshHierarchy::coarsen(const mesh::MeshTags<std::int8_t>& marker,
+                       int num_threads)
+{
+  if (num_levels() < 2)
+    throw std::runtime_error("Cannot coarsen the coarsest level");
+  if (marker.mesh() != _meshes.back())
+    throw std::runtime_error("MeshTags are not on the finest level");
+  std::shared_ptr<const mesh::Mesh> coarse = _meshes[num_levels() - 2];
+  const int tdim = coarse->topology().dim();
+  if (marker.dim() != tdim)
+    throw std::runtime_error("Coarsening markers must be on cells");
+
+  // A parent cell stays refined if any of its children is not marked
+  const std::vector<std::int32_t>& parents = _parent_cells.back();
+  std::vector<std::int8_t> marked(parents.size(), false);
+  for (std::int32_t c : marker.indices())
+    marked[c] = true;
+  const std::int32_t num_parents
+      = coarse->topology().index_map(tdim)->size_local();
+  std::vector<std::int8_t> refined(num_parents, false);
+  std::vector<std::int32_t> num_children(num_parents, 0);
+  for (std::size_t c = 0; c < parents.size(); ++c)
+  {
+    refined[parents[c]] = refined[parents[c]] or !marked[c];
+    ++num_children[parents[c]];
+  }
+
+  // The edges that were split in the cells that stay refined are split
+  // again, which reproduces their children. They are the edges with a
+  // midpoint that is a vertex of a child, and the midpoints are
+  // computed exactly as in the refinement.
+  auto c_to_e = coarse->topology().connectivity(tdim, 1);
+  assert(c_to_e);
+  std::vector<std::int32_t> cells, edges;
+  for (std::int32_t p = 0; p < num_parents; ++p)
+  {
+    if (refined[p] and num_children[p] > 1)
+    {
+      cells.push_back(p);
+      auto cell_edges = c_to_e->links(p);
+      edges.insert(edges.end(), cell_edges.begin(), cell_edges.end());
+    }
+  }
+  const xt::xtensor<double, 2> midpoints
+      = mesh::midpoints(*coarse, 1, edges);
+  std::vector<std::int32_t> split_edges;
+  {
+    std::vector<std::int32_t> offsets(num_parents + 1, 0);
+    for (std::int32_t p : parents)
+      ++offsets[p + 1];
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    std::vector<std::int32_t> children(parents.size());
+    std::vector<std::int32_t> pos(offsets.begin(), std::prev(offsets.end()));
+    for (std::size_t c = 0; c < parents.size(); ++c)
+      children[pos[parents[c]]++] = c;
+
+    const mesh::Mesh& fine = *_meshes.back();
+    const xt::xtensor<double, 2>& x = fine.geometry().x();
+    const graph::AdjacencyList<std::int32_t>& x_dofmap
+        = fine.geometry().dofmap();
+    const std::size_t num_cell_edges = c_to_e->num_links(0);
+    for (std::size_t i = 0; i < cells.size(); ++i)
+    {
+      const std::int32_t p = cells[i];
+      for (std::size_t e = 0; e < num_cell_edges; ++e)
+      {
+        auto m = xt::row(midpoints, i * num_cell_edges + e);
+        bool found = false;
+        for (std::int32_t j = offsets[p]; j < offsets[p + 1] and !found; ++j)
+        {
+          for (std::int32_t node : x_dofmap.links(children[j]))
+            found = found or xt::row(x, node) == m;
+        }
+        if (found)
+          split_edges.push_back(edges[i * num_cell_edges + e]);
+      }
+    }
+  }
+  std::sort(split_edges.begin(), split_edges.end());
+  split_edges.erase(std::unique(split_edges.begin(), split_edges.end()),
+                    split_edges.end());
+
+  // Remove the finest level
+  std::shared_ptr<const mesh::Mesh> mesh0 = _meshes.back();
+  std::vector<std::int32_t> parents0 = std::move(_parent_cells.back());
+  _meshes.pop_back();
+  _parent_cells.pop_back();
+  _parent_facets.pop_back();
+
+  // Refine again. If no edges are split, the next coarser level is the
+  // finest level and is its own parent.
+  std::int32_t num_split = split_edges.size();
+  MPI_Allreduce(MPI_IN_PLACE, &num_split, 1, MPI_INT32_T, MPI_SUM,
+                coarse->mpi_comm());
+  std::vector<std::int32_t> parents1;
+  if (num_split > 0)
+  {
+    coarse->topology_mutable().create_connectivity(1, 1);
+    std::vector<std::int8_t> values(split_edges.size(), 1);
+    refine(mesh::MeshTags<std::int8_t>(coarse, 1, std::move(split_edges),
+                                       std::move(values)),
+           num_threads);
+    parents1 = _parent_cells.back();
+  }
+  else
+  {
+    parents1.resize(num_parents);
+    std::iota(parents1.begin(), parents1.end(), 0);
+  }
+
+  return map_vertices(*mesh0, parents0, *_meshes.back(), parents1,
+                      num_parents);
+}
+//-----------------------------------------------------------------------------
+int MeshHierarchy::num_levels() const { return _meshes.size(); }
+//-----------------------------------------------------------------------------
+std::shared_ptr<const mesh::Mesh> MeshHierarchy::mesh(int level) const
+{
+  return _meshes.at(level);
+}
+//-----------------------------------------------------------------------------
+const std::vector<std::int32_t>& MeshHierarchy::parent_cells(int level) const
+{
+  if (level < 1 or level >= num_levels())
+    throw std::runtime_error("Invalid level for parent cells");
+  return _parent_cells[level - 1];
+}
+//-----------------------------------------------------------------------------
+const std::vector<std::int32_t>& MeshHierarchy::parent_facets(int level) const
+{
+  if (level < 1 or level >= num_levels())
+    throw std::runtime_error("Invalid level for parent facets");
+  return _parent_facets[level - 1];
+}
+//-----------------------------------------------------------------------------
+void MeshHierarchy::add_level(const graph::AdjacencyList<std::int64_t>& cells,
+                              const xt::xtensor<double, 2>& x,
+                              std::vector<std::int32_t>&& parent_cell,
+                              const std::vector<std::int8_t>& parent_facet,
+                              int num_threads)
+{
+  // The cells of the new level are in the order of the refinement
+  // data, so parent_cell is the parent map of the cells
+  const mesh::Mesh& coarse = *_meshes.back();
+  auto fine = std::make_shared<mesh::Mesh>(
+      refinement::create_mesh_from_parent(coarse, cells, x));
+
+  // Facet k of a cell is opposite its vertex k, for both the refinement
+  // data and the cell-facet connectivity
+  const int tdim = coarse.topology().dim();
+  coarse.topology_mutable().create_entities(tdim - 1, num_threads);
+  coarse.topology_mutable().create_connectivity(tdim, tdim - 1, num_threads);
+  fine->topology_mutable().create_entities(tdim - 1, num_threads);
+  fine->topology_mutable().create_connectivity(tdim, tdim - 1, num_threads);
+  auto c_to_f0 = coarse.topology().connectivity(tdim, tdim - 1);
+  assert(c_to_f0);
+  auto c_to_f1 = fine->topology().connectivity(tdim, tdim - 1);
+  assert(c_to_f1);
+
+  auto map_f = fine->topology().index_map(tdim - 1);
+  assert(map_f);
+  std::vector<std::int32_t> parent_facets(
+      map_f->size_local() + map_f->num_ghosts(), -1);
+  for (std::size_t c = 0; c < parent_cell.size(); ++c)
+  {
+    auto facets = c_to_f1->links(c);
+    auto facets0 = c_to_f0->links(parent_cell[c]);
+    for (std::size_t k = 0; k < facets.size(); ++k)
+    {
+      if (const int pf = parent_facet[c * facets.size() + k]; pf >= 0)
+        parent_facets[facets[k]] = facets0[pf];
+    }
+  }
+
+  _meshes.push_back(fine);
+  _parent_cells.push_back(std::move(parent_cell));
+  _parent_facets.push_back(std::move(parent_facets));
+}
+//-----------------------------------------------------------------------------
+int MeshHierarchy::find_level(const mesh::Mesh& mesh) const
+{
+  auto it = std::find_if(_meshes.begin(), _meshes.end(),
+                         [&mesh](auto& m) { return m.get() == &mesh; });
+  if (it == _meshes.end())
+    throw std::runtime_error("Mesh is not a level of the MeshHierarchy");
+  return std::distance(_meshes.begin(), it);
+}
+//-----------------------------------------------------------------------------
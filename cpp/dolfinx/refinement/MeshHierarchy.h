@@ -0,0 +1,253 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/fem/DofMap.h>
+#include <dolfinx/fem/ElementDofLayout.h>
+#include <dolfinx/fem/Function.h>
+#include <dolfinx/fem/FunctionSpace.h>
+#include <dolfinx/graph/AdjacencyList.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <dolfinx/mesh/MeshTags.h>
+#include <dolfinx/mesh/Topology.h>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include <xtensor/xtensor.hpp>
+#include <xtl/xspan.hpp>
+
+namespace dolfinx::refinement
+{
+
+/// A hierarchy of meshes that are created by successive refinement of
+/// a coarse mesh, e.g. for geometric multigrid.
+///
+/// Level 0 is the coarse mesh, and level l + 1 is a refinement of level
+/// l. The levels are not redistributed, so the cells of a level are on
+/// the process of their parent cell, and each level keeps the parent
+/// of its cells and facets on the next coarser level in local indices.
+/// The parent maps are known from the refinement, and no geometric
+/// search is needed to transfer data between levels.
+class MeshHierarchy
+{
+public:
+  /// Create a hierarchy with one level
+  /// @note Collective
+  /// @param[in] mesh The coarse mesh (simplex cells), which must not
+  /// have ghost cells
+  explicit MeshHierarchy(std::shared_ptr<const mesh::Mesh> mesh);
+
+  /// Copy constructor
+  MeshHierarchy(const MeshHierarchy& hierarchy) = default;
+
+  /// Move constructor
+  MeshHierarchy(MeshHierarchy&& hierarchy) = default;
+
+  /// Destructor
+  ~MeshHierarchy() = default;
+
+  /// Copy assignment
+  MeshHierarchy& operator=(const MeshHierarchy& hierarchy) = default;
+
+  /// Move assignment
+  MeshHierarchy& operator=(MeshHierarchy&& hierarchy) = default;
+
+  /// Add a level by uniform refinement of the finest level
+  /// @note Collective
+  /// @param[in] num_threads The number of threads used to refine
+  void refine(int num_threads = 1);
+
+  /// Add a level by refinement of the finest level with markers
+  /// @note Collective
+  /// @param[in] refinement_marker MeshTags on the finest level listing
+  /// the mesh entities that should be split. The values are ignored.
+  /// @param[in] num_threads The number of threads used to refine
+  void refine(const mesh::MeshTags<std::int8_t>& refinement_marker,
+              int num_threads = 1);
+
+  /// Coarsen the finest level by merging the children of a cell of the
+  /// next coarser level when all of them are marked. This undoes the
+  /// refinement of these cells: the finest level is replaced by a
+  /// refinement of the next coarser level that splits the edges that
+  /// were split in the cells that are not merged (with the propagation
+  /// of the refinement markers, so that the mesh is conforming), or is
+  /// removed if all cells are merged.
+  /// @note Collective
+  /// @param[in] marker MeshTags on the cells of the finest level
+  /// listing the cells to coarsen. The values are ignored.
+  /// @param[in] num_threads The number of threads used to refine
+  /// @return For each vertex (owned and ghost) of the new finest level,
+  /// the local index of the vertex at the same point of the replaced
+  /// finest level. It can be used to transfer data, see
+  /// refinement::transfer.
+  std::vector<std::int32_t>
+  coarsen(const mesh::MeshTags<std::int8_t>& marker, int num_threads = 1);
+
+  /// Number of levels
+  int num_levels() const;
+
+  /// Get the mesh of a level
+  /// @param[in] level The level
+  /// @return The mesh
+  std::shared_ptr<const mesh::Mesh> mesh(int level) const;
+
+  /// Get the parent cells of a level
+  /// @param[in] level The level (> 0)
+  /// @return The local index of the parent cell on level - 1 of each
+  /// cell of the level
+  const std::vector<std::int32_t>& parent_cells(int level) const;
+
+  /// Get the parent facets of a level
+  /// @param[in] level The level (> 0)
+  /// @return The local index of the facet on level - 1 that contains
+  /// each facet (owned and ghost) of the level, or -1 if the facet is
+  /// in the interior of its parent cell
+  const std::vector<std::int32_t>& parent_facets(int level) const;
+
+  /// Transfer MeshTags on the cells or facets of a level to the next
+  /// finer level. The children of a tagged entity get its value.
+  /// Facets in the interior of a parent cell are not tagged.
+  /// @param[in] tags MeshTags on the mesh of a level that is not the
+  /// finest level
+  /// @return MeshTags on the mesh of the next finer level
+  template <typename T>
+  mesh::MeshTags<T> transfer(const mesh::MeshTags<T>& tags) const
+  {
+    const int level = find_level(*tags.mesh());
+    if (level + 1 == num_levels())
+      throw std::runtime_error("Cannot transfer MeshTags from finest level.");
+    const int tdim = tags.mesh()->topology().dim();
+    if (tags.dim() != tdim and tags.dim() != tdim - 1)
+    {
+      throw std::runtime_error(
+          "MeshTags can be transferred on cells and facets only.");
+    }
+
+    // Position of the tag of each entity, -1 if the entity is not
+    // tagged
+    auto map = tags.mesh()->topology().index_map(tags.dim());
+    assert(map);
+    std::vector<std::int32_t> pos(map->size_local() + map->num_ghosts(), -1);
+    const std::vector<std::int32_t>& indices = tags.indices();
+    for (std::size_t i = 0; i < indices.size(); ++i)
+      pos[indices[i]] = i;
+
+    // The children are visited in order, so the indices are sorted
+    const std::vector<std::int32_t>& parents
+        = tags.dim() == tdim ? parent_cells(level + 1)
+                             : parent_facets(level + 1);
+    std::vector<std::int32_t> child_indices;
+    std::vector<T> child_values;
+    for (std::size_t i = 0; i < parents.size(); ++i)
+    {
+      if (parents[i] >= 0 and pos[parents[i]] >= 0)
+      {
+        child_indices.push_back(i);
+        child_values.push_back(tags.values()[pos[parents[i]]]);
+      }
+    }
+
+    mesh::MeshTags<T> child_tags(_meshes[level + 1], tags.dim(),
+                                 std::move(child_indices),
+                                 std::move(child_values));
+    child_tags.name = tags.name;
+    return child_tags;
+  }
+
+private:
+  // Add the level created from the data of plaza refinement of the
+  // finest level
+  void add_level(const graph::AdjacencyList<std::int64_t>& cells,
+                 const xt::xtensor<double, 2>& x,
+                 std::vector<std::int32_t>&& parent_cell,
+                 const std::vector<std::int8_t>& parent_facet,
+                 int num_threads);
+
+  // Get the level of a mesh
+  int find_level(const mesh::Mesh& mesh) const;
+
+  // The meshes of the levels
+  std::vector<std::shared_ptr<const mesh::Mesh>> _meshes;
+
+  // Parent cells and facets of the levels > 0 (entry l - 1 is level l)
+  std::vector<std::vector<std::int32_t>> _parent_cells, _parent_facets;
+};
+
+/// Transfer a Function with degrees-of-freedom at the vertices only
+/// (e.g. degree 1 Lagrange) to a Function on another mesh, using a map
+/// from the vertices of the other mesh to the vertices at the same
+/// points, as returned by MeshHierarchy::coarsen.
+/// @param[in] u0 The Function to transfer
+/// @param[out] u1 The Function on the other mesh. All values (owned and
+/// ghost) are set.
+/// @param[in] vertex_map The vertex of the mesh of u0 at each vertex
+/// of the mesh of u1
+template <typename T>
+void transfer(const fem::Function<T>& u0, fem::Function<T>& u1,
+              const xtl::span<const std::int32_t>& vertex_map)
+{
+  // Get the block degree-of-freedom at each vertex
+  auto vertex_dofs = [](const fem::FunctionSpace& V)
+  {
+    std::shared_ptr<const mesh::Mesh> mesh = V.mesh();
+    assert(mesh);
+    std::shared_ptr<const fem::DofMap> dofmap = V.dofmap();
+    assert(dofmap);
+    const fem::ElementDofLayout& layout = *dofmap->element_dof_layout;
+    const int tdim = mesh->topology().dim();
+    auto c_to_v = mesh->topology().connectivity(tdim, 0);
+    assert(c_to_v);
+    if (dofmap->bs() != dofmap->index_map_bs()
+        or layout.num_entity_dofs(0) != 1
+        or layout.num_dofs() != c_to_v->num_links(0))
+    {
+      throw std::runtime_error(
+          "Function space does not have dofs at vertices only.");
+    }
+
+    auto map_v = mesh->topology().index_map(0);
+    assert(map_v);
+    std::vector<std::int32_t> dofs(map_v->size_local() + map_v->num_ghosts(),
+                                   -1);
+    for (std::int32_t c = 0; c < c_to_v->num_nodes(); ++c)
+    {
+      auto vertices = c_to_v->links(c);
+      auto cell_dofs = dofmap->cell_dofs(c);
+      for (std::size_t i = 0; i < vertices.size(); ++i)
+        dofs[vertices[i]] = cell_dofs[layout.entity_dofs(0, i).front()];
+    }
+    return dofs;
+  };
+
+  assert(u0.function_space());
+  assert(u1.function_space());
+  const std::vector<std::int32_t> dofs0 = vertex_dofs(*u0.function_space());
+  const std::vector<std::int32_t> dofs1 = vertex_dofs(*u1.function_space());
+  if (vertex_map.size() != dofs1.size())
+    throw std::runtime_error("Vertex map does not match the mesh.");
+  const int bs = u0.function_space()->dofmap()->bs();
+  if (u1.function_space()->dofmap()->bs() != bs)
+    throw std::runtime_error("Function block sizes do not match.");
+
+  const std::vector<T>& x0 = u0.x()->array();
+  std::vector<T>& x1 = u1.x()->mutable_array();
+  for (std::size_t v = 0; v < dofs1.size(); ++v)
+  {
+    assert(vertex_map[v] >= 0);
+    if (dofs1[v] < 0)
+      continue;
+    const std::int32_t dof0 = dofs0[vertex_map[v]];
+    assert(dof0 >= 0);
+    for (int k = 0; k < bs; ++k)
+      x1[bs * dofs1[v] + k] = x0[bs * dof0 + k];
+  }
+}
+
+} // namespace dolfinx::refinement
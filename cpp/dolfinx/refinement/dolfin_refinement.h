@@ -12,4 +12,6 @@ namespace dolfinx
 
 // DOLFINx refinement interface
 
+#include <dolfinx/refinement/MeshHierarchy.h>
+#include <dolfinx/refinement/marking.h>
 #include <dolfinx/refinement/refine.h>
@@ -0,0 +1,172 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "marking.h"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/utils.h>
+#include <dolfinx/graph/AdjacencyList.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <dolfinx/mesh/Topology.h>
+#include <limits>
+#include <stdexcept>
+
+using namespace dolfinx;
+
+namespace
+{
+// Number of bins of the histograms, and maximum number of refinements
+// of the histogram
+constexpr int num_bins = 64;
+constexpr int max_steps = 32;
+
+// Range of a histogram. Bin b is [edge(b), edge(b + 1)), and the last
+// bin contains hi if the range is closed.
+struct Range
+{
+  double lo, hi;
+  bool closed;
+
+  double edge(int b) const
+  {
+    return b == num_bins ? hi : lo + b * ((hi - lo) / num_bins);
+  }
+
+  // Get the bin of a value, or -1 if the value is not in the range
+  int bin(double v) const
+  {
+    if (v < lo or v > hi or (v == hi and !closed))
+      return -1;
+    int b = std::clamp<int>((v - lo) / ((hi - lo) / num_bins), 0,
+                            num_bins - 1);
+    while (b > 0 and v < edge(b))
+      --b;
+    while (b < num_bins - 1 and v >= edge(b + 1))
+      ++b;
+    return b;
+  }
+};
+} // namespace
+
+//-----------------------------------------------------------------------------
+std::vector<std::int32_t>
+refinement::select_doerfler(MPI_Comm comm, const xtl::span<const double>& eta,
+                            double theta, int num_threads)
+{
+  if (theta <= 0.0 or theta > 1.0)
+    throw std::runtime_error("Dörfler fraction must be in (0, 1]");
+
+  // Global range and sum of the values
+  std::array<double, 2> range = {std::numeric_limits<double>::max(),
+                                 std::numeric_limits<double>::lowest()};
+  double total = 0.0;
+  for (double v : eta)
+  {
+    if (v < 0.0)
+      throw std::runtime_error("Dörfler marking values must be non-negative");
+    range[0] = std::min(range[0], v);
+    range[1] = std::max(range[1], v);
+    total += v;
+  }
+  range[0] = -range[0];
+  MPI_Allreduce(MPI_IN_PLACE, range.data(), 2, MPI_DOUBLE, MPI_MAX, comm);
+  MPI_Allreduce(MPI_IN_PLACE, &total, 1, MPI_DOUBLE, MPI_SUM, comm);
+  if (total <= 0.0)
+    return {};
+
+  // Refine the histogram of the bin that contains the threshold, with
+  // the sum of the values above the range
+  const double target = theta * total;
+  Range r = {-range[0], range[1], true};
+  double above = 0.0;
+  double threshold = r.lo;
+  for (int step = 0; step < max_steps and r.lo < r.hi; ++step)
+  {
+    // Sums and counts of the values in the bins, computed by each
+    // thread and then summed
+    const int max_threads = std::max(num_threads, 1);
+    std::vector<double> hist(max_threads * 2 * num_bins, 0.0);
+    const int num_parts = common::for_each_part(
+        eta.size(), num_threads,
+        [&eta, &r, &hist](std::size_t i0, std::size_t i1, int t)
+        {
+          double* h = hist.data() + t * 2 * num_bins;
+          for (std::size_t i = i0; i < i1; ++i)
+          {
+            if (int b = r.bin(eta[i]); b >= 0)
+            {
+              h[b] += eta[i];
+              h[num_bins + b] += 1.0;
+            }
+          }
+        });
+    for (int t = 1; t < num_parts; ++t)
+    {
+      for (int j = 0; j < 2 * num_bins; ++j)
+        hist[j] += hist[t * 2 * num_bins + j];
+    }
+    hist.resize(2 * num_bins);
+    MPI_Allreduce(MPI_IN_PLACE, hist.data(), hist.size(), MPI_DOUBLE, MPI_SUM,
+                  comm);
+
+    // Find the bin in which the sum from the largest values reaches
+    // the target
+    int b = num_bins - 1;
+    double acc = above;
+    for (; b > 0; --b)
+    {
+      if (acc + hist[b] >= target)
+        break;
+      acc += hist[b];
+    }
+
+    threshold = r.edge(b);
+    if (hist[num_bins + b] <= 1.0 or r.edge(b + 1) <= r.edge(b))
+      break;
+
+    above = acc;
+    r = {r.edge(b), r.edge(b + 1), r.closed and b == num_bins - 1};
+  }
+
+  std::vector<std::int32_t> selected;
+  for (std::size_t i = 0; i < eta.size(); ++i)
+  {
+    if (eta[i] >= threshold)
+      selected.push_back(i);
+  }
+
+  return selected;
+}
+//-----------------------------------------------------------------------------
+std::vector<std::int32_t>
+refinement::mark_doerfler(const mesh::Mesh& mesh,
+                          const xtl::span<const double>& eta, double theta,
+                          int num_threads)
+{
+  const int tdim = mesh.topology().dim();
+  auto map_c = mesh.topology().index_map(tdim);
+  assert(map_c);
+  if (eta.size() != std::size_t(map_c->size_local()))
+    throw std::runtime_error("Number of indicators must match owned cells");
+  auto c_to_e = mesh.topology().connectivity(tdim, 1);
+  if (!c_to_e)
+    throw std::runtime_error("Connectivity missing: (tdim, 1)");
+
+  std::vector<std::int32_t> edges;
+  for (std::int32_t c :
+       select_doerfler(mesh.mpi_comm(), eta, theta, num_threads))
+  {
+    auto cell_edges = c_to_e->links(c);
+    edges.insert(edges.end(), cell_edges.begin(), cell_edges.end());
+  }
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+  return edges;
+}
+//-----------------------------------------------------------------------------
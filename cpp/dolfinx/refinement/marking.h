@@ -0,0 +1,65 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <cstdint>
+#include <mpi.h>
+#include <vector>
+#include <xtl/xspan.hpp>
+
+namespace dolfinx::mesh
+{
+class Mesh;
+}
+
+namespace dolfinx::refinement
+{
+
+/// Select the largest values of a distributed array by the Dörfler
+/// (bulk) criterion: the values not smaller than a threshold are
+/// selected, with the largest threshold for which the sum of the
+/// selected values is at least theta times the sum of all values.
+///
+/// The threshold is found without sorting or gathering the values, by
+/// refinement of a histogram of the values: each step reduces the
+/// histogram of the bin that contains the threshold over all
+/// processes, until the bin contains at most one value or cannot be
+/// split.
+///
+/// @note Collective
+/// @param[in] comm The MPI communicator
+/// @param[in] eta The local (non-negative) values, e.g. the squares of
+/// the error indicators of the owned cells
+/// @param[in] theta The fraction of the sum of the values, in (0, 1]
+/// @param[in] num_threads The number of threads used to compute the
+/// histograms
+/// @return The sorted indices of the selected local values
+std::vector<std::int32_t> select_doerfler(MPI_Comm comm,
+                                          const xtl::span<const double>& eta,
+                                          double theta, int num_threads = 1);
+
+/// Mark the edges of the cells selected by the Dörfler criterion for
+/// refinement. The error indicators can be computed by assembly of a
+/// vector with a piecewise constant test function, with one value per
+/// cell.
+///
+/// @note Collective
+/// @param[in] mesh The mesh, with the (tdim, 1) connectivity
+/// @param[in] eta The (non-negative) error indicator of each owned
+/// cell, see refinement::select_doerfler
+/// @param[in] theta The fraction of the sum of the indicators, in (0, 1]
+/// @param[in] num_threads The number of threads used to compute the
+/// histograms
+/// @return The sorted local indices (owned and ghost) of the edges of
+/// the selected cells, which can be used as the indices of a MeshTags
+/// of dimension 1 for refinement::refine (which requires the (1, 1)
+/// connectivity)
+std::vector<std::int32_t> mark_doerfler(const mesh::Mesh& mesh,
+                                        const xtl::span<const double>& eta,
+                                        double theta, int num_threads = 1);
+
+} // namespace dolfinx::refinement
@@ -6,17 +6,24 @@
 
 #include "plaza.h"
 #include "utils.h"
+#include <algorithm>
+#include <array>
+#include <dolfinx/common/Arena.h>
 #include <dolfinx/common/IndexMap.h>
 #include <dolfinx/common/Timer.h>
+#include <dolfinx/common/utils.h>
 #include <dolfinx/graph/AdjacencyList.h>
+#include <dolfinx/la/Reduction.h>
 #include <dolfinx/mesh/Geometry.h>
 #include <dolfinx/mesh/Mesh.h>
 #include <dolfinx/mesh/MeshTags.h>
 #include <dolfinx/mesh/Topology.h>
 #include <limits>
 #include <map>
+#include <numeric>
 #include <vector>
 #include <xtensor/xnorm.hpp>
+#include <xtl/xspan.hpp>
 
 using namespace dolfinx;
 using namespace dolfinx::refinement;
@@ -55,30 +62,31 @@ void enforce_rules(
   const int num_neighbors = indegree;
   std::vector<std::vector<std::int32_t>> marked_for_update(num_neighbors);
 
-  std::int32_t update_count = 1;
-  while (update_count > 0)
+  // Mark the longest edge of each face with a marked edge, until no
+  // edge is marked, and add the shared edges that are marked to the
+  // lists of the sharing neighbors. The exchange of the edges of the
+  // previous round is progressed between sweeps.
+  std::vector<std::vector<std::int32_t>> pending(num_neighbors);
+  auto propagate = [&](refinement::MarkedEdgeExchange& exchange)
   {
-    update_count = 0;
-    refinement::update_logical_edgefunction(neighbor_comm, marked_for_update,
-                                            marked_edges, *map_e);
-    for (int i = 0; i < num_neighbors; ++i)
-      marked_for_update[i].clear();
-
-    for (int f = 0; f < num_faces; ++f)
+    bool changed = true;
+    while (changed)
     {
-      const std::int32_t long_e = long_edge[f];
-      if (marked_edges[long_e])
-        continue;
+      changed = false;
+      for (int f = 0; f < num_faces; ++f)
+      {
+        const std::int32_t long_e = long_edge[f];
+        if (marked_edges[long_e])
+          continue;
 
-      bool any_marked = false;
-      for (auto edge : f_to_e->links(f))
-        any_marked = any_marked or marked_edges[edge];
+        bool any_marked = false;
+        for (auto edge : f_to_e->links(f))
+          any_marked = any_marked or marked_edges[edge];
 
-      if (any_marked)
-      {
-        if (!marked_edges[long_e])
+        if (any_marked)
         {
           marked_edges[long_e] = true;
+          changed = true;
 
           // If it is a shared edge, add all sharing neighbors to update
           // set
@@ -86,23 +94,45 @@ void enforce_rules(
               map_it != shared_edges.end())
           {
             for (int p : map_it->second)
-              marked_for_update[p].push_back(long_e);
+              pending[p].push_back(long_e);
           }
         }
-        ++update_count;
       }
+      exchange.test();
     }
+  };
 
-    const std::int32_t update_count_old = update_count;
-    MPI_Allreduce(&update_count_old, &update_count, 1, MPI_INT32_T, MPI_SUM,
-                  mesh.mpi_comm());
+  // Each round sends the edges marked in the previous round and
+  // enforces the rules locally while the edges are in transit. The
+  // rules hold when no process sends or has edges to send.
+  while (true)
+  {
+    std::int32_t num_sent = 0;
+    for (int i = 0; i < num_neighbors; ++i)
+      num_sent += marked_for_update[i].size();
+    refinement::MarkedEdgeExchange exchange(neighbor_comm, marked_for_update,
+                                            *map_e);
+    propagate(exchange);
+    for (int i = 0; i < num_neighbors; ++i)
+    {
+      num_sent += pending[i].size();
+      marked_for_update[i] = std::move(pending[i]);
+      pending[i].clear();
+    }
+
+    la::Reduction<std::int32_t> update_count(mesh.mpi_comm(), {num_sent});
+    exchange.wait(marked_edges);
+    if (update_count.wait().front() == 0)
+      break;
   }
 }
 //-----------------------------------------------------------------------------
-// 2D version of subdivision allowing for uniform subdivision (flag)
-std::vector<std::int32_t> get_triangles(const std::vector<bool>& marked_edges,
-                                        const std::int32_t longest_edge,
-                                        bool uniform)
+// 2D version of subdivision allowing for uniform subdivision (flag).
+// The cell-local vertex indices of the new triangles are written to
+// simplices, and the number of indices written is returned.
+std::size_t get_triangles(const std::array<bool, 6>& marked_edges,
+                          std::int32_t longest_edge, bool uniform,
+                          const xtl::span<std::int32_t>& simplices)
 {
   // Longest edge must be marked
   assert(marked_edges[longest_edge]);
@@ -116,32 +146,51 @@ std::vector<std::int32_t> get_triangles(const std::vector<bool>& marked_edges,
   const std::int32_t e1 = v1 + 3;
   const std::int32_t e2 = v2 + 3;
 
+  std::size_t n = 0;
+  auto add = [&simplices, &n](std::int32_t a, std::int32_t b, std::int32_t c)
+  {
+    assert(n + 3 <= simplices.size());
+    simplices[n++] = a;
+    simplices[n++] = b;
+    simplices[n++] = c;
+  };
+
   // If all edges marked, consider uniform refinement
   if (uniform and marked_edges[v0] and marked_edges[v1])
-    return {e0, e1, v2, e1, e2, v0, e2, e0, v1, e2, e1, e0};
+  {
+    add(e0, e1, v2);
+    add(e1, e2, v0);
+    add(e2, e0, v1);
+    add(e2, e1, e0);
+    return n;
+  }
 
   // Break each half of triangle into one or two sub-triangles
-  std::vector<std::int32_t> tri_set;
   if (marked_edges[v0])
-    tri_set = {e2, v2, e0, e2, e0, v1};
+  {
+    add(e2, v2, e0);
+    add(e2, e0, v1);
+  }
   else
-    tri_set = {e2, v2, v1};
+    add(e2, v2, v1);
 
   if (marked_edges[v1])
   {
-    tri_set.insert(tri_set.end(), {e2, v2, e1});
-    tri_set.insert(tri_set.end(), {e2, e1, v0});
+    add(e2, v2, e1);
+    add(e2, e1, v0);
   }
   else
-    tri_set.insert(tri_set.end(), {e2, v2, v0});
+    add(e2, v2, v0);
 
-  return tri_set;
+  return n;
 }
 //-----------------------------------------------------------------------------
-// 3D version of subdivision
-std::vector<std::int32_t>
-get_tetrahedra(const std::vector<bool>& marked_edges,
-               const std::vector<std::int32_t>& longest_edge)
+// 3D version of subdivision. The cell-local vertex indices of the new
+// tetrahedra are written to simplices, and the number of indices
+// written is returned.
+std::size_t get_tetrahedra(const std::array<bool, 6>& marked_edges,
+                           const std::array<std::int32_t, 4>& longest_edge,
+                           const xtl::span<std::int32_t>& simplices)
 {
   // Connectivity matrix for ten possible points (4 vertices + 6 edge
   // midpoints) ordered {v0, v1, v2, v3, e0, e1, e2, e3, e4, e5} Only need
@@ -213,30 +262,39 @@ get_tetrahedra(const std::vector<bool>& marked_edges,
   }
 
   // Iterate through all possible new vertices
-  std::vector<std::int32_t> facet_set, tet_set;
+  std::size_t n = 0;
+  std::array<std::int32_t, 10> facet_set;
   for (std::int32_t i = 0; i < 10; ++i)
   {
     for (std::int32_t j = i + 1; j < 10; ++j)
     {
       if (conn[i][j])
       {
-        facet_set.clear();
+        std::size_t num_facet = 0;
         for (std::int32_t k = j + 1; k < 10; ++k)
         {
           if (conn[i][k] and conn[j][k])
           {
             // Note that i < j < m < k
-            for (const std::int32_t& m : facet_set)
-              if (conn[m][k])
-                tet_set.insert(tet_set.end(), {i, j, m, k});
-            facet_set.push_back(k);
+            for (std::size_t q = 0; q < num_facet; ++q)
+            {
+              if (const std::int32_t m = facet_set[q]; conn[m][k])
+              {
+                assert(n + 4 <= simplices.size());
+                simplices[n++] = i;
+                simplices[n++] = j;
+                simplices[n++] = m;
+                simplices[n++] = k;
+              }
+            }
+            facet_set[num_facet++] = k;
           }
         }
       }
     }
   }
 
-  return tet_set;
+  return n;
 }
 //-----------------------------------------------------------------------------
 /// Get the subdivision of an original simplex into smaller simplices,
@@ -244,51 +302,93 @@ get_tetrahedra(const std::vector<bool>& marked_edges,
 /// (cell local indexing). A flag indicates if a uniform subdivision is
 /// preferable in 2D.
 ///
-/// @param[in] marked_edges Vector indicating which edges are to be
+/// @param[in] marked_edges Array indicating which edges are to be
 ///   split
-/// @param[in] longest_edge Vector indicating the longest edge for each
-///   triangle. For tdim=2, one entry, for tdim=3, four entries.
+/// @param[in] longest_edge Array indicating the longest edge for each
+///   triangle. For tdim=2, the first entry, for tdim=3, four entries.
 /// @param[in] tdim Topological dimension (2 or 3)
 /// @param[in] uniform Make a "uniform" subdivision with all triangles
 ///   being similar shape
-/// @return
-std::vector<std::int32_t>
-get_simplices(const std::vector<bool>& marked_edges,
-              const std::vector<std::int32_t>& longest_edge, std::int32_t tdim,
-              bool uniform)
+/// @param[out] simplices The cell-local vertex indices of the new
+///   simplices (vertices are 0 to tdim, and the midpoint of edge i is
+///   tdim + 1 + i). It must have space for max_simplices * (tdim + 1)
+///   indices.
+/// @return The number of indices written to simplices
+std::size_t get_simplices(const std::array<bool, 6>& marked_edges,
+                          const std::array<std::int32_t, 4>& longest_edge,
+                          std::int32_t tdim, bool uniform,
+                          const xtl::span<std::int32_t>& simplices)
 {
   if (tdim == 2)
-  {
-    assert(longest_edge.size() == 1);
-    return get_triangles(marked_edges, longest_edge[0], uniform);
-  }
+    return get_triangles(marked_edges, longest_edge[0], uniform, simplices);
   else if (tdim == 3)
-  {
-    assert(longest_edge.size() == 4);
-    return get_tetrahedra(marked_edges, longest_edge);
-  }
+    return get_tetrahedra(marked_edges, longest_edge, simplices);
   else
     throw std::runtime_error("Topological dimension not supported");
 }
 
+// The maximum number of simplices that a cell is subdivided into
+constexpr int max_simplices = 8;
+
+//-----------------------------------------------------------------------------
+// Get the parent cell-local facet index of each facet of a new cell,
+// or -1 if the facet is in the interior of the parent. Facet k of the
+// new cell is opposite its vertex k, and its vertices are given in
+// cell-local indexing of the parent (vertices 0 to tdim, then the
+// midpoint of edge i is tdim + 1 + i).
+void compute_parent_facets(const xtl::span<const std::int32_t>& simplex,
+                           int tdim, const xtl::span<std::int8_t>& facets)
+{
+  // Edge connectivity to vertices
+  static const std::int32_t tri_edges[3][2] = {{1, 2}, {0, 2}, {0, 1}};
+  static const std::int32_t tet_edges[6][2]
+      = {{2, 3}, {1, 3}, {1, 2}, {0, 3}, {0, 2}, {0, 1}};
+
+  // A point is on facet j of the parent if it is not vertex j, or the
+  // midpoint of an edge that is not attached to vertex j
+  auto on_facet = [tdim](std::int32_t v, int j)
+  {
+    if (v <= tdim)
+      return v != j;
+    const std::int32_t* ev = tdim == 2 ? tri_edges[v - 3] : tet_edges[v - 4];
+    return ev[0] != j and ev[1] != j;
+  };
+
+  for (int k = 0; k <= tdim; ++k)
+  {
+    facets[k] = -1;
+    for (int j = 0; j <= tdim; ++j)
+    {
+      bool on_j = true;
+      for (int i = 0; i <= tdim; ++i)
+        on_j = on_j and (i == k or on_facet(simplex[i], j));
+      if (on_j)
+      {
+        facets[k] = j;
+        break;
+      }
+    }
+  }
+}
+
 // Get the longest edge of each face (using local mesh index)
-std::pair<std::vector<std::int32_t>, std::vector<bool>>
-face_long_edge(const mesh::Mesh& mesh)
+std::pair<std::vector<std::int32_t>, std::vector<std::int8_t>>
+face_long_edge(const mesh::Mesh& mesh, int num_threads)
 {
   const int tdim = mesh.topology().dim();
   // FIXME: cleanup these calls? Some of the happen internally again.
-  mesh.topology_mutable().create_entities(1);
-  mesh.topology_mutable().create_entities(2);
-  mesh.topology_mutable().create_connectivity(2, 1);
-  mesh.topology_mutable().create_connectivity(1, tdim);
-  mesh.topology_mutable().create_connectivity(tdim, 2);
+  mesh.topology_mutable().create_entities(1, num_threads);
+  mesh.topology_mutable().create_entities(2, num_threads);
+  mesh.topology_mutable().create_connectivity(2, 1, num_threads);
+  mesh.topology_mutable().create_connectivity(1, tdim, num_threads);
+  mesh.topology_mutable().create_connectivity(tdim, 2, num_threads);
 
   std::int64_t num_faces = mesh.topology().index_map(2)->size_local()
                            + mesh.topology().index_map(2)->num_ghosts();
 
   // Storage for face-local index of longest edge
   std::vector<std::int32_t> long_edge(num_faces);
-  std::vector<bool> edge_ratio_ok;
+  std::vector<std::int8_t> edge_ratio_ok;
 
   // Check mesh face quality (may be used in 2D to switch to "uniform"
   // refinement)
@@ -308,31 +408,37 @@ face_long_edge(const mesh::Mesh& mesh)
   // Store all edge lengths in Mesh to save recalculating for each Face
   auto map_e = mesh.topology().index_map(1);
   assert(map_e);
-  std::vector<double> edge_length(map_e->size_local() + map_e->num_ghosts());
+  common::ArenaScope scope;
+  std::pmr::vector<double> edge_length(
+      map_e->size_local() + map_e->num_ghosts(), scope.resource());
   const xt::xtensor<double, 2>& x = mesh.geometry().x();
-  for (std::size_t e = 0; e < edge_length.size(); ++e)
+  auto compute_length = [&](std::int32_t e0, std::int32_t e1, int)
   {
-    // Get first attached cell
-    assert(e_to_c->num_links(e) > 0);
-    const std::int32_t c = e_to_c->links(e)[0];
-    auto cell_vertices = c_to_v->links(c);
-    auto edge_vertices = e_to_v->links(e);
-
-    // Find local index of edge vertices in the cell geometry map
-    auto it0 = std::find(cell_vertices.begin(), cell_vertices.end(),
-                         edge_vertices[0]);
-    assert(it0 != cell_vertices.end());
-    const std::size_t local0 = std::distance(cell_vertices.begin(), it0);
-    auto it1 = std::find(cell_vertices.begin(), cell_vertices.end(),
-                         edge_vertices[1]);
-    assert(it1 != cell_vertices.end());
-    const std::size_t local1 = std::distance(cell_vertices.begin(), it1);
-
-    auto x_dofs = x_dofmap.links(c);
-    auto x0 = xt::row(x, x_dofs[local0]);
-    auto x1 = xt::row(x, x_dofs[local1]);
-    edge_length[e] = xt::norm_l2(x0 - x1)();
-  }
+    for (std::int32_t e = e0; e < e1; ++e)
+    {
+      // Get first attached cell
+      assert(e_to_c->num_links(e) > 0);
+      const std::int32_t c = e_to_c->links(e)[0];
+      auto cell_vertices = c_to_v->links(c);
+      auto edge_vertices = e_to_v->links(e);
+
+      // Find local index of edge vertices in the cell geometry map
+      auto it0 = std::find(cell_vertices.begin(), cell_vertices.end(),
+                           edge_vertices[0]);
+      assert(it0 != cell_vertices.end());
+      const std::size_t local0 = std::distance(cell_vertices.begin(), it0);
+      auto it1 = std::find(cell_vertices.begin(), cell_vertices.end(),
+                           edge_vertices[1]);
+      assert(it1 != cell_vertices.end());
+      const std::size_t local1 = std::distance(cell_vertices.begin(), it1);
+
+      auto x_dofs = x_dofmap.links(c);
+      auto x0 = xt::row(x, x_dofs[local0]);
+      auto x1 = xt::row(x, x_dofs[local1]);
+      edge_length[e] = xt::norm_l2(x0 - x1)();
+    }
+  };
+  common::for_each_part(edge_length.size(), num_threads, compute_length);
 
   // Get longest edge of each face
   auto f_to_v = mesh.topology().connectivity(2, 0);
@@ -341,68 +447,82 @@ face_long_edge(const mesh::Mesh& mesh)
   assert(f_to_e);
   const std::vector global_indices
       = mesh.topology().index_map(0)->global_indices();
-  for (int f = 0; f < f_to_v->num_nodes(); ++f)
+  auto compute_long_edge = [&](std::int32_t f0, std::int32_t f1, int)
   {
-    auto face_edges = f_to_e->links(f);
+    for (std::int32_t f = f0; f < f1; ++f)
+    {
+      auto face_edges = f_to_e->links(f);
 
-    std::int32_t imax = 0;
-    double max_len = 0.0;
-    double min_len = std::numeric_limits<double>::max();
+      std::int32_t imax = 0;
+      double max_len = 0.0;
+      double min_len = std::numeric_limits<double>::max();
 
-    for (int i = 0; i < 3; ++i)
-    {
-      const double e_len = edge_length[face_edges[i]];
-      min_len = std::min(e_len, min_len);
-      if (e_len > max_len)
+      for (int i = 0; i < 3; ++i)
       {
-        max_len = e_len;
-        imax = i;
-      }
-      else if (tdim == 3 and e_len == max_len)
-      {
-        // If edges are the same length, compare global index of
-        // opposite vertex.  Only important so that tetrahedral faces
-        // have a matching refinement pattern across processes.
-        auto vertices = f_to_v->links(f);
-        const int vmax = vertices[imax];
-        const int vi = vertices[i];
-        if (global_indices[vi] > global_indices[vmax])
+        const double e_len = edge_length[face_edges[i]];
+        min_len = std::min(e_len, min_len);
+        if (e_len > max_len)
+        {
+          max_len = e_len;
           imax = i;
+        }
+        else if (tdim == 3 and e_len == max_len)
+        {
+          // If edges are the same length, compare global index of
+          // opposite vertex.  Only important so that tetrahedral faces
+          // have a matching refinement pattern across processes.
+          auto vertices = f_to_v->links(f);
+          const int vmax = vertices[imax];
+          const int vi = vertices[i];
+          if (global_indices[vi] > global_indices[vmax])
+            imax = i;
+        }
       }
-    }
 
-    // Only save edge ratio in 2D
-    if (tdim == 2)
-      edge_ratio_ok[f] = (min_len / max_len >= min_ratio);
+      // Only save edge ratio in 2D
+      if (tdim == 2)
+        edge_ratio_ok[f] = (min_len / max_len >= min_ratio);
 
-    long_edge[f] = face_edges[imax];
-  }
+      long_edge[f] = face_edges[imax];
+    }
+  };
+  common::for_each_part(f_to_v->num_nodes(), num_threads, compute_long_edge);
 
   return std::pair(std::move(long_edge), std::move(edge_ratio_ok));
 }
 //-----------------------------------------------------------------------------
-// Convenient interface for both uniform and marker refinement
+// Convenient interface for both uniform and marker refinement. With
+// refine_all, all edges are marked and the marker look-ups are
+// skipped. The new cells of each parent cell are written in parallel
+// (num_threads threads) into preallocated arrays, after a counting
+// pass that sizes them.
 std::tuple<graph::AdjacencyList<std::int64_t>, xt::xtensor<double, 2>,
-           std::vector<std::int32_t>>
+           std::vector<std::int32_t>, std::vector<std::int8_t>>
 compute_refinement(
     const MPI_Comm& neighbor_comm, const std::vector<bool>& marked_edges,
     const std::map<std::int32_t, std::vector<std::int32_t>> shared_edges,
     const mesh::Mesh& mesh, const std::vector<std::int32_t>& long_edge,
-    const std::vector<bool>& edge_ratio_ok)
+    const std::vector<std::int8_t>& edge_ratio_ok, bool refine_all,
+    int num_threads)
 {
+  common::Timer t0("PLAZA: Subdivide cells");
+
   const std::int32_t tdim = mesh.topology().dim();
-  const std::int32_t num_cell_edges = tdim * 3 - 3;
   const std::int32_t num_cell_vertices = tdim + 1;
 
   // Make new vertices in parallel
-  const auto [new_vertex_map, new_vertex_coordinates]
+  auto [new_vertex_map, new_vertex_coordinates]
       = refinement::create_new_vertices(neighbor_comm, shared_edges, mesh,
                                         marked_edges);
 
-  std::vector<std::int32_t> parent_cell;
-  std::vector<std::int64_t> indices(num_cell_vertices + num_cell_edges);
-  std::vector<int> marked_edge_list;
-  std::vector<std::int32_t> simplex_set;
+  // Global index of the new vertex of each (local) edge, -1 if the
+  // edge is not split
+  auto map_e = mesh.topology().index_map(1);
+  assert(map_e);
+  std::vector<std::int64_t> edge_to_vertex(
+      map_e->size_local() + map_e->num_ghosts(), -1);
+  for (auto [e, v] : new_vertex_map)
+    edge_to_vertex[e] = v;
 
   auto map_c = mesh.topology().index_map(tdim);
   assert(map_c);
@@ -414,114 +534,157 @@ compute_refinement(
   auto c_to_f = mesh.topology().connectivity(tdim, 2);
   assert(c_to_f);
 
-  std::int32_t num_new_vertices_local = std::count(
-      marked_edges.begin(),
-      marked_edges.begin() + mesh.topology().index_map(1)->size_local(), true);
+  const std::int32_t num_new_vertices_local
+      = refine_all ? map_e->size_local()
+                   : std::int32_t(std::count(
+                       marked_edges.begin(),
+                       marked_edges.begin() + map_e->size_local(), true));
 
   std::vector<std::int64_t> global_indices = refinement::adjust_indices(
       mesh.topology().index_map(0), num_new_vertices_local);
 
-  const int num_cells = map_c->size_local();
-  std::vector<std::int64_t> cell_topology;
-  for (int c = 0; c < num_cells; ++c)
+  // Get the markers of the cell edges. Returns the number of marked
+  // edges.
+  auto cell_markers = [&](std::int32_t c, std::array<bool, 6>& markers)
   {
-    // Create vector of indices in the order [vertices][edges], 3+3 in
-    // 2D, 4+6 in 3D
-
-    // Copy vertices
-    auto vertices = c_to_v->links(c);
-    for (std::size_t v = 0; v < vertices.size(); ++v)
-      indices[v] = global_indices[vertices[v]];
-
-    // Get cell-local indices of marked edges
-    marked_edge_list.clear();
     auto edges = c_to_e->links(c);
+    int num_marked = 0;
     for (std::size_t ei = 0; ei < edges.size(); ++ei)
-      if (marked_edges[edges[ei]])
-        marked_edge_list.push_back(ei);
+    {
+      markers[ei] = refine_all or marked_edges[edges[ei]];
+      num_marked += markers[ei];
+    }
+    return num_marked;
+  };
+
+  // Compute the cell-local subdivision of a cell with marked edges.
+  // Returns the number of indices written to simplices.
+  auto subdivide
+      = [&](std::int32_t c, const std::array<bool, 6>& markers,
+            const xtl::span<std::int32_t>& simplices) -> std::size_t
+  {
+    // Need longest edges of each face in cell local indexing. NB in
+    // 2D the face is the cell itself, and there is just one entry.
+    auto edges = c_to_e->links(c);
+    auto faces = c_to_f->links(c);
+    std::array<std::int32_t, 4> longest_edge;
+    for (std::size_t i = 0; i < faces.size(); ++i)
+    {
+      auto it = std::find(edges.begin(), edges.end(), long_edge[faces[i]]);
+      assert(it != edges.end());
+      longest_edge[i] = std::distance(edges.begin(), it);
+    }
 
-    if (marked_edge_list.empty())
+    const bool uniform = (tdim == 2) ? edge_ratio_ok[c] : false;
+    return get_simplices(markers, longest_edge, tdim, uniform, simplices);
+  };
+
+  // Count the new cells of each cell. In 2D, a cell with marked edges
+  // is split into one more cell than it has marked edges.
+  const std::int32_t num_cells = map_c->size_local();
+  common::ArenaScope scope;
+  std::pmr::vector<std::int32_t> cell_offsets(num_cells + 1, 0,
+                                              scope.resource());
+  auto count_cells = [&](std::int32_t c0, std::int32_t c1, int)
+  {
+    std::array<bool, 6> markers;
+    std::array<std::int32_t, max_simplices * 4> simplices;
+    for (std::int32_t c = c0; c < c1; ++c)
     {
-      // Copy over existing Cell to new topology
-      for (auto v : vertices)
-        cell_topology.push_back(global_indices[v]);
-      parent_cell.push_back(c);
+      if (const int num_marked = cell_markers(c, markers); num_marked == 0)
+        cell_offsets[c + 1] = 1;
+      else if (tdim == 2)
+        cell_offsets[c + 1] = num_marked + 1;
+      else
+        cell_offsets[c + 1] = subdivide(c, markers, simplices) / 4;
     }
-    else
+  };
+  if (refine_all and tdim == 2)
+    std::fill(std::next(cell_offsets.begin()), cell_offsets.end(), 4);
+  else
+    common::for_each_part(num_cells, num_threads, count_cells);
+  std::partial_sum(cell_offsets.begin(), cell_offsets.end(),
+                   cell_offsets.begin());
+
+  // Write the new cells
+  std::vector<std::int64_t> cell_topology(cell_offsets.back()
+                                          * num_cell_vertices);
+  std::vector<std::int32_t> parent_cell(cell_offsets.back());
+  std::vector<std::int8_t> parent_facet(cell_topology.size());
+  auto create_cells = [&](std::int32_t c0, std::int32_t c1, int)
+  {
+    std::array<bool, 6> markers;
+    std::array<std::int32_t, max_simplices * 4> simplices;
+    std::array<std::int64_t, 10> indices;
+    for (std::int32_t c = c0; c < c1; ++c)
     {
-      // Get the marked edge indices for new vertices and make bool
-      // vector of marked edges
-      std::vector<bool> markers(num_cell_edges, false);
-      auto edges = c_to_e->links(c);
-      for (int p : marked_edge_list)
+      std::fill(std::next(parent_cell.begin(), cell_offsets[c]),
+                std::next(parent_cell.begin(), cell_offsets[c + 1]), c);
+      auto cell = std::next(cell_topology.begin(),
+                            cell_offsets[c] * num_cell_vertices);
+      xtl::span<std::int8_t> facets(parent_facet.data()
+                                        + cell_offsets[c] * num_cell_vertices,
+                                    (cell_offsets[c + 1] - cell_offsets[c])
+                                        * num_cell_vertices);
+
+      // Copy over an unmarked cell to the new topology
+      auto vertices = c_to_v->links(c);
+      if (cell_markers(c, markers) == 0)
       {
-        markers[p] = true;
-        auto it = new_vertex_map.find(edges[p]);
-        assert(it != new_vertex_map.end());
-        indices[num_cell_vertices + p] = it->second;
+        std::transform(vertices.begin(), vertices.end(), cell,
+                       [&global_indices](auto v) { return global_indices[v]; });
+        std::iota(facets.begin(), facets.end(), 0);
+        continue;
       }
 
-      // Need longest edges of each face in cell local indexing. NB in
-      // 2D the face is the cell itself, and there is just one entry.
-      std::vector<std::int32_t> longest_edge;
-      for (auto f : c_to_f->links(c))
-        longest_edge.push_back(long_edge[f]);
-
-      // Convert to cell local index
-      for (std::int32_t& p : longest_edge)
+      // Create vector of indices in the order [vertices][edges], 3+3
+      // in 2D, 4+6 in 3D
+      for (std::size_t v = 0; v < vertices.size(); ++v)
+        indices[v] = global_indices[vertices[v]];
+      auto edges = c_to_e->links(c);
+      for (std::size_t ei = 0; ei < edges.size(); ++ei)
       {
-        for (std::size_t ej = 0; ej < edges.size(); ++ej)
-        {
-          if (p == edges[ej])
-          {
-            p = ej;
-            break;
-          }
-        }
+        assert(!markers[ei] or edge_to_vertex[edges[ei]] >= 0);
+        indices[num_cell_vertices + ei] = edge_to_vertex[edges[ei]];
       }
 
-      const bool uniform = (tdim == 2) ? edge_ratio_ok[c] : false;
-
-      // FIXME: this has an expensive dynamic memory allocation
-      simplex_set = get_simplices(markers, longest_edge, tdim, uniform);
-
-      // Save parent index
-      const std::int32_t ncells = simplex_set.size() / num_cell_vertices;
-      for (std::int32_t i = 0; i < ncells; ++i)
-        parent_cell.push_back(c);
-
-      // Convert from cell local index to mesh index and add to cells
-      for (std::int32_t v : simplex_set)
-        cell_topology.push_back(indices[v]);
+      // Convert from cell local index to mesh index
+      const std::size_t n = subdivide(c, markers, simplices);
+      assert((std::int32_t)n
+             == (cell_offsets[c + 1] - cell_offsets[c]) * num_cell_vertices);
+      std::transform(simplices.begin(), std::next(simplices.begin(), n), cell,
+                     [&indices](auto v) { return indices[v]; });
+      for (std::size_t i = 0; i < n; i += num_cell_vertices)
+      {
+        compute_parent_facets(
+            xtl::span<const std::int32_t>(simplices.data() + i,
+                                          num_cell_vertices),
+            tdim, facets.subspan(i, num_cell_vertices));
+      }
     }
-  }
+  };
+  common::for_each_part(num_cells, num_threads, create_cells);
 
-  assert(cell_topology.size() % num_cell_vertices == 0);
-  std::vector<std::int32_t> offsets(
-      cell_topology.size() / num_cell_vertices + 1, 0);
+  std::vector<std::int32_t> offsets(cell_offsets.back() + 1, 0);
   for (std::size_t i = 0; i < offsets.size() - 1; ++i)
     offsets[i + 1] = offsets[i] + num_cell_vertices;
   graph::AdjacencyList<std::int64_t> cell_adj(std::move(cell_topology),
                                               std::move(offsets));
 
   return {std::move(cell_adj), std::move(new_vertex_coordinates),
-          std::move(parent_cell)};
+          std::move(parent_cell), std::move(parent_facet)};
 }
 //-----------------------------------------------------------------------------
-} // namespace
-
-//-----------------------------------------------------------------------------
-mesh::Mesh plaza::refine(const mesh::Mesh& mesh, bool redistribute)
+// Create the refined mesh from the new cells and the owned vertices.
+// Without ghost cells and redistribution, the new cells stay on the
+// process of their parent and the mesh is created directly. Otherwise
+// it is built (and partitioned) from scratch.
+mesh::Mesh
+create_refined_mesh(const mesh::Mesh& mesh,
+                    const graph::AdjacencyList<std::int64_t>& cell_adj,
+                    const xt::xtensor<double, 2>& new_vertex_coordinates,
+                    bool redistribute)
 {
-  auto [cell_adj, new_vertex_coordinates, parent_cell]
-      = plaza::compute_refinement_data(mesh);
-
-  if (dolfinx::MPI::size(mesh.mpi_comm()) == 1)
-  {
-    return mesh::create_mesh(mesh.mpi_comm(), cell_adj, mesh.geometry().cmap(),
-                             new_vertex_coordinates, mesh::GhostMode::none);
-  }
-
   const std::shared_ptr<const common::IndexMap> map_c
       = mesh.topology().index_map(mesh.topology().dim());
   const int num_ghost_cells = map_c->num_ghosts();
@@ -531,6 +694,13 @@ mesh::Mesh plaza::refine(const mesh::Mesh& mesh, bool redistribute)
   MPI_Allreduce(&num_ghost_cells, &max_ghost_cells, 1, MPI_INT, MPI_MAX,
                 mesh.mpi_comm());
 
+  if (max_ghost_cells == 0
+      and (!redistribute or dolfinx::MPI::size(mesh.mpi_comm()) == 1))
+  {
+    return refinement::create_mesh_from_parent(mesh, cell_adj,
+                                               new_vertex_coordinates);
+  }
+
   // Build mesh
   const mesh::GhostMode ghost_mode = (max_ghost_cells == 0)
                                          ? mesh::GhostMode::none
@@ -540,42 +710,34 @@ mesh::Mesh plaza::refine(const mesh::Mesh& mesh, bool redistribute)
                                redistribute, ghost_mode);
 }
 //-----------------------------------------------------------------------------
+} // namespace
+
+//-----------------------------------------------------------------------------
+mesh::Mesh plaza::refine(const mesh::Mesh& mesh, bool redistribute,
+                         int num_threads)
+{
+  auto [cell_adj, new_vertex_coordinates, parent_cell, parent_facet]
+      = plaza::compute_refinement_data(mesh, num_threads);
+
+  return create_refined_mesh(mesh, cell_adj, new_vertex_coordinates,
+                             redistribute);
+}
+//-----------------------------------------------------------------------------
 mesh::Mesh plaza::refine(const mesh::Mesh& mesh,
                          const mesh::MeshTags<std::int8_t>& refinement_marker,
-                         bool redistribute)
+                         bool redistribute, int num_threads)
 {
-  auto [cell_adj, new_vertex_coordinates, parent_cell]
-      = plaza::compute_refinement_data(mesh, refinement_marker);
+  auto [cell_adj, new_vertex_coordinates, parent_cell, parent_facet]
+      = plaza::compute_refinement_data(mesh, refinement_marker, num_threads);
 
-  if (dolfinx::MPI::size(mesh.mpi_comm()) == 1)
-  {
-    return mesh::create_mesh(mesh.mpi_comm(), cell_adj, mesh.geometry().cmap(),
-                             new_vertex_coordinates, mesh::GhostMode::none);
-  }
-
-  const std::shared_ptr<const common::IndexMap> map_c
-      = mesh.topology().index_map(mesh.topology().dim());
-  const int num_ghost_cells = map_c->num_ghosts();
-  // Check if mesh has ghost cells on any rank
-  // FIXME: this is not a robust test. Should be user option.
-  int max_ghost_cells = 0;
-  MPI_Allreduce(&num_ghost_cells, &max_ghost_cells, 1, MPI_INT, MPI_MAX,
-                mesh.mpi_comm());
-
-  // Build mesh
-  const mesh::GhostMode ghost_mode = (max_ghost_cells == 0)
-                                         ? mesh::GhostMode::none
-                                         : mesh::GhostMode::shared_facet;
-
-  return refinement::partition(mesh, cell_adj, new_vertex_coordinates,
-                               redistribute, ghost_mode);
+  return create_refined_mesh(mesh, cell_adj, new_vertex_coordinates,
+                             redistribute);
 }
 //------------------------------------------------------------------------------
 std::tuple<graph::AdjacencyList<std::int64_t>, xt::xtensor<double, 2>,
-           std::vector<std::int32_t>>
-plaza::compute_refinement_data(const mesh::Mesh& mesh)
+           std::vector<std::int32_t>, std::vector<std::int8_t>>
+plaza::compute_refinement_data(const mesh::Mesh& mesh, int num_threads)
 {
-
   if (mesh.topology().cell_type() != mesh::CellType::triangle
       and mesh.topology().cell_type() != mesh::CellType::tetrahedron)
   {
@@ -586,26 +748,26 @@ plaza::compute_refinement_data(const mesh::Mesh& mesh)
 
   auto [neighbor_comm, shared_edges] = refinement::compute_edge_sharing(mesh);
 
-  // Mark all edges
+  // Mark all edges. No marker propagation is needed, and the cell
+  // subdivision does not look up the markers.
+  const auto [long_edge, edge_ratio_ok] = face_long_edge(mesh, num_threads);
   auto map_e = mesh.topology().index_map(1);
   std::vector<bool> marked_edges(map_e->size_local() + map_e->num_ghosts(),
                                  true);
-
-  const auto [long_edge, edge_ratio_ok] = face_long_edge(mesh);
-  auto [cell_adj, new_vertex_coordinates, parent_cell]
+  auto [cell_adj, new_vertex_coordinates, parent_cell, parent_facet]
       = compute_refinement(neighbor_comm, marked_edges, shared_edges, mesh,
-                           long_edge, edge_ratio_ok);
+                           long_edge, edge_ratio_ok, true, num_threads);
   MPI_Comm_free(&neighbor_comm);
 
   return {std::move(cell_adj), std::move(new_vertex_coordinates),
-          std::move(parent_cell)};
+          std::move(parent_cell), std::move(parent_facet)};
 }
 //------------------------------------------------------------------------------
 std::tuple<graph::AdjacencyList<std::int64_t>, xt::xtensor<double, 2>,
-           std::vector<std::int32_t>>
+           std::vector<std::int32_t>, std::vector<std::int8_t>>
 plaza::compute_refinement_data(
     const mesh::Mesh& mesh,
-    const mesh::MeshTags<std::int8_t>& refinement_marker)
+    const mesh::MeshTags<std::int8_t>& refinement_marker, int num_threads)
 {
   if (mesh.topology().cell_type() != mesh::CellType::triangle
       and mesh.topology().cell_type() != mesh::CellType::tetrahedron)
@@ -667,14 +829,14 @@ plaza::compute_refinement_data(
 
   // Enforce rules about refinement (i.e. if any edge is marked in a
   // triangle, then the longest edge must also be marked).
-  const auto [long_edge, edge_ratio_ok] = face_long_edge(mesh);
+  const auto [long_edge, edge_ratio_ok] = face_long_edge(mesh, num_threads);
   enforce_rules(neighbor_comm, shared_edges, marked_edges, mesh, long_edge);
 
-  auto [cell_adj, new_vertex_coordinates, parent_cell]
+  auto [cell_adj, new_vertex_coordinates, parent_cell, parent_facet]
       = compute_refinement(neighbor_comm, marked_edges, shared_edges, mesh,
-                           long_edge, edge_ratio_ok);
+                           long_edge, edge_ratio_ok, false, num_threads);
   MPI_Comm_free(&neighbor_comm);
   return {std::move(cell_adj), std::move(new_vertex_coordinates),
-          std::move(parent_cell)};
+          std::move(parent_cell), std::move(parent_facet)};
 }
 //-----------------------------------------------------------------------------
@@ -30,45 +30,66 @@ namespace plaza
 /// Uniform refine, optionally redistributing and optionally
 /// calculating the parent-child relation for facets (in 2D)
 ///
+/// Without redistribution of a mesh without ghost cells, the refined
+/// mesh is created directly from the parent topology (see
+/// refinement::create_mesh_from_parent).
+///
 /// @param[in] mesh Input mesh to be refined
 /// @param[in] redistribute Flag to call the mesh partitioner to
 /// redistribute after refinement
+/// @param[in] num_threads The number of threads used to subdivide the
+/// cells
 /// @return New mesh
-mesh::Mesh refine(const mesh::Mesh& mesh, bool redistribute);
+mesh::Mesh refine(const mesh::Mesh& mesh, bool redistribute,
+                  int num_threads = 1);
 
-/// Refine with markers, optionally redistributing
+/// Refine with markers, optionally redistributing. The refined mesh is
+/// created as for uniform refinement.
 ///
 /// @param[in] mesh Input mesh to be refined
 /// @param[in] refinement_marker MeshTags listing which mesh entities
 /// should be split by this refinement. The values are ignored.
 /// @param[in] redistribute Flag to call the Mesh Partitioner to
 /// redistribute after refinement
+/// @param[in] num_threads The number of threads used to subdivide the
+/// cells
 /// @return New Mesh
 mesh::Mesh refine(const mesh::Mesh& mesh,
                   const mesh::MeshTags<std::int8_t>& refinement_marker,
-                  bool redistribute);
+                  bool redistribute, int num_threads = 1);
 
 /// Refine with markers returning new mesh data
 ///
 /// @param[in] mesh Input mesh to be refined
 /// @param[in] refinement_marker MeshTags listing which mesh entities
 /// should be split by this refinement. The values are ignored.
-/// redistribute after refinement
-/// @return New mesh data: cell topology, vertex coordinates and parent cell
-/// index
+/// @param[in] num_threads The number of threads used to subdivide the
+/// cells
+/// @return New mesh data: cell topology, vertex coordinates, parent
+/// cell index and parent facet. The parent facet of facet j of new
+/// cell i is entry i * (tdim + 1) + j, and is the local index of the
+/// facet of the parent cell that contains it, or -1 if it is in the
+/// interior of the parent cell.
 std::tuple<graph::AdjacencyList<std::int64_t>, xt::xtensor<double, 2>,
-           std::vector<std::int32_t>>
+           std::vector<std::int32_t>, std::vector<std::int8_t>>
 compute_refinement_data(const mesh::Mesh& mesh,
-                        const mesh::MeshTags<std::int8_t>& refinement_marker);
+                        const mesh::MeshTags<std::int8_t>& refinement_marker,
+                        int num_threads = 1);
 
-/// Refine mesh returning new mesh data
+/// Refine mesh returning new mesh data. All edges are split, so the
+/// marker propagation of the marked refinement is skipped.
 ///
 /// @param[in] mesh Input mesh to be refined
-/// @return New mesh data: cell topology, vertex coordinates and parent cell
-/// index
+/// @param[in] num_threads The number of threads used to subdivide the
+/// cells
+/// @return New mesh data: cell topology, vertex coordinates, parent
+/// cell index and parent facet. The parent facet of facet j of new
+/// cell i is entry i * (tdim + 1) + j, and is the local index of the
+/// facet of the parent cell that contains it, or -1 if it is in the
+/// interior of the parent cell.
 std::tuple<graph::AdjacencyList<std::int64_t>, xt::xtensor<double, 2>,
-           std::vector<std::int32_t>>
-compute_refinement_data(const mesh::Mesh& mesh);
+           std::vector<std::int32_t>, std::vector<std::int8_t>>
+compute_refinement_data(const mesh::Mesh& mesh, int num_threads = 1);
 
 } // namespace plaza
 } // namespace dolfinx::refinement
@@ -15,7 +15,7 @@ using namespace refinement;
 
 //-----------------------------------------------------------------------------
 mesh::Mesh dolfinx::refinement::refine(const mesh::Mesh& mesh,
-                                       bool redistribute)
+                                       bool redistribute, int num_threads)
 {
   if (mesh.topology().cell_type() != mesh::CellType::triangle
       and mesh.topology().cell_type() != mesh::CellType::tetrahedron)
@@ -23,7 +23,7 @@ mesh::Mesh dolfinx::refinement::refine(const mesh::Mesh& mesh,
     throw std::runtime_error("Refinement only defined for simplices");
   }
 
-  mesh::Mesh refined_mesh = plaza::refine(mesh, redistribute);
+  mesh::Mesh refined_mesh = plaza::refine(mesh, redistribute, num_threads);
 
   // Report the number of refined cells
   const int D = mesh.topology().dim();
@@ -39,7 +39,7 @@ mesh::Mesh dolfinx::refinement::refine(const mesh::Mesh& mesh,
 mesh::Mesh
 dolfinx::refinement::refine(const mesh::Mesh& mesh,
                             const mesh::MeshTags<std::int8_t>& cell_markers,
-                            bool redistribute)
+                            bool redistribute, int num_threads)
 {
   if (mesh.topology().cell_type() != mesh::CellType::triangle
       and mesh.topology().cell_type() != mesh::CellType::tetrahedron)
@@ -47,7 +47,8 @@ dolfinx::refinement::refine(const mesh::Mesh& mesh,
     throw std::runtime_error("Refinement only defined for simplices");
   }
 
-  mesh::Mesh refined_mesh = plaza::refine(mesh, cell_markers, redistribute);
+  mesh::Mesh refined_mesh
+      = plaza::refine(mesh, cell_markers, redistribute, num_threads);
 
   // Report the number of refined cells
   const int D = mesh.topology().dim();
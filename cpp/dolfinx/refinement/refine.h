@@ -23,8 +23,11 @@ namespace dolfinx::refinement
 /// @param[in] mesh The mesh from which to build a refined Mesh
 /// @param[in] redistribute Optional argument to redistribute the
 ///     refined mesh if mesh is a distributed mesh.
+/// @param[in] num_threads The number of threads used to subdivide the
+///     cells
 /// @return A refined mesh
-mesh::Mesh refine(const mesh::Mesh& mesh, bool redistribute = true);
+mesh::Mesh refine(const mesh::Mesh& mesh, bool redistribute = true,
+                  int num_threads = 1);
 
 /// Create locally refined mesh
 ///
@@ -34,9 +37,11 @@ mesh::Mesh refine(const mesh::Mesh& mesh, bool redistribute = true);
 ///     (any other integer value)).
 /// @param[in] redistribute Optional argument to redistribute the
 ///     refined mesh if mesh is a distributed mesh.
+/// @param[in] num_threads The number of threads used to subdivide the
+///     cells
 /// @return A locally refined mesh
 mesh::Mesh refine(const mesh::Mesh& mesh,
                   const mesh::MeshTags<std::int8_t>& cell_markers,
-                  bool redistribute = true);
+                  bool redistribute = true, int num_threads = 1);
 
 } // namespace dolfinx::refinement
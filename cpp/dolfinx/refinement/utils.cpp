@@ -5,9 +5,12 @@
 // SPDX-License-Identifier:    LGPL-3.0-or-later
 
 #include "utils.h"
+#include <algorithm>
+#include <dolfinx/common/IndexMap.h>
 #include <dolfinx/common/MPI.h>
 #include <dolfinx/common/types.h>
 #include <dolfinx/fem/ElementDofLayout.h>
+#include <dolfinx/graph/partition.h>
 #include <dolfinx/mesh/Geometry.h>
 #include <dolfinx/mesh/Mesh.h>
 #include <dolfinx/mesh/MeshTags.h>
@@ -15,13 +18,17 @@
 #include <dolfinx/mesh/graphbuild.h>
 #include <dolfinx/mesh/topologycomputation.h>
 #include <dolfinx/mesh/utils.h>
+#include <iterator>
 #include <map>
 #include <memory>
 #include <mpi.h>
+#include <numeric>
+#include <set>
 #include <vector>
 #include <xtensor/xadapt.hpp>
 #include <xtensor/xtensor.hpp>
 #include <xtensor/xview.hpp>
+#include <xtl/xspan.hpp>
 
 using namespace dolfinx;
 using namespace xt::placeholders;
@@ -117,17 +124,17 @@ refinement::compute_edge_sharing(const mesh::Mesh& mesh)
   auto map_e = mesh.topology().index_map(1);
   assert(map_e);
 
-  // Create shared edges, for both owned and ghost indices
-  // returning edge -> set(global process numbers)
-  std::map<std::int32_t, std::set<int>> shared_edges_by_proc
-      = map_e->compute_shared_indices();
+  // Shared edges, for both owned and ghost indices, i.e. edge ->
+  // (global process numbers)
+  const graph::AdjacencyList<int> shared_edges_by_proc
+      = map_e->compute_sharing_ranks();
 
   // Compute a slightly wider neighborhood for direct communication of shared
   // edges
-  std::set<int> all_neighbor_set;
-  for (const auto& q : shared_edges_by_proc)
-    all_neighbor_set.insert(q.second.begin(), q.second.end());
-  std::vector<int> neighbors(all_neighbor_set.begin(), all_neighbor_set.end());
+  std::vector<int> neighbors(shared_edges_by_proc.array());
+  std::sort(neighbors.begin(), neighbors.end());
+  neighbors.erase(std::unique(neighbors.begin(), neighbors.end()),
+                  neighbors.end());
 
   MPI_Comm neighbor_comm;
   MPI_Dist_graph_create_adjacent(
@@ -141,47 +148,105 @@ refinement::compute_edge_sharing(const mesh::Mesh& mesh)
     proc_to_neighbor.insert({neighbors[i], i});
 
   std::map<std::int32_t, std::vector<int>> shared_edges;
-  for (auto& q : shared_edges_by_proc)
+  for (std::int32_t e = 0; e < shared_edges_by_proc.num_nodes(); ++e)
   {
+    auto ranks = shared_edges_by_proc.links(e);
+    if (ranks.empty())
+      continue;
+
+    // The ranks and neighbors are sorted, so the neighbor indices are
+    // sorted
     std::vector<int> neighbor_set;
-    for (int r : q.second)
+    for (int r : ranks)
       neighbor_set.push_back(proc_to_neighbor[r]);
-    std::sort(neighbor_set.begin(), neighbor_set.end());
-    neighbor_set.erase(std::unique(neighbor_set.begin(), neighbor_set.end()),
-                       neighbor_set.end());
-    shared_edges.insert({q.first, neighbor_set});
+    shared_edges.insert({e, std::move(neighbor_set)});
   }
 
   return {neighbor_comm, std::move(shared_edges)};
 }
 //-----------------------------------------------------------------------------
-void refinement::update_logical_edgefunction(
+refinement::MarkedEdgeExchange::MarkedEdgeExchange(
     const MPI_Comm& neighbor_comm,
     const std::vector<std::vector<std::int32_t>>& marked_for_update,
-    std::vector<bool>& marked_edges, const common::IndexMap& map_e)
+    const common::IndexMap& map_e)
+    : _comm(neighbor_comm), _map_e(map_e)
 {
-  std::vector<std::int32_t> send_offsets = {0};
-  std::vector<std::int64_t> data_to_send;
-  int num_neighbors = marked_for_update.size();
+  const int num_neighbors = marked_for_update.size();
+  _send_sizes.resize(num_neighbors + 1, 0);
+  _recv_sizes.resize(num_neighbors + 1, 0);
   for (int i = 0; i < num_neighbors; ++i)
   {
     for (std::int32_t q : marked_for_update[i])
-      data_to_send.push_back(local_to_global(q, map_e));
-
-    send_offsets.push_back(data_to_send.size());
+      _send_data.push_back(local_to_global(q, map_e));
+    _send_sizes[i] = marked_for_update[i].size();
   }
 
-  // Send all shared edges marked for update and receive from other
-  // processes
-  const std::vector<std::int64_t> data_to_recv
-      = MPI::neighbor_all_to_all(
-            neighbor_comm,
-            graph::AdjacencyList<std::int64_t>(data_to_send, send_offsets))
-            .array();
+  MPI_Ineighbor_alltoall(_send_sizes.data(), 1, MPI_INT, _recv_sizes.data(),
+                         1, MPI_INT, _comm, &_request);
+}
+//-----------------------------------------------------------------------------
+refinement::MarkedEdgeExchange::~MarkedEdgeExchange()
+{
+  int finalized = 0;
+  MPI_Finalized(&finalized);
+  if (finalized)
+    return;
 
-  // Flatten received values and set marked_edges at each index received
-  std::vector<std::int32_t> local_indices(data_to_recv.size());
-  map_e.global_to_local(data_to_recv, local_indices);
+  if (!_data_stage and _request != MPI_REQUEST_NULL)
+  {
+    MPI_Wait(&_request, MPI_STATUS_IGNORE);
+    start_data();
+  }
+  if (_request != MPI_REQUEST_NULL)
+    MPI_Wait(&_request, MPI_STATUS_IGNORE);
+}
+//-----------------------------------------------------------------------------
+void refinement::MarkedEdgeExchange::start_data()
+{
+  _data_stage = true;
+  _send_disp.resize(_send_sizes.size(), 0);
+  std::partial_sum(_send_sizes.begin(), std::prev(_send_sizes.end()),
+                   std::next(_send_disp.begin()));
+  _recv_disp.resize(_recv_sizes.size(), 0);
+  std::partial_sum(_recv_sizes.begin(), std::prev(_recv_sizes.end()),
+                   std::next(_recv_disp.begin()));
+  _recv_data.resize(_recv_disp.back() + 1);
+  _send_data.reserve(_send_data.size() + 1);
+
+  MPI_Ineighbor_alltoallv(_send_data.data(), _send_sizes.data(),
+                          _send_disp.data(), MPI_INT64_T, _recv_data.data(),
+                          _recv_sizes.data(), _recv_disp.data(), MPI_INT64_T,
+                          _comm, &_request);
+}
+//-----------------------------------------------------------------------------
+bool refinement::MarkedEdgeExchange::test()
+{
+  int flag = 1;
+  if (_request != MPI_REQUEST_NULL)
+    MPI_Test(&_request, &flag, MPI_STATUS_IGNORE);
+  if (flag and !_data_stage)
+  {
+    start_data();
+    MPI_Test(&_request, &flag, MPI_STATUS_IGNORE);
+  }
+  return flag;
+}
+//-----------------------------------------------------------------------------
+void refinement::MarkedEdgeExchange::wait(std::vector<bool>& marked_edges)
+{
+  if (!_data_stage)
+  {
+    MPI_Wait(&_request, MPI_STATUS_IGNORE);
+    start_data();
+  }
+  MPI_Wait(&_request, MPI_STATUS_IGNORE);
+
+  // Set marked_edges at each index received
+  const std::size_t num_recv = _recv_disp.back();
+  std::vector<std::int32_t> local_indices(num_recv);
+  _map_e.global_to_local(
+      xtl::span<const std::int64_t>(_recv_data.data(), num_recv),
+      local_indices);
   for (std::int32_t local_index : local_indices)
   {
     assert(local_index != -1);
@@ -189,6 +254,15 @@ void refinement::update_logical_edgefunction(
   }
 }
 //-----------------------------------------------------------------------------
+void refinement::update_logical_edgefunction(
+    const MPI_Comm& neighbor_comm,
+    const std::vector<std::vector<std::int32_t>>& marked_for_update,
+    std::vector<bool>& marked_edges, const common::IndexMap& map_e)
+{
+  MarkedEdgeExchange(neighbor_comm, marked_for_update, map_e)
+      .wait(marked_edges);
+}
+//-----------------------------------------------------------------------------
 std::pair<std::map<std::int32_t, std::int64_t>, xt::xtensor<double, 2>>
 refinement::create_new_vertices(
     const MPI_Comm& neighbor_comm,
@@ -277,6 +351,92 @@ refinement::create_new_vertices(
           std::move(new_vertex_coordinates)};
 }
 //-----------------------------------------------------------------------------
+mesh::Mesh refinement::create_mesh_from_parent(
+    const mesh::Mesh& old_mesh,
+    const graph::AdjacencyList<std::int64_t>& cell_topology,
+    const xt::xtensor<double, 2>& new_vertex_coordinates)
+{
+  MPI_Comm comm = old_mesh.mpi_comm();
+  const int mpi_size = dolfinx::MPI::size(comm);
+  const int mpi_rank = dolfinx::MPI::rank(comm);
+
+  // Get the range of the owned vertices on all processes
+  const std::int32_t num_vertices = new_vertex_coordinates.shape(0);
+  std::vector<std::int32_t> local_sizes(mpi_size);
+  MPI_Allgather(&num_vertices, 1, MPI_INT32_T, local_sizes.data(), 1,
+                MPI_INT32_T, comm);
+  std::vector<std::int64_t> ranges(mpi_size + 1, 0);
+  for (int i = 0; i < mpi_size; ++i)
+    ranges[i + 1] = ranges[i] + local_sizes[i];
+  const std::int64_t offset = ranges[mpi_rank];
+  auto owned = [offset, num_vertices](std::int64_t v)
+  { return v >= offset and v < offset + num_vertices; };
+
+  // The ghost vertices are the vertices of the cells that are owned by
+  // other processes
+  const std::vector<std::int64_t>& cells = cell_topology.array();
+  std::vector<std::int64_t> ghosts;
+  std::copy_if(cells.begin(), cells.end(), std::back_inserter(ghosts),
+               [&owned](auto v) { return !owned(v); });
+  std::sort(ghosts.begin(), ghosts.end());
+  ghosts.erase(std::unique(ghosts.begin(), ghosts.end()), ghosts.end());
+  std::vector<int> ghost_owners(ghosts.size());
+  for (std::size_t i = 0; i < ghosts.size(); ++i)
+  {
+    auto it = std::upper_bound(ranges.begin(), ranges.end(), ghosts[i]);
+    ghost_owners[i] = std::distance(ranges.begin(), it) - 1;
+  }
+
+  auto index_map_v = std::make_shared<common::IndexMap>(
+      comm, num_vertices,
+      dolfinx::MPI::compute_graph_edges(
+          comm, std::set<int>(ghost_owners.begin(), ghost_owners.end())),
+      ghosts, ghost_owners);
+
+  // Cell-vertex connectivity, with the owned vertices followed by the
+  // (sorted) ghosts
+  std::vector<std::int32_t> cells_local(cells.size());
+  std::transform(cells.begin(), cells.end(), cells_local.begin(),
+                 [&](std::int64_t v) -> std::int32_t
+                 {
+                   if (owned(v))
+                     return v - offset;
+                   auto it = std::lower_bound(ghosts.begin(), ghosts.end(), v);
+                   assert(it != ghosts.end() and *it == v);
+                   return num_vertices + std::distance(ghosts.begin(), it);
+                 });
+  auto c_to_v = std::make_shared<graph::AdjacencyList<std::int32_t>>(
+      std::move(cells_local),
+      mesh::num_cell_vertices(old_mesh.topology().cell_type()));
+
+  mesh::Topology topology(comm, old_mesh.topology().cell_type());
+  const int tdim = topology.dim();
+  topology.set_index_map(0, index_map_v);
+  topology.set_connectivity(
+      std::make_shared<graph::AdjacencyList<std::int32_t>>(
+          num_vertices + ghosts.size()),
+      0, 0);
+  topology.set_index_map(tdim, std::make_shared<common::IndexMap>(
+                                   comm, cell_topology.num_nodes()));
+  topology.set_connectivity(c_to_v, tdim, 0);
+
+  // Coordinates of the owned vertices, and of the ghosts from their
+  // owners. The geometry dofmap is the cell-vertex connectivity.
+  const std::size_t gdim = new_vertex_coordinates.shape(1);
+  xt::xtensor<double, 2> x({num_vertices + ghosts.size(), gdim});
+  std::copy(new_vertex_coordinates.cbegin(), new_vertex_coordinates.cend(),
+            x.begin());
+  index_map_v->scatter_fwd(
+      xtl::span<const double>(new_vertex_coordinates.data(),
+                              new_vertex_coordinates.size()),
+      xtl::span<double>(x.data() + num_vertices * gdim, ghosts.size() * gdim),
+      gdim);
+  mesh::Geometry geometry(index_map_v, c_to_v, old_mesh.geometry().cmap(),
+                          std::move(x), index_map_v->global_indices());
+
+  return mesh::Mesh(comm, std::move(topology), std::move(geometry));
+}
+//-----------------------------------------------------------------------------
 std::vector<std::int64_t> refinement::adjust_indices(
     const std::shared_ptr<const common::IndexMap>& index_map, std::int32_t n)
 {
@@ -314,9 +474,13 @@ refinement::partition(const mesh::Mesh& old_mesh,
 
   if (redistribute)
   {
+    // The refined cells are on the ranks of their parents, so only the
+    // load imbalance due to the refinement is migrated
     xt::xtensor<double, 2> new_coords(new_vertex_coordinates);
-    return mesh::create_mesh(old_mesh.mpi_comm(), cell_topology,
-                             old_mesh.geometry().cmap(), new_coords, gm);
+    return mesh::create_mesh(
+        old_mesh.mpi_comm(), cell_topology, old_mesh.geometry().cmap(),
+        new_coords, gm,
+        mesh::create_cell_partitioner(graph::create_diffusion_partitioner()));
   }
 
   auto partitioner = [](MPI_Comm mpi_comm, int, int tdim,
@@ -36,6 +36,78 @@ namespace dolfinx::refinement
 std::pair<MPI_Comm, std::map<std::int32_t, std::vector<int>>>
 compute_edge_sharing(const mesh::Mesh& mesh);
 
+/// Handle to a non-blocking transfer of marked edges between
+/// processes.
+///
+/// The transfer is started when the handle is created, can be
+/// progressed with MarkedEdgeExchange::test while local work is done,
+/// e.g. the enforcement of the refinement rules, and the received
+/// edges are marked by MarkedEdgeExchange::wait. The transfer has two
+/// stages, the number of edges and the edges, and the second stage is
+/// started by MarkedEdgeExchange::test or MarkedEdgeExchange::wait once
+/// the first is complete.
+///
+/// @note The communicator and the IndexMap must remain valid until the
+/// transfer is complete.
+class MarkedEdgeExchange
+{
+public:
+  /// Start the transfer of marked edges
+  /// @note Collective over the neighborhood
+  /// @param[in] neighbor_comm MPI Communicator for neighborhood
+  /// @param[in] marked_for_update Lists of edges to be updated on each
+  /// neighbor
+  /// @param[in] map_e IndexMap for edges
+  MarkedEdgeExchange(
+      const MPI_Comm& neighbor_comm,
+      const std::vector<std::vector<std::int32_t>>& marked_for_update,
+      const common::IndexMap& map_e);
+
+  /// Copy constructor (deleted)
+  MarkedEdgeExchange(const MarkedEdgeExchange& exchange) = delete;
+
+  /// Move constructor (deleted)
+  MarkedEdgeExchange(MarkedEdgeExchange&& exchange) = delete;
+
+  /// Destructor. Waits for the transfer to complete if
+  /// MarkedEdgeExchange::wait has not been called.
+  ~MarkedEdgeExchange();
+
+  /// Assignment operator (deleted)
+  MarkedEdgeExchange& operator=(const MarkedEdgeExchange& exchange)
+      = delete;
+
+  /// Move assignment operator (deleted)
+  MarkedEdgeExchange& operator=(MarkedEdgeExchange&& exchange) = delete;
+
+  /// Progress the transfer, without blocking
+  /// @return True if the edges have been received
+  bool test();
+
+  /// Wait for the transfer to complete and mark the received edges
+  /// @param[in,out] marked_edges Marked edges to be updated
+  void wait(std::vector<bool>& marked_edges);
+
+private:
+  // Start the transfer of the edges once the sizes are received
+  void start_data();
+
+  MPI_Comm _comm;
+  const common::IndexMap& _map_e;
+
+  // Sizes and displacements (send and receive). One is added to the
+  // size to handle the empty case, as OpenMPI fails for null pointers.
+  std::vector<int> _send_sizes, _recv_sizes, _send_disp, _recv_disp;
+
+  // Global indices of the edges (send and receive)
+  std::vector<std::int64_t> _send_data, _recv_data;
+
+  // Request of the current stage, and true if the edges are being
+  // transferred
+  MPI_Request _request = MPI_REQUEST_NULL;
+  bool _data_stage = false;
+};
+
 /// Transfer marked edges between processes.
 /// @param neighbor_comm MPI Communicator for neighborhood
 /// @param marked_for_update Lists of edges to be updates on each
@@ -66,7 +138,9 @@ create_new_vertices(
 /// @param[in] old_mesh
 /// @param[in] cell_topology Topology of cells, (vertex indices)
 /// @param[in] new_vertex_coordinates
-/// @param[in] redistribute Call graph partitioner if true
+/// @param[in] redistribute Re-partition the new mesh if true, using
+/// graph::create_diffusion_partitioner to balance the cells starting
+/// from the distribution of the parent cells
 /// @param[in] ghost_mode None or shared_facet
 /// @return New mesh
 mesh::Mesh partition(const mesh::Mesh& old_mesh,
@@ -74,6 +148,25 @@ mesh::Mesh partition(const mesh::Mesh& old_mesh,
                      const xt::xtensor<double, 2>& new_vertex_coordinates,
                      bool redistribute, mesh::GhostMode ghost_mode);
 
+/// Create the refined mesh directly from the refined cells on the
+/// processes of their parent cells, without partitioning, computing
+/// the dual graph or distributing vertices. The vertex IndexMap
+/// follows from the numbering of the new vertices, which are owned by
+/// the owner of their parent vertex or edge and are numbered
+/// contiguously on each process (see adjust_indices), and the ghost
+/// vertex coordinates are sent by their owners.
+///
+/// @note The parent mesh must not have ghost cells
+/// @param[in] old_mesh The parent mesh
+/// @param[in] cell_topology Topology of the owned cells (global vertex
+/// indices)
+/// @param[in] new_vertex_coordinates Coordinates of the owned vertices
+/// @return New mesh, with the cell-vertex connectivity only
+mesh::Mesh create_mesh_from_parent(
+    const mesh::Mesh& old_mesh,
+    const graph::AdjacencyList<std::int64_t>& cell_topology,
+    const xt::xtensor<double, 2>& new_vertex_coordinates);
+
 /// Adjust indices to account for extra n values on each process This
 /// is a utility to help add new topological vertices on each process
 /// into the space of the index map.
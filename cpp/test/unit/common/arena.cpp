@@ -0,0 +1,81 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+//
+// Unit tests for common::Arena
+
+#include <catch.hpp>
+#include <cstdint>
+#include <dolfinx/common/Arena.h>
+#include <memory_resource>
+#include <numeric>
+#include <vector>
+
+using namespace dolfinx;
+
+namespace
+{
+
+void test_scope()
+{
+  common::Arena arena(1024);
+  {
+    common::ArenaScope scope(arena);
+    std::pmr::vector<std::int64_t> x(100, 1, scope.resource());
+    CHECK(arena.size() >= 800);
+
+    // Nested scope, with an allocation larger than a block
+    {
+      common::ArenaScope inner(arena);
+      std::pmr::vector<double> y(1000, 2.0, inner.resource());
+      CHECK(arena.size() >= 8800);
+      CHECK(std::accumulate(y.begin(), y.end(), 0.0) == 2000.0);
+    }
+    CHECK(arena.size() < 8800);
+    CHECK(std::accumulate(x.begin(), x.end(), std::int64_t(0)) == 100);
+
+    // Alignment
+    void* p = scope.resource()->allocate(8, 256);
+    CHECK(reinterpret_cast<std::uintptr_t>(p) % 256 == 0);
+    CHECK_THROWS(arena.release());
+  }
+  CHECK(arena.size() == 0);
+  CHECK(arena.peak() >= 8800);
+
+  // The blocks are re-used by later scopes
+  const std::size_t capacity = arena.capacity();
+  {
+    common::ArenaScope scope(arena);
+    std::pmr::vector<double> y(1000, 0.0, scope.resource());
+  }
+  CHECK(arena.capacity() == capacity);
+
+  arena.release();
+  CHECK(arena.capacity() == 0);
+}
+
+void test_deallocate()
+{
+  // Deallocation of the most recent allocation returns its memory
+  common::Arena arena;
+  common::ArenaScope scope(arena);
+  std::pmr::memory_resource* r = scope.resource();
+  void* p0 = r->allocate(64);
+  const std::size_t size = arena.size();
+  void* p1 = r->allocate(128);
+  r->deallocate(p1, 128);
+  CHECK(arena.size() == size);
+  CHECK(r->allocate(128) == p1);
+  r->deallocate(p0, 64);
+  CHECK(arena.size() > size);
+}
+
+} // namespace
+
+TEST_CASE("Arena", "[arena]")
+{
+  CHECK_NOTHROW(test_scope());
+  CHECK_NOTHROW(test_deallocate());
+}
@@ -0,0 +1,106 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+//
+// Unit tests for the kernels in common/cpu.h, which are checked
+// against plain loops for the instruction set of the CPU
+
+#include <catch.hpp>
+#include <cstdint>
+#include <dolfinx/common/cpu.h>
+#include <dolfinx/common/math.h>
+#include <random>
+#include <vector>
+
+using namespace dolfinx;
+
+namespace
+{
+
+// Vector length, which is not a multiple of the SIMD width so that
+// the scalar remainder is tested
+constexpr std::size_t n = 37;
+
+template <typename T>
+std::vector<T> create(int seed)
+{
+  std::mt19937 engine(seed);
+  std::uniform_real_distribution<T> dist(-1.0, 1.0);
+  std::vector<T> x(n);
+  for (T& v : x)
+    v = dist(engine);
+  return x;
+}
+
+template <typename T>
+void test_blas1()
+{
+  const std::vector<T> x = create<T>(0), y = create<T>(1);
+  T dot = 0;
+  for (std::size_t i = 0; i < n; ++i)
+    dot += x[i] * y[i];
+  CHECK(cpu::dot(x.data(), y.data(), n) == Approx(dot));
+
+  std::vector<T> r(n);
+  cpu::axpy(r.data(), T(2), x.data(), y.data(), n);
+  for (std::size_t i = 0; i < n; ++i)
+    CHECK(r[i] == Approx(2 * x[i] + y[i]));
+}
+
+void test_gather_scatter(int bs)
+{
+  const std::vector<std::int32_t> idx = {3, 0, 5, 5, 1};
+  std::vector<double> in(6 * bs);
+  for (std::size_t i = 0; i < in.size(); ++i)
+    in[i] = i;
+
+  std::vector<double> buffer(idx.size() * bs);
+  cpu::gather(idx.data(), idx.size(), bs, in.data(), buffer.data());
+  for (std::size_t i = 0; i < idx.size(); ++i)
+    for (int j = 0; j < bs; ++j)
+      CHECK(buffer[i * bs + j] == in[idx[i] * bs + j]);
+
+  // Repeated indices are accumulated
+  std::vector<double> out(in.size(), 1.0);
+  cpu::scatter_add(idx.data(), idx.size(), bs, buffer.data(), out.data());
+  for (int j = 0; j < bs; ++j)
+  {
+    CHECK(out[5 * bs + j] == 1.0 + 2 * in[5 * bs + j]);
+    CHECK(out[2 * bs + j] == 1.0);
+  }
+}
+
+void test_det_inv()
+{
+  constexpr std::size_t m = 3;
+  std::vector<double> A(m * m * n);
+  std::mt19937 engine(2);
+  std::uniform_real_distribution<double> dist(-0.4, 0.4);
+  for (std::size_t c = 0; c < m * m; ++c)
+    for (std::size_t p = 0; p < n; ++p)
+      A[c * n + p] = dist(engine) + (c % (m + 1) == 0 ? 1.0 : 0.0);
+
+  std::vector<double> detA(n), detA1(n), B(m * m * n), B1(m * m * n);
+  cpu::det_batch(m, n, A.data(), detA.data());
+  cpu::pinv_batch(m, m, n, A.data(), B.data());
+  math::det_batch<double>(m, n, A.data(), detA1.data());
+  math::pinv_batch<double>(m, m, n, A.data(), B1.data());
+  for (std::size_t p = 0; p < n; ++p)
+    CHECK(detA[p] == Approx(detA1[p]));
+  for (std::size_t i = 0; i < B.size(); ++i)
+    CHECK(B[i] == Approx(B1[i]));
+}
+
+} // namespace
+
+TEST_CASE("CPU kernels", "[cpu]")
+{
+  INFO("Instruction set: " << cpu::to_string(cpu::detected_isa()));
+  CHECK_NOTHROW(test_blas1<double>());
+  CHECK_NOTHROW(test_blas1<float>());
+  for (int bs = 1; bs <= 4; ++bs)
+    CHECK_NOTHROW(test_gather_scatter(bs));
+  CHECK_NOTHROW(test_det_inv());
+}
@@ -4,11 +4,15 @@
 //
 // SPDX-License-Identifier:    LGPL-3.0-or-later
 
+#include <array>
 #include <catch.hpp>
 #include <dolfinx/common/IndexMap.h>
 #include <dolfinx/common/MPI.h>
+#include <dolfinx/common/Scatterer.h>
+#include <memory>
 #include <numeric>
 #include <set>
+#include <utility>
 #include <vector>
 
 using namespace dolfinx;
@@ -101,8 +105,364 @@ void test_scatter_rev()
   sum = std::accumulate(data_local.begin(), data_local.end(), 0);
   CHECK(sum == 2 * n * value * num_ghosts);
 }
+
+void test_scatterer(int n)
+{
+  const int mpi_size = dolfinx::MPI::size(MPI_COMM_WORLD);
+  const int mpi_rank = dolfinx::MPI::rank(MPI_COMM_WORLD);
+  const int size_local = 100;
+
+  // Create some ghost entries on next process
+  const int num_ghosts = (mpi_size - 1) * 3;
+  std::vector<std::int64_t> ghosts(num_ghosts);
+  for (int i = 0; i < num_ghosts; ++i)
+    ghosts[i] = (mpi_rank + 1) % mpi_size * size_local + i;
+
+  std::vector<int> global_ghost_owner(ghosts.size(), (mpi_rank + 1) % mpi_size);
+
+  // Create an IndexMap
+  auto idx_map = std::make_shared<common::IndexMap>(
+      MPI_COMM_WORLD, size_local,
+      dolfinx::MPI::compute_graph_edges(
+          MPI_COMM_WORLD,
+          std::set<int>(global_ghost_owner.begin(), global_ghost_owner.end())),
+      ghosts, global_ghost_owner);
+
+  // Re-use the scatterer for several updates
+  common::Scatterer<std::int64_t> scatterer(idx_map, n);
+  std::vector<std::int64_t> data_local(n * size_local);
+  std::vector<std::int64_t> data_ghost(n * num_ghosts, -1);
+  for (std::int64_t k = 0; k < 3; ++k)
+  {
+    // Forward scatter of the global index (plus k) of each owned entry
+    const std::int64_t offset = idx_map->local_range()[0];
+    for (int i = 0; i < size_local; ++i)
+      for (int j = 0; j < n; ++j)
+        data_local[n * i + j] = offset + i + k;
+    scatterer.scatter_fwd(xtl::span<const std::int64_t>(data_local),
+                          xtl::span<std::int64_t>(data_ghost));
+    for (int i = 0; i < num_ghosts; ++i)
+      for (int j = 0; j < n; ++j)
+        CHECK(data_ghost[n * i + j] == ghosts[i] + k);
+
+    // Reverse scatter (add) of ones
+    std::fill(data_local.begin(), data_local.end(), 0);
+    std::fill(data_ghost.begin(), data_ghost.end(), 1);
+    scatterer.scatter_rev(xtl::span<std::int64_t>(data_local),
+                          xtl::span<const std::int64_t>(data_ghost),
+                          common::IndexMap::Mode::add);
+    const std::int64_t sum
+        = std::accumulate(data_local.begin(), data_local.end(), 0);
+    CHECK(sum == n * num_ghosts);
+  }
+}
+
+void test_scatterer_shared_memory(int n)
+{
+  const int mpi_size = dolfinx::MPI::size(MPI_COMM_WORLD);
+  const int mpi_rank = dolfinx::MPI::rank(MPI_COMM_WORLD);
+  const int size_local = 100;
+
+  // Ghost the first entries of the next process and the last entries of
+  // the previous process, so that the ghosts are not sorted by owner
+  std::vector<std::int64_t> ghosts;
+  std::vector<int> global_ghost_owner;
+  if (mpi_size > 1)
+  {
+    const int next = (mpi_rank + 1) % mpi_size;
+    const int prev = (mpi_rank + mpi_size - 1) % mpi_size;
+    for (int i = 0; i < 3; ++i)
+    {
+      ghosts.push_back(next * size_local + i);
+      global_ghost_owner.push_back(next);
+    }
+    for (int i = 0; i < 2; ++i)
+    {
+      ghosts.push_back((prev + 1) * size_local - 1 - i);
+      global_ghost_owner.push_back(prev);
+    }
+  }
+  const int num_ghosts = ghosts.size();
+
+  auto idx_map = std::make_shared<common::IndexMap>(
+      MPI_COMM_WORLD, size_local,
+      dolfinx::MPI::compute_graph_edges(
+          MPI_COMM_WORLD,
+          std::set<int>(global_ghost_owner.begin(), global_ghost_owner.end())),
+      ghosts, global_ghost_owner);
+
+  // Scatter with messages only and with shared memory for ranks on the
+  // node, several times to re-use the windows
+  common::Scatterer<std::int64_t> scatterer(idx_map, n);
+  common::Scatterer<std::int64_t> scatterer_shm(idx_map, n);
+  scatterer_shm.enable_shared_memory();
+  CHECK(scatterer_shm.shared_memory());
+  CHECK(!scatterer.shared_memory());
+  const std::int64_t offset = idx_map->local_range()[0];
+  for (std::int64_t k = 0; k < 3; ++k)
+  {
+    std::vector<std::int64_t> data_local(n * size_local);
+    for (int i = 0; i < size_local; ++i)
+      for (int j = 0; j < n; ++j)
+        data_local[n * i + j] = n * (offset + i) + j + k;
+
+    std::vector<std::int64_t> data_ghost(n * num_ghosts, -1);
+    std::vector<std::int64_t> data_ghost_shm(n * num_ghosts, -1);
+    scatterer.scatter_fwd(xtl::span<const std::int64_t>(data_local),
+                          xtl::span<std::int64_t>(data_ghost));
+    scatterer_shm.scatter_fwd(xtl::span<const std::int64_t>(data_local),
+                              xtl::span<std::int64_t>(data_ghost_shm));
+    CHECK(data_ghost_shm == data_ghost);
+    for (int i = 0; i < num_ghosts; ++i)
+      for (int j = 0; j < n; ++j)
+        CHECK(data_ghost_shm[n * i + j] == n * ghosts[i] + j + k);
+
+    // Reverse scatter (add) of the ghost values
+    std::vector<std::int64_t> data_local_shm = data_local;
+    scatterer.scatter_rev(xtl::span<std::int64_t>(data_local),
+                          xtl::span<const std::int64_t>(data_ghost),
+                          common::IndexMap::Mode::add);
+    scatterer_shm.scatter_rev(xtl::span<std::int64_t>(data_local_shm),
+                              xtl::span<const std::int64_t>(data_ghost_shm),
+                              common::IndexMap::Mode::add);
+    CHECK(data_local_shm == data_local);
+  }
+
+  // Custom functions to pack and unpack the buffers, as used for data in
+  // device memory
+  using Scatterer = common::Scatterer<std::int64_t>;
+  int num_calls = 0;
+  auto gather = [&num_calls](auto idx, int bs, auto in, auto out)
+  {
+    ++num_calls;
+    Scatterer::gather(idx, bs, in, out);
+  };
+  auto scatter = [&num_calls](auto idx, int bs, auto in, auto out, auto op)
+  {
+    ++num_calls;
+    Scatterer::scatter(idx, bs, in, out, op);
+  };
+
+  std::vector<std::int64_t> data_local(n * size_local, 1);
+  std::vector<std::int64_t> data_ghost(n * num_ghosts, -1);
+  scatterer.scatter_fwd_begin(xtl::span<const std::int64_t>(data_local),
+                              xtl::span<std::int64_t>(data_ghost), gather);
+  scatterer.scatter_fwd_end(xtl::span<std::int64_t>(data_ghost), gather);
+  CHECK(std::all_of(data_ghost.begin(), data_ghost.end(),
+                    [](auto x) { return x == 1; }));
+  scatterer.scatter_rev_begin(xtl::span<const std::int64_t>(data_ghost),
+                              scatter);
+  scatterer.scatter_rev_end(xtl::span<std::int64_t>(data_local),
+                            common::IndexMap::Mode::add, scatter);
+  const std::int64_t sum
+      = std::accumulate(data_local.begin(), data_local.end(), 0);
+  CHECK(sum == n * (size_local + num_ghosts));
+  if (mpi_size > 1)
+    CHECK(num_calls == (scatterer.owner_sorted() ? 3 : 4));
+}
+
+void test_global_to_local()
+{
+  const int mpi_size = dolfinx::MPI::size(MPI_COMM_WORLD);
+  const int mpi_rank = dolfinx::MPI::rank(MPI_COMM_WORLD);
+  const int size_local = 100;
+
+  // Create some ghost entries on next process, in reverse order
+  const int num_ghosts = (mpi_size - 1) * 3;
+  std::vector<std::int64_t> ghosts(num_ghosts);
+  for (int i = 0; i < num_ghosts; ++i)
+    ghosts[i] = (mpi_rank + 1) % mpi_size * size_local + num_ghosts - 1 - i;
+
+  std::vector<int> global_ghost_owner(ghosts.size(), (mpi_rank + 1) % mpi_size);
+
+  // Create an IndexMap
+  common::IndexMap idx_map(
+      MPI_COMM_WORLD, size_local,
+      dolfinx::MPI::compute_graph_edges(
+          MPI_COMM_WORLD,
+          std::set<int>(global_ghost_owner.begin(), global_ghost_owner.end())),
+      ghosts, global_ghost_owner);
+
+  // Global indices for all local indices, plus one index that is not on
+  // this process (if any)
+  std::vector<std::int64_t> global = idx_map.global_indices();
+  if (mpi_size > 1)
+    global.push_back((mpi_rank + 1) % mpi_size * size_local + size_local - 1);
+
+  std::vector<std::int32_t> local(global.size());
+  idx_map.global_to_local(global, local);
+  for (int i = 0; i < size_local + num_ghosts; ++i)
+    CHECK(local[i] == i);
+  if (mpi_size > 1)
+    CHECK(local.back() == -1);
+}
+
+void test_sharing_ranks()
+{
+  const int mpi_size = dolfinx::MPI::size(MPI_COMM_WORLD);
+  const int mpi_rank = dolfinx::MPI::rank(MPI_COMM_WORLD);
+  const int size_local = 100;
+
+  // Create some ghost entries on next process
+  const int num_ghosts = (mpi_size - 1) * 3;
+  std::vector<std::int64_t> ghosts(num_ghosts);
+  for (int i = 0; i < num_ghosts; ++i)
+    ghosts[i] = (mpi_rank + 1) % mpi_size * size_local + i;
+
+  std::vector<int> global_ghost_owner(ghosts.size(), (mpi_rank + 1) % mpi_size);
+
+  // Create an IndexMap
+  common::IndexMap idx_map(
+      MPI_COMM_WORLD, size_local,
+      dolfinx::MPI::compute_graph_edges(
+          MPI_COMM_WORLD,
+          std::set<int>(global_ghost_owner.begin(), global_ghost_owner.end())),
+      ghosts, global_ghost_owner);
+
+  // The first num_ghosts owned indices are ghosts on the previous
+  // process, and the ghosts are shared with the owner
+  const graph::AdjacencyList<int> ranks = idx_map.compute_sharing_ranks();
+  CHECK(ranks.num_nodes() == size_local + num_ghosts);
+  for (int i = 0; i < size_local + num_ghosts; ++i)
+  {
+    auto links = ranks.links(i);
+    if (i < num_ghosts)
+    {
+      CHECK(links.size() == 1);
+      CHECK(links.front() == (mpi_rank + mpi_size - 1) % mpi_size);
+    }
+    else if (i >= size_local)
+    {
+      CHECK(links.size() == 1);
+      CHECK(links.front() == (mpi_rank + 1) % mpi_size);
+    }
+    else
+      CHECK(links.empty());
+  }
+}
+void test_stack_index_maps()
+{
+  const int mpi_size = dolfinx::MPI::size(MPI_COMM_WORLD);
+  const int mpi_rank = dolfinx::MPI::rank(MPI_COMM_WORLD);
+
+  // Map 0 (block size 2) has ghosts owned by the next rank and map 1
+  // (block size 1) has ghosts owned by the previous rank
+  std::vector<std::shared_ptr<common::IndexMap>> index_maps;
+  const std::array<int, 2> size_local = {100, 50};
+  const std::array<int, 2> owner_rank
+      = {(mpi_rank + 1) % mpi_size, (mpi_rank + mpi_size - 1) % mpi_size};
+  for (int f = 0; f < 2; ++f)
+  {
+    const int num_ghosts = mpi_size > 1 ? 3 + f : 0;
+    std::vector<std::int64_t> ghosts(num_ghosts);
+    for (int i = 0; i < num_ghosts; ++i)
+      ghosts[i] = owner_rank[f] * size_local[f] + 2 * i + f;
+    std::vector<int> ghost_owners(num_ghosts, owner_rank[f]);
+    index_maps.push_back(std::make_shared<common::IndexMap>(
+        MPI_COMM_WORLD, size_local[f],
+        dolfinx::MPI::compute_graph_edges(
+            MPI_COMM_WORLD,
+            std::set<int>(ghost_owners.begin(), ghost_owners.end())),
+        ghosts, ghost_owners));
+  }
+
+  const std::vector<
+      std::pair<std::reference_wrapper<const common::IndexMap>, int>>
+      maps = {{*index_maps[0], 2}, {*index_maps[1], 1}};
+  const auto [offset, local_offset, ghosts_new, owners]
+      = common::stack_index_maps(maps);
+  CHECK(local_offset.back() == 2 * size_local[0] + size_local[1]);
+
+  std::vector<std::int64_t> ghosts;
+  std::vector<int> ghost_owners;
+  for (int f = 0; f < 2; ++f)
+  {
+    ghosts.insert(ghosts.end(), ghosts_new[f].begin(), ghosts_new[f].end());
+    ghost_owners.insert(ghost_owners.end(), owners[f].begin(),
+                        owners[f].end());
+  }
+  common::IndexMap map(MPI_COMM_WORLD, local_offset.back(),
+                       common::stack_dest_ranks(maps), ghosts, ghost_owners);
+  CHECK(map.local_range()[0] == offset);
+  CHECK(map.size_global()
+        == 2 * index_maps[0]->size_global() + index_maps[1]->size_global());
+
+  // The stacked global index of a ghost is the stacked global index of
+  // the owned entry on the owner
+  const std::vector<std::int64_t> global
+      = common::stack_local_to_global(maps, map);
+  auto it = global.begin();
+  for (int f = 0; f < 2; ++f)
+  {
+    const int bs = maps[f].second;
+    const std::int32_t n = bs * index_maps[f]->size_local();
+    const std::int32_t num_ghosts = bs * index_maps[f]->num_ghosts();
+    std::vector<std::int64_t> data_local(it, std::next(it, n));
+    std::vector<std::int64_t> data_ghost(num_ghosts);
+    index_maps[f]->scatter_fwd(xtl::span<const std::int64_t>(data_local),
+                               xtl::span<std::int64_t>(data_ghost), bs);
+    CHECK(std::equal(data_ghost.begin(), data_ghost.end(), std::next(it, n)));
+    std::advance(it, n + num_ghosts);
+  }
+  CHECK(it == global.end());
+}
+
+
+void test_sub_index_map()
+{
+  const int mpi_size = dolfinx::MPI::size(MPI_COMM_WORLD);
+  const int mpi_rank = dolfinx::MPI::rank(MPI_COMM_WORLD);
+  const int size_local = 100;
+
+  // Ghost the first entries of the next rank
+  const int num_ghosts = mpi_size > 1 ? 6 : 0;
+  const int owner = (mpi_rank + 1) % mpi_size;
+  std::vector<std::int64_t> ghosts(num_ghosts);
+  for (int i = 0; i < num_ghosts; ++i)
+    ghosts[i] = owner * size_local + i;
+  std::vector<int> ghost_owners(num_ghosts, owner);
+  common::IndexMap map(
+      MPI_COMM_WORLD, size_local,
+      dolfinx::MPI::compute_graph_edges(
+          MPI_COMM_WORLD,
+          std::set<int>(ghost_owners.begin(), ghost_owners.end())),
+      ghosts, ghost_owners);
+
+  // Keep the even owned indices and all ghosts. Only the even ghosts
+  // are kept on their owner.
+  std::vector<std::int32_t> indices;
+  for (int i = 0; i < size_local; i += 2)
+    indices.push_back(i);
+  for (int i = 0; i < num_ghosts; ++i)
+    indices.push_back(size_local + i);
+  const auto [submap, sub_to_parent]
+      = common::create_sub_index_map(map, indices);
+  CHECK(submap.size_local() == size_local / 2);
+  CHECK(submap.size_global() == mpi_size * size_local / 2);
+  CHECK(submap.num_ghosts() == num_ghosts / 2);
+  for (int i = 0; i < submap.num_ghosts(); ++i)
+  {
+    CHECK(sub_to_parent[size_local / 2 + i] == size_local + 2 * i);
+    CHECK(submap.ghosts()[i] == owner * size_local / 2 + i);
+  }
+
+  // Forward scatter of the global index of each owned entry
+  const std::int64_t offset = submap.local_range()[0];
+  std::vector<std::int64_t> data_local(submap.size_local());
+  std::iota(data_local.begin(), data_local.end(), offset);
+  std::vector<std::int64_t> data_ghost(submap.num_ghosts());
+  submap.scatter_fwd(xtl::span<const std::int64_t>(data_local),
+                     xtl::span<std::int64_t>(data_ghost), 1);
+  CHECK(data_ghost == submap.ghosts());
+}
+
 } // namespace
 
+TEST_CASE("Stack index maps", "[index_map_stack]")
+{
+  CHECK_NOTHROW(test_stack_index_maps());
+}
+
 TEST_CASE("Scatter forward using IndexMap", "[index_map_scatter_fwd]")
 {
   auto n = GENERATE(1, 5, 10);
@@ -113,3 +473,31 @@ TEST_CASE("Scatter reverse using IndexMap", "[index_map_scatter_rev]")
 {
   CHECK_NOTHROW(test_scatter_rev());
 }
+
+TEST_CASE("Scatter using persistent Scatterer", "[index_map_scatterer]")
+{
+  auto n = GENERATE(1, 3);
+  CHECK_NOTHROW(test_scatterer(n));
+}
+
+TEST_CASE("Scatter using shared memory for neighbors on the node",
+          "[index_map_scatterer_shared_memory]")
+{
+  auto n = GENERATE(1, 3);
+  CHECK_NOTHROW(test_scatterer_shared_memory(n));
+}
+
+TEST_CASE("Global to local using IndexMap", "[index_map_global_to_local]")
+{
+  CHECK_NOTHROW(test_global_to_local());
+}
+
+TEST_CASE("Sharing ranks of IndexMap", "[index_map_sharing_ranks]")
+{
+  CHECK_NOTHROW(test_sharing_ranks());
+}
+
+TEST_CASE("Sub index map", "[index_map_sub]")
+{
+  CHECK_NOTHROW(test_sub_index_map());
+}
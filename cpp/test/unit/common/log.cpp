@@ -0,0 +1,140 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+//
+// Unit tests for buffered logging and compile-time elimination of log
+// messages
+
+// log.h defines the glog CHECK macro, which is replaced by the Catch
+// CHECK macro
+#include <dolfinx/common/log.h>
+#undef CHECK
+
+#include <algorithm>
+#include <catch.hpp>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dolfinx;
+
+namespace
+{
+
+// Messages received by a log callback
+struct Messages
+{
+  std::mutex mutex;
+  std::vector<std::string> text;
+
+  std::size_t size()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    return text.size();
+  }
+};
+
+void append(void* user_data, const loguru::Message& message)
+{
+  Messages& messages = *static_cast<Messages*>(user_data);
+  std::lock_guard<std::mutex> lock(messages.mutex);
+  messages.text.push_back(message.message);
+}
+
+void test_buffered_logger()
+{
+  // Write any messages in the buffer of this thread from other tests
+  log::flush_thread_buffer();
+
+  Messages messages;
+  loguru::add_callback("test_buffered_logger", append, &messages,
+                       loguru::Verbosity_1);
+  if (!log::is_enabled(loguru::Verbosity_1))
+  {
+    // Messages are eliminated at compile time
+    loguru::remove_callback("test_buffered_logger");
+    return;
+  }
+
+  // Messages are written to the log when the buffer is flushed
+  LOG_THREAD(1) << "main " << 0;
+  CHECK(messages.size() == 0);
+  log::flush_thread_buffer();
+  CHECK(messages.size() == 1);
+
+  // Threads flush explicitly (even t) or at exit (odd t)
+  constexpr int num_threads = 4;
+  constexpr int num_messages = 10;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t)
+  {
+    threads.emplace_back(
+        [t]()
+        {
+          for (int i = 0; i < num_messages; ++i)
+            LOG_THREAD(1) << "thread " << t << " " << i;
+          if (t % 2 == 0)
+            log::flush_thread_buffer();
+        });
+  }
+  for (auto& t : threads)
+    t.join();
+
+  loguru::remove_callback("test_buffered_logger");
+
+  // The messages of each thread are logged once, in order
+  REQUIRE(messages.text.size() == 1 + num_threads * num_messages);
+  CHECK(messages.text[0] == "main 0");
+  for (int t = 0; t < num_threads; ++t)
+  {
+    auto it = messages.text.begin();
+    for (int i = 0; i < num_messages; ++i)
+    {
+      const std::string m
+          = "thread " + std::to_string(t) + " " + std::to_string(i);
+      CHECK(std::count(messages.text.begin(), messages.text.end(), m) == 1);
+      auto it1 = std::find(messages.text.begin(), messages.text.end(), m);
+      CHECK(it1 >= it);
+      it = it1;
+    }
+  }
+}
+
+void test_compile_time_elimination()
+{
+  // Log all verbosities at run time, including those above
+  // DOLFINX_LOG_MAX_VERBOSITY
+  constexpr int max_verbosity = DOLFINX_LOG_MAX_VERBOSITY;
+  Messages messages;
+  loguru::add_callback("test_compile_time_elimination", append, &messages,
+                       max_verbosity + 1);
+
+  // The stream arguments of messages above DOLFINX_LOG_MAX_VERBOSITY
+  // are not evaluated, and the messages are not logged
+  int num_evaluated = 0;
+  auto count = [&num_evaluated]() { return ++num_evaluated; };
+  VLOG(max_verbosity) << "evaluated " << count();
+  VLOG(max_verbosity + 1) << "eliminated " << count();
+  VLOG_IF(max_verbosity + 1, true) << "eliminated " << count();
+  CHECK(num_evaluated == 1);
+  CHECK(messages.size() == 1);
+  CHECK(log::is_enabled(max_verbosity));
+  CHECK(!log::is_enabled(max_verbosity + 1));
+
+  loguru::remove_callback("test_compile_time_elimination");
+}
+
+} // namespace
+
+TEST_CASE("Buffered logging from threads", "[log]")
+{
+  CHECK_NOTHROW(test_buffered_logger());
+}
+
+TEST_CASE("Compile-time elimination of log messages", "[log]")
+{
+  CHECK_NOTHROW(test_compile_time_elimination());
+}
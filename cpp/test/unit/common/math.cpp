@@ -0,0 +1,152 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+//
+// Unit tests for the batched matrix functions and the dense solver in
+// common/math.h
+
+#include <catch.hpp>
+#include <cmath>
+#include <cstddef>
+#include <dolfinx/common/math.h>
+#include <random>
+#include <vector>
+
+using namespace dolfinx;
+
+namespace
+{
+
+// Row-major m x k matrix with the interface used by math::det and
+// math::inv
+struct Matrix
+{
+  using value_type = double;
+  Matrix(std::size_t m, std::size_t k) : m(m), k(k), a(m * k) {}
+  double& operator()(std::size_t i, std::size_t j) { return a[i * k + j]; }
+  double operator()(std::size_t i, std::size_t j) const { return a[i * k + j]; }
+  std::size_t shape(int i) const { return i == 0 ? m : k; }
+  int dimension() const { return 2; }
+  std::size_t m, k;
+  std::vector<double> a;
+};
+
+// Number of matrices, which is not a multiple of the SIMD width so
+// that the scalar remainder is tested
+constexpr std::size_t n = 13;
+
+// Random matrices that are close to the identity, in the
+// structure-of-arrays layout
+std::vector<double> create(std::size_t m, std::size_t k)
+{
+  std::mt19937 engine(m * 10 + k);
+  std::uniform_real_distribution<double> dist(-0.4, 0.4);
+  std::vector<double> A(m * k * n);
+  for (std::size_t i = 0; i < m; ++i)
+    for (std::size_t j = 0; j < k; ++j)
+      for (std::size_t p = 0; p < n; ++p)
+        A[(i * k + j) * n + p] = dist(engine) + (i == j ? 1.0 : 0.0);
+  return A;
+}
+
+// Matrix p of a batch
+Matrix get(const std::vector<double>& A, std::size_t m, std::size_t k,
+           std::size_t p)
+{
+  Matrix B(m, k);
+  for (std::size_t i = 0; i < m; ++i)
+    for (std::size_t j = 0; j < k; ++j)
+      B(i, j) = A[(i * k + j) * n + p];
+  return B;
+}
+
+void test_square(std::size_t m)
+{
+  const std::vector<double> A = create(m, m);
+  std::vector<double> B(m * m * n), detA(n), detA1(n);
+  math::inv_batch<double>(m, n, A.data(), B.data(), detA.data());
+  math::det_batch<double>(m, n, A.data(), detA1.data());
+  for (std::size_t p = 0; p < n; ++p)
+  {
+    Matrix Ap = get(A, m, m, p);
+    Matrix Bp(m, m);
+    math::inv(Ap, Bp);
+    CHECK(detA[p] == Approx(math::det(Ap)));
+    CHECK(detA1[p] == Approx(math::det(Ap)));
+    for (std::size_t c = 0; c < m * m; ++c)
+      CHECK(B[c * n + p] == Approx(Bp.a[c]));
+  }
+}
+
+void test_rectangular(std::size_t m, std::size_t k)
+{
+  const std::vector<double> A = create(m, k);
+  std::vector<double> B(k * m * n), detA(n);
+  math::pinv_batch<double>(m, k, n, A.data(), B.data(), detA.data());
+  for (std::size_t p = 0; p < n; ++p)
+  {
+    // B A is the identity, and the pseudo-determinant is the square
+    // root of det(A^T A)
+    Matrix Ap = get(A, m, k, p);
+    Matrix Bp = get(B, k, m, p);
+    Matrix ATA(k, k);
+    for (std::size_t i = 0; i < k; ++i)
+    {
+      for (std::size_t j = 0; j < k; ++j)
+      {
+        double BA = 0.0;
+        for (std::size_t l = 0; l < m; ++l)
+        {
+          BA += Bp(i, l) * Ap(l, j);
+          ATA(i, j) += Ap(l, i) * Ap(l, j);
+        }
+        CHECK(BA == Approx(i == j ? 1.0 : 0.0).margin(1e-12));
+      }
+    }
+    CHECK(detA[p] == Approx(std::sqrt(math::det(ATA))));
+  }
+}
+
+void test_lu_solve()
+{
+  // Random matrix with a zero on the diagonal, so that pivoting is
+  // required
+  constexpr std::size_t m = 6, nrhs = 2;
+  std::mt19937 engine(0);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  std::vector<double> A(m * m), X(m * nrhs);
+  for (double& a : A)
+    a = dist(engine);
+  A[0] = 0.0;
+  for (double& x : X)
+    x = dist(engine);
+
+  std::vector<double> B(m * nrhs, 0.0);
+  for (std::size_t i = 0; i < m; ++i)
+    for (std::size_t j = 0; j < nrhs; ++j)
+      for (std::size_t k = 0; k < m; ++k)
+        B[i * nrhs + j] += A[i * m + k] * X[k * nrhs + j];
+
+  CHECK(math::lu_solve<double>(m, nrhs, A.data(), B.data()));
+  for (std::size_t i = 0; i < X.size(); ++i)
+    CHECK(B[i] == Approx(X[i]));
+
+  std::vector<double> S(4, 1.0), b(2, 1.0);
+  CHECK(!math::lu_solve<double>(2, 1, S.data(), b.data()));
+}
+
+} // namespace
+
+TEST_CASE("Batched inverse", "[math]")
+{
+  for (std::size_t m = 1; m <= 3; ++m)
+    CHECK_NOTHROW(test_square(m));
+  CHECK_NOTHROW(test_rectangular(2, 1));
+  CHECK_NOTHROW(test_rectangular(3, 1));
+  CHECK_NOTHROW(test_rectangular(3, 2));
+  CHECK_THROWS(test_square(4));
+}
+
+TEST_CASE("Dense solve", "[math]") { CHECK_NOTHROW(test_lu_solve()); }
@@ -0,0 +1,59 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include <catch.hpp>
+#include <dolfinx/common/MPI.h>
+#include <set>
+#include <vector>
+
+using namespace dolfinx;
+
+namespace
+{
+void test_sparse_exchange()
+{
+  const int mpi_size = dolfinx::MPI::size(MPI_COMM_WORLD);
+  const int mpi_rank = dolfinx::MPI::rank(MPI_COMM_WORLD);
+
+  // Edges to the next two ranks
+  const std::set<int> edges
+      = {(mpi_rank + 1) % mpi_size, (mpi_rank + 2) % mpi_size};
+  const std::vector<int> edges_dense
+      = dolfinx::MPI::compute_graph_edges(MPI_COMM_WORLD, edges);
+  const std::vector<int> edges_sparse
+      = dolfinx::MPI::compute_graph_edges_nbx(MPI_COMM_WORLD, edges);
+  CHECK(edges_dense == edges_sparse);
+
+  // Send rank + p to each rank p
+  std::vector<std::int64_t> data;
+  std::vector<std::int32_t> offsets = {0};
+  for (int p = 0; p < mpi_size; ++p)
+  {
+    for (int j = 0; j < p % 3; ++j)
+      data.push_back(mpi_rank + p);
+    offsets.push_back(data.size());
+  }
+  const graph::AdjacencyList<std::int64_t> send_data(data, offsets);
+  const graph::AdjacencyList<std::int64_t> recv_dense
+      = dolfinx::MPI::all_to_all(MPI_COMM_WORLD, send_data);
+  const graph::AdjacencyList<std::int64_t> recv_sparse
+      = dolfinx::MPI::all_to_all_nbx(MPI_COMM_WORLD, send_data);
+  CHECK(recv_dense.array() == recv_sparse.array());
+  CHECK(recv_dense.offsets() == recv_sparse.offsets());
+  for (int p = 0; p < mpi_size; ++p)
+  {
+    auto links = recv_sparse.links(p);
+    CHECK(links.size() == std::size_t(mpi_rank % 3));
+    for (auto v : links)
+      CHECK(v == p + mpi_rank);
+  }
+}
+} // namespace
+
+TEST_CASE("Sparse (NBX) exchange", "[mpi_sparse_exchange]")
+{
+  CHECK_NOTHROW(test_sparse_exchange());
+}
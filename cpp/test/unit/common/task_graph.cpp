@@ -0,0 +1,128 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+//
+// Unit tests for common::TaskGraph
+
+#include <atomic>
+#include <catch.hpp>
+#include <cstdint>
+#include <dolfinx/common/TaskGraph.h>
+#include <dolfinx/common/ThreadPool.h>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace dolfinx;
+
+namespace
+{
+
+void test_dependencies()
+{
+  int a = 0, b = 0, c = 0;
+  common::TaskGraph graph;
+  const std::size_t t0 = graph.add("", []() {}, {}, {&a});
+  const std::size_t t1 = graph.add("", []() {}, {&a}, {&b});
+  const std::size_t t2 = graph.add("", []() {}, {&a}, {&c});
+  const std::size_t t3 = graph.add("", []() {}, {&b}, {&a});
+  const std::size_t t4 = graph.add("", []() {}, {&c}, {&c});
+  CHECK(graph.size() == 5);
+
+  // Read after write
+  CHECK(graph.dependencies(t0).empty());
+  CHECK(graph.dependencies(t1) == std::vector<std::size_t>{t0});
+  CHECK(graph.dependencies(t2) == std::vector<std::size_t>{t0});
+
+  // Write after read and write after write
+  CHECK(graph.dependencies(t3) == std::vector<std::size_t>{t0, t1, t2});
+  CHECK(graph.dependencies(t4) == std::vector<std::size_t>{t2});
+
+  // Collective tasks are ordered
+  const std::size_t t5 = graph.add("", []() {}, {}, {}, true);
+  const std::size_t t6 = graph.add("", []() {}, {}, {}, true);
+  CHECK(graph.dependencies(t6) == std::vector<std::size_t>{t5});
+
+  CHECK_THROWS(graph.add_dependency(t0, t6));
+}
+
+void test_run()
+{
+  common::ThreadPool pool(4);
+  common::TaskGraph graph;
+
+  // Chains of tasks that each increment a counter, with a collective
+  // task that reads the counters
+  constexpr int num_chains = 8, length = 20;
+  std::vector<std::int64_t> x(num_chains, 0);
+  std::atomic<int> num_collective(0);
+  const std::thread::id main = std::this_thread::get_id();
+  for (int k = 0; k < length; ++k)
+  {
+    for (int c = 0; c < num_chains; ++c)
+    {
+      graph.add(
+          "", [&x, c, k]()
+          { x[c] = x[c] == k ? k + 1 : -1; }, {}, {&x[c]});
+    }
+
+    std::vector<common::TaskGraph::Data> inputs;
+    for (int c = 0; c < num_chains; ++c)
+      inputs.push_back(&x[c]);
+    graph.add(
+        "test",
+        [&, k]()
+        {
+          for (int c = 0; c < num_chains; ++c)
+            CHECK(x[c] == k + 1);
+          CHECK(std::this_thread::get_id() == main);
+          CHECK(num_collective++ == k);
+        },
+        inputs, {}, true);
+  }
+
+  graph.run(pool);
+  CHECK(graph.size() == 0);
+  CHECK(num_collective == length);
+  for (int c = 0; c < num_chains; ++c)
+    CHECK(x[c] == length);
+
+  // Tasks that run nested loops on the pool
+  std::atomic<std::int64_t> sum(0);
+  for (int k = 0; k < 16; ++k)
+  {
+    graph.add(
+        "", [&]()
+        { pool.parallel_for(100, 4, [&](auto i0, auto i1, int)
+                            { sum += i1 - i0; }); },
+        {}, {});
+  }
+  graph.run(pool);
+  CHECK(sum == 1600);
+}
+
+void test_exception()
+{
+  // The tasks that depend on a task that throws are not executed
+  int a = 0;
+  bool executed = false;
+  common::TaskGraph graph;
+  graph.add(
+      "", []() { throw std::runtime_error("task"); }, {}, {&a});
+  graph.add(
+      "", [&]() { executed = true; }, {&a}, {});
+  CHECK_THROWS_AS(graph.run(), std::runtime_error);
+  CHECK(!executed);
+  CHECK(graph.size() == 0);
+}
+
+} // namespace
+
+TEST_CASE("Task graph", "[task_graph]")
+{
+  CHECK_NOTHROW(test_dependencies());
+  CHECK_NOTHROW(test_run());
+  CHECK_NOTHROW(test_exception());
+}
@@ -0,0 +1,102 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+//
+// Unit tests for common::ThreadPool
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <catch.hpp>
+#include <cstdint>
+#include <dolfinx/common/ThreadPool.h>
+#include <dolfinx/common/utils.h>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+using namespace dolfinx;
+
+namespace
+{
+
+void test_parallel_for()
+{
+  common::ThreadPool pool(4);
+  CHECK(pool.size() == 4);
+
+  // Each index is visited once, and the parts are contiguous
+  for (int num_threads : {1, 3, 8})
+  {
+    constexpr std::int64_t n = 1000;
+    std::vector<int> count(n, 0);
+    std::vector<std::array<std::int64_t, 2>> parts(num_threads, {-1, -1});
+    const int num_parts = pool.parallel_for(
+        n, num_threads,
+        [&](std::int64_t i0, std::int64_t i1, int t)
+        {
+          parts[t] = {i0, i1};
+          for (std::int64_t i = i0; i < i1; ++i)
+            ++count[i];
+        });
+    CHECK(num_parts == num_threads);
+    CHECK(std::all_of(count.begin(), count.end(),
+                      [](int c) { return c == 1; }));
+    for (int t = 1; t < num_parts; ++t)
+      CHECK(parts[t][0] == parts[t - 1][1]);
+  }
+
+  // The number of parts is not larger than the size of the range
+  CHECK(pool.parallel_for(2, 4, [](auto, auto, int) {}) == 2);
+}
+
+void test_nested()
+{
+  // Nested loops with more parts than threads complete
+  common::ThreadPool pool(2);
+  std::atomic<std::int64_t> sum(0);
+  pool.parallel_for(8, 8,
+                    [&](std::int64_t i0, std::int64_t i1, int)
+                    {
+                      pool.parallel_for(
+                          100, 4,
+                          [&](std::int64_t j0, std::int64_t j1, int)
+                          { sum += (i1 - i0) * (j1 - j0); });
+                    });
+  CHECK(sum == 800);
+
+  // The loops of the library pool
+  std::vector<std::int64_t> x(10000);
+  common::for_each_part(x.size(), 4,
+                        [&x](std::int64_t i0, std::int64_t i1, int)
+                        { std::iota(x.begin() + i0, x.begin() + i1, i0); });
+  CHECK(std::accumulate(x.begin(), x.end(), std::int64_t(0))
+        == 10000 * 9999 / 2);
+}
+
+void test_exception()
+{
+  // The exception of a part is rethrown after all parts complete
+  common::ThreadPool pool(3);
+  std::atomic<int> num_parts(0);
+  CHECK_THROWS_AS(pool.parallel_for(30, 3,
+                                    [&](std::int64_t, std::int64_t, int t)
+                                    {
+                                      ++num_parts;
+                                      if (t == 1)
+                                        throw std::runtime_error("part");
+                                    }),
+                  std::runtime_error);
+  CHECK(num_parts == 3);
+}
+
+} // namespace
+
+TEST_CASE("Thread pool", "[thread_pool]")
+{
+  CHECK_NOTHROW(test_parallel_for());
+  CHECK_NOTHROW(test_nested());
+  CHECK_NOTHROW(test_exception());
+}
@@ -0,0 +1,104 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+//
+// Unit tests for matrix assembly with recorded insertion positions
+
+#include "p1_forms.h"
+#include <algorithm>
+#include <catch.hpp>
+#include <dolfinx/fem/AssemblyPlan.h>
+#include <dolfinx/fem/DirichletBC.h>
+#include <dolfinx/fem/assembler.h>
+#include <dolfinx/fem/utils.h>
+#include <dolfinx/generation/RectangleMesh.h>
+#include <dolfinx/la/MatrixCSR.h>
+#include <dolfinx/la/SparsityPattern.h>
+#include <vector>
+
+using namespace dolfinx;
+
+namespace
+{
+
+void test_assembly_plan()
+{
+  auto mesh = std::make_shared<mesh::Mesh>(generation::RectangleMesh::create(
+      MPI_COMM_WORLD, {{{0.0, 0.0, 0.0}, {1.0, 1.0, 0.0}}}, {12, 9},
+      mesh::CellType::triangle, mesh::GhostMode::none));
+  auto V = fem::test::create_p1_space(mesh);
+  auto a = fem::test::create_mass_form<double>(V);
+  const std::vector<std::shared_ptr<const fem::DirichletBC<double>>> bcs;
+
+  la::SparsityPattern pattern = fem::create_sparsity_pattern(*a);
+  pattern.assemble();
+
+  // Assemble without a plan
+  la::MatrixCSR<double> A0(pattern);
+  fem::assemble_matrix(la::MatrixCSR<double>::mat_add_values(A0), *a, bcs);
+  A0.finalize();
+  const std::vector<double> values0(A0.values().begin(), A0.values().end());
+
+  // Record, and then replay the insertion positions. The plan can be
+  // used with any matrix with the same sparsity pattern.
+  fem::AssemblyPlan<double> plan;
+  la::MatrixCSR<double> A(pattern);
+  for (int i = 0; i < 3; ++i)
+  {
+    la::MatrixCSR<double>& B = i < 2 ? A : A0;
+    B.set(0.0);
+    fem::assemble_matrix(plan.mat_add_values(*a, B), *a, bcs);
+    plan.finish();
+    B.finalize();
+    CHECK(plan.valid(*a, B));
+    CHECK(std::equal(B.values().begin(), B.values().end(),
+                     values0.begin()));
+  }
+
+  // A different form object requires a new recording
+  auto a1 = fem::test::create_mass_form<double>(V);
+  CHECK(!plan.valid(*a1, A));
+
+  // Element matrix of the first cell, inserted with the rows in a
+  // different order than recorded
+  const int num_cells = mesh->topology().index_map(2)->size_local();
+  if (num_cells > 0)
+  {
+    std::vector<std::int32_t> dofs(V->dofmap()->cell_dofs(0).begin(),
+                                   V->dofmap()->cell_dofs(0).end());
+    std::reverse(dofs.begin(), dofs.end());
+    const std::vector<double> Ae(dofs.size() * dofs.size(), 1.0);
+    auto add = plan.mat_add_values(*a, A);
+    CHECK_THROWS(add(3, dofs.data(), 3, dofs.data(), Ae.data()));
+    CHECK(!plan.valid(*a, A));
+
+    // Record again. An additional insertion after a complete replay
+    // is detected.
+    fem::assemble_matrix(plan.mat_add_values(*a, A), *a, bcs);
+    plan.finish();
+    CHECK(plan.valid(*a, A));
+    auto add1 = plan.mat_add_values(*a, A);
+    fem::assemble_matrix(add1, *a, bcs);
+    CHECK_THROWS(add1(3, dofs.data(), 3, dofs.data(), Ae.data()));
+    CHECK(!plan.valid(*a, A));
+  }
+
+  // Fewer insertions than recorded are detected by finish
+  fem::assemble_matrix(plan.mat_add_values(*a, A), *a, bcs);
+  plan.finish();
+  CHECK(plan.valid(*a, A));
+  plan.mat_add_values(*a, A);
+  if (num_cells > 0)
+    CHECK_THROWS(plan.finish());
+  else
+    CHECK_NOTHROW(plan.finish());
+}
+
+} // namespace
+
+TEST_CASE("Assembly plan", "[assembly_plan]")
+{
+  CHECK_NOTHROW(test_assembly_plan());
+}
@@ -0,0 +1,138 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+//
+// Unit tests for assembly with batched kernels
+
+#include "p1_forms.h"
+#include <catch.hpp>
+#include <cmath>
+#include <dolfinx/fem/DirichletBC.h>
+#include <dolfinx/fem/Function.h>
+#include <dolfinx/fem/assembler.h>
+#include <dolfinx/fem/utils.h>
+#include <dolfinx/generation/RectangleMesh.h>
+#include <dolfinx/la/MatrixCSR.h>
+#include <dolfinx/la/SparsityPattern.h>
+#include <dolfinx/mesh/utils.h>
+#include <functional>
+#include <vector>
+#include <xtensor/xmath.hpp>
+#include <xtensor/xview.hpp>
+
+using namespace dolfinx;
+
+namespace
+{
+
+using kernel_t = std::function<void(double*, const double*, const double*,
+                                    const double*, const int*,
+                                    const std::uint8_t*)>;
+
+// Area of cell k of a batch of size n of linear triangles, with the
+// coordinates interleaved by cell
+double area(const double* x, int n, int k)
+{
+  auto X = [x, n, k](int i) { return x[i * n + k]; };
+  return 0.5
+         * std::abs((X(3) - X(0)) * (X(7) - X(1))
+                    - (X(6) - X(0)) * (X(4) - X(1)));
+}
+
+// Batched P1 mass matrix kernel. Counts the number of calls.
+kernel_t mass_batch(int n, int& num_calls)
+{
+  return [n, &num_calls](double* A, const double*, const double*,
+                         const double* x, const int*, const std::uint8_t*)
+  {
+    ++num_calls;
+    for (int k = 0; k < n; ++k)
+    {
+      const double a = area(x, n, k);
+      for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+          A[(3 * i + j) * n + k] = a * (i == j ? 2.0 : 1.0) / 12.0;
+    }
+  };
+}
+
+// Batched P1 load vector kernel, for a unit source
+kernel_t load_batch(int n)
+{
+  return [n](double* b, const double*, const double*, const double* x,
+             const int*, const std::uint8_t*)
+  {
+    for (int k = 0; k < n; ++k)
+      for (int i = 0; i < 3; ++i)
+        b[i * n + k] = area(x, n, k) / 3.0;
+  };
+}
+
+void test_batch_kernel()
+{
+  auto mesh = std::make_shared<mesh::Mesh>(generation::RectangleMesh::create(
+      MPI_COMM_WORLD, {{{0.0, 0.0, 0.0}, {1.0, 1.0, 0.0}}}, {7, 5},
+      mesh::CellType::triangle, mesh::GhostMode::none));
+  auto V = fem::test::create_p1_space(mesh);
+
+  // Boundary condition on the facets at x = 0
+  mesh->topology_mutable().create_connectivity(1, 2);
+  mesh->topology_mutable().create_connectivity(2, 1);
+  const std::vector<std::int32_t> facets = mesh::locate_entities_boundary(
+      *mesh, 1,
+      [](const xt::xtensor<double, 2>& x) -> xt::xtensor<bool, 1>
+      { return xt::isclose(xt::row(x, 0), 0.0); });
+  auto g = std::make_shared<fem::Function<double>>(V);
+  const std::vector<std::shared_ptr<const fem::DirichletBC<double>>> bcs
+      = {std::make_shared<const fem::DirichletBC<double>>(
+          g, fem::locate_dofs_topological(*V, 1, facets))};
+
+  // Assemble with the per-cell kernels
+  auto a = fem::test::create_mass_form<double>(V);
+  auto L = fem::test::create_load_form<double>(V);
+  la::SparsityPattern pattern = fem::create_sparsity_pattern(*a);
+  pattern.assemble();
+  la::MatrixCSR<double> A0(pattern);
+  fem::assemble_matrix(la::MatrixCSR<double>::mat_add_values(A0), *a, bcs);
+  A0.finalize();
+  std::vector<double> b0(V->dofmap()->index_map->size_local()
+                             + V->dofmap()->index_map->num_ghosts(),
+                         0.0);
+  fem::assemble_vector(xtl::span<double>(b0), *L);
+
+  // Batch sizes for which the final batch is partial (unless the
+  // number of cells is divisible by the batch size), and a batch size
+  // larger than the number of cells, for which the only batch is
+  // partial
+  const int num_cells = a->domains(fem::IntegralType::cell, -1).size();
+  for (int n : {1, 4, 7, num_cells + 3})
+  {
+    int num_calls = 0;
+    auto a_b = fem::test::create_mass_form<double>(V);
+    a_b->set_batch_kernel(fem::IntegralType::cell, -1,
+                          mass_batch(n, num_calls), n);
+    la::MatrixCSR<double> A(pattern);
+    fem::assemble_matrix(la::MatrixCSR<double>::mat_add_values(A), *a_b,
+                         bcs);
+    A.finalize();
+    CHECK(num_calls == (num_cells + n - 1) / n);
+    for (std::size_t i = 0; i < A0.values().size(); ++i)
+      CHECK(A.values()[i] == Approx(A0.values()[i]).margin(1.0e-14));
+
+    auto L_b = fem::test::create_load_form<double>(V);
+    L_b->set_batch_kernel(fem::IntegralType::cell, -1, load_batch(n), n);
+    std::vector<double> b(b0.size(), 0.0);
+    fem::assemble_vector(xtl::span<double>(b), *L_b);
+    for (std::size_t i = 0; i < b0.size(); ++i)
+      CHECK(b[i] == Approx(b0[i]).margin(1.0e-14));
+  }
+}
+
+} // namespace
+
+TEST_CASE("Batched kernels", "[batch_kernel]")
+{
+  CHECK_NOTHROW(test_batch_kernel());
+}
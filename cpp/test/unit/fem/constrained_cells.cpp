@@ -0,0 +1,91 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+//
+// Unit tests for matrix assembly with cells classified by boundary
+// conditions
+
+#include "p1_forms.h"
+#include <catch.hpp>
+#include <dolfinx/fem/ConstrainedCells.h>
+#include <dolfinx/fem/DirichletBC.h>
+#include <dolfinx/fem/Function.h>
+#include <dolfinx/fem/assembler.h>
+#include <dolfinx/fem/utils.h>
+#include <dolfinx/generation/RectangleMesh.h>
+#include <dolfinx/la/MatrixCSR.h>
+#include <dolfinx/la/SparsityPattern.h>
+#include <dolfinx/mesh/utils.h>
+#include <vector>
+#include <xtensor/xmath.hpp>
+#include <xtensor/xview.hpp>
+
+using namespace dolfinx;
+
+namespace
+{
+
+void test_constrained_cells()
+{
+  auto mesh = std::make_shared<mesh::Mesh>(generation::RectangleMesh::create(
+      MPI_COMM_WORLD, {{{0.0, 0.0, 0.0}, {1.0, 1.0, 0.0}}}, {10, 8},
+      mesh::CellType::triangle, mesh::GhostMode::none));
+  auto V = fem::test::create_p1_space(mesh);
+  auto a = fem::test::create_mass_form<double>(V);
+
+  // Boundary condition on the facets at x = 0
+  mesh->topology_mutable().create_connectivity(1, 2);
+  mesh->topology_mutable().create_connectivity(2, 1);
+  const std::vector<std::int32_t> facets = mesh::locate_entities_boundary(
+      *mesh, 1,
+      [](const xt::xtensor<double, 2>& x) -> xt::xtensor<bool, 1>
+      { return xt::isclose(xt::row(x, 0), 0.0); });
+  auto g = std::make_shared<fem::Function<double>>(V);
+  const std::vector<std::shared_ptr<const fem::DirichletBC<double>>> bcs
+      = {std::make_shared<const fem::DirichletBC<double>>(
+          g, fem::locate_dofs_topological(*V, 1, facets))};
+
+  // Each cell is either constrained, with at least one zeroed row and
+  // column, or has no constrained dofs
+  fem::ConstrainedCells<double> cells(*a, bcs);
+  const std::vector<bool>& markers = cells.markers(0);
+  CHECK(cells.unconstrained(-1).size() + cells.constrained(-1).size()
+        == a->domains(fem::IntegralType::cell, -1).size());
+  for (std::size_t j = 0; j < cells.constrained(-1).size(); ++j)
+  {
+    CHECK(cells.zeroed(-1, 0).num_links(j) > 0);
+    CHECK(cells.zeroed(-1, 1).num_links(j) > 0);
+    const std::int32_t c = cells.constrained(-1)[j];
+    for (std::int32_t i : cells.zeroed(-1, 0).links(j))
+      CHECK(markers[V->dofmap()->cell_dofs(c)[i]]);
+  }
+  for (std::int32_t c : cells.unconstrained(-1))
+    for (std::int32_t dof : V->dofmap()->cell_dofs(c))
+      CHECK(!markers[dof]);
+
+  // Assembly with the classified cells is equal to assembly with the
+  // boundary conditions
+  la::SparsityPattern pattern = fem::create_sparsity_pattern(*a);
+  pattern.assemble();
+  la::MatrixCSR<double> A0(pattern), A1(pattern);
+  fem::assemble_matrix(la::MatrixCSR<double>::mat_add_values(A0), *a, bcs);
+  fem::assemble_matrix(la::MatrixCSR<double>::mat_add_values(A1), *a, cells);
+  A0.finalize();
+  A1.finalize();
+  for (std::size_t i = 0; i < A0.values().size(); ++i)
+    CHECK(A1.values()[i] == Approx(A0.values()[i]).margin(1.0e-14));
+
+  // The classification is for the form it was created with
+  auto a1 = fem::test::create_mass_form<double>(V);
+  CHECK_THROWS(fem::assemble_matrix(la::MatrixCSR<double>::mat_add_values(A1),
+                                    *a1, cells));
+}
+
+} // namespace
+
+TEST_CASE("Constrained cells", "[constrained_cells]")
+{
+  CHECK_NOTHROW(test_constrained_cells());
+}
@@ -0,0 +1,100 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+//
+// Unit tests for the interior facet data stored by fem::Form
+
+#include "p1_forms.h"
+#include <catch.hpp>
+#include <dolfinx/fem/Form.h>
+#include <dolfinx/fem/InteriorFacets.h>
+#include <dolfinx/fem/assembler.h>
+#include <dolfinx/fem/utils.h>
+#include <dolfinx/generation/RectangleMesh.h>
+#include <dolfinx/la/MatrixCSR.h>
+#include <dolfinx/la/SparsityPattern.h>
+#include <thread>
+#include <vector>
+
+using namespace dolfinx;
+
+namespace
+{
+
+void test_interior_facets()
+{
+  auto mesh = std::make_shared<mesh::Mesh>(generation::RectangleMesh::create(
+      MPI_COMM_WORLD, {{{0.0, 0.0, 0.0}, {1.0, 1.0, 0.0}}}, {8, 6},
+      mesh::CellType::triangle, mesh::GhostMode::shared_facet));
+  auto V = fem::test::create_p1_space(mesh);
+
+  // Interior facet integral with a constant element matrix
+  using kernel_t = std::function<void(double*, const double*, const double*,
+                                      const double*, const int*,
+                                      const std::uint8_t*)>;
+  const kernel_t kernel
+      = [](double* A, const double*, const double*, const double*,
+           const int*, const std::uint8_t*) { std::fill_n(A, 36, 1.0); };
+  auto a = std::make_shared<fem::Form<double>>(
+      std::vector<std::shared_ptr<const fem::FunctionSpace>>{V, V},
+      std::map<fem::IntegralType,
+               std::pair<std::vector<std::pair<int, kernel_t>>,
+                         const mesh::MeshTags<int>*>>{
+          {fem::IntegralType::interior_facet, {{{-1, kernel}}, nullptr}}},
+      std::vector<std::shared_ptr<const fem::Function<double>>>(),
+      std::vector<std::shared_ptr<const fem::Constant<double>>>(), false);
+
+  // The facet data is packed when the form is created
+  const mesh::Topology& topology = mesh->topology();
+  const fem::InteriorFacets facets0 = fem::pack_interior_facets(
+      topology, a->domains(fem::IntegralType::interior_facet, -1),
+      topology.get_facet_permutations());
+  const fem::InteriorFacets& facets = a->interior_facets(-1);
+  CHECK(facets.cells == facets0.cells);
+  CHECK(facets.local_facets == facets0.local_facets);
+  CHECK(facets.perms == facets0.perms);
+
+  la::SparsityPattern pattern = fem::create_sparsity_pattern(*a);
+  pattern.assemble();
+  la::MatrixCSR<double> A0(pattern);
+  fem::assemble_matrix(la::MatrixCSR<double>::mat_add_values(A0), *a,
+                       std::vector<std::shared_ptr<
+                           const fem::DirichletBC<double>>>());
+
+  // Concurrent access and assembly of the same form
+  constexpr int num_threads = 4;
+  std::vector<la::MatrixCSR<double>> A(num_threads,
+                                       la::MatrixCSR<double>(pattern));
+  std::vector<const fem::InteriorFacets*> ptr(num_threads, nullptr);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t)
+  {
+    threads.emplace_back(
+        [&, t]()
+        {
+          ptr[t] = &a->interior_facets(-1);
+          fem::assemble_matrix(
+              la::MatrixCSR<double>::mat_add_values(A[t]), *a,
+              std::vector<std::shared_ptr<const fem::DirichletBC<double>>>());
+        });
+  }
+  for (auto& t : threads)
+    t.join();
+
+  for (int t = 0; t < num_threads; ++t)
+  {
+    CHECK(ptr[t] == &facets);
+    CHECK(A[t].values().size() == A0.values().size());
+    CHECK(std::equal(A[t].values().begin(), A[t].values().end(),
+                     A0.values().begin()));
+  }
+}
+
+} // namespace
+
+TEST_CASE("Interior facet data", "[interior_facets]")
+{
+  CHECK_NOTHROW(test_interior_facets());
+}
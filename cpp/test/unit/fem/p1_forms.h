@@ -0,0 +1,127 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+//
+// Linear Lagrange space and bilinear forms with hand-written kernels
+// on triangle meshes, for unit tests that do not use generated code
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <dolfinx/fem/DofMap.h>
+#include <dolfinx/fem/ElementDofLayout.h>
+#include <dolfinx/fem/FiniteElement.h>
+#include <dolfinx/fem/Form.h>
+#include <dolfinx/fem/FunctionSpace.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <dolfinx/mesh/Topology.h>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <ufc.h>
+#include <utility>
+#include <vector>
+
+namespace dolfinx::fem::test
+{
+
+/// Create a linear Lagrange space on a triangle mesh. The dofs are the
+/// mesh vertices.
+inline std::shared_ptr<fem::FunctionSpace>
+create_p1_space(std::shared_ptr<const mesh::Mesh> mesh)
+{
+  ufc_finite_element e{};
+  e.signature = "FiniteElement('Lagrange', triangle, 1)";
+  e.cell_shape = triangle;
+  e.element_type = ufc_basix_element;
+  e.topological_dimension = 2;
+  e.space_dimension = 3;
+  e.value_size = 1;
+  e.reference_value_size = 1;
+  e.degree = 1;
+  e.family = "P";
+  e.block_size = 1;
+  auto element = std::make_shared<fem::FiniteElement>(e);
+
+  const std::vector<std::vector<std::set<int>>> entity_dofs
+      = {{{0}, {1}, {2}}, {{}, {}, {}}, {{}}};
+  const std::vector<std::vector<std::set<int>>> entity_closure_dofs
+      = {{{0}, {1}, {2}}, {{1, 2}, {0, 2}, {0, 1}}, {{0, 1, 2}}};
+  auto layout = std::make_shared<fem::ElementDofLayout>(
+      1, entity_dofs, entity_closure_dofs, std::vector<int>(),
+      std::vector<std::shared_ptr<const fem::ElementDofLayout>>());
+
+  const mesh::Topology& topology = mesh->topology();
+  auto dofmap = std::make_shared<fem::DofMap>(
+      layout, topology.index_map(0), 1,
+      *topology.connectivity(topology.dim(), 0), 1);
+  return std::make_shared<fem::FunctionSpace>(mesh, element, dofmap);
+}
+
+/// Element mass matrix of a linear Lagrange triangle
+template <typename T>
+void mass_p1(T* A, const T*, const T*, const double* x, const int*,
+             const std::uint8_t*)
+{
+  const double area = 0.5
+                      * std::abs((x[3] - x[0]) * (x[7] - x[1])
+                                 - (x[6] - x[0]) * (x[4] - x[1]));
+  for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < 3; ++j)
+      A[3 * i + j] = area * (i == j ? 2.0 : 1.0) / 12.0;
+}
+
+/// Element load vector of a linear Lagrange triangle, for a unit source
+template <typename T>
+void load_p1(T* b, const T*, const T*, const double* x, const int*,
+             const std::uint8_t*)
+{
+  const double area = 0.5
+                      * std::abs((x[3] - x[0]) * (x[7] - x[1])
+                                 - (x[6] - x[0]) * (x[4] - x[1]));
+  for (int i = 0; i < 3; ++i)
+    b[i] = area / 3.0;
+}
+
+/// Create the mass matrix form on a linear Lagrange space
+template <typename T>
+std::shared_ptr<fem::Form<T>>
+create_mass_form(std::shared_ptr<const fem::FunctionSpace> V)
+{
+  using kernel_t = std::function<void(T*, const T*, const T*, const double*,
+                                      const int*, const std::uint8_t*)>;
+  const std::map<fem::IntegralType,
+                 std::pair<std::vector<std::pair<int, kernel_t>>,
+                           const mesh::MeshTags<int>*>>
+      integrals
+      = {{fem::IntegralType::cell, {{{-1, kernel_t(mass_p1<T>)}}, nullptr}}};
+  return std::make_shared<fem::Form<T>>(
+      std::vector<std::shared_ptr<const fem::FunctionSpace>>{V, V}, integrals,
+      std::vector<std::shared_ptr<const fem::Function<T>>>(),
+      std::vector<std::shared_ptr<const fem::Constant<T>>>(), false);
+}
+
+/// Create the load vector form, for a unit source, on a linear Lagrange
+/// space
+template <typename T>
+std::shared_ptr<fem::Form<T>>
+create_load_form(std::shared_ptr<const fem::FunctionSpace> V)
+{
+  using kernel_t = std::function<void(T*, const T*, const T*, const double*,
+                                      const int*, const std::uint8_t*)>;
+  const std::map<fem::IntegralType,
+                 std::pair<std::vector<std::pair<int, kernel_t>>,
+                           const mesh::MeshTags<int>*>>
+      integrals
+      = {{fem::IntegralType::cell, {{{-1, kernel_t(load_p1<T>)}}, nullptr}}};
+  return std::make_shared<fem::Form<T>>(
+      std::vector<std::shared_ptr<const fem::FunctionSpace>>{V}, integrals,
+      std::vector<std::shared_ptr<const fem::Function<T>>>(),
+      std::vector<std::shared_ptr<const fem::Constant<T>>>(), false);
+}
+
+} // namespace dolfinx::fem::test
@@ -0,0 +1,65 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+//
+// Unit tests for the basis function tabulation cache
+
+#include <algorithm>
+#include <catch.hpp>
+#include <dolfinx/fem/CoordinateElement.h>
+#include <dolfinx/fem/TabulationCache.h>
+#include <dolfinx/mesh/cell_types.h>
+#include <xtensor/xtensor.hpp>
+
+using namespace dolfinx;
+
+namespace
+{
+
+void test_cached_tables()
+{
+  fem::CoordinateElement cmap(mesh::CellType::triangle, 2);
+  const xt::xtensor<double, 2> X = {{0.1, 0.2}, {0.3, 0.4}, {0.5, 0.25}};
+
+  // A cached table is equal to the tabulated basis, and is returned
+  // again for the same element, points and derivative order
+  fem::TabulationCache cache(2);
+  auto phi0 = cache.tabulate(cmap, 1, X);
+  const xt::xtensor<double, 4> phi = cmap.tabulate(1, X);
+  CHECK(phi0->shape() == phi.shape());
+  CHECK(std::equal(phi0->begin(), phi0->end(), phi.begin()));
+  CHECK(cache.tabulate(cmap, 1, X) == phi0);
+  CHECK(cache.size() == 1);
+
+  // The table depends on the derivative order, element and points
+  auto phi1 = cache.tabulate(cmap, 0, X);
+  CHECK(phi1 != phi0);
+  CHECK(phi1->shape(0) == 1);
+  CHECK(cache.size() == 2);
+
+  // The least recently used table is removed when the cache is full
+  fem::CoordinateElement cmap1(mesh::CellType::triangle, 1);
+  CHECK(cmap1.hash() != cmap.hash());
+  CHECK(cache.tabulate(cmap1, 0, X)->shape(2) == 3);
+  CHECK(cache.size() == 2);
+  CHECK(cache.tabulate(cmap, 0, X) == phi1);
+  CHECK(cache.tabulate(cmap, 1, X) != phi0);
+
+  // Removed tables remain valid
+  CHECK(std::equal(phi0->begin(), phi0->end(), phi.begin()));
+
+  const xt::xtensor<double, 2> Y = {{0.1, 0.2}, {0.3, 0.4}, {0.5, 0.3}};
+  CHECK(cache.tabulate(cmap, 1, Y) != cache.tabulate(cmap, 1, X));
+
+  cache.clear();
+  CHECK(cache.size() == 0);
+}
+
+} // namespace
+
+TEST_CASE("Tabulation cache", "[tabulation_cache]")
+{
+  CHECK_NOTHROW(test_cached_tables());
+}
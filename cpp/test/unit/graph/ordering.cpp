@@ -0,0 +1,131 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+//
+// Unit tests for graph re-ordering
+
+#include <algorithm>
+#include <catch.hpp>
+#include <cstdlib>
+#include <dolfinx/graph/AdjacencyList.h>
+#include <dolfinx/graph/ordering.h>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace dolfinx;
+
+namespace
+{
+
+// Create the graph of the vertices of a triangulated nx x ny grid,
+// with vertex (i, j) numbered map[i * ny + j]
+graph::AdjacencyList<std::int32_t> create_grid(int nx, int ny,
+                                               const std::vector<int>& map)
+{
+  std::vector<std::vector<std::int32_t>> links(nx * ny);
+  auto add_edge = [&links](int a, int b)
+  {
+    links[a].push_back(b);
+    links[b].push_back(a);
+  };
+  for (int i = 0; i < nx; ++i)
+  {
+    for (int j = 0; j < ny; ++j)
+    {
+      const int a = map[i * ny + j];
+      if (i + 1 < nx)
+        add_edge(a, map[(i + 1) * ny + j]);
+      if (j + 1 < ny)
+        add_edge(a, map[i * ny + j + 1]);
+      if (i + 1 < nx and j + 1 < ny)
+        add_edge(a, map[(i + 1) * ny + j + 1]);
+    }
+  }
+  return graph::AdjacencyList<std::int32_t>(links);
+}
+
+// Compute the bandwidth of a graph with re-ordered nodes
+int bandwidth(const graph::AdjacencyList<std::int32_t>& graph,
+              const std::vector<int>& map)
+{
+  int b = 0;
+  for (std::int32_t i = 0; i < graph.num_nodes(); ++i)
+  {
+    for (std::int32_t e : graph.links(i))
+      b = std::max(b, std::abs(map[i] - map[e]));
+  }
+  return b;
+}
+
+// Check that a re-ordering is a permutation
+bool is_permutation(const std::vector<int>& map)
+{
+  std::vector<int> identity(map.size());
+  std::iota(identity.begin(), identity.end(), 0);
+  return std::is_permutation(map.begin(), map.end(), identity.begin());
+}
+
+void test_reorder_grid()
+{
+  constexpr int nx = 30, ny = 50;
+  std::vector<int> map(nx * ny);
+  std::iota(map.begin(), map.end(), 0);
+  std::mt19937 rng(1);
+  std::shuffle(map.begin(), map.end(), rng);
+  const graph::AdjacencyList<std::int32_t> graph = create_grid(nx, ny, map);
+
+  // The orderings of a grid have the bandwidth of the optimal ordering
+  // along the longest direction
+  for (auto reorder : {graph::reorder_rcm, graph::reorder_gps})
+  {
+    const std::vector<int> remap = reorder(graph);
+    CHECK(is_permutation(remap));
+    CHECK(bandwidth(graph, remap) == nx + 1);
+  }
+}
+
+void test_reorder_blocked()
+{
+  // The blocks of a grid with row-wise numbering are sets of rows, and
+  // the re-ordering does not move nodes between blocks
+  constexpr int nx = 40, ny = 20;
+  std::vector<int> map(nx * ny);
+  std::iota(map.begin(), map.end(), 0);
+  const graph::AdjacencyList<std::int32_t> graph = create_grid(nx, ny, map);
+  constexpr int block_size = 5 * ny;
+  const std::vector<int> remap = graph::reorder_blocked_rcm(graph, block_size);
+  CHECK(is_permutation(remap));
+  for (std::size_t i = 0; i < remap.size(); ++i)
+    CHECK(remap[i] / block_size == int(i) / block_size);
+  CHECK(bandwidth(graph, remap) <= 2 * block_size);
+}
+
+void test_reorder_components()
+{
+  // Graph with several connected components and isolated nodes
+  std::vector<std::vector<std::int32_t>> links(10);
+  links[1] = {3};
+  links[3] = {1, 5};
+  links[5] = {3};
+  links[7] = {8};
+  links[8] = {7};
+  const graph::AdjacencyList<std::int32_t> graph(links);
+  for (auto reorder : {graph::reorder_rcm, graph::reorder_gps})
+  {
+    const std::vector<int> remap = reorder(graph);
+    CHECK(is_permutation(remap));
+    CHECK(bandwidth(graph, remap) == 1);
+  }
+}
+
+} // namespace
+
+TEST_CASE("Re-order graph", "[graph_ordering]")
+{
+  CHECK_NOTHROW(test_reorder_grid());
+  CHECK_NOTHROW(test_reorder_blocked());
+  CHECK_NOTHROW(test_reorder_components());
+}
@@ -0,0 +1,144 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+//
+// Unit tests for repeated solves with the SLEPc eigenvalue solver
+
+#ifdef HAS_SLEPC
+
+#include <catch.hpp>
+#include <cmath>
+#include <complex>
+#include <dolfinx/la/SLEPcEigenSolver.h>
+#include <petscksp.h>
+#include <petscmat.h>
+#include <slepceps.h>
+#include <vector>
+
+using namespace dolfinx;
+
+namespace
+{
+
+// Eigenvalues 2 - 2 cos(k pi / (n + 1)), k = 1, ..., n, of the n x n
+// 1D Laplacian tridiag(-1, 2, -1)
+double laplacian_eigenvalue(int n, int k)
+{
+  return 2.0 - 2.0 * std::cos(k * M_PI / (n + 1));
+}
+
+// Create the 1D Laplacian tridiag(-1, 2, -1), on a single process so
+// that a direct solver can be used for the spectral transformation
+Mat create_laplacian(int n)
+{
+  Mat A;
+  MatCreateSeqAIJ(MPI_COMM_SELF, n, n, 3, nullptr, &A);
+  for (PetscInt i = 0; i < n; ++i)
+  {
+    const PetscInt cols[3] = {i - 1, i, i + 1};
+    const PetscScalar vals[3] = {-1.0, 2.0, -1.0};
+    if (i == 0)
+      MatSetValues(A, 1, &i, 2, cols + 1, vals + 1, INSERT_VALUES);
+    else if (i == n - 1)
+      MatSetValues(A, 1, &i, 2, cols, vals, INSERT_VALUES);
+    else
+      MatSetValues(A, 1, &i, 3, cols, vals, INSERT_VALUES);
+  }
+  MatAssemblyBegin(A, MAT_FINAL_ASSEMBLY);
+  MatAssemblyEnd(A, MAT_FINAL_ASSEMBLY);
+  return A;
+}
+
+// Compute the smallest eigenvalues and return the first num_eig of
+// them
+std::vector<double> solve(la::SLEPcEigenSolver& solver, int num_eig)
+{
+  solver.solve(num_eig);
+  REQUIRE(solver.get_number_converged() >= num_eig);
+  std::vector<double> eig;
+  for (int i = 0; i < num_eig; ++i)
+    eig.push_back(solver.get_eigenvalue(i).real());
+  return eig;
+}
+
+void test_repeated_solves()
+{
+  constexpr int n = 40;
+  constexpr int num_eig = 4;
+  Mat A = create_laplacian(n);
+
+  // Shift-and-invert about zero with a direct solver, so that the
+  // factorisation of the spectral transformation can be kept
+  la::SLEPcEigenSolver solver(MPI_COMM_SELF);
+  EPS eps = solver.eps();
+  EPSSetProblemType(eps, EPS_HEP);
+  EPSSetWhichEigenpairs(eps, EPS_TARGET_MAGNITUDE);
+  EPSSetTarget(eps, 0.0);
+  EPSSetTolerances(eps, 1.0e-12, 1000);
+  ST st;
+  EPSGetST(eps, &st);
+  STSetType(st, STSINVERT);
+  KSP ksp;
+  STGetKSP(st, &ksp);
+  KSPSetType(ksp, KSPPREONLY);
+  PC pc;
+  KSPGetPC(ksp, &pc);
+  PCSetType(pc, PCLU);
+
+  solver.set_operators(A, nullptr);
+  solver.set_factorisation_reuse(true);
+  solver.set_warm_start(true);
+
+  // Solves with the kept factorisation and the eigenvectors of the
+  // previous solve as the initial space
+  const std::vector<double> eig0 = solve(solver, num_eig);
+  for (int i = 0; i < num_eig; ++i)
+    CHECK(eig0[i] == Approx(laplacian_eigenvalue(n, i + 1)).epsilon(1e-10));
+  for (int k = 0; k < 2; ++k)
+  {
+    const std::vector<double> eig = solve(solver, num_eig);
+    for (int i = 0; i < num_eig; ++i)
+      CHECK(eig[i] == Approx(eig0[i]).epsilon(1e-10));
+  }
+
+  // Solve with an explicitly set initial space
+  Vec r, c;
+  MatCreateVecs(A, &r, &c);
+  std::vector<Vec> x;
+  for (int i = 0; i < num_eig; ++i)
+  {
+    Vec y;
+    VecDuplicate(r, &y);
+    PetscScalar lr, lc;
+    solver.get_eigenpair(lr, lc, y, c, i);
+    x.push_back(y);
+  }
+  solver.set_initial_space(x);
+  const std::vector<double> eig1 = solve(solver, num_eig);
+  for (int i = 0; i < num_eig; ++i)
+    CHECK(eig1[i] == Approx(eig0[i]).epsilon(1e-10));
+  for (Vec& y : x)
+    VecDestroy(&y);
+  VecDestroy(&r);
+  VecDestroy(&c);
+
+  // The factorisation is recomputed for changed operator values
+  MatScale(A, 2.0);
+  solver.rebuild_factorisation();
+  const std::vector<double> eig2 = solve(solver, num_eig);
+  for (int i = 0; i < num_eig; ++i)
+    CHECK(eig2[i] == Approx(2.0 * eig0[i]).epsilon(1e-10));
+
+  MatDestroy(&A);
+}
+
+} // namespace
+
+TEST_CASE("Eigenvalue solver with kept factorisation", "[la_eigen_solver]")
+{
+  CHECK_NOTHROW(test_repeated_solves());
+}
+
+#endif
@@ -0,0 +1,129 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+//
+// Unit tests for the native Krylov solvers
+
+#include <catch.hpp>
+#include <dolfinx.h>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/la/Vector.h>
+#include <dolfinx/la/krylov.h>
+
+using namespace dolfinx;
+
+namespace
+{
+
+template <typename F>
+void test_krylov(F solve)
+{
+  const int mpi_size = dolfinx::MPI::size(MPI_COMM_WORLD);
+  const int mpi_rank = dolfinx::MPI::rank(MPI_COMM_WORLD);
+  constexpr int size_local = 50;
+
+  // Ghost the neighbouring entries of the 1D chain of indices
+  std::vector<std::int64_t> ghosts;
+  std::vector<int> ghost_owners;
+  if (mpi_rank > 0)
+  {
+    ghosts.push_back(mpi_rank * size_local - 1);
+    ghost_owners.push_back(mpi_rank - 1);
+  }
+  if (mpi_rank < mpi_size - 1)
+  {
+    ghosts.push_back((mpi_rank + 1) * size_local);
+    ghost_owners.push_back(mpi_rank + 1);
+  }
+  const auto index_map = std::make_shared<common::IndexMap>(
+      MPI_COMM_WORLD, size_local,
+      dolfinx::MPI::compute_graph_edges(
+          MPI_COMM_WORLD, std::set<int>(ghost_owners.begin(),
+                                        ghost_owners.end())),
+      ghosts, ghost_owners);
+
+  // Shifted 1D Laplacian, y_i = 3 x_i - x_{i-1} - x_{i+1}
+  const std::int32_t left = mpi_rank > 0 ? size_local : -1;
+  const std::int32_t right
+      = mpi_rank < mpi_size - 1 ? size_local + ghosts.size() - 1 : -1;
+  auto action = [left, right](la::Vector<double>& x, la::Vector<double>& y)
+  {
+    x.scatter_fwd();
+    const std::vector<double>& _x = x.array();
+    std::vector<double>& _y = y.mutable_array();
+    for (std::int32_t i = 0; i < size_local; ++i)
+    {
+      const std::int32_t i0 = i > 0 ? i - 1 : left;
+      const std::int32_t i1 = i < size_local - 1 ? i + 1 : right;
+      _y[i] = 3.0 * _x[i] - (i0 < 0 ? 0.0 : _x[i0])
+              - (i1 < 0 ? 0.0 : _x[i1]);
+    }
+  };
+
+  // Jacobi preconditioner
+  auto precond = [](const la::Vector<double>& r, la::Vector<double>& z)
+  {
+    std::transform(r.array().begin(), r.array().end(),
+                   z.mutable_array().begin(),
+                   [](auto r) { return r / 3.0; });
+  };
+
+  // Right-hand side for the exact solution x = 1
+  la::Vector<double> x(index_map, 1), b(index_map, 1);
+  std::fill(x.mutable_array().begin(), x.mutable_array().end(), 1.0);
+  action(x, b);
+
+  std::fill(x.mutable_array().begin(), x.mutable_array().end(), 0.0);
+  const la::KrylovResult result = solve(x, b, action, precond);
+  CHECK(result.converged);
+  CHECK(result.iterations > 0);
+  for (std::int32_t i = 0; i < size_local; ++i)
+    CHECK(x.array()[i] == Approx(1.0).epsilon(1e-8));
+}
+
+} // namespace
+
+TEST_CASE("Conjugate gradient", "[la_krylov]")
+{
+  test_krylov([](auto& x, auto& b, auto& action, auto& precond)
+              { return la::cg(x, b, action, precond, 200, 1e-10); });
+  test_krylov([](auto& x, auto& b, auto& action, auto&)
+              { return la::cg(x, b, action, 200, 1e-10); });
+}
+
+TEST_CASE("Conjugate gradient with single-precision preconditioner",
+          "[la_krylov]")
+{
+  test_krylov(
+      [](auto& x, auto& b, auto& action, auto&)
+      {
+        // Jacobi preconditioner applied to single-precision vectors
+        la::Vector<float> rf(x.map(), x.bs()), zf(x.map(), x.bs());
+        auto precond
+            = [&rf, &zf](const la::Vector<double>& r, la::Vector<double>& z)
+        {
+          la::copy(rf, r);
+          std::transform(rf.array().begin(), rf.array().end(),
+                         zf.mutable_array().begin(),
+                         [](auto r) { return r / 3.0f; });
+          la::copy(z, zf);
+        };
+        return la::cg(x, b, action, precond, 200, 1e-10);
+      });
+}
+
+TEST_CASE("Pipelined conjugate gradient", "[la_krylov]")
+{
+  test_krylov([](auto& x, auto& b, auto& action, auto& precond)
+              { return la::pipelined_cg(x, b, action, precond, 200, 1e-10); });
+}
+
+TEST_CASE("GMRES", "[la_krylov]")
+{
+  test_krylov([](auto& x, auto& b, auto& action, auto& precond)
+              { return la::gmres(x, b, action, precond, 200, 1e-10, 10); });
+  test_krylov([](auto& x, auto& b, auto& action, auto&)
+              { return la::gmres(x, b, action, 200, 1e-10); });
+}
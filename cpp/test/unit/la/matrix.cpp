@@ -0,0 +1,133 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+//
+// Unit tests for distributed la::MatrixCSR
+
+#include <catch.hpp>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/la/MatrixCSR.h>
+#include <dolfinx/la/SparsityPattern.h>
+#include <dolfinx/la/Vector.h>
+#include <set>
+#include <vector>
+
+using namespace dolfinx;
+
+namespace
+{
+
+// Assemble element matrices of type U into a matrix of type T
+template <typename T, typename U>
+void test_matrix()
+{
+  // Block size
+  auto bs = GENERATE(1, 2);
+
+  const int mpi_size = dolfinx::MPI::size(MPI_COMM_WORLD);
+  const int mpi_rank = dolfinx::MPI::rank(MPI_COMM_WORLD);
+  constexpr int size_local = 100;
+
+  // Create some ghost entries on next process
+  int num_ghosts = (mpi_size - 1) * 3;
+  std::vector<std::int64_t> ghosts(num_ghosts);
+  for (int i = 0; i < num_ghosts; ++i)
+    ghosts[i] = (mpi_rank + 1) % mpi_size * size_local + i;
+
+  const std::vector<int> global_ghost_owner(ghosts.size(),
+                                            (mpi_rank + 1) % mpi_size);
+
+  // Create an IndexMap
+  const auto index_map = std::make_shared<common::IndexMap>(
+      MPI_COMM_WORLD, size_local,
+      dolfinx::MPI::compute_graph_edges(
+          MPI_COMM_WORLD,
+          std::set<int>(global_ghost_owner.begin(), global_ghost_owner.end())),
+      ghosts, global_ghost_owner);
+
+  // 'Elements' connecting consecutive indices. On each process with a
+  // neighbour, the last owned index is connected to the first ghost,
+  // which gives a periodic chain across processes.
+  std::vector<std::array<std::int32_t, 2>> elements;
+  for (std::int32_t i = 0; i < size_local - 1; ++i)
+    elements.push_back({i, i + 1});
+  if (num_ghosts > 0)
+    elements.push_back({size_local - 1, size_local});
+
+  la::SparsityPattern pattern(MPI_COMM_WORLD, {index_map, index_map},
+                              {bs, bs});
+  for (auto& e : elements)
+    pattern.insert(e, e);
+  pattern.assemble();
+
+  la::MatrixCSR<T> A(pattern);
+  CHECK(A.num_nonzeros() == pattern.num_nonzeros() * bs * bs);
+
+  const std::vector<U> Ae(4 * bs * bs, 1.0);
+  auto add = la::MatrixCSR<T>::template mat_add_values<U>(A);
+  for (auto& e : elements)
+    add(2, e.data(), 2, e.data(), Ae.data());
+  A.finalize();
+
+  // Each row of the chain has a diagonal entry equal to the number of
+  // elements sharing the index, and a unit entry for each neighbour
+  const double norm2 = mpi_size > 1 ? 6.0 * mpi_size * size_local
+                                    : 98 * 6.0 + 2 * 2.0;
+  CHECK(A.squared_norm() == Approx(bs * bs * norm2));
+
+  // Check the dense owned rows
+  const std::vector<T> Ad = A.to_dense();
+  const std::size_t ncols = bs * A.column_indices().size();
+  for (int k0 = 0; k0 < bs; ++k0)
+  {
+    CHECK(Ad[(bs * 1 + k0) * ncols + bs * 1] == 2.0);
+    CHECK(Ad[(bs * 1 + k0) * ncols + bs * 2] == 1.0);
+    if (mpi_size > 1)
+      CHECK(Ad[k0 * ncols] == 2.0);
+    else
+      CHECK(Ad[k0 * ncols] == 1.0);
+  }
+
+  // Matrix-vector product, compared with the product of the dense
+  // owned rows
+  la::Vector<T> x(index_map, bs), y(index_map, bs);
+  const std::int64_t offset = index_map->local_range()[0];
+  for (std::int32_t i = 0; i < bs * size_local; ++i)
+    x.mutable_array()[i] = 1 + (bs * offset + i) % 7;
+  for (int num_threads : {1, 3})
+  {
+    A.mult(x, y, num_threads);
+    for (std::int32_t i = 0; i < bs * size_local; ++i)
+    {
+      T yi = 0;
+      for (std::size_t j = 0; j < ncols; ++j)
+      {
+        const std::int64_t col
+            = bs * A.column_indices()[j / bs] + std::int64_t(j % bs);
+        yi += Ad[i * ncols + j] * T(1 + col % 7);
+      }
+      CHECK(y.array()[i] == Approx(yi));
+    }
+  }
+
+  // All ghost row entries have been sent to the owner
+  CHECK(A.cols().size() == A.ghost_row_ptr().back());
+  CHECK(std::all_of(
+      std::next(A.values().begin(), bs * bs * A.ghost_row_ptr().front()),
+      A.values().end(), [](auto x) { return x == 0.0; }));
+}
+
+} // namespace
+
+TEST_CASE("Linear Algebra CSR Matrix", "[la_matrix]")
+{
+  CHECK_NOTHROW((test_matrix<double, double>()));
+}
+
+TEST_CASE("Linear Algebra CSR Matrix, mixed precision", "[la_matrix]")
+{
+  CHECK_NOTHROW((test_matrix<float, float>()));
+  CHECK_NOTHROW((test_matrix<double, float>()));
+}
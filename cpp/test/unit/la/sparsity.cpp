@@ -0,0 +1,95 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+//
+// Unit tests for la::SparsityPattern
+
+#include <catch.hpp>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/graph/AdjacencyList.h>
+#include <dolfinx/la/SparsityPattern.h>
+#include <numeric>
+#include <set>
+#include <vector>
+
+using namespace dolfinx;
+
+namespace
+{
+
+void test_two_pass()
+{
+  const int mpi_size = dolfinx::MPI::size(MPI_COMM_WORLD);
+  const int mpi_rank = dolfinx::MPI::rank(MPI_COMM_WORLD);
+  constexpr int size_local = 100;
+
+  // Create some ghost entries on next process
+  int num_ghosts = (mpi_size - 1) * 3;
+  std::vector<std::int64_t> ghosts(num_ghosts);
+  for (int i = 0; i < num_ghosts; ++i)
+    ghosts[i] = (mpi_rank + 1) % mpi_size * size_local + i;
+
+  const std::vector<int> global_ghost_owner(ghosts.size(),
+                                            (mpi_rank + 1) % mpi_size);
+
+  const auto index_map = std::make_shared<common::IndexMap>(
+      MPI_COMM_WORLD, size_local,
+      dolfinx::MPI::compute_graph_edges(
+          MPI_COMM_WORLD,
+          std::set<int>(global_ghost_owner.begin(), global_ghost_owner.end())),
+      ghosts, global_ghost_owner);
+
+  // 'Elements' connecting three indices, including ghosts, so that
+  // rows receive duplicate entries
+  const std::int32_t size = size_local + num_ghosts;
+  std::vector<std::array<std::int32_t, 3>> elements;
+  for (std::int32_t i = 0; i < size - 2; ++i)
+    elements.push_back({i, i + 1, i + 2});
+
+  la::SparsityPattern p0(MPI_COMM_WORLD, {index_map, index_map}, {1, 1});
+  for (auto& e : elements)
+    p0.insert(e, e);
+  p0.assemble();
+
+  la::SparsityPattern p1(MPI_COMM_WORLD, {index_map, index_map}, {1, 1});
+  p1.count_begin();
+  for (auto& e : elements)
+    p1.insert(e, e);
+  p1.count_end();
+  for (auto& e : elements)
+    p1.insert(e, e);
+  p1.assemble(2);
+
+  CHECK(p0.num_nonzeros() == p1.num_nonzeros());
+  CHECK(p0.diagonal_pattern().array() == p1.diagonal_pattern().array());
+  CHECK(p0.diagonal_pattern().offsets() == p1.diagonal_pattern().offsets());
+  CHECK(p0.off_diagonal_pattern().array()
+        == p1.off_diagonal_pattern().array());
+  CHECK(p0.off_diagonal_pattern().offsets()
+        == p1.off_diagonal_pattern().offsets());
+  CHECK(p0.column_indices() == p1.column_indices());
+
+  // Insertions beyond the counts of the first pass
+  std::vector<std::int32_t> rows(size);
+  std::iota(rows.begin(), rows.end(), 0);
+  la::SparsityPattern p2(MPI_COMM_WORLD, {index_map, index_map}, {1, 1});
+  p2.count_begin();
+  p2.insert_diagonal(rows);
+  p2.count_end();
+  for (auto& e : elements)
+    p2.insert(e, e);
+  p2.insert_diagonal(rows);
+  p2.assemble();
+  CHECK(p0.diagonal_pattern().array() == p2.diagonal_pattern().array());
+  CHECK(p0.off_diagonal_pattern().array()
+        == p2.off_diagonal_pattern().array());
+}
+
+} // namespace
+
+TEST_CASE("Two-pass sparsity pattern", "[la_sparsity]")
+{
+  CHECK_NOTHROW(test_two_pass());
+}
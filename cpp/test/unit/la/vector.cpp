@@ -8,8 +8,11 @@
 
 #include <catch.hpp>
 #include <dolfinx.h>
+#include <dolfinx/common/AlignedAllocator.h>
 #include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/array2d.h>
 #include <dolfinx/la/Vector.h>
+#include <dolfinx/la/VectorPool.h>
 
 using namespace dolfinx;
 
@@ -55,9 +58,206 @@ void test_vector()
   CHECK(v.norm(la::Norm::linf) == static_cast<PetscScalar>(mpi_size - 1));
 }
 
+void test_vector_kernels()
+{
+  const int mpi_size = dolfinx::MPI::size(MPI_COMM_WORLD);
+  const int mpi_rank = dolfinx::MPI::rank(MPI_COMM_WORLD);
+  constexpr int size_local = 101;
+  constexpr int bs = 2;
+  const auto index_map
+      = std::make_shared<common::IndexMap>(MPI_COMM_WORLD, size_local);
+
+  la::Vector<double> x(index_map, bs), y(index_map, bs), w(index_map, bs);
+  std::fill(x.mutable_array().begin(), x.mutable_array().end(), 2.0);
+  std::fill(y.mutable_array().begin(), y.mutable_array().end(), 3.0);
+  const int n = bs * size_local;
+
+  la::axpy(y, 2.0, x);
+  CHECK(std::all_of(y.array().begin(), y.array().end(),
+                    [](auto v) { return v == 7.0; }));
+  la::axpby(y, 1.0, x, -1.0);
+  CHECK(std::all_of(y.array().begin(), y.array().end(),
+                    [](auto v) { return v == -5.0; }));
+  la::waxpy(w, -1.0, x, y);
+  CHECK(std::all_of(w.array().begin(), w.array().end(),
+                    [](auto v) { return v == -7.0; }));
+  la::scale(w, 2.0);
+  CHECK(std::all_of(w.array().begin(), w.array().end(),
+                    [](auto v) { return v == -14.0; }));
+  la::pointwise_mult(w, x, y);
+  CHECK(std::all_of(w.array().begin(), w.array().end(),
+                    [](auto v) { return v == -10.0; }));
+  la::pointwise_divide(w, w, x);
+  CHECK(std::all_of(w.array().begin(), w.array().end(),
+                    [](auto v) { return v == -5.0; }));
+
+  // Linear combination, with the result aliasing one of the vectors
+  la::linear_combination<double>(w, {1.0, 2.0, -1.0}, {&w, &x, &y});
+  CHECK(std::all_of(w.array().begin(), w.array().end(),
+                    [](auto v) { return v == 4.0; }));
+  la::linear_combination<double>(w, {-2.5}, {&x});
+  CHECK(std::all_of(w.array().begin(), w.array().end(),
+                    [](auto v) { return v == -5.0; }));
+
+  // Norms, including the block size
+  CHECK(w.norm(la::Norm::l1) == Approx(5.0 * n * mpi_size));
+  CHECK(w.squared_norm() == Approx(25.0 * n * mpi_size));
+  CHECK(la::inner_product(w, x) == Approx(-10.0 * n * mpi_size));
+
+  // Extrema
+  w.mutable_array()[n - 1] = mpi_rank;
+  CHECK(la::max(w) == mpi_size - 1);
+  CHECK(la::min(w) == -5.0);
+}
+
+void test_vector_reductions()
+{
+  const int mpi_rank = dolfinx::MPI::rank(MPI_COMM_WORLD);
+  constexpr int size_local = 2500;
+  const auto index_map
+      = std::make_shared<common::IndexMap>(MPI_COMM_WORLD, size_local);
+
+  la::Vector<double> x(index_map, 1), y(index_map, 1);
+  std::fill(x.mutable_array().begin(), x.mutable_array().end(), 2.0);
+  std::fill(y.mutable_array().begin(), y.mutable_array().end(), mpi_rank);
+
+  // Blocking and non-blocking versions
+  const std::vector<double> r0 = la::inner_products<double>(
+      {{&x, &y}, {&x, &x}, {&y, &y}});
+  la::Reduction<double> reduction
+      = la::inner_products_begin<double>({{&x, &y}, {&x, &x}, {&y, &y}});
+  const std::vector<double>& r1 = reduction.wait();
+  CHECK(r0 == r1);
+  CHECK(r0.size() == 3);
+  CHECK(r0[0] == Approx(la::inner_product(x, y)));
+  CHECK(r0[1] == Approx(x.squared_norm()));
+  CHECK(r0[2] == Approx(y.squared_norm()));
+  CHECK(reduction.test());
+
+  CHECK(la::inner_products<double>({}).empty());
+}
+
+void test_vector_allocator()
+{
+  const int mpi_size = dolfinx::MPI::size(MPI_COMM_WORLD);
+  const int mpi_rank = dolfinx::MPI::rank(MPI_COMM_WORLD);
+  constexpr int size_local = 37;
+
+  // Ghost the first entries of the next process
+  const int num_ghosts = mpi_size > 1 ? 3 : 0;
+  std::vector<std::int64_t> ghosts(num_ghosts);
+  for (int i = 0; i < num_ghosts; ++i)
+    ghosts[i] = (mpi_rank + 1) % mpi_size * size_local + i;
+  const std::vector<int> global_ghost_owner(ghosts.size(),
+                                            (mpi_rank + 1) % mpi_size);
+  const auto index_map = std::make_shared<common::IndexMap>(
+      MPI_COMM_WORLD, size_local,
+      dolfinx::MPI::compute_graph_edges(
+          MPI_COMM_WORLD,
+          std::set<int>(global_ghost_owner.begin(), global_ghost_owner.end())),
+      ghosts, global_ghost_owner);
+
+  using Allocator = common::AlignedAllocator<double, 64>;
+  la::Vector<double, Allocator> x(index_map, 3);
+  CHECK(reinterpret_cast<std::uintptr_t>(x.array().data()) % 64 == 0);
+  std::fill(x.mutable_array().begin(), x.mutable_array().end(), mpi_rank);
+  x.scatter_fwd();
+  const int ghost_value = (mpi_rank + 1) % mpi_size;
+  CHECK(std::all_of(std::next(x.array().begin(), 3 * size_local),
+                    x.array().end(),
+                    [ghost_value](auto v) { return v == ghost_value; }));
+
+  const la::Vector<double, Allocator> y(x);
+  CHECK(reinterpret_cast<std::uintptr_t>(y.array().data()) % 64 == 0);
+  CHECK(la::inner_product(x, y) == Approx(x.squared_norm()));
+
+  const array2d<double, Allocator> A(5, 3, 1.0, Allocator());
+  CHECK(reinterpret_cast<std::uintptr_t>(A.data()) % 64 == 0);
+}
+
+void test_vector_pool()
+{
+  const int mpi_size = dolfinx::MPI::size(MPI_COMM_WORLD);
+  const int mpi_rank = dolfinx::MPI::rank(MPI_COMM_WORLD);
+  constexpr int size_local = 2000;
+
+  // Ghost the first entries of the next process
+  const int num_ghosts = mpi_size > 1 ? 3 : 0;
+  std::vector<std::int64_t> ghosts(num_ghosts);
+  for (int i = 0; i < num_ghosts; ++i)
+    ghosts[i] = (mpi_rank + 1) % mpi_size * size_local + i;
+  const std::vector<int> global_ghost_owner(ghosts.size(),
+                                            (mpi_rank + 1) % mpi_size);
+  const auto index_map = std::make_shared<common::IndexMap>(
+      MPI_COMM_WORLD, size_local,
+      dolfinx::MPI::compute_graph_edges(
+          MPI_COMM_WORLD,
+          std::set<int>(global_ghost_owner.begin(), global_ghost_owner.end())),
+      ghosts, global_ghost_owner);
+
+  la::VectorPool<double> pool(index_map, 2);
+  const double* data;
+  {
+    std::shared_ptr<la::Vector<double>> x = pool.get();
+    data = x->array().data();
+    CHECK(pool.size() == 0);
+  }
+  CHECK(pool.size() == 1);
+
+  // The released vector is re-used, and vectors in use are distinct
+  auto x = pool.get();
+  auto y = pool.get();
+  CHECK(x->array().data() == data);
+  CHECK(y->array().data() != data);
+  CHECK(y->array().size() == 2 * (size_local + num_ghosts));
+
+  // Ghost updates of vectors that share the scatterer, one at a time
+  std::fill(x->mutable_array().begin(), x->mutable_array().end(), mpi_rank);
+  std::fill(y->mutable_array().begin(), y->mutable_array().end(), 1.0);
+  x->scatter_fwd();
+  y->scatter_fwd();
+  const int ghost_value = (mpi_rank + 1) % mpi_size;
+  CHECK(std::all_of(std::next(x->array().begin(), 2 * size_local),
+                    x->array().end(),
+                    [ghost_value](auto v) { return v == ghost_value; }));
+
+  // Fused update of a pooled vector
+  la::linear_combination<double>(*y, {2.0, 3.0}, {x.get(), y.get()});
+  CHECK(y->array().back() == Approx(2.0 * ghost_value + 3.0));
+
+  // Vectors that outlive the pool are freed when released
+  pool.clear();
+  CHECK(pool.size() == 0);
+  {
+    la::VectorPool<double> tmp(index_map, 1);
+    x = tmp.get();
+  }
+  x.reset();
+}
+
 } // namespace
 
 TEST_CASE("Linear Algebra Vector", "[la_vector]")
 {
   CHECK_NOTHROW(test_vector());
 }
+
+TEST_CASE("Linear Algebra Vector kernels", "[la_vector_kernels]")
+{
+  CHECK_NOTHROW(test_vector_kernels());
+}
+
+TEST_CASE("Linear Algebra Vector reductions", "[la_vector_reductions]")
+{
+  CHECK_NOTHROW(test_vector_reductions());
+}
+
+TEST_CASE("Linear Algebra Vector allocator", "[la_vector_allocator]")
+{
+  CHECK_NOTHROW(test_vector_allocator());
+}
+
+TEST_CASE("Linear Algebra Vector pool", "[la_vector_pool]")
+{
+  CHECK_NOTHROW(test_vector_pool());
+}
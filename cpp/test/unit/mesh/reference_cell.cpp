@@ -0,0 +1,89 @@
+// Copyright (C) 2021 Garth N. Wells
+//
+// This file is part of DOLFINx (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+//
+// Unit tests for the reference cell tables
+
+#include <algorithm>
+#include <basix/cell.h>
+#include <catch.hpp>
+#include <dolfinx/mesh/cell_types.h>
+#include <dolfinx/mesh/reference_cell.h>
+#include <vector>
+
+using namespace dolfinx;
+
+namespace
+{
+
+void test_topology(mesh::CellType type)
+{
+  // The entity vertices are the same as in Basix
+  const mesh::ReferenceCell& ref = mesh::reference_cell(type);
+  const std::vector<std::vector<std::vector<int>>> topology
+      = basix::cell::topology(
+          basix::cell::str_to_type(mesh::to_string(type)));
+  CHECK(ref.dim == mesh::cell_dim(type));
+  for (int d = 0; d <= ref.dim; ++d)
+  {
+    REQUIRE(ref.num_entities[d] == (int)topology[d].size());
+    for (int e = 0; e < ref.num_entities[d]; ++e)
+    {
+      REQUIRE(ref.num_entity_vertices(d, e) == (int)topology[d][e].size());
+      for (std::size_t k = 0; k < topology[d][e].size(); ++k)
+        CHECK(ref.entity_vertices[d][e][k] == topology[d][e][k]);
+    }
+  }
+
+  // The edges of each face are the edges with both vertices on the face
+  if (ref.dim < 2)
+    return;
+  for (int f = 0; f < ref.num_entities[2]; ++f)
+  {
+    const std::vector<int>& fv = topology[2][f];
+    std::vector<int> edges;
+    for (int e = 0; e < ref.num_entities[1]; ++e)
+    {
+      const std::vector<int>& ev = topology[1][e];
+      if (std::count(fv.begin(), fv.end(), ev[0])
+          and std::count(fv.begin(), fv.end(), ev[1]))
+      {
+        edges.push_back(e);
+      }
+    }
+    REQUIRE(edges.size() == (std::size_t)ref.num_face_vertices[f]);
+    for (std::size_t k = 0; k < edges.size(); ++k)
+      CHECK(ref.face_edges[f][k] == edges[k]);
+  }
+}
+
+// Tables are usable in constant expressions
+static_assert(mesh::reference_cell(mesh::CellType::tetrahedron).num_entities[1]
+              == 6);
+static_assert(mesh::reference_cell(mesh::CellType::prism)
+                  .num_entity_vertices(2, 1)
+              == 4);
+
+} // namespace
+
+TEST_CASE("Reference cell tables", "[reference_cell]")
+{
+  for (auto type :
+       {mesh::CellType::point, mesh::CellType::interval,
+        mesh::CellType::triangle, mesh::CellType::quadrilateral,
+        mesh::CellType::tetrahedron, mesh::CellType::pyramid,
+        mesh::CellType::prism, mesh::CellType::hexahedron})
+  {
+    CHECK_NOTHROW(test_topology(type));
+  }
+
+  // Compatibility of the adjacency list interface
+  const graph::AdjacencyList<int> edges
+      = mesh::get_entity_vertices(mesh::CellType::tetrahedron, 1);
+  CHECK(edges.num_nodes() == 6);
+  CHECK(edges.links(0)[0] == 2);
+  CHECK(edges.links(0)[1] == 3);
+  CHECK(mesh::get_sub_entities(mesh::CellType::hexahedron, 2, 1)(5, 3) == 11);
+}
@@ -33,7 +33,7 @@ from .cpp import __version__
 
 from dolfinx.common import (has_debug, has_petsc_complex, has_kahip,
                            has_parmetis, git_commit_hash, TimingType, timing,
-                           list_timings)
+                           list_timings, has_zlib, has_adios2)
 
 import dolfinx.log
 
@@ -9,7 +9,7 @@ import functools
 
 from dolfinx import cpp
 from dolfinx.cpp.common import (git_commit_hash, has_debug, has_kahip,  # noqa
-                                has_parmetis, has_petsc_complex)
+                                has_parmetis, has_petsc_complex, has_zlib, has_adios2)
 
 TimingType = cpp.common.TimingType
 
@@ -22,6 +22,78 @@ def list_timings(mpi_comm, timing_types: list):
     return cpp.common.list_timings(mpi_comm, timing_types)
 
 
+def list_timing_imbalance(mpi_comm, timing_type=TimingType.wall):
+    """List the load imbalance of the timed tasks across ranks (min,
+    mean, max, standard deviation and the slowest ranks)"""
+    cpp.common.list_timing_imbalance(mpi_comm, timing_type)
+
+
+def write_timing_distribution(mpi_comm, filename: str, timing_type=TimingType.wall):
+    """Write the total time of each task on each rank to a CSV file,
+    with one row per task and one column per rank"""
+    cpp.common.write_timing_distribution(mpi_comm, filename, timing_type)
+
+
+def nested_timings() -> str:
+    """Summary of the wall times of tasks by their nesting in other
+    tasks, with rows such as ``NewtonSolver::solve > Assemble``"""
+    return cpp.common.nested_timings()
+
+
+def set_timer_trace(enable: bool):
+    """Enable or disable the recording of timer events for
+    ``write_timer_trace``"""
+    cpp.common.set_timer_trace(enable)
+
+
+def write_timer_trace(mpi_comm, filename: str):
+    """Write the recorded timer events of all ranks to a file in the
+    Chrome trace event format (JSON), with one process per rank"""
+    cpp.common.write_timer_trace(mpi_comm, filename)
+
+
+def set_timer_counters(enable: bool):
+    """Enable or disable the recording of hardware counters (cycles,
+    instructions and last level cache misses) by named timers, which
+    are listed by ``list_timings``"""
+    cpp.common.set_timer_counters(enable)
+
+
+def timer_counters_available() -> bool:
+    """Return True if hardware counters can be recorded by timers"""
+    return cpp.common.timer_counters_available()
+
+
+def set_communication_log(enable: bool):
+    """Enable or disable the recording of communication statistics
+    (neighbors, messages, bytes and wait time) by call site"""
+    cpp.common.set_communication_log(enable)
+
+
+def list_communication(mpi_comm):
+    """List a summary of the communication statistics by call site"""
+    cpp.common.list_communication(mpi_comm)
+
+
+def write_communication(mpi_comm, filename: str):
+    """Write the communication statistics of each rank to a CSV file,
+    with one row per rank and call site"""
+    cpp.common.write_communication(mpi_comm, filename)
+
+
+def list_io(mpi_comm):
+    """List a summary of the I/O statistics (bytes, time and bandwidth)
+    of HDF5Interface, XDMFFile and VTKFile across the ranks, by call
+    site and dataset"""
+    cpp.common.list_io(mpi_comm)
+
+
+def write_io(mpi_comm, filename: str):
+    """Write the I/O statistics of each rank to a CSV file, with one row
+    per rank, call site and dataset"""
+    cpp.common.write_io(mpi_comm, filename)
+
+
 class Timer:
     """A timer can be used for timing tasks. The basic usage is::
 
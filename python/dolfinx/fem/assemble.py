@@ -235,10 +235,10 @@ def _(A: PETSc.Mat,
 @functools.singledispatch
 def assemble_matrix_nest(a: typing.List[typing.List[typing.Union[Form, cpp.fem.Form]]],
                          bcs: typing.List[DirichletBC] = [], mat_types=[],
-                         diagonal: float = 1.0) -> PETSc.Mat:
+                         diagonal: float = 1.0, num_threads: int = 1) -> PETSc.Mat:
     """Assemble bilinear forms into matrix"""
     A = cpp.fem.create_matrix_nest(_create_cpp_form(a), mat_types)
-    assemble_matrix_nest(A, a, bcs, diagonal)
+    assemble_matrix_nest(A, a, bcs, diagonal, num_threads)
     return A
 
 
@@ -246,14 +246,19 @@ def assemble_matrix_nest(a: typing.List[typing.List[typing.Union[Form, cpp.fem.F
 def _(A: PETSc.Mat,
       a: typing.List[typing.List[typing.Union[Form, cpp.fem.Form]]],
       bcs: typing.List[DirichletBC] = [],
-      diagonal: float = 1.0) -> PETSc.Mat:
-    """Assemble bilinear forms into matrix"""
+      diagonal: float = 1.0, num_threads: int = 1) -> PETSc.Mat:
+    """Assemble bilinear forms into matrix. The blocks are assembled in
+    a single traversal of the mesh cells, with the element matrix of
+    each block inserted directly into its sub-matrix."""
     _a = _create_cpp_form(a)
+    cpp.fem.assemble_matrix_nest_petsc(A, _a, bcs, num_threads=num_threads)
     for i, a_row in enumerate(_a):
         for j, a_block in enumerate(a_row):
-            if a_block is not None:
+            if a_block is not None and a_block.function_spaces[0].id == a_block.function_spaces[1].id:
                 Asub = A.getNestSubMatrix(i, j)
-                assemble_matrix(Asub, a_block, bcs)
+                Asub.assemblyBegin(PETSc.Mat.AssemblyType.FLUSH)
+                Asub.assemblyEnd(PETSc.Mat.AssemblyType.FLUSH)
+                cpp.fem.insert_diagonal(Asub, a_block.function_spaces[0], bcs, diagonal)
     return A
 
 
@@ -52,3 +52,9 @@ class DofMap:
     def list(self):
         """ Returns the adjacency list with dof indices for each cell """
         return self._cpp_object.list()
+
+    def compress(self):
+        """Store a compressed copy of the dofmap data, which is used in
+        vector assembly of cell integrals. Returns False if the dofs of
+        a cell span too large a range to be compressed."""
+        return self._cpp_object.compress()
@@ -102,7 +102,7 @@ class Expression:
 
         self._cpp_object = cpp.fem.Expression(coefficients, constants, mesh, x, fn, value_size)
 
-    def eval(self, cells: np.ndarray, u: typing.Optional[np.ndarray] = None) -> np.ndarray:
+    def eval(self, cells: np.ndarray, u: typing.Optional[np.ndarray] = None, num_threads: int = 1) -> np.ndarray:
         """Evaluate Expression in cells.
 
         Parameters
@@ -112,6 +112,8 @@ class Expression:
         u: optional
             array of shape (num_cells, num_points*value_size) to
             store result of expression evaluation.
+        num_threads: optional
+            number of threads used to evaluate the expression.
 
         Returns
         -------
@@ -133,16 +135,38 @@ class Expression:
                 u = np.empty((num_cells, self.num_points * self.value_size), dtype=np.complex128)
             else:
                 u = np.empty((num_cells, self.num_points * self.value_size), dtype=np.float64)
-            self._cpp_object.eval(cells, u)
+            self._cpp_object.eval(cells, u, num_threads)
         else:
             assert u.ndim < 3
             assert u.size == num_cells * self.num_points * self.value_size
             assert u.shape[0] == num_cells
             assert u.shape[1] == self.num_points * self.value_size
-            self._cpp_object.eval(cells, u)
+            self._cpp_object.eval(cells, u, num_threads)
 
         return u
 
+    def eval_chunked(self, cells: np.ndarray, f: typing.Callable[[np.ndarray, np.ndarray], None],
+                     chunk_size: int, num_threads: int = 1) -> None:
+        """Evaluate Expression in chunks of cells.
+
+        Parameters
+        ----------
+        cells
+            local indices of cells to evaluate expression.
+        f
+            function that is called for each chunk as ``f(cells, u)``,
+            where ``u`` has shape (num_cells, num_points*value_size) and
+            holds the values on the cells of the chunk. ``u`` is only
+            valid during the call.
+        chunk_size
+            maximum number of cells in a chunk.
+        num_threads: optional
+            number of threads used to evaluate each chunk.
+        """
+        cells = np.asarray(cells, dtype=np.int32)
+        assert cells.ndim == 1
+        self._cpp_object.eval_chunked(cells, f, chunk_size, num_threads)
+
     @property
     def ufl_expression(self):
         """Return the original UFL Expression"""
@@ -263,14 +287,21 @@ class Function(ufl.Coefficient):
             u = np.reshape(u, (-1, ))
         return u
 
-    def interpolate(self, u) -> None:
-        """Interpolate an expression"""
+    def interpolate(self, u, cells: typing.Optional[np.ndarray] = None, chunk_size: int = 0) -> None:
+        """Interpolate an expression. When interpolating a callable,
+        the interpolation can be restricted to the cells ``cells``, and
+        the cells can be processed in chunks of ``chunk_size`` cells, with
+        the callable evaluated once for each chunk."""
         @singledispatch
         def _interpolate(u):
             try:
                 self._cpp_object.interpolate(u._cpp_object)
             except AttributeError:
-                self._cpp_object.interpolate(u)
+                if cells is None and chunk_size == 0:
+                    self._cpp_object.interpolate(u)
+                else:
+                    _cells = None if cells is None else np.asarray(cells, dtype=np.int32)
+                    self._cpp_object.interpolate(u, _cells, chunk_size)
 
         @_interpolate.register(int)
         def _(u_ptr):
@@ -278,6 +309,12 @@ class Function(ufl.Coefficient):
 
         _interpolate(u)
 
+    def migrate(self, v, cells) -> None:
+        """Copy the degrees-of-freedom of a Function ``v`` on the
+        original mesh of a redistributed mesh, where ``cells`` is the
+        cell map returned by ``dolfinx.mesh.redistribute``"""
+        self._cpp_object.migrate(v._cpp_object, cells)
+
     def compute_point_values(self):
         return self._cpp_object.compute_point_values()
 
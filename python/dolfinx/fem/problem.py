@@ -7,7 +7,7 @@
 
 import typing
 import ufl
-from dolfinx import fem
+from dolfinx import cpp, fem
 from petsc4py import PETSc
 
 
@@ -230,3 +230,31 @@ class NonlinearProblem:
         A.zeroEntries()
         fem.assemble_matrix(A, self._a, self.bcs)
         A.assemble()
+
+    def FJ(self, x: PETSc.Vec, b: PETSc.Vec, A: PETSc.Mat):
+        """Assemble the residual F into the vector b and the Jacobian
+        into the matrix A, with one traversal of the cells for the
+        cell integrals of both forms.
+        Parameters
+        ----------
+        x
+            The vector containing the latest solution
+        b
+            Vector to assemble the residual into
+        A
+            The matrix to assemble the Jacobian into
+        """
+        A.zeroEntries()
+        with b.localForm() as b_local:
+            b_local.set(0.0)
+            cpp.fem.assemble_fused_petsc([A], [self._a._cpp_object], [b_local.array_w],
+                                         [self._L._cpp_object], self.bcs)
+        A.assemblyBegin(PETSc.Mat.AssemblyType.FLUSH)
+        A.assemblyEnd(PETSc.Mat.AssemblyType.FLUSH)
+        cpp.fem.insert_diagonal(A, self._a._cpp_object.function_spaces[0], self.bcs, 1.0)
+        A.assemble()
+
+        # Apply boundary condition
+        fem.apply_lifting(b, [self._a], [self.bcs], [x], -1.0)
+        b.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+        fem.set_bc(b, self.bcs, x, -1.0)
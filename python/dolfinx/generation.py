@@ -14,7 +14,7 @@ from dolfinx import cpp
 
 __all__ = [
     "IntervalMesh", "UnitIntervalMesh", "RectangleMesh", "UnitSquareMesh",
-    "BoxMesh", "UnitCubeMesh"
+    "BoxMesh", "UnitCubeMesh", "BlockRectangleMesh", "BlockBoxMesh"
 ]
 
 
@@ -142,3 +142,50 @@ def UnitCubeMesh(comm, nx, ny, nz, cell_type=cpp.mesh.CellType.tetrahedron,
     """
     return BoxMesh(comm, [numpy.array([0.0, 0.0, 0.0]), numpy.array(
         [1.0, 1.0, 1.0])], [nx, ny, nz], cell_type, ghost_mode, partitioner)
+
+
+def BlockRectangleMesh(comm, points: typing.List[numpy.array], n: list, cell_type=cpp.mesh.CellType.triangle,
+                       diagonal: str = "right"):
+    """Create a rectangle mesh that is distributed by a block
+    decomposition over a Cartesian grid of processes, without graph
+    partitioning. The mesh has no ghost cells.
+
+    Parameters
+    ----------
+    comm
+        MPI communicator
+    points
+        List of `Points` representing vertices
+    n
+        List of number of cells in each direction
+    diagonal
+        Direction of diagonal, "left" or "right"
+
+    """
+    domain = ufl.Mesh(ufl.VectorElement("Lagrange", cpp.mesh.to_string(cell_type), 1))
+    mesh = cpp.generation.create_rectangle_mesh_block(comm, points, n, cell_type, diagonal)
+    domain._ufl_cargo = mesh
+    mesh._ufl_domain = domain
+    return mesh
+
+
+def BlockBoxMesh(comm, points: typing.List[numpy.array], n: list, cell_type=cpp.mesh.CellType.tetrahedron):
+    """Create a box mesh that is distributed by a block decomposition
+    over a Cartesian grid of processes, without graph partitioning. The
+    mesh has no ghost cells.
+
+    Parameters
+    ----------
+    comm
+        MPI communicator
+    points
+        List of points representing vertices
+    n
+        List of cells in each direction
+
+    """
+    domain = ufl.Mesh(ufl.VectorElement("Lagrange", cpp.mesh.to_string(cell_type), 1))
+    mesh = cpp.generation.create_box_mesh_block(comm, points, n, cell_type)
+    domain._ufl_cargo = mesh
+    mesh._ufl_domain = domain
+    return mesh
@@ -4,6 +4,8 @@
 #
 # SPDX-License-Identifier:    LGPL-3.0-or-later
 
-from dolfinx.cpp.geometry import (BoundingBoxTree, create_midpoint_tree, compute_closest_entity,  # noqa
+from dolfinx.cpp.geometry import (BoundingBoxTree, BuildStrategy, create_midpoint_tree, compute_closest_entity,  # noqa
                                   compute_collisions_point, compute_collisions, compute_distance_gjk,
-                                  squared_distance, select_colliding_cells)
+                                  compute_colliding_cells, squared_distance, select_colliding_cells,
+                                  compute_closest_entities, compute_distributed_collisions, locate_cells,
+                                  PointOwnership)
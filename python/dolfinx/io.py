@@ -40,31 +40,91 @@ class VTKFile(cpp.io.VTKFile):
 
 
 class XDMFFile(cpp.io.XDMFFile):
-    def write_function(self, u, t=0.0, mesh_xpath="/Xdmf/Domain/Grid[@GridType='Uniform'][1]"):
+    def write_function(self, u, t=0.0, mesh_xpath="/Xdmf/Domain/Grid[@GridType='Uniform'][1]", geometry_xpath=""):
         u_cpp = getattr(u, "_cpp_object", u)
-        super().write_function(u_cpp, t, mesh_xpath)
+        super().write_function(u_cpp, t, mesh_xpath, geometry_xpath)
+
+    def write_checkpoint(self, u, name):
+        """Write the degrees-of-freedom of a Function in their native
+        layout, for restarting a computation"""
+        super().write_checkpoint(getattr(u, "_cpp_object", u), name)
+
+    def read_checkpoint(self, u, name):
+        """Read the degrees-of-freedom of a Function that were written
+        with write_checkpoint"""
+        super().read_checkpoint(getattr(u, "_cpp_object", u), name)
 
     def read_mesh(self, ghost_mode=cpp.mesh.GhostMode.shared_facet, name="mesh", xpath="/Xdmf/Domain"):
-        # Read mesh data from file
+        # Read mesh data from file and build the mesh. A cell partition
+        # saved with the mesh is used when it is for the same number of
+        # processes.
         cell_shape, cell_degree = super().read_cell_type(name, xpath)
-        cells = super().read_topology_data(name, xpath)
-        x = super().read_geometry_data(name, xpath)
+        cmap = cpp.fem.CoordinateElement(cell_shape, cell_degree)
+        mesh = super().read_mesh(cmap, ghost_mode, name, xpath)
 
         # Construct the geometry map
-        cell = ufl.Cell(cpp.mesh.to_string(cell_shape), geometric_dimension=x.shape[1])
+        cell = ufl.Cell(cpp.mesh.to_string(cell_shape), geometric_dimension=mesh.geometry.dim)
         domain = ufl.Mesh(ufl.VectorElement("Lagrange", cell, cell_degree))
-
-        # Build the mesh
-        cmap = cpp.fem.CoordinateElement(cell_shape, cell_degree)
-        mesh = cpp.mesh.create_mesh(self.comm(), cpp.graph.AdjacencyList_int64(cells),
-                                    cmap, x, ghost_mode, cpp.mesh.partition_cells_graph)
-        mesh.name = name
         domain._ufl_cargo = mesh
         mesh._ufl_domain = domain
 
         return mesh
 
 
+class AsyncWriter(cpp.io.AsyncWriter):
+    """Write output in a background thread. The Functions are copied
+    when a write is queued, and the writes are performed in order by an
+    I/O thread. Call wait() before using the files directly.
+
+    """
+
+    def write_function(self, file, u, t: float = 0.0, mesh_xpath="/Xdmf/Domain/Grid[@GridType='Uniform'][1]") -> None:
+        """Queue the write of a Function to an XDMFFile, or of a
+        Function or list of Functions to a VTKFile"""
+        if isinstance(file, cpp.io.VTKFile):
+            u = u if isinstance(u, list) else [u]
+            super().write_function(file, [getattr(u_, "_cpp_object", u_) for u_ in u], t)
+        else:
+            super().write_function(file, getattr(u, "_cpp_object", u), t, mesh_xpath)
+
+
+def write_mesh_cache(mesh: cpp.mesh.Mesh, filename: str) -> None:
+    """Write a binary cache of a distributed mesh, with its computed
+    entities and connectivities, for reading with read_mesh_cache on
+    the same number of processes"""
+    cpp.io.write_mesh_cache(mesh, filename)
+
+
+def read_mesh_cache(comm, filename: str) -> cpp.mesh.Mesh:
+    """Read a mesh that was written with write_mesh_cache. The file is
+    mapped into memory, and the mesh is constructed without parsing or
+    partitioning."""
+    mesh = cpp.io.read_mesh_cache(comm, filename)
+
+    # Construct the geometry map
+    cmap = mesh.geometry.cmap
+    cell = ufl.Cell(cpp.mesh.to_string(mesh.topology.cell_type), geometric_dimension=mesh.geometry.dim)
+    domain = ufl.Mesh(ufl.VectorElement("Lagrange", cell, cmap.degree))
+    domain._ufl_cargo = mesh
+    mesh._ufl_domain = domain
+
+    return mesh
+
+
+if cpp.common.has_adios2:
+    class ADIOS2Writer(cpp.io.ADIOS2Writer):
+        """Output of meshes and functions with ADIOS2, to BP files
+        (engine "BP4" or "BP5") or to a staging engine ("SST"). Each
+        write is one ADIOS2 step.
+
+        """
+
+        def write_function(self, u, t: float = 0.0) -> None:
+            """Write the degrees-of-freedom of a Function for a given
+            time (default 0.0)"""
+            super().write_function(getattr(u, "_cpp_object", u), t)
+
+
 def extract_gmsh_topology_and_markers(gmsh_model, model_name=None):
     """Extract all entities tagged with a physical marker
     in the gmsh model, and collects the data per cell type.
@@ -5,11 +5,14 @@
 # SPDX-License-Identifier:    LGPL-3.0-or-later
 """Just-in-time (JIT) compilation using FFCx."""
 
+import argparse
+import concurrent.futures
 import functools
 import json
+import multiprocessing
 import os
 from pathlib import Path
-from typing import Optional
+from typing import List, Optional
 
 from mpi4py import MPI
 
@@ -17,9 +20,10 @@ import dolfinx.pkgconfig
 import ffcx
 import ffcx.codegeneration.jit
 import ufl
+import ufl.algorithms
 from dolfinx import common
 
-__all__ = ["ffcx_jit", "get_parameters"]
+__all__ = ["ffcx_jit", "ffcx_jit_many", "get_parameters", "prewarm"]
 
 if dolfinx.pkgconfig.exists("dolfinx"):
     dolfinx_pc = dolfinx.pkgconfig.parse("dolfinx")
@@ -28,7 +32,8 @@ else:
 
 DOLFINX_DEFAULT_JIT_PARAMETERS = {
     "cache_dir":
-        (Path.joinpath(Path.home(), ".cache", "fenics"), "Path for storing DOLFINx JIT cache"),
+        (os.getenv("DOLFINX_JIT_CACHE_DIR", Path.joinpath(Path.home(), ".cache", "fenics")),
+         "Path for storing DOLFINx JIT cache (default from $DOLFINX_JIT_CACHE_DIR)"),
     "cffi_debug":
         (False, "CFFI debug mode"),
     "cffi_extra_compile_args":
@@ -224,3 +229,134 @@ def ffcx_jit(ufl_object, form_compiler_parameters={}, jit_parameters={}):
         raise TypeError(type(ufl_object))
 
     return (r[0][0], r[1], r[2])
+
+
+def ffcx_jit_many(comm, ufl_objects: List, form_compiler_parameters={}, jit_parameters={}):
+    """Compile independent UFL objects concurrently with FFCx and CFFI.
+
+    In a parallel run, the objects that are not in the cache are
+    compiled concurrently by the processes of the communicator, in a
+    round-robin distribution. When all compilations are done, each
+    process loads all objects from the cache. The cache directory
+    (`cache_dir`, see `ffcx_jit`) must be shared by the processes, e.g.
+    on a parallel file system. The cache is safe for concurrent use,
+    and a module is only loaded by other processes once it has been
+    completely built.
+
+    Parameters
+    ----------
+      comm:
+        MPI communicator
+      ufl_objects:
+        Objects to compile, see `ffcx_jit`
+      form_compiler_parameters:
+        Parameters used in FFCx compilation, see `ffcx_jit`
+      jit_parameters:
+        Parameters used in CFFI JIT compilation, see `ffcx_jit`
+
+    Returns
+    -------
+      List of (compiled object, module, (header code, implementation code))
+
+    """
+    local_jit = ffcx_jit.__wrapped__
+    status, error_msg = 0, ""
+    for i in range(comm.rank, len(ufl_objects), comm.size):
+        try:
+            local_jit(ufl_objects[i], form_compiler_parameters, jit_parameters)
+        except Exception as e:
+            status = 1
+            error_msg = str(e)
+
+    # Fail simultaneously on all processes, to allow catching the error
+    # without deadlock
+    if comm.allreduce(status, op=MPI.MAX) != 0:
+        if status == 0:
+            error_msg = "Compilation failed on another process."
+        raise RuntimeError("Failed just-in-time compilation: {}".format(error_msg))
+
+    return [local_jit(o, form_compiler_parameters, jit_parameters) for o in ufl_objects]
+
+
+def _load_ufl_objects(filename):
+    """Load the forms, elements and expressions of a UFL file."""
+    ufd = ufl.algorithms.load_ufl_file(str(filename))
+    return ufd.forms + ufd.elements + ufd.expressions
+
+
+def _prewarm_object(filename, index, form_compiler_parameters, jit_parameters):
+    """Compile an object of a UFL file (in a worker process)."""
+    ffcx_jit.__wrapped__(_load_ufl_objects(filename)[index], form_compiler_parameters, jit_parameters)
+
+
+def prewarm(comm, filenames: List, num_workers: int = 1, form_compiler_parameters={}, jit_parameters={}) -> int:
+    """Compile the forms, elements and expressions of UFL files into
+    the JIT cache ahead of a run.
+
+    The objects are compiled concurrently: in a parallel run they are
+    distributed over the processes (see `ffcx_jit_many`), and each
+    process compiles its objects with a pool of worker processes, which
+    load the UFL files themselves and do not use MPI. The workers are
+    started with the ``spawn`` method, since forking a process after
+    MPI has been initialised is unsafe with many MPI implementations. The
+    objects are found in the cache by a later run if they have the same
+    UFL signature, which does not depend on the names of the objects.
+    The parameters must be the parameters of the run.
+
+    Parameters
+    ----------
+      comm:
+        MPI communicator
+      filenames:
+        UFL files
+      num_workers:
+        Number of worker processes of each process
+      form_compiler_parameters:
+        Parameters used in FFCx compilation, see `ffcx_jit`
+      jit_parameters:
+        Parameters used in CFFI JIT compilation, see `ffcx_jit`
+
+    Returns
+    -------
+      The number of compiled objects
+
+    """
+    tasks = [(filename, i) for filename in filenames for i in range(len(_load_ufl_objects(filename)))]
+    status, error_msg = 0, ""
+    with concurrent.futures.ProcessPoolExecutor(max_workers=max(num_workers, 1),
+                                                mp_context=multiprocessing.get_context("spawn")) as executor:
+        futures = [executor.submit(_prewarm_object, filename, i, form_compiler_parameters, jit_parameters)
+                   for (filename, i) in tasks[comm.rank::comm.size]]
+        for future in futures:
+            try:
+                future.result()
+            except Exception as e:
+                status = 1
+                error_msg = str(e)
+
+    if comm.allreduce(status, op=MPI.MAX) != 0:
+        if status == 0:
+            error_msg = "Compilation failed on another process."
+        raise RuntimeError("Failed just-in-time compilation: {}".format(error_msg))
+
+    return len(tasks)
+
+
+def main(args=None):
+    """Pre-warm the JIT cache with the objects of UFL files."""
+    parser = argparse.ArgumentParser(
+        description="Compile the forms, elements and expressions of UFL files into the DOLFINx JIT cache.")
+    parser.add_argument("files", nargs="+", help="UFL files")
+    parser.add_argument("-j", "--workers", type=int, default=os.cpu_count() or 1,
+                        help="number of worker processes of each MPI process")
+    parser.add_argument("--cache-dir", default=None, help="JIT cache directory")
+    args = parser.parse_args(args)
+
+    jit_parameters = {} if args.cache_dir is None else {"cache_dir": args.cache_dir}
+    n = prewarm(MPI.COMM_WORLD, args.files, args.workers, jit_parameters=jit_parameters)
+    if MPI.COMM_WORLD.rank == 0:
+        print("Compiled {} objects into {}".format(n, get_parameters(jit_parameters)["cache_dir"]))
+
+
+if __name__ == "__main__":
+    main()
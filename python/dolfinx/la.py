@@ -6,3 +6,23 @@
 """Linear algebra functionality"""
 
 from dolfinx.cpp.la import VectorSpaceBasis  # noqa
+from petsc4py import PETSc
+
+
+def create_petsc_vector_wrap(x):
+    """Create a ghosted PETSc vector that shares the data of a DOLFINx
+    vector. The PETSc vector holds a reference to the data, which
+    keeps the DOLFINx vector alive.
+
+    Args:
+        x: The DOLFINx vector (``dolfinx.cpp.la.Vector``)
+
+    Returns:
+        A ``PETSc.Vec`` with the owned and ghost entries of ``x``.
+
+    """
+    index_map = x.map
+    ghosts = index_map.ghosts.astype(PETSc.IntType)
+    bs = x.bs
+    size = (index_map.size_local * bs, index_map.size_global * bs)
+    return PETSc.Vec().createGhostWithArray(ghosts, x.array, size=size, bsize=bs, comm=index_map.mpi_comm())
@@ -6,6 +6,7 @@
 """Creation, refining and marking of meshes"""
 
 import types
+import typing
 
 import numpy
 import ufl
@@ -13,13 +14,14 @@ from dolfinx import cpp
 from dolfinx.cpp.mesh import create_meshtags
 
 __all__ = [
-    "locate_entities", "locate_entities_boundary", "refine", "create_mesh", "create_meshtags", "MeshTags"
+    "locate_entities", "locate_entities_boundary", "refine", "create_mesh", "redistribute", "create_meshtags",
+    "create_submesh", "MeshTags"
 ]
 
 
 def locate_entities(mesh: cpp.mesh.Mesh,
                     dim: int,
-                    marker: types.FunctionType):
+                    marker: typing.Union[types.FunctionType, typing.List[types.FunctionType]]):
     """Compute list of mesh entities satisfying a geometric marking function.
 
     Parameters
@@ -32,11 +34,15 @@ def locate_entities(mesh: cpp.mesh.Mesh,
         A function that takes an array of points `x` with shape
         ``(gdim, num_points)`` and returns an array of booleans of length
         ``num_points``, evaluating to `True` for entities to be located.
+        A list of such functions can be passed to locate the entities for
+        many markers in a single traversal of the mesh entities.
 
     Returns
     -------
-    numpy.ndarray
-        Indices (local to the process) of marked mesh entities.
+    numpy.ndarray or cpp.graph.AdjacencyList_int32
+        Indices (local to the process) of marked mesh entities. If a list
+        of markers is passed, the links of node `i` are the entities marked
+        by the `i`-th marker.
 
     """
 
@@ -45,7 +51,7 @@ def locate_entities(mesh: cpp.mesh.Mesh,
 
 def locate_entities_boundary(mesh: cpp.mesh.Mesh,
                              dim: int,
-                             marker: types.FunctionType):
+                             marker: typing.Union[types.FunctionType, typing.List[types.FunctionType]]):
     """Compute list of mesh entities that are attached to an owned boundary facet
     and satisfy a geometric marking function.
 
@@ -68,11 +74,15 @@ def locate_entities_boundary(mesh: cpp.mesh.Mesh,
         A function that takes an array of points `x` with shape
         ``(gdim, num_points)`` and returns an array of booleans of length
         ``num_points``, evaluating to `True` for entities to be located.
+        A list of such functions can be passed to locate the entities for
+        many markers in a single traversal of the mesh entities.
 
     Returns
     -------
-    numpy.ndarray
-        Indices (local to the process) of marked mesh entities.
+    numpy.ndarray or cpp.graph.AdjacencyList_int32
+        Indices (local to the process) of marked mesh entities. If a list
+        of markers is passed, the links of node `i` are the entities marked
+        by the `i`-th marker.
 
     """
 
@@ -95,12 +105,12 @@ _meshtags_types = {
 }
 
 
-def refine(mesh, cell_markers=None, redistribute=True):
+def refine(mesh, cell_markers=None, redistribute=True, num_threads=1):
     """Refine a mesh"""
     if cell_markers is None:
-        mesh_refined = cpp.refinement.refine(mesh, redistribute)
+        mesh_refined = cpp.refinement.refine(mesh, redistribute, num_threads)
     else:
-        mesh_refined = cpp.refinement.refine(mesh, cell_markers, redistribute)
+        mesh_refined = cpp.refinement.refine(mesh, cell_markers, redistribute, num_threads)
 
     domain = mesh._ufl_domain
     domain._ufl_cargo = mesh_refined
@@ -110,17 +120,20 @@ def refine(mesh, cell_markers=None, redistribute=True):
 
 def create_mesh(comm, cells, x, domain,
                 ghost_mode=cpp.mesh.GhostMode.shared_facet,
-                partitioner=cpp.mesh.partition_cells_graph):
-    """Create a mesh from topology and geometry data"""
+                partitioner=cpp.mesh.partition_cells_graph,
+                reordering=cpp.mesh.CellReordering.gps):
+    """Create a mesh from topology and geometry data. The owned cells
+    (and vertices) on each process are re-ordered for data locality
+    as specified by ``reordering``."""
     ufl_element = domain.ufl_coordinate_element()
     cell_shape = ufl_element.cell().cellname()
     cell_degree = ufl_element.degree()
     cmap = cpp.fem.CoordinateElement(_uflcell_to_dolfinxcell[cell_shape], cell_degree)
     try:
-        mesh = cpp.mesh.create_mesh(comm, cells, cmap, x, ghost_mode, partitioner)
+        mesh = cpp.mesh.create_mesh(comm, cells, cmap, x, ghost_mode, partitioner, reordering)
     except TypeError:
         mesh = cpp.mesh.create_mesh(comm, cpp.graph.AdjacencyList_int64(numpy.cast['int64'](cells)),
-                                    cmap, x, ghost_mode, partitioner)
+                                    cmap, x, ghost_mode, partitioner, reordering)
 
     # Attach UFL data (used when passing a mesh into UFL functions)
     domain._ufl_cargo = mesh
@@ -128,6 +141,40 @@ def create_mesh(comm, cells, x, domain,
     return mesh
 
 
+def redistribute(mesh, dest, ghost_mode=cpp.mesh.GhostMode.shared_facet, reordering=cpp.mesh.CellReordering.gps):
+    """Redistribute a mesh, sending each owned cell to the rank in
+    ``dest``. Returns the new mesh and the global index in the original
+    mesh of each (owned and ghost) cell of the new mesh, which is
+    used to migrate data with ``cpp.mesh.migrate_meshtags`` and
+    ``Function.migrate``."""
+    mesh_new, cells = cpp.mesh.redistribute(mesh, numpy.asarray(dest, dtype=numpy.int32), ghost_mode, reordering)
+
+    # Attach UFL data (used when passing a mesh into UFL functions)
+    domain = mesh._ufl_domain
+    domain._ufl_cargo = mesh_new
+    mesh_new._ufl_domain = domain
+    return mesh_new, cells
+
+
+def create_submesh(mesh, dim, entities):
+    """Create a mesh of the entities of dimension ``dim`` with local
+    indices ``entities``. The submesh keeps the parallel distribution of
+    the entities. Returns the submesh and, for each of its cells,
+    vertices and geometry nodes, the local index of the entity, vertex
+    and geometry node in ``mesh``."""
+    submesh, entity_map, vertex_map, geom_map = cpp.mesh.create_submesh(
+        mesh, dim, numpy.asarray(entities, dtype=numpy.int32))
+
+    # Attach UFL data (used when passing a mesh into UFL functions)
+    cmap = submesh.geometry.cmap
+    cell = ufl.Cell(cpp.mesh.to_string(submesh.topology.cell_type),
+                    geometric_dimension=submesh.geometry.dim)
+    domain = ufl.Mesh(ufl.VectorElement("Lagrange", cell, cmap.degree))
+    domain._ufl_cargo = submesh
+    submesh._ufl_domain = domain
+    return submesh, entity_map, vertex_map, geom_map
+
+
 def MeshTags(mesh, dim, indices, values):
 
     if isinstance(values, int):
@@ -12,9 +12,11 @@ import mpi4py
 
 
 class NewtonSolver(cpp.nls.NewtonSolver):
-    def __init__(self, comm: mpi4py.MPI.Intracomm, problem: fem.NonlinearProblem):
+    def __init__(self, comm: mpi4py.MPI.Intracomm, problem: fem.NonlinearProblem, fused: bool = False):
         """
         Create a Newton solver for a given MPI communicator and non-linear problem.
+        If fused is True, the residual and the Jacobian are assembled in one
+        traversal of the cells when both are needed.
         """
         super().__init__(comm)
 
@@ -24,6 +26,8 @@ class NewtonSolver(cpp.nls.NewtonSolver):
         self.setJ(problem.J, self._A)
         self._b = fem.create_vector(problem.L)
         self.setF(problem.F, self._b)
+        if fused:
+            self.setFJ(problem.FJ)
         self.set_form(problem.form)
 
     def solve(self, u: fem.Function):
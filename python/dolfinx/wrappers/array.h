@@ -8,6 +8,7 @@
 
 #include <dolfinx/common/array2d.h>
 #include <memory>
+#include <type_traits>
 #include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 
@@ -74,4 +75,18 @@ auto xt_as_pyarray(U&& x)
 
   return py::array_t<typename U::value_type>(shape, strides, data, capsule);
 }
+
+/// Create a read-only py::array_t view of the contiguous data of a
+/// container (e.g. a std::vector or xtl::span) that is owned by a C++
+/// object. No data is copied, and the py::array_t object keeps the
+/// owner alive.
+template <typename Container>
+auto as_pyarray_view(const Container& c, py::handle owner)
+{
+  using T = std::remove_const_t<typename Container::value_type>;
+  py::array_t<T> array(c.size(), c.data(), owner);
+  py::detail::array_proxy(array.ptr())->flags
+      &= ~py::detail::npy_api::NPY_ARRAY_WRITEABLE_;
+  return array;
+}
 } // namespace dolfinx_wrappers
@@ -5,16 +5,20 @@
 // SPDX-License-Identifier:    LGPL-3.0-or-later
 
 #include "MPICommWrapper.h"
+#include "array.h"
 #include "caster_mpi.h"
 #include "caster_petsc.h"
 #include <complex>
 #include <dolfinx/common/IndexMap.h>
 #include <dolfinx/common/Table.h>
 #include <dolfinx/common/Timer.h>
+#include <dolfinx/common/cpu.h>
 #include <dolfinx/common/defines.h>
 #include <dolfinx/common/subsystem.h>
 #include <dolfinx/common/timing.h>
+#include <dolfinx/common/utils.h>
 #include <memory>
+#include <pybind11/complex.h>
 #include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
@@ -32,8 +36,15 @@ void common(py::module& m)
   m.attr("has_debug") = dolfinx::has_debug();
   m.attr("has_parmetis") = dolfinx::has_parmetis();
   m.attr("has_kahip") = dolfinx::has_kahip();
+  m.attr("has_zlib") = dolfinx::has_zlib();
+  m.attr("has_adios2") = dolfinx::has_adios2();
   m.attr("has_petsc_complex") = dolfinx::has_petsc_complex();
   m.attr("has_slepc") = dolfinx::has_slepc();
+
+  // From dolfinx/common/cpu.h
+  m.attr("has_cpu_dispatch") = dolfinx::cpu::has_dispatch();
+  m.attr("cpu_isa")
+      = dolfinx::cpu::to_string(dolfinx::cpu::detected_isa());
 #ifdef HAS_PYBIND11_SLEPC4PY
   m.attr("has_slepc4py") = true;
 #else
@@ -65,17 +76,32 @@ void common(py::module& m)
       .def_property_readonly("local_range",
                              &dolfinx::common::IndexMap::local_range,
                              "Range of indices owned by this map")
-      .def("ghost_owner_rank", &dolfinx::common::IndexMap::ghost_owner_rank,
-           "Return owning process for each ghost index")
+      .def(
+          "ghost_owner_rank",
+          [](const dolfinx::common::IndexMap& self)
+          { return as_pyarray(self.ghost_owner_rank()); },
+          "Return owning process for each ghost index")
+      .def("memory_usage", &dolfinx::common::IndexMap::memory_usage,
+           "Memory allocated by the index map (bytes)")
+      .def(
+          "mpi_comm",
+          [](const dolfinx::common::IndexMap& self)
+          {
+            return MPICommWrapper(
+                self.comm(dolfinx::common::IndexMap::Direction::forward));
+          },
+          "Return the MPI communicator of the index map")
       .def_property_readonly(
           "ghosts",
           [](const dolfinx::common::IndexMap& self) {
-            const std::vector<std::int64_t>& ghosts = self.ghosts();
-            return py::array_t<std::int64_t>(ghosts.size(), ghosts.data(),
-                                             py::cast(self));
+            return as_pyarray_view(self.ghosts(), py::cast(self));
           },
           "Return list of ghost indices")
-      .def("global_indices", &dolfinx::common::IndexMap::global_indices)
+      .def(
+          "global_indices",
+          [](const dolfinx::common::IndexMap& self)
+          { return as_pyarray(self.global_indices()); },
+          "Return the global index of each local (owned and ghost) index")
       .def("local_to_global",
            [](const dolfinx::common::IndexMap& self,
               const py::array_t<std::int32_t, py::array::c_style>& local) {
@@ -112,6 +138,61 @@ void common(py::module& m)
           std::set<dolfinx::TimingType> _type(type.begin(), type.end());
           dolfinx::list_timings(comm.get(), _type);
         });
+  m.def(
+      "list_timing_imbalance",
+      [](const MPICommWrapper comm, dolfinx::TimingType type)
+      { dolfinx::list_timing_imbalance(comm.get(), type); },
+      py::arg("comm"), py::arg("type") = dolfinx::TimingType::wall);
+  m.def(
+      "write_timing_distribution",
+      [](const MPICommWrapper comm, const std::string& filename,
+         dolfinx::TimingType type)
+      { dolfinx::write_timing_distribution(comm.get(), filename, type); },
+      py::arg("comm"), py::arg("filename"),
+      py::arg("type") = dolfinx::TimingType::wall);
+  m.def(
+      "nested_timings", []() { return dolfinx::nested_timings().str(); },
+      "Summary of the wall times of nested tasks");
+  m.def("set_timer_trace", &dolfinx::set_timer_trace, py::arg("enable"));
+  m.def(
+      "write_timer_trace",
+      [](const MPICommWrapper comm, const std::string& filename)
+      { dolfinx::write_timer_trace(comm.get(), filename); },
+      py::arg("comm"), py::arg("filename"));
+
+  m.def("set_timer_counters", &dolfinx::set_timer_counters,
+        py::arg("enable"));
+  m.def("timer_counters_available", &dolfinx::timer_counters_available);
+
+  m.def("set_communication_log", &dolfinx::set_communication_log,
+        py::arg("enable"));
+  m.def(
+      "list_communication",
+      [](const MPICommWrapper comm)
+      { dolfinx::list_communication(comm.get()); },
+      py::arg("comm"));
+  m.def(
+      "write_communication",
+      [](const MPICommWrapper comm, const std::string& filename)
+      { dolfinx::write_communication(comm.get(), filename); },
+      py::arg("comm"), py::arg("filename"));
+  m.def(
+      "list_io", [](const MPICommWrapper comm)
+      { dolfinx::list_io(comm.get()); },
+      py::arg("comm"));
+  m.def(
+      "write_io",
+      [](const MPICommWrapper comm, const std::string& filename)
+      { dolfinx::write_io(comm.get(), filename); },
+      py::arg("comm"), py::arg("filename"));
+
+  m.def(
+      "sum_reproducible",
+      [](const MPICommWrapper comm, PetscScalar value)
+      { return dolfinx::common::sum_reproducible(comm.get(), value); },
+      py::arg("comm"), py::arg("value"),
+      "Sum a value across processes with a result that is reproducible "
+      "for a given number of processes");
 
   m.def("init_logging", [](std::vector<std::string> args) {
     std::vector<char*> argv(args.size() + 1, nullptr);
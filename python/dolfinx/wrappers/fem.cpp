@@ -11,16 +11,25 @@
 #include <cstdint>
 #include <dolfinx/common/IndexMap.h>
 #include <dolfinx/common/types.h>
+#include <dolfinx/fem/BatchAssembler.h>
 #include <dolfinx/fem/Constant.h>
 #include <dolfinx/fem/CoordinateElement.h>
 #include <dolfinx/fem/DirichletBC.h>
+#include <dolfinx/fem/DirichletBCs.h>
 #include <dolfinx/fem/DofMap.h>
+#include <dolfinx/fem/ElementTensorCache.h>
 #include <dolfinx/fem/ElementDofLayout.h>
 #include <dolfinx/fem/Expression.h>
 #include <dolfinx/fem/FiniteElement.h>
 #include <dolfinx/fem/Form.h>
 #include <dolfinx/fem/Function.h>
 #include <dolfinx/fem/FunctionSpace.h>
+#include <dolfinx/fem/LocalSolver.h>
+#include <dolfinx/fem/MatrixFreeOperator.h>
+#include <dolfinx/fem/MultiPointConstraint.h>
+#include <dolfinx/fem/QuadratureData.h>
+#include <dolfinx/fem/StaticCondensation.h>
+#include <dolfinx/fem/TensorProductOperator.h>
 #include <dolfinx/fem/assembler.h>
 #include <dolfinx/fem/discreteoperators.h>
 #include <dolfinx/fem/dofmapbuilder.h>
@@ -28,12 +37,14 @@
 #include <dolfinx/fem/petsc.h>
 #include <dolfinx/fem/utils.h>
 #include <dolfinx/geometry/BoundingBoxTree.h>
+#include <dolfinx/geometry/PointOwnership.h>
 #include <dolfinx/la/PETScMatrix.h>
 #include <dolfinx/la/PETScVector.h>
 #include <dolfinx/la/SparsityPattern.h>
 #include <dolfinx/mesh/Mesh.h>
 #include <dolfinx/mesh/MeshTags.h>
 #include <memory>
+#include <mutex>
 #include <petsc4py/petsc4py.h>
 #include <pybind11/functional.h>
 #include <pybind11/numpy.h>
@@ -64,11 +75,31 @@ void fem(py::module& m)
   m.def("create_sparsity_pattern",
         &dolfinx::fem::create_sparsity_pattern<PetscScalar>,
         "Create a sparsity pattern for bilinear form.");
+  m.def(
+      "create_sparsity_pattern",
+      [](const dolfinx::fem::Form<PetscScalar>& a,
+         const dolfinx::fem::MultiPointConstraint<PetscScalar>& mpc)
+      { return dolfinx::fem::create_sparsity_pattern(a, mpc); },
+      py::arg("a"), py::arg("mpc"),
+      "Create a sparsity pattern for a bilinear form with multipoint "
+      "constraints.");
+  m.def(
+      "memory_usage",
+      [](const dolfinx::fem::Form<PetscScalar>& form)
+      {
+        return dolfinx::fem::memory_usage(form)
+            .reduce(form.mesh()->mpi_comm(), dolfinx::Table::Reduction::max)
+            .str();
+      },
+      "Summary of the memory used by the data of a Form (MPI_MAX "
+      "reduction).");
   m.def(
       "pack_coefficients",
-      [](dolfinx::fem::Form<PetscScalar>& form)
-      { return as_pyarray2d(dolfinx::fem::pack_coefficients(form)); },
-      "Pack coefficients for a Form.");
+      [](dolfinx::fem::Form<PetscScalar>& form, std::size_t width)
+      { return as_pyarray2d(dolfinx::fem::pack_coefficients(form, width)); },
+      py::arg("form"), py::arg("width") = 1,
+      "Pack coefficients for a Form, with rows padded to a multiple of "
+      "width values.");
   m.def(
       "pack_coefficients",
       [](dolfinx::fem::Expression<PetscScalar>& expr)
@@ -110,12 +141,19 @@ void fem(py::module& m)
       "create_dofmap",
       [](const MPICommWrapper comm, const std::uintptr_t dofmap,
          dolfinx::mesh::Topology& topology,
-         std::shared_ptr<dolfinx::fem::FiniteElement> element) {
+         std::shared_ptr<dolfinx::fem::FiniteElement> element,
+         bool sort_ghosts, int num_threads) {
         const ufc_dofmap* p = reinterpret_cast<const ufc_dofmap*>(dofmap);
         return dolfinx::fem::create_dofmap(comm.get(), *p, topology, nullptr,
-                                           element);
+                                           element, sort_ghosts, num_threads);
       },
+      py::arg("comm"), py::arg("dofmap"), py::arg("topology"),
+      py::arg("element"), py::arg("sort_ghosts") = false,
+      py::arg("num_threads") = 1,
       "Create DofMap object from a pointer to ufc_dofmap.");
+  m.def("compute_component_dofs", &dolfinx::fem::compute_component_dofs,
+        py::arg("dofmap"), py::arg("num_cells"),
+        "Compute the owned dofs of each component of a dofmap.");
   m.def(
       "create_form",
       [](const std::uintptr_t form,
@@ -222,16 +260,23 @@ void fem(py::module& m)
       .def_property_readonly("index_map_bs",
                              &dolfinx::fem::DofMap::index_map_bs)
       .def_readonly("dof_layout", &dolfinx::fem::DofMap::element_dof_layout)
+      .def("memory_usage", &dolfinx::fem::DofMap::memory_usage,
+           "Memory allocated by the dofmap data (bytes)")
       .def("cell_dofs",
            [](const dolfinx::fem::DofMap& self, int cell)
            {
-             xtl::span<const std::int32_t> dofs = self.cell_dofs(cell);
-             return py::array_t<std::int32_t>(dofs.size(), dofs.data(),
-                                              py::cast(self));
+             return as_pyarray_view(self.cell_dofs(cell), py::cast(self));
            })
       .def_property_readonly("bs", &dolfinx::fem::DofMap::bs)
       .def("list", &dolfinx::fem::DofMap::list,
-           py::return_value_policy::reference_internal);
+           py::return_value_policy::reference_internal)
+      .def("compress", &dolfinx::fem::DofMap::compress,
+           "Store a compressed copy of the dofmap data for assembly")
+      .def_property_readonly(
+          "compressed",
+          [](const dolfinx::fem::DofMap& self)
+          { return self.compressed_list() != nullptr; },
+          "True if a compressed copy of the dofmap data is stored");
 
   // dolfinx::fem::CoordinateElement
   py::class_<dolfinx::fem::CoordinateElement,
@@ -241,6 +286,8 @@ void fem(py::module& m)
            py::arg("degree"))
       .def_property_readonly("dof_layout",
                              &dolfinx::fem::CoordinateElement::dof_layout)
+      .def_property_readonly("degree",
+                             &dolfinx::fem::CoordinateElement::degree)
       .def("push_forward",
            [](const dolfinx::fem::CoordinateElement& self,
               const py::array_t<double, py::array::c_style>& X,
@@ -312,36 +359,544 @@ void fem(py::module& m)
       .def_property_readonly(
           "function_space",
           &dolfinx::fem::DirichletBC<PetscScalar>::function_space)
+      .def(
+          "update_values",
+          [](dolfinx::fem::DirichletBC<PetscScalar>& self,
+             const std::function<py::array_t<PetscScalar>(
+                 const py::array_t<double>&)>& f)
+          {
+            auto _f =
+                [&f](const xt::xtensor<double, 2>& x) -> xt::xarray<PetscScalar>
+            {
+              auto strides = x.strides();
+              std::transform(strides.begin(), strides.end(), strides.begin(),
+                             [](auto s) { return s * sizeof(double); });
+              py::array_t _x(x.shape(), strides, x.data(), py::none());
+              py::array_t v = f(_x);
+              std::vector<std::size_t> shape;
+              for (pybind11::ssize_t i = 0; i < v.ndim(); i++)
+                shape.push_back(v.shape()[i]);
+              return xt::adapt(v.data(), shape);
+            };
+            self.update_values(_f);
+          },
+          py::arg("f"),
+          "Set the boundary values by evaluating an expression at the "
+          "constrained degree-of-freedom coordinates only")
       .def_property_readonly("value",
                              &dolfinx::fem::DirichletBC<PetscScalar>::value);
 
+  // dolfinx::fem::DirichletBCs
+  py::class_<dolfinx::fem::DirichletBCs<PetscScalar>,
+             std::shared_ptr<dolfinx::fem::DirichletBCs<PetscScalar>>>(
+      m, "DirichletBCs",
+      "Dirichlet boundary conditions on a function space merged into a "
+      "single set of degrees-of-freedom")
+      .def(py::init<const dolfinx::fem::FunctionSpace&,
+                    const std::vector<std::shared_ptr<
+                        const dolfinx::fem::DirichletBC<PetscScalar>>>&>(),
+           py::arg("V"), py::arg("bcs"))
+      .def("dof_indices",
+           [](const dolfinx::fem::DirichletBCs<PetscScalar>& self)
+           {
+             auto [dofs, owned] = self.dof_indices();
+             return std::pair(py::array_t<std::int32_t>(
+                                  dofs.size(), dofs.data(), py::cast(self)),
+                              owned);
+           })
+      .def_property_readonly(
+          "bcs", &dolfinx::fem::DirichletBCs<PetscScalar>::bcs);
+
+  // dolfinx::fem::MultiPointConstraint
+  py::class_<dolfinx::fem::MultiPointConstraint<PetscScalar>,
+             std::shared_ptr<dolfinx::fem::MultiPointConstraint<PetscScalar>>>(
+      m, "MultiPointConstraint",
+      "Multipoint constraints, in which slave degrees-of-freedom are linear "
+      "combinations of master degrees-of-freedom")
+      .def(py::init(
+               [](const std::shared_ptr<const dolfinx::fem::FunctionSpace>& V,
+                  const py::array_t<std::int32_t, py::array::c_style>& slaves,
+                  const py::array_t<std::int64_t, py::array::c_style>& masters,
+                  const py::array_t<std::int32_t, py::array::c_style>& offsets,
+                  const py::array_t<PetscScalar, py::array::c_style>&
+                      coefficients)
+               {
+                 return dolfinx::fem::MultiPointConstraint<PetscScalar>(
+                     V,
+                     std::vector<std::int32_t>(slaves.data(),
+                                               slaves.data() + slaves.size()),
+                     dolfinx::graph::AdjacencyList<std::int64_t>(
+                         std::vector<std::int64_t>(
+                             masters.data(), masters.data() + masters.size()),
+                         std::vector<std::int32_t>(
+                             offsets.data(), offsets.data() + offsets.size())),
+                     std::vector<PetscScalar>(coefficients.data(),
+                                              coefficients.data()
+                                                  + coefficients.size()));
+               }),
+           py::arg("V"), py::arg("slaves"), py::arg("masters"),
+           py::arg("offsets"), py::arg("coefficients"))
+      .def_property_readonly(
+          "function_space",
+          &dolfinx::fem::MultiPointConstraint<PetscScalar>::function_space)
+      .def_property_readonly(
+          "index_map",
+          &dolfinx::fem::MultiPointConstraint<PetscScalar>::index_map)
+      .def_property_readonly(
+          "index_map_bs",
+          &dolfinx::fem::MultiPointConstraint<PetscScalar>::index_map_bs)
+      .def_property_readonly(
+          "slaves",
+          [](const dolfinx::fem::MultiPointConstraint<PetscScalar>& self)
+          { return as_pyarray_view(self.slaves(), py::cast(self)); })
+      .def_property_readonly(
+          "num_owned_slaves",
+          &dolfinx::fem::MultiPointConstraint<PetscScalar>::num_owned_slaves)
+      .def(
+          "apply_transpose",
+          [](const dolfinx::fem::MultiPointConstraint<PetscScalar>& self,
+             py::array_t<PetscScalar, py::array::c_style> b)
+          {
+            self.apply_transpose(
+                xtl::span<PetscScalar>(b.mutable_data(), b.size()));
+          },
+          py::arg("b"))
+      .def(
+          "backsubstitution",
+          [](const dolfinx::fem::MultiPointConstraint<PetscScalar>& self,
+             py::array_t<PetscScalar, py::array::c_style> x)
+          {
+            self.backsubstitution(
+                xtl::span<PetscScalar>(x.mutable_data(), x.size()));
+          },
+          py::arg("x"));
+
+  // dolfinx::fem::BatchAssembler
+  py::class_<dolfinx::fem::BatchAssembler<PetscScalar>,
+             std::shared_ptr<dolfinx::fem::BatchAssembler<PetscScalar>>>(
+      m, "BatchAssembler",
+      "Repeated assembly of the cell integrals of a form with batched "
+      "kernels")
+      .def(py::init<const dolfinx::fem::Form<PetscScalar>&,
+                    const dolfinx::la::MatrixCSR<PetscScalar>&,
+                    const std::vector<bool>&, const std::vector<bool>&>(),
+           py::arg("a"), py::arg("A"), py::arg("bc0"), py::arg("bc1"))
+      .def(py::init<const dolfinx::fem::Form<PetscScalar>&>(), py::arg("L"))
+      .def(
+          "update_coefficients",
+          [](dolfinx::fem::BatchAssembler<PetscScalar>& self,
+             const py::array_t<PetscScalar, py::array::c_style>& coeffs)
+          {
+            if (coeffs.ndim() != 2)
+              throw std::runtime_error("Coefficients array must be 2D.");
+            dolfinx::array2d<PetscScalar> c(coeffs.shape(0),
+                                            coeffs.shape(1));
+            std::copy_n(coeffs.data(), coeffs.size(), c.data());
+            self.update_coefficients(c);
+          },
+          py::arg("coeffs"))
+      .def(
+          "update_constants",
+          [](dolfinx::fem::BatchAssembler<PetscScalar>& self,
+             const py::array_t<PetscScalar, py::array::c_style>& constants)
+          {
+            self.update_constants(xtl::span<const PetscScalar>(
+                constants.data(), constants.size()));
+          },
+          py::arg("constants"))
+      .def(
+          "assemble",
+          [](dolfinx::fem::BatchAssembler<PetscScalar>& self,
+             dolfinx::la::MatrixCSR<PetscScalar>& A, int num_threads)
+          {
+            py::gil_scoped_release release;
+            self.assemble(A.values(), num_threads);
+          },
+          py::arg("A"), py::arg("num_threads") = 1,
+          "Add the assembled bilinear form to a matrix")
+      .def(
+          "assemble",
+          [](dolfinx::fem::BatchAssembler<PetscScalar>& self,
+             py::array_t<PetscScalar, py::array::c_style> b, int num_threads)
+          {
+            xtl::span<PetscScalar> _b(b.mutable_data(), b.size());
+            py::gil_scoped_release release;
+            self.assemble(_b, num_threads);
+          },
+          py::arg("b"), py::arg("num_threads") = 1,
+          "Add the assembled linear form to an array (including ghosts)")
+      .def_property_readonly(
+          "num_cells", &dolfinx::fem::BatchAssembler<PetscScalar>::num_cells);
+
+  // dolfinx::fem::QuadratureData
+  py::class_<dolfinx::fem::QuadratureData<PetscScalar>,
+             std::shared_ptr<dolfinx::fem::QuadratureData<PetscScalar>>>(
+      m, "QuadratureData",
+      "Storage of a state at the quadrature points of each cell in the "
+      "packed coefficient data of a form")
+      .def(py::init<const dolfinx::fem::Form<PetscScalar>&, int>(),
+           py::arg("form"), py::arg("index"), py::keep_alive<1, 2>())
+      .def(
+          "update",
+          [](py::object self)
+          {
+            const dolfinx::array2d<PetscScalar>& c
+                = self.cast<dolfinx::fem::QuadratureData<PetscScalar>&>()
+                      .update();
+            return py::array_t<PetscScalar>(c.shape, c.strides(), c.data(),
+                                            self);
+          },
+          "Re-pack the modified coefficients and return the packed "
+          "coefficient data")
+      .def(
+          "state",
+          [](py::object self, std::int32_t cell)
+          {
+            xtl::span<PetscScalar> state
+                = self.cast<dolfinx::fem::QuadratureData<PetscScalar>&>()
+                      .state(cell);
+            return py::array_t<PetscScalar>(state.size(), state.data(), self);
+          },
+          py::arg("cell"), "The state on a cell, which can be modified")
+      .def(
+          "previous",
+          [](py::object self, std::int32_t cell)
+          {
+            return as_pyarray_view(
+                self.cast<const dolfinx::fem::QuadratureData<PetscScalar>&>()
+                    .previous(cell),
+                self);
+          },
+          py::arg("cell"), "The state on a cell at the last accepted step")
+      .def(
+          "update_state",
+          [](py::object self,
+             const std::function<void(std::int32_t,
+                                      py::array_t<PetscScalar>,
+                                      py::array_t<PetscScalar>)>& f)
+          {
+            self.cast<dolfinx::fem::QuadratureData<PetscScalar>&>()
+                .update_state(
+                    [&f, &self](std::int32_t c, xtl::span<PetscScalar> state,
+                                xtl::span<const PetscScalar> w)
+                    {
+                      f(c,
+                        py::array_t<PetscScalar>(state.size(), state.data(),
+                                                 self),
+                        as_pyarray_view(w, self));
+                    });
+          },
+          py::arg("f"),
+          "Update the state on each cell by calling f(cell, state, w), "
+          "where state is a writable view of the state on the cell and w "
+          "is the coefficient data of the cell")
+      .def("commit", &dolfinx::fem::QuadratureData<PetscScalar>::commit)
+      .def("revert", &dolfinx::fem::QuadratureData<PetscScalar>::revert)
+      .def_property_readonly(
+          "offset", &dolfinx::fem::QuadratureData<PetscScalar>::offset)
+      .def_property_readonly("size",
+                             &dolfinx::fem::QuadratureData<PetscScalar>::size);
+
+  // dolfinx::fem::LocalSolver
+  py::class_<dolfinx::fem::LocalSolver<PetscScalar>,
+             std::shared_ptr<dolfinx::fem::LocalSolver<PetscScalar>>>
+      local_solver(m, "LocalSolver",
+                   "Solution of the cell-local systems of a bilinear and a "
+                   "linear form");
+  py::enum_<dolfinx::fem::LocalSolver<PetscScalar>::Type>(local_solver,
+                                                          "Type")
+      .value("lu", dolfinx::fem::LocalSolver<PetscScalar>::Type::lu)
+      .value("cholesky",
+             dolfinx::fem::LocalSolver<PetscScalar>::Type::cholesky);
+  local_solver
+      .def(py::init<
+               const std::shared_ptr<const dolfinx::fem::Form<PetscScalar>>&,
+               const std::shared_ptr<const dolfinx::fem::Form<PetscScalar>>&,
+               dolfinx::fem::LocalSolver<PetscScalar>::Type>(),
+           py::arg("a"), py::arg("L"),
+           py::arg("type") = dolfinx::fem::LocalSolver<PetscScalar>::Type::lu)
+      .def("factorize", &dolfinx::fem::LocalSolver<PetscScalar>::factorize,
+           py::arg("num_threads") = 1,
+           py::call_guard<py::gil_scoped_release>())
+      .def("solve",
+           &dolfinx::fem::LocalSolver<PetscScalar>::solve<
+               std::allocator<PetscScalar>>,
+           py::arg("x"), py::arg("num_threads") = 1,
+           py::call_guard<py::gil_scoped_release>())
+      .def_property_readonly(
+          "cells",
+          [](const dolfinx::fem::LocalSolver<PetscScalar>& self)
+          { return as_pyarray_view(self.cells(), py::cast(self)); });
+
   // dolfinx::fem::assemble
 
   // Functional
-  m.def("assemble_scalar",
-        py::overload_cast<const dolfinx::fem::Form<PetscScalar>&>(
-            &dolfinx::fem::assemble_scalar<PetscScalar>),
-        "Assemble functional over mesh");
+  m.def(
+      "assemble_scalar",
+      [](const dolfinx::fem::Form<PetscScalar>& M, int num_threads)
+      { return dolfinx::fem::assemble_scalar<PetscScalar>(M, num_threads); },
+      py::arg("M"), py::arg("num_threads") = 1,
+      py::call_guard<py::gil_scoped_release>(),
+      "Assemble functional over mesh");
+  m.def(
+      "assemble_scalar",
+      [](const dolfinx::fem::Form<PetscScalar>& M,
+         const py::array_t<PetscScalar, py::array::c_style>& constants)
+      {
+        if (constants.ndim() != 2)
+          throw std::runtime_error("Constants array must be 2D.");
+        dolfinx::array2d<PetscScalar> _constants(constants.shape(0),
+                                                 constants.shape(1));
+        std::copy_n(constants.data(), constants.size(), _constants.data());
+        return as_pyarray(dolfinx::fem::assemble_scalar(
+            M, _constants, dolfinx::fem::pack_coefficients(M)));
+      },
+      py::arg("M"), py::arg("constants"),
+      "Assemble functional over mesh for each row (ensemble member) of "
+      "packed constants");
   // Vector
   m.def(
       "assemble_vector",
       [](py::array_t<PetscScalar, py::array::c_style> b,
-         const dolfinx::fem::Form<PetscScalar>& L)
+         const dolfinx::fem::Form<PetscScalar>& L, int num_threads)
+      {
+        xtl::span<PetscScalar> _b(b.mutable_data(), b.size());
+        py::gil_scoped_release release;
+        dolfinx::fem::assemble_vector<PetscScalar>(_b, L, num_threads);
+      },
+      py::arg("b"), py::arg("L"), py::arg("num_threads") = 1,
+      "Assemble linear form into an existing vector");
+  m.def(
+      "assemble_vector",
+      [](dolfinx::la::Vector<PetscScalar>& b,
+         const dolfinx::fem::Form<PetscScalar>& L,
+         const std::vector<std::shared_ptr<dolfinx::la::Vector<PetscScalar>>>&
+             x)
+      {
+        std::vector<std::reference_wrapper<dolfinx::la::Vector<PetscScalar>>>
+            _x;
+        for (auto& v : x)
+          _x.push_back(*v);
+        dolfinx::fem::assemble_vector<PetscScalar>(b, L, _x);
+      },
+      py::arg("b"), py::arg("L"),
+      py::arg("x")
+      = std::vector<std::shared_ptr<dolfinx::la::Vector<PetscScalar>>>(),
+      py::call_guard<py::gil_scoped_release>(),
+      "Assemble linear form into a ghosted vector, overlapping ghost "
+      "updates with assembly");
+  m.def(
+      "assemble_vector_owned",
+      [](py::array_t<PetscScalar, py::array::c_style> b,
+         const dolfinx::fem::Form<PetscScalar>& L, int num_threads)
       {
+        xtl::span<PetscScalar> _b(b.mutable_data(), b.size());
+        py::gil_scoped_release release;
+        dolfinx::fem::assemble_vector_owned<PetscScalar>(_b, L, num_threads);
+      },
+      py::arg("b"), py::arg("L"), py::arg("num_threads") = 1,
+      "Assemble linear form into the owned entries of a vector, without a "
+      "reverse scatter");
+  m.def(
+      "assemble_diagonal",
+      [](dolfinx::la::Vector<PetscScalar>& d,
+         const dolfinx::fem::Form<PetscScalar>& a,
+         const std::vector<std::shared_ptr<
+             const dolfinx::fem::DirichletBC<PetscScalar>>>& bcs,
+         PetscScalar diagonal, int num_threads)
+      {
+        dolfinx::fem::assemble_diagonal<PetscScalar>(d, a, bcs, diagonal,
+                                                     num_threads);
+      },
+      py::arg("d"), py::arg("a"), py::arg("bcs"), py::arg("diagonal") = 1.0,
+      py::arg("num_threads") = 1, py::call_guard<py::gil_scoped_release>(),
+      "Assemble the diagonal (or the diagonal blocks) of a bilinear form "
+      "into a vector");
+  m.def(
+      "assemble_vector",
+      [](py::array_t<PetscScalar, py::array::c_style> b,
+         const dolfinx::fem::Form<PetscScalar>& L,
+         const py::array_t<PetscScalar, py::array::c_style>& constants)
+      {
+        if (constants.ndim() != 2 or b.ndim() != 2
+            or b.shape(1) != constants.shape(0))
+        {
+          throw std::runtime_error(
+              "Array must have one column per row of constants.");
+        }
+        dolfinx::array2d<PetscScalar> _constants(constants.shape(0),
+                                                 constants.shape(1));
+        std::copy_n(constants.data(), constants.size(), _constants.data());
         dolfinx::fem::assemble_vector<PetscScalar>(
-            xtl::span(b.mutable_data(), b.size()), L);
+            xtl::span(b.mutable_data(), b.size()), L, _constants,
+            dolfinx::fem::pack_coefficients(L));
+      },
+      py::arg("b"), py::arg("L"), py::arg("constants"),
+      "Assemble linear form into the columns of an existing (row-major) "
+      "array for each row (ensemble member) of packed constants");
+  m.def(
+      "assemble_multi_vector",
+      [](py::array_t<PetscScalar, py::array::c_style> b,
+         const std::vector<const dolfinx::fem::Form<PetscScalar>*>& L)
+      {
+        if (b.ndim() != 2 or b.shape(1) != static_cast<py::ssize_t>(L.size()))
+          throw std::runtime_error("Array must have one column per form.");
+        std::vector<std::reference_wrapper<
+            const dolfinx::fem::Form<PetscScalar>>>
+            _L;
+        for (auto form : L)
+          _L.push_back(*form);
+        xtl::span<PetscScalar> _b(b.mutable_data(), b.size());
+        py::gil_scoped_release release;
+        dolfinx::fem::assemble_multi_vector<PetscScalar>(_b, _L);
       },
       py::arg("b"), py::arg("L"),
-      "Assemble linear form into an existing vector");
+      "Assemble linear forms with the same test space into the columns of "
+      "an existing (row-major) array in a single traversal of the cells");
   // Matrices
-  m.def("assemble_matrix_petsc",
-        [](Mat A, const dolfinx::fem::Form<PetscScalar>& a,
-           const std::vector<std::shared_ptr<
-               const dolfinx::fem::DirichletBC<PetscScalar>>>& bcs)
+  m.def(
+      "assemble_matrix_petsc",
+      [](Mat A, const dolfinx::fem::Form<PetscScalar>& a,
+         const std::vector<std::shared_ptr<
+             const dolfinx::fem::DirichletBC<PetscScalar>>>& bcs,
+         int num_threads)
+      {
+        auto set_fn = dolfinx::la::PETScMatrix::set_block_fn(A, ADD_VALUES);
+        if (num_threads > 1)
         {
-          dolfinx::fem::assemble_matrix(
-              dolfinx::la::PETScMatrix::set_block_fn(A, ADD_VALUES), a, bcs);
-        });
+          // PETSc insertion is not thread-safe, so serialise calls to
+          // MatSetValuesBlockedLocal. Element tensors are still computed
+          // concurrently.
+          std::mutex mutex;
+          dolfinx::fem::assemble_matrix<PetscScalar>(
+              [&](std::int32_t m, const std::int32_t* rows, std::int32_t n,
+                  const std::int32_t* cols, const PetscScalar* vals)
+              {
+                std::lock_guard<std::mutex> lock(mutex);
+                return set_fn(m, rows, n, cols, vals);
+              },
+              a, bcs, num_threads);
+        }
+        else
+          dolfinx::fem::assemble_matrix(set_fn, a, bcs);
+      },
+      py::arg("A"), py::arg("a"), py::arg("bcs"), py::arg("num_threads") = 1,
+      py::call_guard<py::gil_scoped_release>());
+  m.def(
+      "assemble_fused_petsc",
+      [](const std::vector<Mat>& A,
+         const std::vector<const dolfinx::fem::Form<PetscScalar>*>& a,
+         std::vector<py::array_t<PetscScalar, py::array::c_style>> b,
+         const std::vector<const dolfinx::fem::Form<PetscScalar>*>& L,
+         const std::vector<std::shared_ptr<
+             const dolfinx::fem::DirichletBC<PetscScalar>>>& bcs,
+         int chunk_size)
+      {
+        std::vector<std::function<int(std::int32_t, const std::int32_t*,
+                                      std::int32_t, const std::int32_t*,
+                                      const PetscScalar*)>>
+            set_fn;
+        for (Mat _A : A)
+          set_fn.push_back(
+              dolfinx::la::PETScMatrix::set_block_fn(_A, ADD_VALUES));
+        std::vector<xtl::span<PetscScalar>> _b;
+        for (auto& array : b)
+          _b.push_back(xtl::span(array.mutable_data(), array.size()));
+        std::vector<std::reference_wrapper<
+            const dolfinx::fem::Form<PetscScalar>>>
+            _a, _L;
+        for (auto form : a)
+          _a.push_back(*form);
+        for (auto form : L)
+          _L.push_back(*form);
+        py::gil_scoped_release release;
+        dolfinx::fem::assemble_fused<PetscScalar>(set_fn, _a, _b, _L, bcs,
+                                                  chunk_size);
+      },
+      py::arg("A"), py::arg("a"), py::arg("b"), py::arg("L"), py::arg("bcs"),
+      py::arg("chunk_size") = 128,
+      "Assemble bilinear forms into PETSc matrices and linear forms into "
+      "vectors in a single traversal of the mesh cells");
+  m.def(
+      "assemble_matrix_nest_petsc",
+      [](Mat A,
+         const std::vector<
+             std::vector<const dolfinx::fem::Form<PetscScalar>*>>& a,
+         const std::vector<std::shared_ptr<
+             const dolfinx::fem::DirichletBC<PetscScalar>>>& bcs,
+         int chunk_size, int num_threads)
+      {
+        // Collect the blocks, each with the insertion function for its
+        // sub-matrix
+        std::vector<std::reference_wrapper<
+            const dolfinx::fem::Form<PetscScalar>>>
+            _a;
+        std::vector<Mat> blocks;
+        for (std::size_t i = 0; i < a.size(); ++i)
+        {
+          for (std::size_t j = 0; j < a[i].size(); ++j)
+          {
+            if (a[i][j])
+            {
+              Mat Asub;
+              MatNestGetSubMat(A, i, j, &Asub);
+              _a.push_back(*a[i][j]);
+              blocks.push_back(Asub);
+            }
+          }
+        }
+
+        // PETSc insertion is not thread-safe, so with threads calls are
+        // serialised for each block. Different blocks are inserted into
+        // concurrently.
+        std::vector<std::mutex> mutexes(blocks.size());
+        std::vector<std::function<int(std::int32_t, const std::int32_t*,
+                                      std::int32_t, const std::int32_t*,
+                                      const PetscScalar*)>>
+            set_fn;
+        for (std::size_t k = 0; k < blocks.size(); ++k)
+        {
+          auto fn = dolfinx::la::PETScMatrix::set_block_fn(blocks[k],
+                                                           ADD_VALUES);
+          if (num_threads > 1)
+          {
+            set_fn.push_back(
+                [fn, &mutex = mutexes[k]](
+                    std::int32_t m, const std::int32_t* rows, std::int32_t n,
+                    const std::int32_t* cols, const PetscScalar* vals)
+                {
+                  std::lock_guard<std::mutex> lock(mutex);
+                  return fn(m, rows, n, cols, vals);
+                });
+          }
+          else
+            set_fn.push_back(fn);
+        }
+
+        py::gil_scoped_release release;
+        dolfinx::fem::assemble_fused<PetscScalar>(
+            set_fn, _a, {}, {}, bcs, chunk_size, num_threads);
+      },
+      py::arg("A"), py::arg("a"), py::arg("bcs"), py::arg("chunk_size") = 128,
+      py::arg("num_threads") = 1,
+      "Assemble the blocks of a nested PETSc matrix in a single traversal "
+      "of the mesh cells");
+  m.def(
+      "assemble_matrix_petsc",
+      [](Mat A, const dolfinx::fem::Form<PetscScalar>& a,
+         const dolfinx::fem::MultiPointConstraint<PetscScalar>& mpc,
+         const std::vector<std::shared_ptr<
+             const dolfinx::fem::DirichletBC<PetscScalar>>>& bcs,
+         PetscScalar diagonal)
+      {
+        dolfinx::fem::assemble_matrix(
+            dolfinx::la::PETScMatrix::set_fn(A, ADD_VALUES), a, mpc, bcs,
+            diagonal);
+      },
+      py::arg("A"), py::arg("a"), py::arg("mpc"), py::arg("bcs"),
+      py::arg("diagonal") = 1.0, py::call_guard<py::gil_scoped_release>(),
+      "Assemble a bilinear form with multipoint constraints into a PETSc "
+      "matrix");
   m.def("assemble_matrix_petsc",
         [](Mat A, const dolfinx::fem::Form<PetscScalar>& a,
            const std::vector<bool>& rows0, const std::vector<bool>& rows1)
@@ -349,7 +904,8 @@ void fem(py::module& m)
           dolfinx::fem::assemble_matrix(
               dolfinx::la::PETScMatrix::set_block_fn(A, ADD_VALUES), a, rows0,
               rows1);
-        });
+        },
+        py::call_guard<py::gil_scoped_release>());
   m.def("assemble_matrix_petsc_unrolled",
         [](Mat A, const dolfinx::fem::Form<PetscScalar>& a,
            const std::vector<std::shared_ptr<
@@ -360,7 +916,8 @@ void fem(py::module& m)
                   A, a.function_spaces()[0]->dofmap()->bs(),
                   a.function_spaces()[1]->dofmap()->bs(), ADD_VALUES),
               a, bcs);
-        });
+        },
+        py::call_guard<py::gil_scoped_release>());
   m.def("assemble_matrix_petsc_unrolled",
         [](Mat A, const dolfinx::fem::Form<PetscScalar>& a,
            const std::vector<bool>& rows0, const std::vector<bool>& rows1)
@@ -370,7 +927,8 @@ void fem(py::module& m)
                   A, a.function_spaces()[0]->dofmap()->bs(),
                   a.function_spaces()[1]->dofmap()->bs(), ADD_VALUES),
               a, rows0, rows1);
-        });
+        },
+        py::call_guard<py::gil_scoped_release>());
   m.def("insert_diagonal",
         [](Mat A, const dolfinx::fem::FunctionSpace& V,
            const std::vector<std::shared_ptr<
@@ -380,7 +938,8 @@ void fem(py::module& m)
           dolfinx::fem::set_diagonal(
               dolfinx::la::PETScMatrix::set_fn(A, INSERT_VALUES), V, bcs,
               diagonal);
-        });
+        },
+        py::call_guard<py::gil_scoped_release>());
   m.def(
       "assemble_matrix",
       [](const std::function<int(const py::array_t<std::int32_t>&,
@@ -404,6 +963,24 @@ void fem(py::module& m)
       "slow. Testing use only.");
 
   // BC modifiers
+  m.def(
+      "assemble_vector",
+      [](py::array_t<PetscScalar, py::array::c_style> b,
+         const dolfinx::fem::Form<PetscScalar>& L,
+         const dolfinx::fem::Form<PetscScalar>& a,
+         const std::vector<std::shared_ptr<
+             const dolfinx::fem::DirichletBC<PetscScalar>>>& bcs1,
+         const py::array_t<PetscScalar, py::array::c_style>& x0, double scale)
+      {
+        xtl::span<PetscScalar> _b(b.mutable_data(), b.size());
+        py::gil_scoped_release release;
+        dolfinx::fem::assemble_vector<PetscScalar>(
+            _b, L, a, bcs1, xtl::span(x0.data(), x0.size()), scale);
+      },
+      py::arg("b"), py::arg("L"), py::arg("a"), py::arg("bcs"), py::arg("x0"),
+      py::arg("scale"),
+      "Assemble linear form into an existing vector and modify it for "
+      "lifted boundary conditions in the same traversal of the cells");
   m.def(
       "apply_lifting",
       [](py::array_t<PetscScalar, py::array::c_style> b,
@@ -417,10 +994,51 @@ void fem(py::module& m)
         std::vector<xtl::span<const PetscScalar>> _x0;
         for (const auto& x : x0)
           _x0.emplace_back(x.data(), x.size());
-        dolfinx::fem::apply_lifting<PetscScalar>(
-            xtl::span(b.mutable_data(), b.size()), a, bcs1, _x0, scale);
+        xtl::span<PetscScalar> _b(b.mutable_data(), b.size());
+        py::gil_scoped_release release;
+        dolfinx::fem::apply_lifting<PetscScalar>(_b, a, bcs1, _x0, scale);
       },
       "Modify vector for lifted boundary conditions");
+  m.def(
+      "apply_lifting",
+      [](py::array_t<PetscScalar, py::array::c_style> b,
+         const std::vector<
+             std::shared_ptr<const dolfinx::fem::Form<PetscScalar>>>& a,
+         const std::vector<std::shared_ptr<
+             const dolfinx::fem::DirichletBCs<PetscScalar>>>& bcs1,
+         const std::vector<py::array_t<PetscScalar, py::array::c_style>>& x0,
+         double scale)
+      {
+        std::vector<xtl::span<const PetscScalar>> _x0;
+        for (const auto& x : x0)
+          _x0.emplace_back(x.data(), x.size());
+        xtl::span<PetscScalar> _b(b.mutable_data(), b.size());
+        py::gil_scoped_release release;
+        dolfinx::fem::apply_lifting<PetscScalar>(_b, a, bcs1, _x0, scale);
+      },
+      "Modify vector for lifted merged boundary conditions");
+  m.def(
+      "set_bc",
+      [](py::array_t<PetscScalar, py::array::c_style> b,
+         const dolfinx::fem::DirichletBCs<PetscScalar>& bcs,
+         const py::array_t<PetscScalar, py::array::c_style>& x0, double scale)
+      {
+        if (x0.ndim() == 0)
+        {
+          dolfinx::fem::set_bc<PetscScalar>(
+              xtl::span(b.mutable_data(), b.size()), bcs, scale);
+        }
+        else if (x0.ndim() == 1)
+        {
+          dolfinx::fem::set_bc<PetscScalar>(
+              xtl::span(b.mutable_data(), b.size()), bcs,
+              xtl::span(x0.data(), x0.shape(0)), scale);
+        }
+        else
+          throw std::runtime_error("Wrong array dimension.");
+      },
+      py::arg("b"), py::arg("bcs"), py::arg("x0") = py::none(),
+      py::arg("scale") = 1.0);
   m.def(
       "set_bc",
       [](py::array_t<PetscScalar, py::array::c_style> b,
@@ -450,18 +1068,27 @@ void fem(py::module& m)
 
   m.def(
       "create_discrete_gradient",
+      [](const dolfinx::fem::FunctionSpace& V0,
+         const dolfinx::fem::FunctionSpace& V1, int num_threads)
+      { return dolfinx::fem::create_discrete_gradient(V0, V1, num_threads); },
+      py::return_value_policy::take_ownership, py::arg("V0"), py::arg("V1"),
+      py::arg("num_threads") = 1);
+  m.def(
+      "create_interpolation_matrix",
       [](const dolfinx::fem::FunctionSpace& V0,
          const dolfinx::fem::FunctionSpace& V1)
       {
         dolfinx::la::SparsityPattern sp
-            = dolfinx::fem::create_sparsity_discrete_gradient(V0, V1);
-        Mat A = dolfinx::la::create_petsc_matrix(MPI_COMM_WORLD, sp);
-        dolfinx::fem::assemble_discrete_gradient<PetscScalar>(
-            dolfinx::la::PETScMatrix::set_fn(A, ADD_VALUES), V0, V1);
+            = dolfinx::fem::create_sparsity_interpolation(V0, V1);
+        Mat A = dolfinx::la::create_petsc_matrix(V0.mesh()->mpi_comm(), sp);
+        dolfinx::fem::assemble_interpolation_matrix<PetscScalar>(
+            dolfinx::la::PETScMatrix::set_block_fn(A, INSERT_VALUES), V0, V1);
         MatAssemblyBegin(A, MAT_FINAL_ASSEMBLY);
         MatAssemblyEnd(A, MAT_FINAL_ASSEMBLY);
         return A;
       },
+      py::arg("V0"), py::arg("V1"),
+      "Create the matrix that interpolates functions in V1 into V0",
       py::return_value_policy::take_ownership);
 
   py::enum_<dolfinx::fem::IntegralType>(m, "IntegralType")
@@ -528,6 +1155,23 @@ void fem(py::module& m)
       .def_property_readonly("function_spaces",
                              &dolfinx::fem::Form<PetscScalar>::function_spaces)
       .def("integral_ids", &dolfinx::fem::Form<PetscScalar>::integral_ids)
+      .def("sort_domains", &dolfinx::fem::Form<PetscScalar>::sort_domains)
+      .def("cost", &dolfinx::fem::Form<PetscScalar>::cost)
+      .def(
+          "set_batch_kernel",
+          [](dolfinx::fem::Form<PetscScalar>& self,
+             dolfinx::fem::IntegralType type, int i, std::uintptr_t kernel,
+             int batch_size)
+          {
+            auto tabulate_tensor_ptr
+                = (void (*)(PetscScalar*, const PetscScalar*,
+                            const PetscScalar*, const double*, const int*,
+                            const std::uint8_t*))kernel;
+            self.set_batch_kernel(type, i, tabulate_tensor_ptr, batch_size);
+          },
+          py::arg("type"), py::arg("i"), py::arg("kernel"),
+          py::arg("batch_size"),
+          "Set a batched kernel (function pointer) for an integral")
       .def_property_readonly("needs_facet_permutations", &dolfinx::fem::Form<PetscScalar>::needs_facet_permutations)
       .def("domains", [](const dolfinx::fem::Form<PetscScalar>& self,
                          dolfinx::fem::IntegralType type, int i) {
@@ -564,6 +1208,41 @@ void fem(py::module& m)
       },
       py::arg("V"), py::arg("dim"), py::arg("entities"),
       py::arg("remote") = true);
+  m.def(
+      "locate_dofs_topological_batched",
+      [](const std::vector<
+             std::reference_wrapper<const dolfinx::fem::FunctionSpace>>& V,
+         const std::vector<int>& dims,
+         const std::vector<py::array_t<std::int32_t, py::array::c_style>>&
+             entities,
+         bool remote)
+      {
+        if (V.size() != dims.size() or V.size() != entities.size())
+        {
+          throw std::runtime_error(
+              "Expected the same number of spaces, dimensions and entities.");
+        }
+        using V_ref
+            = std::reference_wrapper<const dolfinx::fem::FunctionSpace>;
+        std::vector<std::tuple<V_ref, int, xtl::span<const std::int32_t>>>
+            _entities;
+        for (std::size_t i = 0; i < V.size(); ++i)
+        {
+          _entities.emplace_back(
+              V[i], dims[i],
+              xtl::span(entities[i].data(), entities[i].size()));
+        }
+        std::vector<std::vector<std::int32_t>> dofs
+            = dolfinx::fem::locate_dofs_topological(_entities, remote);
+        std::vector<py::array> _dofs;
+        for (auto& d : dofs)
+          _dofs.push_back(as_pyarray(std::move(d)));
+        return _dofs;
+      },
+      py::arg("V"), py::arg("dims"), py::arg("entities"),
+      py::arg("remote") = true,
+      "Locate dofs topologically for several (space, dimension, entities) "
+      "triples in the same communication rounds");
   m.def(
       "locate_dofs_geometrical",
       [](const std::vector<
@@ -630,7 +1309,8 @@ void fem(py::module& m)
           "interpolate",
           [](dolfinx::fem::Function<PetscScalar>& self,
              const std::function<py::array_t<PetscScalar>(
-                 const py::array_t<double>&)>& f)
+                 const py::array_t<double>&)>& f,
+             const py::object& cells, std::size_t chunk_size)
           {
             auto _f =
                 [&f](const xt::xtensor<double, 2>& x) -> xt::xarray<PetscScalar>
@@ -645,13 +1325,54 @@ void fem(py::module& m)
                 shape.push_back(v.shape()[i]);
               return xt::adapt(v.data(), shape);
             };
-            self.interpolate(_f);
+
+            if (cells.is_none() and chunk_size == 0)
+              self.interpolate(_f);
+            else
+            {
+              std::vector<std::int32_t> _cells;
+              if (cells.is_none())
+              {
+                auto mesh = self.function_space()->mesh();
+                const int tdim = mesh->topology().dim();
+                auto cell_map = mesh->topology().index_map(tdim);
+                _cells.resize(cell_map->size_local()
+                              + cell_map->num_ghosts());
+                std::iota(_cells.begin(), _cells.end(), 0);
+              }
+              else
+              {
+                auto c = cells.cast<
+                    py::array_t<std::int32_t, py::array::c_style>>();
+                _cells.assign(c.data(), c.data() + c.size());
+              }
+              const std::size_t size = chunk_size > 0
+                                           ? chunk_size
+                                           : std::max<std::size_t>(
+                                               _cells.size(), 1);
+              dolfinx::fem::interpolate<PetscScalar>(self, _f, _cells, size);
+            }
           },
-          py::arg("f"), "Interpolate an expression")
+          py::arg("f"), py::arg("cells") = py::none(),
+          py::arg("chunk_size") = 0,
+          "Interpolate an expression, optionally on a subset of cells "
+          "processed in chunks")
       .def("interpolate",
            py::overload_cast<const dolfinx::fem::Function<PetscScalar>&>(
                &dolfinx::fem::Function<PetscScalar>::interpolate),
            py::arg("u"), "Interpolate a finite element function")
+      .def(
+          "migrate",
+          [](dolfinx::fem::Function<PetscScalar>& self,
+             const dolfinx::fem::Function<PetscScalar>& v,
+             const py::array_t<std::int64_t, py::array::c_style>& cells)
+          {
+            dolfinx::fem::migrate_function(
+                self, v, xtl::span(cells.data(), cells.size()));
+          },
+          py::arg("v"), py::arg("cells"),
+          "Copy a finite element function on the original mesh of a "
+          "redistributed mesh")
       .def(
           "interpolate_ptr",
           [](dolfinx::fem::Function<PetscScalar>& self, std::uintptr_t addr)
@@ -717,6 +1438,20 @@ void fem(py::module& m)
           },
           py::arg("x"), py::arg("cells"), py::arg("values"),
           "Evaluate Function")
+      .def(
+          "eval",
+          [](const dolfinx::fem::Function<PetscScalar>& self,
+             const dolfinx::geometry::PointOwnership& points,
+             py::array_t<PetscScalar, py::array::c_style>& u)
+          {
+            xt::xtensor<PetscScalar, 2> _u(
+                {static_cast<std::size_t>(u.shape(0)),
+                 static_cast<std::size_t>(u.shape(1))});
+            self.eval(points, _u);
+            std::copy_n(_u.data(), _u.size(), u.mutable_data());
+          },
+          py::arg("points"), py::arg("values"),
+          "Evaluate Function at distributed points")
       .def(
           "compute_point_values",
           [](const dolfinx::fem::Function<PetscScalar>& self)
@@ -746,6 +1481,38 @@ void fem(py::module& m)
            [](const dolfinx::fem::FunctionSpace& self)
            { return xt_as_pyarray(self.tabulate_dof_coordinates(false)); });
 
+  // dolfinx::fem::InterpolationPlan
+  py::class_<dolfinx::fem::InterpolationPlan,
+             std::shared_ptr<dolfinx::fem::InterpolationPlan>>(
+      m, "InterpolationPlan",
+      "Plan for interpolating Functions from a non-matching mesh")
+      .def(py::init<const dolfinx::fem::FunctionSpace&,
+                    const dolfinx::mesh::Mesh&, int>(),
+           py::arg("V"), py::arg("mesh"), py::arg("num_threads") = 1)
+      .def_property_readonly(
+          "ownership", &dolfinx::fem::InterpolationPlan::ownership,
+          py::return_value_policy::reference_internal)
+      .def("interpolate",
+           &dolfinx::fem::InterpolationPlan::interpolate<PetscScalar>,
+           py::arg("u"), py::arg("v"),
+           "Interpolate v in the space of u");
+
+  // dolfinx::fem::InterpolationOperator
+  py::class_<dolfinx::fem::InterpolationOperator,
+             std::shared_ptr<dolfinx::fem::InterpolationOperator>>(
+      m, "InterpolationOperator",
+      "Operator for interpolating Functions between spaces on the same mesh")
+      .def(py::init<const dolfinx::fem::FunctionSpace&,
+                    const dolfinx::fem::FunctionSpace&>(),
+           py::arg("V0"), py::arg("V1"))
+      .def_property_readonly(
+          "matrix",
+          [](const dolfinx::fem::InterpolationOperator& self)
+          { return xt_as_pyarray(xt::xtensor<double, 2>(self.matrix())); })
+      .def("interpolate",
+           &dolfinx::fem::InterpolationOperator::interpolate<PetscScalar>,
+           py::arg("u"), py::arg("v"), "Interpolate v in the space of u");
+
   // dolfinx::fem::Constant
   py::class_<dolfinx::fem::Constant<PetscScalar>,
              std::shared_ptr<dolfinx::fem::Constant<PetscScalar>>>(
@@ -758,6 +1525,111 @@ void fem(py::module& m)
           { return py::array(self.shape, self.value.data(), py::none()); },
           py::return_value_policy::reference_internal);
 
+  // dolfinx::fem::MatrixFreeOperator
+  py::class_<dolfinx::fem::MatrixFreeOperator<PetscScalar>,
+             std::shared_ptr<dolfinx::fem::MatrixFreeOperator<PetscScalar>>>(
+      m, "MatrixFreeOperator", "Matrix-free action of a bilinear form")
+      .def(py::init<std::shared_ptr<const dolfinx::fem::Form<PetscScalar>>,
+                    const std::vector<std::shared_ptr<
+                        const dolfinx::fem::DirichletBC<PetscScalar>>>&,
+                    PetscScalar>(),
+           py::arg("a"), py::arg("bcs"), py::arg("diagonal") = 1.0)
+      .def("apply",
+           &dolfinx::fem::MatrixFreeOperator<PetscScalar>::apply<
+               std::allocator<PetscScalar>>,
+           py::arg("x"), py::arg("y"), "Compute y = A x");
+  m.def("create_matrix_free", &dolfinx::fem::create_matrix_free,
+        py::return_value_policy::take_ownership, py::arg("A"),
+        "Create a PETSc shell matrix for a matrix-free operator.");
+
+  // dolfinx::fem::TensorProductOperator
+  py::class_<dolfinx::fem::TensorProductOperator<PetscScalar>,
+             std::shared_ptr<
+                 dolfinx::fem::TensorProductOperator<PetscScalar>>>(
+      m, "TensorProductOperator",
+      "Sum-factorised action of kappa (grad u, grad v) + sigma (u, v)")
+      .def(py::init<std::shared_ptr<const dolfinx::fem::FunctionSpace>,
+                    PetscScalar, PetscScalar,
+                    const std::vector<std::shared_ptr<
+                        const dolfinx::fem::DirichletBC<PetscScalar>>>&,
+                    PetscScalar>(),
+           py::arg("V"), py::arg("kappa"), py::arg("sigma"), py::arg("bcs"),
+           py::arg("diagonal") = 1.0)
+      .def("apply",
+           &dolfinx::fem::TensorProductOperator<PetscScalar>::apply<
+               std::allocator<PetscScalar>>,
+           py::arg("x"), py::arg("y"), "Compute y = A x")
+      .def_property_readonly(
+          "function_space",
+          &dolfinx::fem::TensorProductOperator<PetscScalar>::function_space);
+
+  // dolfinx::fem::ElementTensorCache
+  py::class_<dolfinx::fem::ElementTensorCache<PetscScalar>,
+             std::shared_ptr<dolfinx::fem::ElementTensorCache<PetscScalar>>>(
+      m, "ElementTensorCache", "Cached element matrices of a bilinear form")
+      .def(py::init<std::shared_ptr<const dolfinx::fem::Form<PetscScalar>>>(),
+           py::arg("a"))
+      .def_static(
+          "memory_estimate",
+          &dolfinx::fem::ElementTensorCache<PetscScalar>::memory_estimate,
+          py::arg("a"))
+      .def(
+          "assemble",
+          [](dolfinx::fem::ElementTensorCache<PetscScalar>& self, Mat A,
+             const std::vector<std::shared_ptr<
+                 const dolfinx::fem::DirichletBC<PetscScalar>>>& bcs,
+             PetscScalar scale)
+          {
+            self.assemble(dolfinx::la::PETScMatrix::set_block_fn(A, ADD_VALUES),
+                          bcs, scale);
+          },
+          py::arg("A"), py::arg("bcs"), py::arg("scale") = 1.0,
+          "Add the scaled cached element matrices to a PETSc matrix")
+      .def("clear", &dolfinx::fem::ElementTensorCache<PetscScalar>::clear)
+      .def_property_readonly(
+          "cached", &dolfinx::fem::ElementTensorCache<PetscScalar>::cached);
+
+  // dolfinx::fem::StaticCondensation
+  py::class_<dolfinx::fem::StaticCondensation<PetscScalar>,
+             std::shared_ptr<dolfinx::fem::StaticCondensation<PetscScalar>>>(
+      m, "StaticCondensation",
+      "Assembly of a linear system with the cell-interior dofs eliminated")
+      .def(py::init<std::shared_ptr<const dolfinx::fem::Form<PetscScalar>>,
+                    std::shared_ptr<const dolfinx::fem::Form<PetscScalar>>>(),
+           py::arg("a"), py::arg("L"))
+      .def_property_readonly(
+          "dofmap", &dolfinx::fem::StaticCondensation<PetscScalar>::dofmap)
+      .def("create_sparsity_pattern",
+           &dolfinx::fem::StaticCondensation<
+               PetscScalar>::create_sparsity_pattern)
+      .def(
+          "assemble",
+          [](dolfinx::fem::StaticCondensation<PetscScalar>& self, Mat A,
+             py::array_t<PetscScalar, py::array::c_style> b,
+             const std::vector<std::shared_ptr<
+                 const dolfinx::fem::DirichletBC<PetscScalar>>>& bcs)
+          {
+            self.assemble(
+                dolfinx::la::PETScMatrix::set_block_fn(A, ADD_VALUES),
+                xtl::span<PetscScalar>(b.mutable_data(), b.size()), bcs);
+          },
+          py::arg("A"), py::arg("b"), py::arg("bcs"),
+          "Assemble the condensed system into a PETSc matrix and the "
+          "local array (including ghosts) of a vector")
+      .def(
+          "recover",
+          [](const dolfinx::fem::StaticCondensation<PetscScalar>& self,
+             const py::array_t<PetscScalar, py::array::c_style>& x_c,
+             py::array_t<PetscScalar, py::array::c_style> x)
+          {
+            self.recover(
+                xtl::span<const PetscScalar>(x_c.data(), x_c.size()),
+                xtl::span<PetscScalar>(x.mutable_data(), x.size()));
+          },
+          py::arg("x_c"), py::arg("x"),
+          "Recover the solution on the parent dofmap from the solution of "
+          "the condensed system");
+
   // dolfinx::fem::Expression
   py::class_<dolfinx::fem::Expression<PetscScalar>,
              std::shared_ptr<dolfinx::fem::Expression<PetscScalar>>>(
@@ -785,13 +1657,13 @@ void fem(py::module& m)
       .def("eval",
            [](const dolfinx::fem::Expression<PetscScalar>& self,
               const py::array_t<std::int32_t, py::array::c_style>& active_cells,
-              py::array_t<PetscScalar> values)
+              py::array_t<PetscScalar> values, int num_threads)
            {
              dolfinx::array2d<PetscScalar> _values(active_cells.shape()[0],
                                                    self.num_points()
                                                        * self.value_size());
              self.eval(xtl::span(active_cells.data(), active_cells.size()),
-                       _values);
+                       _values, num_threads);
              assert(values.ndim() == 2);
              assert(values.shape()[0] == (py::ssize_t)_values.shape[0]);
              assert(values.shape()[1] == (py::ssize_t)_values.shape[1]);
@@ -799,7 +1671,38 @@ void fem(py::module& m)
              for (py::ssize_t i = 0; i < v.shape(0); i++)
                for (py::ssize_t j = 0; j < v.shape(1); j++)
                  v(i, j) = _values(i, j);
-           })
+           },
+           py::arg("active_cells"), py::arg("values"),
+           py::arg("num_threads") = 1)
+      .def(
+          "eval_chunked",
+          [](const dolfinx::fem::Expression<PetscScalar>& self,
+             const py::array_t<std::int32_t, py::array::c_style>& active_cells,
+             const std::function<void(const py::array_t<std::int32_t>&,
+                                      const py::array_t<PetscScalar>&)>& f,
+             std::size_t chunk_size, int num_threads)
+          {
+            const dolfinx::array2d<PetscScalar> coeffs
+                = dolfinx::fem::pack_coefficients(self);
+            const std::vector<PetscScalar> constants
+                = dolfinx::fem::pack_constants(self);
+            const std::size_t num_cols = self.num_points() * self.value_size();
+            auto _f = [&f, num_cols](const xtl::span<const std::int32_t>& cells,
+                                     const xtl::span<const PetscScalar>& values)
+            {
+              f(py::array_t<std::int32_t>(cells.size(), cells.data()),
+                py::array_t<PetscScalar>(
+                    std::vector<std::size_t>{cells.size(), num_cols},
+                    values.data()));
+            };
+            self.eval_chunked(
+                xtl::span(active_cells.data(), active_cells.size()), _f,
+                chunk_size, coeffs, constants, num_threads);
+          },
+          py::arg("active_cells"), py::arg("f"), py::arg("chunk_size"),
+          py::arg("num_threads") = 1,
+          "Evaluate the Expression in chunks of cells and pass the values "
+          "of each chunk to a function")
       .def_property_readonly("mesh",
                              &dolfinx::fem::Expression<PetscScalar>::mesh,
                              py::return_value_policy::reference_internal)
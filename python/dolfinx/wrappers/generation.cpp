@@ -11,6 +11,7 @@
 #include <dolfinx/generation/BoxMesh.h>
 #include <dolfinx/generation/IntervalMesh.h>
 #include <dolfinx/generation/RectangleMesh.h>
+#include <dolfinx/generation/StructuredGrid.h>
 #include <pybind11/functional.h>
 #include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
@@ -84,5 +85,79 @@ void generation(py::module& m)
       },
       py::arg("comm"), py::arg("p"), py::arg("n"), py::arg("celltype"),
       py::arg("ghost_mode"), py::arg("partitioner"));
+
+  m.def(
+      "create_rectangle_mesh_block",
+      [](const MPICommWrapper comm,
+         const std::array<std::array<double, 3>, 2>& p,
+         std::array<std::size_t, 2> n, dolfinx::mesh::CellType celltype,
+         const std::string& diagonal) {
+        return dolfinx::generation::RectangleMesh::create_block(
+            comm.get(), p, n, celltype, diagonal);
+      },
+      py::arg("comm"), py::arg("p"), py::arg("n"), py::arg("celltype"),
+      py::arg("diagonal"));
+
+  m.def(
+      "create_box_mesh_block",
+      [](const MPICommWrapper comm,
+         const std::array<std::array<double, 3>, 2>& p,
+         std::array<std::size_t, 3> n, dolfinx::mesh::CellType celltype) {
+        return dolfinx::generation::BoxMesh::create_block(comm.get(), p, n,
+                                                          celltype);
+      },
+      py::arg("comm"), py::arg("p"), py::arg("n"), py::arg("celltype"));
+
+  py::class_<dolfinx::generation::StructuredGrid,
+             std::shared_ptr<dolfinx::generation::StructuredGrid>>(
+      m, "StructuredGrid", "Structured grid with an implicit topology")
+      .def_property_readonly("cell_type",
+                             &dolfinx::generation::StructuredGrid::cell_type)
+      .def_property_readonly("dim", &dolfinx::generation::StructuredGrid::dim)
+      .def_property_readonly("num_cells",
+                             &dolfinx::generation::StructuredGrid::num_cells)
+      .def_property_readonly(
+          "num_owned_vertices",
+          &dolfinx::generation::StructuredGrid::num_owned_vertices)
+      .def_property_readonly(
+          "num_vertices", &dolfinx::generation::StructuredGrid::num_vertices)
+      .def_property_readonly(
+          "num_vertices_global",
+          &dolfinx::generation::StructuredGrid::num_vertices_global)
+      .def("cube", &dolfinx::generation::StructuredGrid::cube)
+      .def("cell_vertices",
+           [](const dolfinx::generation::StructuredGrid& self, std::int32_t c)
+           {
+             py::array_t<std::int32_t> vertices(self.num_cell_vertices());
+             self.cell_vertices(
+                 c, xtl::span(vertices.mutable_data(), vertices.size()));
+             return vertices;
+           })
+      .def("vertex", &dolfinx::generation::StructuredGrid::vertex)
+      .def("x", &dolfinx::generation::StructuredGrid::x)
+      .def("global_vertex", &dolfinx::generation::StructuredGrid::global_vertex)
+      .def("create_mesh", &dolfinx::generation::StructuredGrid::create_mesh);
+
+  m.def(
+      "create_rectangle_grid",
+      [](const MPICommWrapper comm,
+         const std::array<std::array<double, 3>, 2>& p,
+         std::array<std::size_t, 2> n, dolfinx::mesh::CellType celltype,
+         const std::string& diagonal) {
+        return dolfinx::generation::RectangleMesh::create_grid(
+            comm.get(), p, n, celltype, diagonal);
+      },
+      py::arg("comm"), py::arg("p"), py::arg("n"), py::arg("celltype"),
+      py::arg("diagonal"));
+
+  m.def(
+      "create_box_grid",
+      [](const MPICommWrapper comm,
+         const std::array<std::array<double, 3>, 2>& p,
+         std::array<std::size_t, 3> n, dolfinx::mesh::CellType celltype) {
+        return dolfinx::generation::BoxMesh::create_grid(comm.get(), p, n,
+                                                         celltype);
+      },
+      py::arg("comm"), py::arg("p"), py::arg("n"), py::arg("celltype"));
 }
 } // namespace dolfinx_wrappers
@@ -7,6 +7,7 @@
 #include "array.h"
 #include "caster_mpi.h"
 #include <dolfinx/geometry/BoundingBoxTree.h>
+#include <dolfinx/geometry/PointOwnership.h>
 #include <dolfinx/geometry/gjk.h>
 #include <dolfinx/geometry/utils.h>
 #include <dolfinx/mesh/Mesh.h>
@@ -36,6 +37,26 @@ void geometry(py::module& m)
 
   m.def("compute_closest_entity", &dolfinx::geometry::compute_closest_entity,
         py::arg("tree"), py::arg("p"), py::arg("mesh"), py::arg("R") = -1);
+  m.def(
+      "compute_closest_entities",
+      [](const dolfinx::geometry::BoundingBoxTree& tree,
+         const py::array_t<double, py::array::c_style>& points,
+         const dolfinx::mesh::Mesh& mesh, int k, int num_threads)
+      {
+        if (points.ndim() != 2 or points.shape(1) != 3)
+          throw std::runtime_error("Points must have shape (num_points, 3).");
+        auto [entities, distances]
+            = dolfinx::geometry::compute_closest_entities(
+                tree, xtl::span(points.data(), points.size()), mesh, k,
+                num_threads);
+        std::array<py::ssize_t, 2> shape = {points.shape(0), k};
+        return py::make_tuple(
+            py::array_t<std::int32_t>(shape, entities.data()),
+            py::array_t<double>(shape, distances.data()));
+      },
+      py::arg("tree"), py::arg("points"), py::arg("mesh"), py::arg("k") = 1,
+      py::arg("num_threads") = 1,
+      "Compute the k closest entities to each point and their distances.");
 
   m.def("compute_collisions_point",
         [](const dolfinx::geometry::BoundingBoxTree& tree,
@@ -46,6 +67,59 @@ void geometry(py::module& m)
         py::overload_cast<const dolfinx::geometry::BoundingBoxTree&,
                           const dolfinx::geometry::BoundingBoxTree&>(
             &dolfinx::geometry::compute_collisions));
+  m.def(
+      "compute_collisions",
+      [](const dolfinx::geometry::BoundingBoxTree& tree,
+         const py::array_t<double, py::array::c_style>& points,
+         int num_threads)
+      {
+        if (points.ndim() != 2 or points.shape(1) != 3)
+          throw std::runtime_error("Points must have shape (num_points, 3).");
+        return dolfinx::geometry::compute_collisions(
+            tree, xtl::span(points.data(), points.size()), num_threads);
+      },
+      py::arg("tree"), py::arg("points"), py::arg("num_threads") = 1,
+      "Compute the bounding box leaves that contain each point.");
+  m.def("compute_distributed_collisions",
+        &dolfinx::geometry::compute_distributed_collisions, py::arg("mesh0"),
+        py::arg("tree0"), py::arg("mesh1"), py::arg("tree1"),
+        py::arg("exact") = true, py::arg("num_threads") = 1,
+        "Compute the colliding entities of two distributed meshes.");
+  m.def(
+      "compute_colliding_cells",
+      [](const dolfinx::mesh::Mesh& mesh,
+         const dolfinx::geometry::BoundingBoxTree& tree,
+         const py::array_t<double, py::array::c_style>& points, int n,
+         int num_threads)
+      {
+        if (points.ndim() != 2 or points.shape(1) != 3)
+          throw std::runtime_error("Points must have shape (num_points, 3).");
+        return dolfinx::geometry::compute_colliding_cells(
+            mesh, tree, xtl::span(points.data(), points.size()), n,
+            num_threads);
+      },
+      py::arg("mesh"), py::arg("tree"), py::arg("points"), py::arg("n") = 0,
+      py::arg("num_threads") = 1,
+      "Compute up to n cells that collide with each point.");
+  m.def(
+      "locate_cells",
+      [](const dolfinx::mesh::Mesh& mesh,
+         const dolfinx::geometry::BoundingBoxTree& tree,
+         const py::array_t<double, py::array::c_style>& points,
+         const py::array_t<std::int32_t, py::array::c_style>& cells,
+         int max_steps, int num_threads)
+      {
+        if (points.ndim() != 2 or points.shape(1) != 3)
+          throw std::runtime_error("Points must have shape (num_points, 3).");
+        if (cells.size() != points.shape(0))
+          throw std::runtime_error("Number of cells and points must match.");
+        return as_pyarray(dolfinx::geometry::locate_cells(
+            mesh, tree, xtl::span(points.data(), points.size()),
+            xtl::span(cells.data(), cells.size()), max_steps, num_threads));
+      },
+      py::arg("mesh"), py::arg("tree"), py::arg("points"), py::arg("cells"),
+      py::arg("max_steps") = 32, py::arg("num_threads") = 1,
+      "Locate the cell of each point by walking from a given cell.");
 
   m.def("compute_distance_gjk",
         [](const py::array_t<double>& p, const py::array_t<double>& q) {
@@ -102,33 +176,109 @@ void geometry(py::module& m)
                                             candidate_cells.size()),
               point, n));
         });
+  m.def(
+      "select_colliding_cells",
+      [](const dolfinx::mesh::Mesh& mesh,
+         const dolfinx::graph::AdjacencyList<std::int32_t>& candidate_cells,
+         const py::array_t<double, py::array::c_style>& points, int n,
+         int num_threads)
+      {
+        if (points.ndim() != 2 or points.shape(1) != 3)
+          throw std::runtime_error("Points must have shape (num_points, 3).");
+        return dolfinx::geometry::select_colliding_cells(
+            mesh, candidate_cells, xtl::span(points.data(), points.size()), n,
+            num_threads);
+      },
+      py::arg("mesh"), py::arg("candidate_cells"), py::arg("points"),
+      py::arg("n"), py::arg("num_threads") = 1);
+
+  // dolfinx::geometry::BuildStrategy enums
+  py::enum_<dolfinx::geometry::BuildStrategy>(m, "BuildStrategy")
+      .value("median", dolfinx::geometry::BuildStrategy::median)
+      .value("sah", dolfinx::geometry::BuildStrategy::sah);
 
   // dolfinx::geometry::BoundingBoxTree
   py::class_<dolfinx::geometry::BoundingBoxTree,
              std::shared_ptr<dolfinx::geometry::BoundingBoxTree>>(
       m, "BoundingBoxTree")
-      .def(py::init<const dolfinx::mesh::Mesh&, int, double>(), py::arg("mesh"),
-           py::arg("tdim"), py::arg("padding") = 0.0)
+      .def(py::init<const dolfinx::mesh::Mesh&, int, double,
+                    dolfinx::geometry::BuildStrategy, int>(),
+           py::arg("mesh"), py::arg("tdim"), py::arg("padding") = 0.0,
+           py::arg("strategy") = dolfinx::geometry::BuildStrategy::median,
+           py::arg("num_threads") = 1, py::call_guard<py::gil_scoped_release>())
       .def(py::init(
                [](const dolfinx::mesh::Mesh& mesh, int tdim,
                   const py::array_t<std::int32_t, py::array::c_style>& entities,
-                  double padding) {
+                  double padding, dolfinx::geometry::BuildStrategy strategy,
+                  int num_threads) {
+                 xtl::span<const std::int32_t> _entities(entities.data(),
+                                                         entities.size());
+                 py::gil_scoped_release release;
                  return dolfinx::geometry::BoundingBoxTree(
-                     mesh, tdim,
-                     xtl::span<const std::int32_t>(entities.data(),
-                                                   entities.size()),
-                     padding);
+                     mesh, tdim, _entities, padding, strategy, num_threads);
                }),
            py::arg("mesh"), py::arg("tdim"), py::arg("entity_indices"),
-           py::arg("padding") = 0.0)
+           py::arg("padding") = 0.0,
+           py::arg("strategy") = dolfinx::geometry::BuildStrategy::median,
+           py::arg("num_threads") = 1)
       .def_property_readonly("num_bboxes",
                              &dolfinx::geometry::BoundingBoxTree::num_bboxes)
       .def("get_bbox", &dolfinx::geometry::BoundingBoxTree::get_bbox)
+      .def("refit", &dolfinx::geometry::BoundingBoxTree::refit,
+           py::arg("mesh"), py::arg("max_cost_ratio") = -1.0,
+           py::arg("num_threads") = 1)
       .def("__repr__", &dolfinx::geometry::BoundingBoxTree::str)
       .def("create_global_tree",
            [](const dolfinx::geometry::BoundingBoxTree& self,
               const MPICommWrapper comm) {
              return self.create_global_tree(comm.get());
            });
+
+  // dolfinx::geometry::PointOwnership
+  py::class_<dolfinx::geometry::PointOwnership,
+             std::shared_ptr<dolfinx::geometry::PointOwnership>>(
+      m, "PointOwnership", "Ownership of points in a distributed mesh")
+      .def(py::init(
+               [](const dolfinx::mesh::Mesh& mesh,
+                  const py::array_t<double, py::array::c_style>& points,
+                  int num_threads)
+               {
+                 if (points.ndim() != 2 or points.shape(1) != 3)
+                 {
+                   throw std::runtime_error(
+                       "Points must have shape (num_points, 3).");
+                 }
+                 return dolfinx::geometry::PointOwnership(
+                     mesh, xtl::span(points.data(), points.size()),
+                     num_threads);
+               }),
+           py::arg("mesh"), py::arg("points"), py::arg("num_threads") = 1)
+      .def_property_readonly("num_points",
+                             &dolfinx::geometry::PointOwnership::num_points)
+      .def_property_readonly(
+          "owners",
+          [](const dolfinx::geometry::PointOwnership& self)
+          {
+            const std::vector<int>& owners = self.owners();
+            return py::array_t<int>(owners.size(), owners.data(),
+                                    py::cast(self));
+          })
+      .def_property_readonly(
+          "owned_points",
+          [](const dolfinx::geometry::PointOwnership& self)
+          {
+            const std::vector<double>& x = self.owned_points();
+            std::array<py::ssize_t, 2> shape
+                = {static_cast<py::ssize_t>(x.size() / 3), 3};
+            return py::array_t<double>(shape, x.data(), py::cast(self));
+          })
+      .def_property_readonly(
+          "owned_cells",
+          [](const dolfinx::geometry::PointOwnership& self)
+          {
+            const std::vector<std::int32_t>& cells = self.owned_cells();
+            return py::array_t<std::int32_t>(cells.size(), cells.data(),
+                                             py::cast(self));
+          });
 }
 } // namespace dolfinx_wrappers
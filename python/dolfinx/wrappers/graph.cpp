@@ -4,8 +4,10 @@
 //
 // SPDX-License-Identifier:    LGPL-3.0-or-later
 
+#include "array.h"
 #include "caster_mpi.h"
 #include <dolfinx/graph/AdjacencyList.h>
+#include <dolfinx/graph/ordering.h>
 #include <dolfinx/graph/partition.h>
 #include <pybind11/numpy.h>
 #include <pybind11/operators.h>
@@ -44,22 +46,32 @@ void declare_adjacency_list(py::module& m, std::string type)
       .def(
           "links",
           [](const dolfinx::graph::AdjacencyList<T>& self, int i) {
-            xtl::span<const T> link = self.links(i);
-            return py::array_t<T>(link.size(), link.data(), py::cast(self));
+            return as_pyarray_view(self.links(i), py::cast(self));
           },
           "Links (edges) of a node")
       .def_property_readonly("array",
                              [](const dolfinx::graph::AdjacencyList<T>& self) {
-                               return py::array_t<T>(self.array().size(),
-                                                     self.array().data(),
-                                                     py::cast(self));
-                             })
-      .def_property_readonly("offsets",
-                             [](const dolfinx::graph::AdjacencyList<T>& self) {
-                               return py::array_t<std::int32_t>(
-                                   self.offsets().size(), self.offsets().data(),
-                                   py::cast(self));
+                               return as_pyarray_view(self.array(),
+                                                      py::cast(self));
                              })
+      .def_property_readonly(
+          "offsets",
+          [](const dolfinx::graph::AdjacencyList<T>& self)
+          {
+            if (self.is_compact())
+            {
+              // Offsets are not stored, so create them
+              py::array_t<std::int32_t> offsets(self.num_nodes() + 1);
+              auto o = offsets.mutable_unchecked();
+              o(0) = 0;
+              for (std::int32_t i = 0; i < self.num_nodes(); ++i)
+                o(i + 1) = o(i) + self.num_links(i);
+              return offsets;
+            }
+            return as_pyarray_view(self.offsets(), py::cast(self));
+          })
+      .def_property_readonly(
+          "is_compact", &dolfinx::graph::AdjacencyList<T>::is_compact)
       .def_property_readonly("num_nodes",
                              &dolfinx::graph::AdjacencyList<T>::num_nodes)
       .def("__eq__", &dolfinx::graph::AdjacencyList<T>::operator==,
@@ -73,5 +85,14 @@ void graph(py::module& m)
 
   declare_adjacency_list<std::int32_t>(m, "int32");
   declare_adjacency_list<std::int64_t>(m, "int64");
+
+  m.def("reorder_rcm", &dolfinx::graph::reorder_rcm, py::arg("graph"),
+        "Compute a reverse Cuthill-McKee re-ordering (map[old] -> new)");
+  m.def("reorder_gps", &dolfinx::graph::reorder_gps, py::arg("graph"),
+        "Compute a Gibbs-Poole-Stockmeyer re-ordering (map[old] -> new)");
+  m.def("reorder_blocked_rcm", &dolfinx::graph::reorder_blocked_rcm,
+        py::arg("graph"), py::arg("block_size") = 4096,
+        "Compute a reverse Cuthill-McKee re-ordering (map[old] -> new) "
+        "within consecutive blocks of nodes");
 }
 } // namespace dolfinx_wrappers
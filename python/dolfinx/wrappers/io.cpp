@@ -10,13 +10,17 @@
 #include <dolfinx/common/array2d.h>
 #include <dolfinx/fem/Function.h>
 #include <dolfinx/fem/FunctionSpace.h>
+#include <dolfinx/io/ADIOS2Writer.h>
+#include <dolfinx/io/AsyncWriter.h>
 #include <dolfinx/io/VTKFile.h>
 #include <dolfinx/io/XDMFFile.h>
 #include <dolfinx/io/cells.h>
+#include <dolfinx/io/mesh_cache.h>
 #include <dolfinx/io/xdmf_utils.h>
 #include <dolfinx/la/PETScVector.h>
 #include <dolfinx/mesh/Mesh.h>
 #include <dolfinx/mesh/MeshTags.h>
+#include <map>
 #include <memory>
 #include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
@@ -59,6 +63,44 @@ void io(py::module& m)
                            as_pyarray(std::move(e.second)));
         });
 
+  // dolfinx::io::mesh_cache
+  m.def("write_mesh_cache", &dolfinx::io::mesh_cache::write, py::arg("mesh"),
+        py::arg("filename"), py::call_guard<py::gil_scoped_release>(),
+        "Write a binary mesh cache");
+  m.def(
+      "read_mesh_cache",
+      [](const MPICommWrapper comm, const std::string& filename)
+      { return dolfinx::io::mesh_cache::read(comm.get(), filename); },
+      py::arg("comm"), py::arg("filename"),
+      py::call_guard<py::gil_scoped_release>(), "Read a binary mesh cache");
+
+  // dolfinx::io::HDF5Interface options
+  py::class_<dolfinx::io::HDF5Interface::FileOptions>(m, "HDF5FileOptions")
+      .def(py::init<>())
+      .def_readwrite("alignment",
+                     &dolfinx::io::HDF5Interface::FileOptions::alignment)
+      .def_readwrite(
+          "alignment_threshold",
+          &dolfinx::io::HDF5Interface::FileOptions::alignment_threshold)
+      .def_readwrite("mpi_hints",
+                     &dolfinx::io::HDF5Interface::FileOptions::mpi_hints);
+  py::class_<dolfinx::io::HDF5Interface::WriteOptions>(m, "HDF5WriteOptions")
+      .def(py::init<>())
+      .def_readwrite("collective",
+                     &dolfinx::io::HDF5Interface::WriteOptions::collective)
+      .def_readwrite("use_chunking",
+                     &dolfinx::io::HDF5Interface::WriteOptions::use_chunking)
+      .def_readwrite("chunk_rows",
+                     &dolfinx::io::HDF5Interface::WriteOptions::chunk_rows)
+      .def_readwrite("deflate_level",
+                     &dolfinx::io::HDF5Interface::WriteOptions::deflate_level)
+      .def_readwrite("shuffle",
+                     &dolfinx::io::HDF5Interface::WriteOptions::shuffle)
+      .def_readwrite("szip", &dolfinx::io::HDF5Interface::WriteOptions::szip)
+      .def_readwrite(
+          "scale_offset_digits",
+          &dolfinx::io::HDF5Interface::WriteOptions::scale_offset_digits);
+
   // dolfinx::io::XDMFFile
   py::class_<dolfinx::io::XDMFFile, std::shared_ptr<dolfinx::io::XDMFFile>>
       xdmf_file(m, "XDMFFile");
@@ -69,14 +111,22 @@ void io(py::module& m)
       .value("ASCII", dolfinx::io::XDMFFile::Encoding::ASCII);
 
   xdmf_file
-      .def(py::init([](const MPICommWrapper comm, const std::string filename,
-                       const std::string file_mode,
-                       dolfinx::io::XDMFFile::Encoding encoding) {
-             return std::make_unique<dolfinx::io::XDMFFile>(
-                 comm.get(), filename, file_mode, encoding);
-           }),
+      .def(py::init(
+               [](const MPICommWrapper comm, const std::string filename,
+                  const std::string file_mode,
+                  dolfinx::io::XDMFFile::Encoding encoding,
+                  const dolfinx::io::HDF5Interface::FileOptions& file_options,
+                  const dolfinx::io::HDF5Interface::WriteOptions&
+                      write_options) {
+                 return std::make_unique<dolfinx::io::XDMFFile>(
+                     comm.get(), filename, file_mode, encoding, file_options,
+                     write_options);
+               }),
            py::arg("comm"), py::arg("filename"), py::arg("file_mode"),
-           py::arg("encoding") = dolfinx::io::XDMFFile::Encoding::HDF5)
+           py::arg("encoding") = dolfinx::io::XDMFFile::Encoding::HDF5,
+           py::arg("file_options") = dolfinx::io::HDF5Interface::FileOptions(),
+           py::arg("write_options")
+           = dolfinx::io::HDF5Interface::WriteOptions())
       .def("__enter__",
            [](std::shared_ptr<dolfinx::io::XDMFFile>& self) { return self; })
       .def("__exit__",
@@ -84,10 +134,17 @@ void io(py::module& m)
               py::object exc_value, py::object traceback) { self.close(); })
       .def("close", &dolfinx::io::XDMFFile::close)
       .def("write_mesh", &dolfinx::io::XDMFFile::write_mesh, py::arg("mesh"),
-           py::arg("xpath") = "/Xdmf/Domain")
+           py::arg("xpath") = "/Xdmf/Domain",
+           py::arg("write_partition") = false,
+           py::call_guard<py::gil_scoped_release>())
+      .def("read_mesh", &dolfinx::io::XDMFFile::read_mesh,
+           py::arg("element"), py::arg("mode"), py::arg("name"),
+           py::arg("xpath") = "/Xdmf/Domain",
+           py::call_guard<py::gil_scoped_release>())
       .def("write_geometry", &dolfinx::io::XDMFFile::write_geometry,
            py::arg("geometry"), py::arg("name") = "geometry",
-           py::arg("xpath") = "/Xdmf/Domain")
+           py::arg("xpath") = "/Xdmf/Domain",
+           py::call_guard<py::gil_scoped_release>())
       .def(
           "read_topology_data",
           [](dolfinx::io::XDMFFile& self, const std::string& name,
@@ -108,21 +165,51 @@ void io(py::module& m)
            py::arg("name") = "mesh", py::arg("xpath") = "/Xdmf/Domain")
       .def("write_function",
            py::overload_cast<const dolfinx::fem::Function<double>&, double,
-                             const std::string&>(
+                             const std::string&, const std::string&>(
                &dolfinx::io::XDMFFile::write_function),
-           py::arg("function"), py::arg("t"), py::arg("mesh_xpath"))
+           py::arg("function"), py::arg("t"), py::arg("mesh_xpath"),
+           py::arg("geometry_xpath") = "",
+           py::call_guard<py::gil_scoped_release>())
       .def(
           "write_function",
           py::overload_cast<const dolfinx::fem::Function<std::complex<double>>&,
-                            double, const std::string&>(
+                            double, const std::string&, const std::string&>(
               &dolfinx::io::XDMFFile::write_function),
-          py::arg("function"), py::arg("t"), py::arg("mesh_xpath"))
+          py::arg("function"), py::arg("t"), py::arg("mesh_xpath"),
+          py::arg("geometry_xpath") = "",
+          py::call_guard<py::gil_scoped_release>())
+      .def("write_checkpoint",
+           py::overload_cast<const dolfinx::fem::Function<double>&,
+                             const std::string&>(
+               &dolfinx::io::XDMFFile::write_checkpoint),
+           py::arg("u"), py::arg("name"),
+           py::call_guard<py::gil_scoped_release>())
+      .def("write_checkpoint",
+           py::overload_cast<
+               const dolfinx::fem::Function<std::complex<double>>&,
+               const std::string&>(&dolfinx::io::XDMFFile::write_checkpoint),
+           py::arg("u"), py::arg("name"),
+           py::call_guard<py::gil_scoped_release>())
+      .def("read_checkpoint",
+           py::overload_cast<dolfinx::fem::Function<double>&,
+                             const std::string&>(
+               &dolfinx::io::XDMFFile::read_checkpoint, py::const_),
+           py::arg("u"), py::arg("name"),
+           py::call_guard<py::gil_scoped_release>())
+      .def("read_checkpoint",
+           py::overload_cast<dolfinx::fem::Function<std::complex<double>>&,
+                             const std::string&>(
+               &dolfinx::io::XDMFFile::read_checkpoint, py::const_),
+           py::arg("u"), py::arg("name"),
+           py::call_guard<py::gil_scoped_release>())
       .def("write_meshtags", &dolfinx::io::XDMFFile::write_meshtags,
            py::arg("meshtags"),
            py::arg("geometry_xpath") = "/Xdmf/Domain/Grid/Geometry",
-           py::arg("xpath") = "/Xdmf/Domain")
+           py::arg("xpath") = "/Xdmf/Domain",
+           py::call_guard<py::gil_scoped_release>())
       .def("read_meshtags", &dolfinx::io::XDMFFile::read_meshtags,
-           py::arg("mesh"), py::arg("name"), py::arg("xpath") = "/Xdmf/Domain")
+           py::arg("mesh"), py::arg("name"), py::arg("xpath") = "/Xdmf/Domain",
+           py::call_guard<py::gil_scoped_release>())
       .def("write_information", &dolfinx::io::XDMFFile::write_information,
            py::arg("name"), py::arg("value"), py::arg("xpath") = "/Xdmf/Domain")
       .def("read_information", &dolfinx::io::XDMFFile::read_information,
@@ -132,35 +219,147 @@ void io(py::module& m)
       });
 
   // dolfinx::io::VTKFile
-  py::class_<dolfinx::io::VTKFile, std::shared_ptr<dolfinx::io::VTKFile>>(
-      m, "VTKFile")
-      .def(py::init([](const MPICommWrapper comm, const std::string& filename,
-                       const std::string& mode) {
-             return std::make_unique<dolfinx::io::VTKFile>(comm.get(),
-                                                              filename, mode);
-           }),
-           py::arg("comm"), py::arg("filename"), py::arg("mode"))
+  py::class_<dolfinx::io::VTKFile, std::shared_ptr<dolfinx::io::VTKFile>>
+      vtk_file(m, "VTKFile");
+
+  // dolfinx::io::VTKFile::Encoding enums
+  py::enum_<dolfinx::io::VTKFile::Encoding>(vtk_file, "Encoding")
+      .value("ASCII", dolfinx::io::VTKFile::Encoding::ASCII)
+      .value("Raw", dolfinx::io::VTKFile::Encoding::Raw)
+      .value("ZLib", dolfinx::io::VTKFile::Encoding::ZLib);
+
+  vtk_file
+      .def(py::init(
+               [](const MPICommWrapper comm, const std::string& filename,
+                  const std::string& mode,
+                  dolfinx::io::VTKFile::Encoding encoding,
+                  int ranks_per_file) {
+                 return std::make_unique<dolfinx::io::VTKFile>(
+                     comm.get(), filename, mode, encoding, ranks_per_file);
+               }),
+           py::arg("comm"), py::arg("filename"), py::arg("mode"),
+           py::arg("encoding") = dolfinx::io::VTKFile::Encoding::ASCII,
+           py::arg("ranks_per_file") = 1)
       .def("__enter__",
            [](std::shared_ptr<dolfinx::io::VTKFile>& self) { return self; })
       .def("__exit__",
            [](dolfinx::io::VTKFile& self, py::object exc_type,
               py::object exc_value, py::object traceback) { self.close(); })
       .def("close", &dolfinx::io::VTKFile::close)
+      .def(
+          "set_cells",
+          [](dolfinx::io::VTKFile& self,
+             const py::array_t<std::int32_t, py::array::c_style>& cells)
+          { self.set_cells(xtl::span(cells.data(), cells.size())); },
+          py::arg("cells"))
+      .def("set_cells",
+           py::overload_cast<const dolfinx::mesh::MeshTags<std::int32_t>&,
+                             std::int32_t>(&dolfinx::io::VTKFile::set_cells),
+           py::arg("tags"), py::arg("value"))
+      .def("set_stride", &dolfinx::io::VTKFile::set_stride,
+           py::arg("stride"))
       .def("write",
            py::overload_cast<const std::vector<std::reference_wrapper<
                                  const dolfinx::fem::Function<double>>>&,
                              double>(&dolfinx::io::VTKFile::write),
-           py::arg("u"), py::arg("t") = 0.0)
+           py::arg("u"), py::arg("t") = 0.0,
+           py::call_guard<py::gil_scoped_release>())
       .def("write",
            py::overload_cast<
                const std::vector<std::reference_wrapper<
                    const dolfinx::fem::Function<std::complex<double>>>>&,
                double>(&dolfinx::io::VTKFile::write),
-           py::arg("u"), py::arg("t") = 0.0)
+           py::arg("u"), py::arg("t") = 0.0,
+           py::call_guard<py::gil_scoped_release>())
 
       .def("write",
            py::overload_cast<const dolfinx::mesh::Mesh&, double>(
                &dolfinx::io::VTKFile::write),
-           py::arg("mesh"), py::arg("t") = 0.0);
+           py::arg("mesh"), py::arg("t") = 0.0,
+           py::call_guard<py::gil_scoped_release>());
+
+  // dolfinx::io::AsyncWriter
+  py::class_<dolfinx::io::AsyncWriter,
+             std::shared_ptr<dolfinx::io::AsyncWriter>>(
+      m, "AsyncWriter", "Write output in a background thread")
+      .def(py::init<std::size_t>(), py::arg("max_pending") = 2)
+      .def("write_function",
+           py::overload_cast<dolfinx::io::XDMFFile&,
+                             const dolfinx::fem::Function<double>&, double,
+                             const std::string&>(
+               &dolfinx::io::AsyncWriter::write_function<double>),
+           py::arg("file"), py::arg("u"), py::arg("t"),
+           py::arg("mesh_xpath") = "/Xdmf/Domain/Grid[@GridType='Uniform'][1]",
+           py::keep_alive<1, 2>(), py::call_guard<py::gil_scoped_release>())
+      .def("write_function",
+           py::overload_cast<
+               dolfinx::io::XDMFFile&,
+               const dolfinx::fem::Function<std::complex<double>>&, double,
+               const std::string&>(
+               &dolfinx::io::AsyncWriter::write_function<std::complex<double>>),
+           py::arg("file"), py::arg("u"), py::arg("t"),
+           py::arg("mesh_xpath") = "/Xdmf/Domain/Grid[@GridType='Uniform'][1]",
+           py::keep_alive<1, 2>(), py::call_guard<py::gil_scoped_release>())
+      .def("write_function",
+           py::overload_cast<
+               dolfinx::io::VTKFile&,
+               const std::vector<std::reference_wrapper<
+                   const dolfinx::fem::Function<double>>>&,
+               double>(&dolfinx::io::AsyncWriter::write_function<double>),
+           py::arg("file"), py::arg("u"), py::arg("t") = 0.0,
+           py::keep_alive<1, 2>(), py::call_guard<py::gil_scoped_release>())
+      .def("write_function",
+           py::overload_cast<
+               dolfinx::io::VTKFile&,
+               const std::vector<std::reference_wrapper<
+                   const dolfinx::fem::Function<std::complex<double>>>>&,
+               double>(
+               &dolfinx::io::AsyncWriter::write_function<std::complex<double>>),
+           py::arg("file"), py::arg("u"), py::arg("t") = 0.0,
+           py::keep_alive<1, 2>(), py::call_guard<py::gil_scoped_release>())
+      .def("wait", &dolfinx::io::AsyncWriter::wait,
+           py::call_guard<py::gil_scoped_release>())
+      .def_property_readonly("num_pending",
+                             &dolfinx::io::AsyncWriter::num_pending)
+      .def_property_readonly("asynchronous",
+                             &dolfinx::io::AsyncWriter::asynchronous);
+
+#ifdef HAS_ADIOS2
+  // dolfinx::io::ADIOS2Writer
+  py::class_<dolfinx::io::ADIOS2Writer,
+             std::shared_ptr<dolfinx::io::ADIOS2Writer>>(
+      m, "ADIOS2Writer", "Output of meshes and functions with ADIOS2")
+      .def(py::init(
+               [](const MPICommWrapper comm, const std::string& filename,
+                  const std::string& engine,
+                  const std::map<std::string, std::string>& parameters) {
+                 return std::make_unique<dolfinx::io::ADIOS2Writer>(
+                     comm.get(), filename, engine, parameters);
+               }),
+           py::arg("comm"), py::arg("filename"), py::arg("engine") = "BP4",
+           py::arg("parameters") = std::map<std::string, std::string>())
+      .def("__enter__",
+           [](std::shared_ptr<dolfinx::io::ADIOS2Writer>& self)
+           { return self; })
+      .def("__exit__",
+           [](dolfinx::io::ADIOS2Writer& self, py::object exc_type,
+              py::object exc_value, py::object traceback) { self.close(); })
+      .def("close", &dolfinx::io::ADIOS2Writer::close)
+      .def("write_mesh", &dolfinx::io::ADIOS2Writer::write_mesh,
+           py::arg("mesh"), py::call_guard<py::gil_scoped_release>())
+      .def("write_function",
+           py::overload_cast<const dolfinx::fem::Function<double>&, double>(
+               &dolfinx::io::ADIOS2Writer::write_function),
+           py::arg("u"), py::arg("t") = 0.0,
+           py::call_guard<py::gil_scoped_release>())
+      .def("write_function",
+           py::overload_cast<
+               const dolfinx::fem::Function<std::complex<double>>&, double>(
+               &dolfinx::io::ADIOS2Writer::write_function),
+           py::arg("u"), py::arg("t") = 0.0,
+           py::call_guard<py::gil_scoped_release>())
+      .def("comm", [](dolfinx::io::ADIOS2Writer& self)
+           { return MPICommWrapper(self.comm()); });
+#endif
 }
 } // namespace dolfinx_wrappers
@@ -7,7 +7,10 @@
 #include "array.h"
 #include "caster_mpi.h"
 #include "caster_petsc.h"
+#include <algorithm>
 #include <dolfinx/common/IndexMap.h>
+#include <dolfinx/la/MatrixCSR.h>
+#include <dolfinx/la/PETScKrylovSolver.h>
 #include <dolfinx/la/PETScMatrix.h>
 #include <dolfinx/la/PETScVector.h>
 #include <dolfinx/la/SparsityPattern.h>
@@ -54,8 +57,13 @@ void la(py::module& m)
             return dolfinx::la::SparsityPattern(comm.get(), patterns, maps, bs);
           }))
       .def("index_map", &dolfinx::la::SparsityPattern::index_map)
-      .def("assemble", &dolfinx::la::SparsityPattern::assemble)
+      .def("count_begin", &dolfinx::la::SparsityPattern::count_begin)
+      .def("count_end", &dolfinx::la::SparsityPattern::count_end)
+      .def("assemble", &dolfinx::la::SparsityPattern::assemble,
+           py::arg("num_threads") = 1)
       .def("num_nonzeros", &dolfinx::la::SparsityPattern::num_nonzeros)
+      .def("memory_usage", &dolfinx::la::SparsityPattern::memory_usage,
+           "Memory allocated by the sparsity pattern (bytes)")
       .def("insert", &dolfinx::la::SparsityPattern::insert)
       .def("insert_diagonal", &dolfinx::la::SparsityPattern::insert_diagonal)
       .def_property_readonly("diagonal_pattern",
@@ -85,7 +93,11 @@ void la(py::module& m)
            py::arg("tol") = 1.0e-10)
       .def("in_nullspace", &dolfinx::la::VectorSpaceBasis::in_nullspace,
            py::arg("A"), py::arg("tol") = 1.0e-10)
-      .def("orthogonalize", &dolfinx::la::VectorSpaceBasis::orthogonalize)
+      .def("orthogonalize",
+           [](const dolfinx::la::VectorSpaceBasis& self, Vec x) {
+             dolfinx::la::PETScVector _x(x, true);
+             self.orthogonalize(_x);
+           })
       .def("orthonormalize", &dolfinx::la::VectorSpaceBasis::orthonormalize,
            py::arg("tol") = 1.0e-10)
       .def("dim", &dolfinx::la::VectorSpaceBasis::dim)
@@ -93,18 +105,120 @@ void la(py::module& m)
         return self[i]->vec();
       });
 
+  // dolfinx::la::PreconditionerReuse
+  py::class_<dolfinx::la::PreconditionerReuse>(m, "PreconditionerReuse")
+      .def(py::init(
+               [](int max_solves, double max_iteration_growth,
+                  bool keep_symbolic) {
+                 return dolfinx::la::PreconditionerReuse{
+                     max_solves, max_iteration_growth, keep_symbolic};
+               }),
+           py::arg("max_solves") = 0, py::arg("max_iteration_growth") = 0.0,
+           py::arg("keep_symbolic") = false)
+      .def_readwrite("max_solves",
+                     &dolfinx::la::PreconditionerReuse::max_solves)
+      .def_readwrite("max_iteration_growth",
+                     &dolfinx::la::PreconditionerReuse::max_iteration_growth)
+      .def_readwrite("keep_symbolic",
+                     &dolfinx::la::PreconditionerReuse::keep_symbolic);
+
+  // dolfinx::la::PETScKrylovSolver
+  py::class_<dolfinx::la::PETScKrylovSolver,
+             std::shared_ptr<dolfinx::la::PETScKrylovSolver>>(
+      m, "PETScKrylovSolver")
+      .def(py::init([](const MPICommWrapper comm) {
+        return std::make_unique<dolfinx::la::PETScKrylovSolver>(comm.get());
+      }))
+      .def(py::init<KSP, bool>(), py::arg("ksp"),
+           py::arg("inc_ref_count") = true)
+      .def_property_readonly("ksp", &dolfinx::la::PETScKrylovSolver::ksp)
+      .def("set_operators", &dolfinx::la::PETScKrylovSolver::set_operators)
+      .def("set_from_options",
+           &dolfinx::la::PETScKrylovSolver::set_from_options)
+      .def("solve",
+           py::overload_cast<Vec, const Vec, bool>(
+               &dolfinx::la::PETScKrylovSolver::solve, py::const_),
+           py::arg("x"), py::arg("b"), py::arg("transpose") = false)
+      .def("set_preconditioner_reuse",
+           &dolfinx::la::PETScKrylovSolver::set_preconditioner_reuse)
+      .def_property_readonly(
+          "preconditioner_reuse",
+          &dolfinx::la::PETScKrylovSolver::preconditioner_reuse)
+      .def("rebuild_preconditioner",
+           &dolfinx::la::PETScKrylovSolver::rebuild_preconditioner)
+      .def("set_up", &dolfinx::la::PETScKrylovSolver::set_up);
+
   // dolfinx::la::Vector
   py::class_<dolfinx::la::Vector<PetscScalar>,
              std::shared_ptr<dolfinx::la::Vector<PetscScalar>>>(m, "Vector")
+      .def(py::init<std::shared_ptr<const dolfinx::common::IndexMap>, int>(),
+           py::arg("map"), py::arg("bs"))
+      .def_property_readonly("map", &dolfinx::la::Vector<PetscScalar>::map,
+                             "Index map that describes the parallel layout")
+      .def_property_readonly("bs", &dolfinx::la::Vector<PetscScalar>::bs,
+                             "Block size")
       .def_property_readonly(
           "array",
           [](dolfinx::la::Vector<PetscScalar>& self) {
             std::vector<PetscScalar>& array = self.mutable_array();
             return py::array(array.size(), array.data(), py::cast(self));
           })
+      .def_property_readonly("version",
+                             &dolfinx::la::Vector<PetscScalar>::version,
+                             "Version of the vector data")
+      .def("increment_version",
+           &dolfinx::la::Vector<PetscScalar>::increment_version)
+      .def("memory_usage", &dolfinx::la::Vector<PetscScalar>::memory_usage,
+           "Memory allocated by the vector (bytes)")
       .def("scatter_forward", &dolfinx::la::Vector<PetscScalar>::scatter_fwd)
       .def("scatter_reverse", &dolfinx::la::Vector<PetscScalar>::scatter_rev);
 
+  // dolfinx::la::MatrixCSR
+  py::class_<dolfinx::la::MatrixCSR<PetscScalar>,
+             std::shared_ptr<dolfinx::la::MatrixCSR<PetscScalar>>>(
+      m, "MatrixCSR", "Distributed block compressed sparse row matrix")
+      .def(py::init<const dolfinx::la::SparsityPattern&>(), py::arg("p"))
+      .def("set", &dolfinx::la::MatrixCSR<PetscScalar>::set, py::arg("x"))
+      .def("finalize", &dolfinx::la::MatrixCSR<PetscScalar>::finalize)
+      .def(
+          "to_dense",
+          [](const dolfinx::la::MatrixCSR<PetscScalar>& self)
+          {
+            const std::array<int, 2> bs = self.block_size();
+            const std::size_t num_rows
+                = bs[0] * self.index_map(0)->size_local();
+            const std::size_t num_cols
+                = bs[1] * self.column_indices().size();
+            const std::vector<PetscScalar> A = self.to_dense();
+            py::array_t<PetscScalar> dense({num_rows, num_cols});
+            std::copy(A.begin(), A.end(), dense.mutable_data());
+            return dense;
+          },
+          "Dense copy of the owned rows, with the local columns (see "
+          "column_indices)")
+      .def_property_readonly(
+          "values",
+          [](py::object self)
+          {
+            xtl::span<PetscScalar> x
+                = self.cast<dolfinx::la::MatrixCSR<PetscScalar>&>().values();
+            return py::array_t<PetscScalar>(x.size(), x.data(), self);
+          })
+      .def_property_readonly(
+          "column_indices",
+          [](py::object self)
+          {
+            return as_pyarray_view(
+                self.cast<const dolfinx::la::MatrixCSR<PetscScalar>&>()
+                    .column_indices(),
+                self);
+          },
+          "Global (block) indices of the local columns")
+      .def_property_readonly(
+          "block_size", &dolfinx::la::MatrixCSR<PetscScalar>::block_size)
+      .def("index_map", &dolfinx::la::MatrixCSR<PetscScalar>::index_map,
+           py::arg("dim"));
+
   m.def("create_vector",
         py::overload_cast<const dolfinx::common::IndexMap&, int>(
             &dolfinx::la::create_petsc_vector),
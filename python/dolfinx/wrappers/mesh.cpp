@@ -11,6 +11,9 @@
 #include <dolfinx/common/array2d.h>
 #include <dolfinx/fem/CoordinateElement.h>
 #include <dolfinx/fem/ElementDofLayout.h>
+#include <dolfinx/graph/kahip.h>
+#include <dolfinx/graph/parmetis.h>
+#include <dolfinx/graph/scotch.h>
 #include <dolfinx/mesh/Geometry.h>
 #include <dolfinx/mesh/Mesh.h>
 #include <dolfinx/mesh/MeshTags.h>
@@ -58,14 +61,22 @@ void declare_meshtags(py::module& m, std::string type)
       .def("ufl_id", &dolfinx::mesh::MeshTags<T>::id)
       .def_property_readonly("values",
                              [](dolfinx::mesh::MeshTags<T>& self) {
-                               return py::array_t<T>(self.values().size(),
-                                                     self.values().data(),
-                                                     py::cast(self));
+                               return as_pyarray_view(self.values(),
+                                                      py::cast(self));
                              })
-      .def_property_readonly("indices", [](dolfinx::mesh::MeshTags<T>& self) {
-        return py::array_t<std::int32_t>(self.indices().size(),
-                                         self.indices().data(), py::cast(self));
-      });
+      .def_property_readonly("indices",
+                             [](dolfinx::mesh::MeshTags<T>& self) {
+                               return as_pyarray_view(self.indices(),
+                                                      py::cast(self));
+                             })
+      .def(
+          "find",
+          [](dolfinx::mesh::MeshTags<T>& self, T value) {
+            return as_pyarray_view(self.entities(value), py::cast(self));
+          },
+          py::arg("value"),
+          "Return the (sorted) entities with a given tag value. An index of "
+          "the entities by value is built on the first call.");
 
   m.def("create_meshtags",
         [](const std::shared_ptr<const dolfinx::mesh::Mesh>& mesh, int dim,
@@ -74,6 +85,14 @@ void declare_meshtags(py::module& m, std::string type)
           return dolfinx::mesh::create_meshtags(
               mesh, dim, entities, xtl::span(values.data(), values.size()));
         });
+
+  m.def("migrate_meshtags",
+        [](const dolfinx::mesh::MeshTags<T>& tags,
+           const std::shared_ptr<const dolfinx::mesh::Mesh>& mesh,
+           const py::array_t<std::int64_t, py::array::c_style>& cells) {
+          return dolfinx::mesh::migrate_meshtags(
+              tags, mesh, xtl::span(cells.data(), cells.size()));
+        });
 }
 
 void mesh(py::module& m)
@@ -103,9 +122,31 @@ void mesh(py::module& m)
           return xt_as_pyarray(dolfinx::mesh::cell_normals(
               mesh, dim, xtl::span(entities.data(), entities.size())));
         });
+  m.def(
+      "cell_normals",
+      [](const dolfinx::mesh::Mesh& mesh, int dim,
+         const py::array_t<std::int32_t, py::array::c_style>& entities,
+         py::array_t<double, py::array::c_style>& n, int num_threads)
+      {
+        dolfinx::mesh::cell_normals(
+            mesh, dim, xtl::span(entities.data(), entities.size()),
+            xtl::span(n.mutable_data(), n.size()), num_threads);
+      },
+      py::arg("mesh"), py::arg("dim"), py::arg("entities"), py::arg("n"),
+      py::arg("num_threads") = 1,
+      "Compute cell normals into an array with shape (num_entities, 3).");
   m.def("get_entity_vertices", &dolfinx::mesh::get_entity_vertices);
   m.def("extract_topology", &dolfinx::mesh::extract_topology);
 
+  m.def(
+      "memory_usage",
+      [](const dolfinx::mesh::Mesh& mesh)
+      {
+        return dolfinx::mesh::memory_usage(mesh)
+            .reduce(mesh.mpi_comm(), dolfinx::Table::Reduction::max)
+            .str();
+      },
+      "Summary of the memory used by a mesh (MPI_MAX reduction).");
   m.def(
       "h",
       [](const dolfinx::mesh::Mesh& mesh, int dim,
@@ -114,6 +155,19 @@ void mesh(py::module& m)
             mesh, xtl::span(entities.data(), entities.size()), dim));
       },
       "Compute maximum distance between any two vertices.");
+  m.def(
+      "h",
+      [](const dolfinx::mesh::Mesh& mesh, int dim,
+         const py::array_t<std::int32_t, py::array::c_style>& entities,
+         py::array_t<double, py::array::c_style>& h, int num_threads)
+      {
+        dolfinx::mesh::h(mesh, xtl::span(entities.data(), entities.size()),
+                         dim, xtl::span(h.mutable_data(), h.size()),
+                         num_threads);
+      },
+      py::arg("mesh"), py::arg("dim"), py::arg("entities"), py::arg("h"),
+      py::arg("num_threads") = 1,
+      "Compute maximum distance between any two vertices into an array.");
 
   m.def("midpoints",
         [](const dolfinx::mesh::Mesh& mesh, int dim,
@@ -121,6 +175,19 @@ void mesh(py::module& m)
           return xt_as_pyarray(dolfinx::mesh::midpoints(
               mesh, dim, xtl::span(entity_list.data(), entity_list.size())));
         });
+  m.def(
+      "midpoints",
+      [](const dolfinx::mesh::Mesh& mesh, int dim,
+         const py::array_t<std::int32_t, py::array::c_style>& entities,
+         py::array_t<double, py::array::c_style>& x, int num_threads)
+      {
+        dolfinx::mesh::midpoints(
+            mesh, dim, xtl::span(entities.data(), entities.size()),
+            xtl::span(x.mutable_data(), x.size()), num_threads);
+      },
+      py::arg("mesh"), py::arg("dim"), py::arg("entities"), py::arg("x"),
+      py::arg("num_threads") = 1,
+      "Compute midpoints into an array with shape (num_entities, 3).");
   m.def("compute_boundary_facets", &dolfinx::mesh::compute_boundary_facets);
 
   using PythonPartitioningFunction
@@ -135,6 +202,138 @@ void mesh(py::module& m)
           return dolfinx::mesh::build_dual_graph(comm.get(), cells, tdim);
         });
 
+  m.def(
+      "create_cell_partitioner_sfc",
+      [](const py::array_t<double, py::array::c_style>& x)
+      {
+        const std::size_t shape1 = x.ndim() == 1 ? 1 : x.shape()[1];
+        std::array<std::size_t, 2> shape
+            = {static_cast<std::size_t>(x.shape(0)), shape1};
+        auto _x = xt::adapt(x.data(), x.size(), xt::no_ownership(), shape);
+        auto partitioner = dolfinx::mesh::create_cell_partitioner_sfc(_x);
+        return PythonPartitioningFunction(
+            [partitioner](
+                const MPICommWrapper comm, int n, int tdim,
+                const dolfinx::graph::AdjacencyList<std::int64_t>& cells,
+                dolfinx::mesh::GhostMode ghost_mode)
+            { return partitioner(comm.get(), n, tdim, cells, ghost_mode); });
+      },
+      py::arg("x"),
+      "Create a cell partitioner that orders cells along a Hilbert "
+      "space-filling curve");
+
+  m.def(
+      "create_cell_partitioner_hierarchical",
+      []()
+      {
+        auto partitioner = dolfinx::mesh::create_cell_partitioner(
+            dolfinx::graph::create_hierarchical_partitioner());
+        return PythonPartitioningFunction(
+            [partitioner](
+                const MPICommWrapper comm, int n, int tdim,
+                const dolfinx::graph::AdjacencyList<std::int64_t>& cells,
+                dolfinx::mesh::GhostMode ghost_mode)
+            { return partitioner(comm.get(), n, tdim, cells, ghost_mode); });
+      },
+      "Create a cell partitioner that first partitions cells across compute "
+      "nodes and then across the processes on each node");
+
+  m.def(
+      "create_cell_partitioner_diffusion",
+      [](double imbalance, int max_iterations)
+      {
+        auto partitioner = dolfinx::mesh::create_cell_partitioner(
+            dolfinx::graph::create_diffusion_partitioner(
+                &dolfinx::graph::partition_graph, imbalance, max_iterations));
+        return PythonPartitioningFunction(
+            [partitioner](
+                const MPICommWrapper comm, int n, int tdim,
+                const dolfinx::graph::AdjacencyList<std::int64_t>& cells,
+                dolfinx::mesh::GhostMode ghost_mode)
+            { return partitioner(comm.get(), n, tdim, cells, ghost_mode); });
+      },
+      py::arg("imbalance") = 1.05, py::arg("max_iterations") = 100,
+      "Create a cell partitioner that balances the cells by moving cells "
+      "between neighbouring processes, starting from the input "
+      "distribution");
+
+  // dolfinx::graph::scotch::strategy enums
+  py::enum_<dolfinx::graph::scotch::strategy>(m, "ScotchStrategy")
+      .value("none", dolfinx::graph::scotch::strategy::none)
+      .value("balance", dolfinx::graph::scotch::strategy::balance)
+      .value("quality", dolfinx::graph::scotch::strategy::quality)
+      .value("safety", dolfinx::graph::scotch::strategy::safety)
+      .value("speed", dolfinx::graph::scotch::strategy::speed)
+      .value("scalability", dolfinx::graph::scotch::strategy::scalability);
+
+  m.def(
+      "create_cell_partitioner_scotch",
+      [](dolfinx::graph::scotch::strategy strategy, double imbalance,
+         int seed, int num_threads)
+      {
+        auto partitioner = dolfinx::mesh::create_cell_partitioner(
+            dolfinx::graph::scotch::partitioner(strategy, imbalance, seed,
+                                                num_threads));
+        return PythonPartitioningFunction(
+            [partitioner](
+                const MPICommWrapper comm, int n, int tdim,
+                const dolfinx::graph::AdjacencyList<std::int64_t>& cells,
+                dolfinx::mesh::GhostMode ghost_mode)
+            { return partitioner(comm.get(), n, tdim, cells, ghost_mode); });
+      },
+      py::arg("strategy") = dolfinx::graph::scotch::strategy::none,
+      py::arg("imbalance") = 0.025, py::arg("seed") = 0,
+      py::arg("num_threads") = 1,
+      "Create a cell partitioner that uses PT-SCOTCH with the given "
+      "strategy, imbalance, seed and number of threads per process");
+
+#ifdef HAS_PARMETIS
+  m.def(
+      "create_cell_partitioner_parmetis",
+      [](double imbalance, std::array<int, 3> options)
+      {
+        auto partitioner = dolfinx::mesh::create_cell_partitioner(
+            dolfinx::graph::parmetis::partitioner(imbalance, options));
+        return PythonPartitioningFunction(
+            [partitioner](
+                const MPICommWrapper comm, int n, int tdim,
+                const dolfinx::graph::AdjacencyList<std::int64_t>& cells,
+                dolfinx::mesh::GhostMode ghost_mode)
+            { return partitioner(comm.get(), n, tdim, cells, ghost_mode); });
+      },
+      py::arg("imbalance") = 0.05,
+      py::arg("options") = std::array<int, 3>{0, 0, 0},
+      "Create a cell partitioner that uses ParMETIS");
+#endif
+
+#ifdef HAS_KAHIP
+  m.def(
+      "create_cell_partitioner_kahip",
+      [](int mode, int seed, double imbalance)
+      {
+        auto partitioner = dolfinx::mesh::create_cell_partitioner(
+            dolfinx::graph::kahip::partitioner(mode, seed, imbalance));
+        return PythonPartitioningFunction(
+            [partitioner](
+                const MPICommWrapper comm, int n, int tdim,
+                const dolfinx::graph::AdjacencyList<std::int64_t>& cells,
+                dolfinx::mesh::GhostMode ghost_mode)
+            { return partitioner(comm.get(), n, tdim, cells, ghost_mode); });
+      },
+      py::arg("mode") = 1, py::arg("seed") = 0, py::arg("imbalance") = 0.03,
+      "Create a cell partitioner that uses KaHIP. The mode trades "
+      "partitioning time for quality (0: ultrafast, 1: fast, 2: eco, and "
+      "3-5 the corresponding mesh modes)");
+#endif
+
+  // dolfinx::mesh::CellReordering enums
+  py::enum_<dolfinx::mesh::CellReordering>(m, "CellReordering")
+      .value("none", dolfinx::mesh::CellReordering::none)
+      .value("gps", dolfinx::mesh::CellReordering::gps)
+      .value("reverse_cuthill_mckee",
+             dolfinx::mesh::CellReordering::reverse_cuthill_mckee)
+      .value("morton", dolfinx::mesh::CellReordering::morton);
+
   m.def(
       "create_mesh",
       [](const MPICommWrapper comm,
@@ -142,7 +341,8 @@ void mesh(py::module& m)
          const dolfinx::fem::CoordinateElement& element,
          const py::array_t<double, py::array::c_style>& x,
          dolfinx::mesh::GhostMode ghost_mode,
-         PythonPartitioningFunction partitioner) {
+         PythonPartitioningFunction partitioner,
+         dolfinx::mesh::CellReordering reordering) {
         auto partitioner_wrapper
             = [partitioner](
                   MPI_Comm comm, int n, int tdim,
@@ -156,11 +356,52 @@ void mesh(py::module& m)
         std::array<std::size_t, 2> shape
             = {static_cast<std::size_t>(x.shape(0)), shape1};
         auto _x = xt::adapt(x.data(), x.size(), xt::no_ownership(), shape);
+
+        // The partitioner acquires the GIL when it is called
+        py::gil_scoped_release release;
         return dolfinx::mesh::create_mesh(comm.get(), cells, element, _x,
-                                          ghost_mode, partitioner_wrapper);
+                                          ghost_mode, partitioner_wrapper,
+                                          reordering);
       },
+      py::arg("comm"), py::arg("cells"), py::arg("element"), py::arg("x"),
+      py::arg("ghost_mode"), py::arg("partitioner"),
+      py::arg("reordering") = dolfinx::mesh::CellReordering::gps,
       "Helper function for creating meshes.");
 
+  m.def(
+      "redistribute",
+      [](const dolfinx::mesh::Mesh& mesh,
+         const py::array_t<std::int32_t, py::array::c_style>& dest,
+         dolfinx::mesh::GhostMode ghost_mode,
+         dolfinx::mesh::CellReordering reordering) {
+        auto [mesh1, cells] = dolfinx::mesh::redistribute(
+            mesh, xtl::span(dest.data(), dest.size()), ghost_mode,
+            reordering);
+        return py::make_tuple(std::move(mesh1), as_pyarray(std::move(cells)));
+      },
+      py::arg("mesh"), py::arg("dest"), py::arg("ghost_mode"),
+      py::arg("reordering") = dolfinx::mesh::CellReordering::gps,
+      "Redistribute a mesh. Returns the new mesh and the original global "
+      "index of each of its cells.");
+
+  m.def(
+      "create_submesh",
+      [](const dolfinx::mesh::Mesh& mesh, int dim,
+         const py::array_t<std::int32_t, py::array::c_style>& entities)
+      {
+        auto [submesh, entity_map, vertex_map, geom_map]
+            = dolfinx::mesh::create_submesh(
+                mesh, dim, xtl::span(entities.data(), entities.size()));
+        return py::make_tuple(std::move(submesh),
+                              as_pyarray(std::move(entity_map)),
+                              as_pyarray(std::move(vertex_map)),
+                              as_pyarray(std::move(geom_map)));
+      },
+      py::arg("mesh"), py::arg("dim"), py::arg("entities"),
+      "Create a mesh of a subset of the entities of a mesh. Returns the "
+      "submesh and the maps from its cells, vertices and geometry nodes "
+      "to the entities, vertices and geometry nodes of the mesh.");
+
   // dolfinx::mesh::GhostMode enums
   py::enum_<dolfinx::mesh::GhostMode>(m, "GhostMode")
       .value("none", dolfinx::mesh::GhostMode::none)
@@ -215,8 +456,34 @@ void mesh(py::module& m)
           "coordinate of a point.")
       .def_property_readonly("cmap", &dolfinx::mesh::Geometry::cmap,
                              "The coordinate map")
-      .def_property_readonly("input_global_indices",
-                             &dolfinx::mesh::Geometry::input_global_indices);
+      .def_property_readonly(
+          "input_global_indices",
+          [](const dolfinx::mesh::Geometry& self)
+          {
+            return as_pyarray_view(self.input_global_indices(),
+                                   py::cast(self));
+          },
+          "Return the input global index of each geometry point")
+      .def("pack_coordinates", &dolfinx::mesh::Geometry::pack_coordinates,
+           "Pack cell coordinates for use in assembly")
+      .def("clear_packed_coordinates",
+           &dolfinx::mesh::Geometry::clear_packed_coordinates,
+           "Discard packed cell coordinates")
+      .def("store_single_precision",
+           &dolfinx::mesh::Geometry::store_single_precision,
+           "Store the coordinates in single precision")
+      .def("store_double_precision",
+           &dolfinx::mesh::Geometry::store_double_precision,
+           "Store the coordinates in double precision")
+      .def_property_readonly("single_precision",
+                             &dolfinx::mesh::Geometry::single_precision,
+                             "True if the coordinates are stored in single "
+                             "precision")
+      .def_property_readonly("version", &dolfinx::mesh::Geometry::version,
+                             "Version of the coordinates")
+      .def("increment_version", &dolfinx::mesh::Geometry::increment_version)
+      .def("memory_usage", &dolfinx::mesh::Geometry::memory_usage,
+           "Memory allocated by the geometry (bytes)");
 
   // dolfinx::mesh::TopologyComputation
   m.def("compute_entities",
@@ -235,31 +502,55 @@ void mesh(py::module& m)
       }))
       .def("set_connectivity", &dolfinx::mesh::Topology::set_connectivity)
       .def("set_index_map", &dolfinx::mesh::Topology::set_index_map)
-      .def("create_entities", &dolfinx::mesh::Topology::create_entities)
+      .def("create_entities", &dolfinx::mesh::Topology::create_entities,
+           py::arg("dim"), py::arg("num_threads") = 1,
+           py::call_guard<py::gil_scoped_release>())
       .def("create_entity_permutations",
-           &dolfinx::mesh::Topology::create_entity_permutations)
-      .def("create_connectivity", &dolfinx::mesh::Topology::create_connectivity)
+           &dolfinx::mesh::Topology::create_entity_permutations,
+           py::arg("num_threads") = 1,
+           py::call_guard<py::gil_scoped_release>())
+      .def("create_facet_permutations",
+           &dolfinx::mesh::Topology::create_facet_permutations,
+           py::arg("num_threads") = 1,
+           py::call_guard<py::gil_scoped_release>())
+      .def("create_connectivity",
+           &dolfinx::mesh::Topology::create_connectivity, py::arg("d0"),
+           py::arg("d1"), py::arg("num_threads") = 1,
+           py::call_guard<py::gil_scoped_release>())
       .def("create_connectivity_all",
-           &dolfinx::mesh::Topology::create_connectivity_all)
+           &dolfinx::mesh::Topology::create_connectivity_all,
+           py::call_guard<py::gil_scoped_release>())
+      .def("release_connectivity",
+           &dolfinx::mesh::Topology::release_connectivity, py::arg("d0"),
+           py::arg("d1"))
+      .def("compact_connectivity",
+           &dolfinx::mesh::Topology::compact_connectivity)
       .def("get_facet_permutations",
            [](const dolfinx::mesh::Topology& self) {
-             const std::vector<std::uint8_t>& p = self.get_facet_permutations();
-             return py::array_t<std::uint8_t>(p.size(), p.data(),
-                                              py::cast(self));
+             return as_pyarray_view(self.get_facet_permutations(),
+                                    py::cast(self));
            })
       .def("get_cell_permutation_info",
            [](const dolfinx::mesh::Topology& self) {
-             const std::vector<std::uint32_t>& p
-                 = self.get_cell_permutation_info();
-             return py::array_t<std::uint32_t>(p.size(), p.data(),
-                                               py::cast(self));
+             return as_pyarray_view(self.get_cell_permutation_info(),
+                                    py::cast(self));
            })
       .def_property_readonly("dim", &dolfinx::mesh::Topology::dim,
                              "Topological dimension")
+      .def_property_readonly("version", &dolfinx::mesh::Topology::version,
+                             "Version of the topology")
       .def("connectivity",
            py::overload_cast<int, int>(&dolfinx::mesh::Topology::connectivity,
                                        py::const_))
       .def("index_map", &dolfinx::mesh::Topology::index_map)
+      .def("memory_usage",
+           py::overload_cast<>(&dolfinx::mesh::Topology::memory_usage,
+                               py::const_),
+           "Memory allocated by the topology (bytes)")
+      .def("memory_usage",
+           py::overload_cast<int, int>(
+               &dolfinx::mesh::Topology::memory_usage, py::const_),
+           "Memory allocated by a connectivity (bytes)")
       .def_property_readonly("cell_type", &dolfinx::mesh::Topology::cell_type)
       .def("cell_name",
            [](const dolfinx::mesh::Topology& self) {
@@ -299,48 +590,110 @@ void mesh(py::module& m)
   declare_meshtags<std::int64_t>(m, "int64");
 
   // Partitioning interface
-  m.def("partition_cells_graph",
-        [](const MPICommWrapper comm, int nparts, int tdim,
-           const dolfinx::graph::AdjacencyList<std::int64_t>& cells,
-           dolfinx::mesh::GhostMode ghost_mode)
-            -> dolfinx::graph::AdjacencyList<std::int32_t> {
-          return dolfinx::mesh::partition_cells_graph(comm.get(), nparts, tdim,
-                                                      cells, ghost_mode);
-        });
+  m.def(
+      "compute_partition_quality",
+      [](const MPICommWrapper comm, int nparts, int tdim,
+         const dolfinx::graph::AdjacencyList<std::int64_t>& cells,
+         const dolfinx::graph::AdjacencyList<std::int32_t>& dest)
+      {
+        const dolfinx::Table table = dolfinx::mesh::compute_partition_quality(
+            comm.get(), nparts, tdim, cells, dest);
+        py::dict quality;
+        for (std::string row : {"Edge cut", "Communication volume",
+                                "Max part weight", "Min part weight",
+                                "Imbalance"})
+        {
+          quality[row.c_str()] = std::get<double>(table.get(row, "value"));
+        }
+        return quality;
+      },
+      py::arg("comm"), py::arg("nparts"), py::arg("tdim"), py::arg("cells"),
+      py::arg("dest"),
+      "Compute quality measures (edge cut, communication volume, part "
+      "weights and imbalance) of a partition of mesh cells.");
+  m.def(
+      "partition_summary",
+      [](const dolfinx::mesh::Mesh& mesh)
+      {
+        return dolfinx::mesh::partition_summary(mesh)
+            .reduce(mesh.mpi_comm(), dolfinx::Table::Reduction::max)
+            .str();
+      },
+      "Summary of the parallel distribution of a mesh (MPI_MAX "
+      "reduction).");
+  m.def(
+      "partition_cells_graph",
+      [](const MPICommWrapper comm, int nparts, int tdim,
+         const dolfinx::graph::AdjacencyList<std::int64_t>& cells,
+         dolfinx::mesh::GhostMode ghost_mode,
+         const py::array_t<std::int32_t, py::array::c_style>& cell_weights,
+         int num_ghost_layers) -> dolfinx::graph::AdjacencyList<std::int32_t> {
+        return dolfinx::mesh::partition_cells_graph(
+            comm.get(), nparts, tdim, cells, ghost_mode,
+            &dolfinx::graph::partition_graph,
+            xtl::span(cell_weights.data(), cell_weights.size()),
+            num_ghost_layers);
+      },
+      py::arg("comm"), py::arg("nparts"), py::arg("tdim"), py::arg("cells"),
+      py::arg("ghost_mode"),
+      py::arg("cell_weights") = py::array_t<std::int32_t>(0),
+      py::arg("num_ghost_layers") = 1,
+      "Compute the destination rank of each cell by partitioning the dual "
+      "graph. Cells are optionally weighted, e.g. by their assembly cost. "
+      "Ghosted meshes get num_ghost_layers layers of facet-connected ghost "
+      "cells.");
+
+  using PythonMarkerFunction = std::function<py::array_t<bool>(
+      const py::array_t<double, py::array::c_style>&)>;
+  auto cpp_marker = [](const PythonMarkerFunction& marker)
+  {
+    return [marker](const xt::xtensor<double, 2>& x) -> xt::xtensor<bool, 1>
+    {
+      py::array_t<double> x_view(x.shape(), x.data(), py::none());
+      py::array_t<bool> marked = marker(x_view);
+      std::array shape = {static_cast<std::size_t>(marked.size())};
+      return xt::adapt(marked.data(), marked.size(), xt::no_ownership(),
+                       shape);
+    };
+  };
+  auto cpp_markers = [cpp_marker](const std::vector<PythonMarkerFunction>& m)
+  {
+    std::vector<
+        std::function<xt::xtensor<bool, 1>(const xt::xtensor<double, 2>&)>>
+        markers;
+    std::transform(m.begin(), m.end(), std::back_inserter(markers),
+                   cpp_marker);
+    return markers;
+  };
 
   m.def("locate_entities",
-        [](const dolfinx::mesh::Mesh& mesh, int dim,
-           const std::function<py::array_t<bool>(
-               const py::array_t<double, py::array::c_style>&)>& marker) {
-          auto cpp_marker
-              = [&marker](
-                    const xt::xtensor<double, 2>& x) -> xt::xtensor<bool, 1> {
-            py::array_t<double> x_view(x.shape(), x.data(), py::none());
-            py::array_t<bool> marked = marker(x_view);
-            std::array shape = {static_cast<std::size_t>(marked.size())};
-            return xt::adapt(marked.data(), marked.size(), xt::no_ownership(),
-                             shape);
-          };
+        [cpp_marker](const dolfinx::mesh::Mesh& mesh, int dim,
+                     const PythonMarkerFunction& marker) {
           return as_pyarray(
-              dolfinx::mesh::locate_entities(mesh, dim, cpp_marker));
+              dolfinx::mesh::locate_entities(mesh, dim, cpp_marker(marker)));
         });
+  m.def(
+      "locate_entities",
+      [cpp_markers](const dolfinx::mesh::Mesh& mesh, int dim,
+                    const std::vector<PythonMarkerFunction>& markers) {
+        return dolfinx::mesh::locate_entities(mesh, dim, cpp_markers(markers));
+      },
+      "Locate the entities marked by each of a list of markers");
 
   m.def("locate_entities_boundary",
-        [](const dolfinx::mesh::Mesh& mesh, int dim,
-           const std::function<py::array_t<bool>(
-               const py::array_t<double, py::array::c_style>&)>& marker) {
-          auto cpp_marker
-              = [&marker](
-                    const xt::xtensor<double, 2>& x) -> xt::xtensor<bool, 1> {
-            py::array_t<double> x_view(x.shape(), x.data(), py::none());
-            py::array_t<bool> marked = marker(x_view);
-            std::array shape = {static_cast<std::size_t>(marked.size())};
-            return xt::adapt(marked.data(), marked.size(), xt::no_ownership(),
-                             shape);
-          };
-          return as_pyarray(
-              dolfinx::mesh::locate_entities_boundary(mesh, dim, cpp_marker));
+        [cpp_marker](const dolfinx::mesh::Mesh& mesh, int dim,
+                     const PythonMarkerFunction& marker) {
+          return as_pyarray(dolfinx::mesh::locate_entities_boundary(
+              mesh, dim, cpp_marker(marker)));
         });
+  m.def(
+      "locate_entities_boundary",
+      [cpp_markers](const dolfinx::mesh::Mesh& mesh, int dim,
+                    const std::vector<PythonMarkerFunction>& markers) {
+        return dolfinx::mesh::locate_entities_boundary(mesh, dim,
+                                                       cpp_markers(markers));
+      },
+      "Locate the boundary entities marked by each of a list of markers");
 
   m.def("entities_to_geometry",
         [](const dolfinx::mesh::Mesh& mesh, int dim,
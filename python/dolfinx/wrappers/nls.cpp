@@ -6,6 +6,7 @@
 
 #include "caster_mpi.h"
 #include "caster_petsc.h"
+#include <dolfinx/la/PETScKrylovSolver.h>
 #include <dolfinx/nls/NewtonSolver.h>
 #include <memory>
 #include <petsc4py/petsc4py.h>
@@ -21,6 +22,28 @@ namespace dolfinx_wrappers
 void nls(py::module& m)
 {
 
+  // dolfinx::nls::NewtonIterationRecord
+  py::class_<dolfinx::nls::NewtonIterationRecord>(m, "NewtonIterationRecord",
+                                                  "Telemetry of a Newton "
+                                                  "iteration")
+      .def_readonly("iteration",
+                    &dolfinx::nls::NewtonIterationRecord::iteration)
+      .def_readonly("residual", &dolfinx::nls::NewtonIterationRecord::residual)
+      .def_readonly("krylov_iterations",
+                    &dolfinx::nls::NewtonIterationRecord::krylov_iterations)
+      .def_readonly("jacobian_computed",
+                    &dolfinx::nls::NewtonIterationRecord::jacobian_computed)
+      .def_readonly("time_residual",
+                    &dolfinx::nls::NewtonIterationRecord::time_residual)
+      .def_readonly("time_jacobian",
+                    &dolfinx::nls::NewtonIterationRecord::time_jacobian)
+      .def_readonly("time_preconditioner",
+                    &dolfinx::nls::NewtonIterationRecord::time_preconditioner)
+      .def_readonly("time_krylov",
+                    &dolfinx::nls::NewtonIterationRecord::time_krylov)
+      .def_readonly("time_update",
+                    &dolfinx::nls::NewtonIterationRecord::time_update);
+
   // dolfinx::NewtonSolver
   py::class_<dolfinx::nls::NewtonSolver,
              std::shared_ptr<dolfinx::nls::NewtonSolver>>(m, "NewtonSolver")
@@ -34,8 +57,22 @@ void nls(py::module& m)
              KSP ksp = krylov_solver.ksp();
              return ksp;
            })
+      .def(
+          "set_preconditioner_reuse",
+          [](dolfinx::nls::NewtonSolver& self,
+             const dolfinx::la::PreconditionerReuse& policy) {
+            self.get_krylov_solver().set_preconditioner_reuse(policy);
+          },
+          "Set the preconditioner reuse policy of the Krylov solver")
       .def("setF", &dolfinx::nls::NewtonSolver::setF)
       .def("setJ", &dolfinx::nls::NewtonSolver::setJ)
+      .def("setFJ", &dolfinx::nls::NewtonSolver::setFJ, py::arg("FJ"),
+           "Set the function computing the residual and Jacobian in one "
+           "pass")
+      .def("setJ_matrix_free", &dolfinx::nls::NewtonSolver::setJ_matrix_free,
+           py::arg("J") = nullptr,
+           "Use a matrix-free Jacobian, applied by the function J (x, v, y) "
+           "or by finite differences of the residual")
       .def("setP", &dolfinx::nls::NewtonSolver::setP)
       .def("set_form", &dolfinx::nls::NewtonSolver::set_form)
       .def("solve", &dolfinx::nls::NewtonSolver::solve)
@@ -51,6 +88,36 @@ void nls(py::module& m)
                      "Relaxation parameter")
       .def_readwrite("max_it", &dolfinx::nls::NewtonSolver::max_it,
                      "Maximum number of iterations")
+      .def_readwrite("jacobian_lag", &dolfinx::nls::NewtonSolver::jacobian_lag,
+                     "Maximum number of iterations with the same Jacobian")
+      .def_readwrite("jacobian_lag_rate",
+                     &dolfinx::nls::NewtonSolver::jacobian_lag_rate,
+                     "Residual reduction factor below which a lagged "
+                     "Jacobian is recomputed")
+      .def_readwrite("eisenstat_walker",
+                     &dolfinx::nls::NewtonSolver::eisenstat_walker,
+                     "Use Eisenstat-Walker forcing terms as Krylov tolerance")
+      .def_readwrite("ew_eta0", &dolfinx::nls::NewtonSolver::ew_eta0,
+                     "Initial Eisenstat-Walker forcing term")
+      .def_readwrite("ew_eta_max", &dolfinx::nls::NewtonSolver::ew_eta_max,
+                     "Maximum Eisenstat-Walker forcing term")
+      .def_readwrite("ew_gamma", &dolfinx::nls::NewtonSolver::ew_gamma,
+                     "Eisenstat-Walker parameter gamma")
+      .def_readwrite("ew_alpha", &dolfinx::nls::NewtonSolver::ew_alpha,
+                     "Eisenstat-Walker parameter alpha")
+      .def_property_readonly("krylov_iterations",
+                             &dolfinx::nls::NewtonSolver::krylov_iterations,
+                             "Number of Krylov iterations of the last solve")
+      .def_property_readonly("residual",
+                             &dolfinx::nls::NewtonSolver::residual,
+                             "Residual of the last iteration")
+      .def_property_readonly("history",
+                             &dolfinx::nls::NewtonSolver::history,
+                             "Telemetry of the iterations of the last solve")
+      .def_property_readonly(
+          "jacobian_evaluations",
+          &dolfinx::nls::NewtonSolver::jacobian_evaluations,
+          "Number of Jacobian evaluations in the last solve")
       .def_readwrite("convergence_criterion",
                      &dolfinx::nls::NewtonSolver::convergence_criterion,
                      "Convergence criterion, either 'residual' (default) or "
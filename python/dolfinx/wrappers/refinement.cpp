@@ -4,13 +4,32 @@
 //
 // SPDX-License-Identifier:    LGPL-3.0-or-later
 
+#include "array.h"
+#include "caster_mpi.h"
+#include <cstdint>
+#include <dolfinx/fem/Function.h>
 #include <dolfinx/mesh/Mesh.h>
 #include <dolfinx/mesh/MeshTags.h>
+#include <dolfinx/refinement/MeshHierarchy.h>
+#include <dolfinx/refinement/marking.h>
 #include <dolfinx/refinement/refine.h>
+#include <memory>
+#include <petscsys.h>
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 
 namespace py = pybind11;
 
+namespace
+{
+template <typename T, typename Class>
+void declare_transfer(Class& cls)
+{
+  cls.def("transfer", &dolfinx::refinement::MeshHierarchy::transfer<T>,
+          py::arg("tags"));
+}
+} // namespace
+
 namespace dolfinx_wrappers
 {
 
@@ -19,15 +38,104 @@ void refinement(py::module& m)
 
   // dolfinx::refinement::refine
   m.def("refine",
-        py::overload_cast<const dolfinx::mesh::Mesh&, bool>(
+        py::overload_cast<const dolfinx::mesh::Mesh&, bool, int>(
             &dolfinx::refinement::refine),
-        py::arg("mesh"), py::arg("redistribute") = true);
+        py::arg("mesh"), py::arg("redistribute") = true,
+        py::arg("num_threads") = 1, py::call_guard<py::gil_scoped_release>());
 
   m.def("refine",
         py::overload_cast<const dolfinx::mesh::Mesh&,
-                          const dolfinx::mesh::MeshTags<std::int8_t>&, bool>(
-            &dolfinx::refinement::refine),
-        py::arg("mesh"), py::arg("marker"), py::arg("redistribute") = true);
+                          const dolfinx::mesh::MeshTags<std::int8_t>&, bool,
+                          int>(&dolfinx::refinement::refine),
+        py::arg("mesh"), py::arg("marker"), py::arg("redistribute") = true,
+        py::arg("num_threads") = 1, py::call_guard<py::gil_scoped_release>());
+
+  // dolfinx::refinement::select_doerfler
+  m.def(
+      "select_doerfler",
+      [](const MPICommWrapper comm,
+         const py::array_t<double, py::array::c_style>& eta, double theta,
+         int num_threads)
+      {
+        return as_pyarray(dolfinx::refinement::select_doerfler(
+            comm.get(), xtl::span(eta.data(), eta.size()), theta,
+            num_threads));
+      },
+      py::arg("comm"), py::arg("eta"), py::arg("theta"),
+      py::arg("num_threads") = 1,
+      "Select the largest values by the Dörfler criterion");
+
+  // dolfinx::refinement::mark_doerfler
+  m.def(
+      "mark_doerfler",
+      [](const dolfinx::mesh::Mesh& mesh,
+         const py::array_t<double, py::array::c_style>& eta, double theta,
+         int num_threads)
+      {
+        return as_pyarray(dolfinx::refinement::mark_doerfler(
+            mesh, xtl::span(eta.data(), eta.size()), theta, num_threads));
+      },
+      py::arg("mesh"), py::arg("eta"), py::arg("theta"),
+      py::arg("num_threads") = 1,
+      "Mark the edges of the cells selected by the Dörfler criterion");
+
+  // dolfinx::refinement::MeshHierarchy
+  py::class_<dolfinx::refinement::MeshHierarchy,
+             std::shared_ptr<dolfinx::refinement::MeshHierarchy>>
+      hierarchy(m, "MeshHierarchy", "Hierarchy of refined meshes");
+  hierarchy
+      .def(py::init<std::shared_ptr<const dolfinx::mesh::Mesh>>(),
+           py::arg("mesh"))
+      .def("refine",
+           py::overload_cast<int>(&dolfinx::refinement::MeshHierarchy::refine),
+           py::arg("num_threads") = 1, py::call_guard<py::gil_scoped_release>())
+      .def("refine",
+           py::overload_cast<const dolfinx::mesh::MeshTags<std::int8_t>&, int>(
+               &dolfinx::refinement::MeshHierarchy::refine),
+           py::arg("marker"), py::arg("num_threads") = 1,
+           py::call_guard<py::gil_scoped_release>())
+      .def(
+          "coarsen",
+          [](dolfinx::refinement::MeshHierarchy& self,
+             const dolfinx::mesh::MeshTags<std::int8_t>& marker,
+             int num_threads)
+          { return as_pyarray(self.coarsen(marker, num_threads)); },
+          py::arg("marker"), py::arg("num_threads") = 1)
+      .def_property_readonly("num_levels",
+                             &dolfinx::refinement::MeshHierarchy::num_levels)
+      .def("mesh", &dolfinx::refinement::MeshHierarchy::mesh, py::arg("level"))
+      .def(
+          "parent_cells",
+          [](const dolfinx::refinement::MeshHierarchy& self, int level)
+          {
+            return as_pyarray_view(self.parent_cells(level), py::cast(self));
+          },
+          py::arg("level"))
+      .def(
+          "parent_facets",
+          [](const dolfinx::refinement::MeshHierarchy& self, int level)
+          {
+            return as_pyarray_view(self.parent_facets(level),
+                                   py::cast(self));
+          },
+          py::arg("level"));
+  declare_transfer<std::int8_t>(hierarchy);
+  declare_transfer<std::int32_t>(hierarchy);
+  declare_transfer<std::int64_t>(hierarchy);
+  declare_transfer<double>(hierarchy);
+
+  // dolfinx::refinement::transfer
+  m.def(
+      "transfer",
+      [](const dolfinx::fem::Function<PetscScalar>& u0,
+         dolfinx::fem::Function<PetscScalar>& u1,
+         const py::array_t<std::int32_t, py::array::c_style>& vertex_map)
+      {
+        dolfinx::refinement::transfer(
+            u0, u1, xtl::span(vertex_map.data(), vertex_map.size()));
+      },
+      py::arg("u0"), py::arg("u1"), py::arg("vertex_map"),
+      "Transfer a Function with dofs at vertices using a vertex map");
 }
 
 } // namespace dolfinx_wrappers
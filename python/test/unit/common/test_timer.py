@@ -6,10 +6,19 @@
 #
 # SPDX-License-Identifier:    LGPL-3.0-or-later
 
+import csv
+import json
+import os
 import random
 from time import sleep
 
-from dolfinx import common
+import pytest
+from dolfinx import UnitSquareMesh, common
+from dolfinx.io import XDMFFile
+from dolfinx_utils.test.fixtures import tempdir
+from mpi4py import MPI
+
+assert (tempdir)
 
 # Seed random generator for determinism
 random.seed(0)
@@ -41,3 +50,108 @@ def test_context_manager_anonymous():
     with common.Timer() as t:
         sleep(0.05)
         assert t.elapsed()[0] >= 0.05
+
+
+def test_nested_timings_and_trace(tempdir):
+    """Test that timers nested in other timers are summarised by path
+    and recorded in the trace"""
+    outer, inner = get_random_task_name(), get_random_task_name()
+    common.set_timer_trace(True)
+    with common.Timer(outer):
+        for i in range(2):
+            with common.Timer(inner):
+                pass
+    common.set_timer_trace(False)
+
+    assert outer + " > " + inner in common.nested_timings()
+
+    filename = os.path.join(tempdir, "trace.json")
+    common.write_timer_trace(MPI.COMM_WORLD, filename)
+    if MPI.COMM_WORLD.rank == 0:
+        with open(filename) as f:
+            events = json.load(f)["traceEvents"]
+        names = [e["name"] for e in events if e["pid"] == 0]
+        assert names.count(inner) == 2
+        assert names.count(outer) == 1
+
+
+def test_timer_counters(capfd):
+    """Test the recording of hardware counters by named timers"""
+    if not common.timer_counters_available():
+        with pytest.raises(RuntimeError):
+            common.set_timer_counters(True)
+        pytest.skip("Hardware counters are not available")
+
+    task = get_random_task_name()
+    common.set_timer_counters(True)
+    with common.Timer(task):
+        sum(range(100000))
+    common.set_timer_counters(False)
+
+    common.list_timings(MPI.COMM_WORLD, [common.TimingType.wall])
+    if MPI.COMM_WORLD.rank == 0:
+        out = capfd.readouterr().out
+        assert "IPC" in out and "LLC miss tot" in out
+
+
+def test_timing_distribution(tempdir):
+    """Test the export of the timings of each rank"""
+    task = get_random_task_name()
+    if MPI.COMM_WORLD.rank == 0:
+        with common.Timer(task):
+            sleep(0.01)
+    common.list_timing_imbalance(MPI.COMM_WORLD)
+
+    filename = os.path.join(tempdir, "timings.csv")
+    common.write_timing_distribution(MPI.COMM_WORLD, filename)
+    if MPI.COMM_WORLD.rank == 0:
+        with open(filename) as f:
+            rows = {row[0]: row[1:] for row in csv.reader(f)}
+        assert len(rows["task"]) == MPI.COMM_WORLD.size
+        assert float(rows[task][0]) >= 0.01
+        assert all(t == "" for t in rows[task][1:])
+
+
+def test_communication_log(tempdir):
+    """Test the recording and export of communication statistics"""
+    common.set_communication_log(True)
+    UnitSquareMesh(MPI.COMM_WORLD, 4, 4)
+    common.set_communication_log(False)
+    common.list_communication(MPI.COMM_WORLD)
+
+    site = "graph::build::distribute"
+    assert common.timing("MPI wait: " + site)[0] > 0
+
+    filename = os.path.join(tempdir, "communication.csv")
+    common.write_communication(MPI.COMM_WORLD, filename)
+    if MPI.COMM_WORLD.rank == 0:
+        with open(filename) as f:
+            rows = list(csv.DictReader(f))
+        ranks = {int(row["rank"]) for row in rows if row["site"] == site}
+        assert ranks == set(range(MPI.COMM_WORLD.size))
+        for row in rows:
+            assert int(row["messages"]) <= int(row["neighbors"])
+            assert float(row["wait"]) >= 0.0
+
+
+def test_io_statistics(tempdir):
+    """Test the recording and export of I/O statistics"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 4, 4)
+    xdmf_filename = os.path.join(tempdir, "io_statistics.xdmf")
+    with XDMFFile(MPI.COMM_WORLD, xdmf_filename, "w") as file:
+        file.write_mesh(mesh)
+    common.list_io(MPI.COMM_WORLD)
+    assert common.timing("I/O: HDF5 write")[0] > 0
+
+    filename = os.path.join(tempdir, "io.csv")
+    common.write_io(MPI.COMM_WORLD, filename)
+    if MPI.COMM_WORLD.rank == 0:
+        with open(filename) as f:
+            rows = list(csv.DictReader(f))
+        name = "/Mesh/mesh/geometry"
+        ranks = {int(row["rank"]) for row in rows if row["site"] == "HDF5 write" and row["name"] == name}
+        assert ranks == set(range(MPI.COMM_WORLD.size))
+        assert any(row["site"] == "XDMF write" and row["rank"] == "0" for row in rows)
+        for row in rows:
+            assert int(row["bytes"]) >= 0
+            assert float(row["time"]) >= 0.0
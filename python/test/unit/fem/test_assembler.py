@@ -18,7 +18,7 @@ from dolfinx.mesh import create_mesh
 from dolfinx_utils.test.skips import skip_in_parallel
 from mpi4py import MPI
 from petsc4py import PETSc
-from ufl import derivative, ds, dx, inner
+from ufl import derivative, ds, dx, grad, inner
 
 
 def nest_matrix_norm(A):
@@ -642,6 +642,93 @@ def test_assembly_solve_taylor_hood(mesh):
     assert Pnorm2 == pytest.approx(Pnorm0, 1.0e-12)
 
 
+@pytest.mark.parametrize("mode", [dolfinx.cpp.mesh.GhostMode.none, dolfinx.cpp.mesh.GhostMode.shared_facet])
+def test_threaded_assembly(mode):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 12, ghost_mode=mode)
+    V = dolfinx.FunctionSpace(mesh, ("Lagrange", 2))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    a = dolfinx.fem.Form(inner(u, v) * dx + inner(u, v) * ds)
+    L = dolfinx.fem.Form(inner(1.0, v) * dx + inner(2.0, v) * ds)
+
+    A0 = dolfinx.fem.assemble_matrix(a)
+    A0.assemble()
+    A1 = dolfinx.fem.create_matrix(a)
+    dolfinx.cpp.fem.assemble_matrix_petsc(A1, a._cpp_object, [], num_threads=4)
+    A1.assemble()
+    assert (A0 - A1).norm() == pytest.approx(0.0, abs=1.0e-12)
+
+    b0 = dolfinx.fem.assemble_vector(L)
+    b0.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+    b1 = dolfinx.fem.create_vector(L)
+    with b1.localForm() as b_local:
+        b_local.set(0.0)
+        dolfinx.cpp.fem.assemble_vector(b_local.array_w, L._cpp_object, num_threads=4)
+    b1.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+    assert (b0 - b1).norm() == pytest.approx(0.0, abs=1.0e-12)
+
+
+@pytest.mark.parametrize("mode", [dolfinx.cpp.mesh.GhostMode.none, dolfinx.cpp.mesh.GhostMode.shared_facet])
+def test_packed_geometry_assembly(mode):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 12, ghost_mode=mode)
+    V = dolfinx.FunctionSpace(mesh, ("Lagrange", 2))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    a = inner(grad(u), grad(v)) * dx + inner(u, v) * ds
+    L = inner(1.0, v) * dx + inner(2.0, v) * ds
+    M = inner(1.0, 1.0) * dx
+
+    A0 = dolfinx.fem.assemble_matrix(a)
+    A0.assemble()
+    b0 = dolfinx.fem.assemble_vector(L)
+    b0.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+    m0 = mesh.mpi_comm().allreduce(dolfinx.fem.assemble_scalar(M), op=MPI.SUM)
+
+    mesh.geometry.pack_coordinates()
+    A1 = dolfinx.fem.assemble_matrix(a)
+    A1.assemble()
+    b1 = dolfinx.fem.assemble_vector(L)
+    b1.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+    m1 = mesh.mpi_comm().allreduce(dolfinx.fem.assemble_scalar(M), op=MPI.SUM)
+    mesh.geometry.clear_packed_coordinates()
+
+    assert (A0 - A1).norm() == pytest.approx(0.0, abs=1.0e-12)
+    assert (b0 - b1).norm() == pytest.approx(0.0, abs=1.0e-12)
+    assert m0 == pytest.approx(m1, rel=1.0e-12)
+
+
+@pytest.mark.parametrize("mode", [dolfinx.cpp.mesh.GhostMode.none, dolfinx.cpp.mesh.GhostMode.shared_facet])
+def test_single_precision_geometry_assembly(mode):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 12, ghost_mode=mode)
+    V = dolfinx.FunctionSpace(mesh, ("Lagrange", 2))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    a = inner(grad(u), grad(v)) * dx + inner(u, v) * ds
+    L = inner(1.0, v) * dx + inner(2.0, v) * ds
+    M = inner(1.0, 1.0) * dx
+
+    A0 = dolfinx.fem.assemble_matrix(a)
+    A0.assemble()
+    b0 = dolfinx.fem.assemble_vector(L)
+    b0.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+    m0 = mesh.mpi_comm().allreduce(dolfinx.fem.assemble_scalar(M), op=MPI.SUM)
+
+    memory0 = mesh.geometry.memory_usage()
+    mesh.geometry.store_single_precision()
+    assert mesh.geometry.single_precision
+    assert mesh.geometry.memory_usage() < memory0
+    with pytest.raises(RuntimeError):
+        mesh.geometry.x
+    A1 = dolfinx.fem.assemble_matrix(a)
+    A1.assemble()
+    b1 = dolfinx.fem.assemble_vector(L)
+    b1.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+    m1 = mesh.mpi_comm().allreduce(dolfinx.fem.assemble_scalar(M), op=MPI.SUM)
+    mesh.geometry.store_double_precision()
+    assert not mesh.geometry.single_precision
+
+    assert (A0 - A1).norm() == pytest.approx(0.0, abs=1.0e-5 * A0.norm())
+    assert (b0 - b1).norm() == pytest.approx(0.0, abs=1.0e-5 * b0.norm())
+    assert m0 == pytest.approx(m1, rel=1.0e-6)
+
+
 def test_basic_interior_facet_assembly():
     mesh = dolfinx.RectangleMesh(MPI.COMM_WORLD,
                                  [numpy.array([0.0, 0.0, 0.0]),
@@ -665,6 +752,22 @@ def test_basic_interior_facet_assembly():
     assert isinstance(b, PETSc.Vec)
 
 
+def test_interior_facet_sparsity():
+    """Test that the sparsity pattern of interior facet integrals couples
+    each cell with itself and with the cells that it shares a facet
+    with, with and without cell integrals"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 4, 4, dolfinx.cpp.mesh.CellType.quadrilateral)
+    V = fem.FunctionSpace(mesh, ("DG", 0))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+
+    # 16 cells and 24 interior facets
+    for a in [ufl.inner(ufl.jump(u), ufl.jump(v)) * ufl.dS,
+              inner(u, v) * dx + ufl.inner(ufl.jump(u), ufl.jump(v)) * ufl.dS]:
+        pattern = dolfinx.cpp.fem.create_sparsity_pattern(fem.Form(a)._cpp_object)
+        pattern.assemble()
+        assert mesh.mpi_comm().allreduce(pattern.num_nonzeros(), op=MPI.SUM) == 16 + 2 * 24
+
+
 @pytest.mark.parametrize("mode", [dolfinx.cpp.mesh.GhostMode.none, dolfinx.cpp.mesh.GhostMode.shared_facet])
 def test_basic_assembly_constant(mode):
     """Tests assembly with Constant
@@ -732,3 +835,539 @@ def test_lambda_assembler():
     v = numpy.ones(mat.shape[1])
     s = MPI.COMM_WORLD.allreduce(mat.dot(v).sum(), MPI.SUM)
     assert numpy.isclose(s, 1.0)
+
+
+@pytest.mark.parametrize("mode", [dolfinx.cpp.mesh.GhostMode.none, dolfinx.cpp.mesh.GhostMode.shared_facet])
+def test_matrix_free_operator(mode):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 12, ghost_mode=mode)
+    V = dolfinx.VectorFunctionSpace(mesh, ("Lagrange", 1))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    f = dolfinx.Function(V)
+    f.interpolate(lambda x: numpy.stack((1 + x[0], 2 + x[1])))
+    a = dolfinx.fem.Form(inner(grad(u), grad(v)) * dx + inner(f, f) * inner(u, v) * ds)
+
+    u_bc = dolfinx.Function(V)
+    bdofs = dolfinx.fem.locate_dofs_geometrical(V, lambda x: numpy.isclose(x[0], 0.0))
+    bc = dolfinx.DirichletBC(u_bc, bdofs)
+
+    A = dolfinx.fem.assemble_matrix(a, [bc])
+    A.assemble()
+    A_free = dolfinx.cpp.fem.create_matrix_free(dolfinx.cpp.fem.MatrixFreeOperator(a._cpp_object, [bc]))
+
+    x = A.createVecRight()
+    x.setRandom()
+    y0, y1 = A.createVecLeft(), A.createVecLeft()
+    A.mult(x, y0)
+    A_free.mult(x, y1)
+    assert (y0 - y1).norm() == pytest.approx(0.0, abs=1.0e-10)
+
+    # Change coefficient values
+    f.x.array[:] *= 2.0
+    A = dolfinx.fem.assemble_matrix(a, [bc])
+    A.assemble()
+    A.mult(x, y0)
+    A_free.mult(x, y1)
+    assert (y0 - y1).norm() == pytest.approx(0.0, abs=1.0e-10)
+
+    # Change coefficient values through an array obtained before the
+    # last product. The change is detected after the version of the
+    # vector is incremented.
+    f_array = f.x.array
+    A_free.mult(x, y1)
+    version = f.x.version
+    f_array[:] *= 2.0
+    assert f.x.version == version
+    f.x.increment_version()
+    assert f.x.version == version + 1
+    A = dolfinx.fem.assemble_matrix(a, [bc])
+    A.assemble()
+    A.mult(x, y0)
+    A_free.mult(x, y1)
+    assert (y0 - y1).norm() == pytest.approx(0.0, abs=1.0e-10)
+
+
+@pytest.mark.parametrize("mode", [dolfinx.cpp.mesh.GhostMode.none, dolfinx.cpp.mesh.GhostMode.shared_facet])
+def test_overlapped_vector_assembly(mode):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 12, ghost_mode=mode)
+    V = dolfinx.FunctionSpace(mesh, ("Lagrange", 2))
+    v = ufl.TestFunction(V)
+    f = dolfinx.Function(V)
+    f.interpolate(lambda x: 1 + x[0] * x[1])
+    L = dolfinx.fem.Form(inner(f, v) * dx + inner(f * f, v) * ds)
+
+    # Modify owned values only, so that ghost values are out-of-date
+    size_local = V.dofmap.index_map.size_local
+    f.x.array[:size_local] *= 2.0
+    b = dolfinx.Function(V)
+    dolfinx.cpp.fem.assemble_vector(b.x, L._cpp_object, [f.x])
+
+    b0 = dolfinx.fem.assemble_vector(L)
+    b0.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+    assert numpy.allclose(b.x.array[:size_local], b0.array)
+
+
+@pytest.mark.parametrize("element, mode, num_layers",
+                         [(("DG", 2), dolfinx.cpp.mesh.GhostMode.none, 1),
+                          (("DG", 2), dolfinx.cpp.mesh.GhostMode.shared_facet, 1),
+                          (("Lagrange", 2), dolfinx.cpp.mesh.GhostMode.shared_facet, 3)])
+def test_owner_computes_vector_assembly(element, mode, num_layers):
+    """Owner-computes assembly is exact when every cell with an owned
+    dof is on the process: for cell dofs with any ghost mode, and for
+    P2 on triangles with three ghost layers"""
+    def partitioner(comm, n, tdim, cells, ghost_mode):
+        return dolfinx.cpp.mesh.partition_cells_graph(comm, n, tdim, cells, ghost_mode, num_ghost_layers=num_layers)
+
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 12, ghost_mode=mode, partitioner=partitioner)
+    V = dolfinx.FunctionSpace(mesh, element)
+    v = ufl.TestFunction(V)
+    f = dolfinx.Function(V)
+    f.interpolate(lambda x: 1 + x[0] * x[1])
+    L = dolfinx.fem.Form(inner(f, v) * dx)
+
+    b0 = dolfinx.fem.assemble_vector(L)
+    b0.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+    b1 = dolfinx.fem.create_vector(L)
+    with b1.localForm() as b_local:
+        b_local.set(0.0)
+        dolfinx.cpp.fem.assemble_vector_owned(b_local.array_w, L._cpp_object, num_threads=2)
+        assert numpy.allclose(b_local.array_r[b1.getLocalSize():], 0.0)
+    assert (b0 - b1).norm() == pytest.approx(0.0, abs=1.0e-12)
+
+
+def test_owner_computes_vector_assembly_missing_cells():
+    """Owner-computes assembly throws if a cell with an owned dof is not
+    on the process"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 12, ghost_mode=dolfinx.cpp.mesh.GhostMode.none)
+    V = dolfinx.FunctionSpace(mesh, ("Lagrange", 1))
+    L = dolfinx.fem.Form(inner(1.0, ufl.TestFunction(V)) * dx)
+    b = dolfinx.fem.create_vector(L)
+    with b.localForm() as b_local:
+        b_local.set(0.0)
+        if mesh.mpi_comm().size > 1:
+            with pytest.raises(RuntimeError):
+                dolfinx.cpp.fem.assemble_vector_owned(b_local.array_w, L._cpp_object)
+        else:
+            dolfinx.cpp.fem.assemble_vector_owned(b_local.array_w, L._cpp_object)
+
+
+def test_compressed_dofmap_vector_assembly():
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 12)
+    V = dolfinx.VectorFunctionSpace(mesh, ("Lagrange", 1))
+    v = ufl.TestFunction(V)
+    f = dolfinx.Function(V)
+    f.interpolate(lambda x: numpy.stack((1 + x[0], x[1] * x[0])))
+    L = dolfinx.fem.Form(inner(f, v) * dx)
+
+    b0 = dolfinx.fem.assemble_vector(L)
+    b0.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+    size = V.dofmap._cpp_object.memory_usage()
+    assert V.dofmap.compress()
+    assert V.dofmap._cpp_object.compressed
+    assert V.dofmap._cpp_object.memory_usage() > size
+    b1 = dolfinx.fem.assemble_vector(L)
+    b1.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+    assert (b0 - b1).norm() == pytest.approx(0.0, abs=1.0e-12)
+
+
+@pytest.mark.parametrize("mode", [dolfinx.cpp.mesh.GhostMode.none, dolfinx.cpp.mesh.GhostMode.shared_facet])
+def test_assemble_diagonal(mode):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 12, ghost_mode=mode)
+    V = dolfinx.VectorFunctionSpace(mesh, ("Lagrange", 2))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    a = dolfinx.fem.Form(inner(grad(u), grad(v)) * dx + inner(u, v) * ds)
+
+    u_bc = dolfinx.Function(V)
+    bdofs = dolfinx.fem.locate_dofs_geometrical(V, lambda x: numpy.isclose(x[0], 0.0))
+    bc = dolfinx.DirichletBC(u_bc, bdofs)
+
+    A = dolfinx.fem.assemble_matrix(a, [bc], diagonal=2.0)
+    A.assemble()
+    d0 = A.getDiagonal()
+
+    # Diagonal
+    d = dolfinx.Function(V)
+    dolfinx.cpp.fem.assemble_diagonal(d.x, a._cpp_object, [bc], diagonal=2.0)
+    size_local = 2 * V.dofmap.index_map.size_local
+    assert numpy.allclose(d.x.array[:size_local], d0.array)
+
+    # Diagonal blocks
+    db = dolfinx.cpp.la.Vector(V.dofmap.index_map, 4)
+    dolfinx.cpp.fem.assemble_diagonal(db, a._cpp_object, [bc], diagonal=2.0)
+    blocks = db.array[:2 * size_local].reshape(-1, 2, 2)
+    assert numpy.allclose(blocks[:, 0, 0], d0.array[0::2])
+    assert numpy.allclose(blocks[:, 1, 1], d0.array[1::2])
+
+
+@pytest.mark.parametrize("packed", [False, True])
+@pytest.mark.parametrize("mode", [dolfinx.cpp.mesh.GhostMode.none, dolfinx.cpp.mesh.GhostMode.shared_facet])
+def test_fused_assembly(mode, packed):
+    """Compare fused assembly with assembly of each form. The cell
+    coordinates are gathered once per chunk unless the geometry is
+    packed, and a and L share the packed coefficients."""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 12, ghost_mode=mode)
+    if packed:
+        mesh.geometry.pack_coordinates()
+    V = dolfinx.FunctionSpace(mesh, ("Lagrange", 2))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    f = dolfinx.Function(V)
+    f.interpolate(lambda x: 1 + x[0] * x[1])
+    a = dolfinx.fem.Form(inner(f * grad(u), grad(v)) * dx + inner(u, v) * ds)
+
+    # Mass matrix over every other cell, so that the forms have
+    # different cells in a chunk
+    num_cells = mesh.topology.index_map(2).size_local + mesh.topology.index_map(2).num_ghosts
+    cells = numpy.arange(num_cells, dtype=numpy.int32)
+    marker = dolfinx.MeshTags(mesh, 2, cells, (cells % 2).astype(numpy.int32))
+    M = dolfinx.fem.Form(inner(u, v) * ufl.Measure("dx", subdomain_data=marker)(1))
+    L = dolfinx.fem.Form(inner(f, v) * dx + inner(f * f, v) * ds)
+
+    u_bc = dolfinx.Function(V)
+    bdofs = dolfinx.fem.locate_dofs_geometrical(V, lambda x: numpy.isclose(x[0], 0.0))
+    bc = dolfinx.DirichletBC(u_bc, bdofs)
+
+    A0 = dolfinx.fem.assemble_matrix(a, [bc], diagonal=0.0)
+    A0.assemble()
+    M0 = dolfinx.fem.assemble_matrix(M, [bc], diagonal=0.0)
+    M0.assemble()
+    b0 = dolfinx.fem.assemble_vector(L)
+    b0.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+
+    A1, M1 = dolfinx.fem.create_matrix(a), dolfinx.fem.create_matrix(M)
+    b1 = dolfinx.fem.create_vector(L)
+    with b1.localForm() as b_local:
+        b_local.set(0.0)
+        dolfinx.cpp.fem.assemble_fused_petsc([A1, M1], [a._cpp_object, M._cpp_object],
+                                             [b_local.array_w], [L._cpp_object], [bc], chunk_size=7)
+    A1.assemble()
+    M1.assemble()
+    b1.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+    assert (A0 - A1).norm() == pytest.approx(0.0, abs=1.0e-12)
+    assert (M0 - M1).norm() == pytest.approx(0.0, abs=1.0e-12)
+    assert (b0 - b1).norm() == pytest.approx(0.0, abs=1.0e-12)
+
+
+@pytest.mark.parametrize("num_threads", [1, 3])
+@pytest.mark.parametrize("mode", [dolfinx.cpp.mesh.GhostMode.none, dolfinx.cpp.mesh.GhostMode.shared_facet])
+def test_nest_single_pass_assembly(mode, num_threads):
+    """Compare nest assembly in a single traversal with assembly of each
+    block"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 12, ghost_mode=mode)
+    V0 = dolfinx.VectorFunctionSpace(mesh, ("Lagrange", 2))
+    V1 = dolfinx.FunctionSpace(mesh, ("Lagrange", 1))
+    u, p = ufl.TrialFunction(V0), ufl.TrialFunction(V1)
+    v, q = ufl.TestFunction(V0), ufl.TestFunction(V1)
+    a = [[dolfinx.fem.Form(inner(grad(u), grad(v)) * dx + inner(u, v) * ds),
+          dolfinx.fem.Form(inner(p, ufl.div(v)) * dx)],
+         [dolfinx.fem.Form(inner(ufl.div(u), q) * dx), None]]
+
+    u_bc = dolfinx.Function(V0)
+    bdofs = dolfinx.fem.locate_dofs_geometrical(V0, lambda x: numpy.isclose(x[0], 0.0))
+    bc = dolfinx.DirichletBC(u_bc, bdofs)
+
+    A = dolfinx.fem.assemble_matrix_nest(a, [bc], diagonal=2.0, num_threads=num_threads)
+    A.assemble()
+    for i, a_row in enumerate(a):
+        for j, a_block in enumerate(a_row):
+            if a_block is not None:
+                A0 = dolfinx.fem.assemble_matrix(a_block, [bc], diagonal=2.0)
+                A0.assemble()
+                assert (A0 - A.getNestSubMatrix(i, j)).norm() == pytest.approx(0.0, abs=1.0e-12)
+
+
+@pytest.mark.parametrize("mode", [dolfinx.cpp.mesh.GhostMode.none, dolfinx.cpp.mesh.GhostMode.shared_facet])
+def test_element_tensor_cache(mode):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 12, ghost_mode=mode)
+    V = dolfinx.VectorFunctionSpace(mesh, ("Lagrange", 1))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    a = dolfinx.fem.Form(inner(grad(u), grad(v)) * dx + inner(u, v) * dx)
+
+    u_bc = dolfinx.Function(V)
+    bdofs = dolfinx.fem.locate_dofs_geometrical(V, lambda x: numpy.isclose(x[0], 0.0))
+    bc = dolfinx.DirichletBC(u_bc, bdofs)
+
+    A0 = dolfinx.fem.assemble_matrix(a, [bc], diagonal=0.0)
+    A0.assemble()
+
+    cache = dolfinx.cpp.fem.ElementTensorCache(a._cpp_object)
+    assert not cache.cached
+    num_dofs = 2 * 3
+    num_cells = mesh.topology.index_map(2).size_local
+    itemsize = numpy.dtype(PETSc.ScalarType).itemsize
+    assert cache.memory_estimate(a._cpp_object) == num_cells * num_dofs**2 * itemsize
+
+    for scale in [1.0, 2.5]:
+        A1 = dolfinx.fem.create_matrix(a)
+        A1.zeroEntries()
+        cache.assemble(A1, [bc], scale)
+        A1.assemble()
+        assert cache.cached
+        assert (scale * A0 - A1).norm() == pytest.approx(0.0, abs=1.0e-12)
+
+    # Facet integrals are not supported
+    with pytest.raises(RuntimeError):
+        dolfinx.cpp.fem.ElementTensorCache(dolfinx.fem.Form(inner(u, v) * ds)._cpp_object)
+
+
+@pytest.mark.parametrize("mode", [dolfinx.cpp.mesh.GhostMode.none, dolfinx.cpp.mesh.GhostMode.shared_facet])
+def test_symmetric_matrix_assembly(mode):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 12, ghost_mode=mode)
+    V = dolfinx.VectorFunctionSpace(mesh, ("Lagrange", 1))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    a = dolfinx.fem.Form(inner(grad(u), grad(v)) * dx + inner(u, v) * dx)
+
+    u_bc = dolfinx.Function(V)
+    bdofs = dolfinx.fem.locate_dofs_geometrical(V, lambda x: numpy.isclose(x[0], 0.0))
+    bc = dolfinx.DirichletBC(u_bc, bdofs)
+
+    A0 = dolfinx.fem.assemble_matrix(a, [bc])
+    A0.assemble()
+
+    A1 = dolfinx.fem.create_matrix(a, "sbaij")
+    A1.zeroEntries()
+    dolfinx.fem.assemble_matrix(A1, a, [bc])
+    A1.assemble()
+    assert A1.getType().endswith("sbaij")
+
+    x, y0 = A0.createVecs()
+    x.setRandom()
+    y1 = y0.duplicate()
+    A0.mult(x, y0)
+    A1.mult(x, y1)
+    assert (y0 - y1).norm() == pytest.approx(0.0, abs=1.0e-10)
+
+
+@pytest.mark.parametrize("mat_type", ["aij", "baij"])
+@pytest.mark.parametrize("mode", [dolfinx.cpp.mesh.GhostMode.none, dolfinx.cpp.mesh.GhostMode.shared_facet])
+def test_matrix_structure_on_creation(mode, mat_type):
+    """The nonzero structure of AIJ/BAIJ matrices is set on creation"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 12, ghost_mode=mode)
+    V = dolfinx.VectorFunctionSpace(mesh, ("Lagrange", 1))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    a = dolfinx.fem.Form(inner(grad(u), grad(v)) * dx)
+
+    A = dolfinx.fem.create_matrix(a, mat_type)
+    assert A.getType().endswith(mat_type)
+    info0 = A.getInfo()
+    assert info0["nz_used"] == info0["nz_allocated"]
+    A.zeroEntries()
+    dolfinx.fem.assemble_matrix(A, a)
+    A.assemble()
+    info1 = A.getInfo()
+    assert info1["nz_used"] == info0["nz_used"]
+    assert info1["mallocs"] == 0.0
+
+    A0 = dolfinx.fem.assemble_matrix(a)
+    A0.assemble()
+    x, y0 = A0.createVecs()
+    x.setRandom()
+    y1 = y0.duplicate()
+    A0.mult(x, y0)
+    A.mult(x, y1)
+    assert (y0 - y1).norm() == pytest.approx(0.0, abs=1.0e-10)
+
+
+@pytest.mark.parametrize("mode", [dolfinx.cpp.mesh.GhostMode.none, dolfinx.cpp.mesh.GhostMode.shared_facet])
+def test_multi_vector_assembly(mode):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 12, ghost_mode=mode)
+    V = dolfinx.VectorFunctionSpace(mesh, ("Lagrange", 1))
+    v = ufl.TestFunction(V)
+    f = dolfinx.Function(V)
+    f.interpolate(lambda x: numpy.stack((x[0], x[1])))
+    x = ufl.SpatialCoordinate(mesh)
+    L = [dolfinx.fem.Form(inner(ufl.as_vector((1.0, 2.0)), v) * dx),
+         dolfinx.fem.Form(inner(f, v) * dx + inner(f, v) * ds),
+         dolfinx.fem.Form(inner(ufl.as_vector((x[1], x[0])), v) * dx(1)),
+         dolfinx.fem.Form(inner(f, v) * ds)]
+
+    size = 2 * (V.dofmap.index_map.size_local + V.dofmap.index_map.num_ghosts)
+    b = numpy.zeros((size, len(L)), dtype=PETSc.ScalarType)
+    dolfinx.cpp.fem.assemble_multi_vector(b, [form._cpp_object for form in L])
+    for j, form in enumerate(L):
+        b0 = numpy.zeros(size, dtype=PETSc.ScalarType)
+        dolfinx.cpp.fem.assemble_vector(b0, form._cpp_object)
+        assert numpy.allclose(b[:, j], b0, atol=1.0e-12)
+
+    # Forms must share the test space
+    W = dolfinx.FunctionSpace(mesh, ("Lagrange", 1))
+    L1 = dolfinx.fem.Form(ufl.TestFunction(W) * dx)
+    with pytest.raises(RuntimeError):
+        dolfinx.cpp.fem.assemble_multi_vector(b[:, :2].copy(), [L[0]._cpp_object, L1._cpp_object])
+
+
+@pytest.mark.parametrize("mode", [dolfinx.cpp.mesh.GhostMode.none, dolfinx.cpp.mesh.GhostMode.shared_facet])
+def test_constants_ensemble_assembly(mode):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 12, ghost_mode=mode)
+    V = dolfinx.FunctionSpace(mesh, ("Lagrange", 1))
+    v = ufl.TestFunction(V)
+    f = dolfinx.Function(V)
+    f.interpolate(lambda x: 1.0 + x[0])
+    c0, c1 = fem.Constant(mesh, 1.0), fem.Constant(mesh, 1.0)
+    M = dolfinx.fem.Form(c0 * f * dx + c1 * f * ds)
+    L = dolfinx.fem.Form(c0 * f * v * dx + c1 * v * ds)
+
+    values = [(1.0, 2.0), (-3.0, 0.5), (0.0, 4.0)]
+    constants = numpy.array(values, dtype=PETSc.ScalarType)
+    size = V.dofmap.index_map.size_local + V.dofmap.index_map.num_ghosts
+    b = numpy.zeros((size, len(values)), dtype=PETSc.ScalarType)
+    m = dolfinx.cpp.fem.assemble_scalar(M._cpp_object, constants)
+    dolfinx.cpp.fem.assemble_vector(b, L._cpp_object, constants)
+    for j, (v0, v1) in enumerate(values):
+        c0.value, c1.value = v0, v1
+        assert m[j] == pytest.approx(dolfinx.fem.assemble_scalar(M), abs=1.0e-12)
+        b0 = numpy.zeros(size, dtype=PETSc.ScalarType)
+        dolfinx.cpp.fem.assemble_vector(b0, L._cpp_object)
+        assert numpy.allclose(b[:, j], b0, atol=1.0e-12)
+
+
+@pytest.mark.parametrize("mode", [dolfinx.cpp.mesh.GhostMode.none, dolfinx.cpp.mesh.GhostMode.shared_facet])
+def test_reproducible_scalar_assembly(mode):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 32, 32, ghost_mode=mode)
+    V = dolfinx.FunctionSpace(mesh, ("Lagrange", 1))
+    f = dolfinx.Function(V)
+    f.interpolate(lambda x: numpy.sin(10.0 * x[0]) * numpy.cos(3.0 * x[1]))
+    M = dolfinx.fem.Form(f * f * dx + f * ds + ufl.avg(f) * ufl.dS)
+
+    m0 = dolfinx.cpp.fem.assemble_scalar(M._cpp_object)
+    for num_threads in [2, 3, 4]:
+        assert dolfinx.cpp.fem.assemble_scalar(M._cpp_object, num_threads) == m0
+
+    m = dolfinx.cpp.common.sum_reproducible(mesh.mpi_comm(), m0)
+    assert m == pytest.approx(mesh.mpi_comm().allreduce(m0, op=MPI.SUM), rel=1.0e-12)
+    assert mesh.mpi_comm().allgather(m) == [m] * mesh.mpi_comm().size
+
+
+def test_pack_coefficients_padded():
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 4, 4)
+    V = dolfinx.FunctionSpace(mesh, ("Lagrange", 1))
+    f = dolfinx.Function(V)
+    f.interpolate(lambda x: x[0] + 2 * x[1])
+    M = dolfinx.fem.Form(f * ufl.dx)
+
+    c0 = dolfinx.cpp.fem.pack_coefficients(M._cpp_object)
+    width = 8
+    c1 = dolfinx.cpp.fem.pack_coefficients(M._cpp_object, width=width)
+    assert c1.shape == c0.shape
+    assert numpy.array_equal(c1, c0)
+
+    # The rows are padded and aligned
+    alignment = width * c1.itemsize
+    assert c1.strides[0] % alignment == 0
+    assert c1.ctypes.data % alignment == 0
+
+
+def test_scalar_assembly_costs():
+    """Threaded assembly of integrals over subdomains with different
+    costs measures the costs and schedules the chunks by cost"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 32, 32)
+    V = dolfinx.FunctionSpace(mesh, ("Lagrange", 3))
+    f = dolfinx.Function(V)
+    f.interpolate(lambda x: numpy.sin(10.0 * x[0]) * numpy.cos(3.0 * x[1]))
+
+    cells = numpy.arange(mesh.topology.index_map(2).size_local, dtype=numpy.int32)
+    marker = dolfinx.MeshTags(mesh, 2, cells, (cells % 2).astype(numpy.int32))
+    dx_m = ufl.Measure("dx", subdomain_data=marker)
+    M = dolfinx.fem.Form(f * dx_m(0) + f**4 * dx_m(1, degree=12) + f * ds)
+
+    m0 = dolfinx.cpp.fem.assemble_scalar(M._cpp_object)
+    types = dolfinx.cpp.fem.IntegralType
+    assert M._cpp_object.cost(types.cell, 1) == 0.0
+
+    assert dolfinx.cpp.fem.assemble_scalar(M._cpp_object, 4) == m0
+    ids = M._cpp_object.integral_ids(types.cell)
+    for i in ids:
+        if len(M._cpp_object.domains(types.cell, i)) > 0:
+            assert M._cpp_object.cost(types.cell, i) > 0.0
+
+    for num_threads in [2, 3, 4]:
+        assert dolfinx.cpp.fem.assemble_scalar(M._cpp_object, num_threads) == m0
+
+
+@pytest.mark.parametrize("mode", [dolfinx.cpp.mesh.GhostMode.none, dolfinx.cpp.mesh.GhostMode.shared_facet])
+def test_fused_lifting_assembly(mode):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 12, ghost_mode=mode)
+    V = dolfinx.VectorFunctionSpace(mesh, ("Lagrange", 2))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    f = dolfinx.Function(V)
+    f.interpolate(lambda x: numpy.stack((x[0], x[1] * x[1])))
+    a = dolfinx.fem.Form(inner(grad(u), grad(v)) * dx + inner(u, v) * ds)
+    L = dolfinx.fem.Form(inner(f, v) * dx + inner(f, v) * ds)
+
+    u_bc = dolfinx.Function(V)
+    u_bc.interpolate(lambda x: numpy.stack((1.0 + x[1], x[0])))
+    bdofs = dolfinx.fem.locate_dofs_geometrical(V, lambda x: numpy.isclose(x[0], 0.0))
+    bc = dolfinx.DirichletBC(u_bc, bdofs)
+
+    x0 = dolfinx.Function(V)
+    x0.interpolate(lambda x: numpy.stack((x[0] * x[1], 2.0 * x[1])))
+    for _x0 in [None, x0]:
+        b0 = dolfinx.fem.create_vector(L)
+        with b0.localForm() as b_local:
+            b_local.set(0.0)
+        dolfinx.fem.assemble_vector(b0, L)
+        dolfinx.fem.apply_lifting(b0, [a], [[bc]], [] if _x0 is None else [_x0.vector], scale=-2.0)
+        b0.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+
+        b1 = dolfinx.fem.create_vector(L)
+        with b1.localForm() as b_local:
+            b_local.set(0.0)
+            x = numpy.zeros(0, dtype=PETSc.ScalarType)
+            if _x0 is not None:
+                with _x0.vector.localForm() as x_local:
+                    x = x_local.array.copy()
+            dolfinx.cpp.fem.assemble_vector(b_local.array_w, L._cpp_object, a._cpp_object, [bc], x, -2.0)
+        b1.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+        assert (b0 - b1).norm() == pytest.approx(0.0, abs=1.0e-10)
+
+
+@pytest.mark.parametrize("mode", [dolfinx.cpp.mesh.GhostMode.none, dolfinx.cpp.mesh.GhostMode.shared_facet])
+def test_sorted_domains_assembly(mode):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 12, ghost_mode=mode)
+    V = dolfinx.FunctionSpace(mesh, ("Lagrange", 1))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    f = dolfinx.Function(V)
+    f.interpolate(lambda x: 1.0 + x[0] * x[1])
+    a = dolfinx.fem.Form(f * inner(u, v) * ds + inner(ufl.avg(u), ufl.avg(v)) * ufl.dS)
+    L = dolfinx.fem.Form(f * v * ds + ufl.avg(f) * ufl.avg(v) * ufl.dS)
+
+    A0 = dolfinx.fem.assemble_matrix(a)
+    A0.assemble()
+    b0 = dolfinx.fem.assemble_vector(L)
+    b0.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+
+    tdim = mesh.topology.dim
+    f_to_c = mesh.topology.connectivity(tdim - 1, tdim)
+    for form in [a, L]:
+        form._cpp_object.sort_domains()
+        for itype in [fem.IntegralType.exterior_facet, fem.IntegralType.interior_facet]:
+            facets = form._cpp_object.domains(itype, -1)
+            cells = [min(f_to_c.links(f)) for f in facets]
+            assert numpy.all(numpy.diff(cells) >= 0)
+
+    A1 = dolfinx.fem.assemble_matrix(a)
+    A1.assemble()
+    b1 = dolfinx.fem.assemble_vector(L)
+    b1.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+    assert (A1 - A0).norm() == pytest.approx(0.0, abs=1.0e-12)
+    assert (b1 - b0).norm() == pytest.approx(0.0, abs=1.0e-12)
+
+
+def test_assembly_python_threads():
+    """Assembly releases the GIL, so it can run in concurrent Python threads"""
+    from concurrent.futures import ThreadPoolExecutor
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 16, 16)
+    V = dolfinx.FunctionSpace(mesh, ("Lagrange", 1))
+    v = ufl.TestFunction(V)
+    x = ufl.SpatialCoordinate(mesh)
+    L = dolfinx.fem.Form((1.0 + x[0]) * v * dx)
+
+    size = V.dofmap.index_map.size_local + V.dofmap.index_map.num_ghosts
+
+    def assemble(i):
+        b = numpy.zeros(size, dtype=PETSc.ScalarType)
+        dolfinx.cpp.fem.assemble_vector(b, L._cpp_object)
+        return b
+
+    b0 = assemble(0)
+    with ThreadPoolExecutor(max_workers=4) as executor:
+        for b in executor.map(assemble, range(8)):
+            assert numpy.allclose(b, b0)
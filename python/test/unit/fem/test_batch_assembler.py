@@ -0,0 +1,175 @@
+# Copyright (C) 2021 Garth N. Wells
+#
+# This file is part of DOLFINx (https://www.fenicsproject.org)
+#
+# SPDX-License-Identifier:    LGPL-3.0-or-later
+"""Unit tests for assembly with batched kernels"""
+
+import dolfinx
+import numba
+import numpy as np
+import pytest
+from dolfinx import cpp
+from dolfinx.fem import IntegralType
+from mpi4py import MPI
+from petsc4py import PETSc
+
+c_signature = numba.types.void(
+    numba.types.CPointer(numba.typeof(PETSc.ScalarType())),
+    numba.types.CPointer(numba.typeof(PETSc.ScalarType())),
+    numba.types.CPointer(numba.typeof(PETSc.ScalarType())),
+    numba.types.CPointer(numba.types.double),
+    numba.types.CPointer(numba.types.int32),
+    numba.types.CPointer(numba.types.int32))
+
+# Number of cells per batch. The number of cells is not a multiple of
+# the batch size, so the last batch is padded.
+batch_size = 4
+
+
+@numba.njit
+def stiffness(x):
+    """P1 stiffness matrix of a triangle with vertex coordinates x"""
+    x0, y0 = x[0, 0], x[0, 1]
+    x1, y1 = x[1, 0], x[1, 1]
+    x2, y2 = x[2, 0], x[2, 1]
+    Ae = abs((x0 - x1) * (y2 - y1) - (y0 - y1) * (x2 - x1))
+    B = np.array([y1 - y2, y2 - y0, y0 - y1, x2 - x1, x0 - x2, x1 - x0], dtype=PETSc.ScalarType).reshape(2, 3)
+    return np.dot(B.T, B) / (2 * Ae)
+
+
+@numba.njit
+def load(x, w):
+    """P1 load vector of a triangle for a constant source w"""
+    x0, y0 = x[0, 0], x[0, 1]
+    x1, y1 = x[1, 0], x[1, 1]
+    x2, y2 = x[2, 0], x[2, 1]
+    Ae = abs((x0 - x1) * (y2 - y1) - (y0 - y1) * (x2 - x1))
+    return w * Ae / 6.0
+
+
+@numba.cfunc(c_signature, nopython=True)
+def tabulate_A(A_, w_, c_, coords_, entity_local_index, orientation):
+    A = numba.carray(A_, (3, 3), dtype=PETSc.ScalarType)
+    x = numba.carray(coords_, (3, 3), dtype=np.float64)
+    A[:, :] = stiffness(x)
+
+
+@numba.cfunc(c_signature, nopython=True)
+def tabulate_A_batch(A_, w_, c_, coords_, entity_local_index, orientation):
+    A = numba.carray(A_, (3, 3, batch_size), dtype=PETSc.ScalarType)
+    x = numba.carray(coords_, (3, 3, batch_size), dtype=np.float64)
+    for k in range(batch_size):
+        A[:, :, k] = stiffness(x[:, :, k])
+
+
+@numba.cfunc(c_signature, nopython=True)
+def tabulate_b(b_, w_, c_, coords_, entity_local_index, orientation):
+    b = numba.carray(b_, (3), dtype=PETSc.ScalarType)
+    w = numba.carray(w_, (1), dtype=PETSc.ScalarType)
+    x = numba.carray(coords_, (3, 3), dtype=np.float64)
+    b[:] = load(x, w[0])
+
+
+@numba.cfunc(c_signature, nopython=True)
+def tabulate_b_batch(b_, w_, c_, coords_, entity_local_index, orientation):
+    b = numba.carray(b_, (3, batch_size), dtype=PETSc.ScalarType)
+    w = numba.carray(w_, (1, batch_size), dtype=PETSc.ScalarType)
+    x = numba.carray(coords_, (3, 3, batch_size), dtype=np.float64)
+    for k in range(batch_size):
+        b[:, k] = load(x[:, :, k], w[0, k])
+
+
+def create_forms():
+    """Create the bilinear and linear forms of a Poisson problem with a
+    DG0 source, with per-cell kernels and with batched kernels"""
+    mesh = dolfinx.generation.UnitSquareMesh(MPI.COMM_WORLD, 13, 11)
+    V = dolfinx.fem.FunctionSpace(mesh, ("Lagrange", 1))
+    f = dolfinx.fem.Function(dolfinx.fem.FunctionSpace(mesh, ("DG", 0)))
+    f.interpolate(lambda x: 1.0 + x[0] * x[1])
+
+    forms = []
+    for batched in [False, True]:
+        integrals = {IntegralType.cell: ([(-1, tabulate_A.address)], None)}
+        a = cpp.fem.Form([V._cpp_object, V._cpp_object], integrals, [], [], False)
+        integrals = {IntegralType.cell: ([(-1, tabulate_b.address)], None)}
+        L = cpp.fem.Form([V._cpp_object], integrals, [f._cpp_object], [], False)
+        if batched:
+            a.set_batch_kernel(IntegralType.cell, -1, tabulate_A_batch.address, batch_size)
+            L.set_batch_kernel(IntegralType.cell, -1, tabulate_b_batch.address, batch_size)
+        forms.append((a, L))
+    return V, f, forms[0], forms[1]
+
+
+def test_batch_kernel_assembly():
+    """Assembly with batched kernels by the matrix and vector assemblers"""
+    _, _, (a0, L0), (a1, L1) = create_forms()
+
+    A0 = dolfinx.fem.assemble_matrix(a0)
+    A0.assemble()
+    A1 = dolfinx.fem.assemble_matrix(a1)
+    A1.assemble()
+    A1.axpy(-1.0, A0)
+    assert A1.norm() == pytest.approx(0.0, abs=1.0e-12 * A0.norm())
+
+    b0 = dolfinx.fem.assemble_vector(L0)
+    b1 = dolfinx.fem.assemble_vector(L1)
+    assert np.allclose(b1.array, b0.array)
+
+
+@pytest.mark.parametrize("num_threads", [1, 2])
+@pytest.mark.parametrize("with_bc", [False, True])
+def test_batch_assembler_matrix(num_threads, with_bc):
+    V, _, (a0, _), (a1, _) = create_forms()
+
+    # Marked rows and columns are not assembled
+    index_map = V.dofmap.index_map
+    num_dofs = index_map.size_local + index_map.num_ghosts
+    marker = [False] * num_dofs
+    if with_bc:
+        for dof in dolfinx.fem.locate_dofs_geometrical(V, lambda x: np.isclose(x[0], 0.0)):
+            marker[dof] = True
+
+    pattern = cpp.fem.create_sparsity_pattern(a1)
+    pattern.assemble()
+    A = cpp.la.MatrixCSR(pattern)
+    assembler = cpp.fem.BatchAssembler(a1, A, marker, marker)
+    assert assembler.num_cells == V.mesh.topology.index_map(2).size_local
+
+    A0 = cpp.la.create_matrix(MPI.COMM_WORLD, pattern)
+    cpp.fem.assemble_matrix_petsc(A0, a0, marker, marker)
+    A0.assemble()
+    rows = (index_map.local_range[0] + np.arange(index_map.size_local)).astype(PETSc.IntType)
+    cols = A.column_indices.astype(PETSc.IntType)
+    A0 = A0.getValues(rows, cols)
+
+    # Repeated assembly gives the same matrix
+    for i in range(2):
+        A.set(0.0)
+        assembler.assemble(A, num_threads)
+        A.finalize()
+        assert np.allclose(A.to_dense(), A0)
+
+
+@pytest.mark.parametrize("num_threads", [1, 2])
+def test_batch_assembler_vector(num_threads):
+    V, f, (_, L0), (_, L1) = create_forms()
+    index_map = V.dofmap.index_map
+    num_dofs = index_map.size_local + index_map.num_ghosts
+
+    def reference():
+        b0 = np.zeros(num_dofs, dtype=PETSc.ScalarType)
+        cpp.fem.assemble_vector(b0, L0)
+        return b0
+
+    assembler = cpp.fem.BatchAssembler(L1)
+    b = np.zeros(num_dofs, dtype=PETSc.ScalarType)
+    assembler.assemble(b, num_threads)
+    assert np.allclose(b, reference())
+
+    # Assemble with new coefficients
+    f.x.array[:] = 3.0
+    assembler.update_coefficients(cpp.fem.pack_coefficients(L1))
+    b[:] = 0.0
+    assembler.assemble(b, num_threads)
+    assert np.allclose(b, reference())
@@ -93,3 +93,95 @@ def test_overlapping_bcs():
         with b.localForm() as b_loc:
             print(b_loc[dof_corner[0]])
             assert b_loc[dof_corner[0]] == 123.456
+
+
+def test_locate_dofs_topological_batched():
+    """Test that locating dofs for several spaces and entity sets at once
+    gives the same dofs as locating them separately"""
+    mesh = dolfinx.generation.UnitSquareMesh(MPI.COMM_WORLD, 8, 5)
+    tdim = mesh.topology.dim
+    V1 = dolfinx.fem.FunctionSpace(mesh, ("Lagrange", 1))
+    V2 = dolfinx.fem.VectorFunctionSpace(mesh, ("Lagrange", 2))
+    facets_left = dolfinx.mesh.locate_entities_boundary(mesh, tdim - 1, lambda x: np.isclose(x[0], 0.0))
+    facets_top = dolfinx.mesh.locate_entities_boundary(mesh, tdim - 1, lambda x: np.isclose(x[1], 1.0))
+    vertices = dolfinx.mesh.locate_entities_boundary(mesh, 0, lambda x: np.isclose(x[0], 1.0))
+
+    spaces = [V1._cpp_object, V2._cpp_object, V2._cpp_object]
+    dims = [tdim - 1, tdim - 1, 0]
+    entities = [facets_left, facets_top, vertices]
+    dofs = dolfinx.cpp.fem.locate_dofs_topological_batched(spaces, dims, entities)
+    assert len(dofs) == 3
+    for V, dim, e, d in zip(spaces, dims, entities, dofs):
+        assert np.array_equal(d, dolfinx.cpp.fem.locate_dofs_topological(V, dim, e))
+
+
+def test_merged_bcs():
+    """Test that merged boundary conditions give the same lifted vector
+    as the list of boundary conditions, with the last boundary condition
+    applied where they overlap"""
+    n = 12
+    mesh = dolfinx.generation.UnitSquareMesh(MPI.COMM_WORLD, n, n)
+    V = dolfinx.fem.FunctionSpace(mesh, ("Lagrange", 1))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    a = inner(u, v) * dx
+    L = inner(1, v) * dx
+
+    dofs_left = dolfinx.fem.locate_dofs_geometrical(V, lambda x: x[0] < 1.0 / (2.0 * n))
+    dofs_top = dolfinx.fem.locate_dofs_geometrical(V, lambda x: x[1] > 1.0 - 1.0 / (2.0 * n))
+    u0, u1 = dolfinx.Function(V), dolfinx.Function(V)
+    u0.interpolate(lambda x: 1.0 + x[1])
+    u1.interpolate(lambda x: 2.0 + x[0])
+    bcs = [dolfinx.DirichletBC(u0, dofs_left), dolfinx.DirichletBC(u1, dofs_top)]
+    bcs_V = dolfinx.cpp.fem.DirichletBCs(V._cpp_object, bcs)
+
+    dofs, owned = bcs_V.dof_indices()
+    assert np.all(np.diff(dofs) > 0)
+    assert np.array_equal(dofs, np.union1d(dofs_left, dofs_top))
+    assert np.all(dofs[:owned] < V.dofmap.index_map.size_local)
+
+    def assemble(bcs):
+        b = dolfinx.fem.create_vector(L)
+        with b.localForm() as b_loc:
+            b_loc.set(0)
+        dolfinx.fem.assemble_vector(b, L)
+        dolfinx.fem.apply_lifting(b, [a], [bcs])
+        b.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+        dolfinx.fem.set_bc(b, bcs)
+        return b
+
+    for _ in range(2):
+        b0, b1 = assemble(bcs), assemble(bcs_V)
+        assert np.allclose(b0.array, b1.array)
+
+        # Boundary values are read on each application
+        with u1.vector.localForm() as u1_loc:
+            u1_loc.array[:] *= 2.0
+
+
+def test_update_bc_values():
+    """Test that boundary values evaluated at the boundary dof
+    coordinates match the values interpolated into the boundary value
+    function"""
+    n = 8
+    mesh = dolfinx.generation.UnitSquareMesh(MPI.COMM_WORLD, n, n)
+    V = dolfinx.fem.VectorFunctionSpace(mesh, ("Lagrange", 2))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    a = inner(u, v) * dx
+    L = inner(ufl.as_vector((1, 1)), v) * dx
+    dofs = dolfinx.fem.locate_dofs_geometrical(V, lambda x: np.isclose(x[0], 0.0))
+
+    def g(t):
+        return lambda x: np.vstack((t * x[1], 1.0 + t * x[1]**2))
+
+    u0, u1 = dolfinx.Function(V), dolfinx.Function(V)
+    bc0, bc1 = dolfinx.DirichletBC(u0, dofs), dolfinx.DirichletBC(u1, dofs)
+    for t in [1.0, 2.0]:
+        u0.interpolate(g(t))
+        bc1.update_values(g(t))
+        b0 = dolfinx.fem.assemble_vector(L)
+        b1 = dolfinx.fem.assemble_vector(L)
+        for b, bc in ((b0, bc0), (b1, bc1)):
+            dolfinx.fem.apply_lifting(b, [a], [[bc]])
+            b.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+            dolfinx.fem.set_bc(b, [bc])
+        assert np.allclose(b0.array, b1.array)
@@ -7,8 +7,10 @@
 
 import numpy
 import pytest
-from dolfinx import FunctionSpace, UnitCubeMesh, UnitSquareMesh
-from dolfinx.cpp.fem import create_discrete_gradient
+from dolfinx import (Function, FunctionSpace, UnitCubeMesh, UnitSquareMesh,
+                     VectorFunctionSpace)
+from dolfinx.cpp.fem import (create_discrete_gradient,
+                             create_interpolation_matrix)
 from dolfinx.cpp.mesh import GhostMode
 from dolfinx_utils.test.skips import skip_in_parallel
 from mpi4py import MPI
@@ -36,6 +38,11 @@ def test_gradient(mesh):
     assert n == mesh.topology.index_map(0).size_global
     assert numpy.isclose(G.norm(PETSc.NormType.FROBENIUS), numpy.sqrt(2.0 * num_edges))
 
+    # Check that the operator computed by several threads is the same
+    G1 = create_discrete_gradient(W._cpp_object, V._cpp_object, num_threads=4)
+    G1.axpy(-1.0, G)
+    assert G1.norm(PETSc.NormType.FROBENIUS) == 0.0
+
 
 def test_incompatible_spaces():
     """Test that error is thrown when function spaces are not compatible"""
@@ -53,3 +60,28 @@ def test_incompatible_spaces():
     V = FunctionSpace(mesh, ("Lagrange", 2))
     with pytest.raises(RuntimeError):
         create_discrete_gradient(W._cpp_object, V._cpp_object)
+
+
+@pytest.mark.parametrize("degrees", [(2, 1), (1, 2), (3, 1)])
+@pytest.mark.parametrize("mesh", [
+    UnitSquareMesh(MPI.COMM_WORLD, 7, 5, ghost_mode=GhostMode.none),
+    UnitCubeMesh(MPI.COMM_WORLD, 3, 4, 2, ghost_mode=GhostMode.shared_facet)
+])
+def test_interpolation_matrix(mesh, degrees):
+    """Test that applying the interpolation matrix is the same as
+    interpolating a function"""
+    V0 = VectorFunctionSpace(mesh, ("Lagrange", degrees[0]))
+    V1 = VectorFunctionSpace(mesh, ("Lagrange", degrees[1]))
+    A = create_interpolation_matrix(V0._cpp_object, V1._cpp_object)
+    m, n = A.getSize()
+    assert m == V0.dofmap.index_map.size_global * V0.dofmap.index_map_bs
+    assert n == V1.dofmap.index_map.size_global * V1.dofmap.index_map_bs
+
+    v = Function(V1)
+    v.interpolate(lambda x: numpy.vstack([x[i]**2 + i for i in range(mesh.geometry.dim)]))
+    u = Function(V0)
+    u.interpolate(v)
+
+    w = Function(V0)
+    A.mult(v.vector, w.vector)
+    assert numpy.allclose(w.vector.array, u.vector.array)
@@ -7,6 +7,7 @@
 
 import sys
 
+import cffi
 import dolfinx
 import numpy as np
 import pytest
@@ -368,3 +369,104 @@ def test_transpose_dofmap():
     dofmap = dolfinx.cpp.graph.AdjacencyList_int32(np.array([[0, 2, 1], [3, 2, 1], [4, 3, 1]], dtype=np.int32))
     transpose = dolfinx.cpp.fem.transpose_dofmap(dofmap, 3)
     assert np.array_equal(transpose.array, [0, 2, 5, 8, 1, 4, 3, 7, 6])
+
+
+def test_owner_sorted_ghosts():
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 8, 8)
+    V = FunctionSpace(mesh, ("Lagrange", 2))
+    ffi = cffi.FFI()
+    dofmap = cpp.fem.create_dofmap(mesh.mpi_comm(), ffi.cast("uintptr_t", ffi.addressof(V._ufc_dofmap)),
+                                   mesh.topology, V._cpp_object.element, sort_ghosts=True)
+
+    # Ghosts are contiguous by owning rank
+    map0, map1 = V.dofmap.index_map, dofmap.index_map
+    owners = map1.ghost_owner_rank()
+    assert np.all(np.diff(owners) >= 0)
+    assert map1.size_local == map0.size_local
+    assert np.array_equal(np.sort(map1.ghosts), np.sort(map0.ghosts))
+
+    # Global numbering of the cell dofs is unchanged
+    num_cells = mesh.topology.index_map(mesh.topology.dim).size_local
+    for c in range(num_cells):
+        dofs0 = map0.local_to_global(V.dofmap.cell_dofs(c))
+        dofs1 = map1.local_to_global(dofmap.cell_dofs(c))
+        assert np.array_equal(dofs0, dofs1)
+
+
+def test_compact_dofmap():
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 4, 4)
+    V = VectorFunctionSpace(mesh, ("Lagrange", 2))
+    num_cells = mesh.topology.index_map(mesh.topology.dim).size_local
+
+    # Dofmaps and the geometry dofmap have a constant number of dofs
+    # per cell and are stored without offsets
+    for dofmap in [V.dofmap, V.sub(0).dofmap, V.sub(0).collapse().dofmap]:
+        assert dofmap.list.is_compact
+        assert np.array_equal(dofmap.list.offsets, np.arange(0, 6 * dofmap.list.num_nodes + 1, 6))
+        for c in range(num_cells):
+            assert np.array_equal(dofmap.cell_dofs(c), dofmap.list.links(c))
+
+    # The geometry dofmap of a P1 mesh is the compact cell-vertex
+    # connectivity, and a P2 geometry dofmap is compact too
+    tdim = mesh.topology.dim
+    assert mesh.topology.connectivity(tdim, 0).is_compact
+    assert mesh.geometry.dofmap.is_compact
+    assert np.array_equal(mesh.geometry.dofmap.array, mesh.topology.connectivity(tdim, 0).array)
+    if MPI.COMM_WORLD.rank == 0:
+        points = np.array([[0.0, 0.0], [1.0, 0.0], [0.0, 1.0], [0.5, 0.5], [0.0, 0.5], [0.5, 0.0]])
+        cells = np.array([range(6)], dtype=np.int64)
+    else:
+        points, cells = np.zeros((0, 2)), np.zeros((0, 6), dtype=np.int64)
+    domain = ufl.Mesh(ufl.VectorElement("Lagrange", "triangle", 2))
+    mesh2 = create_mesh(MPI.COMM_WORLD, cells, points, domain)
+    assert mesh2.geometry.dofmap.is_compact
+    assert mesh2.geometry.dofmap.num_nodes == mesh2.topology.index_map(tdim).size_local
+    assert np.array_equal(mesh2.geometry.dofmap.offsets, np.arange(0, 6 * mesh2.geometry.dofmap.num_nodes + 1, 6))
+
+
+@pytest.mark.parametrize("sort_ghosts", [False, True])
+def test_threaded_dofmap(sort_ghosts):
+    mesh = UnitCubeMesh(MPI.COMM_WORLD, 4, 3, 3)
+    V = VectorFunctionSpace(mesh, ("Lagrange", 3))
+    ffi = cffi.FFI()
+    ufc_dofmap = ffi.cast("uintptr_t", ffi.addressof(V._ufc_dofmap))
+    dofmap0 = cpp.fem.create_dofmap(mesh.mpi_comm(), ufc_dofmap, mesh.topology,
+                                    V._cpp_object.element, sort_ghosts=sort_ghosts)
+
+    # The dofmap built with threads is the same as the serial dofmap
+    for num_threads in [2, 5]:
+        dofmap1 = cpp.fem.create_dofmap(mesh.mpi_comm(), ufc_dofmap, mesh.topology,
+                                        V._cpp_object.element, sort_ghosts=sort_ghosts,
+                                        num_threads=num_threads)
+        assert dofmap1.list == dofmap0.list
+        assert dofmap1.index_map.size_local == dofmap0.index_map.size_local
+        assert np.array_equal(dofmap1.index_map.ghosts, dofmap0.index_map.ghosts)
+        assert np.array_equal(dofmap1.index_map.ghost_owner_rank(), dofmap0.index_map.ghost_owner_rank())
+
+
+def test_component_dofs(mesh):
+    tdim = mesh.topology.dim
+    num_cells = mesh.topology.index_map(tdim).size_local
+
+    # The components of a blocked dofmap are strided
+    V = VectorFunctionSpace(mesh, ("Lagrange", 1))
+    dofs = cpp.fem.compute_component_dofs(V.dofmap._cpp_object, num_cells)
+    bs = V.dofmap.index_map_bs
+    size_local = V.dofmap.index_map.size_local
+    assert dofs.num_nodes == bs
+    for k in range(bs):
+        assert np.array_equal(dofs.links(k), bs * np.arange(size_local) + k)
+
+    # The components of the vector sub-space of a mixed space are the
+    # owned dofs of the collapsed components
+    P2 = VectorElement("Lagrange", mesh.ufl_cell(), 2)
+    P1 = FiniteElement("Lagrange", mesh.ufl_cell(), 1)
+    W = FunctionSpace(mesh, P2 * P1)
+    W0 = W.sub(0)
+    dofs = cpp.fem.compute_component_dofs(W0.dofmap._cpp_object, num_cells)
+    V0, collapsed_dofs = W0.collapse(True)
+    size_local = V0.dofmap.index_map.size_local
+    collapsed_dofs = np.array(collapsed_dofs).reshape(-1, 2)[:size_local]
+    assert dofs.num_nodes == 2
+    for k in range(2):
+        assert np.array_equal(dofs.links(k), np.sort(collapsed_dofs[:, k]))
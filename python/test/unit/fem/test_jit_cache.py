@@ -0,0 +1,54 @@
+# Copyright (C) 2021 Garth N. Wells
+#
+# This file is part of DOLFINx (https://www.fenicsproject.org)
+#
+# SPDX-License-Identifier:    LGPL-3.0-or-later
+"""Unit tests for concurrent JIT compilation and pre-warming of the cache"""
+
+import os
+
+import dolfinx.jit
+import ufl
+from dolfinx_utils.test.fixtures import tempdir
+from mpi4py import MPI
+
+assert (tempdir)
+
+
+def test_ffcx_jit_many(tempdir):
+    jit_parameters = {"cache_dir": tempdir, "timeout": 60}
+    element = ufl.FiniteElement("Lagrange", ufl.triangle, 1)
+    u, v = ufl.TrialFunction(element), ufl.TestFunction(element)
+    forms = [ufl.inner(u, v) * ufl.dx, ufl.inner(ufl.grad(u), ufl.grad(v)) * ufl.dx, v * ufl.dx]
+
+    compiled = dolfinx.jit.ffcx_jit_many(MPI.COMM_WORLD, forms, jit_parameters=jit_parameters)
+    assert len(compiled) == len(forms)
+    for form, (ufc_form, module, code) in zip(forms, compiled):
+        assert ufc_form.rank == len(form.arguments())
+
+        # The object is loaded from the cache
+        ufc_form1, module1, _ = dolfinx.jit.ffcx_jit(MPI.COMM_WORLD, form, jit_parameters=jit_parameters)
+        assert module1.__name__ == module.__name__
+
+
+def test_prewarm(tempdir):
+    filename = os.path.join(tempdir, "forms.ufl")
+    if MPI.COMM_WORLD.rank == 0:
+        with open(filename, "w") as f:
+            f.write("element = FiniteElement('Lagrange', tetrahedron, 2)\n"
+                    "u, v = TrialFunction(element), TestFunction(element)\n"
+                    "a = inner(grad(u), grad(v)) * dx\n"
+                    "L = v * dx\n")
+    MPI.COMM_WORLD.barrier()
+
+    cache_dir = os.path.join(tempdir, "cache")
+    jit_parameters = {"cache_dir": cache_dir, "timeout": 60}
+    n = dolfinx.jit.prewarm(MPI.COMM_WORLD, [filename], num_workers=2, jit_parameters=jit_parameters)
+    assert n >= 2
+    num_files = len(os.listdir(cache_dir))
+
+    # A form with the same signature is found in the cache
+    element = ufl.FiniteElement("Lagrange", ufl.tetrahedron, 2)
+    v = ufl.TestFunction(element)
+    dolfinx.jit.ffcx_jit(MPI.COMM_WORLD, v * ufl.dx, jit_parameters=jit_parameters)
+    assert len(os.listdir(cache_dir)) == num_files
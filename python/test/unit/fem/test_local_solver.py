@@ -0,0 +1,80 @@
+# Copyright (C) 2021 Garth N. Wells
+#
+# This file is part of DOLFINx (https://www.fenicsproject.org)
+#
+# SPDX-License-Identifier:    LGPL-3.0-or-later
+"""Unit tests for the solution of cell-local systems"""
+
+import dolfinx
+import numpy as np
+import pytest
+import ufl
+from dolfinx.cpp.fem import LocalSolver
+from dolfinx.cpp.mesh import CellType
+from dolfinx.generation import UnitSquareMesh
+from mpi4py import MPI
+from petsc4py import PETSc
+from ufl import dx, inner
+
+
+@pytest.mark.parametrize("cell_type", [CellType.triangle, CellType.quadrilateral])
+@pytest.mark.parametrize("degree", [0, 1, 2])
+@pytest.mark.parametrize("solver_type", [LocalSolver.Type.lu, LocalSolver.Type.cholesky])
+def test_local_projection(cell_type, degree, solver_type):
+    """Compare the local projection into a DG space with the solution of
+    the global mass matrix system"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 7, 5, cell_type)
+    V = dolfinx.fem.FunctionSpace(mesh, ("DG", degree))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    x = ufl.SpatialCoordinate(mesh)
+    f = ufl.sin(3 * x[0]) * ufl.exp(x[1])
+    a = dolfinx.fem.Form(inner(u, v) * dx)
+    L = dolfinx.fem.Form(inner(f, v) * dx)
+
+    solver = LocalSolver(a._cpp_object, L._cpp_object, solver_type)
+    solver.factorize(num_threads=2)
+    uh = dolfinx.fem.Function(V)
+    solver.solve(uh.x, num_threads=2)
+
+    # Global solve
+    A = dolfinx.fem.assemble_matrix(a)
+    A.assemble()
+    b = dolfinx.fem.assemble_vector(L)
+    b.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+    ksp = PETSc.KSP().create(mesh.mpi_comm())
+    ksp.setOperators(A)
+    ksp.setType("cg")
+    ksp.getPC().setType("jacobi")
+    ksp.setTolerances(rtol=1.0e-14)
+    u0 = dolfinx.fem.Function(V)
+    ksp.solve(b, u0.vector)
+    u0.vector.ghostUpdate(addv=PETSc.InsertMode.INSERT, mode=PETSc.ScatterMode.FORWARD)
+
+    assert np.allclose(uh.x.array, u0.x.array, rtol=1.0e-8, atol=1.0e-10)
+
+
+def test_local_solver_checks_factorisation():
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 3, 3)
+    V = dolfinx.fem.FunctionSpace(mesh, ("DG", 1))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    c = dolfinx.Constant(mesh, 0.0)
+    a = dolfinx.fem.Form(c * inner(u, v) * dx)
+    L = dolfinx.fem.Form(inner(1.0, v) * dx)
+
+    # A zero element matrix has zero pivots
+    solver = LocalSolver(a._cpp_object, L._cpp_object, LocalSolver.Type.lu)
+    with pytest.raises(RuntimeError):
+        solver.factorize()
+    uh = dolfinx.fem.Function(V)
+    with pytest.raises(RuntimeError):
+        solver.solve(uh.x)
+
+    # A negative-definite element matrix has an LU but no Cholesky
+    # factorisation
+    c.value = -1.0
+    solver.factorize()
+    solver.solve(uh.x)
+    assert np.all(uh.x.array.real < 0.0)
+    solver = LocalSolver(a._cpp_object, L._cpp_object, LocalSolver.Type.cholesky)
+    with pytest.raises(RuntimeError):
+        solver.factorize()
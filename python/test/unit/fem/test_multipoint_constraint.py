@@ -0,0 +1,189 @@
+# Copyright (C) 2021 Garth N. Wells
+#
+# This file is part of DOLFINx (https://www.fenicsproject.org)
+#
+# SPDX-License-Identifier:    LGPL-3.0-or-later
+"""Unit tests for assembly with multipoint constraints"""
+
+import dolfinx
+import numpy as np
+import pytest
+import ufl
+from dolfinx_utils.test.skips import skip_in_parallel
+from mpi4py import MPI
+from petsc4py import PETSc
+from ufl import dx, grad, inner
+
+
+@skip_in_parallel
+@pytest.mark.parametrize("degree", [1, 2])
+def test_periodic_constraint(degree):
+    """Compare assembly with a periodic constraint to the constrained
+    system computed from the unconstrained system, C^T A C and C^T b"""
+    mesh = dolfinx.generation.UnitSquareMesh(MPI.COMM_WORLD, 6, 6)
+    V = dolfinx.fem.FunctionSpace(mesh, ("Lagrange", degree))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    x = ufl.SpatialCoordinate(mesh)
+    a = dolfinx.fem.Form(inner(grad(u), grad(v)) * dx + inner(u, v) * dx)
+    L = dolfinx.fem.Form(inner(1 + x[0] * x[1], v) * dx)
+
+    # The dofs on x = 1 are slaves of the dofs on x = 0 with the same y
+    # coordinate
+    X = V.tabulate_dof_coordinates()
+    left = np.flatnonzero(np.isclose(X[:, 0], 0.0))
+    right = np.flatnonzero(np.isclose(X[:, 0], 1.0))
+    left = left[np.argsort(X[left, 1])]
+    right = right[np.argsort(X[right, 1])]
+    assert np.allclose(X[left, 1], X[right, 1])
+    mpc = dolfinx.cpp.fem.MultiPointConstraint(V._cpp_object, right.astype(np.int32), left.astype(np.int64),
+                                               np.arange(len(right) + 1, dtype=np.int32),
+                                               np.ones(len(right), dtype=PETSc.ScalarType))
+    assert mpc.num_owned_slaves == len(right)
+
+    n = V.dofmap.index_map.size_local
+    C = np.eye(n)
+    C[right, :] = 0.0
+    C[right, left] = 1.0
+
+    # Matrix
+    pattern = dolfinx.cpp.fem.create_sparsity_pattern(a._cpp_object, mpc)
+    pattern.assemble()
+    A = dolfinx.cpp.la.create_matrix(mesh.mpi_comm(), pattern)
+    dolfinx.cpp.fem.assemble_matrix_petsc(A, a._cpp_object, mpc, [], diagonal=2.0)
+    A.assemble()
+    A0 = dolfinx.fem.assemble_matrix(a)
+    A0.assemble()
+    A0 = C.T @ A0.convert("dense").getDenseArray() @ C
+    A0[right, right] = 2.0
+    assert np.allclose(A.convert("dense").getDenseArray(), A0)
+
+    # Vector
+    b = dolfinx.cpp.la.create_vector(mpc.index_map, mpc.index_map_bs)
+    with b.localForm() as b_local:
+        b_local.set(0.0)
+        dolfinx.cpp.fem.assemble_vector(b_local.array_w, L._cpp_object)
+        mpc.apply_transpose(b_local.array_w)
+    b0 = dolfinx.fem.assemble_vector(L)
+    assert np.allclose(b.array, C.T @ b0.array)
+
+    # Solution of the unconstrained system
+    x = np.random.rand(n).astype(PETSc.ScalarType)
+    x[right] = 0.0
+    mpc.backsubstitution(x)
+    assert np.allclose(x[right], x[left])
+
+
+def doubly_periodic_constraint(V):
+    """Create the constraint of the dofs on x = 1 and y = 1 to the dofs
+    on x = 0 and y = 0. The masters may be owned by any process."""
+    comm = V.mesh.mpi_comm()
+    index_map = V.dofmap.index_map
+    n = index_map.size_local
+    X = V.tabulate_dof_coordinates()[:n, :2]
+
+    # Coordinates and global indices of the candidate masters on all
+    # processes
+    is_master = np.logical_and(np.logical_or(np.isclose(X[:, 0], 0.0), np.isclose(X[:, 1], 0.0)),
+                               np.logical_not(np.logical_or(np.isclose(X[:, 0], 1.0), np.isclose(X[:, 1], 1.0))))
+    masters = np.flatnonzero(is_master)
+    X_masters = np.vstack(comm.allgather(X[masters]))
+    global_masters = np.hstack(comm.allgather(index_map.local_range[0] + masters)).astype(np.int64)
+
+    slaves = np.flatnonzero(np.logical_or(np.isclose(X[:, 0], 1.0), np.isclose(X[:, 1], 1.0))).astype(np.int32)
+    target = np.where(np.isclose(X[slaves], 1.0), 0.0, X[slaves])
+    slave_masters = np.zeros(len(slaves), dtype=np.int64)
+    for i, x in enumerate(target):
+        match = np.flatnonzero(np.isclose(X_masters, x).all(axis=1))
+        assert len(match) == 1
+        slave_masters[i] = global_masters[match[0]]
+
+    return dolfinx.cpp.fem.MultiPointConstraint(V._cpp_object, slaves, slave_masters,
+                                                np.arange(len(slaves) + 1, dtype=np.int32),
+                                                np.ones(len(slaves), dtype=PETSc.ScalarType))
+
+
+def solve_periodic(comm, degree):
+    """Solve a doubly periodic reaction-diffusion problem with a
+    multipoint constraint. Returns the constraint and integrals of the
+    solution."""
+    mesh = dolfinx.generation.UnitSquareMesh(comm, 8, 8)
+    V = dolfinx.fem.FunctionSpace(mesh, ("Lagrange", degree))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    x = ufl.SpatialCoordinate(mesh)
+    a = dolfinx.fem.Form(inner(grad(u), grad(v)) * dx + inner(u, v) * dx)
+    L = dolfinx.fem.Form(inner(1 + x[0] * x[1], v) * dx)
+    mpc = doubly_periodic_constraint(V)
+
+    pattern = dolfinx.cpp.fem.create_sparsity_pattern(a._cpp_object, mpc)
+    pattern.assemble()
+    A = dolfinx.cpp.la.create_matrix(comm, pattern)
+    dolfinx.cpp.fem.assemble_matrix_petsc(A, a._cpp_object, mpc, [], diagonal=1.0)
+    A.assemble()
+
+    b = dolfinx.cpp.la.create_vector(mpc.index_map, mpc.index_map_bs)
+    with b.localForm() as b_local:
+        b_local.set(0.0)
+        dolfinx.cpp.fem.assemble_vector(b_local.array_w, L._cpp_object)
+        mpc.apply_transpose(b_local.array_w)
+    b.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+
+    ksp = PETSc.KSP().create(comm)
+    ksp.setOperators(A)
+    ksp.setType("cg")
+    ksp.getPC().setType("jacobi")
+    ksp.setTolerances(rtol=1.0e-12)
+    xc = dolfinx.cpp.la.create_vector(mpc.index_map, mpc.index_map_bs)
+    ksp.solve(b, xc)
+    assert ksp.getConvergedReason() > 0
+    xc.ghostUpdate(addv=PETSc.InsertMode.INSERT, mode=PETSc.ScatterMode.FORWARD)
+
+    uh = dolfinx.fem.Function(V)
+    with xc.localForm() as x_local:
+        mpc.backsubstitution(x_local.array_w)
+        uh.x.array[:] = x_local.array_r[:len(uh.x.array)]
+
+    def integrate(f):
+        return comm.allreduce(dolfinx.fem.assemble_scalar(f * dx), op=MPI.SUM)
+
+    # The values of the owned slaves equal the values at their periodic
+    # images, which may be owned by other processes
+    n = V.dofmap.index_map.size_local
+    X = V.tabulate_dof_coordinates()[:n, :2]
+    X_all = np.vstack(comm.allgather(X))
+    values_all = np.hstack(comm.allgather(uh.x.array[:n]))
+    slaves = mpc.slaves[:mpc.num_owned_slaves]
+    for s, y in zip(slaves, np.where(np.isclose(X[slaves], 1.0), 0.0, X[slaves])):
+        match = np.flatnonzero(np.isclose(X_all, y).all(axis=1))
+        assert np.isclose(uh.x.array[s], values_all[match[0]])
+
+    return mpc, np.array([integrate(uh), integrate(uh * uh), integrate(x[0] * x[1] * uh)])
+
+
+@pytest.mark.parametrize("degree", [1, 2])
+def test_periodic_constraint_parallel(degree):
+    """Compare the solution of a periodic problem with a multipoint
+    constraint in parallel with the solution in serial"""
+    comm = MPI.COMM_WORLD
+    mpc, values = solve_periodic(comm, degree)
+    _, values0 = solve_periodic(MPI.COMM_SELF, degree)
+    assert np.allclose(values, values0, rtol=1.0e-8)
+
+    # In parallel, the constraints of slaves that are ghosts are sent to
+    # the ghosting processes, and masters that are not on a process are
+    # ghosts of the extended index map
+    if comm.size > 1:
+        V = mpc.function_space
+        num_ghost_slaves = len(mpc.slaves) - mpc.num_owned_slaves
+        num_new_ghosts = mpc.index_map.num_ghosts - V.dofmap.index_map.num_ghosts
+        assert comm.allreduce(num_ghost_slaves, op=MPI.SUM) > 0
+        assert comm.allreduce(num_new_ghosts, op=MPI.SUM) > 0
+
+
+def test_constraint_slaves_must_be_owned():
+    mesh = dolfinx.generation.UnitSquareMesh(MPI.COMM_WORLD, 4, 4)
+    V = dolfinx.fem.FunctionSpace(mesh, ("Lagrange", 1))
+    n = V.dofmap.index_map.size_local
+    with pytest.raises(RuntimeError):
+        dolfinx.cpp.fem.MultiPointConstraint(V._cpp_object, np.array([n], dtype=np.int32),
+                                             np.array([0], dtype=np.int64), np.array([0, 1], dtype=np.int32),
+                                             np.ones(1, dtype=PETSc.ScalarType))
@@ -0,0 +1,67 @@
+# Copyright (C) 2021 Garth N. Wells
+#
+# This file is part of DOLFINx (https://www.fenicsproject.org)
+#
+# SPDX-License-Identifier:    LGPL-3.0-or-later
+"""Unit tests for the storage of state at quadrature points"""
+
+import dolfinx
+import numpy as np
+import ufl
+from mpi4py import MPI
+
+
+def test_quadrature_data():
+    mesh = dolfinx.generation.UnitSquareMesh(MPI.COMM_WORLD, 4, 4)
+    Q = dolfinx.fem.FunctionSpace(mesh, ufl.FiniteElement("Quadrature", mesh.ufl_cell(), 2, quad_scheme="default"))
+    V = dolfinx.fem.FunctionSpace(mesh, ("Lagrange", 1))
+    q, f = dolfinx.fem.Function(Q), dolfinx.fem.Function(V)
+    q.x.array[:] = np.arange(len(q.x.array))
+    f.interpolate(lambda x: 1.0 + x[0])
+    v = ufl.TestFunction(V)
+    L = dolfinx.fem.Form(q * f * v * ufl.dx(metadata={"quadrature_degree": 2}))
+    index = next(i for i, c in enumerate(L._cpp_object.coefficients) if c is q._cpp_object)
+
+    # The first update packs all coefficients and initialises the state
+    data = dolfinx.cpp.fem.QuadratureData(L._cpp_object, index)
+    c0 = dolfinx.cpp.fem.pack_coefficients(L._cpp_object)
+    assert np.allclose(data.update(), c0)
+    state = slice(data.offset, data.offset + data.size)
+    assert data.size > 0
+    others = np.ones(c0.shape[1], dtype=bool)
+    others[state] = False
+
+    # The state is modified in place and is not re-packed from its
+    # coefficient
+    data.state(0)[:] = 7.0
+    q.x.array[:] = -1.0
+    c = data.update().copy()
+    assert np.allclose(c[0, state], 7.0)
+    assert np.allclose(c[1:, state], c0[1:, state])
+
+    # Commit and revert
+    data.commit()
+    assert np.allclose(data.previous(0), 7.0)
+    data.state(0)[:] = 9.0
+    assert np.allclose(data.previous(0), 7.0)
+    data.revert()
+    assert np.allclose(data.state(0), 7.0)
+
+    # Update the state on all cells from the coefficient data
+    def double(cell, s, w):
+        s[:] = 2.0 * w[state]
+
+    data.update_state(double)
+    c1 = data.update().copy()
+    assert np.allclose(c1[0, state], 14.0)
+    assert np.allclose(c1[1:, state], 2.0 * c0[1:, state])
+    data.revert()
+    assert np.allclose(data.update()[:, state], c[:, state])
+
+    # Modified coefficients, other than the state, are re-packed
+    f.x.array[:] = 3.0
+    c2 = data.update()
+    c3 = dolfinx.cpp.fem.pack_coefficients(L._cpp_object)
+    assert np.allclose(c2[:, others], c3[:, others])
+    assert not np.allclose(c2[:, others], c0[:, others])
+    assert np.allclose(c2[:, state], c[:, state])
@@ -0,0 +1,85 @@
+# Copyright (C) 2021 Garth N. Wells
+#
+# This file is part of DOLFINx (https://www.fenicsproject.org)
+#
+# SPDX-License-Identifier:    LGPL-3.0-or-later
+"""Unit tests for static condensation of cell-interior dofs"""
+
+import dolfinx
+import numpy as np
+import pytest
+import ufl
+from dolfinx import cpp
+from dolfinx.cpp.fem import StaticCondensation
+from dolfinx.cpp.mesh import CellType
+from dolfinx.generation import UnitSquareMesh
+from mpi4py import MPI
+from petsc4py import PETSc
+from ufl import dx, grad, inner
+
+
+def create_solver(comm, A):
+    ksp = PETSc.KSP().create(comm)
+    ksp.setOperators(A)
+    ksp.setType("cg")
+    ksp.getPC().setType("jacobi")
+    ksp.setTolerances(rtol=1.0e-14)
+    return ksp
+
+
+@pytest.mark.parametrize("cell_type", [CellType.triangle, CellType.quadrilateral])
+@pytest.mark.parametrize("degree", [3, 4])
+def test_static_condensation_poisson(cell_type, degree):
+    """Compare the solution of a Poisson problem computed with the
+    interior dofs condensed with the solution of the full system"""
+    comm = MPI.COMM_WORLD
+    mesh = UnitSquareMesh(comm, 6, 5, cell_type)
+    V = dolfinx.fem.FunctionSpace(mesh, ("Lagrange", degree))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    x = ufl.SpatialCoordinate(mesh)
+    f = ufl.sin(3 * x[0]) * ufl.exp(x[1])
+    a = dolfinx.fem.Form(inner(grad(u), grad(v)) * dx)
+    L = dolfinx.fem.Form(inner(f, v) * dx)
+
+    u_bc = dolfinx.fem.Function(V)
+    u_bc.interpolate(lambda x: 1.0 + x[0] * x[1])
+    dofs = dolfinx.fem.locate_dofs_geometrical(V, lambda x: np.logical_or(np.isclose(x[0], 0.0),
+                                                                         np.isclose(x[1], 1.0)))
+    bc = dolfinx.fem.dirichletbc.DirichletBC(u_bc, dofs)
+
+    # Full system
+    A = dolfinx.fem.assemble_matrix(a, [bc])
+    A.assemble()
+    b = dolfinx.fem.assemble_vector(L)
+    dolfinx.fem.apply_lifting(b, [a], [[bc]])
+    b.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+    dolfinx.fem.set_bc(b, [bc])
+    u0 = dolfinx.fem.Function(V)
+    create_solver(comm, A).solve(b, u0.vector)
+    u0.vector.ghostUpdate(addv=PETSc.InsertMode.INSERT, mode=PETSc.ScatterMode.FORWARD)
+
+    # Condensed system
+    sc = StaticCondensation(a._cpp_object, L._cpp_object)
+    index_map = sc.dofmap.index_map
+    bs = sc.dofmap.index_map_bs
+    assert index_map.size_global < V.dofmap.index_map.size_global
+    pattern = sc.create_sparsity_pattern()
+    pattern.assemble()
+    Ac = cpp.la.create_matrix(comm, pattern)
+    b_c = cpp.la.create_vector(index_map, bs)
+    with b_c.localForm() as b_local:
+        b_local.set(0.0)
+        sc.assemble(Ac, b_local.array_w, [bc])
+    Ac.assemble()
+    b_c.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+    x_c = b_c.duplicate()
+    create_solver(comm, Ac).solve(b_c, x_c)
+    x_c.ghostUpdate(addv=PETSc.InsertMode.INSERT, mode=PETSc.ScatterMode.FORWARD)
+
+    uh = dolfinx.fem.Function(V)
+    with x_c.localForm() as x_local:
+        sc.recover(x_local.array_r, uh.x.array)
+    uh.x.scatter_forward()
+
+    assert np.allclose(uh.x.array, u0.x.array, rtol=1.0e-8, atol=1.0e-10)
+
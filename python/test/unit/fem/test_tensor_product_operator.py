@@ -0,0 +1,55 @@
+# Copyright (C) 2021 Garth N. Wells
+#
+# This file is part of DOLFINx (https://www.fenicsproject.org)
+#
+# SPDX-License-Identifier:    LGPL-3.0-or-later
+"""Unit tests for the sum-factorised operator action"""
+
+import dolfinx
+import numpy as np
+import pytest
+import ufl
+from dolfinx.cpp.fem import TensorProductOperator
+from dolfinx.cpp.mesh import CellType
+from dolfinx.generation import UnitCubeMesh, UnitSquareMesh
+from mpi4py import MPI
+from ufl import dx, grad, inner
+
+
+@pytest.mark.parametrize("cell_type", [CellType.quadrilateral, CellType.hexahedron])
+@pytest.mark.parametrize("degree", [1, 4])
+@pytest.mark.parametrize("with_bc", [False, True])
+def test_tensor_product_operator(cell_type, degree, with_bc):
+    """Compare the sum-factorised action with the product of the
+    assembled matrix and a random vector"""
+    if cell_type == CellType.quadrilateral:
+        mesh = UnitSquareMesh(MPI.COMM_WORLD, 7, 5, cell_type)
+    else:
+        mesh = UnitCubeMesh(MPI.COMM_WORLD, 3, 2, 2, cell_type)
+    V = dolfinx.fem.FunctionSpace(mesh, ("Lagrange", degree))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    kappa, sigma = 2.0, 0.5
+    a = dolfinx.fem.Form(kappa * inner(grad(u), grad(v)) * dx + sigma * inner(u, v) * dx)
+
+    bcs = []
+    if with_bc:
+        u_bc = dolfinx.fem.Function(V)
+        dofs = dolfinx.fem.locate_dofs_geometrical(V, lambda x: np.isclose(x[0], 0.0))
+        bcs = [dolfinx.fem.dirichletbc.DirichletBC(u_bc, dofs)]
+
+    A = dolfinx.fem.assemble_matrix(a, bcs)
+    A.assemble()
+    op = TensorProductOperator(V._cpp_object, kappa, sigma, bcs)
+
+    # Random owned values; the operator updates the ghosts
+    size_local = V.dofmap.index_map.size_local
+    x = dolfinx.fem.Function(V)
+    rng = np.random.default_rng(MPI.COMM_WORLD.rank)
+    x.x.array[:size_local] = rng.random(size_local)
+    x.x.array[size_local:] = 0.0
+    y = dolfinx.fem.Function(V)
+    op.apply(x.x, y.x)
+
+    y0 = A.createVecLeft()
+    A.mult(x.vector, y0)
+    assert np.allclose(y.x.array[:size_local], y0.array, rtol=1.0e-10, atol=1.0e-12)
@@ -262,3 +262,32 @@ def test_assembly_into_quadrature_function():
             e_exact_eval[Q_dofs_unrolled[cell]] = e_exact(x.T).T.flatten()
 
         assert np.allclose(local.array, e_exact_eval)
+
+
+def test_threaded_and_chunked_evaluation():
+    """Test that threaded and chunked evaluation of an Expression give
+    the same values as serial evaluation"""
+    mesh = dolfinx.generation.UnitSquareMesh(MPI.COMM_WORLD, 6, 5)
+    P2 = dolfinx.FunctionSpace(mesh, ("P", 2))
+    u = dolfinx.Function(P2)
+    u.interpolate(lambda x: x[0] ** 2 + 2.0 * x[1] ** 2)
+
+    points = np.array([[0.0, 0.0], [1.0, 0.0], [0.0, 1.0], [1 / 3, 1 / 3]])
+    expr = dolfinx.Expression(dolfinx.Constant(mesh, 2.0) * ufl.grad(u), points)
+
+    map_c = mesh.topology.index_map(mesh.topology.dim)
+    num_cells = map_c.size_local + map_c.num_ghosts
+    cells = np.arange(num_cells, dtype=np.int32)[::-1].copy()
+    values = expr.eval(cells)
+    assert np.allclose(expr.eval(cells, num_threads=3), values)
+
+    # The chunks cover the cells in order
+    chunks = []
+
+    def f(chunk_cells, chunk_values):
+        assert chunk_values.shape == (len(chunk_cells), expr.num_points * expr.value_size)
+        chunks.append((chunk_cells.copy(), chunk_values.copy()))
+    expr.eval_chunked(cells, f, 7, num_threads=2)
+    assert len(chunks) == (num_cells + 6) // 7
+    assert np.array_equal(np.concatenate([c[0] for c in chunks]), cells)
+    assert np.allclose(np.concatenate([c[1] for c in chunks]), values)
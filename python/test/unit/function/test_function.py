@@ -14,6 +14,7 @@ import pytest
 import ufl
 from dolfinx import (Function, FunctionSpace, TensorFunctionSpace,
                      UnitCubeMesh, VectorFunctionSpace, geometry)
+from dolfinx.cpp.mesh import CellType
 from dolfinx.mesh import create_mesh
 from dolfinx_utils.test.skips import skip_if_complex, skip_in_parallel
 from mpi4py import MPI
@@ -166,6 +167,46 @@ def test_eval_multiple(W):
     u.eval(x[0], cell)
 
 
+def test_eval_point_ownership(W):
+    mesh = W.mesh
+
+    # Each rank passes different points, and the last point is outside
+    # the mesh
+    comm = mesh.mpi_comm()
+    x = np.random.RandomState(comm.rank).rand(10, 3)
+    x[-1] = [2.0, 0.5, 0.5]
+    points = geometry.PointOwnership(mesh, x)
+    assert np.all(points.owners[:-1] >= 0) and points.owners[-1] == -1
+    assert comm.allreduce(len(points.owned_cells), op=MPI.SUM) == 9 * comm.size
+
+    # The points can be reused for several functions
+    u = Function(W)
+    for a in [1.0, 2.0]:
+        u.interpolate(lambda x: np.vstack((a * x[0], 2 * x[1], x[0] + x[2])))
+        values = np.empty((len(x), 3), dtype=PETSc.ScalarType)
+        u._cpp_object.eval(points, values)
+        x_exact = np.vstack((a * x[:, 0], 2 * x[:, 1], x[:, 0] + x[:, 2])).T
+        x_exact[-1] = 0.0
+        assert np.allclose(values, x_exact)
+
+
+@pytest.mark.parametrize("cell_type", [CellType.tetrahedron, CellType.hexahedron])
+def test_eval_grouped_points(cell_type):
+    """Evaluate at many points with several points in each cell, passed
+    in random order"""
+    mesh = UnitCubeMesh(MPI.COMM_WORLD, 3, 2, 2, cell_type)
+    V = FunctionSpace(mesh, ("Lagrange", 2))
+    u = Function(V)
+    u.interpolate(lambda x: x[0]**2 + x[1] * x[2])
+
+    comm = mesh.mpi_comm()
+    x = np.random.RandomState(comm.rank).rand(200, 3)
+    points = geometry.PointOwnership(mesh, x)
+    values = np.empty((len(x), 1), dtype=PETSc.ScalarType)
+    u._cpp_object.eval(points, values)
+    assert np.allclose(values[:, 0], x[:, 0]**2 + x[:, 1] * x[:, 2])
+
+
 @skip_in_parallel
 def test_eval_manifold():
     # Simple two-triangle surface in 3d
@@ -295,3 +336,64 @@ def test_interpolation_function(mesh):
     uh = Function(Vh)
     uh.interpolate(u)
     assert np.allclose(uh.vector.array, 1)
+
+
+def test_interpolation_nonmatching_mesh():
+    mesh0 = UnitCubeMesh(MPI.COMM_WORLD, 3, 3, 3)
+    mesh1 = UnitCubeMesh(MPI.COMM_WORLD, 4, 5, 2)
+    V0 = VectorFunctionSpace(mesh0, ('Lagrange', 1))
+    V1 = VectorFunctionSpace(mesh1, ('Lagrange', 2))
+    v = Function(V0)
+    u = Function(V1)
+    u_exact = Function(V1)
+
+    # A linear function is reproduced exactly, and the plan can be
+    # reused for several functions
+    plan = dolfinx.cpp.fem.InterpolationPlan(V1._cpp_object, mesh0)
+    for a in [1.0, 2.0]:
+        def f(x):
+            return np.vstack((a * x[0], 2 * x[1], x[0] + x[2]))
+        v.interpolate(f)
+        u_exact.interpolate(f)
+        plan.interpolate(u._cpp_object, v._cpp_object)
+        assert np.allclose(u.vector.array, u_exact.vector.array)
+
+    # Function.interpolate creates a plan for non-matching meshes
+    u.vector.set(0.0)
+    u.interpolate(v)
+    assert np.allclose(u.vector.array, u_exact.vector.array)
+
+    # The plan can only be applied to the spaces it was created for
+    with pytest.raises(RuntimeError):
+        plan.interpolate(v._cpp_object, u._cpp_object)
+
+
+@pytest.mark.parametrize("degrees", [(1, 2), (2, 1), (3, 2)])
+def test_interpolation_operator(degrees):
+    mesh = UnitCubeMesh(MPI.COMM_WORLD, 3, 2, 4)
+    V0 = VectorFunctionSpace(mesh, ('Lagrange', degrees[0]))
+    V1 = VectorFunctionSpace(mesh, ('Lagrange', degrees[1]))
+    v = Function(V1)
+    u = Function(V0)
+    u_exact = Function(V0)
+
+    # A linear function is reproduced exactly, and the operator can be
+    # reused for several functions
+    op = dolfinx.cpp.fem.InterpolationOperator(V0._cpp_object, V1._cpp_object)
+    for a in [1.0, 2.0]:
+        def f(x):
+            return np.vstack((a * x[0], 2 * x[1], x[0] + a * x[2]))
+        v.interpolate(f)
+        u_exact.interpolate(f)
+        op.interpolate(u._cpp_object, v._cpp_object)
+        assert np.allclose(u.vector.array, u_exact.vector.array)
+
+    # Function.interpolate uses the operator for different elements on
+    # the same mesh
+    w = Function(V0)
+    w.interpolate(v)
+    assert np.allclose(w.vector.array, u.vector.array)
+
+    # The operator can only be applied to the spaces it was created for
+    with pytest.raises(RuntimeError):
+        op.interpolate(v._cpp_object, u._cpp_object)
@@ -167,6 +167,29 @@ def test_collapse(W, V):
     assert f0.vector.getSize() == f1.vector.getSize()
 
 
+def test_collapse_mixed(Q):
+    Vs = Q.sub(0)
+    Vc, dofmap_new_old = Vs.collapse(True)
+
+    # The collapsed sub-space of the mixed space keeps the block
+    # structure of the vector element
+    assert Vc.dofmap.bs == 3
+    assert Vc.dofmap.index_map_bs == 3
+    assert 4 * Vc.dofmap.index_map.size_global == Vs.dofmap.index_map.size_global
+    assert len(dofmap_new_old) == 3 * (Vc.dofmap.index_map.size_local + Vc.dofmap.index_map.num_ghosts)
+    for c in range(Q.mesh.topology.index_map(3).size_local):
+        dofs_c = Vc.dofmap.cell_dofs(c)
+        dofs_s = Vs.dofmap.cell_dofs(c)
+        for i, dof in enumerate(dofs_c):
+            for k in range(3):
+                assert dofmap_new_old[3 * dof + k] == dofs_s[3 * i + k]
+
+    # Repeated collapse returns the cached space and map
+    Vc1, dofmap_new_old1 = Vs.collapse(True)
+    assert Vc1._cpp_object is Vc._cpp_object
+    assert dofmap_new_old1 == dofmap_new_old
+
+
 def test_argument_equality(mesh, V, V2, W, W2):
     """Placed this test here because it's mainly about detecting differing
     function spaces.
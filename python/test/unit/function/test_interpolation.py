@@ -12,6 +12,7 @@ import pytest
 import ufl
 from dolfinx import Function, FunctionSpace, VectorFunctionSpace, cpp
 from dolfinx.cpp.mesh import CellType
+from dolfinx.generation import UnitSquareMesh
 from dolfinx.mesh import create_mesh
 from dolfinx_utils.test.skips import skip_in_parallel
 from mpi4py import MPI
@@ -221,3 +222,38 @@ def test_mixed_interpolation():
     v = Function(FunctionSpace(mesh, ufl.MixedElement([A, B])))
     with pytest.raises(RuntimeError):
         v.interpolate(lambda x: (x[1], 2 * x[0], 3 * x[1]))
+
+
+@pytest.mark.parametrize("element", [("Lagrange", 2), ("N1curl", 1)])
+def test_interpolation_cell_subset_chunks(element):
+    """Test interpolation on a subset of cells processed in chunks"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 6, 5)
+    V = FunctionSpace(mesh, element)
+    if element[0] == "Lagrange":
+        def f(x):
+            return 1.0 + x[0] + 2 * x[1]**2
+    else:
+        def f(x):
+            return np.vstack((1.0 + x[1], 2.0 - x[0]))
+
+    # Interpolating on all cells in chunks is the same as interpolating
+    # on all cells at once
+    u0, u1 = Function(V), Function(V)
+    u0.interpolate(f)
+    u1.interpolate(f, chunk_size=7)
+    assert np.allclose(u0.x.array, u1.x.array)
+
+    # Interpolating on a subset of cells only sets the dofs of the cells
+    # in the subset
+    tdim = mesh.topology.dim
+    num_cells = mesh.topology.index_map(tdim).size_local + mesh.topology.index_map(tdim).num_ghosts
+    cells = np.arange(0, num_cells, 3, dtype=np.int32)
+    u2 = Function(V)
+    u2.interpolate(f, cells=cells, chunk_size=4)
+    dofs = np.unique(np.hstack([V.dofmap.cell_dofs(c) for c in cells]))
+    bs = V.dofmap.index_map_bs
+    dofs = (bs * np.repeat(dofs, bs) + np.tile(np.arange(bs), len(dofs))).astype(np.int32)
+    assert np.allclose(u2.x.array[dofs], u0.x.array[dofs])
+    mask = np.ones(len(u2.x.array), dtype=bool)
+    mask[dofs] = False
+    assert np.allclose(u2.x.array[mask], 0.0)
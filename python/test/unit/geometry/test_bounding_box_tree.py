@@ -7,11 +7,12 @@
 
 import numpy
 import pytest
-from dolfinx import (BoxMesh, UnitCubeMesh, UnitIntervalMesh, UnitSquareMesh,
-                     cpp)
-from dolfinx.geometry import (BoundingBoxTree, compute_closest_entity,
-                              compute_collisions, compute_collisions_point,
-                              create_midpoint_tree, select_colliding_cells,
+from dolfinx import (BoxMesh, RectangleMesh, UnitCubeMesh, UnitIntervalMesh,
+                     UnitSquareMesh, cpp)
+from dolfinx.geometry import (BoundingBoxTree, BuildStrategy, compute_closest_entities, compute_closest_entity,
+                              compute_colliding_cells, compute_collisions, compute_collisions_point,
+                              compute_distributed_collisions,
+                              create_midpoint_tree, locate_cells, select_colliding_cells,
                               compute_distance_gjk)
 from dolfinx.mesh import locate_entities, locate_entities_boundary
 from dolfinx_utils.test.skips import skip_in_parallel
@@ -132,6 +133,74 @@ def test_empty_tree():
     assert bbtree.num_bboxes == 0
 
 
+@pytest.mark.parametrize("strategy", [BuildStrategy.median, BuildStrategy.sah])
+@pytest.mark.parametrize("num_threads", [1, 4])
+def test_build_strategy(strategy, num_threads):
+    mesh = UnitCubeMesh(MPI.COMM_WORLD, 12, 8, 6)
+    tdim = mesh.topology.dim
+    tree = BoundingBoxTree(mesh, tdim)
+    tree_s = BoundingBoxTree(mesh, tdim, strategy=strategy, num_threads=num_threads)
+    assert tree_s.num_bboxes == tree.num_bboxes
+    assert numpy.allclose(tree_s.get_bbox(tree_s.num_bboxes - 1), tree.get_bbox(tree.num_bboxes - 1))
+
+    points = numpy.random.RandomState(1).rand(20, 3)
+    for p in points:
+        cells = numpy.sort(compute_collisions_point(tree, p))
+        cells_s = numpy.sort(compute_collisions_point(tree_s, p))
+        assert numpy.array_equal(cells, cells_s)
+
+
+def test_refit():
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 8, 6)
+    tdim = mesh.topology.dim
+    tree = BoundingBoxTree(mesh, tdim, padding=0.01)
+
+    # A translation does not change the quality of the tree
+    mesh.geometry.x[:, 0] += 0.5
+    assert not tree.refit(mesh, max_cost_ratio=1.1)
+    tree_new = BoundingBoxTree(mesh, tdim, padding=0.01)
+    assert tree.num_bboxes == tree_new.num_bboxes
+    assert numpy.allclose(tree.get_bbox(tree.num_bboxes - 1), tree_new.get_bbox(tree_new.num_bboxes - 1))
+    for p in numpy.random.RandomState(3).rand(20, 3) + [0.5, 0.0, 0.0]:
+        p[2] = 0.0
+        cells = numpy.sort(compute_collisions_point(tree, p))
+        assert numpy.array_equal(cells, numpy.sort(compute_collisions_point(tree_new, p)))
+
+    # Shuffling the vertices decreases the quality and triggers a rebuild
+    x = mesh.geometry.x
+    x[:] = x[numpy.random.RandomState(4).permutation(x.shape[0])]
+    assert tree.refit(mesh, max_cost_ratio=1.1)
+    p = mesh.geometry.x[0]
+    cells = numpy.sort(compute_collisions_point(tree, p))
+    assert numpy.array_equal(cells, numpy.sort(compute_collisions_point(BoundingBoxTree(mesh, tdim, padding=0.01), p)))
+
+    with pytest.raises(RuntimeError):
+        create_midpoint_tree(mesh, tdim, numpy.arange(2, dtype=numpy.int32)).refit(mesh)
+
+
+@pytest.mark.parametrize("num_threads", [1, 3])
+def test_compute_collisions_points(num_threads):
+    mesh = UnitCubeMesh(MPI.COMM_WORLD, 5, 4, 3)
+    tree = BoundingBoxTree(mesh, mesh.topology.dim)
+    points = numpy.random.RandomState(2).rand(50, 3)
+    points[0] = [0.2, 0.25, 1.0 / 3.0]
+
+    candidates = compute_collisions(tree, points, num_threads=num_threads)
+    cells = select_colliding_cells(mesh, candidates, points, 0, num_threads=num_threads)
+    cells_1 = compute_colliding_cells(mesh, tree, points, 1, num_threads=num_threads)
+    assert candidates.num_nodes == cells.num_nodes == cells_1.num_nodes == len(points)
+    for i, p in enumerate(points):
+        p_candidates = compute_collisions_point(tree, p)
+        assert numpy.array_equal(candidates.links(i), p_candidates)
+        p_cells = select_colliding_cells(mesh, p_candidates, p, len(p_candidates))
+        assert numpy.array_equal(cells.links(i), p_cells)
+        assert numpy.array_equal(cells_1.links(i), p_cells[:1])
+
+    all_cells = compute_colliding_cells(mesh, tree, points)
+    assert numpy.array_equal(all_cells.array, cells.array)
+    assert numpy.array_equal(all_cells.offsets, cells.offsets)
+
+
 @skip_in_parallel
 def test_compute_collisions_point_1d():
     N = 16
@@ -242,6 +311,61 @@ def test_compute_collisions_tree_3d(point):
     assert numpy.allclose(entities_B, cells_B)
 
 
+@pytest.mark.parametrize("num_threads", [1, 3])
+def test_compute_distributed_collisions(num_threads):
+    mesh0 = UnitSquareMesh(MPI.COMM_WORLD, 5, 4)
+    mesh1 = RectangleMesh(MPI.COMM_WORLD, [numpy.array([0.5, 0.1, 0]), numpy.array([1.5, 0.6, 0])], [3, 2],
+                          cpp.mesh.CellType.triangle)
+    tdim = mesh0.topology.dim
+    tree0 = BoundingBoxTree(mesh0, tdim)
+    tree1 = BoundingBoxTree(mesh1, tdim)
+    exact = compute_distributed_collisions(mesh0, tree0, mesh1, tree1, num_threads=num_threads)
+    candidates = compute_distributed_collisions(mesh0, tree0, mesh1, tree1, exact=False, num_threads=num_threads)
+
+    map0 = mesh0.topology.index_map(tdim)
+    assert exact.num_nodes == candidates.num_nodes == map0.size_local + map0.num_ghosts
+    x = mesh0.geometry.x
+    dofs = mesh0.geometry.dofmap
+    for c in range(exact.num_nodes):
+        assert numpy.all(numpy.isin(exact.links(c), candidates.links(c)))
+
+        # Cells strictly inside or outside the second mesh
+        xc = x[dofs.links(c)]
+        if numpy.all(xc[:, 0] > 0.5) and numpy.all(xc[:, 1] > 0.1) and numpy.all(xc[:, 1] < 0.6):
+            assert len(exact.links(c)) > 0
+        if numpy.all(xc[:, 0] < 0.5) or numpy.all(xc[:, 1] < 0.1) or numpy.all(xc[:, 1] > 0.6):
+            assert len(candidates.links(c)) == 0
+
+    # Compare with the collisions of the local trees in serial
+    if MPI.COMM_WORLD.size == 1:
+        pairs = compute_collisions(tree0, tree1)
+        for c in range(candidates.num_nodes):
+            assert numpy.array_equal(candidates.links(c), numpy.unique([p[1] for p in pairs if p[0] == c]))
+
+
+@pytest.mark.parametrize("cell_type", [cpp.mesh.CellType.tetrahedron, cpp.mesh.CellType.hexahedron])
+@pytest.mark.parametrize("num_threads", [1, 3])
+def test_locate_cells(cell_type, num_threads):
+    mesh = UnitCubeMesh(MPI.COMM_WORLD, 4, 5, 3, cell_type=cell_type)
+    tree = BoundingBoxTree(mesh, mesh.topology.dim)
+    points = numpy.random.RandomState(5).rand(40, 3)
+    points[-1] = [1.5, 0.5, 0.5]
+
+    # Move the points in steps, starting each walk from the previous cell
+    cells = locate_cells(mesh, tree, points, numpy.full(len(points), -1, dtype=numpy.int32),
+                         num_threads=num_threads)
+    for step in range(4):
+        points[:-1] = numpy.clip(points[:-1] + 0.07 * numpy.sin(points[:-1] * (step + 3)), 0, 1)
+        cells = locate_cells(mesh, tree, points, cells, num_threads=num_threads)
+        found = compute_colliding_cells(mesh, tree, points, 0)
+        assert cells[-1] == -1
+        for i, p in enumerate(points[:-1]):
+            if len(found.links(i)) == 0:
+                assert cells[i] == -1
+            else:
+                assert cells[i] in found.links(i)
+
+
 @pytest.mark.parametrize("dim", [0, 1])
 def test_compute_closest_entity_1d(dim):
     ref_distance = 0.75
@@ -347,6 +471,29 @@ def test_compute_closest_sub_entity(dim):
         assert numpy.isin(entity, entities)
 
 
+@pytest.mark.parametrize("dim", [0, 2, 3])
+@pytest.mark.parametrize("num_threads", [1, 3])
+def test_compute_closest_entities(dim, num_threads):
+    mesh = UnitCubeMesh(MPI.COMM_WORLD, 4, 3, 5)
+    mesh.topology.create_entities(dim)
+    tree = BoundingBoxTree(mesh, dim)
+    points = numpy.random.RandomState(4).rand(20, 3) * 1.5 - 0.25
+
+    k = 3
+    entities, distances = compute_closest_entities(tree, points, mesh, k=k, num_threads=num_threads)
+    assert entities.shape == distances.shape == (len(points), k)
+    num_entities = mesh.topology.index_map(dim).size_local + mesh.topology.index_map(dim).num_ghosts
+    for i, p in enumerate(points):
+        # Compare with the distances to all entities
+        d = numpy.sqrt([cpp.geometry.squared_distance(mesh, dim, e, p) for e in range(num_entities)])
+        assert numpy.allclose(distances[i], numpy.sort(d)[:k], rtol=1.0e-12, atol=1.0e-14)
+        assert numpy.allclose(d[entities[i]], distances[i], rtol=1.0e-12, atol=1.0e-14)
+
+        # The closest entity has the distance of compute_closest_entity
+        _, distance = compute_closest_entity(tree, p, mesh)
+        assert distances[i, 0] == pytest.approx(distance, 1.0e-12)
+
+
 @pytest.mark.parametrize("N", [1, 30])
 def test_midpoint_tree(N):
     """
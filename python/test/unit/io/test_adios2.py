@@ -0,0 +1,40 @@
+# Copyright (C) 2021 Garth N. Wells
+#
+# This file is part of DOLFINx (https://www.fenicsproject.org)
+#
+# SPDX-License-Identifier:    LGPL-3.0-or-later
+
+import os
+
+import pytest
+from dolfinx import (Function, FunctionSpace, UnitSquareMesh,
+                     VectorFunctionSpace, has_adios2)
+from dolfinx_utils.test.fixtures import tempdir
+from mpi4py import MPI
+
+assert (tempdir)
+
+pytestmark = pytest.mark.skipif(not has_adios2, reason="DOLFINx not compiled with ADIOS2")
+
+
+@pytest.mark.parametrize("engine", ["BP4"])
+def test_write_mesh_and_functions(tempdir, engine):
+    from dolfinx.io import ADIOS2Writer
+
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 8, 8)
+    u = Function(FunctionSpace(mesh, ("Lagrange", 2)))
+    u.name = "u"
+    v = Function(VectorFunctionSpace(mesh, ("Lagrange", 1)))
+    v.name = "v"
+
+    filename = os.path.join(tempdir, "output.bp")
+    with ADIOS2Writer(mesh.mpi_comm(), filename, engine) as writer:
+        writer.write_mesh(mesh)
+        for t in [0.0, 0.5, 1.0]:
+            u.vector.set(t)
+            v.vector.set(2 * t)
+            writer.write_function(u, t)
+            writer.write_function(v, t)
+
+    mesh.mpi_comm().Barrier()
+    assert os.path.exists(filename)
@@ -0,0 +1,94 @@
+# Copyright (C) 2021 Garth N. Wells
+#
+# This file is part of DOLFINx (https://www.fenicsproject.org)
+#
+# SPDX-License-Identifier:    LGPL-3.0-or-later
+
+import os
+
+import numpy as np
+import pytest
+import ufl
+from dolfinx import UnitCubeMesh, UnitSquareMesh
+from dolfinx.cpp.mesh import CellType
+from dolfinx.io import read_mesh_cache, write_mesh_cache
+from dolfinx.mesh import create_mesh
+from dolfinx_utils.test.fixtures import tempdir
+from mpi4py import MPI
+
+assert (tempdir)
+
+
+@pytest.mark.parametrize("cell_type", [CellType.triangle, CellType.quadrilateral])
+def test_read_write_2d(tempdir, cell_type):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 8, 7, cell_type)
+    mesh.topology.create_connectivity(1, 2)
+    filename = os.path.join(tempdir, "mesh_cache_2d.bin")
+    write_mesh_cache(mesh, filename)
+
+    mesh_in = read_mesh_cache(MPI.COMM_WORLD, filename)
+    assert mesh_in.name == mesh.name
+    assert mesh_in.topology.cell_type == cell_type
+    for d in range(3):
+        imap, imap_in = mesh.topology.index_map(d), mesh_in.topology.index_map(d)
+        assert imap_in.size_local == imap.size_local
+        assert imap_in.size_global == imap.size_global
+        assert np.all(imap_in.ghosts == imap.ghosts)
+    for d0, d1 in [(2, 0), (1, 0), (1, 2)]:
+        c, c_in = mesh.topology.connectivity(d0, d1), mesh_in.topology.connectivity(d0, d1)
+        assert c_in is not None
+        assert np.all(c_in.array == c.array)
+        assert np.all(c_in.offsets == c.offsets)
+    assert np.allclose(mesh_in.geometry.x, mesh.geometry.x)
+    assert np.all(mesh_in.geometry.dofmap.array == mesh.geometry.dofmap.array)
+    assert np.all(mesh_in.geometry.input_global_indices == mesh.geometry.input_global_indices)
+
+
+def test_read_write_3d(tempdir):
+    mesh = UnitCubeMesh(MPI.COMM_WORLD, 3, 4, 2)
+    filename = os.path.join(tempdir, "mesh_cache_3d.bin")
+    write_mesh_cache(mesh, filename)
+
+    mesh_in = read_mesh_cache(MPI.COMM_WORLD, filename)
+    assert mesh_in.geometry.dim == 3
+    assert mesh_in.geometry.cmap.degree == 1
+    assert mesh_in.topology.index_map(3).size_global == mesh.topology.index_map(3).size_global
+    assert mesh_in.topology.index_map(0).size_global == 60
+    assert mesh_in.ufl_domain() is not None
+
+
+def test_read_write_p2(tempdir):
+    """Round trip of a mesh with a P2 geometry, which has a compact
+    geometry dofmap that is not shared with the topology"""
+    if MPI.COMM_WORLD.rank == 0:
+        x = np.array([[0.0, 0.0], [1.0, 0.0], [0.0, 1.0], [1.0, 1.0], [0.5, 0.5],
+                      [0.0, 0.5], [0.5, 0.0], [1.0, 0.5], [0.5, 1.0]])
+        cells = np.array([[0, 1, 2, 4, 5, 6], [1, 3, 2, 8, 4, 7]], dtype=np.int64)
+    else:
+        x, cells = np.zeros((0, 2)), np.zeros((0, 6), dtype=np.int64)
+    domain = ufl.Mesh(ufl.VectorElement("Lagrange", "triangle", 2))
+    mesh = create_mesh(MPI.COMM_WORLD, cells, x, domain)
+    assert mesh.geometry.dofmap.is_compact
+    filename = os.path.join(tempdir, "mesh_cache_p2.bin")
+    write_mesh_cache(mesh, filename)
+
+    mesh_in = read_mesh_cache(MPI.COMM_WORLD, filename)
+    assert mesh_in.geometry.cmap.degree == 2
+    x_dofmap, x_dofmap_in = mesh.geometry.dofmap, mesh_in.geometry.dofmap
+    assert x_dofmap_in.is_compact
+    assert x_dofmap_in.num_nodes == x_dofmap.num_nodes
+    assert np.all(x_dofmap_in.array == x_dofmap.array)
+    assert np.allclose(mesh_in.geometry.x, mesh.geometry.x)
+    tdim = mesh.topology.dim
+    assert mesh_in.topology.connectivity(tdim, 0).is_compact
+    assert np.all(mesh_in.topology.connectivity(tdim, 0).array == mesh.topology.connectivity(tdim, 0).array)
+
+
+def test_read_wrong_file(tempdir):
+    filename = os.path.join(tempdir, "mesh_cache_invalid.bin")
+    if MPI.COMM_WORLD.rank == 0:
+        with open(filename, "wb") as f:
+            f.write(b"not a mesh cache file")
+    MPI.COMM_WORLD.Barrier()
+    with pytest.raises(RuntimeError):
+        read_mesh_cache(MPI.COMM_WORLD, filename)
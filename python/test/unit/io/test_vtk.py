@@ -11,10 +11,10 @@ import pytest
 import ufl
 from dolfinx import (Function, FunctionSpace, TensorFunctionSpace,
                      UnitCubeMesh, UnitIntervalMesh, UnitSquareMesh,
-                     VectorFunctionSpace, cpp)
+                     VectorFunctionSpace, cpp, has_zlib)
 from dolfinx.io import VTKFile
 from dolfinx.cpp.mesh import CellType
-from dolfinx.mesh import create_mesh
+from dolfinx.mesh import MeshTags, create_mesh, locate_entities_boundary
 from dolfinx_utils.test.fixtures import tempdir
 from dolfinx_utils.test.skips import skip_in_parallel
 from mpi4py import MPI
@@ -218,3 +218,94 @@ def test_save_3d_tensor(tempdir):
     filename = os.path.join(tempdir, "u.pvd")
     with VTKFile(mesh.mpi_comm(), filename, "w") as vtk:
         vtk.write_function(u, 0.)
+
+
+@pytest.mark.parametrize("encoding", [VTKFile.Encoding.Raw, VTKFile.Encoding.ZLib])
+def test_save_binary_encoding(tempdir, encoding):
+    if encoding == VTKFile.Encoding.ZLib and not has_zlib:
+        pytest.skip("DOLFINx has not been built with zlib")
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 16, 16)
+    u = Function(VectorFunctionSpace(mesh, ("Lagrange", 1)))
+    u.interpolate(lambda x: np.vstack((x[0], x[1])))
+
+    filename = os.path.join(tempdir, f"u_{encoding.name}.pvd")
+    with VTKFile(mesh.mpi_comm(), filename, "w", encoding) as vtk:
+        vtk.write_mesh(mesh, 0.)
+        vtk.write_function(u, 1.)
+
+    rank = mesh.mpi_comm().rank
+    for step in ["000000", "000001"]:
+        vtu = os.path.join(tempdir, f"u_{encoding.name}_p{rank}_{step}.vtu")
+        with open(vtu, "rb") as f:
+            data = f.read()
+        assert data.count(b'format="appended"') >= 4
+        assert b'<AppendedData encoding="raw">' in data
+        assert data.rstrip().endswith(b"</VTKFile>")
+
+
+@pytest.mark.parametrize("encoding", [VTKFile.Encoding.ASCII, VTKFile.Encoding.Raw])
+@pytest.mark.parametrize("ranks_per_file", [0, 2])
+def test_save_aggregated(tempdir, encoding, ranks_per_file):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 16, 16)
+    u = Function(FunctionSpace(mesh, ("Lagrange", 1)))
+    u.interpolate(lambda x: x[0] + x[1])
+
+    name = f"u_{encoding.name}_{ranks_per_file}"
+    filename = os.path.join(tempdir, f"{name}.pvd")
+    with VTKFile(mesh.mpi_comm(), filename, "w", encoding, ranks_per_file) as vtk:
+        vtk.write_function(u, 0.)
+
+    # Count the files and the pieces in the files
+    comm = mesh.mpi_comm()
+    comm.barrier()
+    if comm.rank == 0:
+        files = [f for f in os.listdir(tempdir) if f.startswith(f"{name}_p") and f.endswith(".vtu")]
+        if ranks_per_file > 0:
+            assert len(files) == (comm.size + ranks_per_file - 1) // ranks_per_file
+        num_pieces = 0
+        for f in files:
+            with open(os.path.join(tempdir, f), "rb") as vtu:
+                num_pieces += vtu.read().count(b"<Piece ")
+        assert num_pieces == comm.size
+
+
+def test_save_region(tempdir):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 16, 16)
+    u = Function(FunctionSpace(mesh, ("Lagrange", 2)))
+    u.interpolate(lambda x: x[0] + x[1])
+    v = Function(FunctionSpace(mesh, ("DG", 0)))
+
+    # Tag the facets at x = 0
+    facets = locate_entities_boundary(mesh, 1, lambda x: np.isclose(x[0], 0.0))
+    tags = MeshTags(mesh, 1, facets, np.full(len(facets), 1, dtype=np.int32))
+    mesh.topology.create_connectivity(1, 2)
+
+    filename = os.path.join(tempdir, "u_region.pvd")
+    with VTKFile(mesh.mpi_comm(), filename, "w") as vtk:
+        vtk.set_cells(tags, 1)
+        vtk.write_mesh(mesh, 0.)
+        vtk.write_function([u, v], 1.)
+
+    comm = mesh.mpi_comm()
+    for step in ["000000", "000001"]:
+        vtu = os.path.join(tempdir, f"u_region_p{comm.rank}_{step}.vtu")
+        with open(vtu) as f:
+            data = f.read()
+        num_cells = int(data.split('NumberOfCells="')[1].split('"')[0])
+        assert comm.allreduce(num_cells, op=MPI.SUM) == 16
+
+
+def test_save_stride(tempdir):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 4, 4)
+    u = Function(FunctionSpace(mesh, ("Lagrange", 1)))
+    filename = os.path.join(tempdir, "u_stride.pvd")
+    with VTKFile(mesh.mpi_comm(), filename, "w") as vtk:
+        vtk.set_stride(2)
+        for t in range(5):
+            vtk.write_function(u, float(t))
+
+    mesh.mpi_comm().barrier()
+    with open(filename) as f:
+        data = f.read()
+    assert data.count("<DataSet ") == 3
+    assert 'timestep="2"' in data and 'timestep="1"' not in data
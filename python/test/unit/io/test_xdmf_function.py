@@ -5,13 +5,17 @@
 # SPDX-License-Identifier:    LGPL-3.0-or-later
 
 import os
+from xml.etree import ElementTree
 
+import numpy as np
 import pytest
+import ufl
 from dolfinx import (Function, FunctionSpace, TensorFunctionSpace,
                      UnitCubeMesh, UnitIntervalMesh, UnitSquareMesh,
                      VectorFunctionSpace, has_petsc_complex)
 from dolfinx.cpp.mesh import CellType
-from dolfinx.io import XDMFFile
+from dolfinx.io import AsyncWriter, XDMFFile
+from dolfinx.mesh import create_mesh
 from dolfinx_utils.test.fixtures import tempdir
 from mpi4py import MPI
 
@@ -100,6 +104,24 @@ def test_save_2d_vector(tempdir, encoding, cell_type):
         file.write_function(u)
 
 
+@pytest.mark.parametrize("encoding", encodings)
+def test_save_2d_vector_CG2(tempdir, encoding):
+    """Write a P2 function on a quadratic mesh, for which the values at
+    the geometry nodes are the degrees-of-freedom"""
+    points = np.array([[0, 0], [1, 0], [0, 2], [0.5, 1], [0, 1], [0.5, 0],
+                       [1, 2], [0.5, 2], [1, 1]])
+    cells = np.array([[0, 1, 2, 3, 4, 5],
+                      [1, 6, 2, 7, 3, 8]])
+    domain = ufl.Mesh(ufl.VectorElement("Lagrange", "triangle", 2))
+    mesh = create_mesh(MPI.COMM_WORLD, cells, points, domain)
+    u = Function(VectorFunctionSpace(mesh, ("Lagrange", 2)))
+    u.interpolate(lambda x: np.stack((x[0], x[1])))
+    filename = os.path.join(tempdir, "u_2dv_CG2.xdmf")
+    with XDMFFile(mesh.mpi_comm(), filename, "w", encoding=encoding) as file:
+        file.write_mesh(mesh)
+        file.write_function(u)
+
+
 @pytest.mark.parametrize("cell_type", celltypes_3D)
 @pytest.mark.parametrize("encoding", encodings)
 def test_save_3d_vector(tempdir, encoding, cell_type):
@@ -152,3 +174,131 @@ def test_save_3d_vector_series(tempdir, encoding, cell_type):
     with XDMFFile(mesh.mpi_comm(), filename, "a", encoding=encoding) as file:
         u.vector.set(3.0 + (3j if has_petsc_complex else 0))
         file.write_function(u, 0.3)
+
+
+def test_save_series_appended(tempdir):
+    filename = os.path.join(tempdir, "u_series.xdmf")
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 4, 4)
+    u = Function(FunctionSpace(mesh, ("Lagrange", 1)))
+    u.name = "u"
+    with XDMFFile(mesh.mpi_comm(), filename, "w") as file:
+        file.write_mesh(mesh)
+        for t in range(3):
+            u.vector.set(t)
+            file.write_function(u, t)
+        file.write_geometry(mesh.geometry, "geometry_moved")
+        file.write_function(u, 3.0, geometry_xpath="/Xdmf/Domain/Grid[@Name='geometry_moved']/Geometry")
+
+    # The values at all times are slabs of one dataset, whose
+    # dimensions are the same in each step
+    num_dofs = mesh.geometry.index_map().size_global
+    root = ElementTree.parse(filename).getroot()
+    slabs = root.findall(".//Attribute/DataItem[@ItemType='HyperSlab']")
+    assert len(slabs) == (8 if has_petsc_complex else 4)
+    for i, slab in enumerate(slabs[::2] if has_petsc_complex else slabs):
+        select, data = slab.findall("DataItem")
+        assert [int(v) for v in select.text.split()] == [i * num_dofs, 0, 1, 1, num_dofs, 1]
+        assert data.get("Dimensions") == f"{4 * num_dofs} 1"
+        assert data.text.endswith(":/Function/" + ("real_u" if has_petsc_complex else "u") + "/values")
+
+    # The last step refers to the moved geometry
+    grid = root.findall(".//Grid[@CollectionType='Temporal']/Grid")[-1]
+    refs = [ref.get("xpointer") for ref in grid if ref.tag.endswith("include")]
+    assert refs[-1] == "xpointer(/Xdmf/Domain/Grid[@Name='geometry_moved']/Geometry)"
+
+
+@pytest.mark.parametrize("max_pending", [0, 2])
+def test_save_series_async(tempdir, max_pending):
+    filename = os.path.join(tempdir, "u_async.xdmf")
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 4, 4)
+    u = Function(FunctionSpace(mesh, ("Lagrange", 1)))
+    u.name = "u"
+    writer = AsyncWriter(max_pending)
+    with XDMFFile(mesh.mpi_comm(), filename, "w") as file:
+        file.write_mesh(mesh)
+        for t in range(4):
+            # The Function is copied, so it can be modified once the
+            # write has been queued
+            u.vector.set(t)
+            writer.write_function(file, u, t)
+            assert writer.num_pending <= max_pending
+        writer.wait()
+        assert writer.num_pending == 0
+
+    root = ElementTree.parse(filename).getroot()
+    times = [float(time.get("Value")) for time in root.findall(".//Grid[@CollectionType='Temporal']/Grid/Time")]
+    assert times == [0.0, 1.0, 2.0, 3.0]
+
+
+@pytest.mark.parametrize("write_partition", [True, False])
+def test_checkpoint(tempdir, write_partition):
+    filename = os.path.join(tempdir, "u_checkpoint.xdmf")
+    mesh = UnitCubeMesh(MPI.COMM_WORLD, 4, 3, 2)
+    u = Function(VectorFunctionSpace(mesh, ("Lagrange", 2)))
+    u.interpolate(lambda x: np.stack((x[0] + 2 * x[1] * x[2], x[1] ** 2, x[2])))
+    u.x.scatter_forward()
+    with XDMFFile(mesh.mpi_comm(), filename, "w") as file:
+        file.write_mesh(mesh, write_partition=write_partition)
+        file.write_checkpoint(u, "u")
+
+    # With the saved partition, the values of each process are read
+    # directly if the cells and dofs are unchanged. Otherwise the values
+    # are redistributed.
+    with XDMFFile(MPI.COMM_WORLD, filename, "r") as file:
+        mesh1 = file.read_mesh()
+        u1 = Function(VectorFunctionSpace(mesh1, ("Lagrange", 2)))
+        file.read_checkpoint(u1, "u")
+
+    u_exact = Function(u1.function_space)
+    u_exact.interpolate(lambda x: np.stack((x[0] + 2 * x[1] * x[2], x[1] ** 2, x[2])))
+    assert np.allclose(u1.x.array, u_exact.x.array)
+
+
+def p2_square_mesh(comm, nx, ny):
+    """Mesh of the unit square with P2 triangles, created on rank 0"""
+    if comm.rank == 0:
+        # Nodes on a (2 nx + 1) x (2 ny + 1) lattice
+        i, j = np.meshgrid(np.arange(2 * nx + 1), np.arange(2 * ny + 1), indexing="ij")
+        x = np.stack((i.ravel() / (2 * nx), j.ravel() / (2 * ny)), axis=1)
+
+        def node(a, b):
+            return a * (2 * ny + 1) + b
+
+        cells = []
+        for a in range(0, 2 * nx, 2):
+            for b in range(0, 2 * ny, 2):
+                for v in [((a, b), (a + 2, b), (a + 2, b + 2)), ((a, b), (a + 2, b + 2), (a, b + 2))]:
+                    # Vertices, then the midpoints of the edges (v1, v2),
+                    # (v0, v2) and (v0, v1)
+                    mid = [(v[1], v[2]), (v[0], v[2]), (v[0], v[1])]
+                    cells.append([node(*p) for p in v]
+                                 + [node((p[0] + q[0]) // 2, (p[1] + q[1]) // 2) for p, q in mid])
+        cells = np.array(cells, dtype=np.int64)
+    else:
+        x, cells = np.zeros((0, 2)), np.zeros((0, 6), dtype=np.int64)
+    domain = ufl.Mesh(ufl.VectorElement("Lagrange", "triangle", 2))
+    return create_mesh(comm, cells, x, domain)
+
+
+@pytest.mark.parametrize("write_partition", [True, False])
+def test_checkpoint_p2_geometry(tempdir, write_partition):
+    """Checkpoint round trip on a mesh with a P2 geometry, which has a
+    compact geometry dofmap"""
+    filename = os.path.join(tempdir, "u_checkpoint_p2.xdmf")
+    mesh = p2_square_mesh(MPI.COMM_WORLD, 4, 3)
+    assert mesh.geometry.dofmap.is_compact
+    u = Function(FunctionSpace(mesh, ("Lagrange", 2)))
+    u.interpolate(lambda x: x[0] + 2 * x[1] ** 2)
+    u.x.scatter_forward()
+    with XDMFFile(mesh.mpi_comm(), filename, "w") as file:
+        file.write_mesh(mesh, write_partition=write_partition)
+        file.write_checkpoint(u, "u")
+
+    with XDMFFile(MPI.COMM_WORLD, filename, "r") as file:
+        mesh1 = file.read_mesh()
+        u1 = Function(FunctionSpace(mesh1, ("Lagrange", 2)))
+        file.read_checkpoint(u1, "u")
+
+    u_exact = Function(u1.function_space)
+    u_exact.interpolate(lambda x: x[0] + 2 * x[1] ** 2)
+    assert np.allclose(u1.x.array, u_exact.x.array)
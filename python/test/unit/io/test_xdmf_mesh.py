@@ -94,6 +94,57 @@ def test_save_and_load_3d_mesh(tempdir, encoding, cell_type):
         mesh.topology.dim).size_global
 
 
+@pytest.mark.parametrize("chunk_rows", [0, 100])
+def test_save_and_load_compressed_mesh(tempdir, chunk_rows):
+    filename = os.path.join(tempdir, "mesh_compressed.xdmf")
+    mesh = UnitCubeMesh(MPI.COMM_WORLD, 6, 6, 6)
+    file_options = cpp.io.HDF5FileOptions()
+    file_options.alignment = 4096
+    write_options = cpp.io.HDF5WriteOptions()
+    write_options.chunk_rows = chunk_rows
+    write_options.deflate_level = 4
+    write_options.shuffle = True
+    with XDMFFile(mesh.mpi_comm(), filename, "w", file_options=file_options,
+                  write_options=write_options) as file:
+        file.write_mesh(mesh)
+
+    with XDMFFile(MPI.COMM_WORLD, filename, "r") as file:
+        mesh2 = file.read_mesh()
+
+    tdim = mesh.topology.dim
+    assert mesh.topology.index_map(0).size_global == mesh2.topology.index_map(0).size_global
+    assert mesh.topology.index_map(tdim).size_global == mesh2.topology.index_map(tdim).size_global
+    x0 = cpp.mesh.midpoints(mesh, tdim, range(mesh.topology.index_map(tdim).size_local))
+    x1 = cpp.mesh.midpoints(mesh2, tdim, range(mesh2.topology.index_map(tdim).size_local))
+    x0 = np.vstack(MPI.COMM_WORLD.allgather(x0))
+    x1 = np.vstack(MPI.COMM_WORLD.allgather(x1))
+    assert np.allclose(x0[np.lexsort(x0.T)], x1[np.lexsort(x1.T)])
+
+
+@pytest.mark.parametrize("ghost_mode", [cpp.mesh.GhostMode.none, cpp.mesh.GhostMode.shared_facet])
+def test_save_and_load_partition(tempdir, ghost_mode):
+    filename = os.path.join(tempdir, "mesh_partition.xdmf")
+    mesh = UnitCubeMesh(MPI.COMM_WORLD, 8, 8, 8, ghost_mode=cpp.mesh.GhostMode.shared_facet)
+    with XDMFFile(mesh.mpi_comm(), filename, "w") as file:
+        file.write_mesh(mesh, write_partition=True)
+
+    with XDMFFile(MPI.COMM_WORLD, filename, "r") as file:
+        mesh2 = file.read_mesh(ghost_mode=ghost_mode)
+
+    # The saved partition is reused, so each process owns the same cells
+    tdim = mesh.topology.dim
+    map0, map1 = mesh.topology.index_map(tdim), mesh2.topology.index_map(tdim)
+    assert map1.size_global == map0.size_global
+    assert map1.size_local == map0.size_local
+    x0 = cpp.mesh.midpoints(mesh, tdim, range(map0.size_local))
+    x1 = cpp.mesh.midpoints(mesh2, tdim, range(map1.size_local))
+    assert np.allclose(x0[np.lexsort(x0.T)], x1[np.lexsort(x1.T)])
+    if ghost_mode == cpp.mesh.GhostMode.shared_facet:
+        assert map1.num_ghosts == map0.num_ghosts
+    else:
+        assert map1.num_ghosts == 0
+
+
 @pytest.mark.parametrize("encoding", encodings)
 def test_read_write_p2_mesh(tempdir, encoding):
     try:
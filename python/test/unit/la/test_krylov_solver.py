@@ -12,7 +12,7 @@ import numpy as np
 import pytest
 import ufl
 from dolfinx import (DirichletBC, Function, FunctionSpace, UnitSquareMesh,
-                     VectorFunctionSpace)
+                     VectorFunctionSpace, cpp)
 from dolfinx.fem import (apply_lifting, assemble_matrix, assemble_vector,
                          locate_dofs_topological, set_bc)
 from dolfinx.la import VectorSpaceBasis
@@ -52,6 +52,42 @@ def test_krylov_solver_lu():
     assert x.norm(PETSc.NormType.N2) == pytest.approx(norm, abs=1.0e-12)
 
 
+def test_preconditioner_reuse():
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 12)
+    V = FunctionSpace(mesh, ("Lagrange", 1))
+    u, v = TrialFunction(V), TestFunction(V)
+    A = assemble_matrix(inner(u, v) * dx)
+    A.assemble()
+    b = assemble_vector(inner(1.0, v) * dx)
+    b.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+
+    ksp = PETSc.KSP().create(mesh.mpi_comm())
+    ksp.setType("preonly")
+    ksp.getPC().setType("lu")
+    solver = cpp.la.PETScKrylovSolver(ksp)
+    solver.set_preconditioner_reuse(cpp.la.PreconditionerReuse(max_solves=2))
+    assert solver.preconditioner_reuse.max_solves == 2
+    solver.set_operators(A, A)
+
+    x = A.createVecRight()
+    solver.solve(x, b)
+    norm = x.norm()
+
+    # The factorisation of the unscaled operator is reused in the second
+    # solve, and rebuilt in the third
+    A.scale(2.0)
+    solver.solve(x, b)
+    assert x.norm() == pytest.approx(norm, rel=1.0e-10)
+    solver.solve(x, b)
+    assert x.norm() == pytest.approx(0.5 * norm, rel=1.0e-10)
+
+    # Forced rebuild
+    A.scale(2.0)
+    solver.rebuild_preconditioner()
+    solver.solve(x, b)
+    assert x.norm() == pytest.approx(0.25 * norm, rel=1.0e-10)
+
+
 @pytest.mark.skip
 def test_krylov_samg_solver_elasticity():
     "Test PETScKrylovSolver with smoothed aggregation AMG"
@@ -143,3 +143,23 @@ def test_nullspace_check(mesh, degree):
     assert not null_space.in_nullspace(A, tol=1.0e-8)
     null_space.orthonormalize()
     assert not null_space.in_nullspace(A, tol=1.0e-8)
+
+
+def test_nullspace_orthogonalize_vector():
+    """Test orthogonalisation of a vector and the update of the cached
+    Gram matrix when a basis vector changes"""
+    mesh = UnitCubeMesh(MPI.COMM_WORLD, 6, 6, 6)
+    V = VectorFunctionSpace(mesh, ('Lagrange', 1))
+    null_space = build_elastic_nullspace(V)
+    null_space.orthonormalize()
+    assert null_space.is_orthonormal()
+
+    x = cpp.la.create_vector(V.dofmap.index_map, V.dofmap.index_map_bs)
+    x.setRandom()
+    null_space.orthogonalize(x)
+    for i in range(null_space.dim()):
+        assert abs(x.dot(null_space[i])) < 1.0e-10
+
+    null_space[0].scale(2.0)
+    assert null_space.is_orthogonal()
+    assert not null_space.is_orthonormal()
@@ -9,9 +9,11 @@
 
 import numpy as np
 from mpi4py import MPI
+from petsc4py import PETSc
 import pytest
 
 from dolfinx import (Function, FunctionSpace, UnitSquareMesh, cpp)
+from dolfinx.la import create_petsc_vector_wrap
 import ufl
 
 
@@ -72,3 +74,24 @@ def test_scatter_reverse(element):
     # on all processes
     all_count1 = MPI.COMM_WORLD.allreduce(u.x.array.sum(), op=MPI.SUM)
     assert all_count1 == (all_count0 + bs * ghost_count)
+
+
+@pytest.mark.parametrize("element", [ufl.FiniteElement("CG", "triangle", 1), ufl.VectorElement("CG", "triangle", 1)])
+def test_petsc_vector_wrap(element):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 5, 5)
+    V = FunctionSpace(mesh, element)
+    x = cpp.la.Vector(V.dofmap.index_map, V.dofmap.index_map_bs)
+    x.array[:] = MPI.COMM_WORLD.rank
+
+    # The PETSc vector shares the owned and ghost entries
+    v = create_petsc_vector_wrap(x)
+    with v.localForm() as v_local:
+        assert np.allclose(v_local.array_r, x.array)
+    v.scale(2.0)
+    assert np.allclose(x.array[:V.dofmap.index_map.size_local * x.bs], 2 * MPI.COMM_WORLD.rank)
+
+    # PETSc ghost updates write into the DOLFINx vector
+    x.array[:] = MPI.COMM_WORLD.rank
+    v.ghostUpdate(addv=PETSc.InsertMode.INSERT, mode=PETSc.ScatterMode.FORWARD)
+    ghost_owners = np.repeat(V.dofmap.index_map.ghost_owner_rank(), x.bs)
+    assert np.allclose(x.array[V.dofmap.index_map.size_local * x.bs:], ghost_owners)
@@ -87,3 +87,161 @@ def test_custom_partitioner(tempdir, Nx, cell_type):
     assert num_cells > 0
     assert np.all(cell_midpoints[:, 0] >= mpi_comm.rank)
     assert np.all(cell_midpoints[:, 0] <= mpi_comm.rank + 1)
+
+
+@pytest.mark.parametrize("ghost_mode", [GhostMode.none, GhostMode.shared_facet])
+@pytest.mark.parametrize("cell_type", [CellType.tetrahedron, CellType.hexahedron])
+def test_sfc_partitioner(tempdir, ghost_mode, cell_type):
+    mpi_comm = MPI.COMM_WORLD
+    Nx = 6
+    mesh = dolfinx.BoxMesh(mpi_comm, [np.array([0, 0, 0]), np.array([1, 1, 1])], [Nx, Nx, Nx], cell_type,
+                           GhostMode.none)
+    filename = os.path.join(tempdir, "sfc.xdmf")
+    with XDMFFile(mpi_comm, filename, "w") as file:
+        file.write_mesh(mesh)
+    with XDMFFile(mpi_comm, filename, "r") as file:
+        cell_shape, cell_degree = file.read_cell_type()
+        x = file.read_geometry_data()
+        topo = file.read_topology_data()
+
+    cell = ufl.Cell(dolfinx.cpp.mesh.to_string(cell_shape))
+    domain = ufl.Mesh(ufl.VectorElement("Lagrange", cell, cell_degree))
+    partitioner = dolfinx.cpp.mesh.create_cell_partitioner_sfc(x)
+    new_mesh = dolfinx.mesh.create_mesh(mpi_comm, topo, x, domain, ghost_mode, partitioner)
+
+    tdim = new_mesh.topology.dim
+    index_map = new_mesh.topology.index_map(tdim)
+    assert index_map.size_global == mesh.topology.index_map(tdim).size_global
+    assert new_mesh.topology.index_map(0).size_global == (Nx + 1)**3
+    assert index_map.size_local > 0
+    if ghost_mode == GhostMode.none:
+        assert index_map.num_ghosts == 0
+    elif mpi_comm.size > 1:
+        assert index_map.num_ghosts > 0
+    vol = mpi_comm.allreduce(dolfinx.fem.assemble_scalar(1 * ufl.dx(new_mesh)), op=MPI.SUM)
+    assert vol == pytest.approx(1, rel=1e-9)
+
+
+@pytest.mark.parametrize("cell_type", [CellType.tetrahedron, CellType.hexahedron])
+def test_weighted_partitioner(tempdir, cell_type):
+    mpi_comm = MPI.COMM_WORLD
+    Nx = 8
+    mesh = dolfinx.BoxMesh(mpi_comm, [np.array([0, 0, 0]), np.array([1, 1, 1])], [Nx, Nx, Nx], cell_type,
+                           GhostMode.none)
+    filename = os.path.join(tempdir, "weighted.xdmf")
+    with XDMFFile(mpi_comm, filename, "w") as file:
+        file.write_mesh(mesh)
+    with XDMFFile(MPI.COMM_SELF, filename, "r") as file:
+        x_global = file.read_geometry_data()
+    with XDMFFile(mpi_comm, filename, "r") as file:
+        cell_shape, cell_degree = file.read_cell_type()
+        x = file.read_geometry_data()
+        topo = file.read_topology_data()
+
+    # Cells in the left half of the domain are ten times as expensive
+    def cost(midpoints):
+        return np.where(midpoints[:, 0] < 0.5, 10, 1).astype(np.int32)
+
+    weights = cost(np.mean(x_global[topo], axis=1))
+
+    def partitioner(comm, n, tdim, cells, ghost_mode):
+        return partition_cells_graph(comm, n, tdim, cells, ghost_mode, weights)
+
+    cell = ufl.Cell(dolfinx.cpp.mesh.to_string(cell_shape))
+    domain = ufl.Mesh(ufl.VectorElement("Lagrange", cell, cell_degree))
+    new_mesh = dolfinx.mesh.create_mesh(mpi_comm, topo, x, domain, GhostMode.none, partitioner)
+
+    tdim = new_mesh.topology.dim
+    index_map = new_mesh.topology.index_map(tdim)
+    assert index_map.size_global == mesh.topology.index_map(tdim).size_global
+    num_cells = index_map.size_local
+    load = np.sum(cost(dolfinx.cpp.mesh.midpoints(new_mesh, tdim, range(num_cells))))
+    loads = mpi_comm.allgather(load)
+    assert max(loads) <= 1.2 * np.mean(loads)
+
+    # The number of weights must match the number of cells
+    with pytest.raises(RuntimeError):
+        partition_cells_graph(mpi_comm, mpi_comm.size, tdim, dolfinx.cpp.graph.AdjacencyList_int64(topo),
+                              GhostMode.none, np.ones(topo.shape[0] + 1, dtype=np.int32))
+
+
+@pytest.mark.parametrize("ghost_mode", [GhostMode.none, GhostMode.shared_facet])
+def test_hierarchical_partitioner(tempdir, ghost_mode):
+    mpi_comm = MPI.COMM_WORLD
+    Nx = 6
+    mesh = dolfinx.BoxMesh(mpi_comm, [np.array([0, 0, 0]), np.array([1, 1, 1])], [Nx, Nx, Nx],
+                           CellType.tetrahedron, GhostMode.none)
+    filename = os.path.join(tempdir, "hierarchical.xdmf")
+    with XDMFFile(mpi_comm, filename, "w") as file:
+        file.write_mesh(mesh)
+    with XDMFFile(mpi_comm, filename, "r") as file:
+        cell_shape, cell_degree = file.read_cell_type()
+        x = file.read_geometry_data()
+        topo = file.read_topology_data()
+
+    cell = ufl.Cell(dolfinx.cpp.mesh.to_string(cell_shape))
+    domain = ufl.Mesh(ufl.VectorElement("Lagrange", cell, cell_degree))
+    partitioner = dolfinx.cpp.mesh.create_cell_partitioner_hierarchical()
+    new_mesh = dolfinx.mesh.create_mesh(mpi_comm, topo, x, domain, ghost_mode, partitioner)
+
+    tdim = new_mesh.topology.dim
+    index_map = new_mesh.topology.index_map(tdim)
+    assert index_map.size_global == mesh.topology.index_map(tdim).size_global
+    assert index_map.size_local > 0
+    if ghost_mode == GhostMode.none:
+        assert index_map.num_ghosts == 0
+    vol = mpi_comm.allreduce(dolfinx.fem.assemble_scalar(1 * ufl.dx(new_mesh)), op=MPI.SUM)
+    assert vol == pytest.approx(1, rel=1e-9)
+
+
+@pytest.mark.parametrize("ghost_mode", [GhostMode.none, GhostMode.shared_facet])
+def test_diffusion_partitioner(tempdir, ghost_mode):
+    mpi_comm = MPI.COMM_WORLD
+    Nx = 6
+    mesh = dolfinx.BoxMesh(mpi_comm, [np.array([0, 0, 0]), np.array([1, 1, 1])], [Nx, Nx, Nx],
+                           CellType.tetrahedron, GhostMode.none)
+    filename = os.path.join(tempdir, "diffusion.xdmf")
+    with XDMFFile(mpi_comm, filename, "w") as file:
+        file.write_mesh(mesh)
+    with XDMFFile(mpi_comm, filename, "r") as file:
+        cell_shape, cell_degree = file.read_cell_type()
+        x = file.read_geometry_data()
+        topo = file.read_topology_data()
+
+    # Create an imbalanced distribution of the cells, with the number of
+    # cells on a rank proportional to the rank plus one
+    topo = np.vstack(mpi_comm.allgather(topo))
+    num_cells = np.arange(1, mpi_comm.size + 1)
+    offsets = np.insert(np.cumsum(num_cells), 0, 0) * topo.shape[0] // num_cells.sum()
+    topo = topo[offsets[mpi_comm.rank]:offsets[mpi_comm.rank + 1]]
+
+    cell = ufl.Cell(dolfinx.cpp.mesh.to_string(cell_shape))
+    domain = ufl.Mesh(ufl.VectorElement("Lagrange", cell, cell_degree))
+    partitioner = dolfinx.cpp.mesh.create_cell_partitioner_diffusion()
+    new_mesh = dolfinx.mesh.create_mesh(mpi_comm, topo, x, domain, ghost_mode, partitioner)
+
+    # The cells are re-balanced without increasing the largest number of
+    # cells on a rank
+    tdim = new_mesh.topology.dim
+    index_map = new_mesh.topology.index_map(tdim)
+    assert index_map.size_global == mesh.topology.index_map(tdim).size_global
+    assert mpi_comm.allreduce(index_map.size_local, op=MPI.MAX) <= mpi_comm.allreduce(topo.shape[0], op=MPI.MAX)
+    assert index_map.size_local > 0
+    if ghost_mode == GhostMode.none:
+        assert index_map.num_ghosts == 0
+    vol = mpi_comm.allreduce(dolfinx.fem.assemble_scalar(1 * ufl.dx(new_mesh)), op=MPI.SUM)
+    assert vol == pytest.approx(1, rel=1e-9)
+
+
+@pytest.mark.parametrize("strategy", [dolfinx.cpp.mesh.ScotchStrategy.quality,
+                                      dolfinx.cpp.mesh.ScotchStrategy.speed])
+@pytest.mark.parametrize("num_threads", [1, 2])
+def test_scotch_partitioner_options(strategy, num_threads):
+    Nx = 6
+    partitioner = dolfinx.cpp.mesh.create_cell_partitioner_scotch(
+        strategy, imbalance=0.05, seed=1, num_threads=num_threads)
+    mesh = dolfinx.BoxMesh(MPI.COMM_WORLD, [np.array([0, 0, 0]), np.array([1, 1, 1])], [Nx, Nx, Nx],
+                           CellType.tetrahedron, GhostMode.shared_facet, partitioner)
+    tdim = mesh.topology.dim
+    assert mesh.topology.index_map(tdim).size_global == Nx**3 * 6
+    assert mesh.topology.index_map(tdim).size_local != 0
@@ -51,6 +51,29 @@ def test_ghost_3d(mode):
     assert mesh.topology.index_map(3).size_global == num_cells
 
 
+@pytest.mark.parametrize("num_layers", [2, 3])
+def test_ghost_layers(num_layers):
+    def partitioner(comm, n, tdim, cells, ghost_mode):
+        return cpp.mesh.partition_cells_graph(comm, n, tdim, cells, ghost_mode, num_ghost_layers=num_layers)
+
+    N = 8
+    mode = cpp.mesh.GhostMode.shared_facet
+    mesh1 = UnitSquareMesh(MPI.COMM_WORLD, N, N, ghost_mode=mode)
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, N, N, ghost_mode=mode, partitioner=partitioner)
+    assert mesh.topology.index_map(0).size_global == 81
+    assert mesh.topology.index_map(2).size_global == N * N * 2
+    for d in range(3):
+        mesh.topology.create_entities(d)
+
+    # More layers give more ghost cells on each process
+    map1, map = mesh1.topology.index_map(2), mesh.topology.index_map(2)
+    num_ghosts1 = mesh.mpi_comm().allreduce(map1.num_ghosts, op=MPI.SUM)
+    num_ghosts = mesh.mpi_comm().allreduce(map.num_ghosts, op=MPI.SUM)
+    if mesh.mpi_comm().size > 1:
+        assert num_ghosts > num_ghosts1
+    assert mesh.topology.index_map(1).size_global == mesh1.topology.index_map(1).size_global
+
+
 @pytest.mark.parametrize("mode",
                          [cpp.mesh.GhostMode.none, cpp.mesh.GhostMode.shared_facet,
                           pytest.param(cpp.mesh.GhostMode.shared_vertex,
@@ -10,10 +10,15 @@ import sys
 import numpy as np
 import pytest
 import basix
-from dolfinx import (BoxMesh, RectangleMesh, UnitCubeMesh, UnitIntervalMesh,
-                     UnitSquareMesh, cpp)
-from dolfinx.cpp.mesh import CellType, is_simplex
+import ufl
+from dolfinx import (BoxMesh, Function, FunctionSpace, RectangleMesh,
+                     UnitCubeMesh, UnitIntervalMesh, UnitSquareMesh, cpp)
+from dolfinx.cpp.mesh import CellReordering, CellType, is_simplex
 from dolfinx.fem import assemble_scalar
+from dolfinx.generation import BlockBoxMesh, BlockRectangleMesh
+from dolfinx.mesh import (MeshTags, create_mesh, create_submesh,
+                          locate_entities, locate_entities_boundary,
+                          redistribute)
 from dolfinx_utils.test.fixtures import tempdir
 from dolfinx_utils.test.skips import skip_in_parallel
 from mpi4py import MPI
@@ -254,6 +259,29 @@ def test_cell_h(c0, c1, c5):
         assert cpp.mesh.h(c[0], c[1], [c[2]]) == pytest.approx(math.sqrt(2.0))
 
 
+@pytest.mark.parametrize("num_threads", [1, 3])
+def test_cell_metrics_into_arrays(num_threads):
+    """Check that the cell metrics computed into arrays, with threads, match
+    the returned arrays"""
+    mesh = UnitCubeMesh(MPI.COMM_WORLD, 5, 3, 4)
+    tdim = mesh.topology.dim
+    mesh.topology.create_connectivity(tdim - 1, tdim)
+    cells = np.arange(mesh.topology.index_map(tdim).size_local, dtype=np.int32)
+    h = np.zeros(len(cells))
+    cpp.mesh.h(mesh, tdim, cells, h, num_threads)
+    assert np.allclose(h, cpp.mesh.h(mesh, tdim, cells))
+
+    x = np.zeros((len(cells), 3))
+    cpp.mesh.midpoints(mesh, tdim, cells, x, num_threads)
+    assert np.allclose(x, cpp.mesh.midpoints(mesh, tdim, cells))
+
+    facets = np.arange(mesh.topology.index_map(tdim - 1).size_local, dtype=np.int32)
+    n = np.zeros((len(facets), 3))
+    cpp.mesh.cell_normals(mesh, tdim - 1, facets, n, num_threads)
+    assert np.allclose(n, cpp.mesh.cell_normals(mesh, tdim - 1, facets))
+    assert np.allclose(np.linalg.norm(n, axis=1), 1.0)
+
+
 @skip_in_parallel
 def xtest_cell_radius_ratio(c0, c1, c5):
     assert cpp.mesh.radius_ratio(c0[0], c0[2]) == pytest.approx(math.sqrt(3.0) - 1.0)
@@ -396,3 +424,408 @@ def test_UnitHexMesh_assemble():
     vol = assemble_scalar(1 * dx(mesh))
     vol = mesh.mpi_comm().allreduce(vol, MPI.SUM)
     assert vol == pytest.approx(1, rel=1e-9)
+
+
+@pytest.mark.parametrize("cell_type, diagonal", [(CellType.triangle, "left"), (CellType.triangle, "right"),
+                                                 (CellType.quadrilateral, "right")])
+def test_block_rectangle_mesh(cell_type, diagonal):
+    n = [2 * MPI.COMM_WORLD.size + 1, 5]
+    points = [np.array([0.0, 0.0, 0.0]), np.array([2.0, 1.5, 0.0])]
+    mesh = BlockRectangleMesh(MPI.COMM_WORLD, points, n, cell_type, diagonal)
+    mesh0 = RectangleMesh(MPI.COMM_WORLD, points, n, cell_type, diagonal=diagonal)
+    for d in (0, 2):
+        assert mesh.topology.index_map(d).size_global == mesh0.topology.index_map(d).size_global
+    assert mesh.topology.index_map(2).num_ghosts == 0
+    vol = mesh.mpi_comm().allreduce(assemble_scalar(1 * dx(mesh)), MPI.SUM)
+    assert vol == pytest.approx(3.0, rel=1e-9)
+
+    # Entities are computed as for a partitioned mesh
+    mesh.topology.create_connectivity(1, 0)
+    mesh0.topology.create_connectivity(1, 0)
+    assert mesh.topology.index_map(1).size_global == mesh0.topology.index_map(1).size_global
+
+    # The input global indices are the lexicographic indices of the
+    # grid vertices
+    x = mesh.geometry.x
+    i = mesh.geometry.input_global_indices
+    assert np.allclose(x[:, 0], (np.array(i) % (n[0] + 1)) * 2.0 / n[0])
+
+
+@pytest.mark.parametrize("cell_type", [CellType.tetrahedron, CellType.hexahedron])
+def test_block_box_mesh(cell_type):
+    n = [3, 2, 4]
+    points = [np.array([0.0, 0.0, 0.0]), np.array([1.0, 2.0, 1.0])]
+    mesh = BlockBoxMesh(MPI.COMM_WORLD, points, n, cell_type)
+    mesh0 = BoxMesh(MPI.COMM_WORLD, points, n, cell_type)
+    for d in (0, 3):
+        assert mesh.topology.index_map(d).size_global == mesh0.topology.index_map(d).size_global
+    mesh.topology.create_connectivity(2, 0)
+    mesh0.topology.create_connectivity(2, 0)
+    assert mesh.topology.index_map(2).size_global == mesh0.topology.index_map(2).size_global
+    vol = mesh.mpi_comm().allreduce(assemble_scalar(1 * dx(mesh)), MPI.SUM)
+    assert vol == pytest.approx(2.0, rel=1e-9)
+
+
+@pytest.mark.parametrize("cell_type", [CellType.tetrahedron, CellType.hexahedron])
+def test_structured_grid(cell_type):
+    n = [3, 2, 4]
+    p = [[0.0, 0.0, 0.0], [1.0, 2.0, 1.0]]
+    grid = cpp.generation.create_box_grid(MPI.COMM_WORLD, p, n, cell_type)
+    mesh = grid.create_mesh()
+    assert grid.num_vertices_global == 4 * 3 * 5
+    assert mesh.topology.index_map(0).size_local == grid.num_owned_vertices
+    assert mesh.topology.index_map(3).size_local == grid.num_cells
+
+    # The cells and coordinates of the grid are the cells and
+    # coordinates of the mesh
+    dofmap = mesh.geometry.dofmap
+    for c in range(grid.num_cells):
+        assert np.array_equal(grid.cell_vertices(c), dofmap.links(c))
+    x = mesh.geometry.x
+    global_indices = mesh.topology.index_map(0).global_indices()
+    for v in range(grid.num_vertices):
+        assert np.allclose(grid.x(v), x[v])
+        assert grid.global_vertex(grid.vertex(v))[0] == global_indices[v]
+
+
+def test_array_views():
+    """Arrays of the topology and geometry are read-only views that share memory with the C++ objects"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 4, 4)
+    tdim = mesh.topology.dim
+    c_to_v = mesh.topology.connectivity(tdim, 0)
+    mesh.topology.create_connectivity(0, tdim)
+    v_to_c = mesh.topology.connectivity(0, tdim)
+    for a in (c_to_v.array, v_to_c.offsets, c_to_v.links(0), mesh.geometry.input_global_indices,
+              mesh.topology.index_map(0).ghosts):
+        assert not a.flags.writeable
+        assert not a.flags.owndata
+    assert np.shares_memory(c_to_v.array, c_to_v.links(0))
+
+    # The views keep the C++ objects alive
+    indices = np.arange(mesh.topology.index_map(tdim).size_local, dtype=np.int32)
+    a = MeshTags(mesh, tdim, indices, np.ones_like(indices)).values
+    assert np.all(a == 1)
+    x = mesh.geometry.x
+    del mesh
+    assert x.shape[1] == 3
+
+
+def test_memory_usage():
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 8, 8)
+    topology = mesh.topology
+    tdim = topology.dim
+    mesh.topology.create_connectivity(tdim - 1, tdim)
+    size = topology.memory_usage(tdim - 1, tdim)
+    assert size > 0
+    assert topology.memory_usage() >= size + topology.memory_usage(tdim, 0)
+    assert mesh.geometry.memory_usage() >= mesh.geometry.x.nbytes
+    assert topology.index_map(tdim).memory_usage() >= 0
+
+    summary = cpp.mesh.memory_usage(mesh)
+    assert "Topology connectivity ({}, {})".format(tdim - 1, tdim) in summary
+    assert "Geometry" in summary
+
+
+@pytest.mark.parametrize("ghost_mode", [cpp.mesh.GhostMode.none, cpp.mesh.GhostMode.shared_facet])
+def test_vertex_geometry_shares_topology(ghost_mode):
+    """Check that a P1 geometry uses the cell-vertex connectivity and
+    the vertex index map of the topology"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 6, 5, ghost_mode=ghost_mode)
+    topology, geometry = mesh.topology, mesh.geometry
+    tdim = topology.dim
+    assert np.array_equal(geometry.dofmap.array, topology.connectivity(tdim, 0).array)
+    assert geometry.index_map().size_local == topology.index_map(0).size_local
+    assert geometry.index_map().num_ghosts == topology.index_map(0).num_ghosts
+    assert geometry.x.shape[0] == topology.index_map(0).size_local + topology.index_map(0).num_ghosts
+
+
+def test_create_entities_threads():
+    """Check that the entity numbering does not depend on the number of
+    threads"""
+    mesh0 = UnitCubeMesh(MPI.COMM_WORLD, 5, 5, 5)
+    mesh1 = UnitCubeMesh(MPI.COMM_WORLD, 5, 5, 5)
+    for dim in (1, 2):
+        mesh0.topology.create_entities(dim)
+        mesh1.topology.create_entities(dim, num_threads=4)
+        c0 = mesh0.topology.connectivity(3, dim)
+        c1 = mesh1.topology.connectivity(3, dim)
+        assert np.array_equal(c0.array, c1.array)
+
+
+def test_create_connectivity_threads():
+    """Check that the connectivity does not depend on the number of
+    threads"""
+    mesh0 = UnitCubeMesh(MPI.COMM_WORLD, 5, 5, 5)
+    mesh1 = UnitCubeMesh(MPI.COMM_WORLD, 5, 5, 5)
+    for d0, d1 in ((0, 3), (1, 2), (2, 1), (3, 1), (2, 0)):
+        mesh0.topology.create_connectivity(d0, d1)
+        mesh1.topology.create_connectivity(d0, d1, num_threads=4)
+        c0 = mesh0.topology.connectivity(d0, d1)
+        c1 = mesh1.topology.connectivity(d0, d1)
+        assert np.array_equal(c0.offsets, c1.offsets)
+        assert np.array_equal(c0.array, c1.array)
+
+
+def test_release_and_compact_connectivity():
+    mesh = UnitCubeMesh(MPI.COMM_WORLD, 3, 3, 3)
+    topology = mesh.topology
+    topology.create_connectivity(3, 1)
+    topology.create_connectivity(1, 3)
+    c31 = topology.connectivity(3, 1).array.copy()
+    c13 = topology.connectivity(1, 3)
+    c13_array, c13_offsets = c13.array.copy(), c13.offsets.copy()
+
+    # Released connectivities are recomputed on request
+    topology.release_connectivity(3, 1)
+    topology.release_connectivity(1, 3)
+    assert topology.connectivity(3, 1) is None
+    assert topology.connectivity(1, 3) is None
+    topology.create_connectivity(3, 1)
+    topology.create_connectivity(1, 3)
+    assert np.array_equal(topology.connectivity(3, 1).array, c31)
+    assert np.array_equal(topology.connectivity(1, 3).array, c13_array)
+    with pytest.raises(RuntimeError):
+        topology.release_connectivity(1, 0)
+
+    # Only connectivities with constant degree are compacted
+    size = topology.memory_usage()
+    topology.compact_connectivity()
+    assert topology.memory_usage() < size
+    c = topology.connectivity(3, 1)
+    assert c.is_compact
+    assert np.array_equal(c.array, c31)
+    assert np.array_equal(c.offsets, np.arange(0, 6 * c.num_nodes + 1, 6))
+    assert topology.connectivity(3, 0).is_compact
+    c = topology.connectivity(1, 3)
+    assert not c.is_compact
+    assert np.array_equal(c.offsets, c13_offsets)
+
+
+def test_geometry_topology_version():
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 4, 4)
+    geometry, topology = mesh.geometry, mesh.topology
+
+    v = geometry.version
+    geometry.increment_version()
+    assert geometry.version == v + 1
+    geometry.store_single_precision()
+    assert geometry.version == v + 2
+    geometry.store_double_precision()
+    assert geometry.version == v + 3
+
+    # Creating connectivity does not change the topology version
+    v = topology.version
+    topology.create_connectivity(1, 2)
+    assert topology.version == v
+
+
+@pytest.mark.parametrize("reordering", [CellReordering.none, CellReordering.gps,
+                                        CellReordering.reverse_cuthill_mckee, CellReordering.morton])
+def test_create_mesh_reordering(reordering):
+    """Check that the cell reordering at mesh creation gives a valid mesh"""
+    n = 8
+    if MPI.COMM_WORLD.rank == 0:
+        i, j = np.meshgrid(np.arange(n + 1), np.arange(n + 1), indexing="ij")
+        x = np.column_stack((i.ravel(), j.ravel())).astype(np.float64) / n
+        v = np.arange((n + 1)**2, dtype=np.int64).reshape(n + 1, n + 1)
+        v0, v1, v2, v3 = v[:-1, :-1].ravel(), v[1:, :-1].ravel(), v[:-1, 1:].ravel(), v[1:, 1:].ravel()
+        cells = np.vstack((np.column_stack((v0, v1, v3)), np.column_stack((v0, v2, v3))))
+    else:
+        x = np.zeros((0, 2), dtype=np.float64)
+        cells = np.zeros((0, 3), dtype=np.int64)
+
+    domain = ufl.Mesh(ufl.VectorElement("Lagrange", "triangle", 1))
+    mesh = create_mesh(MPI.COMM_WORLD, cells, x, domain, reordering=reordering)
+    assert mesh.topology.index_map(2).size_global == 2 * n**2
+    assert mesh.topology.index_map(0).size_global == (n + 1)**2
+    area = mesh.mpi_comm().allreduce(assemble_scalar(1 * dx(mesh)), op=MPI.SUM)
+    assert area == pytest.approx(1.0, rel=1e-10)
+
+
+@pytest.mark.parametrize("ghost_mode", [cpp.mesh.GhostMode.none, cpp.mesh.GhostMode.shared_facet])
+def test_redistribute(ghost_mode):
+    """Check that a redistributed mesh and the migrated tags and
+    function match the original"""
+    comm = MPI.COMM_WORLD
+    mesh = UnitCubeMesh(comm, 4, 4, 4)
+    tdim = mesh.topology.dim
+    num_cells = mesh.topology.index_map(tdim).size_local
+    dest = np.full(num_cells, (comm.rank + 1) % comm.size, dtype=np.int32)
+    dest[:num_cells // 2] = comm.rank
+
+    facets = locate_entities_boundary(mesh, tdim - 1, lambda x: np.isclose(x[0], 0.0))
+    tags = MeshTags(mesh, tdim - 1, facets, 3)
+    V = FunctionSpace(mesh, ("Lagrange", 2))
+    u = Function(V)
+    u.interpolate(lambda x: x[0] + 2 * x[1] * x[2])
+    u.x.scatter_forward()
+
+    mesh_new, cells = redistribute(mesh, dest, ghost_mode)
+    map_new = mesh_new.topology.index_map(tdim)
+    assert map_new.size_global == mesh.topology.index_map(tdim).size_global
+    assert len(cells) == map_new.size_local + map_new.num_ghosts
+    assert comm.allreduce(map_new.size_local, op=MPI.SUM) == comm.allreduce(num_cells, op=MPI.SUM)
+    if ghost_mode == cpp.mesh.GhostMode.none:
+        assert map_new.num_ghosts == 0
+    vol = comm.allreduce(assemble_scalar(1 * dx(mesh_new)), op=MPI.SUM)
+    assert vol == pytest.approx(1.0, rel=1e-10)
+
+    tags_new = cpp.mesh.migrate_meshtags(tags, mesh_new, cells)
+    assert np.all(tags_new.values == 3)
+    facet_map = mesh_new.topology.index_map(tdim - 1)
+    num_tagged = np.sum(tags_new.indices < facet_map.size_local)
+    assert comm.allreduce(num_tagged, op=MPI.SUM) == 2 * 4 * 4
+
+    V_new = FunctionSpace(mesh_new, ("Lagrange", 2))
+    u_new, u_exact = Function(V_new), Function(V_new)
+    u_new.migrate(u, cells)
+    u_exact.interpolate(lambda x: x[0] + 2 * x[1] * x[2])
+    assert np.allclose(u_new.x.array, u_exact.x.array)
+
+
+@pytest.mark.parametrize("dim", [0, 1, 2])
+def test_locate_entities_many_markers(dim):
+    """Check that locating entities for a list of markers gives the same
+    entities as locating the entities one marker at a time"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 7, 5)
+    markers = [lambda x: np.isclose(x[0], 0.0), lambda x: np.isclose(x[1], 1.0),
+               lambda x: x[0] < 0.5, lambda x: np.full(x.shape[1], False)]
+    entities = locate_entities(mesh, dim, markers)
+    assert entities.num_nodes == len(markers)
+    for i, marker in enumerate(markers):
+        assert np.array_equal(np.sort(entities.links(i)), np.sort(locate_entities(mesh, dim, marker)))
+
+    if dim < mesh.topology.dim:
+        entities = locate_entities_boundary(mesh, dim, markers)
+        for i, marker in enumerate(markers):
+            assert np.array_equal(np.sort(entities.links(i)), np.sort(locate_entities_boundary(mesh, dim, marker)))
+        assert len(entities.links(3)) == 0
+
+
+@pytest.mark.parametrize("ghost_mode", [cpp.mesh.GhostMode.none, cpp.mesh.GhostMode.shared_facet])
+def test_exterior_facets(ghost_mode):
+    """Check that the exterior facets are the same for all functions that
+    use them and that each exterior facet is found on one process"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 6, 4, ghost_mode=ghost_mode)
+    tdim = mesh.topology.dim
+    mesh.topology.create_connectivity(tdim - 1, tdim)
+    marker = np.array(cpp.mesh.compute_boundary_facets(mesh.topology))
+    facets = np.array(cpp.mesh.exterior_facet_indices(mesh), dtype=np.int32)
+    assert np.array_equal(np.flatnonzero(marker), facets)
+    assert np.array_equal(np.flatnonzero(cpp.mesh.compute_boundary_facets(mesh.topology)), facets)
+    assert mesh.mpi_comm().allreduce(len(facets), op=MPI.SUM) == 2 * (6 + 4)
+
+
+def _face_permutation(cell_vertices, vertices):
+    """Permutation number of a face, computed from the positions of the face
+    vertices in the cell"""
+    e = [cell_vertices.index(v) for v in vertices]
+    n = len(vertices)
+    if n == 3:
+        pre_post = [(2, 1), (0, 2), (1, 0)]
+        position = [0, 1, 2]
+    else:
+        pre_post = [(2, 1), (0, 3), (3, 0), (1, 2)]
+        position = [0, 1, 3, 2]
+    min_v = int(np.argmin(e))
+    pre, post = pre_post[min_v]
+    g_min_v = int(np.argmin(vertices))
+    g_pre, g_post = pre_post[g_min_v]
+    min_v, g_min_v = position[min_v], position[g_min_v]
+    if vertices[g_post] > vertices[g_pre]:
+        rots = (g_min_v - min_v) % n
+    else:
+        rots = (min_v - g_min_v) % n
+    reflect = (e[post] > e[pre]) == (vertices[g_post] < vertices[g_pre])
+    return int(reflect) + 2 * rots
+
+
+@pytest.mark.parametrize("cell_type", [CellType.tetrahedron, CellType.hexahedron])
+def test_entity_permutations(cell_type):
+    """Check the entity permutations against the permutations computed
+    from the face and edge vertices"""
+    mesh = UnitCubeMesh(MPI.COMM_WORLD, 3, 2, 2, cell_type)
+    topology = mesh.topology
+    topology.create_entity_permutations(num_threads=2)
+    facet_perms = topology.get_facet_permutations()
+    cell_info = topology.get_cell_permutation_info()
+
+    mesh2 = UnitCubeMesh(MPI.COMM_WORLD, 3, 2, 2, cell_type)
+    mesh2.topology.create_facet_permutations()
+    assert np.array_equal(mesh2.topology.get_facet_permutations(), facet_perms)
+
+    topology.create_connectivity(3, 2)
+    topology.create_connectivity(3, 1)
+    c_to_v, c_to_f, c_to_e = [topology.connectivity(3, d) for d in (0, 2, 1)]
+    f_to_v, e_to_v = topology.connectivity(2, 0), topology.connectivity(1, 0)
+    im = topology.index_map(0)
+    num_faces = len(c_to_f.links(0))
+    for c in range(c_to_v.num_nodes):
+        cell_vertices = list(im.local_to_global(c_to_v.links(c)))
+        for i, f in enumerate(c_to_f.links(c)):
+            perm = _face_permutation(cell_vertices, list(im.local_to_global(f_to_v.links(f))))
+            assert facet_perms[c * num_faces + i] == perm
+            assert (cell_info[c] >> (3 * i)) & 7 == perm
+        for i, e in enumerate(c_to_e.links(c)):
+            v0, v1 = im.local_to_global(e_to_v.links(e))
+            reflect = (cell_vertices.index(v0) > cell_vertices.index(v1)) == (v1 > v0)
+            assert (cell_info[c] >> (3 * num_faces + i)) & 1 == reflect
+
+
+@pytest.mark.parametrize("ghost_mode", [cpp.mesh.GhostMode.none,
+                                        cpp.mesh.GhostMode.shared_facet])
+def test_create_submesh(ghost_mode):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 8, 8, ghost_mode=ghost_mode)
+    comm = mesh.mpi_comm()
+    tdim = mesh.topology.dim
+
+    # Cells of the left half of the domain
+    cells = locate_entities(mesh, tdim, lambda x: x[0] <= 0.5 + 1.0e-10)
+    submesh, cell_map, vertex_map, geom_map = create_submesh(mesh, tdim, cells)
+    assert submesh.topology.dim == tdim
+    num_cells = submesh.topology.index_map(tdim).size_global
+    assert num_cells == mesh.topology.index_map(tdim).size_global // 2
+    area = comm.allreduce(assemble_scalar(1 * dx(submesh)), MPI.SUM)
+    assert area == pytest.approx(0.5, rel=1.0e-10)
+    assert np.allclose(submesh.geometry.x, mesh.geometry.x[geom_map])
+    c = mesh.topology.connectivity(tdim, 0)
+    c_sub = submesh.topology.connectivity(tdim, 0)
+    for i, cell in enumerate(cell_map):
+        assert np.array_equal(vertex_map[c_sub.links(i)], c.links(cell))
+
+    # Boundary facets
+    facets = locate_entities_boundary(mesh, tdim - 1, lambda x: np.full(x.shape[1], True))
+    submesh, facet_map, vertex_map, geom_map = create_submesh(mesh, tdim - 1, facets)
+    assert submesh.topology.dim == tdim - 1
+    assert submesh.topology.index_map(tdim - 1).size_global == 4 * 8
+    assert submesh.topology.index_map(0).size_global == 4 * 8
+    length = comm.allreduce(assemble_scalar(1 * dx(submesh)), MPI.SUM)
+    assert length == pytest.approx(4.0, rel=1.0e-10)
+
+
+def test_partition_quality():
+    comm = MPI.COMM_WORLD
+    mesh = UnitSquareMesh(comm, 8, 8)
+    tdim = mesh.topology.dim
+
+    # Partition the cells of the mesh (in the global input numbering)
+    # into one part per rank
+    num_cells = mesh.topology.index_map(tdim).size_global
+    c_v = mesh.topology.connectivity(tdim, 0)
+    cells = np.array([c_v.links(c) for c in range(c_v.num_nodes)], dtype=np.int32)
+    cells = mesh.topology.index_map(0).local_to_global(cells.ravel()).reshape(cells.shape)
+    cells = cells[:mesh.topology.index_map(tdim).size_local]
+    cells = cpp.graph.AdjacencyList_int64(cells)
+    dest = cpp.mesh.partition_cells_graph(comm, comm.size, tdim, cells, cpp.mesh.GhostMode.none)
+    quality = cpp.mesh.compute_partition_quality(comm, comm.size, tdim, cells, dest)
+    assert quality["Max part weight"] >= num_cells / comm.size
+    assert quality["Imbalance"] >= 1.0
+    if comm.size == 1:
+        assert quality["Edge cut"] == 0
+        assert quality["Communication volume"] == 0
+    else:
+        assert quality["Edge cut"] > 0
+
+    summary = cpp.mesh.partition_summary(mesh)
+    assert "Topology index map ({})".format(tdim) in summary
+    assert "send volume" in summary
@@ -24,3 +24,15 @@ def test_create(cell_type):
 
     mt = create_meshtags(mesh, 1, entities, values)
     assert mt.indices.shape == marked_lines.shape
+
+
+def test_find():
+    mesh = UnitCubeMesh(MPI.COMM_WORLD, 3, 3, 3)
+    tdim = mesh.topology.dim
+    num_cells = mesh.topology.index_map(tdim).size_local
+    indices = numpy.arange(num_cells, dtype=numpy.int32)
+    values = numpy.array(indices % 4, dtype=numpy.int32)
+    mt = cpp.mesh.MeshTags_int32(mesh, tdim, indices, values)
+    for value in range(4):
+        assert numpy.array_equal(mt.find(value), indices[values == value])
+    assert len(mt.find(7)) == 0
@@ -5,10 +5,13 @@
 # SPDX-License-Identifier:    LGPL-3.0-or-later
 
 import dolfinx
+import numpy
+import pytest
 import ufl
-from dolfinx import FunctionSpace, UnitCubeMesh, UnitSquareMesh
+from dolfinx import FunctionSpace, UnitCubeMesh, UnitSquareMesh, cpp
 from dolfinx.cpp.mesh import GhostMode
-from dolfinx.mesh import refine
+from dolfinx.fem import assemble_scalar, assemble_vector
+from dolfinx.mesh import MeshTags, locate_entities, refine
 from mpi4py import MPI
 
 
@@ -65,6 +68,146 @@ def test_refine_create_form():
     dolfinx.fem.assemble_matrix(a)
 
 
+def test_refine_repeated_keep_partition():
+    """Check the mesh that is created from the parent topology by
+    repeated refinement without redistribution"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 5, 7, ghost_mode=GhostMode.none)
+    for i in range(2):
+        mesh.topology.create_entities(1)
+        mesh = refine(mesh, redistribute=False)
+    assert mesh.topology.index_map(0).size_global == 609
+    assert mesh.topology.index_map(2).size_global == 1120
+    mesh.topology.create_entities(1)
+    assert mesh.topology.index_map(1).size_global == 1728
+
+    area = mesh.mpi_comm().allreduce(assemble_scalar(1 * ufl.dx(mesh)), op=MPI.SUM)
+    assert numpy.isclose(area, 1.0)
+
+
+@pytest.mark.parametrize("tdim", [2, 3])
+def test_mesh_hierarchy(tdim):
+    """Check the parent maps and the MeshTags transfer of a MeshHierarchy"""
+    if tdim == 2:
+        mesh = UnitSquareMesh(MPI.COMM_WORLD, 5, 7, ghost_mode=GhostMode.none)
+    else:
+        mesh = UnitCubeMesh(MPI.COMM_WORLD, 3, 2, 2, ghost_mode=GhostMode.none)
+    hierarchy = cpp.refinement.MeshHierarchy(mesh)
+    hierarchy.refine()
+    hierarchy.refine()
+    assert hierarchy.num_levels == 3
+    for level in (1, 2):
+        coarse, fine = hierarchy.mesh(level - 1), hierarchy.mesh(level)
+        num_cells = coarse.topology.index_map(tdim).size_local
+        assert fine.topology.index_map(tdim).size_global == 2**tdim * coarse.topology.index_map(tdim).size_global
+
+        # Each cell has 2^tdim children, and each facet has 2^(tdim-1)
+        parent_cells = hierarchy.parent_cells(level)
+        assert len(parent_cells) == fine.topology.index_map(tdim).size_local
+        assert numpy.all(numpy.bincount(parent_cells, minlength=num_cells) == 2**tdim)
+        map_f = coarse.topology.index_map(tdim - 1)
+        parent_facets = hierarchy.parent_facets(level)
+        counts = numpy.bincount(parent_facets[parent_facets >= 0], minlength=map_f.size_local + map_f.num_ghosts)
+        assert numpy.all(counts == 2**(tdim - 1))
+
+    coarse = hierarchy.mesh(0)
+    cells = numpy.arange(coarse.topology.index_map(tdim).size_local, dtype=numpy.int32)
+    tags = MeshTags(coarse, tdim, cells, cells)
+    tags_fine = hierarchy.transfer(tags)
+    assert numpy.all(tags_fine.indices == numpy.arange(len(hierarchy.parent_cells(1))))
+    assert numpy.all(tags_fine.values == hierarchy.parent_cells(1))
+
+
+def test_mesh_hierarchy_coarsen():
+    """Check that coarsening undoes the refinement of the merged cells
+    and that a linear Function is transferred exactly"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 5, 7, ghost_mode=GhostMode.none)
+    hierarchy = cpp.refinement.MeshHierarchy(mesh)
+    hierarchy.refine()
+    hierarchy.refine()
+    tdim = mesh.topology.dim
+    num_cells = [hierarchy.mesh(level).topology.index_map(tdim).size_global for level in range(3)]
+
+    def f(x):
+        return x[0] + 2 * x[1]
+
+    # Coarsen the children of the cells with the midpoint in the left
+    # half. No parent cell crosses x = 0.5, so these families are merged.
+    fine = hierarchy.mesh(2)
+    u0 = dolfinx.Function(FunctionSpace(fine, ("Lagrange", 1)))
+    u0.interpolate(f)
+    cells = locate_entities(fine, tdim, lambda x: x[0] < 0.5)
+    marker = MeshTags(fine, tdim, cells, numpy.ones(len(cells), dtype=numpy.int8))
+    vertex_map = hierarchy.coarsen(marker)
+    assert hierarchy.num_levels == 3
+    mesh1 = hierarchy.mesh(2)
+    assert num_cells[1] < mesh1.topology.index_map(tdim).size_global < num_cells[2]
+    assert len(vertex_map) == mesh1.topology.index_map(0).size_local + mesh1.topology.index_map(0).num_ghosts
+    area = assemble_scalar(1 * ufl.dx(mesh1))
+    assert mesh1.mpi_comm().allreduce(area, op=MPI.SUM) == pytest.approx(1.0, rel=1e-9)
+
+    u1 = dolfinx.Function(FunctionSpace(mesh1, ("Lagrange", 1)))
+    cpp.refinement.transfer(u0._cpp_object, u1._cpp_object, vertex_map)
+    u = dolfinx.Function(u1.function_space)
+    u.interpolate(f)
+    assert numpy.allclose(u1.x.array, u.x.array)
+
+    # Coarsen all cells, which removes the finest level
+    fine = hierarchy.mesh(2)
+    cells = numpy.arange(fine.topology.index_map(tdim).size_local, dtype=numpy.int32)
+    vertex_map = hierarchy.coarsen(MeshTags(fine, tdim, cells, numpy.ones(len(cells), dtype=numpy.int8)))
+    assert hierarchy.num_levels == 2
+    map_v = hierarchy.mesh(1).topology.index_map(0)
+    assert len(vertex_map) == map_v.size_local + map_v.num_ghosts
+
+
+@pytest.mark.parametrize("num_threads", [1, 4])
+def test_refine_threaded(num_threads):
+    """Check that threaded uniform and marked refinement give the mesh
+    of the serial refinement"""
+    mesh = UnitCubeMesh(MPI.COMM_WORLD, 4, 5, 3, ghost_mode=GhostMode.none)
+    mesh.topology.create_entities(1)
+    mesh_refined = refine(mesh, redistribute=False, num_threads=num_threads)
+    assert mesh_refined.topology.index_map(0).size_global == 693
+    assert mesh_refined.topology.index_map(3).size_global == 2880
+
+    tdim = mesh.topology.dim
+    mesh.topology.create_connectivity(tdim, 1)
+    cells = locate_entities(mesh, tdim, lambda x: x[0] < 0.5)
+    markers = MeshTags(mesh, tdim, cells, numpy.ones(len(cells), dtype=numpy.int8))
+    mesh0 = refine(mesh, markers, redistribute=False)
+    mesh1 = refine(mesh, markers, redistribute=False, num_threads=num_threads)
+    for d in (0, tdim):
+        assert mesh1.topology.index_map(d).size_global == mesh0.topology.index_map(d).size_global
+
+
+@pytest.mark.parametrize("num_threads", [1, 4])
+def test_mark_doerfler(num_threads):
+    """Check that the Dörfler selection of cell indicators assembled
+    into a DG0 vector is the minimal set of the largest indicators"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 8, 8, ghost_mode=GhostMode.none)
+    V = FunctionSpace(mesh, ("DG", 0))
+    x = ufl.SpatialCoordinate(mesh)
+    b = assemble_vector(ufl.exp(3 * x[0]) * (1 + x[1]**2) * ufl.TestFunction(V) * ufl.dx)
+    tdim = mesh.topology.dim
+    num_cells = mesh.topology.index_map(tdim).size_local
+    eta = numpy.real(b.array[V.dofmap.list.array[:num_cells]]).copy()
+
+    theta = 0.4
+    comm = mesh.mpi_comm()
+    selected = cpp.refinement.select_doerfler(comm, eta, theta, num_threads)
+    eta_all = numpy.sort(numpy.concatenate(comm.allgather(eta)))[::-1]
+    num_selected = numpy.searchsorted(numpy.cumsum(eta_all), theta * eta_all.sum()) + 1
+    assert comm.allreduce(len(selected), op=MPI.SUM) == num_selected
+
+    mesh.topology.create_entities(1)
+    mesh.topology.create_connectivity(tdim, 1)
+    mesh.topology.create_connectivity(1, 1)
+    edges = cpp.refinement.mark_doerfler(mesh, eta, theta, num_threads)
+    markers = MeshTags(mesh, 1, edges, numpy.ones(len(edges), dtype=numpy.int8))
+    mesh_refined = refine(mesh, markers, redistribute=False)
+    assert mesh_refined.topology.index_map(tdim).size_global > mesh.topology.index_map(tdim).size_global + num_selected
+
+
 def xtest_refinement_gdim():
     """Test that 2D refinement is still 2D"""
     mesh = UnitSquareMesh(MPI.COMM_WORLD, 3, 4, ghost_mode=GhostMode.none)
@@ -6,7 +6,9 @@
 """Unit tests for Newton solver assembly"""
 
 import dolfinx
+import dolfinx.nls
 import numpy as np
+import pytest
 import ufl
 from dolfinx import fem
 from mpi4py import MPI
@@ -159,6 +161,127 @@ def test_nonlinear_pde():
     assert n < 6
 
 
+def test_nonlinear_pde_lagged_jacobian():
+    """Test Newton solver with a lagged Jacobian and inexact Krylov
+    solves with Eisenstat-Walker forcing terms"""
+    mesh = dolfinx.generation.UnitSquareMesh(MPI.COMM_WORLD, 12, 5)
+    V = fem.FunctionSpace(mesh, ("Lagrange", 1))
+    u = dolfinx.fem.Function(V)
+    v = TestFunction(V)
+    F = inner(5.0, v) * dx - ufl.sqrt(u * u) * inner(
+        grad(u), grad(v)) * dx - inner(u, v) * dx
+
+    def boundary(x):
+        """Define Dirichlet boundary (x = 0 or x = 1)."""
+        return np.logical_or(x[0] < 1.0e-8, x[0] > 1.0 - 1.0e-8)
+
+    u_bc = fem.Function(V)
+    with u_bc.vector.localForm() as u_local:
+        u_local.set(1.0)
+    bc = fem.DirichletBC(u_bc, fem.locate_dofs_geometrical(V, boundary))
+    problem = NonlinearPDEProblem(F, u, bc)
+
+    solver = dolfinx.cpp.nls.NewtonSolver(MPI.COMM_WORLD)
+    solver.setF(problem.F, problem.vector())
+    solver.setJ(problem.J, problem.matrix())
+    solver.set_form(problem.form)
+    solver.jacobian_lag = 3
+    solver.jacobian_lag_rate = 0.9
+    with u.vector.localForm() as u_local:
+        u_local.set(0.9)
+    n, converged = solver.solve(u.vector)
+    assert converged
+    assert solver.jacobian_evaluations < n
+    history = solver.history
+    assert [r.iteration for r in history] == list(range(1, n + 1))
+    assert sum(r.jacobian_computed for r in history) == solver.jacobian_evaluations
+    assert sum(r.krylov_iterations for r in history) == solver.krylov_iterations
+    assert history[-1].residual == solver.residual
+    assert all(r.time_krylov >= 0.0 and r.time_residual >= 0.0 for r in history)
+
+    ksp = solver.krylov_solver
+    ksp.setType("gmres")
+    ksp.getPC().setType("jacobi")
+    ksp.setTolerances(rtol=1.0e-12, max_it=1000)
+    solver.jacobian_lag = 1
+    solver.eisenstat_walker = True
+    with u.vector.localForm() as u_local:
+        u_local.set(0.9)
+    n, converged = solver.solve(u.vector)
+    assert converged
+    assert solver.jacobian_evaluations == n
+    assert ksp.getTolerances()[0] == 1.0e-12
+
+
+def test_nonlinear_pde_matrix_free():
+    """Test Newton solver with a finite difference matrix-free Jacobian
+    and an assembled preconditioner"""
+    mesh = dolfinx.generation.UnitSquareMesh(MPI.COMM_WORLD, 12, 5)
+    V = fem.FunctionSpace(mesh, ("Lagrange", 1))
+    u = dolfinx.fem.Function(V)
+    v = TestFunction(V)
+    F = inner(5.0, v) * dx - ufl.sqrt(u * u) * inner(
+        grad(u), grad(v)) * dx - inner(u, v) * dx
+
+    def boundary(x):
+        """Define Dirichlet boundary (x = 0 or x = 1)."""
+        return np.logical_or(x[0] < 1.0e-8, x[0] > 1.0 - 1.0e-8)
+
+    u_bc = fem.Function(V)
+    with u_bc.vector.localForm() as u_local:
+        u_local.set(1.0)
+    bc = fem.DirichletBC(u_bc, fem.locate_dofs_geometrical(V, boundary))
+    problem = NonlinearPDEProblem(F, u, bc)
+
+    solver = dolfinx.cpp.nls.NewtonSolver(MPI.COMM_WORLD)
+    solver.setF(problem.F, problem.vector())
+    solver.setJ_matrix_free()
+    solver.setP(problem.J, problem.matrix())
+    solver.set_form(problem.form)
+    ksp = solver.krylov_solver
+    ksp.setType("gmres")
+    ksp.getPC().setType("jacobi")
+    ksp.setTolerances(rtol=1.0e-10, max_it=1000)
+    with u.vector.localForm() as u_local:
+        u_local.set(0.9)
+    n, converged = solver.solve(u.vector)
+    assert converged
+    assert n < 8
+
+
+def test_nonlinear_pde_fused():
+    """Test Newton solver with the residual and the Jacobian assembled
+    in one pass"""
+    mesh = dolfinx.generation.UnitSquareMesh(MPI.COMM_WORLD, 12, 5)
+    V = fem.FunctionSpace(mesh, ("Lagrange", 1))
+
+    def boundary(x):
+        """Define Dirichlet boundary (x = 0 or x = 1)."""
+        return np.logical_or(x[0] < 1.0e-8, x[0] > 1.0 - 1.0e-8)
+
+    u_bc = fem.Function(V)
+    with u_bc.vector.localForm() as u_local:
+        u_local.set(1.0)
+    bc = fem.DirichletBC(u_bc, fem.locate_dofs_geometrical(V, boundary))
+
+    results = []
+    for fused in (False, True):
+        u = dolfinx.fem.Function(V)
+        v = TestFunction(V)
+        F = inner(5.0, v) * dx - ufl.sqrt(u * u) * inner(
+            grad(u), grad(v)) * dx - inner(u, v) * dx
+        problem = fem.NonlinearProblem(F, u, [bc])
+        solver = dolfinx.nls.NewtonSolver(MPI.COMM_WORLD, problem, fused=fused)
+        with u.vector.localForm() as u_local:
+            u_local.set(0.9)
+        n, converged = solver.solve(u)
+        assert converged
+        results.append((n, u.vector.norm()))
+
+    assert results[0][0] == results[1][0]
+    assert results[0][1] == pytest.approx(results[1][1], rel=1e-10)
+
+
 def test_nonlinear_pde_snes():
     """Test Newton solver for a simple nonlinear PDE"""
     # Create mesh and function space